@@ -0,0 +1,231 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include "overheadbench.h"
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+
+#define SAFE_RELEASE(p) \
+  do                    \
+  {                     \
+    if(p)               \
+      (p)->Release();   \
+    (p) = NULL;         \
+  } while((void)0, 0)
+
+static const char *vertexShader =
+    "cbuffer params : register(b0) { float4 offset; };\n"
+    "float4 main(uint id : SV_VertexID) : SV_Position\n"
+    "{ return float4(float(id) * 0.01f, 0.0f, 0.0f, 1.0f) + offset; }\n";
+
+enum D3D11Workload
+{
+  eD3D11Workload_Draws,
+  eD3D11Workload_ConstantBufferBinds,
+  eD3D11Workload_Maps,
+  eD3D11Workload_Creation,
+  eD3D11Workload_Count,
+};
+
+static const uint32_t D3D11CallsPerFrame[eD3D11Workload_Count] = {10000, 10000, 1000, 1000};
+
+static const char *D3D11WorkloadNames[eD3D11Workload_Count] = {
+    "draws", "descriptor_updates", "maps", "resource_creation",
+};
+
+static const uint32_t NumConstantBuffers = 64;
+
+class D3D11Bench : public BenchAPI
+{
+public:
+  D3D11Bench()
+  {
+    m_Device = NULL;
+    m_Context = NULL;
+    m_VS = NULL;
+    m_MapBuffer = NULL;
+    m_Query = NULL;
+    memset(m_CBs, 0, sizeof(m_CBs));
+  }
+
+  const char *Name() { return "D3D11"; }
+  bool Init();
+  void Shutdown();
+  void *DevicePointer() { return m_Device; }
+  uint32_t NumWorkloads() { return eD3D11Workload_Count; }
+  const char *WorkloadName(uint32_t w) { return D3D11WorkloadNames[w]; }
+  uint32_t CallsPerFrame(uint32_t w) { return D3D11CallsPerFrame[w]; }
+  void Frame(uint32_t w);
+  void Present();
+
+private:
+  ID3D11Device *m_Device;
+  ID3D11DeviceContext *m_Context;
+  ID3D11VertexShader *m_VS;
+  ID3D11Buffer *m_CBs[NumConstantBuffers];
+  ID3D11Buffer *m_MapBuffer;
+  ID3D11Query *m_Query;
+};
+
+bool D3D11Bench::Init()
+{
+  HRESULT hr = D3D11CreateDevice(NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, 0, NULL, 0,
+                                 D3D11_SDK_VERSION, &m_Device, NULL, &m_Context);
+
+  if(FAILED(hr))
+  {
+    std::cerr << "Couldn't create a D3D11 device: " << std::hex << hr << std::dec << std::endl;
+    return false;
+  }
+
+  ID3DBlob *blob = NULL;
+  hr = D3DCompile(vertexShader, strlen(vertexShader), "overheadbench", NULL, NULL, "main", "vs_4_0",
+                  0, 0, &blob, NULL);
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), NULL, &m_VS);
+
+  SAFE_RELEASE(blob);
+
+  D3D11_BUFFER_DESC desc = {};
+  desc.ByteWidth = 256;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+  desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+  for(uint32_t i = 0; SUCCEEDED(hr) && i < NumConstantBuffers; i++)
+    hr = m_Device->CreateBuffer(&desc, NULL, &m_CBs[i]);
+
+  desc.Usage = D3D11_USAGE_DYNAMIC;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateBuffer(&desc, NULL, &m_MapBuffer);
+
+  D3D11_QUERY_DESC queryDesc = {D3D11_QUERY_EVENT, 0};
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateQuery(&queryDesc, &m_Query);
+
+  if(FAILED(hr))
+  {
+    std::cerr << "Couldn't create the D3D11 benchmark objects: " << std::hex << hr << std::dec
+              << std::endl;
+    Shutdown();
+    return false;
+  }
+
+  D3D11_VIEWPORT view = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+
+  m_Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
+  m_Context->VSSetShader(m_VS, NULL, 0);
+  m_Context->VSSetConstantBuffers(0, 1, &m_CBs[0]);
+  m_Context->RSSetViewports(1, &view);
+
+  return true;
+}
+
+void D3D11Bench::Shutdown()
+{
+  if(m_Context)
+    m_Context->ClearState();
+
+  for(uint32_t i = 0; i < NumConstantBuffers; i++)
+    SAFE_RELEASE(m_CBs[i]);
+
+  SAFE_RELEASE(m_Query);
+  SAFE_RELEASE(m_MapBuffer);
+  SAFE_RELEASE(m_VS);
+  SAFE_RELEASE(m_Context);
+  SAFE_RELEASE(m_Device);
+}
+
+void D3D11Bench::Frame(uint32_t w)
+{
+  const uint32_t calls = D3D11CallsPerFrame[w];
+
+  switch(w)
+  {
+    case eD3D11Workload_Draws:
+    {
+      for(uint32_t i = 0; i < calls; i++)
+        m_Context->Draw(1, i % 64);
+      break;
+    }
+    case eD3D11Workload_ConstantBufferBinds:
+    {
+      for(uint32_t i = 0; i < calls; i++)
+        m_Context->VSSetConstantBuffers(0, 1, &m_CBs[i % NumConstantBuffers]);
+      break;
+    }
+    case eD3D11Workload_Maps:
+    {
+      // a map/unmap pair counts as one call
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        HRESULT hr = m_Context->Map(m_MapBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if(SUCCEEDED(hr))
+        {
+          memset(mapped.pData, i & 0xff, 256);
+          m_Context->Unmap(m_MapBuffer, 0);
+        }
+      }
+      break;
+    }
+    case eD3D11Workload_Creation:
+    {
+      // one create and release counts as one call
+      D3D11_BUFFER_DESC desc = {};
+      desc.ByteWidth = 1024;
+      desc.Usage = D3D11_USAGE_DEFAULT;
+      desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        ID3D11Buffer *buf = NULL;
+        m_Device->CreateBuffer(&desc, NULL, &buf);
+        SAFE_RELEASE(buf);
+      }
+      break;
+    }
+  }
+}
+
+void D3D11Bench::Present()
+{
+  // there's no swapchain, so a frame ends with a flush and a wait for the GPU
+  m_Context->End(m_Query);
+  m_Context->Flush();
+
+  while(m_Context->GetData(m_Query, NULL, 0, 0) == S_FALSE)
+    ;
+}
+
+BenchAPI *CreateD3D11Bench()
+{
+  return new D3D11Bench();
+}
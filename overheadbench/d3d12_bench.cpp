@@ -0,0 +1,349 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include "overheadbench.h"
+
+#include <d3d12.h>
+#include <d3dcompiler.h>
+
+#define SAFE_RELEASE(p) \
+  do                    \
+  {                     \
+    if(p)               \
+      (p)->Release();   \
+    (p) = NULL;         \
+  } while((void)0, 0)
+
+static const char *vertexShader =
+    "float4 main(uint id : SV_VertexID) : SV_Position\n"
+    "{ return float4(float(id) * 0.01f, 0.0f, 0.0f, 1.0f); }\n";
+
+enum D3D12Workload
+{
+  eD3D12Workload_Draws,
+  eD3D12Workload_DescriptorUpdates,
+  eD3D12Workload_Maps,
+  eD3D12Workload_Creation,
+  eD3D12Workload_Count,
+};
+
+static const uint32_t D3D12CallsPerFrame[eD3D12Workload_Count] = {10000, 10000, 1000, 1000};
+
+static const char *D3D12WorkloadNames[eD3D12Workload_Count] = {
+    "draws", "descriptor_updates", "maps", "resource_creation",
+};
+
+static const uint32_t NumDescriptors = 64;
+
+class D3D12Bench : public BenchAPI
+{
+public:
+  D3D12Bench()
+  {
+    m_Device = NULL;
+    m_Queue = NULL;
+    m_Alloc = NULL;
+    m_List = NULL;
+    m_Fence = NULL;
+    m_FenceValue = 0;
+    m_FenceEvent = NULL;
+    m_RootSig = NULL;
+    m_PSO = NULL;
+    m_Heap = NULL;
+    m_Buffer = NULL;
+    m_Recorded = false;
+  }
+
+  const char *Name() { return "D3D12"; }
+  bool Init();
+  void Shutdown();
+  void *DevicePointer() { return m_Device; }
+  uint32_t NumWorkloads() { return eD3D12Workload_Count; }
+  const char *WorkloadName(uint32_t w) { return D3D12WorkloadNames[w]; }
+  uint32_t CallsPerFrame(uint32_t w) { return D3D12CallsPerFrame[w]; }
+  void Frame(uint32_t w);
+  void Present();
+
+private:
+  ID3D12Device *m_Device;
+  ID3D12CommandQueue *m_Queue;
+  ID3D12CommandAllocator *m_Alloc;
+  ID3D12GraphicsCommandList *m_List;
+  ID3D12Fence *m_Fence;
+  UINT64 m_FenceValue;
+  HANDLE m_FenceEvent;
+  ID3D12RootSignature *m_RootSig;
+  ID3D12PipelineState *m_PSO;
+  ID3D12DescriptorHeap *m_Heap;
+  ID3D12Resource *m_Buffer;
+  bool m_Recorded;
+};
+
+bool D3D12Bench::Init()
+{
+  HRESULT hr = D3D12CreateDevice(NULL, D3D_FEATURE_LEVEL_11_0, __uuidof(ID3D12Device),
+                                 (void **)&m_Device);
+
+  if(FAILED(hr))
+  {
+    std::cerr << "Couldn't create a D3D12 device: " << std::hex << hr << std::dec << std::endl;
+    return false;
+  }
+
+  D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+  queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+
+  hr = m_Device->CreateCommandQueue(&queueDesc, __uuidof(ID3D12CommandQueue), (void **)&m_Queue);
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                          __uuidof(ID3D12CommandAllocator), (void **)&m_Alloc);
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence), (void **)&m_Fence);
+
+  m_FenceEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+
+  // an empty root signature, the vertex shader needs no resources
+  D3D12_ROOT_SIGNATURE_DESC rootDesc = {};
+  ID3DBlob *blob = NULL;
+
+  if(SUCCEEDED(hr))
+    hr = D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, &blob, NULL);
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateRootSignature(0, blob->GetBufferPointer(), blob->GetBufferSize(),
+                                       __uuidof(ID3D12RootSignature), (void **)&m_RootSig);
+
+  SAFE_RELEASE(blob);
+
+  if(SUCCEEDED(hr))
+    hr = D3DCompile(vertexShader, strlen(vertexShader), "overheadbench", NULL, NULL, "main",
+                    "vs_5_0", 0, 0, &blob, NULL);
+
+  if(SUCCEEDED(hr))
+  {
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = m_RootSig;
+    psoDesc.VS.pShaderBytecode = blob->GetBufferPointer();
+    psoDesc.VS.BytecodeLength = blob->GetBufferSize();
+    psoDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    psoDesc.SampleMask = ~0U;
+    psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.RasterizerState.DepthClipEnable = TRUE;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_POINT;
+    psoDesc.SampleDesc.Count = 1;
+
+    hr = m_Device->CreateGraphicsPipelineState(&psoDesc, __uuidof(ID3D12PipelineState),
+                                               (void **)&m_PSO);
+  }
+
+  SAFE_RELEASE(blob);
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_Alloc, m_PSO,
+                                     __uuidof(ID3D12GraphicsCommandList), (void **)&m_List);
+
+  if(SUCCEEDED(hr))
+    hr = m_List->Close();
+
+  // CPU-side descriptors are what descriptor updates write
+  D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+  heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+  heapDesc.NumDescriptors = NumDescriptors;
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateDescriptorHeap(&heapDesc, __uuidof(ID3D12DescriptorHeap),
+                                        (void **)&m_Heap);
+
+  D3D12_HEAP_PROPERTIES uploadHeap = {D3D12_HEAP_TYPE_UPLOAD};
+
+  D3D12_RESOURCE_DESC bufDesc = {};
+  bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+  bufDesc.Width = 256 * NumDescriptors;
+  bufDesc.Height = 1;
+  bufDesc.DepthOrArraySize = 1;
+  bufDesc.MipLevels = 1;
+  bufDesc.SampleDesc.Count = 1;
+  bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+  if(SUCCEEDED(hr))
+    hr = m_Device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &bufDesc,
+                                           D3D12_RESOURCE_STATE_GENERIC_READ, NULL,
+                                           __uuidof(ID3D12Resource), (void **)&m_Buffer);
+
+  if(FAILED(hr) || m_FenceEvent == NULL)
+  {
+    std::cerr << "Couldn't create the D3D12 benchmark objects: " << std::hex << hr << std::dec
+              << std::endl;
+    Shutdown();
+    return false;
+  }
+
+  return true;
+}
+
+void D3D12Bench::Shutdown()
+{
+  if(m_Queue && m_Fence && m_FenceEvent)
+    Present();
+
+  SAFE_RELEASE(m_Buffer);
+  SAFE_RELEASE(m_Heap);
+  SAFE_RELEASE(m_List);
+  SAFE_RELEASE(m_PSO);
+  SAFE_RELEASE(m_RootSig);
+  SAFE_RELEASE(m_Fence);
+  SAFE_RELEASE(m_Alloc);
+  SAFE_RELEASE(m_Queue);
+  SAFE_RELEASE(m_Device);
+
+  if(m_FenceEvent)
+    CloseHandle(m_FenceEvent);
+  m_FenceEvent = NULL;
+}
+
+void D3D12Bench::Frame(uint32_t w)
+{
+  const uint32_t calls = D3D12CallsPerFrame[w];
+
+  switch(w)
+  {
+    case eD3D12Workload_Draws:
+    {
+      m_List->Reset(m_Alloc, m_PSO);
+
+      D3D12_VIEWPORT view = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+      D3D12_RECT scissor = {0, 0, 64, 64};
+
+      m_List->SetGraphicsRootSignature(m_RootSig);
+      m_List->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
+      m_List->RSSetViewports(1, &view);
+      m_List->RSSetScissorRects(1, &scissor);
+
+      for(uint32_t i = 0; i < calls; i++)
+        m_List->DrawInstanced(1, 1, i % 64, 0);
+
+      m_List->Close();
+
+      m_Recorded = true;
+      break;
+    }
+    case eD3D12Workload_DescriptorUpdates:
+    {
+      D3D12_CPU_DESCRIPTOR_HANDLE base = m_Heap->GetCPUDescriptorHandleForHeapStart();
+      UINT increment =
+          m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+      D3D12_GPU_VIRTUAL_ADDRESS address = m_Buffer->GetGPUVirtualAddress();
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        uint32_t slot = i % NumDescriptors;
+
+        D3D12_CONSTANT_BUFFER_VIEW_DESC cbv = {address + slot * 256, 256};
+
+        D3D12_CPU_DESCRIPTOR_HANDLE handle = base;
+        handle.ptr += slot * increment;
+
+        m_Device->CreateConstantBufferView(&cbv, handle);
+      }
+      break;
+    }
+    case eD3D12Workload_Maps:
+    {
+      // a map/unmap pair counts as one call
+      D3D12_RANGE noRead = {0, 0};
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        D3D12_RANGE written = {(i % NumDescriptors) * 256, (i % NumDescriptors) * 256 + 256};
+
+        void *ptr = NULL;
+        HRESULT hr = m_Buffer->Map(0, &noRead, &ptr);
+        if(SUCCEEDED(hr))
+        {
+          memset((byte *)ptr + written.Begin, i & 0xff, 256);
+          m_Buffer->Unmap(0, &written);
+        }
+      }
+      break;
+    }
+    case eD3D12Workload_Creation:
+    {
+      // one create and release counts as one call
+      D3D12_HEAP_PROPERTIES defaultHeap = {D3D12_HEAP_TYPE_DEFAULT};
+
+      D3D12_RESOURCE_DESC bufDesc = {};
+      bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+      bufDesc.Width = 1024;
+      bufDesc.Height = 1;
+      bufDesc.DepthOrArraySize = 1;
+      bufDesc.MipLevels = 1;
+      bufDesc.SampleDesc.Count = 1;
+      bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        ID3D12Resource *buf = NULL;
+        m_Device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &bufDesc,
+                                          D3D12_RESOURCE_STATE_COMMON, NULL,
+                                          __uuidof(ID3D12Resource), (void **)&buf);
+        SAFE_RELEASE(buf);
+      }
+      break;
+    }
+  }
+}
+
+void D3D12Bench::Present()
+{
+  // there's no swapchain, so a frame ends with a submit and a wait on a fence
+  if(m_Recorded)
+  {
+    ID3D12CommandList *list = m_List;
+    m_Queue->ExecuteCommandLists(1, &list);
+  }
+
+  m_FenceValue++;
+  m_Queue->Signal(m_Fence, m_FenceValue);
+
+  if(m_Fence->GetCompletedValue() < m_FenceValue)
+  {
+    m_Fence->SetEventOnCompletion(m_FenceValue, m_FenceEvent);
+    WaitForSingleObject(m_FenceEvent, INFINITE);
+  }
+
+  if(m_Recorded)
+    m_Alloc->Reset();
+
+  m_Recorded = false;
+}
+
+BenchAPI *CreateD3D12Bench()
+{
+  return new D3D12Bench();
+}
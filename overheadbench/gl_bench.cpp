@@ -0,0 +1,530 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include "overheadbench.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+#include "official/glcorearb.h"
+#include "official/wglext.h"
+
+#else
+
+#include "official/glcorearb.h"
+
+// cheeky way to prevent GL/gl.h from being included, as we want to use
+// glcorearb.h from above. Likewise use the official glxext.h instead of the system's
+#define __gl_h_
+#define GLX_GLXEXT_LEGACY
+#include <GL/glx.h>
+#include "official/glxext.h"
+
+#endif
+
+#define GL_BENCH_FUNCS(FUNC)                                   \
+  FUNC(PFNGLGETSTRINGPROC, glGetString);                       \
+  FUNC(PFNGLCLEARPROC, glClear);                               \
+  FUNC(PFNGLFINISHPROC, glFinish);                             \
+  FUNC(PFNGLVIEWPORTPROC, glViewport);                         \
+  FUNC(PFNGLDRAWARRAYSPROC, glDrawArrays);                     \
+  FUNC(PFNGLGENBUFFERSPROC, glGenBuffers);                     \
+  FUNC(PFNGLBINDBUFFERPROC, glBindBuffer);                     \
+  FUNC(PFNGLBINDBUFFERRANGEPROC, glBindBufferRange);           \
+  FUNC(PFNGLBUFFERDATAPROC, glBufferData);                     \
+  FUNC(PFNGLMAPBUFFERRANGEPROC, glMapBufferRange);             \
+  FUNC(PFNGLUNMAPBUFFERPROC, glUnmapBuffer);                   \
+  FUNC(PFNGLDELETEBUFFERSPROC, glDeleteBuffers);               \
+  FUNC(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays);           \
+  FUNC(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray);           \
+  FUNC(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays);     \
+  FUNC(PFNGLCREATESHADERPROC, glCreateShader);                 \
+  FUNC(PFNGLSHADERSOURCEPROC, glShaderSource);                 \
+  FUNC(PFNGLCOMPILESHADERPROC, glCompileShader);               \
+  FUNC(PFNGLDELETESHADERPROC, glDeleteShader);                 \
+  FUNC(PFNGLCREATEPROGRAMPROC, glCreateProgram);               \
+  FUNC(PFNGLATTACHSHADERPROC, glAttachShader);                 \
+  FUNC(PFNGLLINKPROGRAMPROC, glLinkProgram);                   \
+  FUNC(PFNGLGETPROGRAMIVPROC, glGetProgramiv);                 \
+  FUNC(PFNGLUSEPROGRAMPROC, glUseProgram);                     \
+  FUNC(PFNGLDELETEPROGRAMPROC, glDeleteProgram);               \
+  FUNC(PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex); \
+  FUNC(PFNGLUNIFORMBLOCKBINDINGPROC, glUniformBlockBinding);
+
+struct GLFunctions
+{
+#define DECLARE_FUNC(type, name) type name
+  GL_BENCH_FUNCS(DECLARE_FUNC)
+#undef DECLARE_FUNC
+};
+
+static const char *vertexShader =
+    "#version 330 core\n"
+    "layout(std140) uniform params { vec4 offset; };\n"
+    "void main() { gl_Position = vec4(float(gl_VertexID) * 0.01, 0.0, 0.0, 1.0) + offset; }\n";
+
+static const char *fragmentShader =
+    "#version 330 core\n"
+    "out vec4 col;\n"
+    "void main() { col = vec4(1.0, 0.0, 1.0, 1.0); }\n";
+
+enum GLWorkload
+{
+  eGLWorkload_Draws,
+  eGLWorkload_BufferBinds,
+  eGLWorkload_Maps,
+  eGLWorkload_Creation,
+  eGLWorkload_Count,
+};
+
+static const uint32_t GLCallsPerFrame[eGLWorkload_Count] = {10000, 10000, 1000, 1000};
+
+static const char *GLWorkloadNames[eGLWorkload_Count] = {
+    "draws", "descriptor_updates", "maps", "resource_creation",
+};
+
+// the uniform buffer is bound in 256-byte slices, the largest alignment any implementation needs
+static const uint32_t UniformSlices = 64;
+
+class GLBench : public BenchAPI
+{
+public:
+  GLBench()
+  {
+    memset(&GL, 0, sizeof(GL));
+    m_Program = m_VAO = m_UBO = m_MapBuffer = 0;
+#if defined(_WIN32)
+    m_Wnd = NULL;
+    m_DC = NULL;
+    m_Ctx = NULL;
+#else
+    m_Display = NULL;
+    m_Window = 0;
+    m_Colormap = 0;
+    m_Ctx = NULL;
+#endif
+  }
+
+  const char *Name() { return "GL"; }
+  bool Init();
+  void Shutdown();
+  uint32_t NumWorkloads() { return eGLWorkload_Count; }
+  const char *WorkloadName(uint32_t w) { return GLWorkloadNames[w]; }
+  uint32_t CallsPerFrame(uint32_t w) { return GLCallsPerFrame[w]; }
+  void Frame(uint32_t w);
+  void Present();
+
+private:
+  bool CreateContext();
+  void DestroyContext();
+  void *GetProc(const char *name);
+
+  GLFunctions GL;
+
+  GLuint m_Program;
+  GLuint m_VAO;
+  GLuint m_UBO;
+  GLuint m_MapBuffer;
+
+#if defined(_WIN32)
+  HWND m_Wnd;
+  HDC m_DC;
+  HGLRC m_Ctx;
+#else
+  Display *m_Display;
+  Window m_Window;
+  Colormap m_Colormap;
+  GLXContext m_Ctx;
+#endif
+};
+
+#if defined(_WIN32)
+
+void *GLBench::GetProc(const char *name)
+{
+  void *ret = (void *)wglGetProcAddress(name);
+
+  // GL 1.1 entry points only come from opengl32.dll itself
+  if(ret == NULL)
+    ret = (void *)GetProcAddress(GetModuleHandleA("opengl32.dll"), name);
+
+  return ret;
+}
+
+bool GLBench::CreateContext()
+{
+  WNDCLASSA wc = {};
+  wc.style = CS_OWNDC;
+  wc.lpfnWndProc = DefWindowProcA;
+  wc.hInstance = GetModuleHandleA(NULL);
+  wc.lpszClassName = "overheadbenchgl";
+  RegisterClassA(&wc);
+
+  m_Wnd = CreateWindowA("overheadbenchgl", "overheadbench", WS_OVERLAPPEDWINDOW, 0, 0, 64, 64,
+                        NULL, NULL, wc.hInstance, NULL);
+
+  if(m_Wnd == NULL)
+  {
+    std::cerr << "Couldn't create a window for GL" << std::endl;
+    return false;
+  }
+
+  m_DC = GetDC(m_Wnd);
+
+  PIXELFORMATDESCRIPTOR pfd = {};
+  pfd.nSize = sizeof(pfd);
+  pfd.nVersion = 1;
+  pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+  pfd.iPixelType = PFD_TYPE_RGBA;
+  pfd.cColorBits = 32;
+
+  int pf = ChoosePixelFormat(m_DC, &pfd);
+  if(pf == 0 || !SetPixelFormat(m_DC, pf, &pfd))
+  {
+    std::cerr << "Couldn't set a GL pixel format" << std::endl;
+    return false;
+  }
+
+  // need a legacy context current to be able to fetch wglCreateContextAttribsARB
+  HGLRC dummy = wglCreateContext(m_DC);
+  wglMakeCurrent(m_DC, dummy);
+
+  PFNWGLCREATECONTEXTATTRIBSARBPROC createContextAttribs =
+      (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+
+  if(createContextAttribs)
+  {
+    const int attribs[] = {
+        WGL_CONTEXT_MAJOR_VERSION_ARB,
+        3,
+        WGL_CONTEXT_MINOR_VERSION_ARB,
+        3,
+        WGL_CONTEXT_PROFILE_MASK_ARB,
+        WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+        0,
+    };
+
+    m_Ctx = createContextAttribs(m_DC, NULL, attribs);
+  }
+
+  wglMakeCurrent(NULL, NULL);
+  wglDeleteContext(dummy);
+
+  if(m_Ctx == NULL)
+  {
+    std::cerr << "Couldn't create a GL 3.3 core context" << std::endl;
+    return false;
+  }
+
+  wglMakeCurrent(m_DC, m_Ctx);
+
+  return true;
+}
+
+void GLBench::DestroyContext()
+{
+  if(m_Ctx)
+  {
+    wglMakeCurrent(NULL, NULL);
+    wglDeleteContext(m_Ctx);
+  }
+
+  if(m_Wnd)
+  {
+    ReleaseDC(m_Wnd, m_DC);
+    DestroyWindow(m_Wnd);
+  }
+
+  m_Ctx = NULL;
+  m_DC = NULL;
+  m_Wnd = NULL;
+}
+
+void GLBench::Present()
+{
+  GL.glFinish();
+  SwapBuffers(m_DC);
+}
+
+#else
+
+void *GLBench::GetProc(const char *name)
+{
+  return (void *)glXGetProcAddress((const GLubyte *)name);
+}
+
+bool GLBench::CreateContext()
+{
+  m_Display = XOpenDisplay(NULL);
+
+  if(m_Display == NULL)
+  {
+    std::cerr << "Couldn't open an X display for GL" << std::endl;
+    return false;
+  }
+
+  const int fbAttribs[] = {
+      GLX_X_RENDERABLE, True, GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT, GLX_RENDER_TYPE, GLX_RGBA_BIT,
+      GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, GLX_DOUBLEBUFFER, True, None,
+  };
+
+  int numConfigs = 0;
+  GLXFBConfig *configs =
+      glXChooseFBConfig(m_Display, DefaultScreen(m_Display), fbAttribs, &numConfigs);
+
+  if(configs == NULL || numConfigs == 0)
+  {
+    std::cerr << "Couldn't find a GLX framebuffer config" << std::endl;
+    return false;
+  }
+
+  GLXFBConfig config = configs[0];
+  XFree(configs);
+
+  XVisualInfo *vi = glXGetVisualFromFBConfig(m_Display, config);
+
+  if(vi == NULL)
+  {
+    std::cerr << "Couldn't get a visual for the GLX framebuffer config" << std::endl;
+    return false;
+  }
+
+  Window root = RootWindow(m_Display, vi->screen);
+
+  m_Colormap = XCreateColormap(m_Display, root, vi->visual, AllocNone);
+
+  XSetWindowAttributes swa = {};
+  swa.colormap = m_Colormap;
+  swa.border_pixel = 0;
+
+  m_Window = XCreateWindow(m_Display, root, 0, 0, 64, 64, 0, vi->depth, InputOutput, vi->visual,
+                           CWBorderPixel | CWColormap, &swa);
+
+  XFree(vi);
+
+  XStoreName(m_Display, m_Window, "overheadbench");
+  XMapWindow(m_Display, m_Window);
+  XSync(m_Display, False);
+
+  PFNGLXCREATECONTEXTATTRIBSARBPROC createContextAttribs =
+      (PFNGLXCREATECONTEXTATTRIBSARBPROC)GetProc("glXCreateContextAttribsARB");
+
+  if(createContextAttribs)
+  {
+    const int attribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB,
+        3,
+        GLX_CONTEXT_MINOR_VERSION_ARB,
+        3,
+        GLX_CONTEXT_PROFILE_MASK_ARB,
+        GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        0,
+    };
+
+    m_Ctx = createContextAttribs(m_Display, config, NULL, True, attribs);
+  }
+
+  if(m_Ctx == NULL)
+  {
+    std::cerr << "Couldn't create a GL 3.3 core context" << std::endl;
+    return false;
+  }
+
+  glXMakeCurrent(m_Display, m_Window, m_Ctx);
+
+  return true;
+}
+
+void GLBench::DestroyContext()
+{
+  if(m_Display == NULL)
+    return;
+
+  if(m_Ctx)
+  {
+    glXMakeCurrent(m_Display, None, NULL);
+    glXDestroyContext(m_Display, m_Ctx);
+  }
+
+  if(m_Window)
+    XDestroyWindow(m_Display, m_Window);
+
+  if(m_Colormap)
+    XFreeColormap(m_Display, m_Colormap);
+
+  XCloseDisplay(m_Display);
+
+  m_Ctx = NULL;
+  m_Window = 0;
+  m_Colormap = 0;
+  m_Display = NULL;
+}
+
+void GLBench::Present()
+{
+  GL.glFinish();
+  glXSwapBuffers(m_Display, m_Window);
+}
+
+#endif
+
+bool GLBench::Init()
+{
+  if(!CreateContext())
+  {
+    DestroyContext();
+    return false;
+  }
+
+#define FETCH_FUNC(type, name)                                        \
+  GL.name = (type)GetProc(#name);                                     \
+  if(GL.name == NULL)                                                 \
+  {                                                                   \
+    std::cerr << "Couldn't fetch GL function " << #name << std::endl; \
+    DestroyContext();                                                 \
+    return false;                                                     \
+  }
+
+  GL_BENCH_FUNCS(FETCH_FUNC)
+
+#undef FETCH_FUNC
+
+  std::cerr << "GL renderer: " << (const char *)GL.glGetString(GL_RENDERER) << std::endl;
+
+  GLuint vs = GL.glCreateShader(GL_VERTEX_SHADER);
+  GL.glShaderSource(vs, 1, &vertexShader, NULL);
+  GL.glCompileShader(vs);
+
+  GLuint fs = GL.glCreateShader(GL_FRAGMENT_SHADER);
+  GL.glShaderSource(fs, 1, &fragmentShader, NULL);
+  GL.glCompileShader(fs);
+
+  m_Program = GL.glCreateProgram();
+  GL.glAttachShader(m_Program, vs);
+  GL.glAttachShader(m_Program, fs);
+  GL.glLinkProgram(m_Program);
+
+  GL.glDeleteShader(vs);
+  GL.glDeleteShader(fs);
+
+  GLint linked = 0;
+  GL.glGetProgramiv(m_Program, GL_LINK_STATUS, &linked);
+
+  if(!linked)
+  {
+    std::cerr << "Couldn't link the GL benchmark program" << std::endl;
+    Shutdown();
+    return false;
+  }
+
+  GL.glUniformBlockBinding(m_Program, GL.glGetUniformBlockIndex(m_Program, "params"), 0);
+
+  GL.glGenVertexArrays(1, &m_VAO);
+  GL.glBindVertexArray(m_VAO);
+
+  char zeroes[256 * UniformSlices] = {};
+
+  GL.glGenBuffers(1, &m_UBO);
+  GL.glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+  GL.glBufferData(GL_UNIFORM_BUFFER, sizeof(zeroes), zeroes, GL_STATIC_DRAW);
+  GL.glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_UBO, 0, 256);
+
+  GL.glGenBuffers(1, &m_MapBuffer);
+  GL.glBindBuffer(GL_ARRAY_BUFFER, m_MapBuffer);
+  GL.glBufferData(GL_ARRAY_BUFFER, 256, NULL, GL_DYNAMIC_DRAW);
+
+  GL.glUseProgram(m_Program);
+  GL.glViewport(0, 0, 64, 64);
+
+  return true;
+}
+
+void GLBench::Shutdown()
+{
+  if(GL.glDeleteProgram)
+  {
+    GL.glDeleteProgram(m_Program);
+    GL.glDeleteVertexArrays(1, &m_VAO);
+    GL.glDeleteBuffers(1, &m_UBO);
+    GL.glDeleteBuffers(1, &m_MapBuffer);
+  }
+
+  m_Program = m_VAO = m_UBO = m_MapBuffer = 0;
+
+  DestroyContext();
+}
+
+void GLBench::Frame(uint32_t w)
+{
+  const uint32_t calls = GLCallsPerFrame[w];
+
+  switch(w)
+  {
+    case eGLWorkload_Draws:
+    {
+      for(uint32_t i = 0; i < calls; i++)
+        GL.glDrawArrays(GL_POINTS, i % 64, 1);
+      break;
+    }
+    case eGLWorkload_BufferBinds:
+    {
+      for(uint32_t i = 0; i < calls; i++)
+        GL.glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_UBO, (i % UniformSlices) * 256, 256);
+      break;
+    }
+    case eGLWorkload_Maps:
+    {
+      // a map/unmap pair counts as one call
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        void *ptr = GL.glMapBufferRange(GL_ARRAY_BUFFER, 0, 256,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if(ptr)
+          memset(ptr, i & 0xff, 256);
+        GL.glUnmapBuffer(GL_ARRAY_BUFFER);
+      }
+      break;
+    }
+    case eGLWorkload_Creation:
+    {
+      // one create, initialise and delete counts as one call
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        GLuint buf = 0;
+        GL.glGenBuffers(1, &buf);
+        GL.glBindBuffer(GL_COPY_WRITE_BUFFER, buf);
+        GL.glBufferData(GL_COPY_WRITE_BUFFER, 1024, NULL, GL_STATIC_DRAW);
+        GL.glDeleteBuffers(1, &buf);
+      }
+      break;
+    }
+  }
+}
+
+BenchAPI *CreateGLBench()
+{
+  return new GLBench();
+}
@@ -0,0 +1,361 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// Measures what RenderDoc's wrapping costs per API call. Run it once normally for the unhooked
+// numbers and save them:
+//
+//   overheadbench --out unhooked.json
+//
+// then once under RenderDoc, e.g. with renderdoccmd capture, passing the first results in:
+//
+//   renderdoccmd capture overheadbench --baseline unhooked.json --out hooked.json
+//
+// When RenderDoc is loaded every workload is run twice - once hooked but idle, and once inside
+// an active capture started through the in-application API - and the per-call difference from
+// the baseline is reported alongside the raw times.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "3rdparty/cmdline/cmdline.h"
+#include "overheadbench.h"
+#include "renderdoc_app.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+using std::string;
+using std::vector;
+
+struct BenchResult
+{
+  string api;
+  string workload;
+  string mode;
+  uint32_t callsPerFrame;
+  uint32_t frames;
+  double nsPerCall;    // median frame
+  double nsMin;
+  double nsMean;
+  double nsStddev;
+  bool hasBaseline;
+  double baselineNsPerCall;
+};
+
+static RENDERDOC_API_1_1_1 *GetRenderDoc()
+{
+  pRENDERDOC_GetAPI getAPI = NULL;
+
+#if defined(_WIN32)
+  HMODULE mod = GetModuleHandleA("renderdoc.dll");
+  if(mod)
+    getAPI = (pRENDERDOC_GetAPI)GetProcAddress(mod, "RENDERDOC_GetAPI");
+#else
+  void *mod = dlopen("librenderdoc.so", RTLD_NOW | RTLD_NOLOAD);
+  if(mod)
+    getAPI = (pRENDERDOC_GetAPI)dlsym(mod, "RENDERDOC_GetAPI");
+#endif
+
+  RENDERDOC_API_1_1_1 *rdoc = NULL;
+
+  if(getAPI == NULL || !getAPI(eRENDERDOC_API_Version_1_1_1, (void **)&rdoc))
+    return NULL;
+
+  return rdoc;
+}
+
+static double Now()
+{
+  using namespace std::chrono;
+  return duration<double, std::nano>(high_resolution_clock::now().time_since_epoch()).count();
+}
+
+static BenchResult RunWorkload(BenchAPI *api, uint32_t w, const char *mode, uint32_t warmup,
+                               uint32_t frames, RENDERDOC_API_1_1_1 *rdoc)
+{
+  BenchResult ret;
+  ret.api = api->Name();
+  ret.workload = api->WorkloadName(w);
+  ret.mode = mode;
+  ret.callsPerFrame = api->CallsPerFrame(w);
+  ret.frames = frames;
+  ret.hasBaseline = false;
+  ret.baselineNsPerCall = 0.0;
+
+  for(uint32_t i = 0; i < warmup; i++)
+  {
+    api->Frame(w);
+    api->Present();
+  }
+
+  if(rdoc)
+    rdoc->StartFrameCapture(api->DevicePointer(), api->WindowHandle());
+
+  vector<double> times;
+
+  for(uint32_t i = 0; i < frames; i++)
+  {
+    double start = Now();
+    api->Frame(w);
+    times.push_back((Now() - start) / double(ret.callsPerFrame));
+
+    api->Present();
+  }
+
+  if(rdoc)
+    rdoc->EndFrameCapture(api->DevicePointer(), api->WindowHandle());
+
+  std::sort(times.begin(), times.end());
+
+  double sum = 0.0;
+  for(size_t i = 0; i < times.size(); i++)
+    sum += times[i];
+
+  ret.nsMean = times.empty() ? 0.0 : sum / double(times.size());
+
+  double variance = 0.0;
+  for(size_t i = 0; i < times.size(); i++)
+    variance += (times[i] - ret.nsMean) * (times[i] - ret.nsMean);
+
+  ret.nsStddev = times.empty() ? 0.0 : sqrt(variance / double(times.size()));
+  ret.nsMin = times.empty() ? 0.0 : times[0];
+  ret.nsPerCall = times.empty() ? 0.0 : times[times.size() / 2];
+
+  return ret;
+}
+
+// pull the string value of "key": "value" out of a line
+static bool FindString(const char *line, const char *key, string &value)
+{
+  string search = string("\"") + key + "\": \"";
+  const char *c = strstr(line, search.c_str());
+  if(c == NULL)
+    return false;
+
+  c += search.length();
+  const char *end = strchr(c, '"');
+  if(end == NULL)
+    return false;
+
+  value = string(c, end);
+  return true;
+}
+
+// reads the unhooked results back out of a previous run's output, which has one result per line
+static vector<BenchResult> LoadBaseline(const string &filename)
+{
+  vector<BenchResult> ret;
+
+  FILE *f = fopen(filename.c_str(), "r");
+  if(f == NULL)
+  {
+    std::cerr << "Couldn't open baseline file '" << filename << "'" << std::endl;
+    return ret;
+  }
+
+  char line[1024];
+  while(fgets(line, sizeof(line), f))
+  {
+    BenchResult res;
+
+    if(!FindString(line, "api", res.api) || !FindString(line, "workload", res.workload) ||
+       !FindString(line, "mode", res.mode) || res.mode != "unhooked")
+      continue;
+
+    const char *ns = strstr(line, "\"nsPerCall\": ");
+    if(ns == NULL)
+      continue;
+
+    res.nsPerCall = atof(ns + strlen("\"nsPerCall\": "));
+    ret.push_back(res);
+  }
+
+  fclose(f);
+
+  return ret;
+}
+
+static string ResultJSON(const BenchResult &res)
+{
+  char buf[1024];
+  snprintf(buf, sizeof(buf),
+           "{\"api\": \"%s\", \"workload\": \"%s\", \"mode\": \"%s\", \"callsPerFrame\": %u, "
+           "\"frames\": %u, \"nsPerCall\": %.2f, \"nsMin\": %.2f, \"nsMean\": %.2f, "
+           "\"nsStddev\": %.2f",
+           res.api.c_str(), res.workload.c_str(), res.mode.c_str(), res.callsPerFrame,
+           res.frames, res.nsPerCall, res.nsMin, res.nsMean, res.nsStddev);
+
+  string ret = buf;
+
+  if(res.hasBaseline)
+  {
+    snprintf(buf, sizeof(buf), ", \"baselineNsPerCall\": %.2f, \"overheadNsPerCall\": %.2f",
+             res.baselineNsPerCall, res.nsPerCall - res.baselineNsPerCall);
+    ret += buf;
+  }
+
+  ret += "}";
+
+  return ret;
+}
+
+int main(int argc, char *argv[])
+{
+  cmdline::parser parser;
+  parser.set_program_name("overheadbench");
+  parser.add<string>("api", 'a', "Only run the workloads for this API (gl, vulkan, d3d11, d3d12).",
+                     false);
+  parser.add<uint32_t>("warmup", 'w', "Untimed frames before each workload is timed.", false, 10);
+  parser.add<uint32_t>("frames", 'n', "Timed frames per workload.", false, 100);
+  parser.add<uint32_t>("capture-frames", 'c',
+                       "Timed frames per workload inside an active capture.", false, 10);
+  parser.add<string>("baseline", 'b', "Unhooked results from a previous run to compare against.",
+                     false);
+  parser.add<string>("out", 'o', "Write the JSON results to this file instead of stdout.", false);
+  parser.add("help", '\0', "Print this help message.");
+
+  if(!parser.parse(argc, argv) || parser.exist("help"))
+  {
+    std::cerr << parser.error_full() << parser.usage();
+    return parser.exist("help") ? 0 : 1;
+  }
+
+  RENDERDOC_API_1_1_1 *rdoc = GetRenderDoc();
+
+  if(rdoc)
+  {
+    // the overlay is drawn on every present, which isn't part of the per-call cost we're after
+    rdoc->MaskOverlayBits(eRENDERDOC_Overlay_None, eRENDERDOC_Overlay_None);
+    rdoc->SetCaptureKeys(NULL, 0);
+    rdoc->SetFocusToggleKeys(NULL, 0);
+  }
+
+  vector<BenchResult> baseline;
+  if(parser.exist("baseline"))
+    baseline = LoadBaseline(parser.get<string>("baseline"));
+
+  vector<BenchAPI *> apis;
+  apis.push_back(CreateGLBench());
+  apis.push_back(CreateVulkanBench());
+#if defined(_WIN32)
+  apis.push_back(CreateD3D11Bench());
+  apis.push_back(CreateD3D12Bench());
+#endif
+
+  string onlyAPI = parser.exist("api") ? parser.get<string>("api") : "";
+  std::transform(onlyAPI.begin(), onlyAPI.end(), onlyAPI.begin(), ::tolower);
+
+  uint32_t warmup = parser.get<uint32_t>("warmup");
+  uint32_t frames = parser.get<uint32_t>("frames");
+  uint32_t captureFrames = parser.get<uint32_t>("capture-frames");
+
+  vector<BenchResult> results;
+
+  for(size_t a = 0; a < apis.size(); a++)
+  {
+    BenchAPI *api = apis[a];
+
+    string name = api->Name();
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    if(!onlyAPI.empty() && name != onlyAPI)
+    {
+      delete api;
+      continue;
+    }
+
+    if(!api->Init())
+    {
+      std::cerr << "Skipping " << api->Name() << " workloads" << std::endl;
+      delete api;
+      continue;
+    }
+
+    for(uint32_t w = 0; w < api->NumWorkloads(); w++)
+    {
+      if(rdoc)
+      {
+        results.push_back(RunWorkload(api, w, "idle", warmup, frames, NULL));
+        if(captureFrames > 0)
+          results.push_back(RunWorkload(api, w, "capture", warmup, captureFrames, rdoc));
+      }
+      else
+      {
+        results.push_back(RunWorkload(api, w, "unhooked", warmup, frames, NULL));
+      }
+    }
+
+    api->Shutdown();
+    delete api;
+  }
+
+  for(size_t r = 0; r < results.size(); r++)
+  {
+    for(size_t b = 0; b < baseline.size(); b++)
+    {
+      if(baseline[b].api == results[r].api && baseline[b].workload == results[r].workload)
+      {
+        results[r].hasBaseline = true;
+        results[r].baselineNsPerCall = baseline[b].nsPerCall;
+        break;
+      }
+    }
+  }
+
+  string json = "{\n";
+  json += string("  \"hooked\": ") + (rdoc ? "true" : "false") + ",\n";
+  json += "  \"results\": [\n";
+  for(size_t r = 0; r < results.size(); r++)
+    json += "    " + ResultJSON(results[r]) + (r + 1 < results.size() ? ",\n" : "\n");
+  json += "  ]\n";
+  json += "}\n";
+
+  if(parser.exist("out"))
+  {
+    string outfile = parser.get<string>("out");
+
+    FILE *f = fopen(outfile.c_str(), "wb");
+
+    if(!f)
+    {
+      std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
+      return 1;
+    }
+
+    fwrite(json.c_str(), 1, json.length(), f);
+    fclose(f);
+  }
+  else
+  {
+    std::cout << json;
+  }
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// a set of synthetic workloads on one graphics API. Each workload issues a fixed number of one
+// kind of call per frame, so the time spent in Frame() divided by CallsPerFrame() is the cost of
+// a single call - with or without RenderDoc's wrapping in between.
+class BenchAPI
+{
+public:
+  virtual ~BenchAPI() {}
+  virtual const char *Name() = 0;
+
+  // create the device/context and everything the workloads need. Returns false (with a message
+  // on stderr) if the API isn't available, in which case that API is skipped.
+  virtual bool Init() = 0;
+  virtual void Shutdown() = 0;
+
+  // the device pointer to pass to the in-application API's Start/EndFrameCapture
+  virtual void *DevicePointer() { return NULL; }
+  virtual void *WindowHandle() { return NULL; }
+  virtual uint32_t NumWorkloads() = 0;
+  virtual const char *WorkloadName(uint32_t w) = 0;
+  virtual uint32_t CallsPerFrame(uint32_t w) = 0;
+
+  // issue one frame's worth of the measured call. Only this is timed.
+  virtual void Frame(uint32_t w) = 0;
+
+  // finish the frame - submit, present and wait for the GPU so the next frame starts idle.
+  virtual void Present() = 0;
+};
+
+BenchAPI *CreateGLBench();
+BenchAPI *CreateVulkanBench();
+BenchAPI *CreateD3D11Bench();
+BenchAPI *CreateD3D12Bench();
@@ -0,0 +1,703 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include "overheadbench.h"
+
+#define VK_NO_PROTOTYPES
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "official/vulkan.h"
+
+#define VK_INSTANCE_FUNCS(FUNC)                   \
+  FUNC(vkDestroyInstance);                        \
+  FUNC(vkEnumeratePhysicalDevices);               \
+  FUNC(vkGetPhysicalDeviceProperties);            \
+  FUNC(vkGetPhysicalDeviceQueueFamilyProperties); \
+  FUNC(vkGetPhysicalDeviceMemoryProperties);      \
+  FUNC(vkCreateDevice);                           \
+  FUNC(vkGetDeviceProcAddr);
+
+#define VK_DEVICE_FUNCS(FUNC)          \
+  FUNC(vkDestroyDevice);               \
+  FUNC(vkGetDeviceQueue);              \
+  FUNC(vkQueueSubmit);                 \
+  FUNC(vkQueueWaitIdle);               \
+  FUNC(vkDeviceWaitIdle);              \
+  FUNC(vkCreateCommandPool);           \
+  FUNC(vkDestroyCommandPool);          \
+  FUNC(vkResetCommandPool);            \
+  FUNC(vkAllocateCommandBuffers);      \
+  FUNC(vkBeginCommandBuffer);          \
+  FUNC(vkEndCommandBuffer);            \
+  FUNC(vkCmdBeginRenderPass);          \
+  FUNC(vkCmdEndRenderPass);            \
+  FUNC(vkCmdBindPipeline);             \
+  FUNC(vkCmdDraw);                     \
+  FUNC(vkCreateBuffer);                \
+  FUNC(vkDestroyBuffer);               \
+  FUNC(vkGetBufferMemoryRequirements); \
+  FUNC(vkAllocateMemory);              \
+  FUNC(vkFreeMemory);                  \
+  FUNC(vkBindBufferMemory);            \
+  FUNC(vkMapMemory);                   \
+  FUNC(vkUnmapMemory);                 \
+  FUNC(vkCreateDescriptorSetLayout);   \
+  FUNC(vkDestroyDescriptorSetLayout);  \
+  FUNC(vkCreateDescriptorPool);        \
+  FUNC(vkDestroyDescriptorPool);       \
+  FUNC(vkAllocateDescriptorSets);      \
+  FUNC(vkUpdateDescriptorSets);        \
+  FUNC(vkCreatePipelineLayout);        \
+  FUNC(vkDestroyPipelineLayout);       \
+  FUNC(vkCreateShaderModule);          \
+  FUNC(vkDestroyShaderModule);         \
+  FUNC(vkCreateRenderPass);            \
+  FUNC(vkDestroyRenderPass);           \
+  FUNC(vkCreateFramebuffer);           \
+  FUNC(vkDestroyFramebuffer);          \
+  FUNC(vkCreateGraphicsPipelines);     \
+  FUNC(vkDestroyPipeline);
+
+struct VkFunctions
+{
+#define DECLARE_FUNC(name) PFN_##name name
+  DECLARE_FUNC(vkGetInstanceProcAddr);
+  DECLARE_FUNC(vkCreateInstance);
+  VK_INSTANCE_FUNCS(DECLARE_FUNC)
+  VK_DEVICE_FUNCS(DECLARE_FUNC)
+#undef DECLARE_FUNC
+};
+
+// a vertex shader that only writes a constant position - the draws are rasterizer-discarded so
+// there's no need for a fragment shader or any attachments:
+//
+// OpCapability Shader
+// OpMemoryModel Logical GLSL450
+// OpEntryPoint Vertex %main "main" %pos
+// OpDecorate %pos BuiltIn Position
+// %void = OpTypeVoid
+// %fn = OpTypeFunction %void
+// %float = OpTypeFloat 32
+// %v4 = OpTypeVector %float 4
+// %ptr = OpTypePointer Output %v4
+// %pos = OpVariable %ptr Output
+// %zero = OpConstantNull %v4
+// %main = OpFunction %void None %fn
+// %label = OpLabel
+// OpStore %pos %zero
+// OpReturn
+// OpFunctionEnd
+static const uint32_t vertexSPIRV[] = {
+    0x07230203, 0x00010000, 0x00000000, 10, 0x00000000,
+    // OpCapability Shader
+    0x00020011, 1,
+    // OpMemoryModel Logical GLSL450
+    0x0003000E, 0, 1,
+    // OpEntryPoint Vertex %8 "main" %6
+    0x0006000F, 0, 8, 0x6E69616D, 0x00000000, 6,
+    // OpDecorate %6 BuiltIn Position
+    0x00040047, 6, 11, 0,
+    // %1 = OpTypeVoid
+    0x00020013, 1,
+    // %2 = OpTypeFunction %1
+    0x00030021, 2, 1,
+    // %3 = OpTypeFloat 32
+    0x00030016, 3, 32,
+    // %4 = OpTypeVector %3 4
+    0x00040017, 4, 3, 4,
+    // %5 = OpTypePointer Output %4
+    0x00040020, 5, 3, 4,
+    // %6 = OpVariable %5 Output
+    0x0004003B, 5, 6, 3,
+    // %7 = OpConstantNull %4
+    0x0003002E, 4, 7,
+    // %8 = OpFunction %1 None %2
+    0x00050036, 1, 8, 0, 2,
+    // %9 = OpLabel
+    0x000200F8, 9,
+    // OpStore %6 %7
+    0x0003003E, 6, 7,
+    // OpReturn
+    0x000100FD,
+    // OpFunctionEnd
+    0x00010038,
+};
+
+enum VkWorkload
+{
+  eVkWorkload_Draws,
+  eVkWorkload_DescriptorUpdates,
+  eVkWorkload_Maps,
+  eVkWorkload_Creation,
+  eVkWorkload_Count,
+};
+
+static const uint32_t VkCallsPerFrame[eVkWorkload_Count] = {10000, 10000, 1000, 1000};
+
+static const char *VkWorkloadNames[eVkWorkload_Count] = {
+    "draws", "descriptor_updates", "maps", "resource_creation",
+};
+
+static const uint32_t UniformSlices = 64;
+
+class VulkanBench : public BenchAPI
+{
+public:
+  VulkanBench()
+  {
+    memset(&VK, 0, sizeof(VK));
+    m_Module = NULL;
+    m_Instance = VK_NULL_HANDLE;
+    m_PhysDev = VK_NULL_HANDLE;
+    m_Device = VK_NULL_HANDLE;
+    m_Queue = VK_NULL_HANDLE;
+    m_QueueFamily = 0;
+    m_HostMemType = 0;
+    m_CmdPool = VK_NULL_HANDLE;
+    m_Cmd = VK_NULL_HANDLE;
+    m_Recorded = false;
+    m_Buffer = VK_NULL_HANDLE;
+    m_Memory = VK_NULL_HANDLE;
+    m_SetLayout = VK_NULL_HANDLE;
+    m_DescPool = VK_NULL_HANDLE;
+    m_Set = VK_NULL_HANDLE;
+    m_PipeLayout = VK_NULL_HANDLE;
+    m_RenderPass = VK_NULL_HANDLE;
+    m_Framebuffer = VK_NULL_HANDLE;
+    m_Pipeline = VK_NULL_HANDLE;
+  }
+
+  const char *Name() { return "Vulkan"; }
+  bool Init();
+  void Shutdown();
+  uint32_t NumWorkloads() { return eVkWorkload_Count; }
+  const char *WorkloadName(uint32_t w) { return VkWorkloadNames[w]; }
+  uint32_t CallsPerFrame(uint32_t w) { return VkCallsPerFrame[w]; }
+  void Frame(uint32_t w);
+  void Present();
+
+private:
+  bool LoadLoader();
+  bool CreateDevice();
+  bool CreateObjects();
+
+  VkFunctions VK;
+
+  void *m_Module;
+
+  VkInstance m_Instance;
+  VkPhysicalDevice m_PhysDev;
+  VkDevice m_Device;
+  VkQueue m_Queue;
+  uint32_t m_QueueFamily;
+  uint32_t m_HostMemType;
+
+  VkCommandPool m_CmdPool;
+  VkCommandBuffer m_Cmd;
+  bool m_Recorded;
+
+  VkBuffer m_Buffer;
+  VkDeviceMemory m_Memory;
+
+  VkDescriptorSetLayout m_SetLayout;
+  VkDescriptorPool m_DescPool;
+  VkDescriptorSet m_Set;
+  VkPipelineLayout m_PipeLayout;
+  VkRenderPass m_RenderPass;
+  VkFramebuffer m_Framebuffer;
+  VkPipeline m_Pipeline;
+};
+
+bool VulkanBench::LoadLoader()
+{
+#if defined(_WIN32)
+  HMODULE mod = LoadLibraryA("vulkan-1.dll");
+  m_Module = (void *)mod;
+  if(mod)
+    VK.vkGetInstanceProcAddr =
+        (PFN_vkGetInstanceProcAddr)GetProcAddress(mod, "vkGetInstanceProcAddr");
+#else
+  m_Module = dlopen("libvulkan.so.1", RTLD_NOW);
+  if(m_Module)
+    VK.vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(m_Module, "vkGetInstanceProcAddr");
+#endif
+
+  if(VK.vkGetInstanceProcAddr == NULL)
+  {
+    std::cerr << "Couldn't load the Vulkan loader" << std::endl;
+    return false;
+  }
+
+  VK.vkCreateInstance =
+      (PFN_vkCreateInstance)VK.vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance");
+
+  return VK.vkCreateInstance != NULL;
+}
+
+bool VulkanBench::CreateDevice()
+{
+  VkApplicationInfo app = {VK_STRUCTURE_TYPE_APPLICATION_INFO};
+  app.pApplicationName = "overheadbench";
+  app.apiVersion = VK_API_VERSION_1_0;
+
+  VkInstanceCreateInfo instInfo = {VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+  instInfo.pApplicationInfo = &app;
+
+  VkResult vkr = VK.vkCreateInstance(&instInfo, NULL, &m_Instance);
+
+  if(vkr != VK_SUCCESS)
+  {
+    std::cerr << "Couldn't create a Vulkan instance: " << vkr << std::endl;
+    return false;
+  }
+
+#define FETCH_FUNC(name)                                                  \
+  VK.name = (PFN_##name)VK.vkGetInstanceProcAddr(m_Instance, #name);      \
+  if(VK.name == NULL)                                                     \
+  {                                                                       \
+    std::cerr << "Couldn't fetch Vulkan function " << #name << std::endl; \
+    return false;                                                         \
+  }
+
+  VK_INSTANCE_FUNCS(FETCH_FUNC)
+
+#undef FETCH_FUNC
+
+  uint32_t count = 1;
+  vkr = VK.vkEnumeratePhysicalDevices(m_Instance, &count, &m_PhysDev);
+
+  if((vkr != VK_SUCCESS && vkr != VK_INCOMPLETE) || count == 0)
+  {
+    std::cerr << "Couldn't find a Vulkan physical device" << std::endl;
+    return false;
+  }
+
+  VkPhysicalDeviceProperties props;
+  VK.vkGetPhysicalDeviceProperties(m_PhysDev, &props);
+
+  std::cerr << "Vulkan device: " << props.deviceName << std::endl;
+
+  VkQueueFamilyProperties families[16];
+  count = 16;
+  VK.vkGetPhysicalDeviceQueueFamilyProperties(m_PhysDev, &count, families);
+
+  m_QueueFamily = ~0U;
+  for(uint32_t i = 0; i < count; i++)
+  {
+    if(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+    {
+      m_QueueFamily = i;
+      break;
+    }
+  }
+
+  if(m_QueueFamily == ~0U)
+  {
+    std::cerr << "Couldn't find a Vulkan graphics queue" << std::endl;
+    return false;
+  }
+
+  VkPhysicalDeviceMemoryProperties memProps;
+  VK.vkGetPhysicalDeviceMemoryProperties(m_PhysDev, &memProps);
+
+  const VkMemoryPropertyFlags hostFlags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+  m_HostMemType = ~0U;
+  for(uint32_t i = 0; i < memProps.memoryTypeCount; i++)
+  {
+    if((memProps.memoryTypes[i].propertyFlags & hostFlags) == hostFlags)
+    {
+      m_HostMemType = i;
+      break;
+    }
+  }
+
+  if(m_HostMemType == ~0U)
+  {
+    std::cerr << "Couldn't find a host-visible Vulkan memory type" << std::endl;
+    return false;
+  }
+
+  float priority = 1.0f;
+
+  VkDeviceQueueCreateInfo queueInfo = {VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+  queueInfo.queueFamilyIndex = m_QueueFamily;
+  queueInfo.queueCount = 1;
+  queueInfo.pQueuePriorities = &priority;
+
+  VkDeviceCreateInfo devInfo = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+  devInfo.queueCreateInfoCount = 1;
+  devInfo.pQueueCreateInfos = &queueInfo;
+
+  vkr = VK.vkCreateDevice(m_PhysDev, &devInfo, NULL, &m_Device);
+
+  if(vkr != VK_SUCCESS)
+  {
+    std::cerr << "Couldn't create a Vulkan device: " << vkr << std::endl;
+    return false;
+  }
+
+#define FETCH_FUNC(name)                                                  \
+  VK.name = (PFN_##name)VK.vkGetDeviceProcAddr(m_Device, #name);          \
+  if(VK.name == NULL)                                                     \
+  {                                                                       \
+    std::cerr << "Couldn't fetch Vulkan function " << #name << std::endl; \
+    return false;                                                         \
+  }
+
+  VK_DEVICE_FUNCS(FETCH_FUNC)
+
+#undef FETCH_FUNC
+
+  VK.vkGetDeviceQueue(m_Device, m_QueueFamily, 0, &m_Queue);
+
+  return true;
+}
+
+bool VulkanBench::CreateObjects()
+{
+  VkCommandPoolCreateInfo poolInfo = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  poolInfo.queueFamilyIndex = m_QueueFamily;
+
+  if(VK.vkCreateCommandPool(m_Device, &poolInfo, NULL, &m_CmdPool) != VK_SUCCESS)
+    return false;
+
+  VkCommandBufferAllocateInfo cmdInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+  cmdInfo.commandPool = m_CmdPool;
+  cmdInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  cmdInfo.commandBufferCount = 1;
+
+  if(VK.vkAllocateCommandBuffers(m_Device, &cmdInfo, &m_Cmd) != VK_SUCCESS)
+    return false;
+
+  // one buffer serves as the uniform buffer for descriptor updates and as the mapped buffer
+  VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+  bufInfo.size = 256 * UniformSlices;
+  bufInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+  if(VK.vkCreateBuffer(m_Device, &bufInfo, NULL, &m_Buffer) != VK_SUCCESS)
+    return false;
+
+  VkMemoryRequirements mrq;
+  VK.vkGetBufferMemoryRequirements(m_Device, m_Buffer, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+  allocInfo.allocationSize = mrq.size;
+  allocInfo.memoryTypeIndex = m_HostMemType;
+
+  if(VK.vkAllocateMemory(m_Device, &allocInfo, NULL, &m_Memory) != VK_SUCCESS)
+    return false;
+
+  if(VK.vkBindBufferMemory(m_Device, m_Buffer, m_Memory, 0) != VK_SUCCESS)
+    return false;
+
+  VkDescriptorSetLayoutBinding binding = {};
+  binding.binding = 0;
+  binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  binding.descriptorCount = 1;
+  binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+  layoutInfo.bindingCount = 1;
+  layoutInfo.pBindings = &binding;
+
+  if(VK.vkCreateDescriptorSetLayout(m_Device, &layoutInfo, NULL, &m_SetLayout) != VK_SUCCESS)
+    return false;
+
+  VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1};
+
+  VkDescriptorPoolCreateInfo descPoolInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+  descPoolInfo.maxSets = 1;
+  descPoolInfo.poolSizeCount = 1;
+  descPoolInfo.pPoolSizes = &poolSize;
+
+  if(VK.vkCreateDescriptorPool(m_Device, &descPoolInfo, NULL, &m_DescPool) != VK_SUCCESS)
+    return false;
+
+  VkDescriptorSetAllocateInfo setInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+  setInfo.descriptorPool = m_DescPool;
+  setInfo.descriptorSetCount = 1;
+  setInfo.pSetLayouts = &m_SetLayout;
+
+  if(VK.vkAllocateDescriptorSets(m_Device, &setInfo, &m_Set) != VK_SUCCESS)
+    return false;
+
+  VkPipelineLayoutCreateInfo pipeLayoutInfo = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+  pipeLayoutInfo.setLayoutCount = 1;
+  pipeLayoutInfo.pSetLayouts = &m_SetLayout;
+
+  if(VK.vkCreatePipelineLayout(m_Device, &pipeLayoutInfo, NULL, &m_PipeLayout) != VK_SUCCESS)
+    return false;
+
+  VkSubpassDescription subpass = {};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+  VkRenderPassCreateInfo rpInfo = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+  rpInfo.subpassCount = 1;
+  rpInfo.pSubpasses = &subpass;
+
+  if(VK.vkCreateRenderPass(m_Device, &rpInfo, NULL, &m_RenderPass) != VK_SUCCESS)
+    return false;
+
+  VkFramebufferCreateInfo fbInfo = {VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+  fbInfo.renderPass = m_RenderPass;
+  fbInfo.width = 64;
+  fbInfo.height = 64;
+  fbInfo.layers = 1;
+
+  if(VK.vkCreateFramebuffer(m_Device, &fbInfo, NULL, &m_Framebuffer) != VK_SUCCESS)
+    return false;
+
+  VkShaderModuleCreateInfo moduleInfo = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+  moduleInfo.codeSize = sizeof(vertexSPIRV);
+  moduleInfo.pCode = vertexSPIRV;
+
+  VkShaderModule module = VK_NULL_HANDLE;
+  if(VK.vkCreateShaderModule(m_Device, &moduleInfo, NULL, &module) != VK_SUCCESS)
+    return false;
+
+  VkPipelineShaderStageCreateInfo stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+  stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+  stage.module = module;
+  stage.pName = "main";
+
+  VkPipelineVertexInputStateCreateInfo vertexInput = {
+      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
+      VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+  inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+
+  VkPipelineRasterizationStateCreateInfo raster = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+  raster.rasterizerDiscardEnable = VK_TRUE;
+  raster.polygonMode = VK_POLYGON_MODE_FILL;
+  raster.lineWidth = 1.0f;
+
+  VkGraphicsPipelineCreateInfo pipeInfo = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+  pipeInfo.stageCount = 1;
+  pipeInfo.pStages = &stage;
+  pipeInfo.pVertexInputState = &vertexInput;
+  pipeInfo.pInputAssemblyState = &inputAssembly;
+  pipeInfo.pRasterizationState = &raster;
+  pipeInfo.layout = m_PipeLayout;
+  pipeInfo.renderPass = m_RenderPass;
+
+  VkResult vkr =
+      VK.vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &pipeInfo, NULL, &m_Pipeline);
+
+  VK.vkDestroyShaderModule(m_Device, module, NULL);
+
+  return vkr == VK_SUCCESS;
+}
+
+bool VulkanBench::Init()
+{
+  if(!LoadLoader() || !CreateDevice())
+  {
+    Shutdown();
+    return false;
+  }
+
+  if(!CreateObjects())
+  {
+    std::cerr << "Couldn't create the Vulkan benchmark objects" << std::endl;
+    Shutdown();
+    return false;
+  }
+
+  return true;
+}
+
+void VulkanBench::Shutdown()
+{
+  // vkDestroyPipeline is fetched last, so if it's present all the device functions are
+  if(m_Device && VK.vkDestroyPipeline)
+  {
+    VK.vkDeviceWaitIdle(m_Device);
+
+    if(m_Pipeline)
+      VK.vkDestroyPipeline(m_Device, m_Pipeline, NULL);
+    if(m_Framebuffer)
+      VK.vkDestroyFramebuffer(m_Device, m_Framebuffer, NULL);
+    if(m_RenderPass)
+      VK.vkDestroyRenderPass(m_Device, m_RenderPass, NULL);
+    if(m_PipeLayout)
+      VK.vkDestroyPipelineLayout(m_Device, m_PipeLayout, NULL);
+    if(m_DescPool)
+      VK.vkDestroyDescriptorPool(m_Device, m_DescPool, NULL);
+    if(m_SetLayout)
+      VK.vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, NULL);
+    if(m_Buffer)
+      VK.vkDestroyBuffer(m_Device, m_Buffer, NULL);
+    if(m_Memory)
+      VK.vkFreeMemory(m_Device, m_Memory, NULL);
+    if(m_CmdPool)
+      VK.vkDestroyCommandPool(m_Device, m_CmdPool, NULL);
+  }
+
+  if(m_Device && VK.vkDestroyDevice)
+    VK.vkDestroyDevice(m_Device, NULL);
+
+  if(m_Instance && VK.vkDestroyInstance)
+    VK.vkDestroyInstance(m_Instance, NULL);
+
+#if defined(_WIN32)
+  if(m_Module)
+    FreeLibrary((HMODULE)m_Module);
+#else
+  if(m_Module)
+    dlclose(m_Module);
+#endif
+
+  // reset everything back to the initial state
+  *this = VulkanBench();
+}
+
+void VulkanBench::Frame(uint32_t w)
+{
+  const uint32_t calls = VkCallsPerFrame[w];
+
+  switch(w)
+  {
+    case eVkWorkload_Draws:
+    {
+      VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+      beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+      VK.vkBeginCommandBuffer(m_Cmd, &beginInfo);
+
+      VkRenderPassBeginInfo rpBegin = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+      rpBegin.renderPass = m_RenderPass;
+      rpBegin.framebuffer = m_Framebuffer;
+      rpBegin.renderArea.extent.width = 64;
+      rpBegin.renderArea.extent.height = 64;
+
+      VK.vkCmdBeginRenderPass(m_Cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+      VK.vkCmdBindPipeline(m_Cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+
+      for(uint32_t i = 0; i < calls; i++)
+        VK.vkCmdDraw(m_Cmd, 1, 1, i % 64, 0);
+
+      VK.vkCmdEndRenderPass(m_Cmd);
+      VK.vkEndCommandBuffer(m_Cmd);
+
+      m_Recorded = true;
+      break;
+    }
+    case eVkWorkload_DescriptorUpdates:
+    {
+      VkDescriptorBufferInfo bufInfo = {m_Buffer, 0, 256};
+
+      VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      write.dstSet = m_Set;
+      write.dstBinding = 0;
+      write.descriptorCount = 1;
+      write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+      write.pBufferInfo = &bufInfo;
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        bufInfo.offset = (i % UniformSlices) * 256;
+        VK.vkUpdateDescriptorSets(m_Device, 1, &write, 0, NULL);
+      }
+      break;
+    }
+    case eVkWorkload_Maps:
+    {
+      // a map/unmap pair counts as one call
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        void *ptr = NULL;
+        VK.vkMapMemory(m_Device, m_Memory, (i % UniformSlices) * 256, 256, 0, &ptr);
+        if(ptr)
+          memset(ptr, i & 0xff, 256);
+        VK.vkUnmapMemory(m_Device, m_Memory);
+      }
+      break;
+    }
+    case eVkWorkload_Creation:
+    {
+      // one buffer create, allocate, bind and destroy counts as one call
+      VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+      bufInfo.size = 1024;
+      bufInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+      for(uint32_t i = 0; i < calls; i++)
+      {
+        VkBuffer buf = VK_NULL_HANDLE;
+        VK.vkCreateBuffer(m_Device, &bufInfo, NULL, &buf);
+
+        VkMemoryRequirements mrq;
+        VK.vkGetBufferMemoryRequirements(m_Device, buf, &mrq);
+
+        VkMemoryAllocateInfo allocInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        allocInfo.allocationSize = mrq.size;
+        allocInfo.memoryTypeIndex = m_HostMemType;
+
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        VK.vkAllocateMemory(m_Device, &allocInfo, NULL, &mem);
+        VK.vkBindBufferMemory(m_Device, buf, mem, 0);
+
+        VK.vkDestroyBuffer(m_Device, buf, NULL);
+        VK.vkFreeMemory(m_Device, mem, NULL);
+      }
+      break;
+    }
+  }
+}
+
+void VulkanBench::Present()
+{
+  // there's no swapchain, so a frame ends with a submit and a wait for idle
+  if(m_Recorded)
+  {
+    VkSubmitInfo submit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &m_Cmd;
+
+    VK.vkQueueSubmit(m_Queue, 1, &submit, VK_NULL_HANDLE);
+  }
+
+  VK.vkQueueWaitIdle(m_Queue);
+
+  if(m_Recorded)
+    VK.vkResetCommandPool(m_Device, m_CmdPool, 0);
+
+  m_Recorded = false;
+}
+
+BenchAPI *CreateVulkanBench()
+{
+  return new VulkanBench();
+}
@@ -208,12 +208,19 @@ void CaptureContext::LoadLogfileThreaded(const QString &logFile, const QString &
 
   m_EventID = 0;
 
-  // fetch initial data like drawcalls, textures and buffers
+  // fetch the frame info and drawcalls first, everything else can be fetched while the views
+  // that only need those get set up
   m_Renderer.BlockInvoke([this](IReplayRenderer *r) {
     r->GetFrameInfo(&m_FrameInfo);
 
     m_APIProps = r->GetAPIProperties();
 
+    // cached data beyond these budgets is freed as the replay moves between events, 0 is no limit
+    r->SetMemoryBudget(eReplayMemory_PostVSCache,
+                       uint64_t(qMax(0, Config.Replay_PostVSCacheBudgetMB)) * 1024 * 1024);
+    r->SetMemoryBudget(eReplayMemory_ProxyResources,
+                       uint64_t(qMax(0, Config.Replay_ProxyCacheBudgetMB)) * 1024 * 1024);
+
     m_PostloadProgress = 0.2f;
 
     r->GetDrawcalls(&m_Drawcalls);
@@ -244,7 +251,9 @@ void CaptureContext::LoadLogfileThreaded(const QString &logFile, const QString &
     else
       m_X11Display = QX11Info::display();
 #endif
+  });
 
+  RenderManager::InvokeHandlePtr resources = m_Renderer.AsyncInvoke([this](IReplayRenderer *r) {
     r->GetBuffers(&m_BufferList);
     for(FetchBuffer &b : m_BufferList)
       m_Buffers[b.ID] = &b;
@@ -260,7 +269,7 @@ void CaptureContext::LoadLogfileThreaded(const QString &logFile, const QString &
     r->GetD3D11PipelineState(&CurD3D11PipelineState);
     r->GetD3D12PipelineState(&CurD3D12PipelineState);
     r->GetGLPipelineState(&CurGLPipelineState);
-    r->GetVulkanPipelineState(&CurVulkanPipelineState);
+    r->GetVulkanPipelineStatePaged(&CurVulkanPipelineState, VulkanDescriptorPageSize);
     CurPipelineState.SetStates(m_APIProps, &CurD3D11PipelineState, &CurD3D12PipelineState,
                                &CurGLPipelineState, &CurVulkanPipelineState);
 
@@ -270,6 +279,20 @@ void CaptureContext::LoadLogfileThreaded(const QString &logFile, const QString &
     m_PostloadProgress = 1.0f;
   });
 
+  {
+    QVector<ILogViewerForm *> logviewers(m_LogViewers);
+
+    GUIInvoke::blockcall([&logviewers]() {
+      for(ILogViewerForm *logviewer : logviewers)
+      {
+        if(logviewer)
+          logviewer->OnDrawcallsLoaded();
+      }
+    });
+  }
+
+  resources->wait();
+
   QThread::msleep(20);
 
   QDateTime today = QDateTime::currentDateTimeUtc();
@@ -565,7 +588,7 @@ void CaptureContext::SetEventID(const QVector<ILogViewerForm *> &exclude, uint32
     r->GetD3D11PipelineState(&CurD3D11PipelineState);
     r->GetD3D12PipelineState(&CurD3D12PipelineState);
     r->GetGLPipelineState(&CurGLPipelineState);
-    r->GetVulkanPipelineState(&CurVulkanPipelineState);
+    r->GetVulkanPipelineStatePaged(&CurVulkanPipelineState, VulkanDescriptorPageSize);
     CurPipelineState.SetStates(m_APIProps, &CurD3D11PipelineState, &CurD3D12PipelineState,
                                &CurGLPipelineState, &CurVulkanPipelineState);
   });
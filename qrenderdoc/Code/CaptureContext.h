@@ -43,6 +43,12 @@ struct ILogViewerForm
   virtual void OnLogfileLoaded() = 0;
   virtual void OnLogfileClosed() = 0;
 
+  // called part way through loading, once the frame info and drawcalls are available but while
+  // the textures, buffers and pipeline state are still being fetched. Views that only need the
+  // drawcalls can do their setup here, so that it overlaps with the rest of the load instead of
+  // following it. OnLogfileLoaded is still called once everything is available.
+  virtual void OnDrawcallsLoaded() {}
+
   // These 2 functions distinguish between the event which is actually
   // selected and the event which the displayed state should be taken from. In
   // the case of an event with children, OnSelectedEventChanged receives the
@@ -94,6 +100,7 @@ public:
 
     if(LogLoaded())
     {
+      f->OnDrawcallsLoaded();
       f->OnLogfileLoaded();
       f->OnEventChanged(CurEvent());
     }
@@ -167,7 +174,10 @@ public:
   D3D11PipelineState CurD3D11PipelineState;
   D3D12PipelineState CurD3D12PipelineState;
   GLPipelineState CurGLPipelineState;
+  // large descriptor arrays only hold their first page of elements, the rest are fetched with
+  // IReplayRenderer::GetVulkanDescriptorBindings as they're displayed.
   VulkanPipelineState CurVulkanPipelineState;
+  static const uint32_t VulkanDescriptorPageSize = 256;
   CommonPipelineState CurPipelineState;
 
   PersistantConfig &Config;
@@ -900,13 +900,19 @@ void CommonPipelineState::GetConstantBuffer(ShaderStageType stage, uint32_t BufI
           return;
         }
 
-        auto &descriptorBind = pipe.DescSets[bind.bindset].bindings[bind.bind].binds[ArrayIdx];
+        auto &binds = pipe.DescSets[bind.bindset].bindings[bind.bind].binds;
 
-        buf = descriptorBind.res;
-        ByteOffset = descriptorBind.offset;
-        ByteSize = descriptorBind.size;
+        // only the first page of a large descriptor array is in the pipeline state
+        if(ArrayIdx < (uint32_t)binds.count)
+        {
+          auto &descriptorBind = binds[ArrayIdx];
 
-        return;
+          buf = descriptorBind.res;
+          ByteOffset = descriptorBind.offset;
+          ByteSize = descriptorBind.size;
+
+          return;
+        }
       }
     }
   }
@@ -1001,7 +1007,8 @@ QMap<BindpointMap, QVector<BoundResource>> CommonPipelineState::GetReadOnlyResou
             BindpointMap key(set, slot);
             QVector<BoundResource> val(bind.descriptorCount);
 
-            for(uint32_t i = 0; i < bind.descriptorCount; i++)
+            // elements past the first page of a large array are left unbound
+            for(uint32_t i = 0; i < qMin(bind.descriptorCount, (uint32_t)bind.binds.count); i++)
             {
               val[i].Id = bind.binds[i].res;
               val[i].HighestMip = (int)bind.binds[i].baseMip;
@@ -1128,7 +1135,7 @@ QMap<BindpointMap, QVector<BoundResource>> CommonPipelineState::GetReadWriteReso
             BindpointMap key(set, slot);
             QVector<BoundResource> val(bind.descriptorCount);
 
-            for(uint32_t i = 0; i < bind.descriptorCount; i++)
+            for(uint32_t i = 0; i < qMin(bind.descriptorCount, (uint32_t)bind.binds.count); i++)
             {
               val[i].Id = bind.binds[i].res;
               val[i].HighestMip = (int)bind.binds[i].baseMip;
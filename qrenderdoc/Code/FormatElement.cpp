@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <limits>
 #include <QRegularExpression>
 #include <QtMath>
 #include "QRDUtils.h"
@@ -751,6 +752,190 @@ QVariantList FormatElement::GetVariants(const byte *&data, const byte *end) cons
   return ret;
 }
 
+// the type and number of the values GetVariants returns for a format
+static VarType DecodedType(const ResourceFormat &f)
+{
+  if(f.special && f.specialFormat != eSpecial_R10G10B10A2)
+    return eVar_Float;
+
+  if(f.compType == eCompType_UInt)
+    return eVar_UInt;
+  if(f.compType == eCompType_SInt)
+    return eVar_Int;
+
+  return eVar_Float;
+}
+
+static uint32_t DecodedComponentCount(const FormatElement &el)
+{
+  if(el.format.special)
+  {
+    switch(el.format.specialFormat)
+    {
+      case eSpecial_R5G5B5A1:
+      case eSpecial_R4G4B4A4: return 4;
+      case eSpecial_R5G6B5:
+      case eSpecial_R11G11B10: return 3;
+      case eSpecial_R10G10B10A2: return (el.format.compCount / 4) * 4;
+      default: break;
+    }
+  }
+
+  return qMax(el.matrixdim, 1U) * el.format.compCount;
+}
+
+// converts numComps components of type T from each element, with the same arithmetic as
+// GetVariants and interpret() so the results are identical. NULL elements are skipped
+template <typename T>
+static void DecodeComponents(const QVector<const byte *> &elems, uint32_t numComps,
+                             CompType compType, double *out)
+{
+  const float maxVal = (float)(std::numeric_limits<T>::max)();
+  const T minVal = (std::numeric_limits<T>::min)();
+
+  for(int i = 0; i < elems.count(); i++, out += numComps)
+  {
+    const byte *src = elems[i];
+
+    if(src == NULL)
+      continue;
+
+    for(uint32_t c = 0; c < numComps; c++)
+    {
+      T val;
+      memcpy(&val, src + c * sizeof(T), sizeof(T));
+
+      if(compType == eCompType_UNorm)
+        out[c] = (float)val / maxVal;
+      else if(compType == eCompType_SNorm)
+        out[c] = val == minVal ? -1.0f : (float)val / maxVal;
+      else if(compType == eCompType_UScaled || compType == eCompType_SScaled)
+        out[c] = (float)val;
+      else
+        out[c] = (double)val;
+    }
+  }
+}
+
+void FormatElement::DecodeElements(const byte *data, const byte *end, size_t stride,
+                                   const uint32_t *indices, int count, DecodedElements &out) const
+{
+  out.type = DecodedType(format);
+  out.compCount = DecodedComponentCount(*this);
+  out.values.fill(0.0, count * out.compCount);
+  out.valid.fill(false, count);
+
+  const uint32_t width = format.compByteWidth;
+  const CompType type = format.compType;
+
+  bool isSigned =
+      (type == eCompType_SInt || type == eCompType_SNorm || type == eCompType_SScaled);
+  bool isNorm = (type == eCompType_UNorm || type == eCompType_SNorm);
+  bool isInt = (type == eCompType_UInt || type == eCompType_SInt || type == eCompType_UScaled ||
+                type == eCompType_SScaled);
+
+  // anything else is rare enough to go through GetVariants one element at a time
+  bool columnar = !format.special && ((type == eCompType_Float && (width % 2) == 0) ||
+                                      (type == eCompType_Double && width == 8) ||
+                                      (isInt && width <= 4 && width != 3) ||
+                                      (isNorm && width <= 2));
+
+  if(!columnar)
+  {
+    for(int i = 0; i < count; i++)
+    {
+      if(indices[i] == ~0U)
+        continue;
+
+      const byte *src = data + stride * indices[i];
+      QVariantList list = GetVariants(src, end);
+
+      if(list.isEmpty())
+        continue;
+
+      out.valid[i] = true;
+
+      double *dst = out.values.data() + i * out.compCount;
+      for(int c = 0; c < list.count() && c < (int)out.compCount; c++)
+        dst[c] = list[c].toDouble();
+    }
+
+    return;
+  }
+
+  const uint32_t numComps = out.compCount;
+  const size_t elemSize = numComps * width;
+
+  QVector<const byte *> elems(count, NULL);
+
+  for(int i = 0; i < count; i++)
+  {
+    if(indices[i] == ~0U)
+      continue;
+
+    const byte *src = data + stride * indices[i];
+
+    if(src + elemSize <= end)
+    {
+      elems[i] = src;
+      out.valid[i] = true;
+    }
+  }
+
+  double *values = out.values.data();
+
+  if(type == eCompType_Float && width == 2)
+  {
+    // gather the halves into one contiguous stream so they can be converted in a single batch
+    QVector<uint16_t> halves(count * numComps, 0);
+
+    for(int i = 0; i < count; i++)
+      if(elems[i])
+        memcpy(halves.data() + i * numComps, elems[i], elemSize);
+
+    QVector<float> floats(halves.count());
+    Maths_HalfToFloatArray(halves.data(), floats.data(), (uint32_t)halves.count());
+
+    for(int i = 0; i < floats.count(); i++)
+      values[i] = floats[i];
+  }
+  else if(width == 8)
+  {
+    DecodeComponents<double>(elems, numComps, type, values);
+  }
+  else if(type == eCompType_Float)
+  {
+    DecodeComponents<float>(elems, numComps, type, values);
+  }
+  else if(width == 4)
+  {
+    if(isSigned)
+      DecodeComponents<int32_t>(elems, numComps, type, values);
+    else
+      DecodeComponents<uint32_t>(elems, numComps, type, values);
+  }
+  else if(width == 2)
+  {
+    if(isSigned)
+      DecodeComponents<int16_t>(elems, numComps, type, values);
+    else
+      DecodeComponents<uint16_t>(elems, numComps, type, values);
+  }
+  else
+  {
+    if(isSigned)
+      DecodeComponents<int8_t>(elems, numComps, type, values);
+    else
+      DecodeComponents<uint8_t>(elems, numComps, type, values);
+  }
+
+  if(format.bgraOrder && numComps >= 3)
+  {
+    for(int i = 0; i < count; i++)
+      qSwap(values[i * numComps + 0], values[i * numComps + 2]);
+  }
+}
+
 ShaderVariable FormatElement::GetShaderVar(const byte *&data, const byte *end) const
 {
   QVariantList objs = GetVariants(data, end);
@@ -98,6 +98,10 @@ struct SPIRVDisassembler
                                                                                            \
   CONFIG_SETTING_VAL(public, int, int, LocalProxyAPI, -1)                                  \
                                                                                            \
+  CONFIG_SETTING_VAL(public, int, int, Replay_PostVSCacheBudgetMB, 0)                      \
+                                                                                           \
+  CONFIG_SETTING_VAL(public, int, int, Replay_ProxyCacheBudgetMB, 0)                       \
+                                                                                           \
   CONFIG_SETTING_VAL(public, int, TimeUnit, EventBrowser_TimeUnit, TimeUnit::Microseconds) \
                                                                                            \
   CONFIG_SETTING_VAL(public, bool, bool, EventBrowser_HideEmpty, false)                    \
@@ -414,6 +414,19 @@ QString ToQStr(const ResourceUsage usage, const GraphicsAPI apitype);
 // overload for a couple of things that need to know the pipeline type when converting
 QString ToQStr(const ShaderStageType stage, const GraphicsAPI apitype);
 
+// a run of elements decoded together. Each has compCount values, which are integers for the
+// integer formats and floating point for everything else. Doubles hold either exactly.
+struct DecodedElements
+{
+  VarType type = eVar_Float;
+  uint32_t compCount = 0;
+  QVector<double> values;
+  // elements that couldn't be read, e.g. out of range of the data, are false and have zero values
+  QVector<bool> valid;
+
+  const double *element(int i) const { return values.data() + i * compCount; }
+};
+
 struct FormatElement
 {
   FormatElement();
@@ -424,6 +437,11 @@ struct FormatElement
                                                 bool tightPacking, QString &errors);
 
   QVariantList GetVariants(const byte *&data, const byte *end) const;
+  // decodes count elements at once, element i at data + stride * indices[i], with indices of ~0U
+  // skipped as invalid. Gives the same values as GetVariants but the common formats are converted
+  // a whole component stream at a time, which is far faster for large meshes.
+  void DecodeElements(const byte *data, const byte *end, size_t stride, const uint32_t *indices,
+                      int count, DecodedElements &out) const;
   ShaderVariable GetShaderVar(const byte *&data, const byte *end) const;
 
   QString ElementString(const QVariant &var);
@@ -231,48 +231,69 @@ bool RenderManager::IsRunning()
   return m_Thread && m_Thread->isRunning() && m_Running;
 }
 
-void RenderManager::AsyncInvoke(const QString &tag, RenderManager::InvokeMethod m)
+bool RenderManager::InvokeHandle::cancel()
+{
+  if(!state.testAndSetOrdered(Pending, Cancelled))
+    return false;
+
+  processed.release();
+  return true;
+}
+
+void RenderManager::InvokeHandle::abort()
+{
+  if(cancel())
+    return;
+
+  abortFlag = 1;
+}
+
+void RenderManager::InvokeHandle::wait()
+{
+  // leave the semaphore released so that any number of waits return
+  processed.acquire();
+  processed.release();
+}
+
+RenderManager::InvokeHandlePtr RenderManager::AsyncInvoke(const QString &tag,
+                                                          RenderManager::InvokeMethod m,
+                                                          InvokePriority priority)
 {
   {
     QMutexLocker autolock(&m_RenderLock);
     for(int i = 0; i < m_RenderQueue.count();)
     {
       if(m_RenderQueue[i]->tag == tag)
-      {
-        InvokeHandle *cmd = m_RenderQueue.takeAt(i);
-        if(cmd->selfdelete)
-          delete cmd;
-      }
+        m_RenderQueue.takeAt(i)->cancel();
       else
-      {
         i++;
-      }
     }
   }
 
-  InvokeHandle *cmd = new InvokeHandle(m, tag);
-  cmd->selfdelete = true;
+  InvokeHandlePtr cmd(new InvokeHandle(m, tag, priority));
 
   PushInvoke(cmd);
+
+  return cmd;
 }
 
-void RenderManager::AsyncInvoke(RenderManager::InvokeMethod m)
+RenderManager::InvokeHandlePtr RenderManager::AsyncInvoke(RenderManager::InvokeMethod m,
+                                                          InvokePriority priority)
 {
-  InvokeHandle *cmd = new InvokeHandle(m);
-  cmd->selfdelete = true;
+  InvokeHandlePtr cmd(new InvokeHandle(m, QString(), priority));
 
   PushInvoke(cmd);
+
+  return cmd;
 }
 
 void RenderManager::BlockInvoke(RenderManager::InvokeMethod m)
 {
-  InvokeHandle *cmd = new InvokeHandle(m);
+  InvokeHandlePtr cmd(new InvokeHandle(m, QString(), eInvoke_Normal));
 
   PushInvoke(cmd);
 
-  cmd->processed.acquire();
-
-  delete cmd;
+  cmd->wait();
 }
 
 void RenderManager::CloseThread()
@@ -382,19 +403,22 @@ uint32_t RenderManager::ExecuteAndInject(const QString &exe, const QString &work
   return ret;
 }
 
-void RenderManager::PushInvoke(RenderManager::InvokeHandle *cmd)
+void RenderManager::PushInvoke(RenderManager::InvokeHandlePtr cmd)
 {
   if(m_Thread == NULL || !m_Thread->isRunning() || !m_Running)
   {
-    if(cmd->selfdelete)
-      delete cmd;
-    else
-      cmd->processed.release();
+    cmd->cancel();
     return;
   }
 
   QMutexLocker autolock(&m_RenderLock);
-  m_RenderQueue.enqueue(cmd);
+
+  // insert after everything of the same or higher priority
+  int idx = m_RenderQueue.count();
+  while(idx > 0 && m_RenderQueue[idx - 1]->priority < cmd->priority)
+    idx--;
+
+  m_RenderQueue.insert(idx, cmd);
   m_RenderCondition.wakeAll();
 }
 
@@ -417,7 +441,7 @@ void RenderManager::run()
   // main render command loop
   while(m_Running)
   {
-    InvokeHandle *cmd = NULL;
+    InvokeHandlePtr cmd;
 
     // wait for the condition to be woken, grab top of current queue,
     // unlock again.
@@ -427,41 +451,38 @@ void RenderManager::run()
         m_RenderCondition.wait(&m_RenderLock, 10);
 
       if(!m_RenderQueue.isEmpty())
-        cmd = m_RenderQueue.dequeue();
+        cmd = m_RenderQueue.takeFirst();
     }
 
-    if(cmd == NULL)
+    if(cmd.isNull())
+      continue;
+
+    // if it was cancelled while queued, skip it
+    if(!cmd->state.testAndSetOrdered(InvokeHandle::Pending, InvokeHandle::Running))
       continue;
 
+    renderer->SetOperationControl(&cmd->abortFlag, &cmd->progressValue);
+
     if(cmd->method != NULL)
       cmd->method(renderer);
 
-    // if it's a throwaway command, delete it
-    if(cmd->selfdelete)
-      delete cmd;
-    else
-      cmd->processed.release();
+    renderer->SetOperationControl(NULL, NULL);
+
+    cmd->state.storeRelease(InvokeHandle::Finished);
+    cmd->processed.release();
   }
 
-  // clean up anything left in the queue
+  // cancel anything left in the queue
   {
-    QQueue<InvokeHandle *> queue;
+    QList<InvokeHandlePtr> queue;
 
     {
       QMutexLocker autolock(&m_RenderLock);
       m_RenderQueue.swap(queue);
     }
 
-    for(InvokeHandle *cmd : queue)
-    {
-      if(cmd == NULL)
-        continue;
-
-      if(cmd->selfdelete)
-        delete cmd;
-      else
-        cmd->processed.release();
-    }
+    for(InvokeHandlePtr cmd : queue)
+      cmd->cancel();
   }
 
   // close the core renderer
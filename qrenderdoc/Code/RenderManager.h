@@ -24,9 +24,11 @@
 
 #pragma once
 
+#include <QAtomicInt>
+#include <QList>
 #include <QMutex>
-#include <QQueue>
 #include <QSemaphore>
+#include <QSharedPointer>
 #include <QString>
 #include <QThread>
 #include <QVariantMap>
@@ -123,6 +125,63 @@ public:
   typedef std::function<void(IReplayRenderer *)> InvokeMethod;
   typedef std::function<void(const char *, const rdctype::array<DirectoryFile> &)> DirectoryBrowseMethod;
 
+  // queued invokes are processed highest priority first, and in order within the same priority.
+  // The replay is single threaded so an invoke that has started always runs to completion, but
+  // e.g. picking a pixel under the cursor can skip past a queued pixel history.
+  enum InvokePriority
+  {
+    eInvoke_Low = 0,
+    eInvoke_Normal,
+    eInvoke_High,
+  };
+
+  // returned from an async invoke, to poll for when it has been processed or to cancel it if it
+  // hasn't started yet.
+  class InvokeHandle
+  {
+  public:
+    InvokeHandle(InvokeMethod m, const QString &t, InvokePriority p)
+        : method(m), tag(t), priority(p), state(Pending), abortFlag(0), progressValue(0.0f)
+    {
+    }
+
+    bool isFinished() const { return state.loadAcquire() == Finished; }
+    bool isCancelled() const { return state.loadAcquire() == Cancelled; }
+    // returns true if the invoke was cancelled, false if it had already started
+    bool cancel();
+    // waits until the invoke has either finished or been cancelled
+    void wait();
+    // cancels the invoke if it hasn't started, otherwise asks a long-running replay operation
+    // (pixel history, counter fetch) to stop early and return what it has so far. Only local
+    // replays check for this, a remote operation will run to completion.
+    void abort();
+    // the progress reported by a long-running replay operation while this invoke runs
+    float progress() const { return progressValue; }
+
+  private:
+    friend class RenderManager;
+
+    enum State
+    {
+      Pending,
+      Running,
+      Finished,
+      Cancelled,
+    };
+
+    InvokeMethod method;
+    QString tag;
+    InvokePriority priority;
+    QAtomicInt state;
+    QSemaphore processed;
+
+    // polled by the replay while the invoke is running, see IReplayRenderer::SetOperationControl
+    volatile bool32 abortFlag;
+    float progressValue;
+  };
+
+  typedef QSharedPointer<InvokeHandle> InvokeHandlePtr;
+
   RenderManager();
   ~RenderManager();
 
@@ -137,8 +196,9 @@ public:
   // processed.
   // the manager processes only the request on the top of the queue, so when a new tagged invoke
   // comes in, we remove any other requests in the queue before it that have the same tag
-  void AsyncInvoke(const QString &tag, InvokeMethod m);
-  void AsyncInvoke(InvokeMethod m);
+  InvokeHandlePtr AsyncInvoke(const QString &tag, InvokeMethod m,
+                              InvokePriority priority = eInvoke_Normal);
+  InvokeHandlePtr AsyncInvoke(InvokeMethod m, InvokePriority priority = eInvoke_Normal);
   void BlockInvoke(InvokeMethod m);
 
   void CloseThread();
@@ -160,28 +220,13 @@ public:
   void CopyCaptureFromRemote(const QString &remotepath, const QString &localpath, QWidget *window);
 
 private:
-  struct InvokeHandle
-  {
-    InvokeHandle(InvokeMethod m, const QString &t = QString())
-    {
-      tag = t;
-      method = m;
-      selfdelete = false;
-    }
-
-    QString tag;
-    InvokeMethod method;
-    QSemaphore processed;
-    bool selfdelete;
-  };
-
   void run();
 
   QMutex m_RenderLock;
-  QQueue<InvokeHandle *> m_RenderQueue;
+  QList<InvokeHandlePtr> m_RenderQueue;
   QWaitCondition m_RenderCondition;
 
-  void PushInvoke(InvokeHandle *cmd);
+  void PushInvoke(InvokeHandlePtr cmd);
 
   int m_ProxyRenderer;
   QString m_ReplayHost;
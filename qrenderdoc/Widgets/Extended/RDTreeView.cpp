@@ -62,3 +62,9 @@ void RDTreeView::drawBranches(QPainter *painter, const QRect &rect, const QModel
     style()->drawPrimitive(QStyle::PE_IndicatorBranch, &opt, painter, this);
   }
 }
+
+void RDTreeView::keyPressEvent(QKeyEvent *e)
+{
+  emit(keyPress(e));
+  QTreeView::keyPressEvent(e);
+}
@@ -33,8 +33,12 @@ public:
   explicit RDTreeView(QWidget *parent = 0);
 
   void setDrawBranches(bool draw) { m_DrawBranches = draw; }
+signals:
+  void keyPress(QKeyEvent *e);
+
 private:
   void drawBranches(QPainter *painter, const QRect &rect, const QModelIndex &index) const override;
+  void keyPressEvent(QKeyEvent *e) override;
 
   bool m_DrawBranches = true;
 };
@@ -23,11 +23,14 @@
  ******************************************************************************/
 
 #include "APIInspector.h"
-#include <QRegularExpression>
 #include "ui_APIInspector.h"
 
 Q_DECLARE_METATYPE(FetchAPIEvent);
 
+// on parameter items, the event they belong to and their index in that event's parameters
+static const int EventIDRole = Qt::UserRole + 1;
+static const int ParamIndexRole = Qt::UserRole + 2;
+
 APIInspector::APIInspector(CaptureContext &ctx, QWidget *parent)
     : QFrame(parent), ui(new Ui::APIInspector), m_Ctx(ctx)
 {
@@ -62,6 +65,8 @@ void APIInspector::OnLogfileClosed()
 {
   ui->apiEvents->clear();
   ui->callstack->clear();
+
+  m_EventParams.clear();
 }
 
 void APIInspector::OnSelectedEventChanged(uint32_t eventID)
@@ -113,13 +118,93 @@ void APIInspector::on_apiEvents_itemSelectionChanged()
   }
 }
 
+void APIInspector::on_apiEvents_itemExpanded(QTreeWidgetItem *item)
+{
+  // already filled in
+  if(item->childCount() > 0)
+    return;
+
+  uint32_t eid = 0;
+  int32_t paramIdx = -1;
+
+  if(item->parent() == NULL)
+  {
+    eid = item->data(0, Qt::UserRole).value<FetchAPIEvent>().eventID;
+  }
+  else
+  {
+    eid = item->data(0, EventIDRole).toUInt();
+    paramIdx = item->data(0, ParamIndexRole).toInt();
+  }
+
+  if(m_EventParams.contains(eid))
+  {
+    addParameters(item, eid, paramIdx);
+    return;
+  }
+
+  m_Ctx.Renderer().AsyncInvoke([this, eid](IReplayRenderer *r) {
+    rdctype::array<APIEventParameter> params;
+    r->GetAPIEventParameters(eid, &params);
+
+    GUIInvoke::call([this, eid, params]() {
+      m_EventParams[eid] = params;
+
+      // the view may have been refilled while we were fetching, so look the event up again
+      for(int i = 0; i < ui->apiEvents->topLevelItemCount(); i++)
+      {
+        QTreeWidgetItem *root = ui->apiEvents->topLevelItem(i);
+
+        if(root->data(0, Qt::UserRole).value<FetchAPIEvent>().eventID == eid)
+        {
+          if(root->isExpanded() && root->childCount() == 0)
+            addParameters(root, eid, -1);
+          break;
+        }
+      }
+    });
+  });
+}
+
+void APIInspector::addParameters(QTreeWidgetItem *parent, uint32_t eventID, int32_t parentParam)
+{
+  const rdctype::array<APIEventParameter> &params = m_EventParams[eventID];
+
+  ui->apiEvents->setUpdatesEnabled(false);
+
+  for(int32_t i = 0; i < params.count; i++)
+  {
+    const APIEventParameter &p = params[i];
+
+    if(p.parent != parentParam)
+      continue;
+
+    QString text = ToQStr(p.name);
+
+    if(p.value.count > 0)
+      text += (p.numChildren > 0 ? " = " : ": ") + ToQStr(p.value);
+
+    QTreeWidgetItem *item = new QTreeWidgetItem(parent, QStringList{"", text});
+
+    item->setData(0, EventIDRole, eventID);
+    item->setData(0, ParamIndexRole, i);
+
+    // members are only created once this parameter is expanded
+    if(p.numChildren > 0)
+      item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+  }
+
+  parent->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+
+  ui->apiEvents->setUpdatesEnabled(true);
+}
+
 void APIInspector::fillAPIView()
 {
   ui->apiEvents->setUpdatesEnabled(false);
   ui->apiEvents->clear();
 
-  QRegularExpression rgxopen("^\\s*{");
-  QRegularExpression rgxclose("^\\s*}");
+  m_EventParams.clear();
 
   const FetchDrawcall *draw = m_Ctx.CurSelectedDrawcall();
 
@@ -128,28 +213,16 @@ void APIInspector::fillAPIView()
     int e = 0;
     for(const FetchAPIEvent &ev : draw->events)
     {
-      QStringList lines = ToQStr(ev.eventDesc).split("\n", QString::SkipEmptyParts);
+      // only the first line, the call name, is needed up front. The parameters are fetched when
+      // the event is expanded.
+      QString desc = ToQStr(ev.eventDesc);
+      int nameEnd = desc.indexOf(QLatin1Char('\n'));
 
-      QTreeWidgetItem *root =
-          new QTreeWidgetItem(ui->apiEvents, QStringList{QString::number(ev.eventID), lines[0]});
+      QTreeWidgetItem *root = new QTreeWidgetItem(
+          ui->apiEvents, QStringList{QString::number(ev.eventID), desc.left(nameEnd)});
 
-      int i = 1;
-
-      if(i < lines.count() && lines[i].trimmed() == "{")
-        i++;
-
-      QList<QTreeWidgetItem *> nodestack;
-      nodestack.push_back(root);
-
-      for(; i < lines.count(); i++)
-      {
-        if(rgxopen.match(lines[i]).hasMatch())
-          nodestack.push_back(nodestack.back()->child(nodestack.back()->childCount() - 1));
-        else if(rgxclose.match(lines[i]).hasMatch())
-          nodestack.pop_back();
-        else if(!nodestack.empty())
-          new QTreeWidgetItem(nodestack.back(), QStringList{"", lines[i].trimmed()});
-      }
+      if(nameEnd >= 0 && nameEnd + 1 < desc.length())
+        root->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
 
       if(ev.eventID == draw->eventID)
       {
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <QFrame>
+#include <QMap>
 #include "Code/CaptureContext.h"
 
 namespace Ui
@@ -32,6 +33,8 @@ namespace Ui
 class APIInspector;
 }
 
+class QTreeWidgetItem;
+
 class APIInspector : public QFrame, public ILogViewerForm
 {
   Q_OBJECT
@@ -46,11 +49,16 @@ public:
   void OnEventChanged(uint32_t eventID) {}
 public slots:
   void on_apiEvents_itemSelectionChanged();
+  void on_apiEvents_itemExpanded(QTreeWidgetItem *item);
 
 private:
   Ui::APIInspector *ui;
   CaptureContext &m_Ctx;
 
+  // parameters of each event in the current view, fetched the first time the event is expanded
+  QMap<uint32_t, rdctype::array<APIEventParameter>> m_EventParams;
+
   void addCallstack(rdctype::array<rdctype::str> calls);
+  void addParameters(QTreeWidgetItem *parent, uint32_t eventID, int32_t parentParam);
   void fillAPIView();
 };
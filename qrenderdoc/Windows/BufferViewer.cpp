@@ -29,6 +29,7 @@
 #include <QMenu>
 #include <QMouseEvent>
 #include <QScrollBar>
+#include <QSet>
 #include <QTimer>
 #include <QtMath>
 #include "Code/Resources.h"
@@ -358,17 +359,165 @@ uint32_t CalcIndex(BufferData *data, uint32_t vertID, int32_t baseVertex)
   return idx;
 }
 
+// rows are decoded in blocks of this many at a time, so only the rows that are displayed or
+// exported get decoded
+static const uint32_t DecodeBlockRows = 256;
+
+// decodes an element for rows [firstRow, firstRow + numRows), looking up each row's vertex through
+// the index buffer if there is one
+static void DecodeRows(const FormatElement &el, const QList<BufferData *> &buffers,
+                       BufferData *indices, int32_t baseVertex, uint32_t inst, uint32_t firstRow,
+                       int numRows, DecodedElements &out)
+{
+  QVector<uint32_t> elemIndices(numRows, ~0U);
+
+  const byte *data = NULL;
+  const byte *end = NULL;
+  size_t stride = 0;
+
+  if(el.buffer < buffers.size() && buffers[el.buffer] && buffers[el.buffer]->data)
+  {
+    data = buffers[el.buffer]->data + el.offset;
+    end = buffers[el.buffer]->end;
+    stride = buffers[el.buffer]->stride;
+
+    uint32_t instIdx = 0;
+    if(el.instancerate > 0)
+      instIdx = inst / el.instancerate;
+
+    for(int r = 0; r < numRows; r++)
+    {
+      uint32_t idx = firstRow + r;
+
+      if(indices && indices->data)
+        idx = CalcIndex(indices, idx, baseVertex);
+
+      if(idx != ~0U)
+        elemIndices[r] = el.perinstance ? instIdx : idx;
+    }
+  }
+
+  el.DecodeElements(data, end, stride, elemIndices.data(), numRows, out);
+}
+
+static QString DecodedValueString(const DecodedElements &dec, int elem, uint32_t comp, bool hex)
+{
+  double d = dec.element(elem)[comp];
+
+  if(dec.type == eVar_UInt)
+    return Formatter::Format((uint32_t)d, hex);
+
+  if(dec.type == eVar_Int)
+  {
+    int i = (int)d;
+    if(i > 0)
+      return " " + Formatter::Format(i);
+    else
+      return Formatter::Format(i);
+  }
+
+  // pad with space on left if sign is missing, to better align
+  if(d < 0.0)
+    return Formatter::Format(d);
+  else if(d > 0.0)
+    return " " + Formatter::Format(d);
+  else if(qIsNaN(d))
+    return " NaN";
+
+  // force negative and positive 0 together
+  return " " + Formatter::Format(0.0);
+}
+
+// raw views of buffers larger than this are fetched in pages as they're scrolled through, rather
+// than reading back the whole buffer up front
+static const uint64_t PagedBufferThreshold = 16 * 1024 * 1024;
+
+// roughly how much data each page holds. Pages are always a whole number of decode blocks
+static const uint64_t PageBytes = 1024 * 1024;
+
+// how many pages either side of the displayed one are fetched ahead, and how far a page can be
+// from the displayed one before it's dropped
+static const uint32_t PrefetchPages = 2;
+static const uint32_t MaxPageDistance = 8;
+
+// where a paged buffer is read from. Page p holds rows [p * pageRows, (p + 1) * pageRows)
+struct PageSource
+{
+  ResourceId buffer;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  size_t stride = 1;
+  uint32_t pageRows = DecodeBlockRows;
+};
+
+// reads back the pages in one batch. The caller owns the returned data
+static QVector<BufferData *> RT_FetchPages(IReplayRenderer *r, const PageSource &src,
+                                           const QVector<uint32_t> &pages)
+{
+  uint64_t pageSize = uint64_t(src.pageRows) * src.stride;
+
+  QVector<BufferDataRange> ranges;
+  for(uint32_t p : pages)
+  {
+    uint64_t start = uint64_t(p) * pageSize;
+    ranges.push_back(
+        BufferDataRange(src.buffer, src.offset + start, qMin(pageSize, src.size - start)));
+  }
+
+  rdctype::array<rdctype::array<byte> > rangeData;
+  r->GetBuffersData(ranges.toStdVector(), &rangeData);
+
+  QVector<BufferData *> ret;
+
+  for(int i = 0; i < pages.count(); i++)
+  {
+    BufferData *buf = new BufferData;
+    if(i < rangeData.count)
+    {
+      const rdctype::array<byte> &bufdata = rangeData[i];
+
+      buf->data = new byte[bufdata.count];
+      memcpy(buf->data, bufdata.elems, bufdata.count);
+      buf->end = buf->data + bufdata.count;
+    }
+    buf->stride = src.stride;
+    ret.push_back(buf);
+  }
+
+  return ret;
+}
+
+// fetches one page and waits for it, for exporting off the UI thread
+static BufferData *FetchPageBlocking(CaptureContext &ctx, const PageSource &src, uint32_t page)
+{
+  QVector<uint32_t> pages = {page};
+  QVector<BufferData *> data;
+
+  ctx.Renderer().BlockInvoke(
+      [&data, &src, &pages](IReplayRenderer *r) { data = RT_FetchPages(r, src, pages); });
+
+  return data[0];
+}
+
 class BufferItemModel : public QAbstractItemModel
 {
 public:
-  BufferItemModel(RDTableView *v, QObject *parent) : QAbstractItemModel(parent)
+  BufferItemModel(RDTableView *v, CaptureContext &c, QObject *parent)
+      : QAbstractItemModel(parent), ctx(c)
   {
     view = v;
     view->setModel(this);
   }
-  void beginReset() { emit beginResetModel(); }
+  ~BufferItemModel() { clearPages(); }
+  void beginReset()
+  {
+    decodeCache.clear();
+    clearPages();
+    emit beginResetModel();
+  }
   void endReset()
   {
+    decodeCache.clear();
     cacheColumns();
     m_ColumnCount = columnLookup.count() + reservedColumnCount();
     emit endResetModel();
@@ -487,105 +636,97 @@ public:
       {
         if(col >= 0 && col < m_ColumnCount && row < numRows)
         {
-          if(col == 0 && meshView)
-            return row;
+          if(col < reservedColumnCount())
+            return displayData(row, col, QVector<DecodedElements>());
 
-          uint32_t idx = row;
+          return displayData(row, col, cachedBlock(row));
+        }
+      }
+    }
 
-          if(indices && indices->data)
-          {
-            idx = CalcIndex(indices, row, baseVertex);
+    return QVariant();
+  }
 
-            if(idx == ~0U)
-              return QVariant();
-          }
+  // the displayed value of a cell, given the decoded block of rows that contains it
+  QVariant displayData(uint32_t row, int col, const QVector<DecodedElements> &block) const
+  {
+    if(col == 0 && meshView)
+      return row;
 
-          if(col == 1 && meshView)
-            return idx;
+    uint32_t idx = row;
 
-          const FormatElement &el = elementForColumn(col);
+    if(indices && indices->data)
+    {
+      idx = CalcIndex(indices, row, baseVertex);
 
-          uint32_t instIdx = 0;
-          if(el.instancerate > 0)
-            instIdx = curInstance / el.instancerate;
+      if(idx == ~0U)
+        return QVariant();
+    }
 
-          if(el.buffer < buffers.size())
-          {
-            const byte *data = buffers[el.buffer]->data;
-            const byte *end = buffers[el.buffer]->end;
+    if(col == 1 && meshView)
+      return idx;
 
-            if(!el.perinstance)
-              data += buffers[el.buffer]->stride * idx;
-            else
-              data += buffers[el.buffer]->stride * instIdx;
+    int elIdx = columnLookup[col - reservedColumnCount()];
+    uint32_t comp = (uint32_t)componentForIndex(col);
+    int blockRow = int(row % DecodeBlockRows);
 
-            data += el.offset;
+    if(elIdx >= block.count())
+      return QVariant();
 
-            // only slightly wasteful, we need to fetch all variants together
-            // since some formats are packed and can't be read individually
-            QVariantList list = el.GetVariants(data, end);
+    const DecodedElements &dec = block[elIdx];
 
-            int comp = componentForIndex(col);
+    if(blockRow < dec.valid.count() && dec.valid[blockRow] && comp < dec.compCount)
+      return DecodedValueString(dec, blockRow, comp, columns[elIdx].hex);
 
-            if(comp < list.count())
-            {
-              QVariant &v = list[comp];
-
-              QString ret;
-
-              QMetaType::Type vt = (QMetaType::Type)v.type();
-
-              if(vt == QMetaType::Double)
-              {
-                double d = v.toDouble();
-                // pad with space on left if sign is missing, to better align
-                if(d < 0.0)
-                  ret = Formatter::Format(d);
-                else if(d > 0.0)
-                  ret = " " + Formatter::Format(d);
-                else if(qIsNaN(d))
-                  ret = " NaN";
-                else
-                  // force negative and positive 0 together
-                  ret = " " + Formatter::Format(0.0);
-              }
-              else if(vt == QMetaType::Float)
-              {
-                float f = v.toFloat();
-                // pad with space on left if sign is missing, to better align
-                if(f < 0.0)
-                  ret = Formatter::Format(f);
-                else if(f > 0.0)
-                  ret = " " + Formatter::Format(f);
-                else if(qIsNaN(f))
-                  ret = " NaN";
-                else
-                  // force negative and positive 0 together
-                  ret = " " + Formatter::Format(0.0);
-              }
-              else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              {
-                ret = Formatter::Format(v.toUInt(), el.hex);
-              }
-              else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              {
-                int i = v.toInt();
-                if(i > 0)
-                  ret = " " + Formatter::Format(i);
-                else
-                  ret = Formatter::Format(i);
-              }
-              else
-                ret = v.toString();
-
-              return ret;
-            }
-          }
-        }
-      }
+    return QVariant();
+  }
+
+  // decodes every element for the block of rows that contains row. This doesn't touch the cache
+  // so it's safe to call from other threads
+  void decodeBlock(uint32_t row, QVector<DecodedElements> &block) const
+  {
+    if(paged)
+    {
+      decodePagedBlock(row, pages.value(row / pageSource.pageRows, NULL), block);
+      return;
     }
 
-    return QVariant();
+    uint32_t firstRow = row - (row % DecodeBlockRows);
+    int count = (int)qMin(DecodeBlockRows, numRows - firstRow);
+
+    block.resize(columns.count());
+
+    for(int i = 0; i < columns.count(); i++)
+      DecodeRows(columns[i], buffers, indices, baseVertex, curInstance, firstRow, count, block[i]);
+  }
+
+  // large raw buffer views are set up with this between beginReset and endReset, instead of
+  // filling in buffers. Rows are then fetched a page at a time as they're displayed, and pages
+  // that have scrolled far out of view are dropped.
+  void setPaged(const PageSource &src)
+  {
+    pageSource = src;
+    paged = true;
+  }
+
+  bool isPaged() const { return paged; }
+  const PageSource &pagedSource() const { return pageSource; }
+  // as decodeBlock, from the page that contains row. Only needs the page to be valid, so this is
+  // safe to call from other threads with a page that the caller fetched itself
+  void decodePagedBlock(uint32_t row, BufferData *page, QVector<DecodedElements> &block) const
+  {
+    uint32_t firstRow = row - (row % DecodeBlockRows);
+    uint32_t pageFirstRow = firstRow - (firstRow % pageSource.pageRows);
+    int count = (int)qMin(DecodeBlockRows, numRows - firstRow);
+
+    QList<BufferData *> pageBuffers;
+    pageBuffers.push_back(page);
+
+    block.resize(columns.count());
+
+    for(int i = 0; i < columns.count(); i++)
+      DecodeRows(columns[i], pageBuffers, NULL, 0, curInstance, firstRow - pageFirstRow, count,
+                 block[i]);
   }
 
   RDTableView *view = NULL;
@@ -684,6 +825,148 @@ private:
   bool secondaryElAlpha = false;
   bool secondaryEnabled = false;
 
+  // decoded blocks of rows that have been displayed, indexed by row / DecodeBlockRows. Only used
+  // from the UI thread
+  mutable QHash<uint32_t, QVector<DecodedElements>> decodeCache;
+
+  // enough to cover any visible area, scrolling through a huge mesh shouldn't keep it all decoded
+  static const int MaxCachedBlocks = 64;
+
+  const QVector<DecodedElements> &cachedBlock(uint32_t row) const
+  {
+    uint32_t blockIdx = row / DecodeBlockRows;
+
+    auto it = decodeCache.constFind(blockIdx);
+    if(it != decodeCache.constEnd())
+      return it.value();
+
+    if(paged)
+    {
+      uint32_t page = row / pageSource.pageRows;
+
+      requestPages(page);
+
+      // nothing is cached until the page arrives, then dataChanged brings us back here
+      if(!pages.contains(page))
+      {
+        static const QVector<DecodedElements> empty;
+        return empty;
+      }
+    }
+
+    if(decodeCache.count() >= MaxCachedBlocks)
+      decodeCache.clear();
+
+    QVector<DecodedElements> &block = decodeCache[blockIdx];
+    decodeBlock(row, block);
+    return block;
+  }
+
+  CaptureContext &ctx;
+
+  // paging state, only used on the UI thread
+  bool paged = false;
+  PageSource pageSource;
+  mutable QMap<uint32_t, BufferData *> pages;
+  mutable QSet<uint32_t> requestedPages;
+  mutable uint32_t pageCentre = 0;
+  // incremented on every reset, so pages requested before it are thrown away when they arrive
+  uint32_t pageGeneration = 0;
+
+  void clearPages()
+  {
+    for(BufferData *page : pages)
+      page->deref();
+
+    pages.clear();
+    requestedPages.clear();
+    paged = false;
+    pageGeneration++;
+  }
+
+  static uint32_t pageDistance(uint32_t a, uint32_t b) { return a > b ? a - b : b - a; }
+  // drops pages far from the displayed one and fetches any missing ones around it, in one batch
+  void requestPages(uint32_t page) const
+  {
+    pageCentre = page;
+
+    for(auto it = pages.begin(); it != pages.end();)
+    {
+      if(pageDistance(it.key(), page) > MaxPageDistance)
+      {
+        it.value()->deref();
+        it = pages.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    uint32_t numPages = (numRows + pageSource.pageRows - 1) / pageSource.pageRows;
+
+    QVector<uint32_t> fetch;
+
+    for(uint32_t p = page > PrefetchPages ? page - PrefetchPages : 0;
+        p <= page + PrefetchPages && p < numPages; p++)
+    {
+      if(pages.contains(p) || requestedPages.contains(p))
+        continue;
+
+      requestedPages.insert(p);
+      fetch.push_back(p);
+    }
+
+    if(fetch.isEmpty())
+      return;
+
+    BufferItemModel *model = const_cast<BufferItemModel *>(this);
+    PageSource src = pageSource;
+    uint32_t generation = pageGeneration;
+
+    ctx.Renderer().AsyncInvoke([model, src, generation, fetch](IReplayRenderer *r) {
+      QVector<BufferData *> data = RT_FetchPages(r, src, fetch);
+
+      GUIInvoke::call([model, generation, fetch, data]() {
+        model->pagesFetched(generation, fetch, data);
+      });
+    });
+  }
+
+  void pagesFetched(uint32_t generation, const QVector<uint32_t> &fetched,
+                    const QVector<BufferData *> &data)
+  {
+    if(generation != pageGeneration)
+    {
+      for(BufferData *d : data)
+        d->deref();
+      return;
+    }
+
+    for(int i = 0; i < fetched.count(); i++)
+    {
+      uint32_t p = fetched[i];
+
+      requestedPages.remove(p);
+
+      // the view may have scrolled away while this was being fetched
+      if(pageDistance(p, pageCentre) > MaxPageDistance)
+      {
+        data[i]->deref();
+        continue;
+      }
+
+      if(pages.contains(p))
+        pages[p]->deref();
+      pages[p] = data[i];
+
+      uint32_t firstRow = p * pageSource.pageRows;
+      uint32_t lastRow = qMin(firstRow + pageSource.pageRows, numRows) - 1;
+
+      emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
+    }
+  }
+
   int reservedColumnCount() const { return (meshView ? 2 : 0); }
   int componentForIndex(int col) const { return componentLookup[col - reservedColumnCount()]; }
   int firstColumnForElement(int el) const
@@ -812,9 +1095,9 @@ BufferViewer::BufferViewer(CaptureContext &ctx, bool meshview, QWidget *parent)
 {
   ui->setupUi(this);
 
-  m_ModelVSIn = new BufferItemModel(ui->vsinData, this);
-  m_ModelVSOut = new BufferItemModel(ui->vsoutData, this);
-  m_ModelGSOut = new BufferItemModel(ui->gsoutData, this);
+  m_ModelVSIn = new BufferItemModel(ui->vsinData, m_Ctx, this);
+  m_ModelVSOut = new BufferItemModel(ui->vsoutData, m_Ctx, this);
+  m_ModelGSOut = new BufferItemModel(ui->gsoutData, m_Ctx, this);
 
   m_Flycam = new FlycamWrapper();
   m_Arcball = new ArcballWrapper();
@@ -1225,7 +1508,21 @@ void BufferViewer::OnEventChanged(uint32_t eventID)
       guessSecondaryColumn(m_ModelGSOut);
   }
 
-  m_Ctx.Renderer().AsyncInvoke([this, vsinHoriz, vsoutHoriz, gsoutHoriz](IReplayRenderer *r) {
+  // the size of a raw buffer view, to decide whether to page it
+  uint64_t viewSize = 0;
+  if(!m_MeshView && m_IsBuffer)
+  {
+    FetchBuffer *fetchBuf = m_Ctx.GetBuffer(m_BufferID);
+
+    if(fetchBuf && fetchBuf->byteSize > m_ByteOffset)
+      viewSize = qMin(m_ByteSize, fetchBuf->byteSize - m_ByteOffset);
+  }
+
+  m_Ctx.Renderer().AsyncInvoke([this, vsinHoriz, vsoutHoriz, gsoutHoriz,
+                                viewSize](IReplayRenderer *r) {
+
+    PageSource paging;
+    bool paged = false;
 
     if(m_MeshView)
     {
@@ -1233,43 +1530,67 @@ void BufferViewer::OnEventChanged(uint32_t eventID)
     }
     else
     {
-      BufferData *buf = new BufferData;
-      rdctype::array<byte> data;
-      if(m_IsBuffer)
+      // calculate tight stride
+      size_t stride = 0;
+      for(const FormatElement &el : m_ModelVSIn->columns)
+        stride += el.byteSize();
+
+      stride = qMax((size_t)1, stride);
+
+      for(auto vb : m_ModelVSIn->buffers)
+        vb->deref();
+      m_ModelVSIn->buffers.clear();
+
+      if(viewSize > PagedBufferThreshold)
       {
-        uint64_t len = m_ByteSize;
-        if(len == UINT64_MAX)
-          len = 0;
+        paged = true;
+        paging.buffer = m_BufferID;
+        paging.offset = m_ByteOffset;
+        paging.size = viewSize;
+        paging.stride = stride;
 
-        r->GetBufferData(m_BufferID, m_ByteOffset, len, &data);
+        uint64_t pageRows = qMax(PageBytes / stride, (uint64_t)DecodeBlockRows);
+        paging.pageRows = uint32_t(pageRows - (pageRows % DecodeBlockRows));
+
+        m_ModelVSIn->numRows = uint32_t((viewSize + stride - 1) / stride);
       }
       else
       {
-        r->GetTextureData(m_BufferID, m_TexArrayIdx, m_TexMip, &data);
-      }
-
-      buf->data = new byte[data.count];
-      memcpy(buf->data, data.elems, data.count);
-      buf->end = buf->data + data.count;
+        BufferData *buf = new BufferData;
+        rdctype::array<byte> data;
+        if(m_IsBuffer)
+        {
+          uint64_t len = m_ByteSize;
+          if(len == UINT64_MAX)
+            len = 0;
 
-      // calculate tight stride
-      buf->stride = 0;
-      for(const FormatElement &el : m_ModelVSIn->columns)
-        buf->stride += el.byteSize();
+          r->GetBufferData(m_BufferID, m_ByteOffset, len, &data);
+        }
+        else
+        {
+          r->GetTextureData(m_BufferID, m_TexArrayIdx, m_TexMip, &data);
+        }
 
-      buf->stride = qMax((size_t)1, buf->stride);
+        buf->data = new byte[data.count];
+        memcpy(buf->data, data.elems, data.count);
+        buf->end = buf->data + data.count;
+        buf->stride = stride;
 
-      m_ModelVSIn->numRows = uint32_t((data.count + buf->stride - 1) / buf->stride);
+        m_ModelVSIn->numRows = uint32_t((data.count + buf->stride - 1) / buf->stride);
 
-      // ownership passes to model
-      m_ModelVSIn->buffers.push_back(buf);
+        // ownership passes to model
+        m_ModelVSIn->buffers.push_back(buf);
+      }
     }
 
     updatePreviewColumns();
 
     RT_UpdateAndDisplay(r);
 
-    GUIInvoke::call([this, vsinHoriz, vsoutHoriz, gsoutHoriz] {
+    GUIInvoke::call([this, vsinHoriz, vsoutHoriz, gsoutHoriz, paged, paging] {
+      if(paged)
+        m_ModelVSIn->setPaged(paging);
+
       m_ModelVSIn->endReset();
       m_ModelVSOut->endReset();
       m_ModelGSOut->endReset();
@@ -1291,6 +1612,13 @@ void BufferViewer::OnEventChanged(uint32_t eventID)
       ui->gsoutData->horizontalScrollBar()->setValue(gsoutHoriz);
     });
   });
+
+  // when there's nothing else to do, get the neighbouring draws' post-VS data ready so stepping
+  // to them is quick. The tag drops any prefetch still queued for a previous event.
+  if(m_MeshView)
+    m_Ctx.Renderer().AsyncInvoke("PrefetchPostVS",
+                                 [](IReplayRenderer *r) { r->PrefetchPostVSData(); },
+                                 RenderManager::eInvoke_Low);
 }
 
 void BufferViewer::RT_FetchMeshData(IReplayRenderer *r)
@@ -1353,6 +1681,14 @@ void BufferViewer::RT_FetchMeshData(IReplayRenderer *r)
     }
   }
 
+  r->GetPostVSData(m_Config.curInstance, eMeshDataStage_VSOut, &m_PostVS);
+  r->GetPostVSData(m_Config.curInstance, eMeshDataStage_GSOut, &m_PostGS);
+
+  // everything else that's needed only depends on the index data, so it can all be fetched
+  // together in one batch
+  QVector<BufferDataRange> ranges;
+  QVector<int> vbRange;
+
   int vbIdx = 0;
   for(BoundVBuffer vb : vbs)
   {
@@ -1398,29 +1734,59 @@ void BufferViewer::RT_FetchMeshData(IReplayRenderer *r)
         qCritical() << "Buffer used for both instance and vertex rendering!";
     }
 
-    BufferData *buf = new BufferData;
+    vbRange.push_back(used ? ranges.count() : -1);
+
     if(used)
+      ranges.push_back(BufferDataRange(vb.Buffer, vb.ByteOffset + offset * vb.ByteStride,
+                                       (maxIdx + 1) * vb.ByteStride));
+  }
+
+  int postVSIdxRange = -1;
+  if(draw && m_PostVS.idxbuf != ResourceId() && (draw->flags & eDraw_UseIBuffer))
+  {
+    postVSIdxRange = ranges.count();
+    ranges.push_back(BufferDataRange(m_PostVS.idxbuf,
+                                     ioffset + draw->indexOffset * draw->indexByteWidth,
+                                     draw->numIndices * draw->indexByteWidth));
+  }
+
+  int postVSRange = -1;
+  if(m_PostVS.buf != ResourceId())
+  {
+    postVSRange = ranges.count();
+    ranges.push_back(BufferDataRange(m_PostVS.buf, m_PostVS.offset, 0));
+  }
+
+  int postGSRange = -1;
+  if(m_PostGS.buf != ResourceId())
+  {
+    postGSRange = ranges.count();
+    ranges.push_back(BufferDataRange(m_PostGS.buf, m_PostGS.offset, 0));
+  }
+
+  rdctype::array<rdctype::array<byte> > rangeData;
+  r->GetBuffersData(ranges.toStdVector(), &rangeData);
+
+  for(int vb = 0; vb < vbRange.count(); vb++)
+  {
+    BufferData *buf = new BufferData;
+    if(vbRange[vb] >= 0 && vbRange[vb] < rangeData.count)
     {
-      rdctype::array<byte> bufdata;
-      r->GetBufferData(vb.Buffer, vb.ByteOffset + offset * vb.ByteStride,
-                       (maxIdx + 1) * vb.ByteStride, &bufdata);
+      const rdctype::array<byte> &bufdata = rangeData[vbRange[vb]];
 
       buf->data = new byte[bufdata.count];
       memcpy(buf->data, bufdata.elems, bufdata.count);
       buf->end = buf->data + bufdata.count;
-      buf->stride = vb.ByteStride;
+      buf->stride = vbs[vb].ByteStride;
     }
     // ref passes to model
     m_ModelVSIn->buffers.push_back(buf);
   }
 
-  r->GetPostVSData(m_Config.curInstance, eMeshDataStage_VSOut, &m_PostVS);
-
   m_ModelVSOut->numRows = m_PostVS.numVerts;
 
-  if(draw && m_PostVS.idxbuf != ResourceId() && (draw->flags & eDraw_UseIBuffer))
-    r->GetBufferData(m_PostVS.idxbuf, ioffset + draw->indexOffset * draw->indexByteWidth,
-                     draw->numIndices * draw->indexByteWidth, &idata);
+  if(postVSIdxRange >= 0 && postVSIdxRange < rangeData.count)
+    idata = rangeData[postVSIdxRange];
 
   indices = NULL;
   if(m_ModelVSOut->indices)
@@ -1453,11 +1819,10 @@ void BufferViewer::RT_FetchMeshData(IReplayRenderer *r)
     }
   }
 
-  if(m_PostVS.buf != ResourceId())
+  if(postVSRange >= 0 && postVSRange < rangeData.count)
   {
     BufferData *postvs = new BufferData;
-    rdctype::array<byte> bufdata;
-    r->GetBufferData(m_PostVS.buf, m_PostVS.offset, 0, &bufdata);
+    const rdctype::array<byte> &bufdata = rangeData[postVSRange];
 
     postvs->data = new byte[bufdata.count];
     memcpy(postvs->data, bufdata.elems, bufdata.count);
@@ -1468,18 +1833,15 @@ void BufferViewer::RT_FetchMeshData(IReplayRenderer *r)
     m_ModelVSOut->buffers.push_back(postvs);
   }
 
-  r->GetPostVSData(m_Config.curInstance, eMeshDataStage_GSOut, &m_PostGS);
-
   m_ModelGSOut->numRows = m_PostGS.numVerts;
 
   indices = NULL;
   m_ModelGSOut->indices = NULL;
 
-  if(m_PostGS.buf != ResourceId())
+  if(postGSRange >= 0 && postGSRange < rangeData.count)
   {
     BufferData *postgs = new BufferData;
-    rdctype::array<byte> bufdata;
-    r->GetBufferData(m_PostGS.buf, m_PostGS.offset, 0, &bufdata);
+    const rdctype::array<byte> &bufdata = rangeData[postGSRange];
 
     postgs->data = new byte[bufdata.count];
     memcpy(postgs->data, bufdata.elems, bufdata.count);
@@ -1569,60 +1931,32 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
       maxOutputList.push_back(FloatVector(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX));
     }
 
-    QVector<CachedElData> cache;
-
-    CacheDataForIteration(cache, s.elements, s.buffers, bbox.inst);
-
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
+    DecodedElements dec;
 
-    for(uint32_t row = 0; row < s.count; row++)
+    for(int col = 0; col < s.elements.count(); col++)
     {
-      uint32_t idx = row;
+      float *minOut = (float *)&minOutputList[col];
+      float *maxOut = (float *)&maxOutputList[col];
 
-      if(s.indices && s.indices->data)
+      for(uint32_t firstRow = 0; firstRow < s.count; firstRow += DecodeBlockRows)
       {
-        idx = CalcIndex(s.indices, row, bbox.baseVertex);
+        int numRows = (int)qMin(DecodeBlockRows, s.count - firstRow);
 
-        if(idx == ~0U)
-          continue;
-      }
-
-      for(int col = 0; col < s.elements.count(); col++)
-      {
-        const CachedElData &d = cache[col];
-        const FormatElement *el = d.el;
+        DecodeRows(s.elements[col], s.buffers, s.indices, bbox.baseVertex, bbox.inst, firstRow,
+                   numRows, dec);
 
-        float *minOut = (float *)&minOutputList[col];
-        float *maxOut = (float *)&maxOutputList[col];
+        uint32_t numComps = qMin(dec.compCount, 4U);
 
-        if(d.data)
+        for(int r = 0; r < numRows; r++)
         {
-          const byte *bytes = d.data;
-
-          if(!el->perinstance)
-            bytes += d.stride * idx;
+          if(!dec.valid[r])
+            continue;
 
-          QVariantList list = el->GetVariants(bytes, d.end);
+          const double *values = dec.element(r);
 
-          for(int comp = 0; comp < list.count(); comp++)
+          for(uint32_t comp = 0; comp < numComps; comp++)
           {
-            const QVariant &v = list[comp];
-
-            QMetaType::Type vt = (QMetaType::Type)v.type();
-
-            float fval = 0.0f;
-
-            if(vt == QMetaType::Double)
-              fval = (float)v.toDouble();
-            else if(vt == QMetaType::Float)
-              fval = v.toFloat();
-            else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              fval = (float)v.toUInt();
-            else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              fval = (float)v.toInt();
-            else
-              continue;
+            float fval = (float)values[comp];
 
             if(qIsFinite(fval))
             {
@@ -2625,7 +2959,21 @@ void BufferViewer::exportData(const BufferExport &params)
   LambdaThread *exportThread = new LambdaThread([this, params, model, f]() {
     if(params.format == BufferExport::RawBytes)
     {
-      if(!m_MeshView)
+      if(!m_MeshView && model->isPaged())
+      {
+        // the buffer was too big to read back whole, so go a page at a time
+        const PageSource &src = model->pagedSource();
+        uint32_t numPages = (model->numRows + src.pageRows - 1) / src.pageRows;
+
+        for(uint32_t p = 0; p < numPages; p++)
+        {
+          BufferData *page = FetchPageBlocking(m_Ctx, src, p);
+          if(page->data)
+            f->write((const char *)page->data, int(page->end - page->data));
+          page->deref();
+        }
+      }
+      else if(!m_MeshView)
       {
         // this is the simplest possible case, we just dump the contents of the first buffer, as
         // it's tightly packed
@@ -2684,11 +3032,37 @@ void BufferViewer::exportData(const BufferExport &params)
 
       s << "\n";
 
+      // decode a block of rows at a time, the same as the model does for display. Paged buffers
+      // are fetched here a page at a time, the model's own pages belong to the UI thread
+      QVector<DecodedElements> block;
+      BufferData *page = NULL;
+
       for(int row = 0; row < model->rowCount(); row++)
       {
+        if(row % DecodeBlockRows == 0)
+        {
+          if(model->isPaged())
+          {
+            const PageSource &src = model->pagedSource();
+
+            if(row % src.pageRows == 0)
+            {
+              if(page)
+                page->deref();
+              page = FetchPageBlocking(m_Ctx, src, row / src.pageRows);
+            }
+
+            model->decodePagedBlock((uint32_t)row, page, block);
+          }
+          else
+          {
+            model->decodeBlock((uint32_t)row, block);
+          }
+        }
+
         for(int col = 0; col < model->columnCount(); col++)
         {
-          s << model->data(model->index(row, col), Qt::DisplayRole).toString();
+          s << model->displayData((uint32_t)row, col, block).toString();
 
           if(col + 1 < model->columnCount())
             s << ", ";
@@ -2696,6 +3070,9 @@ void BufferViewer::exportData(const BufferExport &params)
 
         s << "\n";
       }
+
+      if(page)
+        page->deref();
     }
 
     f->close();
@@ -2739,12 +3116,13 @@ void BufferViewer::debugVertex()
 
   m_Ctx.Renderer().AsyncInvoke([this, vertid, index](IReplayRenderer *r) {
     ShaderDebugTrace *trace = new ShaderDebugTrace;
+    uint32_t numSteps = 0;
 
-    bool success =
-        r->DebugVertex(vertid, m_Config.curInstance, index, m_Ctx.CurDrawcall()->instanceOffset,
-                       m_Ctx.CurDrawcall()->vertexOffset, trace);
+    uint32_t session = r->DebugVertexSession(vertid, m_Config.curInstance, index,
+                                             m_Ctx.CurDrawcall()->instanceOffset,
+                                             m_Ctx.CurDrawcall()->vertexOffset, trace, &numSteps);
 
-    if(!success || trace->states.count == 0)
+    if(session == 0)
     {
       delete trace;
 
@@ -2756,7 +3134,7 @@ void BufferViewer::debugVertex()
       return;
     }
 
-    GUIInvoke::call([this, vertid, trace]() {
+    GUIInvoke::call([this, vertid, trace, session, numSteps]() {
       QString debugContext = tr("Vertex %1").arg(vertid);
 
       if(m_Ctx.CurDrawcall()->numInstances > 1)
@@ -2768,8 +3146,9 @@ void BufferViewer::debugVertex()
           m_Ctx.CurPipelineState.GetBindpointMapping(eShaderStage_Pixel);
 
       // viewer takes ownership of the trace
-      ShaderViewer *s = ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails,
-                                                  eShaderStage_Pixel, trace, debugContext, this);
+      ShaderViewer *s =
+          ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails, eShaderStage_Pixel, trace,
+                                    session, numSteps, debugContext, this);
 
       m_Ctx.setupDockWindow(s);
 
@@ -27,6 +27,7 @@
 #include "ui_ConstantBufferPreviewer.h"
 
 QList<ConstantBufferPreviewer *> ConstantBufferPreviewer::m_Previews;
+ConstantBufferPreviewer *ConstantBufferPreviewer::m_FetchQueuedBy = NULL;
 
 ConstantBufferPreviewer::ConstantBufferPreviewer(CaptureContext &ctx, const ShaderStageType stage,
                                                  uint32_t slot, uint32_t idx, QWidget *parent)
@@ -64,6 +65,11 @@ ConstantBufferPreviewer::~ConstantBufferPreviewer()
 {
   m_Ctx.RemoveLogViewer(this);
   m_Previews.removeOne(this);
+
+  // the queued fetch is dropped along with us, so let the next event queue another
+  if(m_FetchQueuedBy == this)
+    m_FetchQueuedBy = NULL;
+
   delete ui;
 }
 
@@ -98,12 +104,15 @@ void ConstantBufferPreviewer::OnEventChanged(uint32_t eventID)
   m_Ctx.CurPipelineState.GetConstantBuffer(m_stage, m_slot, m_arrayIdx, m_cbuffer, offs, size);
 
   m_shader = m_Ctx.CurPipelineState.GetShader(m_stage);
-  QString entryPoint = m_Ctx.CurPipelineState.GetShaderEntryPoint(m_stage);
+  m_entryPoint = m_Ctx.CurPipelineState.GetShaderEntryPoint(m_stage);
+  m_offset = offs;
   const ShaderReflection *reflection = m_Ctx.CurPipelineState.GetShaderReflection(m_stage);
 
   updateLabels();
 
-  if(reflection == NULL || reflection->ConstantBlocks.count <= (int)m_slot)
+  m_blockBound = reflection != NULL && reflection->ConstantBlocks.count > (int)m_slot;
+
+  if(!m_blockBound)
   {
     setVariables({});
     return;
@@ -118,15 +127,57 @@ void ConstantBufferPreviewer::OnEventChanged(uint32_t eventID)
       GUIInvoke::call([this, vars] { setVariables(vars); });
     });
   }
-  else
+  else if(m_FetchQueuedBy == NULL)
   {
-    m_Ctx.Renderer().AsyncInvoke([this, entryPoint, offs](IReplayRenderer *r) {
-      rdctype::array<ShaderVariable> vars;
-      r->GetCBufferVariableContents(m_shader, entryPoint.toUtf8().data(), m_slot, m_cbuffer, offs,
-                                    &vars);
-      GUIInvoke::call([this, vars] { setVariables(vars); });
-    });
+    // each preview finds its binding as it's told about the event, then they're all filled out
+    // together in one request once every preview has been told
+    m_FetchQueuedBy = this;
+    QMetaObject::invokeMethod(this, "fetchPreviews", Qt::QueuedConnection);
+  }
+}
+
+void ConstantBufferPreviewer::fetchPreviews()
+{
+  m_FetchQueuedBy = NULL;
+
+  QList<ConstantBufferPreviewer *> previews;
+  std::vector<CBufferContentsRequest> requests;
+
+  for(ConstantBufferPreviewer *c : m_Previews)
+  {
+    if(!c->m_blockBound || !c->m_formatOverride.empty())
+      continue;
+
+    CBufferContentsRequest req;
+    req.shader = c->m_shader;
+    req.entryPoint = c->m_entryPoint.toUtf8().data();
+    req.slot = c->m_slot;
+    req.buffer = c->m_cbuffer;
+    req.offset = c->m_offset;
+
+    previews.push_back(c);
+    requests.push_back(req);
   }
+
+  if(previews.isEmpty())
+    return;
+
+  rdctype::array<CBufferContentsRequest> reqs;
+  reqs = requests;
+
+  m_Ctx.Renderer().AsyncInvoke([previews, reqs](IReplayRenderer *r) {
+    rdctype::array<rdctype::array<ShaderVariable> > vars;
+    r->GetCBuffersVariableContents(reqs, &vars);
+
+    GUIInvoke::call([previews, vars] {
+      for(int i = 0; i < previews.count() && i < vars.count; i++)
+      {
+        // previews closed since the request was made are skipped
+        if(m_Previews.contains(previews[i]))
+          previews[i]->setVariables(vars[i]);
+      }
+    });
+  });
 }
 
 void ConstantBufferPreviewer::on_setFormat_toggled(bool checked)
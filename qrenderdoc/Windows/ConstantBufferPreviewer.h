@@ -57,6 +57,7 @@ private slots:
 
   // manual slots
   void processFormat(const QString &format);
+  void fetchPreviews();
 
 private:
   Ui::ConstantBufferPreviewer *ui;
@@ -64,6 +65,9 @@ private:
 
   ResourceId m_cbuffer;
   ResourceId m_shader;
+  QString m_entryPoint;
+  uint64_t m_offset = 0;
+  bool m_blockBound = false;
   ShaderStageType m_stage = eShaderStage_Vertex;
   uint32_t m_slot = 0;
   uint32_t m_arrayIdx = 0;
@@ -76,6 +80,8 @@ private:
   void updateLabels();
 
   static QList<ConstantBufferPreviewer *> m_Previews;
+  // the preview that has queued fetchPreviews for the current event, if any
+  static ConstantBufferPreviewer *m_FetchQueuedBy;
 
   QList<FormatElement> m_formatOverride;
 };
@@ -74,6 +74,18 @@ QVariantMap CaptureSettings::toJSON() const
   opts["SaveAllInitials"] = Options.SaveAllInitials;
   opts["CaptureAllCmdLists"] = Options.CaptureAllCmdLists;
   opts["DebugOutputMute"] = Options.DebugOutputMute;
+  opts["AsyncCaptureWrite"] = Options.AsyncCaptureWrite;
+  opts["CombineMultiFrameCaptures"] = Options.CombineMultiFrameCaptures;
+  opts["StageInitialContentsMB"] = Options.StageInitialContentsMB;
+  opts["TrackMappedWrites"] = Options.TrackMappedWrites;
+  opts["DeduplicateCallstacks"] = Options.DeduplicateCallstacks;
+  opts["RingCaptureFrames"] = Options.RingCaptureFrames;
+  opts["RingCaptureMemoryMB"] = Options.RingCaptureMemoryMB;
+  opts["SpikeCaptureThresholdMS"] = Options.SpikeCaptureThresholdMS;
+  opts["SpikeCapturePercent"] = Options.SpikeCapturePercent;
+  opts["CaptureMemoryBudgetMB"] = Options.CaptureMemoryBudgetMB;
+  opts["CaptureEventTimings"] = Options.CaptureEventTimings;
+  opts["HideOverlay"] = Options.HideOverlay;
   ret["Options"] = opts;
 
   return ret;
@@ -109,6 +121,19 @@ void CaptureSettings::fromJSON(const QVariantMap &data)
   Options.SaveAllInitials = opts["SaveAllInitials"].toBool();
   Options.CaptureAllCmdLists = opts["CaptureAllCmdLists"].toBool();
   Options.DebugOutputMute = opts["DebugOutputMute"].toBool();
+  Options.AsyncCaptureWrite = opts["AsyncCaptureWrite"].toBool();
+  Options.CombineMultiFrameCaptures = opts["CombineMultiFrameCaptures"].toBool();
+  Options.StageInitialContentsMB = opts["StageInitialContentsMB"].toUInt();
+  Options.TrackMappedWrites = opts["TrackMappedWrites"].toBool();
+  Options.DeduplicateCallstacks = opts["DeduplicateCallstacks"].toBool();
+  Options.RingCaptureFrames = opts["RingCaptureFrames"].toUInt();
+  if(opts.contains("RingCaptureMemoryMB"))
+    Options.RingCaptureMemoryMB = opts["RingCaptureMemoryMB"].toUInt();
+  Options.SpikeCaptureThresholdMS = opts["SpikeCaptureThresholdMS"].toUInt();
+  Options.SpikeCapturePercent = opts["SpikeCapturePercent"].toUInt();
+  Options.CaptureMemoryBudgetMB = opts["CaptureMemoryBudgetMB"].toUInt();
+  Options.CaptureEventTimings = opts["CaptureEventTimings"].toBool();
+  Options.HideOverlay = opts["HideOverlay"].toBool();
 }
 
 CaptureDialog::CaptureDialog(CaptureContext &ctx, OnCaptureMethod captureCallback,
@@ -23,9 +23,12 @@
  ******************************************************************************/
 
 #include "EventBrowser.h"
+#include <QAbstractItemModel>
 #include <QKeyEvent>
+#include <QSet>
 #include <QShortcut>
 #include <QTimer>
+#include <algorithm>
 #include "3rdparty/flowlayout/FlowLayout.h"
 #include "Code/CaptureContext.h"
 #include "Code/QRDUtils.h"
@@ -37,10 +40,415 @@ enum
   COL_EID = 1,
   COL_DURATION = 2,
 
-  COL_CURRENT,
-  COL_FIND,
-  COL_BOOKMARK,
-  COL_LAST_EID,
+  COL_COUNT,
+};
+
+// one flattened entry per row in the tree. Nodes are laid out breadth-first so that the children
+// of any node are contiguous, and a node's index doubles as the model index's internal id. The
+// display text is generated on demand from the drawcall, so the only cost per event is this POD.
+struct EventNode
+{
+  const FetchDrawcall *draw;
+  int parent;
+  int row;
+  int firstChild;
+  int numChildren;
+  uint32_t eventID;
+  uint32_t lastEID;
+};
+
+class EventItemModel : public QAbstractItemModel
+{
+public:
+  EventItemModel(QObject *parent) : QAbstractItemModel(parent)
+  {
+    m_CurrentIcon.addFile(QStringLiteral(":/flag_green.png"), QSize(), QIcon::Normal, QIcon::Off);
+    m_FindIcon.addFile(QStringLiteral(":/find.png"), QSize(), QIcon::Normal, QIcon::Off);
+    m_BookmarkIcon.addFile(QStringLiteral(":/asterisk_orange.png"), QSize(), QIcon::Normal,
+                           QIcon::Off);
+  }
+
+  void setDrawcalls(uint32_t frameNumber, const rdctype::array<FetchDrawcall> &draws)
+  {
+    emit beginResetModel();
+
+    clearNodes();
+
+    m_FrameNumber = frameNumber;
+
+    // the frame root, with the implicit 'Frame Start' node followed by the top-level draws.
+    EventNode root = {NULL, -1, 0, 1, draws.count + 1, 0, 0};
+    m_Nodes.push_back(root);
+
+    EventNode framestart = {NULL, 0, 0, 0, 0, 0, 0};
+    m_Nodes.push_back(framestart);
+
+    for(int32_t i = 0; i < draws.count; i++)
+    {
+      EventNode n = {&draws[i], 0, i + 1, 0, 0, draws[i].eventID, 0};
+      m_Nodes.push_back(n);
+    }
+
+    // append each node's children after everything queued so far, breadth-first
+    for(int idx = 2; idx < m_Nodes.count(); idx++)
+    {
+      const rdctype::array<FetchDrawcall> &children = m_Nodes[idx].draw->children;
+
+      m_Nodes[idx].firstChild = m_Nodes.count();
+      m_Nodes[idx].numChildren = children.count;
+
+      for(int32_t i = 0; i < children.count; i++)
+      {
+        EventNode n = {&children[i], idx, i, 0, 0, children[i].eventID, 0};
+        m_Nodes.push_back(n);
+      }
+    }
+
+    // children always come after their parent, so walking backwards sees every child's last EID
+    // before the parent needs it. A parent takes the last EID of its final child, leaves their
+    // own EID, and set markers inherit the EID of the next draw.
+    for(int idx = m_Nodes.count() - 1; idx > 1; idx--)
+    {
+      EventNode &n = m_Nodes[idx];
+
+      if(n.numChildren > 0)
+        n.lastEID = m_Nodes[n.firstChild + n.numChildren - 1].lastEID;
+
+      if(n.lastEID == 0)
+      {
+        n.lastEID = n.eventID;
+
+        const EventNode &p = m_Nodes[n.parent];
+
+        if((n.draw->flags & eDraw_SetMarker) && n.row + 1 < p.numChildren)
+          n.lastEID = m_Nodes[p.firstChild + n.row + 1].eventID;
+      }
+    }
+
+    if(draws.count > 0)
+      m_Nodes[0].lastEID = m_Nodes[draws.count + 1].lastEID;
+
+    // sort by last EID for event lookup. Where several nodes share the same last EID, leaf nodes
+    // come first and then later nodes, to match the old reverse search that allowed 'set' markers
+    // to select the real draw they inherit from.
+    m_EIDLookup.reserve(m_Nodes.count() - 1);
+    for(int idx = 1; idx < m_Nodes.count(); idx++)
+      m_EIDLookup.push_back(idx);
+
+    std::sort(m_EIDLookup.begin(), m_EIDLookup.end(), [this](int a, int b) {
+      const EventNode &na = m_Nodes[a];
+      const EventNode &nb = m_Nodes[b];
+      if(na.lastEID != nb.lastEID)
+        return na.lastEID < nb.lastEID;
+      if((na.numChildren == 0) != (nb.numChildren == 0))
+        return na.numChildren == 0;
+      return a > b;
+    });
+
+    emit endResetModel();
+  }
+
+  void clear()
+  {
+    emit beginResetModel();
+    clearNodes();
+    emit endResetModel();
+  }
+
+  bool isEmpty() const { return m_Nodes.isEmpty(); }
+  QModelIndex rootIndex() const
+  {
+    if(m_Nodes.isEmpty())
+      return QModelIndex();
+    return createIndex(0, 0, quintptr(0));
+  }
+
+  // returns the node with the lowest last EID at or after eventID
+  QModelIndex findEvent(uint32_t eventID) const
+  {
+    int lo = 0, hi = m_EIDLookup.count();
+    while(lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if(m_Nodes[m_EIDLookup[mid]].lastEID < eventID)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if(lo >= m_EIDLookup.count())
+      return QModelIndex();
+
+    return nodeIndex(m_EIDLookup[lo]);
+  }
+
+  // text search over every node. Returns the last EID of the closest match after (or before)
+  // the given EID, or -1 if nothing matches
+  int findText(const QString &filter, uint32_t after, bool forward) const
+  {
+    int found = -1;
+
+    for(int idx = 1; idx < m_Nodes.count(); idx++)
+    {
+      uint32_t eid = m_Nodes[idx].lastEID;
+
+      if(forward && (eid <= after || (found >= 0 && eid >= (uint32_t)found)))
+        continue;
+      if(!forward && (eid >= after || (found >= 0 && eid <= (uint32_t)found)))
+        continue;
+
+      if(nodeName(idx).contains(filter, Qt::CaseInsensitive))
+        found = (int)eid;
+    }
+
+    return found;
+  }
+
+  int setFindFilter(const QString &filter)
+  {
+    m_FindFilter = filter;
+
+    int results = 0;
+
+    if(!filter.isEmpty())
+    {
+      for(int idx = 1; idx < m_Nodes.count(); idx++)
+        if(nodeName(idx).contains(filter, Qt::CaseInsensitive))
+          results++;
+    }
+
+    refreshAll();
+
+    return results;
+  }
+
+  void setCurrent(const QModelIndex &idx)
+  {
+    int prev = m_Current;
+    m_Current = idx.isValid() ? (int)idx.internalId() : -1;
+
+    refreshNode(prev);
+    refreshNode(m_Current);
+  }
+
+  void setBookmarked(const QModelIndex &idx, bool bookmarked)
+  {
+    if(!idx.isValid())
+      return;
+
+    int node = (int)idx.internalId();
+
+    if(bookmarked)
+      m_Bookmarked.insert(node);
+    else
+      m_Bookmarked.remove(node);
+
+    refreshNode(node);
+  }
+
+  void clearBookmarks()
+  {
+    m_Bookmarked.clear();
+    refreshAll();
+  }
+
+  void setDurations(const rdctype::array<CounterResult> &results)
+  {
+    QHash<uint32_t, double> times;
+    times.reserve(results.count);
+    for(const CounterResult &r : results)
+      times[r.eventID] = r.value.d;
+
+    m_Durations.fill(0.0, m_Nodes.count());
+
+    // leaf nodes look up their time, parents take the value of the sum of their children. As with
+    // the last EIDs, walking backwards means every child is finished before its parent.
+    for(int idx = m_Nodes.count() - 1; idx >= 0; idx--)
+    {
+      const EventNode &n = m_Nodes[idx];
+
+      if(n.numChildren == 0)
+        m_Durations[idx] = times.value(n.eventID, -1.0);
+
+      if(n.parent >= 0 && m_Durations[idx] > 0.0)
+        m_Durations[n.parent] += m_Durations[idx];
+    }
+
+    refreshAll();
+  }
+
+  uint32_t eventID(const QModelIndex &idx) const
+  {
+    return idx.isValid() ? m_Nodes[(int)idx.internalId()].eventID : 0;
+  }
+
+  uint32_t lastEID(const QModelIndex &idx) const
+  {
+    return idx.isValid() ? m_Nodes[(int)idx.internalId()].lastEID : 0;
+  }
+
+  QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override
+  {
+    if(row < 0 || row >= rowCount(parent) || column < 0 || column >= columnCount())
+      return QModelIndex();
+
+    if(!parent.isValid())
+      return createIndex(row, column, quintptr(0));
+
+    const EventNode &p = m_Nodes[(int)parent.internalId()];
+
+    return createIndex(row, column, quintptr(p.firstChild + row));
+  }
+
+  QModelIndex parent(const QModelIndex &index) const override
+  {
+    if(!index.isValid())
+      return QModelIndex();
+
+    int parent = m_Nodes[(int)index.internalId()].parent;
+
+    if(parent < 0)
+      return QModelIndex();
+
+    return createIndex(m_Nodes[parent].row, 0, quintptr(parent));
+  }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override
+  {
+    if(m_Nodes.isEmpty())
+      return 0;
+
+    if(!parent.isValid())
+      return 1;
+
+    if(parent.column() != 0)
+      return 0;
+
+    return m_Nodes[(int)parent.internalId()].numChildren;
+  }
+
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override { return COL_COUNT; }
+  Qt::ItemFlags flags(const QModelIndex &index) const override
+  {
+    if(!index.isValid())
+      return 0;
+
+    return QAbstractItemModel::flags(index);
+  }
+
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+  {
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole)
+    {
+      switch(section)
+      {
+        case COL_NAME: return QString("Name");
+        case COL_EID: return QString("EID");
+        case COL_DURATION: return QString::fromUtf8("Duration (µs)");
+        default: break;
+      }
+    }
+
+    return QVariant();
+  }
+
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+  {
+    if(!index.isValid())
+      return QVariant();
+
+    int idx = (int)index.internalId();
+    const EventNode &n = m_Nodes[idx];
+
+    if(role == Qt::DisplayRole)
+    {
+      switch(index.column())
+      {
+        case COL_NAME: return nodeName(idx);
+        case COL_EID:
+          if(idx == 0)
+            return QString();
+          if(n.numChildren > 0 && n.lastEID > n.eventID)
+            return QString("%1-%2").arg(n.eventID).arg(n.lastEID);
+          return QString::number(n.eventID);
+        case COL_DURATION:
+        {
+          if(m_Durations.isEmpty())
+            return idx == 0 ? QString() : QString("0.0");
+
+          double duration = m_Durations[idx];
+          return duration < 0.0 ? QString() : QString::number(duration * 1000000.0);
+        }
+        default: break;
+      }
+    }
+    else if(role == Qt::DecorationRole && index.column() == COL_NAME && idx > 0)
+    {
+      if(idx == m_Current)
+        return m_CurrentIcon;
+      if(m_Bookmarked.contains(idx))
+        return m_BookmarkIcon;
+      if(!m_FindFilter.isEmpty() && nodeName(idx).contains(m_FindFilter, Qt::CaseInsensitive))
+        return m_FindIcon;
+    }
+
+    return QVariant();
+  }
+
+private:
+  QVector<EventNode> m_Nodes;
+  QVector<int> m_EIDLookup;
+  QVector<double> m_Durations;
+  QSet<int> m_Bookmarked;
+  QString m_FindFilter;
+  int m_Current = -1;
+  uint32_t m_FrameNumber = 0;
+
+  QIcon m_CurrentIcon;
+  QIcon m_FindIcon;
+  QIcon m_BookmarkIcon;
+
+  void clearNodes()
+  {
+    m_Nodes.clear();
+    m_EIDLookup.clear();
+    m_Durations.clear();
+    m_Bookmarked.clear();
+    m_FindFilter.clear();
+    m_Current = -1;
+  }
+
+  QString nodeName(int idx) const
+  {
+    if(idx == 0)
+      return QString("Frame #%1").arg(m_FrameNumber);
+
+    const EventNode &n = m_Nodes[idx];
+
+    if(n.draw == NULL)
+      return QString("Frame Start");
+
+    return QString(n.draw->name);
+  }
+
+  QModelIndex nodeIndex(int idx, int column = 0) const
+  {
+    return createIndex(m_Nodes[idx].row, column, quintptr(idx));
+  }
+
+  void refreshNode(int idx)
+  {
+    if(idx >= 0 && idx < m_Nodes.count())
+      emit dataChanged(nodeIndex(idx, 0), nodeIndex(idx, COL_COUNT - 1));
+  }
+
+  // icons and durations can change on any row, so rather than emitting a change for every node
+  // we notify a multi-cell range on the root, which makes the view repaint everything visible.
+  void refreshAll()
+  {
+    if(!m_Nodes.isEmpty())
+      emit dataChanged(nodeIndex(0, 0), nodeIndex(0, COL_COUNT - 1));
+  }
 };
 
 EventBrowser::EventBrowser(CaptureContext &ctx, QWidget *parent)
@@ -50,9 +458,10 @@ EventBrowser::EventBrowser(CaptureContext &ctx, QWidget *parent)
 
   m_Ctx.AddLogViewer(this);
 
-  clearBookmarks();
+  m_Model = new EventItemModel(this);
+  ui->events->setModel(m_Model);
 
-  ui->events->setClearSelectionOnFocusLoss(false);
+  clearBookmarks();
 
   ui->events->header()->resizeSection(COL_EID, 80);
 
@@ -78,7 +487,9 @@ EventBrowser::EventBrowser(CaptureContext &ctx, QWidget *parent)
 
   QObject::connect(ui->closeFind, &QToolButton::clicked, this, &EventBrowser::on_HideFindJump);
   QObject::connect(ui->closeJump, &QToolButton::clicked, this, &EventBrowser::on_HideFindJump);
-  QObject::connect(ui->events, &RDTreeWidget::keyPress, this, &EventBrowser::events_keyPress);
+  QObject::connect(ui->events, &RDTreeView::keyPress, this, &EventBrowser::events_keyPress);
+  QObject::connect(ui->events->selectionModel(), &QItemSelectionModel::currentChanged, this,
+                   &EventBrowser::events_currentChanged);
   ui->jumpStrip->hide();
   ui->findStrip->hide();
   ui->bookmarkStrip->hide();
@@ -90,10 +501,6 @@ EventBrowser::EventBrowser(CaptureContext &ctx, QWidget *parent)
   m_BookmarkStripLayout->addWidget(ui->bookmarkStripHeader);
   m_BookmarkStripLayout->addItem(m_BookmarkSpacer);
 
-  m_CurrentIcon.addFile(QStringLiteral(":/flag_green.png"), QSize(), QIcon::Normal, QIcon::Off);
-  m_FindIcon.addFile(QStringLiteral(":/find.png"), QSize(), QIcon::Normal, QIcon::Off);
-  m_BookmarkIcon.addFile(QStringLiteral(":/asterisk_orange.png"), QSize(), QIcon::Normal, QIcon::Off);
-
   Qt::Key keys[] = {
       Qt::Key_1, Qt::Key_2, Qt::Key_3, Qt::Key_4, Qt::Key_5,
       Qt::Key_6, Qt::Key_7, Qt::Key_8, Qt::Key_9, Qt::Key_0,
@@ -119,32 +526,28 @@ EventBrowser::~EventBrowser()
 {
   m_Ctx.windowClosed(this);
   m_Ctx.RemoveLogViewer(this);
+  ui->events->setModel(NULL);
   delete ui;
   delete m_SizeDelegate;
 }
 
-void EventBrowser::OnLogfileLoaded()
+void EventBrowser::OnDrawcallsLoaded()
 {
-  QTreeWidgetItem *frame = new QTreeWidgetItem(
-      (QTreeWidget *)NULL,
-      QStringList{QString("Frame #%1").arg(m_Ctx.FrameInfo().frameNumber), "", ""});
-
+  // building the tree is the expensive part of loading here, so do it while the rest of the
+  // capture's data is still being fetched
   clearBookmarks();
 
-  QTreeWidgetItem *framestart = new QTreeWidgetItem(frame, QStringList{"Frame Start", "0", ""});
-  framestart->setData(COL_EID, Qt::UserRole, QVariant(0));
-  framestart->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_FIND, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_LAST_EID, Qt::UserRole, QVariant(0));
+  m_Model->setDrawcalls(m_Ctx.FrameInfo().frameNumber, m_Ctx.CurDrawcalls());
 
-  uint lastEID = AddDrawcalls(frame, m_Ctx.CurDrawcalls());
-  frame->setData(COL_EID, Qt::UserRole, QVariant(0));
-  frame->setData(COL_LAST_EID, Qt::UserRole, QVariant(lastEID));
+  ui->events->expand(m_Model->rootIndex());
+}
 
-  ui->events->insertTopLevelItem(0, frame);
+void EventBrowser::OnLogfileLoaded()
+{
+  // if the capture's been timed before the stored timings can be shown straight away
+  LoadCachedDrawcallTimes();
 
-  ui->events->expandItem(frame);
+  uint lastEID = m_Model->lastEID(m_Model->rootIndex());
 
   m_Ctx.SetEventID({this}, lastEID, lastEID);
 }
@@ -153,7 +556,7 @@ void EventBrowser::OnLogfileClosed()
 {
   clearBookmarks();
 
-  ui->events->clear();
+  m_Model->clear();
 }
 
 void EventBrowser::OnEventChanged(uint32_t eventID)
@@ -162,78 +565,9 @@ void EventBrowser::OnEventChanged(uint32_t eventID)
   highlightBookmarks();
 }
 
-uint EventBrowser::AddDrawcalls(QTreeWidgetItem *parent, const rdctype::array<FetchDrawcall> &draws)
+void EventBrowser::SetDrawcallTimes(const rdctype::array<CounterResult> &results)
 {
-  uint lastEID = 0;
-
-  for(int32_t i = 0; i < draws.count; i++)
-  {
-    QTreeWidgetItem *child = new QTreeWidgetItem(
-        parent, QStringList{QString(draws[i].name), QString("%1").arg(draws[i].eventID), "0.0"});
-
-    lastEID = AddDrawcalls(child, draws[i].children);
-
-    if(lastEID > draws[i].eventID)
-      child->setText(COL_EID, QString("%1-%2").arg(draws[i].eventID).arg(lastEID));
-
-    if(lastEID == 0)
-    {
-      lastEID = draws[i].eventID;
-
-      if((draws[i].flags & eDraw_SetMarker) && i + 1 < draws.count)
-        lastEID = draws[i + 1].eventID;
-    }
-
-    child->setData(COL_EID, Qt::UserRole, QVariant(draws[i].eventID));
-    child->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-    child->setData(COL_FIND, Qt::UserRole, QVariant(false));
-    child->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-    child->setData(COL_LAST_EID, Qt::UserRole, QVariant(lastEID));
-  }
-
-  return lastEID;
-}
-
-void EventBrowser::SetDrawcallTimes(QTreeWidgetItem *node,
-                                    const rdctype::array<CounterResult> &results)
-{
-  if(node == NULL)
-    return;
-
-  // parent nodes take the value of the sum of their children
-  double duration = 0.0;
-
-  // look up leaf nodes in the dictionary
-  if(node->childCount() == 0)
-  {
-    uint eid = node->data(COL_EID, Qt::UserRole).toUInt();
-
-    duration = -1.0;
-
-    for(const CounterResult &r : results)
-    {
-      if(r.eventID == eid)
-        duration = r.value.d;
-    }
-
-    node->setText(COL_DURATION, duration < 0.0f ? "" : QString::number(duration * 1000000.0));
-    node->setData(COL_DURATION, Qt::UserRole, QVariant(duration));
-
-    return;
-  }
-
-  for(int i = 0; i < node->childCount(); i++)
-  {
-    SetDrawcallTimes(node->child(i), results);
-
-    double nd = node->child(i)->data(COL_DURATION, Qt::UserRole).toDouble();
-
-    if(nd > 0.0)
-      duration += nd;
-  }
-
-  node->setText(COL_DURATION, duration < 0.0f ? "" : QString::number(duration * 1000000.0));
-  node->setData(COL_DURATION, Qt::UserRole, QVariant(duration));
+  m_Model->setDurations(results);
 }
 
 void EventBrowser::on_find_clicked()
@@ -252,41 +586,61 @@ void EventBrowser::on_gotoEID_clicked()
 
 void EventBrowser::on_bookmark_clicked()
 {
-  QTreeWidgetItem *n = ui->events->currentItem();
+  QModelIndex idx = ui->events->currentIndex();
 
-  if(n)
-    toggleBookmark(n->data(COL_LAST_EID, Qt::UserRole).toUInt());
+  if(idx.isValid())
+    toggleBookmark(m_Model->lastEID(idx));
 }
 
 void EventBrowser::on_timeDraws_clicked()
 {
-  m_Ctx.Renderer().AsyncInvoke([this](IReplayRenderer *r) {
+  FetchDrawcallTimes(RenderManager::eInvoke_Normal);
+}
 
+void EventBrowser::FetchDrawcallTimes(RenderManager::InvokePriority priority)
+{
+  m_Ctx.Renderer().AsyncInvoke("DrawcallTimes",
+                               [this](IReplayRenderer *r) {
+                                 uint32_t counters[] = {eCounter_EventGPUDuration};
+
+                                 rdctype::array<CounterResult> results;
+                                 r->FetchCounters(counters, 1, &results);
+
+                                 GUIInvoke::call([this, results]() { SetDrawcallTimes(results); });
+                               },
+                               priority);
+}
+
+void EventBrowser::LoadCachedDrawcallTimes()
+{
+  m_Ctx.Renderer().AsyncInvoke([this](IReplayRenderer *r) {
     uint32_t counters[] = {eCounter_EventGPUDuration};
 
     rdctype::array<CounterResult> results;
-    r->FetchCounters(counters, 1, &results);
+    bool32 stale = false;
 
-    GUIInvoke::call([this, results]() { SetDrawcallTimes(ui->events->topLevelItem(0), results); });
+    if(r->GetCachedCounterResults(counters, 1, &results, &stale))
+    {
+      GUIInvoke::call([this, results]() { SetDrawcallTimes(results); });
+    }
+    else if(stale)
+    {
+      // the capture was timed before, but on different hardware or drivers. Re-time it in the
+      // background so the column is filled in again, without getting in the way of anything else
+      GUIInvoke::call([this]() { FetchDrawcallTimes(RenderManager::eInvoke_Low); });
+    }
   });
 }
 
-void EventBrowser::on_events_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous)
+void EventBrowser::events_currentChanged(const QModelIndex &current, const QModelIndex &previous)
 {
-  if(previous)
-  {
-    previous->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-    RefreshIcon(previous);
-  }
+  m_Model->setCurrent(current);
 
-  if(!current)
+  if(!current.isValid())
     return;
 
-  current->setData(COL_CURRENT, Qt::UserRole, QVariant(true));
-  RefreshIcon(current);
-
-  uint EID = current->data(COL_EID, Qt::UserRole).toUInt();
-  uint lastEID = current->data(COL_LAST_EID, Qt::UserRole).toUInt();
+  uint EID = m_Model->eventID(current);
+  uint lastEID = m_Model->lastEID(current);
 
   m_Ctx.SetEventID({this}, EID, lastEID);
 
@@ -448,6 +802,8 @@ void EventBrowser::clearBookmarks()
   m_Bookmarks.clear();
   m_BookmarkButtons.clear();
 
+  m_Model->clearBookmarks();
+
   ui->bookmarkStrip->setVisible(false);
 }
 
@@ -455,19 +811,14 @@ void EventBrowser::toggleBookmark(uint32_t EID)
 {
   int index = m_Bookmarks.indexOf(EID);
 
-  QTreeWidgetItem *found = NULL;
-  FindEventNode(found, ui->events->topLevelItem(0), EID);
+  QModelIndex found = m_Model->findEvent(EID);
 
   if(index >= 0)
   {
     delete m_BookmarkButtons.takeAt(index);
     m_Bookmarks.removeAt(index);
 
-    if(found)
-    {
-      found->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-      RefreshIcon(found);
-    }
+    m_Model->setBookmarked(found, false);
   }
   else
   {
@@ -488,11 +839,7 @@ void EventBrowser::toggleBookmark(uint32_t EID)
 
     highlightBookmarks();
 
-    if(found)
-    {
-      found->setData(COL_BOOKMARK, Qt::UserRole, QVariant(true));
-      RefreshIcon(found);
-    }
+    m_Model->setBookmarked(found, true);
 
     m_BookmarkStripLayout->removeItem(m_BookmarkSpacer);
     m_BookmarkStripLayout->addWidget(but);
@@ -522,70 +869,22 @@ void EventBrowser::highlightBookmarks()
   }
 }
 
-bool EventBrowser::hasBookmark(QTreeWidgetItem *node)
-{
-  if(node)
-    return hasBookmark(node->data(COL_EID, Qt::UserRole).toUInt());
-
-  return false;
-}
-
 bool EventBrowser::hasBookmark(uint32_t EID)
 {
   return m_Bookmarks.contains(EID);
 }
 
-void EventBrowser::RefreshIcon(QTreeWidgetItem *item)
-{
-  if(item->data(COL_CURRENT, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_CurrentIcon);
-  else if(item->data(COL_BOOKMARK, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_BookmarkIcon);
-  else if(item->data(COL_FIND, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_FindIcon);
-  else
-    item->setIcon(COL_NAME, QIcon());
-}
-
-bool EventBrowser::FindEventNode(QTreeWidgetItem *&found, QTreeWidgetItem *parent, uint32_t eventID)
-{
-  // do a reverse search to find the last match (in case of 'set' markers that
-  // inherit the event of the next real draw).
-  for(int i = parent->childCount() - 1; i >= 0; i--)
-  {
-    QTreeWidgetItem *n = parent->child(i);
-
-    uint nEID = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
-    uint fEID = found ? found->data(COL_LAST_EID, Qt::UserRole).toUInt() : 0;
-
-    if(nEID >= eventID && (found == NULL || nEID <= fEID))
-      found = n;
-
-    if(nEID == eventID && n->childCount() == 0)
-      return true;
-
-    if(n->childCount() > 0)
-    {
-      bool exact = FindEventNode(found, n, eventID);
-      if(exact)
-        return true;
-    }
-  }
-
-  return false;
-}
-
-void EventBrowser::ExpandNode(QTreeWidgetItem *node)
+void EventBrowser::ExpandNode(const QModelIndex &idx)
 {
-  QTreeWidgetItem *n = node;
-  while(node != NULL)
+  QModelIndex i = idx;
+  while(i.isValid())
   {
-    node->setExpanded(true);
-    node = node->parent();
+    ui->events->expand(i);
+    i = i.parent();
   }
 
-  if(n)
-    ui->events->scrollToItem(n);
+  if(idx.isValid())
+    ui->events->scrollTo(idx);
 }
 
 bool EventBrowser::SelectEvent(uint32_t eventID)
@@ -593,13 +892,10 @@ bool EventBrowser::SelectEvent(uint32_t eventID)
   if(!m_Ctx.LogLoaded())
     return false;
 
-  QTreeWidgetItem *found = NULL;
-  FindEventNode(found, ui->events->topLevelItem(0), eventID);
-  if(found != NULL)
+  QModelIndex found = m_Model->findEvent(eventID);
+  if(found.isValid())
   {
-    ui->events->clearSelection();
-    ui->events->setItemSelected(found, true);
-    ui->events->setCurrentItem(found);
+    ui->events->setCurrentIndex(found);
 
     ExpandNode(found);
     return true;
@@ -608,48 +904,10 @@ bool EventBrowser::SelectEvent(uint32_t eventID)
   return false;
 }
 
-void EventBrowser::ClearFindIcons(QTreeWidgetItem *parent)
-{
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    QTreeWidgetItem *n = parent->child(i);
-
-    n->setData(COL_FIND, Qt::UserRole, QVariant(false));
-    RefreshIcon(n);
-
-    if(n->childCount() > 0)
-      ClearFindIcons(n);
-  }
-}
-
 void EventBrowser::ClearFindIcons()
 {
   if(m_Ctx.LogLoaded())
-    ClearFindIcons(ui->events->topLevelItem(0));
-}
-
-int EventBrowser::SetFindIcons(QTreeWidgetItem *parent, QString filter)
-{
-  int results = 0;
-
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    QTreeWidgetItem *n = parent->child(i);
-
-    if(n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-    {
-      n->setData(COL_FIND, Qt::UserRole, QVariant(true));
-      RefreshIcon(n);
-      results++;
-    }
-
-    if(n->childCount() > 0)
-    {
-      results += SetFindIcons(n, filter);
-    }
-  }
-
-  return results;
+    m_Model->setFindFilter(QString());
 }
 
 int EventBrowser::SetFindIcons(QString filter)
@@ -657,63 +915,7 @@ int EventBrowser::SetFindIcons(QString filter)
   if(filter.isEmpty())
     return 0;
 
-  return SetFindIcons(ui->events->topLevelItem(0), filter);
-}
-
-QTreeWidgetItem *EventBrowser::FindNode(QTreeWidgetItem *parent, QString filter, uint32_t after)
-{
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    QTreeWidgetItem *n = parent->child(i);
-
-    uint eid = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
-
-    if(eid > after && n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-      return n;
-
-    if(n->childCount() > 0)
-    {
-      QTreeWidgetItem *found = FindNode(n, filter, after);
-
-      if(found != NULL)
-        return found;
-    }
-  }
-
-  return NULL;
-}
-
-int EventBrowser::FindEvent(QTreeWidgetItem *parent, QString filter, uint32_t after, bool forward)
-{
-  if(parent == NULL)
-    return -1;
-
-  for(int i = forward ? 0 : parent->childCount() - 1; i >= 0 && i < parent->childCount();
-      i += forward ? 1 : -1)
-  {
-    auto n = parent->child(i);
-
-    uint eid = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
-
-    bool matchesAfter = (forward && eid > after) || (!forward && eid < after);
-
-    if(matchesAfter)
-    {
-      QString name = n->text(COL_NAME);
-      if(name.contains(filter, Qt::CaseInsensitive))
-        return (int)eid;
-    }
-
-    if(n->childCount() > 0)
-    {
-      int found = FindEvent(n, filter, after, forward);
-
-      if(found > 0)
-        return found;
-    }
-  }
-
-  return -1;
+  return m_Model->setFindFilter(filter);
 }
 
 int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
@@ -721,7 +923,7 @@ int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
   if(!m_Ctx.LogLoaded())
     return 0;
 
-  return FindEvent(ui->events->topLevelItem(0), filter, after, forward);
+  return m_Model->findText(filter, after, forward);
 }
 
 void EventBrowser::Find(bool forward)
@@ -730,8 +932,8 @@ void EventBrowser::Find(bool forward)
     return;
 
   uint32_t curEID = m_Ctx.CurEvent();
-  if(!ui->events->selectedItems().isEmpty())
-    curEID = ui->events->selectedItems()[0]->data(COL_LAST_EID, Qt::UserRole).toUInt();
+  if(ui->events->currentIndex().isValid())
+    curEID = m_Model->lastEID(ui->events->currentIndex());
 
   int eid = FindEvent(ui->findEvent->text(), curEID, forward);
   if(eid >= 0)
@@ -33,10 +33,11 @@ namespace Ui
 class EventBrowser;
 }
 
+class QModelIndex;
 class QSpacerItem;
 class QToolButton;
-class QTreeWidgetItem;
 class QTimer;
+class EventItemModel;
 class FlowLayout;
 class SizeDelegate;
 
@@ -49,6 +50,7 @@ public:
   explicit EventBrowser(CaptureContext &ctx, QWidget *parent = 0);
   ~EventBrowser();
 
+  void OnDrawcallsLoaded();
   void OnLogfileLoaded();
   void OnLogfileClosed();
   void OnSelectedEventChanged(uint32_t eventID) {}
@@ -65,7 +67,6 @@ private slots:
   void on_findEvent_returnPressed();
   void on_findEvent_keyPress(QKeyEvent *event);
   void on_findEvent_textEdited(const QString &arg1);
-  void on_events_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
   void on_findNext_clicked();
   void on_findPrev_clicked();
   void on_stepNext_clicked();
@@ -74,6 +75,7 @@ private slots:
   // manual slots
   void findHighlight_timeout();
   void events_keyPress(QKeyEvent *event);
+  void events_currentChanged(const QModelIndex &current, const QModelIndex &previous);
 
 public slots:
   void clearBookmarks();
@@ -82,32 +84,23 @@ public slots:
   void jumpToBookmark(int idx);
 
 private:
-  uint AddDrawcalls(QTreeWidgetItem *parent, const rdctype::array<FetchDrawcall> &draws);
-  void SetDrawcallTimes(QTreeWidgetItem *node, const rdctype::array<CounterResult> &results);
+  void SetDrawcallTimes(const rdctype::array<CounterResult> &results);
+  void FetchDrawcallTimes(RenderManager::InvokePriority priority);
+  void LoadCachedDrawcallTimes();
 
-  void ExpandNode(QTreeWidgetItem *node);
+  void ExpandNode(const QModelIndex &idx);
 
-  bool FindEventNode(QTreeWidgetItem *&found, QTreeWidgetItem *parent, uint32_t eventID);
   bool SelectEvent(uint32_t eventID);
 
-  void ClearFindIcons(QTreeWidgetItem *parent);
   void ClearFindIcons();
-
-  int SetFindIcons(QTreeWidgetItem *parent, QString filter);
   int SetFindIcons(QString filter);
 
   void highlightBookmarks();
-  bool hasBookmark(QTreeWidgetItem *node);
 
-  QTreeWidgetItem *FindNode(QTreeWidgetItem *parent, QString filter, uint32_t after);
-  int FindEvent(QTreeWidgetItem *parent, QString filter, uint32_t after, bool forward);
   int FindEvent(QString filter, uint32_t after, bool forward);
   void Find(bool forward);
 
-  QIcon m_CurrentIcon;
-  QIcon m_FindIcon;
-  QIcon m_BookmarkIcon;
-
+  EventItemModel *m_Model;
   SizeDelegate *m_SizeDelegate;
   QTimer *m_FindHighlight;
 
@@ -116,8 +109,6 @@ private:
   QList<int> m_Bookmarks;
   QList<QToolButton *> m_BookmarkButtons;
 
-  void RefreshIcon(QTreeWidgetItem *item);
-
   Ui::EventBrowser *ui;
   CaptureContext &m_Ctx;
 };
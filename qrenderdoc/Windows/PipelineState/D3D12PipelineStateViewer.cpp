@@ -99,6 +99,22 @@ struct ViewTag
 
 Q_DECLARE_METATYPE(ViewTag);
 
+// register spaces in a bindless root signature can hold many thousands of views, so only this many
+// rows are listed at once for each space. The rest are listed on demand.
+static const int RegisterPageSize = 256;
+
+struct RegisterPageTag
+{
+  RegisterPageTag() : uav(false), space(0), next(0) {}
+  RegisterPageTag(bool u, int s, int n) : uav(u), space(s), next(n) {}
+  bool uav;
+  int space;
+  // the first register that hasn't been listed yet
+  int next;
+};
+
+Q_DECLARE_METATYPE(RegisterPageTag);
+
 D3D12PipelineStateViewer::D3D12PipelineStateViewer(CaptureContext &ctx, PipelineStateViewer &common,
                                                    QWidget *parent)
     : QFrame(parent), ui(new Ui::D3D12PipelineStateViewer), m_Ctx(ctx), m_Common(common)
@@ -580,9 +596,8 @@ void D3D12PipelineStateViewer::setViewDetails(QTreeWidgetItem *node, const ViewT
   }
 }
 
-void D3D12PipelineStateViewer::addResourceRow(const ViewTag &view,
-                                              const D3D12PipelineState::ShaderStage *stage,
-                                              RDTreeWidget *resources)
+QTreeWidgetItem *D3D12PipelineStateViewer::makeResourceRow(
+    const ViewTag &view, const D3D12PipelineState::ShaderStage *stage, RDTreeWidget *resources)
 {
   const QIcon &action = Icons::action();
   const QIcon &action_hover = Icons::action_hover();
@@ -592,7 +607,7 @@ void D3D12PipelineStateViewer::addResourceRow(const ViewTag &view,
 
   // consider this register to not exist - it's in a gap defined by sparse root signature elements
   if(r.RootElement == ~0U)
-    return;
+    return NULL;
 
   const BindpointMap *bind = NULL;
   const ShaderResource *shaderInput = NULL;
@@ -751,7 +766,47 @@ void D3D12PipelineStateViewer::addResourceRow(const ViewTag &view,
     if(!usedSlot)
       setInactiveRow(node);
 
-    resources->addTopLevelItem(node);
+    return node;
+  }
+
+  return NULL;
+}
+
+void D3D12PipelineStateViewer::addRegisterRows(const D3D12PipelineState::ShaderStage &stage,
+                                               bool uav, int space, int firstReg,
+                                               RDTreeWidget *resources, int insertAt)
+{
+  const rdctype::array<D3D12PipelineState::ResourceView> &views =
+      uav ? stage.Spaces[space].UAVs : stage.Spaces[space].SRVs;
+
+  int rows = 0;
+
+  for(int reg = firstReg; reg < views.count; reg++)
+  {
+    // once a page of rows is listed, the rest of the space is left behind a placeholder row
+    if(rows == RegisterPageSize)
+    {
+      QTreeWidgetItem *node = makeTreeNode({
+          "", space, QString("%1..%2").arg(reg).arg(views.count - 1),
+          tr("%1 more registers").arg(views.count - reg), tr("Activate to list more"), "", "", "",
+          "", "", "",
+      });
+
+      node->setData(0, Qt::UserRole, QVariant::fromValue(RegisterPageTag(uav, space, reg)));
+
+      resources->insertTopLevelItem(insertAt, node);
+      return;
+    }
+
+    QTreeWidgetItem *node =
+        makeResourceRow(ViewTag(uav ? ViewTag::UAV : ViewTag::SRV, space, reg, views[reg]),
+                        &stage, resources);
+
+    if(node)
+    {
+      resources->insertTopLevelItem(insertAt++, node);
+      rows++;
+    }
   }
 }
 
@@ -912,13 +967,7 @@ void D3D12PipelineStateViewer::setShaderState(const D3D12PipelineState::ShaderSt
   resources->setUpdatesEnabled(false);
   resources->clear();
   for(int space = 0; space < stage.Spaces.count; space++)
-  {
-    for(int reg = 0; reg < stage.Spaces[space].SRVs.count; reg++)
-    {
-      addResourceRow(ViewTag(ViewTag::SRV, space, reg, stage.Spaces[space].SRVs[reg]), &stage,
-                     resources);
-    }
-  }
+    addRegisterRows(stage, false, space, 0, resources, resources->topLevelItemCount());
   resources->clearSelection();
   resources->setUpdatesEnabled(true);
   resources->verticalScrollBar()->setValue(vs);
@@ -927,12 +976,7 @@ void D3D12PipelineStateViewer::setShaderState(const D3D12PipelineState::ShaderSt
   uavs->setUpdatesEnabled(false);
   uavs->clear();
   for(int space = 0; space < stage.Spaces.count; space++)
-  {
-    for(int reg = 0; reg < stage.Spaces[space].UAVs.count; reg++)
-    {
-      addResourceRow(ViewTag(ViewTag::UAV, space, reg, stage.Spaces[space].UAVs[reg]), &stage, uavs);
-    }
-  }
+    addRegisterRows(stage, true, space, 0, uavs, uavs->topLevelItemCount());
   uavs->clearSelection();
   uavs->setUpdatesEnabled(true);
   uavs->verticalScrollBar()->setValue(vs);
@@ -1532,14 +1576,22 @@ void D3D12PipelineStateViewer::setState()
   {
     for(int i = 0; i < state.m_OM.RenderTargets.count; i++)
     {
-      addResourceRow(ViewTag(ViewTag::OMTarget, 0, i, state.m_OM.RenderTargets[i]), NULL,
-                     ui->targetOutputs);
+      QTreeWidgetItem *node = makeResourceRow(
+          ViewTag(ViewTag::OMTarget, 0, i, state.m_OM.RenderTargets[i]), NULL, ui->targetOutputs);
+
+      if(node)
+        ui->targetOutputs->addTopLevelItem(node);
 
       if(state.m_OM.RenderTargets[i].Resource != ResourceId())
         targets[i] = true;
     }
 
-    addResourceRow(ViewTag(ViewTag::OMDepth, 0, 0, state.m_OM.DepthTarget), NULL, ui->targetOutputs);
+    QTreeWidgetItem *node =
+        makeResourceRow(ViewTag(ViewTag::OMDepth, 0, 0, state.m_OM.DepthTarget), NULL,
+                        ui->targetOutputs);
+
+    if(node)
+      ui->targetOutputs->addTopLevelItem(node);
   }
   ui->targetOutputs->clearSelection();
   ui->targetOutputs->setUpdatesEnabled(true);
@@ -1689,6 +1741,23 @@ void D3D12PipelineStateViewer::resource_itemActivated(QTreeWidgetItem *item, int
 
   QVariant tag = item->data(0, Qt::UserRole);
 
+  if(tag.canConvert<RegisterPageTag>())
+  {
+    RegisterPageTag page = tag.value<RegisterPageTag>();
+
+    RDTreeWidget *resources = (RDTreeWidget *)item->treeWidget();
+
+    // the next page is listed where the placeholder was
+    int insertAt = resources->indexOfTopLevelItem(item);
+    delete item;
+
+    resources->setUpdatesEnabled(false);
+    addRegisterRows(*stage, page.uav, page.space, page.next, resources, insertAt);
+    resources->setUpdatesEnabled(true);
+
+    return;
+  }
+
   FetchTexture *tex = NULL;
   FetchBuffer *buf = NULL;
 
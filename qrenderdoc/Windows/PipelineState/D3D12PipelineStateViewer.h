@@ -86,8 +86,11 @@ private:
   void setShaderState(const D3D12PipelineState::ShaderStage &stage, QLabel *shader, RDTreeWidget *tex,
                       RDTreeWidget *samp, RDTreeWidget *cbuffer, RDTreeWidget *uavs);
 
-  void addResourceRow(const ViewTag &view, const D3D12PipelineState::ShaderStage *stage,
-                      RDTreeWidget *resources);
+  QTreeWidgetItem *makeResourceRow(const ViewTag &view,
+                                   const D3D12PipelineState::ShaderStage *stage,
+                                   RDTreeWidget *resources);
+  void addRegisterRows(const D3D12PipelineState::ShaderStage &stage, bool uav, int space,
+                       int firstReg, RDTreeWidget *resources, int insertAt);
 
   void clearShaderState(QLabel *shader, RDTreeWidget *tex, RDTreeWidget *samp,
                         RDTreeWidget *cbuffer, RDTreeWidget *uavs);
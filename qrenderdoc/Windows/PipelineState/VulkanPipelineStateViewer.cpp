@@ -92,6 +92,23 @@ struct BufferTag
 
 Q_DECLARE_METATYPE(BufferTag);
 
+struct DescriptorPageTag
+{
+  DescriptorPageTag() { bindset = bind = next = 0; }
+  DescriptorPageTag(int s, int b, int n)
+  {
+    bindset = s;
+    bind = b;
+    next = n;
+  }
+  int bindset;
+  int bind;
+  // the first array element that hasn't been listed yet
+  int next;
+};
+
+Q_DECLARE_METATYPE(DescriptorPageTag);
+
 VulkanPipelineStateViewer::VulkanPipelineStateViewer(CaptureContext &ctx,
                                                      PipelineStateViewer &common, QWidget *parent)
     : QFrame(parent), ui(new Ui::VulkanPipelineStateViewer), m_Ctx(ctx), m_Common(common)
@@ -668,7 +685,8 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
                                                int bindset, int bind,
                                                const VulkanPipelineState::Pipeline &pipe,
                                                RDTreeWidget *resources,
-                                               QMap<ResourceId, SamplerData> &samplers)
+                                               QMap<ResourceId, SamplerData> &samplers,
+                                               QTreeWidgetItem *pageNode)
 {
   const ShaderResource *shaderRes = NULL;
   const BindpointMap *bindMap = NULL;
@@ -744,6 +762,13 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
 
   // TODO - check compatibility between bindType and shaderRes.resType ?
 
+  int arrayLength = 0;
+  if(slotBinds != NULL)
+    arrayLength =
+        qMax((int)pipe.DescSets[bindset].bindings[bind].descriptorCount, (int)slotBinds->count);
+  else
+    arrayLength = (int)bindMap->arraySize;
+
   // consider it filled if any array element is filled
   bool filledSlot = false;
   for(int idx = 0; slotBinds != NULL && idx < slotBinds->count; idx++)
@@ -753,11 +778,17 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
       filledSlot |= (*slotBinds)[idx].sampler != ResourceId();
   }
 
+  // only the first page of a large array is in the pipeline state, so we can't tell if the rest
+  // is empty. Assume it isn't, rather than hiding it.
+  if(slotBinds != NULL && slotBinds->count < arrayLength)
+    filledSlot = true;
+
   // if it's masked out by stage bits, act as if it's not filled, so it's marked in red
   if(!stageBitsIncluded)
     filledSlot = false;
 
-  if(showNode(usedSlot, filledSlot))
+  // a page node is already listed, so it's shown regardless
+  if(pageNode != NULL || showNode(usedSlot, filledSlot))
   {
     QTreeWidgetItem *parentNode = resources->invisibleRootItem();
 
@@ -767,14 +798,36 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
     if(shaderRes != NULL && shaderRes->name.count > 0)
       slotname += ": " + ToQStr(shaderRes->name);
 
-    int arrayLength = 0;
-    if(slotBinds != NULL)
-      arrayLength = slotBinds->count;
-    else
-      arrayLength = (int)bindMap->arraySize;
+    // large arrays are listed a page at a time, starting with the elements that came with the
+    // pipeline state. The next page is fetched when the placeholder row after it is activated.
+    const rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+        *elements = slotBinds;
+    rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+        page;
+    int firstElement = 0;
+
+    if(pageNode != NULL)
+    {
+      parentNode = pageNode->parent();
+      firstElement = pageNode->data(0, Qt::UserRole).value<DescriptorPageTag>().next;
+
+      // the placeholder is always the last child, so the new page is appended in its place
+      delete pageNode;
 
+      if(slotBinds != NULL)
+      {
+        m_Ctx.Renderer().BlockInvoke(
+            [&stage, bindset, bind, firstElement, &page](IReplayRenderer *r) {
+              r->GetVulkanDescriptorBindings(stage.stage, (uint32_t)bindset, (uint32_t)bind,
+                                             (uint32_t)firstElement,
+                                             CaptureContext::VulkanDescriptorPageSize, &page);
+            });
+
+        elements = &page;
+      }
+    }
     // for arrays, add a parent element that we add the real cbuffers below
-    if(arrayLength > 1)
+    else if(arrayLength > 1)
     {
       QTreeWidgetItem *node =
           makeTreeNode({"", setname, slotname, tr("Array[%1]").arg(arrayLength), "", "", "", ""});
@@ -792,12 +845,15 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
       parentNode = node;
     }
 
-    for(int idx = 0; idx < arrayLength; idx++)
+    int lastElement =
+        qMin(arrayLength, firstElement + (int)CaptureContext::VulkanDescriptorPageSize);
+
+    for(int idx = firstElement; idx < lastElement; idx++)
     {
       const VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement *descriptorBind =
           NULL;
-      if(slotBinds != NULL)
-        descriptorBind = &(*slotBinds)[idx];
+      if(elements != NULL && idx - firstElement < elements->count)
+        descriptorBind = &(*elements)[idx - firstElement];
 
       if(arrayLength > 1)
       {
@@ -1041,6 +1097,20 @@ void VulkanPipelineStateViewer::addResourceRow(ShaderReflection *shaderDetails,
       if(samplerNode)
         parentNode->addChild(samplerNode);
     }
+
+    if(lastElement < arrayLength)
+    {
+      QTreeWidgetItem *node = makeTreeNode({
+          "", bindset, QString("%1[%2..%3]").arg(bind).arg(lastElement).arg(arrayLength - 1),
+          tr("%1 more elements").arg(arrayLength - lastElement), tr("Activate to list more"), "",
+          "",
+      });
+
+      node->setData(0, Qt::UserRole,
+                    QVariant::fromValue(DescriptorPageTag(bindset, bind, lastElement)));
+
+      parentNode->addChild(node);
+    }
   }
 }
 
@@ -1276,7 +1346,7 @@ void VulkanPipelineStateViewer::setShaderState(const VulkanPipelineState::Shader
   {
     for(int bind = 0; bind < pipe.DescSets[bindset].bindings.count; bind++)
     {
-      addResourceRow(shaderDetails, stage, bindset, bind, pipe, resources, samplers);
+      addResourceRow(shaderDetails, stage, bindset, bind, pipe, resources, samplers, NULL);
     }
 
     // if we have a shader bound, go through and add rows for any resources it wants for binds that
@@ -1294,7 +1364,7 @@ void VulkanPipelineStateViewer::setShaderState(const VulkanPipelineState::Shader
         {
           addResourceRow(shaderDetails, stage, bindset,
                          stage.BindpointMapping.ReadOnlyResources[ro.bindPoint].bind, pipe,
-                         resources, samplers);
+                         resources, samplers, NULL);
         }
       }
 
@@ -1308,7 +1378,7 @@ void VulkanPipelineStateViewer::setShaderState(const VulkanPipelineState::Shader
         {
           addResourceRow(shaderDetails, stage, bindset,
                          stage.BindpointMapping.ReadWriteResources[rw.bindPoint].bind, pipe,
-                         resources, samplers);
+                         resources, samplers, NULL);
         }
       }
     }
@@ -1327,7 +1397,8 @@ void VulkanPipelineStateViewer::setShaderState(const VulkanPipelineState::Shader
       {
         addResourceRow(
             shaderDetails, stage, stage.BindpointMapping.ReadOnlyResources[ro.bindPoint].bindset,
-            stage.BindpointMapping.ReadOnlyResources[ro.bindPoint].bind, pipe, resources, samplers);
+            stage.BindpointMapping.ReadOnlyResources[ro.bindPoint].bind, pipe, resources, samplers,
+            NULL);
       }
     }
 
@@ -1339,7 +1410,8 @@ void VulkanPipelineStateViewer::setShaderState(const VulkanPipelineState::Shader
       {
         addResourceRow(
             shaderDetails, stage, stage.BindpointMapping.ReadWriteResources[rw.bindPoint].bindset,
-            stage.BindpointMapping.ReadWriteResources[rw.bindPoint].bind, pipe, resources, samplers);
+            stage.BindpointMapping.ReadWriteResources[rw.bindPoint].bind, pipe, resources, samplers,
+            NULL);
       }
     }
   }
@@ -2034,6 +2106,27 @@ void VulkanPipelineStateViewer::resource_itemActivated(QTreeWidgetItem *item, in
 
   QVariant tag = item->data(0, Qt::UserRole);
 
+  if(tag.canConvert<DescriptorPageTag>())
+  {
+    DescriptorPageTag page = tag.value<DescriptorPageTag>();
+
+    const VulkanPipelineState::Pipeline &pipe = stage->stage == eShaderStage_Compute
+                                                    ? m_Ctx.CurVulkanPipelineState.compute
+                                                    : m_Ctx.CurVulkanPipelineState.graphics;
+
+    RDTreeWidget *resources = (RDTreeWidget *)item->treeWidget();
+
+    // samplers in the new page are only de-duplicated against each other
+    QMap<ResourceId, SamplerData> samplers;
+
+    resources->setUpdatesEnabled(false);
+    addResourceRow(stage->ShaderDetails, *stage, page.bindset, page.bind, pipe, resources,
+                   samplers, item);
+    resources->setUpdatesEnabled(true);
+
+    return;
+  }
+
   if(tag.canConvert<ResourceId>())
   {
     FetchTexture *tex = m_Ctx.GetTexture(tag.value<ResourceId>());
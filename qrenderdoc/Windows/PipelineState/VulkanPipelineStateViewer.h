@@ -88,7 +88,8 @@ private:
       const VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement &descriptor);
   void addResourceRow(ShaderReflection *shaderDetails, const VulkanPipelineState::ShaderStage &stage,
                       int bindset, int bind, const VulkanPipelineState::Pipeline &pipe,
-                      RDTreeWidget *resources, QMap<ResourceId, SamplerData> &samplers);
+                      RDTreeWidget *resources, QMap<ResourceId, SamplerData> &samplers,
+                      QTreeWidgetItem *pageNode);
   void addConstantBlockRow(ShaderReflection *shaderDetails,
                            const VulkanPipelineState::ShaderStage &stage, int bindset, int bind,
                            const VulkanPipelineState::Pipeline &pipe, RDTreeWidget *ubos);
@@ -27,6 +27,9 @@
 #include <math.h>
 #include <QAction>
 #include <QMenu>
+#include <QScrollBar>
+#include <QSet>
+#include <QTimer>
 #include "3rdparty/toolwindowmanager/ToolWindowManager.h"
 #include "Windows/BufferViewer.h"
 #include "Windows/ShaderViewer.h"
@@ -75,23 +78,53 @@ public:
     }
   }
 
-  void setHistory(const rdctype::array<PixelModification> &history)
+  // batches arrive most recent first, so each one goes before everything already received
+  void addHistory(const rdctype::array<PixelModification> &batch)
   {
-    m_ModList.reserve(history.count);
-    for(const PixelModification &h : history)
-      m_ModList.push_back(h);
+    if(batch.count == 0)
+      return;
+
+    QVector<PixelModification> mods;
+    mods.reserve(batch.count + m_ModList.count());
+    for(const PixelModification &h : batch)
+      mods.push_back(h);
+    mods += m_ModList;
+
+    m_ModList.swap(mods);
 
     m_Loading = false;
+    m_Progress = -1.0f;
 
-    emit beginResetModel();
+    setShowFailures(m_ShowFailures);
+  }
 
-    setShowFailures(true);
+  void finishHistory()
+  {
+    if(!m_Loading)
+      return;
 
-    emit endResetModel();
+    m_Loading = false;
+    m_Progress = -1.0f;
+
+    setShowFailures(m_ShowFailures);
+  }
+
+  bool isLoading() const { return m_Loading; }
+
+  void setProgress(float progress)
+  {
+    if(!m_Loading)
+      return;
+
+    m_Progress = progress;
+
+    emit dataChanged(index(0, 0), index(0, 0));
   }
 
   void setShowFailures(bool show)
   {
+    m_ShowFailures = show;
+
     emit beginResetModel();
 
     m_History.clear();
@@ -185,7 +218,12 @@ public:
       if(m_Loading)
       {
         if(role == Qt::DisplayRole && col == 0)
+        {
+          if(m_Progress >= 0.0f)
+            return QString("Loading... %1%").arg(int(m_Progress * 100.0f));
+
           return "Loading...";
+        }
 
         return QVariant();
       }
@@ -397,6 +435,8 @@ private:
   bool m_IsDepth = false, m_IsUint = false, m_IsSint = false, m_IsFloat = true;
 
   bool m_Loading = true;
+  bool m_ShowFailures = true;
+  float m_Progress = -1.0f;
   QVector<QList<PixelModification>> m_History;
   QVector<PixelModification> m_ModList;
 
@@ -597,7 +637,8 @@ PixelHistoryView::PixelHistoryView(CaptureContext &ctx, ResourceId id, QPoint po
       "Double click to jump to an event.\n"
       "Right click to debug an event, or hide failed events.";
 
-  ui->label->setText(text);
+  m_Description = text;
+  ui->label->setText(m_Description);
 
   ui->eventsHidden->setVisible(false);
 
@@ -615,6 +656,10 @@ PixelHistoryView::PixelHistoryView(CaptureContext &ctx, ResourceId id, QPoint po
 
 PixelHistoryView::~PixelHistoryView()
 {
+  // nothing is waiting for the results any more
+  if(m_Invoke)
+    m_Invoke->abort();
+
   ui->events->setModel(NULL);
   delete ui;
 }
@@ -628,9 +673,74 @@ void PixelHistoryView::OnLogfileClosed()
   ToolWindowManager::closeToolWindow(this);
 }
 
-void PixelHistoryView::setHistory(const rdctype::array<PixelModification> &history)
+void PixelHistoryView::addHistory(const rdctype::array<PixelModification> &batch)
+{
+  if(batch.count == 0)
+    return;
+
+  // the model is reset with each batch, so keep the events that were expanded open and the view
+  // the same distance from the most recent event at the bottom
+  QSet<uint32_t> expanded;
+  for(int i = 0; !m_Model->isLoading() && i < m_Model->rowCount(); i++)
+  {
+    QModelIndex idx = m_Model->index(i, 0);
+    if(ui->events->isExpanded(idx))
+      expanded.insert(m_Model->data(idx, Qt::UserRole).value<EventTag>().eventID);
+  }
+
+  QScrollBar *scroll = ui->events->verticalScrollBar();
+  int fromBottom = scroll->maximum() - scroll->value();
+
+  m_Model->addHistory(batch);
+
+  for(int i = 0; !expanded.isEmpty() && i < m_Model->rowCount(); i++)
+  {
+    QModelIndex idx = m_Model->index(i, 0);
+    if(expanded.contains(m_Model->data(idx, Qt::UserRole).value<EventTag>().eventID))
+      ui->events->expand(idx);
+  }
+
+  scroll->setValue(scroll->maximum() - fromBottom);
+}
+
+void PixelHistoryView::finishHistory()
+{
+  m_Invoke.clear();
+
+  if(m_ProgressTimer)
+    m_ProgressTimer->stop();
+
+  ui->label->setText(m_Description);
+
+  m_Model->finishHistory();
+}
+
+void PixelHistoryView::setInvoke(RenderManager::InvokeHandlePtr invoke)
 {
-  m_Model->setHistory(history);
+  // the history may already have arrived
+  if(invoke->isFinished() || invoke->isCancelled())
+    return;
+
+  m_Invoke = invoke;
+
+  if(!m_ProgressTimer)
+  {
+    m_ProgressTimer = new QTimer(this);
+    m_ProgressTimer->setInterval(100);
+    QObject::connect(m_ProgressTimer, &QTimer::timeout, [this]() {
+      if(!m_Invoke)
+        return;
+
+      float progress = m_Invoke->progress();
+
+      // the loading row only shows until the first modifications arrive
+      m_Model->setProgress(progress);
+      ui->label->setText(
+          m_Description + tr("\n\nFetching history... %1%").arg(int(progress * 100.0f)));
+    });
+  }
+
+  m_ProgressTimer->start();
 }
 
 void PixelHistoryView::startDebug(EventTag tag)
@@ -639,21 +749,21 @@ void PixelHistoryView::startDebug(EventTag tag)
 
   ShaderDebugTrace *trace = new ShaderDebugTrace;
 
-  bool success = false;
+  uint32_t session = 0, numSteps = 0;
 
-  m_Ctx.Renderer().BlockInvoke([this, &success, trace](IReplayRenderer *r) {
-    success =
-        r->DebugPixel((uint32_t)m_Pixel.x(), (uint32_t)m_Pixel.y(), m_Display.sampleIdx, ~0U, trace);
+  m_Ctx.Renderer().BlockInvoke([this, &session, &numSteps, trace](IReplayRenderer *r) {
+    session = r->DebugPixelSession((uint32_t)m_Pixel.x(), (uint32_t)m_Pixel.y(),
+                                   m_Display.sampleIdx, ~0U, trace, &numSteps);
   });
 
-  if(!success || trace->states.count == 0)
+  if(session == 0)
   {
     RDDialog::critical(this, tr("Debug Error"), tr("Error debugging pixel."));
     delete trace;
     return;
   }
 
-  GUIInvoke::call([this, trace]() {
+  GUIInvoke::call([this, trace, session, numSteps]() {
     QString debugContext = QString("Pixel %1,%2").arg(m_Pixel.x()).arg(m_Pixel.y());
 
     const ShaderReflection *shaderDetails =
@@ -662,8 +772,9 @@ void PixelHistoryView::startDebug(EventTag tag)
         m_Ctx.CurPipelineState.GetBindpointMapping(eShaderStage_Pixel);
 
     // viewer takes ownership of the trace
-    ShaderViewer *s = ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails,
-                                                eShaderStage_Pixel, trace, debugContext, this);
+    ShaderViewer *s =
+        ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails, eShaderStage_Pixel, trace,
+                                  session, numSteps, debugContext, this);
 
     m_Ctx.setupDockWindow(s);
 
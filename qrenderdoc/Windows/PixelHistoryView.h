@@ -32,6 +32,7 @@ namespace Ui
 class PixelHistoryView;
 }
 
+class QTimer;
 class CaptureContext;
 class PixelHistoryItemModel;
 struct EventTag;
@@ -49,7 +50,11 @@ public:
   void OnLogfileClosed();
   void OnSelectedEventChanged(uint32_t eventID) {}
   void OnEventChanged(uint32_t eventID) {}
-  void setHistory(const rdctype::array<PixelModification> &history);
+  // the history is filled in a batch at a time, most recent events first
+  void addHistory(const rdctype::array<PixelModification> &batch);
+  void finishHistory();
+  // the invoke fetching the history, aborted if the view is closed before it completes
+  void setInvoke(RenderManager::InvokeHandlePtr invoke);
 
 private slots:
   // automatic slots
@@ -63,6 +68,9 @@ private:
   TextureDisplay m_Display;
   QPoint m_Pixel;
   PixelHistoryItemModel *m_Model;
+  RenderManager::InvokeHandlePtr m_Invoke;
+  QString m_Description;
+  QTimer *m_ProgressTimer = NULL;
   bool m_ShowFailures = true;
   void startDebug(EventTag tag);
   void jumpToPrimitive(EventTag tag);
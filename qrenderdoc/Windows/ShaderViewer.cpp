@@ -250,12 +250,14 @@ void ShaderViewer::editShader(bool customShader, const QString &entryPoint, cons
 }
 
 void ShaderViewer::debugShader(const ShaderBindpointMapping *bind, const ShaderReflection *shader,
-                               ShaderStageType stage, ShaderDebugTrace *trace,
-                               const QString &debugContext)
+                               ShaderStageType stage, ShaderDebugTrace *trace, uint32_t session,
+                               uint32_t numSteps, const QString &debugContext)
 {
   m_Mapping = bind;
   m_ShaderDetails = shader;
   m_Trace = trace;
+  m_DebugSession = session;
+  m_NumSteps = (int)numSteps;
   m_Stage = stage;
 
   // no replacing allowed, stay in find mode
@@ -480,6 +482,12 @@ ShaderViewer::~ShaderViewer()
 {
   delete m_Trace;
 
+  if(m_DebugSession)
+  {
+    uint32_t session = m_DebugSession;
+    m_Ctx.Renderer().AsyncInvoke([session](IReplayRenderer *r) { r->EndDebugSession(session); });
+  }
+
   if(m_CloseCallback)
     m_CloseCallback(&m_Ctx);
 
@@ -616,7 +624,7 @@ bool ShaderViewer::stepNext()
   if(!m_Trace)
     return false;
 
-  if(currentStep() + 1 >= m_Trace->states.count)
+  if(currentStep() + 1 >= m_NumSteps)
     return false;
 
   setCurrentStep(currentStep() + 1);
@@ -687,32 +695,20 @@ void ShaderViewer::runTo(int runToInstruction, bool forward, ShaderDebugStateFla
   if(!m_Trace)
     return;
 
-  int step = currentStep();
-
-  int inc = forward ? 1 : -1;
+  // the states are on the replay side, so the search runs there and only the step comes back
+  uint32_t session = m_DebugSession;
+  uint32_t step = (uint32_t)currentStep();
 
-  bool firstStep = true;
+  std::vector<uint32_t> breakpoints;
+  for(int b : m_Breakpoints)
+    breakpoints.push_back((uint32_t)b);
 
-  while(step < m_Trace->states.count)
-  {
-    if(runToInstruction >= 0 && m_Trace->states[step].nextInstruction == (uint32_t)runToInstruction)
-      break;
-
-    if(!firstStep && (m_Trace->states[step + inc].flags & condition))
-      break;
-
-    if(!firstStep && m_Breakpoints.contains((int)m_Trace->states[step].nextInstruction))
-      break;
-
-    firstStep = false;
-
-    if(step + inc < 0 || step + inc >= m_Trace->states.count)
-      break;
-
-    step += inc;
-  }
+  m_Ctx.Renderer().BlockInvoke([&](IReplayRenderer *r) {
+    step = r->FindDebugStep(session, step, forward, runToInstruction, condition,
+                            breakpoints.data(), (uint32_t)breakpoints.size());
+  });
 
-  setCurrentStep(step);
+  setCurrentStep((int)step);
 }
 
 QString ShaderViewer::stringRep(const ShaderVariable &var, bool useType)
@@ -800,15 +796,15 @@ void ShaderViewer::addFileList()
 
 void ShaderViewer::updateDebugging()
 {
-  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_Trace->states.count)
+  if(!m_Trace || m_CurrentStep < 0 || m_CurrentStep >= m_NumSteps)
     return;
 
-  const ShaderDebugState &state = m_Trace->states[m_CurrentStep];
+  const ShaderDebugState &state = debugState(m_CurrentStep);
 
   uint32_t nextInst = state.nextInstruction;
   bool done = false;
 
-  if(m_CurrentStep == m_Trace->states.count - 1)
+  if(m_CurrentStep == m_NumSteps - 1)
   {
     nextInst--;
     done = true;
@@ -1014,10 +1010,39 @@ int ShaderViewer::currentStep()
   return m_CurrentStep;
 }
 
+const ShaderDebugState &ShaderViewer::debugState(int step)
+{
+  if(step < m_StateWindowStart || step >= m_StateWindowStart + m_StateWindow.count)
+  {
+    // fetch a window mostly ahead of the step, since stepping forward is the common case
+    const int WindowSize = 64;
+
+    m_StateWindowStart = qBound(0, step - WindowSize / 4, qMax(0, m_NumSteps - WindowSize));
+
+    uint32_t session = m_DebugSession;
+    uint32_t first = (uint32_t)m_StateWindowStart;
+    uint32_t count = (uint32_t)WindowSize;
+
+    m_StateWindow.Delete();
+
+    m_Ctx.Renderer().BlockInvoke([this, session, first, count](IReplayRenderer *r) {
+      r->GetDebugStates(session, first, count, &m_StateWindow);
+    });
+  }
+
+  if(step < m_StateWindowStart || step >= m_StateWindowStart + m_StateWindow.count)
+  {
+    static ShaderDebugState empty;
+    return empty;
+  }
+
+  return m_StateWindow[step - m_StateWindowStart];
+}
+
 void ShaderViewer::setCurrentStep(int step)
 {
-  if(m_Trace && !m_Trace->states.empty())
-    m_CurrentStep = qBound(0, step, m_Trace->states.count - 1);
+  if(m_Trace && m_NumSteps > 0)
+    m_CurrentStep = qBound(0, step, m_NumSteps - 1);
   else
     m_CurrentStep = 0;
 
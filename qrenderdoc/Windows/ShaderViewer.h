@@ -60,13 +60,15 @@ public:
     return ret;
   }
 
+  // the trace holds the inputs and cbuffers for the debug session, the states are fetched from
+  // the replay as they're stepped through. The viewer takes ownership of both.
   static ShaderViewer *debugShader(CaptureContext &ctx, const ShaderBindpointMapping *bind,
                                    const ShaderReflection *shader, ShaderStageType stage,
-                                   ShaderDebugTrace *trace, const QString &debugContext,
-                                   QWidget *parent)
+                                   ShaderDebugTrace *trace, uint32_t session, uint32_t numSteps,
+                                   const QString &debugContext, QWidget *parent)
   {
     ShaderViewer *ret = new ShaderViewer(ctx, parent);
-    ret->debugShader(bind, shader, stage, trace, debugContext);
+    ret->debugShader(bind, shader, stage, trace, session, numSteps, debugContext);
     return ret;
   }
 
@@ -74,7 +76,7 @@ public:
                                   const ShaderReflection *shader, ShaderStageType stage,
                                   QWidget *parent)
   {
-    return ShaderViewer::debugShader(ctx, bind, shader, stage, NULL, "", parent);
+    return ShaderViewer::debugShader(ctx, bind, shader, stage, NULL, 0, 0, "", parent);
   }
 
   ~ShaderViewer();
@@ -128,7 +130,8 @@ private:
   explicit ShaderViewer(CaptureContext &ctx, QWidget *parent = 0);
   void editShader(bool customShader, const QString &entryPoint, const QStringMap &files);
   void debugShader(const ShaderBindpointMapping *bind, const ShaderReflection *shader,
-                   ShaderStageType stage, ShaderDebugTrace *trace, const QString &debugContext);
+                   ShaderStageType stage, ShaderDebugTrace *trace, uint32_t session,
+                   uint32_t numSteps, const QString &debugContext);
 
   Ui::ShaderViewer *ui;
   CaptureContext &m_Ctx;
@@ -162,7 +165,13 @@ private:
   CloseMethod m_CloseCallback;
 
   ShaderDebugTrace *m_Trace = NULL;
+  uint32_t m_DebugSession = 0;
+  int m_NumSteps = 0;
   int m_CurrentStep;
+
+  // the states fetched around the current step
+  rdctype::array<ShaderDebugState> m_StateWindow;
+  int m_StateWindowStart = 0;
   QList<int> m_Breakpoints;
 
   static const int CURRENT_MARKER = 0;
@@ -186,6 +195,7 @@ private:
   int instructionForLine(sptr_t line);
 
   void updateDebugging();
+  const ShaderDebugState &debugState(int step);
 
   void ensureLineScrolled(ScintillaEdit *s, int i);
 
@@ -24,8 +24,26 @@
 
 #include "StatisticsViewer.h"
 #include <QFontDatabase>
+#include <QPointer>
+#include <QScrollBar>
+#include <algorithm>
 #include "ui_StatisticsViewer.h"
 
+// everything the report is built from, copied on the UI thread so that the report can be
+// generated on a worker without touching the context's data as it changes.
+struct StatisticsSource
+{
+  QString logName;
+  QString stageAbbrevs[eShaderStage_Count];
+  FetchFrameInfo frameInfo;
+  rdctype::array<FetchTexture> textures;
+  rdctype::array<FetchBuffer> buffers;
+
+  // not copied, the drawcalls stay the same until the log is closed and the worker is stopped
+  // before that.
+  const rdctype::array<FetchDrawcall> *drawcalls;
+};
+
 static const int HistogramWidth = 128;
 static const QString Stars = QString(HistogramWidth, QChar('*'));
 
@@ -168,7 +186,7 @@ void AppendInputAssemblerStatistics(QString &statisticsLog, const FetchFrameInfo
                                                     vertices.bindslots));
 }
 
-void AppendShaderStatistics(CaptureContext &ctx, QString &statisticsLog,
+void AppendShaderStatistics(const StatisticsSource &src, QString &statisticsLog,
                             const FetchFrameInfo &frameInfo)
 {
   const FetchFrameShaderStats *shaders = frameInfo.stats.shaders;
@@ -188,7 +206,7 @@ void AppendShaderStatistics(CaptureContext &ctx, QString &statisticsLog,
   {
     statisticsLog.append(QString("%1 calls: %2, non-null shader sets: %3, null shader sets: %4, "
                                  "redundant shader sets: %5\n")
-                             .arg(ctx.CurPipelineState.Abbrev((ShaderStageType)s))
+                             .arg(src.stageAbbrevs[s])
                              .arg(shaders[s].calls)
                              .arg(shaders[s].sets)
                              .arg(shaders[s].nulls)
@@ -203,7 +221,7 @@ void AppendShaderStatistics(CaptureContext &ctx, QString &statisticsLog,
                            .arg(totalShadersPerStage.redundants));
 }
 
-void AppendConstantBindStatistics(CaptureContext &ctx, QString &statisticsLog,
+void AppendConstantBindStatistics(const StatisticsSource &src, QString &statisticsLog,
                                   const FetchFrameInfo &frameInfo)
 {
   // #mivance C++-side we guarantee all stages will have the same slots
@@ -263,7 +281,7 @@ void AppendConstantBindStatistics(CaptureContext &ctx, QString &statisticsLog,
   for(int s = eShaderStage_First; s < eShaderStage_Count; s++)
   {
     statisticsLog.append(QString("%1 calls: %2, non-null buffer sets: %3, null buffer sets: %4\n")
-                             .arg(ctx.CurPipelineState.Abbrev((ShaderStageType)s))
+                             .arg(src.stageAbbrevs[s])
                              .arg(totalConstantsPerStage[s].calls)
                              .arg(totalConstantsPerStage[s].sets)
                              .arg(totalConstantsPerStage[s].nulls));
@@ -299,7 +317,7 @@ void AppendConstantBindStatistics(CaptureContext &ctx, QString &statisticsLog,
   }
 }
 
-void AppendSamplerBindStatistics(CaptureContext &ctx, QString &statisticsLog,
+void AppendSamplerBindStatistics(const StatisticsSource &src, QString &statisticsLog,
                                  const FetchFrameInfo &frameInfo)
 {
   // #mivance see AppendConstantBindStatistics
@@ -348,7 +366,7 @@ void AppendSamplerBindStatistics(CaptureContext &ctx, QString &statisticsLog,
   for(int s = eShaderStage_First; s < eShaderStage_Count; s++)
   {
     statisticsLog.append(QString("%1 calls: %2, non-null sampler sets: %3, null sampler sets: %4\n")
-                             .arg(ctx.CurPipelineState.Abbrev((ShaderStageType)s))
+                             .arg(src.stageAbbrevs[s])
                              .arg(totalSamplersPerStage[s].calls)
                              .arg(totalSamplersPerStage[s].sets)
                              .arg(totalSamplersPerStage[s].nulls));
@@ -364,7 +382,7 @@ void AppendSamplerBindStatistics(CaptureContext &ctx, QString &statisticsLog,
       "Aggregate slot counts per invocation across all stages", totalSamplersForAllStages.bindslots));
 }
 
-void AppendResourceBindStatistics(CaptureContext &ctx, QString &statisticsLog,
+void AppendResourceBindStatistics(const StatisticsSource &src, QString &statisticsLog,
                                   const FetchFrameInfo &frameInfo)
 {
   // #mivance see AppendConstantBindStatistics
@@ -424,7 +442,7 @@ void AppendResourceBindStatistics(CaptureContext &ctx, QString &statisticsLog,
   for(int s = eShaderStage_First; s < eShaderStage_Count; s++)
   {
     statisticsLog.append(QString("%1 calls: %2 non-null resource sets: %3 null resource sets: %4\n")
-                             .arg(ctx.CurPipelineState.Abbrev((ShaderStageType)s))
+                             .arg(src.stageAbbrevs[s])
                              .arg(totalResourcesPerStage[s].calls)
                              .arg(totalResourcesPerStage[s].sets)
                              .arg(totalResourcesPerStage[s].nulls));
@@ -584,24 +602,119 @@ void AppendOutputStatistics(QString &statisticsLog, const FetchFrameInfo &frameI
   statisticsLog.append(CreateSimpleIntegerHistogram("Outputs set", outputs.bindslots));
 }
 
-void AppendDetailedInformation(CaptureContext &ctx, QString &statisticsLog,
-                               const FetchFrameInfo &frameInfo)
+struct PassStatistics
 {
-  if(frameInfo.stats.recorded == 0)
+  uint32_t draws = 0, dispatches = 0, clears = 0, copies = 0;
+  uint64_t indices = 0;
+  uint32_t firstEID = ~0U, lastEID = 0;
+
+  void add(const PassStatistics &o)
+  {
+    draws += o.draws;
+    dispatches += o.dispatches;
+    clears += o.clears;
+    copies += o.copies;
+    indices += o.indices;
+    firstEID = qMin(firstEID, o.firstEID);
+    lastEID = qMax(lastEID, o.lastEID);
+  }
+
+  void add(const FetchDrawcall &d)
+  {
+    if(d.flags & eDraw_Drawcall)
+    {
+      draws++;
+      indices += uint64_t(d.numIndices) * qMax(1U, d.numInstances);
+    }
+    if(d.flags & eDraw_Dispatch)
+      dispatches++;
+    if(d.flags & eDraw_Clear)
+      clears++;
+    if(d.flags & (eDraw_Copy | eDraw_Resolve))
+      copies++;
+
+    firstEID = qMin(firstEID, d.eventID);
+    lastEID = qMax(lastEID, d.eventID);
+  }
+
+  bool empty() const { return draws == 0 && dispatches == 0 && clears == 0 && copies == 0; }
+};
+
+QString FormatPassStatistics(const QString &name, const PassStatistics &pass)
+{
+  return QString("%1 %2 %3 %4 %5 %6 %7\n")
+      .arg(name.left(40), -40)
+      .arg(QString("%1-%2").arg(pass.firstEID).arg(pass.lastEID), 13)
+      .arg(pass.draws, 7)
+      .arg(pass.dispatches, 10)
+      .arg(pass.clears, 7)
+      .arg(pass.copies, 7)
+      .arg(pass.indices, 12);
+}
+
+// each marker region gets a line, placed before its children's lines even though its totals
+// are only known once they've been walked. Regions with no work in them are left out.
+PassStatistics CollectPassStatistics(const rdctype::array<FetchDrawcall> &draws, int depth,
+                                     QStringList &lines)
+{
+  PassStatistics total;
+
+  for(const FetchDrawcall &d : draws)
+  {
+    if(d.children.count == 0)
+    {
+      total.add(d);
+      continue;
+    }
+
+    int line = lines.count();
+    lines.push_back(QString());
+
+    PassStatistics pass = CollectPassStatistics(d.children, depth + 1, lines);
+
+    if(!pass.empty())
+      lines[line] = FormatPassStatistics(QString(depth * 2, QChar(' ')) + ToQStr(d.name), pass);
+
+    total.add(pass);
+  }
+
+  return total;
+}
+
+void AppendPassStatistics(QString &statisticsLog, const rdctype::array<FetchDrawcall> &draws)
+{
+  QStringList lines;
+  CollectPassStatistics(draws, 0, lines);
+
+  // work at the top level that's outside of any marker region
+  PassStatistics loose;
+  for(const FetchDrawcall &d : draws)
+    if(d.children.count == 0)
+      loose.add(d);
+
+  statisticsLog.append("\n*** Pass Statistics ***\n\n");
+
+  if(lines.isEmpty())
+  {
+    statisticsLog.append("No marker regions in the frame.\n");
     return;
+  }
 
-  AppendDrawStatistics(statisticsLog, frameInfo);
-  AppendDispatchStatistics(statisticsLog, frameInfo);
-  AppendInputAssemblerStatistics(statisticsLog, frameInfo);
-  AppendShaderStatistics(ctx, statisticsLog, frameInfo);
-  AppendConstantBindStatistics(ctx, statisticsLog, frameInfo);
-  AppendSamplerBindStatistics(ctx, statisticsLog, frameInfo);
-  AppendResourceBindStatistics(ctx, statisticsLog, frameInfo);
-  AppendBlendStatistics(statisticsLog, frameInfo);
-  AppendDepthStencilStatistics(statisticsLog, frameInfo);
-  AppendRasterizationStatistics(statisticsLog, frameInfo);
-  AppendUpdateStatistics(statisticsLog, frameInfo);
-  AppendOutputStatistics(statisticsLog, frameInfo);
+  statisticsLog.append(QString("%1 %2 %3 %4 %5 %6 %7\n")
+                           .arg("Pass", -40)
+                           .arg("Events", 13)
+                           .arg("Draws", 7)
+                           .arg("Dispatches", 10)
+                           .arg("Clears", 7)
+                           .arg("Copies", 7)
+                           .arg("Indices", 12));
+
+  for(const QString &l : lines)
+    if(!l.isEmpty())
+      statisticsLog.append(l);
+
+  if(!loose.empty())
+    statisticsLog.append(FormatPassStatistics("(outside any marker)", loose));
 }
 
 void CountContributingEvents(const FetchDrawcall &draw, uint32_t &drawCount,
@@ -664,11 +777,11 @@ QString AppendAPICallSummary(const FetchFrameInfo &frameInfo, uint numAPICalls)
   return calls;
 }
 
-QString GenerateReport(CaptureContext &ctx)
+QString GenerateSummary(const StatisticsSource &src)
 {
   QString statisticsLog;
 
-  const rdctype::array<FetchDrawcall> &curDraws = ctx.CurDrawcalls();
+  const rdctype::array<FetchDrawcall> &curDraws = *src.drawcalls;
 
   const FetchDrawcall *lastDraw = &curDraws.back();
   while(!lastDraw->children.empty())
@@ -682,13 +795,13 @@ QString GenerateReport(CaptureContext &ctx)
 
   uint32_t numAPIcalls = lastDraw->eventID - (drawCount + dispatchCount + diagnosticCount);
 
-  int numTextures = ctx.GetTextures().count;
-  int numBuffers = ctx.GetBuffers().count;
+  int numTextures = src.textures.count;
+  int numBuffers = src.buffers.count;
 
   uint64_t IBBytes = 0;
   uint64_t VBBytes = 0;
   uint64_t BufBytes = 0;
-  for(const FetchBuffer &b : ctx.GetBuffers())
+  for(const FetchBuffer &b : src.buffers)
   {
     BufBytes += b.length;
 
@@ -706,7 +819,7 @@ QString GenerateReport(CaptureContext &ctx)
   float texW = 0, texH = 0;
   float largeTexW = 0, largeTexH = 0;
   int texCount = 0, largeTexCount = 0;
-  for(const FetchTexture &t : ctx.GetTextures())
+  for(const FetchTexture &t : src.textures)
   {
     if(t.creationFlags & (eTextureCreate_RTV | eTextureCreate_DSV))
     {
@@ -739,7 +852,7 @@ QString GenerateReport(CaptureContext &ctx)
   largeTexW /= largeTexCount;
   largeTexH /= largeTexCount;
 
-  const FetchFrameInfo &frameInfo = ctx.FrameInfo();
+  const FetchFrameInfo &frameInfo = src.frameInfo;
 
   float compressedMB = (float)frameInfo.compressedFileSize / (1024.0f * 1024.0f);
   float uncompressedMB = (float)frameInfo.uncompressedFileSize / (1024.0f * 1024.0f);
@@ -751,7 +864,7 @@ QString GenerateReport(CaptureContext &ctx)
       QString(
           "Stats for %1.\n\nFile size: %2MB (%3MB uncompressed, compression ratio %4:1)\n"
           "Persistent Data (approx): %5MB, Frame-initial data (approx): %6MB\n")
-          .arg(QFileInfo(ctx.LogFilename()).fileName())
+          .arg(src.logName)
           .arg(compressedMB, 2, 'f', 2)
           .arg(uncompressedMB, 2, 'f', 2)
           .arg(compressRatio, 2, 'f', 2)
@@ -792,11 +905,166 @@ QString GenerateReport(CaptureContext &ctx)
   statisticsLog.append(buffers);
   statisticsLog.append(load);
 
-  AppendDetailedInformation(ctx, statisticsLog, frameInfo);
-
   return statisticsLog;
 }
 
+// builds the report a section at a time, handing each one over as soon as it's formatted so
+// the view can fill in while the rest is still being generated.
+void GenerateReport(const StatisticsSource &src, const QAtomicInt &cancel,
+                    std::function<void(const QString &)> section)
+{
+  section(GenerateSummary(src));
+
+  QString passes;
+  AppendPassStatistics(passes, *src.drawcalls);
+  section(passes);
+
+  const FetchFrameInfo &frameInfo = src.frameInfo;
+
+  if(frameInfo.stats.recorded == 0)
+    return;
+
+  for(int i = 0; i < 12; i++)
+  {
+    if(cancel.loadAcquire())
+      return;
+
+    QString text;
+
+    switch(i)
+    {
+      case 0: AppendDrawStatistics(text, frameInfo); break;
+      case 1: AppendDispatchStatistics(text, frameInfo); break;
+      case 2: AppendInputAssemblerStatistics(text, frameInfo); break;
+      case 3: AppendShaderStatistics(src, text, frameInfo); break;
+      case 4: AppendConstantBindStatistics(src, text, frameInfo); break;
+      case 5: AppendSamplerBindStatistics(src, text, frameInfo); break;
+      case 6: AppendResourceBindStatistics(src, text, frameInfo); break;
+      case 7: AppendBlendStatistics(text, frameInfo); break;
+      case 8: AppendDepthStencilStatistics(text, frameInfo); break;
+      case 9: AppendRasterizationStatistics(text, frameInfo); break;
+      case 10: AppendUpdateStatistics(text, frameInfo); break;
+      case 11: AppendOutputStatistics(text, frameInfo); break;
+    }
+
+    section(text);
+  }
+}
+
+QString BytesAsReadable(uint64_t value)
+{
+  if(value >= (1024 * 1024))
+    return QString("%1MB").arg((double)value / (1024.0 * 1024.0), 0, 'f', 2);
+  else if(value >= 1024)
+    return QString("%1KB").arg((double)value / 1024.0, 0, 'f', 2);
+  else
+    return QString("%1B").arg(value);
+}
+
+QString GenerateProxyReport(rdctype::array<ProxyCommandStats> &stats)
+{
+  QString report;
+
+  if(stats.count == 0)
+    return report;
+
+  // the commands that cost the most waiting first, those are the ones worth batching or caching
+  std::sort(stats.begin(), stats.end(), [](const ProxyCommandStats &a, const ProxyCommandStats &b) {
+    return a.totalLatency > b.totalLatency;
+  });
+
+  uint64_t totalSent = 0, totalReceived = 0;
+  double totalLatency = 0.0;
+  for(const ProxyCommandStats &s : stats)
+  {
+    totalSent += s.bytesSent;
+    totalReceived += s.bytesReceived;
+    totalLatency += s.totalLatency;
+  }
+
+  report += "\n*** Remote replay commands ***\n\n";
+  report += QString("%1 sent, %2 received, %3 ms waiting on the remote replay.\n\n")
+                .arg(BytesAsReadable(totalSent))
+                .arg(BytesAsReadable(totalReceived))
+                .arg(totalLatency, 0, 'f', 1);
+
+  report += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                .arg("Command", -24)
+                .arg("Count", 8)
+                .arg("Sent", 11)
+                .arg("Received", 11)
+                .arg("Total ms", 10)
+                .arg("Avg ms", 9)
+                .arg("Max ms", 9)
+                .arg("Remote ms", 10);
+
+  for(const ProxyCommandStats &s : stats)
+  {
+    double avg = s.count > 0 ? s.totalLatency / s.count : 0.0;
+
+    report += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                  .arg(ToQStr(s.name), -24)
+                  .arg(s.count, 8)
+                  .arg(BytesAsReadable(s.bytesSent), 11)
+                  .arg(BytesAsReadable(s.bytesReceived), 11)
+                  .arg(s.totalLatency, 10, 'f', 1)
+                  .arg(avg, 9, 'f', 2)
+                  .arg(s.maxLatency, 9, 'f', 2)
+                  .arg(s.remoteTime, 10, 'f', 1);
+  }
+
+  return report;
+}
+
+QString GenerateMemoryReport(const rdctype::array<ReplayMemoryStats> &stats)
+{
+  QString report;
+
+  if(stats.count == 0)
+    return report;
+
+  static const char *categoryNames[] = {
+      "Capture resources", "Initial contents", "Post-VS cache",
+      "Proxy resources",   "Debug resources",
+  };
+
+  static_assert(sizeof(categoryNames) / sizeof(categoryNames[0]) == eReplayMemory_Count,
+                "Category names are out of date");
+
+  uint64_t totalGPU = 0, totalCPU = 0;
+  for(const ReplayMemoryStats &s : stats)
+  {
+    totalGPU += s.gpuBytes;
+    totalCPU += s.cpuBytes;
+  }
+
+  report += "\n*** Replay memory ***\n\n";
+  report += QString("%1 GPU, %2 CPU.\n\n")
+                .arg(BytesAsReadable(totalGPU))
+                .arg(BytesAsReadable(totalCPU));
+
+  report += QString("%1 %2 %3 %4 %5\n")
+                .arg("Category", -20)
+                .arg("Where", -7)
+                .arg("GPU", 11)
+                .arg("CPU", 11)
+                .arg("Budget", 11);
+
+  for(const ReplayMemoryStats &s : stats)
+  {
+    QString name = s.category < eReplayMemory_Count ? categoryNames[s.category] : "Unknown";
+
+    report += QString("%1 %2 %3 %4 %5\n")
+                  .arg(name, -20)
+                  .arg(s.remote ? "Remote" : "Local", -7)
+                  .arg(BytesAsReadable(s.gpuBytes), 11)
+                  .arg(BytesAsReadable(s.cpuBytes), 11)
+                  .arg(s.budget > 0 ? BytesAsReadable(s.budget) : "-", 11);
+  }
+
+  return report;
+}
+
 StatisticsViewer::StatisticsViewer(CaptureContext &ctx, QWidget *parent)
     : QFrame(parent), ui(new Ui::StatisticsViewer), m_Ctx(ctx)
 {
@@ -809,6 +1077,8 @@ StatisticsViewer::StatisticsViewer(CaptureContext &ctx, QWidget *parent)
 
 StatisticsViewer::~StatisticsViewer()
 {
+  StopReport();
+
   m_Ctx.windowClosed(this);
 
   m_Ctx.RemoveLogViewer(this);
@@ -817,10 +1087,110 @@ StatisticsViewer::~StatisticsViewer()
 
 void StatisticsViewer::OnLogfileClosed()
 {
+  StopReport();
+
+  m_Report.clear();
+  m_ProxyReport.clear();
+  m_MemoryReport.clear();
   ui->statistics->clear();
 }
 
 void StatisticsViewer::OnLogfileLoaded()
 {
-  ui->statistics->setText(GenerateReport(m_Ctx));
+  StopReport();
+
+  m_Report.clear();
+  m_ProxyReport.clear();
+  m_MemoryReport.clear();
+  ui->statistics->setText(tr("Generating statistics..."));
+
+  StatisticsSource *src = new StatisticsSource();
+  src->logName = QFileInfo(m_Ctx.LogFilename()).fileName();
+  for(int s = eShaderStage_First; s < eShaderStage_Count; s++)
+    src->stageAbbrevs[s] = m_Ctx.CurPipelineState.Abbrev((ShaderStageType)s);
+  src->frameInfo = m_Ctx.FrameInfo();
+  src->textures = m_Ctx.GetTextures();
+  src->buffers = m_Ctx.GetBuffers();
+  src->drawcalls = &m_Ctx.CurDrawcalls();
+
+  // sections can still be queued to the UI thread after the worker stops, so they're only
+  // appended if they come from the current report
+  int generation = ++m_ReportGeneration;
+  QPointer<StatisticsViewer> me(this);
+
+  m_ReportCancel.storeRelease(0);
+
+  m_ReportThread = new LambdaThread([this, src, generation, me]() {
+    GenerateReport(*src, m_ReportCancel, [generation, me](const QString &text) {
+      GUIInvoke::call([generation, me, text]() {
+        if(me && me->m_ReportGeneration == generation)
+          me->AppendReport(text);
+      });
+    });
+
+    delete src;
+  });
+  m_ReportThread->start();
+
+  RefreshReplayStats();
+}
+
+void StatisticsViewer::StopReport()
+{
+  if(m_ReportThread)
+  {
+    m_ReportCancel.storeRelease(1);
+    m_ReportThread->wait();
+    m_ReportThread->deleteLater();
+    m_ReportThread = NULL;
+  }
+
+  m_ReportGeneration++;
+}
+
+void StatisticsViewer::AppendReport(const QString &text)
+{
+  m_Report += text;
+  UpdateText();
+}
+
+void StatisticsViewer::UpdateText()
+{
+  if(m_Report.isEmpty())
+    return;
+
+  // keep the view where it was while sections are added underneath
+  QScrollBar *scroll = ui->statistics->verticalScrollBar();
+  int pos = scroll->value();
+
+  ui->statistics->setText(m_Report + m_MemoryReport + m_ProxyReport);
+
+  scroll->setValue(pos);
+}
+
+void StatisticsViewer::OnEventChanged(uint32_t eventID)
+{
+  // moving between events is what generates most remote traffic and fills the replay's caches,
+  // so keep the figures current
+  RefreshReplayStats();
+}
+
+void StatisticsViewer::RefreshReplayStats()
+{
+  m_Ctx.Renderer().AsyncInvoke([this](IReplayRenderer *r) {
+    rdctype::array<ReplayMemoryStats> memory;
+    r->GetMemoryStats(&memory);
+
+    rdctype::array<ProxyCommandStats> stats;
+    r->GetProxyStats(&stats);
+
+    QString memoryReport = GenerateMemoryReport(memory);
+    QString proxyReport = GenerateProxyReport(stats);
+
+    GUIInvoke::call([this, memoryReport, proxyReport]() {
+      m_MemoryReport = memoryReport;
+      m_ProxyReport = proxyReport;
+      UpdateText();
+    });
+  });
 }
\ No newline at end of file
@@ -43,8 +43,25 @@ public:
   void OnLogfileLoaded();
   void OnLogfileClosed();
   void OnSelectedEventChanged(uint32_t eventID) {}
-  void OnEventChanged(uint32_t eventID) {}
+  void OnEventChanged(uint32_t eventID);
+
 private:
   Ui::StatisticsViewer *ui;
   CaptureContext &m_Ctx;
+
+  // the report for the capture itself, the replay's memory use and remote replay traffic are
+  // appended to it as they change
+  QString m_Report;
+  QString m_MemoryReport;
+  QString m_ProxyReport;
+
+  // the report is generated on a worker and filled in as each section is ready
+  LambdaThread *m_ReportThread = NULL;
+  QAtomicInt m_ReportCancel;
+  int m_ReportGeneration = 0;
+
+  void StopReport();
+  void AppendReport(const QString &text);
+  void UpdateText();
+  void RefreshReplayStats();
 };
@@ -33,6 +33,7 @@
 #include <QJsonDocument>
 #include <QMenu>
 #include <QPainter>
+#include <QPointer>
 #include <QStyledItemDelegate>
 #include "3rdparty/flowlayout/FlowLayout.h"
 #include "3rdparty/toolwindowmanager/ToolWindowManagerArea.h"
@@ -724,6 +725,9 @@ void TextureViewer::RT_UpdateVisualRange(IReplayRenderer *)
       m_TexDisplay.Blue && fmt.compCount > 2, m_TexDisplay.Alpha && fmt.compCount > 3,
   };
 
+  // as with picking, this can run ahead of a queued display update
+  m_Output->SetTextureDisplay(m_TexDisplay);
+
   rdctype::array<uint32_t> histogram;
   success = m_Output->GetHistogram(ui->rangeHistogram->rangeMin(), ui->rangeHistogram->rangeMax(),
                                    channels, &histogram);
@@ -742,6 +746,20 @@ void TextureViewer::RT_UpdateVisualRange(IReplayRenderer *)
   }
 }
 
+void TextureViewer::UI_QueuePickPixels()
+{
+  m_Ctx.Renderer().AsyncInvoke("PickPixelClick",
+                               [this](IReplayRenderer *r) { RT_PickPixelsAndUpdate(r); },
+                               RenderManager::eInvoke_High);
+}
+
+void TextureViewer::UI_QueueVisualRange()
+{
+  m_Ctx.Renderer().AsyncInvoke("VisualRange",
+                               [this](IReplayRenderer *r) { RT_UpdateVisualRange(r); },
+                               RenderManager::eInvoke_High);
+}
+
 void TextureViewer::UI_UpdateStatusText()
 {
   FetchTexture *texptr = GetCurrentTexture();
@@ -1514,7 +1532,7 @@ void TextureViewer::UI_UpdateChannels()
   m_TexDisplay.FlipY = ui->flip_y->isChecked();
 
   INVOKE_MEMFN(RT_UpdateAndDisplay);
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 }
 
 void TextureViewer::SetupTextureTabs()
@@ -1643,7 +1661,7 @@ void TextureViewer::GotoLocation(int x, int y)
     m_PickedPoint.setY((int)(mipHeight - 1) - m_PickedPoint.x());
 
   if(m_Output != NULL)
-    INVOKE_MEMFN(RT_PickPixelsAndUpdate);
+    UI_QueuePickPixels();
   INVOKE_MEMFN(RT_UpdateAndDisplay);
 
   UI_UpdateStatusText();
@@ -2185,13 +2203,13 @@ void TextureViewer::render_mouseMove(QMouseEvent *e)
         m_PickedPoint.setX(qBound(0, m_PickedPoint.x(), (int)texptr->width - 1));
         m_PickedPoint.setY(qBound(0, m_PickedPoint.y(), (int)texptr->height - 1));
 
-        m_Ctx.Renderer().AsyncInvoke("PickPixelClick",
-                                     [this](IReplayRenderer *r) { RT_PickPixelsAndUpdate(r); });
+        UI_QueuePickPixels();
       }
       else if(e->buttons() == Qt::NoButton)
       {
         m_Ctx.Renderer().AsyncInvoke("PickPixelHover",
-                                     [this](IReplayRenderer *r) { RT_PickHoverAndUpdate(r); });
+                                     [this](IReplayRenderer *r) { RT_PickHoverAndUpdate(r); },
+                                     RenderManager::eInvoke_High);
       }
     }
   }
@@ -2294,10 +2312,8 @@ void TextureViewer::render_keyPress(QKeyEvent *e)
                            qBound(0, m_PickedPoint.y(), (int)texptr->height - 1));
     e->accept();
 
-    m_Ctx.Renderer().AsyncInvoke([this](IReplayRenderer *r) {
-      RT_PickPixelsAndUpdate(r);
-      RT_UpdateAndDisplay(r);
-    });
+    UI_QueuePickPixels();
+    INVOKE_MEMFN(RT_UpdateAndDisplay);
 
     UI_UpdateStatusText();
   }
@@ -2912,7 +2928,7 @@ void TextureViewer::rangePoint_Update()
 
   ui->rangeHistogram->setRange(black, white);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 }
 
 void TextureViewer::rangePoint_leave()
@@ -2948,7 +2964,7 @@ void TextureViewer::on_zoomRange_clicked()
 
   ui->rangeHistogram->setRange(black, white);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 }
 
 void TextureViewer::on_autoFit_clicked()
@@ -2962,7 +2978,7 @@ void TextureViewer::on_reset01_clicked()
 
   ui->autoFit->setChecked(false);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 }
 
 void TextureViewer::on_visualiseRange_clicked()
@@ -2972,7 +2988,7 @@ void TextureViewer::on_visualiseRange_clicked()
     ui->rangeHistogram->setMinimumSize(QSize(300, 90));
 
     m_Visualise = true;
-    INVOKE_MEMFN(RT_UpdateVisualRange);
+    UI_QueueVisualRange();
   }
   else
   {
@@ -2989,7 +3005,11 @@ void TextureViewer::AutoFitRange()
   if(!m_Ctx.LogLoaded() || GetCurrentTexture() == NULL || m_Output == NULL)
     return;
 
-  m_Ctx.Renderer().AsyncInvoke([this](IReplayRenderer *r) {
+  m_Ctx.Renderer().AsyncInvoke("AutoFitRange", [this](IReplayRenderer *r) {
+    // this can run ahead of a queued display update, so make sure it's looking at the texture
+    // currently selected
+    m_Output->SetTextureDisplay(m_TexDisplay);
+
     PixelValue min, max;
     bool success = m_Output->GetMinMax(&min, &max);
 
@@ -3050,11 +3070,11 @@ void TextureViewer::AutoFitRange()
       {
         GUIInvoke::call([this, minval, maxval]() {
           ui->rangeHistogram->setRange(minval, maxval);
-          INVOKE_MEMFN(RT_UpdateVisualRange);
+          UI_QueueVisualRange();
         });
       }
     }
-  });
+  }, RenderManager::eInvoke_High);
 }
 
 void TextureViewer::on_backcolorPick_clicked()
@@ -3154,11 +3174,11 @@ void TextureViewer::on_mipLevel_currentIndexChanged(int index)
     return;
   }
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 
   if(m_Output != NULL && m_PickedPoint.x() >= 0 && m_PickedPoint.y() >= 0)
   {
-    INVOKE_MEMFN(RT_PickPixelsAndUpdate);
+    UI_QueuePickPixels();
   }
 
   INVOKE_MEMFN(RT_UpdateAndDisplay);
@@ -3176,11 +3196,11 @@ void TextureViewer::on_sliceFace_currentIndexChanged(int index)
   if(tex.depth > 1)
     m_TexDisplay.sliceFace = (uint32_t)(index << (int)m_TexDisplay.mip);
 
-  INVOKE_MEMFN(RT_UpdateVisualRange);
+  UI_QueueVisualRange();
 
   if(m_Output != NULL && m_PickedPoint.x() >= 0 && m_PickedPoint.y() >= 0)
   {
-    INVOKE_MEMFN(RT_PickPixelsAndUpdate);
+    UI_QueuePickPixels();
   }
 
   INVOKE_MEMFN(RT_UpdateAndDisplay);
@@ -3307,10 +3327,12 @@ void TextureViewer::on_debugPixelContext_clicked()
 
   m_Ctx.Renderer().AsyncInvoke([this, x, y](IReplayRenderer *r) {
     ShaderDebugTrace *trace = new ShaderDebugTrace;
+    uint32_t numSteps = 0;
 
-    bool success = r->DebugPixel((uint32_t)x, (uint32_t)y, m_TexDisplay.sampleIdx, ~0U, trace);
+    uint32_t session = r->DebugPixelSession((uint32_t)x, (uint32_t)y, m_TexDisplay.sampleIdx, ~0U,
+                                            trace, &numSteps);
 
-    if(!success || trace->states.count == 0)
+    if(session == 0)
     {
       delete trace;
 
@@ -3319,7 +3341,7 @@ void TextureViewer::on_debugPixelContext_clicked()
       return;
     }
 
-    GUIInvoke::call([this, x, y, trace]() {
+    GUIInvoke::call([this, x, y, trace, session, numSteps]() {
       QString debugContext = tr("Pixel %1,%2").arg(x).arg(y);
 
       const ShaderReflection *shaderDetails =
@@ -3328,8 +3350,9 @@ void TextureViewer::on_debugPixelContext_clicked()
           m_Ctx.CurPipelineState.GetBindpointMapping(eShaderStage_Pixel);
 
       // viewer takes ownership of the trace
-      ShaderViewer *s = ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails,
-                                                  eShaderStage_Pixel, trace, debugContext, this);
+      ShaderViewer *s =
+          ShaderViewer::debugShader(m_Ctx, &bindMapping, shaderDetails, eShaderStage_Pixel, trace,
+                                    session, numSteps, debugContext, this);
 
       m_Ctx.setupDockWindow(s);
 
@@ -3341,6 +3364,19 @@ void TextureViewer::on_debugPixelContext_clicked()
   });
 }
 
+static void RENDERDOC_CC PixelHistoryBatchReceived(void *userData,
+                                                    const rdctype::array<PixelModification> *batch)
+{
+  QPointer<PixelHistoryView> hist = *(QPointer<PixelHistoryView> *)userData;
+  rdctype::array<PixelModification> *mods = new rdctype::array<PixelModification>(*batch);
+
+  GUIInvoke::call([hist, mods] {
+    if(hist)
+      hist->addHistory(*mods);
+    delete mods;
+  });
+}
+
 void TextureViewer::on_pixelHistory_clicked()
 {
   FetchTexture *texptr = GetCurrentTexture();
@@ -3361,19 +3397,33 @@ void TextureViewer::on_pixelHistory_clicked()
   ToolWindowManager::AreaReference ref(ToolWindowManager::RightOf, manager->areaOf(this), 0.2f);
   manager->addToolWindow(hist, ref);
 
+  // the view can be closed while the history is still being fetched, in which case the fetch is
+  // aborted and whatever comes back is dropped.
+  QPointer<PixelHistoryView> histPtr(hist);
+
   // add a short delay so that controls repainting after a new panel appears can get at the
-  // render thread before we insert the long blocking pixel history task
-  LambdaThread *thread = new LambdaThread([this, texptr, x, y, hist]() {
+  // render thread before we insert the long blocking pixel history task. It's also queued at low
+  // priority so anything else already waiting goes first.
+  LambdaThread *thread = new LambdaThread([this, texptr, x, y, histPtr]() {
     QThread::msleep(150);
-    m_Ctx.Renderer().AsyncInvoke([this, texptr, x, y, hist](IReplayRenderer *r) {
-      rdctype::array<PixelModification> *history = new rdctype::array<PixelModification>();
-      r->PixelHistory(texptr->ID, (uint32_t)x, (int32_t)y, m_TexDisplay.sliceFace, m_TexDisplay.mip,
-                      m_TexDisplay.sampleIdx, m_TexDisplay.typeHint, history);
-
-      GUIInvoke::call([hist, history] {
-        hist->setHistory(*history);
-        delete history;
-      });
+    RenderManager::InvokeHandlePtr invoke = m_Ctx.Renderer().AsyncInvoke(
+        [this, texptr, x, y, histPtr](IReplayRenderer *r) {
+          r->PixelHistoryBatched(texptr->ID, (uint32_t)x, (int32_t)y, m_TexDisplay.sliceFace,
+                                 m_TexDisplay.mip, m_TexDisplay.sampleIdx, m_TexDisplay.typeHint,
+                                 &PixelHistoryBatchReceived, (void *)&histPtr);
+
+          GUIInvoke::call([histPtr] {
+            if(histPtr)
+              histPtr->finishHistory();
+          });
+        },
+        RenderManager::eInvoke_Low);
+
+    GUIInvoke::call([histPtr, invoke] {
+      if(histPtr)
+        histPtr->setInvoke(invoke);
+      else
+        invoke->abort();
     });
   });
   thread->selfDelete(true);
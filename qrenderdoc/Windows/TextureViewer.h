@@ -210,6 +210,11 @@ private:
   void UI_RecreatePanels();
 
   void UI_UpdateStatusText();
+
+  // queue a pick of m_PickedPoint or a histogram update ahead of other replay work. These read
+  // the current state when they run, so a newer request replaces any that are still queued.
+  void UI_QueuePickPixels();
+  void UI_QueueVisualRange();
   void UI_UpdateTextureDetails();
   void UI_OnTextureSelectionChanged(bool newdraw);
 
@@ -1,2 +1,5 @@
 #define TINYEXR_IMPLEMENTATION
+// use the implementation of miniz built from 3rdparty/miniz, instead of compiling the copy embedded
+// in tinyexr and ending up with two definitions of each function
+#define MINIZ_HEADER_FILE_ONLY
 #include "tinyexr.h"
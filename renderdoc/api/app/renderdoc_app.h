@@ -191,6 +191,140 @@ typedef enum {
   // 0 - API debugging is displayed as normal
   eRENDERDOC_Option_DebugOutputMute = 11,
 
+  // Write capture files to disk on a background thread. The application resumes
+  // as soon as the frame's data has been handed off, and the capture is only
+  // reported as available once it has been fully written.
+  //
+  // Default - disabled
+  //
+  // 1 - Capture files are written asynchronously after the frame ends
+  // 0 - The frame that ends a capture blocks until the file is on disk
+  eRENDERDOC_Option_AsyncCaptureWrite = 12,
+
+  // When several consecutive frames are captured with TriggerMultiFrameCapture or through
+  // target control, record them all into a single capture instead of one capture per frame.
+  // The frames share one set of initial resource contents, so the capture costs roughly the
+  // same as one frame plus the commands of the others. Each frame ends with a present in the event
+  // list, and only presents of the window the capture started on count towards the frames.
+  //
+  // Default - disabled
+  //
+  // 1 - Multi-frame captures produce a single capture containing every frame
+  // 0 - Each frame of a multi-frame capture is written as its own capture
+  eRENDERDOC_Option_CombineMultiFrameCaptures = 13,
+
+  // Prepare the initial contents of dirty resources a few at a time in the frames before a
+  // capture is triggered, so that the first frame of a capture only has to copy what has changed
+  // since. The value is how many megabytes of prepared contents may be held at once; past that,
+  // the remaining resources are prepared when the capture starts as normal. Currently only
+  // non-mappable Vulkan images are prepared ahead of time.
+  //
+  // Default - 0
+  //
+  // 0 - Initial contents are prepared only when the capture starts
+  // N - Stage up to N megabytes of initial contents ahead of a capture
+  eRENDERDOC_Option_StageInitialContentsMB = 14,
+
+  // Find what changed in persistently mapped coherent memory by write-protecting it and catching
+  // the first write to each page, so that only written pages are compared and saved at each
+  // submit instead of the whole mapping. This only applies while a frame is being captured.
+  // On D3D11 the same is done for the shadow copies of buffers mapped with WRITE or
+  // WRITE_NO_OVERWRITE, so that Unmap only compares the pages written during the map.
+  // Writes made by the OS into protected memory, such as reading a file directly into a mapped
+  // pointer, fail instead of being caught, so this is only safe if the application never does so.
+  // Where the memory can't be protected the whole mapping is compared as normal.
+  //
+  // Default - disabled
+  //
+  // 1 - Track written pages of coherent mappings while capturing
+  // 0 - Compare the whole of each coherent mapping at every submit
+  eRENDERDOC_Option_TrackMappedWrites = 15,
+
+  // When capturing callstacks for every API call, store each unique callstack once in a table in
+  // the capture and refer to it by index from each call, instead of storing the full stack with
+  // every call. Captures made with this enabled can't be opened by older versions of RenderDoc.
+  //
+  // Default - disabled
+  //
+  // 1 - Each unique callstack is stored once and referenced by index
+  // 0 - Each API call stores its full callstack
+  eRENDERDOC_Option_DeduplicateCallstacks = 16,
+
+  // Keep a rolling capture of the most recent frames in memory, so that a capture can be taken of
+  // a frame that has already been presented. Every frame is recorded as if it were being
+  // captured, and the capture keys or TriggerCapture write out the last frames recorded rather
+  // than the next ones. The value is how many frames are kept, with the oldest discarded first.
+  // Recording every frame has a large per-frame cost, see the capture stats from target control.
+  //
+  // Default - 0
+  //
+  // 0 - Captures are taken of the frames after they are triggered
+  // N - Keep the last N frames, triggering writes out the most recent
+  eRENDERDOC_Option_RingCaptureFrames = 17,
+
+  // The most memory in megabytes that the frames kept by eRENDERDOC_Option_RingCaptureFrames may
+  // use. Older frames are discarded to stay under the limit, though the most recent frame is
+  // always kept.
+  //
+  // Default - 256
+  eRENDERDOC_Option_RingCaptureMemoryMB = 18,
+
+  // Trigger a capture by itself when a frame takes longer than this many milliseconds on the
+  // CPU, measured from one present to the next. With eRENDERDOC_Option_RingCaptureFrames the
+  // slow frame itself is written out, otherwise the frame after it is captured.
+  //
+  // Default - 0
+  //
+  // 0 - Frame times don't trigger captures
+  // N - Capture when a frame takes longer than N milliseconds
+  eRENDERDOC_Option_SpikeCaptureThresholdMS = 19,
+
+  // Trigger a capture by itself when a frame takes longer than this percentage of the average
+  // frame time over the last second, e.g. 200 for a frame taking twice as long as average. This
+  // behaves as eRENDERDOC_Option_SpikeCaptureThresholdMS otherwise, and either can trigger.
+  //
+  // Default - 0
+  //
+  // 0 - Frame times don't trigger captures
+  // N - Capture when a frame takes longer than N percent of the average
+  eRENDERDOC_Option_SpikeCapturePercent = 20,
+
+  // Limit how much memory a capture may use, counting the recorded chunks, initial contents and
+  // shadow copies of mapped memory. Once the limit is reached initial contents are spilled to a
+  // temporary file on disk, and if the capture is still over the limit when the frame ends it is
+  // discarded with an error in the log rather than running the application out of memory.
+  //
+  // Default - 0
+  //
+  // 0 - No limit
+  // N - Limit captures to N MB
+  eRENDERDOC_Option_CaptureMemoryBudgetMB = 21,
+
+  // Record GPU timestamps around every draw and dispatch while the frame is being captured, and
+  // store the resulting per-event timings in the capture. These are the timings as the application
+  // itself ran, with its own overlap and caching, rather than those measured by replaying each
+  // event in isolation. On Vulkan and D3D12 only events recorded directly into primary command
+  // buffers or direct/compute command lists are timed, keeping the last submission of each. On
+  // D3D11 only the immediate context is timed.
+  //
+  // Default - disabled
+  //
+  // 1 - Timestamps are recorded around each draw and dispatch in the captured frame
+  // 0 - No timestamps are recorded
+  eRENDERDOC_Option_CaptureEventTimings = 22,
+
+  // Don't draw the overlay on present while the application isn't being captured. Drawing it
+  // costs GPU and CPU time and a save and restore of state every frame, so hiding it keeps frame
+  // times closer to running without RenderDoc. The frame times are still available through
+  // target control along with the other capture stats. Unlike masking out
+  // eRENDERDOC_Overlay_Enabled this doesn't change the overlay bits the application sees.
+  //
+  // Default - disabled
+  //
+  // 1 - The overlay is never drawn
+  // 0 - The overlay is drawn as set by the overlay bits
+  eRENDERDOC_Option_HideOverlay = 23,
+
 } RENDERDOC_CaptureOption;
 
 // Sets an option that controls how RenderDoc behaves on capture.
@@ -430,7 +564,8 @@ typedef void(RENDERDOC_CC *pRENDERDOC_SetActiveWindow)(RENDERDOC_DevicePointer d
 // capture the next frame on whichever window and API is currently considered active
 typedef void(RENDERDOC_CC *pRENDERDOC_TriggerCapture)();
 
-// capture the next N frames on whichever window and API is currently considered active
+// capture the next N frames on whichever window and API is currently considered active.
+// See eRENDERDOC_Option_CombineMultiFrameCaptures for whether these are one capture or N.
 typedef void(RENDERDOC_CC *pRENDERDOC_TriggerMultiFrameCapture)(uint32_t numFrames);
 
 // When choosing either a device pointer or a window handle to capture, you can pass NULL.
@@ -49,4 +49,16 @@ struct CaptureOptions
   bool32 SaveAllInitials;
   bool32 CaptureAllCmdLists;
   bool32 DebugOutputMute;
+  bool32 AsyncCaptureWrite;
+  bool32 CombineMultiFrameCaptures;
+  uint32_t StageInitialContentsMB;
+  bool32 TrackMappedWrites;
+  bool32 DeduplicateCallstacks;
+  uint32_t RingCaptureFrames;
+  uint32_t RingCaptureMemoryMB;
+  uint32_t SpikeCaptureThresholdMS;
+  uint32_t SpikeCapturePercent;
+  uint32_t CaptureMemoryBudgetMB;
+  bool32 CaptureEventTimings;
+  bool32 HideOverlay;
 };
@@ -134,6 +134,15 @@ struct TextureDisplay
   TextureDisplayOverlay overlay;
 };
 
+// one pixel to fetch the history of, as with IReplayRenderer::PixelHistory
+struct PixelHistoryQuery
+{
+  ResourceId target;
+  uint32_t x, y;
+  uint32_t slice, mip, sampleIdx;
+  FormatComponentType typeHint;
+};
+
 struct TextureSave
 {
   ResourceId id;
@@ -220,6 +229,51 @@ struct TextureSave
   int jpegQuality;
 };
 
+// one side of a texture comparison, see IReplayRenderer::CompareTextures
+struct TextureCompareInput
+{
+  TextureCompareInput()
+      : eventID(0), sliceFace(0), mip(0), sampleIdx(0), typeHint(eCompType_None)
+  {
+  }
+
+  ResourceId texid;
+  // the event to read the texture at, or 0 for the current event
+  uint32_t eventID;
+  uint32_t sliceFace;
+  uint32_t mip;
+  uint32_t sampleIdx;
+  FormatComponentType typeHint;
+};
+
+struct TextureCompareResult
+{
+  // RGBA32F texture of the absolute difference per channel, which is infinite where only one side
+  // is NaN. It's owned by the replay and reused by the next comparison
+  ResourceId diffTexture;
+  // the area compared, the smaller of the two inputs if they differ in size
+  uint32_t width, height;
+  float maxError[4];
+  // texels where any channel differs by more than the threshold
+  uint32_t numDifferent;
+};
+
+struct CaptureRecordStats
+{
+  ResourceId ID;
+  uint32_t numChunks;
+  uint64_t chunkBytes;
+};
+
+struct EntryPointStats
+{
+  rdctype::str name;
+  uint64_t calls;
+  uint64_t sampledCalls;
+  // time spent in the entry point, extrapolated from the timed calls to all calls
+  uint64_t totalNS;
+};
+
 struct TargetControlMessage
 {
   TargetControlMessage() {}
@@ -249,4 +303,59 @@ struct TargetControlMessage
     uint32_t PID;
     uint32_t ident;
   } NewChild;
+
+  struct CaptureStatsData
+  {
+    // all chunks currently alive in the target, whether held by records or pending write
+    uint64_t liveChunks;
+    uint64_t peakLiveChunks;
+    uint64_t chunkBytes;
+    // memory held by the pages small chunks are sub-allocated from
+    uint64_t chunkPageBytes;
+    uint64_t peakChunkPageBytes;
+
+    uint32_t numRecords;
+    uint32_t numRecordChunks;
+    uint64_t recordChunkBytes;
+
+    uint32_t numInitialContents;
+    uint32_t numInitialChunks;
+    uint64_t initialChunkBytes;
+
+    // frames held by the rolling capture, see eRENDERDOC_Option_RingCaptureFrames
+    uint32_t ringFrames;
+    uint64_t ringBytes;
+    uint64_t ringByteLimit;
+    // average time spent starting and ending the capture of each rolling frame, on top of the
+    // cost of recording its commands
+    double ringFrameOverheadMS;
+
+    // memory counted against eRENDERDOC_Option_CaptureMemoryBudgetMB, which is the chunks that
+    // aren't spilled to disk plus the initial contents and map shadows below
+    uint64_t captureMemoryBytes;
+    uint64_t captureMemoryBudget;
+    uint64_t initialContentBytes;
+    uint64_t mapShadowBytes;
+    uint64_t spilledBytes;
+    // captures discarded for going over the budget
+    uint32_t abortedCaptures;
+
+    // CPU time between presents over the last second, so frame rates can be watched without
+    // the overlay, see eRENDERDOC_Option_HideOverlay
+    double avgFrameTimeMS;
+    double minFrameTimeMS;
+    double maxFrameTimeMS;
+
+    // the records holding the most chunk memory, largest first
+    rdctype::array<CaptureRecordStats> largestRecords;
+  } CaptureStats;
+
+  struct EntryPointStatsData
+  {
+    // one in this many calls was timed, 0 if profiling is disabled
+    uint32_t sampleInterval;
+
+    // every entry point called since profiling was enabled, most time spent first
+    rdctype::array<EntryPointStats> entryPoints;
+  } EntryPoints;
 };
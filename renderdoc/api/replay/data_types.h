@@ -123,6 +123,17 @@ struct FetchAPIEvent
   uint64_t fileOffset;
 };
 
+// one parameter of an API call, see IReplayRenderer::GetAPIEventParameters. Structures and arrays
+// have their members listed as separate parameters that refer back to them.
+struct APIEventParameter
+{
+  rdctype::str name;
+  rdctype::str value;
+  // index of the enclosing parameter in the same array, or -1 for the call's own parameters
+  int32_t parent;
+  uint32_t numChildren;
+};
+
 struct DebugMessage
 {
   uint32_t eventID;
@@ -333,6 +344,111 @@ struct EventUsage
   ResourceId view;
 };
 
+// a range of a buffer to read back, as for GetBufferData. A length of 0 reads to the end
+struct BufferDataRange
+{
+  BufferDataRange() : offset(0), length(0) {}
+  BufferDataRange(ResourceId b, uint64_t o, uint64_t l) : buffer(b), offset(o), length(l) {}
+  ResourceId buffer;
+  uint64_t offset;
+  uint64_t length;
+};
+
+// one constant block to fill out with IReplayRenderer::GetCBuffersVariableContents, as bound at
+// the current event. buffer is ResourceId() for blocks that aren't backed by a buffer.
+struct CBufferContentsRequest
+{
+  CBufferContentsRequest() : slot(0), offset(0) {}
+  ResourceId shader;
+  rdctype::str entryPoint;
+  uint32_t slot;
+  ResourceId buffer;
+  uint64_t offset;
+};
+
+// which textures or buffers to return from IReplayRenderer::QueryTextures/QueryBuffers, and which
+// page of the matches.
+struct ResourceQuery
+{
+  ResourceQuery()
+      : resType(eResType_None), creationFlags(0), firstEvent(0), lastEvent(0), first(0), count(~0U)
+  {
+  }
+  // textures must be of this type, or any type if it's eResType_None. Ignored for buffers
+  ShaderResourceType resType;
+  // resources must have all of these creation flags
+  uint32_t creationFlags;
+  // case-insensitive substring of the resource's name, or empty for any name
+  rdctype::str name;
+  // if lastEvent is non-zero, resources must be used by at least one event in
+  // [firstEvent, lastEvent]
+  uint32_t firstEvent;
+  uint32_t lastEvent;
+  // the page of matches to return, in the order GetTextures/GetBuffers lists them
+  uint32_t first;
+  uint32_t count;
+};
+
+// what to look for in a value search. Only channels set in the mask are checked - for textures bit
+// N is component N of each texel, for post-transform data it's the Nth float in each vertex.
+struct ValueSearchParams
+{
+  ValueSearchParams()
+      : flags(eValueSearch_NaN | eValueSearch_Inf),
+        minValue(0.0f),
+        maxValue(1.0f),
+        channelMask(~0U),
+        maxMatches(1024)
+  {
+  }
+  uint32_t flags;
+  // values outside of [minValue, maxValue] match if eValueSearch_OutOfRange is set
+  float minValue;
+  float maxValue;
+  uint32_t channelMask;
+  // the most matches returned, the search still counts every match
+  uint32_t maxMatches;
+};
+
+// a value found by a value search. For textures x and y are the texel, for post-transform data x is
+// the vertex in the output and y is 0. component is the channel or float within the vertex.
+struct ValueSearchMatch
+{
+  uint32_t x;
+  uint32_t y;
+  uint32_t component;
+  float value;
+};
+
+// traffic and timing for one kind of command sent to a remote replay, accumulated since the
+// capture was opened. Times are in milliseconds.
+struct ProxyCommandStats
+{
+  rdctype::str name;
+  uint32_t count;
+  uint64_t bytesSent;
+  uint64_t bytesReceived;
+  // round-trip time as seen locally. Commands with no reply are sent along with the next command
+  // that has one, so their latency is counted there.
+  double totalLatency;
+  double maxLatency;
+  // time the remote replay spent executing the command
+  double remoteTime;
+};
+
+// memory used by one category of the replay's own resources. Drivers that can't track a
+// category exactly report an estimate, or 0 if they don't know.
+struct ReplayMemoryStats
+{
+  ReplayMemoryCategory category;
+  // true for memory on the remote side when replaying on another machine
+  bool32 remote;
+  uint64_t gpuBytes;
+  uint64_t cpuBytes;
+  // the budget set with SetMemoryBudget, or 0 if there is none
+  uint64_t budget;
+};
+
 struct FetchDrawcall
 {
   FetchDrawcall() { Reset(); }
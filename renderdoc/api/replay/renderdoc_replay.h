@@ -152,6 +152,13 @@ struct IReplayOutput
   virtual bool AddThumbnail(WindowingSystem system, void *data, ResourceId texID,
                             FormatComponentType typeHint) = 0;
 
+  // render thumbnails into a single window, split into a grid of columns x rows cells filled
+  // left to right and top to bottom. The whole atlas is drawn and presented once per Display()
+  // instead of once per thumbnail window.
+  virtual bool SetThumbnailAtlas(WindowingSystem system, void *data, uint32_t columns,
+                                 uint32_t rows) = 0;
+  virtual bool SetAtlasThumbnail(uint32_t cell, ResourceId texID, FormatComponentType typeHint) = 0;
+
   virtual bool Display() = 0;
 
   virtual bool SetPixelContext(WindowingSystem system, void *data) = 0;
@@ -181,6 +188,14 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_AddThumbnail(IReplayOu
                                                                        WindowingSystem system,
                                                                        void *data, ResourceId texID,
                                                                        FormatComponentType typeHint);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_SetThumbnailAtlas(IReplayOutput *output,
+                                                                            WindowingSystem system,
+                                                                            void *data,
+                                                                            uint32_t columns,
+                                                                            uint32_t rows);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayOutput_SetAtlasThumbnail(IReplayOutput *output, uint32_t cell, ResourceId texID,
+                               FormatComponentType typeHint);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_Display(IReplayOutput *output);
 
@@ -209,6 +224,11 @@ extern "C" RENDERDOC_API uint32_t RENDERDOC_CC ReplayOutput_PickVertex(IReplayOu
                                                                        uint32_t y,
                                                                        uint32_t *pickedInstance);
 
+// called with each batch of results from IReplayRenderer::PixelHistoryBatched. The batch is only
+// valid for the duration of the call.
+typedef void(RENDERDOC_CC *pPixelHistoryBatchCallback)(
+    void *userData, const rdctype::array<PixelModification> *batch);
+
 struct IReplayRenderer
 {
   virtual APIProperties GetAPIProperties() = 0;
@@ -229,6 +249,16 @@ struct IReplayRenderer
   virtual bool GetD3D12PipelineState(D3D12PipelineState *state) = 0;
   virtual bool GetGLPipelineState(GLPipelineState *state) = 0;
   virtual bool GetVulkanPipelineState(VulkanPipelineState *state) = 0;
+  // as GetVulkanPipelineState, but each descriptor binding's binds holds at most maxArrayElements
+  // elements. descriptorCount still holds the full array size, and the remaining elements can be
+  // fetched a page at a time with GetVulkanDescriptorBindings when they're needed. That looks
+  // the binding up in the compute pipeline for the compute stage, and the graphics one otherwise.
+  virtual bool GetVulkanPipelineStatePaged(VulkanPipelineState *state,
+                                           uint32_t maxArrayElements) = 0;
+  virtual bool GetVulkanDescriptorBindings(
+      ShaderStageType stage, uint32_t set, uint32_t binding, uint32_t first, uint32_t count,
+      rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+          *elements) = 0;
 
   virtual ResourceId BuildCustomShader(const char *entry, const char *source,
                                        const uint32_t compileFlags, ShaderStageType type,
@@ -238,6 +268,19 @@ struct IReplayRenderer
   virtual ResourceId BuildTargetShader(const char *entry, const char *source,
                                        const uint32_t compileFlags, ShaderStageType type,
                                        rdctype::str *errors) = 0;
+
+  // Start building a custom or target shader without blocking - the expensive compile runs on a
+  // worker thread. Returns a ticket to pass to GetShaderBuildResult. For target shaders, if replace
+  // is set then the new shader replaces that resource once it's built (or the replacement is
+  // removed if the build failed).
+  virtual uint32_t BuildCustomShaderAsync(const char *entry, const char *source,
+                                          const uint32_t compileFlags, ShaderStageType type) = 0;
+  virtual uint32_t BuildTargetShaderAsync(const char *entry, const char *source,
+                                          const uint32_t compileFlags, ShaderStageType type,
+                                          ResourceId replace) = 0;
+  // Returns false if the build is still in progress. Otherwise finishes it, returning the shader
+  // the same way as BuildCustomShader/BuildTargetShader, and the ticket is no longer valid.
+  virtual bool GetShaderBuildResult(uint32_t ticket, ResourceId *id, rdctype::str *errors) = 0;
   virtual bool ReplaceResource(ResourceId from, ResourceId to) = 0;
   virtual bool RemoveReplacement(ResourceId id) = 0;
   virtual bool FreeTargetResource(ResourceId id) = 0;
@@ -246,37 +289,150 @@ struct IReplayRenderer
   virtual bool GetDrawcalls(rdctype::array<FetchDrawcall> *draws) = 0;
   virtual bool FetchCounters(uint32_t *counters, uint32_t numCounters,
                              rdctype::array<CounterResult> *results) = 0;
+  // returns the counter results stored in the capture or already fetched, without fetching
+  // anything. Returns false if any of the counters don't have results. If the capture did have
+  // results stored for those, but they were discarded because they came from different hardware or
+  // drivers, *stale is set so the caller knows to refresh them.
+  virtual bool GetCachedCounterResults(uint32_t *counters, uint32_t numCounters,
+                                       rdctype::array<CounterResult> *results, bool32 *stale) = 0;
   virtual bool EnumerateCounters(rdctype::array<uint32_t> *counters) = 0;
   virtual bool DescribeCounter(uint32_t counterID, CounterDescription *desc) = 0;
   virtual bool GetTextures(rdctype::array<FetchTexture> *texs) = 0;
   virtual bool GetBuffers(rdctype::array<FetchBuffer> *bufs) = 0;
+  // the page of textures or buffers matching the query, and how many match in total. The matches
+  // for the last query are kept, so paging through the same query doesn't filter again. Over a
+  // remote replay the query is answered on the remote side and only the page is sent back.
+  virtual bool QueryTextures(const ResourceQuery &query, rdctype::array<FetchTexture> *texs,
+                             uint32_t *total) = 0;
+  virtual bool QueryBuffers(const ResourceQuery &query, rdctype::array<FetchBuffer> *bufs,
+                            uint32_t *total) = 0;
   virtual bool GetResolve(uint64_t *callstack, uint32_t callstackLen,
                           rdctype::array<rdctype::str> *trace) = 0;
   virtual bool GetDebugMessages(rdctype::array<DebugMessage> *msgs) = 0;
+  // lets the long-running operations - PixelHistory, FetchCounters and the shader debugging
+  // functions - be stopped early or report how far they've got. While *cancel is non-zero they stop
+  // as soon as they can and return what they have so far, and *progress goes from 0 to 1 as they
+  // run. Both pointers must stay valid until cleared with NULL. Only honoured for local replays.
+  virtual void SetOperationControl(volatile bool32 *cancel, float *progress) = 0;
+  // the parameters of the API call at an event, in order with each structure or array followed by
+  // its members. Only decoded when requested, so it's cheap to call for one event at a time.
+  virtual bool GetAPIEventParameters(uint32_t eventID,
+                                     rdctype::array<APIEventParameter> *params) = 0;
+  // traffic and timing of each kind of command sent to a remote replay since the capture was
+  // opened. Empty when replaying locally.
+  virtual bool GetProxyStats(rdctype::array<ProxyCommandStats> *stats) = 0;
+  // memory the replay is using for each category, locally and on the remote side if there is one
+  virtual bool GetMemoryStats(rdctype::array<ReplayMemoryStats> *stats) = 0;
+  // limits how much cached data in a category is kept. Cached data beyond the budget is freed
+  // after each event change, furthest from the current event first. 0 removes the budget.
+  virtual bool SetMemoryBudget(ReplayMemoryCategory category, uint64_t bytes) = 0;
 
   virtual bool PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
                             uint32_t sampleIdx, FormatComponentType typeHint,
                             rdctype::array<PixelModification> *history) = 0;
+  // as PixelHistory, but the events are processed a few at a time starting from the most recent,
+  // and the modifications are handed to the callback after each batch so they can be displayed
+  // while the rest are still being fetched. Each batch is in event order and comes before the
+  // previous batch. Stops after the current batch if the operation is cancelled.
+  virtual bool PixelHistoryBatched(ResourceId target, uint32_t x, uint32_t y, uint32_t slice,
+                                   uint32_t mip, uint32_t sampleIdx, FormatComponentType typeHint,
+                                   pPixelHistoryBatchCallback callback, void *userData) = 0;
   virtual bool DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset,
                            uint32_t vertOffset, ShaderDebugTrace *trace) = 0;
   virtual bool DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
                           ShaderDebugTrace *trace) = 0;
   virtual bool DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace) = 0;
 
+  // Debug sessions keep the trace's states on the replay side, so that only the inputs and
+  // cbuffers are returned in trace and the states are fetched as they're stepped through. Each
+  // returns a session ID and the number of steps, or 0 if the shader couldn't be debugged.
+  virtual uint32_t DebugVertexSession(uint32_t vertid, uint32_t instid, uint32_t idx,
+                                      uint32_t instOffset, uint32_t vertOffset,
+                                      ShaderDebugTrace *trace, uint32_t *numSteps) = 0;
+  virtual uint32_t DebugPixelSession(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
+                                     ShaderDebugTrace *trace, uint32_t *numSteps) = 0;
+  virtual uint32_t DebugThreadSession(uint32_t groupid[3], uint32_t threadid[3],
+                                      ShaderDebugTrace *trace, uint32_t *numSteps) = 0;
+  // the states for count steps starting at first, clamped to the end of the trace
+  virtual bool GetDebugStates(uint32_t session, uint32_t first, uint32_t count,
+                              rdctype::array<ShaderDebugState> *states) = 0;
+  // steps from step forward or backward until reaching the given instruction (if it's >= 0), a
+  // step with any of the flags set, or one of the breakpoint instructions, and returns that step.
+  // Stops at the first or last step if none of those are reached.
+  virtual uint32_t FindDebugStep(uint32_t session, uint32_t step, bool32 forward,
+                                 int32_t instruction, uint32_t flags, const uint32_t *breakpoints,
+                                 uint32_t numBreakpoints) = 0;
+  virtual void EndDebugSession(uint32_t session) = 0;
+
   virtual bool GetUsage(ResourceId id, rdctype::array<EventUsage> *usage) = 0;
 
   virtual bool GetCBufferVariableContents(ResourceId shader, const char *entryPoint,
                                           uint32_t cbufslot, ResourceId buffer, uint64_t offs,
                                           rdctype::array<ShaderVariable> *vars) = 0;
+  // fills out several constant blocks at the current event at once, vars[i] for requests[i]. The
+  // buffer data for all of them is fetched together, and results are kept for the event so
+  // asking again - from either function - doesn't fetch or decode anything.
+  virtual bool GetCBuffersVariableContents(
+      const rdctype::array<CBufferContentsRequest> &requests,
+      rdctype::array<rdctype::array<ShaderVariable> > *vars) = 0;
 
   virtual bool SaveTexture(const TextureSave &saveData, const char *path) = 0;
+  // save several textures (or several mips/slices of one texture) at once, saves[i] to paths[i].
+  // Encoding and writing the files happens in parallel, overlapped with reading back the next.
+  virtual bool SaveTextures(const rdctype::array<TextureSave> &saves,
+                            const rdctype::array<rdctype::str> &paths) = 0;
 
   virtual bool GetPostVSData(uint32_t instID, MeshDataStage stage, MeshFormat *data) = 0;
+  // compute the post-VS/GS data for the draws around the current event ahead of time, so that
+  // stepping between them in the mesh view doesn't have to wait for it. Intended to be called when
+  // the replay has nothing else to do.
+  virtual bool PrefetchPostVSData() = 0;
+
+  // search a texture subresource, or the current draw's post-VS/GS output, for float values that
+  // are NaN, infinite or outside a range. The search runs on the GPU where the API supports it,
+  // otherwise the data is read back and searched on the CPU. numMatches receives how many values
+  // matched, matches gets at most params.maxMatches of them ordered by location. Post-transform
+  // data is searched as 32-bit floats, x is the vertex. Block compressed textures can't be
+  // searched, and multisampled textures only where the search runs on the GPU.
+  virtual bool SearchTextureValues(ResourceId tex, uint32_t sliceFace, uint32_t mip,
+                                   uint32_t sample, const ValueSearchParams &params,
+                                   rdctype::array<ValueSearchMatch> *matches,
+                                   uint32_t *numMatches) = 0;
+  virtual bool SearchPostVSValues(uint32_t instID, MeshDataStage stage,
+                                  const ValueSearchParams &params,
+                                  rdctype::array<ValueSearchMatch> *matches,
+                                  uint32_t *numMatches) = 0;
+
+  // compare two texture subresources on the GPU, each at its own event. The replay is left at the
+  // current event. Only the stats in result are read back, the per-texel difference stays in
+  // result->diffTexture which can be displayed, or have min/max and histograms fetched, like any
+  // other texture. Where the API has no GPU diff, or for integer textures, both are read back and
+  // compared on the CPU, with the difference uploaded afterwards (a remote replay only gets the
+  // stats). Block compressed and multisampled textures need the GPU diff.
+  virtual bool CompareTextures(const TextureCompareInput &a, const TextureCompareInput &b,
+                               float threshold, TextureCompareResult *result) = 0;
+  // as CompareTextures, with b read from another capture's replay and uploaded here as a proxy.
+  // If b.eventID is set the other replay is moved to that event.
+  virtual bool CompareTextureWithCapture(const TextureCompareInput &a, IReplayRenderer *other,
+                                         const TextureCompareInput &b, float threshold,
+                                         TextureCompareResult *result) = 0;
 
   virtual bool GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
                              rdctype::array<byte> *data) = 0;
+  // reads back several buffer ranges at once, which lets the driver batch them into a single
+  // submission and a remote replay into a single round-trip. data gets one entry per range.
+  virtual bool GetBuffersData(const rdctype::array<BufferDataRange> &ranges,
+                              rdctype::array<rdctype::array<byte> > *data) = 0;
   virtual bool GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                               rdctype::array<byte> *data) = 0;
+  // as GetBufferData/GetTextureData, but the data is written straight into memory owned by the
+  // caller instead of a newly allocated array. At most dstSize bytes are written and dataSize
+  // receives the full size of the data. If dst is NULL or too small nothing is written and false
+  // is returned, so the caller can retry with a large enough buffer.
+  virtual bool GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dst,
+                                 uint64_t dstSize, uint64_t *dataSize) = 0;
+  virtual bool GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dst,
+                                  uint64_t dstSize, uint64_t *dataSize) = 0;
 };
 
 // deprecated C interface, for renderdocui only
@@ -308,6 +464,13 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetGLPipelineState(I
                                                                                GLPipelineState *state);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetVulkanPipelineState(IReplayRenderer *rend, VulkanPipelineState *state);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetVulkanPipelineStatePaged(
+    IReplayRenderer *rend, VulkanPipelineState *state, uint32_t maxArrayElements);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetVulkanDescriptorBindings(
+    IReplayRenderer *rend, ShaderStageType stage, uint32_t set, uint32_t binding, uint32_t first,
+    uint32_t count,
+    rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+        *elements);
 
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_BuildCustomShader(
     IReplayRenderer *rend, const char *entry, const char *source, const uint32_t compileFlags,
@@ -343,14 +506,34 @@ ReplayRenderer_GetTextures(IReplayRenderer *rend, rdctype::array<FetchTexture> *
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetBuffers(IReplayRenderer *rend, rdctype::array<FetchBuffer> *bufs);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_QueryTextures(IReplayRenderer *rend, const ResourceQuery &query,
+                             rdctype::array<FetchTexture> *texs, uint32_t *total);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_QueryBuffers(IReplayRenderer *rend, const ResourceQuery &query,
+                            rdctype::array<FetchBuffer> *bufs, uint32_t *total);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetResolve(IReplayRenderer *rend, uint64_t *callstack, uint32_t callstackLen,
                           rdctype::array<rdctype::str> *trace);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetDebugMessages(IReplayRenderer *rend, rdctype::array<DebugMessage> *msgs);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetAPIEventParameters(
+    IReplayRenderer *rend, uint32_t eventID, rdctype::array<APIEventParameter> *params);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetProxyStats(IReplayRenderer *rend, rdctype::array<ProxyCommandStats> *stats);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetMemoryStats(IReplayRenderer *rend, rdctype::array<ReplayMemoryStats> *stats);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetMemoryBudget(
+    IReplayRenderer *rend, ReplayMemoryCategory category, uint64_t bytes);
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_SetOperationControl(
+    IReplayRenderer *rend, volatile bool32 *cancel, float *progress);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistory(
     IReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
     uint32_t sampleIdx, FormatComponentType typeHint, rdctype::array<PixelModification> *history);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistoryBatched(
+    IReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
+    uint32_t sampleIdx, FormatComponentType typeHint, pPixelHistoryBatchCallback callback,
+    void *userData);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_DebugVertex(IReplayRenderer *rend, uint32_t vertid, uint32_t instid, uint32_t idx,
                            uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace);
@@ -370,15 +553,36 @@ ReplayRenderer_GetUsage(IReplayRenderer *rend, ResourceId id, rdctype::array<Eve
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetCBufferVariableContents(
     IReplayRenderer *rend, ResourceId shader, const char *entryPoint, uint32_t cbufslot,
     ResourceId buffer, uint64_t offs, rdctype::array<ShaderVariable> *vars);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetCBuffersVariableContents(
+    IReplayRenderer *rend, const rdctype::array<CBufferContentsRequest> &requests,
+    rdctype::array<rdctype::array<ShaderVariable> > *vars);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SaveTexture(IReplayRenderer *rend,
                                                                         const TextureSave &saveData,
                                                                         const char *path);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_SaveTextures(IReplayRenderer *rend, const rdctype::array<TextureSave> &saves,
+                            const rdctype::array<rdctype::str> &paths);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetPostVSData(IReplayRenderer *rend,
                                                                           uint32_t instID,
                                                                           MeshDataStage stage,
                                                                           MeshFormat *data);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_PrefetchPostVSData(IReplayRenderer *rend);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SearchTextureValues(
+    IReplayRenderer *rend, ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+    const ValueSearchParams &params, rdctype::array<ValueSearchMatch> *matches,
+    uint32_t *numMatches);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_CompareTextures(
+    IReplayRenderer *rend, const TextureCompareInput &a, const TextureCompareInput &b,
+    float threshold, TextureCompareResult *result);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_CompareTextureWithCapture(
+    IReplayRenderer *rend, const TextureCompareInput &a, IReplayRenderer *other,
+    const TextureCompareInput &b, float threshold, TextureCompareResult *result);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SearchPostVSValues(
+    IReplayRenderer *rend, uint32_t instID, MeshDataStage stage, const ValueSearchParams &params,
+    rdctype::array<ValueSearchMatch> *matches, uint32_t *numMatches);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetBufferData(IReplayRenderer *rend, ResourceId buff, uint64_t offset, uint64_t len,
@@ -386,6 +590,12 @@ ReplayRenderer_GetBufferData(IReplayRenderer *rend, ResourceId buff, uint64_t of
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetTextureData(IReplayRenderer *rend, ResourceId tex, uint32_t arrayIdx,
                               uint32_t mip, rdctype::array<byte> *data);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetBufferDataInto(IReplayRenderer *rend, ResourceId buff, uint64_t offset,
+                                 uint64_t len, byte *dst, uint64_t dstSize, uint64_t *dataSize);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetTextureDataInto(IReplayRenderer *rend, ResourceId tex, uint32_t arrayIdx,
+                                  uint32_t mip, byte *dst, uint64_t dstSize, uint64_t *dataSize);
 
 struct ITargetControl
 {
@@ -402,6 +612,20 @@ struct ITargetControl
   virtual void QueueCapture(uint32_t frameNumber) = 0;
   virtual void CopyCapture(uint32_t remoteID, const char *localpath) = 0;
   virtual void DeleteCapture(uint32_t remoteID) = 0;
+  // requests capture memory statistics, which arrive later as eTargetControlMsg_CaptureStats
+  virtual void QueryCaptureStats() = 0;
+  // if localFolder is set, each new capture is sent to the host as soon as it has been written,
+  // saved into that folder, and announced with eTargetControlMsg_CaptureCopied after its
+  // eTargetControlMsg_NewCapture. NULL or an empty string goes back to copying on request.
+  virtual void StreamCaptures(const char *localFolder) = 0;
+  // starts counting calls to the target's API entry points and timing one call in every
+  // sampleInterval, resetting any previous counts. 0 stops profiling
+  virtual void ProfileEntryPoints(uint32_t sampleInterval) = 0;
+  // requests the entry point counters, which arrive later as eTargetControlMsg_EntryPointStats
+  virtual void QueryEntryPointStats() = 0;
+  // sets the frame times that trigger a capture automatically, see
+  // eRENDERDOC_Option_SpikeCaptureThresholdMS and eRENDERDOC_Option_SpikeCapturePercent
+  virtual void SetSpikeCaptureTrigger(uint32_t thresholdMS, uint32_t averagePercent) = 0;
 
   virtual void ReceiveMessage(TargetControlMessage *msg) = 0;
 };
@@ -423,6 +647,15 @@ extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_CopyCapture(ITargetCont
                                                                      const char *localpath);
 extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_DeleteCapture(ITargetControl *control,
                                                                        uint32_t remoteID);
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_QueryCaptureStats(ITargetControl *control);
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_StreamCaptures(ITargetControl *control,
+                                                                        const char *localFolder);
+extern "C" RENDERDOC_API void RENDERDOC_CC
+TargetControl_ProfileEntryPoints(ITargetControl *control, uint32_t sampleInterval);
+extern "C" RENDERDOC_API void RENDERDOC_CC
+TargetControl_QueryEntryPointStats(ITargetControl *control);
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_SetSpikeCaptureTrigger(
+    ITargetControl *control, uint32_t thresholdMS, uint32_t averagePercent);
 
 extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_ReceiveMessage(ITargetControl *control,
                                                                         TargetControlMessage *msg);
@@ -490,6 +723,55 @@ RemoteServer_OpenCapture(IRemoteServer *remote, uint32_t proxyid, const char *lo
 extern "C" RENDERDOC_API void RENDERDOC_CC RemoteServer_CloseCapture(IRemoteServer *remote,
                                                                      IReplayRenderer *rend);
 
+// The same capture opened on several remote servers at once - typically one server process per GPU
+// on the same machine - with the heavy analyses split between them and the results merged as if
+// they came from a single replay. Each shard is a normal IReplayRenderer and can be used directly
+// for anything not covered here, but the set owns them.
+struct IReplayShardSet
+{
+  virtual uint32_t GetShardCount() = 0;
+  virtual IReplayRenderer *GetShard(uint32_t idx) = 0;
+
+  // moves every shard to the same event, which PixelHistory works back from
+  virtual bool SetFrameEvent(uint32_t eventID) = 0;
+
+  // the counters are split between the shards and each fetches its share over the whole frame, so
+  // there's only a speedup when fetching more than one counter. Results are ordered by event, then
+  // in the order the counters were requested.
+  virtual bool FetchCounters(uint32_t *counters, uint32_t numCounters,
+                             rdctype::array<CounterResult> *results) = 0;
+
+  // saves[i] is saved to paths[i] at eventIDs[i]. The events are split into one contiguous range
+  // for each shard so that each only replays forward through the frame.
+  virtual bool SaveTextures(const rdctype::array<uint32_t> &eventIDs,
+                            const rdctype::array<TextureSave> &saves,
+                            const rdctype::array<rdctype::str> &paths) = 0;
+
+  // history[i] is the history of queries[i] up to the current event. Shards take the next query as
+  // soon as they finish their last one, so uneven queries still balance out.
+  virtual bool PixelHistory(const rdctype::array<PixelHistoryQuery> &queries,
+                            rdctype::array<rdctype::array<PixelModification> > *history) = 0;
+
+  // closes the capture on every shard. The remote server connections are left open.
+  virtual void Shutdown() = 0;
+};
+
+extern "C" RENDERDOC_API uint32_t RENDERDOC_CC ReplayShardSet_GetShardCount(IReplayShardSet *set);
+extern "C" RENDERDOC_API IReplayRenderer *RENDERDOC_CC ReplayShardSet_GetShard(IReplayShardSet *set,
+                                                                              uint32_t idx);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayShardSet_SetFrameEvent(IReplayShardSet *set,
+                                                                         uint32_t eventID);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayShardSet_FetchCounters(IReplayShardSet *set, uint32_t *counters, uint32_t numCounters,
+                             rdctype::array<CounterResult> *results);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayShardSet_SaveTextures(
+    IReplayShardSet *set, const rdctype::array<uint32_t> &eventIDs,
+    const rdctype::array<TextureSave> &saves, const rdctype::array<rdctype::str> &paths);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayShardSet_PixelHistory(IReplayShardSet *set, const rdctype::array<PixelHistoryQuery> &queries,
+                            rdctype::array<rdctype::array<PixelModification> > *history);
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayShardSet_Shutdown(IReplayShardSet *set);
+
 //////////////////////////////////////////////////////////////////////////
 // camera
 //////////////////////////////////////////////////////////////////////////
@@ -520,6 +802,8 @@ extern "C" RENDERDOC_API void RENDERDOC_CC Camera_GetBasis(Camera *c, FloatVecto
 
 extern "C" RENDERDOC_API float RENDERDOC_CC Maths_HalfToFloat(uint16_t half);
 extern "C" RENDERDOC_API uint16_t RENDERDOC_CC Maths_FloatToHalf(float f);
+extern "C" RENDERDOC_API void RENDERDOC_CC Maths_HalfToFloatArray(const uint16_t *halves,
+                                                                  float *floats, uint32_t count);
 
 extern "C" RENDERDOC_API uint32_t RENDERDOC_CC
 Topology_NumVerticesPerPrimitive(PrimitiveTopology topology);
@@ -553,6 +837,11 @@ extern "C" RENDERDOC_API uint32_t RENDERDOC_CC RENDERDOC_EnumerateRemoteTargets(
 extern "C" RENDERDOC_API uint32_t RENDERDOC_CC RENDERDOC_GetDefaultRemoteServerPort();
 extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
 RENDERDOC_CreateRemoteServerConnection(const char *host, uint32_t port, IRemoteServer **rend);
+// copies the local logfile to each server and opens it there, all in parallel. The servers must be
+// separate connections that aren't already replaying anything, and they stay owned by the caller.
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_OpenShardedReplay(IRemoteServer **servers, uint32_t numServers, const char *logfile,
+                            float *progress, IReplayShardSet **set);
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_BecomeRemoteServer(const char *listenhost,
                                                                         uint32_t port,
                                                                         volatile bool32 *killReplay);
@@ -597,6 +886,47 @@ extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_LogMessage(LogMessageType t
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *filename,
                                                                     FileType type, uint32_t maxsize,
                                                                     rdctype::array<byte> *buf);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_RecompressCapture(
+    const char *filename, const char *destfilename, CaptureCompression compression);
+// times each stage of loading a capture and, if writeSize is non-zero, compressing that many
+// bytes of synthetic data with each codec and diffing it with each FindDiffRange implementation,
+// along with the per-call cost of serialising a draw call's fields during capture.
+// Results are returned as a JSON object. The replay stages are only run if replay is set, and need
+// a device capable of replaying the capture.
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_BenchmarkCapture(const char *filename,
+                                                                        bool32 replay,
+                                                                        uint64_t writeSize,
+                                                                        rdctype::str *json);
+// replays the whole frame of the capture warmup times, then iterations more times recording the
+// wall-clock time of each, then fetches per-event GPU durations gpuPasses times and sums them for
+// the frame and for each marker region. Results are returned as a JSON object. Needs a device
+// capable of replaying the capture, but no window.
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_BenchmarkReplay(const char *filename,
+                                                                       uint32_t warmup,
+                                                                       uint32_t iterations,
+                                                                       uint32_t gpuPasses,
+                                                                       rdctype::str *json);
+// loads the capture with its replay driver and writes out the decoded text of every chunk to
+// destfilename as it's read. Needs a device capable of replaying the capture.
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_ExportCaptureText(const char *filename, const char *destfilename);
+// replays the capture without any window and writes the outputs of every drawcall - or each marker
+// region if markerRegions is set - into outdir, with a manifest.json describing them. If meshes is
+// set the post-VS data of each drawcall is written out too.
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_ExportCaptureOutputs(const char *filename, const char *outdir, bool32 markerRegions,
+                               bool32 meshes);
+// compares two captures from the same API by a hash of each chunk's contents, without decoding or
+// replaying them, and returns a JSON object listing the added, removed and changed chunks in each
+// marker region and in the resources before the frame. At most maxListed changes are listed per
+// region, the counts always cover all of them.
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_DiffCaptures(const char *fileA,
+                                                                    const char *fileB,
+                                                                    uint32_t maxListed,
+                                                                    rdctype::str *json);
+// writes the most recent timed phases of loading and replaying (see SCOPED_TRACE) to filename as a
+// Chrome trace, which can be opened in chrome://tracing or Perfetto
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_ExportTrace(const char *filename);
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetVersionString();
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetCommitHash();
 extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetConfigSetting(const char *name);
@@ -185,6 +185,12 @@ enum FileType
   eFileType_Count,
 };
 
+enum CaptureCompression
+{
+  eCaptureCompression_LZ4,
+  eCaptureCompression_Deflate,
+};
+
 enum AlphaMapping
 {
   eAlphaMap_Discard,
@@ -519,6 +525,10 @@ enum GPUCounters
   eCounter_CSInvocations,
   eCounter_GLMaxCounters,
 
+  // read from the timestamps recorded while capturing with eRENDERDOC_Option_CaptureEventTimings
+  // rather than measured on replay, so it sits past the counters that GL queries when replaying.
+  eCounter_CapturedGPUDuration,
+
   // IHV specific counters can be set above this point
   // with ranges reserved for each IHV
   eCounter_FirstAMD = 1000000,
@@ -528,6 +538,15 @@ enum GPUCounters
   eCounter_FirstNvidia = 3000000,
 };
 
+// which values a value search matches, these can be combined. Values match if they meet any of the
+// set conditions.
+enum ValueSearchFlags
+{
+  eValueSearch_NaN = 0x1,
+  eValueSearch_Inf = 0x2,
+  eValueSearch_OutOfRange = 0x4,
+};
+
 enum CounterUnits
 {
   eUnits_Absolute,
@@ -573,6 +592,8 @@ enum TargetControlMessageType
   eTargetControlMsg_CaptureCopied,
   eTargetControlMsg_RegisterAPI,
   eTargetControlMsg_NewChild,
+  eTargetControlMsg_CaptureStats,
+  eTargetControlMsg_EntryPointStats,
 };
 
 enum EnvironmentModificationType
@@ -612,3 +633,20 @@ enum VulkanFlags
   eVulkan_UpdateAllowed = 0x20,
   eVulkan_Unfixable = 0x40,
 };
+
+// what replay-side memory is being used for, see IReplayRenderer::GetMemoryStats
+enum ReplayMemoryCategory
+{
+  // the resources created from the capture itself
+  eReplayMemory_CaptureResources,
+  // copies of each resource's contents at the start of the frame, to reset to between replays
+  eReplayMemory_InitialContents,
+  // cached vertex and geometry shader output for the mesh viewer
+  eReplayMemory_PostVSCache,
+  // local copies of remote textures and buffers when replaying on another machine
+  eReplayMemory_ProxyResources,
+  // everything else the replay creates for its own use - overlays, readback, shaders
+  eReplayMemory_DebugResources,
+
+  eReplayMemory_Count,
+};
@@ -27,6 +27,8 @@
 #include <stdarg.h>
 #include <string.h>
 #include <string>
+#include <vector>
+#include "common/job_system.h"
 #include "common/threading.h"
 #include "os/os_specific.h"
 #include "serialise/string_utils.h"
@@ -84,34 +86,82 @@ void rdcassert(const char *msg, const char *file, unsigned int line, const char
   rdclog_int(RDCLog_Error, RDCLOG_PROJECT, file, line, "Assertion failed: %s", msg);
 }
 
-#if 0
-static __m128 zero = {0};
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DIFF_RANGE_X86 OPTION_ON
+#else
+#define DIFF_RANGE_X86 OPTION_OFF
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define DIFF_RANGE_NEON OPTION_ON
+#else
+#define DIFF_RANGE_NEON OPTION_OFF
+#endif
+
+#if ENABLED(DIFF_RANGE_X86)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+
+#include <intrin.h>
+
+// MSVC allows any intrinsic in any function
+#define DIFF_TARGET_SSE2
+#define DIFF_TARGET_AVX2
+
+static void CPUID(int leaf, int subleaf, int regs[4])
+{
+  __cpuidex(regs, leaf, subleaf);
+}
+
+static uint64_t XGetBV()
+{
+  return _xgetbv(0);
+}
+
+#else
+
+#include <cpuid.h>
+
+// only these functions are compiled for the wider instruction sets, they're only called once the
+// CPU has been checked for support
+#define DIFF_TARGET_SSE2 __attribute__((target("sse2")))
+#define DIFF_TARGET_AVX2 __attribute__((target("avx2")))
+
+static void CPUID(int leaf, int subleaf, int regs[4])
+{
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+}
+
+static uint64_t XGetBV()
+{
+  uint32_t lo = 0, hi = 0;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (uint64_t(hi) << 32) | lo;
+}
+
+#endif
+
+#endif    // DIFF_RANGE_X86
+
+#if ENABLED(DIFF_RANGE_NEON)
+#include <arm_neon.h>
 #endif
 
+// FindDiffRange compares 16-byte vectors, the implementations below only differ in how quickly they
+// find the first and last vector that differs. Finding the byte-accurate edges is common.
+//
+// returns the index of the first differing vector, or numVecs if they're all equal
+typedef size_t (*DiffScanFirst)(const byte *a, const byte *b, size_t numVecs);
+// returns one past the index of the last differing vector, or 0 if they're all equal
+typedef size_t (*DiffScanLast)(const byte *a, const byte *b, size_t numVecs);
+
 // assumes a and b both point to 16-byte aligned 16-byte chunks of memory.
 // Returns if they're equal or different
-bool Vec16NotEqual(void *a, void *b)
-{
-// disabled SSE version as it's acting dodgy
-#if 0
-	__m128 avec = _mm_load_ps(aflt);
-	__m128 bvec = _mm_load_ps(bflt);
-
-	__m128 diff = _mm_xor_ps(avec, bvec);
-
-	__m128 eq = _mm_cmpeq_ps(diff, zero);
-	int mask = _mm_movemask_ps(eq);
-	int signMask = _mm_movemask_ps(diff);
-
-	// first check ensures that diff is floatequal to zero (ie. avec bitwise equal to bvec).
-	// HOWEVER -0 is floatequal to 0, so we ensure no sign bits are set on diff
-	if((mask^0xf) || signMask != 0)
-	{
-		return true;
-	}
-	
-	return false;
-#elif ENABLED(RDOC_X64)
+static bool Vec16NotEqual(const byte *a, const byte *b)
+{
+#if ENABLED(RDOC_X64)
   uint64_t *a64 = (uint64_t *)a;
   uint64_t *b64 = (uint64_t *)b;
 
@@ -124,105 +174,462 @@ bool Vec16NotEqual(void *a, void *b)
 #endif
 }
 
-bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
+static size_t ScanFirst_Scalar(const byte *a, const byte *b, size_t numVecs)
 {
-  RDCASSERT(uintptr_t(a) % 16 == 0);
-  RDCASSERT(uintptr_t(b) % 16 == 0);
+  for(size_t v = 0; v < numVecs; v++)
+    if(Vec16NotEqual(a + v * 16, b + v * 16))
+      return v;
 
-  diffStart = bufSize + 1;
-  diffEnd = 0;
+  return numVecs;
+}
 
-  size_t alignedSize = bufSize & (~0xf);
-  size_t numVecs = alignedSize / 16;
+static size_t ScanLast_Scalar(const byte *a, const byte *b, size_t numVecs)
+{
+  for(size_t v = numVecs; v > 0; v--)
+    if(Vec16NotEqual(a + (v - 1) * 16, b + (v - 1) * 16))
+      return v;
+
+  return 0;
+}
 
-  size_t offs = 0;
+#if ENABLED(DIFF_RANGE_X86)
 
-  float *aflt = (float *)a;
-  float *bflt = (float *)b;
+DIFF_TARGET_SSE2 static __m128i Vec16Equal_SSE2(const byte *a, const byte *b)
+{
+  return _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)a), _mm_load_si128((const __m128i *)b));
+}
 
-  // sweep to find the start of differences
-  for(size_t v = 0; v < numVecs; v++)
+DIFF_TARGET_SSE2 static bool Block64Equal_SSE2(const byte *a, const byte *b)
+{
+  __m128i eq = _mm_and_si128(_mm_and_si128(Vec16Equal_SSE2(a, b), Vec16Equal_SSE2(a + 16, b + 16)),
+                             _mm_and_si128(Vec16Equal_SSE2(a + 32, b + 32),
+                                           Vec16Equal_SSE2(a + 48, b + 48)));
+
+  return _mm_movemask_epi8(eq) == 0xffff;
+}
+
+// compares 64 bytes at a time, then finds the exact vector within the block that differs
+DIFF_TARGET_SSE2 static size_t ScanFirst_SSE2(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = 0;
+
+  for(; v + 4 <= numVecs; v += 4)
+    if(!Block64Equal_SSE2(a + v * 16, b + v * 16))
+      break;
+
+  for(; v < numVecs; v++)
+    if(_mm_movemask_epi8(Vec16Equal_SSE2(a + v * 16, b + v * 16)) != 0xffff)
+      return v;
+
+  return numVecs;
+}
+
+DIFF_TARGET_SSE2 static size_t ScanLast_SSE2(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = numVecs;
+
+  for(; v >= 4; v -= 4)
+    if(!Block64Equal_SSE2(a + (v - 4) * 16, b + (v - 4) * 16))
+      break;
+
+  for(; v > 0; v--)
+    if(_mm_movemask_epi8(Vec16Equal_SSE2(a + (v - 1) * 16, b + (v - 1) * 16)) != 0xffff)
+      return v;
+
+  return 0;
+}
+
+// the buffers are only 16-byte aligned so these are unaligned loads, which cost nothing extra
+// for data that's aligned in practice
+DIFF_TARGET_AVX2 static bool Block128Equal_AVX2(const byte *a, const byte *b)
+{
+  __m256i eq[4];
+
+  for(int i = 0; i < 4; i++)
+    eq[i] = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i * 32)),
+                              _mm256_loadu_si256((const __m256i *)(b + i * 32)));
+
+  __m256i all = _mm256_and_si256(_mm256_and_si256(eq[0], eq[1]), _mm256_and_si256(eq[2], eq[3]));
+
+  return _mm256_movemask_epi8(all) == -1;
+}
+
+// compares 128 bytes at a time, then hands the block that differs and anything left over to the
+// SSE2 scan to find the exact vector
+DIFF_TARGET_AVX2 static size_t ScanFirst_AVX2(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = 0;
+
+  for(; v + 8 <= numVecs; v += 8)
+    if(!Block128Equal_AVX2(a + v * 16, b + v * 16))
+      break;
+
+  return v + ScanFirst_SSE2(a + v * 16, b + v * 16, numVecs - v);
+}
+
+DIFF_TARGET_AVX2 static size_t ScanLast_AVX2(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = numVecs;
+
+  for(; v >= 8; v -= 8)
+    if(!Block128Equal_AVX2(a + (v - 8) * 16, b + (v - 8) * 16))
+      break;
+
+  return ScanLast_SSE2(a, b, v);
+}
+
+bool CPUSupportsSSE2()
+{
+#if ENABLED(RDOC_X64)
+  // always present on x64
+  return true;
+#else
+  int regs[4] = {};
+  CPUID(1, 0, regs);
+  return (regs[3] & (1 << 26)) != 0;
+#endif
+}
+
+// the OS must also save the upper halves of the registers on context switches
+static bool SupportsAVX()
+{
+  int regs[4] = {};
+  CPUID(1, 0, regs);
+  const int osxsave = (1 << 27), avx = (1 << 28);
+  return (regs[2] & (osxsave | avx)) == (osxsave | avx) && (XGetBV() & 0x6) == 0x6;
+}
+
+bool CPUSupportsAVX2()
+{
+  int regs[4] = {};
+
+  CPUID(0, 0, regs);
+  if(regs[0] < 7 || !SupportsAVX())
+    return false;
+
+  CPUID(7, 0, regs);
+  return (regs[1] & (1 << 5)) != 0;
+}
+
+bool CPUSupportsF16C()
+{
+  if(!SupportsAVX())
+    return false;
+
+  int regs[4] = {};
+  CPUID(1, 0, regs);
+  return (regs[2] & (1 << 29)) != 0;
+}
+
+#else
+
+bool CPUSupportsSSE2()
+{
+  return false;
+}
+
+bool CPUSupportsAVX2()
+{
+  return false;
+}
+
+bool CPUSupportsF16C()
+{
+  return false;
+}
+
+#endif    // DIFF_RANGE_X86
+
+#if ENABLED(DIFF_RANGE_NEON)
+
+static bool AllOnes_NEON(uint8x16_t v)
+{
+  uint64x2_t v64 = vreinterpretq_u64_u8(v);
+  return (vgetq_lane_u64(v64, 0) & vgetq_lane_u64(v64, 1)) == ~0ULL;
+}
+
+static uint8x16_t Vec16Equal_NEON(const byte *a, const byte *b)
+{
+  return vceqq_u8(vld1q_u8(a), vld1q_u8(b));
+}
+
+static bool Block64Equal_NEON(const byte *a, const byte *b)
+{
+  return AllOnes_NEON(vandq_u8(vandq_u8(Vec16Equal_NEON(a, b), Vec16Equal_NEON(a + 16, b + 16)),
+                               vandq_u8(Vec16Equal_NEON(a + 32, b + 32),
+                                        Vec16Equal_NEON(a + 48, b + 48))));
+}
+
+static size_t ScanFirst_NEON(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = 0;
+
+  for(; v + 4 <= numVecs; v += 4)
+    if(!Block64Equal_NEON(a + v * 16, b + v * 16))
+      break;
+
+  for(; v < numVecs; v++)
+    if(!AllOnes_NEON(Vec16Equal_NEON(a + v * 16, b + v * 16)))
+      return v;
+
+  return numVecs;
+}
+
+static size_t ScanLast_NEON(const byte *a, const byte *b, size_t numVecs)
+{
+  size_t v = numVecs;
+
+  for(; v >= 4; v -= 4)
+    if(!Block64Equal_NEON(a + (v - 4) * 16, b + (v - 4) * 16))
+      break;
+
+  for(; v > 0; v--)
+    if(!AllOnes_NEON(Vec16Equal_NEON(a + (v - 1) * 16, b + (v - 1) * 16)))
+      return v;
+
+  return 0;
+}
+
+#endif    // DIFF_RANGE_NEON
+
+struct DiffScanImpl
+{
+  const char *name;
+  DiffScanFirst first;
+  DiffScanLast last;
+};
+
+static DiffScanImpl GetDiffScanImpl(DiffRangeImpl impl)
+{
+  DiffScanImpl ret = {"scalar", &ScanFirst_Scalar, &ScanLast_Scalar};
+
+  switch(impl)
   {
-    if(Vec16NotEqual(aflt, bflt))
+#if ENABLED(DIFF_RANGE_X86)
+    case eDiffRange_SSE2:
     {
-      diffStart = offs;
+      DiffScanImpl sse2 = {"sse2", &ScanFirst_SSE2, &ScanLast_SSE2};
+      if(CPUSupportsSSE2())
+        ret = sse2;
       break;
     }
+    case eDiffRange_AVX2:
+    {
+      DiffScanImpl avx2 = {"avx2", &ScanFirst_AVX2, &ScanLast_AVX2};
+      if(CPUSupportsSSE2() && CPUSupportsAVX2())
+        ret = avx2;
+      break;
+    }
+#endif
+#if ENABLED(DIFF_RANGE_NEON)
+    case eDiffRange_NEON:
+    {
+      DiffScanImpl neon = {"neon", &ScanFirst_NEON, &ScanLast_NEON};
+      ret = neon;
+      break;
+    }
+#endif
+    default: break;
+  }
+
+  return ret;
+}
 
-    aflt += 4;
-    bflt += 4;
-    offs += 4 * sizeof(float);
+bool DiffRangeImplSupported(DiffRangeImpl impl)
+{
+  return impl == eDiffRange_Scalar ||
+         GetDiffScanImpl(impl).first != GetDiffScanImpl(eDiffRange_Scalar).first;
+}
+
+const char *DiffRangeImplName(DiffRangeImpl impl)
+{
+  switch(impl)
+  {
+    case eDiffRange_Scalar: return "scalar";
+    case eDiffRange_SSE2: return "sse2";
+    case eDiffRange_AVX2: return "avx2";
+    case eDiffRange_NEON: return "neon";
+    default: break;
   }
 
-  // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffStart < bufSize && *((byte *)a + diffStart) == *((byte *)b + diffStart))
-    diffStart++;
+  return "unknown";
+}
+
+static DiffScanImpl PickDiffScanImpl()
+{
+  for(int i = eDiffRange_Count - 1; i > eDiffRange_Scalar; i--)
+    if(DiffRangeImplSupported((DiffRangeImpl)i))
+      return GetDiffScanImpl((DiffRangeImpl)i);
+
+  return GetDiffScanImpl(eDiffRange_Scalar);
+}
+
+static const DiffScanImpl &GetBestDiffScanImpl()
+{
+  // initialised exactly once, so no thread can see a partially filled in implementation
+  static const DiffScanImpl best = PickDiffScanImpl();
+
+  return best;
+}
+
+// below this much data per thread it's not worth starting threads. Each one scans an even share
+// from its start until it finds a difference, then from its end back to that difference.
+static const size_t DiffMinBytesPerThread = 16 * 1024 * 1024;
+static const uint32_t DiffMaxThreads = 4;
+
+struct DiffScanJob
+{
+  DiffScanImpl impl;
+  const byte *a;
+  const byte *b;
+  size_t numVecs;
+  bool needLast;
+
+  size_t first;
+  size_t last;
+};
+
+static void RunDiffScanJob(void *param)
+{
+  DiffScanJob &job = *(DiffScanJob *)param;
+
+  job.first = job.impl.first(job.a, job.b, job.numVecs);
+  job.last = 0;
 
-  // do we have some unaligned bytes at the end of the buffer?
-  if(bufSize > alignedSize)
+  if(job.first < job.numVecs && job.needLast)
   {
-    size_t numBytes = bufSize - alignedSize;
+    size_t offs = job.first * 16;
+    job.last = job.first + job.impl.last(job.a + offs, job.b + offs, job.numVecs - job.first);
+  }
+}
 
-    // if we haven't even found a start, check in these bytes
-    if(diffStart > bufSize)
-    {
-      offs = bufSize;
-
-      for(size_t by = 0; by < numBytes; by++)
-      {
-        if(*((byte *)a + alignedSize + by) != *((byte *)b + alignedSize + by))
-        {
-          diffStart = offs;
-          break;
-        }
-
-        offs++;
-      }
-    }
+// finds the first differing vector (numVecs if none) and, if needLast, one past the last
+static void ScanDiffVecs(const DiffScanImpl &impl, uint32_t numThreads, const byte *a,
+                         const byte *b, size_t numVecs, bool needLast, size_t &first, size_t &last)
+{
+  numThreads = (uint32_t)RDCMIN((size_t)numThreads, numVecs * 16 / DiffMinBytesPerThread);
 
-    // sweep from the last byte to find the end
-    for(size_t by = 0; by < numBytes; by++)
-    {
-      if(*((byte *)a + bufSize - 1 - by) != *((byte *)b + bufSize - 1 - by))
-      {
-        diffEnd = bufSize - by;
-        break;
-      }
-    }
+  if(numThreads <= 1)
+  {
+    DiffScanJob job = {impl, a, b, numVecs, needLast, 0, 0};
+    RunDiffScanJob(&job);
+    first = job.first;
+    last = job.last;
+    return;
   }
 
-  // if we haven't found a start, or we've found a start AND and end,
-  // then we're done.
-  if(diffStart > bufSize || diffEnd > 0)
-    return diffStart < bufSize;
+  std::vector<DiffScanJob> jobs(numThreads);
+  Threading::JobGroup group;
 
-  offs = alignedSize;
+  size_t vecsPerThread = numVecs / numThreads;
 
-  // sweep from the last __m128
-  aflt = (float *)a + offs / sizeof(float) - 4;
-  bflt = (float *)b + offs / sizeof(float) - 4;
+  for(uint32_t t = 0; t < numThreads; t++)
+  {
+    size_t start = t * vecsPerThread;
+    size_t count = (t + 1 == numThreads) ? numVecs - start : vecsPerThread;
 
-  for(size_t v = 0; v < numVecs; v++)
+    DiffScanJob job = {impl, a + start * 16, b + start * 16, count, needLast, 0, 0};
+    jobs[t] = job;
+
+    // this thread takes the first share itself
+    if(t > 0)
+      group.Submit(&RunDiffScanJob, &jobs[t]);
+  }
+
+  RunDiffScanJob(&jobs[0]);
+
+  group.Wait();
+
+  first = numVecs;
+  last = 0;
+
+  for(uint32_t t = 0; t < numThreads; t++)
   {
-    if(Vec16NotEqual(aflt, bflt))
+    if(jobs[t].first == jobs[t].numVecs)
+      continue;
+
+    size_t start = t * vecsPerThread;
+
+    if(first == numVecs)
+      first = start + jobs[t].first;
+
+    last = start + jobs[t].last;
+  }
+}
+
+static bool FindDiffRange(const DiffScanImpl &impl, uint32_t numThreads, void *a, void *b,
+                          size_t bufSize, size_t &diffStart, size_t &diffEnd)
+{
+  RDCASSERT(uintptr_t(a) % 16 == 0);
+  RDCASSERT(uintptr_t(b) % 16 == 0);
+
+  byte *abyte = (byte *)a;
+  byte *bbyte = (byte *)b;
+
+  diffStart = bufSize + 1;
+  diffEnd = 0;
+
+  size_t alignedSize = bufSize & (~0xf);
+  size_t numVecs = alignedSize / 16;
+
+  // sweep from the last byte of any unaligned bytes at the end, to find the end
+  for(size_t offs = bufSize; offs > alignedSize; offs--)
+  {
+    if(abyte[offs - 1] != bbyte[offs - 1])
     {
       diffEnd = offs;
       break;
     }
+  }
 
-    aflt -= 4;
-    bflt -= 4;
-    offs -= 16;
+  size_t firstVec = numVecs, lastVec = 0;
+  ScanDiffVecs(impl, numThreads, abyte, bbyte, numVecs, diffEnd == 0, firstVec, lastVec);
+
+  if(firstVec < numVecs)
+  {
+    diffStart = firstVec * 16;
+
+    // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
+    while(diffStart < bufSize && abyte[diffStart] == bbyte[diffStart])
+      diffStart++;
+  }
+  else if(diffEnd > 0)
+  {
+    // the only differences are in the unaligned bytes
+    diffStart = alignedSize;
+    while(abyte[diffStart] == bbyte[diffStart])
+      diffStart++;
   }
 
+  // if we haven't found a start, or we've found a start AND and end,
+  // then we're done.
+  if(diffStart > bufSize || diffEnd > 0)
+    return diffStart < bufSize;
+
+  diffEnd = lastVec * 16;
+
   // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffEnd > 0 && *((byte *)a + diffEnd - 1) == *((byte *)b + diffEnd - 1))
+  while(diffEnd > 0 && abyte[diffEnd - 1] == bbyte[diffEnd - 1])
     diffEnd--;
 
   // if we found a start then we necessarily found an end
   return diffStart < bufSize;
 }
 
+bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
+{
+  uint32_t numThreads = RDCMIN(Threading::GetNumberOfCores(), DiffMaxThreads);
+
+  return FindDiffRange(GetBestDiffScanImpl(), numThreads, a, b, bufSize, diffStart, diffEnd);
+}
+
+bool FindDiffRange(DiffRangeImpl impl, uint32_t numThreads, void *a, void *b, size_t bufSize,
+                   size_t &diffStart, size_t &diffEnd)
+{
+  return FindDiffRange(GetDiffScanImpl(impl), RDCMAX(numThreads, 1U), a, b, bufSize, diffStart,
+                       diffEnd);
+}
+
 uint32_t CalcNumMips(int w, int h, int d)
 {
   int mipLevels = 1;
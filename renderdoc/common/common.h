@@ -154,7 +154,32 @@ inline T AlignUpPtr(T x, A a)
 #define MAKE_FOURCC(a, b, c, d) \
   (((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
 
+// the ways FindDiffRange can compare memory. It uses the widest one the CPU supports
+enum DiffRangeImpl
+{
+  eDiffRange_Scalar,
+  eDiffRange_SSE2,
+  eDiffRange_AVX2,
+  eDiffRange_NEON,
+  eDiffRange_Count,
+};
+
+bool DiffRangeImplSupported(DiffRangeImpl impl);
+const char *DiffRangeImplName(DiffRangeImpl impl);
+
+// finds the range of bytes [diffStart, diffEnd) that differs between a and b, which must both be
+// 16-byte aligned. Returns false if they're identical. Large buffers are split across threads.
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd);
+// as above with one implementation and up to numThreads threads, for benchmarking. Unsupported
+// implementations fall back to the scalar one
+bool FindDiffRange(DiffRangeImpl impl, uint32_t numThreads, void *a, void *b, size_t bufSize,
+                   size_t &diffStart, size_t &diffEnd);
+
+// runtime checks for the x86 instruction sets the SIMD paths use. Always false on other CPUs
+bool CPUSupportsSSE2();
+bool CPUSupportsAVX2();
+bool CPUSupportsF16C();
+
 uint32_t CalcNumMips(int Width, int Height, int Depth);
 
 uint32_t Log2Floor(uint32_t value);
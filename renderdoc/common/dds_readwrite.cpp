@@ -615,7 +615,63 @@ DXGI_FORMAT ResourceFormat2DXGIFormat(ResourceFormat format)
   return DXGI_FORMAT_UNKNOWN;
 }
 
-bool write_dds_to_file(FILE *f, const dds_data &data)
+// calculates the pitch of one row and the number of rows in one depth slice of a mip. Both are
+// in blocks rather than pixels for block-compressed formats.
+static bool get_dds_subresource_layout(const dds_data &data, int mip, int &pitch, int &numRows)
+{
+  int rowlen = RDCMAX(1, data.width >> mip);
+  numRows = RDCMAX(1, data.height >> mip);
+
+  if(data.format.special)
+  {
+    switch(data.format.specialFormat)
+    {
+      case eSpecial_BC1:
+      case eSpecial_BC2:
+      case eSpecial_BC3:
+      case eSpecial_BC4:
+      case eSpecial_BC5:
+      case eSpecial_BC6:
+      case eSpecial_BC7:
+      {
+        int blockSize =
+            (data.format.specialFormat == eSpecial_BC1 || data.format.specialFormat == eSpecial_BC4)
+                ? 8
+                : 16;
+
+        numRows = RDCMAX(1, numRows / 4);
+        pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
+        return true;
+      }
+      default: break;
+    }
+  }
+
+  uint32_t bytesPerPixel = 1;
+  switch(data.format.specialFormat)
+  {
+    case eSpecial_S8: bytesPerPixel = 1; break;
+    case eSpecial_R10G10B10A2:
+    case eSpecial_R9G9B9E5:
+    case eSpecial_R11G11B10:
+    case eSpecial_D24S8: bytesPerPixel = 4; break;
+    case eSpecial_R5G6B5:
+    case eSpecial_R5G5B5A1:
+    case eSpecial_R4G4B4A4: bytesPerPixel = 2; break;
+    case eSpecial_D32S8: bytesPerPixel = 8; break;
+    case eSpecial_D16S8:
+    case eSpecial_YUV:
+    case eSpecial_R4G4:
+      RDCERR("Unsupported file format %u", data.format.specialFormat);
+      return false;
+    default: bytesPerPixel = data.format.compCount * data.format.compByteWidth;
+  }
+
+  pitch = RDCMAX(1, rowlen * (int)bytesPerPixel);
+  return true;
+}
+
+bool write_dds_header_to_file(FILE *f, const dds_data &data)
 {
   if(!f)
     return false;
@@ -698,39 +754,11 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
   if(headerDXT10.arraySize > 1)
     dx10Header = true;    // need to specify dx10 header to give array size
 
-  uint32_t bytesPerPixel = 1;
-
-  if(blockFormat)
-  {
-    int blockSize =
-        (data.format.specialFormat == eSpecial_BC1 || data.format.specialFormat == eSpecial_BC4)
-            ? 8
-            : 16;
-    header.dwPitchOrLinearSize = RDCMAX(1U, ((header.dwWidth + 3) / 4)) * blockSize;
-  }
-  else
-  {
-    switch(data.format.specialFormat)
-    {
-      case eSpecial_S8: bytesPerPixel = 1; break;
-      case eSpecial_R10G10B10A2:
-      case eSpecial_R9G9B9E5:
-      case eSpecial_R11G11B10:
-      case eSpecial_D24S8: bytesPerPixel = 4; break;
-      case eSpecial_R5G6B5:
-      case eSpecial_R5G5B5A1:
-      case eSpecial_R4G4B4A4: bytesPerPixel = 2; break;
-      case eSpecial_D32S8: bytesPerPixel = 8; break;
-      case eSpecial_D16S8:
-      case eSpecial_YUV:
-      case eSpecial_R4G4:
-        RDCERR("Unsupported file format %u", data.format.specialFormat);
-        return false;
-      default: bytesPerPixel = data.format.compCount * data.format.compByteWidth;
-    }
+  int pitch = 0, numRows = 0;
+  if(!get_dds_subresource_layout(data, 0, pitch, numRows))
+    return false;
 
-    header.dwPitchOrLinearSize = header.dwWidth * bytesPerPixel;
-  }
+  header.dwPitchOrLinearSize = (uint32_t)pitch;
 
   // special case a couple of formats to write out non-DX10 style, for
   // backwards compatibility
@@ -794,48 +822,43 @@ bool write_dds_to_file(FILE *f, const dds_data &data)
     header.ddspf.dwFourCC = MAKE_FOURCC('D', 'X', '1', '0');
   }
 
-  {
-    FileIO::fwrite(&magic, sizeof(magic), 1, f);
-    FileIO::fwrite(&header, sizeof(header), 1, f);
-    if(dx10Header)
-      FileIO::fwrite(&headerDXT10, sizeof(headerDXT10), 1, f);
-
-    int i = 0;
-    for(int slice = 0; slice < RDCMAX(1, data.slices); slice++)
-    {
-      for(int mip = 0; mip < RDCMAX(1, data.mips); mip++)
-      {
-        int numdepths = RDCMAX(1, data.depth >> mip);
-        for(int d = 0; d < numdepths; d++)
-        {
-          byte *bytedata = data.subdata[i];
+  FileIO::fwrite(&magic, sizeof(magic), 1, f);
+  FileIO::fwrite(&header, sizeof(header), 1, f);
+  if(dx10Header)
+    FileIO::fwrite(&headerDXT10, sizeof(headerDXT10), 1, f);
 
-          int rowlen = RDCMAX(1, data.width >> mip);
-          int numRows = RDCMAX(1, data.height >> mip);
-          int pitch = RDCMAX(1U, rowlen * bytesPerPixel);
+  return true;
+}
 
-          // pitch/rows are in blocks, not pixels, for block formats.
-          if(blockFormat)
-          {
-            numRows = RDCMAX(1, numRows / 4);
+bool write_dds_subresource_to_file(FILE *f, const dds_data &data, int mip, const byte *subdata)
+{
+  int pitch = 0, numRows = 0;
+  if(!f || !get_dds_subresource_layout(data, mip, pitch, numRows))
+    return false;
 
-            int blockSize = (data.format.specialFormat == eSpecial_BC1 ||
-                             data.format.specialFormat == eSpecial_BC4)
-                                ? 8
-                                : 16;
+  // rows are tightly packed both in memory and in the file
+  size_t size = size_t(pitch) * size_t(numRows);
 
-            pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
-          }
+  return FileIO::fwrite(subdata, 1, size, f) == size;
+}
 
-          for(int row = 0; row < numRows; row++)
-          {
-            FileIO::fwrite(bytedata, 1, pitch, f);
+bool write_dds_to_file(FILE *f, const dds_data &data)
+{
+  if(!write_dds_header_to_file(f, data))
+    return false;
 
-            bytedata += pitch;
-          }
+  int i = 0;
+  for(int slice = 0; slice < RDCMAX(1, data.slices); slice++)
+  {
+    for(int mip = 0; mip < RDCMAX(1, data.mips); mip++)
+    {
+      int numdepths = RDCMAX(1, data.depth >> mip);
+      for(int d = 0; d < numdepths; d++)
+      {
+        if(!write_dds_subresource_to_file(f, data, mip, data.subdata[i]))
+          return false;
 
-          i++;
-        }
+        i++;
       }
     }
   }
@@ -855,11 +878,13 @@ bool is_dds_file(FILE *f)
   return magic == dds_fourcc;
 }
 
-dds_data load_dds_from_file(FILE *f)
+dds_data load_dds_header_from_file(FILE *f, uint64_t &dataOffset)
 {
   dds_data ret = {};
   dds_data error = {};
 
+  dataOffset = 0;
+
   FileIO::fseek64(f, 0, SEEK_SET);
 
   uint32_t magic = 0;
@@ -1009,7 +1034,6 @@ dds_data load_dds_from_file(FILE *f)
   }
 
   ret.subsizes = new uint32_t[ret.slices * ret.mips];
-  ret.subdata = new byte *[ret.slices * ret.mips];
 
   int i = 0;
   for(int slice = 0; slice < ret.slices; slice++)
@@ -1036,20 +1060,75 @@ dds_data load_dds_from_file(FILE *f)
 
       ret.subsizes[i] = numdepths * numRows * pitch;
 
-      byte *bytedata = ret.subdata[i] = new byte[ret.subsizes[i]];
+      i++;
+    }
+  }
 
-      for(int d = 0; d < numdepths; d++)
-      {
-        for(int row = 0; row < numRows; row++)
-        {
-          FileIO::fread(bytedata, 1, pitch, f);
+  dataOffset = FileIO::ftell64(f);
 
-          bytedata += pitch;
-        }
-      }
+  return ret;
+}
 
-      i++;
-    }
+dds_data load_dds_from_file(FILE *f)
+{
+  uint64_t dataOffset = 0;
+  dds_data ret = load_dds_header_from_file(f, dataOffset);
+
+  if(ret.subsizes == NULL)
+    return ret;
+
+  FileIO::fseek64(f, dataOffset, SEEK_SET);
+
+  // subresources are tightly packed one after another, slice-major then mip
+  ret.subdata = new byte *[ret.slices * ret.mips];
+
+  for(int i = 0; i < ret.slices * ret.mips; i++)
+  {
+    ret.subdata[i] = new byte[ret.subsizes[i]];
+    FileIO::fread(ret.subdata[i], 1, ret.subsizes[i], f);
+  }
+
+  return ret;
+}
+
+dds_data map_dds_from_file(FILE *f, uint64_t &dataOffset, void **mappingHandle)
+{
+  *mappingHandle = NULL;
+
+  dds_data ret = load_dds_header_from_file(f, dataOffset);
+
+  if(ret.subsizes == NULL)
+    return ret;
+
+  uint64_t dataSize = 0;
+  for(int i = 0; i < ret.slices * ret.mips; i++)
+    dataSize += ret.subsizes[i];
+
+  FileIO::fseek64(f, 0, SEEK_END);
+  uint64_t fileSize = FileIO::ftell64(f);
+
+  // touching a mapping past the end of the file faults, so truncated files can't be mapped
+  if(dataOffset + dataSize > fileSize)
+  {
+    RDCWARN("DDS file is truncated, expected %llu bytes but have %llu", dataOffset + dataSize,
+            fileSize);
+    return ret;
+  }
+
+  byte *base = (byte *)FileIO::MapFileRange(f, dataOffset, dataSize, mappingHandle);
+
+  if(base == NULL)
+  {
+    *mappingHandle = NULL;
+    return ret;
+  }
+
+  ret.subdata = new byte *[ret.slices * ret.mips];
+
+  for(int i = 0; i < ret.slices * ret.mips; i++)
+  {
+    ret.subdata[i] = base;
+    base += ret.subsizes[i];
   }
 
   return ret;
@@ -45,4 +45,23 @@ struct dds_data
 
 extern bool is_dds_file(FILE *f);
 extern dds_data load_dds_from_file(FILE *f);
+
+// parses the header only, filling out everything but subdata (which is left NULL). The
+// subresources are packed in the file from dataOffset onwards, in the same order as subsizes.
+// On failure subsizes is NULL.
+extern dds_data load_dds_header_from_file(FILE *f, uint64_t &dataOffset);
+
+// as load_dds_header_from_file, but also maps the data and points subdata into the mapping
+// instead of reading it, so nothing is loaded until it's touched. Release with
+// FileIO::UnmapFileRange(*mappingHandle), then delete[] subdata and subsizes (but not the
+// individual subdata pointers). If the file can't be mapped, subdata is NULL and the data must
+// be read from dataOffset as usual.
+extern dds_data map_dds_from_file(FILE *f, uint64_t &dataOffset, void **mappingHandle);
+
 extern bool write_dds_to_file(FILE *f, const dds_data &data);
+
+// streaming alternative to write_dds_to_file - write the header (subdata is ignored), then each
+// subresource in turn: slices, then mips within each slice, then depth slices within each mip.
+extern bool write_dds_header_to_file(FILE *f, const dds_data &data);
+extern bool write_dds_subresource_to_file(FILE *f, const dds_data &data, int mip,
+                                          const byte *subdata);
@@ -0,0 +1,240 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+// mixes the bits of a 64-bit value so that sequential values (IDs, pointers from a pool) spread
+// across the whole table
+inline uint64_t HashMix64(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// hash function used by HashMap. Integers and pointers are handled here, other key types need a
+// specialisation next to where they're declared, and must hash equal keys to the same value.
+template <typename T>
+struct HashKey
+{
+  static uint64_t Hash(const T &t) { return HashMix64((uint64_t)t); }
+};
+
+template <typename T>
+struct HashKey<T *>
+{
+  static uint64_t Hash(T *t) { return HashMix64((uint64_t)(uintptr_t)t); }
+};
+
+// associative container with the subset of the std::map interface used for the lookup tables on
+// hot paths, stored as an open-addressed table with linear probing. Lookups touch one or two
+// contiguous entries instead of walking a tree, and inserts don't allocate a node each.
+//
+// Unlike std::map, iteration order is unspecified and any insert or erase invalidates iterators
+// and references into the map.
+template <typename K, typename V, typename Hasher = HashKey<K> >
+class HashMap
+{
+public:
+  typedef std::pair<K, V> value_type;
+
+  class iterator
+  {
+  public:
+    iterator() : m_Map(NULL), m_Idx(0) {}
+    value_type &operator*() const { return m_Map->m_Entries[m_Idx]; }
+    value_type *operator->() const { return &m_Map->m_Entries[m_Idx]; }
+    iterator &operator++()
+    {
+      m_Idx = m_Map->NextUsed(m_Idx + 1);
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator ret = *this;
+      ++(*this);
+      return ret;
+    }
+    bool operator==(const iterator &o) const { return m_Idx == o.m_Idx; }
+    bool operator!=(const iterator &o) const { return m_Idx != o.m_Idx; }
+  private:
+    friend class HashMap;
+    iterator(HashMap *map, size_t idx) : m_Map(map), m_Idx(idx) {}
+    HashMap *m_Map;
+    size_t m_Idx;
+  };
+
+  HashMap() : m_Count(0) {}
+  iterator begin() { return iterator(this, NextUsed(0)); }
+  iterator end() { return iterator(this, m_Used.size()); }
+  size_t size() const { return m_Count; }
+  bool empty() const { return m_Count == 0; }
+  iterator find(const K &key)
+  {
+    size_t idx = FindSlot(key);
+    return idx == NotFound ? end() : iterator(this, idx);
+  }
+
+  V &operator[](const K &key)
+  {
+    size_t idx = FindSlot(key);
+    if(idx != NotFound)
+      return m_Entries[idx].second;
+
+    // keep the load factor under 3/4 so probe runs stay short
+    if((m_Count + 1) * 4 > m_Used.size() * 3)
+      Grow();
+
+    idx = Home(key);
+    while(m_Used[idx])
+      idx = (idx + 1) & (m_Used.size() - 1);
+
+    m_Used[idx] = 1;
+    m_Entries[idx] = value_type(key, V());
+    m_Count++;
+
+    return m_Entries[idx].second;
+  }
+
+  size_t erase(const K &key)
+  {
+    size_t idx = FindSlot(key);
+    if(idx == NotFound)
+      return 0;
+
+    EraseSlot(idx);
+    return 1;
+  }
+
+  void erase(iterator it)
+  {
+    if(it.m_Idx < m_Used.size())
+      EraseSlot(it.m_Idx);
+  }
+
+  // empties the map but keeps the table, as maps that are cleared are usually refilled
+  void clear()
+  {
+    for(size_t i = 0; i < m_Used.size(); i++)
+    {
+      if(m_Used[i])
+        m_Entries[i] = value_type();
+      m_Used[i] = 0;
+    }
+    m_Count = 0;
+  }
+
+  void swap(HashMap &o)
+  {
+    m_Entries.swap(o.m_Entries);
+    m_Used.swap(o.m_Used);
+    std::swap(m_Count, o.m_Count);
+  }
+
+private:
+  static const size_t NotFound = ~size_t(0);
+  static const size_t MinSize = 16;
+
+  size_t Home(const K &key) const { return size_t(Hasher::Hash(key)) & (m_Used.size() - 1); }
+  size_t NextUsed(size_t idx) const
+  {
+    while(idx < m_Used.size() && !m_Used[idx])
+      idx++;
+    return idx;
+  }
+
+  size_t FindSlot(const K &key) const
+  {
+    if(m_Count == 0)
+      return NotFound;
+
+    for(size_t idx = Home(key); m_Used[idx]; idx = (idx + 1) & (m_Used.size() - 1))
+    {
+      if(m_Entries[idx].first == key)
+        return idx;
+    }
+
+    return NotFound;
+  }
+
+  // backward-shift deletion: pull later entries in the probe run into the hole so that lookups
+  // never need tombstones
+  void EraseSlot(size_t hole)
+  {
+    const size_t mask = m_Used.size() - 1;
+
+    for(size_t idx = (hole + 1) & mask; m_Used[idx]; idx = (idx + 1) & mask)
+    {
+      // distance from each entry's home slot. An entry can fill the hole if the hole is no
+      // further from its home than where it currently sits
+      size_t home = Home(m_Entries[idx].first);
+      if(((idx - home) & mask) >= ((idx - hole) & mask))
+      {
+        m_Entries[hole] = m_Entries[idx];
+        hole = idx;
+      }
+    }
+
+    m_Used[hole] = 0;
+    m_Entries[hole] = value_type();
+    m_Count--;
+  }
+
+  void Grow()
+  {
+    std::vector<value_type> entries;
+    std::vector<uint8_t> used;
+
+    entries.swap(m_Entries);
+    used.swap(m_Used);
+
+    size_t newSize = used.empty() ? MinSize : used.size() * 2;
+    m_Entries.resize(newSize);
+    m_Used.resize(newSize, 0);
+
+    for(size_t i = 0; i < used.size(); i++)
+    {
+      if(!used[i])
+        continue;
+
+      size_t idx = Home(entries[i].first);
+      while(m_Used[idx])
+        idx = (idx + 1) & (newSize - 1);
+
+      m_Used[idx] = 1;
+      m_Entries[idx] = entries[i];
+    }
+  }
+
+  std::vector<value_type> m_Entries;
+  std::vector<uint8_t> m_Used;
+  size_t m_Count;
+};
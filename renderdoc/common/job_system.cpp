@@ -0,0 +1,360 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "job_system.h"
+#include <deque>
+#include "common/threading.h"
+
+namespace Threading
+{
+struct Job
+{
+  JobFunction func;
+  void *userData;
+  JobGroup *group;
+};
+
+struct JobQueue
+{
+  CriticalSection lock;
+  std::deque<Job> jobs;
+};
+
+struct JobSystemData
+{
+  JobSystemData() : numWorkers(0), started(false), shutdown(false), pending(0), running(0) {}
+  uint32_t numWorkers;
+
+  CriticalSection startLock;
+  volatile bool started;
+  bool shutdown;
+  vector<ThreadHandle> threads;
+
+  // one queue per worker, and a final shared queue for jobs submitted from outside the pool
+  vector<JobQueue *> queues;
+
+  // jobs sitting in any queue, tested under sleepLock before a worker sleeps so that a job
+  // submitted at the same time can't be missed
+  volatile int32_t pending;
+  volatile int32_t running;
+
+  CriticalSection sleepLock;
+  ConditionVariable workAvailable;
+  ConditionVariable jobFinished;
+
+  // holds the 1-based worker index on worker threads
+  uint64_t workerSlot;
+};
+
+static JobSystemData *jobSystem = NULL;
+
+static uint32_t CurrentWorker()
+{
+  return (uint32_t)(uintptr_t)GetTLSValue(jobSystem->workerSlot);
+}
+
+static bool PopFront(JobQueue *queue, Job &job)
+{
+  SCOPED_LOCK(queue->lock);
+
+  if(queue->jobs.empty())
+    return false;
+
+  job = queue->jobs.front();
+  queue->jobs.pop_front();
+  return true;
+}
+
+static bool PopJob(uint32_t worker, Job &job)
+{
+  JobSystemData &js = *jobSystem;
+
+  if(js.pending <= 0)
+    return false;
+
+  bool found = false;
+
+  // our own most recent job first, as its data is most likely to still be in cache
+  if(worker > 0)
+  {
+    JobQueue *queue = js.queues[worker - 1];
+    SCOPED_LOCK(queue->lock);
+
+    if(!queue->jobs.empty())
+    {
+      job = queue->jobs.back();
+      queue->jobs.pop_back();
+      found = true;
+    }
+  }
+
+  if(!found)
+    found = PopFront(js.queues.back(), job);
+
+  for(uint32_t i = 0; !found && i < js.numWorkers; i++)
+  {
+    // start stealing from our neighbour so that workers don't all hit the same queue
+    uint32_t victim = (worker + i) % js.numWorkers;
+    if(victim + 1 != worker)
+      found = PopFront(js.queues[victim], job);
+  }
+
+  if(found)
+    Atomic::Dec32(&js.pending);
+
+  return found;
+}
+
+void RunJob(Job &job)
+{
+  job.func(job.userData);
+
+  // once the count hits 0 the group can be destroyed at any time, so it's not touched again
+  if(Atomic::Dec32(&job.group->m_Outstanding) == 0 && jobSystem)
+  {
+    SCOPED_LOCK(jobSystem->sleepLock);
+    jobSystem->jobFinished.Broadcast();
+  }
+}
+
+static void WorkerThread(void *param)
+{
+  JobSystemData &js = *jobSystem;
+
+  uint32_t worker = (uint32_t)(uintptr_t)param;
+  SetTLSValue(js.workerSlot, (void *)(uintptr_t)worker);
+
+  for(;;)
+  {
+    Job job;
+    if(PopJob(worker, job))
+    {
+      RunJob(job);
+      continue;
+    }
+
+    SCOPED_LOCK(js.sleepLock);
+
+    // a job may have been queued between the pop failing and taking the lock
+    if(js.pending > 0)
+      continue;
+
+    if(js.shutdown)
+      break;
+
+    js.workAvailable.Wait(js.sleepLock);
+  }
+
+  Atomic::Dec32(&js.running);
+}
+
+static void StartWorkers()
+{
+  JobSystemData &js = *jobSystem;
+
+  SCOPED_LOCK(js.startLock);
+
+  if(js.started)
+    return;
+
+  js.running = (int32_t)js.numWorkers;
+
+  for(uint32_t i = 0; i < js.numWorkers; i++)
+    js.threads.push_back(CreateThread(&WorkerThread, (void *)(uintptr_t)(i + 1)));
+
+  RDCLOG("Started %u job system workers", js.numWorkers);
+
+  js.started = true;
+}
+
+void JobGroup::Submit(JobFunction func, void *userData)
+{
+  Atomic::Inc32(&m_Outstanding);
+
+  Job job = {func, userData, this};
+
+  if(GetJobWorkerCount() == 0)
+  {
+    RunJob(job);
+    return;
+  }
+
+  JobSystemData &js = *jobSystem;
+
+  if(!js.started)
+    StartWorkers();
+
+  uint32_t worker = CurrentWorker();
+
+  // counted before it's visible, so a worker can't take it and leave pending negative
+  Atomic::Inc32(&js.pending);
+
+  {
+    JobQueue *queue = worker > 0 ? js.queues[worker - 1] : js.queues.back();
+    SCOPED_LOCK(queue->lock);
+    queue->jobs.push_back(job);
+  }
+
+  SCOPED_LOCK(js.sleepLock);
+  js.workAvailable.Signal();
+}
+
+void JobGroup::Wait()
+{
+  while(m_Outstanding > 0)
+  {
+    if(RunPendingJob())
+      continue;
+
+    JobSystemData &js = *jobSystem;
+    SCOPED_LOCK(js.sleepLock);
+
+    // the timeout only matters if every worker is waiting inside a job and more work gets
+    // queued, otherwise the last job in the group will wake us.
+    if(m_Outstanding > 0)
+      js.jobFinished.Wait(js.sleepLock, 1);
+  }
+}
+
+bool RunPendingJob()
+{
+  if(jobSystem == NULL || jobSystem->numWorkers == 0)
+    return false;
+
+  Job job;
+  if(!PopJob(CurrentWorker(), job))
+    return false;
+
+  RunJob(job);
+  return true;
+}
+
+struct ParallelForRange
+{
+  ParallelForFunction func;
+  void *userData;
+  uint32_t begin;
+  uint32_t end;
+};
+
+static void RunParallelForRange(void *param)
+{
+  ParallelForRange &range = *(ParallelForRange *)param;
+  range.func(range.userData, range.begin, range.end);
+}
+
+void ParallelFor(ParallelForFunction func, void *userData, uint32_t count, uint32_t grainSize)
+{
+  if(count == 0)
+    return;
+
+  grainSize = RDCMAX(grainSize, 1U);
+
+  // a few ranges per thread so that uneven ranges balance out, but no smaller than grainSize
+  uint32_t numRanges = RDCMIN((count + grainSize - 1) / grainSize, (GetJobWorkerCount() + 1) * 4);
+
+  if(numRanges <= 1)
+  {
+    func(userData, 0, count);
+    return;
+  }
+
+  vector<ParallelForRange> ranges(numRanges);
+
+  for(uint32_t i = 0; i < numRanges; i++)
+  {
+    ranges[i].func = func;
+    ranges[i].userData = userData;
+    ranges[i].begin = uint32_t(uint64_t(count) * i / numRanges);
+    ranges[i].end = uint32_t(uint64_t(count) * (i + 1) / numRanges);
+  }
+
+  JobGroup group;
+
+  for(uint32_t i = 1; i < numRanges; i++)
+    group.Submit(&RunParallelForRange, &ranges[i]);
+
+  RunParallelForRange(&ranges[0]);
+
+  group.Wait();
+}
+
+uint32_t GetJobWorkerCount()
+{
+  return jobSystem ? jobSystem->numWorkers : 0;
+}
+
+void InitJobSystem()
+{
+  if(jobSystem)
+    return;
+
+  jobSystem = new JobSystemData();
+
+  // the thread submitting jobs takes a share of the work while it waits
+  jobSystem->numWorkers = GetNumberOfCores() - 1;
+  jobSystem->workerSlot = AllocateTLSSlot();
+
+  for(uint32_t i = 0; i <= jobSystem->numWorkers; i++)
+    jobSystem->queues.push_back(new JobQueue());
+}
+
+void ShutdownJobSystem()
+{
+  if(jobSystem == NULL)
+    return;
+
+  JobSystemData &js = *jobSystem;
+
+  if(js.started)
+  {
+    {
+      SCOPED_LOCK(js.sleepLock);
+      js.shutdown = true;
+      js.workAvailable.Broadcast();
+    }
+
+    // as with other threads torn down in RenderDoc's destructor we can't join, since on windows
+    // that may happen while the loader lock is held. The workers finish off any queued jobs and
+    // flag that they've left the loop instead. On process exit they may already have been
+    // killed, so don't wait forever and leak everything if they never check in.
+    for(uint32_t i = 0; js.running > 0 && i < 100; i++)
+      Sleep(1);
+
+    if(js.running > 0)
+    {
+      jobSystem = NULL;
+      return;
+    }
+
+    for(size_t i = 0; i < js.threads.size(); i++)
+      CloseThread(js.threads[i]);
+  }
+
+  for(size_t i = 0; i < js.queues.size(); i++)
+    delete js.queues[i];
+
+  SAFE_DELETE(jobSystem);
+}
+};
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include "common/common.h"
+#include "os/os_specific.h"
+
+// A shared pool of worker threads for short CPU-bound jobs, so that everything wanting to go wide
+// shares one thread per core instead of each creating its own. Each worker has its own queue that
+// jobs submitted from inside a job go onto and are run from most-recent first, idle workers steal
+// from the oldest end of other workers' queues. Jobs submitted from any other thread go onto a
+// shared queue that is run in submission order. The workers are only created on first use, and if
+// there's a single core jobs just run immediately on the submitting thread.
+//
+// Jobs must not block waiting on anything other than a JobGroup, and anything long-running (e.g. a
+// thread that lives as long as a file is open) should keep its own thread instead.
+
+namespace Threading
+{
+typedef void (*JobFunction)(void *userData);
+typedef void (*ParallelForFunction)(void *userData, uint32_t begin, uint32_t end);
+
+struct Job;
+
+// a set of jobs that can be waited on together. The group must outlive its jobs, the destructor
+// waits for any that are still outstanding.
+class JobGroup
+{
+public:
+  JobGroup() : m_Outstanding(0) {}
+  ~JobGroup() { Wait(); }
+  void Submit(JobFunction func, void *userData);
+
+  // runs pending jobs on this thread while waiting, so waiting from inside a job is fine
+  void Wait();
+
+  int32_t Outstanding() const { return m_Outstanding; }
+  bool IsFinished() const { return m_Outstanding == 0; }
+private:
+  friend void RunJob(Job &job);
+
+  // no copying
+  JobGroup &operator=(const JobGroup &other);
+  JobGroup(const JobGroup &other);
+
+  volatile int32_t m_Outstanding;
+};
+
+// the result of a function run as a job. Get() waits for it, like JobGroup::Wait().
+template <typename T>
+class Future
+{
+public:
+  typedef T (*Function)(void *userData);
+
+  Future() : m_Func(NULL), m_UserData(NULL), m_Result() {}
+  void Start(Function func, void *userData)
+  {
+    m_Func = func;
+    m_UserData = userData;
+    m_Group.Submit(&Future::Run, this);
+  }
+
+  bool IsReady() const { return m_Group.IsFinished(); }
+  T &Get()
+  {
+    m_Group.Wait();
+    return m_Result;
+  }
+
+private:
+  static void Run(void *param)
+  {
+    Future *future = (Future *)param;
+    future->m_Result = future->m_Func(future->m_UserData);
+  }
+
+  // no copying
+  Future &operator=(const Future &other);
+  Future(const Future &other);
+
+  Function m_Func;
+  void *m_UserData;
+  T m_Result;
+  JobGroup m_Group;
+};
+
+// calls func over [0, count) split into ranges of at least grainSize, with the calling thread
+// taking a share, and returns once every range is done.
+void ParallelFor(ParallelForFunction func, void *userData, uint32_t count, uint32_t grainSize);
+
+// runs one queued job on the calling thread, returning false if there weren't any
+bool RunPendingJob();
+
+// how many workers the pool has, or will have once started. 0 means jobs run immediately.
+uint32_t GetJobWorkerCount();
+
+void InitJobSystem();
+void ShutdownJobSystem();
+};
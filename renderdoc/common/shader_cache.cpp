@@ -0,0 +1,175 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "shader_cache.h"
+#include <string.h>
+
+ShaderCacheFile::ShaderCacheFile()
+{
+  m_Magic = m_Version = 0;
+  m_Data = NULL;
+  m_Mapping = NULL;
+  m_AppendHandle = NULL;
+}
+
+ShaderCacheFile::~ShaderCacheFile()
+{
+  Close();
+}
+
+bool ShaderCacheFile::Open(const char *filename, uint32_t magicNumber, uint32_t versionNumber)
+{
+  Close();
+
+  m_Filename = FileIO::GetAppFolderFilename(filename);
+  m_Magic = magicNumber;
+  m_Version = versionNumber;
+
+  FILE *f = FileIO::fopen(m_Filename.c_str(), "rb");
+
+  if(!f)
+    return false;
+
+  FileIO::fseek64(f, 0, SEEK_END);
+  uint64_t cachelen = FileIO::ftell64(f);
+  FileIO::fseek64(f, 0, SEEK_SET);
+
+  if(cachelen > 0)
+  {
+    m_Data = (const byte *)FileIO::MapFileRange(f, 0, cachelen, &m_Mapping);
+
+    if(m_Data == NULL)
+    {
+      m_Mapping = NULL;
+      m_ReadData.resize((size_t)cachelen);
+      FileIO::fread(&m_ReadData[0], 1, m_ReadData.size(), f);
+      m_Data = &m_ReadData[0];
+    }
+  }
+
+  FileIO::fclose(f);
+
+  bool valid = true;
+  uint32_t stale = 0;
+
+  uint64_t offs = 0;
+  while(offs < cachelen)
+  {
+    EntryHeader header;
+
+    if(cachelen - offs < sizeof(header))
+    {
+      valid = false;
+      break;
+    }
+
+    memcpy(&header, m_Data + offs, sizeof(header));
+    offs += sizeof(header);
+
+    if(header.magic != m_Magic || cachelen - offs < header.length)
+    {
+      valid = false;
+      break;
+    }
+
+    // entries written by another version can be left behind by older builds sharing the file
+    if(header.version != m_Version)
+      stale++;
+    else if(!Contains(header.hash))
+      m_Index[header.hash] = std::make_pair(offs, header.length);
+
+    offs += header.length;
+  }
+
+  if(!valid)
+    RDCERR("Invalid shader cache - truncated or not in the expected format");
+  else if(stale > 0)
+    RDCDEBUG("Skipped %u out of date entries in shader cache", stale);
+
+  // anything appended after invalid data would never be read, and a file with nothing valid left
+  // would only keep growing, so start again from an empty file. Losing entries another process
+  // is appending at the same time is harmless, they'll just be compiled again.
+  if(!valid || m_Index.empty())
+  {
+    Close();
+    FileIO::Delete(m_Filename.c_str());
+    return false;
+  }
+
+  RDCDEBUG("Successfully indexed %u shaders in shader cache", (uint32_t)m_Index.size());
+
+  return true;
+}
+
+void ShaderCacheFile::Close()
+{
+  if(m_Mapping)
+    FileIO::UnmapFileRange(m_Mapping);
+
+  if(m_AppendHandle)
+    FileIO::logfile_close(m_AppendHandle);
+
+  m_Data = NULL;
+  m_Mapping = NULL;
+  m_AppendHandle = NULL;
+  m_ReadData.clear();
+  m_Index.clear();
+}
+
+const byte *ShaderCacheFile::Find(uint32_t hash, uint32_t &length) const
+{
+  auto it = m_Index.find(hash);
+
+  if(it == m_Index.end())
+    return NULL;
+
+  length = it->second.second;
+  return m_Data + it->second.first;
+}
+
+void ShaderCacheFile::Append(uint32_t hash, const byte *data, uint32_t length)
+{
+  if(m_Filename.empty())
+    return;
+
+  if(m_AppendHandle == NULL)
+    m_AppendHandle = FileIO::logfile_open(m_Filename.c_str());
+
+  if(m_AppendHandle == NULL)
+  {
+    RDCERR("Error opening shader cache for write");
+    return;
+  }
+
+  // the header and data go out in one write, so that entries from different processes are never
+  // interleaved
+  std::vector<byte> entry(sizeof(EntryHeader) + length);
+
+  EntryHeader header = {m_Magic, m_Version, hash, length};
+  memcpy(&entry[0], &header, sizeof(header));
+  if(length > 0)
+    memcpy(&entry[sizeof(header)], data, length);
+
+  FileIO::logfile_append(m_AppendHandle, (const char *)&entry[0], entry.size());
+}
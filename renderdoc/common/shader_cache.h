@@ -24,151 +24,98 @@
 
 #pragma once
 
+#include <map>
 #include "os/os_specific.h"
 
-template <typename ResultType, typename ShaderCallbacks>
-bool LoadShaderCache(const char *filename, const uint32_t magicNumber, const uint32_t versionNumber,
-                     std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
+// A cache of compiled shaders (or similar blobs) keyed by a 32-bit hash, kept in a file under the
+// app folder that is only ever appended to. Each entry is written with a single atomic append, so
+// several processes (e.g. replay workers on one machine) can use the same file at once without
+// overwriting each other's entries.
+//
+// Opening the cache maps the file and only walks the entry headers to build an index, the data
+// for an entry is only touched when it's looked up. Entries appended by other processes after the
+// file was opened are picked up the next time it's opened.
+class ShaderCacheFile
 {
-  string shadercache = FileIO::GetAppFolderFilename(filename);
-
-  FILE *f = FileIO::fopen(shadercache.c_str(), "rb");
+public:
+  ShaderCacheFile();
+  ~ShaderCacheFile();
 
-  if(!f)
-    return false;
+  // returns false if there was no valid cache with entries of this magic number and version
+  bool Open(const char *filename, uint32_t magicNumber, uint32_t versionNumber);
+  void Close();
 
-  FileIO::fseek64(f, 0, SEEK_END);
-  uint64_t cachelen = FileIO::ftell64(f);
-  FileIO::fseek64(f, 0, SEEK_SET);
+  bool Contains(uint32_t hash) const { return m_Index.find(hash) != m_Index.end(); }
+  // returns NULL if the hash isn't in the cache
+  const byte *Find(uint32_t hash, uint32_t &length) const;
 
-  bool ret = true;
+  void Append(uint32_t hash, const byte *data, uint32_t length);
 
-  // header: magic number, file version, number of entries
-  if(cachelen < sizeof(uint32_t) * 3)
+  size_t NumEntries() const { return m_Index.size(); }
+private:
+  struct EntryHeader
   {
-    RDCERR("Invalid shader cache");
-    ret = false;
-  }
-  else
-  {
-    byte *cache = new byte[(size_t)cachelen];
-    FileIO::fread(cache, 1, (size_t)cachelen, f);
+    uint32_t magic;
+    uint32_t version;
+    uint32_t hash;
+    uint32_t length;
+  };
 
-    uint32_t *header = (uint32_t *)cache;
+  std::string m_Filename;
+  uint32_t m_Magic, m_Version;
 
-    uint32_t fileMagic = header[0];
-    uint32_t fileVer = header[1];
+  // the file contents, either mapped or read into m_ReadData if it couldn't be mapped
+  const byte *m_Data;
+  void *m_Mapping;
+  std::vector<byte> m_ReadData;
 
-    if(fileMagic != magicNumber || fileVer != versionNumber)
-    {
-      RDCDEBUG("Out of date or invalid shader cache magic: %d version: %d", fileMagic, fileVer);
-      ret = false;
-    }
-    else
-    {
-      uint32_t numentries = header[2];
-
-      byte *ptr = cache + sizeof(uint32_t) * 3;
-
-      int64_t bufsize = (int64_t)cachelen - sizeof(uint32_t) * 3;
-
-      for(uint32_t i = 0; i < numentries; i++)
-      {
-        if((size_t)bufsize < sizeof(uint32_t))
-        {
-          RDCERR("Invalid shader cache - truncated, not enough data for shader hash");
-          ret = false;
-          break;
-        }
-
-        uint32_t hash = *(uint32_t *)ptr;
-        ptr += sizeof(uint32_t);
-        bufsize -= sizeof(uint32_t);
-
-        if((size_t)bufsize < sizeof(uint32_t))
-        {
-          RDCERR("Invalid shader cache - truncated, not enough data for shader length");
-          ret = false;
-          break;
-        }
-
-        uint32_t len = *(uint32_t *)ptr;
-        ptr += sizeof(uint32_t);
-        bufsize -= sizeof(uint32_t);
-
-        if(bufsize < len)
-        {
-          RDCERR("Invalid shader cache - truncated, not enough data for shader buffer");
-          ret = false;
-          break;
-        }
-
-        byte *data = ptr;
-        ptr += len;
-        bufsize -= len;
-
-        ResultType result;
-        bool created = callbacks.Create(len, data, &result);
-
-        if(!created)
-        {
-          RDCERR("Couldn't create blob of size %u from shadercache", len);
-          ret = false;
-          break;
-        }
-
-        resultCache[hash] = result;
-      }
-
-      if(ret == true && bufsize != 0)
-      {
-        RDCERR("Invalid shader cache - trailing data");
-        ret = false;
-      }
-
-      RDCDEBUG("Successfully loaded %d shaders from shader cache", resultCache.size());
-    }
-
-    delete[] cache;
-  }
+  // offset of each entry's data and its length
+  std::map<uint32_t, std::pair<uint64_t, uint32_t> > m_Index;
 
-  FileIO::fclose(f);
-
-  return ret;
-}
+  void *m_AppendHandle;
+};
 
+// looks up a hash in the cache file, creating the result and adding it to resultCache if found
 template <typename ResultType, typename ShaderCallbacks>
-void SaveShaderCache(const char *filename, uint32_t magicNumber, uint32_t versionNumber,
-                     const std::map<uint32_t, ResultType> &cache, const ShaderCallbacks &callbacks)
+bool FetchShaderCache(const ShaderCacheFile &file, uint32_t hash,
+                      std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
 {
-  string shadercache = FileIO::GetAppFolderFilename(filename);
+  uint32_t len = 0;
+  const byte *data = file.Find(hash, len);
 
-  FILE *f = FileIO::fopen(shadercache.c_str(), "wb");
+  if(data == NULL)
+    return false;
 
-  if(!f)
+  ResultType result;
+  if(!callbacks.Create(len, (byte *)data, &result))
   {
-    RDCERR("Error opening shader cache for write");
-    return;
+    RDCERR("Couldn't create blob of size %u from shadercache", len);
+    return false;
   }
 
-  FileIO::fwrite(&magicNumber, 1, sizeof(magicNumber), f);
-  FileIO::fwrite(&versionNumber, 1, sizeof(versionNumber), f);
-  uint32_t numentries = (uint32_t)cache.size();
-  FileIO::fwrite(&numentries, 1, sizeof(numentries), f);
+  resultCache[hash] = result;
+  return true;
+}
+
+// appends every entry in the cache that the file doesn't have yet, then destroys them all
+template <typename ResultType, typename ShaderCallbacks>
+void SaveShaderCache(ShaderCacheFile &file, const std::map<uint32_t, ResultType> &cache,
+                     const ShaderCallbacks &callbacks)
+{
+  uint32_t numentries = 0;
 
   for(auto it = cache.begin(); it != cache.end(); ++it)
   {
-    uint32_t hash = it->first;
-    uint32_t len = callbacks.GetSize(it->second);
-    byte *data = callbacks.GetData(it->second);
-    FileIO::fwrite(&hash, 1, sizeof(hash), f);
-    FileIO::fwrite(&len, 1, sizeof(len), f);
-    FileIO::fwrite(data, 1, len, f);
+    if(!file.Contains(it->first))
+    {
+      file.Append(it->first, callbacks.GetData(it->second), callbacks.GetSize(it->second));
+      numentries++;
+    }
 
     callbacks.Destroy(it->second);
   }
 
-  FileIO::fclose(f);
+  file.Close();
 
-  RDCDEBUG("Successfully wrote %u shaders to shader cache", numentries);
+  RDCDEBUG("Successfully appended %u shaders to shader cache", numentries);
 }
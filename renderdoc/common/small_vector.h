@@ -0,0 +1,107 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+// array that keeps up to N elements inline in the object and only goes to the heap when it grows
+// past that, for lists that are nearly always tiny but exist once per object.
+//
+// Only for trivially copyable types like pointers and IDs - elements are moved around with memcpy
+// and never constructed or destructed.
+template <typename T, size_t N>
+class SmallVector
+{
+public:
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  SmallVector() : m_Data(m_Inline), m_Count(0), m_Capacity(N) {}
+  SmallVector(const SmallVector &o) : m_Data(m_Inline), m_Count(0), m_Capacity(N) { *this = o; }
+  ~SmallVector()
+  {
+    if(m_Data != m_Inline)
+      delete[] m_Data;
+  }
+
+  SmallVector &operator=(const SmallVector &o)
+  {
+    if(this != &o)
+    {
+      m_Count = 0;
+      Reserve(o.m_Count);
+      memcpy(m_Data, o.m_Data, o.m_Count * sizeof(T));
+      m_Count = o.m_Count;
+    }
+    return *this;
+  }
+
+  iterator begin() { return m_Data; }
+  iterator end() { return m_Data + m_Count; }
+  const_iterator begin() const { return m_Data; }
+  const_iterator end() const { return m_Data + m_Count; }
+  size_t size() const { return m_Count; }
+  bool empty() const { return m_Count == 0; }
+  T &operator[](size_t i) { return m_Data[i]; }
+  const T &operator[](size_t i) const { return m_Data[i]; }
+  bool contains(const T &t) const
+  {
+    for(size_t i = 0; i < m_Count; i++)
+      if(m_Data[i] == t)
+        return true;
+    return false;
+  }
+
+  void push_back(const T &t)
+  {
+    if(m_Count == m_Capacity)
+      Reserve(m_Capacity * 2);
+    m_Data[m_Count++] = t;
+  }
+
+  // keeps any heap storage, a list that was cleared is usually refilled
+  void clear() { m_Count = 0; }
+private:
+  void Reserve(size_t capacity)
+  {
+    if(capacity <= m_Capacity)
+      return;
+
+    T *data = new T[capacity];
+    memcpy(data, m_Data, m_Count * sizeof(T));
+
+    if(m_Data != m_Inline)
+      delete[] m_Data;
+
+    m_Data = data;
+    m_Capacity = capacity;
+  }
+
+  T m_Inline[N];
+  T *m_Data;
+  size_t m_Count;
+  size_t m_Capacity;
+};
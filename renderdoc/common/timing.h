@@ -30,6 +30,7 @@
 #include <string>
 #include "os/os_specific.h"
 #include "common.h"
+#include "tracing.h"
 
 using std::string;
 
@@ -54,12 +55,13 @@ public:
   void InitTimers()
   {
     m_HighPrecisionTimer.Restart();
-    m_TotalTime = m_AvgFrametime = m_MinFrametime = m_MaxFrametime = 0.0;
+    m_TotalTime = m_AvgFrametime = m_MinFrametime = m_MaxFrametime = m_LastFrametime = 0.0;
   }
 
   void UpdateTimers()
   {
-    m_FrameTimes.push_back(m_HighPrecisionTimer.GetMilliseconds());
+    m_LastFrametime = m_HighPrecisionTimer.GetMilliseconds();
+    m_FrameTimes.push_back(m_LastFrametime);
     m_TotalTime += m_FrameTimes.back();
     m_HighPrecisionTimer.Restart();
 
@@ -90,6 +92,7 @@ public:
   double GetAvgFrameTime() const { return m_AvgFrametime; }
   double GetMinFrameTime() const { return m_MinFrametime; }
   double GetMaxFrameTime() const { return m_MaxFrametime; }
+  double GetLastFrameTime() const { return m_LastFrametime; }
 private:
   PerformanceTimer m_HighPrecisionTimer;
   vector<double> m_FrameTimes;
@@ -97,6 +100,7 @@ private:
   double m_AvgFrametime;
   double m_MinFrametime;
   double m_MaxFrametime;
+  double m_LastFrametime;
 };
 
 class ScopedTimer
@@ -117,10 +121,15 @@ public:
     m_Message = buf;
 
     va_end(args);
+
+    m_Start = Timing::GetTick();
   }
 
+  // the time is logged, and recorded as a trace event too
   ~ScopedTimer()
   {
+    Tracing::AddEvent(m_Message.c_str(), m_Start, Timing::GetTick());
+
     rdclog_int(RDCLog_Comment, RDCLOG_PROJECT, m_File, m_Line, "Timer %s - %.3lf ms",
                m_Message.c_str(), m_Timer.GetMilliseconds());
   }
@@ -130,6 +139,7 @@ private:
   unsigned int m_Line;
   string m_Message;
   PerformanceTimer m_Timer;
+  uint64_t m_Start;
 };
 
 #define SCOPED_TIMER(...) ScopedTimer CONCAT(timer, __LINE__)(__FILE__, __LINE__, __VA_ARGS__);
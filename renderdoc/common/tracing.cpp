@@ -0,0 +1,130 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "tracing.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace Tracing
+{
+struct Event
+{
+  uint64_t start;
+  uint64_t end;
+  uint64_t threadID;
+  char name[48];
+};
+
+// must be a power of two
+static const int64_t MaxEvents = 16384;
+
+static Event events[MaxEvents];
+static volatile int64_t numEvents = 0;
+
+void AddEvent(const char *name, uint64_t startTick, uint64_t endTick)
+{
+  int64_t idx = Atomic::Inc64(&numEvents) - 1;
+
+  Event &e = events[idx & (MaxEvents - 1)];
+
+  e.start = startTick;
+  e.end = endTick;
+  e.threadID = Threading::GetCurrentID();
+
+  size_t len = RDCMIN(strlen(name), sizeof(e.name) - 1);
+  memcpy(e.name, name, len);
+  e.name[len] = 0;
+}
+
+static bool EarlierEvent(const Event &a, const Event &b)
+{
+  return a.start < b.start;
+}
+
+static string EscapeJSON(const char *str)
+{
+  string ret;
+  for(const char *c = str; *c; c++)
+  {
+    if(*c == '"' || *c == '\\')
+      ret.push_back('\\');
+    if(*c >= ' ')
+      ret.push_back(*c);
+  }
+  return ret;
+}
+
+bool Export(const char *filename)
+{
+  // events still being written while we copy might be torn, which at worst gives one odd span
+  int64_t total = numEvents;
+  int64_t count = RDCMIN(total, MaxEvents);
+
+  std::vector<Event> copy;
+  copy.reserve((size_t)count);
+
+  for(int64_t i = total - count; i < total; i++)
+    copy.push_back(events[i & (MaxEvents - 1)]);
+
+  std::sort(copy.begin(), copy.end(), EarlierEvent);
+
+  FILE *f = FileIO::fopen(filename, "wb");
+
+  if(f == NULL)
+  {
+    RDCERR("Couldn't open %s to write the trace", filename);
+    return false;
+  }
+
+  const double ticksPerUS = Timing::GetTickFrequency() / 1000.0;
+  const uint64_t base = copy.empty() ? 0 : copy[0].start;
+  const uint32_t pid = Process::GetCurrentPID();
+
+  string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+  for(size_t i = 0; i < copy.size(); i++)
+  {
+    const Event &e = copy[i];
+
+    json += StringFormat::Fmt(
+        "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%llu}",
+        i > 0 ? ",\n" : "", EscapeJSON(e.name).c_str(), double(e.start - base) / ticksPerUS,
+        double(e.end - e.start) / ticksPerUS, pid, e.threadID);
+  }
+
+  json += "\n]}\n";
+
+  bool ret = FileIO::fwrite(json.c_str(), 1, json.size(), f) == json.size();
+
+  FileIO::fclose(f);
+
+  if(ret)
+    RDCLOG("Wrote %llu trace events to %s", (uint64_t)copy.size(), filename);
+  else
+    RDCERR("Couldn't write the trace to %s", filename);
+
+  return ret;
+}
+};
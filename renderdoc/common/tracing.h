@@ -0,0 +1,57 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include "common/common.h"
+#include "os/os_specific.h"
+
+// Records spans of time on each thread into a fixed-size ring buffer, so that the most recent
+// activity can be written out as a Chrome trace and loaded into chrome://tracing or Perfetto.
+// Spans are recorded when they end, nested spans on a thread show up nested in the trace. Once
+// the buffer is full the oldest spans are overwritten. Recording takes no locks, only a ring
+// index increment, so it's cheap enough for coarse phases but not per API call.
+
+namespace Tracing
+{
+// name is copied, truncated if necessary
+void AddEvent(const char *name, uint64_t startTick, uint64_t endTick);
+
+// write the recorded events to filename in Chrome's trace event JSON format
+bool Export(const char *filename);
+};
+
+class ScopedTrace
+{
+public:
+  ScopedTrace(const char *name) : m_Name(name), m_Start(Timing::GetTick()) {}
+  ~ScopedTrace() { Tracing::AddEvent(m_Name, m_Start, Timing::GetTick()); }
+private:
+  const char *m_Name;
+  uint64_t m_Start;
+};
+
+// name must stay valid until the end of the scope
+#define SCOPED_TRACE(name) ScopedTrace CONCAT(trace, __LINE__)(name);
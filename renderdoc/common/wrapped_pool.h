@@ -48,28 +48,324 @@ public:
   typedef C Type;
 };
 
-// allocate each class in its own pool so we can identify the type by the pointer
-template <typename WrapType, int PoolCount = 8192, int MaxPoolByteSize = 1024 * 1024, bool DebugClear = true>
+// counters for how much churn a pool sees, summed over every thread's cache
+struct WrappingPoolStats
+{
+  // total allocations and frees since the pool was created
+  uint64_t allocs;
+  uint64_t frees;
+  // how many times a thread cache had to go back to the shared pool, taking its lock
+  uint64_t refills;
+  uint64_t drains;
+  // number of additional pools allocated once the immediate pool filled up
+  uint32_t additionalPools;
+};
+
+// a thread's cache of free slots for one pool, see WrappingPool::ThreadCache
+struct WrappingPoolThreadCache
+{
+  virtual ~WrappingPoolThreadCache() {}
+  // hands any cached slots back to the pool and deletes the cache
+  virtual void Release() = 0;
+};
+
+// every pool shares one TLS slot, pointing to the thread's caches indexed by pool. When the
+// thread exits each cache is released back to its pool.
+struct WrappingPoolThreadCaches
+{
+  std::vector<WrappingPoolThreadCache *> caches;
+
+  static void ThreadExit(void *value)
+  {
+    WrappingPoolThreadCaches *threadCaches = (WrappingPoolThreadCaches *)value;
+
+    for(size_t i = 0; i < threadCaches->caches.size(); i++)
+      if(threadCaches->caches[i])
+        threadCaches->caches[i]->Release();
+
+    delete threadCaches;
+  }
+
+  static WrappingPoolThreadCaches &Get()
+  {
+    // allocated on first use rather than during static initialisation, which happens before the
+    // threading system is ready
+    static const uint64_t slot = Threading::AllocateTLSSlot(&ThreadExit);
+
+    WrappingPoolThreadCaches *ret = (WrappingPoolThreadCaches *)Threading::GetTLSValue(slot);
+
+    if(ret == NULL)
+    {
+      ret = new WrappingPoolThreadCaches();
+      Threading::SetTLSValue(slot, ret);
+    }
+
+    return *ret;
+  }
+
+  // this is only a counter, so it's safe to call during static initialisation
+  static int32_t AllocatePoolIndex()
+  {
+    static volatile int32_t numPools = 0;
+    return Atomic::Inc32(&numPools) - 1;
+  }
+};
+
+// allocate each class in its own pool so we can identify the type by the pointer.
+//
+// If ReserveCount is set, address space for that many items is reserved up front (backed by large
+// pages where possible) and pools are committed from it as they're needed. Ownership checks are
+// then a single range compare however many pools there are, and objects stay densely packed.
+// Only once the reservation is exhausted do pools come from the heap.
+template <typename WrapType, int PoolCount = 8192, int MaxPoolByteSize = 1024 * 1024,
+          bool DebugClear = true, int ReserveCount = 0>
 class WrappingPool
 {
 public:
   void *Allocate()
   {
+    ThreadCache *cache = GetThreadCache();
+
+    void *ret = NULL;
+
+    {
+      SCOPED_LOCK(cache->lock);
+
+      cache->allocs++;
+
+      if(cache->count > 0)
+        ret = cache->slots[--cache->count];
+    }
+
+    if(ret)
+    {
+#if ENABLED(RDOC_DEVEL)
+      memset(ret, 0xb0, AllocByteSize);
+#endif
+      return ret;
+    }
+
+    // the cache is empty, take a batch from the shared pool. One slot is returned and the rest go
+    // in the cache for this thread's next allocations
     SCOPED_LOCK(m_Lock);
 
-    // try and allocate from immediate pool
-    void *ret = m_ImmediatePool.Allocate();
+    m_Refills++;
+
+    ret = AllocateShared();
+
+    {
+      SCOPED_LOCK(cache->lock);
+
+      // only take what's free without growing, the cache isn't worth a new pool
+      for(int i = 0; ret != NULL && i < CacheBatchSize && cache->count < CacheSize; i++)
+      {
+        void *slot = AllocateFromPools();
+        if(slot == NULL)
+          break;
+        cache->slots[cache->count++] = slot;
+      }
+    }
+
+    return ret;
+  }
+
+  bool IsAlloc(const void *p)
+  {
+    // we can check the immediate pool and the reserved range without locking
+    if(m_ImmediatePool.IsAlloc(p) || InReservedRange(p))
+      return true;
+
+    // if we have additional pools, lock and check them.
+    // TODO: Check for additional pools in a lock-free manner,
+    // to prevent the cost of locking if there are no more pools.
+    {
+      SCOPED_LOCK(m_Lock);
+
+      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+        if(m_AdditionalPools[i]->IsAlloc(p))
+          return true;
+    }
+
+    return false;
+  }
+
+  void Deallocate(void *p)
+  {
+    // the immediate pool and reserved range can be checked without locking, so those slots go back
+    // to the thread's cache. Anything else takes the lock to find its pool, or report that it's
+    // not ours.
+    ThreadCache *cache = GetThreadCache();
+
+    if(!m_ImmediatePool.IsAlloc(p) && !InReservedRange(p))
+    {
+      SCOPED_LOCK(m_Lock);
+      DeallocateShared(p);
+
+      SCOPED_LOCK(cache->lock);
+      cache->frees++;
+      return;
+    }
+
+#if ENABLED(RDOC_DEVEL)
+    memset(p, 0xfe, DebugClear ? AllocByteSize : 0);
+#endif
+
+    void *drain[CacheBatchSize];
+    int drainCount = 0;
+
+    {
+      SCOPED_LOCK(cache->lock);
+
+      cache->frees++;
+
+      // if the cache is full, hand the oldest batch of slots back to the shared pool so one thread
+      // freeing a lot doesn't starve the others
+      if(cache->count == CacheSize)
+      {
+        drainCount = CacheBatchSize;
+        memcpy(drain, cache->slots, sizeof(drain));
+        cache->count -= CacheBatchSize;
+        memmove(cache->slots, cache->slots + CacheBatchSize, cache->count * sizeof(void *));
+      }
+
+      cache->slots[cache->count++] = p;
+    }
+
+    if(drainCount > 0)
+    {
+      SCOPED_LOCK(m_Lock);
+
+      m_Drains++;
+
+      for(int i = 0; i < drainCount; i++)
+        DeallocateShared(drain[i]);
+    }
+  }
+
+  WrappingPoolStats GetStats()
+  {
+    SCOPED_LOCK(m_Lock);
+
+    WrappingPoolStats ret = {};
+
+    ret.allocs = m_ExitedAllocs;
+    ret.frees = m_ExitedFrees;
+
+    for(size_t i = 0; i < m_ThreadCaches.size(); i++)
+    {
+      SCOPED_LOCK(m_ThreadCaches[i]->lock);
+      ret.allocs += m_ThreadCaches[i]->allocs;
+      ret.frees += m_ThreadCaches[i]->frees;
+    }
+
+    ret.refills = m_Refills;
+    ret.drains = m_Drains;
+    ret.additionalPools = (uint32_t)m_AdditionalPools.size();
+
+    return ret;
+  }
+
+  static const size_t AllocCount = PoolCount;
+  static const size_t AllocMaxByteSize = MaxPoolByteSize;
+  static const size_t AllocReserveCount = ReserveCount;
+  static const size_t AllocByteSize;
+
+private:
+  struct ItemPool;
+
+  // each thread keeps a small cache of free slots so that allocating and freeing only takes the
+  // shared lock once per batch. The caches have their own lock, which is uncontended except when
+  // the shared pool runs out and reclaims slots held by other threads. Locks are always taken in
+  // the order m_Lock then cache lock.
+  static const int CacheSize = 64;
+  static const int CacheBatchSize = 32;
+
+  struct ThreadCache : public WrappingPoolThreadCache
+  {
+    ThreadCache(WrappingPool *p) : pool(p), count(0), allocs(0), frees(0) {}
+    void Release()
+    {
+      // the pool is NULL if it was destroyed first, during process shutdown
+      if(pool)
+        pool->ReleaseThreadCache(this);
+      delete this;
+    }
+
+    WrappingPool *pool;
+    Threading::CriticalSection lock;
+    void *slots[CacheSize];
+    int count;
+    uint64_t allocs;
+    uint64_t frees;
+  };
+
+  ThreadCache *GetThreadCache()
+  {
+    std::vector<WrappingPoolThreadCache *> &caches = WrappingPoolThreadCaches::Get().caches;
+
+    if((size_t)m_PoolIndex < caches.size() && caches[m_PoolIndex])
+      return (ThreadCache *)caches[m_PoolIndex];
+
+    if((size_t)m_PoolIndex >= caches.size())
+      caches.resize(m_PoolIndex + 1);
+
+    ThreadCache *cache = new ThreadCache(this);
+    caches[m_PoolIndex] = cache;
+
+    SCOPED_LOCK(m_Lock);
+    m_ThreadCaches.push_back(cache);
+
+    return cache;
+  }
+
+  // called when a thread exits. Its cached slots go back to the pool and its counts are kept
+  void ReleaseThreadCache(ThreadCache *cache)
+  {
+    SCOPED_LOCK(m_Lock);
+
+    {
+      SCOPED_LOCK(cache->lock);
+
+      for(int s = 0; s < cache->count; s++)
+        DeallocateShared(cache->slots[s]);
+      cache->count = 0;
+
+      m_ExitedAllocs += cache->allocs;
+      m_ExitedFrees += cache->frees;
+    }
+
+    for(size_t i = 0; i < m_ThreadCaches.size(); i++)
+    {
+      if(m_ThreadCaches[i] == cache)
+      {
+        m_ThreadCaches.erase(m_ThreadCaches.begin() + i);
+        break;
+      }
+    }
+  }
+
+  // must be called with m_Lock held
+  void *AllocateShared()
+  {
+    void *ret = AllocateFromPools();
     if(ret != NULL)
       return ret;
 
-    // fall back to additional pools, if there are any
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+    // slots might be sitting unused in thread caches, take them all back before growing
+    for(size_t i = 0; i < m_ThreadCaches.size(); i++)
     {
-      ret = m_AdditionalPools[i]->Allocate();
-      if(ret != NULL)
-        return ret;
+      ThreadCache *cache = m_ThreadCaches[i];
+
+      SCOPED_LOCK(cache->lock);
+      for(int s = 0; s < cache->count; s++)
+        DeallocateShared(cache->slots[s]);
+      cache->count = 0;
     }
 
+    ret = AllocateFromPools();
+    if(ret != NULL)
+      return ret;
+
 // warn when we need to allocate an additional pool
 #if ENABLED(INCLUDE_TYPE_NAMES)
     RDCWARN("Ran out of free slots in %s pool!", GetTypeName<WrapType>::Name());
@@ -78,7 +374,7 @@ public:
 #endif
 
     // allocate a new additional pool and use that to allocate from
-    m_AdditionalPools.push_back(new ItemPool());
+    m_AdditionalPools.push_back(NewPool());
 
 #if ENABLED(INCLUDE_TYPE_NAMES)
     RDCDEBUG("WrappingPool[%d]<%s>: %p -> %p", (uint32_t)m_AdditionalPools.size() - 1,
@@ -89,36 +385,69 @@ public:
     return m_AdditionalPools.back()->Allocate();
   }
 
-  bool IsAlloc(const void *p)
+  // must be called with m_Lock held
+  void *AllocateFromPools()
   {
-    // we can check the immediate pool without locking
-    if(m_ImmediatePool.IsAlloc(p))
-      return true;
+    // try and allocate from immediate pool
+    void *ret = m_ImmediatePool.Allocate();
+    if(ret != NULL)
+      return ret;
 
-    // if we have additional pools, lock and check them.
-    // TODO: Check for additional pools in a lock-free manner,
-    // to prevent the cost of locking if there are no more pools.
+    // fall back to additional pools, if there are any
+    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
     {
-      SCOPED_LOCK(m_Lock);
-
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-        if(m_AdditionalPools[i]->IsAlloc(p))
-          return true;
+      ret = m_AdditionalPools[i]->Allocate();
+      if(ret != NULL)
+        return ret;
     }
 
-    return false;
+    return NULL;
   }
 
-  void Deallocate(void *p)
+  bool InReservedRange(const void *p) const
   {
-    SCOPED_LOCK(m_Lock);
+    return p >= (const void *)m_Range && p < (const void *)(m_Range + m_RangeBytes);
+  }
+
+  // must be called with m_Lock held. Pools are taken from the reserved range in order, so the
+  // first ones after the immediate pool can be indexed directly
+  ItemPool *NewPool()
+  {
+    ItemPool *ret = new ItemPool();
+
+    size_t idx = m_AdditionalPools.size() + 1;
+    byte *storage = NULL;
+
+    if(idx < m_RangePools)
+    {
+      storage = m_Range + idx * m_PoolByteSize;
+      if(!VirtualMemory::Commit(storage, m_PoolByteSize))
+        storage = NULL;
+    }
+
+    ret->Init(storage);
+
+    return ret;
+  }
 
+  // must be called with m_Lock held
+  void DeallocateShared(void *p)
+  {
     // try immediate pool
     if(m_ImmediatePool.IsAlloc(p))
     {
       m_ImmediatePool.Deallocate(p);
       return;
     }
+    else if(InReservedRange(p))
+    {
+      size_t idx = ((byte *)p - m_Range) / m_PoolByteSize;
+      if(idx > 0 && idx <= m_AdditionalPools.size() && m_AdditionalPools[idx - 1]->IsAlloc(p))
+      {
+        m_AdditionalPools[idx - 1]->Deallocate(p);
+        return;
+      }
+    }
     else if(!m_AdditionalPools.empty())
     {
       // fall back and try additional pools
@@ -142,13 +471,46 @@ public:
 #endif
   }
 
-  static const size_t AllocCount = PoolCount;
-  static const size_t AllocMaxByteSize = MaxPoolByteSize;
-  static const size_t AllocByteSize;
-
-private:
   WrappingPool()
   {
+    m_PoolIndex = WrappingPoolThreadCaches::AllocatePoolIndex();
+    m_Refills = m_Drains = 0;
+    m_ExitedAllocs = m_ExitedFrees = 0;
+
+    m_Range = NULL;
+    m_RangeBytes = 0;
+    m_RangePools = 0;
+    m_PoolByteSize = 0;
+
+    if(ReserveCount > 0)
+    {
+      size_t pageSize = VirtualMemory::GetPageSize();
+
+      // each pool starts on a page boundary so that it can be committed on its own
+      m_PoolByteSize = (AllocCount * AllocByteSize + pageSize - 1) & ~(pageSize - 1);
+
+      m_RangePools = (ReserveCount + AllocCount - 1) / AllocCount;
+      m_Range = (byte *)VirtualMemory::Reserve(m_RangePools * m_PoolByteSize, true);
+
+      if(m_Range && VirtualMemory::Commit(m_Range, m_PoolByteSize))
+      {
+        m_RangeBytes = m_RangePools * m_PoolByteSize;
+      }
+      else
+      {
+        RDCWARN("Couldn't reserve %llu bytes for pool, falling back to heap pools",
+                uint64_t(m_RangePools * m_PoolByteSize));
+
+        if(m_Range)
+          VirtualMemory::Release(m_Range, m_RangePools * m_PoolByteSize);
+
+        m_Range = NULL;
+        m_RangePools = 0;
+      }
+    }
+
+    m_ImmediatePool.Init(m_Range);
+
 #if ENABLED(INCLUDE_TYPE_NAMES)
     // hack - print in kB because float printing relies on statics that might not be initialised
     // yet in loading order. Ugly :(
@@ -163,10 +525,33 @@ private:
       delete m_AdditionalPools[i];
 
     m_AdditionalPools.clear();
+
+    // threads that are still running own their caches and free them when they exit
+    for(size_t i = 0; i < m_ThreadCaches.size(); i++)
+      m_ThreadCaches[i]->pool = NULL;
+
+    m_ThreadCaches.clear();
+
+    // the pools don't own storage from the range, so this must come after they're deleted
+    if(m_Range)
+      VirtualMemory::Release(m_Range, m_RangeBytes);
   }
 
   Threading::CriticalSection m_Lock;
 
+  int32_t m_PoolIndex;
+  std::vector<ThreadCache *> m_ThreadCaches;
+  uint64_t m_Refills;
+  uint64_t m_Drains;
+  // counts from the caches of threads that have exited
+  uint64_t m_ExitedAllocs;
+  uint64_t m_ExitedFrees;
+
+  byte *m_Range;
+  size_t m_RangeBytes;
+  size_t m_RangePools;
+  size_t m_PoolByteSize;
+
   struct ItemPool
   {
     ItemPool()
@@ -174,9 +559,26 @@ private:
       lastAllocIdx = 0;
       RDCEraseEl(allocated);
 
-      items = (WrapType *)(new uint8_t[AllocCount * AllocByteSize]);
+      items = NULL;
+      ownsItems = false;
+    }
+
+    // storage is committed memory from the reserved range, or NULL to allocate from the heap
+    void Init(void *storage)
+    {
+      ownsItems = (storage == NULL);
+
+      if(ownsItems)
+        items = (WrapType *)(new uint8_t[AllocCount * AllocByteSize]);
+      else
+        items = (WrapType *)storage;
+    }
+
+    ~ItemPool()
+    {
+      if(ownsItems)
+        delete[](uint8_t *) items;
     }
-    ~ItemPool() { delete[](uint8_t *) items; }
     void *Allocate()
     {
       int lastAlloc = lastAllocIdx;
@@ -231,6 +633,7 @@ private:
 
     bool IsAlloc(const void *p) const { return p >= &items[0] && p < &items[PoolCount]; }
     WrapType *items;
+    bool ownsItems;
 
     // could possibly make this uint32s and check via bitmasks, but
     // we'll see if it shows up in profiling
@@ -275,4 +678,7 @@ private:
                     "Pool is bigger than max pool size cap for " STRINGIZE(a));           \
   RDCCOMPILE_ASSERT(a::PoolType::AllocCount > 2,                                          \
                     "Pool isn't greater than 2 in size. Bad parameters?");                \
+  RDCCOMPILE_ASSERT(a::PoolType::AllocReserveCount == 0 ||                                \
+                        a::PoolType::AllocReserveCount >= a::PoolType::AllocCount,        \
+                    "Reserved range doesn't fit the immediate pool for " STRINGIZE(a));   \
   DECL_TYPENAME(a);
@@ -29,6 +29,7 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/dds_readwrite.h"
+#include "common/job_system.h"
 #include "hooks/hooks.h"
 #include "replay/replay_driver.h"
 #include "serialise/serialiser.h"
@@ -224,6 +225,18 @@ RenderDoc::RenderDoc()
 
   m_Cap = 0;
 
+  m_SpikeCooldown = 0;
+
+  m_RingBytes = 0;
+  m_RingFramePending = false;
+  m_RingFrameActive = false;
+  m_RingOverheadMS = 0.0;
+  m_RingOverheadFrames = 0;
+
+  for(int i = 0; i < eCaptureMemory_Count; i++)
+    m_CaptureMemory[i] = 0;
+  m_AbortedCaptures = 0;
+
   m_FocusKeys.clear();
   m_FocusKeys.push_back(eRENDERDOC_Key_F11);
 
@@ -233,6 +246,11 @@ RenderDoc::RenderDoc()
 
   m_ProgressPtr = NULL;
 
+  m_OperationCancel = NULL;
+  m_OperationProgress = NULL;
+  m_OperationProgressStart = 0.0f;
+  m_OperationProgressEnd = 1.0f;
+
   m_ExHandler = NULL;
 
   m_Overlay = eRENDERDOC_Overlay_Default;
@@ -252,6 +270,8 @@ void RenderDoc::Initialise()
 
   Threading::Init();
 
+  Threading::InitJobSystem();
+
   m_RemoteIdent = 0;
   m_RemoteThread = 0;
 
@@ -305,6 +325,9 @@ void RenderDoc::Initialise()
       SetLogFile(capture_filename.c_str());
 
     RDCLOGFILE(m_LoggingFilename.c_str());
+
+    if(!IsReplayApp())
+      Chunk::SetSpillFile((m_LoggingFilename + ".spill").c_str());
   }
 
   if(IsReplayApp())
@@ -349,6 +372,22 @@ RenderDoc::~RenderDoc()
   for(auto it = m_ShutdownFunctions.begin(); it != m_ShutdownFunctions.end(); ++it)
     (*it)();
 
+  // as with the target control thread below we can't join here, but any capture still being
+  // written must be finished before we go away. The flag is set before the thread exits.
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+
+    for(size_t i = 0; i < m_CaptureWrites.size(); i++)
+    {
+      while(!m_CaptureWrites[i]->finished)
+        m_CaptureWriteDone.Wait(m_CaptureWriteLock);
+
+      Threading::CloseThread(m_CaptureWrites[i]->thread);
+      SAFE_DELETE(m_CaptureWrites[i]);
+    }
+    m_CaptureWrites.clear();
+  }
+
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
     if(m_Captures[i].retrieved)
@@ -380,6 +419,8 @@ RenderDoc::~RenderDoc()
 
   Network::Shutdown();
 
+  Threading::ShutdownJobSystem();
+
   Threading::Shutdown();
 
   FileIO::Delete(m_LoggingFilename.c_str());
@@ -401,6 +442,12 @@ void RenderDoc::Shutdown()
     Threading::CloseThread(m_RemoteThread);
     m_RemoteThread = 0;
   }
+
+  JoinCaptureWrites(false);
+
+  FreeRingFrames();
+
+  Chunk::CloseSpillFile();
 }
 
 bool RenderDoc::MatchClosestWindow(void *&dev, void *&wnd)
@@ -472,11 +519,19 @@ IFrameCapturer *RenderDoc::MatchFrameCapturer(void *dev, void *wnd)
 
 void RenderDoc::StartFrameCapture(void *dev, void *wnd)
 {
+  m_RingFrameActive = m_RingFramePending;
+  m_RingFramePending = false;
+
   IFrameCapturer *frameCap = MatchFrameCapturer(dev, wnd);
   if(frameCap)
   {
+    PerformanceTimer timer;
+
     frameCap->StartFrameCapture(dev, wnd);
     m_CapturesActive++;
+
+    if(m_RingFrameActive)
+      m_RingOverheadMS += timer.GetMilliseconds();
   }
 }
 
@@ -496,11 +551,26 @@ void RenderDoc::SetActiveWindow(void *dev, void *wnd)
 
 bool RenderDoc::EndFrameCapture(void *dev, void *wnd)
 {
+  m_RingFramePending = false;
+
   IFrameCapturer *frameCap = MatchFrameCapturer(dev, wnd);
   if(frameCap)
   {
+    // FinishCaptureWrite clears this when the frame is added to the ring
+    bool ringFrame = m_RingFrameActive;
+
+    PerformanceTimer timer;
+
     m_CapturesActive--;
-    return frameCap->EndFrameCapture(dev, wnd);
+    bool ret = frameCap->EndFrameCapture(dev, wnd);
+
+    if(ringFrame)
+    {
+      m_RingOverheadMS += timer.GetMilliseconds();
+      m_RingOverheadFrames++;
+    }
+
+    return ret;
   }
   return false;
 }
@@ -517,6 +587,78 @@ string RenderDoc::GetTargetControlUsername()
   return RenderDoc::Inst().m_SingleClientName;
 }
 
+static bool LargerRecord(const CaptureRecordStats &a, const CaptureRecordStats &b)
+{
+  return a.chunkBytes > b.chunkBytes;
+}
+
+void RenderDoc::GetCaptureStats(TargetControlMessage::CaptureStatsData &stats)
+{
+  // only the largest few records are interesting, everything else is in the totals
+  const size_t maxRecords = 16;
+
+  stats = TargetControlMessage::CaptureStatsData();
+
+  stats.liveChunks = Chunk::NumLiveChunks();
+  stats.peakLiveChunks = Chunk::MaxLiveChunks();
+  stats.chunkBytes = Chunk::TotalMem();
+  stats.chunkPageBytes = Chunk::ArenaMem();
+  stats.peakChunkPageBytes = Chunk::MaxArenaMem();
+
+  {
+    SCOPED_LOCK(m_RingLock);
+    stats.ringFrames = (uint32_t)m_RingFrames.size();
+    stats.ringBytes = m_RingBytes;
+    stats.ringByteLimit = uint64_t(m_Options.RingCaptureMemoryMB) * 1024 * 1024;
+    if(m_RingOverheadFrames > 0)
+      stats.ringFrameOverheadMS = m_RingOverheadMS / double(m_RingOverheadFrames);
+  }
+
+  stats.captureMemoryBytes = GetCaptureMemory();
+  stats.captureMemoryBudget = uint64_t(m_Options.CaptureMemoryBudgetMB) * 1024 * 1024;
+  stats.initialContentBytes = (uint64_t)m_CaptureMemory[eCaptureMemory_InitialContents];
+  stats.mapShadowBytes = (uint64_t)m_CaptureMemory[eCaptureMemory_MapShadows];
+  stats.spilledBytes = Chunk::SpilledMem();
+  stats.abortedCaptures = m_AbortedCaptures;
+
+  stats.avgFrameTimeMS = m_FrameTimer.GetAvgFrameTime();
+  stats.minFrameTimeMS = m_FrameTimer.GetMinFrameTime();
+  stats.maxFrameTimeMS = m_FrameTimer.GetMaxFrameTime();
+
+  vector<CaptureRecordStats> records;
+
+  {
+    SCOPED_LOCK(m_CaptureStatsLock);
+    for(auto it = m_CaptureStatsSources.begin(); it != m_CaptureStatsSources.end(); ++it)
+      (*it)->AddCaptureStats(stats, records);
+  }
+
+  std::sort(records.begin(), records.end(), LargerRecord);
+
+  if(records.size() > maxRecords)
+    records.resize(maxRecords);
+
+  stats.largestRecords = records;
+}
+
+uint64_t RenderDoc::GetCaptureMemory()
+{
+  int64_t ret = int64_t(Chunk::TotalMem()) - int64_t(Chunk::SpilledMem());
+
+  for(int i = 0; i < eCaptureMemory_Count; i++)
+    ret += m_CaptureMemory[i];
+
+  return ret > 0 ? uint64_t(ret) : 0;
+}
+
+bool RenderDoc::IsOverCaptureMemoryBudget()
+{
+  if(m_Options.CaptureMemoryBudgetMB == 0)
+    return false;
+
+  return GetCaptureMemory() > uint64_t(m_Options.CaptureMemoryBudgetMB) * 1024 * 1024;
+}
+
 void RenderDoc::Tick()
 {
   static bool prev_focus = false;
@@ -560,11 +702,54 @@ void RenderDoc::Tick()
   {
     TriggerCapture(1);
   }
+  else if(m_Cap == 0 && CheckFrameTimeSpike())
+  {
+    TriggerCapture(1);
+  }
 
   prev_focus = cur_focus;
   prev_cap = cur_cap;
 }
 
+bool RenderDoc::CheckFrameTimeSpike()
+{
+  // a triggered capture makes its own frames slow, so give it time to finish and the average
+  // time to settle before looking for another spike
+  const uint32_t cooldownFrames = 60;
+
+  if(m_Options.SpikeCaptureThresholdMS == 0 && m_Options.SpikeCapturePercent == 0)
+    return false;
+
+  if(m_SpikeCooldown > 0)
+  {
+    m_SpikeCooldown--;
+    return false;
+  }
+
+  const double frameTime = m_FrameTimer.GetLastFrameTime();
+  const double avgTime = m_FrameTimer.GetAvgFrameTime();
+
+  bool spike = false;
+
+  if(m_Options.SpikeCaptureThresholdMS > 0 && frameTime > double(m_Options.SpikeCaptureThresholdMS))
+    spike = true;
+
+  // the average isn't known until a second's worth of frames has been timed
+  if(m_Options.SpikeCapturePercent > 0 && avgTime > 0.0 &&
+     frameTime * 100.0 > avgTime * double(m_Options.SpikeCapturePercent))
+    spike = true;
+
+  if(!spike)
+    return false;
+
+  RDCLOG("Frame took %.2lf ms against an average of %.2lf ms, triggering a capture", frameTime,
+         avgTime);
+
+  m_SpikeCooldown = cooldownFrames;
+
+  return true;
+}
+
 string RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, int flags)
 {
   const bool activeWindow = (flags & eOverlay_ActiveWindow);
@@ -634,6 +819,9 @@ string RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, int fla
 #if ENABLED(RDOC_DEVEL)
     overlayText += StringFormat::Fmt("%llu chunks - %.2f MB\n", Chunk::NumLiveChunks(),
                                      float(Chunk::TotalMem()) / 1024.0f / 1024.0f);
+    overlayText += StringFormat::Fmt("Chunk pages - %.2f MB (peak %.2f MB)\n",
+                                     float(Chunk::ArenaMem()) / 1024.0f / 1024.0f,
+                                     float(Chunk::MaxArenaMem()) / 1024.0f / 1024.0f);
 #endif
   }
   else if(capturesEnabled)
@@ -661,12 +849,41 @@ string RenderDoc::GetOverlayText(RDCDriver driver, uint32_t frameNumber, int fla
   return overlayText;
 }
 
-bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
+bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber, uint32_t &spanFrames)
 {
+  m_RingFramePending = false;
+  spanFrames = 0;
+
+  // with a rolling capture, triggering writes out frames that have already been recorded rather
+  // than capturing the ones that follow
+  if(m_Options.RingCaptureFrames > 0)
+  {
+    if(m_Cap > 0)
+    {
+      WriteRingFrames(m_Cap);
+      m_Cap = 0;
+    }
+  }
+  else if(!m_RingFrames.empty())
+  {
+    FreeRingFrames();
+  }
+
   bool ret = m_Cap > 0;
 
   if(m_Cap > 0)
-    m_Cap--;
+  {
+    // record all the requested frames into this capture, rather than one capture each
+    if(m_Options.CombineMultiFrameCaptures)
+    {
+      spanFrames = m_Cap - 1;
+      m_Cap = 0;
+    }
+    else
+    {
+      m_Cap--;
+    }
+  }
 
   set<uint32_t> frames;
   frames.swap(m_QueuedFrameCaptures);
@@ -688,6 +905,13 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
     }
   }
 
+  // otherwise record this frame into the ring
+  if(!ret && m_Options.RingCaptureFrames > 0)
+  {
+    m_RingFramePending = true;
+    ret = true;
+  }
+
   return ret;
 }
 
@@ -724,6 +948,12 @@ Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *par
     }
 
     fileSerialiser->Insert(scope.Get(true));
+
+    // the chunk is kept for older readers, but the section can be read without opening the capture
+    if(HasThumbnail)
+      fileSerialiser->SetThumbnail(thwidth, thheight, (const byte *)thpixels, thlen);
+    else
+      fileSerialiser->SetThumbnail(0, 0, NULL, 0);
   }
 
   {
@@ -887,6 +1117,21 @@ void RenderDoc::RegisterRemoteProvider(RDCDriver driver, const char *name,
   m_RemoteDriverProviders[driver] = provider;
 }
 
+void RenderDoc::RegisterCaptureChunkInfo(RDCDriver driver, const CaptureChunkInfo &info)
+{
+  m_CaptureChunkInfos[driver] = info;
+}
+
+bool RenderDoc::GetCaptureChunkInfo(RDCDriver driver, CaptureChunkInfo &info)
+{
+  auto it = m_CaptureChunkInfos.find(driver);
+  if(it == m_CaptureChunkInfos.end())
+    return false;
+
+  info = it->second;
+  return true;
+}
+
 ReplayCreateStatus RenderDoc::CreateReplayDriver(RDCDriver driverType, const char *logfile,
                                                  IReplayDriver **driver)
 {
@@ -1017,14 +1262,238 @@ void RenderDoc::SetProgress(LoadProgressSection section, float delta)
   *m_ProgressPtr = progress;
 }
 
-void RenderDoc::SuccessfullyWrittenLog(uint32_t frameNumber)
+void RenderDoc::SuccessfullyWrittenLog(Serialiser *fileSerialiser, uint32_t frameNumber)
 {
-  RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+  vector<byte> thumbnail;
+  fileSerialiser->GetThumbnail(thumbnail);
 
-  CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), frameNumber);
+  AddWrittenCapture(m_CurrentLogFile, frameNumber, thumbnail);
+}
+
+void RenderDoc::AddWrittenCapture(const string &path, uint32_t frameNumber,
+                                  const vector<byte> &thumbnail)
+{
+  RDCLOG("Written to disk: %s", path.c_str());
+
+  CaptureData cap(path, Timing::GetUnixTimestamp(), frameNumber);
   {
     SCOPED_LOCK(m_CaptureLock);
     m_Captures.push_back(cap);
+    m_CaptureThumbnails.push_back(thumbnail);
+  }
+}
+
+void RenderDoc::FinishCaptureWrite(Serialiser *fileSerialiser, uint32_t frameNumber)
+{
+  if(m_RingFrameActive)
+  {
+    m_RingFrameActive = false;
+    AddRingFrame(fileSerialiser, frameNumber);
+    return;
+  }
+
+  if(IsOverCaptureMemoryBudget())
+  {
+    // the initial contents have been spilled already if they could be, so try whatever else the
+    // serialiser owns before giving up on the capture
+    fileSerialiser->SpillOwnedChunks();
+  }
+
+  if(IsOverCaptureMemoryBudget())
+  {
+    RDCERR(
+        "Capture of frame %u aborted: it needs %llu MB of memory, over the %u MB capture memory "
+        "budget. Raise eRENDERDOC_Option_CaptureMemoryBudgetMB to capture this frame.",
+        frameNumber, GetCaptureMemory() / (1024 * 1024), m_Options.CaptureMemoryBudgetMB);
+
+    m_AbortedCaptures++;
+    SAFE_DELETE(fileSerialiser);
+    return;
+  }
+
+  // copying the chunks for an asynchronous write would only add to the memory in use
+  if(m_Options.AsyncCaptureWrite && !IsOverCaptureMemoryBudget())
+  {
+    // the chunks for records, initial contents etc are freed or reused as soon as the driver
+    // carries on, so the writer needs its own copies. Most share the same data, only chunks the
+    // driver can still modify in place are actually copied.
+    fileSerialiser->TakeChunkOwnership();
+
+    if(StartCaptureWrite(fileSerialiser, m_CurrentLogFile, frameNumber))
+      return;
+  }
+
+  fileSerialiser->FlushToDisk();
+  SuccessfullyWrittenLog(fileSerialiser, frameNumber);
+  SAFE_DELETE(fileSerialiser);
+}
+
+bool RenderDoc::StartCaptureWrite(Serialiser *fileSerialiser, const string &path,
+                                  uint32_t frameNumber)
+{
+  // tidy up after any previous writes that have completed
+  JoinCaptureWrites(true);
+
+  CaptureWrite *write = new CaptureWrite;
+  write->ser = fileSerialiser;
+  write->path = path;
+  write->frameNumber = frameNumber;
+  write->finished = false;
+
+  SCOPED_LOCK(m_CaptureWriteLock);
+
+  write->thread = Threading::CreateThread(&RenderDoc::CaptureWriteThread, write);
+
+  if(write->thread)
+  {
+    m_CaptureWrites.push_back(write);
+    return true;
+  }
+
+  RDCWARN("Couldn't start capture writing thread, writing %s synchronously", path.c_str());
+  SAFE_DELETE(write);
+  return false;
+}
+
+void RenderDoc::AddRingFrame(Serialiser *fileSerialiser, uint32_t frameNumber)
+{
+  // the frame outlives everything it references in the driver
+  fileSerialiser->TakeChunkOwnership();
+
+  RingFrame frame;
+  frame.ser = fileSerialiser;
+  frame.path = m_CurrentLogFile;
+  frame.frameNumber = frameNumber;
+  frame.bytes = fileSerialiser->GetInsertedChunkBytes();
+
+  const uint64_t limit = uint64_t(m_Options.RingCaptureMemoryMB) * 1024 * 1024;
+  const size_t maxFrames = RDCMAX(1U, m_Options.RingCaptureFrames);
+
+  SCOPED_LOCK(m_RingLock);
+
+  m_RingFrames.push_back(frame);
+  m_RingBytes += frame.bytes;
+
+  if(frame.bytes > limit)
+    RDCWARN("Rolling capture of frame %u is %llu MB, over the %u MB limit", frameNumber,
+            frame.bytes / (1024 * 1024), m_Options.RingCaptureMemoryMB);
+
+  // discard the oldest frames, but always keep the one just recorded
+  size_t discard = 0;
+  while(m_RingFrames.size() - discard > 1 &&
+        (m_RingFrames.size() - discard > maxFrames || m_RingBytes > limit ||
+         IsOverCaptureMemoryBudget()))
+  {
+    m_RingBytes -= m_RingFrames[discard].bytes;
+    SAFE_DELETE(m_RingFrames[discard].ser);
+    discard++;
+  }
+
+  if(discard > 0)
+    m_RingFrames.erase(m_RingFrames.begin(), m_RingFrames.begin() + discard);
+
+  // the ring frames own all their chunks, so the last resort is to move them to disk
+  if(IsOverCaptureMemoryBudget())
+    fileSerialiser->SpillOwnedChunks();
+}
+
+void RenderDoc::WriteRingFrames(uint32_t numFrames)
+{
+  vector<RingFrame> frames;
+
+  {
+    SCOPED_LOCK(m_RingLock);
+
+    size_t num = RDCMIN((size_t)numFrames, m_RingFrames.size());
+
+    frames.insert(frames.begin(), m_RingFrames.end() - num, m_RingFrames.end());
+    m_RingFrames.erase(m_RingFrames.end() - num, m_RingFrames.end());
+
+    for(size_t i = 0; i < frames.size(); i++)
+      m_RingBytes -= frames[i].bytes;
+  }
+
+  if(frames.empty())
+  {
+    RDCWARN("Rolling capture triggered before any frames were recorded");
+    return;
+  }
+
+  for(size_t i = 0; i < frames.size(); i++)
+  {
+    RDCLOG("Writing rolling capture of frame %u", frames[i].frameNumber);
+
+    if(m_Options.AsyncCaptureWrite &&
+       StartCaptureWrite(frames[i].ser, frames[i].path, frames[i].frameNumber))
+      continue;
+
+    vector<byte> thumbnail;
+    frames[i].ser->GetThumbnail(thumbnail);
+
+    frames[i].ser->FlushToDisk();
+    AddWrittenCapture(frames[i].path, frames[i].frameNumber, thumbnail);
+    SAFE_DELETE(frames[i].ser);
+  }
+}
+
+void RenderDoc::FreeRingFrames()
+{
+  SCOPED_LOCK(m_RingLock);
+
+  for(size_t i = 0; i < m_RingFrames.size(); i++)
+    SAFE_DELETE(m_RingFrames[i].ser);
+
+  m_RingFrames.clear();
+  m_RingBytes = 0;
+  m_RingOverheadMS = 0.0;
+  m_RingOverheadFrames = 0;
+}
+
+void RenderDoc::CaptureWriteThread(void *data)
+{
+  Threading::KeepModuleAlive();
+
+  CaptureWrite *write = (CaptureWrite *)data;
+
+  vector<byte> thumbnail;
+  write->ser->GetThumbnail(thumbnail);
+
+  write->ser->FlushToDisk();
+  SAFE_DELETE(write->ser);
+
+  RenderDoc::Inst().AddWrittenCapture(write->path, write->frameNumber, thumbnail);
+
+  {
+    SCOPED_LOCK(RenderDoc::Inst().m_CaptureWriteLock);
+    write->finished = true;
+    RenderDoc::Inst().m_CaptureWriteDone.Broadcast();
+  }
+
+  Threading::ReleaseModuleExitThread();
+}
+
+void RenderDoc::JoinCaptureWrites(bool finishedOnly)
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+
+  for(size_t i = 0; i < m_CaptureWrites.size();)
+  {
+    CaptureWrite *write = m_CaptureWrites[i];
+
+    if(finishedOnly && !write->finished)
+    {
+      i++;
+      continue;
+    }
+
+    // the thread needs the lock to mark itself finished, so wait for that before joining
+    while(!write->finished)
+      m_CaptureWriteDone.Wait(m_CaptureWriteLock);
+
+    Threading::JoinThread(write->thread);
+    Threading::CloseThread(write->thread);
+    SAFE_DELETE(write);
+    m_CaptureWrites.erase(m_CaptureWrites.begin() + i);
   }
 }
 
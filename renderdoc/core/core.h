@@ -33,6 +33,7 @@
 #include <vector>
 #include "api/app/renderdoc_app.h"
 #include "api/replay/capture_options.h"
+#include "api/replay/renderdoc_replay.h"
 #include "api/replay/replay_enums.h"
 #include "common/threading.h"
 #include "common/timing.h"
@@ -66,6 +67,22 @@ struct IFrameCapturer
   virtual bool EndFrameCapture(void *dev, void *wnd) = 0;
 };
 
+// anything holding capture memory that should be reported to target control clients. Resource
+// records with chunks should be appended to records, they are sorted and trimmed afterwards.
+struct ICaptureStatsSource
+{
+  virtual void AddCaptureStats(TargetControlMessage::CaptureStatsData &stats,
+                               vector<CaptureRecordStats> &records) = 0;
+};
+
+// memory held for captures outside of chunks, see RenderDoc::AddCaptureMemory
+enum CaptureMemoryType
+{
+  eCaptureMemory_InitialContents,
+  eCaptureMemory_MapShadows,
+  eCaptureMemory_Count,
+};
+
 enum LogState
 {
   READING = 0,
@@ -177,6 +194,20 @@ typedef void (*VulkanLayerInstall)(bool systemLevel);
 
 typedef void (*ShutdownFunction)();
 
+// what's needed to compare captures chunk by chunk without creating a replay device. The marker
+// chunk types delimit regions, and readMarkerName is called just inside a push or set marker chunk
+// to read its name.
+struct CaptureChunkInfo
+{
+  const char *(*chunkName)(uint32_t chunkType);
+  string (*readMarkerName)(Serialiser *ser);
+  // the chunk that starts the frame. Everything before it is resource creation and contents
+  uint32_t captureScope;
+  uint32_t pushMarker;
+  uint32_t popMarker;
+  uint32_t setMarker;
+};
+
 // this class mediates everything and owns any 'global' resources such as the crash handler.
 //
 // It acts as a central hub that registers any driver providers and can be asked to create one
@@ -189,6 +220,31 @@ public:
   void SetProgressPtr(float *progress) { m_ProgressPtr = progress; }
   void SetProgress(LoadProgressSection section, float delta);
 
+  // the cancel flag and progress of the replay operation currently running, if the caller wants
+  // them. Long-running operations poll IsOperationCancelled between units of work and return early
+  // with whatever they have, and report how far they've got from 0 to 1.
+  void SetOperationControl(volatile bool32 *cancel, float *progress)
+  {
+    m_OperationCancel = cancel;
+    m_OperationProgress = progress;
+    m_OperationProgressStart = 0.0f;
+    m_OperationProgressEnd = 1.0f;
+  }
+  bool IsOperationCancelled() const { return m_OperationCancel && *m_OperationCancel; }
+  void SetOperationProgress(float progress)
+  {
+    if(m_OperationProgress)
+      *m_OperationProgress =
+          m_OperationProgressStart + progress * (m_OperationProgressEnd - m_OperationProgressStart);
+  }
+  // when an operation is made of several smaller ones, maps the 0 to 1 progress that each of them
+  // reports onto its part of the whole.
+  void SetOperationProgressRange(float start, float end)
+  {
+    m_OperationProgressStart = start;
+    m_OperationProgressEnd = end;
+  }
+
   // set from outside of the device creation interface
   void SetLogFile(const char *logFile);
   const char *GetLogFile() const { return m_LogFile.c_str(); }
@@ -210,7 +266,12 @@ public:
   ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
   Serialiser *OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *params, void *thpixels,
                                   size_t thlen, uint32_t thwidth, uint32_t thheight);
-  void SuccessfullyWrittenLog(uint32_t frameNumber);
+  void SuccessfullyWrittenLog(Serialiser *fileSerialiser, uint32_t frameNumber);
+
+  // writes out and deletes a serialiser returned from OpenWriteSerialiser. With the
+  // AsyncCaptureWrite option this returns immediately and the capture is only added to the list
+  // of captures once a background thread has finished writing it.
+  void FinishCaptureWrite(Serialiser *fileSerialiser, uint32_t frameNumber);
 
   void AddChildProcess(uint32_t pid, uint32_t ident)
   {
@@ -223,12 +284,44 @@ public:
     return m_Children;
   }
 
+  void AddCaptureStatsSource(ICaptureStatsSource *source)
+  {
+    SCOPED_LOCK(m_CaptureStatsLock);
+    m_CaptureStatsSources.insert(source);
+  }
+  void RemoveCaptureStatsSource(ICaptureStatsSource *source)
+  {
+    SCOPED_LOCK(m_CaptureStatsLock);
+    m_CaptureStatsSources.erase(source);
+  }
+  void GetCaptureStats(TargetControlMessage::CaptureStatsData &stats);
+
+  // drivers report memory they hold for capturing that isn't in chunks, so that it counts against
+  // eRENDERDOC_Option_CaptureMemoryBudgetMB. bytes is negative when the memory is freed.
+  void AddCaptureMemory(CaptureMemoryType type, int64_t bytes)
+  {
+    Atomic::ExchAdd64(&m_CaptureMemory[type], bytes);
+  }
+  // the chunks in memory plus everything reported through AddCaptureMemory
+  uint64_t GetCaptureMemory();
+  bool IsOverCaptureMemoryBudget();
+
   vector<CaptureData> GetCaptures()
   {
     SCOPED_LOCK(m_CaptureLock);
     return m_Captures;
   }
 
+  // the jpeg thumbnail written into a capture, kept so that it can be announced without reading
+  // the file back. Empty if the capture has no thumbnail.
+  vector<byte> GetCaptureThumbnail(uint32_t idx)
+  {
+    SCOPED_LOCK(m_CaptureLock);
+    if(idx < m_CaptureThumbnails.size())
+      return m_CaptureThumbnails[idx];
+    return vector<byte>();
+  }
+
   void MarkCaptureRetrieved(uint32_t idx)
   {
     SCOPED_LOCK(m_CaptureLock);
@@ -243,6 +336,8 @@ public:
 
   void RegisterReplayProvider(RDCDriver driver, const char *name, ReplayDriverProvider provider);
   void RegisterRemoteProvider(RDCDriver driver, const char *name, RemoteDriverProvider provider);
+  void RegisterCaptureChunkInfo(RDCDriver driver, const CaptureChunkInfo &info);
+  bool GetCaptureChunkInfo(RDCDriver driver, CaptureChunkInfo &info);
 
   void SetVulkanLayerCheck(VulkanLayerCheck callback) { m_VulkanCheck = callback; }
   void SetVulkanLayerInstall(VulkanLayerInstall callback) { m_VulkanInstall = callback; }
@@ -303,6 +398,12 @@ public:
 
   void TriggerCapture(uint32_t numFrames) { m_Cap = numFrames; }
   uint32_t GetOverlayBits() { return m_Overlay; }
+  // whether drivers should draw the overlay on present. The capture option hides it without
+  // changing the bits the application sees.
+  bool ShouldDrawOverlay()
+  {
+    return (m_Overlay & eRENDERDOC_Overlay_Enabled) && !m_Options.HideOverlay;
+  }
   void MaskOverlayBits(uint32_t And, uint32_t Or) { m_Overlay = (m_Overlay & And) | Or; }
   void QueueCapture(uint32_t frameNumber) { m_QueuedFrameCaptures.insert(frameNumber); }
   void SetFocusKeys(RENDERDOC_InputButton *keys, int num)
@@ -320,7 +421,14 @@ public:
 
   const vector<RENDERDOC_InputButton> &GetFocusKeys() { return m_FocusKeys; }
   const vector<RENDERDOC_InputButton> &GetCaptureKeys() { return m_CaptureKeys; }
-  bool ShouldTriggerCapture(uint32_t frameNumber);
+  // spanFrames receives how many further presents a triggered capture should keep recording
+  // through, when a run of frames is combined into one capture. It belongs to the device whose
+  // capture starts, which counts its own presents down and records a frame boundary at each.
+  bool ShouldTriggerCapture(uint32_t frameNumber, uint32_t &spanFrames);
+
+  // true while the frame being captured is only being recorded for the rolling capture, in which
+  // case drivers still tick at present as if no capture were in progress
+  bool IsRingFrameActive() const { return m_RingFrameActive; }
 
   enum
   {
@@ -340,6 +448,9 @@ private:
 
   uint32_t m_Cap;
 
+  bool CheckFrameTimeSpike();
+  uint32_t m_SpikeCooldown;
+
   vector<RENDERDOC_InputButton> m_FocusKeys;
   vector<RENDERDOC_InputButton> m_CaptureKeys;
 
@@ -364,17 +475,73 @@ private:
 
   float *m_ProgressPtr;
 
+  volatile bool32 *m_OperationCancel;
+  float *m_OperationProgress;
+  float m_OperationProgressStart, m_OperationProgressEnd;
+
   Threading::CriticalSection m_CaptureLock;
   vector<CaptureData> m_Captures;
+  // kept separately from m_Captures so GetCaptures doesn't copy every thumbnail
+  vector<vector<byte> > m_CaptureThumbnails;
+
+  struct CaptureWrite
+  {
+    Serialiser *ser;
+    string path;
+    uint32_t frameNumber;
+    Threading::ThreadHandle thread;
+    // set under m_CaptureWriteLock, and m_CaptureWriteDone is broadcast
+    bool finished;
+  };
+
+  static void CaptureWriteThread(void *data);
+  bool StartCaptureWrite(Serialiser *fileSerialiser, const string &path, uint32_t frameNumber);
+  void AddWrittenCapture(const string &path, uint32_t frameNumber, const vector<byte> &thumbnail);
+  void JoinCaptureWrites(bool finishedOnly);
+
+  Threading::CriticalSection m_CaptureWriteLock;
+  Threading::ConditionVariable m_CaptureWriteDone;
+  vector<CaptureWrite *> m_CaptureWrites;
+
+  // a frame recorded by the rolling capture, with its chunks owned by the serialiser so it can be
+  // written out at any point later. See eRENDERDOC_Option_RingCaptureFrames
+  struct RingFrame
+  {
+    Serialiser *ser;
+    string path;
+    uint32_t frameNumber;
+    uint64_t bytes;
+  };
+
+  void AddRingFrame(Serialiser *fileSerialiser, uint32_t frameNumber);
+  void WriteRingFrames(uint32_t numFrames);
+  void FreeRingFrames();
+
+  Threading::CriticalSection m_RingLock;
+  vector<RingFrame> m_RingFrames;
+  uint64_t m_RingBytes;
+  // set by ShouldTriggerCapture when the next frame capture is only for the ring, and moved to
+  // m_RingFrameActive once that capture starts
+  bool m_RingFramePending;
+  bool m_RingFrameActive;
+  double m_RingOverheadMS;
+  uint32_t m_RingOverheadFrames;
+
+  volatile int64_t m_CaptureMemory[eCaptureMemory_Count];
+  uint32_t m_AbortedCaptures;
 
   Threading::CriticalSection m_ChildLock;
   vector<pair<uint32_t, uint32_t> > m_Children;
 
+  Threading::CriticalSection m_CaptureStatsLock;
+  set<ICaptureStatsSource *> m_CaptureStatsSources;
+
   map<string, string> m_ConfigSettings;
 
   map<RDCDriver, string> m_DriverNames;
   map<RDCDriver, ReplayDriverProvider> m_ReplayDriverProviders;
   map<RDCDriver, RemoteDriverProvider> m_RemoteDriverProviders;
+  map<RDCDriver, CaptureChunkInfo> m_CaptureChunkInfos;
 
   VulkanLayerCheck m_VulkanCheck;
   VulkanLayerInstall m_VulkanInstall;
@@ -444,4 +611,8 @@ struct DriverRegistration
   {
     RenderDoc::Inst().RegisterRemoteProvider(driver, name, provider);
   }
+  DriverRegistration(RDCDriver driver, const CaptureChunkInfo &info)
+  {
+    RenderDoc::Inst().RegisterCaptureChunkInfo(driver, info);
+  }
 };
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "entry_profiler.h"
+#include <algorithm>
+#include "common/common.h"
+#include "common/threading.h"
+
+// more than any single driver has entry points, counters past this are ignored
+static const uint32_t MaxEntryPoints = 4096;
+
+struct ThreadEntryCounters
+{
+  uint32_t generation;
+  EntryProfiler::Slot slots[MaxEntryPoints];
+};
+
+static Threading::CriticalSection entryProfileLock;
+static std::vector<const char *> entryNames;
+static std::vector<ThreadEntryCounters *> entryThreads;
+static uint64_t entryTLSSlot = 0;
+
+// bumped on every reset, threads clear their own counters lazily when they see a new value so
+// that nothing has to write to another thread's storage
+static volatile uint32_t entryGeneration = 1;
+
+EntryPointCounter::EntryPointCounter(const char *n) : name(n)
+{
+  SCOPED_LOCK(entryProfileLock);
+
+  index = (uint32_t)entryNames.size();
+  entryNames.push_back(n);
+
+  if(index == MaxEntryPoints)
+    RDCWARN("More than %u profiled entry points, '%s' onwards won't be counted", MaxEntryPoints, n);
+}
+
+namespace EntryProfiler
+{
+volatile uint32_t sampleInterval = 0;
+
+Slot *BeginCall(const EntryPointCounter &counter)
+{
+  uint32_t interval = sampleInterval;
+
+  if(interval == 0 || counter.index >= MaxEntryPoints)
+    return NULL;
+
+  ThreadEntryCounters *counters = (ThreadEntryCounters *)Threading::GetTLSValue(entryTLSSlot);
+
+  if(counters == NULL)
+  {
+    counters = new ThreadEntryCounters;
+    RDCEraseEl(counters->slots);
+    counters->generation = entryGeneration;
+
+    Threading::SetTLSValue(entryTLSSlot, counters);
+
+    SCOPED_LOCK(entryProfileLock);
+    entryThreads.push_back(counters);
+  }
+  else if(counters->generation != entryGeneration)
+  {
+    RDCEraseEl(counters->slots);
+    counters->generation = entryGeneration;
+  }
+
+  Slot &slot = counters->slots[counter.index];
+
+  slot.calls++;
+
+  // time the first call, then one in every interval after that
+  if((slot.calls - 1) % interval != 0)
+    return NULL;
+
+  return &slot;
+}
+
+void SetSampleInterval(uint32_t interval)
+{
+  SCOPED_LOCK(entryProfileLock);
+
+  if(entryTLSSlot == 0)
+    entryTLSSlot = Threading::AllocateTLSSlot();
+
+  if(interval > 0)
+    entryGeneration++;
+
+  sampleInterval = interval;
+
+  if(interval > 0)
+    RDCLOG("Profiling entry points, timing one call in %u", interval);
+  else
+    RDCLOG("Stopped profiling entry points");
+}
+
+static bool LongerEntryPoint(const EntryPointStats &a, const EntryPointStats &b)
+{
+  return a.totalNS > b.totalNS;
+}
+
+void GetStats(TargetControlMessage::EntryPointStatsData &stats)
+{
+  std::vector<EntryPointStats> entries;
+
+  // ticks to nanoseconds
+  double nsPerTick = 1000000.0 / Timing::GetTickFrequency();
+
+  {
+    SCOPED_LOCK(entryProfileLock);
+
+    stats.sampleInterval = sampleInterval;
+
+    uint32_t numEntries = RDCMIN((uint32_t)entryNames.size(), MaxEntryPoints);
+
+    std::vector<Slot> totals;
+    totals.resize(numEntries);
+    if(numEntries > 0)
+      memset(&totals[0], 0, sizeof(Slot) * numEntries);
+
+    // threads that haven't called anything since the last reset have stale counters
+    for(size_t t = 0; t < entryThreads.size(); t++)
+    {
+      if(entryThreads[t]->generation != entryGeneration)
+        continue;
+
+      for(uint32_t i = 0; i < numEntries; i++)
+      {
+        const Slot &slot = entryThreads[t]->slots[i];
+        totals[i].calls += slot.calls;
+        totals[i].sampledCalls += slot.sampledCalls;
+        totals[i].sampledTicks += slot.sampledTicks;
+      }
+    }
+
+    for(uint32_t i = 0; i < numEntries; i++)
+    {
+      if(totals[i].calls == 0)
+        continue;
+
+      EntryPointStats entry;
+      entry.name = entryNames[i];
+      entry.calls = totals[i].calls;
+      entry.sampledCalls = totals[i].sampledCalls;
+      entry.totalNS = 0;
+
+      // extrapolate the sampled time over all calls
+      if(totals[i].sampledCalls > 0)
+        entry.totalNS = uint64_t(double(totals[i].sampledTicks) * nsPerTick *
+                                 double(totals[i].calls) / double(totals[i].sampledCalls));
+
+      entries.push_back(entry);
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), LongerEntryPoint);
+
+  stats.entryPoints = entries;
+}
+};
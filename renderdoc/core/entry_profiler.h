@@ -0,0 +1,96 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "api/replay/renderdoc_replay.h"
+#include "os/os_specific.h"
+
+// Lightweight timing of the wrapped API entry points. Each entry point that uses
+// SCOPED_ENTRY_PROFILE() gets a counter, registered the first time it's called. While profiling
+// is disabled the only cost is a single check. Once enabled every call is counted and one in
+// every sampleInterval calls is timed, in per-thread storage so no locks are taken on the hot
+// path. The per-thread values are summed up when the stats are requested over target control.
+// Times are inclusive, an entry point that calls another wrapped entry point counts both.
+
+struct EntryPointCounter
+{
+  EntryPointCounter(const char *name);
+
+  const char *name;
+  uint32_t index;
+};
+
+namespace EntryProfiler
+{
+struct Slot
+{
+  uint64_t calls;
+  uint64_t sampledCalls;
+  uint64_t sampledTicks;
+};
+
+extern volatile uint32_t sampleInterval;
+
+// counts a call and returns the thread's slot for it if this call should be timed
+Slot *BeginCall(const EntryPointCounter &counter);
+
+// 0 disables profiling. Enabling (or changing the interval) resets all counters
+void SetSampleInterval(uint32_t interval);
+
+void GetStats(TargetControlMessage::EntryPointStatsData &stats);
+};
+
+class ScopedEntryTimer
+{
+public:
+  ScopedEntryTimer(const EntryPointCounter &counter) : m_Slot(NULL), m_Start(0)
+  {
+    if(EntryProfiler::sampleInterval == 0)
+      return;
+
+    m_Slot = EntryProfiler::BeginCall(counter);
+
+    if(m_Slot)
+      m_Start = Timing::GetTick();
+  }
+
+  ~ScopedEntryTimer()
+  {
+    if(m_Slot)
+    {
+      m_Slot->sampledTicks += Timing::GetTick() - m_Start;
+      m_Slot->sampledCalls++;
+    }
+  }
+
+private:
+  EntryProfiler::Slot *m_Slot;
+  uint64_t m_Start;
+};
+
+#define SCOPED_ENTRY_PROFILE()                          \
+  static EntryPointCounter entry_counter(__FUNCTION__); \
+  ScopedEntryTimer entry_timer(entry_counter);
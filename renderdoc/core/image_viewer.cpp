@@ -33,8 +33,10 @@ class ImageViewer : public IReplayDriver
 {
 public:
   ImageViewer(IReplayDriver *proxy, const char *filename)
-      : m_Proxy(proxy), m_Filename(filename), m_TextureID()
+      : m_Proxy(proxy), m_Filename(filename), m_TextureID(), m_DDSMapping(NULL)
   {
+    RDCEraseEl(m_DDS);
+
     if(m_Proxy == NULL)
       RDCERR("Unexpectedly NULL proxy at creation of ImageViewer");
 
@@ -62,6 +64,8 @@ public:
 
   virtual ~ImageViewer()
   {
+    ReleaseDDS();
+
     m_Proxy->Shutdown();
     m_Proxy = NULL;
   }
@@ -102,29 +106,72 @@ public:
   bool GetMinMax(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                  FormatComponentType typeHint, float *minval, float *maxval)
   {
+    EnsureSubresource(sliceFace, mip);
     return m_Proxy->GetMinMax(m_TextureID, sliceFace, mip, sample, typeHint, minval, maxval);
   }
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram)
   {
+    EnsureSubresource(sliceFace, mip);
     return m_Proxy->GetHistogram(m_TextureID, sliceFace, mip, sample, typeHint, minval, maxval,
                                  channels, histogram);
   }
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches)
+  {
+    EnsureSubresource(sliceFace, mip);
+    return m_Proxy->SearchTextureValues(m_TextureID, sliceFace, mip, sample, params, matches,
+                                        numMatches);
+  }
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches)
+  {
+    return false;
+  }
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint)
+  {
+    EnsureSubresource(sliceFace, mip);
+    return m_Proxy->SetTextureDiffInput(input, m_TextureID, sliceFace, mip, sample, typeHint);
+  }
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result)
+  {
+    return m_Proxy->DiffTextureInputs(threshold, result);
+  }
   bool RenderTexture(TextureDisplay cfg)
   {
     cfg.texid = m_TextureID;
+    EnsureSubresource(cfg.sliceFace, cfg.mip);
     return m_Proxy->RenderTexture(cfg);
   }
+  bool HasPendingTextureData() { return false; }
+  vector<ProxyCommandStats> GetProxyStats() { return vector<ProxyCommandStats>(); }
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total)
+  {
+    return false;
+  }
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total)
+  {
+    return false;
+  }
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace, uint32_t mip,
                  uint32_t sample, FormatComponentType typeHint, float pixel[4])
   {
+    EnsureSubresource(sliceFace, mip);
     m_Proxy->PickPixel(m_TextureID, x, y, sliceFace, mip, sample, typeHint, pixel);
   }
   uint32_t PickVertex(uint32_t eventID, const MeshDisplay &cfg, uint32_t x, uint32_t y)
   {
     return m_Proxy->PickVertex(eventID, cfg, x, y);
   }
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+    m_Proxy->PrecompileCustomShader(source, entry, compileFlags, type);
+  }
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors)
   {
@@ -134,6 +181,7 @@ public:
   ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, uint32_t mip, uint32_t arrayIdx,
                                uint32_t sampleIdx, FormatComponentType typeHint)
   {
+    EnsureSubresource(arrayIdx, mip);
     return m_Proxy->ApplyCustomShader(shader, m_TextureID, mip, arrayIdx, sampleIdx, typeHint);
   }
   vector<ResourceId> GetTextures() { return m_Proxy->GetTextures(); }
@@ -141,6 +189,7 @@ public:
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize)
   {
+    EnsureSubresource(arrayIdx, mip);
     return m_Proxy->GetTextureData(m_TextureID, arrayIdx, mip, params, dataSize);
   }
 
@@ -185,6 +234,10 @@ public:
   {
   }
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData) {}
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData)
+  {
+    retData.resize(ranges.size());
+  }
   void InitPostVSBuffers(uint32_t eventID) {}
   void InitPostVSBuffers(const vector<uint32_t> &eventID) {}
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
@@ -230,6 +283,10 @@ public:
     RDCEraseEl(ret);
     return ret;
   }
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+  }
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors)
   {
@@ -255,14 +312,22 @@ public:
     return ResourceId();
   }
 
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize)
   {
     RDCERR("Calling proxy-render functions on an image viewer");
   }
 
   void FileChanged() { RefreshFile(); }
+  vector<ReplayMemoryStats> GetMemoryStats() { return m_Proxy->GetMemoryStats(); }
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
+  {
+    m_Proxy->TrimMemory(category, budget, eventID);
+  }
+
 private:
   void RefreshFile();
+  void EnsureSubresource(uint32_t slice, uint32_t mip);
+  void ReleaseDDS();
 
   APIProperties m_Props;
   FetchFrameRecord m_FrameRecord;
@@ -271,8 +336,39 @@ private:
   string m_Filename;
   ResourceId m_TextureID;
   FetchTexture m_TexDetails;
+
+  // DDS subresources are only uploaded to the proxy texture the first time they're
+  // displayed or read, straight out of a mapping of the file. Large arrays and mip chains
+  // then only cost what's actually looked at.
+  dds_data m_DDS;
+  void *m_DDSMapping;
+  vector<uint64_t> m_DDSOffsets;
+  vector<bool> m_DDSUploaded;
 };
 
+// maps the whole file if possible, otherwise reads it into buffer. mapping is set to the handle
+// to pass to FileIO::UnmapFileRange, or NULL if the file was read.
+static byte *MapOrReadFile(FILE *f, std::vector<byte> &buffer, void **mapping)
+{
+  FileIO::fseek64(f, 0, SEEK_END);
+  uint64_t size = FileIO::ftell64(f);
+  FileIO::fseek64(f, 0, SEEK_SET);
+
+  *mapping = NULL;
+
+  byte *ret = (byte *)FileIO::MapFileRange(f, 0, size, mapping);
+
+  if(ret)
+    return ret;
+
+  *mapping = NULL;
+
+  buffer.resize((size_t)size);
+  FileIO::fread(&buffer[0], 1, buffer.size(), f);
+
+  return &buffer[0];
+}
+
 ReplayCreateStatus IMG_CreateReplayDevice(const char *logfile, IReplayDriver **driver)
 {
   FILE *f = FileIO::fopen(logfile, "rb");
@@ -285,22 +381,19 @@ ReplayCreateStatus IMG_CreateReplayDevice(const char *logfile, IReplayDriver **d
   {
     const char *err = NULL;
 
-    FileIO::fseek64(f, 0, SEEK_END);
-    uint64_t size = FileIO::ftell64(f);
-    FileIO::fseek64(f, 0, SEEK_SET);
-
     std::vector<byte> buffer;
-    buffer.resize((size_t)size);
-
-    FileIO::fread(&buffer[0], 1, buffer.size(), f);
+    void *mapping = NULL;
+    byte *filedata = MapOrReadFile(f, buffer, &mapping);
 
     EXRImage exrImage;
     InitEXRImage(&exrImage);
 
-    int ret = ParseMultiChannelEXRHeaderFromMemory(&exrImage, &buffer[0], &err);
+    int ret = ParseMultiChannelEXRHeaderFromMemory(&exrImage, filedata, &err);
 
     FreeEXRImage(&exrImage);
 
+    FileIO::UnmapFileRange(mapping);
+
     // could be an unsupported form of EXR, like deep image or other
     if(ret != 0)
     {
@@ -330,20 +423,16 @@ ReplayCreateStatus IMG_CreateReplayDevice(const char *logfile, IReplayDriver **d
   }
   else if(is_dds_file(f))
   {
-    FileIO::fseek64(f, 0, SEEK_SET);
-    dds_data read_data = load_dds_from_file(f);
+    uint64_t dataOffset = 0;
+    dds_data read_data = load_dds_header_from_file(f, dataOffset);
 
-    if(read_data.subdata == NULL)
+    if(read_data.subsizes == NULL)
     {
       FileIO::fclose(f);
       RDCERR("DDS file recognised, but couldn't load");
       return eReplayCreate_ImageUnsupported;
     }
 
-    for(int i = 0; i < read_data.slices * read_data.mips; i++)
-      delete[] read_data.subdata[i];
-
-    delete[] read_data.subdata;
     delete[] read_data.subsizes;
   }
   else
@@ -407,6 +496,9 @@ void ImageViewer::RefreshFile()
     return;
   }
 
+  // the file has changed, so any previous mapping and uploads are stale
+  ReleaseDDS();
+
   FetchTexture texDetails;
 
   ResourceFormat rgba8_unorm;
@@ -446,24 +538,21 @@ void ImageViewer::RefreshFile()
   {
     texDetails.format = rgba32_float;
 
-    FileIO::fseek64(f, 0, SEEK_END);
-    uint64_t size = FileIO::ftell64(f);
-    FileIO::fseek64(f, 0, SEEK_SET);
-
+    // tinyexr can only decode from memory, so map the file rather than copying it all in
     std::vector<byte> buffer;
-    buffer.resize((size_t)size);
-
-    FileIO::fread(&buffer[0], 1, buffer.size(), f);
+    void *mapping = NULL;
+    byte *filedata = MapOrReadFile(f, buffer, &mapping);
 
     EXRImage exrImage;
     InitEXRImage(&exrImage);
 
     const char *err = NULL;
 
-    int ret = ParseMultiChannelEXRHeaderFromMemory(&exrImage, &buffer[0], &err);
+    int ret = ParseMultiChannelEXRHeaderFromMemory(&exrImage, filedata, &err);
 
     if(ret != 0)
     {
+      FileIO::UnmapFileRange(mapping);
       RDCERR(
           "EXR file detected, but couldn't load with ParseMultiChannelEXRHeaderFromMemory %d: '%s'",
           ret, err);
@@ -480,7 +569,9 @@ void ImageViewer::RefreshFile()
     for(int i = 0; i < exrImage.num_channels; i++)
       exrImage.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
 
-    ret = LoadMultiChannelEXRFromMemory(&exrImage, &buffer[0], &err);
+    ret = LoadMultiChannelEXRFromMemory(&exrImage, filedata, &err);
+
+    FileIO::UnmapFileRange(mapping);
 
     int channels[4] = {-1, -1, -1, -1};
     for(int i = 0; i < exrImage.num_channels; i++)
@@ -568,19 +659,31 @@ void ImageViewer::RefreshFile()
   m_FrameRecord.frameInfo.persistentSize = 0;
   m_FrameRecord.frameInfo.uncompressedFileSize = datasize;
 
-  dds_data read_data = {0};
-
   if(dds)
   {
-    FileIO::fseek64(f, 0, SEEK_SET);
-    read_data = load_dds_from_file(f);
+    uint64_t dataOffset = 0;
+    m_DDS = map_dds_from_file(f, dataOffset, &m_DDSMapping);
 
-    if(read_data.subdata == NULL)
+    if(m_DDS.subsizes == NULL)
     {
       FileIO::fclose(f);
       return;
     }
 
+    dds_data &read_data = m_DDS;
+
+    uint32_t numSubs = uint32_t(read_data.slices * read_data.mips);
+
+    // if the file couldn't be mapped, each subresource is read when it's needed instead
+    m_DDSOffsets.resize(numSubs);
+    m_DDSUploaded.assign(numSubs, false);
+
+    for(uint32_t i = 0; i < numSubs; i++)
+    {
+      m_DDSOffsets[i] = dataOffset;
+      dataOffset += read_data.subsizes[i];
+    }
+
     texDetails.cubemap = read_data.cubemap;
     texDetails.arraysize = read_data.slices;
     texDetails.width = read_data.width;
@@ -596,7 +699,7 @@ void ImageViewer::RefreshFile()
 
     m_FrameRecord.frameInfo.uncompressedFileSize = 0;
     for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
-      m_FrameRecord.frameInfo.uncompressedFileSize += read_data.subsizes[i];
+      m_FrameRecord.frameInfo.uncompressedFileSize += m_DDS.subsizes[i];
   }
 
   m_FrameRecord.frameInfo.compressedFileSize = m_FrameRecord.frameInfo.uncompressedFileSize;
@@ -621,24 +724,74 @@ void ImageViewer::RefreshFile()
   if(m_TextureID == ResourceId())
     m_TextureID = m_Proxy->CreateProxyTexture(texDetails);
 
+  m_TexDetails = texDetails;
+  m_TexDetails.ID = m_TextureID;
+
+  // DDS data is uploaded per-subresource on demand by EnsureSubresource
   if(!dds)
   {
     m_Proxy->SetProxyTextureData(m_TextureID, 0, 0, data, datasize);
     free(data);
   }
-  else
+
+  FileIO::fclose(f);
+}
+
+void ImageViewer::EnsureSubresource(uint32_t slice, uint32_t mip)
+{
+  if(m_DDSUploaded.empty())
+    return;
+
+  // 3D textures only have one slice, sliceFace selects a depth slice within the mip
+  if(m_TexDetails.depth > 1)
+    slice = 0;
+
+  slice = RDCMIN(slice, m_TexDetails.arraysize - 1);
+  mip = RDCMIN(mip, m_TexDetails.mips - 1);
+
+  uint32_t sub = slice * m_TexDetails.mips + mip;
+
+  if(m_DDSUploaded[sub])
+    return;
+
+  m_DDSUploaded[sub] = true;
+
+  if(m_DDS.subdata)
   {
-    for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
-    {
-      m_Proxy->SetProxyTextureData(m_TextureID, i / texDetails.mips, i % texDetails.mips,
-                                   read_data.subdata[i], (size_t)read_data.subsizes[i]);
+    m_Proxy->SetProxyTextureData(m_TextureID, slice, mip, m_DDS.subdata[sub],
+                                 (size_t)m_DDS.subsizes[sub]);
+    return;
+  }
 
-      delete[] read_data.subdata[i];
-    }
+  FILE *f = FileIO::fopen(m_Filename.c_str(), "rb");
 
-    delete[] read_data.subdata;
-    delete[] read_data.subsizes;
+  if(!f)
+  {
+    RDCERR("Couldn't open %s to read slice %u mip %u", m_Filename.c_str(), slice, mip);
+    return;
   }
 
+  vector<byte> data(m_DDS.subsizes[sub]);
+
+  FileIO::fseek64(f, m_DDSOffsets[sub], SEEK_SET);
+  FileIO::fread(&data[0], 1, data.size(), f);
+
   FileIO::fclose(f);
+
+  m_Proxy->SetProxyTextureData(m_TextureID, slice, mip, &data[0], data.size());
+}
+
+void ImageViewer::ReleaseDDS()
+{
+  FileIO::UnmapFileRange(m_DDSMapping);
+
+  // subdata points into the mapping, so only the arrays themselves are ours
+  delete[] m_DDS.subdata;
+  delete[] m_DDS.subsizes;
+
+  RDCEraseEl(m_DDS);
+  m_DDSMapping = NULL;
+
+  m_DDSOffsets.clear();
+  m_DDSUploaded.clear();
 }
@@ -69,7 +69,7 @@ void Serialiser::Serialise(const char *name, Process::EnvironmentModification &e
   Serialise("value", el.value);
 }
 
-static const uint32_t RemoteServerProtocolVersion = 1;
+static const uint32_t RemoteServerProtocolVersion = 10;
 
 enum RemoteServerPacket
 {
@@ -127,12 +127,20 @@ static void ProgressTicker(void *d)
 struct ClientThread
 {
   ClientThread()
-      : socket(NULL), allowExecution(false), killThread(false), killServer(false), thread(0)
+      : socket(NULL),
+        sessionId(0),
+        allowExecution(false),
+        killThread(false),
+        killServer(false),
+        thread(0)
   {
   }
 
   Network::Socket *socket;
 
+  // unique per active session, used to keep each session's temporary files separate
+  uint32_t sessionId;
+
   bool allowExecution;
   bool killThread;
   bool killServer;
@@ -140,6 +148,11 @@ struct ClientThread
   Threading::ThreadHandle thread;
 };
 
+// creating a replay driver goes through process-global state (e.g. the progress pointer), so
+// sessions opening captures at the same time take turns. Once the driver exists each session
+// replays on its own device independently.
+static Threading::CriticalSection logOpenLock;
+
 static void InactiveRemoteClientThread(void *data)
 {
   ClientThread *threadData = (ClientThread *)data;
@@ -314,18 +327,26 @@ static void ActiveRemoteClientThread(void *data)
       }
       else if(type == eRemoteServer_CopyCaptureToRemote)
       {
+        string key;
+        recvser->Serialise("key", key);
+
         string cap_file;
         string dummy, dummy2;
         FileIO::GetDefaultFiles("remotecopy", cap_file, dummy, dummy2);
 
+        // name the copy after the client and its file so that retrying an interrupted copy lands
+        // on the same file and resumes from what was already received.
+        cap_file = dirname(cap_file) + "/" +
+                   StringFormat::Fmt("remotecopy_%08x_%s.rdc", ip, key.c_str());
+
         Serialiser *fileRecv = NULL;
 
         RDCLOG("Copying file to local path '%s'.", cap_file.c_str());
 
         if(!RecvChunkedFile(client, type, cap_file.c_str(), fileRecv, NULL))
         {
-          FileIO::Delete(cap_file.c_str());
-
+          // the partial file is kept, everything in it has been verified and a retry will
+          // continue from there.
           RDCERR("Network error receiving file");
 
           SAFE_DELETE(fileRecv);
@@ -379,6 +400,8 @@ static void ActiveRemoteClientThread(void *data)
         }
         else if(RenderDoc::Inst().HasRemoteDriver(driverType))
         {
+          SCOPED_LOCK(logOpenLock);
+
           ProgressLoopData progressData;
 
           progressData.sock = client;
@@ -511,6 +534,11 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
   std::vector<std::pair<uint32_t, uint32_t> > listenRanges;
   bool allowExecution = true;
 
+  // by default only one session is served at once, any other client is told we're busy.
+  uint32_t maxSessions = 1;
+  uint64_t gpuMemoryMB = 0;
+  uint64_t sessionMemoryMB = 1024;
+
   FILE *f = FileIO::fopen(FileIO::GetAppFolderFilename("remoteserver.conf").c_str(), "r");
 
   while(f && !FileIO::feof(f))
@@ -549,6 +577,24 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
 
       continue;
     }
+    else if(line.substr(0, sizeof("maxsessions") - 1) == "maxsessions")
+    {
+      maxSessions = (uint32_t)atoi(line.c_str() + sizeof("maxsessions") - 1);
+
+      continue;
+    }
+    else if(line.substr(0, sizeof("gpumemory") - 1) == "gpumemory")
+    {
+      gpuMemoryMB = (uint64_t)atoi(line.c_str() + sizeof("gpumemory") - 1);
+
+      continue;
+    }
+    else if(line.substr(0, sizeof("sessionmemory") - 1) == "sessionmemory")
+    {
+      sessionMemoryMB = (uint64_t)atoi(line.c_str() + sizeof("sessionmemory") - 1);
+
+      continue;
+    }
 
     RDCLOG("Malformed line '%s'. See documentation for file format.", line.c_str());
   }
@@ -585,9 +631,26 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
   else
     RDCLOG("Blocking execution commands");
 
+  // each session replays on its own device, so if a GPU memory budget is given only allow as
+  // many sessions as fit in it.
+  if(gpuMemoryMB > 0 && sessionMemoryMB > 0)
+  {
+    uint32_t budgetSessions = (uint32_t)RDCMAX((uint64_t)1, gpuMemoryMB / sessionMemoryMB);
+
+    RDCLOG("GPU memory budget of %llu MB allows %u sessions of %llu MB", gpuMemoryMB,
+           budgetSessions, sessionMemoryMB);
+
+    maxSessions = RDCMIN(maxSessions, budgetSessions);
+  }
+
+  maxSessions = RDCMAX(1U, maxSessions);
+
+  RDCLOG("Allowing up to %u concurrent sessions", maxSessions);
+
   RDCLOG("Replay host ready for requests...");
 
-  ClientThread *activeClientData = NULL;
+  std::vector<ClientThread *> actives;
+  uint32_t nextSessionId = 0;
 
   std::vector<ClientThread *> inactives;
 
@@ -595,7 +658,11 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
   {
     Network::Socket *client = sock->AcceptClient(false);
 
-    if(activeClientData && activeClientData->killServer)
+    bool killServer = false;
+    for(size_t i = 0; i < actives.size(); i++)
+      killServer |= actives[i]->killServer;
+
+    if(killServer)
       break;
 
     // reap any dead inactive threads
@@ -611,14 +678,17 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
       }
     }
 
-    // reap our active connection possibly
-    if(activeClientData && activeClientData->socket == NULL)
+    // reap any finished active sessions
+    for(size_t i = 0; i < actives.size(); i++)
     {
-      Threading::JoinThread(activeClientData->thread);
-      Threading::CloseThread(activeClientData->thread);
-
-      delete activeClientData;
-      activeClientData = NULL;
+      if(actives[i]->socket == NULL)
+      {
+        Threading::JoinThread(actives[i]->thread);
+        Threading::CloseThread(actives[i]->thread);
+        delete actives[i];
+        actives.erase(actives.begin() + i);
+        break;
+      }
     }
 
     if(client == NULL)
@@ -662,15 +732,19 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
       continue;
     }
 
-    if(activeClientData == NULL)
+    if(actives.size() < maxSessions)
     {
-      activeClientData = new ClientThread();
-      activeClientData->socket = client;
-      activeClientData->allowExecution = allowExecution;
+      ClientThread *active = new ClientThread();
+      active->socket = client;
+      active->sessionId = nextSessionId++;
+      active->allowExecution = allowExecution;
+
+      active->thread = Threading::CreateThread(ActiveRemoteClientThread, active);
 
-      activeClientData->thread = Threading::CreateThread(ActiveRemoteClientThread, activeClientData);
+      actives.push_back(active);
 
-      RDCLOG("Making active connection");
+      RDCLOG("Making active connection (%u of %u sessions)", (uint32_t)actives.size(),
+             maxSessions);
     }
     else
     {
@@ -686,14 +760,15 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
     }
   }
 
-  if(activeClientData && activeClientData->socket != NULL)
-  {
-    activeClientData->killThread = true;
-
-    Threading::JoinThread(activeClientData->thread);
-    Threading::CloseThread(activeClientData->thread);
+  // shut down active sessions
+  for(size_t i = 0; i < actives.size(); i++)
+    actives[i]->killThread = true;
 
-    delete activeClientData;
+  for(size_t i = 0; i < actives.size(); i++)
+  {
+    Threading::JoinThread(actives[i]->thread);
+    Threading::CloseThread(actives[i]->thread);
+    delete actives[i];
   }
 
   // shut down client threads
@@ -977,7 +1052,12 @@ public:
 
   rdctype::str CopyCaptureToRemote(const char *filename, float *progress)
   {
+    // identifies this file to the server, so a repeated copy of the same file can resume
+    string key = StringFormat::Fmt("%08x%08x", strhash(filename),
+                                   (uint32_t)FileIO::GetModifiedTimestamp(filename));
+
     Serialiser sendData("", Serialiser::WRITING, false);
+    sendData.Serialise("key", key);
     Send(eRemoteServer_CopyCaptureToRemote, sendData);
 
     float dummy = 0.0f;
@@ -25,6 +25,10 @@
 
 #include "replay_proxy.h"
 #include "lz4/lz4.h"
+#include "common/hash_map.h"
+#include "common/timing.h"
+#include "core/resource_manager.h"
+#include "maths/formatpacking.h"
 
 // these functions do compile time asserts on the size of the structure, to
 // help prevent the structure changing without these functions being updated.
@@ -276,6 +280,58 @@ void Serialiser::Serialise(const char *name, ShaderDebugState &el)
   SIZE_CHECK(56);
 }
 
+// a full state is sent at least this often, with the states between sent as deltas
+#define SHADER_DEBUG_KEYFRAME_INTERVAL 256
+
+// index 0 is the registers, 1 the outputs and 2 onwards each indexable temp array
+static rdctype::array<ShaderVariable> *GetShaderDebugVars(ShaderDebugState &state, uint32_t group)
+{
+  if(group == 0)
+    return &state.registers;
+  if(group == 1)
+    return &state.outputs;
+  if(group - 2 < (uint32_t)state.indexableTemps.count)
+    return &state.indexableTemps[group - 2];
+  return NULL;
+}
+
+// deltas only contain the type, column count and first four values of a variable, so anything
+// else changing (or a different register layout) needs a full state
+static bool CanDeltaShaderDebugVars(const rdctype::array<ShaderVariable> &prev,
+                                    const rdctype::array<ShaderVariable> &cur)
+{
+  if(prev.count != cur.count)
+    return false;
+
+  for(int32_t i = 0; i < cur.count; i++)
+  {
+    const ShaderVariable &a = prev[i];
+    const ShaderVariable &b = cur[i];
+
+    if(b.rows > 1 || b.columns > 4 || a.rows != b.rows || a.isStruct || b.isStruct ||
+       a.members.count > 0 || b.members.count > 0 || a.displayAsHex != b.displayAsHex ||
+       strcmp(a.name.c_str(), b.name.c_str()) ||
+       memcmp(&a.value.uv[4], &b.value.uv[4], sizeof(uint32_t) * 12))
+      return false;
+  }
+
+  return true;
+}
+
+static bool CanDeltaShaderDebugState(const ShaderDebugState &prev, const ShaderDebugState &cur)
+{
+  if(!CanDeltaShaderDebugVars(prev.registers, cur.registers) ||
+     !CanDeltaShaderDebugVars(prev.outputs, cur.outputs) ||
+     prev.indexableTemps.count != cur.indexableTemps.count)
+    return false;
+
+  for(int32_t i = 0; i < cur.indexableTemps.count; i++)
+    if(!CanDeltaShaderDebugVars(prev.indexableTemps[i], cur.indexableTemps[i]))
+      return false;
+
+  return true;
+}
+
 template <>
 void Serialiser::Serialise(const char *name, ShaderDebugTrace &el)
 {
@@ -290,7 +346,78 @@ void Serialiser::Serialise(const char *name, ShaderDebugTrace &el)
   for(int32_t i = 0; i < numcbuffers; i++)
     Serialise("", el.cbuffers[i]);
 
-  Serialise("", el.states);
+  // consecutive states usually only differ by one or two registers, so rather than sending a
+  // full copy of every register for every step we send a full keyframe periodically and the
+  // changed variables for each step in between. The states are expanded again on read.
+  int32_t numstates = el.states.count;
+  Serialise("", numstates);
+
+  if(m_Mode == READING)
+    create_array_uninit(el.states, numstates);
+
+  for(int32_t i = 0; i < numstates; i++)
+  {
+    ShaderDebugState &state = el.states[i];
+
+    bool keyframe = (i % SHADER_DEBUG_KEYFRAME_INTERVAL) == 0;
+
+    if(m_Mode == WRITING && !keyframe)
+      keyframe = !CanDeltaShaderDebugState(el.states[i - 1], state);
+
+    Serialise("", keyframe);
+
+    if(keyframe)
+    {
+      Serialise("", state);
+      continue;
+    }
+
+    ShaderDebugState &prev = el.states[i - 1];
+
+    if(m_Mode == READING)
+      state = prev;
+
+    Serialise("", state.nextInstruction);
+    Serialise("", state.flags);
+
+    // each change is the group (see GetShaderDebugVars) and index of the variable
+    vector<pair<uint32_t, uint32_t> > changes;
+
+    if(m_Mode == WRITING)
+    {
+      for(uint32_t group = 0; group < 2 + (uint32_t)state.indexableTemps.count; group++)
+      {
+        rdctype::array<ShaderVariable> &prevVars = *GetShaderDebugVars(prev, group);
+        rdctype::array<ShaderVariable> &curVars = *GetShaderDebugVars(state, group);
+
+        for(int32_t v = 0; v < curVars.count; v++)
+        {
+          if(prevVars[v].type != curVars[v].type || prevVars[v].columns != curVars[v].columns ||
+             memcmp(prevVars[v].value.uv, curVars[v].value.uv, sizeof(uint32_t) * 4))
+            changes.push_back(std::make_pair(group, (uint32_t)v));
+        }
+      }
+    }
+
+    Serialise("", changes);
+
+    for(size_t c = 0; c < changes.size(); c++)
+    {
+      rdctype::array<ShaderVariable> *vars = GetShaderDebugVars(state, changes[c].first);
+
+      ShaderVariable dummy;
+      ShaderVariable *var = &dummy;
+
+      if(vars && changes[c].second < (uint32_t)vars->count)
+        var = &(*vars)[changes[c].second];
+      else
+        RDCERR("Invalid shader debug state delta %u %u", changes[c].first, changes[c].second);
+
+      Serialise("", var->type);
+      Serialise("", var->columns);
+      SerialisePODArray<4>("", var->value.uv);
+    }
+  }
 
   SIZE_CHECK(48);
 }
@@ -1320,6 +1447,32 @@ void Serialiser::Serialise(const char *name, DebugMessage &el)
   SIZE_CHECK(40);
 }
 
+template <>
+void Serialiser::Serialise(const char *name, ReplayMemoryStats &el)
+{
+  Serialise("", el.category);
+  Serialise("", el.remote);
+  Serialise("", el.gpuBytes);
+  Serialise("", el.cpuBytes);
+  Serialise("", el.budget);
+
+  SIZE_CHECK(32);
+}
+
+template <>
+void Serialiser::Serialise(const char *name, ResourceQuery &el)
+{
+  Serialise("", el.resType);
+  Serialise("", el.creationFlags);
+  Serialise("", el.name);
+  Serialise("", el.firstEvent);
+  Serialise("", el.lastEvent);
+  Serialise("", el.first);
+  Serialise("", el.count);
+
+  SIZE_CHECK(40);
+}
+
 template <>
 void Serialiser::Serialise(const char *name, FetchAPIEvent &el)
 {
@@ -1732,6 +1885,11 @@ string ToStrHelper<false, MeshDataStage>::Get(const MeshDataStage &el)
   return "<...>";
 }
 template <>
+string ToStrHelper<false, ReplayMemoryCategory>::Get(const ReplayMemoryCategory &el)
+{
+  return "<...>";
+}
+template <>
 string ToStrHelper<false, TextureDisplayOverlay>::Get(const TextureDisplayOverlay &el)
 {
   return "<...>";
@@ -1942,6 +2100,7 @@ string ToStrHelper<false, FloatVector>::Get(const FloatVector &el)
 ReplayProxy::~ReplayProxy()
 {
   SAFE_DELETE(m_FromReplaySerialiser);
+  SAFE_DELETE(m_DeferredCommands);
   m_ToReplaySerialiser = NULL;    // we don't own this
 
   if(m_Proxy)
@@ -1952,176 +2111,1298 @@ ReplayProxy::~ReplayProxy()
     delete it->second;
 }
 
+void ReplayProxy::AppendCommand(Serialiser &batch, ReplayProxyPacket type)
+{
+  uint32_t t = (uint32_t)type;
+  uint32_t length = (uint32_t)m_ToReplaySerialiser->GetOffset();
+
+  batch.Serialise("", t);
+  batch.Serialise("", length);
+  if(length > 0)
+    batch.RawWriteBytes(m_ToReplaySerialiser->GetRawPtr(0), length);
+
+  m_ToReplaySerialiser->Rewind();
+
+  CommandStats *stats = GetCommandStats(t);
+  if(stats)
+  {
+    stats->count++;
+    stats->bytesSent += sizeof(t) + sizeof(length) + length;
+  }
+}
+
+// Commands that have no reply don't need their own round-trip. They're held back and sent in the
+// same packet as the next command that does need a reply, which the remote side processes in
+// order. Only commands that write nothing to the reply serialiser on the remote side can be
+// deferred.
+void ReplayProxy::DeferReplayCommand(ReplayProxyPacket type)
+{
+  AppendCommand(*m_DeferredCommands, type);
+}
+
 bool ReplayProxy::SendReplayCommand(ReplayProxyPacket type)
 {
   if(!m_Socket->Connected())
     return false;
 
-  if(!SendPacket(m_Socket, type, *m_ToReplaySerialiser))
-    return false;
+  // the round trip, including the time spent on the remote side
+  string traceName = ToStr::Get(type);
+  SCOPED_TRACE(traceName.c_str());
 
-  m_ToReplaySerialiser->Rewind();
+  PerformanceTimer timer;
+
+  CommandStats *stats = GetCommandStats(type);
+
+  if(m_DeferredCommands->GetOffset() > 0)
+  {
+    AppendCommand(*m_DeferredCommands, type);
+
+    bool success = SendPacket(m_Socket, eReplayProxy_Batch, *m_DeferredCommands);
+
+    m_DeferredCommands->Rewind();
+
+    if(!success)
+      return false;
+  }
+  else
+  {
+    if(stats)
+    {
+      stats->count++;
+      stats->bytesSent += sizeof(uint32_t) * 2 + m_ToReplaySerialiser->GetOffset();
+    }
+
+    if(!SendPacket(m_Socket, type, *m_ToReplaySerialiser))
+      return false;
+
+    m_ToReplaySerialiser->Rewind();
+  }
 
   SAFE_DELETE(m_FromReplaySerialiser);
 
-  if(!RecvPacket(m_Socket, type, &m_FromReplaySerialiser))
-    return false;
+  ReplayProxyPacket replyType = type;
 
-  return true;
-}
+  if(!RecvPacket(m_Socket, replyType, &m_FromReplaySerialiser))
+    return false;
 
-template <>
-string ToStrHelper<false, RemapTextureEnum>::Get(const RemapTextureEnum &el)
-{
-  switch(el)
+  if(stats)
   {
-    TOSTR_CASE_STRINGIZE(eRemap_None)
-    TOSTR_CASE_STRINGIZE(eRemap_RGBA8)
-    TOSTR_CASE_STRINGIZE(eRemap_RGBA16)
-    TOSTR_CASE_STRINGIZE(eRemap_RGBA32)
-    TOSTR_CASE_STRINGIZE(eRemap_D32S8)
-    default: break;
+    double latency = timer.GetMilliseconds();
+
+    stats->bytesReceived += sizeof(uint32_t) * 2 + m_FromReplaySerialiser->GetSize();
+    stats->totalLatency += latency;
+    stats->maxLatency = RDCMAX(stats->maxLatency, latency);
   }
 
-  return StringFormat::Fmt("RemapTextureEnum<%d>", el);
+  return true;
 }
 
-// If a remap is required, modify the params that are used when getting the proxy texture data
-// for replay on the current driver.
-void ReplayProxy::RemapProxyTextureIfNeeded(ResourceFormat &format, GetTextureDataParams &params)
+vector<ProxyCommandStats> ReplayProxy::GetProxyStats()
 {
-  if(m_Proxy->IsTextureSupported(format))
-    return;
+  vector<double> remoteTimes;
 
-  if(format.special)
+  if(m_RemoteServer)
   {
-    switch(format.specialFormat)
-    {
-      case eSpecial_S8:
-      case eSpecial_D16S8: params.remap = eRemap_D32S8; break;
-      case eSpecial_ASTC:
-      case eSpecial_EAC:
-      case eSpecial_R5G6B5:
-      case eSpecial_ETC2: params.remap = eRemap_RGBA8; break;
-      default:
-        RDCERR("Don't know how to remap special format %u, falling back to RGBA32");
-        params.remap = eRemap_RGBA32;
-        break;
-    }
-    format.special = false;
+    for(uint32_t i = eReplayProxy_First; i < eReplayProxy_Count; i++)
+      remoteTimes.push_back(GetCommandStats(i)->remoteTime);
   }
   else
   {
-    if(format.compByteWidth == 4)
-      params.remap = eRemap_RGBA32;
-    else if(format.compByteWidth == 2)
-      params.remap = eRemap_RGBA16;
-    else if(format.compByteWidth == 1)
-      params.remap = eRemap_RGBA8;
+    if(!SendReplayCommand(eReplayProxy_GetProxyStats))
+      return vector<ProxyCommandStats>();
   }
 
-  switch(params.remap)
+  m_FromReplaySerialiser->Serialise("", remoteTimes);
+
+  vector<ProxyCommandStats> ret;
+
+  if(m_RemoteServer)
+    return ret;
+
+  for(uint32_t i = eReplayProxy_First; i < eReplayProxy_Count; i++)
   {
-    case eRemap_None: RDCERR("IsTextureSupported == false, but we have no remap"); break;
-    case eRemap_RGBA8:
-      format.compCount = 4;
-      format.compByteWidth = 1;
-      format.compType = eCompType_UNorm;
-      // Range adaptation is only needed when remapping a higher precision format down to RGBA8.
-      params.whitePoint = 1.0f;
-      break;
-    case eRemap_RGBA16:
-      format.compCount = 4;
-      format.compByteWidth = 2;
-      format.compType = eCompType_UNorm;
-      break;
-    case eRemap_RGBA32:
-      format.compCount = 4;
-      format.compByteWidth = 4;
-      format.compType = eCompType_Float;
-      break;
-    case eRemap_D32S8: RDCERR("Remapping depth/stencil formats not implemented."); break;
+    const CommandStats &stats = *GetCommandStats(i);
+
+    if(stats.count == 0)
+      continue;
+
+    ProxyCommandStats s;
+
+    // strip the common prefix for display
+    string name = ToStr::Get((ReplayProxyPacket)i);
+    if(name.find("eReplayProxy_") == 0)
+      name = name.substr(sizeof("eReplayProxy_") - 1);
+
+    s.name = name;
+    s.count = stats.count;
+    s.bytesSent = stats.bytesSent;
+    s.bytesReceived = stats.bytesReceived;
+    s.totalLatency = stats.totalLatency;
+    s.maxLatency = stats.maxLatency;
+    s.remoteTime = 0.0;
+
+    size_t idx = i - eReplayProxy_First;
+    if(idx < remoteTimes.size())
+      s.remoteTime = remoteTimes[idx];
+
+    ret.push_back(s);
   }
+
+  return ret;
 }
 
-void ReplayProxy::EnsureTexCached(ResourceId texid, uint32_t arrayIdx, uint32_t mip)
+vector<ReplayMemoryStats> ReplayProxy::GetMemoryStats()
 {
-  if(!m_Socket->Connected())
-    return;
+  vector<ReplayMemoryStats> ret;
 
-  TextureCacheEntry entry = {texid, arrayIdx, mip};
+  if(m_RemoteServer)
+  {
+    ret = m_Remote->GetMemoryStats();
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetMemoryStats))
+      return ret;
+  }
 
-  if(m_LocalTextures.find(texid) != m_LocalTextures.end())
-    return;
+  m_FromReplaySerialiser->Serialise("", ret);
 
-  if(m_TextureProxyCache.find(entry) == m_TextureProxyCache.end())
-  {
-    if(m_ProxyTextures.find(texid) == m_ProxyTextures.end())
-    {
-      FetchTexture tex = GetTexture(texid);
+  if(m_RemoteServer)
+    return ret;
 
-      ProxyTextureProperties proxy;
-      RemapProxyTextureIfNeeded(tex.format, proxy.params);
+  for(size_t i = 0; i < ret.size(); i++)
+    ret[i].remote = true;
 
-      proxy.id = m_Proxy->CreateProxyTexture(tex);
-      m_ProxyTextures[texid] = proxy;
+  // the local replay only renders, so anything it has is reported as-is
+  vector<ReplayMemoryStats> local = m_Proxy->GetMemoryStats();
+
+  ReplayMemoryStats proxy = {};
+  proxy.category = eReplayMemory_ProxyResources;
+
+  for(size_t i = 0; i < local.size(); i++)
+  {
+    if(local[i].category == eReplayMemory_ProxyResources)
+      proxy = local[i];
+    else
+      ret.push_back(local[i]);
+  }
+
+  // the local drivers don't track the proxy textures and buffers they create for us, so if they
+  // don't know, estimate them from the descriptions
+  if(proxy.gpuBytes == 0)
+  {
+    for(auto it = m_ProxyTextures.begin(); it != m_ProxyTextures.end(); ++it)
+    {
+      auto desc = m_TextureDescs.find(it->first);
+      if(desc != m_TextureDescs.end())
+        proxy.gpuBytes += desc->second.byteSize;
     }
 
-    const ProxyTextureProperties &proxy = m_ProxyTextures[texid];
+    for(auto it = m_BufferCaches.begin(); it != m_BufferCaches.end(); ++it)
+      proxy.gpuBytes += it->second.length;
+  }
 
-    size_t size;
-    byte *data = GetTextureData(texid, arrayIdx, mip, proxy.params, size);
+  // and the copies of remote data kept to send deltas
+  proxy.cpuBytes += m_BufferCacheBytes;
 
-    if(data)
-      m_Proxy->SetProxyTextureData(proxy.id, arrayIdx, mip, data, size);
+  for(auto it = m_TextureDataCache.begin(); it != m_TextureDataCache.end(); ++it)
+    proxy.cpuBytes += it->second.size();
 
-    delete[] data;
+  for(auto it = m_ProgressiveTextures.begin(); it != m_ProgressiveTextures.end(); ++it)
+    proxy.cpuBytes += it->second.data.size();
 
-    m_TextureProxyCache.insert(entry);
-  }
+  ret.push_back(proxy);
+
+  return ret;
 }
 
-void ReplayProxy::EnsureBufCached(ResourceId bufid)
+void ReplayProxy::TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
 {
-  if(!m_Socket->Connected())
+  // our own caches are trimmed here, everything else lives on the remote side
+  if(!m_RemoteServer && category == eReplayMemory_ProxyResources)
+  {
+    TrimProxyCaches(budget);
     return;
+  }
 
-  if(m_BufferProxyCache.find(bufid) == m_BufferProxyCache.end())
+  m_ToReplaySerialiser->Serialise("", category);
+  m_ToReplaySerialiser->Serialise("", budget);
+  m_ToReplaySerialiser->Serialise("", eventID);
+
+  if(m_RemoteServer)
   {
-    if(m_ProxyBufferIds.find(bufid) == m_ProxyBufferIds.end())
-    {
-      FetchBuffer buf = GetBuffer(bufid);
-      m_ProxyBufferIds[bufid] = m_Proxy->CreateProxyBuffer(buf);
-    }
+    m_Remote->TrimMemory(category, budget, eventID);
+  }
+  else
+  {
+    if(!m_Socket->Connected())
+      return;
 
-    ResourceId proxyid = m_ProxyBufferIds[bufid];
+    // nothing comes back, so this can go along with the next command
+    DeferReplayCommand(eReplayProxy_TrimMemory);
+  }
+}
 
-    vector<byte> data;
-    GetBufferData(bufid, 0, 0, data);
+template <>
+string ToStrHelper<false, ReplayProxyPacket>::Get(const ReplayProxyPacket &el)
+{
+  switch(el)
+  {
+    TOSTR_CASE_STRINGIZE(eReplayProxy_ReplayLog)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetPassEvents)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTextures)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTexture)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetBuffers)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetBuffer)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetShader)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetDebugMessages)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetBufferData)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTextureData)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_SavePipelineState)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetUsage)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetLiveID)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetFrameRecord)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_IsRenderOutput)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_FreeResource)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_HasResolver)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_FetchCounters)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_EnumerateCounters)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_DescribeCounter)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_FillCBufferVariables)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_InitPostVS)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_InitPostVSVec)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetPostVS)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_InitStackResolver)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_HasStackResolver)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetAddressDetails)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_BuildTargetShader)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_ReplaceResource)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_RemoveReplacement)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_DebugVertex)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_DebugPixel)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_DebugThread)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_RenderOverlay)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetAPIProperties)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_PixelHistory)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetBuffersData)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTexturesData)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTextureDataDelta)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetBufferPages)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetTextureDataRows)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_Batch)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetProxyStats)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_GetMemoryStats)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_TrimMemory)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_QueryTextures)
+    TOSTR_CASE_STRINGIZE(eReplayProxy_QueryBuffers)
+    default: break;
+  }
 
-    if(!data.empty())
-      m_Proxy->SetProxyBufferData(proxyid, &data[0], data.size());
+  return StringFormat::Fmt("ReplayProxyPacket<%d>", el);
+}
 
-    m_BufferProxyCache.insert(bufid);
+template <>
+string ToStrHelper<false, RemapTextureEnum>::Get(const RemapTextureEnum &el)
+{
+  switch(el)
+  {
+    TOSTR_CASE_STRINGIZE(eRemap_None)
+    TOSTR_CASE_STRINGIZE(eRemap_RGBA8)
+    TOSTR_CASE_STRINGIZE(eRemap_RGBA16)
+    TOSTR_CASE_STRINGIZE(eRemap_RGBA32)
+    TOSTR_CASE_STRINGIZE(eRemap_D32S8)
+    default: break;
   }
+
+  return StringFormat::Fmt("RemapTextureEnum<%d>", el);
 }
 
-bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
+// texture and buffer data is split into byte planes before compression, so that the matching
+// bytes of each element (or each BC block) sit next to each other. Exponents, alpha channels and
+// block endpoints vary much less than the low bits, and LZ4 finds far more matches this way.
+static void ShuffleBytes(const byte *src, byte *dst, size_t size, uint32_t stride)
 {
-  if(!m_RemoteServer)
-    return true;
+  size_t count = size / stride;
 
-  if(!m_Socket || !m_Socket->Connected())
-    return false;
+  for(uint32_t b = 0; b < stride; b++)
+    for(size_t i = 0; i < count; i++)
+      dst[b * count + i] = src[i * stride + b];
 
-  m_ToReplaySerialiser = incomingPacket;
+  // any trailing partial element is passed through untouched
+  memcpy(dst + count * stride, src + count * stride, size - count * stride);
+}
 
-  m_FromReplaySerialiser->Rewind();
+static void UnshuffleBytes(const byte *src, byte *dst, size_t size, uint32_t stride)
+{
+  size_t count = size / stride;
 
-  switch(type)
-  {
-    case eReplayProxy_ReplayLog: ReplayLog(0, (ReplayLogType)0); break;
-    case eReplayProxy_GetPassEvents: GetPassEvents(0); break;
+  for(uint32_t b = 0; b < stride; b++)
+    for(size_t i = 0; i < count; i++)
+      dst[i * stride + b] = src[b * count + i];
+
+  memcpy(dst + count * stride, src + count * stride, size - count * stride);
+}
+
+// the size of one element of texture data as returned by GetTextureData, used as the shuffle
+// stride. Getting this wrong only costs compression ratio, never correctness.
+static uint32_t TextureDataStride(const ResourceFormat &format, const GetTextureDataParams &params)
+{
+  switch(params.remap)
+  {
+    case eRemap_RGBA8: return 4;
+    case eRemap_RGBA16:
+    case eRemap_RGBA16F: return 8;
+    case eRemap_RGBA32: return 16;
+    case eRemap_D32S8: return 8;
+    case eRemap_None: break;
+  }
+
+  if(format.special)
+  {
+    switch(format.specialFormat)
+    {
+      case eSpecial_BC1:
+      case eSpecial_BC4: return 8;
+      case eSpecial_BC2:
+      case eSpecial_BC3:
+      case eSpecial_BC5:
+      case eSpecial_BC6:
+      case eSpecial_BC7: return 16;
+      case eSpecial_R10G10B10A2:
+      case eSpecial_R11G11B10:
+      case eSpecial_R9G9B9E5:
+      case eSpecial_D24S8: return 4;
+      case eSpecial_R5G6B5:
+      case eSpecial_R5G5B5A1:
+      case eSpecial_R4G4B4A4: return 2;
+      case eSpecial_D32S8: return 8;
+      default: return 1;
+    }
+  }
+
+  uint32_t stride = format.compCount * format.compByteWidth;
+  return stride > 0 ? stride : 1;
+}
+
+// drivers only render remapped textures to RGBA8 or RGBA32 float, so the 16-bit remaps are read
+// back as RGBA32 and packed here on the remote side, halving what's sent.
+static byte *GetRemoteTextureData(IRemoteDriver *remote, ResourceId tex, uint32_t arrayIdx,
+                                  uint32_t mip, const GetTextureDataParams &params,
+                                  size_t &dataSize)
+{
+  if(params.remap != eRemap_RGBA16 && params.remap != eRemap_RGBA16F)
+    return remote->GetTextureData(tex, arrayIdx, mip, params, dataSize);
+
+  GetTextureDataParams fullParams = params;
+  fullParams.remap = eRemap_RGBA32;
+
+  size_t fullSize = 0;
+  byte *fullData = remote->GetTextureData(tex, arrayIdx, mip, fullParams, fullSize);
+
+  if(fullData == NULL)
+  {
+    dataSize = 0;
+    return NULL;
+  }
+
+  size_t count = fullSize / sizeof(float);
+  const float *src = (const float *)fullData;
+
+  byte *ret = new byte[count * sizeof(uint16_t)];
+  uint16_t *dst = (uint16_t *)ret;
+
+  if(params.remap == eRemap_RGBA16F)
+  {
+    ConvertToHalf(src, dst, count);
+  }
+  else
+  {
+    for(size_t i = 0; i < count; i++)
+      dst[i] = uint16_t(RDCCLAMP(src[i], 0.0f, 1.0f) * 65535.0f + 0.5f);
+  }
+
+  delete[] fullData;
+
+  dataSize = count * sizeof(uint16_t);
+  return ret;
+}
+
+// works out the row layout of the data GetTextureData returns for a subresource, so that rows
+// can be sent separately. Only formats where each element is a fixed number of bytes (pixels, or
+// 4x4 blocks for BC formats) are handled, anything else is always sent whole.
+static bool GetTextureRowLayout(const FetchTexture &tex, uint32_t mip,
+                                const GetTextureDataParams &params, uint32_t &numRows,
+                                uint32_t &rowPitch, uint32_t &elemSize)
+{
+  if(tex.msSamp > 1)
+    return false;
+
+  bool block = false;
+
+  if(params.remap == eRemap_None && tex.format.special)
+  {
+    switch(tex.format.specialFormat)
+    {
+      case eSpecial_BC1:
+      case eSpecial_BC2:
+      case eSpecial_BC3:
+      case eSpecial_BC4:
+      case eSpecial_BC5:
+      case eSpecial_BC6:
+      case eSpecial_BC7: block = true; break;
+      default: return false;
+    }
+  }
+
+  uint32_t width = RDCMAX(1U, tex.width >> mip);
+  uint32_t height = RDCMAX(1U, tex.height >> mip);
+  uint32_t depth = tex.dimension == 3 ? RDCMAX(1U, tex.depth >> mip) : 1;
+
+  if(block)
+  {
+    width = (width + 3) / 4;
+    height = (height + 3) / 4;
+  }
+
+  elemSize = TextureDataStride(tex.format, params);
+  numRows = height * depth;
+  rowPitch = width * elemSize;
+
+  return true;
+}
+
+// a block of data to be compressed for sending, possibly on a worker thread
+struct ProxyCompressJob
+{
+  ProxyCompressJob() : data(NULL), size(0), stride(1) {}
+  byte *data;
+  size_t size;
+  uint32_t stride;
+  vector<byte> compressed;
+};
+
+static void CompressProxyData(void *param)
+{
+  ProxyCompressJob *job = (ProxyCompressJob *)param;
+
+  if(job->data == NULL || job->size == 0)
+    return;
+
+  const byte *src = job->data;
+
+  vector<byte> shuffled;
+  if(job->stride > 1)
+  {
+    shuffled.resize(job->size);
+    ShuffleBytes(job->data, &shuffled[0], job->size, job->stride);
+    src = &shuffled[0];
+  }
+
+  job->compressed.resize(LZ4_COMPRESSBOUND(job->size));
+
+  int compressedSize =
+      LZ4_compress((const char *)src, (char *)&job->compressed[0], (int)job->size);
+
+  job->compressed.resize((size_t)compressedSize);
+}
+
+// re-fetched data is compared in blocks of this size, and only the blocks that changed are sent.
+// For row-major texture data each block is a strip of rows.
+static const size_t DeltaBlockSize = 16 * 1024;
+// pipeline state is much smaller and most of it stays the same between events, so it's compared
+// at a finer granularity
+static const size_t PipelineDeltaBlockSize = 512;
+
+static void HashDeltaBlocks(const byte *data, size_t size, size_t blockSize,
+                            vector<uint64_t> &hashes)
+{
+  size_t numBlocks = (size + blockSize - 1) / blockSize;
+
+  hashes.resize(numBlocks);
+
+  for(size_t b = 0; b < numBlocks; b++)
+  {
+    const byte *block = data + b * blockSize;
+    size_t len = RDCMIN(blockSize, size - b * blockSize);
+
+    // include the length so a partial last block never matches a full one
+    uint64_t hash = HashMix64(len);
+
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t))
+    {
+      uint64_t word;
+      memcpy(&word, block + i, sizeof(word));
+      hash = HashMix64(hash ^ word);
+    }
+
+    for(; i < len; i++)
+      hash = HashMix64(hash ^ block[i]);
+
+    hashes[b] = hash;
+  }
+}
+
+// If a remap is required, modify the params that are used when getting the proxy texture data
+// for replay on the current driver.
+void ReplayProxy::RemapProxyTextureIfNeeded(ResourceFormat &format, GetTextureDataParams &params)
+{
+  if(m_Proxy->IsTextureSupported(format))
+    return;
+
+  // everything sent has to go over the network, so remap to the smallest format that keeps the
+  // precision of the original.
+  if(format.special)
+  {
+    switch(format.specialFormat)
+    {
+      case eSpecial_S8:
+      case eSpecial_D16S8: params.remap = eRemap_D32S8; break;
+      case eSpecial_BC1:
+      case eSpecial_BC2:
+      case eSpecial_BC3:
+      case eSpecial_BC4:
+      case eSpecial_BC5:
+      case eSpecial_BC7:
+      case eSpecial_ASTC:
+      case eSpecial_EAC:
+      case eSpecial_ETC2:
+      case eSpecial_R5G6B5:
+      case eSpecial_R5G5B5A1:
+      case eSpecial_R4G4B4A4:
+      case eSpecial_R4G4:
+      case eSpecial_YUV:
+        // signed values don't survive RGBA8 unorm
+        params.remap = format.compType == eCompType_SNorm ? eRemap_RGBA16F : eRemap_RGBA8;
+        break;
+      case eSpecial_R10G10B10A2: params.remap = eRemap_RGBA16; break;
+      case eSpecial_BC6:
+      case eSpecial_R11G11B10:
+      case eSpecial_R9G9B9E5: params.remap = eRemap_RGBA16F; break;
+      default:
+        RDCERR("Don't know how to remap special format %u, falling back to RGBA32",
+               format.specialFormat);
+        params.remap = eRemap_RGBA32;
+        break;
+    }
+    format.special = false;
+  }
+  else
+  {
+    if(format.compByteWidth == 4)
+      params.remap = eRemap_RGBA32;
+    else if(format.compByteWidth == 2)
+      params.remap = format.compType == eCompType_UNorm ? eRemap_RGBA16 : eRemap_RGBA16F;
+    else if(format.compByteWidth == 1)
+      params.remap = format.compType == eCompType_SNorm ? eRemap_RGBA16F : eRemap_RGBA8;
+  }
+
+  switch(params.remap)
+  {
+    case eRemap_None: RDCERR("IsTextureSupported == false, but we have no remap"); break;
+    case eRemap_RGBA8:
+      format.compCount = 4;
+      format.compByteWidth = 1;
+      format.compType = eCompType_UNorm;
+      // the remote renders the texture to the remapped format through the display shader, so
+      // the range maps values straight through
+      params.whitePoint = 1.0f;
+      break;
+    case eRemap_RGBA16:
+      format.compCount = 4;
+      format.compByteWidth = 2;
+      format.compType = eCompType_UNorm;
+      params.whitePoint = 1.0f;
+      break;
+    case eRemap_RGBA16F:
+      format.compCount = 4;
+      format.compByteWidth = 2;
+      format.compType = eCompType_Float;
+      params.whitePoint = 1.0f;
+      break;
+    case eRemap_RGBA32:
+      format.compCount = 4;
+      format.compByteWidth = 4;
+      format.compType = eCompType_Float;
+      params.whitePoint = 1.0f;
+      break;
+    case eRemap_D32S8: RDCERR("Remapping depth/stencil formats not implemented."); break;
+  }
+}
+
+// subresources smaller than this are always sent whole
+static const uint64_t ProgressiveMinSize = 4 * 1024 * 1024;
+// the preview is point-sampled down until it's no bigger than this
+static const uint64_t ProgressivePreviewSize = 64 * 1024;
+// rows are tracked and requested in bands of roughly this size
+static const uint64_t ProgressiveBandSize = 256 * 1024;
+// each render fetches at least this much more of the texture
+static const uint64_t ProgressiveStepSize = 4 * 1024 * 1024;
+
+bool ReplayProxy::StartProgressiveTexture(const TextureCacheEntry &entry)
+{
+  FetchTexture tex = GetTexture(entry.replayid);
+
+  map<ResourceId, ProxyTextureProperties>::iterator proxyIt = m_ProxyTextures.find(entry.replayid);
+
+  GetTextureDataParams params;
+
+  if(proxyIt != m_ProxyTextures.end())
+  {
+    params = proxyIt->second.params;
+  }
+  else
+  {
+    ResourceFormat proxyFormat = tex.format;
+    RemapProxyTextureIfNeeded(proxyFormat, params);
+  }
+
+  uint32_t numRows = 0, rowPitch = 0, elemSize = 0;
+  if(!GetTextureRowLayout(tex, entry.mip, params, numRows, rowPitch, elemSize) ||
+     uint64_t(numRows) * rowPitch < ProgressiveMinSize)
+    return false;
+
+  if(proxyIt == m_ProxyTextures.end())
+  {
+    FetchTexture proxyTex = tex;
+
+    ProxyTextureProperties proxy;
+    RemapProxyTextureIfNeeded(proxyTex.format, proxy.params);
+
+    proxy.id = m_Proxy->CreateProxyTexture(proxyTex);
+    m_ProxyTextures[entry.replayid] = proxy;
+  }
+
+  uint32_t step = 1;
+  while(uint64_t(numRows / step) * (rowPitch / step) > ProgressivePreviewSize)
+    step *= 2;
+
+  uint32_t gotRows = 0, gotPitch = 0, gotElemSize = 0;
+  vector<byte> preview;
+  GetTextureDataRows(entry.replayid, entry.arrayIdx, entry.mip, params, vector<uint32_t>(), step,
+                     gotRows, gotPitch, gotElemSize, preview);
+
+  uint32_t numElems = rowPitch / elemSize;
+  uint32_t previewRows = (numRows + step - 1) / step;
+  uint32_t previewElems = (numElems + step - 1) / step;
+
+  // if the remote side disagrees about the layout, just fetch the texture normally
+  if(gotRows != numRows || gotPitch != rowPitch || gotElemSize != elemSize ||
+     preview.size() != size_t(previewRows) * previewElems * elemSize)
+    return false;
+
+  ProgressiveTexture &prog = m_ProgressiveTextures[entry];
+
+  prog.numRows = numRows;
+  prog.rowPitch = rowPitch;
+  prog.bandRows = (uint32_t)RDCMAX((uint64_t)1, ProgressiveBandSize / rowPitch);
+  prog.bandReceived.resize((numRows + prog.bandRows - 1) / prog.bandRows, false);
+  prog.data.resize(size_t(numRows) * rowPitch);
+
+  for(uint32_t y = 0; y < numRows; y++)
+  {
+    const byte *src = &preview[size_t(y / step) * previewElems * elemSize];
+    byte *dst = &prog.data[size_t(y) * rowPitch];
+
+    for(uint32_t x = 0; x < numElems; x++)
+      memcpy(dst + x * elemSize, src + (x / step) * elemSize, elemSize);
+  }
+
+  m_Proxy->SetProxyTextureData(m_ProxyTextures[entry.replayid].id, entry.arrayIdx, entry.mip,
+                               &prog.data[0], prog.data.size());
+
+  return true;
+}
+
+bool ReplayProxy::FetchProgressiveRows(const TextureCacheEntry &entry, ProgressiveTexture &prog,
+                                       uint32_t firstVisible, uint32_t lastVisible,
+                                       uint64_t budget)
+{
+  vector<uint32_t> bands;
+  uint64_t size = 0;
+
+  // bands in the visible region go first, then the rest in order
+  for(int pass = 0; pass < 2; pass++)
+  {
+    for(uint32_t b = 0; b < (uint32_t)prog.bandReceived.size() && size < budget; b++)
+    {
+      if(prog.bandReceived[b])
+        continue;
+
+      uint32_t first = b * prog.bandRows;
+      uint32_t last = RDCMIN(prog.numRows, first + prog.bandRows);
+
+      bool visible = last > firstVisible && first < lastVisible;
+      if(visible != (pass == 0))
+        continue;
+
+      bands.push_back(b);
+      size += uint64_t(last - first) * prog.rowPitch;
+    }
+  }
+
+  if(bands.empty())
+    return true;
+
+  vector<uint32_t> ranges;
+
+  for(size_t i = 0; i < bands.size(); i++)
+  {
+    uint32_t first = bands[i] * prog.bandRows;
+    uint32_t last = RDCMIN(prog.numRows, first + prog.bandRows);
+
+    if(!ranges.empty() && ranges.back() == first)
+    {
+      ranges.back() = last;
+    }
+    else
+    {
+      ranges.push_back(first);
+      ranges.push_back(last);
+    }
+  }
+
+  const ProxyTextureProperties &proxy = m_ProxyTextures[entry.replayid];
+
+  uint32_t gotRows = 0, gotPitch = 0, gotElemSize = 0;
+  vector<byte> rows;
+  GetTextureDataRows(entry.replayid, entry.arrayIdx, entry.mip, proxy.params, ranges, 1, gotRows,
+                     gotPitch, gotElemSize, rows);
+
+  if(gotRows != prog.numRows || gotPitch != prog.rowPitch || rows.size() != (size_t)size)
+    return false;
+
+  size_t readOffs = 0;
+
+  for(size_t i = 0; i < ranges.size(); i += 2)
+  {
+    size_t offs = size_t(ranges[i]) * prog.rowPitch;
+    size_t len = size_t(ranges[i + 1] - ranges[i]) * prog.rowPitch;
+
+    memcpy(&prog.data[offs], &rows[readOffs], len);
+    readOffs += len;
+  }
+
+  for(size_t i = 0; i < bands.size(); i++)
+    prog.bandReceived[bands[i]] = true;
+
+  m_Proxy->SetProxyTextureData(proxy.id, entry.arrayIdx, entry.mip, &prog.data[0],
+                               prog.data.size());
+
+  return true;
+}
+
+void ReplayProxy::EnsureTexDisplayable(const TextureDisplay &cfg)
+{
+  if(!m_Socket->Connected())
+    return;
+
+  TextureCacheEntry entry = {cfg.texid, cfg.sliceFace, cfg.mip};
+
+  if(cfg.texid == ResourceId() || m_LocalTextures.find(cfg.texid) != m_LocalTextures.end() ||
+     m_TextureProxyCache.find(entry) != m_TextureProxyCache.end())
+    return;
+
+  map<TextureCacheEntry, ProgressiveTexture>::iterator it = m_ProgressiveTextures.find(entry);
+
+  if(it == m_ProgressiveTextures.end())
+  {
+    // if there's an earlier copy to fetch a delta against, or the texture is small, there's
+    // nothing to gain from streaming it
+    if(m_TextureDataCache.find(entry) != m_TextureDataCache.end() ||
+       !StartProgressiveTexture(entry))
+      EnsureTexCached(cfg.texid, cfg.sliceFace, cfg.mip);
+    else
+      m_TexturePending = true;
+
+    return;
+  }
+
+  ProgressiveTexture &prog = it->second;
+
+  FetchTexture tex = GetTexture(cfg.texid);
+
+  // work out which rows are on screen, so they can be fetched first
+  uint32_t firstVisible = 0, lastVisible = prog.numRows;
+
+  int32_t width = 0, height = 0;
+  if(m_BoundOutput != 0)
+    m_Proxy->GetOutputWindowDimensions(m_BoundOutput, width, height);
+
+  if(height > 0 && tex.height > 0 && cfg.scale > 0.0f && tex.dimension != 3)
+  {
+    float displayHeight = float(tex.height) * cfg.scale;
+
+    float top = RDCCLAMP(-cfg.offy / displayHeight, 0.0f, 1.0f);
+    float bottom = RDCCLAMP((float(height) - cfg.offy) / displayHeight, 0.0f, 1.0f);
+
+    if(cfg.FlipY)
+    {
+      float tmp = top;
+      top = 1.0f - bottom;
+      bottom = 1.0f - tmp;
+    }
+
+    firstVisible = (uint32_t)(top * prog.numRows);
+    lastVisible = RDCMIN(prog.numRows, (uint32_t)(bottom * prog.numRows) + 1);
+  }
+
+  uint64_t budget = RDCMAX(ProgressiveStepSize, uint64_t(prog.data.size()) / 8);
+
+  if(!FetchProgressiveRows(entry, prog, firstVisible, lastVisible, budget))
+  {
+    m_ProgressiveTextures.erase(it);
+    EnsureTexCached(cfg.texid, cfg.sliceFace, cfg.mip);
+    return;
+  }
+
+  if(std::find(prog.bandReceived.begin(), prog.bandReceived.end(), false) !=
+     prog.bandReceived.end())
+  {
+    m_TexturePending = true;
+    return;
+  }
+
+  // everything has arrived, from here on this works like any other cached subresource
+  m_TextureDataCache[entry].swap(prog.data);
+  m_TextureProxyCache.insert(entry);
+  m_ProgressiveTextures.erase(it);
+}
+
+void ReplayProxy::EnsureTexCached(ResourceId texid, uint32_t arrayIdx, uint32_t mip)
+{
+  if(!m_Socket->Connected())
+    return;
+
+  TextureCacheEntry entry = {texid, arrayIdx, mip};
+
+  if(m_LocalTextures.find(texid) != m_LocalTextures.end())
+    return;
+
+  if(m_TextureProxyCache.find(entry) == m_TextureProxyCache.end())
+  {
+    // anything other than display needs the real data, so finish off any streaming in one go
+    map<TextureCacheEntry, ProgressiveTexture>::iterator progIt = m_ProgressiveTextures.find(entry);
+    if(progIt != m_ProgressiveTextures.end())
+    {
+      bool success = FetchProgressiveRows(entry, progIt->second, 0, 0, ~(uint64_t)0);
+
+      if(success)
+      {
+        m_TextureDataCache[entry].swap(progIt->second.data);
+        m_TextureProxyCache.insert(entry);
+      }
+
+      m_ProgressiveTextures.erase(progIt);
+
+      if(success)
+        return;
+    }
+
+    vector<uint32_t> mips;
+
+    if(m_ProxyTextures.find(texid) == m_ProxyTextures.end())
+    {
+      FetchTexture tex = GetTexture(texid);
+
+      // the rest of the mip chain is almost always looked at next, so the first time a texture
+      // is used fetch every mip of this slice in a single round-trip. The remote side reads
+      // them back and compresses them in parallel.
+      for(uint32_t m = 0; m < tex.mips; m++)
+        mips.push_back(m);
+
+      ProxyTextureProperties proxy;
+      RemapProxyTextureIfNeeded(tex.format, proxy.params);
+
+      proxy.id = m_Proxy->CreateProxyTexture(tex);
+      m_ProxyTextures[texid] = proxy;
+    }
+
+    const ProxyTextureProperties &proxy = m_ProxyTextures[texid];
+
+    // if we've fetched this subresource before, e.g. at a previous event, only the blocks that
+    // have changed since need to come over
+    map<TextureCacheEntry, vector<byte> >::iterator it = m_TextureDataCache.find(entry);
+    if(it != m_TextureDataCache.end())
+    {
+      GetTextureDataDelta(texid, arrayIdx, mip, proxy.params, it->second);
+
+      if(!it->second.empty())
+        m_Proxy->SetProxyTextureData(proxy.id, arrayIdx, mip, &it->second[0], it->second.size());
+
+      m_TextureProxyCache.insert(entry);
+      return;
+    }
+
+    if(mips.empty() || mip >= mips.size())
+    {
+      mips.clear();
+      mips.push_back(mip);
+    }
+
+    vector<byte *> data;
+    vector<size_t> sizes;
+    GetTexturesData(texid, arrayIdx, mips, proxy.params, data, sizes);
+
+    for(size_t i = 0; i < data.size(); i++)
+    {
+      TextureCacheEntry mipEntry = {texid, arrayIdx, mips[i]};
+
+      if(data[i])
+      {
+        m_Proxy->SetProxyTextureData(proxy.id, arrayIdx, mips[i], data[i], sizes[i]);
+        m_TextureDataCache[mipEntry].assign(data[i], data[i] + sizes[i]);
+      }
+
+      delete[] data[i];
+
+      m_TextureProxyCache.insert(mipEntry);
+    }
+
+    m_TextureProxyCache.insert(entry);
+  }
+}
+
+// buffers are fetched and tracked in pages of this size
+static const uint64_t BufferPageSize = 64 * 1024;
+// once cached buffer pages take up more than this, the least recently used are dropped
+static const uint64_t BufferCacheBudget = 256 * 1024 * 1024;
+
+static uint64_t HashBufferPage(const vector<byte> &data)
+{
+  if(data.empty())
+    return 0;
+
+  vector<uint64_t> hash;
+  HashDeltaBlocks(&data[0], data.size(), data.size(), hash);
+  return hash[0];
+}
+
+void ReplayProxy::EnsureBufCached(ResourceId bufid, uint64_t offset, uint64_t length)
+{
+  if(!m_Socket->Connected() || bufid == ResourceId())
+    return;
+
+  if(m_ProxyBufferIds.find(bufid) == m_ProxyBufferIds.end())
+  {
+    FetchBuffer buf = GetBuffer(bufid);
+    m_ProxyBufferIds[bufid] = m_Proxy->CreateProxyBuffer(buf);
+    m_BufferCaches[bufid].length = buf.length;
+  }
+
+  ResourceId proxyid = m_ProxyBufferIds[bufid];
+  ProxyBufferCache &cache = m_BufferCaches[bufid];
+
+  // a length of 0 means the whole buffer
+  if(length == 0)
+  {
+    offset = 0;
+    length = cache.length;
+  }
+
+  if(offset >= cache.length || length == 0)
+    return;
+
+  length = RDCMIN(length, cache.length - offset);
+
+  uint64_t firstPage = offset / BufferPageSize;
+  uint64_t lastPage = (offset + length - 1) / BufferPageSize;
+
+  m_BufferCacheTick++;
+
+  vector<uint64_t> pages;
+  vector<uint64_t> hashes;
+
+  for(uint64_t p = firstPage; p <= lastPage; p++)
+  {
+    BufferPage &page = cache.pages[p];
+    page.lastUse = m_BufferCacheTick;
+
+    if(page.epoch == m_ReplayEpoch && !page.data.empty())
+      continue;
+
+    // pages we still have a copy of are only sent again if they've changed
+    pages.push_back(p);
+    hashes.push_back(HashBufferPage(page.data));
+  }
+
+  if(pages.empty())
+    return;
+
+  vector<vector<byte> > pageData;
+  GetBufferPages(bufid, pages, hashes, pageData);
+
+  for(size_t i = 0; i < pageData.size(); i++)
+  {
+    BufferPage &page = cache.pages[pages[i]];
+
+    if(!pageData[i].empty())
+    {
+      m_BufferCacheBytes -= page.data.size();
+      page.data.swap(pageData[i]);
+      m_BufferCacheBytes += page.data.size();
+
+      m_Proxy->SetProxyBufferData(proxyid, pages[i] * BufferPageSize, &page.data[0],
+                                  page.data.size());
+    }
+
+    if(!page.data.empty())
+      page.epoch = m_ReplayEpoch;
+  }
+
+  // evict down to below the budget, so this doesn't have to happen on every request
+  if(m_BufferCacheBytes > BufferCacheBudget)
+    EvictBufferPages(BufferCacheBudget * 3 / 4);
+}
+
+void ReplayProxy::EvictBufferPages(uint64_t targetBytes)
+{
+  // everything not used by the latest request is a candidate, oldest first
+  vector<pair<uint64_t, pair<ResourceId, uint64_t> > > candidates;
+
+  for(auto it = m_BufferCaches.begin(); it != m_BufferCaches.end(); ++it)
+    for(auto page = it->second.pages.begin(); page != it->second.pages.end(); ++page)
+      if(!page->second.data.empty() && page->second.lastUse < m_BufferCacheTick)
+        candidates.push_back(
+            std::make_pair(page->second.lastUse, std::make_pair(it->first, page->first)));
+
+  std::sort(candidates.begin(), candidates.end());
+
+  for(size_t i = 0; i < candidates.size() && m_BufferCacheBytes > targetBytes; i++)
+  {
+    ProxyBufferCache &cache = m_BufferCaches[candidates[i].second.first];
+
+    auto page = cache.pages.find(candidates[i].second.second);
+
+    m_BufferCacheBytes -= page->second.data.size();
+    cache.pages.erase(page);
+  }
+}
+
+void ReplayProxy::TrimProxyCaches(uint64_t budget)
+{
+  uint64_t textureBytes = 0;
+  for(auto it = m_TextureDataCache.begin(); it != m_TextureDataCache.end(); ++it)
+    textureBytes += it->second.size();
+
+  // buffer pages are cheap to fetch again individually, so they go first
+  if(m_BufferCacheBytes + textureBytes > budget)
+    EvictBufferPages(budget > textureBytes ? budget - textureBytes : 0);
+
+  // then the data for subresources that aren't currently up to date in the proxy texture. That
+  // only means the next fetch has to send the whole subresource instead of a delta.
+  for(auto it = m_TextureDataCache.begin();
+      it != m_TextureDataCache.end() && m_BufferCacheBytes + textureBytes > budget;)
+  {
+    if(m_TextureProxyCache.find(it->first) == m_TextureProxyCache.end())
+    {
+      textureBytes -= it->second.size();
+      it = m_TextureDataCache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+bool ReplayProxy::ReadCachedBuffer(ResourceId bufid, uint64_t offset, uint64_t length,
+                                   vector<byte> &data)
+{
+  data.clear();
+
+  auto it = m_BufferCaches.find(bufid);
+  if(it == m_BufferCaches.end() || offset + length > it->second.length)
+    return false;
+
+  data.reserve((size_t)length);
+
+  while(length > 0)
+  {
+    uint64_t p = offset / BufferPageSize;
+    uint64_t pageOffs = offset % BufferPageSize;
+
+    auto page = it->second.pages.find(p);
+    if(page == it->second.pages.end() || page->second.epoch != m_ReplayEpoch ||
+       pageOffs >= page->second.data.size())
+      return false;
+
+    uint64_t len = RDCMIN(length, page->second.data.size() - pageOffs);
+
+    const byte *src = &page->second.data[(size_t)pageOffs];
+    data.insert(data.end(), src, src + len);
+
+    offset += len;
+    length -= len;
+  }
+
+  return true;
+}
+
+// fetch only the parts of a mesh's buffers that will be read, and point it at the proxy buffers.
+// 'indices' is the format with the index buffer and vertex count that index into fmt.
+void ReplayProxy::ProxyMeshBuffers(MeshFormat &fmt, const MeshFormat &indices)
+{
+  if(fmt.buf == ResourceId() && fmt.idxbuf == ResourceId())
+    return;
+
+  bool rangeKnown = fmt.stride > 0 && indices.numVerts > 0;
+  uint64_t firstVert = 0, lastVert = indices.numVerts;
+
+  if(indices.idxbuf != ResourceId() && indices.idxByteWidth > 0)
+  {
+    uint64_t idxLength = uint64_t(indices.numVerts) * indices.idxByteWidth;
+
+    EnsureBufCached(indices.idxbuf, indices.idxoffs, idxLength);
+
+    vector<byte> idxData;
+
+    if(rangeKnown && ReadCachedBuffer(indices.idxbuf, indices.idxoffs, idxLength, idxData))
+    {
+      // find the range of vertices referenced. The all-ones index is skipped since it's the
+      // primitive restart value
+      int64_t minIdx = INT64_MAX, maxIdx = -1;
+
+      for(uint32_t i = 0; i < indices.numVerts; i++)
+      {
+        uint32_t idx = 0;
+
+        if(indices.idxByteWidth == 2)
+        {
+          uint16_t idx16 = 0;
+          memcpy(&idx16, &idxData[i * 2], sizeof(idx16));
+          if(idx16 == 0xffff)
+            continue;
+          idx = idx16;
+        }
+        else if(indices.idxByteWidth == 4)
+        {
+          memcpy(&idx, &idxData[i * 4], sizeof(idx));
+          if(idx == 0xffffffff)
+            continue;
+        }
+        else
+        {
+          idx = idxData[i * indices.idxByteWidth];
+        }
+
+        minIdx = RDCMIN(minIdx, (int64_t)idx);
+        maxIdx = RDCMAX(maxIdx, (int64_t)idx);
+      }
+
+      if(maxIdx < 0)
+      {
+        firstVert = lastVert = 0;
+      }
+      else
+      {
+        firstVert = (uint64_t)RDCMAX((int64_t)0, minIdx + indices.baseVertex);
+        lastVert = (uint64_t)RDCMAX((int64_t)0, maxIdx + indices.baseVertex + 1);
+      }
+    }
+    else
+    {
+      rangeKnown = false;
+    }
+  }
+
+  if(fmt.buf != ResourceId())
+  {
+    if(rangeKnown && lastVert > firstVert)
+      EnsureBufCached(fmt.buf, fmt.offset + firstVert * fmt.stride,
+                      (lastVert - firstVert) * fmt.stride);
+    else if(!rangeKnown)
+      EnsureBufCached(fmt.buf, 0, 0);
+
+    fmt.buf = m_ProxyBufferIds[fmt.buf];
+  }
+
+  if(fmt.idxbuf != ResourceId())
+  {
+    if(fmt.idxbuf != indices.idxbuf)
+      EnsureBufCached(fmt.idxbuf, fmt.idxoffs, uint64_t(fmt.numVerts) * fmt.idxByteWidth);
+
+    fmt.idxbuf = m_ProxyBufferIds[fmt.idxbuf];
+  }
+}
+
+bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
+{
+  if(!m_RemoteServer)
+    return true;
+
+  if(!m_Socket || !m_Socket->Connected())
+    return false;
+
+  m_ToReplaySerialiser = incomingPacket;
+
+  m_FromReplaySerialiser->Rewind();
+
+  if(type == eReplayProxy_Batch)
+  {
+    while(!incomingPacket->AtEnd())
+    {
+      uint32_t subType = 0;
+      uint32_t length = 0;
+      incomingPacket->Serialise("", subType);
+      incomingPacket->Serialise("", length);
+
+      byte dummy = 0;
+      const byte *payload = &dummy;
+      if(length > 0)
+        payload = (const byte *)incomingPacket->RawReadBytes(length);
+
+      Serialiser sub(length, payload, false);
+
+      m_ToReplaySerialiser = &sub;
+
+      PerformanceTimer timer;
+
+      bool ok = HandleCommand((int)subType);
+
+      CommandStats *stats = GetCommandStats(subType);
+      if(stats)
+      {
+        stats->count++;
+        stats->remoteTime += timer.GetMilliseconds();
+      }
+
+      m_ToReplaySerialiser = incomingPacket;
+
+      if(!ok)
+        return false;
+    }
+  }
+  else
+  {
+    PerformanceTimer timer;
+
+    if(!HandleCommand(type))
+      return false;
+
+    CommandStats *stats = GetCommandStats((uint32_t)type);
+    if(stats)
+    {
+      stats->count++;
+      stats->remoteTime += timer.GetMilliseconds();
+    }
+  }
+
+  if(!SendPacket(m_Socket, type, *m_FromReplaySerialiser))
+    return false;
+
+  return true;
+}
+
+bool ReplayProxy::HandleCommand(int type)
+{
+  string traceName = "Remote " + ToStr::Get((ReplayProxyPacket)type);
+  SCOPED_TRACE(traceName.c_str());
+
+  switch(type)
+  {
+    case eReplayProxy_ReplayLog: ReplayLog(0, (ReplayLogType)0); break;
+    case eReplayProxy_GetPassEvents: GetPassEvents(0); break;
     case eReplayProxy_GetAPIProperties: GetAPIProperties(); break;
     case eReplayProxy_GetTextures: GetTextures(); break;
     case eReplayProxy_GetTexture: GetTexture(ResourceId()); break;
@@ -2135,6 +3416,9 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
     case eReplayProxy_GetFrameRecord: GetFrameRecord(); break;
     case eReplayProxy_IsRenderOutput: IsRenderOutput(ResourceId()); break;
     case eReplayProxy_HasResolver: HasCallstacks(); break;
+    case eReplayProxy_GetProxyStats: GetProxyStats(); break;
+    case eReplayProxy_GetMemoryStats: GetMemoryStats(); break;
+    case eReplayProxy_TrimMemory: TrimMemory(eReplayMemory_Count, 0, 0); break;
     case eReplayProxy_InitStackResolver: InitCallstackResolver(); break;
     case eReplayProxy_HasStackResolver: GetCallstackResolver(); break;
     case eReplayProxy_GetAddressDetails: GetAddr(0); break;
@@ -2146,6 +3430,20 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
       break;
     }
     case eReplayProxy_EnumerateCounters: EnumerateCounters(); break;
+    case eReplayProxy_QueryTextures:
+    {
+      vector<FetchTexture> page;
+      uint32_t total = 0;
+      QueryTextures(ResourceQuery(), page, total);
+      break;
+    }
+    case eReplayProxy_QueryBuffers:
+    {
+      vector<FetchBuffer> page;
+      uint32_t total = 0;
+      QueryBuffers(ResourceQuery(), page, total);
+      break;
+    }
     case eReplayProxy_DescribeCounter:
     {
       CounterDescription desc;
@@ -2165,12 +3463,46 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
       GetBufferData(ResourceId(), 0, 0, dummy);
       break;
     }
+    case eReplayProxy_GetBuffersData:
+    {
+      vector<vector<byte> > dummy;
+      GetBuffersData(vector<BufferDataRange>(), dummy);
+      break;
+    }
     case eReplayProxy_GetTextureData:
     {
       size_t dummy;
       GetTextureData(ResourceId(), 0, 0, GetTextureDataParams(), dummy);
       break;
     }
+    case eReplayProxy_GetTexturesData:
+    {
+      vector<byte *> dummy;
+      vector<size_t> dummySizes;
+      GetTexturesData(ResourceId(), 0, vector<uint32_t>(), GetTextureDataParams(), dummy,
+                      dummySizes);
+      break;
+    }
+    case eReplayProxy_GetTextureDataDelta:
+    {
+      vector<byte> dummy;
+      GetTextureDataDelta(ResourceId(), 0, 0, GetTextureDataParams(), dummy);
+      break;
+    }
+    case eReplayProxy_GetBufferPages:
+    {
+      vector<vector<byte> > dummy;
+      GetBufferPages(ResourceId(), vector<uint64_t>(), vector<uint64_t>(), dummy);
+      break;
+    }
+    case eReplayProxy_GetTextureDataRows:
+    {
+      uint32_t dummy[3] = {0};
+      vector<byte> dummyRows;
+      GetTextureDataRows(ResourceId(), 0, 0, GetTextureDataParams(), vector<uint32_t>(), 0,
+                         dummy[0], dummy[1], dummy[2], dummyRows);
+      break;
+    }
     case eReplayProxy_InitPostVS: InitPostVSBuffers(0); break;
     case eReplayProxy_InitPostVSVec:
     {
@@ -2202,9 +3534,6 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
     default: RDCERR("Unexpected command"); return false;
   }
 
-  if(!SendPacket(m_Socket, type, *m_FromReplaySerialiser))
-    return false;
-
   return true;
 }
 
@@ -2296,6 +3625,9 @@ FetchTexture ReplayProxy::GetTexture(ResourceId id)
 {
   FetchTexture ret = {};
 
+  if(!m_RemoteServer && m_TextureDescs.find(id) != m_TextureDescs.end())
+    return m_TextureDescs[id];
+
   m_ToReplaySerialiser->Serialise("", id);
 
   if(m_RemoteServer)
@@ -2310,51 +3642,152 @@ FetchTexture ReplayProxy::GetTexture(ResourceId id)
 
   m_FromReplaySerialiser->Serialise("", ret);
 
+  if(!m_RemoteServer)
+    m_TextureDescs[id] = ret;
+
+  return ret;
+}
+
+vector<ResourceId> ReplayProxy::GetBuffers()
+{
+  vector<ResourceId> ret;
+
+  if(m_RemoteServer)
+  {
+    ret = m_Remote->GetBuffers();
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetBuffers))
+      return ret;
+  }
+
+  m_FromReplaySerialiser->Serialise("", ret);
+
+  return ret;
+}
+
+FetchBuffer ReplayProxy::GetBuffer(ResourceId id)
+{
+  FetchBuffer ret = {};
+
+  if(!m_RemoteServer && m_BufferDescs.find(id) != m_BufferDescs.end())
+    return m_BufferDescs[id];
+
+  m_ToReplaySerialiser->Serialise("", id);
+
+  if(m_RemoteServer)
+  {
+    ret = m_Remote->GetBuffer(id);
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetBuffer))
+      return ret;
+  }
+
+  m_FromReplaySerialiser->Serialise("", ret);
+
+  if(!m_RemoteServer)
+    m_BufferDescs[id] = ret;
+
   return ret;
 }
 
-vector<ResourceId> ReplayProxy::GetBuffers()
+void ReplayProxy::BuildResourceIndex()
+{
+  if(m_ResourceIndexBuilt)
+    return;
+
+  m_ResourceIndexBuilt = true;
+
+  vector<ResourceId> ids = m_Remote->GetTextures();
+  m_IndexTextures.reserve(ids.size());
+  for(size_t i = 0; i < ids.size(); i++)
+    m_IndexTextures.push_back(m_Remote->GetTexture(ids[i]));
+
+  ids = m_Remote->GetBuffers();
+  m_IndexBuffers.reserve(ids.size());
+  for(size_t i = 0; i < ids.size(); i++)
+    m_IndexBuffers.push_back(m_Remote->GetBuffer(ids[i]));
+}
+
+const vector<EventUsage> &ReplayProxy::GetIndexUsage(ResourceId id)
+{
+  ResourceId liveid = m_Remote->GetLiveID(id);
+
+  auto it = m_ResourceUsage.find(liveid);
+  if(it != m_ResourceUsage.end())
+    return it->second;
+
+  vector<EventUsage> &usage = m_ResourceUsage[liveid];
+  usage = m_Remote->GetUsage(liveid);
+  std::stable_sort(usage.begin(), usage.end());
+
+  return usage;
+}
+
+bool ReplayProxy::QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page,
+                                uint32_t &total)
 {
-  vector<ResourceId> ret;
+  ResourceQuery q = query;
+
+  m_ToReplaySerialiser->Serialise("", q);
 
   if(m_RemoteServer)
   {
-    ret = m_Remote->GetBuffers();
+    BuildResourceIndex();
+    auto usage = [this](ResourceId id) -> const vector<EventUsage> & { return GetIndexUsage(id); };
+    total = m_ResourceIndex.QueryTextures(m_IndexTextures, q, usage, page);
   }
   else
   {
-    if(!SendReplayCommand(eReplayProxy_GetBuffers))
-      return ret;
+    if(!SendReplayCommand(eReplayProxy_QueryTextures))
+      return false;
   }
 
-  m_FromReplaySerialiser->Serialise("", ret);
+  m_FromReplaySerialiser->Serialise("", page);
+  m_FromReplaySerialiser->Serialise("", total);
 
-  return ret;
+  return true;
 }
 
-FetchBuffer ReplayProxy::GetBuffer(ResourceId id)
+bool ReplayProxy::QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page,
+                               uint32_t &total)
 {
-  FetchBuffer ret = {};
+  ResourceQuery q = query;
 
-  m_ToReplaySerialiser->Serialise("", id);
+  m_ToReplaySerialiser->Serialise("", q);
 
   if(m_RemoteServer)
   {
-    ret = m_Remote->GetBuffer(id);
+    BuildResourceIndex();
+    auto usage = [this](ResourceId id) -> const vector<EventUsage> & { return GetIndexUsage(id); };
+    total = m_ResourceIndex.QueryBuffers(m_IndexBuffers, q, usage, page);
   }
   else
   {
-    if(!SendReplayCommand(eReplayProxy_GetBuffer))
-      return ret;
+    if(!SendReplayCommand(eReplayProxy_QueryBuffers))
+      return false;
   }
 
-  m_FromReplaySerialiser->Serialise("", ret);
+  m_FromReplaySerialiser->Serialise("", page);
+  m_FromReplaySerialiser->Serialise("", total);
 
-  return ret;
+  return true;
 }
 
 void ReplayProxy::SavePipelineState()
 {
+  // the pipeline state is serialised into a blob, and only the parts of the blob that changed
+  // since the last event are sent. Both sides keep a copy of the last blob to patch against.
+  vector<uint64_t> hashes;
+  if(!m_RemoteServer)
+    HashDeltaBlocks(m_PipelineStateData.empty() ? NULL : &m_PipelineStateData[0],
+                    m_PipelineStateData.size(), PipelineDeltaBlockSize, hashes);
+
+  m_ToReplaySerialiser->Serialise("", hashes);
+
   if(m_RemoteServer)
   {
     m_Remote->SavePipelineState();
@@ -2362,22 +3795,38 @@ void ReplayProxy::SavePipelineState()
     m_D3D12PipelineState = m_Remote->GetD3D12PipelineState();
     m_GLPipelineState = m_Remote->GetGLPipelineState();
     m_VulkanPipelineState = m_Remote->GetVulkanPipelineState();
+
+    Serialiser ser(NULL, Serialiser::WRITING, false);
+
+    ser.Serialise("", m_D3D11PipelineState);
+    ser.Serialise("", m_D3D12PipelineState);
+    ser.Serialise("", m_GLPipelineState);
+    ser.Serialise("", m_VulkanPipelineState);
+
+    SendDeltaData(ser.GetRawPtr(0), (size_t)ser.GetOffset(), 4, hashes, PipelineDeltaBlockSize);
   }
   else
   {
     if(!SendReplayCommand(eReplayProxy_SavePipelineState))
       return;
 
+    ReceiveDeltaData(m_PipelineStateData, PipelineDeltaBlockSize);
+
     m_D3D11PipelineState = D3D11PipelineState();
     m_D3D12PipelineState = D3D12PipelineState();
     m_GLPipelineState = GLPipelineState();
     m_VulkanPipelineState = VulkanPipelineState();
-  }
 
-  m_FromReplaySerialiser->Serialise("", m_D3D11PipelineState);
-  m_FromReplaySerialiser->Serialise("", m_D3D12PipelineState);
-  m_FromReplaySerialiser->Serialise("", m_GLPipelineState);
-  m_FromReplaySerialiser->Serialise("", m_VulkanPipelineState);
+    if(m_PipelineStateData.empty())
+      return;
+
+    Serialiser ser(m_PipelineStateData.size(), &m_PipelineStateData[0], false);
+
+    ser.Serialise("", m_D3D11PipelineState);
+    ser.Serialise("", m_D3D12PipelineState);
+    ser.Serialise("", m_GLPipelineState);
+    ser.Serialise("", m_VulkanPipelineState);
+  }
 }
 
 void ReplayProxy::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
@@ -2388,14 +3837,20 @@ void ReplayProxy::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
   if(m_RemoteServer)
   {
     m_Remote->ReplayLog(endEventID, replayType);
+    m_ReadbackValid = false;
   }
   else
   {
-    if(!SendReplayCommand(eReplayProxy_ReplayLog))
+    if(!m_Socket->Connected())
       return;
 
+    // an event change replays several times before anything is read back, so there's no need
+    // to wait for each replay individually
+    DeferReplayCommand(eReplayProxy_ReplayLog);
+
     m_TextureProxyCache.clear();
-    m_BufferProxyCache.clear();
+    m_ProgressiveTextures.clear();
+    m_ReplayEpoch++;
   }
 }
 
@@ -2424,6 +3879,9 @@ vector<EventUsage> ReplayProxy::GetUsage(ResourceId id)
 {
   vector<EventUsage> ret;
 
+  if(!m_RemoteServer && m_ResourceUsage.find(id) != m_ResourceUsage.end())
+    return m_ResourceUsage[id];
+
   m_ToReplaySerialiser->Serialise("", id);
 
   if(m_RemoteServer)
@@ -2438,6 +3896,9 @@ vector<EventUsage> ReplayProxy::GetUsage(ResourceId id)
 
   m_FromReplaySerialiser->Serialise("", ret);
 
+  if(!m_RemoteServer)
+    m_ResourceUsage[id] = ret;
+
   return ret;
 }
 
@@ -2613,53 +4074,476 @@ void ReplayProxy::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   {
     m_Remote->GetBufferData(buff, offset, len, retData);
 
-    uint64_t sz = retData.size();
-    m_FromReplaySerialiser->Serialise("", sz);
-    m_FromReplaySerialiser->RawWriteBytes(&retData[0], (size_t)sz);
+    // buffers are mostly vertex data, so shuffle on a float stride
+    ProxyCompressJob job;
+    job.data = retData.empty() ? NULL : &retData[0];
+    job.size = retData.size();
+    job.stride = 4;
+    CompressProxyData(&job);
+
+    SendCompressedData(job.compressed, job.size, job.stride);
   }
   else
   {
     if(!SendReplayCommand(eReplayProxy_GetBufferData))
       return;
 
-    uint64_t sz = 0;
-    m_FromReplaySerialiser->Serialise("", sz);
-    retData.resize((size_t)sz);
-    memcpy(&retData[0], m_FromReplaySerialiser->RawReadBytes((size_t)sz), (size_t)sz);
+    size_t sz = 0;
+    byte *data = ReceiveCompressedData(sz);
+
+    retData.resize(sz);
+    if(data)
+      memcpy(&retData[0], data, sz);
+
+    delete[] data;
   }
 }
 
-byte *ReplayProxy::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
-                                  const GetTextureDataParams &_params, size_t &dataSize)
+void ReplayProxy::GetBufferPages(ResourceId buff, const vector<uint64_t> &_pages,
+                                 const vector<uint64_t> &_hashes, vector<vector<byte> > &pageData)
 {
-  GetTextureDataParams params = _params;    // Serialiser is non-const
+  vector<uint64_t> pages = _pages;    // Serialiser is non-const
+  vector<uint64_t> hashes = _hashes;
 
-  m_ToReplaySerialiser->Serialise("", tex);
-  m_ToReplaySerialiser->Serialise("", arrayIdx);
-  m_ToReplaySerialiser->Serialise("", mip);
+  m_ToReplaySerialiser->Serialise("", buff);
+  m_ToReplaySerialiser->Serialise("", pages);
+  m_ToReplaySerialiser->Serialise("", hashes);
+
+  if(m_RemoteServer)
+  {
+    vector<ProxyCompressJob> jobs(pages.size());
+    vector<vector<byte> > data(pages.size());
+
+    // read back runs of consecutive pages together, then compress each changed page
+    {
+      InitialContentsWorkers workers;
+
+      for(size_t i = 0; i < pages.size();)
+      {
+        size_t run = 1;
+        while(i + run < pages.size() && pages[i + run] == pages[i] + run)
+          run++;
+
+        vector<byte> runData;
+        m_Remote->GetBufferData(buff, pages[i] * BufferPageSize, run * BufferPageSize, runData);
+
+        for(size_t r = 0; r < run; r++)
+        {
+          size_t offs = size_t(r * BufferPageSize);
+          if(offs < runData.size())
+          {
+            size_t len = RDCMIN((size_t)BufferPageSize, runData.size() - offs);
+            data[i + r].assign(runData.begin() + offs, runData.begin() + offs + len);
+          }
+
+          if(i + r < hashes.size() && hashes[i + r] != 0 &&
+             HashBufferPage(data[i + r]) == hashes[i + r])
+            continue;
+
+          if(data[i + r].empty())
+            continue;
+
+          jobs[i + r].data = &data[i + r][0];
+          jobs[i + r].size = data[i + r].size();
+          jobs[i + r].stride = 4;
+          workers.Queue(&CompressProxyData, &jobs[i + r]);
+        }
+
+        i += run;
+      }
+
+      workers.Finish();
+    }
+
+    // an empty page in the reply means the requester's copy is still up to date
+    for(size_t i = 0; i < jobs.size(); i++)
+      SendCompressedData(jobs[i].compressed, jobs[i].size, jobs[i].stride);
+  }
+  else
+  {
+    pageData.clear();
+
+    if(!SendReplayCommand(eReplayProxy_GetBufferPages))
+      return;
+
+    pageData.resize(pages.size());
+
+    for(size_t i = 0; i < pages.size(); i++)
+    {
+      size_t size = 0;
+      byte *data = ReceiveCompressedData(size);
+
+      if(data)
+        pageData[i].assign(data, data + size);
+
+      delete[] data;
+    }
+  }
+}
+
+void ReplayProxy::GetBuffersData(const vector<BufferDataRange> &_ranges,
+                                 vector<vector<byte> > &retData)
+{
+  vector<BufferDataRange> ranges = _ranges;    // Serialiser is non-const
+
+  // the whole batch goes in one command, so it costs one round-trip
+  uint32_t count = (uint32_t)ranges.size();
+  m_ToReplaySerialiser->Serialise("", count);
+  ranges.resize(count);
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    m_ToReplaySerialiser->Serialise("", ranges[i].buffer);
+    m_ToReplaySerialiser->Serialise("", ranges[i].offset);
+    m_ToReplaySerialiser->Serialise("", ranges[i].length);
+  }
+
+  if(m_RemoteServer)
+  {
+    m_Remote->GetBuffersData(ranges, retData);
+
+    retData.resize(count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+      uint64_t sz = retData[i].size();
+      m_FromReplaySerialiser->Serialise("", sz);
+      if(sz > 0)
+        m_FromReplaySerialiser->RawWriteBytes(&retData[i][0], (size_t)sz);
+    }
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetBuffersData))
+      return;
+
+    retData.resize(count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+      uint64_t sz = 0;
+      m_FromReplaySerialiser->Serialise("", sz);
+      retData[i].resize((size_t)sz);
+      if(sz > 0)
+        memcpy(&retData[i][0], m_FromReplaySerialiser->RawReadBytes((size_t)sz), (size_t)sz);
+    }
+  }
+}
+
+void ReplayProxy::SerialiseTextureDataParams(GetTextureDataParams &params)
+{
   m_ToReplaySerialiser->Serialise("", params.forDiskSave);
   m_ToReplaySerialiser->Serialise("", params.typeHint);
   m_ToReplaySerialiser->Serialise("", params.resolve);
   m_ToReplaySerialiser->Serialise("", params.remap);
   m_ToReplaySerialiser->Serialise("", params.blackPoint);
   m_ToReplaySerialiser->Serialise("", params.whitePoint);
+}
+
+void ReplayProxy::SendCompressedData(vector<byte> &compressed, size_t uncompressedSize,
+                                     uint32_t stride)
+{
+  uint32_t uncompSize = (uint32_t)uncompressedSize;
+  uint32_t compSize = (uint32_t)compressed.size();
+
+  m_FromReplaySerialiser->Serialise("", uncompSize);
+  m_FromReplaySerialiser->Serialise("", compSize);
+  m_FromReplaySerialiser->Serialise("", stride);
+  if(compSize > 0)
+    m_FromReplaySerialiser->RawWriteBytes(&compressed[0], (size_t)compSize);
+}
+
+byte *ReplayProxy::ReceiveCompressedData(size_t &dataSize)
+{
+  uint32_t uncompressedSize = 0;
+  uint32_t compressedSize = 0;
+  uint32_t stride = 1;
+
+  m_FromReplaySerialiser->Serialise("", uncompressedSize);
+  m_FromReplaySerialiser->Serialise("", compressedSize);
+  m_FromReplaySerialiser->Serialise("", stride);
+
+  if(uncompressedSize == 0 || compressedSize == 0)
+  {
+    dataSize = 0;
+    return NULL;
+  }
+
+  dataSize = (size_t)uncompressedSize;
+
+  byte *compressed = (byte *)m_FromReplaySerialiser->RawReadBytes((size_t)compressedSize);
+
+  byte *ret = new byte[dataSize + 512];
+
+  if(stride > 1)
+  {
+    byte *shuffled = new byte[dataSize];
+    LZ4_decompress_fast((const char *)compressed, (char *)shuffled, (int)dataSize);
+    UnshuffleBytes(shuffled, ret, dataSize, stride);
+    delete[] shuffled;
+  }
+  else
+  {
+    LZ4_decompress_fast((const char *)compressed, (char *)ret, (int)dataSize);
+  }
+
+  return ret;
+}
+
+void ReplayProxy::SendDeltaData(const byte *data, size_t size, uint32_t stride,
+                                const vector<uint64_t> &prevHashes, size_t blockSize)
+{
+  vector<uint64_t> hashes;
+  HashDeltaBlocks(data, size, blockSize, hashes);
+
+  vector<uint32_t> changed;
+
+  for(size_t b = 0; b < hashes.size(); b++)
+    if(b >= prevHashes.size() || hashes[b] != prevHashes[b])
+      changed.push_back((uint32_t)b);
+
+  ProxyCompressJob job;
+  job.stride = stride;
+
+  vector<byte> changedData;
+
+  for(size_t i = 0; i < changed.size(); i++)
+  {
+    size_t offs = changed[i] * blockSize;
+    size_t len = RDCMIN(blockSize, size - offs);
+    changedData.insert(changedData.end(), data + offs, data + offs + len);
+  }
+
+  if(!changedData.empty())
+  {
+    job.data = &changedData[0];
+    job.size = changedData.size();
+    CompressProxyData(&job);
+  }
+
+  uint64_t totalSize = size;
+  m_FromReplaySerialiser->Serialise("", totalSize);
+  m_FromReplaySerialiser->Serialise("", changed);
+  SendCompressedData(job.compressed, job.size, job.stride);
+}
+
+void ReplayProxy::ReceiveDeltaData(vector<byte> &cached, size_t blockSize)
+{
+  uint64_t totalSize = 0;
+  vector<uint32_t> changed;
+
+  m_FromReplaySerialiser->Serialise("", totalSize);
+  m_FromReplaySerialiser->Serialise("", changed);
+
+  size_t changedSize = 0;
+  byte *changedData = ReceiveCompressedData(changedSize);
+
+  // any blocks past the end of our old copy are always in the changed list, so resizing first
+  // and then patching leaves every byte up to date
+  cached.resize((size_t)totalSize);
+
+  size_t readOffs = 0;
+
+  for(size_t i = 0; i < changed.size(); i++)
+  {
+    size_t offs = changed[i] * blockSize;
+
+    if(offs >= cached.size())
+      break;
+
+    size_t len = RDCMIN(blockSize, cached.size() - offs);
+
+    if(changedData == NULL || readOffs + len > changedSize)
+    {
+      RDCERR("Delta data is truncated, expected %llu bytes but got %llu", (uint64_t)len,
+             (uint64_t)(changedSize - readOffs));
+      break;
+    }
+
+    memcpy(&cached[offs], changedData + readOffs, len);
+    readOffs += len;
+  }
+
+  delete[] changedData;
+}
+
+void ReplayProxy::GetTextureDataDelta(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                      const GetTextureDataParams &_params, vector<byte> &cached)
+{
+  GetTextureDataParams params = _params;    // Serialiser is non-const
+
+  vector<uint64_t> hashes;
+  if(!m_RemoteServer)
+    HashDeltaBlocks(cached.empty() ? NULL : &cached[0], cached.size(), DeltaBlockSize, hashes);
+
+  m_ToReplaySerialiser->Serialise("", tex);
+  m_ToReplaySerialiser->Serialise("", arrayIdx);
+  m_ToReplaySerialiser->Serialise("", mip);
+  SerialiseTextureDataParams(params);
+  m_ToReplaySerialiser->Serialise("", hashes);
+
+  if(m_RemoteServer)
+  {
+    size_t size = 0;
+    byte *data = GetRemoteTextureData(m_Remote, tex, arrayIdx, mip, params, size);
+
+    uint32_t stride = TextureDataStride(m_Remote->GetTexture(tex).format, params);
+
+    SendDeltaData(data, data ? size : 0, stride, hashes, DeltaBlockSize);
+
+    delete[] data;
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetTextureDataDelta))
+      return;
+
+    ReceiveDeltaData(cached, DeltaBlockSize);
+  }
+}
+
+const byte *ReplayProxy::GetCachedTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                              const GetTextureDataParams &params,
+                                              size_t &dataSize)
+{
+  if(!m_ReadbackValid || m_ReadbackEntry.replayid != tex || m_ReadbackEntry.arrayIdx != arrayIdx ||
+     m_ReadbackEntry.mip != mip || m_ReadbackParams.forDiskSave != params.forDiskSave ||
+     m_ReadbackParams.typeHint != params.typeHint || m_ReadbackParams.resolve != params.resolve ||
+     m_ReadbackParams.remap != params.remap || m_ReadbackParams.blackPoint != params.blackPoint ||
+     m_ReadbackParams.whitePoint != params.whitePoint)
+  {
+    size_t size = 0;
+    byte *data = GetRemoteTextureData(m_Remote, tex, arrayIdx, mip, params, size);
+
+    if(data)
+      m_ReadbackData.assign(data, data + size);
+    else
+      m_ReadbackData.clear();
+
+    delete[] data;
+
+    m_ReadbackEntry.replayid = tex;
+    m_ReadbackEntry.arrayIdx = arrayIdx;
+    m_ReadbackEntry.mip = mip;
+    m_ReadbackParams = params;
+    m_ReadbackValid = true;
+  }
+
+  dataSize = m_ReadbackData.size();
+
+  return m_ReadbackData.empty() ? NULL : &m_ReadbackData[0];
+}
+
+void ReplayProxy::GetTextureDataRows(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                     const GetTextureDataParams &_params,
+                                     const vector<uint32_t> &_rowRanges, uint32_t step,
+                                     uint32_t &numRows, uint32_t &rowPitch, uint32_t &elemSize,
+                                     vector<byte> &rows)
+{
+  GetTextureDataParams params = _params;    // Serialiser is non-const
+  vector<uint32_t> rowRanges = _rowRanges;
+
+  m_ToReplaySerialiser->Serialise("", tex);
+  m_ToReplaySerialiser->Serialise("", arrayIdx);
+  m_ToReplaySerialiser->Serialise("", mip);
+  SerialiseTextureDataParams(params);
+  m_ToReplaySerialiser->Serialise("", rowRanges);
+  m_ToReplaySerialiser->Serialise("", step);
+
+  numRows = rowPitch = elemSize = 0;
+  rows.clear();
 
   if(m_RemoteServer)
   {
-    byte *data = m_Remote->GetTextureData(tex, arrayIdx, mip, params, dataSize);
+    size_t size = 0;
+    const byte *data = GetCachedTextureData(tex, arrayIdx, mip, params, size);
+
+    // a zero row count tells the other side to fall back to fetching the whole subresource
+    if(data == NULL ||
+       !GetTextureRowLayout(m_Remote->GetTexture(tex), mip, params, numRows, rowPitch, elemSize) ||
+       size_t(numRows) * rowPitch != size)
+      numRows = rowPitch = elemSize = 0;
+
+    if(numRows > 0 && step > 1)
+    {
+      // point-sampled preview, taking every step'th element of every step'th row
+      uint32_t numElems = rowPitch / elemSize;
+
+      for(uint32_t y = 0; y < numRows; y += step)
+      {
+        const byte *row = data + size_t(y) * rowPitch;
+
+        for(uint32_t x = 0; x < numElems; x += step)
+          rows.insert(rows.end(), row + x * elemSize, row + (x + 1) * elemSize);
+      }
+    }
+    else if(numRows > 0)
+    {
+      for(size_t i = 0; i + 1 < rowRanges.size(); i += 2)
+      {
+        uint32_t first = RDCMIN(rowRanges[i], numRows);
+        uint32_t last = RDCMIN(rowRanges[i + 1], numRows);
+
+        if(last > first)
+          rows.insert(rows.end(), data + size_t(first) * rowPitch, data + size_t(last) * rowPitch);
+      }
+    }
+
+    m_FromReplaySerialiser->Serialise("", numRows);
+    m_FromReplaySerialiser->Serialise("", rowPitch);
+    m_FromReplaySerialiser->Serialise("", elemSize);
+
+    ProxyCompressJob job;
+    job.stride = RDCMAX(1U, elemSize);
+
+    if(!rows.empty())
+    {
+      job.data = &rows[0];
+      job.size = rows.size();
+      CompressProxyData(&job);
+    }
+
+    SendCompressedData(job.compressed, job.size, job.stride);
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetTextureDataRows))
+      return;
 
-    byte *compressed = new byte[LZ4_COMPRESSBOUND(dataSize)];
+    m_FromReplaySerialiser->Serialise("", numRows);
+    m_FromReplaySerialiser->Serialise("", rowPitch);
+    m_FromReplaySerialiser->Serialise("", elemSize);
 
-    uint32_t uncompressedSize = (uint32_t)dataSize;
-    uint32_t compressedSize =
-        (uint32_t)LZ4_compress((const char *)data, (char *)compressed, (int)uncompressedSize);
+    size_t size = 0;
+    byte *data = ReceiveCompressedData(size);
 
-    m_FromReplaySerialiser->Serialise("", uncompressedSize);
-    m_FromReplaySerialiser->Serialise("", compressedSize);
-    m_FromReplaySerialiser->RawWriteBytes(compressed, (size_t)compressedSize);
+    if(data)
+      rows.assign(data, data + size);
 
     delete[] data;
-    delete[] compressed;
+  }
+}
+
+byte *ReplayProxy::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                  const GetTextureDataParams &_params, size_t &dataSize)
+{
+  GetTextureDataParams params = _params;    // Serialiser is non-const
+
+  m_ToReplaySerialiser->Serialise("", tex);
+  m_ToReplaySerialiser->Serialise("", arrayIdx);
+  m_ToReplaySerialiser->Serialise("", mip);
+  SerialiseTextureDataParams(params);
+
+  if(m_RemoteServer)
+  {
+    ProxyCompressJob job;
+    job.data = GetRemoteTextureData(m_Remote, tex, arrayIdx, mip, params, job.size);
+    job.stride = TextureDataStride(m_Remote->GetTexture(tex).format, params);
+    CompressProxyData(&job);
+
+    SendCompressedData(job.compressed, job.size, job.stride);
+
+    delete[] job.data;
   }
   else
   {
@@ -2669,30 +4553,70 @@ byte *ReplayProxy::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mi
       return NULL;
     }
 
-    uint32_t uncompressedSize = 0;
-    uint32_t compressedSize = 0;
+    return ReceiveCompressedData(dataSize);
+  }
+
+  return NULL;
+}
+
+void ReplayProxy::GetTexturesData(ResourceId tex, uint32_t arrayIdx, const vector<uint32_t> &_mips,
+                                  const GetTextureDataParams &_params, vector<byte *> &data,
+                                  vector<size_t> &dataSizes)
+{
+  GetTextureDataParams params = _params;    // Serialiser is non-const
+  vector<uint32_t> mips = _mips;
+
+  // all subresources go in one command, so they cost one round-trip
+  m_ToReplaySerialiser->Serialise("", tex);
+  m_ToReplaySerialiser->Serialise("", arrayIdx);
+  m_ToReplaySerialiser->Serialise("", mips);
+  SerialiseTextureDataParams(params);
+
+  uint32_t count = (uint32_t)mips.size();
+
+  if(m_RemoteServer)
+  {
+    uint32_t stride = TextureDataStride(m_Remote->GetTexture(tex).format, params);
 
-    m_FromReplaySerialiser->Serialise("", uncompressedSize);
-    m_FromReplaySerialiser->Serialise("", compressedSize);
+    vector<ProxyCompressJob> jobs(count);
 
-    if(uncompressedSize == 0 || compressedSize == 0)
+    // readback has to happen here on the replay thread, but each subresource can be compressed
+    // while the next is read back.
     {
-      dataSize = 0;
-      return NULL;
+      InitialContentsWorkers workers;
+
+      for(uint32_t i = 0; i < count; i++)
+      {
+        jobs[i].data = GetRemoteTextureData(m_Remote, tex, arrayIdx, mips[i], params, jobs[i].size);
+        jobs[i].stride = stride;
+        workers.Queue(&CompressProxyData, &jobs[i]);
+      }
+
+      workers.Finish();
     }
 
-    dataSize = (size_t)uncompressedSize;
+    for(uint32_t i = 0; i < count; i++)
+    {
+      delete[] jobs[i].data;
+      jobs[i].data = NULL;
 
-    byte *ret = new byte[dataSize + 512];
+      SendCompressedData(jobs[i].compressed, jobs[i].size, jobs[i].stride);
+    }
+  }
+  else
+  {
+    data.clear();
+    dataSizes.clear();
 
-    byte *compressed = (byte *)m_FromReplaySerialiser->RawReadBytes((size_t)compressedSize);
+    if(!SendReplayCommand(eReplayProxy_GetTexturesData))
+      return;
 
-    LZ4_decompress_fast((const char *)compressed, (char *)ret, (int)dataSize);
+    data.resize(count);
+    dataSizes.resize(count);
 
-    return ret;
+    for(uint32_t i = 0; i < count; i++)
+      data[i] = ReceiveCompressedData(dataSizes[i]);
   }
-
-  return NULL;
 }
 
 void ReplayProxy::InitPostVSBuffers(uint32_t eventID)
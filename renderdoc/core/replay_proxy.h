@@ -27,6 +27,7 @@
 
 #include "os/os_specific.h"
 #include "replay/replay_driver.h"
+#include "replay/resource_index.h"
 #include "serialise/serialiser.h"
 #include "socket_helpers.h"
 
@@ -85,6 +86,29 @@ enum ReplayProxyPacket
   eReplayProxy_GetAPIProperties,
 
   eReplayProxy_PixelHistory,
+
+  eReplayProxy_GetBuffersData,
+
+  eReplayProxy_GetTexturesData,
+
+  eReplayProxy_GetTextureDataDelta,
+  eReplayProxy_GetBufferPages,
+
+  eReplayProxy_GetTextureDataRows,
+
+  // several commands in one packet, each as {uint32 type, uint32 length, payload}. The replies
+  // are concatenated in the same order into a single response.
+  eReplayProxy_Batch,
+
+  eReplayProxy_GetProxyStats,
+
+  eReplayProxy_GetMemoryStats,
+  eReplayProxy_TrimMemory,
+
+  eReplayProxy_QueryTextures,
+  eReplayProxy_QueryBuffers,
+
+  eReplayProxy_Count,
 };
 
 // This class implements IReplayDriver and StackResolver. On the local machine where the UI
@@ -101,7 +125,16 @@ public:
   {
     m_FromReplaySerialiser = NULL;
     m_ToReplaySerialiser = new Serialiser(NULL, Serialiser::WRITING, false);
+    m_DeferredCommands = new Serialiser(NULL, Serialiser::WRITING, false);
     m_RemoteHasResolver = false;
+    m_BufferCacheBytes = 0;
+    m_BufferCacheTick = 0;
+    m_ReplayEpoch = 1;
+    m_TexturePending = false;
+    m_BoundOutput = 0;
+    m_ReadbackValid = false;
+    m_ResourceIndexBuilt = false;
+    RDCEraseEl(m_CommandStats);
 
     GetAPIProperties();
   }
@@ -111,7 +144,16 @@ public:
   {
     m_ToReplaySerialiser = NULL;
     m_FromReplaySerialiser = new Serialiser(NULL, Serialiser::WRITING, false);
+    m_DeferredCommands = NULL;
     m_RemoteHasResolver = false;
+    m_BufferCacheBytes = 0;
+    m_BufferCacheTick = 0;
+    m_ReplayEpoch = 1;
+    m_TexturePending = false;
+    m_BoundOutput = 0;
+    m_ReadbackValid = false;
+    m_ResourceIndexBuilt = false;
+    RDCEraseEl(m_CommandStats);
 
     RDCEraseEl(m_APIProps);
   }
@@ -119,6 +161,9 @@ public:
   virtual ~ReplayProxy();
 
   bool IsRemoteProxy() { return !m_RemoteServer; }
+  vector<ProxyCommandStats> GetProxyStats();
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total);
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total);
   void Shutdown() { delete this; }
   void ReadLogInitialisation() {}
   vector<WindowingSystem> GetSupportedWindowSystems()
@@ -161,6 +206,8 @@ public:
   }
   void BindOutputWindow(uint64_t id, bool depth)
   {
+    m_BoundOutput = id;
+
     if(m_Proxy)
       return m_Proxy->BindOutputWindow(id, depth);
   }
@@ -219,11 +266,77 @@ public:
     return false;
   }
 
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches)
+  {
+    if(m_Proxy)
+    {
+      EnsureTexCached(texid, sliceFace, mip);
+      if(texid == ResourceId() || m_ProxyTextures[texid] == ResourceId())
+        return false;
+      return m_Proxy->SearchTextureValues(m_ProxyTextures[texid], sliceFace, mip, sample, params,
+                                          matches, numMatches);
+    }
+
+    return false;
+  }
+
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches)
+  {
+    if(m_Proxy)
+    {
+      // an unbounded search needs the whole buffer, which is a length of 0
+      uint64_t length = numElems == ~0U ? 0 : uint64_t(numElems) * stride;
+      EnsureBufCached(buff, offset, length);
+      if(buff == ResourceId() || m_ProxyBufferIds[buff] == ResourceId())
+        return false;
+      return m_Proxy->SearchBufferValues(m_ProxyBufferIds[buff], offset, stride, numElems, params,
+                                         matches, numMatches);
+    }
+
+    return false;
+  }
+
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint)
+  {
+    if(m_Proxy)
+    {
+      EnsureTexCached(texid, sliceFace, mip);
+      if(texid == ResourceId() || m_ProxyTextures[texid] == ResourceId())
+        return false;
+      return m_Proxy->SetTextureDiffInput(input, m_ProxyTextures[texid], sliceFace, mip, sample,
+                                          typeHint);
+    }
+
+    return false;
+  }
+
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result)
+  {
+    if(m_Proxy)
+    {
+      bool ret = m_Proxy->DiffTextureInputs(threshold, result);
+      // the diff texture only exists locally
+      if(ret)
+      {
+        m_LocalTextures.insert(result.diffTexture);
+        m_ProxyTextures[result.diffTexture] = result.diffTexture;
+      }
+      return ret;
+    }
+
+    return false;
+  }
+
   bool RenderTexture(TextureDisplay cfg)
   {
     if(m_Proxy)
     {
-      EnsureTexCached(cfg.texid, cfg.sliceFace, cfg.mip);
+      EnsureTexDisplayable(cfg);
       if(cfg.texid == ResourceId() || m_ProxyTextures[cfg.texid] == ResourceId())
         return false;
       cfg.texid = m_ProxyTextures[cfg.texid];
@@ -242,6 +355,13 @@ public:
     return false;
   }
 
+  bool HasPendingTextureData()
+  {
+    bool ret = m_TexturePending;
+    m_TexturePending = false;
+    return ret;
+  }
+
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace, uint32_t mip,
                  uint32_t sample, FormatComponentType typeHint, float pixel[4])
   {
@@ -275,39 +395,17 @@ public:
     {
       MeshDisplay proxiedCfg = cfg;
 
-      EnsureBufCached(proxiedCfg.position.buf);
-      if(proxiedCfg.position.buf == ResourceId() ||
-         m_ProxyBufferIds[proxiedCfg.position.buf] == ResourceId())
+      ProxyMeshBuffers(proxiedCfg.position, cfg.position);
+      if(proxiedCfg.position.buf == ResourceId())
         return;
-      proxiedCfg.position.buf = m_ProxyBufferIds[proxiedCfg.position.buf];
 
-      if(proxiedCfg.second.buf != ResourceId())
-      {
-        EnsureBufCached(proxiedCfg.second.buf);
-        proxiedCfg.second.buf = m_ProxyBufferIds[proxiedCfg.second.buf];
-      }
-
-      if(proxiedCfg.position.idxbuf != ResourceId())
-      {
-        EnsureBufCached(proxiedCfg.position.idxbuf);
-        proxiedCfg.position.idxbuf = m_ProxyBufferIds[proxiedCfg.position.idxbuf];
-      }
+      // the secondary data is indexed the same way as the position data
+      ProxyMeshBuffers(proxiedCfg.second, cfg.position);
 
       vector<MeshFormat> secDraws = secondaryDraws;
 
       for(size_t i = 0; i < secDraws.size(); i++)
-      {
-        if(secDraws[i].buf != ResourceId())
-        {
-          EnsureBufCached(secDraws[i].buf);
-          secDraws[i].buf = m_ProxyBufferIds[secDraws[i].buf];
-        }
-        if(secDraws[i].idxbuf != ResourceId())
-        {
-          EnsureBufCached(secDraws[i].idxbuf);
-          secDraws[i].idxbuf = m_ProxyBufferIds[secDraws[i].idxbuf];
-        }
-      }
+        ProxyMeshBuffers(secDraws[i], secondaryDraws[i]);
 
       m_Proxy->RenderMesh(eventID, secDraws, proxiedCfg);
     }
@@ -319,23 +417,11 @@ public:
     {
       MeshDisplay proxiedCfg = cfg;
 
-      EnsureBufCached(proxiedCfg.position.buf);
-      if(proxiedCfg.position.buf == ResourceId() ||
-         m_ProxyBufferIds[proxiedCfg.position.buf] == ResourceId())
+      ProxyMeshBuffers(proxiedCfg.position, cfg.position);
+      if(proxiedCfg.position.buf == ResourceId())
         return ~0U;
-      proxiedCfg.position.buf = m_ProxyBufferIds[proxiedCfg.position.buf];
 
-      if(proxiedCfg.second.buf != ResourceId())
-      {
-        EnsureBufCached(proxiedCfg.second.buf);
-        proxiedCfg.second.buf = m_ProxyBufferIds[proxiedCfg.second.buf];
-      }
-
-      if(proxiedCfg.position.idxbuf != ResourceId())
-      {
-        EnsureBufCached(proxiedCfg.position.idxbuf);
-        proxiedCfg.position.idxbuf = m_ProxyBufferIds[proxiedCfg.position.idxbuf];
-      }
+      ProxyMeshBuffers(proxiedCfg.second, cfg.position);
 
       return m_Proxy->PickVertex(eventID, proxiedCfg, x, y);
     }
@@ -343,6 +429,13 @@ public:
     return ~0U;
   }
 
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+    if(m_Proxy)
+      m_Proxy->PrecompileCustomShader(source, entry, compileFlags, type);
+  }
+
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors)
   {
@@ -420,6 +513,7 @@ public:
                             vector<ShaderVariable> &outvars, const vector<byte> &data);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
@@ -450,12 +544,20 @@ public:
                               uint32_t primitive);
   ShaderDebugTrace DebugThread(uint32_t eventID, uint32_t groupid[3], uint32_t threadid[3]);
 
+  // target shaders are compiled on the remote side when BuildTargetShader is sent
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+  }
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   void ReplaceResource(ResourceId from, ResourceId to);
   void RemoveReplacement(ResourceId id);
 
   void FileChanged() {}
+  vector<ReplayMemoryStats> GetMemoryStats();
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID);
+
   // will never be used
   ResourceId CreateProxyTexture(const FetchTexture &templateTex)
   {
@@ -476,17 +578,64 @@ public:
     return ResourceId();
   }
 
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize)
   {
     RDCERR("Calling proxy-render functions on a proxy serialiser");
   }
 
 private:
   bool SendReplayCommand(ReplayProxyPacket type);
+  void DeferReplayCommand(ReplayProxyPacket type);
+  void AppendCommand(Serialiser &batch, ReplayProxyPacket type);
+  bool HandleCommand(int type);
+
+  // the client records traffic and round-trip time, the remote side records execution time
+  struct CommandStats
+  {
+    uint32_t count;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    double totalLatency;
+    double maxLatency;
+    double remoteTime;
+  };
+
+  CommandStats *GetCommandStats(uint32_t type)
+  {
+    if(type < eReplayProxy_First || type >= eReplayProxy_Count)
+      return NULL;
+    return &m_CommandStats[type - eReplayProxy_First];
+  }
+
+  CommandStats m_CommandStats[eReplayProxy_Count - eReplayProxy_First];
 
   void EnsureTexCached(ResourceId texid, uint32_t arrayIdx, uint32_t mip);
+  void EnsureTexDisplayable(const TextureDisplay &cfg);
+  void GetTexturesData(ResourceId tex, uint32_t arrayIdx, const vector<uint32_t> &mips,
+                       const GetTextureDataParams &params, vector<byte *> &data,
+                       vector<size_t> &dataSizes);
+  void GetTextureDataDelta(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                           const GetTextureDataParams &params, vector<byte> &cached);
+  void GetBufferPages(ResourceId buff, const vector<uint64_t> &pages,
+                      const vector<uint64_t> &hashes, vector<vector<byte> > &pageData);
+  void GetTextureDataRows(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                          const GetTextureDataParams &params, const vector<uint32_t> &rowRanges,
+                          uint32_t step, uint32_t &numRows, uint32_t &rowPitch,
+                          uint32_t &elemSize, vector<byte> &rows);
+  const byte *GetCachedTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                   const GetTextureDataParams &params, size_t &dataSize);
+  void SendDeltaData(const byte *data, size_t size, uint32_t stride,
+                     const vector<uint64_t> &prevHashes, size_t blockSize);
+  void ReceiveDeltaData(vector<byte> &cached, size_t blockSize);
+  void SerialiseTextureDataParams(GetTextureDataParams &params);
+  void SendCompressedData(vector<byte> &compressed, size_t uncompressedSize, uint32_t stride);
+  byte *ReceiveCompressedData(size_t &dataSize);
   void RemapProxyTextureIfNeeded(ResourceFormat &format, GetTextureDataParams &params);
-  void EnsureBufCached(ResourceId bufid);
+  void EnsureBufCached(ResourceId bufid, uint64_t offset, uint64_t length);
+  bool ReadCachedBuffer(ResourceId bufid, uint64_t offset, uint64_t length, vector<byte> &data);
+  void ProxyMeshBuffers(MeshFormat &fmt, const MeshFormat &indices);
+  void EvictBufferPages(uint64_t targetBytes);
+  void TrimProxyCaches(uint64_t budget);
 
   struct TextureCacheEntry
   {
@@ -504,6 +653,34 @@ private:
     }
   };
   set<TextureCacheEntry> m_TextureProxyCache;
+  // the last data fetched for each subresource and buffer. These stay valid when the caches
+  // above are invalidated, so a re-fetch only needs to transfer the blocks that changed.
+  map<TextureCacheEntry, vector<byte> > m_TextureDataCache;
+
+  // a large subresource that's being streamed in. It starts out as a point-sampled preview
+  // expanded to full size, and bands of rows are replaced with the real data as they arrive.
+  struct ProgressiveTexture
+  {
+    vector<byte> data;
+    uint32_t numRows;
+    uint32_t rowPitch;
+    uint32_t bandRows;
+    vector<bool> bandReceived;
+  };
+  map<TextureCacheEntry, ProgressiveTexture> m_ProgressiveTextures;
+  bool m_TexturePending;
+  uint64_t m_BoundOutput;
+
+  bool StartProgressiveTexture(const TextureCacheEntry &entry);
+  bool FetchProgressiveRows(const TextureCacheEntry &entry, ProgressiveTexture &prog,
+                            uint32_t firstVisible, uint32_t lastVisible, uint64_t budget);
+
+  // on the remote side, the last subresource read back. Streaming a texture in several requests
+  // only reads it back from the GPU once.
+  TextureCacheEntry m_ReadbackEntry;
+  GetTextureDataParams m_ReadbackParams;
+  vector<byte> m_ReadbackData;
+  bool m_ReadbackValid;
   set<ResourceId> m_LocalTextures;
 
   struct ProxyTextureProperties
@@ -519,11 +696,49 @@ private:
   };
   map<ResourceId, ProxyTextureProperties> m_ProxyTextures;
 
-  set<ResourceId> m_BufferProxyCache;
+  // buffers are cached in fixed-size pages, fetched as they're needed. The page data is kept
+  // so that after an event change only pages that changed need to be sent again, and the least
+  // recently used pages are dropped once the cache gets too big.
+  struct BufferPage
+  {
+    BufferPage() : epoch(0), lastUse(0) {}
+    vector<byte> data;
+    // the value of m_ReplayEpoch when this page was last known to be up to date
+    uint32_t epoch;
+    uint64_t lastUse;
+  };
+  struct ProxyBufferCache
+  {
+    ProxyBufferCache() : length(0) {}
+    uint64_t length;
+    map<uint64_t, BufferPage> pages;
+  };
+  map<ResourceId, ProxyBufferCache> m_BufferCaches;
+  uint64_t m_BufferCacheBytes;
+  uint64_t m_BufferCacheTick;
+  uint32_t m_ReplayEpoch;
+
   map<ResourceId, ResourceId> m_ProxyBufferIds;
 
   map<ResourceId, ResourceId> m_LiveIDs;
 
+  // resource descriptions and usage don't change over the life of a capture, so they only need
+  // to be fetched once
+  map<ResourceId, FetchTexture> m_TextureDescs;
+  map<ResourceId, FetchBuffer> m_BufferDescs;
+  map<ResourceId, vector<EventUsage> > m_ResourceUsage;
+
+  // on the remote side, every texture and buffer description, fetched the first time a query comes
+  // in. Queries are answered from these so only the requested page goes back over the network.
+  bool m_ResourceIndexBuilt;
+  vector<FetchTexture> m_IndexTextures;
+  vector<FetchBuffer> m_IndexBuffers;
+  ResourceIndex m_ResourceIndex;
+
+  void BuildResourceIndex();
+  // sorted usage of a resource by its original ID, fetched from the remote driver once
+  const vector<EventUsage> &GetIndexUsage(ResourceId id);
+
   struct ShaderReflKey
   {
     ShaderReflKey() {}
@@ -544,6 +759,8 @@ private:
   Network::Socket *m_Socket;
   Serialiser *m_FromReplaySerialiser;
   Serialiser *m_ToReplaySerialiser;
+  // commands with no reply, waiting to go out in the same packet as the next command that has one
+  Serialiser *m_DeferredCommands;
   IReplayDriver *m_Proxy;
   IRemoteDriver *m_Remote;
   bool m_RemoteServer;
@@ -556,4 +773,7 @@ private:
   D3D12PipelineState m_D3D12PipelineState;
   GLPipelineState m_GLPipelineState;
   VulkanPipelineState m_VulkanPipelineState;
+
+  // the last pipeline state blob received, that the next one is sent as a delta against
+  vector<byte> m_PipelineStateData;
 };
@@ -24,6 +24,8 @@
  ******************************************************************************/
 
 #include "resource_manager.h"
+#include <functional>
+#include <queue>
 
 namespace ResourceIDGen
 {
@@ -47,15 +49,269 @@ void SetReplayResourceIDs()
 }
 };
 
+namespace ResourceIndexGen
+{
+// records are created and destroyed far less often than they're looked up, so this is only
+// locked for write when the tables change.
+static Threading::RWLock indexLock;
+
+static HashMap<ResourceId, uint32_t> indexLookup;
+static std::vector<ResourceId> indexIDs;
+
+// reused lowest first so the live indices stay packed at the start
+static std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t> > freeIndices;
+
+uint32_t Allocate(ResourceId id)
+{
+  SCOPED_WRITELOCK(indexLock);
+
+  uint32_t index;
+
+  if(freeIndices.empty())
+  {
+    index = (uint32_t)indexIDs.size();
+    indexIDs.push_back(id);
+  }
+  else
+  {
+    index = freeIndices.top();
+    freeIndices.pop();
+    indexIDs[index] = id;
+  }
+
+  indexLookup[id] = index;
+
+  return index;
+}
+
+void Release(uint32_t index)
+{
+  SCOPED_WRITELOCK(indexLock);
+
+  ResourceId id = indexIDs[index];
+
+  // another record may have been created with the same ID after this one, only remove the lookup
+  // if it's still ours
+  auto it = indexLookup.find(id);
+  if(it != indexLookup.end() && it->second == index)
+    indexLookup.erase(it);
+
+  indexIDs[index] = ResourceId();
+  freeIndices.push(index);
+}
+
+uint32_t Find(ResourceId id)
+{
+  SCOPED_READLOCK(indexLock);
+
+  auto it = indexLookup.find(id);
+
+  if(it == indexLookup.end())
+    return NoResourceIndex;
+
+  return it->second;
+}
+
+ResourceId GetID(uint32_t index)
+{
+  SCOPED_READLOCK(indexLock);
+
+  if(index >= indexIDs.size())
+    return ResourceId();
+
+  return indexIDs[index];
+}
+};
+
+bool FrameRefBits::Mark(uint32_t index, FrameRefType refType)
+{
+  size_t w = index / 64;
+  uint64_t bit = 1ULL << (index % 64);
+
+  if(w >= m_Words.size())
+  {
+    Word empty = {0, 0, 0};
+    m_Words.resize(w + 1, empty);
+  }
+
+  Word &word = m_Words[w];
+
+  bool referenced = (word.referenced & bit) != 0;
+
+  FrameRefType existing = eFrameRef_Unknown;
+  if(referenced)
+    Get(index, existing);
+
+  FrameRefType state = ComposeFrameRef(referenced, existing, refType);
+
+  word.referenced |= bit;
+  word.read &= ~bit;
+  word.write &= ~bit;
+
+  if(state == eFrameRef_ReadOnly || state == eFrameRef_ReadBeforeWrite)
+    word.read |= bit;
+  if(state == eFrameRef_ReadAndWrite || state == eFrameRef_ReadBeforeWrite)
+    word.write |= bit;
+
+  return !referenced;
+}
+
+bool FrameRefBits::Get(uint32_t index, FrameRefType &refType) const
+{
+  size_t w = index / 64;
+  uint64_t bit = 1ULL << (index % 64);
+
+  if(w >= m_Words.size() || (m_Words[w].referenced & bit) == 0)
+    return false;
+
+  bool read = (m_Words[w].read & bit) != 0;
+  bool write = (m_Words[w].write & bit) != 0;
+
+  if(read && write)
+    refType = eFrameRef_ReadBeforeWrite;
+  else if(read)
+    refType = eFrameRef_ReadOnly;
+  else if(write)
+    refType = eFrameRef_ReadAndWrite;
+  else
+    refType = eFrameRef_Unknown;
+
+  return true;
+}
+
+void FrameRefBits::Merge(const FrameRefBits &o, std::vector<uint32_t> &added)
+{
+  if(m_Words.size() < o.m_Words.size())
+  {
+    Word empty = {0, 0, 0};
+    m_Words.resize(o.m_Words.size(), empty);
+  }
+
+  for(size_t w = 0; w < o.m_Words.size(); w++)
+  {
+    Word &dst = m_Words[w];
+    const Word &src = o.m_Words[w];
+
+    if(src.referenced == 0)
+      continue;
+
+    // ComposeFrameRef for states: a read-before-write always wins, otherwise the existing state is
+    // kept unless it's unknown or absent, in which case the incoming state replaces it.
+    uint64_t known = dst.read | dst.write;
+    uint64_t readBeforeWrite = src.read & src.write;
+
+    dst.read |= readBeforeWrite | (src.read & ~known);
+    dst.write |= readBeforeWrite | (src.write & ~known);
+
+    uint64_t newRefs = src.referenced & ~dst.referenced;
+    dst.referenced |= src.referenced;
+
+    while(newRefs)
+    {
+      uint32_t bit = Bits::CountTrailingZeroes(newRefs);
+      added.push_back(uint32_t(w * 64 + bit));
+      newRefs &= newRefs - 1;
+    }
+  }
+}
+
+uint32_t FrameRefBits::FindFrom(uint32_t index) const
+{
+  size_t w = index / 64;
+
+  if(w >= m_Words.size())
+    return NoResourceIndex;
+
+  // mask off the indices before this one in the first word
+  uint64_t bits = m_Words[w].referenced & (~0ULL << (index % 64));
+
+  while(bits == 0)
+  {
+    w++;
+    if(w >= m_Words.size())
+      return NoResourceIndex;
+    bits = m_Words[w].referenced;
+  }
+
+  return uint32_t(w * 64 + Bits::CountTrailingZeroes(bits));
+}
+
+namespace
+{
+struct RunCursor
+{
+  const RecordChunk *cur;
+  const RecordChunk *end;
+  size_t run;
+};
+
+// orders the heap so the cursor with the lowest ID is on top, and the earliest run wins ties
+struct RunCursorGreater
+{
+  bool operator()(const RunCursor &a, const RunCursor &b) const
+  {
+    if(a.cur->first != b.cur->first)
+      return a.cur->first > b.cur->first;
+    return a.run > b.run;
+  }
+};
+};
+
+void RecordChunkList::Merge(std::vector<Chunk *> &chunks) const
+{
+  chunks.reserve(chunks.size() + m_Count);
+
+  std::vector<RunCursor> heap;
+  heap.reserve(m_Runs.size());
+
+  for(size_t i = 0; i < m_Runs.size(); i++)
+  {
+    RunCursor c = {m_Runs[i].first, m_Runs[i].second, i};
+    heap.push_back(c);
+  }
+
+  std::make_heap(heap.begin(), heap.end(), RunCursorGreater());
+
+  bool first = true;
+  int32_t prevID = 0;
+
+  while(!heap.empty())
+  {
+    std::pop_heap(heap.begin(), heap.end(), RunCursorGreater());
+    RunCursor &c = heap.back();
+
+    if(first || c.cur->first != prevID)
+      chunks.push_back(c.cur->second);
+
+    first = false;
+    prevID = c.cur->first;
+
+    c.cur++;
+
+    if(c.cur == c.end)
+      heap.pop_back();
+    else
+      std::push_heap(heap.begin(), heap.end(), RunCursorGreater());
+  }
+}
+
 void ResourceRecord::MarkResourceFrameReferenced(ResourceId id, FrameRefType refType)
 {
   if(id == ResourceId())
     return;
-  ResourceManager<void *, void *, ResourceRecord>::MarkReferenced(m_FrameRefs, id, refType);
+
+  uint32_t index = ResourceIndexGen::Find(id);
+
+  if(index != NoResourceIndex)
+    m_FrameRefBits.Mark(index, refType);
+  else
+    ResourceManager<void *, void *, ResourceRecord>::MarkReferenced(m_FrameRefs, id, refType);
 }
 
 void ResourceRecord::AddResourceReferences(ResourceRecordHandler *mgr)
 {
+  mgr->MarkResourcesFrameReferenced(m_FrameRefBits);
+
   for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
   {
     mgr->MarkResourceFrameReferenced(it->first, it->second);
@@ -85,6 +341,16 @@ void ResourceRecord::Delete(ResourceRecordHandler *mgr)
       }
     }
 
+    const FrameRefBits &bits = m_FrameRefBits;
+    for(uint32_t idx = bits.First(); idx != NoResourceIndex; idx = bits.Next(idx))
+    {
+      FrameRefType refType = eFrameRef_Unknown;
+      bits.Get(idx, refType);
+
+      if(refType == eFrameRef_ReadAndWrite || refType == eFrameRef_ReadBeforeWrite)
+        mgr->MarkPendingDirty(ResourceIndexGen::GetID(idx));
+    }
+
     DeleteChunks();
 
     if(ResID != ResourceId())
@@ -96,3 +362,18 @@ void ResourceRecord::Delete(ResourceRecordHandler *mgr)
     mgr->DestroyResourceRecord(this);
   }
 }
+
+void InitialContentsWorkers::Queue(Job job, void *data)
+{
+  m_Jobs.Submit(job, data);
+
+  // help out rather than let the queue grow without bound
+  while(m_Jobs.Outstanding() > MaxQueuedJobs && Threading::RunPendingJob())
+  {
+  }
+}
+
+void InitialContentsWorkers::Finish()
+{
+  m_Jobs.Wait();
+}
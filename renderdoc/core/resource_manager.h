@@ -25,9 +25,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include "api/replay/renderdoc_replay.h"
+#include "common/hash_map.h"
+#include "common/job_system.h"
+#include "common/small_vector.h"
 #include "common/threading.h"
 #include "core/core.h"
 #include "os/os_specific.h"
@@ -36,6 +40,12 @@
 using std::set;
 using std::map;
 
+template <>
+struct HashKey<ResourceId>
+{
+  static uint64_t Hash(const ResourceId &id) { return HashMix64(id.id); }
+};
+
 // in what way (read, write, etc) was a resource referenced in a frame -
 // used to determine if initial contents are needed and to what degree
 enum FrameRefType
@@ -63,6 +73,100 @@ ResourceId GetNewUniqueID();
 void SetReplayResourceIDs();
 };
 
+// combines a new reference to a resource with how it was already referenced (if it was), returning
+// the state it's now in.
+inline FrameRefType ComposeFrameRef(bool referenced, FrameRefType existing, FrameRefType refType)
+{
+  if(!referenced)
+  {
+    if(refType == eFrameRef_Read)
+      return eFrameRef_ReadOnly;
+    else if(refType == eFrameRef_Write)
+      return eFrameRef_ReadAndWrite;
+    else    // unknown or existing state
+      return refType;
+  }
+
+  // special case, explicitly set to ReadBeforeWrite for when
+  // we know that this use will likely be a partial-write
+  if(refType == eFrameRef_ReadBeforeWrite)
+    return eFrameRef_ReadBeforeWrite;
+
+  if(refType == eFrameRef_Unknown)
+    return existing;
+
+  if(existing == eFrameRef_Unknown)
+  {
+    if(refType == eFrameRef_Read || refType == eFrameRef_ReadOnly)
+      return eFrameRef_ReadOnly;
+    else
+      return eFrameRef_ReadAndWrite;
+  }
+
+  if(existing == eFrameRef_ReadOnly && refType == eFrameRef_Write)
+    return eFrameRef_ReadBeforeWrite;
+
+  return existing;
+}
+
+static const uint32_t NoResourceIndex = ~0U;
+
+// every live resource record with an ID gets a small index, handed out lowest first and reused once
+// the record is destroyed. This keeps the indices dense, so reference tracking can use flat bit
+// arrays indexed by them instead of maps keyed on ResourceId.
+namespace ResourceIndexGen
+{
+uint32_t Allocate(ResourceId id);
+void Release(uint32_t index);
+
+// returns NoResourceIndex if there's no live record with this ID
+uint32_t Find(ResourceId id);
+// returns ResourceId() if the index isn't in use
+ResourceId GetID(uint32_t index);
+};
+
+// how a set of resources were referenced, indexed by ResourceIndexGen index. For every 64 indices
+// there's a word of which were referenced at all and two words for their state: neither bit set is
+// unknown, read only is read-only, write only is read-and-write and both is read-before-write.
+// That means merging one set into another is a handful of word-wide operations per 64 resources,
+// rather than a map lookup and insert per resource.
+class FrameRefBits
+{
+public:
+  bool empty() const { return m_Words.empty(); }
+  void clear() { m_Words.clear(); }
+  void swap(FrameRefBits &o) { m_Words.swap(o.m_Words); }
+  // as ComposeFrameRef. Returns true if this index wasn't referenced before
+  bool Mark(uint32_t index, FrameRefType refType);
+
+  // returns false if the index isn't referenced
+  bool Get(uint32_t index, FrameRefType &refType) const;
+  bool Contains(uint32_t index) const
+  {
+    size_t w = index / 64;
+    return w < m_Words.size() && (m_Words[w].referenced & (1ULL << (index % 64))) != 0;
+  }
+
+  // merges in another set's references, as if each had been marked here with its state. The
+  // indices that weren't referenced before are appended to added.
+  void Merge(const FrameRefBits &o, std::vector<uint32_t> &added);
+
+  // iterates over the referenced indices in order, returning NoResourceIndex at the end
+  uint32_t First() const { return FindFrom(0); }
+  uint32_t Next(uint32_t index) const { return FindFrom(index + 1); }
+private:
+  uint32_t FindFrom(uint32_t index) const;
+
+  struct Word
+  {
+    uint64_t referenced;
+    uint64_t read;
+    uint64_t write;
+  };
+
+  std::vector<Word> m_Words;
+};
+
 struct ResourceRecord;
 
 class ResourceRecordHandler
@@ -73,9 +177,66 @@ public:
   virtual void MarkPendingDirty(ResourceId id) = 0;
   virtual void RemoveResourceRecord(ResourceId id) = 0;
   virtual void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType) = 0;
+  virtual void MarkResourcesFrameReferenced(const FrameRefBits &refs) = 0;
   virtual void DestroyResourceRecord(ResourceRecord *record) = 0;
 };
 
+// Runs jobs on the shared job system, used on replay to create the API objects for initial
+// contents while the main thread carries on reading chunks. Jobs are started in the order they
+// were queued but may overlap each other, so they must only use thread-safe API entry points and
+// hand their results to ResourceManager::SetInitialContents. With a single core, jobs run
+// immediately. ReplayRenderer::ExportOutputs also uses it to encode and write files while the
+// replay continues.
+class InitialContentsWorkers
+{
+public:
+  typedef Threading::JobFunction Job;
+
+  void Queue(Job job, void *data);
+
+  // wait for all queued jobs to complete
+  void Finish();
+
+private:
+  // past this many outstanding jobs the queueing thread runs jobs itself, to bound how much decoded
+  // data can be waiting around for a worker
+  static const int32_t MaxQueuedJobs = 64;
+
+  Threading::JobGroup m_Jobs;
+};
+
+// a chunk in a record's stream, along with its ID. IDs come from a global counter, so sorting on
+// them gives the order the chunks were recorded in across all records.
+typedef std::pair<int32_t, Chunk *> RecordChunk;
+
+// gathers the chunks from the records being written out to a capture. Each record's chunks are
+// already in ID order, so they're kept as separate runs pointing into the records and merged at
+// the end, rather than inserting every chunk into one sorted container. The records must not be
+// modified before the list is merged.
+class RecordChunkList
+{
+public:
+  RecordChunkList() : m_Count(0) {}
+  void AddRun(const std::vector<RecordChunk> &chunks)
+  {
+    if(chunks.empty())
+      return;
+
+    m_Runs.push_back(std::make_pair(&chunks[0], &chunks[0] + chunks.size()));
+    m_Count += chunks.size();
+  }
+
+  // number of chunks in all runs, including any duplicated IDs
+  size_t size() const { return m_Count; }
+  // appends all the chunks to the list in ID order. If the same ID appears more than once, only
+  // the first is kept
+  void Merge(std::vector<Chunk *> &chunks) const;
+
+private:
+  std::vector<std::pair<const RecordChunk *, const RecordChunk *> > m_Runs;
+  size_t m_Count;
+};
+
 // This is a generic resource record, that APIs can inherit from and use.
 // A resource is an API object that gets tracked on its own, has dependencies on other resources
 // and has its own stream of chunks.
@@ -100,15 +261,23 @@ struct ResourceRecord
 
     if(lock)
       m_ChunkLock = new Threading::CriticalSection();
+
+    ResIndex = id == ResourceId() ? NoResourceIndex : ResourceIndexGen::Allocate(id);
   }
 
-  ~ResourceRecord() { SAFE_DELETE(m_ChunkLock); }
+  ~ResourceRecord()
+  {
+    SAFE_DELETE(m_ChunkLock);
+
+    if(ResIndex != NoResourceIndex)
+      ResourceIndexGen::Release(ResIndex);
+  }
   void AddParent(ResourceRecord *r)
   {
-    if(Parents.find(r) == Parents.end())
+    if(!Parents.contains(r))
     {
       r->AddRef();
-      Parents.insert(r);
+      Parents.push_back(r);
     }
   }
 
@@ -133,7 +302,7 @@ struct ResourceRecord
   }
 
   void MarkDataUnwritten() { DataWritten = false; }
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(RecordChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -148,7 +317,7 @@ struct ResourceRecord
     }
 
     if(!dataWritten)
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.AddRun(m_Chunks);
   }
 
   void AddRef() { Atomic::Inc32(&RefCount); }
@@ -156,6 +325,7 @@ struct ResourceRecord
   void Delete(ResourceRecordHandler *mgr);
 
   ResourceId GetResourceID() const { return ResID; }
+  uint32_t GetResourceIndex() const { return ResIndex; }
   void RemoveChunk(Chunk *chunk)
   {
     LockChunks();
@@ -173,9 +343,23 @@ struct ResourceRecord
   void AddChunk(Chunk *chunk, int32_t ID = 0)
   {
     LockChunks();
+    // the ID is allocated under the lock so that chunks are always appended in order, only chunks
+    // re-added with an earlier ID need to search for their place.
     if(ID == 0)
       ID = GetID();
-    m_Chunks[ID] = chunk;
+    if(m_Chunks.empty() || m_Chunks.back().first < ID)
+    {
+      m_Chunks.push_back(RecordChunk(ID, chunk));
+    }
+    else
+    {
+      auto it = std::lower_bound(m_Chunks.begin(), m_Chunks.end(), RecordChunk(ID, NULL),
+                                 RecordChunkIDLess());
+      if(it != m_Chunks.end() && it->first == ID)
+        it->second = chunk;
+      else
+        m_Chunks.insert(it, RecordChunk(ID, chunk));
+    }
     UnlockChunks();
   }
 
@@ -192,12 +376,22 @@ struct ResourceRecord
 
   bool HasChunks() const { return !m_Chunks.empty(); }
   size_t NumChunks() const { return m_Chunks.size(); }
+  void GetChunkStats(uint32_t &numChunks, uint64_t &chunkBytes)
+  {
+    LockChunks();
+    numChunks = (uint32_t)m_Chunks.size();
+    chunkBytes = 0;
+    for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
+      chunkBytes += it->second->GetLength();
+    UnlockChunks();
+  }
   void SwapChunks(ResourceRecord *other)
   {
     LockChunks();
     other->LockChunks();
     m_Chunks.swap(other->m_Chunks);
     m_FrameRefs.swap(other->m_FrameRefs);
+    m_FrameRefBits.swap(other->m_FrameRefBits);
     other->UnlockChunks();
     UnlockChunks();
   }
@@ -229,26 +423,33 @@ struct ResourceRecord
   Chunk *GetLastChunk() const
   {
     RDCASSERT(HasChunks());
-    return m_Chunks.rbegin()->second;
+    return m_Chunks.back().second;
   }
 
   int32_t GetLastChunkID() const
   {
     RDCASSERT(HasChunks());
-    return m_Chunks.rbegin()->first;
+    return m_Chunks.back().first;
   }
 
-  void PopChunk() { m_Chunks.erase(m_Chunks.rbegin()->first); }
+  void PopChunk() { m_Chunks.pop_back(); }
+  // allocates the ID a chunk added now would get, for a chunk that is only serialised later but
+  // must keep this place in the record. Pass it back to AddChunk.
+  int32_t ReserveChunkID() { return GetID(); }
   byte *GetDataPtr() { return DataPtr + DataOffset; }
   bool HasDataPtr() { return DataPtr != NULL; }
   void SetDataOffset(uint64_t offs) { DataOffset = offs; }
   void SetDataPtr(byte *ptr) { DataPtr = ptr; }
   void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
   void AddResourceReferences(ResourceRecordHandler *mgr);
-  void AddReferencedIDs(std::set<ResourceId> &ids)
+  // whether this record (e.g. a baked command buffer) references the given resource. Checks a bit
+  // for any resource with a live record, so it's cheap enough to ask at every submit.
+  bool HasFrameReference(ResourceRecord *record)
   {
-    for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
-      ids.insert(it->first);
+    if(record->ResIndex != NoResourceIndex)
+      return m_FrameRefBits.Contains(record->ResIndex);
+
+    return m_FrameRefs.find(record->ResID) != m_FrameRefs.end();
   }
 
   uint64_t Length;
@@ -265,8 +466,11 @@ protected:
   uint64_t DataOffset;
 
   ResourceId ResID;
+  uint32_t ResIndex;
 
-  std::set<ResourceRecord *> Parents;
+  // nearly every record has at most a handful of parents, so these are kept inline and searched
+  // linearly rather than allocating a set node for each
+  SmallVector<ResourceRecord *, 4> Parents;
 
   int32_t GetID()
   {
@@ -275,10 +479,19 @@ protected:
     return Atomic::Inc32(&globalIDCounter);
   }
 
-  std::map<int32_t, Chunk *> m_Chunks;
+  struct RecordChunkIDLess
+  {
+    bool operator()(const RecordChunk &a, const RecordChunk &b) const { return a.first < b.first; }
+  };
+
+  // sorted by ID, which in practice means appended to
+  std::vector<RecordChunk> m_Chunks;
   Threading::CriticalSection *m_ChunkLock;
 
-  map<ResourceId, FrameRefType> m_FrameRefs;
+  // references to resources with a live record are kept by index, so they can be merged into
+  // the frame's references in bulk. Anything else falls back to the map.
+  FrameRefBits m_FrameRefBits;
+  HashMap<ResourceId, FrameRefType> m_FrameRefs;
 };
 
 // the resource manager is a utility class that's not required but is likely wanted by any API
@@ -293,7 +506,7 @@ protected:
 // 'original'
 // resources from the application when it was captured.
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
-class ResourceManager : public ResourceRecordHandler
+class ResourceManager : public ResourceRecordHandler, public ICaptureStatsSource
 {
 public:
   ResourceManager(LogState state, Serialiser *ser);
@@ -303,16 +516,24 @@ public:
 
   struct InitialContentData
   {
-    InitialContentData(WrappedResourceType r, uint32_t n, byte *b) : resource(r), num(n), blob(b) {}
+    InitialContentData(WrappedResourceType r, uint32_t n, byte *b, uint64_t mem = 0)
+        : resource(r), num(n), blob(b), bytes(mem)
+    {
+    }
     InitialContentData()
-        : resource((WrappedResourceType)RecordType::NullResource), num(0), blob(NULL)
+        : resource((WrappedResourceType)RecordType::NullResource), num(0), blob(NULL), bytes(0)
     {
     }
     WrappedResourceType resource;
     uint32_t num;
     byte *blob;
+    // memory held by these contents while capturing, counted against the capture memory budget
+    uint64_t bytes;
   };
 
+  // live resources paired with the initial contents to apply to them
+  typedef vector<pair<WrappedResourceType, InitialContentData> > InitialContentList;
+
   bool IsWriting() { return m_State >= WRITING; }
   bool IsReading() { return m_State < WRITING; }
   ///////////////////////////////////////////
@@ -325,6 +546,10 @@ public:
   inline void RemoveResourceRecord(ResourceId id);
   void DestroyResourceRecord(ResourceRecord *record);
 
+  // reports the memory held by resource records and initial contents chunks
+  void AddCaptureStats(TargetControlMessage::CaptureStatsData &stats,
+                       vector<CaptureRecordStats> &records);
+
   // while capturing or replaying, resources and their live IDs
   void AddCurrentResource(ResourceId id, WrappedResourceType res);
   bool HasCurrentResource(ResourceId id);
@@ -349,6 +574,9 @@ public:
   // of the frame.
   inline void MarkDirtyResource(ResourceId res);
 
+  // marks a set of resources dirty at once, taking the lock only once for all of them
+  void MarkDirtyResources(const set<ResourceId> &res);
+
   // for use when we might be mid-capture, this will get flushed to dirty state before the
   // next frame but is safe to use mid-capture
   void MarkPendingDirty(ResourceId res);
@@ -363,6 +591,11 @@ public:
   // call callbacks to prepare initial contents for dirty resources
   void PrepareInitialContents();
 
+  // called once per frame while idle. If the StageInitialContentsMB capture option is set this
+  // prepares a few more dirty resources' initial contents ahead of time, so that when a capture
+  // starts PrepareInitialContents only has to redo the ones dirtied again since.
+  void StageInitialContents();
+
   InitialContentData GetInitialContents(ResourceId id);
   void SetInitialContents(ResourceId id, InitialContentData contents);
   void SetInitialChunk(ResourceId id, Chunk *chunk);
@@ -376,17 +609,24 @@ public:
   void Serialise_InitialContentsNeeded();
 
   // handle marking a resource referenced for read or write and storing RAW access etc.
-  static bool MarkReferenced(map<ResourceId, FrameRefType> &refs, ResourceId id,
-                             FrameRefType refType);
+  template <typename RefMap>
+  static bool MarkReferenced(RefMap &refs, ResourceId id, FrameRefType refType);
 
   // mark resource referenced somewhere in the main frame-affecting calls.
   // That means this resource should be included in the final serialise out
   inline void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
 
+  // mark a whole set of resources referenced at once, e.g. everything a command buffer referenced
+  // when it's submitted
+  void MarkResourcesFrameReferenced(const FrameRefBits &refs);
+
   // check if this resource was read before being written to - can be used to detect if
   // initial states are necessary
   bool ReadBeforeWrite(ResourceId id);
 
+  // check if this resource has been referenced at all so far in the frame
+  bool IsFrameReferenced(ResourceId id);
+
   ///////////////////////////////////////////
   // Replay-side methods
 
@@ -405,6 +645,13 @@ public:
   ResourceId GetOriginalID(ResourceId id);
   ResourceId GetLiveID(ResourceId id);
 
+  // run a job on a worker thread that creates initial contents, see InitialContentsWorkers. All
+  // queued jobs are complete before initial contents are created, applied or freed.
+  void QueueInitialContentsJob(InitialContentsWorkers::Job job, void *data)
+  {
+    m_InitialContentsWorkers.Queue(job, data);
+  }
+
   // Serialise in which resources need initial contents and set them up.
   void CreateInitialContents();
 
@@ -429,11 +676,31 @@ protected:
 
   virtual bool Force_InitialState(WrappedResourceType res, bool prepare) = 0;
   virtual bool AllowDeletedResource_InitialState() { return false; }
+  // whether initial contents can be prepared ahead of the capture, i.e. every change to the
+  // resource after it's prepared is guaranteed to mark it dirty again
+  virtual bool AllowStaging_InitialState(WrappedResourceType res) { return false; }
+  // memory held by prepared initial contents, counted against the staging budget
+  virtual uint64_t GetSize_InitialState(ResourceId id, InitialContentData initial) { return 0; }
+  // whether all of the resource's contents were discarded in the frame before anything could read
+  // them, so its initial contents aren't needed. On replay it's then set up the same way as a
+  // resource that was created mid-frame.
+  virtual bool Discarded_InitialState(ResourceId id, WrappedResourceType res) { return false; }
   virtual bool Need_InitialStateChunk(WrappedResourceType res) = 0;
   virtual bool Prepare_InitialState(WrappedResourceType res) = 0;
+  // called around a run of Prepare_InitialState calls, so drivers can batch up the readbacks and
+  // wait for them all at once. Every prepared resource's contents must be ready after the end.
+  virtual void BeginPrepare_InitialStates() {}
+  virtual void EndPrepare_InitialStates() {}
   virtual bool Serialise_InitialState(ResourceId id, WrappedResourceType res) = 0;
   virtual void Create_InitialState(ResourceId id, WrappedResourceType live, bool hasData) = 0;
   virtual void Apply_InitialState(WrappedResourceType live, InitialContentData initial) = 0;
+  // applies every resource's initial contents at once, so drivers that can batch the work up into
+  // fewer submissions can override this. By default each is applied on its own, in order.
+  virtual void Apply_InitialStates(const InitialContentList &states)
+  {
+    for(size_t i = 0; i < states.size(); i++)
+      Apply_InitialState(states[i].first, states[i].second);
+  }
 
   LogState m_State;
   Serialiser *m_pSerialiser;
@@ -441,30 +708,76 @@ protected:
   Serialiser *GetSerialiser() { return m_pSerialiser; }
   bool m_InFrame;
 
-  // very coarse lock, protects EVERYTHING. This could certainly be improved and it may be a
-  // bottleneck
-  // for performance. Given that the main use cases are write-rarely read-often the lock should be
-  // optimised
-  // for that as we only want to make sure we're not modifying the objects together, by far the most
-  // common
-  // operation is looking up data.
+  // very coarse lock, protects EVERYTHING except lookups into the tables covered by
+  // m_LookupLock below. Anything that modifies or iterates the resource manager's state holds it.
   Threading::CriticalSection m_Lock;
 
-  // easy optimisation win - don't use maps everywhere. It's convenient but not optimal, and
-  // profiling will
-  // likely prove that some or all of these could be a problem
+  // m_WrapperMap, m_CurrentResourceMap, m_ResourceRecords and m_Replacements are looked up from
+  // every thread recording API calls, so plain lookups only take this for read and don't touch
+  // m_Lock. Modifying those tables needs m_Lock and this for write, so code holding m_Lock can
+  // still iterate them safely. It isn't recursive, so nothing may be called while it's held.
+  Threading::RWLock m_LookupLock;
+
+  // the tables looked up on every wrapped call or replayed chunk are hash maps, the rest are maps
+  // either because they're small or because something relies on iterating them in ID order.
 
   // used during capture - map from real resource to its wrapper (other way can be done just with an
   // Unwrap)
-  map<RealResourceType, WrappedResourceType> m_WrapperMap;
+  HashMap<RealResourceType, WrappedResourceType> m_WrapperMap;
 
   // used during capture - holds resources referenced in current frame (and how they're referenced)
-  map<ResourceId, FrameRefType> m_FrameReferencedResources;
+  HashMap<ResourceId, FrameRefType> m_FrameReferencedResources;
+
+  // references are marked from every thread recording API calls, so each thread collects them in
+  // its own buffer (found through a TLS slot) with only an uncontended lock, and they're merged
+  // into m_FrameReferencedResources by MergeFrameReferences before anything looks at the frame's
+  // references. A thread takes a ref on a record the first time it sees it, so records can't be
+  // destroyed mid-frame while their reference is waiting to be merged. That also keeps the record's
+  // index from being reused, so resources with a record are buffered by index.
+  struct FrameRefBuffer
+  {
+    Threading::CriticalSection lock;
+    FrameRefBits bits;
+    HashMap<ResourceId, FrameRefType> refs;
+    HashMap<ResourceId, RecordType *> records;
+
+    // scratch space for the indices newly referenced by a merge
+    std::vector<uint32_t> added;
+  };
+
+  FrameRefBuffer *GetFrameRefBuffer();
+
+  // takes a ref on the record for a resource this thread just referenced for the first time
+  void HoldFrameRefRecord(FrameRefBuffer *buf, ResourceId id);
+
+  uint64_t m_FrameRefTLSSlot;
+
+  // every thread's buffer, so they can be merged. Protected by m_Lock
+  vector<FrameRefBuffer *> m_FrameRefBuffers;
+
+  // must be called with m_Lock held
+  void MergeFrameReferences();
+  void MergeFrameReference(HashMap<ResourceId, RecordType *> &records, ResourceId id,
+                           FrameRefType refType);
+
+  // insert an initial contents chunk, spilling it to disk if the capture is over its memory budget
+  void InsertInitialChunk(Serialiser *fileSer, Chunk *chunk);
 
   // used during capture - holds resources marked as dirty, needing initial contents
   set<ResourceId> m_DirtyResources;
   set<ResourceId> m_PendingDirtyResources;
 
+  // used during capture - dirty resources whose initial contents were prepared by
+  // StageInitialContents and that haven't been dirtied since, with the size held for each
+  map<ResourceId, uint64_t> m_StagedResources;
+  uint64_t m_StagedBytes;
+
+  // how many resources StageInitialContents prepares in one frame, to spread the cost out
+  static const uint32_t MaxStagedPerFrame = 16;
+
+  // must be called with m_Lock held
+  void UnstageResource(ResourceId id);
+
   // used during capture or replay - holds initial contents
   map<ResourceId, InitialContentData> m_InitialContents;
   // on capture, if a chunk was prepared in Prepare_InitialContents and added, don't re-serialise.
@@ -473,20 +786,23 @@ protected:
 
   // used during capture or replay - map of resources currently alive with their real IDs, used in
   // capture and replay.
-  map<ResourceId, WrappedResourceType> m_CurrentResourceMap;
+  HashMap<ResourceId, WrappedResourceType> m_CurrentResourceMap;
 
   // used during replay - maps back and forth from original id to live id and vice-versa
-  map<ResourceId, ResourceId> m_OriginalIDs, m_LiveIDs;
+  HashMap<ResourceId, ResourceId> m_OriginalIDs, m_LiveIDs;
 
   // used during replay - holds resources allocated and the original id that they represent
   // for a) in-frame creations and b) pre-frame creations respectively.
   map<ResourceId, WrappedResourceType> m_InframeResourceMap, m_LiveResourceMap;
 
   // used during capture - holds resource records by id.
-  map<ResourceId, RecordType *> m_ResourceRecords;
+  HashMap<ResourceId, RecordType *> m_ResourceRecords;
 
   // used during replay - holds current resource replacements
   map<ResourceId, ResourceId> m_Replacements;
+
+  // used during replay - creates initial contents off the main thread
+  InitialContentsWorkers m_InitialContentsWorkers;
 };
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -500,6 +816,13 @@ ResourceManager<WrappedResourceType, RealResourceType, RecordType>::ResourceMana
   m_pSerialiser = ser;
 
   m_InFrame = false;
+
+  m_FrameRefTLSSlot = Threading::AllocateTLSSlot();
+
+  m_StagedBytes = 0;
+
+  if(IsWriting())
+    RenderDoc::Inst().AddCaptureStatsSource(this);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -540,83 +863,193 @@ ResourceManager<WrappedResourceType, RealResourceType, RecordType>::~ResourceMan
   RDCASSERT(m_InitialContents.empty());
   RDCASSERT(m_ResourceRecords.empty());
 
+  RenderDoc::Inst().RemoveCaptureStatsSource(this);
+
+  for(size_t i = 0; i < m_FrameRefBuffers.size(); i++)
+    delete m_FrameRefBuffers[i];
+
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+template <typename RefMap>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkReferenced(
-    map<ResourceId, FrameRefType> &refs, ResourceId id, FrameRefType refType)
+    RefMap &refs, ResourceId id, FrameRefType refType)
 {
-  if(refs.find(id) == refs.end())
-  {
-    if(refType == eFrameRef_Read)
-      refs[id] = eFrameRef_ReadOnly;
-    else if(refType == eFrameRef_Write)
-      refs[id] = eFrameRef_ReadAndWrite;
-    else    // unknown or existing state
-      refs[id] = refType;
+  auto it = refs.find(id);
 
+  if(it == refs.end())
+  {
+    refs[id] = ComposeFrameRef(false, eFrameRef_Unknown, refType);
     return true;
   }
-  else
+
+  it->second = ComposeFrameRef(true, it->second, refType);
+  return false;
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+typename ResourceManager<WrappedResourceType, RealResourceType, RecordType>::FrameRefBuffer *
+ResourceManager<WrappedResourceType, RealResourceType, RecordType>::GetFrameRefBuffer()
+{
+  FrameRefBuffer *buf = (FrameRefBuffer *)Threading::GetTLSValue(m_FrameRefTLSSlot);
+
+  if(buf == NULL)
   {
-    if(refType == eFrameRef_Unknown)
-    {
-      // nothing
-    }
-    else if(refType == eFrameRef_ReadBeforeWrite)
-    {
-      // special case, explicitly set to ReadBeforeWrite for when
-      // we know that this use will likely be a partial-write
-      refs[id] = eFrameRef_ReadBeforeWrite;
-    }
-    else if(refs[id] == eFrameRef_Unknown)
-    {
-      if(refType == eFrameRef_Read || refType == eFrameRef_ReadOnly)
-        refs[id] = eFrameRef_ReadOnly;
-      else
-        refs[id] = eFrameRef_ReadAndWrite;
-    }
-    else if(refs[id] == eFrameRef_ReadOnly && refType == eFrameRef_Write)
-    {
-      refs[id] = eFrameRef_ReadBeforeWrite;
-    }
+    buf = new FrameRefBuffer;
+    Threading::SetTLSValue(m_FrameRefTLSSlot, buf);
+
+    SCOPED_LOCK(m_Lock);
+    m_FrameRefBuffers.push_back(buf);
   }
 
-  return false;
+  return buf;
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::HoldFrameRefRecord(
+    FrameRefBuffer *buf, ResourceId id)
+{
+  RecordType *record = GetResourceRecord(id);
+
+  if(record)
+  {
+    record->AddRef();
+    buf->records[id] = record;
+  }
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkResourceFrameReferenced(
     ResourceId id, FrameRefType refType)
 {
-  SCOPED_LOCK(m_Lock);
-
   if(id == ResourceId())
     return;
 
-  bool newRef = MarkReferenced(m_FrameReferencedResources, id, refType);
+  FrameRefBuffer *buf = GetFrameRefBuffer();
+
+  uint32_t index = ResourceIndexGen::Find(id);
+
+  SCOPED_LOCK(buf->lock);
+
+  bool newRef;
+
+  if(index != NoResourceIndex)
+    newRef = buf->bits.Mark(index, refType);
+  else
+    newRef = MarkReferenced(buf->refs, id, refType);
 
   if(newRef)
+    HoldFrameRefRecord(buf, id);
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType,
+                     RecordType>::MarkResourcesFrameReferenced(const FrameRefBits &refs)
+{
+  if(refs.empty())
+    return;
+
+  FrameRefBuffer *buf = GetFrameRefBuffer();
+
+  SCOPED_LOCK(buf->lock);
+
+  buf->added.clear();
+  buf->bits.Merge(refs, buf->added);
+
+  // the source's records may have been destroyed since it was recorded, in which case there's
+  // nothing to hold a ref on
+  for(size_t i = 0; i < buf->added.size(); i++)
   {
-    RecordType *record = GetResourceRecord(id);
+    ResourceId id = ResourceIndexGen::GetID(buf->added[i]);
+    if(id != ResourceId())
+      HoldFrameRefRecord(buf, id);
+  }
+}
 
-    if(record)
-      record->AddRef();
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MergeFrameReferences()
+{
+  for(size_t i = 0; i < m_FrameRefBuffers.size(); i++)
+  {
+    FrameRefBuffer *buf = m_FrameRefBuffers[i];
+
+    FrameRefBits bits;
+    HashMap<ResourceId, FrameRefType> refs;
+    HashMap<ResourceId, RecordType *> records;
+
+    {
+      SCOPED_LOCK(buf->lock);
+      bits.swap(buf->bits);
+      refs.swap(buf->refs);
+      records.swap(buf->records);
+    }
+
+    // the records referenced by index are still held, so their indices can't have been reused
+    for(uint32_t idx = bits.First(); idx != NoResourceIndex; idx = bits.Next(idx))
+    {
+      FrameRefType refType = eFrameRef_Unknown;
+      bits.Get(idx, refType);
+
+      ResourceId id = ResourceIndexGen::GetID(idx);
+      if(id != ResourceId())
+        MergeFrameReference(records, id, refType);
+    }
+
+    for(auto it = refs.begin(); it != refs.end(); ++it)
+      MergeFrameReference(records, it->first, it->second);
+  }
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MergeFrameReference(
+    HashMap<ResourceId, RecordType *> &records, ResourceId id, FrameRefType refType)
+{
+  // replay what this thread did as a plain read or write, so that a write coming after another
+  // thread's read still makes it read-before-write. The order between threads isn't known
+  // here, but assuming the read came first only errs on the side of keeping initial contents.
+  if(refType == eFrameRef_ReadOnly)
+    refType = eFrameRef_Read;
+  else if(refType == eFrameRef_ReadAndWrite)
+    refType = eFrameRef_Write;
+
+  bool newRef = MarkReferenced(m_FrameReferencedResources, id, refType);
+
+  // if another thread referenced the resource first, the ref this one took isn't needed
+  if(!newRef)
+  {
+    auto rec = records.find(id);
+    if(rec != records.end())
+      rec->second->Delete(this);
   }
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::ReadBeforeWrite(ResourceId id)
 {
-  if(m_FrameReferencedResources.find(id) != m_FrameReferencedResources.end())
-    return m_FrameReferencedResources[id] == eFrameRef_ReadBeforeWrite ||
-           m_FrameReferencedResources[id] == eFrameRef_ReadOnly;
+  SCOPED_LOCK(m_Lock);
+
+  MergeFrameReferences();
+
+  auto it = m_FrameReferencedResources.find(id);
+
+  if(it != m_FrameReferencedResources.end())
+    return it->second == eFrameRef_ReadBeforeWrite || it->second == eFrameRef_ReadOnly;
 
   return false;
 }
 
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::IsFrameReferenced(ResourceId id)
+{
+  SCOPED_LOCK(m_Lock);
+
+  MergeFrameReferences();
+
+  return m_FrameReferencedResources.find(id) != m_FrameReferencedResources.end();
+}
+
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkDirtyResource(ResourceId res)
 {
@@ -626,6 +1059,28 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkDir
     return;
 
   m_DirtyResources.insert(res);
+
+  // any staged contents are now out of date
+  if(!m_StagedResources.empty())
+    UnstageResource(res);
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkDirtyResources(
+    const set<ResourceId> &res)
+{
+  SCOPED_LOCK(m_Lock);
+
+  for(auto it = res.begin(); it != res.end(); ++it)
+  {
+    if(*it == ResourceId())
+      continue;
+
+    m_DirtyResources.insert(*it);
+
+    if(!m_StagedResources.empty())
+      UnstageResource(*it);
+  }
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -671,6 +1126,31 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkCle
   {
     m_DirtyResources.erase(res);
   }
+
+  if(!m_StagedResources.empty())
+    UnstageResource(res);
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::UnstageResource(
+    ResourceId id)
+{
+  auto it = m_StagedResources.find(id);
+
+  if(it == m_StagedResources.end())
+    return;
+
+  m_StagedBytes -= it->second;
+  m_StagedResources.erase(it);
+
+  // the contents themselves are replaced when the resource is prepared again, but a chunk that was
+  // serialised while preparing must go now as it can't be set twice.
+  auto chunk = m_InitialChunks.find(id);
+  if(chunk != m_InitialChunks.end())
+  {
+    SAFE_DELETE(chunk->second);
+    m_InitialChunks.erase(chunk);
+  }
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -687,9 +1167,13 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::SetInit
   {
     ResourceTypeRelease(it->second.resource);
     Serialiser::FreeAlignedBuffer(it->second.blob);
+    RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_InitialContents,
+                                       -int64_t(it->second.bytes));
     m_InitialContents.erase(it);
   }
 
+  RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_InitialContents, int64_t(contents.bytes));
+
   m_InitialContents[id] = contents;
 }
 
@@ -735,6 +1219,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Seriali
 {
   SCOPED_LOCK(m_Lock);
 
+  MergeFrameReferences();
+
   struct WrittenRecord
   {
     ResourceId id;
@@ -782,11 +1268,18 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Seriali
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::FreeInitialContents()
 {
+  m_InitialContentsWorkers.Finish();
+
+  m_StagedResources.clear();
+  m_StagedBytes = 0;
+
   while(!m_InitialContents.empty())
   {
     auto it = m_InitialContents.begin();
     ResourceTypeRelease(it->second.resource);
     Serialiser::FreeAlignedBuffer(it->second.blob);
+    RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_InitialContents,
+                                       -int64_t(it->second.bytes));
     if(!m_InitialContents.empty())
       m_InitialContents.erase(m_InitialContents.begin());
   }
@@ -795,6 +1288,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::FreeIni
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::CreateInitialContents()
 {
+  m_InitialContentsWorkers.Finish();
+
   set<ResourceId> neededInitials;
 
   uint32_t NumWrittenResources = 0;
@@ -822,6 +1317,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::CreateI
     {
       ResourceTypeRelease(it->second.resource);
       Serialiser::FreeAlignedBuffer(it->second.blob);
+      RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_InitialContents,
+                                         -int64_t(it->second.bytes));
       ++it;
       m_InitialContents.erase(id);
     }
@@ -835,22 +1332,24 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::CreateI
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::ApplyInitialContents()
 {
+  m_InitialContentsWorkers.Finish();
+
   RDCDEBUG("Applying initial contents");
-  uint32_t numContents = 0;
+
+  InitialContentList states;
+  states.reserve(m_InitialContents.size());
+
   for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
   {
     ResourceId id = it->first;
 
     if(HasLiveResource(id))
-    {
-      WrappedResourceType live = GetLiveResource(id);
+      states.push_back(std::make_pair(GetLiveResource(id), it->second));
+  }
 
-      numContents++;
+  Apply_InitialStates(states);
 
-      Apply_InitialState(live, it->second);
-    }
-  }
-  RDCDEBUG("Applied %d", numContents);
+  RDCDEBUG("Applied %u", (uint32_t)states.size());
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -868,10 +1367,12 @@ template <typename WrappedResourceType, typename RealResourceType, typename Reco
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertReferencedChunks(
     Serialiser *fileSer)
 {
-  map<int32_t, Chunk *> sortedChunks;
+  RecordChunkList recordlist;
 
   SCOPED_LOCK(m_Lock);
 
+  MergeFrameReferences();
+
   RDCDEBUG("%u frame resource records", (uint32_t)m_FrameReferencedResources.size());
 
   if(RenderDoc::Inst().GetCaptureOptions().RefAllResources)
@@ -881,7 +1382,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertR
       if(!SerialisableResource(it->first, it->second))
         continue;
 
-      it->second->Insert(sortedChunks);
+      it->second->Insert(recordlist);
     }
   }
   else
@@ -890,16 +1391,17 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertR
     {
       RecordType *record = GetResourceRecord(it->first);
       if(record)
-        record->Insert(sortedChunks);
+        record->Insert(recordlist);
     }
   }
 
+  vector<Chunk *> sortedChunks;
+  recordlist.Merge(sortedChunks);
+
   RDCDEBUG("%u frame resource chunks", (uint32_t)sortedChunks.size());
 
-  for(auto it = sortedChunks.begin(); it != sortedChunks.end(); it++)
-  {
-    fileSer->Insert(it->second);
-  }
+  for(size_t i = 0; i < sortedChunks.size(); i++)
+    fileSer->Insert(sortedChunks[i]);
 
   RDCDEBUG("inserted to serialiser");
 }
@@ -912,6 +1414,10 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
   RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)m_DirtyResources.size());
   uint32_t prepared = 0;
 
+  uint32_t staged = 0;
+
+  BeginPrepare_InitialStates();
+
   for(auto it = m_DirtyResources.begin(); it != m_DirtyResources.end(); ++it)
   {
     ResourceId id = *it;
@@ -925,6 +1431,13 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
     if(record == NULL || record->SpecialResource)
       continue;
 
+    // prepared already by StageInitialContents, and not dirtied since
+    if(m_StagedResources.find(id) != m_StagedResources.end())
+    {
+      staged++;
+      continue;
+    }
+
     prepared++;
 
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
@@ -934,7 +1447,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
     Prepare_InitialState(res);
   }
 
-  RDCDEBUG("Prepared %u dirty resources", prepared);
+  RDCDEBUG("Prepared %u dirty resources, %u were already staged", prepared, staged);
 
   prepared = 0;
 
@@ -943,6 +1456,9 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
     if(it->second == (WrappedResourceType)RecordType::NullResource)
       continue;
 
+    if(m_StagedResources.find(it->first) != m_StagedResources.end())
+      continue;
+
     if(Force_InitialState(it->second, true))
     {
       prepared++;
@@ -950,7 +1466,73 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
     }
   }
 
+  EndPrepare_InitialStates();
+
   RDCDEBUG("Force-prepared %u dirty resources", prepared);
+
+  // the staged contents now belong to this capture, and are freed with the rest
+  m_StagedResources.clear();
+  m_StagedBytes = 0;
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::StageInitialContents()
+{
+  uint64_t budget = uint64_t(RenderDoc::Inst().GetCaptureOptions().StageInitialContentsMB) << 20;
+
+  if(budget == 0)
+    return;
+
+  SCOPED_LOCK(m_Lock);
+
+  uint32_t staged = 0;
+
+  BeginPrepare_InitialStates();
+
+  for(auto it = m_DirtyResources.begin(); it != m_DirtyResources.end(); ++it)
+  {
+    if(staged >= MaxStagedPerFrame || m_StagedBytes >= budget)
+      break;
+
+    ResourceId id = *it;
+
+    if(m_StagedResources.find(id) != m_StagedResources.end() || !HasCurrentResource(id))
+      continue;
+
+    RecordType *record = GetResourceRecord(id);
+    WrappedResourceType res = GetCurrentResource(id);
+
+    if(record == NULL || record->SpecialResource || !AllowStaging_InitialState(res))
+      continue;
+
+    if(!Prepare_InitialState(res))
+      continue;
+
+    auto initial = m_InitialContents.find(id);
+    uint64_t size =
+        initial != m_InitialContents.end() ? GetSize_InitialState(id, initial->second) : 0;
+
+    m_StagedResources[id] = size;
+    m_StagedBytes += size;
+    staged++;
+  }
+
+  EndPrepare_InitialStates();
+
+#if ENABLED(VERBOSE_DIRTY_RESOURCES)
+  if(staged > 0)
+    RDCDEBUG("Staged %u resources, %llu bytes held in total", staged, m_StagedBytes);
+#endif
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertInitialChunk(
+    Serialiser *fileSer, Chunk *chunk)
+{
+  if(RenderDoc::Inst().IsOverCaptureMemoryBudget())
+    chunk->Spill();
+
+  fileSer->Insert(chunk);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -959,8 +1541,11 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
 {
   SCOPED_LOCK(m_Lock);
 
+  MergeFrameReferences();
+
   uint32_t dirty = 0;
   uint32_t skipped = 0;
+  uint32_t discarded = 0;
 
   RDCDEBUG("Checking %u possibly dirty resources", (uint32_t)m_DirtyResources.size());
 
@@ -1010,6 +1595,15 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
       continue;
     }
 
+    if(isAlive && Discarded_InitialState(id, res))
+    {
+#if ENABLED(VERBOSE_DIRTY_RESOURCES)
+      RDCDEBUG("Resource %llu was discarded before being read - skipping", id);
+#endif
+      discarded++;
+      continue;
+    }
+
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
     RDCDEBUG("Serialising dirty Resource %llu", id);
 #endif
@@ -1019,6 +1613,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
     if(!Need_InitialStateChunk(res))
     {
       // just need to grab data, don't create chunk
+      m_pSerialiser->SetBufferDedupChunk(Serialiser::NoBufferDedup);
       Serialise_InitialState(id, res);
       continue;
     }
@@ -1026,21 +1621,26 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
     auto preparedChunk = m_InitialChunks.find(id);
     if(preparedChunk != m_InitialChunks.end())
     {
-      fileSerialiser->Insert(preparedChunk->second);
+      InsertInitialChunk(fileSerialiser, preparedChunk->second);
       m_InitialChunks.erase(preparedChunk);
     }
     else
     {
+      // identical contents (default textures, cleared targets, ...) are common, so only store the
+      // first copy of each and have the others refer back to it
+      m_pSerialiser->SetBufferDedupChunk(fileSerialiser->GetNumInsertedChunks());
+
       ScopedContext scope(m_pSerialiser, "Initial Contents", "Initial Contents", INITIAL_CONTENTS,
                           false);
 
       Serialise_InitialState(id, res);
 
-      fileSerialiser->Insert(scope.Get(true));
+      InsertInitialChunk(fileSerialiser, scope.Get(true));
     }
   }
 
-  RDCDEBUG("Serialised %u dirty resources, skipped %u unreferenced", dirty, skipped);
+  RDCDEBUG("Serialised %u dirty resources, skipped %u unreferenced and %u discarded", dirty,
+           skipped, discarded);
 
   dirty = 0;
 
@@ -1056,21 +1656,25 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
       auto preparedChunk = m_InitialChunks.find(it->first);
       if(preparedChunk != m_InitialChunks.end())
       {
-        fileSerialiser->Insert(preparedChunk->second);
+        InsertInitialChunk(fileSerialiser, preparedChunk->second);
         m_InitialChunks.erase(preparedChunk);
       }
       else
       {
+        m_pSerialiser->SetBufferDedupChunk(fileSerialiser->GetNumInsertedChunks());
+
         ScopedContext scope(m_pSerialiser, "Initial Contents", "Initial Contents", INITIAL_CONTENTS,
                             false);
 
         Serialise_InitialState(it->first, it->second);
 
-        fileSerialiser->Insert(scope.Get(true));
+        InsertInitialChunk(fileSerialiser, scope.Get(true));
       }
     }
   }
 
+  m_pSerialiser->ResetBufferDedup();
+
   RDCDEBUG("Force-serialised %u dirty resources", dirty);
 
   // delete/cleanup any chunks that weren't used (maybe the resource was not
@@ -1101,6 +1705,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::ClearRe
 {
   SCOPED_LOCK(m_Lock);
 
+  MergeFrameReferences();
+
   for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
   {
     RecordType *record = GetResourceRecord(it->first);
@@ -1119,7 +1725,10 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Replace
   SCOPED_LOCK(m_Lock);
 
   if(HasLiveResource(to))
+  {
+    SCOPED_WRITELOCK(m_LookupLock);
     m_Replacements[from] = to;
+  }
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -1135,6 +1744,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::RemoveR
 {
   SCOPED_LOCK(m_Lock);
 
+  SCOPED_WRITELOCK(m_LookupLock);
+
   auto it = m_Replacements.find(id);
 
   if(it == m_Replacements.end())
@@ -1147,7 +1758,7 @@ template <typename WrappedResourceType, typename RealResourceType, typename Reco
 RecordType *ResourceManager<WrappedResourceType, RealResourceType, RecordType>::GetResourceRecord(
     ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_LookupLock);
 
   auto it = m_ResourceRecords.find(id);
 
@@ -1160,7 +1771,7 @@ RecordType *ResourceManager<WrappedResourceType, RealResourceType, RecordType>::
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::HasResourceRecord(ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_LookupLock);
 
   auto it = m_ResourceRecords.find(id);
 
@@ -1175,6 +1786,7 @@ RecordType *ResourceManager<WrappedResourceType, RealResourceType, RecordType>::
     ResourceId id)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_LookupLock);
 
   RDCASSERT(m_ResourceRecords.find(id) == m_ResourceRecords.end(), id);
 
@@ -1186,6 +1798,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::RemoveR
     ResourceId id)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_LookupLock);
 
   RDCASSERT(m_ResourceRecords.find(id) != m_ResourceRecords.end(), id);
 
@@ -1199,6 +1812,53 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Destroy
   delete(RecordType *)record;
 }
 
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::AddCaptureStats(
+    TargetControlMessage::CaptureStatsData &stats, vector<CaptureRecordStats> &records)
+{
+  // only take a reference to each record under the lock, so that walking all of their chunks
+  // doesn't stall resource creation on the application's threads
+  vector<RecordType *> snapshot;
+
+  {
+    SCOPED_LOCK(m_Lock);
+
+    snapshot.reserve(m_ResourceRecords.size());
+
+    for(auto it = m_ResourceRecords.begin(); it != m_ResourceRecords.end(); ++it)
+    {
+      it->second->AddRef();
+      snapshot.push_back(it->second);
+    }
+
+    stats.numInitialContents += (uint32_t)m_InitialContents.size();
+
+    for(auto it = m_InitialChunks.begin(); it != m_InitialChunks.end(); ++it)
+    {
+      stats.numInitialChunks++;
+      stats.initialChunkBytes += it->second->GetLength();
+    }
+  }
+
+  for(size_t i = 0; i < snapshot.size(); i++)
+  {
+    CaptureRecordStats rec;
+    rec.ID = snapshot[i]->GetResourceID();
+    snapshot[i]->GetChunkStats(rec.numChunks, rec.chunkBytes);
+
+    stats.numRecords++;
+    stats.numRecordChunks += rec.numChunks;
+    stats.recordChunkBytes += rec.chunkBytes;
+
+    if(rec.numChunks > 0)
+      records.push_back(rec);
+
+    // the resource may have been released since the snapshot, in which case this is the last
+    // reference and the record is destroyed here
+    snapshot[i]->Delete(this);
+  }
+}
+
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::AddWrapper(
     WrappedResourceType wrap, RealResourceType real)
@@ -1214,6 +1874,8 @@ bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::AddWrap
     ret = false;
   }
 
+  SCOPED_WRITELOCK(m_LookupLock);
+
   if(m_WrapperMap[real] != (WrappedResourceType)RecordType::NullResource)
   {
     RDCERR("Overriding wrapper for resource");
@@ -1230,25 +1892,28 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::RemoveW
     RealResourceType real)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_LookupLock);
+
+  auto it = m_WrapperMap.find(real);
 
-  if(real == (RealResourceType)RecordType::NullResource || !HasWrapper(real))
+  if(real == (RealResourceType)RecordType::NullResource || it == m_WrapperMap.end())
   {
     RDCERR(
         "Invalid state removing resource wrapper - real resource is NULL or doesn't have wrapper");
     return;
   }
 
-  m_WrapperMap.erase(m_WrapperMap.find(real));
+  m_WrapperMap.erase(it);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::HasWrapper(RealResourceType real)
 {
-  SCOPED_LOCK(m_Lock);
-
   if(real == (RealResourceType)RecordType::NullResource)
     return false;
 
+  SCOPED_READLOCK(m_LookupLock);
+
   return (m_WrapperMap.find(real) != m_WrapperMap.end());
 }
 
@@ -1256,19 +1921,22 @@ template <typename WrappedResourceType, typename RealResourceType, typename Reco
 WrappedResourceType ResourceManager<WrappedResourceType, RealResourceType, RecordType>::GetWrapper(
     RealResourceType real)
 {
-  SCOPED_LOCK(m_Lock);
-
   if(real == (RealResourceType)RecordType::NullResource)
     return (WrappedResourceType)RecordType::NullResource;
 
-  if(real != (RealResourceType)RecordType::NullResource && !HasWrapper(real))
+  SCOPED_READLOCK(m_LookupLock);
+
+  auto it = m_WrapperMap.find(real);
+
+  if(it == m_WrapperMap.end())
   {
     RDCERR(
         "Invalid state removing resource wrapper - real resource isn't NULL and doesn't have "
         "wrapper");
+    return (WrappedResourceType)RecordType::NullResource;
   }
 
-  return m_WrapperMap[real];
+  return it->second;
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -1362,6 +2030,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::AddCurr
     ResourceId id, WrappedResourceType res)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_LookupLock);
 
   RDCASSERT(m_CurrentResourceMap.find(id) == m_CurrentResourceMap.end(), id);
   m_CurrentResourceMap[id] = res;
@@ -1370,7 +2039,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::AddCurr
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::HasCurrentResource(ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_LookupLock);
 
   return m_CurrentResourceMap.find(id) != m_CurrentResourceMap.end();
 }
@@ -1379,13 +2048,23 @@ template <typename WrappedResourceType, typename RealResourceType, typename Reco
 WrappedResourceType ResourceManager<WrappedResourceType, RealResourceType,
                                     RecordType>::GetCurrentResource(ResourceId id)
 {
-  SCOPED_LOCK(m_Lock);
+  SCOPED_READLOCK(m_LookupLock);
+
+  // follow replacements here rather than recursing, as the lookup lock can't be re-taken
+  auto rep = m_Replacements.find(id);
+  while(rep != m_Replacements.end())
+  {
+    id = rep->second;
+    rep = m_Replacements.find(id);
+  }
 
-  if(m_Replacements.find(id) != m_Replacements.end())
-    return GetCurrentResource(m_Replacements[id]);
+  auto it = m_CurrentResourceMap.find(id);
 
-  RDCASSERT(m_CurrentResourceMap.find(id) != m_CurrentResourceMap.end(), id);
-  return m_CurrentResourceMap[id];
+  RDCASSERT(it != m_CurrentResourceMap.end(), id);
+  if(it == m_CurrentResourceMap.end())
+    return (WrappedResourceType)RecordType::NullResource;
+
+  return it->second;
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -1393,6 +2072,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Release
     ResourceId id)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_WRITELOCK(m_LookupLock);
 
   RDCASSERT(m_CurrentResourceMap.find(id) != m_CurrentResourceMap.end(), id);
   m_CurrentResourceMap.erase(id);
@@ -25,6 +25,10 @@
 
 #pragma once
 
+#include "common/hash_map.h"
+#include "common/timing.h"
+#include "lz4/lz4.h"
+
 inline uint32_t RecvPacket(Network::Socket *sock)
 {
   if(sock == NULL)
@@ -96,6 +100,9 @@ bool SendPacket(Network::Socket *sock, PacketTypeEnum type)
   return true;
 }
 
+// packets up to this size are assembled and sent with one write
+static const uint32_t SmallPacketSize = 4096;
+
 template <typename PacketTypeEnum>
 bool SendPacket(Network::Socket *sock, PacketTypeEnum type, const Serialiser &ser)
 {
@@ -103,10 +110,24 @@ bool SendPacket(Network::Socket *sock, PacketTypeEnum type, const Serialiser &se
     return false;
 
   uint32_t t = (uint32_t)type;
+  uint32_t payloadLength = ser.GetOffset() & 0xffffffff;
+
+  // small packets go out in a single write. Over forwarded connections (e.g. adb) every write
+  // can become its own transport packet, so splitting the header off is expensive.
+  if(payloadLength <= SmallPacketSize)
+  {
+    byte packet[sizeof(uint32_t) * 2 + SmallPacketSize];
+    memcpy(packet, &t, sizeof(t));
+    memcpy(packet + sizeof(t), &payloadLength, sizeof(payloadLength));
+    if(payloadLength > 0)
+      memcpy(packet + sizeof(t) * 2, ser.GetRawPtr(0), payloadLength);
+
+    return sock->SendDataBlocking(packet, sizeof(uint32_t) * 2 + payloadLength);
+  }
+
   if(!sock->SendDataBlocking(&t, sizeof(t)))
     return false;
 
-  uint32_t payloadLength = ser.GetOffset() & 0xffffffff;
   if(!sock->SendDataBlocking(&payloadLength, sizeof(payloadLength)))
     return false;
 
@@ -116,6 +137,196 @@ bool SendPacket(Network::Socket *sock, PacketTypeEnum type, const Serialiser &se
   return true;
 }
 
+// files are sent in chunks of this size. Each chunk is checksummed, so a transfer is verified as
+// it arrives and an interrupted transfer can resume from the last good chunk.
+static const uint32_t ChunkedFileBufferSize = 4 * 1024 * 1024;
+// how many chunks are compressed in parallel before being sent
+static const uint32_t ChunkedFileBatchSize = 4;
+// each chunk is prefixed by its flags, uncompressed length and checksum
+static const uint32_t ChunkedFileChunkHeader = sizeof(uint32_t) * 2 + sizeof(uint64_t);
+// the start of each chunk is test-compressed to decide whether the whole chunk is worth
+// compressing, or should be sent straight from the file.
+static const uint32_t ChunkedFileSampleSize = 64 * 1024;
+
+enum ChunkedFileFlags
+{
+  eChunkedFile_Compressed = 0x1,
+};
+
+inline uint64_t HashFileChunk(const byte *data, size_t len)
+{
+  // include the length so a partial last chunk never matches a full one
+  uint64_t hash = HashMix64(len);
+
+  size_t i = 0;
+  for(; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = HashMix64(hash ^ word);
+  }
+
+  for(; i < len; i++)
+    hash = HashMix64(hash ^ data[i]);
+
+  return hash;
+}
+
+struct FileChunkCompressJob
+{
+  uint64_t offset;
+  byte *src;
+  uint32_t srcLen;
+  bool compress;
+  vector<byte> compressed;
+};
+
+inline bool FileChunkCompressible(const byte *data, uint32_t len, vector<byte> &scratch)
+{
+  scratch.resize(LZ4_COMPRESSBOUND(len));
+
+  int compSize = LZ4_compress((const char *)data, (char *)&scratch[0], (int)len);
+
+  return compSize > 0 && (uint32_t)compSize < len - len / 8;
+}
+
+inline void CompressFileChunk(void *data)
+{
+  FileChunkCompressJob *job = (FileChunkCompressJob *)data;
+
+  job->compressed.resize(LZ4_COMPRESSBOUND(job->srcLen));
+
+  int compSize =
+      LZ4_compress((const char *)job->src, (char *)&job->compressed[0], (int)job->srcLen);
+
+  job->compressed.resize(compSize > 0 ? (size_t)compSize : 0);
+}
+
+// reads the next batch of chunks and starts compressing the ones worth compressing. This runs
+// while the previous batch is still being sent.
+inline void StartFileChunkBatch(FILE *f, FileChunkCompressJob *jobs,
+                                Threading::ThreadHandle *threads, uint32_t batch, byte *buf,
+                                uint32_t bufLen, uint64_t &offs, uint64_t &remaining,
+                                vector<byte> &scratch)
+{
+  for(uint32_t b = 0; b < batch; b++)
+  {
+    FileChunkCompressJob &job = jobs[b];
+
+    job.offset = offs;
+    job.src = buf + b * bufLen;
+    job.srcLen = (uint32_t)RDCMIN((uint64_t)bufLen, remaining);
+    job.compressed.clear();
+
+    // captures often contain sections that are already compressed. Those chunks are never
+    // read in here, they're sent straight from the file.
+    uint32_t sampleLen = RDCMIN(ChunkedFileSampleSize, job.srcLen);
+
+    FileIO::fseek64(f, job.offset, SEEK_SET);
+    FileIO::fread(job.src, 1, sampleLen, f);
+
+    job.compress = FileChunkCompressible(job.src, sampleLen, scratch);
+
+    if(job.compress && job.srcLen > sampleLen)
+      FileIO::fread(job.src + sampleLen, 1, job.srcLen - sampleLen, f);
+
+    offs += job.srcLen;
+    remaining -= job.srcLen;
+  }
+
+  // compress the batch in parallel so the link rather than the CPU limits the transfer
+  for(uint32_t b = 0; b < batch; b++)
+    threads[b] = jobs[b].compress ? Threading::CreateThread(CompressFileChunk, &jobs[b]) : 0;
+}
+
+inline void FinishFileChunkBatch(FileChunkCompressJob *jobs, Threading::ThreadHandle *threads,
+                                 uint32_t batch)
+{
+  for(uint32_t b = 0; b < batch; b++)
+  {
+    if(jobs[b].compress)
+    {
+      Threading::JoinThread(threads[b]);
+      Threading::CloseThread(threads[b]);
+    }
+  }
+}
+
+// a received chunk, decoded, verified and written on its own thread while the next chunk is
+// being received.
+struct FileChunkWriteJob
+{
+  FILE *f;
+  const char *logfile;
+  uint32_t index;
+  vector<byte> payload;
+  vector<byte> chunk;
+  bool success;
+};
+
+inline void WriteFileChunk(void *data)
+{
+  FileChunkWriteJob *job = (FileChunkWriteJob *)data;
+
+  job->success = false;
+
+  if(job->payload.size() < ChunkedFileChunkHeader)
+    return;
+
+  uint32_t flags = 0, rawLength = 0;
+  uint64_t checksum = 0;
+  memcpy(&flags, &job->payload[0], sizeof(flags));
+  memcpy(&rawLength, &job->payload[sizeof(uint32_t)], sizeof(rawLength));
+  memcpy(&checksum, &job->payload[sizeof(uint32_t) * 2], sizeof(checksum));
+
+  const byte *src = &job->payload[0] + ChunkedFileChunkHeader;
+  int srcLength = int(job->payload.size() - ChunkedFileChunkHeader);
+
+  if(flags & eChunkedFile_Compressed)
+  {
+    job->chunk.resize(RDCMAX(1U, rawLength));
+
+    int ret =
+        LZ4_decompress_safe((const char *)src, (char *)&job->chunk[0], srcLength, (int)rawLength);
+
+    if(ret != (int)rawLength)
+    {
+      RDCERR("Failed to decompress chunk %u of '%s'", job->index, job->logfile);
+      return;
+    }
+
+    src = &job->chunk[0];
+  }
+  else if(srcLength != (int)rawLength)
+  {
+    return;
+  }
+
+  // anything already written has been verified, so a retry can resume from this chunk
+  if(HashFileChunk(src, rawLength) != checksum)
+  {
+    RDCERR("Checksum mismatch in chunk %u of '%s'", job->index, job->logfile);
+    return;
+  }
+
+  FileIO::fwrite(src, 1, rawLength, job->f);
+
+  job->success = true;
+}
+
+inline void LogFileTransferRate(const char *verb, const char *logfile, uint64_t fileBytes,
+                                uint64_t wireBytes, double milliseconds)
+{
+  if(fileBytes == 0)
+    return;
+
+  double seconds = RDCMAX(0.001, milliseconds / 1000.0);
+
+  RDCLOG("%s %llu bytes of '%s' as %llu bytes in %.2fs (%.1f MB/s, %.1f MB/s on the wire)", verb,
+         fileBytes, logfile, wireBytes, seconds, double(fileBytes) / (seconds * 1024.0 * 1024.0),
+         double(wireBytes) / (seconds * 1024.0 * 1024.0));
+}
+
 template <typename PacketTypeEnum>
 bool RecvChunkedFile(Network::Socket *sock, PacketTypeEnum packetType, const char *logfile,
                      Serialiser *&ser, float *progress)
@@ -139,47 +350,146 @@ bool RecvChunkedFile(Network::Socket *sock, PacketTypeEnum packetType, const cha
   uint32_t numBuffers;
 
   uint64_t sz = ser->GetSize();
-  ser->SetOffset(sz - sizeof(uint64_t) - sizeof(uint32_t) * 2);
+  uint64_t trailer = sz - sizeof(uint64_t) - sizeof(uint32_t) * 2;
+  ser->SetOffset(trailer);
 
   ser->Serialise("", fileLength);
   ser->Serialise("", bufLength);
   ser->Serialise("", numBuffers);
 
+  // the checksum of every chunk precedes the trailer
+  vector<uint64_t> checksums(numBuffers);
+
+  ser->SetOffset(trailer - sizeof(uint64_t) * numBuffers);
+
+  for(uint32_t i = 0; i < numBuffers; i++)
+    ser->Serialise("", checksums[i]);
+
   ser->SetOffset(0);
 
-  FILE *f = FileIO::fopen(logfile, "wb");
+  // if a previous attempt left part of this file behind, keep every leading chunk that still
+  // matches and only ask for the rest.
+  uint32_t firstBuf = 0;
+
+  FILE *f = FileIO::fopen(logfile, "rb");
+
+  if(f)
+  {
+    FileIO::fseek64(f, 0, SEEK_END);
+    uint64_t existingLength = FileIO::ftell64(f);
+    FileIO::fseek64(f, 0, SEEK_SET);
+
+    if(existingLength <= fileLength && bufLength > 0)
+    {
+      byte *buf = new byte[bufLength];
+
+      for(; firstBuf < numBuffers; firstBuf++)
+      {
+        uint64_t offs = (uint64_t)firstBuf * bufLength;
+        uint32_t len = (uint32_t)RDCMIN((uint64_t)bufLength, fileLength - offs);
+
+        if(offs + len > existingLength || FileIO::fread(buf, 1, len, f) != len)
+          break;
+
+        if(HashFileChunk(buf, len) != checksums[firstBuf])
+          break;
+      }
+
+      delete[] buf;
+    }
+
+    FileIO::fclose(f);
+  }
+
+  {
+    Serialiser reply("", Serialiser::WRITING, false);
+    reply.Serialise("", firstBuf);
+
+    if(!SendPacket(sock, packetType, reply))
+      return false;
+  }
+
+  if(firstBuf > 0)
+    RDCLOG("Resuming transfer of '%s' at chunk %u of %u", logfile, firstBuf, numBuffers);
+
+  f = FileIO::fopen(logfile, firstBuf > 0 ? "r+b" : "wb");
 
   if(f == NULL)
   {
     return false;
   }
 
+  FileIO::fseek64(f, (uint64_t)firstBuf * bufLength, SEEK_SET);
+
   if(progress)
-    *progress = 0.0001f;
+    *progress = RDCMAX(0.0001f, float(firstBuf) / float(RDCMAX(1U, numBuffers)));
 
-  for(uint32_t i = 0; i < numBuffers; i++)
+  PerformanceTimer timer;
+  uint64_t wireBytes = 0;
+
+  // alternate between two chunks, so one is received while the other is decoded and written
+  FileChunkWriteJob jobs[2];
+  FileChunkWriteJob *pending = NULL;
+  Threading::ThreadHandle writer = 0;
+
+  bool success = true;
+
+  for(uint32_t i = firstBuf; i < numBuffers; i++)
   {
-    if(!RecvPacket(sock, type, payload))
+    FileChunkWriteJob &job = jobs[i % 2];
+
+    if(!RecvPacket(sock, type, job.payload) || type != packetType)
     {
-      FileIO::fclose(f);
-      return false;
+      success = false;
+      break;
     }
 
-    if(type != packetType)
+    wireBytes += job.payload.size();
+
+    // wait for the previous chunk so the file is written in order
+    if(pending)
     {
-      FileIO::fclose(f);
-      return false;
+      Threading::JoinThread(writer);
+      Threading::CloseThread(writer);
+
+      success = pending->success;
+      pending = NULL;
+
+      if(!success)
+        break;
+
+      if(progress)
+        *progress = float(i) / float(numBuffers);
     }
 
-    FileIO::fwrite(&payload[0], 1, payload.size(), f);
+    job.f = f;
+    job.logfile = logfile;
+    job.index = i;
+
+    pending = &job;
+    writer = Threading::CreateThread(WriteFileChunk, &job);
+  }
+
+  if(pending)
+  {
+    Threading::JoinThread(writer);
+    Threading::CloseThread(writer);
 
-    if(progress)
-      *progress = float(i + 1) / float(numBuffers);
+    success = success && pending->success;
   }
 
+  if(progress && success)
+    *progress = 1.0f;
+
   FileIO::fclose(f);
 
-  return true;
+  if(success && firstBuf < numBuffers)
+  {
+    uint64_t received = fileLength - RDCMIN(fileLength, (uint64_t)firstBuf * bufLength);
+    LogFileTransferRate("Received", logfile, received, wireBytes, timer.GetMilliseconds());
+  }
+
+  return success;
 }
 
 template <typename PacketTypeEnum>
@@ -200,55 +510,168 @@ bool SendChunkedFile(Network::Socket *sock, PacketTypeEnum type, const char *log
   uint64_t fileLen = FileIO::ftell64(f);
   FileIO::fseek64(f, 0, SEEK_SET);
 
-  uint32_t bufLen = (uint32_t)RDCMIN((uint64_t)4 * 1024 * 1024, fileLen);
+  uint32_t bufLen = (uint32_t)RDCMIN((uint64_t)ChunkedFileBufferSize, fileLen);
+  bufLen = RDCMAX(1U, bufLen);
   uint64_t n = fileLen / (uint64_t)bufLen;
   uint32_t numBufs = (uint32_t)n;
   if(fileLen % (uint64_t)bufLen > 0)
     numBufs++;    // last remaining buffer
 
+  byte *buf = new byte[bufLen * ChunkedFileBatchSize * 2];
+
+  // checksum every chunk up front, so the receiver can tell how much of an earlier attempt it can
+  // keep before anything is sent.
+  vector<uint64_t> checksums(numBufs);
+
+  for(uint32_t i = 0; i < numBufs; i++)
+  {
+    uint32_t len = (uint32_t)RDCMIN((uint64_t)bufLen, fileLen - (uint64_t)i * bufLen);
+
+    FileIO::fread(buf, 1, len, f);
+
+    checksums[i] = HashFileChunk(buf, len);
+  }
+
+  for(uint32_t i = 0; i < numBufs; i++)
+    ser.Serialise("", checksums[i]);
+
   ser.Serialise("", fileLen);
   ser.Serialise("", bufLen);
   ser.Serialise("", numBufs);
 
   if(!SendPacket(sock, type, ser))
   {
+    delete[] buf;
     FileIO::fclose(f);
     return false;
   }
 
-  byte *buf = new byte[bufLen];
+  // the receiver replies with the first chunk it doesn't already have
+  uint32_t firstBuf = 0;
+
+  {
+    PacketTypeEnum replyType;
+    Serialiser *reply = NULL;
+
+    if(!RecvPacket(sock, replyType, &reply) || replyType != type)
+    {
+      SAFE_DELETE(reply);
+      delete[] buf;
+      FileIO::fclose(f);
+      return false;
+    }
+
+    reply->Serialise("", firstBuf);
+    SAFE_DELETE(reply);
+  }
+
+  firstBuf = RDCMIN(firstBuf, numBufs);
+
+  uint64_t offs = RDCMIN(fileLen, (uint64_t)firstBuf * bufLen);
+  uint64_t remaining = fileLen - offs;
 
   uint32_t t = (uint32_t)type;
 
   if(progress)
-    *progress = 0.0001f;
+    *progress = RDCMAX(0.0001f, float(firstBuf) / float(RDCMAX(1U, numBufs)));
 
-  for(uint32_t i = 0; i < numBufs; i++)
+  PerformanceTimer timer;
+  uint64_t wireBytes = 0;
+  uint64_t sentBytes = remaining;
+
+  // two sets of jobs, so the next batch is read and compressed while the current one is sent
+  FileChunkCompressJob jobs[2][ChunkedFileBatchSize];
+  Threading::ThreadHandle threads[2][ChunkedFileBatchSize];
+
+  vector<byte> scratch;
+
+  bool success = true;
+
+  uint32_t set = 0;
+  uint32_t batch = RDCMIN(ChunkedFileBatchSize, numBufs - firstBuf);
+
+  if(batch > 0)
+    StartFileChunkBatch(f, jobs[set], threads[set], batch, buf, bufLen, offs, remaining, scratch);
+
+  for(uint32_t i = firstBuf; i < numBufs; i += ChunkedFileBatchSize)
   {
-    uint32_t payloadLength = RDCMIN(bufLen, (uint32_t)(fileLen & 0xffffffff));
+    FinishFileChunkBatch(jobs[set], threads[set], batch);
+
+    uint32_t next = i + batch;
+    uint32_t nextBatch = RDCMIN(ChunkedFileBatchSize, numBufs - next);
 
-    FileIO::fread(buf, 1, payloadLength, f);
+    if(success && nextBatch > 0)
+      StartFileChunkBatch(f, jobs[set ^ 1], threads[set ^ 1], nextBatch,
+                          buf + (set ^ 1) * ChunkedFileBatchSize * bufLen, bufLen, offs,
+                          remaining, scratch);
+
+    for(uint32_t b = 0; success && b < batch; b++)
+    {
+      FileChunkCompressJob &job = jobs[set][b];
+
+      uint32_t flags = 0;
+      const byte *data = NULL;
+      uint32_t dataLength = job.srcLen;
+
+      if(job.compress)
+      {
+        data = job.src;
+
+        if(!job.compressed.empty() && job.compressed.size() < job.srcLen - job.srcLen / 8)
+        {
+          flags = eChunkedFile_Compressed;
+          data = &job.compressed[0];
+          dataLength = (uint32_t)job.compressed.size();
+        }
+      }
+
+      uint32_t payloadLength = ChunkedFileChunkHeader + dataLength;
+
+      // the packet and chunk headers go out together in one write
+      byte header[sizeof(uint32_t) * 2 + ChunkedFileChunkHeader];
+      memcpy(header, &t, sizeof(t));
+      memcpy(header + sizeof(uint32_t), &payloadLength, sizeof(payloadLength));
+      memcpy(header + sizeof(uint32_t) * 2, &flags, sizeof(flags));
+      memcpy(header + sizeof(uint32_t) * 3, &job.srcLen, sizeof(job.srcLen));
+      memcpy(header + sizeof(uint32_t) * 4, &checksums[i + b], sizeof(uint64_t));
+
+      bool sent = sock->SendDataBlocking(header, sizeof(header));
+
+      if(sent && data)
+        sent = sock->SendDataBlocking(data, dataLength);
+      else if(sent)
+        sent = sock->SendFileBlocking(f, job.offset, dataLength);
+
+      if(!sent)
+      {
+        success = false;
+        break;
+      }
+
+      wireBytes += payloadLength;
+
+      if(progress)
+        *progress = float(i + b + 1) / float(numBufs);
+    }
 
-    if(!sock->SendDataBlocking(&t, sizeof(t)) ||
-       !sock->SendDataBlocking(&payloadLength, sizeof(payloadLength)) ||
-       !sock->SendDataBlocking(buf, payloadLength))
+    // stop here on failure, once the batch that was started has finished
+    if(!success)
     {
+      if(nextBatch > 0)
+        FinishFileChunkBatch(jobs[set ^ 1], threads[set ^ 1], nextBatch);
       break;
     }
 
-    fileLen -= payloadLength;
-    if(progress)
-      *progress = float(i + 1) / float(numBufs);
+    set ^= 1;
+    batch = nextBatch;
   }
 
   delete[] buf;
 
   FileIO::fclose(f);
 
-  if(fileLen != 0)
-  {
-    return false;
-  }
+  if(success)
+    LogFileTransferRate("Sent", logfile, sentBytes, wireBytes, timer.GetMilliseconds());
 
-  return true;
+  return success;
 }
@@ -25,11 +25,17 @@
 
 #include "api/replay/renderdoc_replay.h"
 #include "core/core.h"
+#include "core/entry_profiler.h"
 #include "os/os_specific.h"
 #include "replay/type_helpers.h"
 #include "serialise/serialiser.h"
+#include "serialise/string_utils.h"
 #include "socket_helpers.h"
 
+// bumped whenever a packet changes, so a client and target that don't agree on the format
+// refuse to talk instead of misreading each other. Version 1 was the unversioned handshake.
+static const uint32_t TargetControlProtocolVersion = 2;
+
 enum PacketType
 {
   ePacket_Noop,
@@ -42,8 +48,67 @@ enum PacketType
   ePacket_DeleteCapture,
   ePacket_QueueCapture,
   ePacket_NewChild,
+  ePacket_CaptureStats,
+  ePacket_StreamCaptures,
+  ePacket_ProfileEntryPoints,
+  ePacket_EntryPointStats,
+  ePacket_SpikeCaptureTrigger,
 };
 
+template <>
+void Serialiser::Serialise(const char *name, CaptureRecordStats &el)
+{
+  Serialise("ID", el.ID);
+  Serialise("numChunks", el.numChunks);
+  Serialise("chunkBytes", el.chunkBytes);
+}
+
+template <>
+void Serialiser::Serialise(const char *name, TargetControlMessage::CaptureStatsData &el)
+{
+  Serialise("liveChunks", el.liveChunks);
+  Serialise("peakLiveChunks", el.peakLiveChunks);
+  Serialise("chunkBytes", el.chunkBytes);
+  Serialise("chunkPageBytes", el.chunkPageBytes);
+  Serialise("peakChunkPageBytes", el.peakChunkPageBytes);
+  Serialise("numRecords", el.numRecords);
+  Serialise("numRecordChunks", el.numRecordChunks);
+  Serialise("recordChunkBytes", el.recordChunkBytes);
+  Serialise("numInitialContents", el.numInitialContents);
+  Serialise("numInitialChunks", el.numInitialChunks);
+  Serialise("initialChunkBytes", el.initialChunkBytes);
+  Serialise("ringFrames", el.ringFrames);
+  Serialise("ringBytes", el.ringBytes);
+  Serialise("ringByteLimit", el.ringByteLimit);
+  Serialise("ringFrameOverheadMS", el.ringFrameOverheadMS);
+  Serialise("captureMemoryBytes", el.captureMemoryBytes);
+  Serialise("captureMemoryBudget", el.captureMemoryBudget);
+  Serialise("initialContentBytes", el.initialContentBytes);
+  Serialise("mapShadowBytes", el.mapShadowBytes);
+  Serialise("spilledBytes", el.spilledBytes);
+  Serialise("abortedCaptures", el.abortedCaptures);
+  Serialise("avgFrameTimeMS", el.avgFrameTimeMS);
+  Serialise("minFrameTimeMS", el.minFrameTimeMS);
+  Serialise("maxFrameTimeMS", el.maxFrameTimeMS);
+  Serialise("largestRecords", el.largestRecords);
+}
+
+template <>
+void Serialiser::Serialise(const char *name, EntryPointStats &el)
+{
+  Serialise("name", el.name);
+  Serialise("calls", el.calls);
+  Serialise("sampledCalls", el.sampledCalls);
+  Serialise("totalNS", el.totalNS);
+}
+
+template <>
+void Serialiser::Serialise(const char *name, TargetControlMessage::EntryPointStatsData &el)
+{
+  Serialise("sampleInterval", el.sampleInterval);
+  Serialise("entryPoints", el.entryPoints);
+}
+
 void RenderDoc::TargetControlClientThread(void *s)
 {
   Threading::KeepModuleAlive();
@@ -84,6 +149,10 @@ void RenderDoc::TargetControlClientThread(void *s)
   vector<CaptureData> captures;
   vector<pair<uint32_t, uint32_t> > children;
 
+  // if set, new captures are sent to the client as soon as they're written without waiting for
+  // it to ask for a copy
+  bool streamCaptures = false;
+
   while(client)
   {
     if(RenderDoc::Inst().m_ControlClientThreadShutdown || (client && !client->Connected()))
@@ -127,12 +196,15 @@ void RenderDoc::TargetControlClientThread(void *s)
       ser.Serialise("", captures.back().timestamp);
       ser.Serialise("", path);
 
-      rdctype::array<byte> buf;
-      RENDERDOC_GetThumbnail(captures.back().path.c_str(), eFileType_JPG, 0, &buf);
+      // send the thumbnail kept from when the capture was written, reading it back from the file
+      // would compete with the application for I/O right after an expensive capture
+      vector<byte> thumb = RenderDoc::Inst().GetCaptureThumbnail(idx);
 
-      size_t sz = buf.size();
-      ser.Serialise("", buf.count);
-      ser.SerialiseBuffer("", buf.elems, sz);
+      int32_t thumblen = (int32_t)thumb.size();
+      byte *buf = thumb.empty() ? NULL : &thumb[0];
+      size_t sz = thumb.size();
+      ser.Serialise("", thumblen);
+      ser.SerialiseBuffer("", buf, sz);
     }
     else if(childprocs.size() != children.size())
     {
@@ -211,6 +283,52 @@ void RenderDoc::TargetControlClientThread(void *s)
             RenderDoc::Inst().MarkCaptureRetrieved(id);
           }
         }
+        else if(type == ePacket_CaptureStats)
+        {
+          TargetControlMessage::CaptureStatsData stats;
+          RenderDoc::Inst().GetCaptureStats(stats);
+
+          ser.Serialise("", stats);
+
+          if(!SendPacket(client, ePacket_CaptureStats, ser))
+          {
+            SAFE_DELETE(client);
+            continue;
+          }
+        }
+        else if(type == ePacket_StreamCaptures)
+        {
+          recvser->Serialise("", streamCaptures);
+        }
+        else if(type == ePacket_ProfileEntryPoints)
+        {
+          uint32_t interval = 0;
+          recvser->Serialise("", interval);
+
+          EntryProfiler::SetSampleInterval(interval);
+        }
+        else if(type == ePacket_SpikeCaptureTrigger)
+        {
+          CaptureOptions opts = RenderDoc::Inst().GetCaptureOptions();
+
+          recvser->Serialise("", opts.SpikeCaptureThresholdMS);
+          recvser->Serialise("", opts.SpikeCapturePercent);
+
+          RenderDoc::Inst().SetCaptureOptions(opts);
+        }
+        else if(type == ePacket_EntryPointStats)
+        {
+          TargetControlMessage::EntryPointStatsData stats;
+          EntryProfiler::GetStats(stats);
+
+          ser.Serialise("", stats);
+
+          if(!SendPacket(client, ePacket_EntryPointStats, ser))
+          {
+            SAFE_DELETE(client);
+            continue;
+          }
+        }
 
         SAFE_DELETE(recvser);
       }
@@ -225,6 +343,30 @@ void RenderDoc::TargetControlClientThread(void *s)
       SAFE_DELETE(client);
       continue;
     }
+
+    if(packetType == ePacket_NewCapture && streamCaptures)
+    {
+      uint32_t id = uint32_t(captures.size() - 1);
+
+      ser.Rewind();
+      ser.Serialise("", id);
+
+      if(!SendPacket(client, ePacket_CopyCapture, ser))
+      {
+        SAFE_DELETE(client);
+        continue;
+      }
+
+      ser.Rewind();
+
+      if(!SendChunkedFile(client, ePacket_CopyCapture, captures.back().path.c_str(), ser, NULL))
+      {
+        SAFE_DELETE(client);
+        continue;
+      }
+
+      RenderDoc::Inst().MarkCaptureRetrieved(id);
+    }
   }
 
   // give up our connection
@@ -293,8 +435,20 @@ void RenderDoc::TargetControlServerThread(void *s)
       ser->SerialiseString("", newClient);
       ser->Serialise("", kick);
 
+      uint32_t version = 1;
+      if(!ser->AtEnd())
+        ser->Serialise("", version);
+
       SAFE_DELETE(ser);
 
+      if(version != TargetControlProtocolVersion)
+      {
+        RDCLOG("Target control client using protocol %u, but we are running %u", version,
+               TargetControlProtocolVersion);
+        SAFE_DELETE(client);
+        continue;
+      }
+
       if(newClient.empty())
       {
         SAFE_DELETE(client);
@@ -381,6 +535,9 @@ public:
       ser.SerialiseString("", clientName);
       ser.Serialise("", forceConnection);
 
+      uint32_t version = TargetControlProtocolVersion;
+      ser.Serialise("", version);
+
       if(!SendPacket(m_Socket, ePacket_Handshake, ser))
       {
         SAFE_DELETE(m_Socket);
@@ -484,6 +641,71 @@ public:
     }
   }
 
+  void QueryCaptureStats()
+  {
+    Serialiser ser("", Serialiser::WRITING, false);
+
+    if(!SendPacket(m_Socket, ePacket_CaptureStats, ser))
+    {
+      SAFE_DELETE(m_Socket);
+      return;
+    }
+  }
+
+  void StreamCaptures(const char *localFolder)
+  {
+    m_StreamFolder = localFolder ? localFolder : "";
+
+    Serialiser ser("", Serialiser::WRITING, false);
+
+    bool enable = !m_StreamFolder.empty();
+    ser.Serialise("", enable);
+
+    if(!SendPacket(m_Socket, ePacket_StreamCaptures, ser))
+    {
+      SAFE_DELETE(m_Socket);
+      return;
+    }
+  }
+
+  void ProfileEntryPoints(uint32_t sampleInterval)
+  {
+    Serialiser ser("", Serialiser::WRITING, false);
+
+    ser.Serialise("", sampleInterval);
+
+    if(!SendPacket(m_Socket, ePacket_ProfileEntryPoints, ser))
+    {
+      SAFE_DELETE(m_Socket);
+      return;
+    }
+  }
+
+  void SetSpikeCaptureTrigger(uint32_t thresholdMS, uint32_t averagePercent)
+  {
+    Serialiser ser("", Serialiser::WRITING, false);
+
+    ser.Serialise("", thresholdMS);
+    ser.Serialise("", averagePercent);
+
+    if(!SendPacket(m_Socket, ePacket_SpikeCaptureTrigger, ser))
+    {
+      SAFE_DELETE(m_Socket);
+      return;
+    }
+  }
+
+  void QueryEntryPointStats()
+  {
+    Serialiser ser("", Serialiser::WRITING, false);
+
+    if(!SendPacket(m_Socket, ePacket_EntryPointStats, ser))
+    {
+      SAFE_DELETE(m_Socket);
+      return;
+    }
+  }
+
   void ReceiveMessage(TargetControlMessage *msg)
   {
     if(m_Socket == NULL)
@@ -605,6 +827,30 @@ public:
         RDCLOG("Got a new capture: %d (time %llu) %d byte thumbnail", msg->NewCapture.ID,
                msg->NewCapture.timestamp, thumblen);
 
+        // when streaming, the capture's contents follow straight after
+        if(!m_StreamFolder.empty())
+          m_CaptureCopies[msg->NewCapture.ID] = m_StreamFolder + "/" + basename(path);
+
+        SAFE_DELETE(ser);
+
+        return;
+      }
+      else if(type == ePacket_CaptureStats)
+      {
+        msg->Type = eTargetControlMsg_CaptureStats;
+
+        ser->Serialise("", msg->CaptureStats);
+
+        SAFE_DELETE(ser);
+
+        return;
+      }
+      else if(type == ePacket_EntryPointStats)
+      {
+        msg->Type = eTargetControlMsg_EntryPointStats;
+
+        ser->Serialise("", msg->EntryPoints);
+
         SAFE_DELETE(ser);
 
         return;
@@ -636,6 +882,7 @@ private:
   uint32_t m_PID;
 
   map<uint32_t, string> m_CaptureCopies;
+  string m_StreamFolder;
 
   void GetPacket(PacketType &type, Serialiser *&ser)
   {
@@ -689,6 +936,35 @@ extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_DeleteCapture(ITargetCo
   control->DeleteCapture(remoteID);
 }
 
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_QueryCaptureStats(ITargetControl *control)
+{
+  control->QueryCaptureStats();
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_StreamCaptures(ITargetControl *control,
+                                                                        const char *localFolder)
+{
+  control->StreamCaptures(localFolder);
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC
+TargetControl_ProfileEntryPoints(ITargetControl *control, uint32_t sampleInterval)
+{
+  control->ProfileEntryPoints(sampleInterval);
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC
+TargetControl_QueryEntryPointStats(ITargetControl *control)
+{
+  control->QueryEntryPointStats();
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_SetSpikeCaptureTrigger(
+    ITargetControl *control, uint32_t thresholdMS, uint32_t averagePercent)
+{
+  control->SetSpikeCaptureTrigger(thresholdMS, averagePercent);
+}
+
 extern "C" RENDERDOC_API void RENDERDOC_CC TargetControl_ReceiveMessage(ITargetControl *control,
                                                                         TargetControlMessage *msg)
 {
@@ -56,5 +56,7 @@ DECLARE_EMBED(glsl_ms2array_comp);
 DECLARE_EMBED(glsl_deptharr2ms_frag);
 DECLARE_EMBED(glsl_depthms2arr_frag);
 DECLARE_EMBED(glsl_gles_texsample_h);
+DECLARE_EMBED(glsl_valuesearch_comp);
+DECLARE_EMBED(glsl_texdiff_comp);
 
 #undef DECLARE_EMBED
@@ -112,6 +112,37 @@ BINDING(2) uniform HistogramUBOData
 }
 INST_NAME(histogram_minmax);
 
+BINDING(2) uniform ValueSearchUBOData
+{
+  uint SearchFlags;
+  float SearchMin;
+  float SearchMax;
+  uint SearchChannels;
+
+  float SearchSlice;
+  int SearchMip;
+  int SearchSample;
+  uint SearchMaxMatches;
+
+  vec3 SearchTextureResolution;
+  uint SearchStride;
+
+  uint SearchOffset;
+  uint SearchNumElements;
+  uint SearchElementsPerRow;
+  uint Padding4;
+}
+INST_NAME(value_search);
+
+BINDING(2) uniform TexDiffUBOData
+{
+  uint DiffWidth;
+  uint DiffHeight;
+  float DiffThreshold;
+  uint Padding5;
+}
+INST_NAME(tex_diff);
+
 BINDING(0) uniform MeshUBOData
 {
   mat4 mvp;
@@ -159,7 +190,8 @@ BINDING(0) uniform MeshPickUBOData
 
   uint meshMode;    // triangles, triangle strip, fan, etc...
   uint unproject;
-  vec2 padding;
+  uint numGroupedPrims;    // if non-zero, each workgroup tests one group from the group list
+  uint padding;
 
   mat4 mvp;
 }
@@ -278,6 +310,18 @@ INST_NAME(texdisplay);
 
 #define HGRAM_NUM_BUCKETS 256u
 
+// value search checks one texel or buffer element per thread. Matches past SearchMaxMatches are
+// still counted but not stored. These flags match ValueSearchFlags in replay_enums.h
+#define VALUESEARCH_TEXELS_PER_GROUP 8u
+#define VALUESEARCH_ELEMS_PER_GROUP 64u
+
+#define VALUESEARCH_NAN 0x1u
+#define VALUESEARCH_INF 0x2u
+#define VALUESEARCH_RANGE 0x4u
+
+// texture diffs compare one texel per thread
+#define TEXDIFF_TEXELS_PER_GROUP 8u
+
 #define MESH_OTHER 0u    // this covers points and lines, logic is the same
 #define MESH_TRIANGLE_LIST 1u
 #define MESH_TRIANGLE_STRIP 2u
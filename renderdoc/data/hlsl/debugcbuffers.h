@@ -110,6 +110,35 @@ cbuffer HistogramCBufferData REG(b0)
   float Padding3;
 };
 
+cbuffer ValueSearchCBufferData REG(b0)
+{
+  uint SearchFlags;
+  float SearchMin;
+  float SearchMax;
+  uint SearchChannels;
+
+  float SearchSlice;
+  uint SearchMip;
+  int SearchSample;
+  uint SearchMaxMatches;
+
+  float3 SearchTextureResolution;
+  uint SearchStride;
+
+  uint SearchOffset;
+  uint SearchNumElements;
+  uint SearchElementsPerRow;
+  uint Padding4;
+};
+
+cbuffer TexDiffCBufferData REG(b0)
+{
+  uint DiffWidth;
+  uint DiffHeight;
+  float DiffThreshold;
+  uint Padding5;
+};
+
 // some constants available to both C++ and HLSL for configuring display
 #define CUBEMAP_FACE_RIGHT 0
 #define CUBEMAP_FACE_LEFT 1
@@ -156,6 +185,18 @@ cbuffer HistogramCBufferData REG(b0)
 
 #define HGRAM_NUM_BUCKETS 256
 
+// value search checks one texel or buffer element per thread. Matches past SearchMaxMatches are
+// still counted but not stored. These flags match ValueSearchFlags in replay_enums.h
+#define VALUESEARCH_TEXELS_PER_GROUP 8
+#define VALUESEARCH_ELEMS_PER_GROUP 64
+
+#define VALUESEARCH_NAN 0x1
+#define VALUESEARCH_INF 0x2
+#define VALUESEARCH_RANGE 0x4
+
+// texture diffs compare one texel per thread
+#define TEXDIFF_TEXELS_PER_GROUP 8
+
 #define MESH_OTHER 0    // this covers points and lines, logic is the same
 #define MESH_TRIANGLE_LIST 1
 #define MESH_TRIANGLE_STRIP 2
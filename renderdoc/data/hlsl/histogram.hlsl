@@ -354,3 +354,131 @@ void RENDERDOC_HistogramCS(uint3 tid : SV_GroupThreadID, uint3 gid : SV_GroupID)
 	}
 }
 
+
+// the first uint4 holds the number of matches found, which can be more than were stored. Each
+// match after it is texel x, texel y (or element, 0), component, value bits
+RWByteAddressBuffer ValueSearchDest : register(u0);
+
+ByteAddressBuffer ValueSearchSource : register(t0);
+
+bool IsValueSearchMatch(float val)
+{
+	// test the bits, as the compiler is free to assume isnan() and isinf() are always false
+	uint bits = asuint(val);
+	bool nan = (bits & 0x7f800000) == 0x7f800000 && (bits & 0x007fffff) != 0;
+	bool inf = (bits & 0x7fffffff) == 0x7f800000;
+
+	if((SearchFlags & VALUESEARCH_NAN) && nan)
+		return true;
+
+	if((SearchFlags & VALUESEARCH_INF) && inf)
+		return true;
+
+	if((SearchFlags & VALUESEARCH_RANGE) && !nan && (val < SearchMin || val > SearchMax))
+		return true;
+
+	return false;
+}
+
+void CheckValueSearch(uint x, uint y, uint comp, float val)
+{
+	if(!IsValueSearchMatch(val))
+		return;
+
+	uint idx = 0;
+	ValueSearchDest.InterlockedAdd(0, 1, idx);
+
+	if(idx < SearchMaxMatches)
+		ValueSearchDest.Store4(16 + idx*16, uint4(x, y, comp, asuint(val)));
+}
+
+[numthreads(VALUESEARCH_TEXELS_PER_GROUP, VALUESEARCH_TEXELS_PER_GROUP, 1)]
+void RENDERDOC_ValueSearchCS(uint3 tid : SV_DispatchThreadID)
+{
+	uint3 texDim = uint3(SearchTextureResolution);
+
+	if(tid.x >= texDim.x || tid.y >= texDim.y)
+		return;
+
+	// sample at the texel centre so that converting back to a texel coordinate can't round down
+	float4 data = SampleTextureFloat4(SHADER_RESTYPE, false, (float2(tid.xy) + 0.5f)/float2(texDim.xy),
+									  SearchSlice, SearchMip, SearchSample, SearchTextureResolution);
+
+	for(uint c=0; c < 4; c++)
+	{
+		if(SearchChannels & (1u << c))
+			CheckValueSearch(tid.x, tid.y, c, data[c]);
+	}
+}
+
+[numthreads(VALUESEARCH_ELEMS_PER_GROUP, 1, 1)]
+void RENDERDOC_ValueSearchBufCS(uint3 tid : SV_DispatchThreadID)
+{
+	// elements are spread over rows of groups, to search more than fit in one dispatch dimension
+	uint elem = tid.y*SearchElementsPerRow + tid.x;
+
+	if(tid.x >= SearchElementsPerRow || elem >= SearchNumElements)
+		return;
+
+	// offset and stride are in dwords
+	uint base = SearchOffset + elem*SearchStride;
+
+	for(uint c=0; c < SearchStride && c < 32; c++)
+	{
+		if((SearchChannels & (1u << c)) == 0)
+			continue;
+
+		CheckValueSearch(elem, 0, c, asfloat(ValueSearchSource.Load((base + c)*4)));
+	}
+}
+
+// both inputs are raw float copies of the textures being compared, see SetTextureDiffInput in the
+// D3D11 and D3D12 debug managers
+Texture2D<float4> DiffInputA : register(t0);
+Texture2D<float4> DiffInputB : register(t1);
+
+RWTexture2D<float4> DiffOutput : register(u0);
+
+// the first uint4 holds the bits of the largest difference per channel. The differences are never
+// negative so their bits sort the same as the floats do. x of the second is the number of texels
+// differing by more than the threshold
+RWByteAddressBuffer DiffDest : register(u1);
+
+bool IsNaNBits(float val)
+{
+	uint bits = asuint(val);
+	return (bits & 0x7f800000) == 0x7f800000 && (bits & 0x007fffff) != 0;
+}
+
+[numthreads(TEXDIFF_TEXELS_PER_GROUP, TEXDIFF_TEXELS_PER_GROUP, 1)]
+void RENDERDOC_TexDiffCS(uint3 tid : SV_DispatchThreadID)
+{
+	if(tid.x >= DiffWidth || tid.y >= DiffHeight)
+		return;
+
+	float4 a = DiffInputA.Load(int3(tid.xy, 0));
+	float4 b = DiffInputB.Load(int3(tid.xy, 0));
+
+	float4 diff = abs(a - b);
+
+	for(uint c=0; c < 4; c++)
+	{
+		// equal infinities and matching NaNs aren't differences, but a NaN on one side only is as
+		// different as it gets
+		if(asuint(a[c]) == asuint(b[c]) || (IsNaNBits(a[c]) && IsNaNBits(b[c])))
+			diff[c] = 0.0f;
+		else if(IsNaNBits(diff[c]))
+			diff[c] = asfloat(0x7f800000);
+	}
+
+	DiffOutput[tid.xy] = diff;
+
+	uint prev = 0;
+	DiffDest.InterlockedMax(0, asuint(diff.x), prev);
+	DiffDest.InterlockedMax(4, asuint(diff.y), prev);
+	DiffDest.InterlockedMax(8, asuint(diff.z), prev);
+	DiffDest.InterlockedMax(12, asuint(diff.w), prev);
+
+	if(any(diff > DiffThreshold))
+		DiffDest.InterlockedAdd(16, 1, prev);
+}
@@ -419,12 +419,13 @@ void D3D11DebugManager::FillCBufferVariables(const vector<DXBC::CBufferVariable>
 
 ShaderDebug::State D3D11DebugManager::CreateShaderDebugState(ShaderDebugTrace &trace, int quadIdx,
                                                              DXBC::DXBCFile *dxbc,
+                                                             const ShaderDebug::GlobalState &global,
                                                              vector<byte> *cbufData)
 {
   using namespace DXBC;
   using namespace ShaderDebug;
 
-  State initialState = State(quadIdx, &trace, dxbc, m_WrappedDevice);
+  State initialState = State(quadIdx, &trace, dxbc, global, m_WrappedDevice);
 
   // use pixel shader here to get inputs
 
@@ -592,6 +593,8 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
                                                 ID3D11UnorderedAccessView **UAVs,
                                                 ID3D11ShaderResourceView **SRVs)
 {
+  ShaderDebug::State::Decode(dxbc, global);
+
   for(int i = 0; UAVs != NULL && i + UAVStartSlot < D3D11_1_UAV_SLOT_COUNT; i++)
   {
     int dsti = i + UAVStartSlot;
@@ -679,8 +682,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
             desc.BindFlags = 0;
             desc.Usage = D3D11_USAGE_STAGING;
 
-            ID3D11Texture1D *stagingTex = NULL;
-            m_WrappedDevice->CreateTexture1D(&desc, NULL, &stagingTex);
+            ID3D11Texture1D *stagingTex = GetStagingTexture(desc);
 
             m_WrappedContext->CopyResource(stagingTex, res);
 
@@ -709,7 +711,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
 
             m_WrappedContext->Unmap(stagingTex, udesc.Texture1D.MipSlice);
 
-            SAFE_RELEASE(stagingTex);
+            ReleaseStagingTexture(stagingTex);
           }
           else if(udesc.ViewDimension == D3D11_UAV_DIMENSION_TEXTURE2D ||
                   udesc.ViewDimension == D3D11_UAV_DIMENSION_TEXTURE2DARRAY)
@@ -722,8 +724,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
             desc.BindFlags = 0;
             desc.Usage = D3D11_USAGE_STAGING;
 
-            ID3D11Texture2D *stagingTex = NULL;
-            m_WrappedDevice->CreateTexture2D(&desc, NULL, &stagingTex);
+            ID3D11Texture2D *stagingTex = GetStagingTexture(desc);
 
             m_WrappedContext->CopyResource(stagingTex, res);
 
@@ -754,7 +755,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
 
             m_WrappedContext->Unmap(stagingTex, udesc.Texture2D.MipSlice);
 
-            SAFE_RELEASE(stagingTex);
+            ReleaseStagingTexture(stagingTex);
           }
           else if(udesc.ViewDimension == D3D11_UAV_DIMENSION_TEXTURE3D)
           {
@@ -766,8 +767,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
             desc.BindFlags = 0;
             desc.Usage = D3D11_USAGE_STAGING;
 
-            ID3D11Texture3D *stagingTex = NULL;
-            m_WrappedDevice->CreateTexture3D(&desc, NULL, &stagingTex);
+            ID3D11Texture3D *stagingTex = GetStagingTexture(desc);
 
             m_WrappedContext->CopyResource(stagingTex, res);
 
@@ -791,7 +791,7 @@ void D3D11DebugManager::CreateShaderGlobalState(ShaderDebug::GlobalState &global
 
             m_WrappedContext->Unmap(stagingTex, udesc.Texture3D.MipSlice);
 
-            SAFE_RELEASE(stagingTex);
+            ReleaseStagingTexture(stagingTex);
           }
         }
       }
@@ -1015,7 +1015,7 @@ ShaderDebugTrace D3D11DebugManager::DebugVertex(uint32_t eventID, uint32_t verti
 
   GlobalState global;
   CreateShaderGlobalState(global, dxbc, 0, NULL, rs->VS.SRVs);
-  State initialState = CreateShaderDebugState(ret, -1, dxbc, cbufData);
+  State initialState = CreateShaderDebugState(ret, -1, dxbc, global, cbufData);
 
   for(int32_t i = 0; i < ret.inputs.count; i++)
   {
@@ -1266,14 +1266,28 @@ ShaderDebugTrace D3D11DebugManager::DebugVertex(uint32_t eventID, uint32_t verti
 
   D3D11MarkerRegion simloop("Simulation Loop");
 
+  // ping pong between two states so that stepping re-uses their register storage
+  State nextState;
+
+  State *curState = &initialState;
+  State *newState = &nextState;
+
   for(int cycleCounter = 0;; cycleCounter++)
   {
-    if(initialState.Finished())
+    if(curState->Finished())
       break;
 
-    initialState = initialState.GetNext(global, NULL);
+    curState->GetNext(global, NULL, *newState);
 
-    states.push_back((State)initialState);
+    State *a = curState;
+    curState = newState;
+    newState = a;
+
+    states.push_back((State)*curState);
+
+    // a cancelled debug returns the trace up to this point
+    if(RenderDoc::Inst().IsOperationCancelled())
+      break;
 
     if(cycleCounter == SHADER_DEBUG_WARN_THRESHOLD)
     {
@@ -1870,7 +1884,7 @@ ShaderDebugTrace D3D11DebugManager::DebugPixel(uint32_t eventID, uint32_t x, uin
   {
     DebugHit *hit = winner;
 
-    State initialState = CreateShaderDebugState(traces[destIdx], destIdx, dxbc, cbufData);
+    State initialState = CreateShaderDebugState(traces[destIdx], destIdx, dxbc, global, cbufData);
 
     rdctype::array<ShaderVariable> &ins = traces[destIdx].inputs;
     if(ins.count > 0 && !strcmp(ins[ins.count - 1].name.elems, "vCoverage"))
@@ -2131,9 +2145,9 @@ ShaderDebugTrace D3D11DebugManager::DebugPixel(uint32_t eventID, uint32_t x, uin
     for(size_t i = 0; i < 4; i++)
     {
       if(activeMask[i])
-        newquad[i] = curquad[i].GetNext(global, curquad);
+        curquad[i].GetNext(global, curquad, newquad[i]);
       else
-        newquad[i] = curquad[i];
+        newquad[i].CopyFrom(curquad[i]);
     }
 
     State *a = curquad;
@@ -2225,6 +2239,10 @@ ShaderDebugTrace D3D11DebugManager::DebugPixel(uint32_t eventID, uint32_t x, uin
 
     cycleCounter++;
 
+    // a cancelled debug returns the trace up to this point
+    if(RenderDoc::Inst().IsOperationCancelled())
+      break;
+
     if(cycleCounter == SHADER_DEBUG_WARN_THRESHOLD)
     {
       if(PromptDebugTimeout(DXBC::TYPE_VERTEX, cycleCounter))
@@ -2279,7 +2297,7 @@ ShaderDebugTrace D3D11DebugManager::DebugThread(uint32_t eventID, uint32_t group
 
   GlobalState global;
   CreateShaderGlobalState(global, dxbc, 0, rs->CSUAVs, rs->CS.SRVs);
-  State initialState = CreateShaderDebugState(ret, -1, dxbc, cbufData);
+  State initialState = CreateShaderDebugState(ret, -1, dxbc, global, cbufData);
 
   for(int i = 0; i < 3; i++)
   {
@@ -2291,14 +2309,28 @@ ShaderDebugTrace D3D11DebugManager::DebugThread(uint32_t eventID, uint32_t group
 
   states.push_back((State)initialState);
 
+  // ping pong between two states so that stepping re-uses their register storage
+  State nextState;
+
+  State *curState = &initialState;
+  State *newState = &nextState;
+
   for(int cycleCounter = 0;; cycleCounter++)
   {
-    if(initialState.Finished())
+    if(curState->Finished())
       break;
 
-    initialState = initialState.GetNext(global, NULL);
+    curState->GetNext(global, NULL, *newState);
+
+    State *a = curState;
+    curState = newState;
+    newState = a;
 
-    states.push_back((State)initialState);
+    states.push_back((State)*curState);
+
+    // a cancelled debug returns the trace up to this point
+    if(RenderDoc::Inst().IsOperationCancelled())
+      break;
 
     if(cycleCounter == SHADER_DEBUG_WARN_THRESHOLD)
     {
@@ -2812,6 +2844,18 @@ void D3D11DebugManager::PickPixel(ResourceId texture, uint32_t x, uint32_t y, ui
   m_pImmediateContext->Unmap(m_DebugRender.PickPixelStageTex, 0);
 }
 
+// the format a remapped texture is rendered to. Anything that isn't remapped to RGBA8 is rendered
+// at full float precision, the proxy packs it down further if it needs to.
+static DXGI_FORMAT GetRemapFormat(RemapTextureEnum remap, bool srgb)
+{
+  RDCASSERT(remap == eRemap_RGBA8 || remap == eRemap_RGBA32);
+
+  if(remap == eRemap_RGBA32)
+    return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+  return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+}
+
 byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                         const GetTextureDataParams &params, size_t &dataSize)
 {
@@ -2847,22 +2891,21 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
-      desc.Format =
-          IsSRGBFormat(desc.Format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+      desc.Format = GetRemapFormat(params.remap, IsSRGBFormat(desc.Format));
       desc.ArraySize = 1;
     }
 
     subresource = arrayIdx * mips + mip;
 
-    HRESULT hr = m_WrappedDevice->CreateTexture1D(&desc, NULL, &d);
+    HRESULT hr = S_OK;
+
+    d = GetStagingTexture(desc);
 
     dummyTex = d;
 
-    if(FAILED(hr))
+    if(d == NULL)
     {
-      RDCERR("Couldn't create staging texture to retrieve data. %08x", hr);
+      RDCERR("Couldn't create staging texture to retrieve data.");
       return NULL;
     }
 
@@ -2870,8 +2913,6 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
       subresource = mip;
 
       desc.CPUAccessFlags = 0;
@@ -2885,7 +2926,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target texture to downcast texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         return NULL;
       }
 
@@ -2899,7 +2940,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target rtv to downcast texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         SAFE_RELEASE(rtTex);
         return NULL;
       }
@@ -2987,23 +3028,22 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
-      desc.Format = (IsSRGBFormat(desc.Format) || wrapTex->m_RealDescriptor)
-                        ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
-                        : DXGI_FORMAT_R8G8B8A8_UNORM;
+      desc.Format =
+          GetRemapFormat(params.remap, IsSRGBFormat(desc.Format) || wrapTex->m_RealDescriptor);
       desc.ArraySize = 1;
     }
 
     subresource = arrayIdx * mips + mip;
 
-    HRESULT hr = m_WrappedDevice->CreateTexture2D(&desc, NULL, &d);
+    HRESULT hr = S_OK;
+
+    d = GetStagingTexture(desc);
 
     dummyTex = d;
 
-    if(FAILED(hr))
+    if(d == NULL)
     {
-      RDCERR("Couldn't create staging texture to retrieve data. %08x", hr);
+      RDCERR("Couldn't create staging texture to retrieve data.");
       return NULL;
     }
 
@@ -3011,8 +3051,6 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
       subresource = mip;
 
       desc.CPUAccessFlags = 0;
@@ -3026,7 +3064,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target texture to downcast texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         return NULL;
       }
 
@@ -3040,7 +3078,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target rtv to downcast texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         SAFE_RELEASE(rtTex);
         return NULL;
       }
@@ -3102,7 +3140,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target texture to resolve texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         return NULL;
       }
 
@@ -3145,21 +3183,20 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
-      desc.Format =
-          IsSRGBFormat(desc.Format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+      desc.Format = GetRemapFormat(params.remap, IsSRGBFormat(desc.Format));
     }
 
     subresource = mip;
 
-    HRESULT hr = m_WrappedDevice->CreateTexture3D(&desc, NULL, &d);
+    HRESULT hr = S_OK;
+
+    d = GetStagingTexture(desc);
 
     dummyTex = d;
 
-    if(FAILED(hr))
+    if(d == NULL)
     {
-      RDCERR("Couldn't create staging texture to retrieve data. %08x", hr);
+      RDCERR("Couldn't create staging texture to retrieve data.");
       return NULL;
     }
 
@@ -3167,8 +3204,6 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     if(params.remap)
     {
-      RDCASSERT(params.remap == eRemap_RGBA8);
-
       subresource = mip;
 
       desc.CPUAccessFlags = 0;
@@ -3182,7 +3217,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
       if(FAILED(hr))
       {
         RDCERR("Couldn't create target texture to downcast texture. %08x", hr);
-        SAFE_RELEASE(d);
+        ReleaseStagingTexture(d);
         return NULL;
       }
 
@@ -3207,7 +3242,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
         if(FAILED(hr))
         {
           RDCERR("Couldn't create target rtv to downcast texture. %08x", hr);
-          SAFE_RELEASE(d);
+          ReleaseStagingTexture(d);
           SAFE_RELEASE(rtTex);
           return NULL;
         }
@@ -3301,7 +3336,7 @@ byte *D3D11DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
     RDCERR("Couldn't map staging texture to retrieve data. %08x", hr);
   }
 
-  SAFE_RELEASE(dummyTex);
+  ReleaseStagingTexture(dummyTex);
 
   return ret;
 }
@@ -4112,7 +4147,7 @@ ResourceId D3D11DebugManager::RenderOverlay(ResourceId texid, FormatComponentTyp
         }
       }
 
-      oldstate.ApplyState(m_WrappedContext);
+      oldstate.ApplyChangedState(m_WrappedContext);
 
       if(overlay == eTexOverlay_TriangleSizePass)
       {
@@ -4288,7 +4323,7 @@ ResourceId D3D11DebugManager::RenderOverlay(ResourceId texid, FormatComponentTyp
 
         m_WrappedDevice->ReplayLog(events[i], events[i], eReplay_OnlyDraw);
 
-        oldstate.ApplyState(m_WrappedContext);
+        oldstate.ApplyChangedState(m_WrappedContext);
 
         if(overlay == eTexOverlay_QuadOverdrawPass)
         {
@@ -5288,6 +5323,18 @@ vector<PixelModification> D3D11DebugManager::PixelHistory(vector<EventUsage> eve
 
   for(size_t ev = 0; ev < events.size(); ev++)
   {
+    // if cancelled, the later passes only look at the events queried so far
+    if(RenderDoc::Inst().IsOperationCancelled())
+    {
+      for(size_t i = ev; i < occl.size(); i++)
+        SAFE_RELEASE(occl[i]);
+      occl.resize(ev);
+      events.resize(ev);
+      break;
+    }
+
+    RenderDoc::Inst().SetOperationProgress(0.5f * float(ev) / float(events.size()));
+
     curNumInst = D3D11_SHADER_MAX_INTERFACES;
     curNumScissors = curNumViews = 16;
 
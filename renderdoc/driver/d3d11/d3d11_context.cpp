@@ -138,6 +138,7 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
   m_ResourceID = ResourceIDGen::GetNewUniqueID();
 
   m_ContextRecord = NULL;
+  m_ChunkArena = NULL;
 
   if(!RenderDoc::Inst().IsReplayApp())
   {
@@ -156,6 +157,9 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
 
   m_PresentChunk = false;
 
+  m_EventTimingDisjoint = NULL;
+  m_EventTimingActive = false;
+
   m_DrawcallStack.push_back(&m_ParentDrawcall);
 
   m_CurEventID = 1;
@@ -166,17 +170,25 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
 
   m_CurrentPipelineState = new D3D11RenderState((Serialiser *)NULL);
   m_DeferredSavedState = NULL;
+
+  m_FirstUAVCounterEvent = ~0U;
   m_DoStateVerify = m_State >= WRITING;
 
   if(context->GetType() == D3D11_DEVICE_CONTEXT_IMMEDIATE)
   {
     m_CurrentPipelineState->SetImmediatePipeline(m_pDevice);
+
+    // the full state tracking is only needed while capturing, see AttemptCapture
+    m_CurrentPipelineState->SetHazardTracking(m_State != WRITING_IDLE);
   }
   else
   {
     m_CurrentPipelineState->SetDevice(m_pDevice);
     m_pDevice->SoftRef();
 
+    if(m_State >= WRITING)
+      m_ChunkArena = new ChunkArena();
+
     if(m_State >= WRITING && RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists)
       m_State = WRITING_CAPFRAME;
   }
@@ -197,11 +209,15 @@ WrappedID3D11DeviceContext::~WrappedID3D11DeviceContext()
     SAFE_RELEASE(it->second.query);
   }
 
+  FreeEventTimings();
+
   if(m_State >= WRITING || m_OwnSerialiser)
   {
     SAFE_DELETE(m_pSerialiser);
   }
 
+  SAFE_DELETE(m_ChunkArena);
+
   SAFE_RELEASE(m_pRealContext1);
   SAFE_RELEASE(m_pRealContext2);
   SAFE_RELEASE(m_pRealContext3);
@@ -406,7 +422,7 @@ void WrappedID3D11DeviceContext::BeginCaptureFrame()
     m_AnnotationQueue.clear();
   }
 
-  m_ContextRecord->AddChunk(scope.Get(), 1);
+  m_ContextRecord->AddChunk(scope.Get(m_ChunkArena), 1);
 }
 
 void WrappedID3D11DeviceContext::AttemptCapture()
@@ -440,6 +456,15 @@ void WrappedID3D11DeviceContext::AttemptCapture()
   {
     RDCDEBUG("Immediate Context %llu Attempting capture", GetResourceID());
 
+    // while idle, binds don't resolve hazards so the tracked state may still hold views that D3D
+    // unbound. Fetch what's really bound before it's serialised, and track it exactly from here.
+    if(!m_CurrentPipelineState->IsTrackingHazards())
+    {
+      D3D11RenderState live(this);
+      m_CurrentPipelineState->SyncBindings(live);
+      m_CurrentPipelineState->SetHazardTracking(true);
+    }
+
     m_SuccessfulCapture = true;
     m_FailureReason = CaptureSucceeded;
 
@@ -466,11 +491,146 @@ void WrappedID3D11DeviceContext::FinishCapture()
 
     m_SuccessfulCapture = false;
     m_FailureReason = CaptureSucceeded;
+
+    if(GetType() == D3D11_DEVICE_CONTEXT_IMMEDIATE)
+      m_CurrentPipelineState->SetHazardTracking(false);
+  }
+}
+
+void WrappedID3D11DeviceContext::BeginEventTiming()
+{
+  if(m_State != WRITING_CAPFRAME || GetType() != D3D11_DEVICE_CONTEXT_IMMEDIATE ||
+     !RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings)
+    return;
+
+  const D3D11_QUERY_DESC disjointdesc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+  const D3D11_QUERY_DESC qtimedesc = {D3D11_QUERY_TIMESTAMP, 0};
+
+  HRESULT hr = S_OK;
+
+  // the frequency for all the frame's timestamps comes from one disjoint query around them
+  if(m_EventTimingDisjoint == NULL)
+  {
+    hr = m_pDevice->GetReal()->CreateQuery(&disjointdesc, &m_EventTimingDisjoint);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create event timing disjoint query %08x", hr);
+      m_EventTimingDisjoint = NULL;
+      return;
+    }
+
+    m_pRealContext->Begin(m_EventTimingDisjoint);
+  }
+
+  CapturedEventTiming timing;
+
+  // the event's chunk will be the next one recorded
+  timing.chunkIndex = uint32_t(m_ContextRecord->NumChunks());
+  timing.queries[0] = timing.queries[1] = NULL;
+
+  hr = m_pDevice->GetReal()->CreateQuery(&qtimedesc, &timing.queries[0]);
+  if(SUCCEEDED(hr))
+    hr = m_pDevice->GetReal()->CreateQuery(&qtimedesc, &timing.queries[1]);
+
+  if(FAILED(hr))
+  {
+    RDCERR("Failed to create event timing query %08x", hr);
+    SAFE_RELEASE(timing.queries[0]);
+    SAFE_RELEASE(timing.queries[1]);
+    return;
+  }
+
+  m_pRealContext->End(timing.queries[0]);
+
+  m_EventTimings.push_back(timing);
+  m_EventTimingActive = true;
+}
+
+void WrappedID3D11DeviceContext::EndEventTiming()
+{
+  if(!m_EventTimingActive)
+    return;
+
+  m_pRealContext->End(m_EventTimings.back().queries[1]);
+
+  m_EventTimingActive = false;
+}
+
+void WrappedID3D11DeviceContext::ResolveEventTimings(vector<uint32_t> &chunkIndices,
+                                                     vector<uint64_t> &durations)
+{
+  if(m_EventTimings.empty() || m_EventTimingDisjoint == NULL)
+  {
+    FreeEventTimings();
+    return;
+  }
+
+  m_pRealContext->End(m_EventTimingDisjoint);
+
+  HRESULT hr = S_OK;
+
+  D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+  do
+  {
+    hr = m_pRealContext->GetData(m_EventTimingDisjoint, &disjointData,
+                                 sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT), 0);
+  } while(hr == S_FALSE);
+
+  SAFE_RELEASE(m_EventTimingDisjoint);
+
+  if(FAILED(hr) || disjointData.Disjoint || disjointData.Frequency == 0)
+  {
+    RDCWARN("Dropping event timings, the GPU timestamps were disjoint over the frame");
+    FreeEventTimings();
+    return;
+  }
+
+  double ticksToNanoseconds = 1000000000.0 / double(disjointData.Frequency);
+
+  for(size_t i = 0; i < m_EventTimings.size(); i++)
+  {
+    const CapturedEventTiming &timing = m_EventTimings[i];
+
+    UINT64 start = 0, end = 0;
+    hr = m_pRealContext->GetData(timing.queries[0], &start, sizeof(UINT64), 0);
+    if(hr != S_OK)
+      continue;
+    hr = m_pRealContext->GetData(timing.queries[1], &end, sizeof(UINT64), 0);
+    if(hr != S_OK)
+      continue;
+
+    chunkIndices.push_back(timing.chunkIndex);
+    durations.push_back(end > start ? uint64_t(double(end - start) * ticksToNanoseconds) : 0);
+  }
+
+  FreeEventTimings();
+}
+
+void WrappedID3D11DeviceContext::FreeEventTimings()
+{
+  for(size_t i = 0; i < m_EventTimings.size(); i++)
+  {
+    SAFE_RELEASE(m_EventTimings[i].queries[0]);
+    SAFE_RELEASE(m_EventTimings[i].queries[1]);
+  }
+
+  m_EventTimings.clear();
+  m_EventTimingActive = false;
+
+  // the disjoint query is only still around here if it was never ended
+  if(m_EventTimingDisjoint)
+  {
+    m_pRealContext->End(m_EventTimingDisjoint);
+    SAFE_RELEASE(m_EventTimingDisjoint);
   }
 }
 
 void WrappedID3D11DeviceContext::EndCaptureFrame()
 {
+  vector<uint32_t> timingChunks;
+  vector<uint64_t> timingDurations;
+  ResolveEventTimings(timingChunks, timingDurations);
+
   SCOPED_SERIALISE_CONTEXT(CONTEXT_CAPTURE_FOOTER);
   m_pSerialiser->Serialise("context", m_ResourceID);
 
@@ -491,7 +651,10 @@ void WrappedID3D11DeviceContext::EndCaptureFrame()
     delete call;
   }
 
-  m_ContextRecord->AddChunk(scope.Get());
+  m_pSerialiser->Serialise("timingChunks", timingChunks);
+  m_pSerialiser->Serialise("timingDurations", timingDurations);
+
+  m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 }
 
 void WrappedID3D11DeviceContext::Present(UINT SyncInterval, UINT Flags)
@@ -501,7 +664,7 @@ void WrappedID3D11DeviceContext::Present(UINT SyncInterval, UINT Flags)
   m_pSerialiser->Serialise("SyncInterval", SyncInterval);
   m_pSerialiser->Serialise("Flags", Flags);
 
-  m_ContextRecord->AddChunk(scope.Get());
+  m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 }
 
 void WrappedID3D11DeviceContext::FreeCaptureData()
@@ -558,6 +721,8 @@ void WrappedID3D11DeviceContext::CleanupCapture()
   {
     m_SuccessfulCapture = true;
     m_FailureReason = CaptureSucceeded;
+
+    FreeEventTimings();
   }
 
   m_ContextRecord->LockChunks();
@@ -788,6 +953,31 @@ void WrappedID3D11DeviceContext::ProcessChunk(uint64_t offset, D3D11ChunkType ch
         SAFE_DELETE_ARRAY(stack);
       }
 
+      if(m_pDevice->GetLogVersion() >= 0x00000C)
+      {
+        vector<uint32_t> timingChunks;
+        vector<uint64_t> timingDurations;
+
+        m_pSerialiser->Serialise("timingChunks", timingChunks);
+        m_pSerialiser->Serialise("timingDurations", timingDurations);
+
+        if(m_State == READING)
+        {
+          m_CapturedEventTimings.clear();
+
+          for(size_t i = 0; i < timingChunks.size() && i < timingDurations.size(); i++)
+          {
+            if(timingChunks[i] >= m_ChunkEventIDs.size())
+              continue;
+
+            double seconds = double(timingDurations[i]) / 1000000000.0;
+
+            m_CapturedEventTimings.push_back(CounterResult(
+                m_ChunkEventIDs[timingChunks[i]], eCounter_CapturedGPUDuration, seconds));
+          }
+        }
+      }
+
       if(m_State == READING)
       {
         if(!m_PresentChunk)
@@ -835,6 +1025,15 @@ void WrappedID3D11DeviceContext::ProcessChunk(uint64_t offset, D3D11ChunkType ch
     context->m_State = state;
 }
 
+static bool HasUAVCounter(ID3D11UnorderedAccessView *uav)
+{
+  D3D11_UNORDERED_ACCESS_VIEW_DESC desc;
+  uav->GetDesc(&desc);
+
+  return desc.ViewDimension == D3D11_UAV_DIMENSION_BUFFER &&
+         (desc.Buffer.Flags & (D3D11_BUFFER_UAV_FLAG_COUNTER | D3D11_BUFFER_UAV_FLAG_APPEND)) != 0;
+}
+
 void WrappedID3D11DeviceContext::AddUsage(const FetchDrawcall &d)
 {
   const D3D11RenderState *pipe = m_CurrentPipelineState;
@@ -889,6 +1088,9 @@ void WrappedID3D11DeviceContext::AddUsage(const FetchDrawcall &d)
               (WrappedID3D11UnorderedAccessView1 *)pipe->CSUAVs[i];
           m_ResourceUses[view->GetResourceResID()].push_back(
               EventUsage(e, eUsage_CS_RWResource, view->GetResourceID()));
+
+          if(HasUAVCounter(view))
+            m_FirstUAVCounterEvent = RDCMIN(m_FirstUAVCounterEvent, e);
         }
       }
     }
@@ -911,6 +1113,9 @@ void WrappedID3D11DeviceContext::AddUsage(const FetchDrawcall &d)
       WrappedID3D11UnorderedAccessView1 *view = (WrappedID3D11UnorderedAccessView1 *)pipe->OM.UAVs[i];
       m_ResourceUses[view->GetResourceResID()].push_back(
           EventUsage(e, eUsage_PS_RWResource, view->GetResourceID()));
+
+      if(HasUAVCounter(view))
+        m_FirstUAVCounterEvent = RDCMIN(m_FirstUAVCounterEvent, e);
     }
   }
 
@@ -1421,6 +1626,10 @@ void WrappedID3D11DeviceContext::ReplayLog(LogState readType, uint32_t startEven
   else if(m_State == READING)
   {
     m_CurEventID = 1;
+
+    // the capture header is chunk 0, and has no event
+    m_ChunkEventIDs.clear();
+    m_ChunkEventIDs.push_back(0);
   }
 
   if(m_State == EXECUTING)
@@ -1451,6 +1660,9 @@ void WrappedID3D11DeviceContext::ReplayLog(LogState readType, uint32_t startEven
 
     D3D11ChunkType chunktype = (D3D11ChunkType)m_pSerialiser->PushContext(NULL, NULL, 1, false);
 
+    if(m_State == READING)
+      m_ChunkEventIDs.push_back(m_CurEventID);
+
     ProcessChunk(offset, chunktype, false);
 
     RenderDoc::Inst().SetProgress(FrameEventsRead,
@@ -1792,6 +2004,10 @@ void WrappedID3D11DeviceContext::RecordUpdateStats(ID3D11Resource *res, uint32_t
   if(res == NULL)
     return;
 
+  ResourceId id = GetIDForResource(res);
+  if(m_CPUWrites.find(id) == m_CPUWrites.end())
+    m_CPUWrites[id] = m_CurEventID;
+
   updates.calls += 1;
   updates.clients += (Server == false);
   updates.servers += (Server == true);
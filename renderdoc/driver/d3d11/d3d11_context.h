@@ -29,6 +29,7 @@
 #include <map>
 #include "api/replay/renderdoc_replay.h"
 #include "core/core.h"
+#include "core/entry_profiler.h"
 #include "d3d11_common.h"
 #include "d3d11_manager.h"
 
@@ -184,8 +185,37 @@ private:
 
   map<ResourceId, StreamOutData> m_StreamOutCounters;
 
+  // with eRENDERDOC_Option_CaptureEventTimings, the immediate context writes a pair of timestamp
+  // queries around each draw and dispatch while capturing, keyed by the chunk index of the event
+  // in the context record. These are read back at the end of the frame into the capture footer.
+  struct CapturedEventTiming
+  {
+    uint32_t chunkIndex;
+    ID3D11Query *queries[2];
+  };
+
+  vector<CapturedEventTiming> m_EventTimings;
+  ID3D11Query *m_EventTimingDisjoint;
+  bool m_EventTimingActive;
+
+  // on replay, the event each chunk of the frame was read as and the timings from the footer
+  vector<uint32_t> m_ChunkEventIDs;
+  vector<CounterResult> m_CapturedEventTimings;
+
+  void BeginEventTiming();
+  void EndEventTiming();
+  void ResolveEventTimings(vector<uint32_t> &chunkIndices, vector<uint64_t> &durations);
+  void FreeEventTimings();
+
   map<ResourceId, vector<EventUsage> > m_ResourceUses;
 
+  // the first event that each resource is written from the CPU by an Unmap or UpdateSubresource,
+  // as those don't show up in the resource usage.
+  map<ResourceId, uint32_t> m_CPUWrites;
+
+  // the first event that binds a UAV with a hidden counter, ~0U if there is none
+  uint32_t m_FirstUAVCounterEvent;
+
   WrappedID3D11Device *m_pDevice;
   ID3D11DeviceContext *m_pRealContext;
   ID3D11DeviceContext1 *m_pRealContext1;
@@ -203,6 +233,11 @@ private:
   ResourceId m_ResourceID;
   D3D11ResourceRecord *m_ContextRecord;
 
+  // deferred contexts allocate their chunks from their own arena, so that contexts recorded on
+  // different threads never share an allocation lock. NULL for the immediate context, which uses
+  // the per-thread arenas.
+  ChunkArena *m_ChunkArena;
+
   bool m_OwnSerialiser;
   Serialiser *m_pSerialiser;
   LogState m_State;
@@ -337,12 +372,20 @@ public:
   void MarkResourceReferenced(ResourceId id, FrameRefType refType);
 
   vector<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
+  const map<ResourceId, vector<EventUsage> > &GetAllUsage() { return m_ResourceUses; }
+  const map<ResourceId, uint32_t> &GetCPUWrites() { return m_CPUWrites; }
+  uint32_t GetFirstUAVCounterEvent() { return m_FirstUAVCounterEvent; }
   void ClearMaps();
 
+  // whether a replay stopped at the current event can be picked up again later by a partial
+  // replay, i.e. no map or command list state restore is outstanding.
+  bool CanResumeReplay() { return m_OpenMaps.empty() && m_DeferredSavedState == NULL; }
+
   uint32_t GetEventID() { return m_CurEventID; }
   FetchAPIEvent GetEvent(uint32_t eventID);
 
   const DrawcallTreeNode &GetRootDraw() { return m_ParentDrawcall; }
+  const vector<CounterResult> &GetCapturedEventTimings() { return m_CapturedEventTimings; }
   void ThreadSafe_SetMarker(uint32_t col, const wchar_t *name);
   int ThreadSafe_BeginEvent(uint32_t col, const wchar_t *name);
   int ThreadSafe_EndEvent();
@@ -327,7 +327,7 @@ void WrappedID3D11DeviceContext::UpdateSubresource1(ID3D11Resource *pDstResource
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else
   {
@@ -406,7 +406,7 @@ void WrappedID3D11DeviceContext::CopySubresourceRegion1(ID3D11Resource *pDstReso
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else
   {
@@ -529,7 +529,7 @@ void WrappedID3D11DeviceContext::ClearView(ID3D11View *pView, const FLOAT Color[
 
     SAFE_RELEASE(viewRes);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -642,7 +642,7 @@ void WrappedID3D11DeviceContext::VSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_VSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -790,7 +790,7 @@ void WrappedID3D11DeviceContext::HSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_HSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -938,7 +938,7 @@ void WrappedID3D11DeviceContext::DSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_DSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1086,7 +1086,7 @@ void WrappedID3D11DeviceContext::GSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_GSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1234,7 +1234,7 @@ void WrappedID3D11DeviceContext::PSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_PSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1382,7 +1382,7 @@ void WrappedID3D11DeviceContext::CSSetConstantBuffers1(UINT StartSlot, UINT NumB
     Serialise_CSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, pFirstConstant,
                                     pNumConstants);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   UINT offs[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1751,7 +1751,7 @@ void WrappedID3D11DeviceContext::DiscardResource(ID3D11Resource *pResource)
     m_MissingTracks.insert(GetIDForResource(pResource));
     MarkResourceReferenced(GetIDForResource(pResource), eFrameRef_Write);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -1867,7 +1867,7 @@ void WrappedID3D11DeviceContext::DiscardView(ID3D11View *pResourceView)
 
     SAFE_RELEASE(viewRes);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -1983,7 +1983,7 @@ void WrappedID3D11DeviceContext::DiscardView1(ID3D11View *pResourceView, const D
 
     SAFE_RELEASE(viewRes);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -2050,7 +2050,20 @@ void WrappedID3D11DeviceContext::SwapDeviceContextState(ID3DDeviceContextState *
   if(ppPreviousState)
     *ppPreviousState = wrapped;
 
-  *m_CurrentPipelineState = *((WrappedID3DDeviceContextState *)pState)->state;
+  WrappedID3DDeviceContextState *next = (WrappedID3DDeviceContextState *)pState;
+
+  // a state saved while idle can hold bindings that D3D had unbound, see
+  // D3D11RenderState::SetHazardTracking, so while capturing take what the swap really bound.
+  if(m_State == WRITING_CAPFRAME)
+  {
+    m_CurrentPipelineState->SetHazardTracking(false);
+    D3D11RenderState live(this);
+    m_CurrentPipelineState->SetHazardTracking(true);
+
+    *next->state = live;
+  }
+
+  *m_CurrentPipelineState = *next->state;
 
   DrainAnnotationQueue();
 
@@ -2062,6 +2075,6 @@ void WrappedID3D11DeviceContext::SwapDeviceContextState(ID3DDeviceContextState *
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_SwapDeviceContextState(pState, NULL);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
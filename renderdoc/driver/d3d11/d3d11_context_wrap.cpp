@@ -51,7 +51,7 @@ bool WrappedID3D11DeviceContext::Serialise_SetMarker(uint32_t col, const wchar_t
     name = StringFormat::Wide2UTF8(wname);
   }
 
-  m_pSerialiser->Serialise("Name", name);
+  m_pSerialiser->SerialiseInternedString("Name", name);
 
   if(m_State == READING)
   {
@@ -87,7 +87,7 @@ bool WrappedID3D11DeviceContext::Serialise_PushEvent(uint32_t col, const wchar_t
     name = StringFormat::Wide2UTF8(wname);
   }
 
-  m_pSerialiser->Serialise("Name", name);
+  m_pSerialiser->SerialiseInternedString("Name", name);
 
   if(m_State == READING)
   {
@@ -133,7 +133,7 @@ void WrappedID3D11DeviceContext::SetMarker(uint32_t col, const wchar_t *name)
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_SetMarker(col, name);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -145,7 +145,7 @@ int WrappedID3D11DeviceContext::PushEvent(uint32_t col, const wchar_t *name)
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_PushEvent(col, name);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   return m_MarkerIndentLevel++;
@@ -159,7 +159,7 @@ int WrappedID3D11DeviceContext::PopEvent()
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_PopEvent();
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   return --m_MarkerIndentLevel;
@@ -248,6 +248,8 @@ void WrappedID3D11DeviceContext::DrainAnnotationQueue()
 
 void WrappedID3D11DeviceContext::IAGetInputLayout(ID3D11InputLayout **ppInputLayout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppInputLayout)
   {
     ID3D11InputLayout *real = NULL;
@@ -265,6 +267,8 @@ void WrappedID3D11DeviceContext::IAGetVertexBuffers(UINT StartSlot, UINT NumBuff
                                                     ID3D11Buffer **ppVertexBuffers, UINT *pStrides,
                                                     UINT *pOffsets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11Buffer *real[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {0};
   m_pRealContext->IAGetVertexBuffers(StartSlot, NumBuffers, real, pStrides, pOffsets);
 
@@ -276,7 +280,8 @@ void WrappedID3D11DeviceContext::IAGetVertexBuffers(UINT StartSlot, UINT NumBuff
       ppVertexBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppVertexBuffers[i]);
 
-      RDCASSERT(ppVertexBuffers[i] == m_CurrentPipelineState->IA.VBs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppVertexBuffers[i] == m_CurrentPipelineState->IA.VBs[i + StartSlot]);
     }
 
     // D3D11 really inconsistently tracks these.
@@ -288,6 +293,8 @@ void WrappedID3D11DeviceContext::IAGetVertexBuffers(UINT StartSlot, UINT NumBuff
 void WrappedID3D11DeviceContext::IAGetIndexBuffer(ID3D11Buffer **pIndexBuffer, DXGI_FORMAT *Format,
                                                   UINT *Offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pIndexBuffer)
   {
     ID3D11Buffer *real = NULL;
@@ -297,7 +304,8 @@ void WrappedID3D11DeviceContext::IAGetIndexBuffer(ID3D11Buffer **pIndexBuffer, D
     *pIndexBuffer = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real);
     SAFE_ADDREF(*pIndexBuffer);
 
-    RDCASSERT(*pIndexBuffer == m_CurrentPipelineState->IA.IndexBuffer);
+    RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+              *pIndexBuffer == m_CurrentPipelineState->IA.IndexBuffer);
 
     if(Format)
       RDCASSERT(*Format == m_CurrentPipelineState->IA.IndexFormat);
@@ -308,6 +316,8 @@ void WrappedID3D11DeviceContext::IAGetIndexBuffer(ID3D11Buffer **pIndexBuffer, D
 
 void WrappedID3D11DeviceContext::IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY *pTopology)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_pRealContext->IAGetPrimitiveTopology(pTopology);
   if(pTopology)
     RDCASSERT(*pTopology == m_CurrentPipelineState->IA.Topo);
@@ -329,6 +339,8 @@ bool WrappedID3D11DeviceContext::Serialise_IASetPrimitiveTopology(D3D11_PRIMITIV
 
 void WrappedID3D11DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -339,7 +351,7 @@ void WrappedID3D11DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_IASetPrimitiveTopology(Topology);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->Change(m_CurrentPipelineState->IA.Topo, Topology);
@@ -371,6 +383,8 @@ bool WrappedID3D11DeviceContext::Serialise_IASetInputLayout(ID3D11InputLayout *p
 
 void WrappedID3D11DeviceContext::IASetInputLayout(ID3D11InputLayout *pInputLayout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -383,7 +397,7 @@ void WrappedID3D11DeviceContext::IASetInputLayout(ID3D11InputLayout *pInputLayou
 
     MarkResourceReferenced(GetIDForResource(pInputLayout), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->IA.Layout, pInputLayout);
@@ -447,6 +461,8 @@ void WrappedID3D11DeviceContext::IASetVertexBuffers(UINT StartSlot, UINT NumBuff
                                                     ID3D11Buffer *const *ppVertexBuffers,
                                                     const UINT *pStrides, const UINT *pOffsets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -457,7 +473,7 @@ void WrappedID3D11DeviceContext::IASetVertexBuffers(UINT StartSlot, UINT NumBuff
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_IASetVertexBuffers(StartSlot, NumBuffers, ppVertexBuffers, pStrides, pOffsets);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->IA.VBs, ppVertexBuffers, StartSlot,
@@ -506,6 +522,8 @@ bool WrappedID3D11DeviceContext::Serialise_IASetIndexBuffer(ID3D11Buffer *pIndex
 void WrappedID3D11DeviceContext::IASetIndexBuffer(ID3D11Buffer *pIndexBuffer, DXGI_FORMAT Format,
                                                   UINT Offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -516,7 +534,7 @@ void WrappedID3D11DeviceContext::IASetIndexBuffer(ID3D11Buffer *pIndexBuffer, DX
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_IASetIndexBuffer(pIndexBuffer, Format, Offset);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   if(pIndexBuffer && m_State >= WRITING_CAPFRAME)
@@ -536,6 +554,8 @@ void WrappedID3D11DeviceContext::IASetIndexBuffer(ID3D11Buffer *pIndexBuffer, DX
 void WrappedID3D11DeviceContext::VSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -547,7 +567,8 @@ void WrappedID3D11DeviceContext::VSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -555,6 +576,8 @@ void WrappedID3D11DeviceContext::VSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::VSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -567,7 +590,8 @@ void WrappedID3D11DeviceContext::VSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->VS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->VS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -575,6 +599,8 @@ void WrappedID3D11DeviceContext::VSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::VSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -595,6 +621,8 @@ void WrappedID3D11DeviceContext::VSGetShader(ID3D11VertexShader **ppVertexShader
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppVertexShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -676,6 +704,8 @@ bool WrappedID3D11DeviceContext::Serialise_VSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::VSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -686,7 +716,7 @@ void WrappedID3D11DeviceContext::VSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_VSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->VS.ConstantBuffers,
@@ -750,6 +780,8 @@ bool WrappedID3D11DeviceContext::Serialise_VSSetShaderResources(
 void WrappedID3D11DeviceContext::VSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -760,7 +792,7 @@ void WrappedID3D11DeviceContext::VSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_VSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->VS.SRVs, ppShaderResourceViews,
@@ -826,6 +858,8 @@ bool WrappedID3D11DeviceContext::Serialise_VSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::VSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -836,7 +870,7 @@ void WrappedID3D11DeviceContext::VSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_VSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->VS.Samplers, ppSamplers, StartSlot,
@@ -900,6 +934,8 @@ void WrappedID3D11DeviceContext::VSSetShader(ID3D11VertexShader *pVertexShader,
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -912,7 +948,7 @@ void WrappedID3D11DeviceContext::VSSetShader(ID3D11VertexShader *pVertexShader,
 
     MarkResourceReferenced(GetIDForResource(pVertexShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->VS.Shader,
@@ -938,6 +974,8 @@ void WrappedID3D11DeviceContext::VSSetShader(ID3D11VertexShader *pVertexShader,
 void WrappedID3D11DeviceContext::HSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -949,7 +987,8 @@ void WrappedID3D11DeviceContext::HSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -957,6 +996,8 @@ void WrappedID3D11DeviceContext::HSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::HSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -969,7 +1010,8 @@ void WrappedID3D11DeviceContext::HSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->HS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->HS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -977,6 +1019,8 @@ void WrappedID3D11DeviceContext::HSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::HSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -997,6 +1041,8 @@ void WrappedID3D11DeviceContext::HSGetShader(ID3D11HullShader **ppHullShader,
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppHullShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -1081,6 +1127,8 @@ bool WrappedID3D11DeviceContext::Serialise_HSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::HSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1091,7 +1139,7 @@ void WrappedID3D11DeviceContext::HSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_HSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->HS.ConstantBuffers,
@@ -1155,6 +1203,8 @@ bool WrappedID3D11DeviceContext::Serialise_HSSetShaderResources(
 void WrappedID3D11DeviceContext::HSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1165,7 +1215,7 @@ void WrappedID3D11DeviceContext::HSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_HSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->HS.SRVs, ppShaderResourceViews,
@@ -1231,6 +1281,8 @@ bool WrappedID3D11DeviceContext::Serialise_HSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::HSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1241,7 +1293,7 @@ void WrappedID3D11DeviceContext::HSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_HSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->HS.Samplers, ppSamplers, StartSlot,
@@ -1305,6 +1357,8 @@ void WrappedID3D11DeviceContext::HSSetShader(ID3D11HullShader *pHullShader,
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1317,7 +1371,7 @@ void WrappedID3D11DeviceContext::HSSetShader(ID3D11HullShader *pHullShader,
 
     MarkResourceReferenced(GetIDForResource(pHullShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->HS.Shader,
@@ -1343,6 +1397,8 @@ void WrappedID3D11DeviceContext::HSSetShader(ID3D11HullShader *pHullShader,
 void WrappedID3D11DeviceContext::DSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1354,7 +1410,8 @@ void WrappedID3D11DeviceContext::DSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -1362,6 +1419,8 @@ void WrappedID3D11DeviceContext::DSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::DSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -1374,7 +1433,8 @@ void WrappedID3D11DeviceContext::DSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->DS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->DS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -1382,6 +1442,8 @@ void WrappedID3D11DeviceContext::DSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::DSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -1402,6 +1464,8 @@ void WrappedID3D11DeviceContext::DSGetShader(ID3D11DomainShader **ppDomainShader
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppDomainShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -1485,6 +1549,8 @@ bool WrappedID3D11DeviceContext::Serialise_DSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::DSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1495,7 +1561,7 @@ void WrappedID3D11DeviceContext::DSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->DS.ConstantBuffers,
@@ -1559,6 +1625,8 @@ bool WrappedID3D11DeviceContext::Serialise_DSSetShaderResources(
 void WrappedID3D11DeviceContext::DSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1569,7 +1637,7 @@ void WrappedID3D11DeviceContext::DSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->DS.SRVs, ppShaderResourceViews,
@@ -1635,6 +1703,8 @@ bool WrappedID3D11DeviceContext::Serialise_DSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::DSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1645,7 +1715,7 @@ void WrappedID3D11DeviceContext::DSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->DS.Samplers, ppSamplers, StartSlot,
@@ -1709,6 +1779,8 @@ void WrappedID3D11DeviceContext::DSSetShader(ID3D11DomainShader *pDomainShader,
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1721,7 +1793,7 @@ void WrappedID3D11DeviceContext::DSSetShader(ID3D11DomainShader *pDomainShader,
 
     MarkResourceReferenced(GetIDForResource(pDomainShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->DS.Shader,
@@ -1747,6 +1819,8 @@ void WrappedID3D11DeviceContext::DSSetShader(ID3D11DomainShader *pDomainShader,
 void WrappedID3D11DeviceContext::GSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -1758,7 +1832,8 @@ void WrappedID3D11DeviceContext::GSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -1766,6 +1841,8 @@ void WrappedID3D11DeviceContext::GSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::GSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -1778,7 +1855,8 @@ void WrappedID3D11DeviceContext::GSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->GS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->GS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -1786,6 +1864,8 @@ void WrappedID3D11DeviceContext::GSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::GSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -1806,6 +1886,8 @@ void WrappedID3D11DeviceContext::GSGetShader(ID3D11GeometryShader **ppGeometrySh
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppGeometryShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -1890,6 +1972,8 @@ bool WrappedID3D11DeviceContext::Serialise_GSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::GSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1900,7 +1984,7 @@ void WrappedID3D11DeviceContext::GSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_GSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->GS.ConstantBuffers,
@@ -1964,6 +2048,8 @@ bool WrappedID3D11DeviceContext::Serialise_GSSetShaderResources(
 void WrappedID3D11DeviceContext::GSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -1974,7 +2060,7 @@ void WrappedID3D11DeviceContext::GSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_GSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->GS.SRVs, ppShaderResourceViews,
@@ -2040,6 +2126,8 @@ bool WrappedID3D11DeviceContext::Serialise_GSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::GSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2050,7 +2138,7 @@ void WrappedID3D11DeviceContext::GSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_GSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->GS.Samplers, ppSamplers, StartSlot,
@@ -2114,6 +2202,8 @@ void WrappedID3D11DeviceContext::GSSetShader(ID3D11GeometryShader *pShader,
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2126,7 +2216,7 @@ void WrappedID3D11DeviceContext::GSSetShader(ID3D11GeometryShader *pShader,
 
     MarkResourceReferenced(GetIDForResource(pShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->GS.Shader,
@@ -2151,6 +2241,8 @@ void WrappedID3D11DeviceContext::GSSetShader(ID3D11GeometryShader *pShader,
 
 void WrappedID3D11DeviceContext::SOGetTargets(UINT NumBuffers, ID3D11Buffer **ppSOTargets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSOTargets)
   {
     ID3D11Buffer *real[D3D11_SO_BUFFER_SLOT_COUNT] = {0};
@@ -2162,7 +2254,8 @@ void WrappedID3D11DeviceContext::SOGetTargets(UINT NumBuffers, ID3D11Buffer **pp
       ppSOTargets[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSOTargets[i]);
 
-      RDCASSERT(ppSOTargets[i] == m_CurrentPipelineState->SO.Buffers[i]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppSOTargets[i] == m_CurrentPipelineState->SO.Buffers[i]);
     }
   }
 }
@@ -2269,6 +2362,8 @@ bool WrappedID3D11DeviceContext::Serialise_SOSetTargets(UINT NumBuffers_,
 void WrappedID3D11DeviceContext::SOSetTargets(UINT NumBuffers, ID3D11Buffer *const *ppSOTargets,
                                               const UINT *pOffsets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2279,7 +2374,7 @@ void WrappedID3D11DeviceContext::SOSetTargets(UINT NumBuffers, ID3D11Buffer *con
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_SOSetTargets(NumBuffers, ppSOTargets, pOffsets);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   ID3D11Buffer *setbufs[4] = {0};
@@ -2370,6 +2465,8 @@ void WrappedID3D11DeviceContext::SOSetTargets(UINT NumBuffers, ID3D11Buffer *con
 
 void WrappedID3D11DeviceContext::RSGetViewports(UINT *pNumViewports, D3D11_VIEWPORT *pViewports)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_pRealContext->RSGetViewports(pNumViewports, pViewports);
 
   if(pViewports)
@@ -2379,6 +2476,8 @@ void WrappedID3D11DeviceContext::RSGetViewports(UINT *pNumViewports, D3D11_VIEWP
 
 void WrappedID3D11DeviceContext::RSGetScissorRects(UINT *pNumRects, D3D11_RECT *pRects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_pRealContext->RSGetScissorRects(pNumRects, pRects);
 
   if(pRects)
@@ -2388,6 +2487,8 @@ void WrappedID3D11DeviceContext::RSGetScissorRects(UINT *pNumRects, D3D11_RECT *
 
 void WrappedID3D11DeviceContext::RSGetState(ID3D11RasterizerState **ppRasterizerState)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppRasterizerState)
   {
     ID3D11RasterizerState *real = NULL;
@@ -2445,6 +2546,8 @@ bool WrappedID3D11DeviceContext::Serialise_RSSetViewports(UINT NumViewports_,
 
 void WrappedID3D11DeviceContext::RSSetViewports(UINT NumViewports, const D3D11_VIEWPORT *pViewports)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2455,7 +2558,7 @@ void WrappedID3D11DeviceContext::RSSetViewports(UINT NumViewports, const D3D11_V
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_RSSetViewports(NumViewports, pViewports);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->Change(m_CurrentPipelineState->RS.Viewports, pViewports, 0, NumViewports);
@@ -2487,6 +2590,8 @@ bool WrappedID3D11DeviceContext::Serialise_RSSetScissorRects(UINT NumRects_, con
 
 void WrappedID3D11DeviceContext::RSSetScissorRects(UINT NumRects, const D3D11_RECT *pRects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2497,7 +2602,7 @@ void WrappedID3D11DeviceContext::RSSetScissorRects(UINT NumRects, const D3D11_RE
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_RSSetScissorRects(NumRects, pRects);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->Change(m_CurrentPipelineState->RS.Scissors, pRects, 0, NumRects);
@@ -2532,6 +2637,8 @@ bool WrappedID3D11DeviceContext::Serialise_RSSetState(ID3D11RasterizerState *pRa
 
 void WrappedID3D11DeviceContext::RSSetState(ID3D11RasterizerState *pRasterizerState)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2542,7 +2649,7 @@ void WrappedID3D11DeviceContext::RSSetState(ID3D11RasterizerState *pRasterizerSt
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_RSSetState(pRasterizerState);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->RS.State, pRasterizerState);
@@ -2559,6 +2666,8 @@ void WrappedID3D11DeviceContext::RSSetState(ID3D11RasterizerState *pRasterizerSt
 void WrappedID3D11DeviceContext::PSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -2570,7 +2679,8 @@ void WrappedID3D11DeviceContext::PSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -2578,6 +2688,8 @@ void WrappedID3D11DeviceContext::PSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::PSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -2590,7 +2702,8 @@ void WrappedID3D11DeviceContext::PSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->PS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->PS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -2598,6 +2711,8 @@ void WrappedID3D11DeviceContext::PSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::PSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -2618,6 +2733,8 @@ void WrappedID3D11DeviceContext::PSGetShader(ID3D11PixelShader **ppPixelShader,
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppPixelShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -2699,6 +2816,8 @@ bool WrappedID3D11DeviceContext::Serialise_PSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::PSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2709,7 +2828,7 @@ void WrappedID3D11DeviceContext::PSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_PSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->PS.ConstantBuffers,
@@ -2771,6 +2890,8 @@ bool WrappedID3D11DeviceContext::Serialise_PSSetShaderResources(
 void WrappedID3D11DeviceContext::PSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2781,7 +2902,7 @@ void WrappedID3D11DeviceContext::PSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->PS.SRVs, ppShaderResourceViews,
@@ -2845,6 +2966,8 @@ bool WrappedID3D11DeviceContext::Serialise_PSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::PSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2855,7 +2978,7 @@ void WrappedID3D11DeviceContext::PSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_PSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->PS.Samplers, ppSamplers, StartSlot,
@@ -2919,6 +3042,8 @@ void WrappedID3D11DeviceContext::PSSetShader(ID3D11PixelShader *pPixelShader,
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -2931,7 +3056,7 @@ void WrappedID3D11DeviceContext::PSSetShader(ID3D11PixelShader *pPixelShader,
 
     MarkResourceReferenced(GetIDForResource(pPixelShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->PS.Shader,
@@ -2958,6 +3083,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargets(UINT NumViews,
                                                     ID3D11RenderTargetView **ppRenderTargetViews,
                                                     ID3D11DepthStencilView **ppDepthStencilView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppRenderTargetViews == NULL && ppDepthStencilView == NULL)
     return;
 
@@ -2978,7 +3105,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargets(UINT NumViews,
           (ID3D11RenderTargetView *)m_pDevice->GetResourceManager()->GetWrapper(rtv[i]);
       SAFE_ADDREF(ppRenderTargetViews[i]);
 
-      RDCASSERT(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
     }
   }
 
@@ -2987,7 +3115,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargets(UINT NumViews,
     *ppDepthStencilView = (ID3D11DepthStencilView *)m_pDevice->GetResourceManager()->GetWrapper(dsv);
     SAFE_ADDREF(*ppDepthStencilView);
 
-    RDCASSERT(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
+    RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+              *ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
   }
 }
 
@@ -2996,6 +3125,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
     ID3D11DepthStencilView **ppDepthStencilView, UINT UAVStartSlot, UINT NumUAVs,
     ID3D11UnorderedAccessView **ppUnorderedAccessViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppRenderTargetViews == NULL && ppDepthStencilView == NULL && ppUnorderedAccessViews == NULL)
     return;
 
@@ -3021,7 +3152,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
           (ID3D11RenderTargetView *)m_pDevice->GetResourceManager()->GetWrapper(rtv[i]);
       SAFE_ADDREF(ppRenderTargetViews[i]);
 
-      RDCASSERT(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
     }
   }
 
@@ -3030,7 +3162,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
     *ppDepthStencilView = (ID3D11DepthStencilView *)m_pDevice->GetResourceManager()->GetWrapper(dsv);
     SAFE_ADDREF(*ppDepthStencilView);
 
-    RDCASSERT(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
+    RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+              *ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
   }
 
   if(ppUnorderedAccessViews)
@@ -3041,7 +3174,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
           (ID3D11UnorderedAccessView *)m_pDevice->GetResourceManager()->GetWrapper(uav[i]);
       SAFE_ADDREF(ppUnorderedAccessViews[i]);
 
-      RDCASSERT(ppUnorderedAccessViews[i] == m_CurrentPipelineState->OM.UAVs[i]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppUnorderedAccessViews[i] == m_CurrentPipelineState->OM.UAVs[i]);
     }
   }
 }
@@ -3049,6 +3183,8 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
 void WrappedID3D11DeviceContext::OMGetBlendState(ID3D11BlendState **ppBlendState,
                                                  FLOAT BlendFactor[4], UINT *pSampleMask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11BlendState *real = NULL;
   m_pRealContext->OMGetBlendState(&real, BlendFactor, pSampleMask);
 
@@ -3078,6 +3214,8 @@ void WrappedID3D11DeviceContext::OMGetBlendState(ID3D11BlendState **ppBlendState
 void WrappedID3D11DeviceContext::OMGetDepthStencilState(ID3D11DepthStencilState **ppDepthStencilState,
                                                         UINT *pStencilRef)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11DepthStencilState *real = NULL;
   m_pRealContext->OMGetDepthStencilState(&real, pStencilRef);
 
@@ -3165,6 +3303,8 @@ void WrappedID3D11DeviceContext::OMSetRenderTargets(UINT NumViews,
                                                     ID3D11RenderTargetView *const *ppRenderTargetViews,
                                                     ID3D11DepthStencilView *pDepthStencilView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -3175,7 +3315,7 @@ void WrappedID3D11DeviceContext::OMSetRenderTargets(UINT NumViews,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_OMSetRenderTargets(NumViews, ppRenderTargetViews, pDepthStencilView);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   ID3D11RenderTargetView *RTs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {0};
@@ -3386,6 +3526,8 @@ void WrappedID3D11DeviceContext::OMSetRenderTargetsAndUnorderedAccessViews(
     ID3D11DepthStencilView *pDepthStencilView, UINT UAVStartSlot, UINT NumUAVs,
     ID3D11UnorderedAccessView *const *ppUnorderedAccessViews, const UINT *pUAVInitialCounts)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -3405,7 +3547,7 @@ void WrappedID3D11DeviceContext::OMSetRenderTargetsAndUnorderedAccessViews(
                                                         pDepthStencilView, UAVStartSlot, NumUAVs,
                                                         ppUnorderedAccessViews, pUAVInitialCounts);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   ID3D11RenderTargetView *RTs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {0};
@@ -3586,6 +3728,8 @@ bool WrappedID3D11DeviceContext::Serialise_OMSetBlendState(ID3D11BlendState *pBl
 void WrappedID3D11DeviceContext::OMSetBlendState(ID3D11BlendState *pBlendState,
                                                  const FLOAT BlendFactor[4], UINT SampleMask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -3596,7 +3740,7 @@ void WrappedID3D11DeviceContext::OMSetBlendState(ID3D11BlendState *pBlendState,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_OMSetBlendState(pBlendState, BlendFactor, SampleMask);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   FLOAT DefaultBlendFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
@@ -3644,6 +3788,8 @@ bool WrappedID3D11DeviceContext::Serialise_OMSetDepthStencilState(
 void WrappedID3D11DeviceContext::OMSetDepthStencilState(ID3D11DepthStencilState *pDepthStencilState,
                                                         UINT StencilRef)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -3654,7 +3800,7 @@ void WrappedID3D11DeviceContext::OMSetDepthStencilState(ID3D11DepthStencilState
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_OMSetDepthStencilState(pDepthStencilState, StencilRef);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->OM.DepthStencilState,
@@ -3796,13 +3942,19 @@ void WrappedID3D11DeviceContext::DrawIndexedInstanced(UINT IndexCountPerInstance
                                                       UINT StartIndexLocation, INT BaseVertexLocation,
                                                       UINT StartInstanceLocation)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation,
                                        BaseVertexLocation, StartInstanceLocation);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED_INST);
@@ -3810,7 +3962,7 @@ void WrappedID3D11DeviceContext::DrawIndexedInstanced(UINT IndexCountPerInstance
     Serialise_DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation,
                                    BaseVertexLocation, StartInstanceLocation);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -3867,13 +4019,19 @@ bool WrappedID3D11DeviceContext::Serialise_DrawInstanced(UINT VertexCountPerInst
 void WrappedID3D11DeviceContext::DrawInstanced(UINT VertexCountPerInstance, UINT InstanceCount,
                                                UINT StartVertexLocation, UINT StartInstanceLocation)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation,
                                 StartInstanceLocation);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_INST);
@@ -3881,7 +4039,7 @@ void WrappedID3D11DeviceContext::DrawInstanced(UINT VertexCountPerInstance, UINT
     Serialise_DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation,
                             StartInstanceLocation);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -3932,19 +4090,25 @@ bool WrappedID3D11DeviceContext::Serialise_DrawIndexed(UINT IndexCount_, UINT St
 void WrappedID3D11DeviceContext::DrawIndexed(UINT IndexCount, UINT StartIndexLocation,
                                              INT BaseVertexLocation)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_SMALL_CONTEXT(DRAW_INDEXED);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -3991,19 +4155,25 @@ bool WrappedID3D11DeviceContext::Serialise_Draw(UINT VertexCount_, UINT StartVer
 
 void WrappedID3D11DeviceContext::Draw(UINT VertexCount, UINT StartVertexLocation)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->Draw(VertexCount, StartVertexLocation);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_Draw(VertexCount, StartVertexLocation);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -4099,19 +4269,25 @@ bool WrappedID3D11DeviceContext::Serialise_DrawAuto()
 
 void WrappedID3D11DeviceContext::DrawAuto()
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawAuto();
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_AUTO);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DrawAuto();
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -4193,20 +4369,26 @@ bool WrappedID3D11DeviceContext::Serialise_DrawIndexedInstancedIndirect(ID3D11Bu
 void WrappedID3D11DeviceContext::DrawIndexedInstancedIndirect(ID3D11Buffer *pBufferForArgs,
                                                               UINT AlignedByteOffsetForArgs)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawIndexedInstancedIndirect(UNWRAP(WrappedID3D11Buffer, pBufferForArgs),
                                                AlignedByteOffsetForArgs);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED_INST_INDIRECT);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DrawIndexedInstancedIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -4278,20 +4460,26 @@ bool WrappedID3D11DeviceContext::Serialise_DrawInstancedIndirect(ID3D11Buffer *p
 void WrappedID3D11DeviceContext::DrawInstancedIndirect(ID3D11Buffer *pBufferForArgs,
                                                        UINT AlignedByteOffsetForArgs)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DrawInstancedIndirect(UNWRAP(WrappedID3D11Buffer, pBufferForArgs),
                                         AlignedByteOffsetForArgs);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_INST_INDIRECT);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DrawInstancedIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -4311,6 +4499,8 @@ void WrappedID3D11DeviceContext::DrawInstancedIndirect(ID3D11Buffer *pBufferForA
 void WrappedID3D11DeviceContext::CSGetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer **ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppConstantBuffers)
   {
     ID3D11Buffer *real[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT] = {0};
@@ -4322,7 +4512,8 @@ void WrappedID3D11DeviceContext::CSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppConstantBuffers[i] == m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -4330,6 +4521,8 @@ void WrappedID3D11DeviceContext::CSGetConstantBuffers(UINT StartSlot, UINT NumBu
 void WrappedID3D11DeviceContext::CSGetShaderResources(UINT StartSlot, UINT NumViews,
                                                       ID3D11ShaderResourceView **ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppShaderResourceViews)
   {
     ID3D11ShaderResourceView *real[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {0};
@@ -4342,7 +4535,8 @@ void WrappedID3D11DeviceContext::CSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->CS.SRVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppShaderResourceViews[i] == m_CurrentPipelineState->CS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -4350,6 +4544,8 @@ void WrappedID3D11DeviceContext::CSGetShaderResources(UINT StartSlot, UINT NumVi
 void WrappedID3D11DeviceContext::CSGetUnorderedAccessViews(
     UINT StartSlot, UINT NumUAVs, ID3D11UnorderedAccessView **ppUnorderedAccessViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppUnorderedAccessViews)
   {
     ID3D11UnorderedAccessView *real[D3D11_1_UAV_SLOT_COUNT] = {0};
@@ -4362,7 +4558,8 @@ void WrappedID3D11DeviceContext::CSGetUnorderedAccessViews(
           (ID3D11UnorderedAccessView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppUnorderedAccessViews[i]);
 
-      RDCASSERT(ppUnorderedAccessViews[i] == m_CurrentPipelineState->CSUAVs[i + StartSlot]);
+      RDCASSERT(!m_CurrentPipelineState->IsTrackingHazards() ||
+                ppUnorderedAccessViews[i] == m_CurrentPipelineState->CSUAVs[i + StartSlot]);
     }
   }
 }
@@ -4370,6 +4567,8 @@ void WrappedID3D11DeviceContext::CSGetUnorderedAccessViews(
 void WrappedID3D11DeviceContext::CSGetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState **ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppSamplers)
   {
     ID3D11SamplerState *real[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {0};
@@ -4390,6 +4589,8 @@ void WrappedID3D11DeviceContext::CSGetShader(ID3D11ComputeShader **ppComputeShad
                                              ID3D11ClassInstance **ppClassInstances,
                                              UINT *pNumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ppComputeShader == NULL && ppClassInstances == NULL && pNumClassInstances == NULL)
     return;
 
@@ -4473,6 +4674,8 @@ bool WrappedID3D11DeviceContext::Serialise_CSSetConstantBuffers(UINT StartSlot_,
 void WrappedID3D11DeviceContext::CSSetConstantBuffers(UINT StartSlot, UINT NumBuffers,
                                                       ID3D11Buffer *const *ppConstantBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4483,7 +4686,7 @@ void WrappedID3D11DeviceContext::CSSetConstantBuffers(UINT StartSlot, UINT NumBu
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_CSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->CS.ConstantBuffers,
@@ -4547,6 +4750,8 @@ bool WrappedID3D11DeviceContext::Serialise_CSSetShaderResources(
 void WrappedID3D11DeviceContext::CSSetShaderResources(
     UINT StartSlot, UINT NumViews, ID3D11ShaderResourceView *const *ppShaderResourceViews)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4557,7 +4762,7 @@ void WrappedID3D11DeviceContext::CSSetShaderResources(
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_CSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->CS.SRVs, ppShaderResourceViews,
@@ -4628,6 +4833,8 @@ void WrappedID3D11DeviceContext::CSSetUnorderedAccessViews(
     UINT StartSlot, UINT NumUAVs, ID3D11UnorderedAccessView *const *ppUnorderedAccessViews,
     const UINT *pUAVInitialCounts)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4639,7 +4846,7 @@ void WrappedID3D11DeviceContext::CSSetUnorderedAccessViews(
     Serialise_CSSetUnorderedAccessViews(StartSlot, NumUAVs, ppUnorderedAccessViews,
                                         pUAVInitialCounts);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefWrite(m_CurrentPipelineState->CSUAVs, ppUnorderedAccessViews,
@@ -4703,6 +4910,8 @@ bool WrappedID3D11DeviceContext::Serialise_CSSetSamplers(UINT StartSlot_, UINT N
 void WrappedID3D11DeviceContext::CSSetSamplers(UINT StartSlot, UINT NumSamplers,
                                                ID3D11SamplerState *const *ppSamplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4713,7 +4922,7 @@ void WrappedID3D11DeviceContext::CSSetSamplers(UINT StartSlot, UINT NumSamplers,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_CSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->CS.Samplers, ppSamplers, StartSlot,
@@ -4777,6 +4986,8 @@ void WrappedID3D11DeviceContext::CSSetShader(ID3D11ComputeShader *pComputeShader
                                              ID3D11ClassInstance *const *ppClassInstances,
                                              UINT NumClassInstances)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4789,7 +5000,7 @@ void WrappedID3D11DeviceContext::CSSetShader(ID3D11ComputeShader *pComputeShader
 
     MarkResourceReferenced(GetIDForResource(pComputeShader), eFrameRef_Read);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->ChangeRefRead(m_CurrentPipelineState->CS.Shader,
@@ -4845,6 +5056,8 @@ bool WrappedID3D11DeviceContext::Serialise_ExecuteCommandList(ID3D11CommandList
 void WrappedID3D11DeviceContext::ExecuteCommandList(ID3D11CommandList *pCommandList,
                                                     BOOL RestoreContextState)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -4860,7 +5073,7 @@ void WrappedID3D11DeviceContext::ExecuteCommandList(ID3D11CommandList *pCommandL
       SCOPED_SERIALISE_CONTEXT(EXECUTE_CMD_LIST);
       m_pSerialiser->Serialise("context", m_ResourceID);
       Serialise_ExecuteCommandList(pCommandList, RestoreContextState);
-      m_ContextRecord->AddChunk(scope.Get());
+      m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
     }
 
     WrappedID3D11CommandList *wrapped = (WrappedID3D11CommandList *)pCommandList;
@@ -4895,7 +5108,7 @@ void WrappedID3D11DeviceContext::ExecuteCommandList(ID3D11CommandList *pCommandL
       // chunks and we can restore the state
       SCOPED_SERIALISE_CONTEXT(RESTORE_STATE_AFTER_EXEC);
       m_pSerialiser->Serialise("context", m_ResourceID);
-      m_ContextRecord->AddChunk(scope.Get());
+      m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
     }
 
     m_CurrentPipelineState->MarkReferenced(this, false);
@@ -4973,19 +5186,25 @@ bool WrappedID3D11DeviceContext::Serialise_Dispatch(UINT ThreadGroupCountX_,
 void WrappedID3D11DeviceContext::Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY,
                                           UINT ThreadGroupCountZ)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -5054,20 +5273,26 @@ bool WrappedID3D11DeviceContext::Serialise_DispatchIndirect(ID3D11Buffer *pBuffe
 void WrappedID3D11DeviceContext::DispatchIndirect(ID3D11Buffer *pBufferForArgs,
                                                   UINT AlignedByteOffsetForArgs)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
 
+  BeginEventTiming();
+
   m_pRealContext->DispatchIndirect(UNWRAP(WrappedID3D11Buffer, pBufferForArgs),
                                    AlignedByteOffsetForArgs);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH_INDIRECT);
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_DispatchIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -5108,6 +5333,8 @@ bool WrappedID3D11DeviceContext::Serialise_FinishCommandList(BOOL RestoreDeferre
 HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContextState,
                                                       ID3D11CommandList **ppCommandList)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(GetType() == D3D11_DEVICE_CONTEXT_IMMEDIATE)
   {
     m_pDevice->AddDebugMessage(eDbgCategory_Execution, eDbgSeverity_High, eDbgSource_IncorrectAPIUse,
@@ -5155,7 +5382,7 @@ HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContex
       SCOPED_SERIALISE_CONTEXT(FINISH_CMD_LIST);
       m_pSerialiser->Serialise("context", m_ResourceID);
       Serialise_FinishCommandList(RestoreDeferredContextState, &w);
-      m_ContextRecord->AddChunk(scope.Get());
+      m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
     }
 
     D3D11ResourceRecord *r =
@@ -5173,7 +5400,7 @@ HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContex
       D3D11RenderState rs(*m_CurrentPipelineState);
       rs.SetSerialiser(m_pSerialiser);
       rs.Serialise(m_State, m_pDevice);
-      m_ContextRecord->AddChunk(scope.Get());
+      m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
     }
   }
   else if(m_State == WRITING_CAPFRAME && !m_SuccessfulCapture)
@@ -5234,6 +5461,8 @@ bool WrappedID3D11DeviceContext::Serialise_Flush()
 
 void WrappedID3D11DeviceContext::Flush()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -5242,7 +5471,7 @@ void WrappedID3D11DeviceContext::Flush()
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_Flush();
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_CurrentPipelineState->MarkReferenced(this, false);
   }
@@ -5342,6 +5571,8 @@ void WrappedID3D11DeviceContext::CopySubresourceRegion(ID3D11Resource *pDstResou
                                                        UINT DstZ, ID3D11Resource *pSrcResource,
                                                        UINT SrcSubresource, const D3D11_BOX *pSrcBox)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -5361,7 +5592,7 @@ void WrappedID3D11DeviceContext::CopySubresourceRegion(ID3D11Resource *pDstResou
     RDCASSERT(srcRecord);
     record->AddParent(srcRecord);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
     // assume partial update
@@ -5489,6 +5720,8 @@ bool WrappedID3D11DeviceContext::Serialise_CopyResource(ID3D11Resource *pDstReso
 void WrappedID3D11DeviceContext::CopyResource(ID3D11Resource *pDstResource,
                                               ID3D11Resource *pSrcResource)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -5507,7 +5740,7 @@ void WrappedID3D11DeviceContext::CopyResource(ID3D11Resource *pDstResource,
     RDCASSERT(srcRecord);
     record->AddParent(srcRecord);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
     MarkResourceReferenced(GetIDForResource(pDstResource), eFrameRef_Write);
@@ -5619,6 +5852,8 @@ void WrappedID3D11DeviceContext::UpdateSubresource(ID3D11Resource *pDstResource,
                                                    const D3D11_BOX *pDstBox, const void *pSrcData,
                                                    UINT SrcRowPitch, UINT SrcDepthPitch)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -5683,7 +5918,7 @@ void WrappedID3D11DeviceContext::UpdateSubresource(ID3D11Resource *pDstResource,
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -5735,7 +5970,7 @@ void WrappedID3D11DeviceContext::UpdateSubresource(ID3D11Resource *pDstResource,
         Chunk *chunk = scope.Get();
 
         record->AddChunk(chunk);
-        record->SubResources[DstSubresource]->SetDataPtr(chunk->GetData());
+        record->SubResources[DstSubresource]->SetDataPtr(chunk->GetWritableData());
 
         record->SubResources[DstSubresource]->DataInSerialiser = true;
       }
@@ -5907,6 +6142,8 @@ void WrappedID3D11DeviceContext::CopyStructureCount(ID3D11Buffer *pDstBuffer,
                                                     UINT DstAlignedByteOffset,
                                                     ID3D11UnorderedAccessView *pSrcView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -5917,7 +6154,7 @@ void WrappedID3D11DeviceContext::CopyStructureCount(ID3D11Buffer *pDstBuffer,
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_CopyStructureCount(pDstBuffer, DstAlignedByteOffset, pSrcView);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_MissingTracks.insert(GetIDForResource(pDstBuffer));
     MarkResourceReferenced(GetIDForResource(pDstBuffer), eFrameRef_Read);
@@ -6030,6 +6267,8 @@ void WrappedID3D11DeviceContext::ResolveSubresource(ID3D11Resource *pDstResource
                                                     UINT DstSubresource, ID3D11Resource *pSrcResource,
                                                     UINT SrcSubresource, DXGI_FORMAT Format)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -6040,7 +6279,7 @@ void WrappedID3D11DeviceContext::ResolveSubresource(ID3D11Resource *pDstResource
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_ResolveSubresource(pDstResource, DstSubresource, pSrcResource, SrcSubresource, Format);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_MissingTracks.insert(GetIDForResource(pDstResource));
     MarkResourceReferenced(GetIDForResource(pDstResource), eFrameRef_Read);
@@ -6164,6 +6403,8 @@ bool WrappedID3D11DeviceContext::Serialise_GenerateMips(ID3D11ShaderResourceView
 
 void WrappedID3D11DeviceContext::GenerateMips(ID3D11ShaderResourceView *pShaderResourceView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -6177,7 +6418,7 @@ void WrappedID3D11DeviceContext::GenerateMips(ID3D11ShaderResourceView *pShaderR
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_GenerateMips(pShaderResourceView);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
 
     ID3D11Resource *res = NULL;
     pShaderResourceView->GetResource(&res);
@@ -6219,6 +6460,8 @@ bool WrappedID3D11DeviceContext::Serialise_ClearState()
 
 void WrappedID3D11DeviceContext::ClearState()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -6227,7 +6470,7 @@ void WrappedID3D11DeviceContext::ClearState()
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_ClearState();
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_CurrentPipelineState->Clear();
@@ -6333,6 +6576,8 @@ bool WrappedID3D11DeviceContext::Serialise_ClearRenderTargetView(
 void WrappedID3D11DeviceContext::ClearRenderTargetView(ID3D11RenderTargetView *pRenderTargetView,
                                                        const FLOAT ColorRGBA[4])
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   if(pRenderTargetView == NULL)
@@ -6356,7 +6601,7 @@ void WrappedID3D11DeviceContext::ClearRenderTargetView(ID3D11RenderTargetView *p
 
     SAFE_RELEASE(res);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -6515,6 +6760,8 @@ bool WrappedID3D11DeviceContext::Serialise_ClearUnorderedAccessViewUint(
 void WrappedID3D11DeviceContext::ClearUnorderedAccessViewUint(
     ID3D11UnorderedAccessView *pUnorderedAccessView, const UINT Values[4])
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -6530,7 +6777,7 @@ void WrappedID3D11DeviceContext::ClearUnorderedAccessViewUint(
 
     SAFE_RELEASE(res);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -6687,6 +6934,8 @@ bool WrappedID3D11DeviceContext::Serialise_ClearUnorderedAccessViewFloat(
 void WrappedID3D11DeviceContext::ClearUnorderedAccessViewFloat(
     ID3D11UnorderedAccessView *pUnorderedAccessView, const FLOAT Values[4])
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -6702,7 +6951,7 @@ void WrappedID3D11DeviceContext::ClearUnorderedAccessViewFloat(
 
     SAFE_RELEASE(res);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -6845,6 +7094,8 @@ bool WrappedID3D11DeviceContext::Serialise_ClearDepthStencilView(
 void WrappedID3D11DeviceContext::ClearDepthStencilView(ID3D11DepthStencilView *pDepthStencilView,
                                                        UINT ClearFlags, FLOAT Depth, UINT8 Stencil)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   if(pDepthStencilView == NULL)
@@ -6868,7 +7119,7 @@ void WrappedID3D11DeviceContext::ClearDepthStencilView(ID3D11DepthStencilView *p
 
     SAFE_RELEASE(res);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
   else if(m_State >= WRITING)
   {
@@ -6961,6 +7212,8 @@ bool WrappedID3D11DeviceContext::Serialise_Begin(ID3D11Asynchronous *pAsync)
 
 void WrappedID3D11DeviceContext::Begin(ID3D11Asynchronous *pAsync)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11Asynchronous *unwrapped = NULL;
 
   if(WrappedID3D11Query1::IsAlloc(pAsync))
@@ -6978,7 +7231,7 @@ void WrappedID3D11DeviceContext::Begin(ID3D11Asynchronous *pAsync)
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_Begin(pAsync);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_pRealContext->Begin(unwrapped);
@@ -7017,6 +7270,8 @@ bool WrappedID3D11DeviceContext::Serialise_End(ID3D11Asynchronous *pAsync)
 
 void WrappedID3D11DeviceContext::End(ID3D11Asynchronous *pAsync)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11Asynchronous *unwrapped = NULL;
 
   if(WrappedID3D11Query1::IsAlloc(pAsync))
@@ -7034,7 +7289,7 @@ void WrappedID3D11DeviceContext::End(ID3D11Asynchronous *pAsync)
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_End(pAsync);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_pRealContext->End(unwrapped);
@@ -7043,6 +7298,8 @@ void WrappedID3D11DeviceContext::End(ID3D11Asynchronous *pAsync)
 HRESULT WrappedID3D11DeviceContext::GetData(ID3D11Asynchronous *pAsync, void *pData, UINT DataSize,
                                             UINT GetDataFlags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11Asynchronous *unwrapped = NULL;
 
   if(WrappedID3D11Query1::IsAlloc(pAsync))
@@ -7077,6 +7334,8 @@ bool WrappedID3D11DeviceContext::Serialise_SetPredication(ID3D11Predicate *pPred
 
 void WrappedID3D11DeviceContext::SetPredication(ID3D11Predicate *pPredicate, BOOL PredicateValue)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -7085,7 +7344,7 @@ void WrappedID3D11DeviceContext::SetPredication(ID3D11Predicate *pPredicate, BOO
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_SetPredication(pPredicate, PredicateValue);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_pRealContext->SetPredication(UNWRAP(WrappedID3D11Predicate, pPredicate), PredicateValue);
@@ -7093,6 +7352,8 @@ void WrappedID3D11DeviceContext::SetPredication(ID3D11Predicate *pPredicate, BOO
 
 FLOAT WrappedID3D11DeviceContext::GetResourceMinLOD(ID3D11Resource *pResource)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_pRealContext->GetResourceMinLOD(m_pDevice->GetResourceManager()->UnwrapResource(pResource));
 }
 
@@ -7112,6 +7373,8 @@ bool WrappedID3D11DeviceContext::Serialise_SetResourceMinLOD(ID3D11Resource *pRe
 
 void WrappedID3D11DeviceContext::SetResourceMinLOD(ID3D11Resource *pResource, FLOAT MinLOD)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_EmptyCommandList = false;
 
   if(m_State == WRITING_CAPFRAME)
@@ -7120,7 +7383,7 @@ void WrappedID3D11DeviceContext::SetResourceMinLOD(ID3D11Resource *pResource, FL
     m_pSerialiser->Serialise("context", m_ResourceID);
     Serialise_SetResourceMinLOD(pResource, MinLOD);
 
-    m_ContextRecord->AddChunk(scope.Get());
+    m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 
   m_pRealContext->SetResourceMinLOD(m_pDevice->GetResourceManager()->UnwrapResource(pResource),
@@ -7129,6 +7392,8 @@ void WrappedID3D11DeviceContext::SetResourceMinLOD(ID3D11Resource *pResource, FL
 
 void WrappedID3D11DeviceContext::GetPredication(ID3D11Predicate **ppPredicate, BOOL *pPredicateValue)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ID3D11Predicate *real = NULL;
   m_pRealContext->GetPredication(&real, pPredicateValue);
   SAFE_RELEASE_NOCLEAR(real);
@@ -7144,11 +7409,15 @@ void WrappedID3D11DeviceContext::GetPredication(ID3D11Predicate **ppPredicate, B
 
 D3D11_DEVICE_CONTEXT_TYPE WrappedID3D11DeviceContext::GetType()
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_pRealContext->GetType();
 }
 
 UINT WrappedID3D11DeviceContext::GetContextFlags()
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_pRealContext->GetContextFlags();
 }
 
@@ -7415,7 +7684,10 @@ bool WrappedID3D11DeviceContext::Serialise_Map(ID3D11Resource *pResource, UINT S
 
     if(appMem == NULL)
     {
-      record->AllocShadowStorage(ctxMapID, mapLength);
+      bool trackWrites = WrappedID3D11Buffer::IsAlloc(pResource) &&
+                         RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites != 0;
+
+      record->AllocShadowStorage(ctxMapID, mapLength, trackWrites);
       appMem = record->GetShadowPtr(ctxMapID, 0);
 
       if(MapType != D3D11_MAP_WRITE_DISCARD)
@@ -7481,9 +7753,19 @@ bool WrappedID3D11DeviceContext::Serialise_Map(ID3D11Resource *pResource, UINT S
 
     if(MapType == D3D11_MAP_WRITE_DISCARD)
     {
+      // discards rewrite and save the whole buffer, so there's nothing to gain from watching which
+      // pages are written - it would only fault on every one of them.
+      record->UnwatchShadowWrites(ctxMapID);
+
       memset(appMem, 0xcc, mapLength);
       memcpy(record->GetShadowPtr(ctxMapID, 1), appMem, mapLength);
     }
+    else if(MapType == D3D11_MAP_WRITE || MapType == D3D11_MAP_WRITE_NO_OVERWRITE)
+    {
+      // these are diffed against the second shadow buffer on Unmap, so from here only the pages
+      // the application writes need to be compared. The watch carries over to later maps.
+      record->WatchShadowWrites(ctxMapID);
+    }
 
     intercept = MapIntercept();
     intercept.verifyWrite = (RenderDoc::Inst().GetCaptureOptions().VerifyMapWrites != 0);
@@ -7577,6 +7859,8 @@ HRESULT WrappedID3D11DeviceContext::Map(ID3D11Resource *pResource, UINT Subresou
                                         D3D11_MAP MapType, UINT MapFlags,
                                         D3D11_MAPPED_SUBRESOURCE *pMappedResource)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -7743,8 +8027,31 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 
     if(m_State == WRITING_CAPFRAME && len > 512 && intercept.MapType != D3D11_MAP_WRITE_DISCARD)
     {
-      bool found =
-          FindDiffRange(appWritePtr, record->GetShadowPtr(ctxMapID, 1), len, diffStart, diffEnd);
+      bool found = false;
+
+      uint64_t watch = record->GetShadowWatch(ctxMapID);
+
+      if(watch && appWritePtr == record->GetShadowPtr(ctxMapID, 0))
+      {
+        // only pages written since the last check can differ. The map is saved as one range, so
+        // it spans from the first modified range to the last.
+        std::vector<std::pair<size_t, size_t> > ranges;
+        WriteWatch::FindModifiedRanges(watch, appWritePtr, record->GetShadowPtr(ctxMapID, 1), len,
+                                       ranges);
+
+        found = !ranges.empty();
+        if(found)
+        {
+          diffStart = ranges.front().first;
+          diffEnd = ranges.back().second;
+        }
+      }
+      else
+      {
+        found =
+            FindDiffRange(appWritePtr, record->GetShadowPtr(ctxMapID, 1), len, diffStart, diffEnd);
+      }
+
       if(found)
       {
         static size_t saved = 0;
@@ -7908,6 +8215,8 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 
 void WrappedID3D11DeviceContext::Unmap(ID3D11Resource *pResource, UINT Subresource)
 {
+  SCOPED_ENTRY_PROFILE();
+
   DrainAnnotationQueue();
 
   m_EmptyCommandList = false;
@@ -7962,7 +8271,7 @@ void WrappedID3D11DeviceContext::Unmap(ID3D11Resource *pResource, UINT Subresour
         m_pSerialiser->Serialise("context", m_ResourceID);
         Serialise_Unmap(pResource, Subresource);
 
-        m_ContextRecord->AddChunk(scope.Get());
+        m_ContextRecord->AddChunk(scope.Get(m_ChunkArena));
       }
       else if(m_State >= WRITING)
       {
@@ -7993,7 +8302,7 @@ void WrappedID3D11DeviceContext::Unmap(ID3D11Resource *pResource, UINT Subresour
           Chunk *chunk = scope.Get();
 
           baserecord->AddChunk(chunk);
-          record->SetDataPtr(chunk->GetData());
+          record->SetDataPtr(chunk->GetWritableData());
 
           record->DataInSerialiser = true;
         }
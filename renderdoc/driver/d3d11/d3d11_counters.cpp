@@ -61,6 +61,9 @@ vector<uint32_t> D3D11DebugManager::EnumerateCounters()
   ret.push_back(eCounter_PSInvocations);
   ret.push_back(eCounter_CSInvocations);
 
+  if(!m_WrappedContext->GetCapturedEventTimings().empty())
+    ret.push_back(eCounter_CapturedGPUDuration);
+
   return ret;
 }
 
@@ -164,6 +167,15 @@ void D3D11DebugManager::DescribeCounter(uint32_t counterID, CounterDescription &
       desc.resultCompType = eCompType_UInt;
       desc.units = eUnits_Absolute;
       break;
+    case eCounter_CapturedGPUDuration:
+      desc.name = "Captured GPU Duration";
+      desc.description =
+          "Time taken for this event on the GPU while the application was being captured, as "
+          "measured by delta between two GPU timestamps recorded around it.";
+      desc.resultByteWidth = 8;
+      desc.resultCompType = eCompType_Double;
+      desc.units = eUnits_Seconds;
+      break;
     default:
       desc.name = "Unknown";
       desc.description = "Unknown counter ID";
@@ -186,6 +198,7 @@ struct GPUTimer
 struct D3D11CounterContext
 {
   uint32_t eventStart;
+  uint32_t maxEID;
   vector<GPUTimer> timers;
   int reuseIdx;
 };
@@ -201,10 +214,14 @@ void D3D11DebugManager::FillTimers(D3D11CounterContext &ctx, const DrawcallTreeN
 
   for(size_t i = 0; i < drawnode.children.size(); i++)
   {
+    // if the fetch is cancelled, stop and return the results so far
+    if(RenderDoc::Inst().IsOperationCancelled())
+      return;
+
     const FetchDrawcall &d = drawnode.children[i].draw;
     FillTimers(ctx, drawnode.children[i]);
 
-    if(d.events.count == 0)
+    if(d.events.count == 0 || RenderDoc::Inst().IsOperationCancelled())
       continue;
 
     GPUTimer *timer = NULL;
@@ -254,9 +271,19 @@ void D3D11DebugManager::FillTimers(D3D11CounterContext &ctx, const DrawcallTreeN
       m_pImmediateContext->End(timer->stats);
 
     ctx.eventStart = d.eventID + 1;
+
+    RenderDoc::Inst().SetOperationProgress(float(d.eventID) / float(ctx.maxEID));
   }
 }
 
+static uint32_t LastEventID(const DrawcallTreeNode &node)
+{
+  if(node.children.empty())
+    return node.draw.eventID;
+
+  return LastEventID(node.children.back());
+}
+
 vector<CounterResult> D3D11DebugManager::FetchCounters(const vector<uint32_t> &counters)
 {
   vector<CounterResult> ret;
@@ -267,6 +294,33 @@ vector<CounterResult> D3D11DebugManager::FetchCounters(const vector<uint32_t> &c
     return ret;
   }
 
+  // the captured timings are already known, so only the remaining counters need a replay
+  vector<uint32_t> replayCounters;
+
+  for(size_t i = 0; i < counters.size(); i++)
+  {
+    if(counters[i] == eCounter_CapturedGPUDuration)
+    {
+      const vector<CounterResult> &timings = m_WrappedContext->GetCapturedEventTimings();
+      ret.insert(ret.end(), timings.begin(), timings.end());
+    }
+    else
+    {
+      replayCounters.push_back(counters[i]);
+    }
+  }
+
+  if(replayCounters.empty())
+    return ret;
+
+  FetchReplayCounters(replayCounters, ret);
+
+  return ret;
+}
+
+void D3D11DebugManager::FetchReplayCounters(const vector<uint32_t> &counters,
+                                            vector<CounterResult> &ret)
+{
   SCOPED_TIMER("Fetch Counters, counters to fetch %u", counters.size());
 
   D3D11_QUERY_DESC disjointdesc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
@@ -281,18 +335,20 @@ vector<CounterResult> D3D11DebugManager::FetchCounters(const vector<uint32_t> &c
   if(FAILED(hr))
   {
     RDCERR("Failed to create disjoint query %08x", hr);
-    return ret;
+    return;
   }
 
   hr = m_pDevice->CreateQuery(&qdesc, &start);
   if(FAILED(hr))
   {
     RDCERR("Failed to create start query %08x", hr);
-    return ret;
+    return;
   }
 
   D3D11CounterContext ctx;
 
+  ctx.maxEID = RDCMAX(1U, LastEventID(m_WrappedContext->GetRootDraw()));
+
   for(int loop = 0; loop < 1; loop++)
   {
     {
@@ -448,6 +504,4 @@ vector<CounterResult> D3D11DebugManager::FetchCounters(const vector<uint32_t> &c
 
   SAFE_RELEASE(disjoint);
   SAFE_RELEASE(start);
-
-  return ret;
 }
@@ -32,6 +32,7 @@
 #include "maths/camera.h"
 #include "maths/formatpacking.h"
 #include "maths/matrix.h"
+#include "replay/replay_driver.h"
 #include "serialise/string_utils.h"
 #include "stb/stb_truetype.h"
 #include "d3d11_context.h"
@@ -90,6 +91,8 @@ D3D11DebugManager::D3D11DebugManager(WrappedID3D11Device *wrapper)
 
   m_OutputWindowID = 1;
 
+  m_StagingPoolSize = 0;
+
   m_supersamplingX = 1.0f;
   m_supersamplingY = 1.0f;
 
@@ -138,8 +141,8 @@ D3D11DebugManager::D3D11DebugManager(WrappedID3D11Device *wrapper)
     }
   }
 
-  bool success = LoadShaderCache("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, ShaderCacheCallbacks);
+  bool success =
+      m_ShaderCacheFile.Open("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion);
 
   // if we failed to load from the cache
   m_ShaderCacheDirty = !success;
@@ -163,8 +166,7 @@ D3D11DebugManager::~D3D11DebugManager()
 
   if(m_ShaderCacheDirty)
   {
-    SaveShaderCache("d3dshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    ShaderCacheCallbacks);
+    SaveShaderCache(m_ShaderCacheFile, m_ShaderCache, ShaderCacheCallbacks);
   }
   else
   {
@@ -172,6 +174,9 @@ D3D11DebugManager::~D3D11DebugManager()
       ShaderCacheCallbacks.Destroy(it->second);
   }
 
+  for(auto it = m_PrecompiledBlobs.begin(); it != m_PrecompiledBlobs.end(); ++it)
+    SAFE_RELEASE(it->second.first);
+
   ShutdownFontRendering();
   ShutdownStreamOut();
 
@@ -183,6 +188,11 @@ D3D11DebugManager::~D3D11DebugManager()
   if(m_CustomShaderResourceId != ResourceId())
     SAFE_RELEASE(m_CustomShaderTex);
 
+  SAFE_RELEASE(m_DiffUAV);
+
+  if(m_DiffResourceId != ResourceId())
+    SAFE_RELEASE(m_DiffTex);
+
   SAFE_RELEASE(m_pFactory);
 
   while(!m_ShaderItemCache.empty())
@@ -192,6 +202,9 @@ D3D11DebugManager::~D3D11DebugManager()
     m_ShaderItemCache.pop_back();
   }
 
+  for(auto it = m_StagingPool.begin(); it != m_StagingPool.end(); ++it)
+    SAFE_RELEASE(it->tex);
+
   for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
   {
     SAFE_RELEASE(it->second.vsout.buf);
@@ -213,22 +226,36 @@ D3D11DebugManager::~D3D11DebugManager()
 //////////////////////////////////////////////////////
 // debug/replay functions
 
-string D3D11DebugManager::GetShaderBlob(const char *source, const char *entry,
-                                        const uint32_t compileFlags, const char *profile,
-                                        ID3DBlob **srcblob)
+static uint32_t GetShaderBlobHash(const char *source, const char *entry,
+                                  const uint32_t compileFlags, const char *profile)
 {
   uint32_t hash = strhash(source);
   hash = strhash(entry, hash);
   hash = strhash(profile, hash);
   hash ^= compileFlags;
+  return hash;
+}
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+static const char *GetShaderProfile(ShaderStageType type)
+{
+  switch(type)
   {
-    *srcblob = m_ShaderCache[hash];
-    (*srcblob)->AddRef();
-    return "";
+    case eShaderStage_Vertex: return "vs_5_0";
+    case eShaderStage_Hull: return "hs_5_0";
+    case eShaderStage_Domain: return "ds_5_0";
+    case eShaderStage_Geometry: return "gs_5_0";
+    case eShaderStage_Pixel: return "ps_5_0";
+    case eShaderStage_Compute: return "cs_5_0";
+    default: break;
   }
 
+  return NULL;
+}
+
+// only calls D3DCompile, so this is safe to call from any thread
+static string CompileShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
+                                const char *profile, ID3DBlob **srcblob)
+{
   HRESULT hr = S_OK;
 
   ID3DBlob *byteBlob = NULL;
@@ -268,12 +295,50 @@ string D3D11DebugManager::GetShaderBlob(const char *source, const char *entry,
     SAFE_RELEASE(errBlob);
 
     if(FAILED(hr))
-    {
       SAFE_RELEASE(byteBlob);
-      return errors;
+  }
+
+  *srcblob = byteBlob;
+  return errors;
+}
+
+string D3D11DebugManager::GetShaderBlob(const char *source, const char *entry,
+                                        const uint32_t compileFlags, const char *profile,
+                                        ID3DBlob **srcblob)
+{
+  uint32_t hash = GetShaderBlobHash(source, entry, compileFlags, profile);
+
+  if(m_ShaderCache.find(hash) != m_ShaderCache.end() ||
+     FetchShaderCache(m_ShaderCacheFile, hash, m_ShaderCache, ShaderCacheCallbacks))
+  {
+    *srcblob = m_ShaderCache[hash];
+    (*srcblob)->AddRef();
+    return "";
+  }
+
+  ID3DBlob *byteBlob = NULL;
+  string errors = "";
+  bool precompiled = false;
+
+  {
+    SCOPED_LOCK(m_PrecompiledLock);
+
+    auto it = m_PrecompiledBlobs.find(hash);
+    if(it != m_PrecompiledBlobs.end())
+    {
+      byteBlob = it->second.first;
+      errors = it->second.second;
+      precompiled = true;
+      m_PrecompiledBlobs.erase(it);
     }
   }
 
+  if(!precompiled)
+    errors = CompileShaderBlob(source, entry, compileFlags, profile, &byteBlob);
+
+  if(byteBlob == NULL)
+    return errors;
+
   if(m_CacheShaders)
   {
     m_ShaderCache[hash] = byteBlob;
@@ -281,12 +346,33 @@ string D3D11DebugManager::GetShaderBlob(const char *source, const char *entry,
     m_ShaderCacheDirty = true;
   }
 
-  SAFE_RELEASE(errBlob);
-
   *srcblob = byteBlob;
   return errors;
 }
 
+void D3D11DebugManager::PrecompileShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  const char *profile = GetShaderProfile(type);
+
+  if(profile == NULL)
+    return;
+
+  ID3DBlob *blob = NULL;
+  string errors = CompileShaderBlob(source.c_str(), entry.c_str(), compileFlags, profile, &blob);
+
+  uint32_t hash = GetShaderBlobHash(source.c_str(), entry.c_str(), compileFlags, profile);
+
+  SCOPED_LOCK(m_PrecompiledLock);
+
+  // if the same shader was precompiled twice without being built, keep the newest
+  auto it = m_PrecompiledBlobs.find(hash);
+  if(it != m_PrecompiledBlobs.end())
+    SAFE_RELEASE(it->second.first);
+
+  m_PrecompiledBlobs[hash] = std::make_pair(blob, errors);
+}
+
 ID3D11VertexShader *D3D11DebugManager::MakeVShader(const char *source, const char *entry,
                                                    const char *profile, int numInputDescs,
                                                    D3D11_INPUT_ELEMENT_DESC *inputs,
@@ -431,20 +517,13 @@ void D3D11DebugManager::BuildShader(string source, string entry, const uint32_t
     return;
   }
 
-  char *profile = NULL;
+  const char *profile = GetShaderProfile(type);
 
-  switch(type)
+  if(profile == NULL)
   {
-    case eShaderStage_Vertex: profile = "vs_5_0"; break;
-    case eShaderStage_Hull: profile = "hs_5_0"; break;
-    case eShaderStage_Domain: profile = "ds_5_0"; break;
-    case eShaderStage_Geometry: profile = "gs_5_0"; break;
-    case eShaderStage_Pixel: profile = "ps_5_0"; break;
-    case eShaderStage_Compute: profile = "cs_5_0"; break;
-    default:
-      RDCERR("Unexpected type in BuildShader!");
-      *id = ResourceId();
-      return;
+    RDCERR("Unexpected type in BuildShader!");
+    *id = ResourceId();
+    return;
   }
 
   ID3DBlob *blob = NULL;
@@ -610,6 +689,10 @@ bool D3D11DebugManager::InitDebugRendering()
   m_CustomShaderRTV = NULL;
   m_CustomShaderResourceId = ResourceId();
 
+  m_DiffTex = NULL;
+  m_DiffUAV = NULL;
+  m_DiffResourceId = ResourceId();
+
   m_OverlayRenderTex = NULL;
   m_OverlayResourceId = ResourceId();
 
@@ -731,6 +814,19 @@ bool D3D11DebugManager::InitDebugRendering()
           m_DebugRender.ResultMinMaxCS[i] =
               MakeCShader(hlsl.c_str(), "RENDERDOC_ResultMinMaxCS", "cs_5_0");
 
+        // NaN and infinity only exist in float data, so only search float textures
+        if(i == 0)
+          m_DebugRender.ValueSearchCS[t] =
+              MakeCShader(hlsl.c_str(), "RENDERDOC_ValueSearchCS", "cs_5_0");
+
+        // the buffer search and texture diff don't sample, so only need compiling once
+        if(t == 1 && i == 0)
+        {
+          m_DebugRender.ValueSearchBufCS =
+              MakeCShader(hlsl.c_str(), "RENDERDOC_ValueSearchBufCS", "cs_5_0");
+          m_DebugRender.TexDiffCS = MakeCShader(hlsl.c_str(), "RENDERDOC_TexDiffCS", "cs_5_0");
+        }
+
         RenderDoc::Inst().SetProgress(
             DebugManagerInit,
             (float(i + 3.0f * t) / float(2.0f + 3.0f * (eTexType_Max - 1))) * 0.7f + 0.1f);
@@ -1718,7 +1814,7 @@ void D3D11DebugManager::FlipOutputWindow(uint64_t id)
   if(m_RealState.active)
   {
     m_RealState.active = false;
-    m_RealState.state.ApplyState(m_WrappedContext);
+    m_RealState.state.ApplyChangedState(m_WrappedContext);
     m_RealState.state.Clear();
   }
   else
@@ -1762,57 +1858,694 @@ bool D3D11DebugManager::GetHistogram(ResourceId texid, uint32_t sliceFace, uint3
 
   D3D11RenderStateTracker tracker(m_WrappedContext);
 
-  HistogramCBufferData cdata;
-  cdata.HistogramTextureResolution.x = (float)RDCMAX(details.texWidth >> mip, 1U);
-  cdata.HistogramTextureResolution.y = (float)RDCMAX(details.texHeight >> mip, 1U);
-  cdata.HistogramTextureResolution.z = (float)RDCMAX(details.texDepth >> mip, 1U);
-  cdata.HistogramSlice = (float)sliceFace;
-  cdata.HistogramMip = mip;
-  cdata.HistogramSample = (int)RDCCLAMP(sample, 0U, details.sampleCount - 1);
-  if(sample == ~0U)
-    cdata.HistogramSample = -int(details.sampleCount);
-  cdata.HistogramMin = minval;
+  HistogramCBufferData cdata;
+  cdata.HistogramTextureResolution.x = (float)RDCMAX(details.texWidth >> mip, 1U);
+  cdata.HistogramTextureResolution.y = (float)RDCMAX(details.texHeight >> mip, 1U);
+  cdata.HistogramTextureResolution.z = (float)RDCMAX(details.texDepth >> mip, 1U);
+  cdata.HistogramSlice = (float)sliceFace;
+  cdata.HistogramMip = mip;
+  cdata.HistogramSample = (int)RDCCLAMP(sample, 0U, details.sampleCount - 1);
+  if(sample == ~0U)
+    cdata.HistogramSample = -int(details.sampleCount);
+  cdata.HistogramMin = minval;
+
+  // The calculation in the shader normalises each value between min and max, then multiplies by the
+  // number of buckets.
+  // But any value equal to HistogramMax must go into NUM_BUCKETS-1, so add a small delta.
+  cdata.HistogramMax = maxval + maxval * 1e-6f;
+
+  cdata.HistogramChannels = 0;
+  if(channels[0])
+    cdata.HistogramChannels |= 0x1;
+  if(channels[1])
+    cdata.HistogramChannels |= 0x2;
+  if(channels[2])
+    cdata.HistogramChannels |= 0x4;
+  if(channels[3])
+    cdata.HistogramChannels |= 0x8;
+  cdata.HistogramFlags = 0;
+
+  int srvOffset = 0;
+  int intIdx = 0;
+
+  if(IsUIntFormat(details.texFmt))
+  {
+    cdata.HistogramFlags |= TEXDISPLAY_UINT_TEX;
+    srvOffset = 10;
+    intIdx = 1;
+  }
+  if(IsIntFormat(details.texFmt))
+  {
+    cdata.HistogramFlags |= TEXDISPLAY_SINT_TEX;
+    srvOffset = 20;
+    intIdx = 2;
+  }
+
+  if(details.texType == eTexType_3D)
+    cdata.HistogramSlice = float(sliceFace) / float(details.texDepth) + 0.001f;
+
+  ID3D11Buffer *cbuf = MakeCBuffer(&cdata, sizeof(cdata));
+
+  UINT zeroes[] = {0, 0, 0, 0};
+  m_pImmediateContext->ClearUnorderedAccessViewUint(m_DebugRender.histogramUAV, zeroes);
+
+  m_pImmediateContext->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, 0, NULL, NULL);
+
+  ID3D11UnorderedAccessView *uavs[D3D11_1_UAV_SLOT_COUNT] = {0};
+  UINT UAV_keepcounts[D3D11_1_UAV_SLOT_COUNT];
+  memset(&UAV_keepcounts[0], 0xff, sizeof(UAV_keepcounts));
+
+  const UINT numUAVs =
+      m_WrappedContext->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
+  uavs[0] = m_DebugRender.histogramUAV;
+  m_pImmediateContext->CSSetUnorderedAccessViews(0, numUAVs, uavs, UAV_keepcounts);
+
+  m_pImmediateContext->CSSetConstantBuffers(0, 1, &cbuf);
+
+  m_pImmediateContext->CSSetShaderResources(srvOffset, eTexType_Max, details.srv);
+
+  ID3D11SamplerState *samps[] = {m_DebugRender.PointSampState, m_DebugRender.LinearSampState};
+  m_pImmediateContext->CSSetSamplers(0, 2, samps);
+
+  m_pImmediateContext->CSSetShader(m_DebugRender.HistogramCS[details.texType][intIdx], NULL, 0);
+
+  int tilesX = (int)ceil(cdata.HistogramTextureResolution.x /
+                         float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
+  int tilesY = (int)ceil(cdata.HistogramTextureResolution.y /
+                         float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
+
+  m_pImmediateContext->Dispatch(tilesX, tilesY, 1);
+
+  m_pImmediateContext->CopyResource(m_DebugRender.histogramStageBuff, m_DebugRender.histogramBuff);
+
+  D3D11_MAPPED_SUBRESOURCE mapped;
+
+  HRESULT hr =
+      m_pImmediateContext->Map(m_DebugRender.histogramStageBuff, 0, D3D11_MAP_READ, 0, &mapped);
+
+  histogram.clear();
+  histogram.resize(HGRAM_NUM_BUCKETS);
+
+  if(FAILED(hr))
+  {
+    RDCERR("Can't map histogram stage buff %08x", hr);
+  }
+  else
+  {
+    memcpy(&histogram[0], mapped.pData, sizeof(uint32_t) * HGRAM_NUM_BUCKETS);
+
+    m_pImmediateContext->Unmap(m_DebugRender.histogramStageBuff, 0);
+  }
+
+  return true;
+}
+
+bool D3D11DebugManager::PrepareValueSearch(uint32_t maxMatches)
+{
+  // one uint4 for the count, then one per match that can be stored
+  uint32_t size = sizeof(uint32_t) * 4 * (1 + maxMatches);
+
+  // resize up on demand
+  if(m_DebugRender.valueSearchBuff == NULL || m_DebugRender.valueSearchSize < size)
+  {
+    SAFE_RELEASE(m_DebugRender.valueSearchBuff);
+    SAFE_RELEASE(m_DebugRender.valueSearchStageBuff);
+    SAFE_RELEASE(m_DebugRender.valueSearchUAV);
+
+    m_DebugRender.valueSearchSize = 0;
+
+    // raw, so that the count can be added to atomically and the matches written as uint4s
+    D3D11_BUFFER_DESC bDesc = {
+        size, D3D11_USAGE_DEFAULT, D3D11_BIND_UNORDERED_ACCESS, 0,
+        D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS, 0,
+    };
+
+    HRESULT hr = m_pDevice->CreateBuffer(&bDesc, NULL, &m_DebugRender.valueSearchBuff);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create value search buff %08x", hr);
+      return false;
+    }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+    uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.FirstElement = 0;
+    uavDesc.Buffer.NumElements = size / sizeof(uint32_t);
+    uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+    hr = m_pDevice->CreateUnorderedAccessView(m_DebugRender.valueSearchBuff, &uavDesc,
+                                              &m_DebugRender.valueSearchUAV);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create value search UAV %08x", hr);
+      SAFE_RELEASE(m_DebugRender.valueSearchBuff);
+      return false;
+    }
+
+    bDesc.BindFlags = 0;
+    bDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    bDesc.Usage = D3D11_USAGE_STAGING;
+    bDesc.MiscFlags = 0;
+
+    hr = m_pDevice->CreateBuffer(&bDesc, NULL, &m_DebugRender.valueSearchStageBuff);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create value search stage buff %08x", hr);
+      SAFE_RELEASE(m_DebugRender.valueSearchBuff);
+      SAFE_RELEASE(m_DebugRender.valueSearchUAV);
+      return false;
+    }
+
+    m_DebugRender.valueSearchSize = size;
+  }
+
+  UINT zeroes[] = {0, 0, 0, 0};
+  m_pImmediateContext->ClearUnorderedAccessViewUint(m_DebugRender.valueSearchUAV, zeroes);
+
+  return true;
+}
+
+void D3D11DebugManager::FetchValueSearchResults(uint32_t maxMatches,
+                                                vector<ValueSearchMatch> &matches,
+                                                uint32_t &numMatches)
+{
+  RDCCOMPILE_ASSERT(sizeof(ValueSearchMatch) == sizeof(uint32_t) * 4,
+                    "ValueSearchMatch must match the layout in the shader");
+
+  m_pImmediateContext->CopyResource(m_DebugRender.valueSearchStageBuff,
+                                    m_DebugRender.valueSearchBuff);
+
+  D3D11_MAPPED_SUBRESOURCE mapped;
+
+  HRESULT hr =
+      m_pImmediateContext->Map(m_DebugRender.valueSearchStageBuff, 0, D3D11_MAP_READ, 0, &mapped);
+
+  if(FAILED(hr))
+  {
+    RDCERR("Can't map value search stage buff %08x", hr);
+    return;
+  }
+
+  const byte *results = (const byte *)mapped.pData;
+
+  // the count keeps going past the matches we had space for
+  numMatches = *(const uint32_t *)results;
+
+  matches.resize(RDCMIN(numMatches, maxMatches));
+  if(!matches.empty())
+    memcpy(&matches[0], results + sizeof(uint32_t) * 4, sizeof(ValueSearchMatch) * matches.size());
+
+  m_pImmediateContext->Unmap(m_DebugRender.valueSearchStageBuff, 0);
+}
+
+// buffer sizes are 32-bit, so cap how many matches can be stored
+static const uint32_t MaxStoredValueSearchMatches = 1 << 24;
+
+bool D3D11DebugManager::SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                            uint32_t sample, const ValueSearchParams &params,
+                                            vector<ValueSearchMatch> &matches,
+                                            uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  TextureShaderDetails details = GetShaderDetails(texid, eCompType_None, true);
+
+  if(details.texFmt == DXGI_FORMAT_UNKNOWN)
+    return false;
+
+  // integer values can't be NaN or infinite, and a range check on them is better done on the CPU
+  if(IsUIntFormat(details.texFmt) || IsIntFormat(details.texFmt))
+    return false;
+
+  if(m_DebugRender.ValueSearchCS[details.texType] == NULL)
+    return false;
+
+  D3D11RenderStateTracker tracker(m_WrappedContext);
+
+  uint32_t maxMatches = RDCMIN(params.maxMatches, MaxStoredValueSearchMatches);
+
+  if(!PrepareValueSearch(maxMatches))
+    return false;
+
+  ValueSearchCBufferData cdata;
+  RDCEraseEl(cdata);
+
+  cdata.SearchFlags = params.flags;
+  cdata.SearchMin = params.minValue;
+  cdata.SearchMax = params.maxValue;
+  cdata.SearchChannels = params.channelMask & 0xf;
+
+  cdata.SearchTextureResolution.x = (float)RDCMAX(details.texWidth >> mip, 1U);
+  cdata.SearchTextureResolution.y = (float)RDCMAX(details.texHeight >> mip, 1U);
+  cdata.SearchTextureResolution.z = (float)RDCMAX(details.texDepth >> mip, 1U);
+  cdata.SearchSlice = (float)sliceFace;
+  // 3D textures are loaded with the slice scaled up by the depth, so aim at the centre of it
+  if(details.texType == eTexType_3D)
+    cdata.SearchSlice = (float(sliceFace >> mip) + 0.5f) / cdata.SearchTextureResolution.z;
+  cdata.SearchMip = mip;
+  cdata.SearchSample = (int)RDCCLAMP(sample, 0U, details.sampleCount - 1);
+  if(sample == ~0U)
+    cdata.SearchSample = -int(details.sampleCount);
+  cdata.SearchMaxMatches = maxMatches;
+
+  ID3D11Buffer *cbuf = MakeCBuffer(&cdata, sizeof(cdata));
+
+  m_pImmediateContext->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, 0, NULL, NULL);
+
+  ID3D11UnorderedAccessView *uavs[D3D11_1_UAV_SLOT_COUNT] = {0};
+  UINT UAV_keepcounts[D3D11_1_UAV_SLOT_COUNT];
+  memset(&UAV_keepcounts[0], 0xff, sizeof(UAV_keepcounts));
+
+  const UINT numUAVs =
+      m_WrappedContext->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
+  uavs[0] = m_DebugRender.valueSearchUAV;
+  m_pImmediateContext->CSSetUnorderedAccessViews(0, numUAVs, uavs, UAV_keepcounts);
+
+  m_pImmediateContext->CSSetConstantBuffers(0, 1, &cbuf);
+
+  m_pImmediateContext->CSSetShaderResources(0, eTexType_Max, details.srv);
+
+  ID3D11SamplerState *samps[] = {m_DebugRender.PointSampState, m_DebugRender.LinearSampState};
+  m_pImmediateContext->CSSetSamplers(0, 2, samps);
+
+  m_pImmediateContext->CSSetShader(m_DebugRender.ValueSearchCS[details.texType], NULL, 0);
+
+  int groupsX = (int)ceil(cdata.SearchTextureResolution.x / float(VALUESEARCH_TEXELS_PER_GROUP));
+  int groupsY = (int)ceil(cdata.SearchTextureResolution.y / float(VALUESEARCH_TEXELS_PER_GROUP));
+
+  m_pImmediateContext->Dispatch(groupsX, groupsY, 1);
+
+  FetchValueSearchResults(maxMatches, matches, numMatches);
+
+  return true;
+}
+
+bool D3D11DebugManager::SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                           uint32_t numElems, const ValueSearchParams &params,
+                                           vector<ValueSearchMatch> &matches,
+                                           uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  auto it = WrappedID3D11Buffer::m_BufferList.find(buff);
+
+  if(it == WrappedID3D11Buffer::m_BufferList.end() || m_DebugRender.ValueSearchBufCS == NULL)
+    return false;
+
+  // the shader reads the buffer as dwords
+  if(stride == 0 || (stride % 4) != 0 || (offset % 4) != 0)
+  {
+    RDCWARN("Can't search buffer with offset %llu and stride %u, must be dword aligned", offset,
+            stride);
+    return false;
+  }
+
+  ID3D11Buffer *buffer = UNWRAP(WrappedID3D11Buffer, it->second.m_Buffer);
+
+  D3D11_BUFFER_DESC desc;
+  buffer->GetDesc(&desc);
+
+  if(offset >= desc.ByteWidth)
+    return true;
+
+  numElems = RDCMIN(numElems, (desc.ByteWidth - (uint32_t)offset) / stride);
+
+  if(numElems == 0)
+    return true;
+
+  uint32_t len = numElems * stride;
+
+  // most buffers will not be available as raw SRVs, so the searched range is copied into our own
+  // buffer. This stays on the GPU, only the matches are read back.
+  if(m_DebugRender.valueSearchSrcBuff == NULL || m_DebugRender.valueSearchSrcSize < len)
+  {
+    SAFE_RELEASE(m_DebugRender.valueSearchSrcBuff);
+    SAFE_RELEASE(m_DebugRender.valueSearchSrcSRV);
+
+    m_DebugRender.valueSearchSrcSize = 0;
+
+    D3D11_BUFFER_DESC bDesc = {
+        AlignUp4(len), D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0,
+        D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS, 0,
+    };
+
+    HRESULT hr = m_pDevice->CreateBuffer(&bDesc, NULL, &m_DebugRender.valueSearchSrcBuff);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create value search source buff %08x", hr);
+      return false;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+    srvDesc.BufferEx.FirstElement = 0;
+    srvDesc.BufferEx.NumElements = bDesc.ByteWidth / sizeof(uint32_t);
+    srvDesc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
+
+    hr = m_pDevice->CreateShaderResourceView(m_DebugRender.valueSearchSrcBuff, &srvDesc,
+                                             &m_DebugRender.valueSearchSrcSRV);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create value search source SRV %08x", hr);
+      SAFE_RELEASE(m_DebugRender.valueSearchSrcBuff);
+      return false;
+    }
+
+    m_DebugRender.valueSearchSrcSize = len;
+  }
+
+  D3D11RenderStateTracker tracker(m_WrappedContext);
+
+  uint32_t maxMatches = RDCMIN(params.maxMatches, MaxStoredValueSearchMatches);
+
+  if(!PrepareValueSearch(maxMatches))
+    return false;
+
+  D3D11_BOX box;
+  box.left = (uint32_t)offset;
+  box.right = (uint32_t)offset + len;
+  box.top = 0;
+  box.bottom = 1;
+  box.front = 0;
+  box.back = 1;
+
+  m_pImmediateContext->CopySubresourceRegion(m_DebugRender.valueSearchSrcBuff, 0, 0, 0, 0, buffer,
+                                             0, &box);
+
+  // spread the groups over rows so that large buffers don't exceed the dispatch limit
+  uint32_t numGroups = (numElems + VALUESEARCH_ELEMS_PER_GROUP - 1) / VALUESEARCH_ELEMS_PER_GROUP;
+  uint32_t groupsX = RDCMIN(numGroups, 65535U);
+  uint32_t groupsY = (numGroups + groupsX - 1) / groupsX;
+
+  ValueSearchCBufferData cdata;
+  RDCEraseEl(cdata);
+
+  cdata.SearchFlags = params.flags;
+  cdata.SearchMin = params.minValue;
+  cdata.SearchMax = params.maxValue;
+  cdata.SearchChannels = params.channelMask;
+  cdata.SearchMaxMatches = maxMatches;
+
+  cdata.SearchStride = stride / 4;
+  cdata.SearchOffset = 0;
+  cdata.SearchNumElements = numElems;
+  cdata.SearchElementsPerRow = groupsX * VALUESEARCH_ELEMS_PER_GROUP;
+
+  ID3D11Buffer *cbuf = MakeCBuffer(&cdata, sizeof(cdata));
+
+  m_pImmediateContext->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, 0, NULL, NULL);
+
+  ID3D11UnorderedAccessView *uavs[D3D11_1_UAV_SLOT_COUNT] = {0};
+  UINT UAV_keepcounts[D3D11_1_UAV_SLOT_COUNT];
+  memset(&UAV_keepcounts[0], 0xff, sizeof(UAV_keepcounts));
+
+  const UINT numUAVs =
+      m_WrappedContext->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
+  uavs[0] = m_DebugRender.valueSearchUAV;
+  m_pImmediateContext->CSSetUnorderedAccessViews(0, numUAVs, uavs, UAV_keepcounts);
+
+  m_pImmediateContext->CSSetConstantBuffers(0, 1, &cbuf);
+
+  m_pImmediateContext->CSSetShaderResources(0, 1, &m_DebugRender.valueSearchSrcSRV);
+
+  m_pImmediateContext->CSSetShader(m_DebugRender.ValueSearchBufCS, NULL, 0);
+
+  m_pImmediateContext->Dispatch(groupsX, groupsY, 1);
+
+  FetchValueSearchResults(maxMatches, matches, numMatches);
+
+  return true;
+}
+
+bool D3D11DebugManager::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                            uint32_t mip, uint32_t sample,
+                                            FormatComponentType typeHint)
+{
+  if(input >= ARRAY_COUNT(m_DebugRender.diffInputTex) || texid == ResourceId() ||
+     m_DebugRender.TexDiffCS == NULL)
+    return false;
+
+  TextureShaderDetails details = GetShaderDetails(texid, typeHint, true);
+
+  if(details.texFmt == DXGI_FORMAT_UNKNOWN)
+    return false;
+
+  // raw output of integer textures is their bits, which can't be subtracted as floats
+  if(IsUIntFormat(details.texFmt) || IsIntFormat(details.texFmt))
+    return false;
+
+  uint32_t w = RDCMAX(1U, details.texWidth >> mip);
+  uint32_t h = RDCMAX(1U, details.texHeight >> mip);
+
+  ID3D11Texture2D *&tex = m_DebugRender.diffInputTex[input];
+
+  if(tex)
+  {
+    D3D11_TEXTURE2D_DESC oldDesc;
+    tex->GetDesc(&oldDesc);
+
+    if(oldDesc.Width != w || oldDesc.Height != h)
+    {
+      SAFE_RELEASE(tex);
+      SAFE_RELEASE(m_DebugRender.diffInputRTV[input]);
+      SAFE_RELEASE(m_DebugRender.diffInputSRV[input]);
+    }
+  }
+
+  if(tex == NULL)
+  {
+    D3D11_TEXTURE2D_DESC texDesc;
+
+    texDesc.ArraySize = 1;
+    texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    texDesc.CPUAccessFlags = 0;
+    texDesc.MipLevels = 1;
+    texDesc.MiscFlags = 0;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.SampleDesc.Quality = 0;
+    texDesc.Usage = D3D11_USAGE_DEFAULT;
+    texDesc.Width = w;
+    texDesc.Height = h;
+    texDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+    HRESULT hr = m_pDevice->CreateTexture2D(&texDesc, NULL, &tex);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff input tex %08x", hr);
+      return false;
+    }
+
+    hr = m_pDevice->CreateRenderTargetView(tex, NULL, &m_DebugRender.diffInputRTV[input]);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff input RTV %08x", hr);
+      SAFE_RELEASE(tex);
+      return false;
+    }
+
+    hr = m_pDevice->CreateShaderResourceView(tex, NULL, &m_DebugRender.diffInputSRV[input]);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff input SRV %08x", hr);
+      SAFE_RELEASE(tex);
+      SAFE_RELEASE(m_DebugRender.diffInputRTV[input]);
+      return false;
+    }
+  }
+
+  D3D11RenderStateTracker tracker(m_WrappedContext);
+
+  // render the subresource 1:1 with raw output, which resolves multisampling, depth and any
+  // texture type down to floats in a plain 2D texture
+  m_pImmediateContext->OMSetRenderTargets(1, &m_DebugRender.diffInputRTV[input], NULL);
+
+  float clr[] = {0.0f, 0.0f, 0.0f, 0.0f};
+  m_pImmediateContext->ClearRenderTargetView(m_DebugRender.diffInputRTV[input], clr);
+
+  D3D11_VIEWPORT viewport;
+  RDCEraseEl(viewport);
+
+  viewport.TopLeftX = 0;
+  viewport.TopLeftY = 0;
+  viewport.Width = (float)w;
+  viewport.Height = (float)h;
+
+  m_pImmediateContext->RSSetViewports(1, &viewport);
+
+  TextureDisplay disp;
+  disp.Red = disp.Green = disp.Blue = disp.Alpha = true;
+  disp.FlipY = false;
+  disp.offx = 0.0f;
+  disp.offy = 0.0f;
+  disp.CustomShader = ResourceId();
+  disp.texid = texid;
+  disp.typeHint = typeHint;
+  disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector(0, 0, 0, 0);
+  disp.HDRMul = -1.0f;
+  disp.linearDisplayAsGamma = false;
+  disp.mip = mip;
+  disp.sampleIdx = sample;
+  disp.overlay = eTexOverlay_None;
+  disp.rangemin = 0.0f;
+  disp.rangemax = 1.0f;
+  disp.rawoutput = true;
+  disp.scale = 1.0f;
+  disp.sliceFace = sliceFace;
+
+  int oldW = GetWidth(), oldH = GetHeight();
+
+  SetOutputDimensions(w, h);
+
+  bool ret = RenderTexture(disp, false);
+
+  SetOutputDimensions(oldW, oldH);
+
+  return ret;
+}
+
+bool D3D11DebugManager::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  RDCEraseEl(result);
+
+  if(m_DebugRender.TexDiffCS == NULL || m_DebugRender.diffInputTex[0] == NULL ||
+     m_DebugRender.diffInputTex[1] == NULL)
+    return false;
+
+  D3D11_TEXTURE2D_DESC inDesc[2];
+  m_DebugRender.diffInputTex[0]->GetDesc(&inDesc[0]);
+  m_DebugRender.diffInputTex[1]->GetDesc(&inDesc[1]);
+
+  uint32_t w = RDCMIN(inDesc[0].Width, inDesc[1].Width);
+  uint32_t h = RDCMIN(inDesc[0].Height, inDesc[1].Height);
+
+  if(m_DiffTex)
+  {
+    D3D11_TEXTURE2D_DESC oldDesc;
+    m_DiffTex->GetDesc(&oldDesc);
+
+    if(oldDesc.Width != w || oldDesc.Height != h)
+    {
+      SAFE_RELEASE(m_DiffUAV);
+      SAFE_RELEASE(m_DiffTex);
+      m_DiffResourceId = ResourceId();
+    }
+  }
+
+  if(m_DiffTex == NULL)
+  {
+    D3D11_TEXTURE2D_DESC texDesc;
+
+    texDesc.ArraySize = 1;
+    texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    texDesc.CPUAccessFlags = 0;
+    texDesc.MipLevels = 1;
+    texDesc.MiscFlags = 0;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.SampleDesc.Quality = 0;
+    texDesc.Usage = D3D11_USAGE_DEFAULT;
+    texDesc.Width = w;
+    texDesc.Height = h;
+    texDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+    // created through the wrapped device so it can be displayed like any other texture
+    HRESULT hr = m_WrappedDevice->CreateTexture2D(&texDesc, NULL, &m_DiffTex);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff tex %08x", hr);
+      return false;
+    }
+
+    m_DiffResourceId = GetIDForResource(m_DiffTex);
+
+    WrappedID3D11Texture2D1 *wrapped = (WrappedID3D11Texture2D1 *)m_DiffTex;
+    hr = m_pDevice->CreateUnorderedAccessView(wrapped->GetReal(), NULL, &m_DiffUAV);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff UAV %08x", hr);
+      SAFE_RELEASE(m_DiffTex);
+      m_DiffResourceId = ResourceId();
+      return false;
+    }
+  }
+
+  if(m_DebugRender.diffResultBuff == NULL)
+  {
+    // raw, so that the stats can be accumulated with atomics
+    D3D11_BUFFER_DESC bDesc = {
+        sizeof(uint32_t) * 8, D3D11_USAGE_DEFAULT, D3D11_BIND_UNORDERED_ACCESS, 0,
+        D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS, 0,
+    };
+
+    HRESULT hr = m_pDevice->CreateBuffer(&bDesc, NULL, &m_DebugRender.diffResultBuff);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff result buff %08x", hr);
+      return false;
+    }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+    uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.FirstElement = 0;
+    uavDesc.Buffer.NumElements = 8;
+    uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+    hr = m_pDevice->CreateUnorderedAccessView(m_DebugRender.diffResultBuff, &uavDesc,
+                                              &m_DebugRender.diffResultUAV);
 
-  // The calculation in the shader normalises each value between min and max, then multiplies by the
-  // number of buckets.
-  // But any value equal to HistogramMax must go into NUM_BUCKETS-1, so add a small delta.
-  cdata.HistogramMax = maxval + maxval * 1e-6f;
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff result UAV %08x", hr);
+      SAFE_RELEASE(m_DebugRender.diffResultBuff);
+      return false;
+    }
 
-  cdata.HistogramChannels = 0;
-  if(channels[0])
-    cdata.HistogramChannels |= 0x1;
-  if(channels[1])
-    cdata.HistogramChannels |= 0x2;
-  if(channels[2])
-    cdata.HistogramChannels |= 0x4;
-  if(channels[3])
-    cdata.HistogramChannels |= 0x8;
-  cdata.HistogramFlags = 0;
+    bDesc.BindFlags = 0;
+    bDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    bDesc.Usage = D3D11_USAGE_STAGING;
+    bDesc.MiscFlags = 0;
 
-  int srvOffset = 0;
-  int intIdx = 0;
+    hr = m_pDevice->CreateBuffer(&bDesc, NULL, &m_DebugRender.diffResultStageBuff);
 
-  if(IsUIntFormat(details.texFmt))
-  {
-    cdata.HistogramFlags |= TEXDISPLAY_UINT_TEX;
-    srvOffset = 10;
-    intIdx = 1;
-  }
-  if(IsIntFormat(details.texFmt))
-  {
-    cdata.HistogramFlags |= TEXDISPLAY_SINT_TEX;
-    srvOffset = 20;
-    intIdx = 2;
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff result stage buff %08x", hr);
+      SAFE_RELEASE(m_DebugRender.diffResultBuff);
+      SAFE_RELEASE(m_DebugRender.diffResultUAV);
+      return false;
+    }
   }
 
-  if(details.texType == eTexType_3D)
-    cdata.HistogramSlice = float(sliceFace) / float(details.texDepth) + 0.001f;
+  D3D11RenderStateTracker tracker(m_WrappedContext);
+
+  TexDiffCBufferData cdata;
+  RDCEraseEl(cdata);
+
+  cdata.DiffWidth = w;
+  cdata.DiffHeight = h;
+  cdata.DiffThreshold = threshold;
 
   ID3D11Buffer *cbuf = MakeCBuffer(&cdata, sizeof(cdata));
 
   UINT zeroes[] = {0, 0, 0, 0};
-  m_pImmediateContext->ClearUnorderedAccessViewUint(m_DebugRender.histogramUAV, zeroes);
+  m_pImmediateContext->ClearUnorderedAccessViewUint(m_DebugRender.diffResultUAV, zeroes);
 
+  // the inputs were last bound as render targets
   m_pImmediateContext->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, 0, NULL, NULL);
 
   ID3D11UnorderedAccessView *uavs[D3D11_1_UAV_SLOT_COUNT] = {0};
@@ -1821,45 +2554,46 @@ bool D3D11DebugManager::GetHistogram(ResourceId texid, uint32_t sliceFace, uint3
 
   const UINT numUAVs =
       m_WrappedContext->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
-  uavs[0] = m_DebugRender.histogramUAV;
+  uavs[0] = m_DiffUAV;
+  uavs[1] = m_DebugRender.diffResultUAV;
   m_pImmediateContext->CSSetUnorderedAccessViews(0, numUAVs, uavs, UAV_keepcounts);
 
   m_pImmediateContext->CSSetConstantBuffers(0, 1, &cbuf);
 
-  m_pImmediateContext->CSSetShaderResources(srvOffset, eTexType_Max, details.srv);
-
-  ID3D11SamplerState *samps[] = {m_DebugRender.PointSampState, m_DebugRender.LinearSampState};
-  m_pImmediateContext->CSSetSamplers(0, 2, samps);
+  m_pImmediateContext->CSSetShaderResources(0, 2, m_DebugRender.diffInputSRV);
 
-  m_pImmediateContext->CSSetShader(m_DebugRender.HistogramCS[details.texType][intIdx], NULL, 0);
-
-  int tilesX = (int)ceil(cdata.HistogramTextureResolution.x /
-                         float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
-  int tilesY = (int)ceil(cdata.HistogramTextureResolution.y /
-                         float(HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK));
+  m_pImmediateContext->CSSetShader(m_DebugRender.TexDiffCS, NULL, 0);
 
-  m_pImmediateContext->Dispatch(tilesX, tilesY, 1);
+  m_pImmediateContext->Dispatch((w + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP,
+                                (h + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP, 1);
 
-  m_pImmediateContext->CopyResource(m_DebugRender.histogramStageBuff, m_DebugRender.histogramBuff);
+  m_pImmediateContext->CopyResource(m_DebugRender.diffResultStageBuff,
+                                    m_DebugRender.diffResultBuff);
 
   D3D11_MAPPED_SUBRESOURCE mapped;
 
   HRESULT hr =
-      m_pImmediateContext->Map(m_DebugRender.histogramStageBuff, 0, D3D11_MAP_READ, 0, &mapped);
-
-  histogram.clear();
-  histogram.resize(HGRAM_NUM_BUCKETS);
+      m_pImmediateContext->Map(m_DebugRender.diffResultStageBuff, 0, D3D11_MAP_READ, 0, &mapped);
 
   if(FAILED(hr))
   {
-    RDCERR("Can't map histogram stage buff %08x", hr);
+    RDCERR("Can't map diff result stage buff %08x", hr);
+    return false;
   }
-  else
-  {
-    memcpy(&histogram[0], mapped.pData, sizeof(uint32_t) * HGRAM_NUM_BUCKETS);
 
-    m_pImmediateContext->Unmap(m_DebugRender.histogramStageBuff, 0);
-  }
+  const uint32_t *stats = (const uint32_t *)mapped.pData;
+
+  RDCCOMPILE_ASSERT(sizeof(result.maxError) == sizeof(uint32_t) * 4,
+                    "max error doesn't match shader");
+  memcpy(result.maxError, stats, sizeof(result.maxError));
+
+  result.numDifferent = stats[4];
+
+  m_pImmediateContext->Unmap(m_DebugRender.diffResultStageBuff, 0);
+
+  result.diffTexture = m_DiffResourceId;
+  result.width = w;
+  result.height = h;
 
   return true;
 }
@@ -2071,6 +2805,107 @@ void D3D11DebugManager::GetBufferData(ID3D11Buffer *buffer, uint64_t offset, uin
   }
 }
 
+void D3D11DebugManager::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                       vector<vector<byte> > &retData)
+{
+  retData.resize(ranges.size());
+
+  struct BufferCopy
+  {
+    size_t idx;
+    ID3D11Buffer *buffer;
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  vector<BufferCopy> copies;
+
+  for(size_t i = 0; i < ranges.size(); i++)
+  {
+    auto it = WrappedID3D11Buffer::m_BufferList.find(ranges[i].buffer);
+
+    if(it == WrappedID3D11Buffer::m_BufferList.end())
+    {
+      RDCERR("Getting buffer data for unknown buffer %llu!", ranges[i].buffer);
+      continue;
+    }
+
+    ID3D11Buffer *buffer = it->second.m_Buffer;
+
+    D3D11_BUFFER_DESC desc;
+    buffer->GetDesc(&desc);
+
+    if(ranges[i].offset >= desc.ByteWidth)
+      continue;
+
+    uint32_t offs = (uint32_t)ranges[i].offset;
+    uint64_t len = ranges[i].length;
+
+    if(len == 0)
+      len = desc.ByteWidth - offs;
+
+    len = RDCMIN(len, uint64_t(desc.ByteWidth - offs));
+
+    // structured buffers have to be copied in whole structures, and anything larger than the
+    // stage buffer needs several copies, so those go on their own.
+    if(desc.StructureByteStride > 0 || len > STAGE_BUFFER_BYTE_SIZE)
+    {
+      GetBufferData(buffer, offs, len, retData[i], true);
+      continue;
+    }
+
+    BufferCopy copy = {i, buffer, offs, (uint32_t)len};
+    copies.push_back(copy);
+  }
+
+  D3D11_BOX box;
+  box.top = 0;
+  box.bottom = 1;
+  box.front = 0;
+  box.back = 1;
+
+  // pack the rest side by side into the stage buffer, so each fill of it needs only one map
+  size_t c = 0;
+  while(c < copies.size())
+  {
+    size_t first = c;
+    uint32_t used = 0;
+
+    for(; c < copies.size() && used + copies[c].length <= STAGE_BUFFER_BYTE_SIZE; c++)
+    {
+      box.left = copies[c].offset;
+      box.right = copies[c].offset + copies[c].length;
+
+      m_pImmediateContext->CopySubresourceRegion(m_DebugRender.StageBuffer, 0, used, 0, 0,
+                                                 UNWRAP(WrappedID3D11Buffer, copies[c].buffer), 0,
+                                                 &box);
+
+      used += copies[c].length;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+
+    HRESULT hr = m_pImmediateContext->Map(m_DebugRender.StageBuffer, 0, D3D11_MAP_READ, 0, &mapped);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to map bufferdata buffer %08x", hr);
+      return;
+    }
+
+    uint32_t readOffs = 0;
+    for(size_t i = first; i < c; i++)
+    {
+      vector<byte> &ret = retData[copies[i].idx];
+      ret.resize(copies[i].length);
+      memcpy(&ret[0], (byte *)mapped.pData + readOffs, copies[i].length);
+      readOffs += copies[i].length;
+    }
+
+    m_pImmediateContext->Unmap(m_DebugRender.StageBuffer, 0);
+  }
+}
+
 void D3D11DebugManager::CopyArrayToTex2DMS(ID3D11Texture2D *destMS, ID3D11Texture2D *srcArray)
 {
   D3D11RenderStateTracker tracker(m_WrappedContext);
@@ -2697,6 +3532,143 @@ D3D11DebugManager::CacheElem &D3D11DebugManager::GetCachedElem(ResourceId id,
   return m_ShaderItemCache.front();
 }
 
+ID3D11Resource *D3D11DebugManager::FindStagingTexture(D3D11_RESOURCE_DIMENSION dim,
+                                                      const void *desc, size_t descSize)
+{
+  for(auto it = m_StagingPool.begin(); it != m_StagingPool.end(); ++it)
+  {
+    if(it->dim == dim && !memcmp(&it->desc, desc, descSize))
+    {
+      ID3D11Resource *ret = it->tex;
+      m_StagingPoolSize -= it->size;
+      m_StagingPool.erase(it);
+      return ret;
+    }
+  }
+
+  return NULL;
+}
+
+ID3D11Texture1D *D3D11DebugManager::GetStagingTexture(const D3D11_TEXTURE1D_DESC &desc)
+{
+  ID3D11Texture1D *ret = (ID3D11Texture1D *)FindStagingTexture(D3D11_RESOURCE_DIMENSION_TEXTURE1D,
+                                                                &desc, sizeof(desc));
+
+  if(ret == NULL)
+  {
+    HRESULT hr = m_WrappedDevice->CreateTexture1D(&desc, NULL, &ret);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create staging texture %08x", hr);
+      return NULL;
+    }
+  }
+
+  return ret;
+}
+
+ID3D11Texture2D *D3D11DebugManager::GetStagingTexture(const D3D11_TEXTURE2D_DESC &desc)
+{
+  ID3D11Texture2D *ret = (ID3D11Texture2D *)FindStagingTexture(D3D11_RESOURCE_DIMENSION_TEXTURE2D,
+                                                                &desc, sizeof(desc));
+
+  if(ret == NULL)
+  {
+    HRESULT hr = m_WrappedDevice->CreateTexture2D(&desc, NULL, &ret);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create staging texture %08x", hr);
+      return NULL;
+    }
+  }
+
+  return ret;
+}
+
+ID3D11Texture3D *D3D11DebugManager::GetStagingTexture(const D3D11_TEXTURE3D_DESC &desc)
+{
+  ID3D11Texture3D *ret = (ID3D11Texture3D *)FindStagingTexture(D3D11_RESOURCE_DIMENSION_TEXTURE3D,
+                                                                &desc, sizeof(desc));
+
+  if(ret == NULL)
+  {
+    HRESULT hr = m_WrappedDevice->CreateTexture3D(&desc, NULL, &ret);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create staging texture %08x", hr);
+      return NULL;
+    }
+  }
+
+  return ret;
+}
+
+void D3D11DebugManager::ReleaseStagingTexture(ID3D11Resource *tex)
+{
+  if(tex == NULL)
+    return;
+
+  StagingElem elem;
+  RDCEraseEl(elem);
+  elem.tex = tex;
+  tex->GetType(&elem.dim);
+
+  UINT mips = 1, arraySize = 1;
+  UINT width = 1, height = 1, depth = 1;
+  DXGI_FORMAT fmt = DXGI_FORMAT_UNKNOWN;
+
+  if(elem.dim == D3D11_RESOURCE_DIMENSION_TEXTURE1D)
+  {
+    ((ID3D11Texture1D *)tex)->GetDesc(&elem.desc.tex1D);
+    mips = elem.desc.tex1D.MipLevels;
+    arraySize = elem.desc.tex1D.ArraySize;
+    width = elem.desc.tex1D.Width;
+    fmt = elem.desc.tex1D.Format;
+  }
+  else if(elem.dim == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+  {
+    ((ID3D11Texture2D *)tex)->GetDesc(&elem.desc.tex2D);
+    mips = elem.desc.tex2D.MipLevels;
+    arraySize = elem.desc.tex2D.ArraySize;
+    width = elem.desc.tex2D.Width;
+    height = elem.desc.tex2D.Height;
+    fmt = elem.desc.tex2D.Format;
+  }
+  else if(elem.dim == D3D11_RESOURCE_DIMENSION_TEXTURE3D)
+  {
+    ((ID3D11Texture3D *)tex)->GetDesc(&elem.desc.tex3D);
+    mips = elem.desc.tex3D.MipLevels;
+    width = elem.desc.tex3D.Width;
+    height = elem.desc.tex3D.Height;
+    depth = elem.desc.tex3D.Depth;
+    fmt = elem.desc.tex3D.Format;
+  }
+  else
+  {
+    RDCERR("Unexpected staging resource type %d", elem.dim);
+    SAFE_RELEASE(tex);
+    return;
+  }
+
+  for(UINT m = 0; m < mips; m++)
+    elem.size += GetByteSize(width, height, depth, fmt, m);
+  elem.size *= arraySize;
+
+  m_StagingPool.push_front(elem);
+  m_StagingPoolSize += elem.size;
+
+  while(!m_StagingPool.empty() && m_StagingPoolSize > MAX_STAGING_POOL_SIZE)
+  {
+    StagingElem &oldest = m_StagingPool.back();
+    m_StagingPoolSize -= oldest.size;
+    SAFE_RELEASE(oldest.tex);
+    m_StagingPool.pop_back();
+  }
+}
+
 D3D11DebugManager::TextureShaderDetails D3D11DebugManager::GetShaderDetails(
     ResourceId id, FormatComponentType typeHint, bool rawOutput)
 {
@@ -3627,6 +4599,75 @@ void D3D11DebugManager::RenderCheckerboard(Vec3f light, Vec3f dark)
   }
 }
 
+static uint64_t GetPostVSDataSize(const D3D11PostVSData &data)
+{
+  ID3D11Buffer *bufs[] = {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf};
+
+  uint64_t ret = 0;
+
+  for(size_t i = 0; i < ARRAY_COUNT(bufs); i++)
+  {
+    if(bufs[i] == NULL)
+      continue;
+
+    D3D11_BUFFER_DESC desc;
+    bufs[i]->GetDesc(&desc);
+    ret += desc.ByteWidth;
+  }
+
+  return ret;
+}
+
+uint64_t D3D11DebugManager::GetPostVSCacheSize()
+{
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    ret += GetPostVSDataSize(it->second);
+
+  return ret;
+}
+
+void D3D11DebugManager::TrimPostVSCache(uint64_t budget, uint32_t eventID)
+{
+  uint64_t total = 0;
+
+  // the events furthest from the current one are evicted first, as they're the least likely to
+  // be looked at again soon
+  vector<pair<uint32_t, uint32_t> > candidates;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    uint64_t size = GetPostVSDataSize(it->second);
+    total += size;
+
+    if(it->first != eventID && size > 0)
+    {
+      uint32_t dist = it->first > eventID ? it->first - eventID : eventID - it->first;
+      candidates.push_back(std::make_pair(dist, it->first));
+    }
+  }
+
+  if(total <= budget || candidates.empty())
+    return;
+
+  std::sort(candidates.rbegin(), candidates.rend());
+
+  for(size_t i = 0; i < candidates.size() && total > budget; i++)
+  {
+    D3D11PostVSData &data = m_PostVSData[candidates[i].second];
+
+    total -= GetPostVSDataSize(data);
+
+    SAFE_RELEASE(data.vsout.buf);
+    SAFE_RELEASE(data.vsout.idxBuf);
+    SAFE_RELEASE(data.gsout.buf);
+    SAFE_RELEASE(data.gsout.idxBuf);
+
+    m_PostVSData.erase(candidates[i].second);
+  }
+}
+
 MeshFormat D3D11DebugManager::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
 {
   D3D11PostVSData postvs;
@@ -3877,7 +4918,9 @@ void D3D11DebugManager::InitPostVSBuffers(uint32_t eventID)
       if(drawcall->baseVertex < 0)
         idxclamp = uint32_t(-drawcall->baseVertex);
 
-      // grab all unique vertex indices referenced
+      vector<uint32_t> remapped;
+      remapped.reserve(numIndices + 1);
+
       for(uint32_t i = 0; i < numIndices; i++)
       {
         uint32_t i32 = index16 ? uint32_t(idx16[i]) : idx32[i];
@@ -3890,18 +4933,13 @@ void D3D11DebugManager::InitPostVSBuffers(uint32_t eventID)
         else if(drawcall->baseVertex > 0)
           i32 += drawcall->baseVertex;
 
-        auto it = std::lower_bound(indices.begin(), indices.end(), i32);
-
-        if(it != indices.end() && *it == i32)
-          continue;
-
-        indices.insert(it, i32);
+        remapped.push_back(i32);
       }
 
       // if we read out of bounds, we'll also have a 0 index being referenced
-      // (as 0 is read). Don't insert 0 if we already have 0 though
-      if(numIndices < drawcall->numIndices && (indices.empty() || indices[0] != 0))
-        indices.insert(indices.begin(), 0);
+      // (as 0 is read).
+      if(numIndices < drawcall->numIndices)
+        remapped.push_back(0);
 
       // An index buffer could be something like: 500, 501, 502, 501, 503, 502
       // in which case we can't use the existing index buffer without filling 499 slots of vertex
@@ -3913,15 +4951,7 @@ void D3D11DebugManager::InitPostVSBuffers(uint32_t eventID)
       // We just stream-out a tightly packed list of unique indices, and then remap the index buffer
       // so that what did point to 500 points to 0 (accounting for rebasing), and what did point
       // to 510 now points to 3 (accounting for the unique sort).
-
-      // we use a map here since the indices may be sparse. Especially considering if an index
-      // is 'invalid' like 0xcccccccc then we don't want an array of 3.4 billion entries.
-      map<uint32_t, size_t> indexRemap;
-      for(size_t i = 0; i < indices.size(); i++)
-      {
-        // by definition, this index will only appear once in indices[]
-        indexRemap[indices[i]] = i;
-      }
+      CompactIndices(remapped, indices);
 
       D3D11_BUFFER_DESC desc = {UINT(sizeof(uint32_t) * indices.size()),
                                 D3D11_USAGE_IMMUTABLE,
@@ -3953,20 +4983,10 @@ void D3D11DebugManager::InitPostVSBuffers(uint32_t eventID)
       // vertex buffer
       for(uint32_t i = 0; i < numIndices; i++)
       {
-        uint32_t i32 = index16 ? uint32_t(idx16[i]) : idx32[i];
-
-        // apply baseVertex but clamp to 0 (don't allow index to become negative)
-        if(i32 < idxclamp)
-          i32 = 0;
-        else if(drawcall->baseVertex < 0)
-          i32 -= idxclamp;
-        else if(drawcall->baseVertex > 0)
-          i32 += drawcall->baseVertex;
-
         if(index16)
-          idx16[i] = uint16_t(indexRemap[i32]);
+          idx16[i] = uint16_t(remapped[i]);
         else
-          idx32[i] = uint32_t(indexRemap[i32]);
+          idx32[i] = remapped[i];
       }
 
       desc.ByteWidth = (UINT)idxdata.size();
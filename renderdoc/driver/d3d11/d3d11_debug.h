@@ -29,6 +29,7 @@
 #include <map>
 #include <utility>
 #include "api/replay/renderdoc_replay.h"
+#include "common/shader_cache.h"
 #include "driver/dx/official/d3d11_4.h"
 #include "driver/shaders/dxbc/dxbc_debug.h"
 #include "d3d11_renderstate.h"
@@ -127,9 +128,13 @@ public:
   int GetHeight() { return m_height; }
   void InitPostVSBuffers(uint32_t eventID);
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
+  uint64_t GetPostVSCacheSize();
+  // frees cached post-VS data for other events until the cache fits in budget bytes
+  void TrimPostVSCache(uint64_t budget, uint32_t eventID);
 
   uint32_t GetStructCount(ID3D11UnorderedAccessView *uav);
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t length, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
   void GetBufferData(ID3D11Buffer *buff, uint64_t offset, uint64_t length, vector<byte> &retData,
                      bool unwrap);
 
@@ -145,10 +150,27 @@ public:
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches);
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches);
+
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
 
   void CopyArrayToTex2DMS(ID3D11Texture2D *destMS, ID3D11Texture2D *srcArray);
   void CopyTex2DMSToArray(ID3D11Texture2D *destArray, ID3D11Texture2D *srcMS);
 
+  // staging textures for readback are pooled by description, and must be given back with
+  // ReleaseStagingTexture instead of releasing them directly. The textures are wrapped.
+  ID3D11Texture1D *GetStagingTexture(const D3D11_TEXTURE1D_DESC &desc);
+  ID3D11Texture2D *GetStagingTexture(const D3D11_TEXTURE2D_DESC &desc);
+  ID3D11Texture3D *GetStagingTexture(const D3D11_TEXTURE3D_DESC &desc);
+  void ReleaseStagingTexture(ID3D11Resource *tex);
+
   // called before any device is created, to init any counters
   static void PreDeviceInitCounters();
 
@@ -173,6 +195,8 @@ public:
   ID3D11PixelShader *MakePShader(const char *source, const char *entry, const char *profile);
   ID3D11ComputeShader *MakeCShader(const char *source, const char *entry, const char *profile);
 
+  void PrecompileShader(string source, string entry, const uint32_t compileFlags,
+                        ShaderStageType type);
   void BuildShader(string source, string entry, const uint32_t compileFlags, ShaderStageType type,
                    ResourceId *id, string *errors);
 
@@ -290,6 +314,29 @@ private:
 
   CacheElem &GetCachedElem(ResourceId id, FormatComponentType typeHint, bool raw);
 
+  struct StagingElem
+  {
+    D3D11_RESOURCE_DIMENSION dim;
+    union
+    {
+      D3D11_TEXTURE1D_DESC tex1D;
+      D3D11_TEXTURE2D_DESC tex2D;
+      D3D11_TEXTURE3D_DESC tex3D;
+    } desc;
+    uint64_t size;
+    ID3D11Resource *tex;
+  };
+
+  static const uint64_t MAX_STAGING_POOL_SIZE = 256 * 1024 * 1024;
+
+  // unused staging textures, most recently used first. Once the total size is over
+  // MAX_STAGING_POOL_SIZE the least recently used are released.
+  std::list<StagingElem> m_StagingPool;
+  uint64_t m_StagingPoolSize;
+
+  ID3D11Resource *FindStagingTexture(D3D11_RESOURCE_DIMENSION dim, const void *desc,
+                                     size_t descSize);
+
   int m_width, m_height;
   float m_supersamplingX, m_supersamplingY;
 
@@ -335,6 +382,11 @@ private:
 
   bool m_ShaderCacheDirty, m_CacheShaders;
   map<uint32_t, ID3DBlob *> m_ShaderCache;
+  ShaderCacheFile m_ShaderCacheFile;
+
+  // blobs and errors compiled off-thread by PrecompileShader, consumed by the next GetShaderBlob
+  Threading::CriticalSection m_PrecompiledLock;
+  map<uint32_t, pair<ID3DBlob *, string> > m_PrecompiledBlobs;
 
   static const int m_SOBufferSize = 32 * 1024 * 1024;
   ID3D11Buffer *m_SOBuffer;
@@ -366,6 +418,11 @@ private:
   ID3D11RenderTargetView *m_CustomShaderRTV;
   ResourceId m_CustomShaderResourceId;
 
+  // the difference between two diff inputs, displayed like any other texture
+  ID3D11Texture2D *m_DiffTex;
+  ID3D11UnorderedAccessView *m_DiffUAV;
+  ResourceId m_DiffResourceId;
+
   ID3D11BlendState *m_WireframeHelpersBS;
   ID3D11RasterizerState *m_WireframeHelpersRS, *m_WireframeHelpersCullCCWRS,
       *m_WireframeHelpersCullCWRS;
@@ -506,6 +563,8 @@ private:
           if(i == 0)
             SAFE_RELEASE(ResultMinMaxCS[j]);
         }
+
+        SAFE_RELEASE(ValueSearchCS[i]);
       }
 
       SAFE_RELEASE(histogramBuff);
@@ -513,6 +572,24 @@ private:
 
       SAFE_RELEASE(histogramUAV);
 
+      SAFE_RELEASE(ValueSearchBufCS);
+      SAFE_RELEASE(valueSearchBuff);
+      SAFE_RELEASE(valueSearchStageBuff);
+      SAFE_RELEASE(valueSearchUAV);
+      SAFE_RELEASE(valueSearchSrcBuff);
+      SAFE_RELEASE(valueSearchSrcSRV);
+
+      SAFE_RELEASE(TexDiffCS);
+      for(int i = 0; i < 2; i++)
+      {
+        SAFE_RELEASE(diffInputTex[i]);
+        SAFE_RELEASE(diffInputRTV[i]);
+        SAFE_RELEASE(diffInputSRV[i]);
+      }
+      SAFE_RELEASE(diffResultBuff);
+      SAFE_RELEASE(diffResultStageBuff);
+      SAFE_RELEASE(diffResultUAV);
+
       SAFE_DELETE_ARRAY(MeshVSBytecode);
 
       SAFE_RELEASE(PickPixelRT);
@@ -568,6 +645,25 @@ private:
     ID3D11Buffer *histogramBuff, *histogramStageBuff;
     ID3D11UnorderedAccessView *histogramUAV;
 
+    // value search only looks at float textures. The result and source buffers are created on
+    // demand, for the number of matches to store and the size of the searched buffer
+    ID3D11ComputeShader *ValueSearchCS[eTexType_Max];
+    ID3D11ComputeShader *ValueSearchBufCS;
+    ID3D11Buffer *valueSearchBuff, *valueSearchStageBuff;
+    ID3D11UnorderedAccessView *valueSearchUAV;
+    uint32_t valueSearchSize;
+    ID3D11Buffer *valueSearchSrcBuff;
+    ID3D11ShaderResourceView *valueSearchSrcSRV;
+    uint32_t valueSearchSrcSize;
+
+    // texture diff inputs are raw RGBA32F renders of the compared subresources, created on demand
+    ID3D11ComputeShader *TexDiffCS;
+    ID3D11Texture2D *diffInputTex[2];
+    ID3D11RenderTargetView *diffInputRTV[2];
+    ID3D11ShaderResourceView *diffInputSRV[2];
+    ID3D11Buffer *diffResultBuff, *diffResultStageBuff;
+    ID3D11UnorderedAccessView *diffResultUAV;
+
     byte *MeshVSBytecode;
     uint32_t MeshVSBytelen;
 
@@ -579,8 +675,14 @@ private:
 
   bool InitDebugRendering();
 
+  bool PrepareValueSearch(uint32_t maxMatches);
+  void FetchValueSearchResults(uint32_t maxMatches, vector<ValueSearchMatch> &matches,
+                               uint32_t &numMatches);
+
   ShaderDebug::State CreateShaderDebugState(ShaderDebugTrace &trace, int quadIdx,
-                                            DXBC::DXBCFile *dxbc, vector<byte> *cbufData);
+                                            DXBC::DXBCFile *dxbc,
+                                            const ShaderDebug::GlobalState &global,
+                                            vector<byte> *cbufData);
   void CreateShaderGlobalState(ShaderDebug::GlobalState &global, DXBC::DXBCFile *dxbc,
                                uint32_t UAVStartSlot, ID3D11UnorderedAccessView **UAVs,
                                ID3D11ShaderResourceView **SRVs);
@@ -596,6 +698,7 @@ private:
   void PreDeviceShutdownCounters();
 
   void FillTimers(D3D11CounterContext &ctx, const DrawcallTreeNode &drawnode);
+  void FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret);
 
   void FillCBuffer(ID3D11Buffer *buf, const void *data, size_t size);
 };
@@ -240,6 +240,8 @@ const uint32_t D3D11InitParams::D3D11_OLD_VERSIONS[D3D11InitParams::D3D11_NUM_SU
     0x000009,
     // from 0xA to 0xB, we added the SwapDeviceContextState from ID3D11DeviceContext1
     0x00000A,
+    // from 0xB to 0xC, the capture footer stores any event timings recorded while capturing
+    0x00000B,
 };
 
 ReplayCreateStatus D3D11InitParams::Serialise()
@@ -352,6 +354,8 @@ WrappedID3D11Device::WrappedID3D11Device(ID3D11Device *realDevice, D3D11InitPara
   m_ChunkAtomic = 0;
 
   m_AppControlledCapture = false;
+  m_CapSpanFrames = 0;
+  m_CapSpanWindow = NULL;
 
 #if ENABLED(RDOC_RELEASE)
   const bool debugSerialiser = false;
@@ -1713,22 +1717,15 @@ bool WrappedID3D11Device::Serialise_InitialState(ResourceId resid, ID3D11DeviceC
         desc.Usage = D3D11_USAGE_IMMUTABLE;
         desc.MiscFlags = 0;
 
-        ID3D11Texture1D *contents = NULL;
-        HRESULT hr = m_pDevice->CreateTexture1D(&desc, subData, &contents);
+        InitialTextureJob *job = new InitialTextureJob();
+        job->device = this;
+        job->id = Id;
+        job->dimension = 1;
+        job->desc1D = desc;
+        job->numSubresources = numSubresources;
+        job->subData = subData;
 
-        if(FAILED(hr) || contents == NULL)
-        {
-          RDCERR("Failed to create staging resource for Texture1D initial contents %08x", hr);
-        }
-        else
-        {
-          m_ResourceManager->SetInitialContents(
-              Id, D3D11ResourceManager::InitialContentData(contents, eInitialContents_Copy, NULL));
-        }
-
-        for(UINT sub = 0; sub < numSubresources; sub++)
-          SAFE_DELETE_ARRAY(subData[sub].pSysMem);
-        SAFE_DELETE_ARRAY(subData);
+        QueueInitialTexture(job);
       }
     }
   }
@@ -1897,6 +1894,22 @@ bool WrappedID3D11Device::Serialise_InitialState(ResourceId resid, ID3D11DeviceC
 
         initialDesc.Usage = D3D11_USAGE_IMMUTABLE;
 
+        // multisampled contents need the immediate context to copy into the real resource, so
+        // only single-sampled textures can be created off the main thread.
+        if(!multisampled)
+        {
+          InitialTextureJob *job = new InitialTextureJob();
+          job->device = this;
+          job->id = Id;
+          job->dimension = 2;
+          job->desc2D = initialDesc;
+          job->numSubresources = numSubresources;
+          job->subData = subData;
+
+          QueueInitialTexture(job);
+          return true;
+        }
+
         HRESULT hr = S_OK;
 
         ID3D11Texture2D *contents = NULL;
@@ -2062,22 +2075,15 @@ bool WrappedID3D11Device::Serialise_InitialState(ResourceId resid, ID3D11DeviceC
         desc.Usage = D3D11_USAGE_IMMUTABLE;
         desc.MiscFlags = 0;
 
-        ID3D11Texture3D *contents = NULL;
-        HRESULT hr = m_pDevice->CreateTexture3D(&desc, subData, &contents);
+        InitialTextureJob *job = new InitialTextureJob();
+        job->device = this;
+        job->id = Id;
+        job->dimension = 3;
+        job->desc3D = desc;
+        job->numSubresources = numSubresources;
+        job->subData = subData;
 
-        if(FAILED(hr) || contents == NULL)
-        {
-          RDCERR("Failed to create staging resource for Texture3D initial contents %08x", hr);
-        }
-        else
-        {
-          m_ResourceManager->SetInitialContents(
-              Id, D3D11ResourceManager::InitialContentData(contents, eInitialContents_Copy, NULL));
-        }
-
-        for(UINT sub = 0; sub < numSubresources; sub++)
-          SAFE_DELETE_ARRAY(subData[sub].pSysMem);
-        SAFE_DELETE_ARRAY(subData);
+        QueueInitialTexture(job);
       }
     }
   }
@@ -2089,6 +2095,56 @@ bool WrappedID3D11Device::Serialise_InitialState(ResourceId resid, ID3D11DeviceC
   return true;
 }
 
+void WrappedID3D11Device::QueueInitialTexture(InitialTextureJob *job)
+{
+  // the replay device is always created free-threaded, see D3D11_CreateReplayDevice
+  m_ResourceManager->QueueInitialContentsJob(&WrappedID3D11Device::CreateInitialTexture, job);
+}
+
+void WrappedID3D11Device::CreateInitialTexture(void *data)
+{
+  InitialTextureJob *job = (InitialTextureJob *)data;
+  WrappedID3D11Device *device = job->device;
+
+  ID3D11Resource *contents = NULL;
+  HRESULT hr = S_OK;
+
+  if(job->dimension == 1)
+  {
+    ID3D11Texture1D *tex = NULL;
+    hr = device->m_pDevice->CreateTexture1D(&job->desc1D, job->subData, &tex);
+    contents = tex;
+  }
+  else if(job->dimension == 2)
+  {
+    ID3D11Texture2D *tex = NULL;
+    hr = device->m_pDevice->CreateTexture2D(&job->desc2D, job->subData, &tex);
+    contents = tex;
+  }
+  else if(job->dimension == 3)
+  {
+    ID3D11Texture3D *tex = NULL;
+    hr = device->m_pDevice->CreateTexture3D(&job->desc3D, job->subData, &tex);
+    contents = tex;
+  }
+
+  if(FAILED(hr) || contents == NULL)
+  {
+    RDCERR("Failed to create staging resource for Texture%dD initial contents %08x",
+           job->dimension, hr);
+  }
+  else
+  {
+    device->m_ResourceManager->SetInitialContents(
+        job->id, D3D11ResourceManager::InitialContentData(contents, eInitialContents_Copy, NULL));
+  }
+
+  for(UINT sub = 0; sub < job->numSubresources; sub++)
+    SAFE_DELETE_ARRAY(job->subData[sub].pSysMem);
+  SAFE_DELETE_ARRAY(job->subData);
+  SAFE_DELETE(job);
+}
+
 void WrappedID3D11Device::Create_InitialState(ResourceId id, ID3D11DeviceChild *live, bool hasData)
 {
   ResourceType type = IdentifyTypeByPtr(live);
@@ -3041,25 +3097,25 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 
       RDCDEBUG("Accumulating context resource list");
 
-      map<int32_t, Chunk *> recordlist;
+      RecordChunkList recordlist;
       record->Insert(recordlist);
 
       RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
-      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-        m_pFileSerialiser->Insert(it->second);
+      vector<Chunk *> sortedChunks;
+      recordlist.Merge(sortedChunks);
+
+      for(size_t i = 0; i < sortedChunks.size(); i++)
+        m_pFileSerialiser->Insert(sortedChunks[i]);
 
       RDCDEBUG("Done");
     }
 
-    m_pFileSerialiser->FlushToDisk();
+    RenderDoc::Inst().FinishCaptureWrite(m_pFileSerialiser, m_FrameCounter);
+    m_pFileSerialiser = NULL;
 
     UnlockForChunkFlushing();
 
-    SAFE_DELETE(m_pFileSerialiser);
-
-    RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
     m_State = WRITING_IDLE;
 
     m_pImmediateContext->CleanupCapture();
@@ -3096,9 +3152,9 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 
     m_Failures++;
 
-    if((RenderDoc::Inst().GetOverlayBits() & eRENDERDOC_Overlay_Enabled) && swap != NULL)
+    if(RenderDoc::Inst().ShouldDrawOverlay() && swap != NULL)
     {
-      D3D11RenderState old = *m_pImmediateContext->GetCurrentPipelineState();
+      D3D11RenderState old(m_pImmediateContext);
 
       ID3D11RenderTargetView *rtv = m_SwapChains[swap];
 
@@ -3297,11 +3353,18 @@ void WrappedID3D11Device::FirstFrame(WrappedIDXGISwapChain4 *swapChain)
   DXGI_SWAP_CHAIN_DESC swapdesc = swapChain->GetDescWithHWND();
 
   // if we have to capture the first frame, begin capturing immediately
-  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0))
+  uint32_t spanFrames = 0;
+  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0, spanFrames))
   {
     RenderDoc::Inst().StartFrameCapture((ID3D11Device *)this, swapdesc.OutputWindow);
 
     m_AppControlledCapture = false;
+
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = swapdesc.OutputWindow;
+    }
   }
 }
 
@@ -3312,7 +3375,7 @@ HRESULT WrappedID3D11Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
 
   m_pCurrentWrappedDevice = this;
 
-  if(m_State == WRITING_IDLE)
+  if(m_State == WRITING_IDLE || RenderDoc::Inst().IsRingFrameActive())
     RenderDoc::Inst().Tick();
 
   m_pImmediateContext->EndFrame();
@@ -3326,12 +3389,11 @@ HRESULT WrappedID3D11Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
 
   if(m_State == WRITING_IDLE)
   {
-    D3D11RenderState old = *m_pImmediateContext->GetCurrentPipelineState();
-
-    uint32_t overlay = RenderDoc::Inst().GetOverlayBits();
-
-    if(overlay & eRENDERDOC_Overlay_Enabled)
+    if(RenderDoc::Inst().ShouldDrawOverlay())
     {
+      // the tracked state doesn't resolve hazards while idle, so save what's really bound instead
+      D3D11RenderState old(m_pImmediateContext);
+
       ID3D11RenderTargetView *rtv = m_SwapChains[swap];
 
       m_pImmediateContext->GetReal()->OMSetRenderTargets(1, &rtv, NULL);
@@ -3370,19 +3432,36 @@ HRESULT WrappedID3D11Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
 
   RenderDoc::Inst().SetCurrentDriver(RDC_D3D11);
 
-  // kill any current capture that isn't application defined
+  // kill any current capture that isn't application defined, unless it's still recording a run of
+  // frames on this window. The serialised Present marks the frame boundary either way
   if(m_State == WRITING_CAPFRAME && !m_AppControlledCapture)
   {
     m_pImmediateContext->Present(SyncInterval, Flags);
 
-    RenderDoc::Inst().EndFrameCapture((ID3D11Device *)this, swapdesc.OutputWindow);
+    if(m_CapSpanFrames > 0 && m_CapSpanWindow == swapdesc.OutputWindow)
+    {
+      m_CapSpanFrames--;
+    }
+    else
+    {
+      m_CapSpanFrames = 0;
+      RenderDoc::Inst().EndFrameCapture((ID3D11Device *)this, swapdesc.OutputWindow);
+    }
   }
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && m_State == WRITING_IDLE)
+  uint32_t spanFrames = 0;
+  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter, spanFrames) && m_State == WRITING_IDLE)
   {
     RenderDoc::Inst().StartFrameCapture((ID3D11Device *)this, swapdesc.OutputWindow);
 
     m_AppControlledCapture = false;
+
+    // the run belongs to this device's capture, once it has actually started
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = swapdesc.OutputWindow;
+    }
   }
 
   return S_OK;
@@ -3483,7 +3562,7 @@ bool WrappedID3D11Device::Serialise_SetResourceName(ID3D11DeviceChild *res, cons
 {
   SERIALISE_ELEMENT(ResourceId, resource, GetIDForResource(res));
   string name = nm ? nm : "";
-  m_pSerialiser->Serialise("name", name);
+  m_pSerialiser->SerialiseInternedString("name", name);
 
   if(m_State < WRITING && GetResourceManager()->HasLiveResource(resource))
   {
@@ -62,10 +62,10 @@ struct D3D11InitParams : public RDCInitParams
   UINT NumFeatureLevels;
   D3D_FEATURE_LEVEL FeatureLevels[16];
 
-  static const uint32_t D3D11_SERIALISE_VERSION = 0x000000B;
+  static const uint32_t D3D11_SERIALISE_VERSION = 0x000000C;
 
   // backwards compatibility for old logs described at the declaration of this array
-  static const uint32_t D3D11_NUM_SUPPORTED_OLD_VERSIONS = 7;
+  static const uint32_t D3D11_NUM_SUPPORTED_OLD_VERSIONS = 8;
   static const uint32_t D3D11_OLD_VERSIONS[D3D11_NUM_SUPPORTED_OLD_VERSIONS];
 
   // version number internal to d3d11 stream
@@ -319,6 +319,23 @@ private:
     eInitialContents_ClearDSV = 2,
   };
 
+  // on replay, the immutable textures holding initial contents are created on the resource
+  // manager's worker threads once their subresource data has been read out of the log.
+  struct InitialTextureJob
+  {
+    WrappedID3D11Device *device;
+    ResourceId id;
+    int dimension;
+    D3D11_TEXTURE1D_DESC desc1D;
+    D3D11_TEXTURE2D_DESC desc2D;
+    D3D11_TEXTURE3D_DESC desc3D;
+    UINT numSubresources;
+    D3D11_SUBRESOURCE_DATA *subData;
+  };
+
+  static void CreateInitialTexture(void *data);
+  void QueueInitialTexture(InitialTextureJob *job);
+
   D3D11Replay m_Replay;
 
   DummyID3D10Multithread m_DummyD3D10Multithread;
@@ -363,6 +380,11 @@ private:
   LogState m_State;
   bool m_AppControlledCapture;
 
+  // presents left in a run of frames being combined into this device's capture, only counted on
+  // the window the capture started on
+  uint32_t m_CapSpanFrames;
+  HWND m_CapSpanWindow;
+
   set<ID3D11DeviceChild *> m_CachedStateObjects;
 
   // This function will check if m_CachedStateObjects is growing too large, and if so
@@ -45,6 +45,8 @@ struct D3D11ResourceRecord : public ResourceRecord
       : ResourceRecord(id, true), NumSubResources(0), SubResources(NULL)
   {
     RDCEraseEl(ShadowPtr);
+    RDCEraseEl(ShadowTrackWrites);
+    RDCEraseEl(ShadowWatch);
     RDCEraseEl(contexts);
     ignoreSerialise = false;
   }
@@ -62,17 +64,31 @@ struct D3D11ResourceRecord : public ResourceRecord
     FreeShadowStorage();
   }
 
-  void AllocShadowStorage(int ctx, size_t size)
+  // if trackWrites is set the first shadow buffer is page aligned and padded to whole pages, so
+  // that writes to it can be watched, see WatchShadowWrites
+  void AllocShadowStorage(int ctx, size_t size, bool trackWrites = false)
   {
     if(ShadowPtr[ctx][0] == NULL)
     {
-      ShadowPtr[ctx][0] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      if(trackWrites)
+      {
+        size_t pageSize = VirtualMemory::GetPageSize();
+        ShadowPtr[ctx][0] = Serialiser::AllocAlignedBuffer(
+            AlignUp(size + sizeof(markerValue), pageSize), pageSize);
+      }
+      else
+      {
+        ShadowPtr[ctx][0] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      }
       ShadowPtr[ctx][1] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      ShadowTrackWrites[ctx] = trackWrites;
 
       memcpy(ShadowPtr[ctx][0] + size, markerValue, sizeof(markerValue));
       memcpy(ShadowPtr[ctx][1] + size, markerValue, sizeof(markerValue));
 
       ShadowSize[ctx] = size;
+
+      RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows, int64_t(size * 2));
     }
   }
 
@@ -89,14 +105,36 @@ struct D3D11ResourceRecord : public ResourceRecord
     return true;
   }
 
+  // starts tracking which pages of the first shadow buffer are written, so that comparing it
+  // against the second only needs to look at those. Does nothing unless it was allocated to allow
+  // it
+  void WatchShadowWrites(int ctx)
+  {
+    if(ShadowPtr[ctx][0] != NULL && ShadowTrackWrites[ctx] && ShadowWatch[ctx] == 0)
+      ShadowWatch[ctx] =
+          WriteWatch::Begin(ShadowPtr[ctx][0], ShadowSize[ctx] + sizeof(markerValue));
+  }
+
+  void UnwatchShadowWrites(int ctx)
+  {
+    WriteWatch::End(ShadowWatch[ctx]);
+    ShadowWatch[ctx] = 0;
+  }
+
+  uint64_t GetShadowWatch(int ctx) { return ShadowWatch[ctx]; }
   void FreeShadowStorage()
   {
     for(int i = 0; i < 32; i++)
     {
+      UnwatchShadowWrites(i);
+
       if(ShadowPtr[i][0] != NULL)
       {
         Serialiser::FreeAlignedBuffer(ShadowPtr[i][0]);
         Serialiser::FreeAlignedBuffer(ShadowPtr[i][1]);
+
+        RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows,
+                                           -int64_t(ShadowSize[i] * 2));
       }
       ShadowPtr[i][0] = ShadowPtr[i][1] = NULL;
     }
@@ -131,7 +169,7 @@ struct D3D11ResourceRecord : public ResourceRecord
       SubResources[i]->SetDataPtr(ptr);
   }
 
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(RecordChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -147,7 +185,7 @@ struct D3D11ResourceRecord : public ResourceRecord
 
     if(!dataWritten)
     {
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.AddRun(m_Chunks);
 
       for(int i = 0; i < NumSubResources; i++)
         SubResources[i]->Insert(recordlist);
@@ -162,6 +200,8 @@ struct D3D11ResourceRecord : public ResourceRecord
 private:
   byte *ShadowPtr[32][2];
   size_t ShadowSize[32];
+  bool ShadowTrackWrites[32];
+  uint64_t ShadowWatch[32];
 
   bool contexts[32];
 };
@@ -45,6 +45,7 @@ D3D11RenderState::D3D11RenderState(Serialiser *ser)
   m_pSerialiser = ser;
 
   m_ImmediatePipeline = false;
+  m_TrackHazards = true;
   m_pDevice = NULL;
 }
 
@@ -64,6 +65,7 @@ D3D11RenderState::D3D11RenderState(const D3D11RenderState &other)
   *this = other;
 
   m_ImmediatePipeline = false;
+  m_TrackHazards = true;
   m_pDevice = NULL;
 }
 
@@ -91,6 +93,26 @@ D3D11RenderState &D3D11RenderState::operator=(const D3D11RenderState &other)
   return *this;
 }
 
+void D3D11RenderState::SyncBindings(const D3D11RenderState &other)
+{
+  bool immediate = m_ImmediatePipeline;
+  WrappedID3D11Device *device = m_pDevice;
+
+  // assignment drops our refs correctly but takes plain refs on the new bindings, so swap those
+  // for pipeline refs if needed. other keeps everything alive in between.
+  *this = other;
+
+  if(immediate)
+  {
+    ReleaseRefs();
+    m_ImmediatePipeline = true;
+    m_pDevice = device;
+    AddRefs();
+  }
+
+  m_pDevice = device;
+}
+
 D3D11RenderState::~D3D11RenderState()
 {
   ReleaseRefs();
@@ -752,6 +774,7 @@ D3D11RenderState::D3D11RenderState(WrappedID3D11DeviceContext *context)
 {
   RDCEraseMem(this, sizeof(D3D11RenderState));
   m_pSerialiser = context->GetSerialiser();
+  m_TrackHazards = true;
 
   // IA
   context->IAGetInputLayout(&IA.Layout);
@@ -938,6 +961,119 @@ void D3D11RenderState::ApplyState(WrappedID3D11DeviceContext *context)
         D3D11_PS_CS_UAV_REGISTER_COUNT - OM.UAVStartSlot, OM.UAVs, UAV_keepcounts);
 }
 
+void D3D11RenderState::ApplyChangedState(WrappedID3D11DeviceContext *context)
+{
+  // Unlike ApplyState we don't clear the pipeline first. Every group of state is still set on the
+  // real context since replay-side operations often bind directly to it behind the tracked state,
+  // but any slot that already matches the tracked state is skipped by ChangeRefRead/ChangeRefWrite,
+  // so after a debug operation this only costs refcounting and hazard checks for what changed.
+  D3D11RenderState *cur = context->GetCurrentPipelineState();
+  ID3D11DeviceContext *real = context->GetReal();
+
+  UINT UAVCount = context->IsFL11_1() ? D3D11_1_UAV_SLOT_COUNT : D3D11_PS_CS_UAV_REGISTER_COUNT;
+
+  UINT UAV_keepcounts[D3D11_1_UAV_SLOT_COUNT] = {(UINT)-1, (UINT)-1, (UINT)-1, (UINT)-1,
+                                                 (UINT)-1, (UINT)-1, (UINT)-1, (UINT)-1};
+
+  ID3D11Buffer *NullBuffers[D3D11_SO_BUFFER_SLOT_COUNT] = {0};
+  ID3D11UnorderedAccessView *NullUAVs[D3D11_1_UAV_SLOT_COUNT] = {0};
+
+  // Anything bound for write must be unbound before the read binds are restored, or reads of those
+  // resources will be forced to NULL. If the tracked write binds differ from ours they need to be
+  // unbound through the context so the hazard tracking sees it, otherwise only the real context
+  // can have anything different bound and we can unbind there without touching any refs. Once our
+  // write binds are restored at the end none of our reads can conflict, as this state was valid.
+  bool SOChanged = memcmp(SO.Buffers, cur->SO.Buffers, sizeof(SO.Buffers)) != 0;
+  bool CSUAVsChanged = memcmp(CSUAVs, cur->CSUAVs, sizeof(CSUAVs)) != 0;
+  bool OMChanged = OM.DepthView != cur->OM.DepthView ||
+                   memcmp(OM.RenderTargets, cur->OM.RenderTargets, sizeof(OM.RenderTargets)) != 0 ||
+                   memcmp(OM.UAVs, cur->OM.UAVs, sizeof(OM.UAVs)) != 0;
+
+  if(SOChanged)
+    context->SOSetTargets(D3D11_SO_BUFFER_SLOT_COUNT, NullBuffers, NULL);
+  else
+    real->SOSetTargets(0, NULL, NULL);
+
+  if(CSUAVsChanged)
+    context->CSSetUnorderedAccessViews(0, UAVCount, NullUAVs, UAV_keepcounts);
+  else
+    real->CSSetUnorderedAccessViews(0, UAVCount, NullUAVs, UAV_keepcounts);
+
+  if(OMChanged)
+    context->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, UAVCount, NullUAVs,
+                                                       UAV_keepcounts);
+  else
+    real->OMSetRenderTargetsAndUnorderedAccessViews(0, NULL, NULL, 0, UAVCount, NullUAVs,
+                                                    UAV_keepcounts);
+
+  // IA
+  context->IASetInputLayout(IA.Layout);
+  context->IASetPrimitiveTopology(IA.Topo);
+  context->IASetIndexBuffer(IA.IndexBuffer, IA.IndexFormat, IA.IndexOffset);
+  context->IASetVertexBuffers(0, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT, IA.VBs, IA.Strides,
+                              IA.Offsets);
+
+  // VS
+  context->VSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, VS.SRVs);
+  context->VSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, VS.Samplers);
+  context->VSSetShader((ID3D11VertexShader *)VS.Shader, VS.Instances, VS.NumInstances);
+
+  // DS
+  context->DSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, DS.SRVs);
+  context->DSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, DS.Samplers);
+  context->DSSetShader((ID3D11DomainShader *)DS.Shader, DS.Instances, DS.NumInstances);
+
+  // HS
+  context->HSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, HS.SRVs);
+  context->HSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, HS.Samplers);
+  context->HSSetShader((ID3D11HullShader *)HS.Shader, HS.Instances, HS.NumInstances);
+
+  // GS
+  context->GSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, GS.SRVs);
+  context->GSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, GS.Samplers);
+  context->GSSetShader((ID3D11GeometryShader *)GS.Shader, GS.Instances, GS.NumInstances);
+
+  // RS
+  context->RSSetState(RS.State);
+  context->RSSetViewports(RS.NumViews, RS.Viewports);
+  context->RSSetScissorRects(RS.NumScissors, RS.Scissors);
+
+  // CS
+  context->CSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, CS.SRVs);
+  context->CSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, CS.Samplers);
+  context->CSSetShader((ID3D11ComputeShader *)CS.Shader, CS.Instances, CS.NumInstances);
+
+  // PS
+  context->PSSetShaderResources(0, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, PS.SRVs);
+  context->PSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, PS.Samplers);
+  context->PSSetShader((ID3D11PixelShader *)PS.Shader, PS.Instances, PS.NumInstances);
+
+  context->VSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 VS.ConstantBuffers, VS.CBOffsets, VS.CBCounts);
+  context->DSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 DS.ConstantBuffers, DS.CBOffsets, DS.CBCounts);
+  context->HSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 HS.ConstantBuffers, HS.CBOffsets, HS.CBCounts);
+  context->GSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 GS.ConstantBuffers, GS.CBOffsets, GS.CBCounts);
+  context->CSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 CS.ConstantBuffers, CS.CBOffsets, CS.CBCounts);
+  context->PSSetConstantBuffers1(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT,
+                                 PS.ConstantBuffers, PS.CBOffsets, PS.CBCounts);
+
+  // OM
+  context->OMSetBlendState(OM.BlendState, OM.BlendFactor, OM.SampleMask);
+  context->OMSetDepthStencilState(OM.DepthStencilState, OM.StencRef);
+
+  // now restore the write binds
+  context->SOSetTargets(D3D11_SO_BUFFER_SLOT_COUNT, SO.Buffers, SO.Offsets);
+  context->CSSetUnorderedAccessViews(0, UAVCount, CSUAVs, UAV_keepcounts);
+  context->OMSetRenderTargetsAndUnorderedAccessViews(OM.UAVStartSlot, OM.RenderTargets,
+                                                     OM.DepthView, OM.UAVStartSlot,
+                                                     UAVCount - OM.UAVStartSlot, OM.UAVs,
+                                                     UAV_keepcounts);
+}
+
 void D3D11RenderState::TakeRef(ID3D11DeviceChild *p)
 {
   if(p)
@@ -1706,7 +1842,7 @@ D3D11RenderStateTracker::D3D11RenderStateTracker(WrappedID3D11DeviceContext *ctx
 
 D3D11RenderStateTracker::~D3D11RenderStateTracker()
 {
-  m_RS.ApplyState(m_pContext);
+  m_RS.ApplyChangedState(m_pContext);
 }
 
 D3D11RenderState::ResourceRange D3D11RenderState::ResourceRange::Null =
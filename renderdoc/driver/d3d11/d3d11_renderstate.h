@@ -44,6 +44,9 @@ struct D3D11RenderState
   D3D11RenderState &operator=(const D3D11RenderState &other);
 
   void ApplyState(WrappedID3D11DeviceContext *context);
+  // restores this state, only re-binding state that is different to what's currently bound on the
+  // context. Used to restore after replay-side operations that change a few bindings.
+  void ApplyChangedState(WrappedID3D11DeviceContext *context);
   void Clear();
 
   ///////////////////////////////////////////////////////////////////////////////
@@ -406,7 +409,7 @@ struct D3D11RenderState
     stateItem = newItem;
 
     // if the item is bound for writing anywhere, we instead bind NULL
-    if(IsBoundForWrite(newItem))
+    if(m_TrackHazards && IsBoundForWrite(newItem))
     {
       // RDCDEBUG("Resource was bound for write, forcing to NULL");
       stateItem = NULL;
@@ -447,7 +450,7 @@ struct D3D11RenderState
     stateItem = NULL;
 
     // if we're not binding NULL, then unbind any other conflicting uses
-    if(newItem)
+    if(newItem && m_TrackHazards)
     {
       UnbindForRead(newItem);
       // when binding something for write, all other write slots are NULL'd too
@@ -569,6 +572,16 @@ struct D3D11RenderState
     m_pDevice = device;
   }
   void SetDevice(WrappedID3D11Device *device) { m_pDevice = device; }
+
+  // by default binds emulate D3D resolving read/write hazards, so the state matches what is really
+  // bound. With that disabled bindings are just recorded as set, so they can include views that
+  // D3D has unbound, but every view D3D still has bound is here and referenced. That's enough to
+  // keep the wrappers alive and fetch the real state when a capture starts, for much less work.
+  void SetHazardTracking(bool track) { m_TrackHazards = track; }
+  bool IsTrackingHazards() const { return m_TrackHazards; }
+  // replace all bindings with other's, keeping this state's kind of references
+  void SyncBindings(const D3D11RenderState &other);
+
   void MarkReferenced(WrappedID3D11DeviceContext *ctx, bool initial) const;
   void MarkDirty(WrappedID3D11DeviceContext *ctx) const;
 
@@ -579,6 +592,7 @@ private:
   Serialiser *GetSerialiser() { return m_pSerialiser; }
   Serialiser *m_pSerialiser;
   bool m_ImmediatePipeline;
+  bool m_TrackHazards;
   WrappedID3D11Device *m_pDevice;
 };
 
@@ -38,6 +38,11 @@ D3D11Replay::D3D11Replay()
   m_pDevice = NULL;
   m_Proxy = false;
   m_WARP = false;
+
+  m_CheckpointInterval = 0;
+  m_CheckpointBudget = 0;
+  m_CheckpointSize = 0;
+  m_CheckpointLimit = 0;
 }
 
 void D3D11Replay::Shutdown()
@@ -46,6 +51,8 @@ void D3D11Replay::Shutdown()
     m_ProxyResources[i]->Release();
   m_ProxyResources.clear();
 
+  FreeCheckpoints();
+
   m_pDevice->Release();
 
   D3D11DebugManager::PostDeviceShutdownCounters();
@@ -1305,11 +1312,358 @@ D3D11PipelineState D3D11Replay::MakePipelineState()
 void D3D11Replay::ReadLogInitialisation()
 {
   m_pDevice->ReadLogInitialisation();
+
+  m_CheckpointInterval = 1000;
+  m_CheckpointBudget = 256 * 1024 * 1024;
+
+  const string &interval = RenderDoc::Inst().GetConfigSetting("d3d11.replay.checkpointInterval");
+  if(!interval.empty())
+    m_CheckpointInterval = (uint32_t)atoi(interval.c_str());
+
+  const string &budget = RenderDoc::Inst().GetConfigSetting("d3d11.replay.checkpointBudgetMB");
+  if(!budget.empty())
+    m_CheckpointBudget = uint64_t(atoi(budget.c_str())) * 1024 * 1024;
+
+  // a UAV's hidden counter can't be read back to be saved
+  m_CheckpointLimit = m_pDevice->GetImmediateContext()->GetFirstUAVCounterEvent();
 }
 
 void D3D11Replay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
 {
-  m_pDevice->ReplayLog(0, endEventID, replayType);
+  if(replayType != eReplay_WithoutDraw || m_CheckpointInterval == 0)
+  {
+    m_pDevice->ReplayLog(0, endEventID, replayType);
+    return;
+  }
+
+  uint32_t startEventID = 0;
+
+  // pick up from the latest checkpoint that isn't past the target
+  auto it = m_Checkpoints.upper_bound(endEventID);
+  if(it != m_Checkpoints.begin())
+  {
+    --it;
+    RestoreCheckpoint(it->second);
+    startEventID = it->first;
+  }
+
+  // replay forward, leaving checkpoints at each interval on the way
+  uint32_t limit = RDCMIN(endEventID, m_CheckpointLimit);
+
+  while(m_CheckpointSize < m_CheckpointBudget)
+  {
+    uint32_t next = (startEventID / m_CheckpointInterval + 1) * m_CheckpointInterval;
+
+    // we can always replay between drawcalls, so only stop at one
+    while(next < limit && m_pDevice->GetDrawcall(next) == NULL)
+      next++;
+
+    if(next >= limit)
+      break;
+
+    m_pDevice->ReplayLog(startEventID, next, eReplay_WithoutDraw);
+    startEventID = next;
+
+    if(m_Checkpoints.find(next) == m_Checkpoints.end() && !CreateCheckpoint(next))
+      break;
+  }
+
+  m_pDevice->ReplayLog(startEventID, endEventID, eReplay_WithoutDraw);
+}
+
+// a copy that the contents of res can be saved to, and restored from. Returns NULL for resources
+// that are never written, or can't be saved.
+static ID3D11Resource *CreateCheckpointCopy(ID3D11Device *device, ID3D11Resource *res,
+                                            bool &dynamic, uint64_t &size)
+{
+  const UINT sharedFlags = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX |
+                           D3D11_RESOURCE_MISC_GDI_COMPATIBLE | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
+
+  D3D11_RESOURCE_DIMENSION dim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+  res->GetType(&dim);
+
+  HRESULT hr = S_OK;
+  ID3D11Resource *ret = NULL;
+
+  dynamic = false;
+  size = 0;
+
+  if(dim == D3D11_RESOURCE_DIMENSION_BUFFER)
+  {
+    D3D11_BUFFER_DESC desc;
+    ((ID3D11Buffer *)res)->GetDesc(&desc);
+    desc.MiscFlags &= ~sharedFlags;
+
+    size = desc.ByteWidth;
+
+    if(desc.Usage == D3D11_USAGE_DYNAMIC)
+    {
+      dynamic = true;
+
+      desc.Usage = D3D11_USAGE_STAGING;
+      desc.BindFlags = 0;
+      desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+      desc.MiscFlags = 0;
+      desc.StructureByteStride = 0;
+    }
+
+    hr = device->CreateBuffer(&desc, NULL, (ID3D11Buffer **)&ret);
+  }
+  else if(dim == D3D11_RESOURCE_DIMENSION_TEXTURE1D)
+  {
+    D3D11_TEXTURE1D_DESC desc;
+    ((ID3D11Texture1D *)res)->GetDesc(&desc);
+    desc.MiscFlags &= ~sharedFlags;
+
+    if(desc.Usage == D3D11_USAGE_DYNAMIC)
+      return NULL;
+
+    for(UINT i = 0; i < desc.MipLevels * desc.ArraySize; i++)
+      size += GetByteSize((ID3D11Texture1D *)res, i);
+
+    hr = device->CreateTexture1D(&desc, NULL, (ID3D11Texture1D **)&ret);
+  }
+  else if(dim == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+  {
+    D3D11_TEXTURE2D_DESC desc;
+    ((ID3D11Texture2D *)res)->GetDesc(&desc);
+    desc.MiscFlags &= ~sharedFlags;
+
+    if(desc.Usage == D3D11_USAGE_DYNAMIC)
+      return NULL;
+
+    for(UINT i = 0; i < desc.MipLevels * desc.ArraySize; i++)
+      size += GetByteSize((ID3D11Texture2D *)res, i) * desc.SampleDesc.Count;
+
+    hr = device->CreateTexture2D(&desc, NULL, (ID3D11Texture2D **)&ret);
+  }
+  else if(dim == D3D11_RESOURCE_DIMENSION_TEXTURE3D)
+  {
+    D3D11_TEXTURE3D_DESC desc;
+    ((ID3D11Texture3D *)res)->GetDesc(&desc);
+    desc.MiscFlags &= ~sharedFlags;
+
+    if(desc.Usage == D3D11_USAGE_DYNAMIC)
+      return NULL;
+
+    for(UINT i = 0; i < desc.MipLevels; i++)
+      size += GetByteSize((ID3D11Texture3D *)res, i);
+
+    hr = device->CreateTexture3D(&desc, NULL, (ID3D11Texture3D **)&ret);
+  }
+
+  if(FAILED(hr) || ret == NULL)
+  {
+    RDCWARN("Failed to create replay checkpoint copy %08x", hr);
+    return NULL;
+  }
+
+  return ret;
+}
+
+static ID3D11Resource *GetCheckpointResource(ResourceId id)
+{
+  {
+    auto it = WrappedID3D11Buffer::m_BufferList.find(id);
+    if(it != WrappedID3D11Buffer::m_BufferList.end())
+      return UNWRAP(WrappedID3D11Buffer, it->second.m_Buffer);
+  }
+
+  {
+    auto it = WrappedID3D11Texture1D::m_TextureList.find(id);
+    if(it != WrappedID3D11Texture1D::m_TextureList.end())
+      return UNWRAP(WrappedID3D11Texture1D, it->second.m_Texture);
+  }
+
+  {
+    auto it = WrappedID3D11Texture2D1::m_TextureList.find(id);
+    if(it != WrappedID3D11Texture2D1::m_TextureList.end())
+      return UNWRAP(WrappedID3D11Texture2D1, it->second.m_Texture);
+  }
+
+  {
+    auto it = WrappedID3D11Texture3D1::m_TextureList.find(id);
+    if(it != WrappedID3D11Texture3D1::m_TextureList.end())
+      return UNWRAP(WrappedID3D11Texture3D1, it->second.m_Texture);
+  }
+
+  return NULL;
+}
+
+static bool IsWriteUsage(ResourceUsage usage)
+{
+  return usage == eUsage_SO || (usage >= eUsage_VS_RWResource && usage <= eUsage_All_RWResource) ||
+         usage == eUsage_ColourTarget || usage == eUsage_DepthStencilTarget ||
+         usage == eUsage_Clear || usage == eUsage_GenMips || usage == eUsage_Resolve ||
+         usage == eUsage_ResolveDst || usage == eUsage_Copy || usage == eUsage_CopyDst;
+}
+
+bool D3D11Replay::CreateCheckpoint(uint32_t eventID)
+{
+  WrappedID3D11DeviceContext *context = m_pDevice->GetImmediateContext();
+
+  // try again at the next interval
+  if(!context->CanResumeReplay())
+    return true;
+
+  // everything that could have been written before this event needs to be saved
+  set<ResourceId> written;
+
+  const map<ResourceId, vector<EventUsage> > &usage = context->GetAllUsage();
+  for(auto it = usage.begin(); it != usage.end(); ++it)
+  {
+    for(size_t i = 0; i < it->second.size(); i++)
+    {
+      if(it->second[i].eventID < eventID && IsWriteUsage(it->second[i].usage))
+      {
+        written.insert(it->first);
+        break;
+      }
+    }
+  }
+
+  const map<ResourceId, uint32_t> &cpuWrites = context->GetCPUWrites();
+  for(auto it = cpuWrites.begin(); it != cpuWrites.end(); ++it)
+    if(it->second < eventID)
+      written.insert(it->first);
+
+  ReplayCheckpoint *checkpoint = new ReplayCheckpoint;
+  checkpoint->eventID = eventID;
+  checkpoint->state = NULL;
+  checkpoint->size = 0;
+
+  ID3D11DeviceContext *ctx = context->GetReal();
+
+  bool success = true;
+
+  for(auto it = written.begin(); it != written.end(); ++it)
+  {
+    ID3D11Resource *live = GetCheckpointResource(*it);
+
+    if(live == NULL)
+      continue;
+
+    ReplayCheckpoint::Contents contents;
+    contents.live = live;
+
+    uint64_t size = 0;
+    contents.copy = CreateCheckpointCopy(m_pDevice->GetReal(), live, contents.dynamic, size);
+
+    if(contents.copy == NULL || m_CheckpointSize + checkpoint->size + size > m_CheckpointBudget)
+    {
+      SAFE_RELEASE(contents.copy);
+      success = false;
+      break;
+    }
+
+    ctx->CopyResource(contents.copy, live);
+
+    contents.live->AddRef();
+    checkpoint->contents.push_back(contents);
+    checkpoint->size += size;
+  }
+
+  if(!success)
+  {
+    for(size_t i = 0; i < checkpoint->contents.size(); i++)
+    {
+      SAFE_RELEASE(checkpoint->contents[i].live);
+      SAFE_RELEASE(checkpoint->contents[i].copy);
+    }
+    delete checkpoint;
+
+    // anything later would need at least as much saving, so stop trying
+    m_CheckpointLimit = RDCMIN(m_CheckpointLimit, eventID);
+    return false;
+  }
+
+  checkpoint->state = new D3D11RenderState(*context->GetCurrentPipelineState());
+
+  m_Checkpoints[eventID] = checkpoint;
+  m_CheckpointSize += checkpoint->size;
+
+  RDCDEBUG("Created replay checkpoint at %u with %u resources (%llu bytes)", eventID,
+           (uint32_t)checkpoint->contents.size(), checkpoint->size);
+
+  return true;
+}
+
+void D3D11Replay::RestoreCheckpoint(ReplayCheckpoint *checkpoint)
+{
+  WrappedID3D11DeviceContext *context = m_pDevice->GetImmediateContext();
+
+  // resources written after the checkpoint by an earlier replay go back to their initial contents,
+  // then everything written before the checkpoint is restored on top.
+  {
+    D3D11MarkerRegion apply("ApplyInitialContents");
+    m_pDevice->GetResourceManager()->ApplyInitialContents();
+    m_pDevice->GetResourceManager()->ReleaseInFrameResources();
+  }
+
+  D3D11MarkerRegion restore(StringFormat::Fmt("Restore checkpoint %u", checkpoint->eventID));
+
+  ID3D11DeviceContext *ctx = context->GetReal();
+
+  for(size_t i = 0; i < checkpoint->contents.size(); i++)
+  {
+    const ReplayCheckpoint::Contents &contents = checkpoint->contents[i];
+
+    if(contents.dynamic)
+    {
+      D3D11_MAPPED_SUBRESOURCE src = {}, dst = {};
+
+      HRESULT hr = ctx->Map(contents.copy, 0, D3D11_MAP_READ, 0, &src);
+
+      if(SUCCEEDED(hr))
+      {
+        hr = ctx->Map(contents.live, 0, D3D11_MAP_WRITE_DISCARD, 0, &dst);
+
+        if(SUCCEEDED(hr))
+        {
+          D3D11_BUFFER_DESC desc;
+          ((ID3D11Buffer *)contents.copy)->GetDesc(&desc);
+
+          memcpy(dst.pData, src.pData, desc.ByteWidth);
+
+          ctx->Unmap(contents.live, 0);
+        }
+
+        ctx->Unmap(contents.copy, 0);
+      }
+
+      if(FAILED(hr))
+        RDCERR("Failed to restore dynamic buffer from replay checkpoint %08x", hr);
+    }
+    else
+    {
+      ctx->CopyResource(contents.live, contents.copy);
+    }
+  }
+
+  checkpoint->state->ApplyState(context);
+}
+
+void D3D11Replay::FreeCheckpoints()
+{
+  for(auto it = m_Checkpoints.begin(); it != m_Checkpoints.end(); ++it)
+  {
+    ReplayCheckpoint *checkpoint = it->second;
+
+    for(size_t i = 0; i < checkpoint->contents.size(); i++)
+    {
+      SAFE_RELEASE(checkpoint->contents[i].live);
+      SAFE_RELEASE(checkpoint->contents[i].copy);
+    }
+
+    SAFE_DELETE(checkpoint->state);
+    delete checkpoint;
+  }
+
+  m_Checkpoints.clear();
+  m_CheckpointSize = 0;
+
+  if(m_pDevice)
+    m_CheckpointLimit = m_pDevice->GetImmediateContext()->GetFirstUAVCounterEvent();
 }
 
 vector<uint32_t> D3D11Replay::GetPassEvents(uint32_t eventID)
@@ -1390,6 +1744,21 @@ void D3D11Replay::FlipOutputWindow(uint64_t id)
   m_pDevice->GetDebugManager()->FlipOutputWindow(id);
 }
 
+vector<ReplayMemoryStats> D3D11Replay::GetMemoryStats()
+{
+  ReplayMemoryStats stats = {};
+  stats.category = eReplayMemory_PostVSCache;
+  stats.gpuBytes = m_pDevice->GetDebugManager()->GetPostVSCacheSize();
+
+  return vector<ReplayMemoryStats>(1, stats);
+}
+
+void D3D11Replay::TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
+{
+  if(category == eReplayMemory_PostVSCache)
+    m_pDevice->GetDebugManager()->TrimPostVSCache(budget, eventID);
+}
+
 void D3D11Replay::InitPostVSBuffers(uint32_t eventID)
 {
   m_pDevice->GetDebugManager()->InitPostVSBuffers(eventID);
@@ -1437,6 +1806,34 @@ bool D3D11Replay::GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mi
                                                     maxval, channels, histogram);
 }
 
+bool D3D11Replay::SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                      uint32_t sample, const ValueSearchParams &params,
+                                      vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  return m_pDevice->GetDebugManager()->SearchTextureValues(texid, sliceFace, mip, sample, params,
+                                                           matches, numMatches);
+}
+
+bool D3D11Replay::SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                     uint32_t numElems, const ValueSearchParams &params,
+                                     vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  return m_pDevice->GetDebugManager()->SearchBufferValues(buff, offset, stride, numElems, params,
+                                                          matches, numMatches);
+}
+
+bool D3D11Replay::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                      uint32_t mip, uint32_t sample, FormatComponentType typeHint)
+{
+  return m_pDevice->GetDebugManager()->SetTextureDiffInput(input, texid, sliceFace, mip, sample,
+                                                           typeHint);
+}
+
+bool D3D11Replay::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  return m_pDevice->GetDebugManager()->DiffTextureInputs(threshold, result);
+}
+
 MeshFormat D3D11Replay::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
 {
   return m_pDevice->GetDebugManager()->GetPostVSBuffers(eventID, instID, stage);
@@ -1447,6 +1844,12 @@ void D3D11Replay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+void D3D11Replay::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                 vector<vector<byte> > &retData)
+{
+  m_pDevice->GetDebugManager()->GetBuffersData(ranges, retData);
+}
+
 byte *D3D11Replay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                   const GetTextureDataParams &params, size_t &dataSize)
 {
@@ -1455,11 +1858,16 @@ byte *D3D11Replay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mi
 
 void D3D11Replay::ReplaceResource(ResourceId from, ResourceId to)
 {
+  // anything after the first use of the replaced resource could now be different
+  FreeCheckpoints();
+
   m_pDevice->GetResourceManager()->ReplaceResource(from, to);
 }
 
 void D3D11Replay::RemoveReplacement(ResourceId id)
 {
+  FreeCheckpoints();
+
   m_pDevice->GetResourceManager()->RemoveReplacement(id);
 }
 
@@ -1484,6 +1892,13 @@ void D3D11Replay::RenderMesh(uint32_t eventID, const vector<MeshFormat> &seconda
   return m_pDevice->GetDebugManager()->RenderMesh(eventID, secondaryDraws, cfg);
 }
 
+void D3D11Replay::PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  m_pDevice->GetDebugManager()->PrecompileShader(source, entry, D3DCOMPILE_DEBUG | compileFlags,
+                                                 type);
+}
+
 void D3D11Replay::BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                                     ShaderStageType type, ResourceId *id, string *errors)
 {
@@ -1491,6 +1906,12 @@ void D3D11Replay::BuildTargetShader(string source, string entry, const uint32_t
                                             id, errors);
 }
 
+void D3D11Replay::PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  m_pDevice->GetDebugManager()->PrecompileShader(source, entry, compileFlags, type);
+}
+
 void D3D11Replay::BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                                     ShaderStageType type, ResourceId *id, string *errors)
 {
@@ -1903,7 +2324,8 @@ ResourceId D3D11Replay::CreateProxyBuffer(const FetchBuffer &templateBuf)
   return ret;
 }
 
-void D3D11Replay::SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+void D3D11Replay::SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data,
+                                     size_t dataSize)
 {
   if(bufid == ResourceId())
     return;
@@ -1918,13 +2340,21 @@ void D3D11Replay::SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSi
     D3D11_BUFFER_DESC desc;
     buf->GetDesc(&desc);
 
-    if(AlignUp16(dataSize) < desc.ByteWidth)
+    if(offset == 0 && AlignUp16(dataSize) >= desc.ByteWidth)
     {
-      RDCERR("Insufficient data provided to SetProxyBufferData");
+      ctx->UpdateSubresource(buf->GetReal(), 0, NULL, data, (UINT)dataSize, (UINT)dataSize);
       return;
     }
 
-    ctx->UpdateSubresource(buf->GetReal(), 0, NULL, data, (UINT)dataSize, (UINT)dataSize);
+    if(offset + dataSize > desc.ByteWidth)
+    {
+      RDCERR("Range provided to SetProxyBufferData is outside the buffer");
+      return;
+    }
+
+    D3D11_BOX box = {(UINT)offset, 0, 0, (UINT)(offset + dataSize), 1, 1};
+
+    ctx->UpdateSubresource(buf->GetReal(), 0, &box, data, (UINT)dataSize, (UINT)dataSize);
   }
   else
   {
@@ -2027,6 +2457,10 @@ ReplayCreateStatus D3D11_CreateReplayDevice(const char *logfile, IReplayDriver *
   D3D_DRIVER_TYPE driverType = initParams.DriverType;
   UINT flags = initParams.Flags;
 
+  // initial contents are created on worker threads during load, so the replay device must be
+  // free-threaded regardless of how the application created its device.
+  flags &= ~D3D11_CREATE_DEVICE_SINGLETHREADED;
+
   HRESULT hr = E_FAIL;
 
   D3D_FEATURE_LEVEL maxFeatureLevel = D3D_FEATURE_LEVEL_9_1;
@@ -2123,3 +2557,27 @@ ReplayCreateStatus D3D11_CreateReplayDevice(const char *logfile, IReplayDriver *
 }
 
 static DriverRegistration D3D11DriverRegistration(RDC_D3D11, "D3D11", &D3D11_CreateReplayDevice);
+
+static string D3D11_ReadMarkerName(Serialiser *ser)
+{
+  uint32_t colour = 0;
+  ser->Serialise("colour", colour);
+
+  string name;
+  ser->SerialiseInternedString("Name", name);
+  return name;
+}
+
+static CaptureChunkInfo D3D11_CaptureChunkInfo()
+{
+  CaptureChunkInfo info;
+  info.chunkName = &WrappedID3D11Device::GetChunkName;
+  info.readMarkerName = &D3D11_ReadMarkerName;
+  info.captureScope = CAPTURE_SCOPE;
+  info.pushMarker = PUSH_EVENT;
+  info.popMarker = POP_EVENT;
+  info.setMarker = SET_MARKER;
+  return info;
+}
+
+static DriverRegistration D3D11ChunkInfoRegistration(RDC_D3D11, D3D11_CaptureChunkInfo());
@@ -31,6 +31,7 @@
 #include "d3d11_common.h"
 
 class WrappedID3D11Device;
+struct D3D11RenderState;
 
 class D3D11Replay : public IReplayDriver
 {
@@ -102,13 +103,25 @@ public:
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches);
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches);
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
 
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   void ReplaceResource(ResourceId from, ResourceId to);
@@ -124,11 +137,21 @@ public:
   bool IsTextureSupported(const ResourceFormat &format);
 
   ResourceId CreateProxyBuffer(const FetchBuffer &templateBuf);
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize);
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize);
 
   void RenderMesh(uint32_t eventID, const vector<MeshFormat> &secondaryDraws, const MeshDisplay &cfg);
 
   bool RenderTexture(TextureDisplay cfg);
+  bool HasPendingTextureData() { return false; }
+  vector<ProxyCommandStats> GetProxyStats() { return vector<ProxyCommandStats>(); }
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total)
+  {
+    return false;
+  }
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total)
+  {
+    return false;
+  }
 
   void RenderCheckerboard(Vec3f light, Vec3f dark);
 
@@ -153,6 +176,8 @@ public:
                            TextureDisplayOverlay overlay, uint32_t eventID,
                            const vector<uint32_t> &passEvents);
 
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, uint32_t mip, uint32_t arrayIdx,
@@ -161,6 +186,9 @@ public:
   bool IsRenderOutput(ResourceId id);
 
   void FileChanged() {}
+  // only the post-VS cache is tracked on D3D11
+  vector<ReplayMemoryStats> GetMemoryStats();
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID);
   void InitCallstackResolver();
   bool HasCallstacks();
   Callstack::StackResolver *GetCallstackResolver();
@@ -176,4 +204,40 @@ private:
   WrappedID3D11Device *m_pDevice;
 
   D3D11PipelineState m_CurPipelineState;
+
+  // snapshots of the frame partway through, so that seeking to a late event only replays from the
+  // nearest earlier checkpoint and not from the start of the frame. A checkpoint at an event has
+  // the state and contents from just before that event.
+  struct ReplayCheckpoint
+  {
+    struct Contents
+    {
+      ID3D11Resource *live;
+      ID3D11Resource *copy;
+      // dynamic buffers can't be copied to, so are saved to a staging buffer and written back with
+      // a map instead.
+      bool dynamic;
+    };
+
+    uint32_t eventID;
+    D3D11RenderState *state;
+    vector<Contents> contents;
+    uint64_t size;
+  };
+
+  bool CreateCheckpoint(uint32_t eventID);
+  void RestoreCheckpoint(ReplayCheckpoint *checkpoint);
+  void FreeCheckpoints();
+
+  map<uint32_t, ReplayCheckpoint *> m_Checkpoints;
+
+  // a checkpoint is attempted on the first drawcall after every interval events, while the total
+  // size of the checkpoints' contents fits the budget.
+  uint32_t m_CheckpointInterval;
+  uint64_t m_CheckpointBudget;
+  uint64_t m_CheckpointSize;
+
+  // no checkpoints can be taken at or after this event, e.g. when something written before it
+  // can't be saved.
+  uint32_t m_CheckpointLimit;
 };
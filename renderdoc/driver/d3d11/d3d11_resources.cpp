@@ -64,6 +64,7 @@ map<ResourceId, WrappedID3D11Texture3D1::TextureEntry>
     WrappedTexture<ID3D11Texture3D, D3D11_TEXTURE3D_DESC, ID3D11Texture3D1>::m_TextureList;
 map<ResourceId, WrappedID3D11Buffer::BufferEntry> WrappedID3D11Buffer::m_BufferList;
 map<ResourceId, WrappedShader::ShaderEntry *> WrappedShader::m_ShaderList;
+map<WrappedShader::DXBCKey, WrappedShader::ShaderEntry *> WrappedShader::ShaderEntry::m_Shaders;
 Threading::CriticalSection WrappedShader::m_ShaderListLock;
 std::vector<WrappedID3DDeviceContextState *> WrappedID3DDeviceContextState::m_List;
 Threading::CriticalSection WrappedID3DDeviceContextState::m_Lock;
@@ -892,16 +892,41 @@ public:
 class WrappedShader
 {
 public:
+  struct DXBCKey
+  {
+    DXBCKey(const byte *code, size_t codeLen)
+    {
+      byteLen = (uint32_t)codeLen;
+      DXBC::DXBCFile::GetHash(hash, code, codeLen);
+    }
+
+    // assume that byte length + hash is enough to uniquely identify a shader bytecode
+    uint32_t byteLen;
+    uint32_t hash[4];
+
+    bool operator<(const DXBCKey &o) const
+    {
+      if(byteLen != o.byteLen)
+        return byteLen < o.byteLen;
+
+      for(size_t i = 0; i < 4; i++)
+        if(hash[i] != o.hash[i])
+          return hash[i] < o.hash[i];
+
+      return false;
+    }
+  };
+
   class ShaderEntry
   {
   public:
-    ShaderEntry() : m_DebugInfoSearchPaths(NULL), m_DXBCFile(NULL), m_Details(NULL) {}
-    ShaderEntry(const byte *code, size_t codeLen)
+    ShaderEntry(const DXBCKey &key, const byte *code, size_t codeLen) : m_Key(key)
     {
       m_Bytecode.assign(code, code + codeLen);
       m_DebugInfoSearchPaths = NULL;
       m_DXBCFile = NULL;
       m_Details = NULL;
+      m_RefCount = 1;
     }
     ~ShaderEntry()
     {
@@ -910,6 +935,34 @@ public:
       SAFE_DELETE(m_Details);
     }
 
+    // shaders with identical bytecode share one entry, so the DXBC is only parsed and the
+    // reflection only built once no matter how many times the application created it.
+    static ShaderEntry *AddShader(const byte *code, size_t codeLen)
+    {
+      DXBCKey key(code, codeLen);
+      ShaderEntry *shader = m_Shaders[key];
+
+      if(shader == NULL)
+        shader = m_Shaders[key] = new ShaderEntry(key, code, codeLen);
+      else
+        shader->m_RefCount++;
+
+      return shader;
+    }
+
+    static void ReleaseShader(ShaderEntry *shader)
+    {
+      if(shader == NULL)
+        return;
+
+      shader->m_RefCount--;
+      if(shader->m_RefCount == 0)
+      {
+        m_Shaders.erase(shader->m_Key);
+        delete shader;
+      }
+    }
+
     void SetDebugInfoPath(vector<std::string> *searchPaths, const std::string &path)
     {
       m_DebugInfoSearchPaths = searchPaths;
@@ -937,6 +990,9 @@ public:
     void TryReplaceOriginalByteCode();
     ShaderEntry &operator=(const ShaderEntry &e);
 
+    DXBCKey m_Key;
+    uint32_t m_RefCount;
+
     std::string m_DebugInfoPath;
     vector<std::string> *m_DebugInfoSearchPaths;
 
@@ -944,6 +1000,8 @@ public:
 
     DXBC::DXBCFile *m_DXBCFile;
     ShaderReflection *m_Details;
+
+    static map<DXBCKey, ShaderEntry *> m_Shaders;
   };
 
   static map<ResourceId, ShaderEntry *> m_ShaderList;
@@ -954,7 +1012,7 @@ public:
     SCOPED_LOCK(m_ShaderListLock);
 
     RDCASSERT(m_ShaderList.find(m_ID) == m_ShaderList.end());
-    m_ShaderList[m_ID] = new ShaderEntry(code, codeLen);
+    m_ShaderList[m_ID] = ShaderEntry::AddShader(code, codeLen);
   }
   virtual ~WrappedShader()
   {
@@ -963,7 +1021,7 @@ public:
     auto it = m_ShaderList.find(m_ID);
     if(it != m_ShaderList.end())
     {
-      delete it->second;
+      ShaderEntry::ReleaseShader(it->second);
       m_ShaderList.erase(it);
     }
   }
@@ -1275,11 +1333,7 @@ public:
   WrappedID3D11DeviceContext *GetContext() { return m_pContext; }
   bool IsCaptured() { return m_Successful; }
   void SetDirtyResources(set<ResourceId> &dirty) { m_Dirty.swap(dirty); }
-  void MarkDirtyResources(D3D11ResourceManager *manager)
-  {
-    for(auto it = m_Dirty.begin(); it != m_Dirty.end(); ++it)
-      manager->MarkDirtyResource(*it);
-  }
+  void MarkDirtyResources(D3D11ResourceManager *manager) { manager->MarkDirtyResources(m_Dirty); }
   void MarkDirtyResources(set<ResourceId> &missingTracks)
   {
     for(auto it = m_Dirty.begin(); it != m_Dirty.end(); ++it)
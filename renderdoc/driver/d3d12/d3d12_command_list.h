@@ -94,6 +94,10 @@ class WrappedID3D12GraphicsCommandList : public RefCounter12<ID3D12GraphicsComma
   ResourceId m_ResourceID;
   D3D12ResourceRecord *m_ListRecord;
 
+  // chunks recorded into this list are allocated from its own arena, so lists being recorded on
+  // different threads never share an allocation lock
+  ChunkArena *m_ChunkArena;
+
   Serialiser *m_pSerialiser;
   LogState &m_State;
 
@@ -108,6 +112,14 @@ class WrappedID3D12GraphicsCommandList : public RefCounter12<ID3D12GraphicsComma
 
   const char *GetChunkName(uint32_t idx) { return m_pDevice->GetChunkName(idx); }
   D3D12ResourceManager *GetResourceManager() { return m_pDevice->GetResourceManager(); }
+  // the most draws and dispatches timed in one recording of a list, any after are untimed
+  static const uint32_t MaxEventTimings = 1024;
+
+  void BeginEventTimings();
+  void BeginEventTiming();
+  void EndEventTiming();
+  void ResolveEventTimings();
+
 public:
   static const int AllocPoolCount = 8192;
   static const int AllocMaxByteSize = 2 * 1024 * 1024;
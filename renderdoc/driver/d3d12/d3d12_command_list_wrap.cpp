@@ -43,10 +43,9 @@ bool WrappedID3D12GraphicsCommandList::Serialise_Close()
 
   if(m_State >= WRITING)
   {
-    D3D12ResourceRecord *record = GetResourceManager()->GetResourceRecord(CommandList);
-    RDCASSERT(record->bakedCommands);
-    if(record->bakedCommands)
-      bakedCmdId = record->bakedCommands->GetResourceID();
+    RDCASSERT(m_ListRecord->bakedCommands);
+    if(m_ListRecord->bakedCommands)
+      bakedCmdId = m_ListRecord->bakedCommands->GetResourceID();
   }
 
   SERIALISE_ELEMENT(ResourceId, bakeId, bakedCmdId);
@@ -118,9 +117,11 @@ HRESULT WrappedID3D12GraphicsCommandList::Close()
       SCOPED_SERIALISE_CONTEXT(CLOSE_LIST);
       Serialise_Close();
 
-      m_ListRecord->AddChunk(scope.Get());
+      m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     }
 
+    ResolveEventTimings();
+
     m_ListRecord->Bake();
   }
 
@@ -143,10 +144,9 @@ bool WrappedID3D12GraphicsCommandList::Serialise_Reset(ID3D12CommandAllocator *p
 
   if(m_State >= WRITING)
   {
-    D3D12ResourceRecord *record = GetResourceManager()->GetResourceRecord(CommandList);
-    RDCASSERT(record->bakedCommands);
-    if(record->bakedCommands)
-      bakedCmdId = record->bakedCommands->GetResourceID();
+    RDCASSERT(m_ListRecord->bakedCommands);
+    if(m_ListRecord->bakedCommands)
+      bakedCmdId = m_ListRecord->bakedCommands->GetResourceID();
   }
 
   SERIALISE_ELEMENT(ResourceId, bakeId, bakedCmdId);
@@ -275,6 +275,7 @@ bool WrappedID3D12GraphicsCommandList::Serialise_Reset(ID3D12CommandAllocator *p
       m_Cmd->m_BakedCmdListInfo[CommandList].curEventID = 0;
       m_Cmd->m_BakedCmdListInfo[CommandList].eventCount = 0;
       m_Cmd->m_BakedCmdListInfo[CommandList].drawCount = 0;
+      m_Cmd->m_BakedCmdListInfo[CommandList].chunkEventIDs.clear();
 
       m_Cmd->m_BakedCmdListInfo[CommandList].drawStack.push_back(draw);
 
@@ -319,7 +320,7 @@ HRESULT WrappedID3D12GraphicsCommandList::Reset(ID3D12CommandAllocator *pAllocat
       SCOPED_SERIALISE_CONTEXT(RESET_LIST);
       Serialise_Reset(pAllocator, pInitialState);
 
-      m_ListRecord->AddChunk(scope.Get());
+      m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     }
 
     // add allocator and initial state (if there is one) as frame refs. We can't add
@@ -330,13 +331,129 @@ HRESULT WrappedID3D12GraphicsCommandList::Reset(ID3D12CommandAllocator *pAllocat
     if(pInitialState)
       m_ListRecord->MarkResourceFrameReferenced(GetResID(pInitialState), eFrameRef_Read);
 
-    if(firstTime)
-      return S_OK;
+    // the list is created open, so the creation reset has nothing to do for real
+    HRESULT hr = S_OK;
+    if(!firstTime)
+      hr = m_pReal->Reset(Unwrap(pAllocator), Unwrap(pInitialState));
+
+    if(SUCCEEDED(hr))
+      BeginEventTimings();
+
+    return hr;
   }
 
   return m_pReal->Reset(Unwrap(pAllocator), Unwrap(pInitialState));
 }
 
+void WrappedID3D12GraphicsCommandList::BeginEventTimings()
+{
+  CmdListRecordingInfo *cmdInfo = m_ListRecord->cmdInfo;
+
+  cmdInfo->timingChunks.clear();
+  cmdInfo->timingActive = false;
+
+  // bundles' events only get IDs once they're executed, and copy lists can't always write
+  // timestamps, so only direct and compute lists are timed.
+  if(!RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings ||
+     (m_Init.type != D3D12_COMMAND_LIST_TYPE_DIRECT &&
+      m_Init.type != D3D12_COMMAND_LIST_TYPE_COMPUTE))
+    return;
+
+  if(cmdInfo->timingHeap == NULL)
+  {
+    D3D12_QUERY_HEAP_DESC heapDesc;
+    heapDesc.Count = MaxEventTimings * 2;
+    heapDesc.NodeMask = 1;
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+
+    HRESULT hr = m_pDevice->GetReal()->CreateQueryHeap(&heapDesc, __uuidof(ID3D12QueryHeap),
+                                                       (void **)&cmdInfo->timingHeap);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create event timing query heap %08x", hr);
+      cmdInfo->timingHeap = NULL;
+      return;
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps;
+    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC bufDesc;
+    bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufDesc.Alignment = 0;
+    bufDesc.Width = sizeof(uint64_t) * MaxEventTimings * 2;
+    bufDesc.Height = 1;
+    bufDesc.DepthOrArraySize = 1;
+    bufDesc.MipLevels = 1;
+    bufDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufDesc.SampleDesc.Count = 1;
+    bufDesc.SampleDesc.Quality = 0;
+    bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    hr = m_pDevice->GetReal()->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, NULL,
+        __uuidof(ID3D12Resource), (void **)&cmdInfo->timingResults);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create event timing readback buffer %08x", hr);
+      cmdInfo->timingResults = NULL;
+      SAFE_RELEASE(cmdInfo->timingHeap);
+      return;
+    }
+  }
+
+  cmdInfo->timingActive = true;
+}
+
+void WrappedID3D12GraphicsCommandList::BeginEventTiming()
+{
+  if(m_State < WRITING)
+    return;
+
+  CmdListRecordingInfo *cmdInfo = m_ListRecord->cmdInfo;
+  if(!cmdInfo->timingActive || cmdInfo->timingChunks.size() >= MaxEventTimings)
+    return;
+
+  // the event's chunk will be the next one added to the list's record
+  UINT idx = (UINT)cmdInfo->timingChunks.size();
+  cmdInfo->timingChunks.push_back((uint32_t)m_ListRecord->NumChunks());
+
+  m_pReal->EndQuery(cmdInfo->timingHeap, D3D12_QUERY_TYPE_TIMESTAMP, idx * 2);
+}
+
+void WrappedID3D12GraphicsCommandList::EndEventTiming()
+{
+  if(m_State < WRITING)
+    return;
+
+  CmdListRecordingInfo *cmdInfo = m_ListRecord->cmdInfo;
+  if(!cmdInfo->timingActive || cmdInfo->timingChunks.empty() ||
+     cmdInfo->timingChunks.back() != (uint32_t)m_ListRecord->NumChunks())
+    return;
+
+  UINT idx = (UINT)cmdInfo->timingChunks.size() - 1;
+
+  m_pReal->EndQuery(cmdInfo->timingHeap, D3D12_QUERY_TYPE_TIMESTAMP, idx * 2 + 1);
+}
+
+void WrappedID3D12GraphicsCommandList::ResolveEventTimings()
+{
+  CmdListRecordingInfo *cmdInfo = m_ListRecord->cmdInfo;
+  if(!cmdInfo->timingActive)
+    return;
+
+  cmdInfo->timingActive = false;
+
+  if(!cmdInfo->timingChunks.empty())
+    m_pReal->ResolveQueryData(cmdInfo->timingHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0,
+                              (UINT)cmdInfo->timingChunks.size() * 2, cmdInfo->timingResults, 0);
+}
+
 void WrappedID3D12GraphicsCommandList::ClearState(ID3D12PipelineState *pPipelineState)
 {
   m_pReal->ClearState(Unwrap(pPipelineState));
@@ -489,7 +606,7 @@ void WrappedID3D12GraphicsCommandList::ResourceBarrier(UINT NumBarriers,
     SCOPED_SERIALISE_CONTEXT(RESOURCE_BARRIER);
     Serialise_ResourceBarrier(NumBarriers, pBarriers);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_ListRecord->cmdInfo->barriers.insert(m_ListRecord->cmdInfo->barriers.end(), pBarriers,
                                            pBarriers + NumBarriers);
@@ -536,7 +653,7 @@ void WrappedID3D12GraphicsCommandList::IASetPrimitiveTopology(D3D12_PRIMITIVE_TO
     SCOPED_SERIALISE_CONTEXT(SET_TOPOLOGY);
     Serialise_IASetPrimitiveTopology(PrimitiveTopology);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -592,7 +709,7 @@ void WrappedID3D12GraphicsCommandList::RSSetViewports(UINT NumViewports,
     SCOPED_SERIALISE_CONTEXT(SET_VIEWPORTS);
     Serialise_RSSetViewports(NumViewports, pViewports);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -647,7 +764,7 @@ void WrappedID3D12GraphicsCommandList::RSSetScissorRects(UINT NumRects, const D3
     SCOPED_SERIALISE_CONTEXT(SET_SCISSORS);
     Serialise_RSSetScissorRects(NumRects, pRects);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -694,7 +811,7 @@ void WrappedID3D12GraphicsCommandList::OMSetBlendFactor(const FLOAT BlendFactor[
     SCOPED_SERIALISE_CONTEXT(SET_BLENDFACTOR);
     Serialise_OMSetBlendFactor(BlendFactor);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -735,7 +852,7 @@ void WrappedID3D12GraphicsCommandList::OMSetStencilRef(UINT StencilRef)
     SCOPED_SERIALISE_CONTEXT(SET_STENCIL);
     Serialise_OMSetStencilRef(StencilRef);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -808,7 +925,7 @@ void WrappedID3D12GraphicsCommandList::SetDescriptorHeaps(UINT NumDescriptorHeap
     SCOPED_SERIALISE_CONTEXT(SET_DESC_HEAPS);
     Serialise_SetDescriptorHeaps(NumDescriptorHeaps, ppDescriptorHeaps);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     for(UINT i = 0; i < NumDescriptorHeaps; i++)
       m_ListRecord->MarkResourceFrameReferenced(GetResID(ppDescriptorHeaps[i]), eFrameRef_Read);
   }
@@ -887,7 +1004,7 @@ void WrappedID3D12GraphicsCommandList::IASetIndexBuffer(const D3D12_INDEX_BUFFER
     SCOPED_SERIALISE_CONTEXT(SET_IBUFFER);
     Serialise_IASetIndexBuffer(pView);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     if(pView)
       m_ListRecord->MarkResourceFrameReferenced(
           WrappedID3D12Resource::GetResIDFromAddr(pView->BufferLocation), eFrameRef_Read);
@@ -960,7 +1077,7 @@ void WrappedID3D12GraphicsCommandList::IASetVertexBuffers(UINT StartSlot, UINT N
     SCOPED_SERIALISE_CONTEXT(SET_VBUFFERS);
     Serialise_IASetVertexBuffers(StartSlot, NumViews, pViews);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     for(UINT i = 0; i < NumViews; i++)
       m_ListRecord->MarkResourceFrameReferenced(
           WrappedID3D12Resource::GetResIDFromAddr(pViews[i].BufferLocation), eFrameRef_Read);
@@ -1038,7 +1155,7 @@ void WrappedID3D12GraphicsCommandList::SOSetTargets(UINT StartSlot, UINT NumView
     SCOPED_SERIALISE_CONTEXT(SET_SOTARGETS);
     Serialise_SOSetTargets(StartSlot, NumViews, pViews);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     for(UINT i = 0; i < NumViews; i++)
       m_ListRecord->MarkResourceFrameReferenced(
           WrappedID3D12Resource::GetResIDFromAddr(pViews[i].BufferLocation), eFrameRef_Read);
@@ -1084,7 +1201,7 @@ void WrappedID3D12GraphicsCommandList::SetPipelineState(ID3D12PipelineState *pPi
     SCOPED_SERIALISE_CONTEXT(SET_PIPE);
     Serialise_SetPipelineState(pPipelineState);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pPipelineState), eFrameRef_Read);
   }
 }
@@ -1202,7 +1319,7 @@ void WrappedID3D12GraphicsCommandList::OMSetRenderTargets(
     Serialise_OMSetRenderTargets(num, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange,
                                  pDepthStencilDescriptor);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     for(UINT i = 0; i < numHandles; i++)
     {
       D3D12Descriptor *desc = GetWrapped(pRenderTargetDescriptors[i]);
@@ -1277,7 +1394,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRootSignature(ID3D12RootSignatu
     SCOPED_SERIALISE_CONTEXT(SET_COMP_ROOT_SIG);
     Serialise_SetComputeRootSignature(pRootSignature);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pRootSignature), eFrameRef_Read);
 
     // store this so we can look up how many descriptors a given slot references, etc
@@ -1347,7 +1464,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRootDescriptorTable(
     SCOPED_SERIALISE_CONTEXT(SET_COMP_ROOT_TABLE);
     Serialise_SetComputeRootDescriptorTable(RootParameterIndex, BaseDescriptor);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(GetWrapped(BaseDescriptor)->nonsamp.heap),
                                               eFrameRef_Read);
 
@@ -1437,7 +1554,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRoot32BitConstant(UINT RootPara
     SCOPED_SERIALISE_CONTEXT(SET_COMP_ROOT_CONST);
     Serialise_SetComputeRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -1498,7 +1615,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRoot32BitConstants(UINT RootPar
     Serialise_SetComputeRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData,
                                            DestOffsetIn32BitValues);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -1574,7 +1691,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRootConstantBufferView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -1651,7 +1768,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRootShaderResourceView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -1729,7 +1846,7 @@ void WrappedID3D12GraphicsCommandList::SetComputeRootUnorderedAccessView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -1792,7 +1909,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRootSignature(ID3D12RootSignat
     SCOPED_SERIALISE_CONTEXT(SET_GFX_ROOT_SIG);
     Serialise_SetGraphicsRootSignature(pRootSignature);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pRootSignature), eFrameRef_Read);
 
     // store this so we can look up how many descriptors a given slot references, etc
@@ -1862,7 +1979,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRootDescriptorTable(
     SCOPED_SERIALISE_CONTEXT(SET_GFX_ROOT_TABLE);
     Serialise_SetGraphicsRootDescriptorTable(RootParameterIndex, BaseDescriptor);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(GetWrapped(BaseDescriptor)->nonsamp.heap),
                                               eFrameRef_Read);
 
@@ -1952,7 +2069,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRoot32BitConstant(UINT RootPar
     SCOPED_SERIALISE_CONTEXT(SET_GFX_ROOT_CONST);
     Serialise_SetGraphicsRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2013,7 +2130,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRoot32BitConstants(UINT RootPa
     Serialise_SetGraphicsRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData,
                                             DestOffsetIn32BitValues);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2090,7 +2207,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRootConstantBufferView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -2168,7 +2285,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRootShaderResourceView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -2246,7 +2363,7 @@ void WrappedID3D12GraphicsCommandList::SetGraphicsRootUnorderedAccessView(
     UINT64 offs = 0;
     WrappedID3D12Resource::GetResIDFromAddr(BufferLocation, id, offs);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(id, eFrameRef_Read);
   }
 }
@@ -2296,7 +2413,7 @@ void WrappedID3D12GraphicsCommandList::BeginQuery(ID3D12QueryHeap *pQueryHeap,
     SCOPED_SERIALISE_CONTEXT(BEGIN_QUERY);
     Serialise_BeginQuery(pQueryHeap, Type, Index);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pQueryHeap), eFrameRef_Read);
   }
@@ -2343,7 +2460,7 @@ void WrappedID3D12GraphicsCommandList::EndQuery(ID3D12QueryHeap *pQueryHeap, D3D
     SCOPED_SERIALISE_CONTEXT(END_QUERY);
     Serialise_EndQuery(pQueryHeap, Type, Index);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pQueryHeap), eFrameRef_Read);
   }
@@ -2406,7 +2523,7 @@ void WrappedID3D12GraphicsCommandList::ResolveQueryData(ID3D12QueryHeap *pQueryH
     Serialise_ResolveQueryData(pQueryHeap, Type, StartIndex, NumQueries, pDestinationBuffer,
                                AlignedDestinationBufferOffset);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pQueryHeap), eFrameRef_Read);
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pDestinationBuffer), eFrameRef_Write);
@@ -2441,7 +2558,7 @@ void WrappedID3D12GraphicsCommandList::SetPredication(ID3D12Resource *pBuffer,
     SCOPED_SERIALISE_CONTEXT(SET_PREDICATION);
     Serialise_SetPredication(pBuffer, AlignedBufferOffset, Operation);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pBuffer), eFrameRef_Read);
   }
 }
@@ -2642,7 +2759,7 @@ bool WrappedID3D12GraphicsCommandList::Serialise_SetMarker(UINT Metadata, const
   }
 
   SERIALISE_ELEMENT(ResourceId, CommandList, GetResourceID());
-  m_pSerialiser->Serialise("MarkerText", markerText);
+  m_pSerialiser->SerialiseInternedString("MarkerText", markerText);
 
   if(m_State < WRITING)
     m_Cmd->m_LastCmdListID = CommandList;
@@ -2668,7 +2785,7 @@ void WrappedID3D12GraphicsCommandList::SetMarker(UINT Metadata, const void *pDat
     SCOPED_SERIALISE_CONTEXT(SET_MARKER);
     Serialise_SetMarker(Metadata, pData, Size);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2700,7 +2817,7 @@ bool WrappedID3D12GraphicsCommandList::Serialise_BeginEvent(UINT Metadata, const
   }
 
   SERIALISE_ELEMENT(ResourceId, CommandList, GetResourceID());
-  m_pSerialiser->Serialise("MarkerText", markerText);
+  m_pSerialiser->SerialiseInternedString("MarkerText", markerText);
 
   if(m_State < WRITING)
     m_Cmd->m_LastCmdListID = CommandList;
@@ -2726,7 +2843,7 @@ void WrappedID3D12GraphicsCommandList::BeginEvent(UINT Metadata, const void *pDa
     SCOPED_SERIALISE_CONTEXT(BEGIN_EVENT);
     Serialise_BeginEvent(Metadata, pData, Size);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2769,7 +2886,7 @@ void WrappedID3D12GraphicsCommandList::EndEvent()
     SCOPED_SERIALISE_CONTEXT(END_EVENT);
     Serialise_EndEvent();
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2838,8 +2955,10 @@ void WrappedID3D12GraphicsCommandList::DrawInstanced(UINT VertexCountPerInstance
                                                      UINT InstanceCount, UINT StartVertexLocation,
                                                      UINT StartInstanceLocation)
 {
+  BeginEventTiming();
   m_pReal->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation,
                          StartInstanceLocation);
+  EndEventTiming();
 
   if(m_State >= WRITING)
   {
@@ -2847,7 +2966,7 @@ void WrappedID3D12GraphicsCommandList::DrawInstanced(UINT VertexCountPerInstance
     Serialise_DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation,
                             StartInstanceLocation);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2917,8 +3036,10 @@ void WrappedID3D12GraphicsCommandList::DrawIndexedInstanced(UINT IndexCountPerIn
                                                             INT BaseVertexLocation,
                                                             UINT StartInstanceLocation)
 {
+  BeginEventTiming();
   m_pReal->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation,
                                 BaseVertexLocation, StartInstanceLocation);
+  EndEventTiming();
 
   if(m_State >= WRITING)
   {
@@ -2926,7 +3047,7 @@ void WrappedID3D12GraphicsCommandList::DrawIndexedInstanced(UINT IndexCountPerIn
     Serialise_DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation,
                                    BaseVertexLocation, StartInstanceLocation);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -2986,14 +3107,16 @@ bool WrappedID3D12GraphicsCommandList::Serialise_Dispatch(UINT ThreadGroupCountX
 void WrappedID3D12GraphicsCommandList::Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY,
                                                 UINT ThreadGroupCountZ)
 {
+  BeginEventTiming();
   m_pReal->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+  EndEventTiming();
 
   if(m_State >= WRITING)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH);
     Serialise_Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
   }
 }
 
@@ -3069,7 +3192,7 @@ void WrappedID3D12GraphicsCommandList::ExecuteBundle(ID3D12GraphicsCommandList *
     SCOPED_SERIALISE_CONTEXT(EXEC_BUNDLE);
     Serialise_ExecuteBundle(pCommandList);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     D3D12ResourceRecord *record = GetRecord(pCommandList);
 
@@ -4075,7 +4198,7 @@ void WrappedID3D12GraphicsCommandList::ExecuteIndirect(ID3D12CommandSignature *p
     Serialise_ExecuteIndirect(pCommandSignature, MaxCommandCount, pArgumentBuffer,
                               ArgumentBufferOffset, pCountBuffer, CountBufferOffset);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     m_ListRecord->ContainsExecuteIndirect = true;
 
@@ -4160,7 +4283,7 @@ void WrappedID3D12GraphicsCommandList::ClearDepthStencilView(
     SCOPED_SERIALISE_CONTEXT(CLEAR_DSV);
     Serialise_ClearDepthStencilView(DepthStencilView, ClearFlags, Depth, Stencil, NumRects, pRects);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     {
       D3D12Descriptor *desc = GetWrapped(DepthStencilView);
@@ -4245,7 +4368,7 @@ void WrappedID3D12GraphicsCommandList::ClearRenderTargetView(
     SCOPED_SERIALISE_CONTEXT(CLEAR_RTV);
     Serialise_ClearRenderTargetView(RenderTargetView, ColorRGBA, NumRects, pRects);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     {
       D3D12Descriptor *desc = GetWrapped(RenderTargetView);
@@ -4342,7 +4465,7 @@ void WrappedID3D12GraphicsCommandList::ClearUnorderedAccessViewUint(
     Serialise_ClearUnorderedAccessViewUint(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource,
                                            Values, NumRects, pRects);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     {
       D3D12Descriptor *desc = GetWrapped(ViewGPUHandleInCurrentHeap);
@@ -4445,7 +4568,7 @@ void WrappedID3D12GraphicsCommandList::ClearUnorderedAccessViewFloat(
     Serialise_ClearUnorderedAccessViewFloat(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource,
                                             Values, NumRects, pRects);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
 
     {
       D3D12Descriptor *desc = GetWrapped(ViewGPUHandleInCurrentHeap);
@@ -4503,7 +4626,7 @@ void WrappedID3D12GraphicsCommandList::DiscardResource(ID3D12Resource *pResource
     SCOPED_SERIALISE_CONTEXT(DISCARD_RESOURCE);
     Serialise_DiscardResource(pResource, pRegion);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pResource), eFrameRef_Write);
   }
 }
@@ -4593,7 +4716,7 @@ void WrappedID3D12GraphicsCommandList::CopyBufferRegion(ID3D12Resource *pDstBuff
     SCOPED_SERIALISE_CONTEXT(COPY_BUFFER);
     Serialise_CopyBufferRegion(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pDstBuffer), eFrameRef_Write);
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pSrcBuffer), eFrameRef_Read);
   }
@@ -4688,7 +4811,7 @@ void WrappedID3D12GraphicsCommandList::CopyTextureRegion(const D3D12_TEXTURE_COP
     SCOPED_SERIALISE_CONTEXT(COPY_TEXTURE);
     Serialise_CopyTextureRegion(pDst, DstX, DstY, DstZ, pSrc, pSrcBox);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pDst->pResource), eFrameRef_Write);
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pSrc->pResource), eFrameRef_Read);
   }
@@ -4769,7 +4892,7 @@ void WrappedID3D12GraphicsCommandList::CopyResource(ID3D12Resource *pDstResource
     SCOPED_SERIALISE_CONTEXT(COPY_RESOURCE);
     Serialise_CopyResource(pDstResource, pSrcResource);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pDstResource), eFrameRef_Write);
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pSrcResource), eFrameRef_Read);
   }
@@ -4862,7 +4985,7 @@ void WrappedID3D12GraphicsCommandList::ResolveSubresource(ID3D12Resource *pDstRe
     SCOPED_SERIALISE_CONTEXT(RESOLVE_SUBRESOURCE);
     Serialise_ResolveSubresource(pDstResource, DstSubresource, pSrcResource, SrcSubresource, Format);
 
-    m_ListRecord->AddChunk(scope.Get());
+    m_ListRecord->AddChunk(scope.Get(m_ChunkArena));
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pDstResource), eFrameRef_Write);
     m_ListRecord->MarkResourceFrameReferenced(GetResID(pSrcResource), eFrameRef_Read);
   }
@@ -409,6 +409,7 @@ void STDMETHODCALLTYPE WrappedID3D12CommandQueue::ExecuteCommandLists(
 
     bool capframe = (m_State == WRITING_CAPFRAME);
     set<ResourceId> refdIDs;
+    vector<D3D12ResourceRecord *> refdCmds;
 
     for(UINT i = 0; i < NumCommandLists; i++)
     {
@@ -495,14 +496,14 @@ void STDMETHODCALLTYPE WrappedID3D12CommandQueue::ExecuteCommandLists(
 
         // pull in frame refs from this baked command list
         record->bakedCommands->AddResourceReferences(GetResourceManager());
-        record->bakedCommands->AddReferencedIDs(refdIDs);
+        refdCmds.push_back(record->bakedCommands);
 
         // reference all executed bundles as well
         for(size_t b = 0; b < record->bakedCommands->cmdInfo->bundles.size(); b++)
         {
           record->bakedCommands->cmdInfo->bundles[b]->bakedCommands->AddResourceReferences(
               GetResourceManager());
-          record->bakedCommands->cmdInfo->bundles[b]->bakedCommands->AddReferencedIDs(refdIDs);
+          refdCmds.push_back(record->bakedCommands->cmdInfo->bundles[b]->bakedCommands);
           GetResourceManager()->MarkResourceFrameReferenced(
               record->bakedCommands->cmdInfo->bundles[b]->GetResourceID(), eFrameRef_Read);
 
@@ -523,58 +524,84 @@ void STDMETHODCALLTYPE WrappedID3D12CommandQueue::ExecuteCommandLists(
 
     if(capframe)
     {
-      vector<MapState> maps = m_pDevice->GetMaps();
+      vector<WrappedID3D12Resource *> maps;
+      m_pDevice->GetMappedResources(refdIDs, refdCmds, maps);
 
       for(auto it = maps.begin(); it != maps.end(); ++it)
       {
-        WrappedID3D12Resource *res = it->res;
-        UINT subres = it->subres;
-        size_t size = (size_t)it->totalSize;
+        WrappedID3D12Resource *res = *it;
+        vector<D3D12ResourceRecord::MapData> &mapData = res->GetResourceRecord()->m_Map;
 
-        // only need to flush memory that could affect this submitted batch of work
-        if(refdIDs.find(res->GetResourceID()) == refdIDs.end())
+        bool dirty = false;
+
+        for(size_t sub = 0; sub < mapData.size(); sub++)
         {
-          RDCDEBUG("Map of memory %llu not referenced in this queue - not flushing",
-                   res->GetResourceID());
-          continue;
-        }
+          D3D12ResourceRecord::MapData &map = mapData[sub];
 
-        size_t diffStart = 0, diffEnd = 0;
-        bool found = true;
+          if(map.refcount <= 0 || map.realPtr == NULL)
+            continue;
 
-        byte *ref = res->GetShadow(subres);
-        byte *data = res->GetMap(subres);
+          UINT subres = (UINT)sub;
+          size_t size = (size_t)map.totalSize;
 
-        if(ref)
-          found = FindDiffRange(data, ref, size, diffStart, diffEnd);
-        else
-          diffEnd = size;
+          // ranges relative to the map pointer that have changed and need to be flushed
+          vector<pair<size_t, size_t> > diffs;
 
-        if(found)
-        {
-          RDCLOG("Persistent map flush forced for %llu (%llu -> %llu)", res->GetResourceID(),
-                 (uint64_t)diffStart, (uint64_t)diffEnd);
+          size_t diffStart = 0, diffEnd = 0;
+
+          byte *ref = map.shadowPtr;
+          byte *data = map.realPtr;
+
+          if(ref && map.writeWatch)
+          {
+            // only pages written since the last flush can differ from the shadow
+            WriteWatch::FindModifiedRanges(map.writeWatch, data, ref, size, diffs);
+          }
+          else if(ref)
+          {
+            if(FindDiffRange(data, ref, size, diffStart, diffEnd))
+              diffs.push_back(std::make_pair(diffStart, diffEnd));
+          }
+          else
+          {
+            // the first flush serialises everything. If we can, start tracking writes before it's
+            // serialised so that anything written during or after is caught next time
+            if(RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites)
+              map.writeWatch = WriteWatch::Begin(data, size);
 
-          D3D12_RANGE range = {diffStart, diffEnd};
+            diffs.push_back(std::make_pair((size_t)0, size));
+          }
 
-          m_pDevice->MapDataWrite(res, subres, data, range);
+          if(diffs.empty())
+            continue;
 
           if(ref == NULL)
           {
             res->AllocShadow(subres, size);
 
-            ref = res->GetShadow(subres);
+            ref = map.shadowPtr;
           }
 
-          // update comparison shadow for next time
-          memcpy(ref, res->GetMap(subres), size);
+          for(size_t d = 0; d < diffs.size(); d++)
+          {
+            RDCLOG("Persistent map flush forced for %llu (%llu -> %llu)", res->GetResourceID(),
+                   (uint64_t)diffs[d].first, (uint64_t)diffs[d].second);
 
-          GetResourceManager()->MarkPendingDirty(res->GetResourceID());
+            D3D12_RANGE range = {diffs[d].first, diffs[d].second};
+
+            m_pDevice->MapDataWrite(res, subres, data, range);
+
+            // update comparison shadow for next time. Everything outside the diffs already matches
+            memcpy(ref + range.Begin, data + range.Begin, range.End - range.Begin);
+          }
+
+          dirty = true;
         }
+
+        if(dirty)
+          GetResourceManager()->MarkPendingDirty(res->GetResourceID());
         else
-        {
           RDCDEBUG("Persistent map flush not needed for %llu", res->GetResourceID());
-        }
       }
 
       for(UINT i = 0; i < NumCommandLists; i++)
@@ -410,6 +410,61 @@ void WrappedID3D12CommandQueue::ProcessChunk(uint64_t offset, D3D12ChunkType chu
         SAFE_DELETE_ARRAY(stack);
       }
 
+      if(m_pDevice->GetLogVersion() >= 0x0000003)
+      {
+        vector<ResourceId> timingCmds;
+        vector<uint32_t> timingChunks;
+        vector<uint64_t> timingDurations;
+
+        m_pSerialiser->Serialise("timingCmds", timingCmds);
+        m_pSerialiser->Serialise("timingChunks", timingChunks);
+        m_pSerialiser->Serialise("timingDurations", timingDurations);
+
+        if(m_State == READING)
+        {
+          m_Cmd.m_CapturedEventTimings.clear();
+
+          for(size_t i = 0; i < timingCmds.size() && i < timingChunks.size() &&
+                            i < timingDurations.size();
+              i++)
+          {
+            // the timings are from the command list's last execution in the frame
+            const vector<uint32_t> &execs =
+                m_Cmd.m_Partial[D3D12CommandData::Primary].cmdListExecs[timingCmds[i]];
+            const vector<uint32_t> &chunkEIDs =
+                m_Cmd.m_BakedCmdListInfo[timingCmds[i]].chunkEventIDs;
+
+            if(execs.empty() || timingChunks[i] >= chunkEIDs.size())
+              continue;
+
+            double seconds = double(timingDurations[i]) / 1000000000.0;
+
+            m_Cmd.m_CapturedEventTimings.push_back(
+                CounterResult(execs.back() + chunkEIDs[timingChunks[i]],
+                              eCounter_CapturedGPUDuration, seconds));
+          }
+        }
+      }
+
+      if(m_State == READING)
+      {
+        m_Cmd.AddEvent("Present()");
+
+        FetchDrawcall draw;
+        draw.name = "Present()";
+        draw.flags |= eDraw_Present;
+
+        draw.copyDestination = bbid;
+
+        m_Cmd.AddDrawcall(draw, true);
+      }
+      break;
+    }
+    case FRAME_BOUNDARY:
+    {
+      // the end of one frame in a capture recording a run of them
+      SERIALISE_ELEMENT(ResourceId, bbid, ResourceId());
+
       if(m_State == READING)
       {
         m_Cmd.AddEvent("Present()");
@@ -527,6 +582,13 @@ void WrappedID3D12CommandQueue::ReplayLog(LogState readType, uint32_t startEvent
 
     ProcessChunk(offset, context);
 
+    // note which event each command list chunk was part of, for the captured event timings
+    if(m_State == READING && m_Cmd.m_LastCmdListID != ResourceId() && context != CLOSE_LIST)
+    {
+      BakedCmdListInfo &cmdInfo = m_Cmd.m_BakedCmdListInfo[m_Cmd.m_LastCmdListID];
+      cmdInfo.chunkEventIDs.push_back(cmdInfo.curEventID);
+    }
+
     RenderDoc::Inst().SetProgress(FileInitialRead, float(offset) / float(m_pSerialiser->GetSize()));
 
     // for now just abort after capture scope. Really we'd need to support multiple frames
@@ -618,6 +680,7 @@ WrappedID3D12GraphicsCommandList::WrappedID3D12GraphicsCommandList(ID3D12Graphic
   RDCEraseEl(m_Init);
 
   m_ListRecord = NULL;
+  m_ChunkArena = NULL;
   m_Cmd = NULL;
 
   m_CurGfxRootSig = NULL;
@@ -634,6 +697,8 @@ WrappedID3D12GraphicsCommandList::WrappedID3D12GraphicsCommandList(ID3D12Graphic
 
     // this is set up in the implicit Reset() right after creation
     m_ListRecord->bakedCommands = NULL;
+
+    m_ChunkArena = new ChunkArena();
   }
   else
   {
@@ -660,6 +725,8 @@ WrappedID3D12GraphicsCommandList::~WrappedID3D12GraphicsCommandList()
   if(m_ListRecord && m_ListRecord->bakedCommands)
     m_ListRecord->bakedCommands->Delete(m_pDevice->GetResourceManager());
 
+  SAFE_DELETE(m_ChunkArena);
+
   m_pDevice->GetResourceManager()->ReleaseCurrentResource(GetResourceID());
 
   SAFE_RELEASE(m_WrappedDebug.m_pReal);
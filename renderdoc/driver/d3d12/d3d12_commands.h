@@ -132,6 +132,7 @@ struct BakedCmdListInfo
     drawCount = parent.drawCount;
     crackedLists.swap(parent.crackedLists);
     executeEvents.swap(parent.executeEvents);
+    chunkEventIDs.swap(parent.chunkEventIDs);
 
     parentList = parentID;
 
@@ -183,6 +184,9 @@ struct BakedCmdListInfo
 
   vector<pair<ResourceId, EventUsage> > resourceUsage;
 
+  // the relative event ID of each chunk recorded in the list, to match captured event timings
+  vector<uint32_t> chunkEventIDs;
+
   ResourceId allocator;
   D3D12_COMMAND_LIST_TYPE type;
   UINT nodeMask;
@@ -317,6 +321,9 @@ struct D3D12CommandData
 
   vector<FetchAPIEvent> m_RootEvents, m_Events;
 
+  // durations read from the timestamps recorded around events while capturing
+  vector<CounterResult> m_CapturedEventTimings;
+
   uint64_t m_CurChunkOffset;
 
   uint32_t m_RootEventID, m_RootDrawcallID;
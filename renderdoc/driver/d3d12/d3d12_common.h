@@ -447,6 +447,8 @@ void Serialiser::Serialise(const char *name, D3D12Descriptor &el);
   D3D12_CHUNK_MACRO(SIGNAL, "ID3D12GraphicsCommandQueue::Signal")                                  \
   D3D12_CHUNK_MACRO(WAIT, "ID3D12GraphicsCommandQueue::Wait")                                      \
                                                                                                    \
+  D3D12_CHUNK_MACRO(FRAME_BOUNDARY, "IDXGISwapChain::Present")                                     \
+                                                                                                   \
   D3D12_CHUNK_MACRO(NUM_D3D12_CHUNKS, "")
 
 enum D3D12ChunkType
@@ -60,6 +60,9 @@ vector<uint32_t> D3D12Replay::EnumerateCounters()
   ret.push_back(eCounter_PSInvocations);
   ret.push_back(eCounter_CSInvocations);
 
+  if(!m_pDevice->GetQueue()->GetCommandData()->m_CapturedEventTimings.empty())
+    ret.push_back(eCounter_CapturedGPUDuration);
+
   return ret;
 }
 
@@ -163,6 +166,15 @@ void D3D12Replay::DescribeCounter(uint32_t counterID, CounterDescription &desc)
       desc.resultCompType = eCompType_UInt;
       desc.units = eUnits_Absolute;
       break;
+    case eCounter_CapturedGPUDuration:
+      desc.name = "Captured GPU Duration";
+      desc.description =
+          "Time taken for this event on the GPU while the application was being captured, as "
+          "measured by delta between two GPU timestamps recorded around it.";
+      desc.resultByteWidth = 8;
+      desc.resultCompType = eCompType_Double;
+      desc.units = eUnits_Seconds;
+      break;
     default:
       desc.name = "Unknown";
       desc.description = "Unknown counter ID";
@@ -192,22 +204,30 @@ struct D3D12GPUTimerCallback : public D3D12DrawcallCallback
   {
     if(cmd->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT)
     {
-      cmd->BeginQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
-      cmd->BeginQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, m_NumStatsQueries);
+      if(m_OcclusionQueryHeap)
+        cmd->BeginQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
+      if(m_PipeStatsQueryHeap)
+        cmd->BeginQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS,
+                        m_NumStatsQueries);
     }
-    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 0);
+    if(m_TimerQueryHeap)
+      cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 0);
   }
 
   bool PostDraw(uint32_t eid, ID3D12GraphicsCommandList *cmd)
   {
-    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 1);
+    if(m_TimerQueryHeap)
+      cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 1);
     m_NumTimestampQueries++;
 
     bool direct = (cmd->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT);
     if(direct)
     {
-      cmd->EndQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, m_NumStatsQueries);
-      cmd->EndQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
+      if(m_PipeStatsQueryHeap)
+        cmd->EndQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS,
+                      m_NumStatsQueries);
+      if(m_OcclusionQueryHeap)
+        cmd->EndQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
 
       m_NumStatsQueries++;
     }
@@ -244,10 +264,54 @@ struct D3D12GPUTimerCallback : public D3D12DrawcallCallback
 };
 
 vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counters)
+{
+  vector<CounterResult> ret;
+
+  // the captured timings are already known, so only the remaining counters need a replay
+  vector<uint32_t> replayCounters;
+
+  for(size_t i = 0; i < counters.size(); i++)
+  {
+    if(counters[i] == eCounter_CapturedGPUDuration)
+    {
+      const vector<CounterResult> &timings =
+          m_pDevice->GetQueue()->GetCommandData()->m_CapturedEventTimings;
+      ret.insert(ret.end(), timings.begin(), timings.end());
+    }
+    else
+    {
+      replayCounters.push_back(counters[i]);
+    }
+  }
+
+  if(!replayCounters.empty())
+    FetchReplayCounters(replayCounters, ret);
+
+  return ret;
+}
+
+void D3D12Replay::FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret)
 {
   uint32_t maxEID = m_pDevice->GetQueue()->GetMaxEID();
 
-  vector<CounterResult> ret;
+  // only create and issue the queries that the requested counters need, pipeline statistics in
+  // particular aren't free to gather on every event.
+  bool needTimestamps = false, needOcclusion = false, needPipeStats = false;
+
+  for(size_t c = 0; c < counters.size(); c++)
+  {
+    if(counters[c] == eCounter_EventGPUDuration)
+      needTimestamps = true;
+    else if(counters[c] == eCounter_SamplesWritten)
+      needOcclusion = true;
+    else
+      needPipeStats = true;
+  }
+
+  // every query type is resolved into its own region of one readback buffer
+  UINT64 timestampSize = needTimestamps ? sizeof(uint64_t) * 2 * maxEID : 0;
+  UINT64 pipeStatsSize = needPipeStats ? sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS) * maxEID : 0;
+  UINT64 occlusionSize = needOcclusion ? sizeof(uint64_t) * maxEID : 0;
 
   D3D12_HEAP_PROPERTIES heapProps;
   heapProps.Type = D3D12_HEAP_TYPE_READBACK;
@@ -259,7 +323,7 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
   D3D12_RESOURCE_DESC bufDesc;
   bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
   bufDesc.Alignment = 0;
-  bufDesc.Width = (sizeof(uint64_t) * 3 + sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS)) * maxEID;
+  bufDesc.Width = RDCMAX(timestampSize + pipeStatsSize + occlusionSize, (UINT64)1);
   bufDesc.Height = 1;
   bufDesc.DepthOrArraySize = 1;
   bufDesc.MipLevels = 1;
@@ -269,62 +333,81 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
   bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
   bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-  ID3D12Resource *readbackBuf;
+  ID3D12Resource *readbackBuf = NULL;
+  ID3D12QueryHeap *timerQueryHeap = NULL;
+  ID3D12QueryHeap *pipestatsQueryHeap = NULL;
+  ID3D12QueryHeap *occlusionQueryHeap = NULL;
+
   HRESULT hr = m_pDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc,
                                                   D3D12_RESOURCE_STATE_COPY_DEST, NULL,
                                                   __uuidof(ID3D12Resource), (void **)&readbackBuf);
   if(FAILED(hr))
   {
     RDCERR("Failed to create query readback buffer %08x", hr);
-    return ret;
+    return;
   }
 
-  D3D12_QUERY_HEAP_DESC timerQueryDesc;
-  timerQueryDesc.Count = maxEID * 2;
-  timerQueryDesc.NodeMask = 1;
-  timerQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
-  ID3D12QueryHeap *timerQueryHeap = NULL;
-  hr = m_pDevice->CreateQueryHeap(&timerQueryDesc, __uuidof(timerQueryHeap),
-                                  (void **)&timerQueryHeap);
-  if(FAILED(hr))
+  if(needTimestamps)
   {
-    RDCERR("Failed to create timer query heap %08x", hr);
-    return ret;
+    D3D12_QUERY_HEAP_DESC timerQueryDesc;
+    timerQueryDesc.Count = maxEID * 2;
+    timerQueryDesc.NodeMask = 1;
+    timerQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    hr = m_pDevice->CreateQueryHeap(&timerQueryDesc, __uuidof(timerQueryHeap),
+                                    (void **)&timerQueryHeap);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create timer query heap %08x", hr);
+      SAFE_RELEASE(readbackBuf);
+      return;
+    }
   }
 
-  D3D12_QUERY_HEAP_DESC pipestatsQueryDesc;
-  pipestatsQueryDesc.Count = maxEID;
-  pipestatsQueryDesc.NodeMask = 1;
-  pipestatsQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS;
-  ID3D12QueryHeap *pipestatsQueryHeap = NULL;
-  hr = m_pDevice->CreateQueryHeap(&pipestatsQueryDesc, __uuidof(pipestatsQueryHeap),
-                                  (void **)&pipestatsQueryHeap);
-  if(FAILED(hr))
+  if(needPipeStats)
   {
-    RDCERR("Failed to create pipeline statistics query heap %08x", hr);
-    return ret;
+    D3D12_QUERY_HEAP_DESC pipestatsQueryDesc;
+    pipestatsQueryDesc.Count = maxEID;
+    pipestatsQueryDesc.NodeMask = 1;
+    pipestatsQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS;
+    hr = m_pDevice->CreateQueryHeap(&pipestatsQueryDesc, __uuidof(pipestatsQueryHeap),
+                                    (void **)&pipestatsQueryHeap);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create pipeline statistics query heap %08x", hr);
+      SAFE_RELEASE(readbackBuf);
+      SAFE_RELEASE(timerQueryHeap);
+      return;
+    }
   }
 
-  D3D12_QUERY_HEAP_DESC occlusionQueryDesc;
-  occlusionQueryDesc.Count = maxEID;
-  occlusionQueryDesc.NodeMask = 1;
-  occlusionQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_OCCLUSION;
-  ID3D12QueryHeap *occlusionQueryHeap = NULL;
-  hr = m_pDevice->CreateQueryHeap(&occlusionQueryDesc, __uuidof(occlusionQueryHeap),
-                                  (void **)&occlusionQueryHeap);
-  if(FAILED(hr))
+  if(needOcclusion)
   {
-    RDCERR("Failed to create occlusion query heap %08x", hr);
-    return ret;
+    D3D12_QUERY_HEAP_DESC occlusionQueryDesc;
+    occlusionQueryDesc.Count = maxEID;
+    occlusionQueryDesc.NodeMask = 1;
+    occlusionQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_OCCLUSION;
+    hr = m_pDevice->CreateQueryHeap(&occlusionQueryDesc, __uuidof(occlusionQueryHeap),
+                                    (void **)&occlusionQueryHeap);
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create occlusion query heap %08x", hr);
+      SAFE_RELEASE(readbackBuf);
+      SAFE_RELEASE(timerQueryHeap);
+      SAFE_RELEASE(pipestatsQueryHeap);
+      return;
+    }
   }
 
   // Only supported with developer mode drivers!!!
-  hr = m_pDevice->SetStablePowerState(TRUE);
-  if(FAILED(hr))
-    MessageBoxA(NULL,
-                "D3D12 counters require Win10 developer mode enabled: Settings > Update & Security "
-                "> For Developers > Developer Mode",
-                "D3D12 Counters Error", MB_ICONWARNING | MB_OK);
+  if(needTimestamps)
+  {
+    hr = m_pDevice->SetStablePowerState(TRUE);
+    if(FAILED(hr))
+      MessageBoxA(NULL,
+                  "D3D12 counters require Win10 developer mode enabled: Settings > Update & "
+                  "Security > For Developers > Developer Mode",
+                  "D3D12 Counters Error", MB_ICONWARNING | MB_OK);
+  }
 
   D3D12GPUTimerCallback cb(m_pDevice, this, timerQueryHeap, pipestatsQueryHeap, occlusionQueryHeap);
 
@@ -337,30 +420,33 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
 #endif
 
   // Only supported with developer mode drivers!!!
-  m_pDevice->SetStablePowerState(FALSE);
+  if(needTimestamps)
+    m_pDevice->SetStablePowerState(FALSE);
 
+  // resolve everything after the replay's own work in one list, and wait on it once
   ID3D12GraphicsCommandList *list = m_pDevice->GetNewList();
 
-  UINT64 bufferOffset = 0;
-
-  list->ResolveQueryData(timerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0,
-                         cb.m_NumTimestampQueries * 2, readbackBuf, bufferOffset);
-
-  bufferOffset += sizeof(uint64_t) * 2 * cb.m_NumTimestampQueries;
-
-  list->ResolveQueryData(pipestatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, 0,
-                         cb.m_NumStatsQueries, readbackBuf, bufferOffset);
+  if(timerQueryHeap && cb.m_NumTimestampQueries > 0)
+    list->ResolveQueryData(timerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0,
+                           cb.m_NumTimestampQueries * 2, readbackBuf, 0);
 
-  bufferOffset += sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS) * cb.m_NumStatsQueries;
+  if(pipestatsQueryHeap && cb.m_NumStatsQueries > 0)
+    list->ResolveQueryData(pipestatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, 0,
+                           cb.m_NumStatsQueries, readbackBuf, timestampSize);
 
-  list->ResolveQueryData(occlusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, 0, cb.m_NumStatsQueries,
-                         readbackBuf, bufferOffset);
+  if(occlusionQueryHeap && cb.m_NumStatsQueries > 0)
+    list->ResolveQueryData(occlusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, 0,
+                           cb.m_NumStatsQueries, readbackBuf, timestampSize + pipeStatsSize);
 
   list->Close();
 
   m_pDevice->ExecuteLists();
   m_pDevice->FlushLists();
 
+  SAFE_RELEASE(timerQueryHeap);
+  SAFE_RELEASE(pipestatsQueryHeap);
+  SAFE_RELEASE(occlusionQueryHeap);
+
   D3D12_RANGE range;
   range.Begin = 0;
   range.End = (SIZE_T)bufDesc.Width;
@@ -371,20 +457,22 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
   {
     RDCERR("Failed to read timer query heap data %08x", hr);
     SAFE_RELEASE(readbackBuf);
-    SAFE_RELEASE(timerQueryHeap);
-    SAFE_RELEASE(pipestatsQueryHeap);
-    SAFE_RELEASE(occlusionQueryHeap);
-    return ret;
+    return;
   }
 
   uint64_t *timestamps = (uint64_t *)data;
-  data += cb.m_NumTimestampQueries * 2 * sizeof(uint64_t);
-  D3D12_QUERY_DATA_PIPELINE_STATISTICS *pipelinestats = (D3D12_QUERY_DATA_PIPELINE_STATISTICS *)data;
-  data += cb.m_NumStatsQueries * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
-  uint64_t *occlusion = (uint64_t *)data;
+  D3D12_QUERY_DATA_PIPELINE_STATISTICS *pipelinestats =
+      (D3D12_QUERY_DATA_PIPELINE_STATISTICS *)(data + timestampSize);
+  uint64_t *occlusion = (uint64_t *)(data + timestampSize + pipeStatsSize);
 
-  uint64_t freq;
-  m_pDevice->GetQueue()->GetTimestampFrequency(&freq);
+  uint64_t freq = 1;
+  if(needTimestamps)
+    m_pDevice->GetQueue()->GetTimestampFrequency(&freq);
+
+  ret.reserve(ret.size() + (cb.m_Results.size() + cb.m_AliasEvents.size()) * counters.size());
+
+  // index of each event's first result, for looking up aliased events below
+  map<uint32_t, size_t> resultIndex;
 
   for(size_t i = 0; i < cb.m_Results.size(); i++)
   {
@@ -396,13 +484,17 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
     // only events on direct lists recorded pipeline stats or occlusion queries
     if(direct)
     {
-      pipeStats = *pipelinestats;
-      occl = *occlusion;
+      if(needPipeStats)
+        pipeStats = *pipelinestats;
+      if(needOcclusion)
+        occl = *occlusion;
 
       pipelinestats++;
       occlusion++;
     }
 
+    resultIndex[cb.m_Results[i].first] = ret.size();
+
     for(size_t c = 0; c < counters.size(); c++)
     {
       CounterResult result;
@@ -435,20 +527,21 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
     }
   }
 
+  range.End = 0;
+  readbackBuf->Unmap(0, &range);
+
   for(size_t i = 0; i < cb.m_AliasEvents.size(); i++)
   {
+    // find the results we're aliasing
+    auto it = resultIndex.find(cb.m_AliasEvents[i].first);
+    RDCASSERT(it != resultIndex.end());
+    if(it == resultIndex.end())
+      continue;
+
     for(size_t c = 0; c < counters.size(); c++)
     {
-      CounterResult search;
-      search.counterID = counters[c];
-      search.eventID = cb.m_AliasEvents[i].first;
-
-      // find the result we're aliasing
-      auto it = std::find(ret.begin(), ret.end(), search);
-      RDCASSERT(it != ret.end());
-
       // duplicate the result and append
-      CounterResult aliased = *it;
+      CounterResult aliased = ret[it->second + c];
       aliased.eventID = cb.m_AliasEvents[i].second;
       ret.push_back(aliased);
     }
@@ -458,9 +551,4 @@ vector<CounterResult> D3D12Replay::FetchCounters(const vector<uint32_t> &counter
   std::sort(ret.begin(), ret.end());
 
   SAFE_RELEASE(readbackBuf);
-  SAFE_RELEASE(timerQueryHeap);
-  SAFE_RELEASE(pipestatsQueryHeap);
-  SAFE_RELEASE(occlusionQueryHeap);
-
-  return ret;
 }
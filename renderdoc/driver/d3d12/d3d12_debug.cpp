@@ -116,6 +116,27 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
     RDCERR("Couldn't create DXGI factory! 0x%08x", hr);
   }
 
+  m_pAdapter = NULL;
+
+  if(m_pFactory)
+  {
+    hr = m_pFactory->EnumAdapterByLuid(m_WrappedDevice->GetAdapterLuid(), __uuidof(IDXGIAdapter3),
+                                       (void **)&m_pAdapter);
+
+    if(FAILED(hr))
+    {
+      RDCWARN("Couldn't get adapter to query memory budget: 0x%08x", hr);
+      m_pAdapter = NULL;
+    }
+  }
+
+  // on UMA devices upload heaps come out of the same memory as everything else
+  D3D12_FEATURE_DATA_ARCHITECTURE arch = {};
+  hr = m_WrappedDevice->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE, &arch, sizeof(arch));
+
+  m_UploadSegment = (SUCCEEDED(hr) && arch.UMA) ? DXGI_MEMORY_SEGMENT_GROUP_LOCAL
+                                                : DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL;
+
   D3D12_DESCRIPTOR_HEAP_DESC desc;
   desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
   desc.NodeMask = 1;
@@ -214,6 +235,9 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
 
   m_CustomShaderTex = NULL;
 
+  m_TexDiffTex = NULL;
+  RDCEraseEl(m_TexDiffInput);
+
   {
     D3D12_RESOURCE_DESC soBufDesc;
     soBufDesc.Alignment = 0;
@@ -359,8 +383,8 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
 
   RenderDoc::Inst().SetProgress(DebugManagerInit, 0.4f);
 
-  bool success = LoadShaderCache("d3d12shaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, ShaderCache12Callbacks);
+  bool success =
+      m_ShaderCacheFile.Open("d3d12shaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion);
 
   // if we failed to load from the cache
   m_ShaderCacheDirty = !success;
@@ -746,9 +770,9 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
   m_OverlayRenderTex = NULL;
   m_OverlayResourceId = ResourceId();
 
-  string histogramhlsl = GetEmbeddedResource(debugcbuffers_h);
-  histogramhlsl += GetEmbeddedResource(debugcommon_hlsl);
-  histogramhlsl += GetEmbeddedResource(histogram_hlsl);
+  m_HistogramHLSL = GetEmbeddedResource(debugcbuffers_h);
+  m_HistogramHLSL += GetEmbeddedResource(debugcommon_hlsl);
+  m_HistogramHLSL += GetEmbeddedResource(histogram_hlsl);
 
   RenderDoc::Inst().SetProgress(DebugManagerInit, 0.7f);
 
@@ -775,12 +799,17 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
     RDCERR("Couldn't create m_MeshPickPipe! 0x%08x", hr);
   }
 
-  compPipeDesc.pRootSignature = m_HistogramRootSig;
-
   RDCEraseEl(m_TileMinMaxPipe);
   RDCEraseEl(m_HistogramPipe);
+  RDCEraseEl(m_HistogramPipesCreated);
   RDCEraseEl(m_ResultMinMaxPipe);
+  m_TexDiffPipe = NULL;
+  m_TexDiffPipeCreated = false;
+  m_TexDiffResultBuffer = NULL;
 
+  // the min/max and histogram pipelines are most of the shaders we'd build here, and many replays
+  // never use them, so they're created on first use. The shaders are compiled in the background in
+  // the meantime so that the first use doesn't have to wait for the compiler.
   for(int t = RESTYPE_TEX1D; t <= RESTYPE_TEX2D_MS; t++)
   {
     // skip unused cube slot
@@ -790,66 +819,20 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
     // float, uint, sint
     for(int i = 0; i < 3; i++)
     {
-      ID3DBlob *tile = NULL;
-      ID3DBlob *result = NULL;
-      ID3DBlob *histogram = NULL;
-
-      string hlsl = string("#define SHADER_RESTYPE ") + ToStr::Get(t) + "\n";
-      hlsl += string("#define UINT_TEX ") + (i == 1 ? "1" : "0") + "\n";
-      hlsl += string("#define SINT_TEX ") + (i == 2 ? "1" : "0") + "\n";
-      hlsl += histogramhlsl;
-
-      GetShaderBlob(hlsl.c_str(), "RENDERDOC_TileMinMaxCS", D3DCOMPILE_WARNINGS_ARE_ERRORS,
-                    "cs_5_0", &tile);
-
-      compPipeDesc.CS.BytecodeLength = tile->GetBufferSize();
-      compPipeDesc.CS.pShaderBytecode = tile->GetBufferPointer();
-
-      hr = m_WrappedDevice->CreateComputePipelineState(&compPipeDesc, __uuidof(ID3D12PipelineState),
-                                                       (void **)&m_TileMinMaxPipe[t][i]);
-
-      if(FAILED(hr))
-      {
-        RDCERR("Couldn't create m_TileMinMaxPipe! 0x%08x", hr);
-      }
-
-      GetShaderBlob(hlsl.c_str(), "RENDERDOC_HistogramCS", D3DCOMPILE_WARNINGS_ARE_ERRORS, "cs_5_0",
-                    &histogram);
-
-      compPipeDesc.CS.BytecodeLength = histogram->GetBufferSize();
-      compPipeDesc.CS.pShaderBytecode = histogram->GetBufferPointer();
-
-      hr = m_WrappedDevice->CreateComputePipelineState(&compPipeDesc, __uuidof(ID3D12PipelineState),
-                                                       (void **)&m_HistogramPipe[t][i]);
-
-      if(FAILED(hr))
-      {
-        RDCERR("Couldn't create m_HistogramPipe! 0x%08x", hr);
-      }
-
-      if(t == 1)
-      {
-        GetShaderBlob(hlsl.c_str(), "RENDERDOC_ResultMinMaxCS", D3DCOMPILE_WARNINGS_ARE_ERRORS,
-                      "cs_5_0", &result);
-
-        compPipeDesc.CS.BytecodeLength = result->GetBufferSize();
-        compPipeDesc.CS.pShaderBytecode = result->GetBufferPointer();
+      string hlsl = GetHistogramSource(t, i);
 
-        hr = m_WrappedDevice->CreateComputePipelineState(
-            &compPipeDesc, __uuidof(ID3D12PipelineState), (void **)&m_ResultMinMaxPipe[i]);
+      QueueBackgroundShader(hlsl, "RENDERDOC_TileMinMaxCS");
+      QueueBackgroundShader(hlsl, "RENDERDOC_HistogramCS");
 
-        if(FAILED(hr))
-        {
-          RDCERR("Couldn't create m_HistogramPipe! 0x%08x", hr);
-        }
-      }
-
-      SAFE_RELEASE(tile);
-      SAFE_RELEASE(histogram);
-      SAFE_RELEASE(result);
+      if(t == RESTYPE_TEX1D)
+        QueueBackgroundShader(hlsl, "RENDERDOC_ResultMinMaxCS");
     }
   }
 
+  // the jobs point into the array, so only submit once it's complete
+  for(size_t i = 0; i < m_BackgroundShaders.size(); i++)
+    m_BackgroundCompiles.Submit(&CompileBackgroundShader, &m_BackgroundShaders[i]);
+
   SAFE_RELEASE(FullscreenVS);
   SAFE_RELEASE(TexDisplayPS);
   SAFE_RELEASE(OutlinePS);
@@ -1025,6 +1008,44 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
     uav.ptr += sizeof(D3D12Descriptor);
     tileDesc.Format = DXGI_FORMAT_R32G32B32A32_SINT;
     m_WrappedDevice->CreateUnorderedAccessView(m_MinMaxResultBuffer, NULL, &tileDesc, uav);
+
+    // the texture diff stats are the same size as the min/max result, but accumulated with atomics
+    hr = m_WrappedDevice->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &minmaxDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL,
+        __uuidof(ID3D12Resource), (void **)&m_TexDiffResultBuffer);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create result buffer for texture diff, HRESULT: 0x%08x", hr);
+      return;
+    }
+
+    // u0 is the diff output texture, which is created when the inputs are diffed
+    uav = GetCPUHandle(TEXDIFF_UAVS);
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC nullDesc = {};
+    nullDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    nullDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+
+    m_WrappedDevice->CreateUnorderedAccessView(NULL, NULL, &nullDesc, uav);
+
+    uav.ptr += sizeof(D3D12Descriptor);
+    tileDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    tileDesc.Buffer.NumElements = UINT(minmaxDesc.Width / sizeof(uint32_t));
+    tileDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+    m_WrappedDevice->CreateUnorderedAccessView(m_TexDiffResultBuffer, NULL, &tileDesc, uav);
+
+    // u2 is unused but the table still needs it filled
+    uav.ptr += sizeof(D3D12Descriptor);
+    m_WrappedDevice->CreateUnorderedAccessView(NULL, NULL, &nullDesc, uav);
+
+    // this UAV is used for clearing the stats back to 0
+    tileDesc.Format = DXGI_FORMAT_R32_UINT;
+    tileDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
+    m_WrappedDevice->CreateUnorderedAccessView(m_TexDiffResultBuffer, NULL, &tileDesc,
+                                               GetCPUHandle(TEXDIFF_RESULT_CLEAR_UAV));
+    m_WrappedDevice->CreateUnorderedAccessView(m_TexDiffResultBuffer, NULL, &tileDesc,
+                                               GetUAVClearHandle(TEXDIFF_RESULT_CLEAR_UAV));
   }
 
   RenderDoc::Inst().SetProgress(DebugManagerInit, 0.8f);
@@ -1308,10 +1329,12 @@ D3D12DebugManager::D3D12DebugManager(WrappedID3D12Device *wrapper)
 
 D3D12DebugManager::~D3D12DebugManager()
 {
+  // anything still compiling would add to m_PrecompiledBlobs as we release it
+  m_BackgroundCompiles.Wait();
+
   if(m_ShaderCacheDirty)
   {
-    SaveShaderCache("d3d12shaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    ShaderCache12Callbacks);
+    SaveShaderCache(m_ShaderCacheFile, m_ShaderCache, ShaderCache12Callbacks);
   }
   else
   {
@@ -1319,6 +1342,9 @@ D3D12DebugManager::~D3D12DebugManager()
       ShaderCache12Callbacks.Destroy(it->second);
   }
 
+  for(auto it = m_PrecompiledBlobs.begin(); it != m_PrecompiledBlobs.end(); ++it)
+    SAFE_RELEASE(it->second.first);
+
   for(auto it = m_CachedMeshPipelines.begin(); it != m_CachedMeshPipelines.end(); ++it)
     for(size_t p = 0; p < MeshDisplayPipelines::ePipe_Count; p++)
       SAFE_RELEASE(it->second.pipes[p]);
@@ -1331,6 +1357,7 @@ D3D12DebugManager::~D3D12DebugManager()
     SAFE_RELEASE(it->second.gsout.idxBuf);
   }
 
+  SAFE_RELEASE(m_pAdapter);
   SAFE_RELEASE(m_pFactory);
 
   SAFE_RELEASE(dsvHeap);
@@ -1366,6 +1393,12 @@ D3D12DebugManager::~D3D12DebugManager()
 
   SAFE_RELEASE(m_CustomShaderTex);
 
+  SAFE_RELEASE(m_TexDiffTex);
+  SAFE_RELEASE(m_TexDiffInput[0]);
+  SAFE_RELEASE(m_TexDiffInput[1]);
+  SAFE_RELEASE(m_TexDiffResultBuffer);
+  SAFE_RELEASE(m_TexDiffPipe);
+
   SAFE_RELEASE(m_SOBuffer);
   SAFE_RELEASE(m_SOStagingBuffer);
 
@@ -1404,22 +1437,36 @@ D3D12DebugManager::~D3D12DebugManager()
     RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 }
 
-string D3D12DebugManager::GetShaderBlob(const char *source, const char *entry,
-                                        const uint32_t compileFlags, const char *profile,
-                                        ID3DBlob **srcblob)
+static uint32_t GetShaderBlobHash(const char *source, const char *entry,
+                                  const uint32_t compileFlags, const char *profile)
 {
   uint32_t hash = strhash(source);
   hash = strhash(entry, hash);
   hash = strhash(profile, hash);
   hash ^= compileFlags;
+  return hash;
+}
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+static const char *GetShaderProfile(ShaderStageType type)
+{
+  switch(type)
   {
-    *srcblob = m_ShaderCache[hash];
-    (*srcblob)->AddRef();
-    return "";
+    case eShaderStage_Vertex: return "vs_5_0";
+    case eShaderStage_Hull: return "hs_5_0";
+    case eShaderStage_Domain: return "ds_5_0";
+    case eShaderStage_Geometry: return "gs_5_0";
+    case eShaderStage_Pixel: return "ps_5_0";
+    case eShaderStage_Compute: return "cs_5_0";
+    default: break;
   }
 
+  return NULL;
+}
+
+// only calls D3DCompile, so this is safe to call from any thread
+static string CompileShaderBlob(const char *source, const char *entry, const uint32_t compileFlags,
+                                const char *profile, ID3DBlob **srcblob)
+{
   HRESULT hr = S_OK;
 
   ID3DBlob *byteBlob = NULL;
@@ -1459,12 +1506,50 @@ string D3D12DebugManager::GetShaderBlob(const char *source, const char *entry,
     SAFE_RELEASE(errBlob);
 
     if(FAILED(hr))
-    {
       SAFE_RELEASE(byteBlob);
-      return errors;
+  }
+
+  *srcblob = byteBlob;
+  return errors;
+}
+
+string D3D12DebugManager::GetShaderBlob(const char *source, const char *entry,
+                                        const uint32_t compileFlags, const char *profile,
+                                        ID3DBlob **srcblob)
+{
+  uint32_t hash = GetShaderBlobHash(source, entry, compileFlags, profile);
+
+  if(m_ShaderCache.find(hash) != m_ShaderCache.end() ||
+     FetchShaderCache(m_ShaderCacheFile, hash, m_ShaderCache, ShaderCache12Callbacks))
+  {
+    *srcblob = m_ShaderCache[hash];
+    (*srcblob)->AddRef();
+    return "";
+  }
+
+  ID3DBlob *byteBlob = NULL;
+  string errors = "";
+  bool precompiled = false;
+
+  {
+    SCOPED_LOCK(m_PrecompiledLock);
+
+    auto it = m_PrecompiledBlobs.find(hash);
+    if(it != m_PrecompiledBlobs.end())
+    {
+      byteBlob = it->second.first;
+      errors = it->second.second;
+      precompiled = true;
+      m_PrecompiledBlobs.erase(it);
     }
   }
 
+  if(!precompiled)
+    errors = CompileShaderBlob(source, entry, compileFlags, profile, &byteBlob);
+
+  if(byteBlob == NULL)
+    return errors;
+
   if(m_CacheShaders)
   {
     m_ShaderCache[hash] = byteBlob;
@@ -1472,12 +1557,157 @@ string D3D12DebugManager::GetShaderBlob(const char *source, const char *entry,
     m_ShaderCacheDirty = true;
   }
 
-  SAFE_RELEASE(errBlob);
-
   *srcblob = byteBlob;
   return errors;
 }
 
+void D3D12DebugManager::PrecompileShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  const char *profile = GetShaderProfile(type);
+
+  if(profile == NULL)
+    return;
+
+  ID3DBlob *blob = NULL;
+  string errors = CompileShaderBlob(source.c_str(), entry.c_str(), compileFlags, profile, &blob);
+
+  uint32_t hash = GetShaderBlobHash(source.c_str(), entry.c_str(), compileFlags, profile);
+
+  SCOPED_LOCK(m_PrecompiledLock);
+
+  // if the same shader was precompiled twice without being built, keep the newest
+  auto it = m_PrecompiledBlobs.find(hash);
+  if(it != m_PrecompiledBlobs.end())
+    SAFE_RELEASE(it->second.first);
+
+  m_PrecompiledBlobs[hash] = std::make_pair(blob, errors);
+}
+
+void D3D12DebugManager::QueueBackgroundShader(const string &source, const char *entry)
+{
+  // nothing to do if it was loaded from the shader cache
+  uint32_t hash =
+      GetShaderBlobHash(source.c_str(), entry, D3DCOMPILE_WARNINGS_ARE_ERRORS, "cs_5_0");
+  if(m_ShaderCache.find(hash) != m_ShaderCache.end() || m_ShaderCacheFile.Contains(hash))
+    return;
+
+  BackgroundShader sh;
+  sh.manager = this;
+  sh.source = source;
+  sh.entry = entry;
+  m_BackgroundShaders.push_back(sh);
+}
+
+void D3D12DebugManager::CompileBackgroundShader(void *param)
+{
+  BackgroundShader *sh = (BackgroundShader *)param;
+  sh->manager->PrecompileShader(sh->source, sh->entry, D3DCOMPILE_WARNINGS_ARE_ERRORS,
+                                eShaderStage_Compute);
+}
+
+string D3D12DebugManager::GetHistogramSource(int resType, int intIdx)
+{
+  string hlsl = string("#define SHADER_RESTYPE ") + ToStr::Get(resType) + "\n";
+  hlsl += string("#define UINT_TEX ") + (intIdx == 1 ? "1" : "0") + "\n";
+  hlsl += string("#define SINT_TEX ") + (intIdx == 2 ? "1" : "0") + "\n";
+  hlsl += m_HistogramHLSL;
+  return hlsl;
+}
+
+void D3D12DebugManager::CreateHistogramPipes(int resType, int intIdx)
+{
+  if(m_HistogramPipesCreated[resType][intIdx])
+    return;
+
+  m_HistogramPipesCreated[resType][intIdx] = true;
+
+  // the shaders should have been compiled in the background by now. Waiting helps with any that
+  // are still queued rather than compiling them again here.
+  m_BackgroundCompiles.Wait();
+
+  // these are our own shaders, so keep them in the on-disk cache like the ones built at startup
+  bool cacheShaders = m_CacheShaders;
+  m_CacheShaders = true;
+
+  D3D12_COMPUTE_PIPELINE_STATE_DESC compPipeDesc;
+  RDCEraseEl(compPipeDesc);
+
+  compPipeDesc.pRootSignature = m_HistogramRootSig;
+
+  string hlsl = GetHistogramSource(resType, intIdx);
+
+  ID3DBlob *tile = NULL;
+  ID3DBlob *histogram = NULL;
+
+  GetShaderBlob(hlsl.c_str(), "RENDERDOC_TileMinMaxCS", D3DCOMPILE_WARNINGS_ARE_ERRORS, "cs_5_0",
+                &tile);
+  GetShaderBlob(hlsl.c_str(), "RENDERDOC_HistogramCS", D3DCOMPILE_WARNINGS_ARE_ERRORS, "cs_5_0",
+                &histogram);
+
+  HRESULT hr = S_OK;
+
+  if(tile)
+  {
+    compPipeDesc.CS.BytecodeLength = tile->GetBufferSize();
+    compPipeDesc.CS.pShaderBytecode = tile->GetBufferPointer();
+
+    hr = m_WrappedDevice->CreateComputePipelineState(&compPipeDesc, __uuidof(ID3D12PipelineState),
+                                                     (void **)&m_TileMinMaxPipe[resType][intIdx]);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create m_TileMinMaxPipe! 0x%08x", hr);
+    }
+  }
+
+  if(histogram)
+  {
+    compPipeDesc.CS.BytecodeLength = histogram->GetBufferSize();
+    compPipeDesc.CS.pShaderBytecode = histogram->GetBufferPointer();
+
+    hr = m_WrappedDevice->CreateComputePipelineState(&compPipeDesc, __uuidof(ID3D12PipelineState),
+                                                     (void **)&m_HistogramPipe[resType][intIdx]);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create m_HistogramPipe! 0x%08x", hr);
+    }
+  }
+
+  SAFE_RELEASE(tile);
+  SAFE_RELEASE(histogram);
+
+  // the result pass doesn't sample the texture, so it's shared between all texture types
+  if(m_ResultMinMaxPipe[intIdx] == NULL)
+  {
+    ID3DBlob *result = NULL;
+
+    hlsl = GetHistogramSource(RESTYPE_TEX1D, intIdx);
+
+    GetShaderBlob(hlsl.c_str(), "RENDERDOC_ResultMinMaxCS", D3DCOMPILE_WARNINGS_ARE_ERRORS,
+                  "cs_5_0", &result);
+
+    if(result)
+    {
+      compPipeDesc.CS.BytecodeLength = result->GetBufferSize();
+      compPipeDesc.CS.pShaderBytecode = result->GetBufferPointer();
+
+      hr = m_WrappedDevice->CreateComputePipelineState(
+          &compPipeDesc, __uuidof(ID3D12PipelineState), (void **)&m_ResultMinMaxPipe[intIdx]);
+
+      if(FAILED(hr))
+      {
+        RDCERR("Couldn't create m_ResultMinMaxPipe! 0x%08x", hr);
+      }
+    }
+
+    SAFE_RELEASE(result);
+  }
+
+  m_CacheShaders = cacheShaders;
+}
+
 D3D12RootSignature D3D12DebugManager::GetRootSig(const void *data, size_t dataSize)
 {
   PFN_D3D12_CREATE_VERSIONED_ROOT_SIGNATURE_DESERIALIZER deserializeRootSig =
@@ -2287,6 +2517,23 @@ void D3D12DebugManager::FreeRTV(D3D12_CPU_DESCRIPTOR_HANDLE handle)
   D3D12NOTIMP("Not freeing RTV's - will run out");
 }
 
+UINT64 D3D12DebugManager::GetUploadResidencyBudget()
+{
+  if(m_pAdapter == NULL)
+    return ~0ULL;
+
+  DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+  HRESULT hr = m_pAdapter->QueryVideoMemoryInfo(0, m_UploadSegment, &info);
+
+  if(FAILED(hr))
+    return ~0ULL;
+
+  if(info.CurrentUsage >= info.Budget)
+    return 0;
+
+  return info.Budget - info.CurrentUsage;
+}
+
 void D3D12DebugManager::PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace,
                                   uint32_t mip, uint32_t sample, FormatComponentType typeHint,
                                   float pixel[4])
@@ -3118,20 +3365,13 @@ void D3D12DebugManager::BuildShader(string source, string entry, const uint32_t
     return;
   }
 
-  char *profile = NULL;
+  const char *profile = GetShaderProfile(type);
 
-  switch(type)
+  if(profile == NULL)
   {
-    case eShaderStage_Vertex: profile = "vs_5_0"; break;
-    case eShaderStage_Hull: profile = "hs_5_0"; break;
-    case eShaderStage_Domain: profile = "ds_5_0"; break;
-    case eShaderStage_Geometry: profile = "gs_5_0"; break;
-    case eShaderStage_Pixel: profile = "ps_5_0"; break;
-    case eShaderStage_Compute: profile = "cs_5_0"; break;
-    default:
-      RDCERR("Unexpected type in BuildShader!");
-      *id = ResourceId();
-      return;
+    RDCERR("Unexpected type in BuildShader!");
+    *id = ResourceId();
+    return;
   }
 
   ID3DBlob *blob = NULL;
@@ -3299,6 +3539,128 @@ void D3D12DebugManager::GetBufferData(ID3D12Resource *buffer, uint64_t offset, u
   m_DebugAlloc->Reset();
 }
 
+void D3D12DebugManager::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                       vector<vector<byte> > &retData)
+{
+  retData.resize(ranges.size());
+
+  struct BufferCopy
+  {
+    size_t idx;
+    WrappedID3D12Resource *buffer;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  vector<BufferCopy> copies;
+
+  for(size_t i = 0; i < ranges.size(); i++)
+  {
+    auto it = WrappedID3D12Resource::GetList().find(ranges[i].buffer);
+
+    if(it == WrappedID3D12Resource::GetList().end())
+    {
+      RDCERR("Getting buffer data for unknown buffer %llu!", ranges[i].buffer);
+      continue;
+    }
+
+    WrappedID3D12Resource *buffer = it->second;
+
+    D3D12_RESOURCE_DESC desc = buffer->GetDesc();
+    D3D12_HEAP_PROPERTIES heapProps;
+    buffer->GetHeapProperties(&heapProps, NULL);
+
+    uint64_t offset = ranges[i].offset;
+    uint64_t length = ranges[i].length;
+
+    if(offset >= desc.Width)
+      continue;
+
+    if(length == 0)
+      length = desc.Width - offset;
+
+    length = RDCMIN(length, desc.Width - offset);
+
+    // anything directly mappable, or that won't fit in the readback buffer, goes on its own.
+    if(heapProps.Type == D3D12_HEAP_TYPE_UPLOAD || heapProps.Type == D3D12_HEAP_TYPE_READBACK ||
+       length > m_ReadbackSize)
+    {
+      GetBufferData(buffer, offset, length, retData[i]);
+      continue;
+    }
+
+    BufferCopy copy = {i, buffer, offset, length};
+    copies.push_back(copy);
+  }
+
+  // pack the rest side by side into the readback buffer, so each fill of it needs only one
+  // submission and one map
+  size_t c = 0;
+  while(c < copies.size())
+  {
+    m_DebugList->Reset(m_DebugAlloc, NULL);
+
+    size_t first = c;
+    uint64_t used = 0;
+
+    for(; c < copies.size() && used + copies[c].length <= m_ReadbackSize; c++)
+    {
+      D3D12_RESOURCE_BARRIER barrier = {};
+
+      barrier.Transition.pResource = copies[c].buffer;
+      barrier.Transition.StateBefore =
+          m_WrappedDevice->GetSubresourceStates(GetResID(copies[c].buffer))[0];
+      barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+
+      if(barrier.Transition.StateBefore != D3D12_RESOURCE_STATE_COPY_SOURCE)
+        m_DebugList->ResourceBarrier(1, &barrier);
+
+      m_DebugList->CopyBufferRegion(m_ReadbackBuffer, used, copies[c].buffer, copies[c].offset,
+                                    copies[c].length);
+
+      if(barrier.Transition.StateBefore != D3D12_RESOURCE_STATE_COPY_SOURCE)
+      {
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+
+        m_DebugList->ResourceBarrier(1, &barrier);
+      }
+
+      used += copies[c].length;
+    }
+
+    m_DebugList->Close();
+
+    ID3D12CommandList *l = m_DebugList;
+    m_WrappedDevice->GetQueue()->ExecuteCommandLists(1, &l);
+    m_WrappedDevice->GPUSync();
+    m_DebugAlloc->Reset();
+
+    D3D12_RANGE range = {0, (size_t)used};
+
+    byte *data = NULL;
+    HRESULT hr = m_ReadbackBuffer->Map(0, &range, (void **)&data);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to map bufferdata buffer %08x", hr);
+      return;
+    }
+
+    uint64_t readOffs = 0;
+    for(size_t i = first; i < c; i++)
+    {
+      vector<byte> &ret = retData[copies[i].idx];
+      ret.resize((size_t)copies[i].length);
+      memcpy(&ret[0], data + readOffs, (size_t)copies[i].length);
+      readOffs += copies[i].length;
+    }
+
+    range.End = 0;
+
+    m_ReadbackBuffer->Unmap(0, &range);
+  }
+}
+
 byte *D3D12DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                         const GetTextureDataParams &params, size_t &dataSize)
 {
@@ -3349,9 +3711,15 @@ byte *D3D12DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
   if(params.remap)
   {
-    // force readback texture to RGBA8 unorm
-    copyDesc.Format = IsSRGBFormat(copyDesc.Format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
-                                                    : DXGI_FORMAT_R8G8B8A8_UNORM;
+    RDCASSERT(params.remap == eRemap_RGBA8 || params.remap == eRemap_RGBA32);
+
+    // force readback texture to RGBA8 unorm, or RGBA32 float for anything needing more precision.
+    // The proxy packs that down further if it needs to
+    if(params.remap == eRemap_RGBA32)
+      copyDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    else
+      copyDesc.Format = IsSRGBFormat(copyDesc.Format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                                                      : DXGI_FORMAT_R8G8B8A8_UNORM;
     // force to 1 array slice, 1 mip
     copyDesc.DepthOrArraySize = 1;
     copyDesc.MipLevels = 1;
@@ -3373,7 +3741,10 @@ byte *D3D12DebugManager::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint3
 
     m_width = uint32_t(copyDesc.Width);
     m_height = copyDesc.Height;
-    m_BBFmtIdx = IsSRGBFormat(copyDesc.Format) ? RGBA8_SRGB_BACKBUFFER : RGBA8_BACKBUFFER;
+    if(params.remap == eRemap_RGBA32)
+      m_BBFmtIdx = RGBA32_BACKBUFFER;
+    else
+      m_BBFmtIdx = IsSRGBFormat(copyDesc.Format) ? RGBA8_SRGB_BACKBUFFER : RGBA8_BACKBUFFER;
 
     m_WrappedDevice->CreateRenderTargetView(remapTexture, NULL, GetCPUHandle(GET_TEX_RTV));
 
@@ -3953,7 +4324,9 @@ void D3D12DebugManager::InitPostVSBuffers(uint32_t eventID)
       if(drawcall->baseVertex < 0)
         idxclamp = uint32_t(-drawcall->baseVertex);
 
-      // grab all unique vertex indices referenced
+      vector<uint32_t> remapped;
+      remapped.reserve(numIndices + 1);
+
       for(uint32_t i = 0; i < numIndices; i++)
       {
         uint32_t i32 = rs.ibuffer.bytewidth == 2 ? uint32_t(idx16[i]) : idx32[i];
@@ -3966,18 +4339,13 @@ void D3D12DebugManager::InitPostVSBuffers(uint32_t eventID)
         else if(drawcall->baseVertex > 0)
           i32 += drawcall->baseVertex;
 
-        auto it = std::lower_bound(indices.begin(), indices.end(), i32);
-
-        if(it != indices.end() && *it == i32)
-          continue;
-
-        indices.insert(it, i32);
+        remapped.push_back(i32);
       }
 
       // if we read out of bounds, we'll also have a 0 index being referenced
-      // (as 0 is read). Don't insert 0 if we already have 0 though
-      if(numIndices < drawcall->numIndices && (indices.empty() || indices[0] != 0))
-        indices.insert(indices.begin(), 0);
+      // (as 0 is read).
+      if(numIndices < drawcall->numIndices)
+        remapped.push_back(0);
 
       // An index buffer could be something like: 500, 501, 502, 501, 503, 502
       // in which case we can't use the existing index buffer without filling 499 slots of vertex
@@ -3989,15 +4357,7 @@ void D3D12DebugManager::InitPostVSBuffers(uint32_t eventID)
       // We just stream-out a tightly packed list of unique indices, and then remap the index buffer
       // so that what did point to 500 points to 0 (accounting for rebasing), and what did point
       // to 510 now points to 3 (accounting for the unique sort).
-
-      // we use a map here since the indices may be sparse. Especially considering if an index
-      // is 'invalid' like 0xcccccccc then we don't want an array of 3.4 billion entries.
-      map<uint32_t, size_t> indexRemap;
-      for(size_t i = 0; i < indices.size(); i++)
-      {
-        // by definition, this index will only appear once in indices[]
-        indexRemap[indices[i]] = i;
-      }
+      CompactIndices(remapped, indices);
 
       if(indices.size() > m_SOPatchedIndexBufferSize / sizeof(uint32_t))
       {
@@ -4042,20 +4402,10 @@ void D3D12DebugManager::InitPostVSBuffers(uint32_t eventID)
       // vertex buffer
       for(uint32_t i = 0; i < numIndices; i++)
       {
-        uint32_t i32 = rs.ibuffer.bytewidth == 2 ? uint32_t(idx16[i]) : idx32[i];
-
-        // apply baseVertex but clamp to 0 (don't allow index to become negative)
-        if(i32 < idxclamp)
-          i32 = 0;
-        else if(drawcall->baseVertex < 0)
-          i32 -= idxclamp;
-        else if(drawcall->baseVertex > 0)
-          i32 += drawcall->baseVertex;
-
         if(rs.ibuffer.bytewidth == 2)
-          idx16[i] = uint16_t(indexRemap[i32]);
+          idx16[i] = uint16_t(remapped[i]);
         else
-          idx32[i] = uint32_t(indexRemap[i32]);
+          idx32[i] = remapped[i];
       }
 
       idxBuf = NULL;
@@ -4701,6 +5051,80 @@ void D3D12DebugManager::InitPostVSBuffers(uint32_t eventID)
   SAFE_RELEASE(soSig);
 }
 
+static uint64_t GetPostVSDataSize(const D3D12PostVSData &data)
+{
+  ID3D12Resource *bufs[] = {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf};
+
+  uint64_t ret = 0;
+
+  for(size_t i = 0; i < ARRAY_COUNT(bufs); i++)
+  {
+    if(bufs[i] == NULL)
+      continue;
+
+    D3D12_RESOURCE_DESC desc = bufs[i]->GetDesc();
+    ret += desc.Width;
+  }
+
+  return ret;
+}
+
+uint64_t D3D12DebugManager::GetPostVSCacheSize()
+{
+  uint64_t ret = 0;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    ret += GetPostVSDataSize(it->second);
+
+  return ret;
+}
+
+void D3D12DebugManager::TrimPostVSCache(uint64_t budget, uint32_t eventID)
+{
+  if(m_PostVSAlias.find(eventID) != m_PostVSAlias.end())
+    eventID = m_PostVSAlias[eventID];
+
+  uint64_t total = 0;
+
+  // the events furthest from the current one are evicted first, as they're the least likely to
+  // be looked at again soon
+  vector<pair<uint32_t, uint32_t> > candidates;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    uint64_t size = GetPostVSDataSize(it->second);
+    total += size;
+
+    if(it->first != eventID && size > 0)
+    {
+      uint32_t dist = it->first > eventID ? it->first - eventID : eventID - it->first;
+      candidates.push_back(std::make_pair(dist, it->first));
+    }
+  }
+
+  if(total <= budget || candidates.empty())
+    return;
+
+  // the buffers could still be referenced by work in flight
+  m_WrappedDevice->GPUSync();
+
+  std::sort(candidates.rbegin(), candidates.rend());
+
+  for(size_t i = 0; i < candidates.size() && total > budget; i++)
+  {
+    D3D12PostVSData &data = m_PostVSData[candidates[i].second];
+
+    total -= GetPostVSDataSize(data);
+
+    SAFE_RELEASE(data.vsout.buf);
+    SAFE_RELEASE(data.vsout.idxBuf);
+    SAFE_RELEASE(data.gsout.buf);
+    SAFE_RELEASE(data.gsout.idxBuf);
+
+    m_PostVSData.erase(candidates[i].second);
+  }
+}
+
 MeshFormat D3D12DebugManager::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
 {
   // go through any aliasing
@@ -6448,6 +6872,304 @@ void D3D12DebugManager::PrepareTextureSampling(ID3D12Resource *resource,
   }
 }
 
+bool D3D12DebugManager::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                            uint32_t mip, uint32_t sample,
+                                            FormatComponentType typeHint)
+{
+  if(input >= ARRAY_COUNT(m_TexDiffInput) || m_TexDiffResultBuffer == NULL)
+    return false;
+
+  ID3D12Resource *resource = WrappedID3D12Resource::GetList()[texid];
+
+  if(resource == NULL)
+    return false;
+
+  D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
+
+  DXGI_FORMAT fmt = GetTypedFormat(resourceDesc.Format, typeHint);
+
+  // raw output of integer textures is their bits, which can't be subtracted as floats
+  if(IsUIntFormat(fmt) || IsIntFormat(fmt))
+    return false;
+
+  D3D12_RESOURCE_DESC texDesc = {};
+  texDesc.Alignment = 0;
+  texDesc.DepthOrArraySize = 1;
+  texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+  texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+  texDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+  texDesc.Width = RDCMAX(1ULL, resourceDesc.Width >> mip);
+  texDesc.Height = RDCMAX(1U, resourceDesc.Height >> mip);
+  texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+  texDesc.MipLevels = 1;
+  texDesc.SampleDesc.Count = 1;
+  texDesc.SampleDesc.Quality = 0;
+
+  D3D12_RESOURCE_DESC oldDesc = {};
+
+  if(m_TexDiffInput[input])
+    oldDesc = m_TexDiffInput[input]->GetDesc();
+
+  if(oldDesc.Width != texDesc.Width || oldDesc.Height != texDesc.Height)
+  {
+    SAFE_RELEASE(m_TexDiffInput[input]);
+
+    D3D12_HEAP_PROPERTIES heapProps;
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    HRESULT hr = m_WrappedDevice->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &texDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, NULL,
+        __uuidof(ID3D12Resource), (void **)&m_TexDiffInput[input]);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff input tex, HRESULT: 0x%08x", hr);
+      return false;
+    }
+  }
+
+  D3D12_CPU_DESCRIPTOR_HANDLE rtv = GetCPUHandle(RTVSlot(TEXDIFF_INPUT_RTVS + input));
+
+  m_WrappedDevice->CreateRenderTargetView(m_TexDiffInput[input], NULL, rtv);
+
+  ID3D12GraphicsCommandList *list = m_WrappedDevice->GetNewList();
+
+  float clr[] = {0.0f, 0.0f, 0.0f, 0.0f};
+  list->ClearRenderTargetView(rtv, clr, 0, NULL);
+
+  list->Close();
+
+  // render the subresource 1:1 with raw output, which resolves multisampling, depth and any
+  // texture type down to floats in a plain 2D texture
+  TextureDisplay disp;
+  disp.Red = disp.Green = disp.Blue = disp.Alpha = true;
+  disp.FlipY = false;
+  disp.offx = 0.0f;
+  disp.offy = 0.0f;
+  disp.CustomShader = ResourceId();
+  disp.texid = texid;
+  disp.typeHint = typeHint;
+  disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector(0, 0, 0, 0);
+  disp.HDRMul = -1.0f;
+  disp.linearDisplayAsGamma = false;
+  disp.mip = mip;
+  disp.sampleIdx = sample;
+  disp.overlay = eTexOverlay_None;
+  disp.rangemin = 0.0f;
+  disp.rangemax = 1.0f;
+  disp.rawoutput = true;
+  disp.scale = 1.0f;
+  disp.sliceFace = sliceFace;
+
+  int oldW = GetWidth(), oldH = GetHeight();
+
+  SetOutputDimensions((int)texDesc.Width, (int)texDesc.Height, texDesc.Format);
+
+  bool ret = RenderTextureInternal(rtv, disp, false);
+
+  SetOutputDimensions(oldW, oldH, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+
+  return ret;
+}
+
+bool D3D12DebugManager::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  RDCEraseEl(result);
+
+  if(m_TexDiffInput[0] == NULL || m_TexDiffInput[1] == NULL || m_TexDiffResultBuffer == NULL)
+    return false;
+
+  if(!m_TexDiffPipeCreated)
+  {
+    m_TexDiffPipeCreated = true;
+
+    ID3DBlob *diff = NULL;
+
+    // the diff doesn't sample, so any texture type will do for the source
+    string hlsl = GetHistogramSource(RESTYPE_TEX1D, 0);
+
+    GetShaderBlob(hlsl.c_str(), "RENDERDOC_TexDiffCS", D3DCOMPILE_WARNINGS_ARE_ERRORS, "cs_5_0",
+                  &diff);
+
+    if(diff)
+    {
+      D3D12_COMPUTE_PIPELINE_STATE_DESC compPipeDesc;
+      RDCEraseEl(compPipeDesc);
+
+      compPipeDesc.pRootSignature = m_HistogramRootSig;
+      compPipeDesc.CS.BytecodeLength = diff->GetBufferSize();
+      compPipeDesc.CS.pShaderBytecode = diff->GetBufferPointer();
+
+      HRESULT hr = m_WrappedDevice->CreateComputePipelineState(
+          &compPipeDesc, __uuidof(ID3D12PipelineState), (void **)&m_TexDiffPipe);
+
+      if(FAILED(hr))
+      {
+        RDCERR("Couldn't create m_TexDiffPipe! 0x%08x", hr);
+      }
+    }
+
+    SAFE_RELEASE(diff);
+  }
+
+  if(m_TexDiffPipe == NULL)
+    return false;
+
+  D3D12_RESOURCE_DESC inDesc[2] = {m_TexDiffInput[0]->GetDesc(), m_TexDiffInput[1]->GetDesc()};
+
+  D3D12_RESOURCE_DESC texDesc = inDesc[0];
+  texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+  texDesc.Width = RDCMIN(inDesc[0].Width, inDesc[1].Width);
+  texDesc.Height = RDCMIN(inDesc[0].Height, inDesc[1].Height);
+
+  D3D12_RESOURCE_DESC oldDesc = {};
+
+  if(m_TexDiffTex)
+    oldDesc = m_TexDiffTex->GetDesc();
+
+  if(oldDesc.Width != texDesc.Width || oldDesc.Height != texDesc.Height)
+  {
+    SAFE_RELEASE(m_TexDiffTex);
+
+    D3D12_HEAP_PROPERTIES heapProps;
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    // left in UAV state, texture display transitions it as needed like any other texture
+    HRESULT hr = m_WrappedDevice->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &texDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL,
+        __uuidof(ID3D12Resource), (void **)&m_TexDiffTex);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Failed to create diff tex, HRESULT: 0x%08x", hr);
+      m_TexDiffResourceId = ResourceId();
+      return false;
+    }
+
+    m_TexDiffResourceId = GetResID(m_TexDiffTex);
+  }
+
+  uint32_t w = (uint32_t)texDesc.Width;
+  uint32_t h = texDesc.Height;
+
+  D3D12_CPU_DESCRIPTOR_HANDLE srv = GetCPUHandle(TEXDIFF_SRVS);
+
+  for(int i = 0; i < 2; i++)
+  {
+    m_WrappedDevice->CreateShaderResourceView(m_TexDiffInput[i], NULL, srv);
+    srv.ptr += sizeof(D3D12Descriptor);
+  }
+
+  m_WrappedDevice->CreateUnorderedAccessView(m_TexDiffTex, NULL, NULL, GetCPUHandle(TEXDIFF_UAVS));
+
+  TexDiffCBufferData cdata;
+  RDCEraseEl(cdata);
+
+  cdata.DiffWidth = w;
+  cdata.DiffHeight = h;
+  cdata.DiffThreshold = threshold;
+
+  {
+    ID3D12GraphicsCommandList *list = m_WrappedDevice->GetNewList();
+
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+
+    for(int i = 0; i < 2; i++)
+    {
+      barriers[i].Transition.pResource = m_TexDiffInput[i];
+      barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+      barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    }
+
+    list->ResourceBarrier(2, barriers);
+
+    list->SetPipelineState(m_TexDiffPipe);
+
+    list->SetComputeRootSignature(m_HistogramRootSig);
+
+    ID3D12DescriptorHeap *heaps[] = {cbvsrvuavHeap, samplerHeap};
+    list->SetDescriptorHeaps(2, heaps);
+
+    UINT zeroes[] = {0, 0, 0, 0};
+    list->ClearUnorderedAccessViewUint(GetGPUHandle(TEXDIFF_RESULT_CLEAR_UAV),
+                                       GetUAVClearHandle(TEXDIFF_RESULT_CLEAR_UAV),
+                                       m_TexDiffResultBuffer, zeroes, 0, NULL);
+
+    list->SetComputeRootConstantBufferView(0, UploadConstants(&cdata, sizeof(cdata)));
+    list->SetComputeRootDescriptorTable(1, GetGPUHandle(TEXDIFF_SRVS));
+    list->SetComputeRootDescriptorTable(2, samplerHeap->GetGPUDescriptorHandleForHeapStart());
+    list->SetComputeRootDescriptorTable(3, GetGPUHandle(TEXDIFF_UAVS));
+
+    list->Dispatch((w + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP,
+                   (h + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP, 1);
+
+    D3D12_RESOURCE_BARRIER resultBarriers[3] = {};
+
+    // finish the UAV work, and transition to copy.
+    resultBarriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    resultBarriers[0].UAV.pResource = m_TexDiffTex;
+    resultBarriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    resultBarriers[1].UAV.pResource = m_TexDiffResultBuffer;
+    resultBarriers[2].Transition.pResource = m_TexDiffResultBuffer;
+    resultBarriers[2].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    resultBarriers[2].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+
+    list->ResourceBarrier(3, resultBarriers);
+
+    list->CopyBufferRegion(m_ReadbackBuffer, 0, m_TexDiffResultBuffer, 0, sizeof(uint32_t) * 8);
+
+    // transition everything back for next time
+    std::swap(resultBarriers[2].Transition.StateBefore, resultBarriers[2].Transition.StateAfter);
+
+    list->ResourceBarrier(1, &resultBarriers[2]);
+
+    for(int i = 0; i < 2; i++)
+      std::swap(barriers[i].Transition.StateBefore, barriers[i].Transition.StateAfter);
+
+    list->ResourceBarrier(2, barriers);
+
+    list->Close();
+
+    m_WrappedDevice->ExecuteLists();
+    m_WrappedDevice->FlushLists();
+  }
+
+  D3D12_RANGE range = {0, sizeof(uint32_t) * 8};
+
+  uint32_t *stats = NULL;
+  HRESULT hr = m_ReadbackBuffer->Map(0, &range, (void **)&stats);
+
+  if(FAILED(hr))
+  {
+    RDCERR("Failed to map bufferdata buffer %08x", hr);
+    return false;
+  }
+
+  RDCCOMPILE_ASSERT(sizeof(result.maxError) == sizeof(uint32_t) * 4,
+                    "max error doesn't match shader");
+  memcpy(result.maxError, stats, sizeof(result.maxError));
+
+  result.numDifferent = stats[4];
+
+  range.End = 0;
+
+  m_ReadbackBuffer->Unmap(0, &range);
+
+  result.diffTexture = m_TexDiffResourceId;
+  result.width = w;
+  result.height = h;
+
+  return true;
+}
+
 bool D3D12DebugManager::GetMinMax(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                                   FormatComponentType typeHint, float *minval, float *maxval)
 {
@@ -6499,6 +7221,8 @@ bool D3D12DebugManager::GetMinMax(ResourceId texid, uint32_t sliceFace, uint32_t
   int resType = 0;
   PrepareTextureSampling(resource, typeHint, resType, barriers);
 
+  CreateHistogramPipes(resType, intIdx);
+
   {
     ID3D12GraphicsCommandList *list = m_WrappedDevice->GetNewList();
 
@@ -6685,6 +7409,8 @@ bool D3D12DebugManager::GetHistogram(ResourceId texid, uint32_t sliceFace, uint3
   int resType = 0;
   PrepareTextureSampling(resource, typeHint, resType, barriers);
 
+  CreateHistogramPipes(resType, intIdx);
+
   {
     ID3D12GraphicsCommandList *list = m_WrappedDevice->GetNewList();
 
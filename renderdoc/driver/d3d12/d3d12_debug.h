@@ -25,6 +25,8 @@
 #pragma once
 
 #include "api/replay/renderdoc_replay.h"
+#include "common/job_system.h"
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "driver/shaders/dxbc/dxbc_debug.h"
 #include "replay/replay_driver.h"
@@ -83,6 +85,10 @@ public:
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
 
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
+
   ResourceId RenderOverlay(ResourceId texid, FormatComponentType typeHint,
                            TextureDisplayOverlay overlay, uint32_t eventID,
                            const vector<uint32_t> &passEvents);
@@ -102,13 +108,19 @@ public:
   // indicates that EID alias is the same as eventID
   void AliasPostVSBuffers(uint32_t eventID, uint32_t alias) { m_PostVSAlias[alias] = eventID; }
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
+  uint64_t GetPostVSCacheSize();
+  // frees cached post-VS data for other events until the cache fits in budget bytes
+  void TrimPostVSCache(uint64_t budget, uint32_t eventID);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t length, vector<byte> &retData);
   void GetBufferData(ID3D12Resource *buff, uint64_t offset, uint64_t length, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
 
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
+  void PrecompileShader(string source, string entry, const uint32_t compileFlags,
+                        ShaderStageType type);
   void BuildShader(string source, string entry, const uint32_t compileFlags, ShaderStageType type,
                    ResourceId *id, string *errors);
 
@@ -123,6 +135,10 @@ public:
   static ID3DBlob *MakeRootSig(const D3D12RootSignature &rootsig);
 
   ID3DBlob *GetOverdrawWritePS() { return m_QuadOverdrawWritePS; }
+  // how many more bytes can be made resident in the memory segment that upload heaps live in,
+  // before going over the OS's budget for this process. Returns ~0ULL if it can't be queried.
+  UINT64 GetUploadResidencyBudget();
+
 private:
   struct OutputWindow
   {
@@ -174,6 +190,10 @@ private:
     PICK_VB_SRV,
     PICK_RESULT_UAV,
     PICK_RESULT_CLEAR_UAV,
+
+    TEXDIFF_SRVS,
+    TEXDIFF_UAVS = TEXDIFF_SRVS + 2,
+    TEXDIFF_RESULT_CLEAR_UAV = TEXDIFF_UAVS + 3,
   };
 
   enum RTVSlot
@@ -182,7 +202,8 @@ private:
     CUSTOM_SHADER_RTV,
     OVERLAY_RTV,
     GET_TEX_RTV,
-    FIRST_WIN_RTV,
+    TEXDIFF_INPUT_RTVS,
+    FIRST_WIN_RTV = TEXDIFF_INPUT_RTVS + 2,
   };
 
   enum DSVSlot
@@ -275,14 +296,23 @@ private:
   ID3D12PipelineState *m_MeshPickPipe;
 
   ID3D12RootSignature *m_HistogramRootSig;
-  // one per texture type, one per int/uint/float
+  // one per texture type, one per int/uint/float. Created on first use by CreateHistogramPipes
   ID3D12PipelineState *m_TileMinMaxPipe[10][3];
   ID3D12PipelineState *m_HistogramPipe[10][3];
+  bool m_HistogramPipesCreated[10][3];
   // one per int/uint/float
   ID3D12PipelineState *m_ResultMinMaxPipe[3];
+  string m_HistogramHLSL;
   ID3D12Resource *m_MinMaxResultBuffer;
   ID3D12Resource *m_MinMaxTileBuffer;
 
+  // texture diff inputs are raw RGBA32F renders of the compared subresources, created on demand.
+  // The pipeline is created on first use like the histogram pipes
+  ID3D12PipelineState *m_TexDiffPipe;
+  bool m_TexDiffPipeCreated;
+  ID3D12Resource *m_TexDiffInput[2];
+  ID3D12Resource *m_TexDiffResultBuffer;
+
   ID3D12GraphicsCommandList *m_DebugList;
   ID3D12CommandAllocator *m_DebugAlloc;
   ID3D12Resource *m_ReadbackBuffer;
@@ -305,6 +335,28 @@ private:
 
   bool m_ShaderCacheDirty, m_CacheShaders;
   map<uint32_t, ID3DBlob *> m_ShaderCache;
+  ShaderCacheFile m_ShaderCacheFile;
+
+  // blobs and errors compiled off-thread by PrecompileShader, consumed by the next GetShaderBlob
+  Threading::CriticalSection m_PrecompiledLock;
+  map<uint32_t, pair<ID3DBlob *, string> > m_PrecompiledBlobs;
+
+  // built-in shaders that aren't needed until first use, compiled by jobs in the background after
+  // load and picked up by GetShaderBlob through m_PrecompiledBlobs.
+  struct BackgroundShader
+  {
+    D3D12DebugManager *manager;
+    string source;
+    string entry;
+  };
+  vector<BackgroundShader> m_BackgroundShaders;
+  Threading::JobGroup m_BackgroundCompiles;
+
+  void QueueBackgroundShader(const string &source, const char *entry);
+  static void CompileBackgroundShader(void *param);
+
+  string GetHistogramSource(int resType, int intIdx);
+  void CreateHistogramPipes(int resType, int intIdx);
 
   void FillCBufferVariables(const string &prefix, size_t &offset, bool flatten,
                             const vector<DXBC::CBufferVariable> &invars,
@@ -406,6 +458,10 @@ private:
   ID3D12Resource *m_CustomShaderTex;
   ResourceId m_CustomShaderResourceId;
 
+  // the difference between two diff inputs, displayed like any other texture
+  ID3D12Resource *m_TexDiffTex;
+  ResourceId m_TexDiffResourceId;
+
   // simple cache for when we need buffer data for highlighting
   // vertices, typical use will be lots of vertices in the same
   // mesh, not jumping back and forth much between meshes.
@@ -438,6 +494,8 @@ private:
   ID3D12Device *m_Device;
 
   IDXGIFactory4 *m_pFactory;
+  IDXGIAdapter3 *m_pAdapter;
+  DXGI_MEMORY_SEGMENT_GROUP m_UploadSegment;
 
   D3D12ResourceManager *m_ResourceManager;
 };
@@ -54,6 +54,17 @@ D3D12InitParams::D3D12InitParams()
   MinimumFeatureLevel = D3D_FEATURE_LEVEL_11_0;
 }
 
+// handling for these versions is scattered throughout the code (as relevant to enable/disable bits
+// of serialisation and set some defaults if necessary).
+// Here we list which non-current versions we support, and what changed
+const uint32_t D3D12InitParams::D3D12_OLD_VERSIONS[D3D12InitParams::D3D12_NUM_SUPPORTED_OLD_VERSIONS] = {
+    // from 0x1 to 0x2, descriptor heap initial states only contain the descriptors that were
+    // defined. Old logs contain every descriptor, which is read the same way.
+    0x000001,
+    // from 0x2 to 0x3, the capture footer stores any event timings recorded while capturing
+    0x000002,
+};
+
 ReplayCreateStatus D3D12InitParams::Serialise()
 {
   Serialiser *localSerialiser = GetSerialiser();
@@ -63,8 +74,25 @@ ReplayCreateStatus D3D12InitParams::Serialise()
 
   if(ver != D3D12_SERIALISE_VERSION)
   {
-    RDCERR("Incompatible D3D12 serialise version, expected %d got %d", D3D12_SERIALISE_VERSION, ver);
-    return eReplayCreate_APIIncompatibleVersion;
+    bool oldsupported = false;
+    for(uint32_t i = 0; i < D3D12_NUM_SUPPORTED_OLD_VERSIONS; i++)
+    {
+      if(ver == D3D12_OLD_VERSIONS[i])
+      {
+        oldsupported = true;
+        RDCWARN(
+            "Old D3D12 serialise version %d, latest is %d. Loading with possibly degraded "
+            "features/support.",
+            ver, D3D12_SERIALISE_VERSION);
+      }
+    }
+
+    if(!oldsupported)
+    {
+      RDCERR("Incompatible D3D12 serialise version, expected %d got %d", D3D12_SERIALISE_VERSION,
+             ver);
+      return eReplayCreate_APIIncompatibleVersion;
+    }
   }
 
   localSerialiser->Serialise("MinimumFeatureLevel", MinimumFeatureLevel);
@@ -185,6 +213,11 @@ WrappedID3D12Device::WrappedID3D12Device(ID3D12Device *realDevice, D3D12InitPara
 
   WrappedID3D12Resource::m_List = NULL;
 
+  m_MappedResources = NULL;
+
+  m_PipelineLibrary = NULL;
+  m_PipelineLibraryDirty = 0;
+
   // refcounters implicitly construct with one reference, but we don't start with any soft
   // references.
   m_SoftRefCounter.Release();
@@ -198,6 +231,8 @@ WrappedID3D12Device::WrappedID3D12Device(ID3D12Device *realDevice, D3D12InitPara
   m_Replay.SetDevice(this);
 
   m_AppControlledCapture = false;
+  m_CapSpanFrames = 0;
+  m_CapSpanWindow = NULL;
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
   tempMemoryTLSSlot = Threading::AllocateTLSSlot();
@@ -379,6 +414,7 @@ WrappedID3D12Device::~WrappedID3D12Device()
 
   SAFE_DELETE(m_ResourceManager);
 
+  SAFE_RELEASE(m_PipelineLibrary);
   SAFE_RELEASE(m_pDevice1);
 
   SAFE_RELEASE(m_pInfoQueue);
@@ -617,11 +653,18 @@ void WrappedID3D12Device::FirstFrame(WrappedIDXGISwapChain4 *swap)
   DXGI_SWAP_CHAIN_DESC swapdesc = swap->GetDescWithHWND();
 
   // if we have to capture the first frame, begin capturing immediately
-  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0))
+  uint32_t spanFrames = 0;
+  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0, spanFrames))
   {
     RenderDoc::Inst().StartFrameCapture((ID3D12Device *)this, swapdesc.OutputWindow);
 
     m_AppControlledCapture = false;
+
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = swapdesc.OutputWindow;
+    }
   }
 }
 
@@ -838,9 +881,7 @@ IUnknown *WrappedID3D12Device::WrapSwapchainBuffer(WrappedIDXGISwapChain4 *swap,
 
 void WrappedID3D12Device::Map(WrappedID3D12Resource *Resource, UINT Subresource)
 {
-  MapState map;
-  map.res = Resource;
-  map.subres = Subresource;
+  D3D12ResourceRecord::MapData &map = Resource->GetResourceRecord()->m_Map[Subresource];
 
   D3D12_RESOURCE_DESC desc = Resource->GetDesc();
 
@@ -848,29 +889,46 @@ void WrappedID3D12Device::Map(WrappedID3D12Resource *Resource, UINT Subresource)
 
   {
     SCOPED_LOCK(m_MapsLock);
-    m_Maps.push_back(map);
+
+    Resource->m_MappedCount++;
+
+    if(Resource->m_MappedCount == 1)
+    {
+      Resource->m_MappedPrev = NULL;
+      Resource->m_MappedNext = m_MappedResources;
+      if(m_MappedResources)
+        m_MappedResources->m_MappedPrev = Resource;
+      m_MappedResources = Resource;
+    }
   }
 }
 
 void WrappedID3D12Device::Unmap(WrappedID3D12Resource *Resource, UINT Subresource, byte *mapPtr,
                                 const D3D12_RANGE *pWrittenRange)
 {
-  MapState map = {};
+  D3D12ResourceRecord::MapData &map = Resource->GetResourceRecord()->m_Map[Subresource];
+
   {
     SCOPED_LOCK(m_MapsLock);
-    for(auto it = m_Maps.begin(); it != m_Maps.end(); ++it)
+
+    Resource->m_MappedCount--;
+
+    if(Resource->m_MappedCount == 0)
     {
-      if(it->res == Resource && it->subres == Subresource)
-      {
-        map = *it;
-        m_Maps.erase(it);
-        break;
-      }
+      if(Resource->m_MappedPrev)
+        Resource->m_MappedPrev->m_MappedNext = Resource->m_MappedNext;
+      else
+        m_MappedResources = Resource->m_MappedNext;
+
+      if(Resource->m_MappedNext)
+        Resource->m_MappedNext->m_MappedPrev = Resource->m_MappedPrev;
+
+      Resource->m_MappedPrev = Resource->m_MappedNext = NULL;
     }
   }
 
-  if(map.res == NULL)
-    return;
+  WriteWatch::End(map.writeWatch);
+  map.writeWatch = 0;
 
   bool capframe = false;
   {
@@ -887,6 +945,29 @@ void WrappedID3D12Device::Unmap(WrappedID3D12Resource *Resource, UINT Subresourc
     MapDataWrite(Resource, Subresource, mapPtr, range);
 }
 
+void WrappedID3D12Device::GetMappedResources(const set<ResourceId> &refdIDs,
+                                             const vector<D3D12ResourceRecord *> &refdCmds,
+                                             vector<WrappedID3D12Resource *> &maps)
+{
+  SCOPED_LOCK(m_MapsLock);
+
+  for(WrappedID3D12Resource *res = m_MappedResources; res; res = res->m_MappedNext)
+  {
+    // only need to flush memory that could affect this submitted batch of work, either through a
+    // bound descriptor or directly from one of the command lists
+    bool refd = refdIDs.find(res->GetResourceID()) != refdIDs.end();
+
+    for(size_t c = 0; !refd && c < refdCmds.size(); c++)
+      refd = refdCmds[c]->HasFrameReference(res->GetResourceRecord());
+
+    if(refd)
+      maps.push_back(res);
+    else
+      RDCDEBUG("Map of memory %llu not referenced in this queue - not flushing",
+               res->GetResourceID());
+  }
+}
+
 bool WrappedID3D12Device::Serialise_MapDataWrite(Serialiser *localSerialiser,
                                                  WrappedID3D12Resource *Resource, UINT Subresource,
                                                  byte *mapPtr, D3D12_RANGE range)
@@ -1108,7 +1189,7 @@ HRESULT WrappedID3D12Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
   if((Flags & DXGI_PRESENT_TEST) != 0)
     return S_OK;
 
-  if(m_State == WRITING_IDLE)
+  if(m_State == WRITING_IDLE || RenderDoc::Inst().IsRingFrameActive())
     RenderDoc::Inst().Tick();
 
   m_FrameCounter++;    // first present becomes frame #1, this function is at the end of the frame
@@ -1132,9 +1213,7 @@ HRESULT WrappedID3D12Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
 
   if(m_State == WRITING_IDLE)
   {
-    uint32_t overlay = RenderDoc::Inst().GetOverlayBits();
-
-    if(overlay & eRENDERDOC_Overlay_Enabled)
+    if(RenderDoc::Inst().ShouldDrawOverlay())
     {
       SwapPresentInfo &swapInfo = m_SwapChains[swap];
       D3D12_CPU_DESCRIPTOR_HANDLE rtv = swapInfo.rtvs[swapInfo.lastPresentedBuffer];
@@ -1178,15 +1257,36 @@ HRESULT WrappedID3D12Device::Present(WrappedIDXGISwapChain4 *swap, UINT SyncInte
 
   RenderDoc::Inst().SetCurrentDriver(RDC_D3D12);
 
-  // kill any current capture that isn't application defined
+  // kill any current capture that isn't application defined, unless it's still recording a run of
+  // frames on this window, in which case the frame boundary is recorded and the capture continues
   if(m_State == WRITING_CAPFRAME && !m_AppControlledCapture)
-    RenderDoc::Inst().EndFrameCapture((ID3D12Device *)this, swapdesc.OutputWindow);
+  {
+    if(m_CapSpanFrames > 0 && m_CapSpanWindow == swapdesc.OutputWindow)
+    {
+      m_CapSpanFrames--;
+      RecordFrameBoundary(
+          (ID3D12Resource *)swap->GetBackbuffers()[m_SwapChains[swap].lastPresentedBuffer]);
+    }
+    else
+    {
+      m_CapSpanFrames = 0;
+      RenderDoc::Inst().EndFrameCapture((ID3D12Device *)this, swapdesc.OutputWindow);
+    }
+  }
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && m_State == WRITING_IDLE)
+  uint32_t spanFrames = 0;
+  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter, spanFrames) && m_State == WRITING_IDLE)
   {
     RenderDoc::Inst().StartFrameCapture((ID3D12Device *)this, swapdesc.OutputWindow);
 
     m_AppControlledCapture = false;
+
+    // the run belongs to this device's capture, once it has actually started
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = swapdesc.OutputWindow;
+    }
   }
 
   return S_OK;
@@ -1244,11 +1344,95 @@ bool WrappedID3D12Device::Serialise_BeginCaptureFrame(bool applyInitialState)
   return true;
 }
 
+void WrappedID3D12Device::ResolveEventTimings(vector<ResourceId> &cmdIds,
+                                              vector<uint32_t> &chunkIndices,
+                                              vector<uint64_t> &durations)
+{
+  // a list's readback buffer only holds the timings from its most recent execution, so if it was
+  // executed more than once in the frame only the last execution can be matched up.
+  set<ID3D12Resource *> seen;
+  vector<pair<D3D12ResourceRecord *, WrappedID3D12CommandQueue *> > timed;
+  uint32_t dropped = 0;
+
+  for(size_t q = 0; q < m_Queues.size(); q++)
+  {
+    const vector<D3D12ResourceRecord *> &cmdListRecords = m_Queues[q]->GetCmdLists();
+
+    for(size_t i = cmdListRecords.size(); i > 0; i--)
+    {
+      D3D12ResourceRecord *record = cmdListRecords[i - 1];
+
+      if(record->cmdInfo == NULL || record->cmdInfo->timingChunks.empty() ||
+         record->cmdInfo->timingResults == NULL)
+        continue;
+
+      if(seen.find(record->cmdInfo->timingResults) != seen.end())
+      {
+        dropped++;
+        continue;
+      }
+
+      seen.insert(record->cmdInfo->timingResults);
+      timed.push_back(std::make_pair(record, m_Queues[q]));
+    }
+  }
+
+  if(timed.empty())
+    return;
+
+  // sync on the real queues, since wrapped signals would be recorded into the frame
+  for(size_t q = 0; q < m_Queues.size(); q++)
+    GPUSync(m_Queues[q]->GetReal(), Unwrap(m_GPUSyncFence));
+
+  for(size_t t = 0; t < timed.size(); t++)
+  {
+    const CmdListRecordingInfo *cmdInfo = timed[t].first->cmdInfo;
+    size_t count = cmdInfo->timingChunks.size();
+
+    UINT64 freq = 0;
+    timed[t].second->GetReal()->GetTimestampFrequency(&freq);
+
+    D3D12_RANGE range = {0, (SIZE_T)(sizeof(uint64_t) * count * 2)};
+    uint64_t *data = NULL;
+    HRESULT hr = cmdInfo->timingResults->Map(0, &range, (void **)&data);
+
+    if(FAILED(hr) || data == NULL || freq == 0)
+    {
+      RDCERR("Failed to read back event timings %08x", hr);
+      if(SUCCEEDED(hr))
+        cmdInfo->timingResults->Unmap(0, NULL);
+      continue;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+      uint64_t start = data[i * 2 + 0], end = data[i * 2 + 1];
+
+      cmdIds.push_back(timed[t].first->GetResourceID());
+      chunkIndices.push_back(cmdInfo->timingChunks[i]);
+      durations.push_back(end > start ? uint64_t(double(end - start) * 1000000000.0 / double(freq))
+                                      : 0);
+    }
+
+    D3D12_RANGE emptyRange = {0, 0};
+    cmdInfo->timingResults->Unmap(0, &emptyRange);
+  }
+
+  if(dropped > 0)
+    RDCWARN("Dropping event timings from %u earlier executions of re-executed command lists",
+            dropped);
+}
+
 void WrappedID3D12Device::EndCaptureFrame(ID3D12Resource *presentImage)
 {
   // must use main serialiser here to match resource manager
   Serialiser *localSerialiser = GetMainSerialiser();
 
+  vector<ResourceId> timingCmds;
+  vector<uint32_t> timingChunks;
+  vector<uint64_t> timingDurations;
+  ResolveEventTimings(timingCmds, timingChunks, timingDurations);
+
   SCOPED_SERIALISE_CONTEXT(CONTEXT_CAPTURE_FOOTER);
 
   SERIALISE_ELEMENT(ResourceId, bbid, GetResID(presentImage));
@@ -1270,6 +1454,22 @@ void WrappedID3D12Device::EndCaptureFrame(ID3D12Resource *presentImage)
     delete call;
   }
 
+  localSerialiser->Serialise("timingCmds", timingCmds);
+  localSerialiser->Serialise("timingChunks", timingChunks);
+  localSerialiser->Serialise("timingDurations", timingDurations);
+
+  m_FrameCaptureRecord->AddChunk(scope.Get());
+}
+
+void WrappedID3D12Device::RecordFrameBoundary(ID3D12Resource *presentImage)
+{
+  CACHE_THREAD_SERIALISER();
+
+  // marks the end of one frame in a capture recording a run of them, replayed by the queue
+  SCOPED_SERIALISE_CONTEXT(FRAME_BOUNDARY);
+
+  SERIALISE_ELEMENT(ResourceId, bbid, GetResID(presentImage));
+
   m_FrameCaptureRecord->AddChunk(scope.Get());
 }
 
@@ -1306,17 +1506,9 @@ void WrappedID3D12Device::StartFrameCapture(void *dev, void *wnd)
     initStateCurBatch = 0;
     initStateCurList = NULL;
 
+    // this closes the final list and waits for all of the readbacks
     GetResourceManager()->PrepareInitialContents();
 
-    // close the final list
-    initStateCurList->Close();
-
-    initStateCurBatch = 0;
-    initStateCurList = NULL;
-
-    ExecuteLists();
-    FlushLists();
-
     RDCDEBUG("Attempting capture");
     m_FrameCaptureRecord->DeleteChunks();
 
@@ -1395,8 +1587,8 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
 
     {
       SCOPED_LOCK(m_MapsLock);
-      for(auto it = m_Maps.begin(); it != m_Maps.end(); ++it)
-        it->res->FreeShadow();
+      for(WrappedID3D12Resource *res = m_MappedResources; res; res = res->m_MappedNext)
+        res->FreeShadow();
     }
 
     byte *thpixels = NULL;
@@ -1646,7 +1838,7 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
   // in capframe (the transition is thread-protected) so nothing will be
   // pushed to the vector
 
-  map<int32_t, Chunk *> recordlist;
+  RecordChunkList recordlist;
 
   for(auto it = queues.begin(); it != queues.end(); ++it)
   {
@@ -1678,17 +1870,17 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
     RDCDEBUG("Flushing %u chunks to file serialiser from context record",
              (uint32_t)recordlist.size());
 
-    for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-      m_pFileSerialiser->Insert(it->second);
+    vector<Chunk *> sortedChunks;
+    recordlist.Merge(sortedChunks);
+
+    for(size_t i = 0; i < sortedChunks.size(); i++)
+      m_pFileSerialiser->Insert(sortedChunks[i]);
 
     RDCDEBUG("Done");
   }
 
-  m_pFileSerialiser->FlushToDisk();
-
-  RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-  SAFE_DELETE(m_pFileSerialiser);
+  RenderDoc::Inst().FinishCaptureWrite(m_pFileSerialiser, m_FrameCounter);
+  m_pFileSerialiser = NULL;
   SAFE_DELETE(m_HeaderChunk);
 
   m_State = WRITING_IDLE;
@@ -1919,7 +2111,7 @@ bool WrappedID3D12Device::Serialise_SetResourceName(Serialiser *localSerialiser,
 {
   SERIALISE_ELEMENT(ResourceId, resource, GetResID(res));
   string name = nm ? nm : "";
-  localSerialiser->Serialise("name", name);
+  localSerialiser->SerialiseInternedString("name", name);
 
   if(m_State < WRITING && GetResourceManager()->HasLiveResource(resource))
   {
@@ -2138,7 +2330,8 @@ ID3D12GraphicsCommandList *WrappedID3D12Device::GetInitialStateList()
 
 void WrappedID3D12Device::CloseInitialStateList()
 {
-  initStateCurList->Close();
+  if(initStateCurList)
+    initStateCurList->Close();
   initStateCurList = NULL;
   initStateCurBatch = 0;
 }
@@ -2210,6 +2403,242 @@ void WrappedID3D12Device::SetLogFile(const char *logfile)
   SAFE_DELETE(m_ResourceManager);
   m_ResourceManager = new D3D12ResourceManager(m_State, m_pSerialiser, this);
   m_pSerialiser->SetUserData(m_ResourceManager);
+
+  // the pipeline library is specific to this log. Pipelines are stored by ID, and the runtime
+  // refuses to load a stored pipeline whose description doesn't match, so a stale library for a
+  // different log that was written to the same path is harmless.
+  string fullpath = FileIO::GetFullPathname(logfile);
+  uint32_t hash = strhash(fullpath.c_str());
+  hash = strhash(StringFormat::Fmt("%llu", FileIO::GetModifiedTimestamp(fullpath)).c_str(), hash);
+
+  m_PipelineLibraryPath =
+      FileIO::GetAppFolderFilename(StringFormat::Fmt("d3d12pipelines_%08x.cache", hash));
+}
+
+void WrappedID3D12Device::OpenPipelineLibrary()
+{
+  if(m_pDevice1 == NULL || m_PipelineLibraryPath.empty())
+    return;
+
+  FILE *f = FileIO::fopen(m_PipelineLibraryPath.c_str(), "rb");
+
+  if(f)
+  {
+    FileIO::fseek64(f, 0, SEEK_END);
+    uint64_t len = FileIO::ftell64(f);
+    FileIO::fseek64(f, 0, SEEK_SET);
+
+    m_PipelineLibraryData.resize((size_t)len);
+    if(len > 0)
+      FileIO::fread(&m_PipelineLibraryData[0], 1, (size_t)len, f);
+
+    FileIO::fclose(f);
+  }
+
+  // the library references this data directly, so it's kept alive until the library is released
+  HRESULT hr = E_FAIL;
+
+  if(!m_PipelineLibraryData.empty())
+  {
+    hr = m_pDevice1->CreatePipelineLibrary(
+        &m_PipelineLibraryData[0], m_PipelineLibraryData.size(), __uuidof(ID3D12PipelineLibrary),
+        (void **)&m_PipelineLibrary);
+
+    if(FAILED(hr))
+      RDCLOG("Pipeline library for this log can't be used (0x%08x), rebuilding", hr);
+  }
+
+  if(FAILED(hr))
+  {
+    m_PipelineLibraryData.clear();
+    m_PipelineLibrary = NULL;
+
+    hr = m_pDevice1->CreatePipelineLibrary(NULL, 0, __uuidof(ID3D12PipelineLibrary),
+                                           (void **)&m_PipelineLibrary);
+
+    if(FAILED(hr))
+    {
+      RDCWARN("Couldn't create pipeline library: 0x%08x", hr);
+      m_PipelineLibrary = NULL;
+    }
+  }
+
+  m_PipelineLibraryDirty = 0;
+}
+
+void WrappedID3D12Device::SavePipelineLibrary()
+{
+  if(m_PipelineLibrary && m_PipelineLibraryDirty > 0)
+  {
+    vector<byte> data;
+    data.resize(m_PipelineLibrary->GetSerializedSize());
+
+    HRESULT hr = data.empty() ? E_FAIL : m_PipelineLibrary->Serialize(&data[0], data.size());
+
+    if(SUCCEEDED(hr))
+    {
+      if(!FileIO::dump(m_PipelineLibraryPath.c_str(), &data[0], data.size()))
+        RDCWARN("Couldn't write pipeline library to %s", m_PipelineLibraryPath.c_str());
+    }
+    else
+    {
+      RDCERR("Couldn't serialise pipeline library: 0x%08x", hr);
+    }
+  }
+
+  // pipelines that were loaded from the library don't need it to stay alive
+  SAFE_RELEASE(m_PipelineLibrary);
+  m_PipelineLibraryData.clear();
+  m_PipelineLibraryDirty = 0;
+}
+
+struct WrappedID3D12Device::PipelineCreateJobs
+{
+  ID3D12Device *device;
+  ID3D12PipelineLibrary *library;
+  volatile int32_t *libraryDirty;
+
+  std::vector<PendingPipeline *> *pipes;
+  volatile int32_t next;
+};
+
+void WrappedID3D12Device::PipelineCreateWorker(void *param)
+{
+  PipelineCreateJobs &jobs = *(PipelineCreateJobs *)param;
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(&jobs.next);
+
+    if(idx >= (int32_t)jobs.pipes->size())
+      break;
+
+    PendingPipeline *pipe = jobs.pipes->at(idx);
+
+    std::wstring name = StringFormat::UTF82Wide(StringFormat::Fmt("%llu", pipe->id));
+
+    pipe->real = NULL;
+    pipe->hr = E_FAIL;
+
+    if(jobs.library)
+    {
+      if(pipe->graphics)
+        pipe->hr = jobs.library->LoadGraphicsPipeline(name.c_str(), pipe->graphics, pipe->guid,
+                                                      (void **)&pipe->real);
+      else
+        pipe->hr = jobs.library->LoadComputePipeline(name.c_str(), pipe->compute, pipe->guid,
+                                                     (void **)&pipe->real);
+
+      if(SUCCEEDED(pipe->hr))
+        continue;
+
+      pipe->real = NULL;
+    }
+
+    if(pipe->graphics)
+      pipe->hr = jobs.device->CreateGraphicsPipelineState(pipe->graphics, pipe->guid,
+                                                          (void **)&pipe->real);
+    else
+      pipe->hr = jobs.device->CreateComputePipelineState(pipe->compute, pipe->guid,
+                                                         (void **)&pipe->real);
+
+    // this fails if a pipeline with the same name but a different description is already stored,
+    // which just means we'll compile it again next time
+    if(SUCCEEDED(pipe->hr) && jobs.library &&
+       SUCCEEDED(jobs.library->StorePipeline(name.c_str(), pipe->real)))
+      Atomic::Inc32(jobs.libraryDirty);
+  }
+}
+
+void WrappedID3D12Device::FlushPendingPipelines()
+{
+  if(m_PendingPipelines.empty())
+    return;
+
+  PipelineCreateJobs jobs;
+  jobs.device = m_pDevice;
+  jobs.library = m_PipelineLibrary;
+  jobs.libraryDirty = &m_PipelineLibraryDirty;
+  jobs.pipes = &m_PendingPipelines;
+  jobs.next = -1;
+
+  uint32_t numThreads =
+      RDCMIN(Threading::GetNumberOfCores(), (uint32_t)m_PendingPipelines.size());
+
+  if(numThreads <= 1)
+  {
+    PipelineCreateWorker(&jobs);
+  }
+  else
+  {
+    std::vector<Threading::ThreadHandle> threads(numThreads, 0);
+
+    for(uint32_t i = 0; i < numThreads; i++)
+      threads[i] = Threading::CreateThread(&PipelineCreateWorker, &jobs);
+
+    for(uint32_t i = 0; i < numThreads; i++)
+    {
+      Threading::JoinThread(threads[i]);
+      Threading::CloseThread(threads[i]);
+    }
+  }
+
+  // wrap them in the order they were serialised
+  for(size_t p = 0; p < m_PendingPipelines.size(); p++)
+  {
+    PendingPipeline *pipe = m_PendingPipelines[p];
+
+    if(FAILED(pipe->hr))
+    {
+      RDCERR("Failed on resource serialise-creation, HRESULT: 0x%08x", pipe->hr);
+
+      SAFE_DELETE(pipe->graphics);
+      SAFE_DELETE(pipe->compute);
+      SAFE_DELETE(pipe);
+      continue;
+    }
+
+    WrappedID3D12PipelineState *wrapped = new WrappedID3D12PipelineState(pipe->real, this);
+
+    if(pipe->graphics)
+    {
+      wrapped->graphics = pipe->graphics;
+
+      D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc = wrapped->graphics;
+
+      desc->pRootSignature =
+          (ID3D12RootSignature *)GetResourceManager()->GetWrapper(desc->pRootSignature);
+
+      D3D12_SHADER_BYTECODE *shaders[] = {
+          &wrapped->graphics->VS, &wrapped->graphics->HS, &wrapped->graphics->DS,
+          &wrapped->graphics->GS, &wrapped->graphics->PS,
+      };
+
+      for(size_t i = 0; i < ARRAY_COUNT(shaders); i++)
+      {
+        if(shaders[i]->BytecodeLength == 0)
+          shaders[i]->pShaderBytecode = NULL;
+        else
+          shaders[i]->pShaderBytecode = WrappedID3D12Shader::AddShader(*shaders[i], this, wrapped);
+      }
+    }
+    else
+    {
+      wrapped->compute = pipe->compute;
+
+      wrapped->compute->pRootSignature =
+          (ID3D12RootSignature *)GetResourceManager()->GetWrapper(wrapped->compute->pRootSignature);
+
+      wrapped->compute->CS.pShaderBytecode =
+          WrappedID3D12Shader::AddShader(wrapped->compute->CS, this, wrapped);
+    }
+
+    GetResourceManager()->AddLiveResource(pipe->id, wrapped);
+
+    SAFE_DELETE(pipe);
+  }
+
+  m_PendingPipelines.clear();
 }
 
 const FetchDrawcall *WrappedID3D12Device::GetDrawcall(uint32_t eventID)
@@ -2222,6 +2651,11 @@ const FetchDrawcall *WrappedID3D12Device::GetDrawcall(uint32_t eventID)
 
 void WrappedID3D12Device::ProcessChunk(uint64_t offset, D3D12ChunkType context)
 {
+  // queued pipelines must exist before any chunk that could reference them
+  if(context != CREATE_GRAPHICS_PIPE && context != CREATE_COMPUTE_PIPE &&
+     context != CREATE_ROOT_SIG)
+    FlushPendingPipelines();
+
   switch(context)
   {
     case DEVICE_INIT: { break;
@@ -2311,6 +2745,8 @@ void WrappedID3D12Device::ReadLogInitialisation()
 
   SCOPED_TIMER("chunk initialisation");
 
+  OpenPipelineLibrary();
+
   for(;;)
   {
     PerformanceTimer timer;
@@ -2355,6 +2791,9 @@ void WrappedID3D12Device::ReadLogInitialisation()
       break;
   }
 
+  FlushPendingPipelines();
+  SavePipelineLibrary();
+
   if(m_State == READING)
   {
     GetFrameRecord().drawcallList = m_Queue->GetParentDrawcall().Bake();
@@ -45,7 +45,11 @@ struct D3D12InitParams : public RDCInitParams
 
   D3D_FEATURE_LEVEL MinimumFeatureLevel;
 
-  static const uint32_t D3D12_SERIALISE_VERSION = 0x0000001;
+  static const uint32_t D3D12_SERIALISE_VERSION = 0x0000003;
+
+  // backwards compatibility for old logs described at the declaration of this array
+  static const uint32_t D3D12_NUM_SUPPORTED_OLD_VERSIONS = 2;
+  static const uint32_t D3D12_OLD_VERSIONS[D3D12_NUM_SUPPORTED_OLD_VERSIONS];
 
   // version number internal to d3d12 stream
   uint32_t SerialiseVersion;
@@ -252,8 +256,44 @@ private:
   set<ResourceId> m_UploadResourceIds;
   map<uint64_t, ID3D12Resource *> m_UploadBuffers;
 
+  // intrusive list of resources with at least one mapped subresource, linked through
+  // WrappedID3D12Resource::m_MappedPrev/m_MappedNext. Only modified on the first Map and last
+  // Unmap of a subresource.
   Threading::CriticalSection m_MapsLock;
-  vector<MapState> m_Maps;
+  WrappedID3D12Resource *m_MappedResources;
+
+  // while loading a log, pipelines are queued up and a run of them is created in parallel on
+  // worker threads, before the next chunk that isn't a pipeline or root signature creation.
+  struct PendingPipeline
+  {
+    ResourceId id;
+    IID guid;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC *graphics;
+    D3D12_COMPUTE_PIPELINE_STATE_DESC *compute;
+
+    // copies of the bytecode, as the serialiser frees its own at the end of the chunk
+    vector<byte> bytecode[5];
+
+    ID3D12PipelineState *real;
+    HRESULT hr;
+  };
+
+  vector<PendingPipeline *> m_PendingPipelines;
+
+  struct PipelineCreateJobs;
+  static void PipelineCreateWorker(void *param);
+  void FlushPendingPipelines();
+
+  // pipelines created on replay are also stored in a pipeline library saved to disk, keyed by the
+  // log, so that reopening the same log can load them instead of compiling again. The runtime
+  // rejects the library if the adapter or driver has changed, in which case it's rebuilt.
+  string m_PipelineLibraryPath;
+  vector<byte> m_PipelineLibraryData;
+  ID3D12PipelineLibrary *m_PipelineLibrary;
+  volatile int32_t m_PipelineLibraryDirty;
+
+  void OpenPipelineLibrary();
+  void SavePipelineLibrary();
 
   void ProcessChunk(uint64_t offset, D3D12ChunkType context);
 
@@ -289,6 +329,11 @@ private:
   Serialiser *m_pSerialiser;
   bool m_AppControlledCapture;
 
+  // presents left in a run of frames being combined into this device's capture, only counted on
+  // the window the capture started on
+  uint32_t m_CapSpanFrames;
+  HWND m_CapSpanWindow;
+
   Threading::CriticalSection m_CapTransitionLock;
   LogState m_State;
 
@@ -337,7 +382,10 @@ private:
   UINT m_DescriptorIncrements[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
 
   void Serialise_CaptureScope(uint64_t offset);
+  void ResolveEventTimings(vector<ResourceId> &cmdIds, vector<uint32_t> &chunkIndices,
+                           vector<uint64_t> &durations);
   void EndCaptureFrame(ID3D12Resource *presentImage);
+  void RecordFrameBoundary(ID3D12Resource *presentImage);
 
 public:
   static const int AllocPoolCount = 4;
@@ -380,6 +428,7 @@ public:
   const map<ResourceId, DXGI_FORMAT> &GetBackbufferFormats() { return m_BackbufferFormat; }
   void SetLogFile(const char *logfile);
   void SetLogVersion(uint32_t fileversion) { m_InitParams.SerialiseVersion = fileversion; }
+  uint32_t GetLogVersion() { return m_InitParams.SerialiseVersion; }
   D3D12Replay *GetReplay() { return &m_Replay; }
   WrappedID3D12CommandQueue *GetQueue() { return m_Queue; }
   ID3D12CommandAllocator *GetAlloc() { return m_Alloc; }
@@ -486,15 +535,9 @@ public:
                                        UINT Subresource, const D3D12_BOX *pDstBox,
                                        const void *pSrcData, UINT SrcRowPitch, UINT SrcDepthPitch);
 
-  vector<MapState> GetMaps()
-  {
-    vector<MapState> ret;
-    {
-      SCOPED_LOCK(m_MapsLock);
-      ret = m_Maps;
-    }
-    return ret;
-  }
+  void GetMappedResources(const set<ResourceId> &refdIDs,
+                          const vector<D3D12ResourceRecord *> &refdCmds,
+                          vector<WrappedID3D12Resource *> &maps);
 
   void InternalRef() { InterlockedIncrement(&m_InternalRefcount); }
   void InternalRelease() { InterlockedDecrement(&m_InternalRefcount); }
@@ -245,39 +245,35 @@ bool WrappedID3D12Device::Serialise_CreateGraphicsPipelineState(
 
   if(m_State == READING)
   {
-    ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateGraphicsPipelineState(&Descriptor, guid, (void **)&ret);
-
-    if(FAILED(hr))
-    {
-      RDCERR("Failed on resource serialise-creation, HRESULT: 0x%08x", hr);
-    }
-    else
-    {
-      ret = new WrappedID3D12PipelineState(ret, this);
-
-      WrappedID3D12PipelineState *wrapped = (WrappedID3D12PipelineState *)ret;
-
-      wrapped->graphics = new D3D12_GRAPHICS_PIPELINE_STATE_DESC(Descriptor);
-
-      wrapped->graphics->pRootSignature =
-          (ID3D12RootSignature *)GetResourceManager()->GetWrapper(wrapped->graphics->pRootSignature);
-
-      D3D12_SHADER_BYTECODE *shaders[] = {
-          &wrapped->graphics->VS, &wrapped->graphics->HS, &wrapped->graphics->DS,
-          &wrapped->graphics->GS, &wrapped->graphics->PS,
-      };
-
-      for(size_t i = 0; i < ARRAY_COUNT(shaders); i++)
+    // created and wrapped in FlushPendingPipelines
+    PendingPipeline *pipe = new PendingPipeline();
+    pipe->id = Pipe;
+    pipe->guid = guid;
+    pipe->graphics = new D3D12_GRAPHICS_PIPELINE_STATE_DESC(Descriptor);
+    pipe->compute = NULL;
+    pipe->real = NULL;
+    pipe->hr = E_FAIL;
+
+    D3D12_SHADER_BYTECODE *shaders[] = {
+        &pipe->graphics->VS, &pipe->graphics->HS, &pipe->graphics->DS, &pipe->graphics->GS,
+        &pipe->graphics->PS,
+    };
+
+    for(size_t i = 0; i < ARRAY_COUNT(shaders); i++)
+    {
+      if(shaders[i]->BytecodeLength == 0)
       {
-        if(shaders[i]->BytecodeLength == 0)
-          shaders[i]->pShaderBytecode = NULL;
-        else
-          shaders[i]->pShaderBytecode = WrappedID3D12Shader::AddShader(*shaders[i], this, wrapped);
+        shaders[i]->pShaderBytecode = NULL;
+      }
+      else
+      {
+        const byte *code = (const byte *)shaders[i]->pShaderBytecode;
+        pipe->bytecode[i].assign(code, code + shaders[i]->BytecodeLength);
+        shaders[i]->pShaderBytecode = &pipe->bytecode[i][0];
       }
-
-      GetResourceManager()->AddLiveResource(Pipe, ret);
     }
+
+    m_PendingPipelines.push_back(pipe);
   }
 
   return true;
@@ -355,28 +351,23 @@ bool WrappedID3D12Device::Serialise_CreateComputePipelineState(
 
   if(m_State == READING)
   {
-    ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateComputePipelineState(&Descriptor, guid, (void **)&ret);
+    // created and wrapped in FlushPendingPipelines
+    PendingPipeline *pipe = new PendingPipeline();
+    pipe->id = Pipe;
+    pipe->guid = guid;
+    pipe->graphics = NULL;
+    pipe->compute = new D3D12_COMPUTE_PIPELINE_STATE_DESC(Descriptor);
+    pipe->real = NULL;
+    pipe->hr = E_FAIL;
 
-    if(FAILED(hr))
+    if(pipe->compute->CS.BytecodeLength > 0)
     {
-      RDCERR("Failed on resource serialise-creation, HRESULT: 0x%08x", hr);
+      const byte *code = (const byte *)pipe->compute->CS.pShaderBytecode;
+      pipe->bytecode[0].assign(code, code + pipe->compute->CS.BytecodeLength);
+      pipe->compute->CS.pShaderBytecode = &pipe->bytecode[0][0];
     }
-    else
-    {
-      WrappedID3D12PipelineState *wrapped = new WrappedID3D12PipelineState(ret, this);
-      ret = wrapped;
-
-      wrapped->compute = new D3D12_COMPUTE_PIPELINE_STATE_DESC(Descriptor);
 
-      wrapped->compute->pRootSignature =
-          (ID3D12RootSignature *)GetResourceManager()->GetWrapper(wrapped->compute->pRootSignature);
-
-      wrapped->compute->CS.pShaderBytecode =
-          WrappedID3D12Shader::AddShader(wrapped->compute->CS, this, wrapped);
-
-      GetResourceManager()->AddLiveResource(Pipe, ret);
-    }
+    m_PendingPipelines.push_back(pipe);
   }
 
   return true;
@@ -26,6 +26,7 @@
 #include "driver/dxgi/dxgi_common.h"
 #include "d3d12_command_list.h"
 #include "d3d12_command_queue.h"
+#include "d3d12_debug.h"
 #include "d3d12_device.h"
 #include "d3d12_resources.h"
 
@@ -396,6 +397,16 @@ void D3D12Descriptor::CopyFrom(const D3D12Descriptor &src)
   samp.idx = index;
 }
 
+// compares what two descriptors contain, ignoring the heap and index of where they live
+static bool DescriptorContentsEqual(const D3D12Descriptor &a, const D3D12Descriptor &b)
+{
+  const byte *contentsA = (const byte *)&a.samp.desc;
+  const byte *contentsB = (const byte *)&b.samp.desc;
+  size_t size = sizeof(D3D12Descriptor) - (contentsA - (const byte *)&a);
+
+  return memcmp(contentsA, contentsB, size) == 0;
+}
+
 void D3D12Descriptor::GetRefIDs(ResourceId &id, ResourceId &id2, FrameRefType &ref)
 {
   id = ResourceId();
@@ -678,6 +689,9 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
 
     D3D12_RESOURCE_DESC desc = r->GetDesc();
 
+    // any readback from a previous capture is gone
+    m_InitialReadbacks.erase(id);
+
     if(desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D && desc.SampleDesc.Count > 1)
     {
       D3D12NOTIMP("Multisampled initial contents");
@@ -697,41 +711,23 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
         return true;
       }
 
-      heapProps.Type = D3D12_HEAP_TYPE_READBACK;
-      heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-      heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-      heapProps.CreationNodeMask = 1;
-      heapProps.VisibleNodeMask = 1;
-
-      desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-      ID3D12Resource *copyDst = NULL;
-      HRESULT hr = m_Device->GetReal()->CreateCommittedResource(
-          &heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, NULL,
-          __uuidof(ID3D12Resource), (void **)&copyDst);
+      UINT64 offset = 0;
+      ID3D12Resource *copyDst = AllocInitialReadback(desc.Width, offset);
 
       if(nonresident)
-        m_Device->MakeResident(1, &pageable);
-
-      if(SUCCEEDED(hr))
-      {
-        ID3D12GraphicsCommandList *list = Unwrap(m_Device->GetInitialStateList());
-
-        list->CopyResource(copyDst, r->GetReal());
-      }
-      else
       {
-        RDCERR("Couldn't create readback buffer: 0x%08x", hr);
+        m_Device->MakeResident(1, &pageable);
+        m_EvictAfterPrepare.push_back(pageable);
       }
 
-      if(nonresident)
+      if(copyDst)
       {
-        m_Device->CloseInitialStateList();
+        ID3D12GraphicsCommandList *list = Unwrap(m_Device->GetInitialStateList());
 
-        m_Device->ExecuteLists();
-        m_Device->FlushLists();
+        list->CopyBufferRegion(copyDst, offset, r->GetReal(), 0, desc.Width);
 
-        m_Device->Evict(1, &pageable);
+        InitialReadback readback = {offset, desc.Width};
+        m_InitialReadbacks[id] = readback;
       }
 
       SetInitialContents(GetResID(r), D3D12ResourceManager::InitialContentData(copyDst, 0, NULL));
@@ -739,26 +735,7 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
     }
     else
     {
-      D3D12_HEAP_PROPERTIES heapProps;
-      heapProps.Type = D3D12_HEAP_TYPE_READBACK;
-      heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-      heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-      heapProps.CreationNodeMask = 1;
-      heapProps.VisibleNodeMask = 1;
-
-      D3D12_RESOURCE_DESC bufDesc;
-
-      bufDesc.Alignment = 0;
-      bufDesc.DepthOrArraySize = 1;
-      bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-      bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-      bufDesc.Format = DXGI_FORMAT_UNKNOWN;
-      bufDesc.Height = 1;
-      bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-      bufDesc.MipLevels = 1;
-      bufDesc.SampleDesc.Count = 1;
-      bufDesc.SampleDesc.Quality = 0;
-      bufDesc.Width = 1;
+      UINT64 totalSize = 0;
 
       UINT numSubresources = desc.MipLevels;
       if(desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE3D)
@@ -768,17 +745,18 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
           new D3D12_PLACED_SUBRESOURCE_FOOTPRINT[numSubresources];
 
       m_Device->GetCopyableFootprints(&desc, 0, numSubresources, 0, layouts, NULL, NULL,
-                                      &bufDesc.Width);
+                                      &totalSize);
 
-      ID3D12Resource *copyDst = NULL;
-      HRESULT hr = m_Device->GetReal()->CreateCommittedResource(
-          &heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, NULL,
-          __uuidof(ID3D12Resource), (void **)&copyDst);
+      UINT64 offset = 0;
+      ID3D12Resource *copyDst = AllocInitialReadback(totalSize, offset);
 
       if(nonresident)
+      {
         m_Device->MakeResident(1, &pageable);
+        m_EvictAfterPrepare.push_back(pageable);
+      }
 
-      if(SUCCEEDED(hr))
+      if(copyDst)
       {
         ID3D12GraphicsCommandList *list = Unwrap(m_Device->GetInitialStateList());
 
@@ -819,6 +797,7 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
           dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
           dst.pResource = copyDst;
           dst.PlacedFootprint = layouts[i];
+          dst.PlacedFootprint.Offset += offset;
 
           list->CopyTextureRegion(&dst, 0, 0, 0, &src, NULL);
         }
@@ -829,20 +808,9 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
 
         if(!barriers.empty())
           list->ResourceBarrier((UINT)barriers.size(), &barriers[0]);
-      }
-      else
-      {
-        RDCERR("Couldn't create readback buffer: 0x%08x", hr);
-      }
-
-      if(nonresident)
-      {
-        m_Device->CloseInitialStateList();
 
-        m_Device->ExecuteLists();
-        m_Device->FlushLists();
-
-        m_Device->Evict(1, &pageable);
+        InitialReadback readback = {offset, totalSize};
+        m_InitialReadbacks[id] = readback;
       }
 
       SAFE_DELETE_ARRAY(layouts);
@@ -859,6 +827,104 @@ bool D3D12ResourceManager::Prepare_InitialState(ID3D12DeviceChild *res)
   return false;
 }
 
+void D3D12ResourceManager::BeginPrepare_InitialStates()
+{
+  m_ReadbackChunk = NULL;
+  m_ReadbackChunkUsed = 0;
+}
+
+void D3D12ResourceManager::EndPrepare_InitialStates()
+{
+  // one wait for every copy recorded since the beginning
+  m_Device->CloseInitialStateList();
+
+  m_Device->ExecuteLists();
+  m_Device->FlushLists();
+
+  if(!m_EvictAfterPrepare.empty())
+    m_Device->Evict((UINT)m_EvictAfterPrepare.size(), &m_EvictAfterPrepare[0]);
+
+  m_EvictAfterPrepare.clear();
+
+  // the initial states hold their own references
+  SAFE_RELEASE(m_ReadbackChunk);
+  m_ReadbackChunkUsed = 0;
+}
+
+ID3D12Resource *D3D12ResourceManager::AllocInitialReadback(UINT64 size, UINT64 &offset)
+{
+  D3D12_HEAP_PROPERTIES heapProps;
+  heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+  heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+  heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+  heapProps.CreationNodeMask = 1;
+  heapProps.VisibleNodeMask = 1;
+
+  D3D12_RESOURCE_DESC bufDesc;
+
+  bufDesc.Alignment = 0;
+  bufDesc.DepthOrArraySize = 1;
+  bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+  bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+  bufDesc.Format = DXGI_FORMAT_UNKNOWN;
+  bufDesc.Height = 1;
+  bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+  bufDesc.MipLevels = 1;
+  bufDesc.SampleDesc.Count = 1;
+  bufDesc.SampleDesc.Quality = 0;
+  bufDesc.Width = RDCMAX(size, 1ULL);
+
+  ID3D12Resource *ret = NULL;
+
+  offset = 0;
+
+  // large resources get a readback buffer to themselves rather than wasting most of a chunk
+  if(size > ReadbackChunkSize / 2)
+  {
+    HRESULT hr = m_Device->GetReal()->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, NULL,
+        __uuidof(ID3D12Resource), (void **)&ret);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create readback buffer: 0x%08x", hr);
+      ret = NULL;
+    }
+
+    return ret;
+  }
+
+  m_ReadbackChunkUsed =
+      AlignUp(m_ReadbackChunkUsed, (UINT64)D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+  if(m_ReadbackChunk == NULL || m_ReadbackChunkUsed + size > ReadbackChunkSize)
+  {
+    SAFE_RELEASE(m_ReadbackChunk);
+    m_ReadbackChunkUsed = 0;
+
+    bufDesc.Width = ReadbackChunkSize;
+
+    HRESULT hr = m_Device->GetReal()->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, NULL,
+        __uuidof(ID3D12Resource), (void **)&m_ReadbackChunk);
+
+    if(FAILED(hr))
+    {
+      RDCERR("Couldn't create readback buffer: 0x%08x", hr);
+      m_ReadbackChunk = NULL;
+      return NULL;
+    }
+  }
+
+  offset = m_ReadbackChunkUsed;
+  m_ReadbackChunkUsed += size;
+
+  ret = m_ReadbackChunk;
+  ret->AddRef();
+
+  return ret;
+}
+
 bool D3D12ResourceManager::Serialise_InitialState(ResourceId resid, ID3D12DeviceChild *liveRes)
 {
   D3D12ResourceRecord *record = NULL;
@@ -877,7 +943,18 @@ bool D3D12ResourceManager::Serialise_InitialState(ResourceId resid, ID3D12Device
       D3D12Descriptor *descs = (D3D12Descriptor *)initContents.blob;
       uint32_t numElems = initContents.num;
 
-      m_pSerialiser->SerialiseComplexArray("Descriptors", descs, numElems);
+      // only serialise the descriptors that have been written. Each one carries its own index so
+      // the rest are left undefined on replay, and large bindless heaps are mostly empty.
+      vector<D3D12Descriptor> defined;
+
+      for(uint32_t i = 0; i < numElems; i++)
+        if(descs[i].GetType() != D3D12Descriptor::TypeUndefined)
+          defined.push_back(descs[i]);
+
+      D3D12Descriptor *definedDescs = defined.empty() ? NULL : &defined[0];
+      uint32_t numDefined = (uint32_t)defined.size();
+
+      m_pSerialiser->SerialiseComplexArray("Descriptors", definedDescs, numDefined);
     }
     else if(type == Resource_Resource)
     {
@@ -905,8 +982,23 @@ bool D3D12ResourceManager::Serialise_InitialState(ResourceId resid, ID3D12Device
 
       if(copiedBuffer)
       {
-        hr = copiedBuffer->Map(0, NULL, (void **)&ptr);
+        uint64_t offset = 0;
         size = (uint64_t)copiedBuffer->GetDesc().Width;
+
+        // data sub-allocated from a shared readback buffer only maps its own range
+        auto readback = m_InitialReadbacks.find(id);
+        if(initContents.num == 0 && readback != m_InitialReadbacks.end())
+        {
+          offset = readback->second.offset;
+          size = readback->second.size;
+        }
+
+        D3D12_RANGE range = {(SIZE_T)offset, (SIZE_T)(offset + size)};
+
+        hr = copiedBuffer->Map(0, &range, (void **)&ptr);
+
+        if(SUCCEEDED(hr) && ptr)
+          ptr += offset;
       }
 
       if(FAILED(hr) || ptr == NULL)
@@ -966,15 +1058,42 @@ bool D3D12ResourceManager::Serialise_InitialState(ResourceId resid, ID3D12Device
 
       copyheap = new WrappedID3D12DescriptorHeap(copyheap, m_Device, desc);
 
-      D3D12_CPU_DESCRIPTOR_HANDLE handle = copyheap->GetCPUDescriptorHandleForHeapStart();
+      D3D12_CPU_DESCRIPTOR_HANDLE base = copyheap->GetCPUDescriptorHandleForHeapStart();
 
       UINT increment = m_Device->GetDescriptorHandleIncrementSize(desc.Type);
 
+      vector<bool> defined(desc.NumDescriptors, false);
+
       for(uint32_t i = 0; i < numElems; i++)
       {
+        uint32_t idx = descs[i].samp.idx;
+
+        if(idx >= desc.NumDescriptors)
+        {
+          RDCERR("Descriptor index %u out of bounds in heap of %u", idx, desc.NumDescriptors);
+          continue;
+        }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE handle = base;
+        handle.ptr += idx * increment;
+
         descs[i].Create(desc.Type, m_Device, handle);
 
-        handle.ptr += increment;
+        defined[idx] = true;
+      }
+
+      // anything not serialised was undefined at the start of the frame
+      D3D12Descriptor *copyDescs = ((WrappedID3D12DescriptorHeap *)copyheap)->GetDescriptors();
+
+      for(uint32_t idx = 0; idx < desc.NumDescriptors; idx++)
+      {
+        if(defined[idx])
+          continue;
+
+        D3D12_CPU_DESCRIPTOR_HANDLE handle = base;
+        handle.ptr += idx * increment;
+
+        copyDescs[idx].Create(desc.Type, m_Device, handle);
       }
 
       SAFE_DELETE_ARRAY(descs);
@@ -1044,6 +1163,11 @@ bool D3D12ResourceManager::Serialise_InitialState(ResourceId resid, ID3D12Device
       else
         SAFE_DELETE_ARRAY(ptr);
 
+      // don't hold on to residency for the copy until it's needed, see Apply_InitialStates
+      ID3D12Pageable *pageable = copySrc;
+      m_Device->GetReal()->Evict(1, &pageable);
+      m_InitialUploadsResident = false;
+
       SetInitialContents(id, D3D12ResourceManager::InitialContentData(copySrc, 1, NULL));
 
       return true;
@@ -1080,21 +1204,124 @@ void D3D12ResourceManager::Create_InitialState(ResourceId id, ID3D12DeviceChild
   }
 }
 
+void D3D12ResourceManager::Apply_InitialStates(const InitialContentList &states)
+{
+  vector<ID3D12Pageable *> uploads;
+  UINT64 totalSize = 0;
+
+  for(size_t i = 0; i < states.size(); i++)
+  {
+    if(states[i].second.num == 1 && states[i].second.resource &&
+       IdentifyTypeByPtr(states[i].first) == Resource_Resource)
+    {
+      ID3D12Resource *copySrc = (ID3D12Resource *)states[i].second.resource;
+      totalSize += copySrc->GetDesc().Width;
+      uploads.push_back(copySrc);
+    }
+  }
+
+  UINT64 budget = m_Device->GetDebugManager()->GetUploadResidencyBudget();
+
+  // everything fits, the copies can stay resident between replays
+  if(m_InitialUploadsResident || totalSize <= budget)
+  {
+    if(!m_InitialUploadsResident && !uploads.empty())
+      m_Device->GetReal()->MakeResident((UINT)uploads.size(), &uploads[0]);
+
+    m_InitialUploadsResident = true;
+
+    for(size_t i = 0; i < states.size(); i++)
+      Apply_InitialState(states[i].first, states[i].second);
+
+    return;
+  }
+
+  RDCDEBUG("Initial contents (%llu bytes) over residency budget (%llu), applying in batches",
+           totalSize, budget);
+
+  budget = RDCMAX(budget, MinResidencyBatchSize);
+
+  vector<ID3D12Pageable *> batch;
+  UINT64 batchSize = 0;
+
+  for(size_t i = 0; i < states.size(); i++)
+  {
+    ID3D12Resource *copySrc = NULL;
+
+    if(states[i].second.num == 1 && states[i].second.resource &&
+       IdentifyTypeByPtr(states[i].first) == Resource_Resource)
+      copySrc = (ID3D12Resource *)states[i].second.resource;
+
+    if(copySrc)
+    {
+      UINT64 size = copySrc->GetDesc().Width;
+
+      // wait for the copies from the current batch before evicting it to make room
+      if(!batch.empty() && batchSize + size > budget)
+      {
+        m_Device->CloseInitialStateList();
+        m_Device->ExecuteLists();
+        m_Device->FlushLists(true);
+
+        m_Device->GetReal()->Evict((UINT)batch.size(), &batch[0]);
+        batch.clear();
+        batchSize = 0;
+      }
+
+      ID3D12Pageable *pageable = copySrc;
+      m_Device->GetReal()->MakeResident(1, &pageable);
+
+      batch.push_back(pageable);
+      batchSize += size;
+    }
+
+    Apply_InitialState(states[i].first, states[i].second);
+  }
+
+  if(!batch.empty())
+  {
+    m_Device->CloseInitialStateList();
+    m_Device->ExecuteLists();
+    m_Device->FlushLists(true);
+
+    m_Device->GetReal()->Evict((UINT)batch.size(), &batch[0]);
+  }
+}
+
 void D3D12ResourceManager::Apply_InitialState(ID3D12DeviceChild *live, InitialContentData data)
 {
   D3D12ResourceType type = IdentifyTypeByPtr(live);
 
   if(type == Resource_DescriptorHeap)
   {
-    ID3D12DescriptorHeap *dstheap = (ID3D12DescriptorHeap *)live;
-    ID3D12DescriptorHeap *srcheap = (ID3D12DescriptorHeap *)data.resource;
+    WrappedID3D12DescriptorHeap *dstheap = (WrappedID3D12DescriptorHeap *)live;
+    WrappedID3D12DescriptorHeap *srcheap = (WrappedID3D12DescriptorHeap *)data.resource;
 
     if(srcheap)
     {
-      // copy the whole heap
-      m_Device->CopyDescriptorsSimple(
-          srcheap->GetDesc().NumDescriptors, dstheap->GetCPUDescriptorHandleForHeapStart(),
-          srcheap->GetCPUDescriptorHandleForHeapStart(), srcheap->GetDesc().Type);
+      D3D12_DESCRIPTOR_HEAP_TYPE heapType = srcheap->GetDesc().Type;
+      UINT numDescriptors = RDCMIN(srcheap->GetNumDescriptors(), dstheap->GetNumDescriptors());
+
+      D3D12Descriptor *src = srcheap->GetDescriptors();
+      D3D12Descriptor *dst = dstheap->GetDescriptors();
+
+      // every write to the live heap goes through its descriptors, so only copy runs of
+      // descriptors that differ from the initial state, as most are untouched between replays.
+      UINT i = 0;
+      while(i < numDescriptors)
+      {
+        if(DescriptorContentsEqual(src[i], dst[i]))
+        {
+          i++;
+          continue;
+        }
+
+        UINT start = i;
+        while(i < numDescriptors && !DescriptorContentsEqual(src[i], dst[i]))
+          i++;
+
+        m_Device->CopyDescriptorsSimple(i - start, dst[start], src[start], heapType);
+      }
     }
   }
   else if(type == Resource_Resource)
@@ -268,6 +268,13 @@ struct D3D12ResourceRecord;
 
 struct CmdListRecordingInfo
 {
+  CmdListRecordingInfo() : timingHeap(NULL), timingResults(NULL), timingActive(false) {}
+  ~CmdListRecordingInfo()
+  {
+    SAFE_RELEASE(timingHeap);
+    SAFE_RELEASE(timingResults);
+  }
+
   vector<D3D12_RESOURCE_BARRIER> barriers;
 
   // a list of all resources dirtied by this command list
@@ -284,6 +291,14 @@ struct CmdListRecordingInfo
 
   // bundles executed
   vector<D3D12ResourceRecord *> bundles;
+
+  // with CaptureEventTimings, the timestamps written around each draw and dispatch and the chunk
+  // index each pair belongs to. The heap and readback buffer are reused by every recording of
+  // the list, and the baked commands keep a reference to the buffer its results are resolved to.
+  ID3D12QueryHeap *timingHeap;
+  ID3D12Resource *timingResults;
+  bool timingActive;
+  vector<uint32_t> timingChunks;
 };
 
 class WrappedID3D12Resource;
@@ -310,11 +325,14 @@ struct GPUAddressRangeTracker
   GPUAddressRangeTracker &operator=(const GPUAddressRangeTracker &);
 
   std::vector<GPUAddressRange> addresses;
-  Threading::CriticalSection addressLock;
+
+  // lookups happen on every recording thread for each buffer view or root address that's set,
+  // while adds and removes only happen on resource creation and destruction.
+  Threading::RWLock addressLock;
 
   void AddTo(GPUAddressRange range)
   {
-    SCOPED_LOCK(addressLock);
+    SCOPED_WRITELOCK(addressLock);
     auto it = std::lower_bound(addresses.begin(), addresses.end(), range.start);
     RDCASSERT(it == addresses.begin() || it == addresses.end() || range.start < it->start ||
               range.start >= it->end);
@@ -324,7 +342,7 @@ struct GPUAddressRangeTracker
 
   void RemoveFrom(D3D12_GPU_VIRTUAL_ADDRESS baseAddr)
   {
-    SCOPED_LOCK(addressLock);
+    SCOPED_WRITELOCK(addressLock);
     auto it = std::lower_bound(addresses.begin(), addresses.end(), baseAddr);
     RDCASSERT(it != addresses.end() && baseAddr >= it->start && baseAddr < it->end);
 
@@ -341,9 +359,8 @@ struct GPUAddressRangeTracker
 
     GPUAddressRange range;
 
-    // this should really be a read-write lock
     {
-      SCOPED_LOCK(addressLock);
+      SCOPED_READLOCK(addressLock);
 
       auto it = std::lower_bound(addresses.begin(), addresses.end(), addr);
       if(it == addresses.end())
@@ -360,13 +377,6 @@ struct GPUAddressRangeTracker
   }
 };
 
-struct MapState
-{
-  WrappedID3D12Resource *res;
-  UINT subres;
-  UINT64 totalSize;
-};
-
 struct D3D12ResourceRecord : public ResourceRecord
 {
   enum
@@ -391,9 +401,15 @@ struct D3D12ResourceRecord : public ResourceRecord
     cmdInfo->dirtied.swap(bakedCommands->cmdInfo->dirtied);
     cmdInfo->boundDescs.swap(bakedCommands->cmdInfo->boundDescs);
     cmdInfo->bundles.swap(bakedCommands->cmdInfo->bundles);
+    cmdInfo->timingChunks.swap(bakedCommands->cmdInfo->timingChunks);
+
+    if(cmdInfo->timingResults)
+      cmdInfo->timingResults->AddRef();
+    SAFE_RELEASE(bakedCommands->cmdInfo->timingResults);
+    bakedCommands->cmdInfo->timingResults = cmdInfo->timingResults;
   }
 
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(RecordChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -408,7 +424,7 @@ struct D3D12ResourceRecord : public ResourceRecord
     }
 
     if(!dataWritten)
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.AddRun(m_Chunks);
   }
 
   D3D12ResourceType type;
@@ -418,10 +434,14 @@ struct D3D12ResourceRecord : public ResourceRecord
 
   struct MapData
   {
-    MapData() : refcount(0), realPtr(NULL), shadowPtr(NULL) {}
+    MapData() : refcount(0), realPtr(NULL), shadowPtr(NULL), totalSize(0), writeWatch(0) {}
     volatile int32_t refcount;
     byte *realPtr;
     byte *shadowPtr;
+    UINT64 totalSize;
+
+    // while capturing, tracks which pages of realPtr have been written since the last flush
+    uint64_t writeWatch;
   };
 
   vector<MapData> m_Map;
@@ -434,7 +454,11 @@ class D3D12ResourceManager
 {
 public:
   D3D12ResourceManager(LogState state, Serialiser *ser, WrappedID3D12Device *dev)
-      : ResourceManager(state, ser), m_Device(dev)
+      : ResourceManager(state, ser),
+        m_Device(dev),
+        m_ReadbackChunk(NULL),
+        m_ReadbackChunkUsed(0),
+        m_InitialUploadsResident(false)
   {
   }
 
@@ -467,8 +491,42 @@ private:
   bool Force_InitialState(ID3D12DeviceChild *res, bool prepare);
   bool Need_InitialStateChunk(ID3D12DeviceChild *res);
   bool Prepare_InitialState(ID3D12DeviceChild *res);
+  void BeginPrepare_InitialStates();
+  void EndPrepare_InitialStates();
   void Create_InitialState(ResourceId id, ID3D12DeviceChild *live, bool hasData);
   void Apply_InitialState(ID3D12DeviceChild *live, InitialContentData data);
+  void Apply_InitialStates(const InitialContentList &states);
+
+  // readbacks for initial states are sub-allocated from large readback buffers, and every copy is
+  // recorded into the initial state list and waited on once after the last resource is prepared.
+  // Each initial state holds its own reference on the buffer it was allocated from.
+  static const UINT64 ReadbackChunkSize = 256 * 1024 * 1024;
+
+  ID3D12Resource *AllocInitialReadback(UINT64 size, UINT64 &offset);
+
+  struct InitialReadback
+  {
+    UINT64 offset;
+    UINT64 size;
+  };
+
+  // where each resource's data lives in a shared readback buffer. Resources not in here own their
+  // whole readback buffer
+  map<ResourceId, InitialReadback> m_InitialReadbacks;
+
+  ID3D12Resource *m_ReadbackChunk;
+  UINT64 m_ReadbackChunkUsed;
+
+  // non-resident resources made resident for their copy, evicted again once the copies are done
+  vector<ID3D12Pageable *> m_EvictAfterPrepare;
+
+  // on replay the upload copies of resource contents are evicted as soon as they're loaded, and
+  // only made resident while they are applied. If they all fit in the residency budget they're
+  // left resident, otherwise they're applied in batches that fit, evicting each after it's done.
+  // Batches are never smaller than this, even when the budget is already exhausted.
+  static const UINT64 MinResidencyBatchSize = 64 * 1024 * 1024;
+
+  bool m_InitialUploadsResident;
 
   WrappedID3D12Device *m_Device;
 };
@@ -1201,6 +1201,37 @@ bool D3D12Replay::GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mi
                                                     maxval, channels, histogram);
 }
 
+bool D3D12Replay::SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                      uint32_t sample, const ValueSearchParams &params,
+                                      vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  // no GPU search here yet, the caller reads the texture back and searches it on the CPU
+  matches.clear();
+  numMatches = 0;
+  return false;
+}
+
+bool D3D12Replay::SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                     uint32_t numElems, const ValueSearchParams &params,
+                                     vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+  return false;
+}
+
+bool D3D12Replay::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                      uint32_t mip, uint32_t sample, FormatComponentType typeHint)
+{
+  return m_pDevice->GetDebugManager()->SetTextureDiffInput(input, texid, sliceFace, mip, sample,
+                                                           typeHint);
+}
+
+bool D3D12Replay::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  return m_pDevice->GetDebugManager()->DiffTextureInputs(threshold, result);
+}
+
 ResourceId D3D12Replay::RenderOverlay(ResourceId texid, FormatComponentType typeHint,
                                       TextureDisplayOverlay overlay, uint32_t eventID,
                                       const vector<uint32_t> &passEvents)
@@ -1314,6 +1345,12 @@ void D3D12Replay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+void D3D12Replay::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                 vector<vector<byte> > &retData)
+{
+  m_pDevice->GetDebugManager()->GetBuffersData(ranges, retData);
+}
+
 void D3D12Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace,
                             uint32_t mip, uint32_t sample, FormatComponentType typeHint,
                             float pixel[4])
@@ -1413,6 +1450,21 @@ void D3D12Replay::FillCBufferVariables(ResourceId shader, string entryPoint, uin
   }
 }
 
+vector<ReplayMemoryStats> D3D12Replay::GetMemoryStats()
+{
+  ReplayMemoryStats stats = {};
+  stats.category = eReplayMemory_PostVSCache;
+  stats.gpuBytes = m_pDevice->GetDebugManager()->GetPostVSCacheSize();
+
+  return vector<ReplayMemoryStats>(1, stats);
+}
+
+void D3D12Replay::TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
+{
+  if(category == eReplayMemory_PostVSCache)
+    m_pDevice->GetDebugManager()->TrimPostVSCache(budget, eventID);
+}
+
 void D3D12Replay::InitPostVSBuffers(uint32_t eventID)
 {
   m_pDevice->GetDebugManager()->InitPostVSBuffers(eventID);
@@ -1539,6 +1591,13 @@ vector<DebugMessage> D3D12Replay::GetDebugMessages()
   return m_pDevice->GetDebugMessages();
 }
 
+void D3D12Replay::PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  m_pDevice->GetDebugManager()->PrecompileShader(source, entry, D3DCOMPILE_DEBUG | compileFlags,
+                                                 type);
+}
+
 void D3D12Replay::BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                                     ShaderStageType type, ResourceId *id, string *errors)
 {
@@ -1646,6 +1705,12 @@ byte *D3D12Replay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mi
   return m_pDevice->GetDebugManager()->GetTextureData(tex, arrayIdx, mip, params, dataSize);
 }
 
+void D3D12Replay::PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                                         ShaderStageType type)
+{
+  m_pDevice->GetDebugManager()->PrecompileShader(source, entry, compileFlags, type);
+}
+
 void D3D12Replay::BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                                     ShaderStageType type, ResourceId *id, string *errors)
 {
@@ -1702,7 +1767,8 @@ ResourceId D3D12Replay::CreateProxyBuffer(const FetchBuffer &templateBuf)
   return ResourceId();
 }
 
-void D3D12Replay::SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+void D3D12Replay::SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data,
+                                     size_t dataSize)
 {
 }
 
@@ -1794,3 +1860,27 @@ ReplayCreateStatus D3D12_CreateReplayDevice(const char *logfile, IReplayDriver *
 }
 
 static DriverRegistration D3D12DriverRegistration(RDC_D3D12, "D3D12", &D3D12_CreateReplayDevice);
+
+static string D3D12_ReadMarkerName(Serialiser *ser)
+{
+  ResourceId CommandList;
+  ser->Serialise("CommandList", CommandList);
+
+  string markerText;
+  ser->SerialiseInternedString("MarkerText", markerText);
+  return markerText;
+}
+
+static CaptureChunkInfo D3D12_CaptureChunkInfo()
+{
+  CaptureChunkInfo info;
+  info.chunkName = &WrappedID3D12Device::GetChunkName;
+  info.readMarkerName = &D3D12_ReadMarkerName;
+  info.captureScope = CAPTURE_SCOPE;
+  info.pushMarker = BEGIN_EVENT;
+  info.popMarker = END_EVENT;
+  info.setMarker = SET_MARKER;
+  return info;
+}
+
+static DriverRegistration D3D12ChunkInfoRegistration(RDC_D3D12, D3D12_CaptureChunkInfo());
@@ -100,13 +100,25 @@ public:
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches);
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches);
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
 
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   void ReplaceResource(ResourceId from, ResourceId to);
@@ -122,11 +134,21 @@ public:
   bool IsTextureSupported(const ResourceFormat &format);
 
   ResourceId CreateProxyBuffer(const FetchBuffer &templateBuf);
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize);
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize);
 
   void RenderMesh(uint32_t eventID, const vector<MeshFormat> &secondaryDraws, const MeshDisplay &cfg);
 
   bool RenderTexture(TextureDisplay cfg);
+  bool HasPendingTextureData() { return false; }
+  vector<ProxyCommandStats> GetProxyStats() { return vector<ProxyCommandStats>(); }
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total)
+  {
+    return false;
+  }
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total)
+  {
+    return false;
+  }
 
   void RenderCheckerboard(Vec3f light, Vec3f dark);
 
@@ -151,6 +173,8 @@ public:
                            TextureDisplayOverlay overlay, uint32_t eventID,
                            const vector<uint32_t> &passEvents);
 
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, uint32_t mip, uint32_t arrayIdx,
@@ -159,6 +183,9 @@ public:
   bool IsRenderOutput(ResourceId id);
 
   void FileChanged() {}
+  // only the post-VS cache is tracked on D3D12
+  vector<ReplayMemoryStats> GetMemoryStats();
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID);
   void InitCallstackResolver();
   bool HasCallstacks();
   Callstack::StackResolver *GetCallstackResolver();
@@ -174,6 +201,8 @@ public:
   void PreDeviceShutdownCounters();
 
 private:
+  void FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret);
+
   void MakePipelineState();
 
   void FillRegisterSpaces(const D3D12RenderState::RootSignature &rootSig,
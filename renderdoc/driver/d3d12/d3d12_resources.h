@@ -782,6 +782,9 @@ public:
     if(m_List)
       (*m_List)[GetResourceID()] = this;
 
+    m_MappedCount = 0;
+    m_MappedPrev = m_MappedNext = NULL;
+
     SetResident(true);
 
     // assuming only valid for buffers
@@ -806,6 +809,12 @@ public:
   void AllocShadow(UINT Subresource, size_t size);
   void FreeShadow();
 
+  // number of subresources currently mapped, and links in the device's list of mapped resources.
+  // Protected by the device's map lock
+  int32_t m_MappedCount;
+  WrappedID3D12Resource *m_MappedPrev;
+  WrappedID3D12Resource *m_MappedNext;
+
   virtual uint64_t GetGPUVirtualAddressIfBuffer()
   {
     if(m_pReal->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
@@ -211,11 +211,9 @@ HRESULT __stdcall WrappedD3DDevice9::Present(CONST RECT *pSourceRect, CONST RECT
 
   // if (m_State == WRITING_IDLE)
   {
-    uint32_t overlay = RenderDoc::Inst().GetOverlayBits();
-
     static bool debugRenderOverlay = true;
 
-    if(overlay & eRENDERDOC_Overlay_Enabled && debugRenderOverlay)
+    if(RenderDoc::Inst().ShouldDrawOverlay() && debugRenderOverlay)
     {
       HRESULT res = S_OK;
       res = m_device->BeginScene();
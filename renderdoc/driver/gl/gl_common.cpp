@@ -699,6 +699,92 @@ void DoVendorChecks(const GLHookSet &gl, GLPlatform &platform, GLWindowingData c
 
 const GLHookSet *GLMarkerRegion::gl;
 
+void GLLock::Lock()
+{
+  uint64_t tid = Threading::GetCurrentID();
+
+  if(m_Owner != tid)
+  {
+    m_RW.WriteLock();
+    m_Owner = tid;
+  }
+
+  m_Depth++;
+}
+
+void GLLock::Unlock()
+{
+  if(--m_Depth == 0)
+  {
+    m_Owner = 0;
+    m_RW.WriteUnlock();
+  }
+}
+
+bool GLLock::LockShared()
+{
+  if(m_Owner == Threading::GetCurrentID())
+  {
+    m_Depth++;
+    return false;
+  }
+
+  m_RW.ReadLock();
+  return true;
+}
+
+void GLLock::UnlockShared()
+{
+  m_RW.ReadUnlock();
+}
+
+bool IsConcurrentGLEntry(const char *function)
+{
+  // fixed function state. These only call the real function and record a chunk into the context
+  // record, and the parameters are serialised as plain values.
+  static const char *const stateFuncs[] = {
+      "glBlendColor", "glBlendEquation", "glBlendEquationSeparate", "glBlendEquationSeparatei",
+      "glBlendEquationi", "glBlendFunc", "glBlendFuncSeparate", "glBlendFuncSeparatei",
+      "glBlendFunci", "glClearColor", "glClearDepth", "glClearDepthf", "glClearStencil",
+      "glClipControl", "glColorMask", "glColorMaski", "glCullFace", "glDepthBoundsEXT",
+      "glDepthFunc", "glDepthMask", "glDepthRange", "glDepthRangeArrayv", "glDepthRangeIndexed",
+      "glDepthRangef", "glDisable", "glDisablei", "glEnable", "glEnablei", "glFrontFace",
+      "glHint", "glLineWidth", "glLogicOp", "glMinSampleShading", "glPatchParameterfv",
+      "glPatchParameteri", "glPointParameterf", "glPointParameterfv", "glPointParameteri",
+      "glPointParameteriv", "glPointSize", "glPolygonMode", "glPolygonOffset",
+      "glPolygonOffsetClampEXT", "glPrimitiveRestartIndex", "glProvokingVertex",
+      "glRasterSamplesEXT", "glSampleCoverage", "glSampleMaski", "glScissor", "glScissorArrayv",
+      "glScissorIndexed", "glScissorIndexedv", "glStencilFunc", "glStencilFuncSeparate",
+      "glStencilMask", "glStencilMaskSeparate", "glStencilOp", "glStencilOpSeparate",
+      "glViewport", "glViewportArrayv", "glViewportIndexedf", "glViewportIndexedfv"
+  };
+
+  for(size_t i = 0; i < ARRAY_COUNT(stateFuncs); i++)
+    if(!strcmp(function, stateFuncs[i]))
+      return true;
+
+  // uniform values go the same way, the program is only looked up to get its ID or mark it dirty
+  // which the resource manager locks. glUniformBlockBinding, glUniformSubroutinesuiv and similar
+  // don't match these and stay exclusive.
+  if(!strncmp(function, "glUniform", 9) || !strncmp(function, "glProgramUniform", 16))
+  {
+    const char *suffix = function + (function[2] == 'U' ? 9 : 16);
+    return (*suffix >= '1' && *suffix <= '4') || !strncmp(suffix, "Matrix", 6);
+  }
+
+  // generic vertex attribute values, but not the pointer/format/binding functions which change
+  // the VAO's record
+  if(!strncmp(function, "glVertexAttrib", 14))
+  {
+    const char *suffix = function + 14;
+    if(*suffix == 'L' || *suffix == 'I' || *suffix == 'P')
+      suffix++;
+    return *suffix >= '1' && *suffix <= '4';
+  }
+
+  return false;
+}
+
 GLMarkerRegion::GLMarkerRegion(const std::string &marker)
 {
   if(gl == NULL || !HasExt[KHR_debug] || !gl->glPushDebugGroup)
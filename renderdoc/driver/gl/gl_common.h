@@ -26,6 +26,7 @@
 #pragma once
 
 #include "common/common.h"
+#include "common/threading.h"
 #include "maths/vec.h"
 
 // typed enum so that templates will pick up specialisations
@@ -240,6 +241,60 @@ const GLenum eGL_ONE = (GLenum)1;
 class WrappedOpenGL;
 struct GLHookSet;
 
+// taken around every hooked entry point while capturing. Most entry points take it exclusively,
+// since WrappedOpenGL's tracking state isn't thread-safe. Those that only set state on the current
+// context and record a chunk through the calling thread's serialiser take it shared (see
+// IsConcurrentGLEntry), so threads with their own contexts record those concurrently. Exclusive
+// locks are recursive, and a thread holding it exclusively that asks for it shared just nests.
+class GLLock
+{
+public:
+  GLLock() : m_Owner(0), m_Depth(0) {}
+  void Lock();
+  void Unlock();
+  // returns false if it was taken exclusively instead, because this thread already owned it
+  bool LockShared();
+  void UnlockShared();
+
+private:
+  Threading::RWLock m_RW;
+  // only ever set to the owning thread's ID by that thread, so a thread comparing against its own
+  // ID gets the right answer without a lock
+  volatile uint64_t m_Owner;
+  int32_t m_Depth;
+};
+
+class ScopedGLLock
+{
+public:
+  ScopedGLLock(GLLock &lock, bool shared) : m_Lock(lock)
+  {
+    m_Shared = shared && m_Lock.LockShared();
+    if(!shared)
+      m_Lock.Lock();
+  }
+  ~ScopedGLLock()
+  {
+    if(m_Shared)
+      m_Lock.UnlockShared();
+    else
+      m_Lock.Unlock();
+  }
+
+private:
+  GLLock &m_Lock;
+  bool m_Shared;
+};
+
+bool IsConcurrentGLEntry(const char *function);
+
+#define SCOPED_GLLOCK(lock) ScopedGLLock CONCAT(scopedgllock, __LINE__)(lock, false);
+
+// for the hooks, the entry point's name is only looked up the first time it's called
+#define SCOPED_GLENTRY(lock, function)                                              \
+  static const bool CONCAT(function, _concurrent) = IsConcurrentGLEntry(#function); \
+  ScopedGLLock CONCAT(scopedgllock, __LINE__)(lock, CONCAT(function, _concurrent));
+
 // replay only class for handling marker regions
 struct GLMarkerRegion
 {
@@ -709,5 +764,7 @@ enum GLChunkType
   INTEROP_INIT,
   INTEROP_DATA,
 
+  FRAME_BOUNDARY,
+
   NUM_OPENGL_CHUNKS,
 };
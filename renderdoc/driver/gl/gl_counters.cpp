@@ -60,6 +60,9 @@ vector<uint32_t> GLReplay::EnumerateCounters()
   ret.push_back(eCounter_PSInvocations);
   ret.push_back(eCounter_CSInvocations);
 
+  if(!m_pDriver->GetCapturedEventTimings().empty())
+    ret.push_back(eCounter_CapturedGPUDuration);
+
   return ret;
 }
 
@@ -161,6 +164,15 @@ void GLReplay::DescribeCounter(uint32_t counterID, CounterDescription &desc)
       desc.resultCompType = eCompType_UInt;
       desc.units = eUnits_Absolute;
       break;
+    case eCounter_CapturedGPUDuration:
+      desc.name = "Captured GPU Duration";
+      desc.description =
+          "Time taken for this event on the GPU while the application was being captured, as "
+          "measured by delta between two GPU timestamps recorded around it.";
+      desc.resultByteWidth = 8;
+      desc.resultCompType = eCompType_Double;
+      desc.units = eUnits_Seconds;
+      break;
     default:
       desc.name = "Unknown";
       desc.description = "Unknown counter ID";
@@ -180,8 +192,14 @@ struct GPUQueries
 struct GLCounterContext
 {
   uint32_t eventStart;
+  uint32_t maxEID;
   vector<GPUQueries> queries;
   int reuseIdx;
+
+  // whether beginning each type of query has been checked for errors yet, and if it failed. Only
+  // the first query of each type is checked, so that we don't sync with the driver on every draw.
+  bool checked[eCounter_GLMaxCounters];
+  bool failed[eCounter_GLMaxCounters];
 };
 
 GLenum glCounters[] = {
@@ -209,10 +227,14 @@ void GLReplay::FillTimers(GLCounterContext &ctx, const DrawcallTreeNode &drawnod
 
   for(size_t i = 0; i < drawnode.children.size(); i++)
   {
+    // if the fetch is cancelled, stop and return the results so far
+    if(RenderDoc::Inst().IsOperationCancelled())
+      return;
+
     const FetchDrawcall &d = drawnode.children[i].draw;
     FillTimers(ctx, drawnode.children[i], counters);
 
-    if(d.events.count == 0)
+    if(d.events.count == 0 || RenderDoc::Inst().IsOperationCancelled())
       continue;
 
     GPUQueries *queries = NULL;
@@ -228,11 +250,8 @@ void GLReplay::FillTimers(GLCounterContext &ctx, const DrawcallTreeNode &drawnod
           queries->obj[q] = 0;
 
         for(uint32_t c = 0; c < counters.size(); c++)
-        {
-          m_pDriver->glGenQueries(1, &queries->obj[counters[c]]);
-          if(m_pDriver->glGetError())
-            queries->obj[counters[c]] = 0;
-        }
+          if(!ctx.failed[counters[c]])
+            m_pDriver->glGenQueries(1, &queries->obj[counters[c]]);
       }
       else
       {
@@ -244,15 +263,33 @@ void GLReplay::FillTimers(GLCounterContext &ctx, const DrawcallTreeNode &drawnod
 
     // Reverse order so that Timer counter is queried the last.
     for(int32_t q = (eCounter_GLMaxCounters - 1); q >= 0; q--)
+    {
+      if(queries->obj[q] && ctx.failed[q])
+      {
+        m_pDriver->glDeleteQueries(1, &queries->obj[q]);
+        queries->obj[q] = 0;
+      }
+
       if(queries->obj[q])
       {
+        if(!ctx.checked[q])
+          ClearGLErrors(m_pDriver->GetHookset());
+
         m_pDriver->glBeginQuery(glCounters[q], queries->obj[q]);
-        if(m_pDriver->glGetError())
+
+        if(!ctx.checked[q])
         {
-          m_pDriver->glDeleteQueries(1, &queries->obj[q]);
-          queries->obj[q] = 0;
+          ctx.checked[q] = true;
+
+          if(m_pDriver->glGetError())
+          {
+            ctx.failed[q] = true;
+            m_pDriver->glDeleteQueries(1, &queries->obj[q]);
+            queries->obj[q] = 0;
+          }
         }
       }
+    }
 
     m_pDriver->ReplayLog(ctx.eventStart, d.eventID, eReplay_OnlyDraw);
 
@@ -261,9 +298,19 @@ void GLReplay::FillTimers(GLCounterContext &ctx, const DrawcallTreeNode &drawnod
         m_pDriver->glEndQuery(glCounters[q]);
 
     ctx.eventStart = d.eventID + 1;
+
+    RenderDoc::Inst().SetOperationProgress(float(d.eventID) / float(ctx.maxEID));
   }
 }
 
+static uint32_t LastEventID(const DrawcallTreeNode &node)
+{
+  if(node.children.empty())
+    return node.draw.eventID;
+
+  return LastEventID(node.children.back());
+}
+
 vector<CounterResult> GLReplay::FetchCounters(const vector<uint32_t> &counters)
 {
   vector<CounterResult> ret;
@@ -274,10 +321,41 @@ vector<CounterResult> GLReplay::FetchCounters(const vector<uint32_t> &counters)
     return ret;
   }
 
+  // the captured timings are already known, so only the remaining counters need a replay
+  vector<uint32_t> replayCounters;
+
+  for(size_t i = 0; i < counters.size(); i++)
+  {
+    if(counters[i] == eCounter_CapturedGPUDuration)
+    {
+      const vector<CounterResult> &timings = m_pDriver->GetCapturedEventTimings();
+      ret.insert(ret.end(), timings.begin(), timings.end());
+    }
+    else if(counters[i] < eCounter_GLMaxCounters)
+    {
+      replayCounters.push_back(counters[i]);
+    }
+  }
+
+  if(replayCounters.empty())
+    return ret;
+
+  FetchReplayCounters(replayCounters, ret);
+
+  return ret;
+}
+
+void GLReplay::FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret)
+{
   MakeCurrentReplayContext(&m_ReplayCtx);
 
   GLCounterContext ctx;
 
+  RDCEraseEl(ctx.checked);
+  RDCEraseEl(ctx.failed);
+
+  ctx.maxEID = RDCMAX(1U, LastEventID(m_pDriver->GetRootDraw()));
+
   for(int loop = 0; loop < 1; loop++)
   {
     ctx.eventStart = 0;
@@ -289,8 +367,67 @@ vector<CounterResult> GLReplay::FetchCounters(const vector<uint32_t> &counters)
     double nanosToSecs = 1.0 / 1000000000.0;
 
     GLuint prevbind = 0;
-    m_pDriver->glGetIntegerv(eGL_QUERY_BUFFER_BINDING, (GLint *)&prevbind);
-    m_pDriver->glBindBuffer(eGL_QUERY_BUFFER, 0);
+    if(HasExt[ARB_query_buffer_object])
+      m_pDriver->glGetIntegerv(eGL_QUERY_BUFFER_BINDING, (GLint *)&prevbind);
+
+    // results for every query, in the same order as the loop below reads them
+    vector<GLuint64> results(ctx.queries.size() * counters.size(), 0);
+
+    bool fetched = false;
+
+    // with query buffer objects the GPU writes each result into a buffer as soon as it's
+    // available, and we only wait once when the buffer is read back - rather than stalling on
+    // each query in turn.
+    if(HasExt[ARB_query_buffer_object] && !results.empty())
+    {
+      GLuint resultBuf = 0;
+      m_pDriver->glGenBuffers(1, &resultBuf);
+      m_pDriver->glBindBuffer(eGL_QUERY_BUFFER, resultBuf);
+      m_pDriver->glNamedBufferDataEXT(resultBuf, GLsizeiptr(results.size() * sizeof(GLuint64)),
+                                      NULL, eGL_STREAM_READ);
+
+      ClearGLErrors(m_pDriver->GetHookset());
+
+      for(size_t i = 0; i < ctx.queries.size(); i++)
+      {
+        for(uint32_t c = 0; c < counters.size(); c++)
+        {
+          GLuint obj = ctx.queries[i].obj[counters[c]];
+          size_t offs = (i * counters.size() + c) * sizeof(GLuint64);
+
+          if(obj)
+            m_pDriver->glGetQueryObjectui64v(obj, eGL_QUERY_RESULT, (GLuint64 *)offs);
+        }
+      }
+
+      if(!m_pDriver->glGetError())
+      {
+        m_pDriver->glGetNamedBufferSubDataEXT(
+            resultBuf, 0, GLsizeiptr(results.size() * sizeof(GLuint64)), &results[0]);
+
+        fetched = !m_pDriver->glGetError();
+      }
+
+      m_pDriver->glBindBuffer(eGL_QUERY_BUFFER, 0);
+      m_pDriver->glDeleteBuffers(1, &resultBuf);
+    }
+
+    if(!fetched)
+    {
+      // Queries complete in order, so once the first result has been waited on the rest are
+      // generally available without further stalls.
+      for(size_t i = 0; i < ctx.queries.size(); i++)
+      {
+        for(uint32_t c = 0; c < counters.size(); c++)
+        {
+          GLuint obj = ctx.queries[i].obj[counters[c]];
+
+          if(obj)
+            m_pDriver->glGetQueryObjectui64v(obj, eGL_QUERY_RESULT,
+                                             &results[i * counters.size() + c]);
+        }
+      }
+    }
 
     for(size_t i = 0; i < ctx.queries.size(); i++)
     {
@@ -298,17 +435,10 @@ vector<CounterResult> GLReplay::FetchCounters(const vector<uint32_t> &counters)
       {
         if(ctx.queries[i].obj[counters[c]])
         {
-          GLuint64 data = 0;
-          m_pDriver->glGetQueryObjectui64v(ctx.queries[i].obj[counters[c]], eGL_QUERY_RESULT, &data);
+          GLuint64 data = results[i * counters.size() + c];
 
           double duration = double(data) * nanosToSecs;
 
-          if(m_pDriver->glGetError())
-          {
-            data = (uint64_t)-1;
-            duration = -1;
-          }
-
           if(counters[c] == eCounter_EventGPUDuration)
           {
             ret.push_back(CounterResult(ctx.queries[i].eventID, eCounter_EventGPUDuration, duration));
@@ -321,13 +451,12 @@ vector<CounterResult> GLReplay::FetchCounters(const vector<uint32_t> &counters)
       }
     }
 
-    m_pDriver->glBindBuffer(eGL_QUERY_BUFFER, prevbind);
+    if(HasExt[ARB_query_buffer_object])
+      m_pDriver->glBindBuffer(eGL_QUERY_BUFFER, prevbind);
   }
 
   for(size_t i = 0; i < ctx.queries.size(); i++)
     for(uint32_t c = 0; c < counters.size(); c++)
       if(ctx.queries[i].obj[counters[c]])
         m_pDriver->glDeleteQueries(1, &ctx.queries[i].obj[counters[c]]);
-
-  return ret;
 }
@@ -419,6 +419,8 @@ void GLReplay::InitDebugData()
     RDCCOMPILE_ASSERT(sizeof(TexDisplayUBOData) <= 2048, "UBO too small");
     RDCCOMPILE_ASSERT(sizeof(FontUBOData) <= 2048, "UBO too small");
     RDCCOMPILE_ASSERT(sizeof(HistogramUBOData) <= 2048, "UBO too small");
+    RDCCOMPILE_ASSERT(sizeof(ValueSearchUBOData) <= 2048, "UBO too small");
+    RDCCOMPILE_ASSERT(sizeof(TexDiffUBOData) <= 2048, "UBO too small");
     RDCCOMPILE_ASSERT(sizeof(overdrawRamp) <= 2048, "UBO too small");
   }
 
@@ -429,6 +431,12 @@ void GLReplay::InitDebugData()
   gl.glBindFramebuffer(eGL_FRAMEBUFFER, DebugData.customFBO);
   DebugData.customTex = 0;
 
+  gl.glGenFramebuffers(1, &DebugData.diffFBO);
+  gl.glBindFramebuffer(eGL_FRAMEBUFFER, DebugData.diffFBO);
+  DebugData.diffInputs[0] = DebugData.diffInputs[1] = DebugData.diffTex = 0;
+  DebugData.diffInputWidth[0] = DebugData.diffInputWidth[1] = 0;
+  DebugData.diffInputHeight[0] = DebugData.diffInputHeight[1] = 0;
+
   gl.glGenFramebuffers(1, &DebugData.pickPixelFBO);
   gl.glBindFramebuffer(eGL_FRAMEBUFFER, DebugData.pickPixelFBO);
 
@@ -454,6 +462,9 @@ void GLReplay::InitDebugData()
     RDCEraseEl(DebugData.minmaxTileProgram);
     RDCEraseEl(DebugData.histogramProgram);
     RDCEraseEl(DebugData.minmaxResultProgram);
+    RDCEraseEl(DebugData.valueSearchTexProgram);
+    DebugData.valueSearchBufProgram = 0;
+    DebugData.diffProgram = 0;
 
     RDCCOMPILE_ASSERT(
         ARRAY_COUNT(DebugData.minmaxTileProgram) >= (TEXDISPLAY_SINT_TEX | TEXDISPLAY_TYPEMASK) + 1,
@@ -511,9 +522,43 @@ void GLReplay::InitDebugData()
 
           DebugData.minmaxResultProgram[i] = CreateCShaderProgram(cs);
         }
+
+        // NaN and infinity only exist in float data, so only search float textures
+        if(i == 0)
+        {
+          string defines = extensions;
+          defines += string("#define SHADER_RESTYPE ") + ToStr::Get(t) + "\n";
+          defines += "#define UINT_TEX 0\n";
+          defines += "#define SINT_TEX 0\n";
+          defines += "#define BUFFER_SEARCH 0\n";
+
+          GenerateGLSLShader(cs, shaderType, defines, GetEmbeddedResource(glsl_valuesearch_comp),
+                             glslCSVer);
+
+          DebugData.valueSearchTexProgram[t] = CreateCShaderProgram(cs);
+        }
       }
     }
 
+    if(glesShadersAreComplete && HasExt[ARB_compute_shader])
+    {
+      string defines = extensions;
+      defines += string("#define SHADER_RESTYPE ") + ToStr::Get(RESTYPE_TEX2D) + "\n";
+      defines += "#define UINT_TEX 0\n";
+      defines += "#define SINT_TEX 0\n";
+      defines += "#define BUFFER_SEARCH 1\n";
+
+      GenerateGLSLShader(cs, shaderType, defines, GetEmbeddedResource(glsl_valuesearch_comp),
+                         glslCSVer);
+
+      DebugData.valueSearchBufProgram = CreateCShaderProgram(cs);
+
+      GenerateGLSLShader(cs, shaderType, extensions, GetEmbeddedResource(glsl_texdiff_comp),
+                         glslCSVer);
+
+      DebugData.diffProgram = CreateCShaderProgram(cs);
+    }
+
     if(!HasExt[ARB_compute_shader])
     {
       RDCWARN("GL_ARB_compute_shader not supported, disabling min/max and histogram features.");
@@ -525,6 +570,8 @@ void GLReplay::InitDebugData()
     gl.glGenBuffers(1, &DebugData.minmaxTileResult);
     gl.glGenBuffers(1, &DebugData.minmaxResult);
     gl.glGenBuffers(1, &DebugData.histogramBuf);
+    gl.glGenBuffers(1, &DebugData.valueSearchResult);
+    gl.glGenBuffers(1, &DebugData.diffResult);
 
     const uint32_t maxTexDim = 16384;
     const uint32_t blockPixSize = HGRAM_PIXELS_PER_TILE * HGRAM_TILES_PER_BLOCK;
@@ -537,6 +584,7 @@ void GLReplay::InitDebugData()
     gl.glNamedBufferDataEXT(DebugData.minmaxResult, sizeof(Vec4f) * 2, NULL, eGL_DYNAMIC_READ);
     gl.glNamedBufferDataEXT(DebugData.histogramBuf, sizeof(uint32_t) * 4 * HGRAM_NUM_BUCKETS, NULL,
                             eGL_DYNAMIC_READ);
+    gl.glNamedBufferDataEXT(DebugData.diffResult, sizeof(Vec4u) * 2, NULL, eGL_DYNAMIC_READ);
   }
 
   if(glesShadersAreComplete && HasExt[ARB_compute_shader])
@@ -752,6 +800,10 @@ void GLReplay::DeleteDebugData()
   gl.glDeleteFramebuffers(1, &DebugData.customFBO);
   gl.glDeleteTextures(1, &DebugData.customTex);
 
+  gl.glDeleteFramebuffers(1, &DebugData.diffFBO);
+  gl.glDeleteTextures(2, DebugData.diffInputs);
+  gl.glDeleteTextures(1, &DebugData.diffTex);
+
   gl.glDeleteVertexArrays(1, &DebugData.emptyVAO);
 
   for(int t = 1; t <= RESTYPE_TEXTYPEMAX; t++)
@@ -771,8 +823,13 @@ void GLReplay::DeleteDebugData()
       gl.glDeleteProgram(DebugData.minmaxResultProgram[i]);
       DebugData.minmaxResultProgram[i] = 0;
     }
+
+    gl.glDeleteProgram(DebugData.valueSearchTexProgram[t]);
   }
 
+  gl.glDeleteProgram(DebugData.valueSearchBufProgram);
+  gl.glDeleteProgram(DebugData.diffProgram);
+
   gl.glDeleteProgram(DebugData.meshPickProgram);
   gl.glDeleteBuffers(1, &DebugData.pickIBBuf);
   gl.glDeleteBuffers(1, &DebugData.pickVBBuf);
@@ -784,6 +841,8 @@ void GLReplay::DeleteDebugData()
   gl.glDeleteBuffers(1, &DebugData.minmaxTileResult);
   gl.glDeleteBuffers(1, &DebugData.minmaxResult);
   gl.glDeleteBuffers(1, &DebugData.histogramBuf);
+  gl.glDeleteBuffers(1, &DebugData.valueSearchResult);
+  gl.glDeleteBuffers(1, &DebugData.diffResult);
 
   gl.glDeleteVertexArrays(1, &DebugData.meshVAO);
   gl.glDeleteVertexArrays(1, &DebugData.axisVAO);
@@ -1148,6 +1207,426 @@ bool GLReplay::GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip,
   return true;
 }
 
+void GLReplay::PrepareValueSearch(uint32_t maxMatches)
+{
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  // one uvec4 for the count, then one per match that can be stored
+  gl.glBindBuffer(eGL_SHADER_STORAGE_BUFFER, DebugData.valueSearchResult);
+  gl.glBufferData(eGL_SHADER_STORAGE_BUFFER, sizeof(Vec4u) * (1 + maxMatches), NULL,
+                  eGL_DYNAMIC_READ);
+
+  Vec4u zero = {};
+  gl.glBufferSubData(eGL_SHADER_STORAGE_BUFFER, 0, sizeof(Vec4u), &zero);
+
+  gl.glBindBufferBase(eGL_SHADER_STORAGE_BUFFER, 0, DebugData.valueSearchResult);
+}
+
+void GLReplay::FetchValueSearchResults(uint32_t maxMatches, vector<ValueSearchMatch> &matches,
+                                       uint32_t &numMatches)
+{
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  RDCCOMPILE_ASSERT(sizeof(ValueSearchMatch) == sizeof(Vec4u),
+                    "ValueSearchMatch must match the layout in the shader");
+
+  gl.glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  gl.glBindBuffer(eGL_COPY_READ_BUFFER, DebugData.valueSearchResult);
+
+  Vec4u count = {};
+  gl.glGetBufferSubData(eGL_COPY_READ_BUFFER, 0, sizeof(Vec4u), &count);
+
+  // the count keeps going past the matches we had space for
+  numMatches = count.x;
+
+  matches.resize(RDCMIN(numMatches, maxMatches));
+  if(!matches.empty())
+    gl.glGetBufferSubData(eGL_COPY_READ_BUFFER, sizeof(Vec4u),
+                          sizeof(ValueSearchMatch) * matches.size(), &matches[0]);
+}
+
+bool GLReplay::SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                   uint32_t sample, const ValueSearchParams &params,
+                                   vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  if(texid == ResourceId() || m_pDriver->m_Textures.find(texid) == m_pDriver->m_Textures.end())
+    return false;
+
+  if(!HasExt[ARB_compute_shader])
+    return false;
+
+  auto &texDetails = m_pDriver->m_Textures[texid];
+
+  FetchTexture details = GetTexture(texid);
+
+  // integer values can't be NaN or infinite, and a range check on them is better done on the CPU
+  if(details.format.compType == eCompType_UInt || details.format.compType == eCompType_SInt)
+    return false;
+
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  int texSlot = 0;
+
+  bool renderbuffer = false;
+
+  switch(texDetails.curType)
+  {
+    case eGL_RENDERBUFFER:
+      texSlot = RESTYPE_TEX2D;
+      renderbuffer = true;
+      break;
+    case eGL_TEXTURE_1D: texSlot = RESTYPE_TEX1D; break;
+    default:
+      RDCWARN("Unexpected texture type");
+    // fall through
+    case eGL_TEXTURE_2D: texSlot = RESTYPE_TEX2D; break;
+    case eGL_TEXTURE_2D_MULTISAMPLE: texSlot = RESTYPE_TEX2DMS; break;
+    case eGL_TEXTURE_RECTANGLE: texSlot = RESTYPE_TEXRECT; break;
+    case eGL_TEXTURE_BUFFER: texSlot = RESTYPE_TEXBUFFER; break;
+    case eGL_TEXTURE_3D: texSlot = RESTYPE_TEX3D; break;
+    case eGL_TEXTURE_CUBE_MAP: texSlot = RESTYPE_TEXCUBE; break;
+    case eGL_TEXTURE_1D_ARRAY: texSlot = RESTYPE_TEX1DARRAY; break;
+    case eGL_TEXTURE_2D_ARRAY: texSlot = RESTYPE_TEX2DARRAY; break;
+    case eGL_TEXTURE_CUBE_MAP_ARRAY: texSlot = RESTYPE_TEXCUBEARRAY; break;
+  }
+
+  if(DebugData.valueSearchTexProgram[texSlot] == 0)
+    return false;
+
+  GLenum target = texDetails.curType;
+  GLuint texname = texDetails.resource.name;
+
+  // do blit from renderbuffer to texture, then sample from texture
+  if(renderbuffer)
+  {
+    // need replay context active to do blit (as FBOs aren't shared)
+    MakeCurrentReplayContext(&m_ReplayCtx);
+
+    GLuint curDrawFBO = 0;
+    GLuint curReadFBO = 0;
+    gl.glGetIntegerv(eGL_DRAW_FRAMEBUFFER_BINDING, (GLint *)&curDrawFBO);
+    gl.glGetIntegerv(eGL_READ_FRAMEBUFFER_BINDING, (GLint *)&curReadFBO);
+
+    gl.glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, texDetails.renderbufferFBOs[1]);
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, texDetails.renderbufferFBOs[0]);
+
+    gl.glBlitFramebuffer(
+        0, 0, texDetails.width, texDetails.height, 0, 0, texDetails.width, texDetails.height,
+        GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, eGL_NEAREST);
+
+    gl.glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, curDrawFBO);
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, curReadFBO);
+
+    texname = texDetails.renderbufferReadTex;
+    target = eGL_TEXTURE_2D;
+  }
+
+  MakeCurrentReplayContext(m_DebugCtx);
+
+  gl.glBindBufferBase(eGL_UNIFORM_BUFFER, 2, DebugData.UBOs[0]);
+  ValueSearchUBOData *cdata =
+      (ValueSearchUBOData *)gl.glMapBufferRange(eGL_UNIFORM_BUFFER, 0, sizeof(ValueSearchUBOData),
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+  cdata->SearchFlags = params.flags;
+  cdata->SearchMin = params.minValue;
+  cdata->SearchMax = params.maxValue;
+  cdata->SearchChannels = params.channelMask & 0xf;
+
+  cdata->SearchTextureResolution.x = (float)RDCMAX(details.width >> mip, 1U);
+  cdata->SearchTextureResolution.y = (float)RDCMAX(details.height >> mip, 1U);
+  cdata->SearchTextureResolution.z = (float)RDCMAX(details.depth >> mip, 1U);
+  if(texDetails.curType != eGL_TEXTURE_3D)
+    cdata->SearchSlice = (float)sliceFace + 0.001f;
+  else
+    cdata->SearchSlice = (float)(sliceFace >> mip);
+  cdata->SearchMip = mip;
+  cdata->SearchSample = (int)RDCCLAMP(sample, 0U, details.msSamp - 1);
+  if(sample == ~0U)
+    cdata->SearchSample = -int(details.msSamp);
+  cdata->SearchMaxMatches = params.maxMatches;
+
+  cdata->SearchStride = 0;
+  cdata->SearchOffset = 0;
+  cdata->SearchNumElements = 0;
+  cdata->SearchElementsPerRow = 0;
+
+  int groupsX = (int)ceil(cdata->SearchTextureResolution.x / float(VALUESEARCH_TEXELS_PER_GROUP));
+  int groupsY = (int)ceil(cdata->SearchTextureResolution.y / float(VALUESEARCH_TEXELS_PER_GROUP));
+
+  gl.glUnmapBuffer(eGL_UNIFORM_BUFFER);
+
+  gl.glActiveTexture((RDCGLenum)(eGL_TEXTURE0 + texSlot));
+  gl.glBindTexture(target, texname);
+  if(texSlot == RESTYPE_TEXRECT || texSlot == RESTYPE_TEXBUFFER)
+    gl.glBindSampler(texSlot, DebugData.pointNoMipSampler);
+  else
+    gl.glBindSampler(texSlot, DebugData.pointSampler);
+
+  int maxlevel = -1;
+
+  int clampmaxlevel = details.mips - 1;
+
+  gl.glGetTextureParameterivEXT(texname, target, eGL_TEXTURE_MAX_LEVEL, (GLint *)&maxlevel);
+
+  // need to ensure texture is mipmap complete by clamping TEXTURE_MAX_LEVEL.
+  if(clampmaxlevel != maxlevel)
+  {
+    gl.glTextureParameterivEXT(texname, target, eGL_TEXTURE_MAX_LEVEL, (GLint *)&clampmaxlevel);
+  }
+  else
+  {
+    maxlevel = -1;
+  }
+
+  PrepareValueSearch(params.maxMatches);
+
+  gl.glUseProgram(DebugData.valueSearchTexProgram[texSlot]);
+  gl.glDispatchCompute(groupsX, groupsY, 1);
+
+  FetchValueSearchResults(params.maxMatches, matches, numMatches);
+
+  if(maxlevel >= 0)
+    gl.glTextureParameterivEXT(texname, target, eGL_TEXTURE_MAX_LEVEL, (GLint *)&maxlevel);
+
+  return true;
+}
+
+bool GLReplay::SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                  uint32_t numElems, const ValueSearchParams &params,
+                                  vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  if(m_pDriver->m_Buffers.find(buff) == m_pDriver->m_Buffers.end())
+    return false;
+
+  if(!HasExt[ARB_compute_shader] || DebugData.valueSearchBufProgram == 0)
+    return false;
+
+  // the shader reads the buffer as dwords
+  if(stride == 0 || (stride % 4) != 0 || (offset % 4) != 0)
+  {
+    RDCWARN("Can't search buffer with offset %llu and stride %u, must be dword aligned", offset,
+            stride);
+    return false;
+  }
+
+  auto &buf = m_pDriver->m_Buffers[buff];
+
+  if(offset >= buf.size)
+    return true;
+
+  numElems = (uint32_t)RDCMIN(uint64_t(numElems), (buf.size - offset) / stride);
+
+  if(numElems == 0)
+    return true;
+
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  MakeCurrentReplayContext(m_DebugCtx);
+
+  // spread the groups over rows so that large buffers don't exceed the dispatch limit
+  uint32_t numGroups = (numElems + VALUESEARCH_ELEMS_PER_GROUP - 1) / VALUESEARCH_ELEMS_PER_GROUP;
+  uint32_t groupsX = RDCMIN(numGroups, 65535U);
+  uint32_t groupsY = (numGroups + groupsX - 1) / groupsX;
+
+  gl.glBindBufferBase(eGL_UNIFORM_BUFFER, 2, DebugData.UBOs[0]);
+  ValueSearchUBOData *cdata =
+      (ValueSearchUBOData *)gl.glMapBufferRange(eGL_UNIFORM_BUFFER, 0, sizeof(ValueSearchUBOData),
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+  RDCEraseMem(cdata, sizeof(ValueSearchUBOData));
+
+  cdata->SearchFlags = params.flags;
+  cdata->SearchMin = params.minValue;
+  cdata->SearchMax = params.maxValue;
+  cdata->SearchChannels = params.channelMask;
+  cdata->SearchMaxMatches = params.maxMatches;
+
+  cdata->SearchStride = stride / 4;
+  cdata->SearchOffset = uint32_t(offset / 4);
+  cdata->SearchNumElements = numElems;
+  cdata->SearchElementsPerRow = groupsX * VALUESEARCH_ELEMS_PER_GROUP;
+
+  gl.glUnmapBuffer(eGL_UNIFORM_BUFFER);
+
+  gl.glBindBufferBase(eGL_SHADER_STORAGE_BUFFER, 1, buf.resource.name);
+
+  PrepareValueSearch(params.maxMatches);
+
+  gl.glUseProgram(DebugData.valueSearchBufProgram);
+  gl.glDispatchCompute(groupsX, groupsY, 1);
+
+  FetchValueSearchResults(params.maxMatches, matches, numMatches);
+
+  return true;
+}
+
+void GLReplay::CreateDiffTexture(GLuint &tex, uint32_t w, uint32_t h)
+{
+  if(tex)
+  {
+    uint32_t oldw = 0, oldh = 0;
+    m_pDriver->glGetTextureLevelParameterivEXT(tex, eGL_TEXTURE_2D, 0, eGL_TEXTURE_WIDTH,
+                                               (GLint *)&oldw);
+    m_pDriver->glGetTextureLevelParameterivEXT(tex, eGL_TEXTURE_2D, 0, eGL_TEXTURE_HEIGHT,
+                                               (GLint *)&oldh);
+
+    if(oldw == w && oldh == h)
+      return;
+
+    m_pDriver->glDeleteTextures(1, &tex);
+    tex = 0;
+  }
+
+  // created through the driver so it's tracked like any other texture, and can be displayed
+  m_pDriver->glGenTextures(1, &tex);
+  m_pDriver->glBindTexture(eGL_TEXTURE_2D, tex);
+  m_pDriver->glTextureImage2DEXT(tex, eGL_TEXTURE_2D, 0, eGL_RGBA32F, (GLsizei)w, (GLsizei)h, 0,
+                                 eGL_RGBA, eGL_FLOAT, NULL);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_MIN_FILTER, eGL_NEAREST);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_MAG_FILTER, eGL_NEAREST);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_BASE_LEVEL, 0);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_MAX_LEVEL, 0);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_WRAP_S, eGL_CLAMP_TO_EDGE);
+  m_pDriver->glTexParameteri(eGL_TEXTURE_2D, eGL_TEXTURE_WRAP_T, eGL_CLAMP_TO_EDGE);
+}
+
+bool GLReplay::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                   uint32_t mip, uint32_t sample, FormatComponentType typeHint)
+{
+  if(input >= ARRAY_COUNT(DebugData.diffInputs) || texid == ResourceId() ||
+     m_pDriver->m_Textures.find(texid) == m_pDriver->m_Textures.end())
+    return false;
+
+  if(!HasExt[ARB_compute_shader] || DebugData.diffProgram == 0)
+    return false;
+
+  auto &texDetails = m_pDriver->m_Textures[texid];
+
+  // raw output of integer textures is their bits, which can't be subtracted as floats
+  if(IsUIntFormat(texDetails.internalFormat) || IsSIntFormat(texDetails.internalFormat))
+    return false;
+
+  uint32_t w = (uint32_t)RDCMAX(1, texDetails.width >> mip);
+  uint32_t h = (uint32_t)RDCMAX(1, texDetails.height >> mip);
+
+  MakeCurrentReplayContext(m_DebugCtx);
+
+  CreateDiffTexture(DebugData.diffInputs[input], w, h);
+
+  // render the subresource 1:1 with raw output, which resolves renderbuffers, depth and any
+  // texture type down to floats in a plain 2D texture
+  m_pDriver->glBindFramebuffer(eGL_FRAMEBUFFER, DebugData.diffFBO);
+  m_pDriver->glFramebufferTexture2D(eGL_FRAMEBUFFER, eGL_COLOR_ATTACHMENT0, eGL_TEXTURE_2D,
+                                    DebugData.diffInputs[input], 0);
+
+  m_pDriver->glViewport(0, 0, w, h);
+
+  DebugData.outWidth = float(w);
+  DebugData.outHeight = float(h);
+
+  float clr[] = {0.0f, 0.0f, 0.0f, 0.0f};
+  m_pDriver->glClearBufferfv(eGL_COLOR, 0, clr);
+
+  TextureDisplay disp;
+  disp.Red = disp.Green = disp.Blue = disp.Alpha = true;
+  disp.FlipY = false;
+  disp.offx = 0.0f;
+  disp.offy = 0.0f;
+  disp.CustomShader = ResourceId();
+  disp.texid = texid;
+  disp.typeHint = typeHint;
+  disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector(0, 0, 0, 0);
+  disp.HDRMul = -1.0f;
+  disp.linearDisplayAsGamma = false;
+  disp.mip = mip;
+  disp.sampleIdx = sample;
+  disp.overlay = eTexOverlay_None;
+  disp.rangemin = 0.0f;
+  disp.rangemax = 1.0f;
+  disp.rawoutput = true;
+  disp.scale = 1.0f;
+  disp.sliceFace = sliceFace;
+
+  if(!RenderTextureInternal(disp, eTexDisplay_MipShift))
+    return false;
+
+  DebugData.diffInputWidth[input] = w;
+  DebugData.diffInputHeight[input] = h;
+
+  return true;
+}
+
+bool GLReplay::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  RDCEraseEl(result);
+
+  if(DebugData.diffProgram == 0 || DebugData.diffInputs[0] == 0 || DebugData.diffInputs[1] == 0)
+    return false;
+
+  uint32_t w = RDCMIN(DebugData.diffInputWidth[0], DebugData.diffInputWidth[1]);
+  uint32_t h = RDCMIN(DebugData.diffInputHeight[0], DebugData.diffInputHeight[1]);
+
+  MakeCurrentReplayContext(m_DebugCtx);
+
+  CreateDiffTexture(DebugData.diffTex, w, h);
+
+  DebugData.DiffTexID =
+      m_pDriver->GetResourceManager()->GetID(TextureRes(m_pDriver->GetCtx(), DebugData.diffTex));
+
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  gl.glBindBufferBase(eGL_UNIFORM_BUFFER, 2, DebugData.UBOs[0]);
+  TexDiffUBOData *cdata =
+      (TexDiffUBOData *)gl.glMapBufferRange(eGL_UNIFORM_BUFFER, 0, sizeof(TexDiffUBOData),
+                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+  cdata->DiffWidth = w;
+  cdata->DiffHeight = h;
+  cdata->DiffThreshold = threshold;
+  cdata->Padding5 = 0;
+
+  gl.glUnmapBuffer(eGL_UNIFORM_BUFFER);
+
+  gl.glBindImageTexture(0, DebugData.diffInputs[0], 0, GL_FALSE, 0, eGL_READ_ONLY, eGL_RGBA32F);
+  gl.glBindImageTexture(1, DebugData.diffInputs[1], 0, GL_FALSE, 0, eGL_READ_ONLY, eGL_RGBA32F);
+  gl.glBindImageTexture(2, DebugData.diffTex, 0, GL_FALSE, 0, eGL_WRITE_ONLY, eGL_RGBA32F);
+
+  gl.glBindBufferBase(eGL_SHADER_STORAGE_BUFFER, 0, DebugData.diffResult);
+
+  Vec4u zero[2] = {};
+  gl.glBufferSubData(eGL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero);
+
+  gl.glUseProgram(DebugData.diffProgram);
+  gl.glDispatchCompute((w + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP,
+                       (h + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP, 1);
+
+  // the diff texture is sampled for display and min/max afterwards
+  gl.glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                     GL_TEXTURE_FETCH_BARRIER_BIT);
+
+  Vec4u stats[2] = {};
+  gl.glBindBuffer(eGL_COPY_READ_BUFFER, DebugData.diffResult);
+  gl.glGetBufferSubData(eGL_COPY_READ_BUFFER, 0, sizeof(stats), stats);
+
+  RDCCOMPILE_ASSERT(sizeof(result.maxError) == sizeof(stats[0]), "max error doesn't match shader");
+  memcpy(result.maxError, &stats[0], sizeof(result.maxError));
+
+  result.diffTexture = DebugData.DiffTexID;
+  result.width = w;
+  result.height = h;
+  result.numDifferent = stats[1].x;
+
+  return true;
+}
+
 uint32_t GLReplay::PickVertex(uint32_t eventID, const MeshDisplay &cfg, uint32_t x, uint32_t y)
 {
   WrappedOpenGL &gl = *m_pDriver;
@@ -1293,6 +1772,9 @@ uint32_t GLReplay::PickVertex(uint32_t eventID, const MeshDisplay &cfg, uint32_t
   cdata->coords = Vec2f((float)x, (float)y);
   cdata->viewport = Vec2f(DebugData.outWidth, DebugData.outHeight);
 
+  // every vertex or primitive is tested
+  cdata->numGroupedPrims = 0;
+
   gl.glUnmapBuffer(eGL_UNIFORM_BUFFER);
 
   GLuint ib = 0;
@@ -1676,7 +2158,9 @@ void GLReplay::CopyTex2DMSToArray(GLuint destArray, GLuint srcMS, GLint width, G
 
   gl.glDeleteTextures(2, texs);
 
-  rs.ApplyState(m_pDriver->GetCtx(), m_pDriver);
+  GLRenderState bound(&gl.GetHookset(), NULL, READING);
+  bound.FetchState(m_pDriver->GetCtx(), m_pDriver);
+  rs.ApplyState(m_pDriver->GetCtx(), m_pDriver, &bound);
 }
 
 bool GLReplay::RenderTexture(TextureDisplay cfg)
@@ -2635,7 +3119,9 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FormatComponentType typeHin
       else
       {
         // if we don't replay the real state, restore what we've changed
-        rs.ApplyState(ctx, &gl);
+        GLRenderState bound(&gl.GetHookset(), NULL, READING);
+        bound.FetchState(ctx, &gl);
+        rs.ApplyState(ctx, &gl, &bound);
       }
 
       float black[] = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -2693,9 +3179,15 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FormatComponentType typeHin
     if(!events.empty())
     {
       if(overlay == eTexOverlay_TriangleSizePass)
+      {
         ReplayLog(events[0], eReplay_WithoutDraw);
+      }
       else
-        rs.ApplyState(m_pDriver->GetCtx(), m_pDriver);
+      {
+        GLRenderState bound(&gl.GetHookset(), NULL, READING);
+        bound.FetchState(m_pDriver->GetCtx(), m_pDriver);
+        rs.ApplyState(m_pDriver->GetCtx(), m_pDriver, &bound);
+      }
 
       // this all happens on the replay context so we need a temp FBO/VAO
       GLuint overlayFBO = 0, tempVAO = 0;
@@ -3115,9 +3607,15 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FormatComponentType typeHin
         gl.glFramebufferTexture(eGL_FRAMEBUFFER, eGL_DEPTH_STENCIL_ATTACHMENT, quadtexs[1], 0);
 
         if(overlay == eTexOverlay_QuadOverdrawPass)
+        {
           ReplayLog(events[0], eReplay_WithoutDraw);
+        }
         else
-          rs.ApplyState(m_pDriver->GetCtx(), m_pDriver);
+        {
+          GLRenderState bound(&gl.GetHookset(), NULL, READING);
+          bound.FetchState(m_pDriver->GetCtx(), m_pDriver);
+          rs.ApplyState(m_pDriver->GetCtx(), m_pDriver, &bound);
+        }
 
         for(size_t i = 0; i < events.size(); i++)
         {
@@ -3263,7 +3761,9 @@ ResourceId GLReplay::RenderOverlay(ResourceId texid, FormatComponentType typeHin
         "types");
   }
 
-  rs.ApplyState(m_pDriver->GetCtx(), m_pDriver);
+  GLRenderState bound(&gl.GetHookset(), NULL, READING);
+  bound.FetchState(m_pDriver->GetCtx(), m_pDriver);
+  rs.ApplyState(m_pDriver->GetCtx(), m_pDriver, &bound);
 
   return m_pDriver->GetResourceManager()->GetID(TextureRes(ctx, DebugData.overlayTex));
 }
@@ -3629,7 +4129,9 @@ void GLReplay::InitPostVSBuffers(uint32_t eventID)
     uint32_t numIndices =
         RDCMIN(uint32_t(idxdata.size() / drawcall->indexByteWidth), drawcall->numIndices);
 
-    // grab all unique vertex indices referenced
+    vector<uint32_t> remapped;
+    remapped.reserve(numIndices + 1);
+
     for(uint32_t i = 0; i < numIndices; i++)
     {
       uint32_t i32 = 0;
@@ -3640,18 +4142,13 @@ void GLReplay::InitPostVSBuffers(uint32_t eventID)
       else if(drawcall->indexByteWidth == 4)
         i32 = idx32[i];
 
-      auto it = std::lower_bound(indices.begin(), indices.end(), i32);
-
-      if(it != indices.end() && *it == i32)
-        continue;
-
-      indices.insert(it, i32);
+      remapped.push_back(i32);
     }
 
     // if we read out of bounds, we'll also have a 0 index being referenced
-    // (as 0 is read). Don't insert 0 if we already have 0 though
-    if(numIndices < drawcall->numIndices && (indices.empty() || indices[0] != 0))
-      indices.insert(indices.begin(), 0);
+    // (as 0 is read).
+    if(numIndices < drawcall->numIndices)
+      remapped.push_back(0);
 
     // An index buffer could be something like: 500, 501, 502, 501, 503, 502
     // in which case we can't use the existing index buffer without filling 499 slots of vertex
@@ -3663,15 +4160,7 @@ void GLReplay::InitPostVSBuffers(uint32_t eventID)
     // We just stream-out a tightly packed list of unique indices, and then remap the index buffer
     // so that what did point to 500 points to 0 (accounting for rebasing), and what did point
     // to 510 now points to 3 (accounting for the unique sort).
-
-    // we use a map here since the indices may be sparse. Especially considering if an index
-    // is 'invalid' like 0xcccccccc then we don't want an array of 3.4 billion entries.
-    map<uint32_t, size_t> indexRemap;
-    for(size_t i = 0; i < indices.size(); i++)
-    {
-      // by definition, this index will only appear once in indices[]
-      indexRemap[indices[i]] = i;
-    }
+    CompactIndices(remapped, indices);
 
     // generate a temporary index buffer with our 'unique index set' indices,
     // so we can transform feedback each referenced vertex once
@@ -3710,17 +4199,17 @@ void GLReplay::InitPostVSBuffers(uint32_t eventID)
     if(drawcall->indexByteWidth == 1)
     {
       for(uint32_t i = 0; i < numIndices; i++)
-        idx8[i] = uint8_t(indexRemap[idx8[i]]);
+        idx8[i] = uint8_t(remapped[i]);
     }
     else if(drawcall->indexByteWidth == 2)
     {
       for(uint32_t i = 0; i < numIndices; i++)
-        idx16[i] = uint16_t(indexRemap[idx16[i]]);
+        idx16[i] = uint16_t(remapped[i]);
     }
     else
     {
       for(uint32_t i = 0; i < numIndices; i++)
-        idx32[i] = uint32_t(indexRemap[idx32[i]]);
+        idx32[i] = remapped[i];
     }
 
     // make the index buffer that can be used to render this postvs data - the original
@@ -4455,6 +4944,86 @@ void GLReplay::InitPostVSBuffers(const vector<uint32_t> &passEvents)
   }
 }
 
+uint64_t GLReplay::GetPostVSDataSize(const GLPostVSData &data)
+{
+  WrappedOpenGL &gl = *m_pDriver;
+
+  GLuint bufs[] = {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf};
+
+  uint64_t ret = 0;
+
+  for(size_t i = 0; i < ARRAY_COUNT(bufs); i++)
+  {
+    if(bufs[i] == 0)
+      continue;
+
+    GLint size = 0;
+    gl.glGetNamedBufferParameterivEXT(bufs[i], eGL_BUFFER_SIZE, &size);
+    ret += (uint64_t)size;
+  }
+
+  return ret;
+}
+
+vector<ReplayMemoryStats> GLReplay::GetMemoryStats()
+{
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  ReplayMemoryStats stats = {};
+  stats.category = eReplayMemory_PostVSCache;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    stats.gpuBytes += GetPostVSDataSize(it->second);
+
+  return vector<ReplayMemoryStats>(1, stats);
+}
+
+void GLReplay::TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
+{
+  if(category != eReplayMemory_PostVSCache)
+    return;
+
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  WrappedOpenGL &gl = *m_pDriver;
+
+  uint64_t total = 0;
+
+  // the events furthest from the current one are evicted first, as they're the least likely to
+  // be looked at again soon
+  vector<pair<uint32_t, uint32_t> > candidates;
+  map<uint32_t, uint64_t> sizes;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    uint64_t size = GetPostVSDataSize(it->second);
+    total += size;
+    sizes[it->first] = size;
+
+    if(it->first != eventID && size > 0)
+    {
+      uint32_t dist = it->first > eventID ? it->first - eventID : eventID - it->first;
+      candidates.push_back(std::make_pair(dist, it->first));
+    }
+  }
+
+  std::sort(candidates.rbegin(), candidates.rend());
+
+  for(size_t i = 0; i < candidates.size() && total > budget; i++)
+  {
+    GLPostVSData &data = m_PostVSData[candidates[i].second];
+
+    total -= sizes[candidates[i].second];
+
+    gl.glDeleteBuffers(1, &data.vsout.buf);
+    gl.glDeleteBuffers(1, &data.vsout.idxBuf);
+    gl.glDeleteBuffers(1, &data.gsout.buf);
+    gl.glDeleteBuffers(1, &data.gsout.idxBuf);
+
+    m_PostVSData.erase(candidates[i].second);
+  }
+}
+
 MeshFormat GLReplay::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
 {
   GLPostVSData postvs;
@@ -320,6 +320,8 @@ const char *GLChunkNames[] = {
 
     "wglDXRegisterObjectNV",
     "wglDXLockObjectsNV",
+
+    "SwapBuffers",
 };
 
 GLInitParams::GLInitParams()
@@ -344,6 +346,7 @@ const uint32_t GLInitParams::GL_OLD_VERSIONS[GLInitParams::GL_NUM_SUPPORTED_OLD_
                  // anything special to support older logs, just make sure we don't open new logs
                  // in an older version.
     0x000012,    // Added support for GL-DX interop
+    0x000013,    // The capture footer now stores any event timings recorded while capturing
 };
 
 ReplayCreateStatus GLInitParams::Serialise()
@@ -390,6 +393,11 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs, GLPlat
   if(RenderDoc::Inst().GetCrashHandler())
     RenderDoc::Inst().GetCrashHandler()->RegisterMemoryRegion(this, sizeof(WrappedOpenGL));
 
+  threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
+
+  m_ShaderReflCacheDirty = false;
+  m_ShaderReflDriverHash = 0;
+
   globalExts.push_back("GL_ARB_arrays_of_arrays");
   globalExts.push_back("GL_ARB_base_instance");
   globalExts.push_back("GL_ARB_blend_func_extended");
@@ -733,6 +741,8 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs, GLPlat
   m_FailureReason = CaptureSucceeded;
 
   m_AppControlledCapture = false;
+  m_CapSpanFrames = 0;
+  m_CapSpanWindow = NULL;
 
   m_RealDebugFunc = NULL;
   m_RealDebugFuncParam = NULL;
@@ -747,6 +757,10 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs, GLPlat
 
   m_FetchCounters = false;
 
+  m_EventTimingActive = false;
+
+  m_DrawcallCallback = NULL;
+
   RDCEraseEl(m_ActiveQueries);
   m_ActiveConditional = false;
   m_ActiveFeedback = false;
@@ -816,6 +830,8 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs, GLPlat
 
     InitSPIRVCompiler();
     RenderDoc::Inst().RegisterShutdownFunction(&ShutdownSPIRVCompiler);
+
+    LoadShaderReflectionCache();
   }
 
   m_FakeBB_FBO = 0;
@@ -1013,6 +1029,11 @@ WrappedOpenGL::~WrappedOpenGL()
 
   SAFE_DELETE(m_pSerialiser);
 
+  for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
+    delete m_ThreadSerialisers[i];
+
+  SaveShaderReflectionCache();
+
   GetResourceManager()->ReleaseCurrentResource(m_DeviceResourceID);
   GetResourceManager()->ReleaseCurrentResource(m_ContextResourceID);
 
@@ -1036,18 +1057,63 @@ WrappedOpenGL::~WrappedOpenGL()
     RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 }
 
+// these are called from entry points that only hold the GL lock shared, so they mustn't insert.
+// Contexts and their data are added in ActivateContext, which always holds it exclusively.
 void *WrappedOpenGL::GetCtx()
 {
-  return (void *)m_ActiveContexts[Threading::GetCurrentID()].ctx;
+  auto it = m_ActiveContexts.find(Threading::GetCurrentID());
+  if(it == m_ActiveContexts.end())
+    return NULL;
+  return (void *)it->second.ctx;
 }
 
 WrappedOpenGL::ContextData &WrappedOpenGL::GetCtxData()
 {
-  return m_ContextData[GetCtx()];
+  void *ctx = GetCtx();
+  auto it = m_ContextData.find(ctx);
+  if(it != m_ContextData.end())
+    return it->second;
+  return m_ContextData[ctx];
+}
+
+void WrappedOpenGL::MarkDirtyOutputs()
+{
+  ContextData &cd = GetCtxData();
+
+  if(!cd.m_OutputBindingsChanged)
+    return;
+
+  cd.m_OutputBindingsChanged = false;
+
+  GLRenderState state(&m_Real, GetSerialiser(), m_State);
+  state.MarkDirty(this);
+}
+
+Serialiser *WrappedOpenGL::GetThreadSerialiser()
+{
+  Serialiser *ser = (Serialiser *)Threading::GetTLSValue(threadSerialiserTLSSlot);
+  if(ser)
+    return ser;
+
+  // slow path, but rare
+
+  ser = new Serialiser(NULL, Serialiser::WRITING, false);
+  ser->SetDebugText(m_pSerialiser->GetDebugText());
+
+  ser->SetChunkNameLookup(&GetChunkName);
+
+  Threading::SetTLSValue(threadSerialiserTLSSlot, (void *)ser);
+
+  {
+    SCOPED_LOCK(m_ThreadSerialisersLock);
+    m_ThreadSerialisers.push_back(ser);
+  }
+
+  return ser;
 }
 
 // defined in gl_<platform>_hooks.cpp
-Threading::CriticalSection &GetGLLock();
+GLLock &GetGLLock();
 
 ////////////////////////////////////////////////////////////////
 // Windowing/setup/etc
@@ -2252,7 +2318,7 @@ void WrappedOpenGL::FreeTargetResource(ResourceId id)
 
 void WrappedOpenGL::SwapBuffers(void *windowHandle)
 {
-  if(m_State == WRITING_IDLE)
+  if(m_State == WRITING_IDLE || RenderDoc::Inst().IsRingFrameActive())
     RenderDoc::Inst().Tick();
 
   // don't do anything if no context is active.
@@ -2325,9 +2391,7 @@ void WrappedOpenGL::SwapBuffers(void *windowHandle)
 
   if(m_State == WRITING_IDLE)
   {
-    uint32_t overlay = RenderDoc::Inst().GetOverlayBits();
-
-    if(overlay & eRENDERDOC_Overlay_Enabled)
+    if(RenderDoc::Inst().ShouldDrawOverlay())
     {
       RenderTextState textState;
 
@@ -2388,15 +2452,39 @@ void WrappedOpenGL::SwapBuffers(void *windowHandle)
   if(ctxdata.Legacy())
     return;
 
-  // kill any current capture that isn't application defined
+  // kill any current capture that isn't application defined, unless it's still recording a run of
+  // frames on this window, in which case the frame boundary is recorded and the capture continues
   if(m_State == WRITING_CAPFRAME && !m_AppControlledCapture)
-    RenderDoc::Inst().EndFrameCapture(ctxdata.ctx, windowHandle);
+  {
+    if(m_CapSpanFrames > 0 && m_CapSpanWindow == windowHandle)
+    {
+      m_CapSpanFrames--;
+
+      SCOPED_SERIALISE_CONTEXT(FRAME_BOUNDARY);
+      Serialise_FrameBoundary();
+
+      m_ContextRecord->AddChunk(scope.Get());
+    }
+    else
+    {
+      m_CapSpanFrames = 0;
+      RenderDoc::Inst().EndFrameCapture(ctxdata.ctx, windowHandle);
+    }
+  }
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && m_State == WRITING_IDLE)
+  uint32_t spanFrames = 0;
+  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter, spanFrames) && m_State == WRITING_IDLE)
   {
     RenderDoc::Inst().StartFrameCapture(ctxdata.ctx, windowHandle);
 
     m_AppControlledCapture = false;
+
+    // the run belongs to this capture, once it has actually started
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = windowHandle;
+    }
   }
 }
 
@@ -2443,7 +2531,7 @@ void WrappedOpenGL::StartFrameCapture(void *dev, void *wnd)
   if(m_State != WRITING_IDLE)
     return;
 
-  SCOPED_LOCK(GetGLLock());
+  SCOPED_GLLOCK(GetGLLock());
 
   RenderDoc::Inst().SetCurrentDriver(GetDriverType());
 
@@ -2501,7 +2589,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
   if(m_State != WRITING_CAPFRAME)
     return true;
 
-  SCOPED_LOCK(GetGLLock());
+  SCOPED_GLLOCK(GetGLLock());
 
   CaptureFailReason reason = CaptureSucceeded;
 
@@ -2581,22 +2669,22 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 
       RDCDEBUG("Accumulating context resource list");
 
-      map<int32_t, Chunk *> recordlist;
+      RecordChunkList recordlist;
       record->Insert(recordlist);
 
       RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
-      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-        m_pFileSerialiser->Insert(it->second);
+      vector<Chunk *> sortedChunks;
+      recordlist.Merge(sortedChunks);
+
+      for(size_t i = 0; i < sortedChunks.size(); i++)
+        m_pFileSerialiser->Insert(sortedChunks[i]);
 
       RDCDEBUG("Done");
     }
 
-    m_pFileSerialiser->FlushToDisk();
-
-    RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-    SAFE_DELETE(m_pFileSerialiser);
+    RenderDoc::Inst().FinishCaptureWrite(m_pFileSerialiser, m_FrameCounter);
+    m_pFileSerialiser = NULL;
 
     m_State = WRITING_IDLE;
 
@@ -2625,7 +2713,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 
     m_Failures++;
 
-    if((RenderDoc::Inst().GetOverlayBits() & eRENDERDOC_Overlay_Enabled))
+    if(RenderDoc::Inst().ShouldDrawOverlay())
     {
       ContextData &ctxdata = GetCtxData();
 
@@ -2847,12 +2935,109 @@ void WrappedOpenGL::Serialise_CaptureScope(uint64_t offset)
   }
 }
 
+void WrappedOpenGL::BeginEventTiming()
+{
+  if(m_State != WRITING_CAPFRAME || !RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings)
+    return;
+
+  if(m_Real.glQueryCounter == NULL || m_Real.glGetQueryObjectui64v == NULL)
+    return;
+
+  CapturedEventTiming timing;
+  timing.ctx = GetCtx();
+
+  // the event's chunk will be the next one recorded, unless a buffer update is still pending - it
+  // is added later but in its original place ahead of this event.
+  timing.chunkIndex = uint32_t(m_ContextRecord->NumChunks());
+  if(m_PendingBufferSubData.record)
+    timing.chunkIndex++;
+
+  m_Real.glGenQueries(2, timing.queries);
+  m_Real.glQueryCounter(timing.queries[0], eGL_TIMESTAMP);
+
+  m_EventTimings.push_back(timing);
+  m_EventTimingActive = true;
+}
+
+void WrappedOpenGL::EndEventTiming()
+{
+  if(!m_EventTimingActive)
+    return;
+
+  m_Real.glQueryCounter(m_EventTimings.back().queries[1], eGL_TIMESTAMP);
+
+  m_EventTimingActive = false;
+}
+
+void WrappedOpenGL::ResolveEventTimings(vector<uint32_t> &chunkIndices, vector<uint64_t> &durations)
+{
+  if(m_EventTimings.empty())
+    return;
+
+  void *ctx = GetCtx();
+
+  // make sure the results are returned to us and not written into an application's query buffer
+  GLuint prevbind = 0;
+  if(HasExt[ARB_query_buffer_object])
+  {
+    m_Real.glGetIntegerv(eGL_QUERY_BUFFER_BINDING, (GLint *)&prevbind);
+    m_Real.glBindBuffer(eGL_QUERY_BUFFER, 0);
+  }
+
+  uint32_t skipped = 0;
+
+  for(size_t i = 0; i < m_EventTimings.size(); i++)
+  {
+    const CapturedEventTiming &timing = m_EventTimings[i];
+
+    if(timing.ctx != ctx)
+    {
+      skipped++;
+      continue;
+    }
+
+    GLuint64 start = 0, end = 0;
+    m_Real.glGetQueryObjectui64v(timing.queries[0], eGL_QUERY_RESULT, &start);
+    m_Real.glGetQueryObjectui64v(timing.queries[1], eGL_QUERY_RESULT, &end);
+
+    chunkIndices.push_back(timing.chunkIndex);
+    durations.push_back(end > start ? end - start : 0);
+  }
+
+  if(HasExt[ARB_query_buffer_object])
+    m_Real.glBindBuffer(eGL_QUERY_BUFFER, prevbind);
+
+  if(skipped > 0)
+    RDCWARN("Dropping %u event timings recorded on other contexts, they can't be read back",
+            skipped);
+
+  FreeEventTimings();
+}
+
+void WrappedOpenGL::FreeEventTimings()
+{
+  void *ctx = GetCtx();
+
+  for(size_t i = 0; i < m_EventTimings.size(); i++)
+    if(m_EventTimings[i].ctx == ctx)
+      m_Real.glDeleteQueries(2, m_EventTimings[i].queries);
+
+  m_EventTimings.clear();
+  m_EventTimingActive = false;
+}
+
 void WrappedOpenGL::ContextEndFrame()
 {
+  FlushBufferSubData();
+
+  vector<uint32_t> timingChunks;
+  vector<uint64_t> timingDurations;
+  ResolveEventTimings(timingChunks, timingDurations);
+
   SCOPED_SERIALISE_CONTEXT(CONTEXT_CAPTURE_FOOTER);
 
   bool HasCallstack = RenderDoc::Inst().GetCaptureOptions().CaptureCallstacks != 0;
-  m_pSerialiser->Serialise("HasCallstack", HasCallstack);
+  GetSerialiser()->Serialise("HasCallstack", HasCallstack);
 
   if(HasCallstack)
   {
@@ -2861,19 +3046,42 @@ void WrappedOpenGL::ContextEndFrame()
     uint32_t numLevels = (uint32_t)call->NumLevels();
     uint64_t *stack = (uint64_t *)call->GetAddrs();
 
-    m_pSerialiser->SerialisePODArray("callstack", stack, numLevels);
+    GetSerialiser()->SerialisePODArray("callstack", stack, numLevels);
 
     delete call;
   }
 
+  GetSerialiser()->Serialise("timingChunks", timingChunks);
+  GetSerialiser()->Serialise("timingDurations", timingDurations);
+
   m_ContextRecord->AddChunk(scope.Get());
 }
 
+bool WrappedOpenGL::Serialise_FrameBoundary()
+{
+  // marks the end of one frame in a capture recording a run of them, so each frame's commands
+  // are separated in the event list. The backbuffer is only kept at the end of the capture
+  if(m_State == READING)
+  {
+    AddEvent("SwapBuffers()");
+
+    FetchDrawcall draw;
+    draw.name = "SwapBuffers()";
+    draw.flags |= eDraw_Present;
+
+    AddDrawcall(draw, true);
+  }
+
+  return true;
+}
+
 void WrappedOpenGL::CleanupCapture()
 {
   m_SuccessfulCapture = true;
   m_FailureReason = CaptureSucceeded;
 
+  FreeEventTimings();
+
   m_ContextRecord->LockChunks();
   while(m_ContextRecord->HasChunks())
   {
@@ -2886,6 +3094,8 @@ void WrappedOpenGL::CleanupCapture()
 
   m_ContextRecord->FreeParents(GetResourceManager());
 
+  m_PendingBufferSubData = PendingBufferSubData();
+
   for(auto it = m_MissingTracks.begin(); it != m_MissingTracks.end(); ++it)
   {
     if(GetResourceManager()->HasResourceRecord(*it))
@@ -2931,12 +3141,16 @@ void WrappedOpenGL::AttemptCapture()
       m_ContextRecord->PopChunk();
     }
     m_ContextRecord->UnlockChunks();
+
+    m_PendingBufferSubData = PendingBufferSubData();
+
+    FreeEventTimings();
   }
 }
 
 bool WrappedOpenGL::Serialise_BeginCaptureFrame(bool applyInitialState)
 {
-  GLRenderState state(&m_Real, m_pSerialiser, m_State);
+  GLRenderState state(&m_Real, GetSerialiser(), m_State);
 
   if(m_State >= WRITING)
   {
@@ -2949,7 +3163,12 @@ bool WrappedOpenGL::Serialise_BeginCaptureFrame(bool applyInitialState)
 
   if(m_State <= EXECUTING && applyInitialState)
   {
-    state.ApplyState(GetCtx(), this);
+    // partial replays restart from here over and over, usually with most of the frame's initial
+    // state still bound from the last replay, so only set what's changed since.
+    GLRenderState bound(&m_Real, NULL, READING);
+    bound.FetchState(GetCtx(), this);
+
+    state.ApplyState(GetCtx(), this, &bound);
   }
 
   return true;
@@ -3022,7 +3241,7 @@ void WrappedOpenGL::Serialise_DebugMessages()
       uint32_t numLevels = (uint32_t)call->NumLevels();
       uint64_t *stack = (uint64_t *)call->GetAddrs();
 
-      m_pSerialiser->SerialisePODArray("callstack", stack, numLevels);
+      GetSerialiser()->SerialisePODArray("callstack", stack, numLevels);
 
       delete call;
     }
@@ -3031,9 +3250,9 @@ void WrappedOpenGL::Serialise_DebugMessages()
       uint32_t numLevels = 0;
       uint64_t *stack = NULL;
 
-      m_pSerialiser->SerialisePODArray("callstack", stack, numLevels);
+      GetSerialiser()->SerialisePODArray("callstack", stack, numLevels);
 
-      m_pSerialiser->SetCallstack(stack, numLevels);
+      GetSerialiser()->SetCallstack(stack, numLevels);
 
       SAFE_DELETE_ARRAY(stack);
     }
@@ -3043,7 +3262,7 @@ void WrappedOpenGL::Serialise_DebugMessages()
 
   for(uint32_t i = 0; i < NumMessages; i++)
   {
-    ScopedContext msgscope(m_pSerialiser, "DebugMessage", "DebugMessage", 0, false);
+    ScopedContext msgscope(GetSerialiser(), "DebugMessage", "DebugMessage", 0, false);
 
     string desc;
     if(m_State >= WRITING)
@@ -3665,6 +3884,31 @@ void WrappedOpenGL::ProcessChunk(uint64_t offset, GLChunkType context)
         SAFE_DELETE_ARRAY(stack);
       }
 
+      if(GetLogVersion() >= 0x000014)
+      {
+        vector<uint32_t> timingChunks;
+        vector<uint64_t> timingDurations;
+
+        m_pSerialiser->Serialise("timingChunks", timingChunks);
+        m_pSerialiser->Serialise("timingDurations", timingDurations);
+
+        if(m_State == READING)
+        {
+          m_CapturedEventTimings.clear();
+
+          for(size_t i = 0; i < timingChunks.size() && i < timingDurations.size(); i++)
+          {
+            if(timingChunks[i] >= m_ChunkEventIDs.size())
+              continue;
+
+            double seconds = double(timingDurations[i]) / 1000000000.0;
+
+            m_CapturedEventTimings.push_back(CounterResult(
+                m_ChunkEventIDs[timingChunks[i]], eCounter_CapturedGPUDuration, seconds));
+          }
+        }
+      }
+
       if(m_State == READING)
       {
         AddEvent("SwapBuffers()");
@@ -3684,6 +3928,7 @@ void WrappedOpenGL::ProcessChunk(uint64_t offset, GLChunkType context)
       Serialise_wglDXRegisterObjectNV(GLResource(MakeNullResource), eGL_NONE, NULL);
       break;
     case INTEROP_DATA: Serialise_wglDXLockObjectsNV(GLResource(MakeNullResource)); break;
+    case FRAME_BOUNDARY: Serialise_FrameBoundary(); break;
     default:
       // ignore system chunks
       if((int)context == (int)INITIAL_CONTENTS)
@@ -3755,6 +4000,10 @@ void WrappedOpenGL::ContextReplayLog(LogState readType, uint32_t startEventID, u
     m_CurDrawcallID = 1;
     m_FirstEventID = 0;
     m_LastEventID = ~0U;
+
+    // the capture header is chunk 0, and has no event
+    m_ChunkEventIDs.clear();
+    m_ChunkEventIDs.push_back(0);
   }
 
   GetResourceManager()->MarkInFrame(true);
@@ -3773,7 +4022,13 @@ void WrappedOpenGL::ContextReplayLog(LogState readType, uint32_t startEventID, u
 
     GLChunkType chunktype = (GLChunkType)m_pSerialiser->PushContext(NULL, NULL, 1, false);
 
-    ContextProcessChunk(offset, chunktype);
+    if(m_State == READING)
+      m_ChunkEventIDs.push_back(m_CurEventID);
+
+    if(m_DrawcallCallback && m_State == EXECUTING)
+      ContextProcessChunkWithCallback(offset, chunktype);
+    else
+      ContextProcessChunk(offset, chunktype);
 
     RenderDoc::Inst().SetProgress(FrameEventsRead,
                                   float(offset - startOffset) / float(m_pSerialiser->GetSize()));
@@ -3843,6 +4098,52 @@ void WrappedOpenGL::ContextProcessChunk(uint64_t offset, GLChunkType chunk)
   m_AddedDrawcall = false;
 }
 
+void WrappedOpenGL::ContextProcessChunkWithCallback(uint64_t offset, GLChunkType chunk)
+{
+  uint32_t eventID = m_CurEventID;
+
+  const FetchDrawcall *draw = GetDrawcall(eventID);
+  uint32_t flags = draw ? draw->flags : 0;
+
+  const uint32_t miscFlags = eDraw_Clear | eDraw_Copy | eDraw_Resolve | eDraw_GenMips;
+
+  if(flags & eDraw_Drawcall)
+    m_DrawcallCallback->PreDraw(eventID);
+  else if(flags & eDraw_Dispatch)
+    m_DrawcallCallback->PreDispatch(eventID);
+  else if(flags & miscFlags)
+    m_DrawcallCallback->PreMisc(eventID, flags);
+
+  ContextProcessChunk(offset, chunk);
+
+  if(flags & eDraw_Drawcall)
+  {
+    bool redraw = m_DrawcallCallback->PostDraw(eventID);
+
+    while(redraw)
+    {
+      // step back to the start of the chunk and process it again as if for the first time
+      m_pSerialiser->SetOffset(offset);
+      m_CurEventID = eventID;
+
+      GLChunkType redrawChunk = (GLChunkType)m_pSerialiser->PushContext(NULL, NULL, 1, false);
+      RDCASSERTEQUAL(redrawChunk, chunk);
+
+      ContextProcessChunk(offset, redrawChunk);
+
+      redraw = m_DrawcallCallback->PostRedraw(eventID);
+    }
+  }
+  else if(flags & eDraw_Dispatch)
+  {
+    m_DrawcallCallback->PostDispatch(eventID);
+  }
+  else if(flags & miscFlags)
+  {
+    m_DrawcallCallback->PostMisc(eventID, flags);
+  }
+}
+
 void WrappedOpenGL::AddUsage(const FetchDrawcall &d)
 {
   if((d.flags & (eDraw_Drawcall | eDraw_Dispatch)) == 0)
@@ -27,8 +27,10 @@
 
 #include <list>
 #include "common/common.h"
+#include "common/shader_cache.h"
 #include "common/timing.h"
 #include "core/core.h"
+#include "core/entry_profiler.h"
 #include "driver/shaders/spirv/spirv_common.h"
 #include "replay/replay_driver.h"
 #include "gl_common.h"
@@ -53,10 +55,10 @@ struct GLInitParams : public RDCInitParams
   uint32_t width;
   uint32_t height;
 
-  static const uint32_t GL_SERIALISE_VERSION = 0x0000013;
+  static const uint32_t GL_SERIALISE_VERSION = 0x0000014;
 
   // backwards compatibility for old logs described at the declaration of this array
-  static const uint32_t GL_NUM_SUPPORTED_OLD_VERSIONS = 3;
+  static const uint32_t GL_NUM_SUPPORTED_OLD_VERSIONS = 4;
   static const uint32_t GL_OLD_VERSIONS[GL_NUM_SUPPORTED_OLD_VERSIONS];
 
   // version number internal to opengl stream
@@ -99,6 +101,30 @@ struct DrawcallTreeNode
   }
 };
 
+// similar to VulkanDrawcallCallback, but GL has no command buffers to re-record. Replaying a
+// drawcall's chunk again is the redraw:
+//
+// PreDraw()
+// do draw call as specified by the log
+// if PostDraw() returns true:
+//   do draw call again
+//   loop while PostRedraw() returns true
+//
+// so an implementation can do any number of modified draws before restoring state for the real
+// one. Dispatches and copy/blit/clear/etc only get a notification before and after.
+struct GLDrawcallCallback
+{
+  virtual void PreDraw(uint32_t eid) = 0;
+  virtual bool PostDraw(uint32_t eid) = 0;
+  virtual bool PostRedraw(uint32_t eid) = 0;
+
+  virtual void PreDispatch(uint32_t eid) = 0;
+  virtual void PostDispatch(uint32_t eid) = 0;
+
+  virtual void PreMisc(uint32_t eid, uint32_t flags) = 0;
+  virtual void PostMisc(uint32_t eid, uint32_t flags) = 0;
+};
+
 struct Replacement
 {
   Replacement(ResourceId i, GLResource r) : id(i), res(r) {}
@@ -155,6 +181,21 @@ private:
   LogState m_State;
   bool m_AppControlledCapture;
 
+  // presents left in a run of frames being combined into this capture, only counted on the
+  // window the capture started on
+  uint32_t m_CapSpanFrames;
+  void *m_CapSpanWindow;
+
+  // while writing, each thread records its chunks through its own serialiser so that
+  // threads uploading resources in the background don't share serialiser state with the
+  // render thread. Chunks are already ordered globally by their ID when the log is written.
+  uint64_t threadSerialiserTLSSlot;
+
+  Threading::CriticalSection m_ThreadSerialisersLock;
+  vector<Serialiser *> m_ThreadSerialisers;
+
+  Serialiser *GetThreadSerialiser();
+
   GLReplay m_Replay;
   RDCDriver m_DriverType;
 
@@ -198,6 +239,44 @@ private:
 
   set<ResourceId> m_HighTrafficResources;
 
+  // while capturing, a run of buffer updates to touching ranges of one buffer
+  // with nothing else recorded in between is accumulated here and serialised as
+  // a single chunk, in the place of the first update in the run.
+  struct PendingBufferSubData
+  {
+    PendingBufferSubData() : record(NULL), chunkID(0), offset(0) {}
+    GLResourceRecord *record;
+    int32_t chunkID;
+    uint64_t offset;
+    vector<byte> data;
+  };
+  PendingBufferSubData m_PendingBufferSubData;
+
+  // returns true if a glBufferData was orphaning and has been handled
+  bool CaptureBufferOrphan(GLResourceRecord *record, GLsizeiptr size, const void *data,
+                           GLenum usage);
+  void CaptureBufferSubData(GLResourceRecord *record, GLintptr offset, GLsizeiptr size,
+                            const void *data);
+  void FlushBufferSubData();
+
+  // with eRENDERDOC_Option_CaptureEventTimings a pair of timestamps is written around each draw
+  // and dispatch in the captured frame, identified by where the event's chunk lands in the context
+  // record. Query objects aren't shared between contexts, so only the timings made on the context
+  // that ends the capture can be read back.
+  struct CapturedEventTiming
+  {
+    void *ctx;
+    GLuint queries[2];
+    uint32_t chunkIndex;
+  };
+  vector<CapturedEventTiming> m_EventTimings;
+  bool m_EventTimingActive;
+
+  void BeginEventTiming();
+  void EndEventTiming();
+  void ResolveEventTimings(vector<uint32_t> &chunkIndices, vector<uint64_t> &durations);
+  void FreeEventTimings();
+
   // we store two separate sets of maps, since for an explicit glMemoryBarrier
   // we need to flush both types of maps, but for implicit sync points we only
   // want to consider coherent maps, and since that happens often we want it to
@@ -219,6 +298,12 @@ private:
       PersistentMapMemoryBarrier(m_CoherentMaps);
   }
 
+  // while idle, every draw or dispatch marks the resources it could write to as
+  // dirty. Dirty resources stay dirty, so the bound outputs only need to be
+  // queried again after one of the functions that can change them has been
+  // called on this context (see ContextData::m_OutputBindingsChanged).
+  void MarkDirtyOutputs();
+
   vector<FetchFrameInfo> m_CapturedFrames;
   FetchFrameRecord m_FrameRecord;
   vector<FetchDrawcall *> m_Drawcalls;
@@ -233,6 +318,11 @@ private:
   uint32_t m_FirstEventID;
   uint32_t m_LastEventID;
 
+  // the event ID of each chunk in the frame, as it's read, to match up the timings recorded at
+  // capture time with the events they were recorded around.
+  vector<uint32_t> m_ChunkEventIDs;
+  vector<CounterResult> m_CapturedEventTimings;
+
   DrawcallTreeNode m_ParentDrawcall;
 
   list<DrawcallTreeNode *> m_DrawcallStack;
@@ -241,6 +331,8 @@ private:
 
   bool m_FetchCounters;
 
+  GLDrawcallCallback *m_DrawcallCallback;
+
   // buffer used
   vector<byte> m_ScratchBuf;
 
@@ -301,6 +393,7 @@ private:
     GLuint prog;
 
     void Compile(WrappedOpenGL &gl);
+    void Disassemble();
   };
 
   struct ProgramData
@@ -334,6 +427,24 @@ private:
   };
 
   map<ResourceId, ShaderData> m_Shaders;
+
+  // on replay, reflection built for a shader is cached on disk keyed by a hash of its sources and
+  // the driver it was reflected on, so that later loads can skip querying the program interface
+  // and compiling to SPIR-V.
+  static const uint32_t m_ShaderReflCacheMagic = 0xf00d0a11;
+  static const uint32_t m_ShaderReflCacheVersion = 1;
+
+  bool m_ShaderReflCacheDirty;
+  uint32_t m_ShaderReflDriverHash;
+  map<uint32_t, vector<byte> *> m_ShaderReflCache;
+  ShaderCacheFile m_ShaderReflCacheFile;
+
+  void LoadShaderReflectionCache();
+  void SaveShaderReflectionCache();
+  uint32_t GetShaderReflectionHash(GLenum type, const vector<string> &sources, bool pointSizeUsed,
+                                   bool clipDistanceUsed);
+  bool FetchCachedShaderReflection(uint32_t hash, ShaderReflection &refl);
+  void CacheShaderReflection(uint32_t hash, const ShaderReflection &refl);
   map<ResourceId, ProgramData> m_Programs;
   map<ResourceId, PipelineData> m_Pipelines;
   vector<pair<ResourceId, Replacement> > m_DependentReplacements;
@@ -351,6 +462,7 @@ private:
   void ProcessChunk(uint64_t offset, GLChunkType context);
   void ContextReplayLog(LogState readType, uint32_t startEventID, uint32_t endEventID, bool partial);
   void ContextProcessChunk(uint64_t offset, GLChunkType chunk);
+  void ContextProcessChunkWithCallback(uint64_t offset, GLChunkType chunk);
   void AddUsage(const FetchDrawcall &d);
   void AddDrawcall(const FetchDrawcall &d, bool hasEvents);
   void AddEvent(string description);
@@ -366,6 +478,7 @@ private:
   void BeginCaptureFrame();
   void FinishCapture();
   void ContextEndFrame();
+  bool Serialise_FrameBoundary();
 
   void CleanupCapture();
   void FreeCaptureData();
@@ -390,6 +503,7 @@ private:
       m_Renderbuffer = ResourceId();
       m_TextureUnit = 0;
       m_ProgramPipeline = m_Program = 0;
+      m_OutputBindingsChanged = true;
     }
 
     void *ctx;
@@ -444,6 +558,11 @@ private:
     GLuint m_ProgramPipeline;
     GLuint m_Program;
 
+    // set whenever a framebuffer attachment, image or transform feedback binding
+    // may have changed, so that the next idle draw knows to re-mark its outputs
+    // as dirty. Indexed buffer binds already mark the buffer dirty immediately
+    bool m_OutputBindingsChanged;
+
     GLResourceRecord *GetActiveTexRecord() { return m_TextureRecord[m_TextureUnit]; }
     // GLES allows drawing from client memory, in which case we will copy to
     // temporary VBOs so that input mesh data is recorded. See struct ClientMemoryData
@@ -531,6 +650,7 @@ public:
   void *GetCtx();
 
   void SetFetchCounters(bool in) { m_FetchCounters = in; };
+  void SetDrawcallCB(GLDrawcallCallback *cb) { m_DrawcallCallback = cb; }
   const GLHookSet &GetHookset() { return m_Real; }
   const GLHookSet &GetInternalHookset() { return m_Internal; }
   void SetDebugMsgContext(const char *context) { m_DebugMsgContext = context; }
@@ -548,13 +668,17 @@ public:
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
   void ReadLogInitialisation();
 
-  Serialiser *GetSerialiser() { return m_pSerialiser; }
+  Serialiser *GetSerialiser()
+  {
+    return m_State >= WRITING ? GetThreadSerialiser() : m_pSerialiser;
+  }
   GLuint GetFakeBBFBO() { return m_FakeBB_FBO; }
   GLuint GetFakeVAO() { return m_FakeVAO; }
   FetchFrameRecord &GetFrameRecord() { return m_FrameRecord; }
   FetchAPIEvent GetEvent(uint32_t eventID);
 
   const DrawcallTreeNode &GetRootDraw() { return m_ParentDrawcall; }
+  const vector<CounterResult> &GetCapturedEventTimings() { return m_CapturedEventTimings; }
   const FetchDrawcall *GetDrawcall(uint32_t eventID);
 
   void SuppressDebugMessages(bool suppress) { m_SuppressDebugMessages = suppress; }
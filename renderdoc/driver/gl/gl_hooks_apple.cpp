@@ -33,7 +33,7 @@
 
 #include "driver/gl/gl_hookset_defs.h"
 
-Threading::CriticalSection glLock;
+GLLock glLock;
 
 class OpenGLHook : LibraryHook
 {
@@ -85,7 +85,7 @@ const GLHookSet &GetRealGLFunctions()
   return dummyHookset;
 }
 
-Threading::CriticalSection &GetGLLock()
+GLLock &GetGLLock()
 {
   return glLock;
 }
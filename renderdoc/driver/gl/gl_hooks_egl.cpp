@@ -124,6 +124,10 @@ public:
       const EGLint ctxAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_CONTEXT_FLAGS_KHR,
                                    EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR, EGL_NONE};
 
+      // a context shared with a surfaceless one is surfaceless too, as there may be no config
+      // that supports pbuffers on a headless display
+      bool surfaceless = (share.egl_wnd == EGL_NO_SURFACE);
+
       const EGLint attribs[] = {EGL_RED_SIZE,
                                 8,
                                 EGL_GREEN_SIZE,
@@ -131,7 +135,7 @@ public:
                                 EGL_BLUE_SIZE,
                                 8,
                                 EGL_SURFACE_TYPE,
-                                EGL_PBUFFER_BIT,
+                                surfaceless ? 0 : EGL_PBUFFER_BIT,
                                 EGL_RENDERABLE_TYPE,
                                 EGL_OPENGL_ES3_BIT,
                                 EGL_CONFORMANT,
@@ -154,7 +158,10 @@ public:
         if(configFound)
         {
           const EGLint pbAttribs[] = {EGL_WIDTH, 32, EGL_HEIGHT, 32, EGL_NONE};
-          ret.egl_wnd = eglCreatePbufferSurface(share.egl_dpy, config, pbAttribs);
+          if(surfaceless)
+            ret.egl_wnd = EGL_NO_SURFACE;
+          else
+            ret.egl_wnd = eglCreatePbufferSurface(share.egl_dpy, config, pbAttribs);
           ret.egl_dpy = share.egl_dpy;
           ret.egl_ctx = eglCreateContext_real(share.egl_dpy, config, share.ctx, ctxAttribs);
         }
@@ -192,6 +199,12 @@ public:
 
   void GetOutputWindowDimensions(GLWindowingData context, int32_t &w, int32_t &h)
   {
+    if(context.egl_wnd == EGL_NO_SURFACE)
+    {
+      w = h = 0;
+      return;
+    }
+
     eglQuerySurface_real(context.egl_dpy, context.egl_wnd, EGL_WIDTH, &w);
     eglQuerySurface_real(context.egl_dpy, context.egl_wnd, EGL_HEIGHT, &h);
   }
@@ -215,32 +228,33 @@ public:
         break;
       }
 #endif
-      case eWindowingSystem_Unknown: {
-#if ENABLED(RDOC_LINUX)
-        // allow undefined so that internally we can create a window-less context
-        Display *dpy = XOpenDisplay(NULL);
-        if(dpy == NULL)
-          return ret;
-        break;
-#endif
-      }
+      // allow undefined so that internally we can create a window-less context
+      case eWindowingSystem_Unknown: break;
       default: RDCERR("Unexpected window system %u", system); break;
     }
 
-    EGLDisplay eglDisplay = eglGetDisplay_real(EGL_DEFAULT_DISPLAY);
+    // internal contexts must live on the same display as the replay context, which may be a
+    // headless device display rather than the default one
+    EGLDisplay eglDisplay = share_context.egl_dpy;
+    if(eglDisplay == EGL_NO_DISPLAY)
+      eglDisplay = eglGetDisplay_real(EGL_DEFAULT_DISPLAY);
     RDCASSERT(eglDisplay);
 
-    static const EGLint configAttribs[] = {EGL_RED_SIZE,
-                                           8,
-                                           EGL_GREEN_SIZE,
-                                           8,
-                                           EGL_BLUE_SIZE,
-                                           8,
-                                           EGL_RENDERABLE_TYPE,
-                                           EGL_OPENGL_ES3_BIT,
-                                           EGL_SURFACE_TYPE,
-                                           EGL_PBUFFER_BIT | EGL_WINDOW_BIT,
-                                           EGL_NONE};
+    // with no window to render to, follow the replay context in being surfaceless if it is
+    bool surfaceless = (window == 0 && share_context.egl_ctx != EGL_NO_CONTEXT &&
+                        share_context.egl_wnd == EGL_NO_SURFACE);
+
+    const EGLint configAttribs[] = {EGL_RED_SIZE,
+                                    8,
+                                    EGL_GREEN_SIZE,
+                                    8,
+                                    EGL_BLUE_SIZE,
+                                    8,
+                                    EGL_RENDERABLE_TYPE,
+                                    EGL_OPENGL_ES3_BIT,
+                                    EGL_SURFACE_TYPE,
+                                    surfaceless ? 0 : EGL_PBUFFER_BIT | EGL_WINDOW_BIT,
+                                    EGL_NONE};
 
     PFN_eglChooseConfig eglChooseConfig = (PFN_eglChooseConfig)dlsym(RTLD_NEXT, "eglChooseConfig");
     PFN_eglCreateWindowSurface eglCreateWindowSurface =
@@ -273,7 +287,7 @@ public:
     {
       surface = eglCreateWindowSurface(eglDisplay, config, window, NULL);
     }
-    else
+    else if(!surfaceless)
     {
       static const EGLint pbAttribs[] = {EGL_WIDTH, 32, EGL_HEIGHT, 32, EGL_NONE};
       surface = eglCreatePbufferSurface(eglDisplay, config, pbAttribs);
@@ -445,7 +459,7 @@ __attribute__((visibility("default"))) EGLContext eglCreateContext(EGLDisplay di
 
   eglhooks.GetDriver()->SetDriverType(RDC_OpenGLES);
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     eglhooks.GetDriver()->CreateContext(data, shareContext, init, true, true);
   }
 
@@ -459,7 +473,7 @@ __attribute__((visibility("default"))) EGLBoolean eglDestroyContext(EGLDisplay d
 
   eglhooks.GetDriver()->SetDriverType(RDC_OpenGLES);
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     eglhooks.GetDriver()->DeleteContext(ctx);
   }
 
@@ -474,7 +488,7 @@ __attribute__((visibility("default"))) EGLBoolean eglMakeCurrent(EGLDisplay disp
 
   EGLBoolean ret = eglhooks.eglMakeCurrent_real(display, draw, read, ctx);
 
-  SCOPED_LOCK(glLock);
+  SCOPED_GLLOCK(glLock);
 
   if(ctx && eglhooks.m_Contexts.find(ctx) == eglhooks.m_Contexts.end())
   {
@@ -499,7 +513,7 @@ __attribute__((visibility("default"))) EGLBoolean eglSwapBuffers(EGLDisplay dpy,
   if(eglhooks.eglSwapBuffers_real == NULL)
     eglhooks.SetupExportedFunctions();
 
-  SCOPED_LOCK(glLock);
+  SCOPED_GLLOCK(glLock);
 
   int height, width;
   eglhooks.eglQuerySurface_real(dpy, surface, EGL_HEIGHT, &height);
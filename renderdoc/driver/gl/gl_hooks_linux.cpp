@@ -475,7 +475,7 @@ __attribute__((visibility("default"))) GLXContext glXCreateContext(Display *dpy,
   data.ctx = ret;
 
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     glhooks.GetDriver()->CreateContext(data, shareList, init, false, false);
   }
 
@@ -488,7 +488,7 @@ __attribute__((visibility("default"))) void glXDestroyContext(Display *dpy, GLXC
     glhooks.SetupExportedFunctions();
 
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     glhooks.GetDriver()->DeleteContext(ctx);
   }
 
@@ -596,7 +596,7 @@ __attribute__((visibility("default"))) GLXContext glXCreateContextAttribsARB(
   data.ctx = ret;
 
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     glhooks.GetDriver()->CreateContext(data, shareList, init, core, true);
   }
 
@@ -611,7 +611,7 @@ __attribute__((visibility("default"))) Bool glXMakeCurrent(Display *dpy, GLXDraw
 
   Bool ret = glhooks.glXMakeCurrent_real(dpy, drawable, ctx);
 
-  SCOPED_LOCK(glLock);
+  SCOPED_GLLOCK(glLock);
 
   if(ctx && glhooks.m_Contexts.find(ctx) == glhooks.m_Contexts.end())
   {
@@ -638,7 +638,7 @@ __attribute__((visibility("default"))) Bool glXMakeContextCurrent(Display *dpy,
 
   Bool ret = glhooks.glXMakeContextCurrent_real(dpy, draw, read, ctx);
 
-  SCOPED_LOCK(glLock);
+  SCOPED_GLLOCK(glLock);
 
   if(ctx && glhooks.m_Contexts.find(ctx) == glhooks.m_Contexts.end())
   {
@@ -662,7 +662,7 @@ __attribute__((visibility("default"))) void glXSwapBuffers(Display *dpy, GLXDraw
   if(glhooks.glXSwapBuffers_real == NULL)
     glhooks.SetupExportedFunctions();
 
-  SCOPED_LOCK(glLock);
+  SCOPED_GLLOCK(glLock);
 
   // if we use the GLXDrawable in XGetGeometry and it's a GLXWindow, then we get
   // a BadDrawable error and things go south. Instead we track GLXWindows created
@@ -746,7 +746,7 @@ __attribute__((visibility("default"))) GLXWindow glXCreateWindow(Display *dpy, G
   GLXWindow ret = glhooks.glXCreateWindow_real(dpy, config, win, attribList);
 
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     glhooks.AddGLXWindow(ret, win);
   }
 
@@ -759,7 +759,7 @@ __attribute__((visibility("default"))) void glXDestroyWindow(Display *dpy, GLXWi
     glhooks.SetupExportedFunctions();
 
   {
-    SCOPED_LOCK(glLock);
+    SCOPED_GLLOCK(glLock);
     glhooks.RemoveGLXWindow(window);
   }
 
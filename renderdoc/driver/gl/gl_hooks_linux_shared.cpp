@@ -34,11 +34,11 @@
 
 GLHookSet GL;
 WrappedOpenGL *m_GLDriver;
-Threading::CriticalSection glLock;
+GLLock glLock;
 void *libGLdlsymHandle =
     RTLD_NEXT;    // default to RTLD_NEXT, but overwritten if app calls dlopen() on real libGL
 
-Threading::CriticalSection &GetGLLock()
+GLLock &GetGLLock()
 {
   return glLock;
 }
@@ -103,7 +103,7 @@ Threading::CriticalSection &GetGLLock()
   done;
         echo ") \\";
 
-        echo -en "\t{ SCOPED_LOCK(glLock); return m_GLDriver->function(";
+        echo -en "\t{ SCOPED_GLENTRY(glLock, function); return m_GLDriver->function(";
             for I in `seq 1 $N`; do echo -n "p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo "); } \\";
 
@@ -112,7 +112,7 @@ Threading::CriticalSection &GetGLLock()
   done;
         echo ") \\";
 
-        echo -en "\t{ SCOPED_LOCK(glLock); return m_GLDriver->function(";
+        echo -en "\t{ SCOPED_GLENTRY(glLock, function); return m_GLDriver->function(";
             for I in `seq 1 $N`; do echo -n "p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo -n "); }";
     }
@@ -140,72 +140,72 @@ Threading::CriticalSection &GetGLLock()
   typedef ret (*CONCAT(function, _hooktype))();                    \
   extern "C" __attribute__((visibility("default"))) ret function() \
   {                                                                \
-    SCOPED_LOCK(glLock);                                           \
+    SCOPED_GLENTRY(glLock, function);                              \
     return m_GLDriver->function();                                 \
   }                                                                \
   ret CONCAT(function, _renderdoc_hooked)()                        \
   {                                                                \
-    SCOPED_LOCK(glLock);                                           \
+    SCOPED_GLENTRY(glLock, function);                              \
     return m_GLDriver->function();                                 \
   }
 #define HookWrapper1(ret, function, t1, p1)                             \
   typedef ret (*CONCAT(function, _hooktype))(t1);                       \
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1) \
   {                                                                     \
-    SCOPED_LOCK(glLock);                                                \
+    SCOPED_GLENTRY(glLock, function);                                   \
     return m_GLDriver->function(p1);                                    \
   }                                                                     \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1)                        \
   {                                                                     \
-    SCOPED_LOCK(glLock);                                                \
+    SCOPED_GLENTRY(glLock, function);                                   \
     return m_GLDriver->function(p1);                                    \
   }
 #define HookWrapper2(ret, function, t1, p1, t2, p2)                            \
   typedef ret (*CONCAT(function, _hooktype))(t1, t2);                          \
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2) \
   {                                                                            \
-    SCOPED_LOCK(glLock);                                                       \
+    SCOPED_GLENTRY(glLock, function);                                          \
     return m_GLDriver->function(p1, p2);                                       \
   }                                                                            \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2)                        \
   {                                                                            \
-    SCOPED_LOCK(glLock);                                                       \
+    SCOPED_GLENTRY(glLock, function);                                          \
     return m_GLDriver->function(p1, p2);                                       \
   }
 #define HookWrapper3(ret, function, t1, p1, t2, p2, t3, p3)                           \
   typedef ret (*CONCAT(function, _hooktype))(t1, t2, t3);                             \
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3) \
   {                                                                                   \
-    SCOPED_LOCK(glLock);                                                              \
+    SCOPED_GLENTRY(glLock, function);                                                 \
     return m_GLDriver->function(p1, p2, p3);                                          \
   }                                                                                   \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3)                        \
   {                                                                                   \
-    SCOPED_LOCK(glLock);                                                              \
+    SCOPED_GLENTRY(glLock, function);                                                 \
     return m_GLDriver->function(p1, p2, p3);                                          \
   }
 #define HookWrapper4(ret, function, t1, p1, t2, p2, t3, p3, t4, p4)                          \
   typedef ret (*CONCAT(function, _hooktype))(t1, t2, t3, t4);                                \
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3, t4 p4) \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4);                                             \
   }                                                                                          \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4)                        \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4);                                             \
   }
 #define HookWrapper5(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5)                         \
   typedef ret (*CONCAT(function, _hooktype))(t1, t2, t3, t4, t5);                                   \
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5) \
   {                                                                                                 \
-    SCOPED_LOCK(glLock);                                                                            \
+    SCOPED_GLENTRY(glLock, function);                                                               \
     return m_GLDriver->function(p1, p2, p3, p4, p5);                                                \
   }                                                                                                 \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5)                        \
   {                                                                                                 \
-    SCOPED_LOCK(glLock);                                                                            \
+    SCOPED_GLENTRY(glLock, function);                                                               \
     return m_GLDriver->function(p1, p2, p3, p4, p5);                                                \
   }
 #define HookWrapper6(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6)          \
@@ -213,12 +213,12 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3, t4 p4, \
                                                                  t5 p5, t6 p6)               \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6);                                     \
   }                                                                                          \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6)          \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6);                                     \
   }
 #define HookWrapper7(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7)  \
@@ -226,12 +226,12 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3, t4 p4, \
                                                                  t5 p5, t6 p6, t7 p7)        \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7);                                 \
   }                                                                                          \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7)   \
   {                                                                                          \
-    SCOPED_LOCK(glLock);                                                                     \
+    SCOPED_GLENTRY(glLock, function);                                                        \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7);                                 \
   }
 #define HookWrapper8(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8) \
@@ -239,12 +239,12 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(t1 p1, t2 p2, t3 p3, t4 p4,        \
                                                                  t5 p5, t6 p6, t7 p7, t8 p8)        \
   {                                                                                                 \
-    SCOPED_LOCK(glLock);                                                                            \
+    SCOPED_GLENTRY(glLock, function);                                                               \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8);                                    \
   }                                                                                                 \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8)   \
   {                                                                                                 \
-    SCOPED_LOCK(glLock);                                                                            \
+    SCOPED_GLENTRY(glLock, function);                                                               \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8);                                    \
   }
 #define HookWrapper9(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,   \
@@ -253,13 +253,13 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(                                 \
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9)                              \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9);                              \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9)                                                  \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9);                              \
   }
 #define HookWrapper10(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,  \
@@ -268,13 +268,13 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(                                 \
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10)                     \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);                         \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9, t10 p10)                                         \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);                         \
   }
 #define HookWrapper11(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,  \
@@ -283,13 +283,13 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(                                 \
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11)            \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);                    \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9, t10 p10, t11 p11)                                \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);                    \
   }
 #define HookWrapper12(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,  \
@@ -298,13 +298,13 @@ Threading::CriticalSection &GetGLLock()
   extern "C" __attribute__((visibility("default"))) ret function(                                 \
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12)   \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12);               \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9, t10 p10, t11 p11, t12 p12)                       \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12);               \
   }
 #define HookWrapper13(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,  \
@@ -315,13 +315,13 @@ Threading::CriticalSection &GetGLLock()
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12,   \
       t13 p13)                                                                                    \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13);          \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9, t10 p10, t11 p11, t12 p12, t13 p13)              \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13);          \
   }
 #define HookWrapper14(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,  \
@@ -332,13 +332,13 @@ Threading::CriticalSection &GetGLLock()
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12,   \
       t13 p13, t14 p14)                                                                           \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14);     \
   }                                                                                               \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, \
                                           t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14)     \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14);     \
   }
 #define HookWrapper15(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8,   \
@@ -349,14 +349,14 @@ Threading::CriticalSection &GetGLLock()
       t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12,    \
       t13 p13, t14 p14, t15 p15)                                                                   \
   {                                                                                                \
-    SCOPED_LOCK(glLock);                                                                           \
+    SCOPED_GLENTRY(glLock, function);                                                              \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); \
   }                                                                                                \
   ret CONCAT(function, _renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8,  \
                                           t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14,      \
                                           t15 p15)                                                 \
   {                                                                                                \
-    SCOPED_LOCK(glLock);                                                                           \
+    SCOPED_GLENTRY(glLock, function);                                                              \
     return m_GLDriver->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); \
   }
 
@@ -35,5 +35,5 @@ bool SharedPopulateHooks(void *(*lookupFunc)(const char *));
 
 extern GLHookSet GL;
 extern WrappedOpenGL *m_GLDriver;
-extern Threading::CriticalSection glLock;
+extern GLLock glLock;
 extern void *libGLdlsymHandle;
@@ -96,7 +96,7 @@
   done;
         echo ") \\";
 
-        echo -en "\t{ SCOPED_LOCK(glLock);";
+        echo -en "\t{ SCOPED_GLENTRY(glLock, function);";
         echo -en "if(!glhooks.m_HaveContextCreation) return glhooks.GL.function(";
             for I in `seq 1 $N`; do echo -n "p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo -en "); return glhooks.GetDriver()->function(";
@@ -122,7 +122,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(); \
   static ret WINAPI CONCAT(function, _hooked)()       \
   {                                                   \
-    SCOPED_LOCK(glLock);                              \
+    SCOPED_GLENTRY(glLock, function);                 \
     if(!glhooks.m_HaveContextCreation)                \
       return glhooks.GL.function();                   \
     return glhooks.GetDriver()->function();           \
@@ -132,7 +132,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1); \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1)    \
   {                                                     \
-    SCOPED_LOCK(glLock);                                \
+    SCOPED_GLENTRY(glLock, function);                   \
     if(!glhooks.m_HaveContextCreation)                  \
       return glhooks.GL.function(p1);                   \
     return glhooks.GetDriver()->function(p1);           \
@@ -142,7 +142,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2); \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2) \
   {                                                         \
-    SCOPED_LOCK(glLock);                                    \
+    SCOPED_GLENTRY(glLock, function);                       \
     if(!glhooks.m_HaveContextCreation)                      \
       return glhooks.GL.function(p1, p2);                   \
     return glhooks.GetDriver()->function(p1, p2);           \
@@ -152,7 +152,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3);    \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3) \
   {                                                                \
-    SCOPED_LOCK(glLock);                                           \
+    SCOPED_GLENTRY(glLock, function);                              \
     if(!glhooks.m_HaveContextCreation)                             \
       return glhooks.GL.function(p1, p2, p3);                      \
     return glhooks.GetDriver()->function(p1, p2, p3);              \
@@ -162,7 +162,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3, t4);       \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4) \
   {                                                                       \
-    SCOPED_LOCK(glLock);                                                  \
+    SCOPED_GLENTRY(glLock, function);                                     \
     if(!glhooks.m_HaveContextCreation)                                    \
       return glhooks.GL.function(p1, p2, p3, p4);                         \
     return glhooks.GetDriver()->function(p1, p2, p3, p4);                 \
@@ -172,7 +172,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3, t4, t5);          \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5) \
   {                                                                              \
-    SCOPED_LOCK(glLock);                                                         \
+    SCOPED_GLENTRY(glLock, function);                                            \
     if(!glhooks.m_HaveContextCreation)                                           \
       return glhooks.GL.function(p1, p2, p3, p4, p5);                            \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5);                    \
@@ -182,7 +182,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3, t4, t5, t6);             \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6) \
   {                                                                                     \
-    SCOPED_LOCK(glLock);                                                                \
+    SCOPED_GLENTRY(glLock, function);                                                   \
     if(!glhooks.m_HaveContextCreation)                                                  \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6);                               \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6);                       \
@@ -192,7 +192,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3, t4, t5, t6, t7);                \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7) \
   {                                                                                            \
-    SCOPED_LOCK(glLock);                                                                       \
+    SCOPED_GLENTRY(glLock, function);                                                          \
     if(!glhooks.m_HaveContextCreation)                                                         \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7);                                  \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7);                          \
@@ -202,7 +202,7 @@
   typedef ret(WINAPI *CONCAT(function, _hooktype))(t1, t2, t3, t4, t5, t6, t7, t8);                   \
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8) \
   {                                                                                                   \
-    SCOPED_LOCK(glLock);                                                                              \
+    SCOPED_GLENTRY(glLock, function);                                                                 \
     if(!glhooks.m_HaveContextCreation)                                                                \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8);                                     \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8);                             \
@@ -214,7 +214,7 @@
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7,  \
                                               t8 p8, t9 p9)                                     \
   {                                                                                             \
-    SCOPED_LOCK(glLock);                                                                        \
+    SCOPED_GLENTRY(glLock, function);                                                           \
     if(!glhooks.m_HaveContextCreation)                                                          \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9);                           \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9);                   \
@@ -226,7 +226,7 @@
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7,   \
                                               t8 p8, t9 p9, t10 p10)                             \
   {                                                                                              \
-    SCOPED_LOCK(glLock);                                                                         \
+    SCOPED_GLENTRY(glLock, function);                                                            \
     if(!glhooks.m_HaveContextCreation)                                                           \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);                       \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);               \
@@ -238,7 +238,7 @@
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7,    \
                                               t8 p8, t9 p9, t10 p10, t11 p11)                     \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     if(!glhooks.m_HaveContextCreation)                                                            \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);                   \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);           \
@@ -251,7 +251,7 @@
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7,    \
                                               t8 p8, t9 p9, t10 p10, t11 p11, t12 p12)            \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     if(!glhooks.m_HaveContextCreation)                                                            \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12);              \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12);      \
@@ -265,7 +265,7 @@
   static ret WINAPI CONCAT(function, _hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7,    \
                                               t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13)   \
   {                                                                                               \
-    SCOPED_LOCK(glLock);                                                                          \
+    SCOPED_GLENTRY(glLock, function);                                                             \
     if(!glhooks.m_HaveContextCreation)                                                            \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13);         \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13); \
@@ -280,7 +280,7 @@
                                               t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13,  \
                                               t14 p14)                                           \
   {                                                                                              \
-    SCOPED_LOCK(glLock);                                                                         \
+    SCOPED_GLENTRY(glLock, function);                                                            \
     if(!glhooks.m_HaveContextCreation)                                                           \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14);   \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, \
@@ -296,14 +296,14 @@
                                               t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13,     \
                                               t14 p14, t15 p15)                                     \
   {                                                                                                 \
-    SCOPED_LOCK(glLock);                                                                            \
+    SCOPED_GLENTRY(glLock, function);                                                               \
     if(!glhooks.m_HaveContextCreation)                                                              \
       return glhooks.GL.function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); \
     return glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13,    \
                                          p14, p15);                                                 \
   }
 
-Threading::CriticalSection glLock;
+GLLock glLock;
 
 typedef BOOL(WINAPI *WGLMAKECURRENTPROC)(HDC, HGLRC);
 typedef BOOL(WINAPI *WGLDELETECONTEXTPROC)(HGLRC);
@@ -841,7 +841,7 @@ private:
     DWORD err = GetLastError();
 
     {
-      SCOPED_LOCK(glLock);
+      SCOPED_GLLOCK(glLock);
 
       if(rc && glhooks.m_HaveContextCreation &&
          glhooks.m_Contexts.find(rc) == glhooks.m_Contexts.end())
@@ -871,7 +871,7 @@ private:
 
     if(w != NULL && glhooks.m_HaveContextCreation)
     {
-      SCOPED_LOCK(glLock);
+      SCOPED_GLLOCK(glLock);
 
       RECT r;
       GetClientRect(w, &r);
@@ -1484,7 +1484,7 @@ GLPlatform &GetGLPlatform()
   return OpenGLHook::glhooks;
 }
 
-Threading::CriticalSection &GetGLLock()
+GLLock &GetGLLock()
 {
   return glLock;
 }
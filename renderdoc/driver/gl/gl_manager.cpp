@@ -886,6 +886,10 @@ void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, Resourc
 
       gl.glTextureParameterivEXT(res.name, details.curType, eGL_TEXTURE_MAX_LEVEL,
                                  (GLint *)&state->maxLevel);
+
+      // the readback of the copy is issued in bulk once every resource has been prepared
+      if(m_State >= WRITING)
+        m_PendingTextureReadbacks.push_back(origid);
     }
 
     SetInitialContents(origid, InitialContentData(TextureRes(res.Context, tex), 0, (byte *)state));
@@ -908,6 +912,185 @@ void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, Resourc
   }
 }
 
+void GLResourceManager::BeginPrepare_InitialStates()
+{
+  const GLHookSet &gl = m_GL->GetInternalHookset();
+
+  // free any readbacks left over from a capture that never got as far as serialising
+  for(auto it = m_TextureReadbacks.begin(); it != m_TextureReadbacks.end(); ++it)
+    gl.glDeleteBuffers(1, &it->second);
+
+  m_TextureReadbacks.clear();
+  m_PendingTextureReadbacks.clear();
+}
+
+void GLResourceManager::EndPrepare_InitialStates()
+{
+  if(m_PendingTextureReadbacks.empty())
+    return;
+
+  const GLHookSet &gl = m_GL->GetInternalHookset();
+
+  GLuint ppb = 0;
+  gl.glGetIntegerv(eGL_PIXEL_PACK_BUFFER_BINDING, (GLint *)&ppb);
+
+  PixelPackState pack;
+  pack.Fetch(&gl, false);
+
+  ResetPixelPackState(gl, false, 1);
+
+  vector<TextureReadbackImage> images;
+
+  // all the copies have been submitted by now, so queue up a readback of each into a pixel pack
+  // buffer. The GPU works through these in order behind the copies and the buffers are only
+  // mapped when the initial contents are serialised at the end of the frame.
+  for(size_t i = 0; i < m_PendingTextureReadbacks.size(); i++)
+  {
+    ResourceId id = m_PendingTextureReadbacks[i];
+
+    GLuint tex = GetInitialContents(id).resource.name;
+
+    images.clear();
+    GetTextureReadbackImages(gl, id, tex, images);
+
+    size_t totalSize = 0;
+    for(size_t img = 0; img < images.size(); img++)
+      totalSize += images[img].size;
+
+    if(totalSize == 0)
+      continue;
+
+    WrappedOpenGL::TextureData &details = m_GL->m_Textures[id];
+
+    GLuint buf = 0;
+    gl.glGenBuffers(1, &buf);
+    gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, buf);
+    gl.glNamedBufferDataEXT(buf, (GLsizeiptr)totalSize, NULL, eGL_STREAM_READ);
+
+    bool iscomp = IsCompressedFormat(details.internalFormat);
+
+    GLenum fmt = eGL_NONE;
+    GLenum type = eGL_NONE;
+    if(!iscomp)
+    {
+      fmt = GetBaseFormat(details.internalFormat);
+      type = GetDataType(details.internalFormat);
+    }
+
+    GLenum binding = TextureBinding(details.curType);
+
+    GLuint prevtex = 0;
+    gl.glGetIntegerv(binding, (GLint *)&prevtex);
+
+    gl.glBindTexture(details.curType, tex);
+
+    size_t offs = 0;
+
+    for(size_t img = 0; img < images.size(); img++)
+    {
+      const TextureReadbackImage &image = images[img];
+
+      // like Serialise_InitialState, avoid glGetTextureImageEXT for uncompressed data as it seems
+      // buggy for cubemap faces
+      if(iscomp)
+        gl.glGetCompressedTextureImageEXT(tex, image.target, image.level, (void *)offs);
+      else
+        gl.glGetTexImage(image.target, image.level, fmt, type, (void *)offs);
+
+      offs += image.size;
+    }
+
+    gl.glBindTexture(details.curType, prevtex);
+
+    m_TextureReadbacks[id] = buf;
+  }
+
+  m_PendingTextureReadbacks.clear();
+
+  gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, ppb);
+
+  pack.Apply(&gl, false);
+}
+
+void GLResourceManager::GetTextureReadbackImages(const GLHookSet &gl, ResourceId id, GLuint tex,
+                                                 vector<TextureReadbackImage> &images)
+{
+  WrappedOpenGL::TextureData &details = m_GL->m_Textures[id];
+
+  // this must walk the sub-images in exactly the order and size that Serialise_InitialState
+  // writes them out
+  if(details.internalFormat == eGL_NONE || details.curType == eGL_TEXTURE_BUFFER || details.view)
+    return;
+
+  bool iscomp = IsCompressedFormat(details.internalFormat);
+
+  if(!iscomp && details.samples > 1)
+    return;
+
+  int mips = GetNumMips(gl, details.curType, tex, details.width, details.height, details.depth);
+
+  GLenum targets[] = {
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_X, eGL_TEXTURE_CUBE_MAP_NEGATIVE_X,
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_Y, eGL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+      eGL_TEXTURE_CUBE_MAP_POSITIVE_Z, eGL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+  };
+
+  int count = ARRAY_COUNT(targets);
+
+  if(details.curType != eGL_TEXTURE_CUBE_MAP)
+  {
+    targets[0] = details.curType;
+    count = 1;
+  }
+
+  GLenum fmt = eGL_NONE;
+  GLenum type = eGL_NONE;
+  if(!iscomp)
+  {
+    fmt = GetBaseFormat(details.internalFormat);
+    type = GetDataType(details.internalFormat);
+  }
+
+  GLint w = details.width;
+  GLint h = details.height;
+  GLint d = details.depth;
+
+  for(int i = 0; i < mips; i++)
+  {
+    size_t size = 0;
+
+    if(iscomp)
+    {
+      size = GetCompressedByteSize(w, h, d, details.internalFormat, i);
+
+      if(w > 0)
+        w = RDCMAX(1, w >> 1);
+      if(h > 0)
+        h = RDCMAX(1, h >> 1);
+      if(d > 0)
+        d = RDCMAX(1, d >> 1);
+    }
+    else
+    {
+      int mipw = RDCMAX(details.width >> i, 1);
+      int miph = RDCMAX(details.height >> i, 1);
+      int mipd = RDCMAX(details.depth >> i, 1);
+
+      if(details.curType == eGL_TEXTURE_CUBE_MAP_ARRAY ||
+         details.curType == eGL_TEXTURE_1D_ARRAY || details.curType == eGL_TEXTURE_2D_ARRAY)
+        mipd = details.depth;
+
+      size = GetByteSize(mipw, miph, mipd, fmt, type);
+    }
+
+    for(int trg = 0; trg < count; trg++)
+    {
+      TextureReadbackImage image = {targets[trg], i, size};
+      images.push_back(image);
+    }
+  }
+}
+
 bool GLResourceManager::Force_InitialState(GLResource res, bool prepare)
 {
   if(res.Namespace != eResBuffer && res.Namespace != eResTexture)
@@ -1010,9 +1193,10 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
       SERIALISE_ELEMENT(uint32_t, len, 0);
 
       size_t size = 0;
-      byte *data = NULL;
+      const byte *data = NULL;
 
-      m_pSerialiser->SerialiseBuffer("buf", data, size);
+      // uploaded straight out of the serialiser, rather than from a copy
+      m_pSerialiser->SerialiseBorrowedBuffer("buf", data, size);
 
       // create a new buffer big enough to hold the contents
       GLuint buf = 0;
@@ -1020,8 +1204,6 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
       gl.glBindBuffer(eGL_COPY_WRITE_BUFFER, buf);
       gl.glNamedBufferDataEXT(buf, (GLsizeiptr)len, data, eGL_STATIC_DRAW);
 
-      SAFE_DELETE_ARRAY(data);
-
       SetInitialContents(Id, InitialContentData(BufferRes(m_GL->GetCtx(), buf), len, NULL));
     }
   }
@@ -1099,6 +1281,24 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
       {
         GLuint tex = GetInitialContents(Id).resource.name;
 
+        // if a readback was issued while preparing, the sub-images are all waiting in order in a
+        // pixel pack buffer. Otherwise fall back to reading each one back synchronously.
+        GLuint readbackBuf = 0;
+        byte *readback = NULL;
+        size_t readbackOffs = 0;
+
+        auto readbackIt = m_TextureReadbacks.find(Id);
+        if(readbackIt != m_TextureReadbacks.end())
+        {
+          readbackBuf = readbackIt->second;
+          m_TextureReadbacks.erase(readbackIt);
+
+          readback = (byte *)gl.glMapNamedBufferEXT(readbackBuf, eGL_READ_ONLY);
+
+          if(!readback)
+            RDCERR("Couldn't map initial contents readback buffer, reading back synchronously");
+        }
+
         GLuint ppb = 0;
         gl.glGetIntegerv(eGL_PIXEL_PACK_BUFFER_BINDING, (GLint *)&ppb);
         gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, 0);
@@ -1159,6 +1359,16 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
             {
               size_t size = GetCompressedByteSize(w, h, d, details.internalFormat, i);
 
+              if(readback)
+              {
+                byte *buf = readback + readbackOffs;
+
+                m_pSerialiser->SerialiseBuffer("image", buf, size);
+
+                readbackOffs += size;
+                continue;
+              }
+
               byte *buf = new byte[size];
 
               gl.glGetCompressedTextureImageEXT(tex, targets[trg], i, buf);
@@ -1187,7 +1397,7 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
 
           size_t size = GetByteSize(details.width, details.height, details.depth, fmt, type);
 
-          byte *buf = new byte[size];
+          byte *buf = readback ? NULL : new byte[size];
 
           GLenum binding = TextureBinding(t);
 
@@ -1224,6 +1434,16 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
 
             for(int trg = 0; trg < count; trg++)
             {
+              if(readback)
+              {
+                byte *src = readback + readbackOffs;
+
+                m_pSerialiser->SerialiseBuffer("image", src, size);
+
+                readbackOffs += size;
+                continue;
+              }
+
               // we avoid glGetTextureImageEXT as it seems buggy for cubemap faces
               gl.glGetTexImage(targets[trg], i, fmt, type, buf);
 
@@ -1239,6 +1459,12 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
         gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, ppb);
 
         pack.Apply(&gl, false);
+
+        if(readback)
+          gl.glUnmapNamedBufferEXT(readbackBuf);
+
+        if(readbackBuf)
+          gl.glDeleteBuffers(1, &readbackBuf);
       }
     }
     else
@@ -1493,9 +1719,9 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
             for(int trg = 0; trg < count; trg++)
             {
               size_t size = 0;
-              byte *buf = NULL;
+              const byte *buf = NULL;
 
-              m_pSerialiser->SerialiseBuffer("image", buf, size);
+              m_pSerialiser->SerialiseBorrowedBuffer("image", buf, size);
 
               if(dim == 1)
                 gl.glCompressedTextureSubImage1DEXT(tex, targets[trg], i, 0, w, internalformat,
@@ -1506,8 +1732,6 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
               else if(dim == 3)
                 gl.glCompressedTextureSubImage3DEXT(tex, targets[trg], i, 0, 0, 0, w, h, d,
                                                     internalformat, (GLsizei)size, buf);
-
-              delete[] buf;
             }
           }
         }
@@ -1547,8 +1771,8 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
             for(int trg = 0; trg < count; trg++)
             {
               size_t size = 0;
-              byte *buf = NULL;
-              m_pSerialiser->SerialiseBuffer("image", buf, size);
+              const byte *buf = NULL;
+              m_pSerialiser->SerialiseBorrowedBuffer("image", buf, size);
 
               if(dim == 1)
                 gl.glTextureSubImage1DEXT(tex, targets[trg], i, 0, w, fmt, type, buf);
@@ -1556,8 +1780,6 @@ bool GLResourceManager::Serialise_InitialState(ResourceId resid, GLResource res)
                 gl.glTextureSubImage2DEXT(tex, targets[trg], i, 0, 0, w, h, fmt, type, buf);
               else if(dim == 3)
                 gl.glTextureSubImage3DEXT(tex, targets[trg], i, 0, 0, 0, w, h, d, fmt, type, buf);
-
-              delete[] buf;
             }
           }
         }
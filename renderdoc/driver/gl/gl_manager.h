@@ -222,6 +222,20 @@ private:
 
   void PrepareTextureInitialContents(ResourceId liveid, ResourceId origid, GLResource res);
 
+  void BeginPrepare_InitialStates();
+  void EndPrepare_InitialStates();
+
+  // one sub-image of a texture's initial contents, in the order it's serialised
+  struct TextureReadbackImage
+  {
+    GLenum target;
+    int level;
+    size_t size;
+  };
+
+  void GetTextureReadbackImages(const GLHookSet &gl, ResourceId id, GLuint tex,
+                                vector<TextureReadbackImage> &images);
+
   void Create_InitialState(ResourceId id, GLResource live, bool hasData);
   void Apply_InitialState(GLResource live, InitialContentData initial);
 
@@ -236,5 +250,11 @@ private:
   map<ResourceId, std::string> m_Names;
   volatile int64_t m_SyncName;
 
+  // texture initial contents copied while preparing, that still need a readback issued. Once
+  // issued, the pixel pack buffer holding all sub-images waits in m_TextureReadbacks until the
+  // texture is serialised, so nothing has to block on the GPU until then.
+  vector<ResourceId> m_PendingTextureReadbacks;
+  map<ResourceId, GLuint> m_TextureReadbacks;
+
   WrappedOpenGL *m_GL;
 };
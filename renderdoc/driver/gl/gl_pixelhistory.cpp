@@ -0,0 +1,597 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <algorithm>
+#include "gl_driver.h"
+#include "gl_replay.h"
+#include "gl_resources.h"
+
+// Pixel history is gathered in a single replay of the frame, the same way as on Vulkan. Every
+// candidate event gets a pair of slots in one pixel pack buffer that the target pixel is read into
+// before and after the event, and a pair of occlusion queries - one with the event's depth/stencil
+// tests and one without - to tell whether the event covered the pixel and whether any fragments
+// passed. The test draws are the event's own chunk replayed again with writes masked off and a
+// scissor around the pixel. Everything is read back once at the end.
+
+// each slot holds four 32-bit components, enough for any colour read back as RGBA. Depth targets
+// read depth as a float to the start of the slot and stencil as a byte just after.
+static const GLsizeiptr PixelHistorySlotSize = 16;
+static const GLintptr PixelHistoryStencilOffset = 4;
+
+struct GLPixelHistoryEventData
+{
+  GLPixelHistoryEventData()
+      : recorded(false),
+        preCopied(false),
+        postCopied(false),
+        testsQueried(false),
+        coverageQueried(false),
+        depthTest(false),
+        stencilTest(false),
+        scissorClipped(false)
+  {
+  }
+
+  // whether we saw this event at all during the replay
+  bool recorded;
+
+  // whether the pre and post values were read into this event's slots
+  bool preCopied, postCopied;
+
+  // which of the two occlusion queries were issued
+  bool testsQueried, coverageQueried;
+
+  // the relevant state at the draw, for classifying failed fragments
+  bool depthTest, stencilTest, scissorClipped;
+};
+
+struct GLPixelHistoryCallback : public GLDrawcallCallback
+{
+  GLPixelHistoryCallback(WrappedOpenGL *gl, const vector<EventUsage> &events, uint32_t x,
+                         uint32_t y, GLuint readFBO, GLenum baseFormat, bool integer,
+                         bool unsignedInt, GLuint buffer, const vector<GLuint> &queries)
+      : m_pDriver(gl),
+        m_X(x),
+        m_Y(y),
+        m_ReadFBO(readFBO),
+        m_BaseFormat(baseFormat),
+        m_Integer(integer),
+        m_UnsignedInt(unsignedInt),
+        m_Buffer(buffer),
+        m_Queries(queries),
+        m_PrevState(&gl->GetHookset(), NULL, READING),
+        m_Stage(eStage_None),
+        m_PausedFeedback(false)
+  {
+    for(size_t i = 0; i < events.size(); i++)
+      m_Slots[events[i].eventID] = (uint32_t)i;
+
+    m_Usages.resize(events.size());
+    for(size_t i = 0; i < events.size(); i++)
+      m_Usages[i] = events[i].usage;
+
+    m_Events.resize(events.size());
+
+    m_QueryTarget = IsGLES ? eGL_ANY_SAMPLES_PASSED : eGL_SAMPLES_PASSED;
+
+    m_pDriver->SetDrawcallCB(this);
+  }
+
+  ~GLPixelHistoryCallback() { m_pDriver->SetDrawcallCB(NULL); }
+  static GLintptr SlotOffset(uint32_t slot, bool post)
+  {
+    return (GLintptr(slot) * 2 + (post ? 1 : 0)) * PixelHistorySlotSize;
+  }
+
+  GLPixelHistoryEventData *GetEvent(uint32_t eid, uint32_t &slot)
+  {
+    auto it = m_Slots.find(eid);
+    if(it == m_Slots.end())
+      return NULL;
+
+    slot = it->second;
+
+    // once cancelled, don't start on any more events but let those underway finish up so
+    // that the results so far are consistent
+    if(!m_Events[slot].recorded)
+    {
+      if(RenderDoc::Inst().IsOperationCancelled())
+        return NULL;
+
+      RenderDoc::Inst().SetOperationProgress(float(slot + 1) / float(m_Events.size()));
+    }
+
+    return &m_Events[slot];
+  }
+
+  void PreDraw(uint32_t eid)
+  {
+    uint32_t slot = 0;
+    GLPixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->recorded = true;
+    ev->preCopied = CopyPixel(SlotOffset(slot, false));
+
+    m_Stage = eStage_None;
+
+    // only draws that render to the target can be tested
+    ResourceUsage usage = m_Usages[slot];
+    if(usage != eUsage_ColourTarget && usage != eUsage_DepthStencilTarget)
+      return;
+
+    const GLHookSet &gl = m_pDriver->GetHookset();
+
+    // if the application has its own occlusion query running, we can't start ours
+    GLint curQuery = 0;
+    gl.glGetQueryiv(m_QueryTarget, eGL_CURRENT_QUERY, &curQuery);
+    if(curQuery != 0)
+      return;
+
+    void *ctx = m_pDriver->GetCtx();
+
+    m_PrevState.FetchState(ctx, m_pDriver);
+
+    ev->depthTest = m_PrevState.Enabled[GLRenderState::eEnabled_DepthTest];
+    ev->stencilTest = m_PrevState.Enabled[GLRenderState::eEnabled_StencilTest];
+
+    const GLRenderState::Scissor &sc = m_PrevState.Scissors[0];
+    if(sc.enabled && (int32_t(m_X) < sc.x || int32_t(m_Y) < sc.y ||
+                      int32_t(m_X) >= sc.x + sc.width || int32_t(m_Y) >= sc.y + sc.height))
+    {
+      ev->scissorClipped = true;
+      return;
+    }
+
+    // do a first draw with writes disabled and the original tests, scissored to the pixel, to see
+    // how many samples pass at this point.
+    PauseFeedback();
+
+    gl.glEnable(eGL_SCISSOR_TEST);
+    gl.glScissor((GLint)m_X, (GLint)m_Y, 1, 1);
+    gl.glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    gl.glDepthMask(GL_FALSE);
+    gl.glStencilMask(0);
+
+    gl.glBeginQuery(m_QueryTarget, m_Queries[slot * 2 + 0]);
+
+    ev->testsQueried = true;
+    m_Stage = eStage_Tested;
+  }
+
+  bool PostDraw(uint32_t eid)
+  {
+    uint32_t slot = 0;
+    GLPixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return false;
+
+    // if we didn't modify anything, the draw we just did was the real one
+    if(m_Stage == eStage_None)
+    {
+      ev->postCopied = CopyPixel(SlotOffset(slot, true));
+      return false;
+    }
+
+    const GLHookSet &gl = m_pDriver->GetHookset();
+
+    gl.glEndQuery(m_QueryTarget);
+
+    // if there are any tests, draw again without them to see if the pixel is covered at all.
+    if(ev->depthTest || ev->stencilTest)
+    {
+      gl.glDisable(eGL_DEPTH_TEST);
+      gl.glDisable(eGL_STENCIL_TEST);
+
+      gl.glBeginQuery(m_QueryTarget, m_Queries[slot * 2 + 1]);
+
+      ev->coverageQueried = true;
+      m_Stage = eStage_Untested;
+    }
+    else
+    {
+      RestoreState();
+    }
+
+    return true;
+  }
+
+  bool PostRedraw(uint32_t eid)
+  {
+    uint32_t slot = 0;
+    GLPixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return false;
+
+    if(m_Stage == eStage_Untested)
+    {
+      m_pDriver->GetHookset().glEndQuery(m_QueryTarget);
+
+      // restore the render state and go ahead with the real draw
+      RestoreState();
+      return true;
+    }
+
+    ev->postCopied = CopyPixel(SlotOffset(slot, true));
+    m_Stage = eStage_None;
+
+    return false;
+  }
+
+  void PreDispatch(uint32_t eid) { PreEvent(eid); }
+  void PostDispatch(uint32_t eid) { PostEvent(eid); }
+  void PreMisc(uint32_t eid, uint32_t flags) { PreEvent(eid); }
+  void PostMisc(uint32_t eid, uint32_t flags) { PostEvent(eid); }
+  void PreEvent(uint32_t eid)
+  {
+    uint32_t slot = 0;
+    GLPixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->recorded = true;
+    ev->preCopied = CopyPixel(SlotOffset(slot, false));
+  }
+
+  void PostEvent(uint32_t eid)
+  {
+    uint32_t slot = 0;
+    GLPixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->postCopied = CopyPixel(SlotOffset(slot, true));
+  }
+
+  void PauseFeedback()
+  {
+    const GLHookSet &gl = m_pDriver->GetHookset();
+
+    // the test draws mustn't append to any transform feedback buffers
+    GLint active = 0, paused = 0;
+    gl.glGetIntegerv(eGL_TRANSFORM_FEEDBACK_ACTIVE, &active);
+    gl.glGetIntegerv(eGL_TRANSFORM_FEEDBACK_PAUSED, &paused);
+
+    m_PausedFeedback = (active && !paused);
+    if(m_PausedFeedback)
+      gl.glPauseTransformFeedback();
+  }
+
+  void RestoreState()
+  {
+    m_PrevState.ApplyState(m_pDriver->GetCtx(), m_pDriver);
+
+    if(m_PausedFeedback)
+      m_pDriver->GetHookset().glResumeTransformFeedback();
+
+    m_PausedFeedback = false;
+    m_Stage = eStage_Real;
+  }
+
+  bool CopyPixel(GLintptr offset)
+  {
+    if(m_ReadFBO == 0)
+      return false;
+
+    const GLHookSet &gl = m_pDriver->GetHookset();
+
+    GLuint prevReadFBO = 0, prevPackBuffer = 0;
+    gl.glGetIntegerv(eGL_READ_FRAMEBUFFER_BINDING, (GLint *)&prevReadFBO);
+    gl.glGetIntegerv(eGL_PIXEL_PACK_BUFFER_BINDING, (GLint *)&prevPackBuffer);
+
+    PixelPackState pack;
+    pack.Fetch(&gl, false);
+
+    ResetPixelPackState(gl, false, 1);
+
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, m_ReadFBO);
+    gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, m_Buffer);
+
+    GLint x = (GLint)m_X, y = (GLint)m_Y;
+
+    if(m_BaseFormat == eGL_DEPTH_COMPONENT || m_BaseFormat == eGL_DEPTH_STENCIL)
+      gl.glReadPixels(x, y, 1, 1, eGL_DEPTH_COMPONENT, eGL_FLOAT, (void *)offset);
+
+    if(m_BaseFormat == eGL_STENCIL_INDEX || m_BaseFormat == eGL_DEPTH_STENCIL)
+      gl.glReadPixels(x, y, 1, 1, eGL_STENCIL_INDEX, eGL_UNSIGNED_BYTE,
+                      (void *)(offset + PixelHistoryStencilOffset));
+
+    if(m_BaseFormat != eGL_DEPTH_COMPONENT && m_BaseFormat != eGL_DEPTH_STENCIL &&
+       m_BaseFormat != eGL_STENCIL_INDEX)
+    {
+      if(m_Integer)
+        gl.glReadPixels(x, y, 1, 1, eGL_RGBA_INTEGER, m_UnsignedInt ? eGL_UNSIGNED_INT : eGL_INT,
+                        (void *)offset);
+      else
+        gl.glReadPixels(x, y, 1, 1, eGL_RGBA, eGL_FLOAT, (void *)offset);
+    }
+
+    gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, prevPackBuffer);
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, prevReadFBO);
+
+    pack.Apply(&gl, false);
+
+    return true;
+  }
+
+  enum Stage
+  {
+    eStage_None,
+    eStage_Tested,
+    eStage_Untested,
+    eStage_Real,
+  };
+
+  WrappedOpenGL *m_pDriver;
+  uint32_t m_X, m_Y;
+  GLuint m_ReadFBO;
+  GLenum m_BaseFormat;
+  bool m_Integer, m_UnsignedInt;
+  GLuint m_Buffer;
+  vector<GLuint> m_Queries;
+  GLenum m_QueryTarget;
+
+  GLRenderState m_PrevState;
+  Stage m_Stage;
+  bool m_PausedFeedback;
+
+  map<uint32_t, uint32_t> m_Slots;
+  vector<ResourceUsage> m_Usages;
+  vector<GLPixelHistoryEventData> m_Events;
+};
+
+vector<PixelModification> GLReplay::PixelHistory(vector<EventUsage> events, ResourceId target,
+                                                 uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
+                                                 uint32_t sampleIdx, FormatComponentType typeHint)
+{
+  vector<PixelModification> history;
+
+  if(events.empty())
+    return history;
+
+  WrappedOpenGL::TextureData &texDetails = m_pDriver->m_Textures[target];
+
+  if(IsCompressedFormat(texDetails.internalFormat))
+    return history;
+
+  SCOPED_TIMER("GLReplay::PixelHistory");
+
+  RDCDEBUG("Checking Pixel History on %llu (%u, %u) with %u possible events", target, x, y,
+           (uint32_t)events.size());
+
+  std::sort(events.begin(), events.end());
+
+  uint32_t numEvents = (uint32_t)events.size();
+
+  // all of the work happens during the replay, so the objects must exist on the replay context
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  const GLHookSet &gl = m_pDriver->GetHookset();
+
+  GLenum baseFormat = GetBaseFormat(texDetails.internalFormat);
+  bool isDepth = (baseFormat == eGL_DEPTH_COMPONENT || baseFormat == eGL_DEPTH_STENCIL ||
+                  baseFormat == eGL_STENCIL_INDEX);
+
+  // values can't be read from multisampled targets, and GLES can't read depth or stencil
+  bool readValues = (texDetails.samples <= 1) && !(IsGLES && isDepth);
+
+  if(texDetails.samples > 1)
+    RDCWARN("Pixel history on multisampled textures only returns test results, not values");
+
+  GLuint readFBO = 0;
+
+  if(readValues)
+  {
+    GLenum attach = eGL_COLOR_ATTACHMENT0;
+    if(baseFormat == eGL_DEPTH_COMPONENT)
+      attach = eGL_DEPTH_ATTACHMENT;
+    else if(baseFormat == eGL_STENCIL_INDEX)
+      attach = eGL_STENCIL_ATTACHMENT;
+    else if(baseFormat == eGL_DEPTH_STENCIL)
+      attach = eGL_DEPTH_STENCIL_ATTACHMENT;
+
+    GLuint prevReadFBO = 0;
+    gl.glGetIntegerv(eGL_READ_FRAMEBUFFER_BINDING, (GLint *)&prevReadFBO);
+
+    gl.glGenFramebuffers(1, &readFBO);
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, readFBO);
+
+    GLuint name = texDetails.resource.name;
+    GLenum type = texDetails.curType;
+
+    if(type == eGL_RENDERBUFFER)
+      gl.glFramebufferRenderbuffer(eGL_READ_FRAMEBUFFER, attach, eGL_RENDERBUFFER, name);
+    else if(type == eGL_TEXTURE_CUBE_MAP)
+      gl.glFramebufferTexture2D(eGL_READ_FRAMEBUFFER, attach,
+                                GLenum(eGL_TEXTURE_CUBE_MAP_POSITIVE_X + slice), name, mip);
+    else if(type == eGL_TEXTURE_3D || type == eGL_TEXTURE_1D_ARRAY ||
+            type == eGL_TEXTURE_2D_ARRAY || type == eGL_TEXTURE_CUBE_MAP_ARRAY)
+      gl.glFramebufferTextureLayer(eGL_READ_FRAMEBUFFER, attach, name, mip, slice);
+    else
+      gl.glFramebufferTexture(eGL_READ_FRAMEBUFFER, attach, name, mip);
+
+    if(!isDepth)
+      gl.glReadBuffer(eGL_COLOR_ATTACHMENT0);
+
+    GLenum status = gl.glCheckFramebufferStatus(eGL_READ_FRAMEBUFFER);
+
+    gl.glBindFramebuffer(eGL_READ_FRAMEBUFFER, prevReadFBO);
+
+    if(status != eGL_FRAMEBUFFER_COMPLETE)
+    {
+      RDCWARN("Can't read back pixel history values, framebuffer status %s",
+              ToStr::Get(status).c_str());
+      gl.glDeleteFramebuffers(1, &readFBO);
+      readFBO = 0;
+    }
+  }
+
+  GLuint prevPackBuffer = 0;
+  gl.glGetIntegerv(eGL_PIXEL_PACK_BUFFER_BINDING, (GLint *)&prevPackBuffer);
+
+  vector<byte> zeroes(size_t(PixelHistorySlotSize * 2 * numEvents), 0);
+
+  GLuint buffer = 0;
+  gl.glGenBuffers(1, &buffer);
+  gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, buffer);
+  gl.glBufferData(eGL_PIXEL_PACK_BUFFER, (GLsizeiptr)zeroes.size(), &zeroes[0], eGL_STREAM_READ);
+  gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, prevPackBuffer);
+
+  vector<GLuint> queries(numEvents * 2);
+  gl.glGenQueries((GLsizei)queries.size(), &queries[0]);
+
+  vector<GLPixelHistoryEventData> eventData;
+
+  {
+    bool isUInt = IsUIntFormat(texDetails.internalFormat);
+    bool isSInt = IsSIntFormat(texDetails.internalFormat);
+
+    GLPixelHistoryCallback cb(m_pDriver, events, x, y, readFBO, baseFormat, isUInt || isSInt,
+                              isUInt, buffer, queries);
+
+    // replay the frame once up to the last event, doing all the copies and queries
+    m_pDriver->ReplayLog(0, events.back().eventID, eReplay_Full);
+
+    eventData = cb.m_Events;
+  }
+
+  // everything has been submitted by now, so the only wait is for the replay to complete
+  vector<uint64_t> queryData(numEvents * 2, 0);
+
+  for(uint32_t i = 0; i < numEvents; i++)
+  {
+    for(uint32_t q = 0; q < 2; q++)
+    {
+      bool issued = q == 0 ? eventData[i].testsQueried : eventData[i].coverageQueried;
+      if(!issued)
+        continue;
+
+      GLuint result = 0;
+      gl.glGetQueryObjectuiv(queries[i * 2 + q], eGL_QUERY_RESULT, &result);
+      queryData[i * 2 + q] = result;
+    }
+  }
+
+  gl.glDeleteQueries((GLsizei)queries.size(), &queries[0]);
+
+  vector<byte> data(zeroes.size());
+  gl.glGetNamedBufferSubDataEXT(buffer, 0, (GLsizeiptr)data.size(), &data[0]);
+
+  gl.glDeleteBuffers(1, &buffer);
+  if(readFBO)
+    gl.glDeleteFramebuffers(1, &readFBO);
+
+  for(uint32_t i = 0; i < numEvents; i++)
+  {
+    const GLPixelHistoryEventData &ev = eventData[i];
+
+    if(!ev.recorded)
+      continue;
+
+    const byte *pre = &data[GLPixelHistoryCallback::SlotOffset(i, false)];
+    const byte *post = &data[GLPixelHistoryCallback::SlotOffset(i, true)];
+
+    bool valuesKnown = ev.preCopied && ev.postCopied;
+    bool unchanged = valuesKnown && memcmp(pre, post, (size_t)PixelHistorySlotSize) == 0;
+
+    uint64_t passed = queryData[i * 2 + 0];
+    uint64_t covered = queryData[i * 2 + 1];
+
+    // drop draws that didn't touch the pixel at all
+    if((ev.testsQueried || ev.scissorClipped) && unchanged)
+    {
+      if(ev.scissorClipped)
+        continue;
+      if(ev.coverageQueried && covered == 0)
+        continue;
+      if(!ev.coverageQueried && passed == 0)
+        continue;
+    }
+
+    PixelModification mod;
+    RDCEraseEl(mod);
+
+    mod.eventID = events[i].eventID;
+
+    ResourceUsage usage = events[i].usage;
+
+    mod.uavWrite = (usage >= eUsage_VS_RWResource && usage <= eUsage_CS_RWResource) ||
+                   usage == eUsage_All_RWResource;
+
+    ModificationValue *vals[] = {&mod.preMod, &mod.postMod};
+    const byte *slots[] = {pre, post};
+    bool copied[] = {ev.preCopied, ev.postCopied};
+
+    for(int v = 0; v < 2; v++)
+    {
+      ModificationValue &val = *vals[v];
+
+      if(!copied[v])
+      {
+        val.depth = -1.0f;
+        val.stencil = -1;
+        continue;
+      }
+
+      if(isDepth)
+      {
+        val.depth = -1.0f;
+        val.stencil = -1;
+
+        if(baseFormat != eGL_STENCIL_INDEX)
+          memcpy(&val.depth, slots[v], sizeof(float));
+        if(baseFormat != eGL_DEPTH_COMPONENT)
+          val.stencil = slots[v][PixelHistoryStencilOffset];
+      }
+      else
+      {
+        // integer formats were read as 32-bit ints and everything else as floats, so the slot
+        // already matches the layout of the value
+        memcpy(&val.col.value_u[0], slots[v], sizeof(uint32_t) * 4);
+
+        val.depth = -1.0f;
+        val.stencil = -1;
+      }
+    }
+
+    // we don't get the individual fragment outputs
+    mod.shaderOut.depth = -1.0f;
+    mod.shaderOut.stencil = -1;
+
+    mod.scissorClipped = ev.scissorClipped;
+
+    if(ev.testsQueried && passed == 0)
+    {
+      if(ev.depthTest)
+        mod.depthTestFailed = true;
+      else if(ev.stencilTest)
+        mod.stencilTestFailed = true;
+    }
+
+    history.push_back(mod);
+  }
+
+  return history;
+}
@@ -1159,16 +1159,28 @@ void GLRenderState::FetchState(void *ctx, WrappedOpenGL *gl)
   ClearGLErrors(*m_Real);
 }
 
-void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
+// true if the member needs to be set, because there is no known bound state to compare against or
+// the bound state differs. Structs are compared bytewise which is fine as Clear() erases padding.
+#define STATE_CHANGED(member) \
+  (shadow == NULL || memcmp(&member, &shadow->member, sizeof(member)) != 0)
+
+void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl, const GLRenderState *shadow)
 {
   if(!ContextPresent || ctx == NULL)
     return;
 
+  // a shadow state fetched with nothing present can't tell us anything
+  if(shadow && !shadow->ContextPresent)
+    shadow = NULL;
+
   for(GLuint i = 0; i < eEnabled_Count; i++)
   {
     if(!CheckEnableDisableParam(enable_disable_cap[i]))
       continue;
 
+    if(shadow && shadow->Enabled[i] == Enabled[i])
+      continue;
+
     if(Enabled[i])
       m_Real->glEnable(enable_disable_cap[i]);
     else
@@ -1178,8 +1190,19 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
   GLuint maxTextures = 0;
   m_Real->glGetIntegerv(eGL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, (GLint *)&maxTextures);
 
+  bool activeTextureChanged = false;
+
   for(GLuint i = 0; i < RDCMIN(maxTextures, (GLuint)ARRAY_COUNT(Tex2D)); i++)
   {
+    if(!STATE_CHANGED(Tex1D[i]) && !STATE_CHANGED(Tex2D[i]) && !STATE_CHANGED(Tex3D[i]) &&
+       !STATE_CHANGED(Tex1DArray[i]) && !STATE_CHANGED(Tex2DArray[i]) &&
+       !STATE_CHANGED(TexRect[i]) && !STATE_CHANGED(TexBuffer[i]) && !STATE_CHANGED(TexCube[i]) &&
+       !STATE_CHANGED(Tex2DMS[i]) && !STATE_CHANGED(Tex2DMSArray[i]) &&
+       !STATE_CHANGED(Samplers[i]) && !STATE_CHANGED(TexCubeArray[i]))
+      continue;
+
+    activeTextureChanged = true;
+
     m_Real->glActiveTexture(GLenum(eGL_TEXTURE0 + i));
     if(!IsGLES)
       m_Real->glBindTexture(eGL_TEXTURE_1D, Tex1D[i]);
@@ -1209,6 +1232,9 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
 
     for(GLuint i = 0; i < RDCMIN(maxImages, (GLuint)ARRAY_COUNT(Images)); i++)
     {
+      if(!STATE_CHANGED(Images[i]))
+        continue;
+
       // use sanitised parameters when no image is bound
       if(Images[i].name == 0)
         m_Real->glBindImageTexture(i, 0, 0, GL_FALSE, 0, eGL_READ_ONLY, eGL_R8);
@@ -1218,10 +1244,12 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
     }
   }
 
-  m_Real->glActiveTexture(ActiveTexture);
+  if(activeTextureChanged || STATE_CHANGED(ActiveTexture))
+    m_Real->glActiveTexture(ActiveTexture);
 
-  m_Real->glBindVertexArray(VAO);
-  if(HasExt[ARB_transform_feedback2])
+  if(STATE_CHANGED(VAO))
+    m_Real->glBindVertexArray(VAO);
+  if(HasExt[ARB_transform_feedback2] && STATE_CHANGED(FeedbackObj))
     m_Real->glBindTransformFeedback(eGL_TRANSFORM_FEEDBACK, FeedbackObj);
 
   // See FetchState(). The spec says that you have to SET the right format for the shader too,
@@ -1229,25 +1257,36 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
   GLuint maxNumAttribs = 0;
   m_Real->glGetIntegerv(eGL_MAX_VERTEX_ATTRIBS, (GLint *)&maxNumAttribs);
   for(GLuint i = 0; i < RDCMIN(maxNumAttribs, (GLuint)ARRAY_COUNT(GenericVertexAttribs)); i++)
-    m_Real->glVertexAttrib4fv(i, &GenericVertexAttribs[i].x);
+    if(STATE_CHANGED(GenericVertexAttribs[i]))
+      m_Real->glVertexAttrib4fv(i, &GenericVertexAttribs[i].x);
 
-  m_Real->glLineWidth(LineWidth);
+  if(STATE_CHANGED(LineWidth))
+    m_Real->glLineWidth(LineWidth);
   if(!IsGLES)
   {
-    m_Real->glPointParameterf(eGL_POINT_FADE_THRESHOLD_SIZE, PointFadeThresholdSize);
-    m_Real->glPointParameteri(eGL_POINT_SPRITE_COORD_ORIGIN, (GLint)PointSpriteOrigin);
-    m_Real->glPointSize(PointSize);
+    if(STATE_CHANGED(PointFadeThresholdSize))
+      m_Real->glPointParameterf(eGL_POINT_FADE_THRESHOLD_SIZE, PointFadeThresholdSize);
+    if(STATE_CHANGED(PointSpriteOrigin))
+      m_Real->glPointParameteri(eGL_POINT_SPRITE_COORD_ORIGIN, (GLint)PointSpriteOrigin);
+    if(STATE_CHANGED(PointSize))
+      m_Real->glPointSize(PointSize);
   }
 
-  if(!IsGLES)
+  if(!IsGLES && STATE_CHANGED(PrimitiveRestartIndex))
     m_Real->glPrimitiveRestartIndex(PrimitiveRestartIndex);
-  if(m_Real->glClipControl && HasExt[ARB_clip_control])
+  if(m_Real->glClipControl && HasExt[ARB_clip_control] &&
+     (STATE_CHANGED(ClipOrigin) || STATE_CHANGED(ClipDepth)))
     m_Real->glClipControl(ClipOrigin, ClipDepth);
-  if(!IsGLES)
+  if(!IsGLES && STATE_CHANGED(ProvokingVertex))
     m_Real->glProvokingVertex(ProvokingVertex);
 
-  m_Real->glUseProgram(Program);
-  if(HasExt[ARB_separate_shader_objects])
+  // subroutine uniforms are reset whenever the program changes, so if the program is re-bound the
+  // subroutines must be set again too.
+  bool programChanged = STATE_CHANGED(Program) || STATE_CHANGED(Pipeline);
+
+  if(STATE_CHANGED(Program))
+    m_Real->glUseProgram(Program);
+  if(HasExt[ARB_separate_shader_objects] && STATE_CHANGED(Pipeline))
     m_Real->glBindProgramPipeline(Pipeline);
 
   GLenum shs[] = {eGL_VERTEX_SHADER,   eGL_TESS_CONTROL_SHADER, eGL_TESS_EVALUATION_SHADER,
@@ -1264,47 +1303,60 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
        !HasExt[ARB_tessellation_shader])
       continue;
 
+    if(!programChanged && !STATE_CHANGED(Subroutines[s]))
+      continue;
+
     if(Subroutines[s].numSubroutines > 0)
       m_Real->glUniformSubroutinesuiv(shs[s], Subroutines[s].numSubroutines, Subroutines[s].Values);
   }
 
-  m_Real->glBindBuffer(eGL_ARRAY_BUFFER, BufferBindings[eBufIdx_Array]);
-  m_Real->glBindBuffer(eGL_COPY_READ_BUFFER, BufferBindings[eBufIdx_Copy_Read]);
-  m_Real->glBindBuffer(eGL_COPY_WRITE_BUFFER, BufferBindings[eBufIdx_Copy_Write]);
-  m_Real->glBindBuffer(eGL_PIXEL_PACK_BUFFER, BufferBindings[eBufIdx_Pixel_Pack]);
-  m_Real->glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, BufferBindings[eBufIdx_Pixel_Unpack]);
-  m_Real->glBindBuffer(eGL_TEXTURE_BUFFER, BufferBindings[eBufIdx_Texture]);
-  if(HasExt[ARB_draw_indirect])
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Array]))
+    m_Real->glBindBuffer(eGL_ARRAY_BUFFER, BufferBindings[eBufIdx_Array]);
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Copy_Read]))
+    m_Real->glBindBuffer(eGL_COPY_READ_BUFFER, BufferBindings[eBufIdx_Copy_Read]);
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Copy_Write]))
+    m_Real->glBindBuffer(eGL_COPY_WRITE_BUFFER, BufferBindings[eBufIdx_Copy_Write]);
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Pixel_Pack]))
+    m_Real->glBindBuffer(eGL_PIXEL_PACK_BUFFER, BufferBindings[eBufIdx_Pixel_Pack]);
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Pixel_Unpack]))
+    m_Real->glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, BufferBindings[eBufIdx_Pixel_Unpack]);
+  if(STATE_CHANGED(BufferBindings[eBufIdx_Texture]))
+    m_Real->glBindBuffer(eGL_TEXTURE_BUFFER, BufferBindings[eBufIdx_Texture]);
+  if(HasExt[ARB_draw_indirect] && STATE_CHANGED(BufferBindings[eBufIdx_Draw_Indirect]))
     m_Real->glBindBuffer(eGL_DRAW_INDIRECT_BUFFER, BufferBindings[eBufIdx_Draw_Indirect]);
-  if(HasExt[ARB_compute_shader])
+  if(HasExt[ARB_compute_shader] && STATE_CHANGED(BufferBindings[eBufIdx_Dispatch_Indirect]))
     m_Real->glBindBuffer(eGL_DISPATCH_INDIRECT_BUFFER, BufferBindings[eBufIdx_Dispatch_Indirect]);
-  if(HasExt[ARB_query_buffer_object])
+  if(HasExt[ARB_query_buffer_object] && STATE_CHANGED(BufferBindings[eBufIdx_Query]))
     m_Real->glBindBuffer(eGL_QUERY_BUFFER, BufferBindings[eBufIdx_Query]);
-  if(HasExt[ARB_indirect_parameters])
+  if(HasExt[ARB_indirect_parameters] && STATE_CHANGED(BufferBindings[eBufIdx_Parameter]))
     m_Real->glBindBuffer(eGL_PARAMETER_BUFFER_ARB, BufferBindings[eBufIdx_Parameter]);
 
   struct
   {
     IdxRangeBuffer *bufs;
+    const IdxRangeBuffer *shadowBufs;
     int count;
     GLenum binding;
     GLenum maxcount;
   } idxBufs[] = {
       {
-          AtomicCounter, ARRAY_COUNT(AtomicCounter), eGL_ATOMIC_COUNTER_BUFFER,
-          eGL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS,
+          AtomicCounter, shadow ? shadow->AtomicCounter : NULL, ARRAY_COUNT(AtomicCounter),
+          eGL_ATOMIC_COUNTER_BUFFER, eGL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS,
       },
       {
-          ShaderStorage, ARRAY_COUNT(ShaderStorage), eGL_SHADER_STORAGE_BUFFER,
-          eGL_MAX_SHADER_STORAGE_BUFFER_BINDINGS,
+          ShaderStorage, shadow ? shadow->ShaderStorage : NULL, ARRAY_COUNT(ShaderStorage),
+          eGL_SHADER_STORAGE_BUFFER, eGL_MAX_SHADER_STORAGE_BUFFER_BINDINGS,
       },
       {
-          TransformFeedback, ARRAY_COUNT(TransformFeedback), eGL_TRANSFORM_FEEDBACK_BUFFER,
+          // transform feedback bindings belong to the feedback object that was bound
+          TransformFeedback,
+          shadow && shadow->FeedbackObj == FeedbackObj ? shadow->TransformFeedback : NULL,
+          ARRAY_COUNT(TransformFeedback), eGL_TRANSFORM_FEEDBACK_BUFFER,
           eGL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS,
       },
       {
-          UniformBinding, ARRAY_COUNT(UniformBinding), eGL_UNIFORM_BUFFER,
-          eGL_MAX_UNIFORM_BUFFER_BINDINGS,
+          UniformBinding, shadow ? shadow->UniformBinding : NULL, ARRAY_COUNT(UniformBinding),
+          eGL_UNIFORM_BUFFER, eGL_MAX_UNIFORM_BUFFER_BINDINGS,
       },
   };
 
@@ -1327,6 +1379,10 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
     m_Real->glGetIntegerv(idxBufs[b].maxcount, &maxCount);
     for(int i = 0; i < idxBufs[b].count && i < maxCount; i++)
     {
+      if(idxBufs[b].shadowBufs &&
+         !memcmp(&idxBufs[b].bufs[i], &idxBufs[b].shadowBufs[i], sizeof(IdxRangeBuffer)))
+        continue;
+
       if(idxBufs[b].bufs[i].name == 0 ||
          (idxBufs[b].bufs[i].start == 0 && idxBufs[b].bufs[i].size == 0))
         m_Real->glBindBufferBase(idxBufs[b].binding, i, idxBufs[b].bufs[i].name);
@@ -1344,6 +1400,9 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
   {
     for(GLuint i = 0; i < RDCMIN(maxDraws, (GLuint)ARRAY_COUNT(Blends)); i++)
     {
+      if(!STATE_CHANGED(Blends[i]))
+        continue;
+
       m_Real->glBlendFuncSeparatei(i, Blends[i].SourceRGB, Blends[i].DestinationRGB,
                                    Blends[i].SourceAlpha, Blends[i].DestinationAlpha);
       m_Real->glBlendEquationSeparatei(i, Blends[i].EquationRGB, Blends[i].EquationAlpha);
@@ -1355,17 +1414,23 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
     }
   }
 
-  m_Real->glBlendColor(BlendColor[0], BlendColor[1], BlendColor[2], BlendColor[3]);
+  if(STATE_CHANGED(BlendColor))
+    m_Real->glBlendColor(BlendColor[0], BlendColor[1], BlendColor[2], BlendColor[3]);
 
   if(HasExt[ARB_viewport_array])
   {
     GLuint maxViews = 0;
     m_Real->glGetIntegerv(eGL_MAX_VIEWPORTS, (GLint *)&maxViews);
 
-    m_Real->glViewportArrayv(0, RDCMIN(maxViews, (GLuint)ARRAY_COUNT(Viewports)), &Viewports[0].x);
+    if(STATE_CHANGED(Viewports))
+      m_Real->glViewportArrayv(0, RDCMIN(maxViews, (GLuint)ARRAY_COUNT(Viewports)),
+                               &Viewports[0].x);
 
     for(GLuint s = 0; s < RDCMIN(maxViews, (GLuint)ARRAY_COUNT(Scissors)); ++s)
     {
+      if(!STATE_CHANGED(Scissors[s]))
+        continue;
+
       m_Real->glScissorIndexedv(s, &Scissors[s].x);
 
       if(Scissors[s].enabled)
@@ -1376,23 +1441,30 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
 
     for(GLuint i = 0; i < RDCMIN(maxViews, (GLuint)ARRAY_COUNT(DepthRanges)); i++)
     {
+      if(!STATE_CHANGED(DepthRanges[i]))
+        continue;
+
       double v[2] = {DepthRanges[i].nearZ, DepthRanges[i].farZ};
       m_Real->glDepthRangeArrayv(i, 1, v);
     }
   }
   else
   {
-    m_Real->glViewport((GLint)Viewports[0].x, (GLint)Viewports[0].y, (GLsizei)Viewports[0].width,
-                       (GLsizei)Viewports[0].height);
+    if(STATE_CHANGED(Viewports[0]))
+      m_Real->glViewport((GLint)Viewports[0].x, (GLint)Viewports[0].y,
+                         (GLsizei)Viewports[0].width, (GLsizei)Viewports[0].height);
 
-    m_Real->glScissor(Scissors[0].x, Scissors[0].y, Scissors[0].width, Scissors[0].height);
+    if(STATE_CHANGED(Scissors[0]))
+    {
+      m_Real->glScissor(Scissors[0].x, Scissors[0].y, Scissors[0].width, Scissors[0].height);
 
-    if(Scissors[0].enabled)
-      m_Real->glEnable(eGL_SCISSOR_TEST);
-    else
-      m_Real->glDisable(eGL_SCISSOR_TEST);
+      if(Scissors[0].enabled)
+        m_Real->glEnable(eGL_SCISSOR_TEST);
+      else
+        m_Real->glDisable(eGL_SCISSOR_TEST);
+    }
 
-    if(!IsGLES)
+    if(!IsGLES && STATE_CHANGED(DepthRanges[0]))
       m_Real->glDepthRange(DepthRanges[0].nearZ, DepthRanges[0].farZ);
   }
 
@@ -1429,33 +1501,50 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
   // this work if we're on the replay context
   if(gl->GetReplay()->IsReplayContext(ctx))
   {
-    // apply drawbuffers/readbuffer to default framebuffer
-    m_Real->glBindFramebuffer(eGL_READ_FRAMEBUFFER, gl->GetFakeBBFBO());
-    m_Real->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, gl->GetFakeBBFBO());
-    m_Real->glDrawBuffers(numDBs, DBs);
+    // the shadow's draw buffers were fetched from whichever framebuffer was bound, so only trust
+    // them when that was the fake backbuffer too
+    bool drawBuffersChanged = STATE_CHANGED(DrawBuffers) || !shadow ||
+                              shadow->DrawFBO != gl->GetFakeBBFBO();
 
-    // see above for reasoning for this
-    m_Real->glReadBuffer(eGL_COLOR_ATTACHMENT0);
+    if(drawBuffersChanged)
+    {
+      // apply drawbuffers/readbuffer to default framebuffer
+      m_Real->glBindFramebuffer(eGL_READ_FRAMEBUFFER, gl->GetFakeBBFBO());
+      m_Real->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, gl->GetFakeBBFBO());
+      m_Real->glDrawBuffers(numDBs, DBs);
 
-    m_Real->glBindFramebuffer(eGL_READ_FRAMEBUFFER, ReadFBO);
-    m_Real->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, DrawFBO);
+      // see above for reasoning for this
+      m_Real->glReadBuffer(eGL_COLOR_ATTACHMENT0);
+    }
+
+    if(drawBuffersChanged || STATE_CHANGED(ReadFBO))
+      m_Real->glBindFramebuffer(eGL_READ_FRAMEBUFFER, ReadFBO);
+    if(drawBuffersChanged || STATE_CHANGED(DrawFBO))
+      m_Real->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, DrawFBO);
   }
 
-  m_Real->glHint(eGL_FRAGMENT_SHADER_DERIVATIVE_HINT, Hints.Derivatives);
-  if(!IsGLES)
+  if(STATE_CHANGED(Hints))
   {
-    m_Real->glHint(eGL_LINE_SMOOTH_HINT, Hints.LineSmooth);
-    m_Real->glHint(eGL_POLYGON_SMOOTH_HINT, Hints.PolySmooth);
-    m_Real->glHint(eGL_TEXTURE_COMPRESSION_HINT, Hints.TexCompression);
+    m_Real->glHint(eGL_FRAGMENT_SHADER_DERIVATIVE_HINT, Hints.Derivatives);
+    if(!IsGLES)
+    {
+      m_Real->glHint(eGL_LINE_SMOOTH_HINT, Hints.LineSmooth);
+      m_Real->glHint(eGL_POLYGON_SMOOTH_HINT, Hints.PolySmooth);
+      m_Real->glHint(eGL_TEXTURE_COMPRESSION_HINT, Hints.TexCompression);
+    }
   }
 
-  m_Real->glDepthMask(DepthWriteMask);
-  m_Real->glClearDepthf(DepthClearValue);
-  m_Real->glDepthFunc(DepthFunc);
+  if(STATE_CHANGED(DepthWriteMask))
+    m_Real->glDepthMask(DepthWriteMask);
+  if(STATE_CHANGED(DepthClearValue))
+    m_Real->glClearDepthf(DepthClearValue);
+  if(STATE_CHANGED(DepthFunc))
+    m_Real->glDepthFunc(DepthFunc);
 
-  if(HasExt[EXT_depth_bounds_test] && m_Real->glDepthBoundsEXT)
+  if(HasExt[EXT_depth_bounds_test] && m_Real->glDepthBoundsEXT && STATE_CHANGED(DepthBounds))
     m_Real->glDepthBoundsEXT(DepthBounds.nearZ, DepthBounds.farZ);
 
+  if(STATE_CHANGED(StencilFront) || STATE_CHANGED(StencilBack))
   {
     m_Real->glStencilFuncSeparate(eGL_FRONT, StencilFront.func, StencilFront.ref,
                                   StencilFront.valuemask);
@@ -1470,27 +1559,33 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
                                 StencilBack.pass);
   }
 
-  m_Real->glClearStencil((GLint)StencilClearValue);
+  if(STATE_CHANGED(StencilClearValue))
+    m_Real->glClearStencil((GLint)StencilClearValue);
 
   for(GLuint i = 0; i < RDCMIN(maxDraws, (GLuint)ARRAY_COUNT(ColorMasks)); i++)
-    m_Real->glColorMaski(i, ColorMasks[i].red, ColorMasks[i].green, ColorMasks[i].blue,
-                         ColorMasks[i].alpha);
-
-  m_Real->glSampleMaski(0, (GLbitfield)SampleMask[0]);
-  m_Real->glSampleCoverage(SampleCoverage, SampleCoverageInvert ? GL_TRUE : GL_FALSE);
-  if(HasExt[ARB_sample_shading])
+    if(STATE_CHANGED(ColorMasks[i]))
+      m_Real->glColorMaski(i, ColorMasks[i].red, ColorMasks[i].green, ColorMasks[i].blue,
+                           ColorMasks[i].alpha);
+
+  if(STATE_CHANGED(SampleMask[0]))
+    m_Real->glSampleMaski(0, (GLbitfield)SampleMask[0]);
+  if(STATE_CHANGED(SampleCoverage) || STATE_CHANGED(SampleCoverageInvert))
+    m_Real->glSampleCoverage(SampleCoverage, SampleCoverageInvert ? GL_TRUE : GL_FALSE);
+  if(HasExt[ARB_sample_shading] && STATE_CHANGED(MinSampleShading))
     m_Real->glMinSampleShading(MinSampleShading);
 
-  if(HasExt[EXT_raster_multisample] && m_Real->glRasterSamplesEXT)
+  if(HasExt[EXT_raster_multisample] && m_Real->glRasterSamplesEXT &&
+     (STATE_CHANGED(RasterSamples) || STATE_CHANGED(RasterFixed)))
     m_Real->glRasterSamplesEXT(RasterSamples, RasterFixed);
 
-  if(!IsGLES)
+  if(!IsGLES && STATE_CHANGED(LogicOp))
     m_Real->glLogicOp(LogicOp);
 
-  m_Real->glClearColor(ColorClearValue.red, ColorClearValue.green, ColorClearValue.blue,
-                       ColorClearValue.alpha);
+  if(STATE_CHANGED(ColorClearValue))
+    m_Real->glClearColor(ColorClearValue.red, ColorClearValue.green, ColorClearValue.blue,
+                         ColorClearValue.alpha);
 
-  if(HasExt[ARB_tessellation_shader])
+  if(HasExt[ARB_tessellation_shader] && STATE_CHANGED(PatchParams))
   {
     m_Real->glPatchParameteri(eGL_PATCH_VERTICES, PatchParams.numVerts);
     if(!IsGLES)
@@ -1500,22 +1595,30 @@ void GLRenderState::ApplyState(void *ctx, WrappedOpenGL *gl)
     }
   }
 
-  if(!IsGLES)
+  if(!IsGLES && STATE_CHANGED(PolygonMode))
     m_Real->glPolygonMode(eGL_FRONT_AND_BACK, PolygonMode);
 
-  if(HasExt[EXT_polygon_offset_clamp] && m_Real->glPolygonOffsetClampEXT)
-    m_Real->glPolygonOffsetClampEXT(PolygonOffset[0], PolygonOffset[1], PolygonOffset[2]);
-  else
-    m_Real->glPolygonOffset(PolygonOffset[0], PolygonOffset[1]);
+  if(STATE_CHANGED(PolygonOffset))
+  {
+    if(HasExt[EXT_polygon_offset_clamp] && m_Real->glPolygonOffsetClampEXT)
+      m_Real->glPolygonOffsetClampEXT(PolygonOffset[0], PolygonOffset[1], PolygonOffset[2]);
+    else
+      m_Real->glPolygonOffset(PolygonOffset[0], PolygonOffset[1]);
+  }
 
-  m_Real->glFrontFace(FrontFace);
-  m_Real->glCullFace(CullFace);
+  if(STATE_CHANGED(FrontFace))
+    m_Real->glFrontFace(FrontFace);
+  if(STATE_CHANGED(CullFace))
+    m_Real->glCullFace(CullFace);
 
-  Unpack.Apply(m_Real, true);
+  if(STATE_CHANGED(Unpack))
+    Unpack.Apply(m_Real, true);
 
   ClearGLErrors(*m_Real);
 }
 
+#undef STATE_CHANGED
+
 void GLRenderState::Clear()
 {
   ContextPresent = true;
@@ -74,7 +74,9 @@ struct GLRenderState
   ~GLRenderState();
 
   void FetchState(void *ctx, WrappedOpenGL *gl);
-  void ApplyState(void *ctx, WrappedOpenGL *gl);
+  // if the state currently bound on the context is known it can be passed as the shadow, and then
+  // only the state that differs from it is set.
+  void ApplyState(void *ctx, WrappedOpenGL *gl, const GLRenderState *shadow = NULL);
   void Clear();
   void Serialise(LogState state, void *ctx, WrappedOpenGL *gl);
 
@@ -364,6 +364,15 @@ void GLReplay::FlipOutputWindow(uint64_t id)
   SwapBuffers(&outw);
 }
 
+void GLReplay::GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &ret)
+{
+  // buffer reads in GL don't each need a submission to wait on, so there's nothing to batch
+  ret.resize(ranges.size());
+
+  for(size_t i = 0; i < ranges.size(); i++)
+    GetBufferData(ranges[i].buffer, ranges[i].offset, ranges[i].length, ret[i]);
+}
+
 void GLReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &ret)
 {
   if(m_pDriver->m_Buffers.find(buff) == m_pDriver->m_Buffers.end())
@@ -837,6 +846,9 @@ ShaderReflection *GLReplay::GetShader(ResourceId shader, string entryPoint)
     return NULL;
   }
 
+  // disassemble lazily on demand
+  shaderDetails.Disassemble();
+
   return &shaderDetails.reflection;
 }
 
@@ -2242,13 +2254,21 @@ byte *GLReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
     arraysize = texDetails.depth;
   }
 
-  if(params.remap && intFormat != eGL_RGBA8 && intFormat != eGL_SRGB8_ALPHA8)
+  // anything that isn't remapped to RGBA8 is rendered at full float precision, the proxy packs it
+  // down further if it needs to
+  GLenum remapFormat = eGL_NONE;
+  if(params.remap == eRemap_RGBA32)
+    remapFormat = eGL_RGBA32F;
+  else if(params.remap)
+    remapFormat = IsSRGBFormat(intFormat) ? eGL_SRGB8_ALPHA8 : eGL_RGBA8;
+
+  if(params.remap && intFormat != remapFormat)
   {
-    RDCASSERT(params.remap == eRemap_RGBA8);
+    RDCASSERT(params.remap == eRemap_RGBA8 || params.remap == eRemap_RGBA32);
 
     MakeCurrentReplayContext(m_DebugCtx);
 
-    GLenum finalFormat = IsSRGBFormat(intFormat) ? eGL_SRGB8_ALPHA8 : eGL_RGBA8;
+    GLenum finalFormat = remapFormat;
     GLenum newtarget = (texType == eGL_TEXTURE_3D ? eGL_TEXTURE_3D : eGL_TEXTURE_2D);
 
     // create temporary texture of width/height in RGBA8 format to render to
@@ -3160,11 +3180,11 @@ ResourceId GLReplay::CreateProxyBuffer(const FetchBuffer &templateBuf)
   return id;
 }
 
-void GLReplay::SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+void GLReplay::SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize)
 {
   GLuint buf = m_pDriver->GetResourceManager()->GetCurrentResource(bufid).name;
 
-  m_pDriver->glNamedBufferSubDataEXT(buf, 0, dataSize, data);
+  m_pDriver->glNamedBufferSubDataEXT(buf, (GLintptr)offset, dataSize, data);
 }
 
 vector<EventUsage> GLReplay::GetUsage(ResourceId id)
@@ -3174,14 +3194,6 @@ vector<EventUsage> GLReplay::GetUsage(ResourceId id)
 
 #pragma endregion
 
-vector<PixelModification> GLReplay::PixelHistory(vector<EventUsage> events, ResourceId target,
-                                                 uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
-                                                 uint32_t sampleIdx, FormatComponentType typeHint)
-{
-  GLNOTIMP("GLReplay::PixelHistory");
-  return vector<PixelModification>();
-}
-
 ShaderDebugTrace GLReplay::DebugVertex(uint32_t eventID, uint32_t vertid, uint32_t instid,
                                        uint32_t idx, uint32_t instOffset, uint32_t vertOffset)
 {
@@ -3227,7 +3239,10 @@ void GLReplay::CloseReplayContext()
 uint64_t GLReplay::MakeOutputWindow(WindowingSystem system, void *data, bool depth)
 {
   OutputWindow win = m_pDriver->m_Platform.MakeOutputWindow(system, data, depth, m_ReplayCtx);
-  if(!win.wnd)
+
+  // on a surfaceless replay context, internal windows have a context but no surface either
+  bool surfaceless = (system == eWindowingSystem_Unknown && !m_ReplayCtx.wnd);
+  if(!win.ctx || (!win.wnd && !surfaceless))
     return eReplayCreate_APIInitFailed;
 
   m_pDriver->m_Platform.GetOutputWindowDimensions(win, win.width, win.height);
@@ -3279,12 +3294,32 @@ bool GLReplay::IsOutputWindowVisible(uint64_t id)
   return m_pDriver->m_Platform.IsOutputWindowVisible(m_OutputWindows[id]);
 }
 
+static string GL_ReadMarkerName(Serialiser *ser)
+{
+  string name;
+  ser->SerialiseInternedString("Name", name);
+  return name;
+}
+
+static CaptureChunkInfo GL_CaptureChunkInfo()
+{
+  CaptureChunkInfo info;
+  info.chunkName = &WrappedOpenGL::GetChunkName;
+  info.readMarkerName = &GL_ReadMarkerName;
+  info.captureScope = CAPTURE_SCOPE;
+  info.pushMarker = BEGIN_EVENT;
+  info.popMarker = END_EVENT;
+  info.setMarker = SET_MARKER;
+  return info;
+}
+
 #if defined(RENDERDOC_SUPPORT_GL)
 
 // defined in gl_replay_<platform>.cpp
 ReplayCreateStatus GL_CreateReplayDevice(const char *logfile, IReplayDriver **driver);
 
 static DriverRegistration GLDriverRegistration(RDC_OpenGL, "OpenGL", &GL_CreateReplayDevice);
+static DriverRegistration GLChunkInfoRegistration(RDC_OpenGL, GL_CaptureChunkInfo());
 
 #endif
 
@@ -3294,5 +3329,6 @@ static DriverRegistration GLDriverRegistration(RDC_OpenGL, "OpenGL", &GL_CreateR
 ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **driver);
 
 static DriverRegistration GLESDriverRegistration(RDC_OpenGLES, "OpenGLES", &GLES_CreateReplayDevice);
+static DriverRegistration GLESChunkInfoRegistration(RDC_OpenGLES, GL_CaptureChunkInfo());
 
 #endif
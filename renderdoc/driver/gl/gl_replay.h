@@ -151,10 +151,20 @@ public:
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches);
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches);
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
 
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &ret);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &ret);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
@@ -167,6 +177,16 @@ public:
 
   void RenderMesh(uint32_t eventID, const vector<MeshFormat> &secondaryDraws, const MeshDisplay &cfg);
 
+  // GL shaders are compiled by the driver on the replay context, so there's nothing that can be
+  // done ahead of time on another thread.
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+  }
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type)
+  {
+  }
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
@@ -180,6 +200,16 @@ public:
   };
 
   bool RenderTexture(TextureDisplay cfg);
+  bool HasPendingTextureData() { return false; }
+  vector<ProxyCommandStats> GetProxyStats() { return vector<ProxyCommandStats>(); }
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total)
+  {
+    return false;
+  }
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total)
+  {
+    return false;
+  }
   bool RenderTextureInternal(TextureDisplay cfg, int flags);
 
   void RenderCheckerboard(Vec3f light, Vec3f dark);
@@ -212,11 +242,14 @@ public:
   bool IsTextureSupported(const ResourceFormat &format);
 
   ResourceId CreateProxyBuffer(const FetchBuffer &templateBuf);
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize);
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize);
 
   bool IsRenderOutput(ResourceId id);
 
   void FileChanged() {}
+  // only the post-VS cache is tracked on GL
+  vector<ReplayMemoryStats> GetMemoryStats();
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID);
   void InitCallstackResolver();
   bool HasCallstacks();
   Callstack::StackResolver *GetCallstackResolver();
@@ -296,6 +329,20 @@ private:
     GLuint histogramProgram[64];      // RESTYPE indexed (see debuguniforms.h, 1d/2d/3d etc |
                                       // uint/sint) src tex -> histogram result buf program
 
+    // value search data
+    GLuint valueSearchResult;           // count + matches, resized to fit the search
+    GLuint valueSearchTexProgram[64];   // RESTYPE indexed, float textures only
+    GLuint valueSearchBufProgram;       // searches a buffer of float elements
+
+    // texture diff data
+    GLuint diffFBO;
+    GLuint diffInputs[2];    // raw RGBA32F copies of the two subresources being compared
+    uint32_t diffInputWidth[2], diffInputHeight[2];
+    GLuint diffTex;        // RGBA32F absolute difference of the inputs
+    GLuint diffResult;     // Vec4u[2] max error bits + count of differing texels
+    GLuint diffProgram;    // inputs -> diff texture + result program
+    ResourceId DiffTexID;
+
     GLuint outlineQuadProg;
 
     GLuint texDisplayPipe;
@@ -380,10 +427,18 @@ private:
 
   // eventID -> data
   map<uint32_t, GLPostVSData> m_PostVSData;
+  uint64_t GetPostVSDataSize(const GLPostVSData &data);
 
   void InitDebugData();
   void DeleteDebugData();
 
+  // size and reset the value search result buffer, then read back what a search found
+  void PrepareValueSearch(uint32_t maxMatches);
+  void FetchValueSearchResults(uint32_t maxMatches, vector<ValueSearchMatch> &matches,
+                               uint32_t &numMatches);
+  // (re)create a single-mip RGBA32F texture for diffing, if it's not already the right size
+  void CreateDiffTexture(GLuint &tex, uint32_t w, uint32_t h);
+
   void CheckGLSLVersion(const char *sl, int &glslVersion);
 
   // called after the context is created, to init any counters
@@ -393,6 +448,7 @@ private:
 
   void FillTimers(GLCounterContext &ctx, const DrawcallTreeNode &drawnode,
                   const vector<uint32_t> &counters);
+  void FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret);
 
   GLuint CreateShaderProgram(const vector<string> &vs, const vector<string> &fs,
                              const vector<string> &gs);
@@ -46,6 +46,7 @@ typedef EGLBoolean (*PFN_eglChooseConfig)(EGLDisplay dpy, const EGLint *attrib_l
                                           EGLConfig *configs, EGLint config_size, EGLint *num_config);
 typedef __eglMustCastToProperFunctionPointerType (*PFN_eglGetProcAddress)(const char *procname);
 typedef EGLBoolean (*PFN_eglInitialize)(EGLDisplay dpy, EGLint *major, EGLint *minor);
+typedef const char *(*PFN_eglQueryString)(EGLDisplay dpy, EGLint name);
 
 PFN_eglBindAPI eglBindAPIProc = NULL;
 PFN_eglInitialize eglInitializeProc = NULL;
@@ -60,10 +61,60 @@ PFN_eglCreatePbufferSurface eglCreatePbufferSurfaceProc = NULL;
 PFN_eglCreateWindowSurface eglCreateWindowSurfaceProc = NULL;
 PFN_eglChooseConfig eglChooseConfigProc = NULL;
 PFN_eglGetProcAddress eglGetProcAddressProc = NULL;
+PFN_eglQueryString eglQueryStringProc = NULL;
 
 const GLHookSet &GetRealGLFunctionsEGL();
 GLPlatform &GetGLPlatformEGL();
 
+// with no window system available, open a display directly on a GPU. RENDERDOC_EGL_DEVICE selects
+// which of the EGL devices to use, so that several replays can be spread across a machine's GPUs.
+static EGLDisplay GetHeadlessDisplay()
+{
+  const char *clientExts = eglQueryStringProc(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddressProc("eglGetPlatformDisplayEXT");
+
+  if(clientExts == NULL || getPlatformDisplay == NULL)
+    return EGL_NO_DISPLAY;
+
+  PFNEGLQUERYDEVICESEXTPROC queryDevices =
+      (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddressProc("eglQueryDevicesEXT");
+
+  EGLDeviceEXT devices[16];
+  EGLint numDevices = 0;
+
+  if(strstr(clientExts, "EGL_EXT_platform_device") && queryDevices &&
+     queryDevices(ARRAY_COUNT(devices), devices, &numDevices) && numDevices > 0)
+  {
+    EGLint idx = 0;
+
+    const char *deviceVar = getenv("RENDERDOC_EGL_DEVICE");
+    if(deviceVar)
+      idx = atoi(deviceVar);
+
+    if(idx < 0 || idx >= numDevices)
+    {
+      RDCWARN("RENDERDOC_EGL_DEVICE=%d is out of range, %d devices available", idx, numDevices);
+      idx = 0;
+    }
+
+    RDCLOG("Replaying headless on EGL device %d of %d", idx, numDevices);
+
+    EGLDisplay dpy = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[idx], NULL);
+    if(dpy != EGL_NO_DISPLAY)
+      return dpy;
+  }
+
+  if(strstr(clientExts, "EGL_MESA_platform_surfaceless"))
+  {
+    RDCLOG("Replaying headless on the surfaceless EGL platform");
+    return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  }
+
+  return EGL_NO_DISPLAY;
+}
+
 ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **driver)
 {
   RDCDEBUG("Creating an OpenGL ES replay device");
@@ -72,6 +123,7 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
   if(eglCreateContextProc == NULL)
   {
     eglGetProcAddressProc = (PFN_eglGetProcAddress)dlsym(RTLD_NEXT, "eglGetProcAddress");
+    eglQueryStringProc = (PFN_eglQueryString)dlsym(RTLD_NEXT, "eglQueryString");
     eglChooseConfigProc = (PFN_eglChooseConfig)dlsym(RTLD_NEXT, "eglChooseConfig");
     eglInitializeProc = (PFN_eglInitialize)dlsym(RTLD_NEXT, "eglInitialize");
     eglBindAPIProc = (PFN_eglBindAPI)dlsym(RTLD_NEXT, "eglBindAPI");
@@ -91,7 +143,8 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
        eglCreateContextProc == NULL || eglMakeCurrentProc == NULL || eglSwapBuffersProc == NULL ||
        eglDestroyContextProc == NULL || eglDestroySurfaceProc == NULL ||
        eglQuerySurfaceProc == NULL || eglCreatePbufferSurfaceProc == NULL ||
-       eglCreateWindowSurfaceProc == NULL || eglChooseConfigProc == NULL)
+       eglCreateWindowSurfaceProc == NULL || eglChooseConfigProc == NULL ||
+       eglQueryStringProc == NULL)
     {
       RDCERR(
           "Couldn't find required function addresses, eglGetProcAddress eglCreateContext"
@@ -113,39 +166,65 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
       return status;
   }
 
+  bool headless = false;
+
 #if DISABLED(RDOC_ANDROID)
   Display *dpy = XOpenDisplay(NULL);
 
   if(dpy == NULL)
   {
-    RDCERR("Couldn't open default X display");
-    return eReplayCreate_APIInitFailed;
+    RDCLOG("Couldn't open default X display, replaying headless");
+    headless = true;
   }
 #endif
 
   eglBindAPIProc(EGL_OPENGL_ES_API);
 
-  EGLDisplay eglDisplay = eglGetDisplayProc(EGL_DEFAULT_DISPLAY);
+  EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+  if(headless)
+    eglDisplay = GetHeadlessDisplay();
+  else
+    eglDisplay = eglGetDisplayProc(EGL_DEFAULT_DISPLAY);
+
   if(!eglDisplay)
   {
-    RDCERR("Couldn't open default EGL display");
+    RDCERR("Couldn't open %s EGL display", headless ? "a headless" : "default");
     return eReplayCreate_APIInitFailed;
   }
 
   int major, minor;
-  eglInitializeProc(eglDisplay, &major, &minor);
-
-  static const EGLint configAttribs[] = {EGL_RED_SIZE,
-                                         8,
-                                         EGL_GREEN_SIZE,
-                                         8,
-                                         EGL_BLUE_SIZE,
-                                         8,
-                                         EGL_RENDERABLE_TYPE,
-                                         EGL_OPENGL_ES3_BIT,
-                                         EGL_SURFACE_TYPE,
-                                         EGL_PBUFFER_BIT | EGL_WINDOW_BIT,
-                                         EGL_NONE};
+  if(!eglInitializeProc(eglDisplay, &major, &minor))
+  {
+    RDCERR("Couldn't initialise EGL display");
+    return eReplayCreate_APIInitFailed;
+  }
+
+  // a headless replay doesn't need any surface, so don't create a pbuffer if the context can be
+  // made current without one
+  bool surfaceless = false;
+  if(headless)
+  {
+    const char *exts = eglQueryStringProc(eglDisplay, EGL_EXTENSIONS);
+    surfaceless = (exts && strstr(exts, "EGL_KHR_surfaceless_context"));
+  }
+
+  EGLint surfaceType = EGL_PBUFFER_BIT | EGL_WINDOW_BIT;
+  if(surfaceless)
+    surfaceType = 0;
+  else if(headless)
+    surfaceType = EGL_PBUFFER_BIT;
+
+  const EGLint configAttribs[] = {EGL_RED_SIZE,
+                                  8,
+                                  EGL_GREEN_SIZE,
+                                  8,
+                                  EGL_BLUE_SIZE,
+                                  8,
+                                  EGL_RENDERABLE_TYPE,
+                                  EGL_OPENGL_ES3_BIT,
+                                  EGL_SURFACE_TYPE,
+                                  surfaceType,
+                                  EGL_NONE};
   EGLint numConfigs;
   EGLConfig config;
 
@@ -164,7 +243,8 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
   if(ctx == NULL)
   {
 #if DISABLED(RDOC_ANDROID)
-    XCloseDisplay(dpy);
+    if(dpy)
+      XCloseDisplay(dpy);
 #endif
     GLReplay::PostContextShutdownCounters();
     RDCERR("Couldn't create GL ES 3.x context - RenderDoc requires OpenGL ES 3.x availability");
@@ -172,14 +252,17 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
   }
 
   static const EGLint pbAttribs[] = {EGL_WIDTH, 32, EGL_HEIGHT, 32, EGL_NONE};
-  EGLSurface pbuffer = eglCreatePbufferSurfaceProc(eglDisplay, config, pbAttribs);
+  EGLSurface pbuffer = EGL_NO_SURFACE;
+  if(!surfaceless)
+    pbuffer = eglCreatePbufferSurfaceProc(eglDisplay, config, pbAttribs);
 
-  if(pbuffer == NULL)
+  if(pbuffer == NULL && !surfaceless)
   {
     RDCERR("Couldn't create a suitable PBuffer");
     eglDestroySurfaceProc(eglDisplay, pbuffer);
 #if DISABLED(RDOC_ANDROID)
-    XCloseDisplay(dpy);
+    if(dpy)
+      XCloseDisplay(dpy);
 #endif
     GLReplay::PostContextShutdownCounters();
     return eReplayCreate_APIInitFailed;
@@ -192,7 +275,8 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
     eglDestroySurfaceProc(eglDisplay, pbuffer);
     eglDestroyContextProc(eglDisplay, ctx);
 #if DISABLED(RDOC_ANDROID)
-    XCloseDisplay(dpy);
+    if(dpy)
+      XCloseDisplay(dpy);
 #endif
     GLReplay::PostContextShutdownCounters();
     return eReplayCreate_APIInitFailed;
@@ -207,7 +291,8 @@ ReplayCreateStatus GLES_CreateReplayDevice(const char *logfile, IReplayDriver **
     eglDestroySurfaceProc(eglDisplay, pbuffer);
     eglDestroyContextProc(eglDisplay, ctx);
 #if DISABLED(RDOC_ANDROID)
-    XCloseDisplay(dpy);
+    if(dpy)
+      XCloseDisplay(dpy);
 #endif
     GLReplay::PostContextShutdownCounters();
     return eReplayCreate_APIHardwareUnsupported;
@@ -135,6 +135,15 @@ struct GLResource
   }
 };
 
+template <>
+struct HashKey<GLResource>
+{
+  static uint64_t Hash(const GLResource &res)
+  {
+    return HashMix64((uint64_t)(uintptr_t)res.Context ^ (uint64_t(res.Namespace) << 32) ^ res.name);
+  }
+};
+
 // Shared objects currently ignore the context parameter.
 // For correctness we'd need to check if the context is shared and if so move up to a 'parent'
 // so the context value ends up being identical for objects being shared, but can be different
@@ -201,7 +210,13 @@ struct GLResourceRecord : public ResourceRecord
 
   static byte markerValue[32];
 
-  GLResourceRecord(ResourceId id) : ResourceRecord(id, true), datatype(eGL_NONE), usage(eGL_NONE)
+  GLResourceRecord(ResourceId id)
+      : ResourceRecord(id, true),
+        datatype(eGL_NONE),
+        usage(eGL_NONE),
+        ShadowSize(0),
+        ShadowTrackWrites(false),
+        ShadowWatch(0)
   {
     RDCEraseEl(ShadowPtr);
     RDCEraseEl(Map);
@@ -234,17 +249,15 @@ struct GLResourceRecord : public ResourceRecord
   void FilterChunks(const ChunkFilter &filter)
   {
     LockChunks();
-    std::vector<std::map<int32_t, Chunk *>::iterator> deletions;
-    for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
-    {
-      if(filter(it->second))
-        deletions.push_back(it);
-    }
-    for(size_t i = 0; i < deletions.size(); i++)
+    size_t kept = 0;
+    for(size_t i = 0; i < m_Chunks.size(); i++)
     {
-      SAFE_DELETE(deletions[i]->second);
-      m_Chunks.erase(deletions[i]);
+      if(filter(m_Chunks[i].second))
+        SAFE_DELETE(m_Chunks[i].second);
+      else
+        m_Chunks[kept++] = m_Chunks[i];
     }
+    m_Chunks.resize(kept);
     UnlockChunks();
   }
 
@@ -273,17 +286,31 @@ struct GLResourceRecord : public ResourceRecord
 
   GLResource Resource;
 
-  void AllocShadowStorage(size_t size)
+  // if trackWrites is set, the first shadow buffer is page aligned and padded to whole pages so
+  // that writes to it can be watched, see WatchShadowWrites
+  void AllocShadowStorage(size_t size, bool trackWrites = false)
   {
     if(ShadowPtr[0] == NULL)
     {
-      ShadowPtr[0] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      if(trackWrites)
+      {
+        size_t pageSize = VirtualMemory::GetPageSize();
+        ShadowPtr[0] = Serialiser::AllocAlignedBuffer(AlignUp(size + sizeof(markerValue), pageSize),
+                                                      pageSize);
+      }
+      else
+      {
+        ShadowPtr[0] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      }
       ShadowPtr[1] = Serialiser::AllocAlignedBuffer(size + sizeof(markerValue));
+      ShadowTrackWrites = trackWrites;
 
       memcpy(ShadowPtr[0] + size, markerValue, sizeof(markerValue));
       memcpy(ShadowPtr[1] + size, markerValue, sizeof(markerValue));
 
       ShadowSize = size;
+
+      RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows, int64_t(size * 2));
     }
   }
 
@@ -298,12 +325,27 @@ struct GLResourceRecord : public ResourceRecord
     return true;
   }
 
+  // starts tracking which pages of the first shadow buffer are written, so that comparing it
+  // against the second only needs to look at those. Does nothing unless it was allocated to allow
+  // it
+  void WatchShadowWrites()
+  {
+    if(ShadowPtr[0] != NULL && ShadowTrackWrites && ShadowWatch == 0)
+      ShadowWatch = WriteWatch::Begin(ShadowPtr[0], ShadowSize + sizeof(markerValue));
+  }
+
+  uint64_t GetShadowWatch() { return ShadowWatch; }
   void FreeShadowStorage()
   {
+    WriteWatch::End(ShadowWatch);
+    ShadowWatch = 0;
+
     if(ShadowPtr[0] != NULL)
     {
       Serialiser::FreeAlignedBuffer(ShadowPtr[0]);
       Serialiser::FreeAlignedBuffer(ShadowPtr[1]);
+
+      RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows, -int64_t(ShadowSize * 2));
     }
     ShadowPtr[0] = ShadowPtr[1] = NULL;
   }
@@ -312,4 +354,6 @@ struct GLResourceRecord : public ResourceRecord
 private:
   byte *ShadowPtr[2];
   size_t ShadowSize;
+  bool ShadowTrackWrites;
+  uint64_t ShadowWatch;
 };
@@ -53,6 +53,8 @@ bool WrappedOpenGL::Serialise_glGenBuffers(GLsizei n, GLuint *buffers)
 
 void WrappedOpenGL::glGenBuffers(GLsizei n, GLuint *buffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenBuffers(n, buffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -108,6 +110,8 @@ bool WrappedOpenGL::Serialise_glCreateBuffers(GLsizei n, GLuint *buffers)
 
 void WrappedOpenGL::glCreateBuffers(GLsizei n, GLuint *buffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateBuffers(n, buffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -184,6 +188,8 @@ bool WrappedOpenGL::Serialise_glBindBuffer(GLenum target, GLuint buffer)
 
 void WrappedOpenGL::glBindBuffer(GLenum target, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindBuffer(target, buffer);
 
   ContextData &cd = GetCtxData();
@@ -326,11 +332,11 @@ bool WrappedOpenGL::Serialise_glNamedBufferStorageEXT(GLuint buffer, GLsizeiptr
   SERIALISE_ELEMENT(uint64_t, Bytesize, (uint64_t)size);
 
   // for satisfying GL_MIN_MAP_BUFFER_ALIGNMENT
-  m_pSerialiser->AlignNextBuffer(64);
+  GetSerialiser()->AlignNextBuffer(64);
 
-  SERIALISE_ELEMENT_BUF(byte *, bytes, data, (size_t)Bytesize);
+  SERIALISE_ELEMENT_BUF_BORROWED(bytes, data, (size_t)Bytesize);
 
-  uint64_t offs = m_pSerialiser->GetOffset();
+  uint64_t offs = GetSerialiser()->GetOffset();
 
   SERIALISE_ELEMENT(uint32_t, Flags, flags);
 
@@ -347,8 +353,6 @@ bool WrappedOpenGL::Serialise_glNamedBufferStorageEXT(GLuint buffer, GLsizeiptr
     m_Real.glNamedBufferStorageEXT(res.name, (GLsizeiptr)Bytesize, bytes, Flags);
 
     m_Buffers[GetResourceManager()->GetLiveID(id)].size = Bytesize;
-
-    SAFE_DELETE_ARRAY(bytes);
   }
   else if(m_State >= WRITING)
   {
@@ -376,7 +380,7 @@ void WrappedOpenGL::Common_glNamedBufferStorageEXT(ResourceId id, GLsizeiptr siz
 
     {
       record->AddChunk(chunk);
-      record->SetDataPtr(chunk->GetData());
+      record->SetDataPtr(chunk->GetWritableData());
       record->Length = (int32_t)size;
       record->DataInSerialiser = true;
     }
@@ -393,12 +397,17 @@ void WrappedOpenGL::Common_glNamedBufferStorageEXT(ResourceId id, GLsizeiptr siz
           GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_PERSISTENT_BIT);
       RDCASSERT(record->Map.persistentPtr);
 
+      bool trackWrites = (RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites != 0);
+
       // persistent maps always need both sets of shadow storage, so allocate up front.
-      record->AllocShadowStorage(size);
+      record->AllocShadowStorage(size, trackWrites);
 
       // ensure shadow pointers have up to date data for diffing
       memcpy(record->GetShadowPtr(0), data, size);
       memcpy(record->GetShadowPtr(1), data, size);
+
+      // from now on only the pages the application writes need to be diffed
+      record->WatchShadowWrites();
     }
   }
   else
@@ -410,6 +419,8 @@ void WrappedOpenGL::Common_glNamedBufferStorageEXT(ResourceId id, GLsizeiptr siz
 void WrappedOpenGL::glNamedBufferStorageEXT(GLuint buffer, GLsizeiptr size, const void *data,
                                             GLbitfield flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   byte *dummy = NULL;
 
   if(m_State >= WRITING && data == NULL)
@@ -430,12 +441,16 @@ void WrappedOpenGL::glNamedBufferStorageEXT(GLuint buffer, GLsizeiptr size, cons
 void WrappedOpenGL::glNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void *data,
                                          GLbitfield flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   glNamedBufferStorageEXT(buffer, size, data, flags);
 }
 
 void WrappedOpenGL::glBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   byte *dummy = NULL;
 
   if(m_State >= WRITING && data == NULL)
@@ -463,11 +478,11 @@ bool WrappedOpenGL::Serialise_glNamedBufferDataEXT(GLuint buffer, GLsizeiptr siz
   SERIALISE_ELEMENT(uint64_t, Bytesize, (uint64_t)size);
 
   // for satisfying GL_MIN_MAP_BUFFER_ALIGNMENT
-  m_pSerialiser->AlignNextBuffer(64);
+  GetSerialiser()->AlignNextBuffer(64);
 
-  SERIALISE_ELEMENT_BUF(byte *, bytes, data, (size_t)Bytesize);
+  SERIALISE_ELEMENT_BUF_BORROWED(bytes, data, (size_t)Bytesize);
 
-  uint64_t offs = m_pSerialiser->GetOffset();
+  uint64_t offs = GetSerialiser()->GetOffset();
 
   SERIALISE_ELEMENT(GLenum, Usage, usage);
 
@@ -477,8 +492,6 @@ bool WrappedOpenGL::Serialise_glNamedBufferDataEXT(GLuint buffer, GLsizeiptr siz
     m_Real.glNamedBufferDataEXT(res.name, (GLsizeiptr)Bytesize, bytes, Usage);
 
     m_Buffers[GetResourceManager()->GetLiveID(id)].size = Bytesize;
-
-    SAFE_DELETE_ARRAY(bytes);
   }
   else if(m_State >= WRITING)
   {
@@ -490,18 +503,41 @@ bool WrappedOpenGL::Serialise_glNamedBufferDataEXT(GLuint buffer, GLsizeiptr siz
   return true;
 }
 
-void WrappedOpenGL::glNamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const void *data,
-                                         GLenum usage)
+bool WrappedOpenGL::CaptureBufferOrphan(GLResourceRecord *record, GLsizeiptr size,
+                                        const void *data, GLenum usage)
 {
-  byte *dummy = NULL;
+  // re-specifying a buffer with the same size and usage is orphaning, used to stream data without
+  // waiting on the GPU. The buffer we replay on is the same either way, so this only needs to
+  // record the new contents rather than a whole new buffer.
+  if(!record->HasDataPtr() || size != (GLsizeiptr)record->Length || usage != record->usage)
+    return false;
 
-  if(m_State >= WRITING && data == NULL)
+  // orphaning without data leaves the contents undefined, so there's nothing to store or
+  // serialise and the backing store can keep what it had
+  if(data == NULL)
+    return true;
+
+  if(m_State == WRITING_IDLE)
   {
-    dummy = new byte[size];
-    memset(dummy, 0xdd, size);
-    data = dummy;
+    memcpy(record->GetDataPtr(), data, (size_t)size);
+  }
+  else if(m_State == WRITING_CAPFRAME)
+  {
+    // the whole buffer is overwritten, so its previous contents aren't needed
+    GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(), eFrameRef_Write);
+
+    // replay as an update of the existing buffer rather than re-creating it each time
+    CaptureBufferSubData(record, 0, size, data);
   }
 
+  return true;
+}
+
+void WrappedOpenGL::glNamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const void *data,
+                                         GLenum usage)
+{
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedBufferDataEXT(buffer, size, data, usage);
 
   if(m_State >= WRITING)
@@ -513,18 +549,17 @@ void WrappedOpenGL::glNamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const v
     if(record == NULL)
       return;
 
-    // detect buffer orphaning and just update backing store
-    if(m_State == WRITING_IDLE && record->HasDataPtr() && size == (GLsizeiptr)record->Length &&
-       usage == record->usage)
-    {
-      if(data)
-        memcpy(record->GetDataPtr(), data, (size_t)size);
-      else
-        memset(record->GetDataPtr(), 0xbe, (size_t)size);
+    if(CaptureBufferOrphan(record, size, data, usage))
+      return;
 
-      SAFE_DELETE_ARRAY(dummy);
+    // the chunk needs contents to serialise even though GL leaves them undefined
+    byte *dummy = NULL;
 
-      return;
+    if(data == NULL)
+    {
+      dummy = new byte[size];
+      memset(dummy, 0xdd, size);
+      data = dummy;
     }
 
     // if we're recreating the buffer, clear the record and add new chunks. Normally
@@ -601,36 +636,31 @@ void WrappedOpenGL::glNamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const v
     else
     {
       record->AddChunk(chunk);
-      record->SetDataPtr(chunk->GetData());
+      record->SetDataPtr(chunk->GetWritableData());
       record->Length = (int32_t)size;
       record->usage = usage;
       record->DataInSerialiser = true;
     }
+
+    SAFE_DELETE_ARRAY(dummy);
   }
   else
   {
     m_Buffers[GetResourceManager()->GetID(BufferRes(GetCtx(), buffer))].size = size;
   }
-
-  SAFE_DELETE_ARRAY(dummy);
 }
 
 void WrappedOpenGL::glNamedBufferData(GLuint buffer, GLsizeiptr size, const void *data, GLenum usage)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   glNamedBufferDataEXT(buffer, size, data, usage);
 }
 
 void WrappedOpenGL::glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
 {
-  byte *dummy = NULL;
-
-  if(m_State >= WRITING && data == NULL)
-  {
-    dummy = new byte[size];
-    memset(dummy, 0xdd, size);
-    data = dummy;
-  }
+  SCOPED_ENTRY_PROFILE();
 
   m_Real.glBufferData(target, size, data, usage);
 
@@ -645,18 +675,17 @@ void WrappedOpenGL::glBufferData(GLenum target, GLsizeiptr size, const void *dat
     if(record == NULL)
       return;
 
-    // detect buffer orphaning and just update backing store
-    if(m_State == WRITING_IDLE && record->HasDataPtr() && size == (GLsizeiptr)record->Length &&
-       usage == record->usage)
-    {
-      if(data)
-        memcpy(record->GetDataPtr(), data, (size_t)size);
-      else
-        memset(record->GetDataPtr(), 0xbe, (size_t)size);
+    if(CaptureBufferOrphan(record, size, data, usage))
+      return;
 
-      SAFE_DELETE_ARRAY(dummy);
+    // the chunk needs contents to serialise even though GL leaves them undefined
+    byte *dummy = NULL;
 
-      return;
+    if(data == NULL)
+    {
+      dummy = new byte[size];
+      memset(dummy, 0xdd, size);
+      data = dummy;
     }
 
     GLuint buffer = record->Resource.name;
@@ -735,18 +764,18 @@ void WrappedOpenGL::glBufferData(GLenum target, GLsizeiptr size, const void *dat
     else
     {
       record->AddChunk(chunk);
-      record->SetDataPtr(chunk->GetData());
+      record->SetDataPtr(chunk->GetWritableData());
       record->Length = size;
       record->usage = usage;
       record->DataInSerialiser = true;
     }
+
+    SAFE_DELETE_ARRAY(dummy);
   }
   else
   {
     RDCERR("Internal buffers should be allocated via dsa interfaces");
   }
-
-  SAFE_DELETE_ARRAY(dummy);
 }
 
 bool WrappedOpenGL::Serialise_glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset,
@@ -755,22 +784,97 @@ bool WrappedOpenGL::Serialise_glNamedBufferSubDataEXT(GLuint buffer, GLintptr of
   SERIALISE_ELEMENT(ResourceId, id, GetResourceManager()->GetID(BufferRes(GetCtx(), buffer)));
   SERIALISE_ELEMENT(uint64_t, Offset, (uint64_t)offset);
   SERIALISE_ELEMENT(uint64_t, Bytesize, (uint64_t)size);
-  SERIALISE_ELEMENT_BUF(byte *, bytes, data, (size_t)Bytesize);
+  SERIALISE_ELEMENT_BUF_BORROWED(bytes, data, (size_t)Bytesize);
 
   if(m_State < WRITING)
   {
     GLResource res = GetResourceManager()->GetLiveResource(id);
     m_Real.glNamedBufferSubDataEXT(res.name, (GLintptr)Offset, (GLsizeiptr)Bytesize, bytes);
-
-    SAFE_DELETE_ARRAY(bytes);
   }
 
   return true;
 }
 
+void WrappedOpenGL::CaptureBufferSubData(GLResourceRecord *record, GLintptr offset,
+                                         GLsizeiptr size, const void *data)
+{
+  PendingBufferSubData &pending = m_PendingBufferSubData;
+
+  uint64_t start = (uint64_t)offset;
+  uint64_t end = start + (uint64_t)size;
+
+  // an update can only be folded into the pending one if nothing else has been recorded since the
+  // pending update's place in the frame, and the ranges overlap or are adjacent
+  bool merge = data && size > 0 && pending.record == record &&
+               (!m_ContextRecord->HasChunks() ||
+                m_ContextRecord->GetLastChunkID() < pending.chunkID) &&
+               start <= pending.offset + pending.data.size() && end >= pending.offset;
+
+  if(merge)
+  {
+    if(start < pending.offset)
+    {
+      pending.data.insert(pending.data.begin(), size_t(pending.offset - start), byte(0));
+      pending.offset = start;
+    }
+
+    if(end > pending.offset + pending.data.size())
+      pending.data.resize(size_t(end - pending.offset));
+
+    memcpy(&pending.data[size_t(start - pending.offset)], data, (size_t)size);
+  }
+  else
+  {
+    FlushBufferSubData();
+
+    if(data && size > 0)
+    {
+      pending.record = record;
+      pending.chunkID = m_ContextRecord->ReserveChunkID();
+      pending.offset = start;
+      pending.data.assign((const byte *)data, (const byte *)data + size);
+    }
+    else
+    {
+      SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
+      Serialise_glNamedBufferSubDataEXT(record->Resource.name, offset, size, data);
+
+      m_ContextRecord->AddChunk(scope.Get());
+    }
+  }
+
+  m_MissingTracks.insert(record->GetResourceID());
+  GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(),
+                                                    eFrameRef_ReadBeforeWrite);
+}
+
+void WrappedOpenGL::FlushBufferSubData()
+{
+  PendingBufferSubData &pending = m_PendingBufferSubData;
+
+  if(pending.record == NULL)
+    return;
+
+  Chunk *chunk = NULL;
+
+  {
+    SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
+    Serialise_glNamedBufferSubDataEXT(pending.record->Resource.name, (GLintptr)pending.offset,
+                                      (GLsizeiptr)pending.data.size(), &pending.data[0]);
+
+    chunk = scope.Get();
+  }
+
+  m_ContextRecord->AddChunk(chunk, pending.chunkID);
+
+  pending = PendingBufferSubData();
+}
+
 void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsizeiptr size,
                                             const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedBufferSubDataEXT(buffer, offset, size, data);
 
   if(m_State >= WRITING)
@@ -785,21 +889,16 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
        m_State != WRITING_CAPFRAME)
       return;
 
-    SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
-    Serialise_glNamedBufferSubDataEXT(buffer, offset, size, data);
-
-    Chunk *chunk = scope.Get();
-
     if(m_State == WRITING_CAPFRAME)
     {
-      m_ContextRecord->AddChunk(chunk);
-      m_MissingTracks.insert(record->GetResourceID());
-      GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(),
-                                                        eFrameRef_ReadBeforeWrite);
+      CaptureBufferSubData(record, offset, size, data);
     }
     else
     {
-      record->AddChunk(chunk);
+      SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
+      Serialise_glNamedBufferSubDataEXT(buffer, offset, size, data);
+
+      record->AddChunk(scope.Get());
       record->UpdateCount++;
 
       if(record->UpdateCount > 10)
@@ -814,12 +913,16 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
 void WrappedOpenGL::glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size,
                                          const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   glNamedBufferSubDataEXT(buffer, offset, size, data);
 }
 
 void WrappedOpenGL::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBufferSubData(target, offset, size, data);
 
   if(m_State >= WRITING)
@@ -837,21 +940,16 @@ void WrappedOpenGL::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr s
        m_State != WRITING_CAPFRAME)
       return;
 
-    SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
-    Serialise_glNamedBufferSubDataEXT(res.name, offset, size, data);
-
-    Chunk *chunk = scope.Get();
-
     if(m_State == WRITING_CAPFRAME)
     {
-      m_ContextRecord->AddChunk(chunk);
-      m_MissingTracks.insert(record->GetResourceID());
-      GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(),
-                                                        eFrameRef_ReadBeforeWrite);
+      CaptureBufferSubData(record, offset, size, data);
     }
     else
     {
-      record->AddChunk(chunk);
+      SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
+      Serialise_glNamedBufferSubDataEXT(res.name, offset, size, data);
+
+      record->AddChunk(scope.Get());
       record->UpdateCount++;
 
       if(record->UpdateCount > 10)
@@ -889,6 +987,8 @@ void WrappedOpenGL::glNamedCopyBufferSubDataEXT(GLuint readBuffer, GLuint writeB
                                                 GLintptr readOffset, GLintptr writeOffset,
                                                 GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glNamedCopyBufferSubDataEXT(readBuffer, writeBuffer, readOffset, writeOffset, size);
@@ -944,12 +1044,16 @@ void WrappedOpenGL::glCopyNamedBufferSubData(GLuint readBuffer, GLuint writeBuff
                                              GLintptr readOffset, GLintptr writeOffset,
                                              GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   glNamedCopyBufferSubDataEXT(readBuffer, writeBuffer, readOffset, writeOffset, size);
 }
 
 void WrappedOpenGL::glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
                                         GLintptr writeOffset, GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
@@ -1025,6 +1129,8 @@ bool WrappedOpenGL::Serialise_glBindBufferBase(GLenum target, GLuint index, GLui
 
 void WrappedOpenGL::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ContextData &cd = GetCtxData();
 
   if(m_State >= WRITING)
@@ -1133,6 +1239,8 @@ bool WrappedOpenGL::Serialise_glBindBufferRange(GLenum target, GLuint index, GLu
 void WrappedOpenGL::glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset,
                                       GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ContextData &cd = GetCtxData();
 
   if(m_State >= WRITING)
@@ -1252,6 +1360,8 @@ bool WrappedOpenGL::Serialise_glBindBuffersBase(GLenum target, GLuint first, GLs
 void WrappedOpenGL::glBindBuffersBase(GLenum target, GLuint first, GLsizei count,
                                       const GLuint *buffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindBuffersBase(target, first, count, buffers);
 
   ContextData &cd = GetCtxData();
@@ -1403,6 +1513,8 @@ void WrappedOpenGL::glBindBuffersRange(GLenum target, GLuint first, GLsizei coun
                                        const GLuint *buffers, const GLintptr *offsets,
                                        const GLsizeiptr *sizes)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindBuffersRange(target, first, count, buffers, offsets, sizes);
 
   ContextData &cd = GetCtxData();
@@ -1503,6 +1615,8 @@ void WrappedOpenGL::glBindBuffersRange(GLenum target, GLuint first, GLsizei coun
 
 void WrappedOpenGL::glInvalidateBufferData(GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateBufferData(buffer);
 
   if(m_State == WRITING_IDLE)
@@ -1513,6 +1627,8 @@ void WrappedOpenGL::glInvalidateBufferData(GLuint buffer)
 
 void WrappedOpenGL::glInvalidateBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateBufferSubData(buffer, offset, length);
 
   if(m_State == WRITING_IDLE)
@@ -1794,6 +1910,8 @@ void WrappedOpenGL::glInvalidateBufferSubData(GLuint buffer, GLintptr offset, GL
 void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GLsizeiptr length,
                                               GLbitfield access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above for high-level explanation of how mapping is handled
 
   if(m_State >= WRITING)
@@ -1999,6 +2117,8 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
 void *WrappedOpenGL::glMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length,
                                            GLbitfield access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   return glMapNamedBufferRangeEXT(buffer, offset, length, access);
 }
@@ -2006,6 +2126,8 @@ void *WrappedOpenGL::glMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsiz
 void *WrappedOpenGL::glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
                                       GLbitfield access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above glMapNamedBufferRangeEXT for high-level explanation of how mapping is handled
 
   if(m_State >= WRITING)
@@ -2026,6 +2148,8 @@ void *WrappedOpenGL::glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr
 // the glMapBuffer functions are equivalent to glMapBufferRange - so we just pass through
 void *WrappedOpenGL::glMapNamedBufferEXT(GLuint buffer, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = GetResourceManager()->GetResourceRecord(BufferRes(GetCtx(), buffer));
@@ -2054,6 +2178,8 @@ void *WrappedOpenGL::glMapNamedBufferEXT(GLuint buffer, GLenum access)
 
 void *WrappedOpenGL::glMapBuffer(GLenum target, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above glMapNamedBufferRangeEXT for high-level explanation of how mapping is handled
 
   if(m_State >= WRITING)
@@ -2181,6 +2307,8 @@ bool WrappedOpenGL::Serialise_glUnmapNamedBufferEXT(GLuint buffer)
 
 GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above glMapNamedBufferRangeEXT for high-level explanation of how mapping is handled
 
   if(m_State >= WRITING)
@@ -2306,6 +2434,8 @@ GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
 
 GLboolean WrappedOpenGL::glUnmapBuffer(GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above glMapNamedBufferRangeEXT for high-level explanation of how mapping is handled
 
   if(m_State >= WRITING)
@@ -2380,6 +2510,8 @@ bool WrappedOpenGL::Serialise_glFlushMappedNamedBufferRangeEXT(GLuint buffer, GL
 
 void WrappedOpenGL::glFlushMappedNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GLsizeiptr length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // see above glMapNamedBufferRangeEXT for high-level explanation of how mapping is handled
 
   GLResourceRecord *record = GetResourceManager()->GetResourceRecord(BufferRes(GetCtx(), buffer));
@@ -2463,12 +2595,16 @@ void WrappedOpenGL::glFlushMappedNamedBufferRangeEXT(GLuint buffer, GLintptr off
 
 void WrappedOpenGL::glFlushMappedNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   glFlushMappedNamedBufferRangeEXT(buffer, offset, length);
 }
 
 void WrappedOpenGL::glFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = GetCtxData().m_BufferRecord[BufferIdx(target)];
@@ -2491,17 +2627,36 @@ void WrappedOpenGL::PersistentMapMemoryBarrier(const set<GLResourceRecord *> &ma
   // this function iterates over all the maps, checking for any changes between
   // the shadow pointers, and propogates that to 'real' GL
 
+  // ranges that have changed in the current map
+  vector<pair<size_t, size_t> > diffs;
+
   for(set<GLResourceRecord *>::const_iterator it = maps.begin(); it != maps.end(); ++it)
   {
     GLResourceRecord *record = *it;
 
     RDCASSERT(record && record->Map.persistentPtr);
 
-    size_t diffStart = 0, diffEnd = 0;
-    bool found = FindDiffRange(record->GetShadowPtr(0), record->GetShadowPtr(1),
-                               (size_t)record->Length, diffStart, diffEnd);
-    if(found)
+    diffs.clear();
+
+    if(record->GetShadowWatch())
+    {
+      // only pages written since the last check can differ
+      WriteWatch::FindModifiedRanges(record->GetShadowWatch(), record->GetShadowPtr(0),
+                                     record->GetShadowPtr(1), (size_t)record->Length, diffs);
+    }
+    else
+    {
+      size_t diffStart = 0, diffEnd = 0;
+      if(FindDiffRange(record->GetShadowPtr(0), record->GetShadowPtr(1), (size_t)record->Length,
+                       diffStart, diffEnd))
+        diffs.push_back(std::make_pair(diffStart, diffEnd));
+    }
+
+    for(size_t d = 0; d < diffs.size(); d++)
     {
+      size_t diffStart = diffs[d].first;
+      size_t diffEnd = diffs[d].second;
+
       // update the modified region in the 'comparison' shadow buffer for next check
       memcpy(record->GetShadowPtr(1) + diffStart, record->GetShadowPtr(0) + diffStart,
              diffEnd - diffStart);
@@ -2541,6 +2696,8 @@ bool WrappedOpenGL::Serialise_glGenTransformFeedbacks(GLsizei n, GLuint *ids)
 
 void WrappedOpenGL::glGenTransformFeedbacks(GLsizei n, GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenTransformFeedbacks(n, ids);
 
   for(GLsizei i = 0; i < n; i++)
@@ -2591,6 +2748,8 @@ bool WrappedOpenGL::Serialise_glCreateTransformFeedbacks(GLsizei n, GLuint *ids)
 
 void WrappedOpenGL::glCreateTransformFeedbacks(GLsizei n, GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateTransformFeedbacks(n, ids);
 
   for(GLsizei i = 0; i < n; i++)
@@ -2623,6 +2782,8 @@ void WrappedOpenGL::glCreateTransformFeedbacks(GLsizei n, GLuint *ids)
 
 void WrappedOpenGL::glDeleteTransformFeedbacks(GLsizei n, const GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = FeedbackRes(GetCtx(), ids[i]);
@@ -2665,8 +2826,12 @@ bool WrappedOpenGL::Serialise_glTransformFeedbackBufferBase(GLuint xfb, GLuint i
 
 void WrappedOpenGL::glTransformFeedbackBufferBase(GLuint xfb, GLuint index, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTransformFeedbackBufferBase(xfb, index, buffer);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     SCOPED_SERIALISE_CONTEXT(FEEDBACK_BUFFER_BASE);
@@ -2724,8 +2889,12 @@ bool WrappedOpenGL::Serialise_glTransformFeedbackBufferRange(GLuint xfb, GLuint
 void WrappedOpenGL::glTransformFeedbackBufferRange(GLuint xfb, GLuint index, GLuint buffer,
                                                    GLintptr offset, GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTransformFeedbackBufferRange(xfb, index, buffer, offset, size);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     SCOPED_SERIALISE_CONTEXT(FEEDBACK_BUFFER_RANGE);
@@ -2768,8 +2937,12 @@ bool WrappedOpenGL::Serialise_glBindTransformFeedback(GLenum target, GLuint id)
 
 void WrappedOpenGL::glBindTransformFeedback(GLenum target, GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindTransformFeedback(target, id);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   GLResourceRecord *record = NULL;
 
   if(m_State >= WRITING)
@@ -2812,6 +2985,8 @@ bool WrappedOpenGL::Serialise_glBeginTransformFeedback(GLenum primitiveMode)
 
 void WrappedOpenGL::glBeginTransformFeedback(GLenum primitiveMode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBeginTransformFeedback(primitiveMode);
   m_ActiveFeedback = true;
 
@@ -2836,6 +3011,8 @@ bool WrappedOpenGL::Serialise_glPauseTransformFeedback()
 
 void WrappedOpenGL::glPauseTransformFeedback()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPauseTransformFeedback();
 
   if(m_State == WRITING_CAPFRAME)
@@ -2859,6 +3036,8 @@ bool WrappedOpenGL::Serialise_glResumeTransformFeedback()
 
 void WrappedOpenGL::glResumeTransformFeedback()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glResumeTransformFeedback();
 
   if(m_State == WRITING_CAPFRAME)
@@ -2883,6 +3062,8 @@ bool WrappedOpenGL::Serialise_glEndTransformFeedback()
 
 void WrappedOpenGL::glEndTransformFeedback()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEndTransformFeedback();
   m_ActiveFeedback = false;
 
@@ -2964,6 +3145,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribOffsetEXT(GLuint vaobj, GLuint buff
                                                        GLint size, GLenum type, GLboolean normalized,
                                                        GLsizei stride, GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribOffsetEXT(vaobj, buffer, index, size, type, normalized, stride,
                                             offset);
 
@@ -2998,6 +3181,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribOffsetEXT(GLuint vaobj, GLuint buff
 void WrappedOpenGL::glVertexAttribPointer(GLuint index, GLint size, GLenum type,
                                           GLboolean normalized, GLsizei stride, const void *pointer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribPointer(index, size, type, normalized, stride, pointer);
 
   if(m_State >= WRITING)
@@ -3074,6 +3259,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribIOffsetEXT(GLuint vaobj, GLuint buf
                                                         GLint size, GLenum type, GLsizei stride,
                                                         GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribIOffsetEXT(vaobj, buffer, index, size, type, stride, offset);
 
   if(m_State >= WRITING)
@@ -3107,6 +3294,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribIOffsetEXT(GLuint vaobj, GLuint buf
 void WrappedOpenGL::glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
                                            const void *pointer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribIPointer(index, size, type, stride, pointer);
 
   if(m_State >= WRITING)
@@ -3183,6 +3372,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribLOffsetEXT(GLuint vaobj, GLuint buf
                                                         GLint size, GLenum type, GLsizei stride,
                                                         GLintptr pointer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribLOffsetEXT(vaobj, buffer, index, size, type, stride, pointer);
 
   if(m_State >= WRITING)
@@ -3216,6 +3407,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribLOffsetEXT(GLuint vaobj, GLuint buf
 void WrappedOpenGL::glVertexAttribLPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
                                            const void *pointer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribLPointer(index, size, type, stride, pointer);
 
   if(m_State >= WRITING)
@@ -3267,6 +3460,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexAttribBindingEXT(GLuint vaobj,
 void WrappedOpenGL::glVertexArrayVertexAttribBindingEXT(GLuint vaobj, GLuint attribindex,
                                                         GLuint bindingindex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribBindingEXT(vaobj, attribindex, bindingindex);
 
   if(m_State >= WRITING)
@@ -3295,6 +3490,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribBindingEXT(GLuint vaobj, GLuint att
 
 void WrappedOpenGL::glVertexAttribBinding(GLuint attribindex, GLuint bindingindex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribBinding(attribindex, bindingindex);
 
   if(m_State >= WRITING)
@@ -3349,6 +3546,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribFormatEXT(GLuint vaobj, GLuint attr
                                                        GLenum type, GLboolean normalized,
                                                        GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribFormatEXT(vaobj, attribindex, size, type, normalized,
                                             relativeoffset);
 
@@ -3380,6 +3579,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribFormatEXT(GLuint vaobj, GLuint attr
 void WrappedOpenGL::glVertexAttribFormat(GLuint attribindex, GLint size, GLenum type,
                                          GLboolean normalized, GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribFormat(attribindex, size, type, normalized, relativeoffset);
 
   if(m_State >= WRITING)
@@ -3432,6 +3633,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexAttribIFormatEXT(GLuint vaobj,
 void WrappedOpenGL::glVertexArrayVertexAttribIFormatEXT(GLuint vaobj, GLuint attribindex, GLint size,
                                                         GLenum type, GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribIFormatEXT(vaobj, attribindex, size, type, relativeoffset);
 
   if(m_State >= WRITING)
@@ -3461,6 +3664,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribIFormatEXT(GLuint vaobj, GLuint att
 void WrappedOpenGL::glVertexAttribIFormat(GLuint attribindex, GLint size, GLenum type,
                                           GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribIFormat(attribindex, size, type, relativeoffset);
 
   if(m_State >= WRITING)
@@ -3512,6 +3717,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexAttribLFormatEXT(GLuint vaobj,
 void WrappedOpenGL::glVertexArrayVertexAttribLFormatEXT(GLuint vaobj, GLuint attribindex, GLint size,
                                                         GLenum type, GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribLFormatEXT(vaobj, attribindex, size, type, relativeoffset);
 
   if(m_State >= WRITING)
@@ -3541,6 +3748,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribLFormatEXT(GLuint vaobj, GLuint att
 void WrappedOpenGL::glVertexAttribLFormat(GLuint attribindex, GLint size, GLenum type,
                                           GLuint relativeoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribLFormat(attribindex, size, type, relativeoffset);
 
   if(m_State >= WRITING)
@@ -3600,6 +3809,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexAttribDivisorEXT(GLuint vaobj,
 
 void WrappedOpenGL::glVertexArrayVertexAttribDivisorEXT(GLuint vaobj, GLuint index, GLuint divisor)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexAttribDivisorEXT(vaobj, index, divisor);
 
   if(m_State >= WRITING)
@@ -3628,6 +3839,8 @@ void WrappedOpenGL::glVertexArrayVertexAttribDivisorEXT(GLuint vaobj, GLuint ind
 
 void WrappedOpenGL::glVertexAttribDivisor(GLuint index, GLuint divisor)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexAttribDivisor(index, divisor);
 
   if(m_State >= WRITING)
@@ -3683,6 +3896,8 @@ bool WrappedOpenGL::Serialise_glEnableVertexArrayAttribEXT(GLuint vaobj, GLuint
 
 void WrappedOpenGL::glEnableVertexArrayAttribEXT(GLuint vaobj, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEnableVertexArrayAttribEXT(vaobj, index);
 
   if(m_State >= WRITING)
@@ -3711,6 +3926,8 @@ void WrappedOpenGL::glEnableVertexArrayAttribEXT(GLuint vaobj, GLuint index)
 
 void WrappedOpenGL::glEnableVertexAttribArray(GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEnableVertexAttribArray(index);
 
   if(m_State >= WRITING)
@@ -3765,6 +3982,8 @@ bool WrappedOpenGL::Serialise_glDisableVertexArrayAttribEXT(GLuint vaobj, GLuint
 
 void WrappedOpenGL::glDisableVertexArrayAttribEXT(GLuint vaobj, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDisableVertexArrayAttribEXT(vaobj, index);
 
   if(m_State >= WRITING)
@@ -3793,6 +4012,8 @@ void WrappedOpenGL::glDisableVertexArrayAttribEXT(GLuint vaobj, GLuint index)
 
 void WrappedOpenGL::glDisableVertexAttribArray(GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDisableVertexAttribArray(index);
 
   if(m_State >= WRITING)
@@ -3840,6 +4061,8 @@ bool WrappedOpenGL::Serialise_glGenVertexArrays(GLsizei n, GLuint *arrays)
 
 void WrappedOpenGL::glGenVertexArrays(GLsizei n, GLuint *arrays)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenVertexArrays(n, arrays);
 
   for(GLsizei i = 0; i < n; i++)
@@ -3890,6 +4113,8 @@ bool WrappedOpenGL::Serialise_glCreateVertexArrays(GLsizei n, GLuint *arrays)
 
 void WrappedOpenGL::glCreateVertexArrays(GLsizei n, GLuint *arrays)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateVertexArrays(n, arrays);
 
   for(GLsizei i = 0; i < n; i++)
@@ -3944,6 +4169,8 @@ bool WrappedOpenGL::Serialise_glBindVertexArray(GLuint array)
 
 void WrappedOpenGL::glBindVertexArray(GLuint array)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindVertexArray(array);
 
   GLResourceRecord *record = NULL;
@@ -4012,6 +4239,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayElementBuffer(GLuint vaobj, GLuint bu
 
 void WrappedOpenGL::glVertexArrayElementBuffer(GLuint vaobj, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayElementBuffer(vaobj, buffer);
 
   if(m_State >= WRITING)
@@ -4075,6 +4304,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayBindVertexBufferEXT(GLuint vaobj, GLu
 void WrappedOpenGL::glVertexArrayBindVertexBufferEXT(GLuint vaobj, GLuint bindingindex,
                                                      GLuint buffer, GLintptr offset, GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayBindVertexBufferEXT(vaobj, bindingindex, buffer, offset, stride);
 
   if(m_State >= WRITING)
@@ -4108,6 +4339,8 @@ void WrappedOpenGL::glVertexArrayBindVertexBufferEXT(GLuint vaobj, GLuint bindin
 void WrappedOpenGL::glBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset,
                                        GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindVertexBuffer(bindingindex, buffer, offset, stride);
 
   if(m_State >= WRITING)
@@ -4212,6 +4445,8 @@ void WrappedOpenGL::glVertexArrayVertexBuffers(GLuint vaobj, GLuint first, GLsiz
                                                const GLuint *buffers, const GLintptr *offsets,
                                                const GLsizei *strides)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexBuffers(vaobj, first, count, buffers, offsets, strides);
 
   if(m_State >= WRITING)
@@ -4256,6 +4491,8 @@ void WrappedOpenGL::glVertexArrayVertexBuffers(GLuint vaobj, GLuint first, GLsiz
 void WrappedOpenGL::glBindVertexBuffers(GLuint first, GLsizei count, const GLuint *buffers,
                                         const GLintptr *offsets, const GLsizei *strides)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindVertexBuffers(first, count, buffers, offsets, strides);
 
   if(m_State >= WRITING)
@@ -4319,6 +4556,8 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexBindingDivisorEXT(GLuint vaobj,
 void WrappedOpenGL::glVertexArrayVertexBindingDivisorEXT(GLuint vaobj, GLuint bindingindex,
                                                          GLuint divisor)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexArrayVertexBindingDivisorEXT(vaobj, bindingindex, divisor);
 
   if(m_State >= WRITING)
@@ -4347,6 +4586,8 @@ void WrappedOpenGL::glVertexArrayVertexBindingDivisorEXT(GLuint vaobj, GLuint bi
 
 void WrappedOpenGL::glVertexBindingDivisor(GLuint bindingindex, GLuint divisor)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glVertexBindingDivisor(bindingindex, divisor);
 
   if(m_State >= WRITING)
@@ -4375,6 +4616,8 @@ void WrappedOpenGL::glVertexBindingDivisor(GLuint bindingindex, GLuint divisor)
 
 void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = BufferRes(GetCtx(), buffers[i]);
@@ -4383,6 +4626,10 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
       GLResourceRecord *record = GetResourceManager()->GetResourceRecord(res);
       if(record)
       {
+        // a pending update must be recorded while the buffer can still be identified
+        if(m_PendingBufferSubData.record == record)
+          FlushBufferSubData();
+
         // if we have a persistent pointer, make sure to unmap it
         if(record->Map.persistentPtr)
         {
@@ -4409,6 +4656,8 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
 
 void WrappedOpenGL::glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = VertexArrayRes(GetCtx(), arrays[i]);
@@ -4460,11 +4709,11 @@ bool WrappedOpenGL::Serialise_glVertexAttrib(GLuint index, int count, GLenum typ
 
   if(m_State >= WRITING)
   {
-    m_pSerialiser->RawWriteBytes(value, valueSize);
+    GetSerialiser()->RawWriteBytes(value, valueSize);
   }
   else if(m_State <= EXECUTING)
   {
-    value = m_pSerialiser->RawReadBytes(valueSize);
+    value = GetSerialiser()->RawReadBytes(valueSize);
 
     if(Type == Attrib_packed)
     {
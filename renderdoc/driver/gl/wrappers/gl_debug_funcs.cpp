@@ -80,7 +80,7 @@ bool WrappedOpenGL::Serialise_glObjectLabel(GLenum identifier, GLuint name, GLsi
   SERIALISE_ELEMENT(uint32_t, Length, length);
   SERIALISE_ELEMENT(bool, HasLabel, label != NULL);
 
-  m_pSerialiser->SerialiseString("label", Label);
+  GetSerialiser()->SerialiseInternedString("label", Label);
 
   if(m_State == READING && GetResourceManager()->HasLiveResource(id))
     GetResourceManager()->SetName(id, HasLabel ? Label : "");
@@ -91,6 +91,8 @@ bool WrappedOpenGL::Serialise_glObjectLabel(GLenum identifier, GLuint name, GLsi
 void WrappedOpenGL::glLabelObjectEXT(GLenum identifier, GLuint name, GLsizei length,
                                      const GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glLabelObjectEXT(identifier, name, length, label);
 
   if(m_State >= WRITING)
@@ -104,6 +106,8 @@ void WrappedOpenGL::glLabelObjectEXT(GLenum identifier, GLuint name, GLsizei len
 
 void WrappedOpenGL::glObjectLabel(GLenum identifier, GLuint name, GLsizei length, const GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glObjectLabel(identifier, name, length, label);
 
   if(m_State >= WRITING)
@@ -117,6 +121,8 @@ void WrappedOpenGL::glObjectLabel(GLenum identifier, GLuint name, GLsizei length
 
 void WrappedOpenGL::glObjectPtrLabel(const void *ptr, GLsizei length, const GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glObjectPtrLabel(ptr, length, label);
 
   if(m_State >= WRITING)
@@ -132,6 +138,8 @@ void WrappedOpenGL::glObjectPtrLabel(const void *ptr, GLsizei length, const GLch
 
 void WrappedOpenGL::glDebugMessageCallback(GLDEBUGPROC callback, const void *userParam)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_RealDebugFunc = callback;
   m_RealDebugFuncParam = userParam;
 
@@ -141,6 +149,8 @@ void WrappedOpenGL::glDebugMessageCallback(GLDEBUGPROC callback, const void *use
 void WrappedOpenGL::glDebugMessageControl(GLenum source, GLenum type, GLenum severity,
                                           GLsizei count, const GLuint *ids, GLboolean enabled)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // we could exert control over debug messages here
   m_Real.glDebugMessageControl(source, type, severity, count, ids, enabled);
 }
@@ -150,7 +160,7 @@ bool WrappedOpenGL::Serialise_glDebugMessageInsert(GLenum source, GLenum type, G
 {
   string name = buf ? string(buf, buf + (length > 0 ? length : strlen(buf))) : "";
 
-  m_pSerialiser->Serialise("Name", name);
+  GetSerialiser()->SerialiseInternedString("Name", name);
 
   if(m_State == READING)
   {
@@ -167,6 +177,8 @@ bool WrappedOpenGL::Serialise_glDebugMessageInsert(GLenum source, GLenum type, G
 void WrappedOpenGL::glDebugMessageInsert(GLenum source, GLenum type, GLuint id, GLenum severity,
                                          GLsizei length, const GLchar *buf)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME && type == eGL_DEBUG_TYPE_MARKER)
   {
     SCOPED_SERIALISE_CONTEXT(SET_MARKER);
@@ -180,6 +192,8 @@ void WrappedOpenGL::glDebugMessageInsert(GLenum source, GLenum type, GLuint id,
 
 void WrappedOpenGL::glPushGroupMarkerEXT(GLsizei length, const GLchar *marker)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(BEGIN_EVENT);
@@ -191,6 +205,8 @@ void WrappedOpenGL::glPushGroupMarkerEXT(GLsizei length, const GLchar *marker)
 
 void WrappedOpenGL::glPopGroupMarkerEXT()
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(END_EVENT);
@@ -202,6 +218,8 @@ void WrappedOpenGL::glPopGroupMarkerEXT()
 
 void WrappedOpenGL::glInsertEventMarkerEXT(GLsizei length, const GLchar *marker)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(SET_MARKER);
@@ -213,11 +231,15 @@ void WrappedOpenGL::glInsertEventMarkerEXT(GLsizei length, const GLchar *marker)
 
 void WrappedOpenGL::glFrameTerminatorGREMEDY()
 {
+  SCOPED_ENTRY_PROFILE();
+
   SwapBuffers(NULL);
 }
 
 void WrappedOpenGL::glStringMarkerGREMEDY(GLsizei len, const void *string)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(SET_MARKER);
@@ -232,7 +254,7 @@ bool WrappedOpenGL::Serialise_glPushDebugGroup(GLenum source, GLuint id, GLsizei
 {
   string name = message ? string(message, message + (length > 0 ? length : strlen(message))) : "";
 
-  m_pSerialiser->Serialise("Name", name);
+  GetSerialiser()->SerialiseInternedString("Name", name);
 
   if(m_State == READING)
   {
@@ -248,6 +270,8 @@ bool WrappedOpenGL::Serialise_glPushDebugGroup(GLenum source, GLuint id, GLsizei
 
 void WrappedOpenGL::glPushDebugGroup(GLenum source, GLuint id, GLsizei length, const GLchar *message)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(BEGIN_EVENT);
@@ -274,6 +298,8 @@ bool WrappedOpenGL::Serialise_glPopDebugGroup()
 }
 void WrappedOpenGL::glPopDebugGroup()
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(END_EVENT);
@@ -39,7 +39,7 @@ bool WrappedOpenGL::Serialise_glDispatchCompute(GLuint num_groups_x, GLuint num_
     m_Real.glDispatchCompute(X, Y, Z);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -78,10 +78,16 @@ bool WrappedOpenGL::Serialise_glDispatchCompute(GLuint num_groups_x, GLuint num_
 
 void WrappedOpenGL::glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH_COMPUTE);
@@ -89,14 +95,13 @@ void WrappedOpenGL::glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y,
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -116,7 +121,7 @@ bool WrappedOpenGL::Serialise_glDispatchComputeGroupSizeARB(GLuint num_groups_x,
     m_Real.glDispatchComputeGroupSizeARB(X, Y, Z, sX, sY, sZ);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -174,11 +179,17 @@ void WrappedOpenGL::glDispatchComputeGroupSizeARB(GLuint num_groups_x, GLuint nu
                                                   GLuint num_groups_z, GLuint group_size_x,
                                                   GLuint group_size_y, GLuint group_size_z)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDispatchComputeGroupSizeARB(num_groups_x, num_groups_y, num_groups_z, group_size_x,
                                        group_size_y, group_size_z);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH_COMPUTE_GROUP_SIZE);
@@ -187,14 +198,13 @@ void WrappedOpenGL::glDispatchComputeGroupSizeARB(GLuint num_groups_x, GLuint nu
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -207,7 +217,7 @@ bool WrappedOpenGL::Serialise_glDispatchComputeIndirect(GLintptr indirect)
     m_Real.glDispatchComputeIndirect((GLintptr)offs);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -243,10 +253,16 @@ bool WrappedOpenGL::Serialise_glDispatchComputeIndirect(GLintptr indirect)
 
 void WrappedOpenGL::glDispatchComputeIndirect(GLintptr indirect)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDispatchComputeIndirect(indirect);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DISPATCH_COMPUTE_INDIRECT);
@@ -254,14 +270,13 @@ void WrappedOpenGL::glDispatchComputeIndirect(GLintptr indirect)
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -327,6 +342,8 @@ bool WrappedOpenGL::Serialise_glMemoryBarrier(GLbitfield barriers)
 
 void WrappedOpenGL::glMemoryBarrier(GLbitfield barriers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(barriers & GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT)
   {
     // perform a forced flush of all persistent mapped buffers,
@@ -362,6 +379,8 @@ bool WrappedOpenGL::Serialise_glMemoryBarrierByRegion(GLbitfield barriers)
 
 void WrappedOpenGL::glMemoryBarrierByRegion(GLbitfield barriers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(barriers & GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT)
   {
     // perform a forced flush of all persistent mapped buffers,
@@ -392,6 +411,8 @@ bool WrappedOpenGL::Serialise_glTextureBarrier()
 
 void WrappedOpenGL::glTextureBarrier()
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glTextureBarrier();
@@ -416,7 +437,7 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedback(GLenum mode, GLuint id)
         Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -447,10 +468,16 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedback(GLenum mode, GLuint id)
 
 void WrappedOpenGL::glDrawTransformFeedback(GLenum mode, GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawTransformFeedback(mode, id);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_FEEDBACK);
@@ -458,14 +485,13 @@ void WrappedOpenGL::glDrawTransformFeedback(GLenum mode, GLuint id)
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -482,7 +508,7 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackInstanced(GLenum mode, GLui
         Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name, Count);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -513,10 +539,16 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackInstanced(GLenum mode, GLui
 
 void WrappedOpenGL::glDrawTransformFeedbackInstanced(GLenum mode, GLuint id, GLsizei instancecount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawTransformFeedbackInstanced(mode, id, instancecount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_FEEDBACK_INSTANCED);
@@ -524,14 +556,13 @@ void WrappedOpenGL::glDrawTransformFeedbackInstanced(GLenum mode, GLuint id, GLs
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -547,7 +578,7 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStream(GLenum mode, GLuint
         Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name, Stream);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -578,10 +609,16 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStream(GLenum mode, GLuint
 
 void WrappedOpenGL::glDrawTransformFeedbackStream(GLenum mode, GLuint id, GLuint stream)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawTransformFeedbackStream(mode, id, stream);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_FEEDBACK_STREAM);
@@ -589,14 +626,13 @@ void WrappedOpenGL::glDrawTransformFeedbackStream(GLenum mode, GLuint id, GLuint
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -616,7 +652,7 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStreamInstanced(GLenum mode
         Count);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -649,10 +685,16 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStreamInstanced(GLenum mode
 void WrappedOpenGL::glDrawTransformFeedbackStreamInstanced(GLenum mode, GLuint id, GLuint stream,
                                                            GLsizei instancecount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawTransformFeedbackStreamInstanced(mode, id, stream, instancecount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAW_FEEDBACK_STREAM_INSTANCED);
@@ -660,14 +702,13 @@ void WrappedOpenGL::glDrawTransformFeedbackStreamInstanced(GLenum mode, GLuint i
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -682,7 +723,7 @@ bool WrappedOpenGL::Serialise_glDrawArrays(GLenum mode, GLint first, GLsizei cou
     m_Real.glDrawArrays(Mode, First, Count);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -774,12 +815,18 @@ void WrappedOpenGL::RestoreClientMemoryArrays(ClientMemoryData *clientMemoryArra
 
 void WrappedOpenGL::glDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   ClientMemoryData *clientMemory = CopyClientMemoryArrays(first, count);
 
+  BeginEventTiming();
+
   m_Real.glDrawArrays(mode, first, count);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWARRAYS);
@@ -787,14 +834,13 @@ void WrappedOpenGL::glDrawArrays(GLenum mode, GLint first, GLsizei count)
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 
   RestoreClientMemoryArrays(clientMemory);
@@ -810,7 +856,7 @@ bool WrappedOpenGL::Serialise_glDrawArraysIndirect(GLenum mode, const void *indi
     m_Real.glDrawArraysIndirect(Mode, (const void *)Offset);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -848,10 +894,16 @@ bool WrappedOpenGL::Serialise_glDrawArraysIndirect(GLenum mode, const void *indi
 
 void WrappedOpenGL::glDrawArraysIndirect(GLenum mode, const void *indirect)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawArraysIndirect(mode, indirect);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWARRAYS_INDIRECT);
@@ -859,14 +911,13 @@ void WrappedOpenGL::glDrawArraysIndirect(GLenum mode, const void *indirect)
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -883,7 +934,7 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstanced(GLenum mode, GLint first, GL
     m_Real.glDrawArraysInstanced(Mode, First, Count, InstanceCount);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -914,12 +965,18 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstanced(GLenum mode, GLint first, GL
 void WrappedOpenGL::glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count,
                                           GLsizei instancecount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   ClientMemoryData *clientMemory = CopyClientMemoryArrays(first, count);
 
+  BeginEventTiming();
+
   m_Real.glDrawArraysInstanced(mode, first, count, instancecount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWARRAYS_INSTANCED);
@@ -927,14 +984,13 @@ void WrappedOpenGL::glDrawArraysInstanced(GLenum mode, GLint first, GLsizei coun
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 
   RestoreClientMemoryArrays(clientMemory);
@@ -955,7 +1011,7 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstancedBaseInstance(GLenum mode, GLi
     m_Real.glDrawArraysInstancedBaseInstance(Mode, First, Count, InstanceCount, BaseInstance);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -986,10 +1042,16 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstancedBaseInstance(GLenum mode, GLi
 void WrappedOpenGL::glDrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count,
                                                       GLsizei instancecount, GLuint baseinstance)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWARRAYS_INSTANCEDBASEINSTANCE);
@@ -997,14 +1059,13 @@ void WrappedOpenGL::glDrawArraysInstancedBaseInstance(GLenum mode, GLint first,
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1111,7 +1172,7 @@ bool WrappedOpenGL::Serialise_glDrawElements(GLenum mode, GLsizei count, GLenum
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1145,10 +1206,16 @@ bool WrappedOpenGL::Serialise_glDrawElements(GLenum mode, GLsizei count, GLenum
 
 void WrappedOpenGL::glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElements(mode, count, type, indices);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS);
@@ -1156,14 +1223,13 @@ void WrappedOpenGL::glDrawElements(GLenum mode, GLsizei count, GLenum type, cons
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1178,7 +1244,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsIndirect(GLenum mode, GLenum type, c
     m_Real.glDrawElementsIndirect(Mode, Type, (const void *)Offset);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1222,10 +1288,16 @@ bool WrappedOpenGL::Serialise_glDrawElementsIndirect(GLenum mode, GLenum type, c
 
 void WrappedOpenGL::glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsIndirect(mode, type, indirect);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_INDIRECT);
@@ -1233,14 +1305,13 @@ void WrappedOpenGL::glDrawElementsIndirect(GLenum mode, GLenum type, const void
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1264,7 +1335,7 @@ bool WrappedOpenGL::Serialise_glDrawRangeElements(GLenum mode, GLuint start, GLu
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1299,10 +1370,16 @@ bool WrappedOpenGL::Serialise_glDrawRangeElements(GLenum mode, GLuint start, GLu
 void WrappedOpenGL::glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count,
                                         GLenum type, const void *indices)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawRangeElements(mode, start, end, count, type, indices);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWRANGEELEMENTS);
@@ -1310,14 +1387,13 @@ void WrappedOpenGL::glDrawRangeElements(GLenum mode, GLuint start, GLuint end, G
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1344,7 +1420,7 @@ bool WrappedOpenGL::Serialise_glDrawRangeElementsBaseVertex(GLenum mode, GLuint
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1380,10 +1456,16 @@ void WrappedOpenGL::glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLu
                                                   GLsizei count, GLenum type, const void *indices,
                                                   GLint basevertex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawRangeElementsBaseVertex(mode, start, end, count, type, indices, basevertex);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWRANGEELEMENTSBASEVERTEX);
@@ -1391,14 +1473,13 @@ void WrappedOpenGL::glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLu
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1421,7 +1502,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsBaseVertex(GLenum mode, GLsizei coun
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1456,10 +1537,16 @@ bool WrappedOpenGL::Serialise_glDrawElementsBaseVertex(GLenum mode, GLsizei coun
 void WrappedOpenGL::glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
                                              const void *indices, GLint basevertex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsBaseVertex(mode, count, type, indices, basevertex);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_BASEVERTEX);
@@ -1467,14 +1554,13 @@ void WrappedOpenGL::glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1497,7 +1583,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstanced(GLenum mode, GLsizei count
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1532,10 +1618,16 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstanced(GLenum mode, GLsizei count
 void WrappedOpenGL::glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
                                             const void *indices, GLsizei instancecount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsInstanced(mode, count, type, indices, instancecount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_INSTANCED);
@@ -1543,14 +1635,13 @@ void WrappedOpenGL::glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum t
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1577,7 +1668,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseInstance(GLenum mode, G
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1613,10 +1704,16 @@ void WrappedOpenGL::glDrawElementsInstancedBaseInstance(GLenum mode, GLsizei cou
                                                         const void *indices, GLsizei instancecount,
                                                         GLuint baseinstance)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsInstancedBaseInstance(mode, count, type, indices, instancecount, baseinstance);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_INSTANCEDBASEINSTANCE);
@@ -1625,14 +1722,13 @@ void WrappedOpenGL::glDrawElementsInstancedBaseInstance(GLenum mode, GLsizei cou
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1659,7 +1755,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseVertex(GLenum mode, GLs
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1696,10 +1792,16 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count
                                                       const void *indices, GLsizei instancecount,
                                                       GLint basevertex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_INSTANCEDBASEVERTEX);
@@ -1708,14 +1810,13 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1742,7 +1843,7 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseVertexBaseInstance(
     Common_postElements(idxDelete);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1781,11 +1882,17 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, G
                                                                   GLint basevertex,
                                                                   GLuint baseinstance)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instancecount,
                                                        basevertex, baseinstance);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(DRAWELEMENTS_INSTANCEDBASEVERTEXBASEINSTANCE);
@@ -1794,14 +1901,13 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, G
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1860,7 +1966,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawArrays(GLenum mode, const GLint *first,
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1913,10 +2019,16 @@ bool WrappedOpenGL::Serialise_glMultiDrawArrays(GLenum mode, const GLint *first,
 void WrappedOpenGL::glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count,
                                       GLsizei drawcount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawArrays(mode, first, count, drawcount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWARRAYS);
@@ -1924,14 +2036,13 @@ void WrappedOpenGL::glMultiDrawArrays(GLenum mode, const GLint *first, const GLs
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -1952,7 +2063,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
     for(uint32_t i = 0; i < Count; i++)
     {
       uint64_t ptr = (uint64_t)indices[i];
-      m_pSerialiser->Serialise("idxOffsArray", ptr);
+      GetSerialiser()->Serialise("idxOffsArray", ptr);
     }
   }
   else
@@ -1960,7 +2071,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
     for(uint32_t i = 0; i < Count; i++)
     {
       uint64_t ptr = 0;
-      m_pSerialiser->Serialise("idxOffsArray", ptr);
+      GetSerialiser()->Serialise("idxOffsArray", ptr);
       idxOffsArray[i] = (void *)ptr;
     }
   }
@@ -2011,7 +2122,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2074,10 +2185,16 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
 void WrappedOpenGL::glMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type,
                                         const void *const *indices, GLsizei drawcount)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawElements(mode, count, type, indices, drawcount);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWELEMENTS);
@@ -2085,14 +2202,13 @@ void WrappedOpenGL::glMultiDrawElements(GLenum mode, const GLsizei *count, GLenu
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2116,7 +2232,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
     for(uint32_t i = 0; i < Count; i++)
     {
       uint64_t ptr = (uint64_t)indices[i];
-      m_pSerialiser->Serialise("idxOffsArray", ptr);
+      GetSerialiser()->Serialise("idxOffsArray", ptr);
     }
   }
   else
@@ -2124,7 +2240,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
     for(uint32_t i = 0; i < Count; i++)
     {
       uint64_t ptr = 0;
-      m_pSerialiser->Serialise("idxOffsArray", ptr);
+      GetSerialiser()->Serialise("idxOffsArray", ptr);
       idxOffsArray[i] = (void *)ptr;
     }
   }
@@ -2176,7 +2292,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2241,10 +2357,16 @@ void WrappedOpenGL::glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *co
                                                   const void *const *indices, GLsizei drawcount,
                                                   const GLint *basevertex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, basevertex);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWELEMENTSBASEVERTEX);
@@ -2252,14 +2374,13 @@ void WrappedOpenGL::glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *co
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2328,7 +2449,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirect(GLenum mode, const void
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2401,10 +2522,16 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirect(GLenum mode, const void
 void WrappedOpenGL::glMultiDrawArraysIndirect(GLenum mode, const void *indirect, GLsizei drawcount,
                                               GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawArraysIndirect(mode, indirect, drawcount, stride);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWARRAYS_INDIRECT);
@@ -2412,14 +2539,13 @@ void WrappedOpenGL::glMultiDrawArraysIndirect(GLenum mode, const void *indirect,
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2495,7 +2621,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirect(GLenum mode, GLenum ty
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2571,10 +2697,16 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirect(GLenum mode, GLenum ty
 void WrappedOpenGL::glMultiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect,
                                                 GLsizei drawcount, GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWELEMENTS_INDIRECT);
@@ -2582,14 +2714,13 @@ void WrappedOpenGL::glMultiDrawElementsIndirect(GLenum mode, GLenum type, const
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2671,7 +2802,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirectCountARB(GLenum mode, GLi
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2745,10 +2876,16 @@ void WrappedOpenGL::glMultiDrawArraysIndirectCountARB(GLenum mode, GLintptr indi
                                                       GLintptr drawcount, GLsizei maxdrawcount,
                                                       GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawArraysIndirectCountARB(mode, indirect, drawcount, maxdrawcount, stride);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWARRAYS_INDIRECT_COUNT);
@@ -2756,14 +2893,13 @@ void WrappedOpenGL::glMultiDrawArraysIndirectCountARB(GLenum mode, GLintptr indi
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2854,7 +2990,7 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirectCountARB(GLenum mode, G
     }
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -2931,10 +3067,16 @@ void WrappedOpenGL::glMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type
                                                         GLintptr drawcount, GLsizei maxdrawcount,
                                                         GLsizei stride)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
+  BeginEventTiming();
+
   m_Real.glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawcount, maxdrawcount, stride);
 
+  EndEventTiming();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(MULTI_DRAWELEMENTS_INDIRECT_COUNT);
@@ -2943,14 +3085,13 @@ void WrappedOpenGL::glMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
@@ -2979,7 +3120,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferfv(GLuint framebuffer, GLen
     if(value)
       v = *((Vec4f *)value);
 
-    m_pSerialiser->SerialisePODArray<4>("value", (float *)&v.x);
+    GetSerialiser()->SerialisePODArray<4>("value", (float *)&v.x);
 
     if(m_State == READING)
       name = "glClearBufferfv(" + ToStr::Get(buf) + ", " + ToStr::Get(drawbuf) + ", " +
@@ -3007,7 +3148,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferfv(GLuint framebuffer, GLen
       m_Real.glClearNamedFramebufferfv(framebuffer, buf, drawbuf, &val);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -3051,6 +3192,8 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferfv(GLuint framebuffer, GLen
 void WrappedOpenGL::glClearNamedFramebufferfv(GLuint framebuffer, GLenum buffer, GLint drawbuffer,
                                               const GLfloat *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedFramebufferfv(framebuffer, buffer, drawbuffer, value);
@@ -3062,19 +3205,20 @@ void WrappedOpenGL::glClearNamedFramebufferfv(GLuint framebuffer, GLenum buffer,
 
     m_ContextRecord->AddChunk(scope.Get());
 
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
+    GLRenderState state(&m_Real, GetSerialiser(), m_State);
     state.FetchState(GetCtx(), this);
     state.MarkReferenced(this, false);
   }
   else if(m_State == WRITING_IDLE)
   {
-    GLRenderState state(&m_Real, m_pSerialiser, m_State);
-    state.MarkDirty(this);
+    MarkDirtyOutputs();
   }
 }
 
 void WrappedOpenGL::glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferfv(buffer, drawbuffer, value);
@@ -3117,7 +3261,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferiv(GLuint framebuffer, GLen
     if(value)
       memcpy(v, value, sizeof(v));
 
-    m_pSerialiser->SerialisePODArray<4>("value", v);
+    GetSerialiser()->SerialisePODArray<4>("value", v);
 
     if(m_State == READING)
       name = "glClearBufferiv(" + ToStr::Get(buf) + ", " + ToStr::Get(drawbuf) + ", " +
@@ -3145,7 +3289,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferiv(GLuint framebuffer, GLen
       m_Real.glClearNamedFramebufferiv(framebuffer, buf, drawbuf, &val);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -3189,6 +3333,8 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferiv(GLuint framebuffer, GLen
 void WrappedOpenGL::glClearNamedFramebufferiv(GLuint framebuffer, GLenum buffer, GLint drawbuffer,
                                               const GLint *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedFramebufferiv(framebuffer, buffer, drawbuffer, value);
@@ -3204,6 +3350,8 @@ void WrappedOpenGL::glClearNamedFramebufferiv(GLuint framebuffer, GLenum buffer,
 
 void WrappedOpenGL::glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferiv(buffer, drawbuffer, value);
@@ -3245,7 +3393,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferuiv(GLuint framebuffer, GLe
     if(value)
       memcpy(v, value, sizeof(v));
 
-    m_pSerialiser->SerialisePODArray<4>("value", v);
+    GetSerialiser()->SerialisePODArray<4>("value", v);
 
     if(m_State == READING)
       name = "glClearBufferuiv(" + ToStr::Get(buf) + ", " + ToStr::Get(drawbuf) + ", " +
@@ -3262,7 +3410,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferuiv(GLuint framebuffer, GLe
       m_Real.glClearNamedFramebufferuiv(framebuffer, buf, drawbuf, v);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -3301,6 +3449,8 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferuiv(GLuint framebuffer, GLe
 void WrappedOpenGL::glClearNamedFramebufferuiv(GLuint framebuffer, GLenum buffer, GLint drawbuffer,
                                                const GLuint *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedFramebufferuiv(framebuffer, buffer, drawbuffer, value);
@@ -3316,6 +3466,8 @@ void WrappedOpenGL::glClearNamedFramebufferuiv(GLuint framebuffer, GLenum buffer
 
 void WrappedOpenGL::glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint *value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferuiv(buffer, drawbuffer, value);
@@ -3359,7 +3511,7 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferfi(GLuint framebuffer, GLen
   if(m_State <= EXECUTING)
     m_Real.glClearNamedFramebufferfi(framebuffer, buf, d, s);
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -3417,6 +3569,8 @@ bool WrappedOpenGL::Serialise_glClearNamedFramebufferfi(GLuint framebuffer, GLen
 void WrappedOpenGL::glClearNamedFramebufferfi(GLuint framebuffer, GLenum buffer, GLfloat depth,
                                               GLint stencil)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedFramebufferfi(framebuffer, buffer, depth, stencil);
@@ -3432,6 +3586,8 @@ void WrappedOpenGL::glClearNamedFramebufferfi(GLuint framebuffer, GLenum buffer,
 
 void WrappedOpenGL::glClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferfi(buffer, drawbuffer, depth, stencil);
@@ -3514,7 +3670,7 @@ bool WrappedOpenGL::Serialise_glClearNamedBufferDataEXT(GLuint buffer, GLenum in
     memcpy(val, data, s);
   }
 
-  m_pSerialiser->SerialisePODArray<4>("data", val);
+  GetSerialiser()->SerialisePODArray<4>("data", val);
 
   if(m_State <= EXECUTING)
   {
@@ -3528,6 +3684,8 @@ bool WrappedOpenGL::Serialise_glClearNamedBufferDataEXT(GLuint buffer, GLenum in
 void WrappedOpenGL::glClearNamedBufferDataEXT(GLuint buffer, GLenum internalformat, GLenum format,
                                               GLenum type, const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedBufferDataEXT(buffer, internalformat, format, type, data);
@@ -3548,6 +3706,8 @@ void WrappedOpenGL::glClearNamedBufferDataEXT(GLuint buffer, GLenum internalform
 void WrappedOpenGL::glClearBufferData(GLenum target, GLenum internalformat, GLenum format,
                                       GLenum type, const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferData(target, internalformat, format, type, data);
@@ -3644,7 +3804,7 @@ bool WrappedOpenGL::Serialise_glClearNamedBufferSubDataEXT(GLuint buffer, GLenum
     memcpy(val, data, s);
   }
 
-  m_pSerialiser->SerialisePODArray<4>("data", val);
+  GetSerialiser()->SerialisePODArray<4>("data", val);
 
   if(m_State <= EXECUTING)
   {
@@ -3660,6 +3820,8 @@ void WrappedOpenGL::glClearNamedBufferSubDataEXT(GLuint buffer, GLenum internalf
                                                  GLintptr offset, GLsizeiptr size, GLenum format,
                                                  GLenum type, const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearNamedBufferSubDataEXT(buffer, internalformat, offset, size, format, type, data);
@@ -3681,6 +3843,8 @@ void WrappedOpenGL::glClearNamedBufferSubData(GLuint buffer, GLenum internalform
                                               GLsizeiptr size, GLenum format, GLenum type,
                                               const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // only difference to EXT function is size parameter, so just upcast
   glClearNamedBufferSubDataEXT(buffer, internalformat, offset, size, format, type, data);
 }
@@ -3689,6 +3853,8 @@ void WrappedOpenGL::glClearBufferSubData(GLenum target, GLenum internalformat, G
                                          GLsizeiptr size, GLenum format, GLenum type,
                                          const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearBufferSubData(target, internalformat, offset, size, format, type, data);
@@ -3724,7 +3890,7 @@ bool WrappedOpenGL::Serialise_glClear(GLbitfield mask)
   if(m_State <= EXECUTING)
     m_Real.glClear(Mask);
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -3850,6 +4016,8 @@ bool WrappedOpenGL::Serialise_glClear(GLbitfield mask)
 
 void WrappedOpenGL::glClear(GLbitfield mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClear(mask);
@@ -3927,7 +4095,7 @@ bool WrappedOpenGL::Serialise_glClearTexImage(GLuint texture, GLint level, GLenu
     memcpy(val, data, s);
   }
 
-  m_pSerialiser->SerialisePODArray<4>("data", val);
+  GetSerialiser()->SerialisePODArray<4>("data", val);
 
   if(m_State <= EXECUTING)
   {
@@ -3941,6 +4109,8 @@ bool WrappedOpenGL::Serialise_glClearTexImage(GLuint texture, GLint level, GLenu
 void WrappedOpenGL::glClearTexImage(GLuint texture, GLint level, GLenum format, GLenum type,
                                     const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearTexImage(texture, level, format, type, data);
@@ -4031,7 +4201,7 @@ bool WrappedOpenGL::Serialise_glClearTexSubImage(GLuint texture, GLint level, GL
     memcpy(val, data, s);
   }
 
-  m_pSerialiser->SerialisePODArray<4>("data", val);
+  GetSerialiser()->SerialisePODArray<4>("data", val);
 
   if(m_State <= EXECUTING)
   {
@@ -4046,6 +4216,8 @@ void WrappedOpenGL::glClearTexSubImage(GLuint texture, GLint level, GLint xoffse
                                        GLint zoffset, GLsizei width, GLsizei height, GLsizei depth,
                                        GLenum format, GLenum type, const void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glClearTexSubImage(texture, level, xoffset, yoffset, zoffset, width, height, depth, format,
@@ -50,6 +50,8 @@ bool WrappedOpenGL::Serialise_glGenFramebuffers(GLsizei n, GLuint *framebuffers)
 
 void WrappedOpenGL::glGenFramebuffers(GLsizei n, GLuint *framebuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenFramebuffers(n, framebuffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -101,6 +103,8 @@ bool WrappedOpenGL::Serialise_glCreateFramebuffers(GLsizei n, GLuint *framebuffe
 
 void WrappedOpenGL::glCreateFramebuffers(GLsizei n, GLuint *framebuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateFramebuffers(n, framebuffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -168,8 +172,12 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTextureEXT(GLuint framebuffer, G
 void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum attachment,
                                                  GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferTextureEXT(framebuffer, attachment, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -215,8 +223,12 @@ void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum atta
 
 void WrappedOpenGL::glFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferTexture(target, attachment, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -313,8 +325,12 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTexture1DEXT(GLuint framebuffer,
 void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum attachment,
                                                    GLenum textarget, GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferTexture1DEXT(framebuffer, attachment, textarget, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -361,8 +377,12 @@ void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture1D(GLenum target, GLenum attachment, GLenum textarget,
                                            GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferTexture1D(target, attachment, textarget, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -460,8 +480,12 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTexture2DEXT(GLuint framebuffer,
 void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum attachment,
                                                    GLenum textarget, GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferTexture2DEXT(framebuffer, attachment, textarget, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -508,8 +532,12 @@ void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget,
                                            GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferTexture2D(target, attachment, textarget, texture, level);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -609,8 +637,12 @@ void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum at
                                                    GLenum textarget, GLuint texture, GLint level,
                                                    GLint zoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferTexture3DEXT(framebuffer, attachment, textarget, texture, level, zoffset);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -658,8 +690,12 @@ void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture3D(GLenum target, GLenum attachment, GLenum textarget,
                                            GLuint texture, GLint level, GLint zoffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferTexture3D(target, attachment, textarget, texture, level, zoffset);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -756,8 +792,12 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferRenderbufferEXT(GLuint framebuff
 void WrappedOpenGL::glNamedFramebufferRenderbufferEXT(GLuint framebuffer, GLenum attachment,
                                                       GLenum renderbuffertarget, GLuint renderbuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferRenderbufferEXT(framebuffer, attachment, renderbuffertarget, renderbuffer);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -795,8 +835,12 @@ void WrappedOpenGL::glNamedFramebufferRenderbufferEXT(GLuint framebuffer, GLenum
 void WrappedOpenGL::glFramebufferRenderbuffer(GLenum target, GLenum attachment,
                                               GLenum renderbuffertarget, GLuint renderbuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -884,8 +928,12 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTextureLayerEXT(GLuint framebuff
 void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum attachment,
                                                       GLuint texture, GLint level, GLint layer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferTextureLayerEXT(framebuffer, attachment, texture, level, layer);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record =
@@ -932,8 +980,12 @@ void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum
 void WrappedOpenGL::glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture,
                                               GLint level, GLint layer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferTextureLayer(target, attachment, texture, level, layer);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *record = m_DeviceRecord;
@@ -1015,6 +1067,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferParameteriEXT(GLuint framebuffer
 
 void WrappedOpenGL::glNamedFramebufferParameteriEXT(GLuint framebuffer, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedFramebufferParameteriEXT(framebuffer, pname, param);
 
   if(m_State >= WRITING)
@@ -1031,6 +1085,8 @@ void WrappedOpenGL::glNamedFramebufferParameteriEXT(GLuint framebuffer, GLenum p
 
 void WrappedOpenGL::glFramebufferParameteri(GLenum target, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferParameteri(target, pname, param);
 
   if(m_State >= WRITING)
@@ -1089,6 +1145,8 @@ bool WrappedOpenGL::Serialise_glFramebufferReadBufferEXT(GLuint framebuffer, GLe
 
 void WrappedOpenGL::glFramebufferReadBufferEXT(GLuint framebuffer, GLenum buf)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferReadBufferEXT(framebuffer, buf);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1113,6 +1171,8 @@ void WrappedOpenGL::glFramebufferReadBufferEXT(GLuint framebuffer, GLenum buf)
 
 void WrappedOpenGL::glReadBuffer(GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *readrecord = GetCtxData().m_ReadFramebufferRecord;
@@ -1160,6 +1220,8 @@ bool WrappedOpenGL::Serialise_glBindFramebuffer(GLenum target, GLuint framebuffe
 
 void WrappedOpenGL::glBindFramebuffer(GLenum target, GLuint framebuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(BIND_FRAMEBUFFER);
@@ -1174,11 +1236,16 @@ void WrappedOpenGL::glBindFramebuffer(GLenum target, GLuint framebuffer)
     framebuffer = m_FakeBB_FBO;
 
   if(target == eGL_DRAW_FRAMEBUFFER || target == eGL_FRAMEBUFFER)
+  {
     GetCtxData().m_DrawFramebufferRecord =
         GetResourceManager()->GetResourceRecord(FramebufferRes(GetCtx(), framebuffer));
+    GetCtxData().m_OutputBindingsChanged = true;
+  }
   else
+  {
     GetCtxData().m_ReadFramebufferRecord =
         GetResourceManager()->GetResourceRecord(FramebufferRes(GetCtx(), framebuffer));
+  }
 
   m_Real.glBindFramebuffer(target, framebuffer);
 }
@@ -1214,6 +1281,8 @@ bool WrappedOpenGL::Serialise_glFramebufferDrawBufferEXT(GLuint framebuffer, GLe
 
 void WrappedOpenGL::glFramebufferDrawBufferEXT(GLuint framebuffer, GLenum buf)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferDrawBufferEXT(framebuffer, buf);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1238,6 +1307,8 @@ void WrappedOpenGL::glFramebufferDrawBufferEXT(GLuint framebuffer, GLenum buf)
 
 void WrappedOpenGL::glDrawBuffer(GLenum buf)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *drawrecord = GetCtxData().m_DrawFramebufferRecord;
@@ -1289,6 +1360,8 @@ bool WrappedOpenGL::Serialise_glFramebufferDrawBuffersEXT(GLuint framebuffer, GL
 
 void WrappedOpenGL::glFramebufferDrawBuffersEXT(GLuint framebuffer, GLsizei n, const GLenum *bufs)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFramebufferDrawBuffersEXT(framebuffer, n, bufs);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1313,6 +1386,8 @@ void WrappedOpenGL::glFramebufferDrawBuffersEXT(GLuint framebuffer, GLsizei n, c
 
 void WrappedOpenGL::glDrawBuffers(GLsizei n, const GLenum *bufs)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     GLResourceRecord *drawrecord = GetCtxData().m_DrawFramebufferRecord;
@@ -1341,6 +1416,8 @@ void WrappedOpenGL::glDrawBuffers(GLsizei n, const GLenum *bufs)
 void WrappedOpenGL::glInvalidateFramebuffer(GLenum target, GLsizei numAttachments,
                                             const GLenum *attachments)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateFramebuffer(target, numAttachments, attachments);
 
   if(m_State == WRITING_IDLE)
@@ -1368,6 +1445,8 @@ void WrappedOpenGL::glInvalidateFramebuffer(GLenum target, GLsizei numAttachment
 void WrappedOpenGL::glInvalidateNamedFramebufferData(GLuint framebuffer, GLsizei numAttachments,
                                                      const GLenum *attachments)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateNamedFramebufferData(framebuffer, numAttachments, attachments);
 
   if(m_State == WRITING_IDLE)
@@ -1384,6 +1463,8 @@ void WrappedOpenGL::glInvalidateSubFramebuffer(GLenum target, GLsizei numAttachm
                                                const GLenum *attachments, GLint x, GLint y,
                                                GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateSubFramebuffer(target, numAttachments, attachments, x, y, width, height);
 
   if(m_State == WRITING_IDLE)
@@ -1412,6 +1493,8 @@ void WrappedOpenGL::glInvalidateNamedFramebufferSubData(GLuint framebuffer, GLsi
                                                         const GLenum *attachments, GLint x, GLint y,
                                                         GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateNamedFramebufferSubData(framebuffer, numAttachments, attachments, x, y, width,
                                              height);
 
@@ -1472,7 +1555,7 @@ bool WrappedOpenGL::Serialise_glBlitNamedFramebuffer(GLuint readFramebuffer, GLu
                                   dX1, dY1, msk, flt);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -1574,6 +1657,8 @@ void WrappedOpenGL::glBlitNamedFramebuffer(GLuint readFramebuffer, GLuint drawFr
                                            GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
                                            GLbitfield mask, GLenum filter)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   if(m_State == WRITING_CAPFRAME)
@@ -1602,6 +1687,8 @@ void WrappedOpenGL::glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLi
                                       GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
                                       GLbitfield mask, GLenum filter)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   if(m_State == WRITING_CAPFRAME)
@@ -1629,6 +1716,8 @@ void WrappedOpenGL::glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLi
 
 void WrappedOpenGL::glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = FramebufferRes(GetCtx(), framebuffers[i]);
@@ -1669,6 +1758,8 @@ bool WrappedOpenGL::Serialise_glGenRenderbuffers(GLsizei n, GLuint *renderbuffer
 
 void WrappedOpenGL::glGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenRenderbuffers(n, renderbuffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -1724,6 +1815,8 @@ bool WrappedOpenGL::Serialise_glCreateRenderbuffers(GLsizei n, GLuint *renderbuf
 
 void WrappedOpenGL::glCreateRenderbuffers(GLsizei n, GLuint *renderbuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateRenderbuffers(n, renderbuffers);
 
   for(GLsizei i = 0; i < n; i++)
@@ -1756,6 +1849,8 @@ void WrappedOpenGL::glCreateRenderbuffers(GLsizei n, GLuint *renderbuffers)
 
 void WrappedOpenGL::glBindRenderbuffer(GLenum target, GLuint renderbuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // don't need to serialise this, as the GL_RENDERBUFFER target does nothing
   // aside from create names (after glGen), and provide as a selector for glRenderbufferStorage*
   // which we do ourselves. We just need to know the current renderbuffer ID
@@ -1766,6 +1861,8 @@ void WrappedOpenGL::glBindRenderbuffer(GLenum target, GLuint renderbuffer)
 
 void WrappedOpenGL::glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = RenderbufferRes(GetCtx(), renderbuffers[i]);
@@ -1843,6 +1940,8 @@ bool WrappedOpenGL::Serialise_glNamedRenderbufferStorageEXT(GLuint renderbuffer,
 void WrappedOpenGL::glNamedRenderbufferStorageEXT(GLuint renderbuffer, GLenum internalformat,
                                                   GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   internalformat = GetSizedFormat(m_Real, eGL_RENDERBUFFER, internalformat);
 
   m_Real.glNamedRenderbufferStorageEXT(renderbuffer, internalformat, width, height);
@@ -1878,6 +1977,8 @@ void WrappedOpenGL::glNamedRenderbufferStorageEXT(GLuint renderbuffer, GLenum in
 void WrappedOpenGL::glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width,
                                           GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   internalformat = GetSizedFormat(m_Real, eGL_RENDERBUFFER, internalformat);
 
   m_Real.glRenderbufferStorage(target, internalformat, width, height);
@@ -1973,6 +2074,8 @@ void WrappedOpenGL::glNamedRenderbufferStorageMultisampleEXT(GLuint renderbuffer
                                                              GLenum internalformat, GLsizei width,
                                                              GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   internalformat = GetSizedFormat(m_Real, eGL_RENDERBUFFER, internalformat);
 
   m_Real.glNamedRenderbufferStorageMultisampleEXT(renderbuffer, samples, internalformat, width,
@@ -2011,6 +2114,8 @@ void WrappedOpenGL::glRenderbufferStorageMultisample(GLenum target, GLsizei samp
                                                      GLenum internalformat, GLsizei width,
                                                      GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   internalformat = GetSizedFormat(m_Real, eGL_RENDERBUFFER, internalformat);
 
   m_Real.glRenderbufferStorageMultisample(target, samples, internalformat, width, height);
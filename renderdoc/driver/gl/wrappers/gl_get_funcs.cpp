@@ -29,11 +29,15 @@
 
 GLenum WrappedOpenGL::glGetError()
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetError();
 }
 
 GLenum WrappedOpenGL::glGetGraphicsResetStatus()
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetGraphicsResetStatus();
 }
 
@@ -41,12 +45,16 @@ GLuint WrappedOpenGL::glGetDebugMessageLog(GLuint count, GLsizei bufSize, GLenum
                                            GLenum *types, GLuint *ids, GLenum *severities,
                                            GLsizei *lengths, GLchar *messageLog)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetDebugMessageLog(count, bufSize, sources, types, ids, severities, lengths,
                                      messageLog);
 }
 
 void WrappedOpenGL::glFlush()
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glFlush();
@@ -54,6 +62,8 @@ void WrappedOpenGL::glFlush()
 
 void WrappedOpenGL::glFinish()
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glFinish();
@@ -61,6 +71,8 @@ void WrappedOpenGL::glFinish()
 
 GLboolean WrappedOpenGL::glIsEnabled(GLenum cap)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(cap == eGL_DEBUG_TOOL_EXT)
     return true;
 
@@ -69,11 +81,15 @@ GLboolean WrappedOpenGL::glIsEnabled(GLenum cap)
 
 GLboolean WrappedOpenGL::glIsTexture(GLuint texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsTexture(texture);
 }
 
 GLboolean WrappedOpenGL::glIsEnabledi(GLenum target, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(target == eGL_DEBUG_TOOL_EXT)
     return true;
 
@@ -82,76 +98,106 @@ GLboolean WrappedOpenGL::glIsEnabledi(GLenum target, GLuint index)
 
 GLboolean WrappedOpenGL::glIsBuffer(GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsBuffer(buffer);
 }
 
 GLboolean WrappedOpenGL::glIsFramebuffer(GLuint framebuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsFramebuffer(framebuffer);
 }
 
 GLboolean WrappedOpenGL::glIsProgram(GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsProgram(program);
 }
 
 GLboolean WrappedOpenGL::glIsProgramPipeline(GLuint pipeline)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsProgramPipeline(pipeline);
 }
 
 GLboolean WrappedOpenGL::glIsQuery(GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsQuery(id);
 }
 
 GLboolean WrappedOpenGL::glIsRenderbuffer(GLuint renderbuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsRenderbuffer(renderbuffer);
 }
 
 GLboolean WrappedOpenGL::glIsSampler(GLuint sampler)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsSampler(sampler);
 }
 
 GLboolean WrappedOpenGL::glIsShader(GLuint shader)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsShader(shader);
 }
 
 GLboolean WrappedOpenGL::glIsSync(GLsync sync)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsSync(sync);
 }
 
 GLboolean WrappedOpenGL::glIsTransformFeedback(GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsTransformFeedback(id);
 }
 
 GLboolean WrappedOpenGL::glIsVertexArray(GLuint array)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsVertexArray(array);
 }
 
 GLboolean WrappedOpenGL::glIsNamedStringARB(GLint namelen, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glIsNamedStringARB(namelen, name);
 }
 
 void WrappedOpenGL::glGetFloatv(GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetFloatv(pname, params);
 }
 
 void WrappedOpenGL::glGetDoublev(GLenum pname, GLdouble *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetDoublev(pname, params);
 }
 
 void WrappedOpenGL::glGetPointerv(GLenum pname, void **params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_DEBUG_CALLBACK_FUNCTION)
     *params = (void *)m_RealDebugFunc;
   else if(pname == eGL_DEBUG_CALLBACK_USER_PARAM)
@@ -162,6 +208,8 @@ void WrappedOpenGL::glGetPointerv(GLenum pname, void **params)
 
 void WrappedOpenGL::glGetIntegerv(GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_MIN_MAP_BUFFER_ALIGNMENT)
   {
     if(params)
@@ -186,11 +234,15 @@ void WrappedOpenGL::glGetIntegerv(GLenum pname, GLint *params)
 
 void WrappedOpenGL::glGetBooleanv(GLenum pname, GLboolean *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetBooleanv(pname, data);
 }
 
 void WrappedOpenGL::glGetInteger64v(GLenum pname, GLint64 *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_MIN_MAP_BUFFER_ALIGNMENT)
   {
     if(data)
@@ -208,11 +260,15 @@ void WrappedOpenGL::glGetInteger64v(GLenum pname, GLint64 *data)
 
 void WrappedOpenGL::glGetBooleani_v(GLenum pname, GLuint index, GLboolean *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetBooleani_v(pname, index, data);
 }
 
 void WrappedOpenGL::glGetIntegeri_v(GLenum pname, GLuint index, GLint *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_MIN_MAP_BUFFER_ALIGNMENT)
   {
     if(data)
@@ -230,16 +286,22 @@ void WrappedOpenGL::glGetIntegeri_v(GLenum pname, GLuint index, GLint *data)
 
 void WrappedOpenGL::glGetFloati_v(GLenum pname, GLuint index, GLfloat *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetFloati_v(pname, index, data);
 }
 
 void WrappedOpenGL::glGetDoublei_v(GLenum pname, GLuint index, GLdouble *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetDoublei_v(pname, index, data);
 }
 
 void WrappedOpenGL::glGetInteger64i_v(GLenum pname, GLuint index, GLint64 *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_MIN_MAP_BUFFER_ALIGNMENT)
   {
     if(data)
@@ -257,68 +319,94 @@ void WrappedOpenGL::glGetInteger64i_v(GLenum pname, GLuint index, GLint64 *data)
 
 void WrappedOpenGL::glGetTexLevelParameteriv(GLenum target, GLint level, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexLevelParameteriv(target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetTexLevelParameterfv(GLenum target, GLint level, GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexLevelParameterfv(target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetTexParameterfv(GLenum target, GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexParameterfv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetTexParameteriv(GLenum target, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexParameteriv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureLevelParameterfv(GLuint texture, GLint level, GLenum pname,
                                                  GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureLevelParameterfv(texture, level, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureLevelParameteriv(GLuint texture, GLint level, GLenum pname,
                                                  GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureLevelParameteriv(texture, level, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterIiv(GLuint texture, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterIiv(texture, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterIuiv(GLuint texture, GLenum pname, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterIuiv(texture, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterfv(GLuint texture, GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterfv(texture, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameteriv(GLuint texture, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameteriv(texture, pname, params);
 }
 
 void WrappedOpenGL::glGetTexParameterIiv(GLenum target, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexParameterIiv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetTexParameterIuiv(GLenum target, GLenum pname, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTexParameterIuiv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetTexImage(GLenum target, GLint level, GLenum format, GLenum type, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetTexImage(target, level, format, type, pixels);
@@ -326,6 +414,8 @@ void WrappedOpenGL::glGetTexImage(GLenum target, GLint level, GLenum format, GLe
 
 void WrappedOpenGL::glGetCompressedTexImage(GLenum target, GLint level, void *img)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetCompressedTexImage(target, level, img);
@@ -333,6 +423,8 @@ void WrappedOpenGL::glGetCompressedTexImage(GLenum target, GLint level, void *im
 
 void WrappedOpenGL::glGetnCompressedTexImage(GLenum target, GLint lod, GLsizei bufSize, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetnCompressedTexImage(target, lod, bufSize, pixels);
@@ -341,6 +433,8 @@ void WrappedOpenGL::glGetnCompressedTexImage(GLenum target, GLint lod, GLsizei b
 void WrappedOpenGL::glGetCompressedTextureImage(GLuint texture, GLint level, GLsizei bufSize,
                                                 void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetCompressedTextureImage(texture, level, bufSize, pixels);
@@ -351,6 +445,8 @@ void WrappedOpenGL::glGetCompressedTextureSubImage(GLuint texture, GLint level,
                                                    GLsizei height, GLsizei depth, GLsizei bufSize,
                                                    void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetCompressedTextureSubImage(texture, level, xoffset, yoffset, zoffset, width, height,
@@ -360,6 +456,8 @@ void WrappedOpenGL::glGetCompressedTextureSubImage(GLuint texture, GLint level,
 void WrappedOpenGL::glGetnTexImage(GLenum target, GLint level, GLenum format, GLenum type,
                                    GLsizei bufSize, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetnTexImage(target, level, format, type, bufSize, pixels);
@@ -368,6 +466,8 @@ void WrappedOpenGL::glGetnTexImage(GLenum target, GLint level, GLenum format, GL
 void WrappedOpenGL::glGetTextureImage(GLuint texture, GLint level, GLenum format, GLenum type,
                                       GLsizei bufSize, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetTextureImage(texture, level, format, type, bufSize, pixels);
@@ -377,6 +477,8 @@ void WrappedOpenGL::glGetTextureSubImage(GLuint texture, GLint level, GLint xoff
                                          GLint zoffset, GLsizei width, GLsizei height, GLsizei depth,
                                          GLenum format, GLenum type, GLsizei bufSize, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetTextureSubImage(texture, level, xoffset, yoffset, zoffset, width, height, depth,
@@ -386,47 +488,65 @@ void WrappedOpenGL::glGetTextureSubImage(GLuint texture, GLint level, GLint xoff
 void WrappedOpenGL::glGetInternalformativ(GLenum target, GLenum internalformat, GLenum pname,
                                           GLsizei bufSize, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetInternalformativ(target, internalformat, pname, bufSize, params);
 }
 
 void WrappedOpenGL::glGetInternalformati64v(GLenum target, GLenum internalformat, GLenum pname,
                                             GLsizei bufSize, GLint64 *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetInternalformati64v(target, internalformat, pname, bufSize, params);
 }
 
 void WrappedOpenGL::glGetSamplerParameterIiv(GLuint sampler, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetSamplerParameterIiv(sampler, pname, params);
 }
 
 void WrappedOpenGL::glGetSamplerParameterIuiv(GLuint sampler, GLenum pname, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetSamplerParameterIuiv(sampler, pname, params);
 }
 
 void WrappedOpenGL::glGetSamplerParameterfv(GLuint sampler, GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetSamplerParameterfv(sampler, pname, params);
 }
 
 void WrappedOpenGL::glGetSamplerParameteriv(GLuint sampler, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetSamplerParameteriv(sampler, pname, params);
 }
 
 void WrappedOpenGL::glGetBufferParameteri64v(GLenum target, GLenum pname, GLint64 *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetBufferParameteri64v(target, pname, params);
 }
 
 void WrappedOpenGL::glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetBufferParameteriv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetBufferPointerv(GLenum target, GLenum pname, void **params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   // intercept GL_BUFFER_MAP_POINTER queries
@@ -456,6 +576,8 @@ void WrappedOpenGL::glGetBufferPointerv(GLenum target, GLenum pname, void **para
 
 void WrappedOpenGL::glGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetBufferSubData(target, offset, size, data);
@@ -463,58 +585,80 @@ void WrappedOpenGL::glGetBufferSubData(GLenum target, GLintptr offset, GLsizeipt
 
 void WrappedOpenGL::glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryObjectuiv(id, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryObjectui64v(id, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryIndexediv(GLenum target, GLuint index, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryIndexediv(target, index, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryObjecti64v(GLuint id, GLenum pname, GLint64 *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryObjecti64v(id, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryObjectiv(GLuint id, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryObjectiv(id, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryiv(GLenum target, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryiv(target, pname, params);
 }
 
 void WrappedOpenGL::glGetQueryBufferObjectui64v(GLuint id, GLuint buffer, GLenum pname,
                                                 GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryBufferObjectui64v(id, buffer, pname, offset);
 }
 
 void WrappedOpenGL::glGetQueryBufferObjectuiv(GLuint id, GLuint buffer, GLenum pname, GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryBufferObjectuiv(id, buffer, pname, offset);
 }
 
 void WrappedOpenGL::glGetQueryBufferObjecti64v(GLuint id, GLuint buffer, GLenum pname, GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryBufferObjecti64v(id, buffer, pname, offset);
 }
 
 void WrappedOpenGL::glGetQueryBufferObjectiv(GLuint id, GLuint buffer, GLenum pname, GLintptr offset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetQueryBufferObjectiv(id, buffer, pname, offset);
 }
 
 void WrappedOpenGL::glGetSynciv(GLsync sync, GLenum pname, GLsizei bufSize, GLsizei *length,
                                 GLint *values)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetSynciv(sync, pname, bufSize, length, values);
@@ -522,6 +666,8 @@ void WrappedOpenGL::glGetSynciv(GLsync sync, GLenum pname, GLsizei bufSize, GLsi
 
 const GLubyte *WrappedOpenGL::glGetString(GLenum name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(name == eGL_EXTENSIONS)
   {
     return (const GLubyte *)GetCtxData().glExtsString.c_str();
@@ -535,6 +681,8 @@ const GLubyte *WrappedOpenGL::glGetString(GLenum name)
 
 const GLubyte *WrappedOpenGL::glGetStringi(GLenum name, GLuint i)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(name == eGL_EXTENSIONS)
   {
     if((size_t)i < GetCtxData().glExts.size())
@@ -552,127 +700,173 @@ const GLubyte *WrappedOpenGL::glGetStringi(GLenum name, GLuint i)
 void WrappedOpenGL::glGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment,
                                                           GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetFramebufferAttachmentParameteriv(target, attachment, pname, params);
 }
 
 GLenum WrappedOpenGL::glCheckFramebufferStatus(GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glCheckFramebufferStatus(target);
 }
 
 void WrappedOpenGL::glGetVertexAttribiv(GLuint index, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribiv(index, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexAttribPointerv(GLuint index, GLenum pname, void **pointer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribPointerv(index, pname, pointer);
 }
 
 GLint WrappedOpenGL::glGetFragDataIndex(GLuint program, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetFragDataIndex(program, name);
 }
 
 GLint WrappedOpenGL::glGetFragDataLocation(GLuint program, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetFragDataLocation(program, name);
 }
 
 void WrappedOpenGL::glGetMultisamplefv(GLenum pname, GLuint index, GLfloat *val)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultisamplefv(pname, index, val);
 }
 
 void WrappedOpenGL::glGetObjectLabel(GLenum identifier, GLuint name, GLsizei bufSize,
                                      GLsizei *length, GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetObjectLabel(identifier, name, bufSize, length, label);
 }
 
 void WrappedOpenGL::glGetObjectLabelEXT(GLenum identifier, GLuint name, GLsizei bufSize,
                                         GLsizei *length, GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetObjectLabelEXT(identifier, name, bufSize, length, label);
 }
 
 void WrappedOpenGL::glGetObjectPtrLabel(const void *ptr, GLsizei bufSize, GLsizei *length,
                                         GLchar *label)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetObjectPtrLabel(ptr, bufSize, length, label);
 }
 
 void WrappedOpenGL::glGetShaderiv(GLuint shader, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetShaderiv(shader, pname, params);
 }
 
 void WrappedOpenGL::glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length,
                                        GLchar *infoLog)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetShaderInfoLog(shader, bufSize, length, infoLog);
 }
 
 void WrappedOpenGL::glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype,
                                                GLint *range, GLint *precision)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetShaderPrecisionFormat(shadertype, precisiontype, range, precision);
 }
 
 void WrappedOpenGL::glGetShaderSource(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *source)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetShaderSource(shader, bufSize, length, source);
 }
 
 void WrappedOpenGL::glGetAttachedShaders(GLuint program, GLsizei maxCount, GLsizei *count,
                                          GLuint *shaders)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetAttachedShaders(program, maxCount, count, shaders);
 }
 
 void WrappedOpenGL::glGetProgramiv(GLuint program, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramiv(program, pname, params);
 }
 
 void WrappedOpenGL::glGetProgramStageiv(GLuint program, GLenum shadertype, GLenum pname, GLint *values)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramStageiv(program, shadertype, pname, values);
 }
 
 void WrappedOpenGL::glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length,
                                        GLenum *binaryFormat, void *binary)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramBinary(program, bufSize, length, binaryFormat, binary);
 }
 
 void WrappedOpenGL::glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length,
                                         GLchar *infoLog)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramInfoLog(program, bufSize, length, infoLog);
 }
 
 void WrappedOpenGL::glGetProgramPipelineiv(GLuint pipeline, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramPipelineiv(pipeline, pname, params);
 }
 
 void WrappedOpenGL::glGetProgramPipelineInfoLog(GLuint pipeline, GLsizei bufSize, GLsizei *length,
                                                 GLchar *infoLog)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramPipelineInfoLog(pipeline, bufSize, length, infoLog);
 }
 
 void WrappedOpenGL::glGetProgramInterfaceiv(GLuint program, GLenum programInterface, GLenum pname,
                                             GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramInterfaceiv(program, programInterface, pname, params);
 }
 
 GLuint WrappedOpenGL::glGetProgramResourceIndex(GLuint program, GLenum programInterface,
                                                 const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetProgramResourceIndex(program, programInterface, name);
 }
 
@@ -680,6 +874,8 @@ void WrappedOpenGL::glGetProgramResourceiv(GLuint program, GLenum programInterfa
                                            GLsizei propCount, const GLenum *props, GLsizei bufSize,
                                            GLsizei *length, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramResourceiv(program, programInterface, index, propCount, props, bufSize, length,
                                 params);
 }
@@ -687,109 +883,147 @@ void WrappedOpenGL::glGetProgramResourceiv(GLuint program, GLenum programInterfa
 void WrappedOpenGL::glGetProgramResourceName(GLuint program, GLenum programInterface, GLuint index,
                                              GLsizei bufSize, GLsizei *length, GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetProgramResourceName(program, programInterface, index, bufSize, length, name);
 }
 
 GLint WrappedOpenGL::glGetProgramResourceLocation(GLuint program, GLenum programInterface,
                                                   const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetProgramResourceLocation(program, programInterface, name);
 }
 
 GLint WrappedOpenGL::glGetProgramResourceLocationIndex(GLuint program, GLenum programInterface,
                                                        const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetProgramResourceLocationIndex(program, programInterface, name);
 }
 
 void WrappedOpenGL::glGetNamedStringARB(GLint namelen, const GLchar *name, GLsizei bufSize,
                                         GLint *stringlen, GLchar *string)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetNamedStringARB(namelen, name, bufSize, stringlen, string);
 }
 
 void WrappedOpenGL::glGetNamedStringivARB(GLint namelen, const GLchar *name, GLenum pname,
                                           GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetNamedStringivARB(namelen, name, pname, params);
 }
 
 GLint WrappedOpenGL::glGetUniformLocation(GLuint program, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetUniformLocation(program, name);
 }
 
 void WrappedOpenGL::glGetUniformIndices(GLuint program, GLsizei uniformCount,
                                         const GLchar *const *uniformNames, GLuint *uniformIndices)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformIndices(program, uniformCount, uniformNames, uniformIndices);
 }
 
 GLuint WrappedOpenGL::glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetUniformBlockIndex(program, uniformBlockName);
 }
 
 GLint WrappedOpenGL::glGetAttribLocation(GLuint program, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetAttribLocation(program, name);
 }
 
 GLuint WrappedOpenGL::glGetSubroutineIndex(GLuint program, GLenum shadertype, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetSubroutineIndex(program, shadertype, name);
 }
 
 GLint WrappedOpenGL::glGetSubroutineUniformLocation(GLuint program, GLenum shadertype,
                                                     const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glGetSubroutineUniformLocation(program, shadertype, name);
 }
 
 void WrappedOpenGL::glGetUniformSubroutineuiv(GLenum shadertype, GLint location, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformSubroutineuiv(shadertype, location, params);
 }
 
 void WrappedOpenGL::glGetActiveSubroutineName(GLuint program, GLenum shadertype, GLuint index,
                                               GLsizei bufsize, GLsizei *length, GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveSubroutineName(program, shadertype, index, bufsize, length, name);
 }
 
 void WrappedOpenGL::glGetActiveSubroutineUniformName(GLuint program, GLenum shadertype, GLuint index,
                                                      GLsizei bufsize, GLsizei *length, GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveSubroutineUniformName(program, shadertype, index, bufsize, length, name);
 }
 
 void WrappedOpenGL::glGetActiveSubroutineUniformiv(GLuint program, GLenum shadertype, GLuint index,
                                                    GLenum pname, GLint *values)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveSubroutineUniformiv(program, shadertype, index, pname, values);
 }
 
 void WrappedOpenGL::glGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize,
                                        GLsizei *length, GLint *size, GLenum *type, GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveUniform(program, index, bufSize, length, size, type, name);
 }
 
 void WrappedOpenGL::glGetActiveUniformsiv(GLuint program, GLsizei uniformCount,
                                           const GLuint *uniformIndices, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveUniformsiv(program, uniformCount, uniformIndices, pname, params);
 }
 
 void WrappedOpenGL::glGetActiveUniformName(GLuint program, GLuint uniformIndex, GLsizei bufSize,
                                            GLsizei *length, GLchar *uniformName)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveUniformName(program, uniformIndex, bufSize, length, uniformName);
 }
 
 void WrappedOpenGL::glGetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex,
                                               GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveUniformBlockiv(program, uniformBlockIndex, pname, params);
 }
 
@@ -797,110 +1031,152 @@ void WrappedOpenGL::glGetActiveUniformBlockName(GLuint program, GLuint uniformBl
                                                 GLsizei bufSize, GLsizei *length,
                                                 GLchar *uniformBlockName)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveUniformBlockName(program, uniformBlockIndex, bufSize, length, uniformBlockName);
 }
 
 void WrappedOpenGL::glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize,
                                       GLsizei *length, GLint *size, GLenum *type, GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveAttrib(program, index, bufSize, length, size, type, name);
 }
 
 void WrappedOpenGL::glGetActiveAtomicCounterBufferiv(GLuint program, GLuint bufferIndex,
                                                      GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetActiveAtomicCounterBufferiv(program, bufferIndex, pname, params);
 }
 
 void WrappedOpenGL::glGetUniformfv(GLuint program, GLint location, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformfv(program, location, params);
 }
 
 void WrappedOpenGL::glGetUniformiv(GLuint program, GLint location, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformiv(program, location, params);
 }
 
 void WrappedOpenGL::glGetUniformuiv(GLuint program, GLint location, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformuiv(program, location, params);
 }
 
 void WrappedOpenGL::glGetUniformdv(GLuint program, GLint location, GLdouble *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetUniformdv(program, location, params);
 }
 
 void WrappedOpenGL::glGetnUniformdv(GLuint program, GLint location, GLsizei bufSize, GLdouble *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetnUniformdv(program, location, bufSize, params);
 }
 
 void WrappedOpenGL::glGetnUniformfv(GLuint program, GLint location, GLsizei bufSize, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetnUniformfv(program, location, bufSize, params);
 }
 
 void WrappedOpenGL::glGetnUniformiv(GLuint program, GLint location, GLsizei bufSize, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetnUniformiv(program, location, bufSize, params);
 }
 
 void WrappedOpenGL::glGetnUniformuiv(GLuint program, GLint location, GLsizei bufSize, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetnUniformuiv(program, location, bufSize, params);
 }
 
 void WrappedOpenGL::glGetVertexArrayiv(GLuint vaobj, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayiv(vaobj, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexArrayIndexed64iv(GLuint vaobj, GLuint index, GLenum pname,
                                                 GLint64 *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayIndexed64iv(vaobj, index, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexArrayIndexediv(GLuint vaobj, GLuint index, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayIndexediv(vaobj, index, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexAttribIiv(GLuint index, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribIiv(index, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexAttribIuiv(GLuint index, GLenum pname, GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribIuiv(index, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexAttribLdv(GLuint index, GLenum pname, GLdouble *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribLdv(index, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexAttribdv(GLuint index, GLenum pname, GLdouble *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribdv(index, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexAttribfv(index, pname, params);
 }
 
 void WrappedOpenGL::glClampColor(GLenum target, GLenum clamp)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClampColor(target, clamp);
 }
 
 void WrappedOpenGL::glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
                                  GLenum type, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glReadPixels(x, y, width, height, format, type, pixels);
@@ -909,6 +1185,8 @@ void WrappedOpenGL::glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height
 void WrappedOpenGL::glReadnPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
                                   GLenum type, GLsizei bufSize, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glReadnPixels(x, y, width, height, format, type, bufSize, pixels);
@@ -918,41 +1196,57 @@ void WrappedOpenGL::glGetTransformFeedbackVarying(GLuint program, GLuint index,
                                                   GLsizei *length, GLsizei *size, GLenum *type,
                                                   GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTransformFeedbackVarying(program, index, bufSize, length, size, type, name);
 }
 
 void WrappedOpenGL::glGetTransformFeedbacki64_v(GLuint xfb, GLenum pname, GLuint index, GLint64 *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTransformFeedbacki64_v(xfb, pname, index, param);
 }
 
 void WrappedOpenGL::glGetTransformFeedbacki_v(GLuint xfb, GLenum pname, GLuint index, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTransformFeedbacki_v(xfb, pname, index, param);
 }
 
 void WrappedOpenGL::glGetTransformFeedbackiv(GLuint xfb, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTransformFeedbackiv(xfb, pname, param);
 }
 
 void WrappedOpenGL::glGetFramebufferParameteriv(GLenum target, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetFramebufferParameteriv(target, pname, param);
 }
 
 void WrappedOpenGL::glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetRenderbufferParameteriv(target, pname, param);
 }
 
 void WrappedOpenGL::glGetNamedBufferParameteri64v(GLuint buffer, GLenum pname, GLint64 *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedBufferParameteri64v(buffer, pname, params);
 }
 
 void WrappedOpenGL::glGetNamedFramebufferParameterivEXT(GLuint framebuffer, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedFramebufferParameterivEXT(framebuffer, pname, param);
 }
 
@@ -960,18 +1254,24 @@ void WrappedOpenGL::glGetNamedFramebufferAttachmentParameterivEXT(GLuint framebu
                                                                   GLenum attachment, GLenum pname,
                                                                   GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedFramebufferAttachmentParameterivEXT(framebuffer, attachment, pname, params);
 }
 
 void WrappedOpenGL::glGetNamedRenderbufferParameterivEXT(GLuint renderbuffer, GLenum pname,
                                                          GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedRenderbufferParameterivEXT(renderbuffer, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureImageEXT(GLuint texture, GLenum target, GLint level, GLenum format,
                                          GLenum type, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetTextureImageEXT(texture, target, level, format, type, pixels);
@@ -980,6 +1280,8 @@ void WrappedOpenGL::glGetTextureImageEXT(GLuint texture, GLenum target, GLint le
 void WrappedOpenGL::glGetCompressedTextureImageEXT(GLuint texture, GLenum target, GLint level,
                                                    void *img)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetCompressedTextureImageEXT(texture, target, level, img);
@@ -987,17 +1289,23 @@ void WrappedOpenGL::glGetCompressedTextureImageEXT(GLuint texture, GLenum target
 
 GLenum WrappedOpenGL::glCheckNamedFramebufferStatusEXT(GLuint framebuffer, GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.glCheckNamedFramebufferStatusEXT(framebuffer, target);
 }
 
 void WrappedOpenGL::glGetNamedBufferParameterivEXT(GLuint buffer, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedBufferParameterivEXT(buffer, pname, params);
 }
 
 void WrappedOpenGL::glGetNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsizeiptr size,
                                                void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetNamedBufferSubDataEXT(buffer, offset, size, data);
@@ -1006,6 +1314,8 @@ void WrappedOpenGL::glGetNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, G
 void WrappedOpenGL::glGetNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size,
                                             void *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetNamedBufferSubData(buffer, offset, size, data);
@@ -1014,41 +1324,55 @@ void WrappedOpenGL::glGetNamedBufferSubData(GLuint buffer, GLintptr offset, GLsi
 void WrappedOpenGL::glGetTextureParameterivEXT(GLuint texture, GLenum target, GLenum pname,
                                                GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterivEXT(texture, target, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterfvEXT(GLuint texture, GLenum target, GLenum pname,
                                                GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterfvEXT(texture, target, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterIivEXT(GLuint texture, GLenum target, GLenum pname,
                                                 GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterIivEXT(texture, target, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureParameterIuivEXT(GLuint texture, GLenum target, GLenum pname,
                                                  GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureParameterIuivEXT(texture, target, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureLevelParameterivEXT(GLuint texture, GLenum target, GLint level,
                                                     GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureLevelParameterivEXT(texture, target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetTextureLevelParameterfvEXT(GLuint texture, GLenum target, GLint level,
                                                     GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetTextureLevelParameterfvEXT(texture, target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetPointeri_vEXT(GLenum pname, GLuint index, void **params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pname == eGL_DEBUG_CALLBACK_FUNCTION)
     *params = (void *)m_RealDebugFunc;
   else if(pname == eGL_DEBUG_CALLBACK_USER_PARAM)
@@ -1059,32 +1383,44 @@ void WrappedOpenGL::glGetPointeri_vEXT(GLenum pname, GLuint index, void **params
 
 void WrappedOpenGL::glGetDoubleIndexedvEXT(GLenum target, GLuint index, GLdouble *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetDoubleIndexedvEXT(target, index, data);
 }
 
 void WrappedOpenGL::glGetPointerIndexedvEXT(GLenum target, GLuint index, void **data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetPointerIndexedvEXT(target, index, data);
 }
 
 void WrappedOpenGL::glGetIntegerIndexedvEXT(GLenum target, GLuint index, GLint *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetIntegerIndexedvEXT(target, index, data);
 }
 
 void WrappedOpenGL::glGetBooleanIndexedvEXT(GLenum target, GLuint index, GLboolean *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetBooleanIndexedvEXT(target, index, data);
 }
 
 void WrappedOpenGL::glGetFloatIndexedvEXT(GLenum target, GLuint index, GLfloat *data)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetFloatIndexedvEXT(target, index, data);
 }
 
 void WrappedOpenGL::glGetMultiTexImageEXT(GLenum texunit, GLenum target, GLint level, GLenum format,
                                           GLenum type, void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetMultiTexImageEXT(texunit, target, level, format, type, pixels);
@@ -1093,42 +1429,56 @@ void WrappedOpenGL::glGetMultiTexImageEXT(GLenum texunit, GLenum target, GLint l
 void WrappedOpenGL::glGetMultiTexParameterfvEXT(GLenum texunit, GLenum target, GLenum pname,
                                                 GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexParameterfvEXT(texunit, target, pname, params);
 }
 
 void WrappedOpenGL::glGetMultiTexParameterivEXT(GLenum texunit, GLenum target, GLenum pname,
                                                 GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexParameterivEXT(texunit, target, pname, params);
 }
 
 void WrappedOpenGL::glGetMultiTexParameterIivEXT(GLenum texunit, GLenum target, GLenum pname,
                                                  GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexParameterIivEXT(texunit, target, pname, params);
 }
 
 void WrappedOpenGL::glGetMultiTexParameterIuivEXT(GLenum texunit, GLenum target, GLenum pname,
                                                   GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexParameterIuivEXT(texunit, target, pname, params);
 }
 
 void WrappedOpenGL::glGetMultiTexLevelParameterfvEXT(GLenum texunit, GLenum target, GLint level,
                                                      GLenum pname, GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexLevelParameterfvEXT(texunit, target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetMultiTexLevelParameterivEXT(GLenum texunit, GLenum target, GLint level,
                                                      GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetMultiTexLevelParameterivEXT(texunit, target, level, pname, params);
 }
 
 void WrappedOpenGL::glGetCompressedMultiTexImageEXT(GLenum texunit, GLenum target, GLint lod,
                                                     void *img)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glGetCompressedMultiTexImageEXT(texunit, target, lod, img);
@@ -1136,6 +1486,8 @@ void WrappedOpenGL::glGetCompressedMultiTexImageEXT(GLenum texunit, GLenum targe
 
 void WrappedOpenGL::glGetNamedBufferPointervEXT(GLuint buffer, GLenum pname, void **params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   // intercept GL_BUFFER_MAP_POINTER queries
@@ -1165,27 +1517,37 @@ void WrappedOpenGL::glGetNamedBufferPointervEXT(GLuint buffer, GLenum pname, voi
 
 void WrappedOpenGL::glGetNamedProgramivEXT(GLuint program, GLenum target, GLenum pname, GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetNamedProgramivEXT(program, target, pname, params);
 }
 
 void WrappedOpenGL::glGetVertexArrayIntegervEXT(GLuint vaobj, GLenum pname, GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayIntegervEXT(vaobj, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexArrayPointervEXT(GLuint vaobj, GLenum pname, void **param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayPointervEXT(vaobj, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexArrayIntegeri_vEXT(GLuint vaobj, GLuint index, GLenum pname,
                                                   GLint *param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayIntegeri_vEXT(vaobj, index, pname, param);
 }
 
 void WrappedOpenGL::glGetVertexArrayPointeri_vEXT(GLuint vaobj, GLuint index, GLenum pname,
                                                   void **param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGetVertexArrayPointeri_vEXT(vaobj, index, pname, param);
 }
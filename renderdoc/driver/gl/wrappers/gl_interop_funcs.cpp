@@ -37,12 +37,16 @@ void GetDXTextureProperties(void *dxObject, ResourceFormat &fmt, uint32_t &width
 
 BOOL WrappedOpenGL::wglDXSetResourceShareHandleNV(void *dxObject, HANDLE shareHandle)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // no-op
   return m_Real.wglDXSetResourceShareHandleNV(dxObject, shareHandle);
 }
 
 HANDLE WrappedOpenGL::wglDXOpenDeviceNV(void *dxDevice)
 {
+  SCOPED_ENTRY_PROFILE();
+
   void *unwrapped = UnwrapDXDevice(dxDevice);
   if(unwrapped)
   {
@@ -60,6 +64,8 @@ HANDLE WrappedOpenGL::wglDXOpenDeviceNV(void *dxDevice)
 
 BOOL WrappedOpenGL::wglDXCloseDeviceNV(HANDLE hDevice)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return m_Real.wglDXCloseDeviceNV(hDevice);
 }
 
@@ -77,6 +83,8 @@ HANDLE Unwrap(HANDLE h)
 HANDLE WrappedOpenGL::wglDXRegisterObjectNV(HANDLE hDevice, void *dxObject, GLuint name,
                                             GLenum type, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   RDCASSERT(m_State >= WRITING);
 
   ID3D11Resource *real = UnwrapDXResource(dxObject);
@@ -136,6 +144,8 @@ HANDLE WrappedOpenGL::wglDXRegisterObjectNV(HANDLE hDevice, void *dxObject, GLui
 
 BOOL WrappedOpenGL::wglDXUnregisterObjectNV(HANDLE hDevice, HANDLE hObject)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // don't need to intercept this, as the DX and GL textures will be deleted independently
   BOOL ret = m_Real.wglDXUnregisterObjectNV(hDevice, Unwrap(hObject));
 
@@ -146,12 +156,16 @@ BOOL WrappedOpenGL::wglDXUnregisterObjectNV(HANDLE hDevice, HANDLE hObject)
 
 BOOL WrappedOpenGL::wglDXObjectAccessNV(HANDLE hObject, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // we don't need to care about access
   return m_Real.wglDXObjectAccessNV(Unwrap(hObject), access);
 }
 
 BOOL WrappedOpenGL::wglDXLockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hObjects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   HANDLE *unwrapped = new HANDLE[count];
   for(GLint i = 0; i < count; i++)
     unwrapped[i] = Unwrap(hObjects[i]);
@@ -179,6 +193,8 @@ BOOL WrappedOpenGL::wglDXLockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hObj
 
 BOOL WrappedOpenGL::wglDXUnlockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hObjects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   HANDLE *unwrapped = new HANDLE[count];
   for(GLint i = 0; i < count; i++)
     unwrapped[i] = Unwrap(hObjects[i]);
@@ -191,42 +207,58 @@ BOOL WrappedOpenGL::wglDXUnlockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hO
 
 BOOL WrappedOpenGL::wglDXSetResourceShareHandleNV(void *dxObject, HANDLE shareHandle)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 HANDLE WrappedOpenGL::wglDXOpenDeviceNV(void *dxDevice)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 BOOL WrappedOpenGL::wglDXCloseDeviceNV(HANDLE hDevice)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 HANDLE WrappedOpenGL::wglDXRegisterObjectNV(HANDLE hDevice, void *dxObject, GLuint name,
                                             GLenum type, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 BOOL WrappedOpenGL::wglDXUnregisterObjectNV(HANDLE hDevice, HANDLE hObject)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 BOOL WrappedOpenGL::wglDXObjectAccessNV(HANDLE hObject, GLenum access)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 BOOL WrappedOpenGL::wglDXLockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hObjects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
 BOOL WrappedOpenGL::wglDXUnlockObjectsNV(HANDLE hDevice, GLint count, HANDLE *hObjects)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return 0;
 }
 
@@ -249,14 +281,14 @@ bool WrappedOpenGL::Serialise_wglDXRegisterObjectNV(GLResource res, GLenum type,
 #endif
   }
 
-  m_pSerialiser->Serialise("type", type);
-  m_pSerialiser->Serialise("internalFormat", internalFormat);
-  m_pSerialiser->Serialise("width", width);
-  m_pSerialiser->Serialise("height", height);
-  m_pSerialiser->Serialise("depth", depth);
-  m_pSerialiser->Serialise("mips", mips);
-  m_pSerialiser->Serialise("layers", layers);
-  m_pSerialiser->Serialise("samples", samples);
+  GetSerialiser()->Serialise("type", type);
+  GetSerialiser()->Serialise("internalFormat", internalFormat);
+  GetSerialiser()->Serialise("width", width);
+  GetSerialiser()->Serialise("height", height);
+  GetSerialiser()->Serialise("depth", depth);
+  GetSerialiser()->Serialise("mips", mips);
+  GetSerialiser()->Serialise("layers", layers);
+  GetSerialiser()->Serialise("samples", samples);
 
   if(m_State < WRITING)
   {
@@ -397,7 +429,7 @@ bool WrappedOpenGL::Serialise_wglDXLockObjectsNV(GLResource res)
           // we avoid glGetTextureImageEXT as it seems buggy for cubemap faces
           gl.glGetTexImage(targets[trg], i, fmt, type, buf);
 
-          m_pSerialiser->SerialiseBuffer("image", buf, size);
+          GetSerialiser()->SerialiseBuffer("image", buf, size);
         }
       }
 
@@ -458,7 +490,7 @@ bool WrappedOpenGL::Serialise_wglDXLockObjectsNV(GLResource res)
         {
           size_t size = 0;
           byte *buf = NULL;
-          m_pSerialiser->SerialiseBuffer("image", buf, size);
+          GetSerialiser()->SerialiseBuffer("image", buf, size);
 
           if(dim == 1)
             gl.glTextureSubImage1DEXT(tex, targets[trg], i, 0, w, fmt, type, buf);
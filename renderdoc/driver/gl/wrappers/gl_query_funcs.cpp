@@ -52,6 +52,8 @@ bool WrappedOpenGL::Serialise_glFenceSync(GLsync real, GLenum condition, GLbitfi
 
 GLsync WrappedOpenGL::glFenceSync(GLenum condition, GLbitfield flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   GLsync sync = m_Real.glFenceSync(condition, flags);
 
   GLuint name = 0;
@@ -100,6 +102,8 @@ bool WrappedOpenGL::Serialise_glClientWaitSync(GLsync sync, GLbitfield flags, GL
 
 GLenum WrappedOpenGL::glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   GLenum ret = m_Real.glClientWaitSync(sync, flags, timeout);
 
   if(m_State == WRITING_CAPFRAME)
@@ -133,6 +137,8 @@ bool WrappedOpenGL::Serialise_glWaitSync(GLsync sync, GLbitfield flags, GLuint64
 
 void WrappedOpenGL::glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glWaitSync(sync, flags, timeout);
 
   if(m_State == WRITING_CAPFRAME)
@@ -146,6 +152,8 @@ void WrappedOpenGL::glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 
 void WrappedOpenGL::glDeleteSync(GLsync sync)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDeleteSync(sync);
 
   ResourceId id = GetResourceManager()->GetSyncID(sync);
@@ -174,6 +182,8 @@ bool WrappedOpenGL::Serialise_glGenQueries(GLsizei n, GLuint *ids)
 
 void WrappedOpenGL::glGenQueries(GLsizei count, GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenQueries(count, ids);
 
   for(GLsizei i = 0; i < count; i++)
@@ -225,6 +235,8 @@ bool WrappedOpenGL::Serialise_glCreateQueries(GLenum target, GLsizei n, GLuint *
 
 void WrappedOpenGL::glCreateQueries(GLenum target, GLsizei count, GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateQueries(target, count, ids);
 
   for(GLsizei i = 0; i < count; i++)
@@ -275,6 +287,8 @@ bool WrappedOpenGL::Serialise_glBeginQuery(GLenum target, GLuint qid)
 
 void WrappedOpenGL::glBeginQuery(GLenum target, GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBeginQuery(target, id);
   if(m_ActiveQueries[QueryIdx(target)][0])
     RDCLOG("Query already active %s", ToStr::Get(target).c_str());
@@ -307,6 +321,8 @@ bool WrappedOpenGL::Serialise_glBeginQueryIndexed(GLenum target, GLuint index, G
 
 void WrappedOpenGL::glBeginQueryIndexed(GLenum target, GLuint index, GLuint id)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBeginQueryIndexed(target, index, id);
   m_ActiveQueries[QueryIdx(target)][index] = true;
 
@@ -339,6 +355,8 @@ bool WrappedOpenGL::Serialise_glEndQuery(GLenum target)
 
 void WrappedOpenGL::glEndQuery(GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEndQuery(target);
   m_ActiveQueries[QueryIdx(target)][0] = false;
 
@@ -367,6 +385,8 @@ bool WrappedOpenGL::Serialise_glEndQueryIndexed(GLenum target, GLuint index)
 
 void WrappedOpenGL::glEndQueryIndexed(GLenum target, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEndQueryIndexed(target, index);
   m_ActiveQueries[QueryIdx(target)][index] = false;
 
@@ -395,6 +415,8 @@ bool WrappedOpenGL::Serialise_glBeginConditionalRender(GLuint id, GLenum mode)
 
 void WrappedOpenGL::glBeginConditionalRender(GLuint id, GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBeginConditionalRender(id, mode);
 
   m_ActiveConditional = true;
@@ -422,6 +444,8 @@ bool WrappedOpenGL::Serialise_glEndConditionalRender()
 
 void WrappedOpenGL::glEndConditionalRender()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEndConditionalRender();
   m_ActiveConditional = false;
 
@@ -449,6 +473,8 @@ bool WrappedOpenGL::Serialise_glQueryCounter(GLuint query, GLenum target)
 
 void WrappedOpenGL::glQueryCounter(GLuint query, GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glQueryCounter(query, target);
 
   if(m_State == WRITING_CAPFRAME)
@@ -463,6 +489,8 @@ void WrappedOpenGL::glQueryCounter(GLuint query, GLenum target)
 
 void WrappedOpenGL::glDeleteQueries(GLsizei n, const GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = QueryRes(GetCtx(), ids[i]);
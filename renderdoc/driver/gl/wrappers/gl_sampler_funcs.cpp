@@ -49,6 +49,8 @@ bool WrappedOpenGL::Serialise_glGenSamplers(GLsizei n, GLuint *samplers)
 
 void WrappedOpenGL::glGenSamplers(GLsizei count, GLuint *samplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenSamplers(count, samplers);
 
   for(GLsizei i = 0; i < count; i++)
@@ -99,6 +101,8 @@ bool WrappedOpenGL::Serialise_glCreateSamplers(GLsizei n, GLuint *samplers)
 
 void WrappedOpenGL::glCreateSamplers(GLsizei count, GLuint *samplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateSamplers(count, samplers);
 
   for(GLsizei i = 0; i < count; i++)
@@ -154,6 +158,8 @@ bool WrappedOpenGL::Serialise_glBindSampler(GLuint unit, GLuint sampler)
 
 void WrappedOpenGL::glBindSampler(GLuint unit, GLuint sampler)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindSampler(unit, sampler);
 
   if(m_State == WRITING_CAPFRAME)
@@ -203,6 +209,8 @@ bool WrappedOpenGL::Serialise_glBindSamplers(GLuint first, GLsizei count, const
 
 void WrappedOpenGL::glBindSamplers(GLuint first, GLsizei count, const GLuint *samplers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindSamplers(first, count, samplers);
 
   if(m_State == WRITING_CAPFRAME)
@@ -254,6 +262,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameteri(GLuint sampler, GLenum pname,
 
 void WrappedOpenGL::glSamplerParameteri(GLuint sampler, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameteri(sampler, pname, param);
 
   // CLAMP isn't supported (border texels gone), assume they meant CLAMP_TO_EDGE
@@ -295,6 +305,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameterf(GLuint sampler, GLenum pname,
 
 void WrappedOpenGL::glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameterf(sampler, pname, param);
 
   // CLAMP isn't supported (border texels gone), assume they meant CLAMP_TO_EDGE
@@ -339,6 +351,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameteriv(GLuint sampler, GLenum pname,
 
 void WrappedOpenGL::glSamplerParameteriv(GLuint sampler, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameteriv(sampler, pname, params);
 
   GLint clamptoedge[4] = {eGL_CLAMP_TO_EDGE};
@@ -384,6 +398,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameterfv(GLuint sampler, GLenum pname,
 
 void WrappedOpenGL::glSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameterfv(sampler, pname, params);
 
   GLfloat clamptoedge[4] = {(float)eGL_CLAMP_TO_EDGE};
@@ -429,6 +445,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameterIiv(GLuint sampler, GLenum pname
 
 void WrappedOpenGL::glSamplerParameterIiv(GLuint sampler, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameterIiv(sampler, pname, params);
 
   GLint clamptoedge[4] = {eGL_CLAMP_TO_EDGE};
@@ -475,6 +493,8 @@ bool WrappedOpenGL::Serialise_glSamplerParameterIuiv(GLuint sampler, GLenum pnam
 
 void WrappedOpenGL::glSamplerParameterIuiv(GLuint sampler, GLenum pname, const GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSamplerParameterIuiv(sampler, pname, params);
 
   GLuint clamptoedge[4] = {eGL_CLAMP_TO_EDGE};
@@ -502,6 +522,8 @@ void WrappedOpenGL::glSamplerParameterIuiv(GLuint sampler, GLenum pname, const G
 
 void WrappedOpenGL::glDeleteSamplers(GLsizei n, const GLuint *ids)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = SamplerRes(GetCtx(), ids[i]);
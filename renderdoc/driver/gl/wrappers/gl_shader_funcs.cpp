@@ -26,9 +26,133 @@
 #include "../gl_driver.h"
 #include "../gl_shader_refl.h"
 #include "common/common.h"
+#include "common/shader_cache.h"
 #include "driver/shaders/spirv/spirv_common.h"
 #include "serialise/string_utils.h"
 
+// defined in replay_proxy.cpp
+template <>
+void Serialiser::Serialise(const char *name, ShaderReflection &el);
+
+struct GLReflectionCacheCallbacks
+{
+  bool Create(uint32_t size, byte *data, vector<byte> **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new vector<byte>(data, data + size);
+
+    return true;
+  }
+
+  void Destroy(vector<byte> *blob) const { delete blob; }
+  uint32_t GetSize(vector<byte> *blob) const { return (uint32_t)blob->size(); }
+  byte *GetData(vector<byte> *blob) const { return &(*blob)[0]; }
+} ReflectionCacheCallbacks;
+
+void WrappedOpenGL::LoadShaderReflectionCache()
+{
+  bool success = m_ShaderReflCacheFile.Open("glreflection.cache", m_ShaderReflCacheMagic,
+                                            m_ShaderReflCacheVersion);
+
+  // if we failed to load from the cache
+  m_ShaderReflCacheDirty = !success;
+}
+
+void WrappedOpenGL::SaveShaderReflectionCache()
+{
+  if(m_ShaderReflCacheDirty)
+  {
+    SaveShaderCache(m_ShaderReflCacheFile, m_ShaderReflCache, ReflectionCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_ShaderReflCache.begin(); it != m_ShaderReflCache.end(); ++it)
+      ReflectionCacheCallbacks.Destroy(it->second);
+  }
+
+  m_ShaderReflCache.clear();
+}
+
+uint32_t WrappedOpenGL::GetShaderReflectionHash(GLenum type, const vector<string> &sources,
+                                                bool pointSizeUsed, bool clipDistanceUsed)
+{
+  // reflection comes from the driver's program interface, so the same sources can reflect
+  // differently on a different driver.
+  if(m_ShaderReflDriverHash == 0)
+  {
+    const char *vendor = (const char *)m_Real.glGetString(eGL_VENDOR);
+    const char *renderer = (const char *)m_Real.glGetString(eGL_RENDERER);
+    const char *version = (const char *)m_Real.glGetString(eGL_VERSION);
+
+    m_ShaderReflDriverHash = strhash(vendor ? vendor : "");
+    m_ShaderReflDriverHash = strhash(renderer ? renderer : "", m_ShaderReflDriverHash);
+    m_ShaderReflDriverHash = strhash(version ? version : "", m_ShaderReflDriverHash);
+  }
+
+  uint32_t hash = m_ShaderReflDriverHash;
+  for(size_t i = 0; i < sources.size(); i++)
+    hash = strhash(sources[i].c_str(), hash);
+
+  char typestr[4] = {'a', 'a', 'a', 0};
+  typestr[0] += (char)ShaderIdx(type);
+  typestr[1] += pointSizeUsed ? 1 : 0;
+  typestr[2] += clipDistanceUsed ? 1 : 0;
+
+  return strhash(typestr, hash);
+}
+
+bool WrappedOpenGL::FetchCachedShaderReflection(uint32_t hash, ShaderReflection &refl)
+{
+  auto it = m_ShaderReflCache.find(hash);
+  if(it == m_ShaderReflCache.end())
+  {
+    if(!FetchShaderCache(m_ShaderReflCacheFile, hash, m_ShaderReflCache, ReflectionCacheCallbacks))
+      return false;
+
+    it = m_ShaderReflCache.find(hash);
+  }
+
+  Serialiser ser(it->second->size(), &(*it->second)[0], false);
+
+  ser.Serialise("", refl);
+
+  if(ser.HasError())
+  {
+    RDCWARN("Invalid cached reflection for shader hash %u, regenerating", hash);
+    refl = ShaderReflection();
+    return false;
+  }
+
+  return true;
+}
+
+void WrappedOpenGL::CacheShaderReflection(uint32_t hash, const ShaderReflection &refl)
+{
+  ShaderReflection cached = refl;
+
+  // the source is stored separately and is cheap to restore, don't duplicate it in the cache
+  create_array(cached.RawBytes, 0);
+  create_array(cached.DebugInfo.files, 0);
+
+  Serialiser ser(NULL, Serialiser::WRITING, false);
+
+  ser.Serialise("", cached);
+
+  byte *data = ser.GetRawPtr(0);
+  size_t size = (size_t)ser.GetOffset();
+
+  if(size == 0)
+    return;
+
+  auto it = m_ShaderReflCache.find(hash);
+  if(it != m_ShaderReflCache.end())
+    ReflectionCacheCallbacks.Destroy(it->second);
+
+  m_ShaderReflCache[hash] = new vector<byte>(data, data + size);
+  m_ShaderReflCacheDirty = true;
+}
+
 void WrappedOpenGL::ShaderData::Compile(WrappedOpenGL &gl)
 {
   bool pointSizeUsed = false, clipDistanceUsed = false;
@@ -69,16 +193,24 @@ void WrappedOpenGL::ShaderData::Compile(WrappedOpenGL &gl)
   else
   {
     prog = sepProg;
-    MakeShaderReflection(gl.GetHookset(), type, sepProg, reflection, pointSizeUsed, clipDistanceUsed);
 
-    vector<uint32_t> spirvwords;
+    uint32_t reflHash =
+        gl.GetShaderReflectionHash(type, sources, pointSizeUsed, clipDistanceUsed);
 
-    string s = CompileSPIRV(SPIRVShaderStage(ShaderIdx(type)), sources, spirvwords);
-    if(!spirvwords.empty())
-      ParseSPIRV(&spirvwords.front(), spirvwords.size(), spirv);
+    // the raw bytes are filled in above, keep them over whatever is read from the cache
+    rdctype::array<byte> rawBytes = reflection.RawBytes;
+
+    bool cached = gl.FetchCachedShaderReflection(reflHash, reflection);
+
+    reflection.RawBytes = rawBytes;
+
+    if(!cached)
+    {
+      MakeShaderReflection(gl.GetHookset(), type, sepProg, reflection, pointSizeUsed,
+                           clipDistanceUsed);
 
-    // for classic GL, entry point is always main
-    reflection.Disassembly = spirv.Disassemble("main");
+      gl.CacheShaderReflection(reflHash, reflection);
+    }
 
     create_array_uninit(reflection.DebugInfo.files, sources.size());
     for(size_t i = 0; i < sources.size(); i++)
@@ -89,6 +221,26 @@ void WrappedOpenGL::ShaderData::Compile(WrappedOpenGL &gl)
   }
 }
 
+void WrappedOpenGL::ShaderData::Disassemble()
+{
+  // the disassembly isn't part of the cached reflection, it's only generated when the shader is
+  // actually looked at since compiling and disassembling the SPIR-V is expensive.
+  if(reflection.Disassembly.count > 0 || sources.empty())
+    return;
+
+  if(spirv.spirv.empty())
+  {
+    vector<uint32_t> spirvwords;
+
+    string s = CompileSPIRV(SPIRVShaderStage(ShaderIdx(type)), sources, spirvwords);
+    if(!spirvwords.empty())
+      ParseSPIRV(&spirvwords.front(), spirvwords.size(), spirv);
+  }
+
+  // for classic GL, entry point is always main
+  reflection.Disassembly = spirv.Disassemble("main");
+}
+
 #pragma region Shaders
 
 bool WrappedOpenGL::Serialise_glCreateShader(GLuint shader, GLenum type)
@@ -114,6 +266,8 @@ bool WrappedOpenGL::Serialise_glCreateShader(GLuint shader, GLenum type)
 
 GLuint WrappedOpenGL::glCreateShader(GLenum type)
 {
+  SCOPED_ENTRY_PROFILE();
+
   GLuint real = m_Real.glCreateShader(type);
 
   GLResource res = ShaderRes(GetCtx(), real);
@@ -159,7 +313,7 @@ bool WrappedOpenGL::Serialise_glShaderSource(GLuint shader, GLsizei count,
     if(source && source[i])
       s = (length && length[i] > 0) ? string(source[i], source[i] + length[i]) : string(source[i]);
 
-    m_pSerialiser->SerialiseString("source", s);
+    GetSerialiser()->SerialiseString("source", s);
 
     if(m_State == READING)
       srcs.push_back(s);
@@ -194,7 +348,7 @@ bool WrappedOpenGL::Serialise_glShaderSource(GLuint shader, GLsizei count,
     {
       m_Real.glDeleteProgram(m_Shaders[liveId].prog);
       m_Shaders[liveId].prog = 0;
-      m_Shaders[liveId].spirv = SPVModule();
+      m_Shaders[liveId].spirv.Clear();
       m_Shaders[liveId].reflection = ShaderReflection();
     }
 
@@ -207,6 +361,8 @@ bool WrappedOpenGL::Serialise_glShaderSource(GLuint shader, GLsizei count,
 void WrappedOpenGL::glShaderSource(GLuint shader, GLsizei count, const GLchar *const *string,
                                    const GLint *length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glShaderSource(shader, count, string, length);
 
   if(m_State >= WRITING)
@@ -251,6 +407,8 @@ bool WrappedOpenGL::Serialise_glCompileShader(GLuint shader)
 
 void WrappedOpenGL::glCompileShader(GLuint shader)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompileShader(shader);
 
   if(m_State >= WRITING)
@@ -274,11 +432,15 @@ void WrappedOpenGL::glCompileShader(GLuint shader)
 
 void WrappedOpenGL::glReleaseShaderCompiler()
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glReleaseShaderCompiler();
 }
 
 void WrappedOpenGL::glDeleteShader(GLuint shader)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDeleteShader(shader);
 
   GLResource res = ShaderRes(GetCtx(), shader);
@@ -311,6 +473,8 @@ bool WrappedOpenGL::Serialise_glAttachShader(GLuint program, GLuint shader)
 
 void WrappedOpenGL::glAttachShader(GLuint program, GLuint shader)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glAttachShader(program, shader);
 
   if(m_State >= WRITING && program != 0 && shader != 0)
@@ -369,6 +533,8 @@ bool WrappedOpenGL::Serialise_glDetachShader(GLuint program, GLuint shader)
 
 void WrappedOpenGL::glDetachShader(GLuint program, GLuint shader)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDetachShader(program, shader);
 
   // check that shader still exists, it might have been deleted. If it has, it's not too important
@@ -423,7 +589,7 @@ bool WrappedOpenGL::Serialise_glCreateShaderProgramv(GLuint program, GLenum type
     string s;
     if(m_State >= WRITING)
       s = strings[i];
-    m_pSerialiser->SerialiseString("Source", s);
+    GetSerialiser()->SerialiseString("Source", s);
     if(m_State < WRITING)
       src.push_back(s);
   }
@@ -468,6 +634,8 @@ bool WrappedOpenGL::Serialise_glCreateShaderProgramv(GLuint program, GLenum type
 
 GLuint WrappedOpenGL::glCreateShaderProgramv(GLenum type, GLsizei count, const GLchar *const *strings)
 {
+  SCOPED_ENTRY_PROFILE();
+
   GLuint real = m_Real.glCreateShaderProgramv(type, count, strings);
 
   if(real == 0)
@@ -546,6 +714,8 @@ bool WrappedOpenGL::Serialise_glCreateProgram(GLuint program)
 
 GLuint WrappedOpenGL::glCreateProgram()
 {
+  SCOPED_ENTRY_PROFILE();
+
   GLuint real = m_Real.glCreateProgram();
 
   GLResource res = ProgramRes(GetCtx(), real);
@@ -610,6 +780,8 @@ bool WrappedOpenGL::Serialise_glLinkProgram(GLuint program)
 
 void WrappedOpenGL::glLinkProgram(GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glLinkProgram(program);
 
   if(m_State >= WRITING)
@@ -662,6 +834,8 @@ bool WrappedOpenGL::Serialise_glUniformBlockBinding(GLuint program, GLuint unifo
 void WrappedOpenGL::glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex,
                                           GLuint uniformBlockBinding)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
 
   if(m_State >= WRITING)
@@ -698,6 +872,8 @@ bool WrappedOpenGL::Serialise_glShaderStorageBlockBinding(GLuint program, GLuint
 void WrappedOpenGL::glShaderStorageBlockBinding(GLuint program, GLuint storageBlockIndex,
                                                 GLuint storageBlockBinding)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glShaderStorageBlockBinding(program, storageBlockIndex, storageBlockBinding);
 
   if(m_State >= WRITING)
@@ -721,7 +897,7 @@ bool WrappedOpenGL::Serialise_glBindAttribLocation(GLuint program, GLuint index,
   SERIALISE_ELEMENT(uint32_t, idx, index);
 
   string name = name_ ? name_ : "";
-  m_pSerialiser->Serialise("Name", name);
+  GetSerialiser()->Serialise("Name", name);
 
   if(m_State == READING)
   {
@@ -733,6 +909,8 @@ bool WrappedOpenGL::Serialise_glBindAttribLocation(GLuint program, GLuint index,
 
 void WrappedOpenGL::glBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindAttribLocation(program, index, name);
 
   if(m_State >= WRITING)
@@ -756,7 +934,7 @@ bool WrappedOpenGL::Serialise_glBindFragDataLocation(GLuint program, GLuint colo
   SERIALISE_ELEMENT(uint32_t, col, color);
 
   string name = name_ ? name_ : "";
-  m_pSerialiser->Serialise("Name", name);
+  GetSerialiser()->Serialise("Name", name);
 
   if(m_State == READING)
   {
@@ -768,6 +946,8 @@ bool WrappedOpenGL::Serialise_glBindFragDataLocation(GLuint program, GLuint colo
 
 void WrappedOpenGL::glBindFragDataLocation(GLuint program, GLuint color, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindFragDataLocation(program, color, name);
 
   if(m_State >= WRITING)
@@ -802,6 +982,8 @@ bool WrappedOpenGL::Serialise_glUniformSubroutinesuiv(GLenum shadertype, GLsizei
 
 void WrappedOpenGL::glUniformSubroutinesuiv(GLenum shadertype, GLsizei count, const GLuint *indices)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glUniformSubroutinesuiv(shadertype, count, indices);
 
   if(m_State >= WRITING_CAPFRAME)
@@ -821,7 +1003,7 @@ bool WrappedOpenGL::Serialise_glBindFragDataLocationIndexed(GLuint program, GLui
   SERIALISE_ELEMENT(uint32_t, idx, index);
 
   string name = name_ ? name_ : "";
-  m_pSerialiser->Serialise("Name", name);
+  GetSerialiser()->Serialise("Name", name);
 
   if(m_State == READING)
   {
@@ -835,6 +1017,8 @@ bool WrappedOpenGL::Serialise_glBindFragDataLocationIndexed(GLuint program, GLui
 void WrappedOpenGL::glBindFragDataLocationIndexed(GLuint program, GLuint colorNumber, GLuint index,
                                                   const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindFragDataLocationIndexed(program, colorNumber, index, name);
 
   if(m_State >= WRITING)
@@ -866,7 +1050,7 @@ bool WrappedOpenGL::Serialise_glTransformFeedbackVaryings(GLuint program, GLsize
   for(uint32_t c = 0; c < Count; c++)
   {
     string v = varyings && varyings[c] ? varyings[c] : "";
-    m_pSerialiser->Serialise("Varying", v);
+    GetSerialiser()->Serialise("Varying", v);
     if(vars)
     {
       vars[c] = v;
@@ -889,6 +1073,8 @@ bool WrappedOpenGL::Serialise_glTransformFeedbackVaryings(GLuint program, GLsize
 void WrappedOpenGL::glTransformFeedbackVaryings(GLuint program, GLsizei count,
                                                 const GLchar *const *varyings, GLenum bufferMode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTransformFeedbackVaryings(program, count, varyings, bufferMode);
 
   if(m_State >= WRITING)
@@ -922,6 +1108,8 @@ bool WrappedOpenGL::Serialise_glProgramParameteri(GLuint program, GLenum pname,
 
 void WrappedOpenGL::glProgramParameteri(GLuint program, GLenum pname, GLint value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glProgramParameteri(program, pname, value);
 
   if(m_State >= WRITING)
@@ -941,6 +1129,8 @@ void WrappedOpenGL::glProgramParameteri(GLuint program, GLenum pname, GLint valu
 
 void WrappedOpenGL::glDeleteProgram(GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDeleteProgram(program);
 
   GLResource res = ProgramRes(GetCtx(), program);
@@ -970,6 +1160,8 @@ bool WrappedOpenGL::Serialise_glUseProgram(GLuint program)
 
 void WrappedOpenGL::glUseProgram(GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glUseProgram(program);
 
   GetCtxData().m_Program = program;
@@ -986,17 +1178,23 @@ void WrappedOpenGL::glUseProgram(GLuint program)
 
 void WrappedOpenGL::glValidateProgram(GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glValidateProgram(program);
 }
 
 void WrappedOpenGL::glValidateProgramPipeline(GLuint pipeline)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glValidateProgramPipeline(pipeline);
 }
 
 void WrappedOpenGL::glShaderBinary(GLsizei count, const GLuint *shaders, GLenum binaryformat,
                                    const void *binary, GLsizei length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // deliberately don't forward on this call when writing, since we want to coax the app into
   // providing non-binary shaders.
   if(m_State < WRITING)
@@ -1008,6 +1206,8 @@ void WrappedOpenGL::glShaderBinary(GLsizei count, const GLuint *shaders, GLenum
 void WrappedOpenGL::glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary,
                                     GLsizei length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // deliberately don't forward on this call when writing, since we want to coax the app into
   // providing non-binary shaders.
   if(m_State < WRITING)
@@ -1088,6 +1288,8 @@ bool WrappedOpenGL::Serialise_glUseProgramStages(GLuint pipeline, GLbitfield sta
 
 void WrappedOpenGL::glUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glUseProgramStages(pipeline, stages, program);
 
   if(m_State > WRITING)
@@ -1135,18 +1337,18 @@ void WrappedOpenGL::glUseProgramStages(GLuint pipeline, GLbitfield stages, GLuin
           if(c->GetChunkType() != USE_PROGRAMSTAGES)
             return false;
 
-          byte *b = c->GetData();
-          byte *end = b + c->GetLength();
+          const byte *b = c->GetData();
+          const byte *end = b + c->GetLength();
 
           // 'fast' path, rather than searching byte-by-byte from
           // the start to be safe, check the exact difference it should
           // always be first.
-          if(*(uint64_t *)(b + 6) == marker_glUseProgramStages_hack)
+          if(*(const uint64_t *)(b + 6) == marker_glUseProgramStages_hack)
             b += 6;
 
           while(b + sizeof(uint64_t) < end)
           {
-            uint64_t *marker = (uint64_t *)b;
+            const uint64_t *marker = (const uint64_t *)b;
             if(*marker == marker_glUseProgramStages_hack)
             {
               // increment to point to pipeline id
@@ -1155,7 +1357,7 @@ void WrappedOpenGL::glUseProgramStages(GLuint pipeline, GLbitfield stages, GLuin
               marker++;
 
               // now compare
-              uint32_t *chunkStages = (uint32_t *)marker;
+              const uint32_t *chunkStages = (const uint32_t *)marker;
 
               if(*chunkStages == stages)
                 return true;
@@ -1249,6 +1451,8 @@ bool WrappedOpenGL::Serialise_glGenProgramPipelines(GLsizei n, GLuint *pipelines
 
 void WrappedOpenGL::glGenProgramPipelines(GLsizei n, GLuint *pipelines)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenProgramPipelines(n, pipelines);
 
   for(GLsizei i = 0; i < n; i++)
@@ -1300,6 +1504,8 @@ bool WrappedOpenGL::Serialise_glCreateProgramPipelines(GLsizei n, GLuint *pipeli
 
 void WrappedOpenGL::glCreateProgramPipelines(GLsizei n, GLuint *pipelines)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateProgramPipelines(n, pipelines);
 
   for(GLsizei i = 0; i < n; i++)
@@ -1354,6 +1560,8 @@ bool WrappedOpenGL::Serialise_glBindProgramPipeline(GLuint pipeline)
 
 void WrappedOpenGL::glBindProgramPipeline(GLuint pipeline)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindProgramPipeline(pipeline);
 
   GetCtxData().m_ProgramPipeline = pipeline;
@@ -1371,6 +1579,8 @@ void WrappedOpenGL::glBindProgramPipeline(GLuint pipeline)
 
 void WrappedOpenGL::glActiveShaderProgram(GLuint pipeline, GLuint program)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glActiveShaderProgram(pipeline, program);
 }
 
@@ -1404,6 +1614,8 @@ GLuint WrappedOpenGL::GetUniformProgram()
 
 void WrappedOpenGL::glDeleteProgramPipelines(GLsizei n, const GLuint *pipelines)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = ProgramPipeRes(GetCtx(), pipelines[i]);
@@ -1437,7 +1649,7 @@ bool WrappedOpenGL::Serialise_glCompileShaderIncludeARB(GLuint shader, GLsizei c
     if(path && path[i])
       s = (length && length[i] > 0) ? string(path[i], path[i] + length[i]) : string(path[i]);
 
-    m_pSerialiser->SerialiseString("path", s);
+    GetSerialiser()->SerialiseString("path", s);
 
     if(m_State == READING)
       paths.push_back(s);
@@ -1475,6 +1687,8 @@ bool WrappedOpenGL::Serialise_glCompileShaderIncludeARB(GLuint shader, GLsizei c
 void WrappedOpenGL::glCompileShaderIncludeARB(GLuint shader, GLsizei count,
                                               const GLchar *const *path, const GLint *length)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompileShaderIncludeARB(shader, count, path, length);
 
   if(m_State >= WRITING)
@@ -1514,8 +1728,8 @@ bool WrappedOpenGL::Serialise_glNamedStringARB(GLenum type, GLint namelen, const
   string namestr = name ? string(name, name + (namelen > 0 ? namelen : strlen(name))) : "";
   string valstr = str ? string(str, str + (stringlen > 0 ? stringlen : strlen(str))) : "";
 
-  m_pSerialiser->Serialise("Name", namestr);
-  m_pSerialiser->Serialise("String", valstr);
+  GetSerialiser()->Serialise("Name", namestr);
+  GetSerialiser()->Serialise("String", valstr);
 
   if(m_State == READING)
   {
@@ -1529,6 +1743,8 @@ bool WrappedOpenGL::Serialise_glNamedStringARB(GLenum type, GLint namelen, const
 void WrappedOpenGL::glNamedStringARB(GLenum type, GLint namelen, const GLchar *name,
                                      GLint stringlen, const GLchar *str)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glNamedStringARB(type, namelen, name, stringlen, str);
 
   if(m_State >= WRITING)
@@ -1547,7 +1763,7 @@ bool WrappedOpenGL::Serialise_glDeleteNamedStringARB(GLint namelen, const GLchar
 {
   string namestr = name ? string(name, name + (namelen > 0 ? namelen : strlen(name))) : "";
 
-  m_pSerialiser->Serialise("Name", namestr);
+  GetSerialiser()->Serialise("Name", namestr);
 
   if(m_State == READING)
   {
@@ -1559,6 +1775,8 @@ bool WrappedOpenGL::Serialise_glDeleteNamedStringARB(GLint namelen, const GLchar
 
 void WrappedOpenGL::glDeleteNamedStringARB(GLint namelen, const GLchar *name)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDeleteNamedStringARB(namelen, name);
 
   if(m_State >= WRITING)
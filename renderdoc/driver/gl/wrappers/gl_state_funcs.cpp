@@ -42,6 +42,8 @@ bool WrappedOpenGL::Serialise_glBlendFunc(GLenum sfactor, GLenum dfactor)
 
 void WrappedOpenGL::glBlendFunc(GLenum sfactor, GLenum dfactor)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendFunc(sfactor, dfactor);
 
   if(m_State == WRITING_CAPFRAME)
@@ -69,6 +71,8 @@ bool WrappedOpenGL::Serialise_glBlendFunci(GLuint buf, GLenum src, GLenum dst)
 
 void WrappedOpenGL::glBlendFunci(GLuint buf, GLenum src, GLenum dst)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendFunci(buf, src, dst);
 
   if(m_State == WRITING_CAPFRAME)
@@ -97,6 +101,8 @@ bool WrappedOpenGL::Serialise_glBlendColor(GLfloat red, GLfloat green, GLfloat b
 
 void WrappedOpenGL::glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendColor(red, green, blue, alpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -127,6 +133,8 @@ bool WrappedOpenGL::Serialise_glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfac
 void WrappedOpenGL::glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha,
                                         GLenum dfactorAlpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -158,6 +166,8 @@ bool WrappedOpenGL::Serialise_glBlendFuncSeparatei(GLuint buf, GLenum sfactorRGB
 void WrappedOpenGL::glBlendFuncSeparatei(GLuint buf, GLenum sfactorRGB, GLenum dfactorRGB,
                                          GLenum sfactorAlpha, GLenum dfactorAlpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendFuncSeparatei(buf, sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -183,6 +193,8 @@ bool WrappedOpenGL::Serialise_glBlendEquation(GLenum mode)
 
 void WrappedOpenGL::glBlendEquation(GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendEquation(mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -209,6 +221,8 @@ bool WrappedOpenGL::Serialise_glBlendEquationi(GLuint buf, GLenum mode)
 
 void WrappedOpenGL::glBlendEquationi(GLuint buf, GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendEquationi(buf, mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -235,6 +249,8 @@ bool WrappedOpenGL::Serialise_glBlendEquationSeparate(GLenum modeRGB, GLenum mod
 
 void WrappedOpenGL::glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendEquationSeparate(modeRGB, modeAlpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -262,6 +278,8 @@ bool WrappedOpenGL::Serialise_glBlendEquationSeparatei(GLuint buf, GLenum modeRG
 
 void WrappedOpenGL::glBlendEquationSeparatei(GLuint buf, GLenum modeRGB, GLenum modeAlpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBlendEquationSeparatei(buf, modeRGB, modeAlpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -283,6 +301,8 @@ bool WrappedOpenGL::Serialise_glBlendBarrierKHR()
 
 void WrappedOpenGL::glBlendBarrierKHR()
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glBlendBarrierKHR();
@@ -310,6 +330,8 @@ bool WrappedOpenGL::Serialise_glLogicOp(GLenum opcode)
 
 void WrappedOpenGL::glLogicOp(GLenum opcode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glLogicOp(opcode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -337,6 +359,8 @@ bool WrappedOpenGL::Serialise_glStencilFunc(GLenum func, GLint ref, GLuint mask)
 
 void WrappedOpenGL::glStencilFunc(GLenum func, GLint ref, GLuint mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilFunc(func, ref, mask);
 
   if(m_State == WRITING_CAPFRAME)
@@ -365,6 +389,8 @@ bool WrappedOpenGL::Serialise_glStencilFuncSeparate(GLenum face, GLenum func, GL
 
 void WrappedOpenGL::glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilFuncSeparate(face, func, ref, mask);
 
   if(m_State == WRITING_CAPFRAME)
@@ -390,6 +416,8 @@ bool WrappedOpenGL::Serialise_glStencilMask(GLuint mask)
 
 void WrappedOpenGL::glStencilMask(GLuint mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilMask(mask);
 
   if(m_State == WRITING_CAPFRAME)
@@ -416,6 +444,8 @@ bool WrappedOpenGL::Serialise_glStencilMaskSeparate(GLenum face, GLuint mask)
 
 void WrappedOpenGL::glStencilMaskSeparate(GLenum face, GLuint mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilMaskSeparate(face, mask);
 
   if(m_State == WRITING_CAPFRAME)
@@ -443,6 +473,8 @@ bool WrappedOpenGL::Serialise_glStencilOp(GLenum fail, GLenum zfail, GLenum zpas
 
 void WrappedOpenGL::glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilOp(fail, zfail, zpass);
 
   if(m_State == WRITING_CAPFRAME)
@@ -472,6 +504,8 @@ bool WrappedOpenGL::Serialise_glStencilOpSeparate(GLenum face, GLenum sfail, GLe
 
 void WrappedOpenGL::glStencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glStencilOpSeparate(face, sfail, dpfail, dppass);
 
   if(m_State == WRITING_CAPFRAME)
@@ -500,6 +534,8 @@ bool WrappedOpenGL::Serialise_glClearColor(GLclampf red, GLclampf green, GLclamp
 
 void WrappedOpenGL::glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClearColor(red, green, blue, alpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -525,6 +561,8 @@ bool WrappedOpenGL::Serialise_glClearStencil(GLint stencil)
 
 void WrappedOpenGL::glClearStencil(GLint stencil)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClearStencil(stencil);
 
   if(m_State == WRITING_CAPFRAME)
@@ -550,6 +588,8 @@ bool WrappedOpenGL::Serialise_glClearDepth(GLdouble depth)
 
 void WrappedOpenGL::glClearDepth(GLdouble depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClearDepth(depth);
 
   if(m_State == WRITING_CAPFRAME)
@@ -563,6 +603,8 @@ void WrappedOpenGL::glClearDepth(GLdouble depth)
 
 void WrappedOpenGL::glClearDepthf(GLfloat depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClearDepthf(depth);
 
   if(m_State == WRITING_CAPFRAME)
@@ -588,6 +630,8 @@ bool WrappedOpenGL::Serialise_glDepthFunc(GLenum func)
 
 void WrappedOpenGL::glDepthFunc(GLenum func)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthFunc(func);
 
   if(m_State == WRITING_CAPFRAME)
@@ -613,6 +657,8 @@ bool WrappedOpenGL::Serialise_glDepthMask(GLboolean flag)
 
 void WrappedOpenGL::glDepthMask(GLboolean flag)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthMask(flag);
 
   if(m_State == WRITING_CAPFRAME)
@@ -637,6 +683,8 @@ bool WrappedOpenGL::Serialise_glDepthRange(GLdouble nearVal, GLdouble farVal)
 
 void WrappedOpenGL::glDepthRange(GLdouble nearVal, GLdouble farVal)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthRange(nearVal, farVal);
 
   if(m_State == WRITING_CAPFRAME)
@@ -661,6 +709,8 @@ bool WrappedOpenGL::Serialise_glDepthRangef(GLfloat nearVal, GLfloat farVal)
 
 void WrappedOpenGL::glDepthRangef(GLfloat nearVal, GLfloat farVal)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthRangef(nearVal, farVal);
 
   if(m_State == WRITING_CAPFRAME)
@@ -686,6 +736,8 @@ bool WrappedOpenGL::Serialise_glDepthRangeIndexed(GLuint index, GLdouble nearVal
 
 void WrappedOpenGL::glDepthRangeIndexed(GLuint index, GLdouble nearVal, GLdouble farVal)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthRangeIndexed(index, nearVal, farVal);
 
   if(m_State == WRITING_CAPFRAME)
@@ -715,6 +767,8 @@ bool WrappedOpenGL::Serialise_glDepthRangeArrayv(GLuint first, GLsizei count, co
 
 void WrappedOpenGL::glDepthRangeArrayv(GLuint first, GLsizei count, const GLdouble *v)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthRangeArrayv(first, count, v);
 
   if(m_State == WRITING_CAPFRAME)
@@ -741,6 +795,8 @@ bool WrappedOpenGL::Serialise_glDepthBoundsEXT(GLclampd nearVal, GLclampd farVal
 
 void WrappedOpenGL::glDepthBoundsEXT(GLclampd nearVal, GLclampd farVal)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDepthBoundsEXT(nearVal, farVal);
 
   if(m_State == WRITING_CAPFRAME)
@@ -767,6 +823,8 @@ bool WrappedOpenGL::Serialise_glClipControl(GLenum origin, GLenum depth)
 
 void WrappedOpenGL::glClipControl(GLenum origin, GLenum depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glClipControl(origin, depth);
 
   if(m_State == WRITING_CAPFRAME)
@@ -792,6 +850,8 @@ bool WrappedOpenGL::Serialise_glProvokingVertex(GLenum mode)
 
 void WrappedOpenGL::glProvokingVertex(GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glProvokingVertex(mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -817,6 +877,8 @@ bool WrappedOpenGL::Serialise_glPrimitiveRestartIndex(GLuint index)
 
 void WrappedOpenGL::glPrimitiveRestartIndex(GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPrimitiveRestartIndex(index);
 
   if(m_State == WRITING_CAPFRAME)
@@ -842,6 +904,8 @@ bool WrappedOpenGL::Serialise_glDisable(GLenum cap)
 
 void WrappedOpenGL::glDisable(GLenum cap)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDisable(cap);
 
   if(m_State == WRITING_CAPFRAME)
@@ -878,6 +942,8 @@ bool WrappedOpenGL::Serialise_glEnable(GLenum cap)
 
 void WrappedOpenGL::glEnable(GLenum cap)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEnable(cap);
 
   if(m_State == WRITING_CAPFRAME)
@@ -904,6 +970,8 @@ bool WrappedOpenGL::Serialise_glDisablei(GLenum cap, GLuint index)
 
 void WrappedOpenGL::glDisablei(GLenum cap, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glDisablei(cap, index);
 
   if(m_State == WRITING_CAPFRAME)
@@ -930,6 +998,8 @@ bool WrappedOpenGL::Serialise_glEnablei(GLenum cap, GLuint index)
 
 void WrappedOpenGL::glEnablei(GLenum cap, GLuint index)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glEnablei(cap, index);
 
   if(m_State == WRITING_CAPFRAME)
@@ -955,6 +1025,8 @@ bool WrappedOpenGL::Serialise_glFrontFace(GLenum mode)
 
 void WrappedOpenGL::glFrontFace(GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glFrontFace(mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -980,6 +1052,8 @@ bool WrappedOpenGL::Serialise_glCullFace(GLenum mode)
 
 void WrappedOpenGL::glCullFace(GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCullFace(mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1006,6 +1080,8 @@ bool WrappedOpenGL::Serialise_glHint(GLenum target, GLenum mode)
 
 void WrappedOpenGL::glHint(GLenum target, GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glHint(target, mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1035,6 +1111,8 @@ bool WrappedOpenGL::Serialise_glColorMask(GLboolean red, GLboolean green, GLbool
 
 void WrappedOpenGL::glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glColorMask(red, green, blue, alpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1066,6 +1144,8 @@ bool WrappedOpenGL::Serialise_glColorMaski(GLuint buf, GLboolean red, GLboolean
 void WrappedOpenGL::glColorMaski(GLuint buf, GLboolean red, GLboolean green, GLboolean blue,
                                  GLboolean alpha)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glColorMaski(buf, red, green, blue, alpha);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1092,6 +1172,8 @@ bool WrappedOpenGL::Serialise_glSampleMaski(GLuint maskNumber, GLbitfield mask)
 
 void WrappedOpenGL::glSampleMaski(GLuint maskNumber, GLbitfield mask)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSampleMaski(maskNumber, mask);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1118,6 +1200,8 @@ bool WrappedOpenGL::Serialise_glSampleCoverage(GLfloat value, GLboolean invert)
 
 void WrappedOpenGL::glSampleCoverage(GLfloat value, GLboolean invert)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glSampleCoverage(value, invert);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1143,6 +1227,8 @@ bool WrappedOpenGL::Serialise_glMinSampleShading(GLfloat value)
 
 void WrappedOpenGL::glMinSampleShading(GLfloat value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMinSampleShading(value);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1169,6 +1255,8 @@ bool WrappedOpenGL::Serialise_glRasterSamplesEXT(GLuint samples, GLboolean fixed
 
 void WrappedOpenGL::glRasterSamplesEXT(GLuint samples, GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glRasterSamplesEXT(samples, fixedsamplelocations);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1195,6 +1283,8 @@ bool WrappedOpenGL::Serialise_glPatchParameteri(GLenum pname, GLint value)
 
 void WrappedOpenGL::glPatchParameteri(GLenum pname, GLint value)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPatchParameteri(pname, value);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1224,6 +1314,8 @@ bool WrappedOpenGL::Serialise_glPatchParameterfv(GLenum pname, const GLfloat *va
 
 void WrappedOpenGL::glPatchParameterfv(GLenum pname, const GLfloat *values)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPatchParameterfv(pname, values);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1249,6 +1341,8 @@ bool WrappedOpenGL::Serialise_glLineWidth(GLfloat width)
 
 void WrappedOpenGL::glLineWidth(GLfloat width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glLineWidth(width);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1274,6 +1368,8 @@ bool WrappedOpenGL::Serialise_glPointSize(GLfloat size)
 
 void WrappedOpenGL::glPointSize(GLfloat size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPointSize(size);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1317,6 +1413,8 @@ bool WrappedOpenGL::Serialise_glPointParameteri(GLenum pname, GLint param)
 
 void WrappedOpenGL::glPointParameteri(GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPointParameteri(pname, param);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1343,6 +1441,8 @@ bool WrappedOpenGL::Serialise_glPointParameteriv(GLenum pname, const GLint *para
 
 void WrappedOpenGL::glPointParameteriv(GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPointParameteriv(pname, params);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1369,6 +1469,8 @@ bool WrappedOpenGL::Serialise_glPointParameterf(GLenum pname, GLfloat param)
 
 void WrappedOpenGL::glPointParameterf(GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPointParameterf(pname, param);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1395,6 +1497,8 @@ bool WrappedOpenGL::Serialise_glPointParameterfv(GLenum pname, const GLfloat *pa
 
 void WrappedOpenGL::glPointParameterfv(GLenum pname, const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPointParameterfv(pname, params);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1423,6 +1527,8 @@ bool WrappedOpenGL::Serialise_glViewport(GLint x, GLint y, GLsizei width, GLsize
 
 void WrappedOpenGL::glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glViewport(x, y, width, height);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1452,6 +1558,8 @@ bool WrappedOpenGL::Serialise_glViewportArrayv(GLuint index, GLuint count, const
 
 void WrappedOpenGL::glViewportArrayv(GLuint index, GLuint count, const GLfloat *v)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glViewportArrayv(index, count, v);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1465,12 +1573,16 @@ void WrappedOpenGL::glViewportArrayv(GLuint index, GLuint count, const GLfloat *
 
 void WrappedOpenGL::glViewportIndexedf(GLuint index, GLfloat x, GLfloat y, GLfloat w, GLfloat h)
 {
+  SCOPED_ENTRY_PROFILE();
+
   const float v[4] = {x, y, w, h};
   glViewportArrayv(index, 1, v);
 }
 
 void WrappedOpenGL::glViewportIndexedfv(GLuint index, const GLfloat *v)
 {
+  SCOPED_ENTRY_PROFILE();
+
   glViewportArrayv(index, 1, v);
 }
 
@@ -1491,6 +1603,8 @@ bool WrappedOpenGL::Serialise_glScissor(GLint x, GLint y, GLsizei width, GLsizei
 
 void WrappedOpenGL::glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glScissor(x, y, width, height);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1520,6 +1634,8 @@ bool WrappedOpenGL::Serialise_glScissorArrayv(GLuint index, GLsizei count, const
 
 void WrappedOpenGL::glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glScissorArrayv(first, count, v);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1534,12 +1650,16 @@ void WrappedOpenGL::glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
 void WrappedOpenGL::glScissorIndexed(GLuint index, GLint left, GLint bottom, GLsizei width,
                                      GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   const GLint v[4] = {left, bottom, width, height};
   glScissorArrayv(index, 1, v);
 }
 
 void WrappedOpenGL::glScissorIndexedv(GLuint index, const GLint *v)
 {
+  SCOPED_ENTRY_PROFILE();
+
   glScissorArrayv(index, 1, v);
 }
 
@@ -1558,6 +1678,8 @@ bool WrappedOpenGL::Serialise_glPolygonMode(GLenum face, GLenum mode)
 
 void WrappedOpenGL::glPolygonMode(GLenum face, GLenum mode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPolygonMode(face, mode);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1584,6 +1706,8 @@ bool WrappedOpenGL::Serialise_glPolygonOffset(GLfloat factor, GLfloat units)
 
 void WrappedOpenGL::glPolygonOffset(GLfloat factor, GLfloat units)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPolygonOffset(factor, units);
 
   if(m_State == WRITING_CAPFRAME)
@@ -1611,6 +1735,8 @@ bool WrappedOpenGL::Serialise_glPolygonOffsetClampEXT(GLfloat factor, GLfloat un
 
 void WrappedOpenGL::glPolygonOffsetClampEXT(GLfloat factor, GLfloat units, GLfloat clamp)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPolygonOffsetClampEXT(factor, units, clamp);
 
   if(m_State == WRITING_CAPFRAME)
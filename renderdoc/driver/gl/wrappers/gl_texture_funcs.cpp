@@ -73,6 +73,8 @@ bool WrappedOpenGL::Serialise_glGenTextures(GLsizei n, GLuint *textures)
 
 void WrappedOpenGL::glGenTextures(GLsizei n, GLuint *textures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenTextures(n, textures);
 
   for(GLsizei i = 0; i < n; i++)
@@ -130,6 +132,8 @@ bool WrappedOpenGL::Serialise_glCreateTextures(GLenum target, GLsizei n, GLuint
 
 void WrappedOpenGL::glCreateTextures(GLenum target, GLsizei n, GLuint *textures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCreateTextures(target, n, textures);
 
   for(GLsizei i = 0; i < n; i++)
@@ -169,6 +173,8 @@ void WrappedOpenGL::glCreateTextures(GLenum target, GLsizei n, GLuint *textures)
 
 void WrappedOpenGL::glDeleteTextures(GLsizei n, const GLuint *textures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(GLsizei i = 0; i < n; i++)
   {
     GLResource res = TextureRes(GetCtx(), textures[i]);
@@ -224,6 +230,8 @@ bool WrappedOpenGL::Serialise_glBindTexture(GLenum target, GLuint texture)
 
 void WrappedOpenGL::glBindTexture(GLenum target, GLuint texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindTexture(target, texture);
 
   if(texture != 0 && GetResourceManager()->GetID(TextureRes(GetCtx(), texture)) == ResourceId())
@@ -328,6 +336,8 @@ bool WrappedOpenGL::Serialise_glBindTextures(GLuint first, GLsizei count, const
 // which makes our lives a bit easier
 void WrappedOpenGL::glBindTextures(GLuint first, GLsizei count, const GLuint *textures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindTextures(first, count, textures);
 
   if(m_State == WRITING_CAPFRAME)
@@ -392,6 +402,8 @@ bool WrappedOpenGL::Serialise_glBindMultiTextureEXT(GLenum texunit, GLenum targe
 
 void WrappedOpenGL::glBindMultiTextureEXT(GLenum texunit, GLenum target, GLuint texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindMultiTextureEXT(texunit, target, texture);
 
   if(texture != 0 && GetResourceManager()->GetID(TextureRes(GetCtx(), texture)) == ResourceId())
@@ -477,6 +489,8 @@ bool WrappedOpenGL::Serialise_glBindTextureUnit(GLuint texunit, GLuint texture)
 
 void WrappedOpenGL::glBindTextureUnit(GLuint unit, GLuint texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindTextureUnit(unit, texture);
 
   if(texture != 0 && GetResourceManager()->GetID(TextureRes(GetCtx(), texture)) == ResourceId())
@@ -531,8 +545,12 @@ bool WrappedOpenGL::Serialise_glBindImageTexture(GLuint unit, GLuint texture, GL
 void WrappedOpenGL::glBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered,
                                        GLint layer, GLenum access, GLenum format)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindImageTexture(unit, texture, level, layered, layer, access, format);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State == WRITING_CAPFRAME)
   {
     Chunk *chunk = NULL;
@@ -592,8 +610,12 @@ bool WrappedOpenGL::Serialise_glBindImageTextures(GLuint first, GLsizei count, c
 
 void WrappedOpenGL::glBindImageTextures(GLuint first, GLsizei count, const GLuint *textures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glBindImageTextures(first, count, textures);
 
+  GetCtxData().m_OutputBindingsChanged = true;
+
   if(m_State >= WRITING_CAPFRAME)
   {
     SCOPED_SERIALISE_CONTEXT(BIND_IMAGE_TEXTURES);
@@ -647,6 +669,8 @@ void WrappedOpenGL::glTextureView(GLuint texture, GLenum target, GLuint origtext
                                   GLenum internalformat, GLuint minlevel, GLuint numlevels,
                                   GLuint minlayer, GLuint numlayers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   internalformat = GetSizedFormat(m_Real, target, internalformat);
 
   m_Real.glTextureView(texture, target, origtexture, internalformat, minlevel, numlevels, minlayer,
@@ -711,7 +735,7 @@ bool WrappedOpenGL::Serialise_glGenerateTextureMipmapEXT(GLuint texture, GLenum
       m_Real.glGenerateTextureMipmap(GetResourceManager()->GetLiveResource(id).name);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -762,6 +786,8 @@ void WrappedOpenGL::Common_glGenerateTextureMipmapEXT(GLResourceRecord *record,
 
 void WrappedOpenGL::glGenerateTextureMipmapEXT(GLuint texture, GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenerateTextureMipmapEXT(texture, target);
 
   if(m_State >= WRITING)
@@ -771,6 +797,8 @@ void WrappedOpenGL::glGenerateTextureMipmapEXT(GLuint texture, GLenum target)
 
 void WrappedOpenGL::glGenerateTextureMipmap(GLuint texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenerateTextureMipmap(texture);
 
   if(m_State >= WRITING)
@@ -780,6 +808,8 @@ void WrappedOpenGL::glGenerateTextureMipmap(GLuint texture)
 
 void WrappedOpenGL::glGenerateMipmap(GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenerateMipmap(target);
 
   if(m_State >= WRITING)
@@ -788,6 +818,8 @@ void WrappedOpenGL::glGenerateMipmap(GLenum target)
 
 void WrappedOpenGL::glGenerateMultiTexMipmapEXT(GLenum texunit, GLenum target)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glGenerateMultiTexMipmapEXT(texunit, target);
 
   if(m_State >= WRITING)
@@ -796,6 +828,8 @@ void WrappedOpenGL::glGenerateMultiTexMipmapEXT(GLenum texunit, GLenum target)
 
 void WrappedOpenGL::glInvalidateTexImage(GLuint texture, GLint level)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateTexImage(texture, level);
 
   if(m_State == WRITING_IDLE)
@@ -808,6 +842,8 @@ void WrappedOpenGL::glInvalidateTexSubImage(GLuint texture, GLint level, GLint x
                                             GLint yoffset, GLint zoffset, GLsizei width,
                                             GLsizei height, GLsizei depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glInvalidateTexSubImage(texture, level, xoffset, yoffset, zoffset, width, height, depth);
 
   if(m_State == WRITING_IDLE)
@@ -847,7 +883,7 @@ bool WrappedOpenGL::Serialise_glCopyImageSubData(GLuint srcName, GLenum srcTarge
                               SourceHeight, SourceDepth);
   }
 
-  const string desc = m_pSerialiser->GetDebugStr();
+  const string desc = GetSerialiser()->GetDebugStr();
 
   Serialise_DebugMessages();
 
@@ -887,6 +923,8 @@ void WrappedOpenGL::glCopyImageSubData(GLuint srcName, GLenum srcTarget, GLint s
                                        GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
                                        GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   CoherentMapImplicitBarrier();
 
   m_Real.glCopyImageSubData(srcName, srcTarget, srcLevel, srcX, srcY, srcZ, dstName, dstTarget,
@@ -977,6 +1015,8 @@ void WrappedOpenGL::Common_glCopyTextureSubImage1DEXT(GLResourceRecord *record,
 void WrappedOpenGL::glCopyTextureSubImage1DEXT(GLuint texture, GLenum target, GLint level,
                                                GLint xoffset, GLint x, GLint y, GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage1DEXT(texture, target, level, xoffset, x, y, width);
 
   if(m_State >= WRITING)
@@ -988,6 +1028,8 @@ void WrappedOpenGL::glCopyTextureSubImage1DEXT(GLuint texture, GLenum target, GL
 void WrappedOpenGL::glCopyTextureSubImage1D(GLuint texture, GLint level, GLint xoffset, GLint x,
                                             GLint y, GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage1D(texture, level, xoffset, x, y, width);
 
   if(m_State >= WRITING)
@@ -999,6 +1041,8 @@ void WrappedOpenGL::glCopyTextureSubImage1D(GLuint texture, GLint level, GLint x
 void WrappedOpenGL::glCopyMultiTexSubImage1DEXT(GLenum texunit, GLenum target, GLint level,
                                                 GLint xoffset, GLint x, GLint y, GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyMultiTexSubImage1DEXT(texunit, target, level, xoffset, x, y, width);
 
   if(m_State >= WRITING)
@@ -1009,6 +1053,8 @@ void WrappedOpenGL::glCopyMultiTexSubImage1DEXT(GLenum texunit, GLenum target, G
 void WrappedOpenGL::glCopyTexSubImage1D(GLenum target, GLint level, GLint xoffset, GLint x, GLint y,
                                         GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTexSubImage1D(target, level, xoffset, x, y, width);
 
   if(m_State >= WRITING)
@@ -1077,6 +1123,8 @@ void WrappedOpenGL::glCopyTextureSubImage2DEXT(GLuint texture, GLenum target, GL
                                                GLint xoffset, GLint yoffset, GLint x, GLint y,
                                                GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage2DEXT(texture, target, level, xoffset, yoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1088,6 +1136,8 @@ void WrappedOpenGL::glCopyTextureSubImage2DEXT(GLuint texture, GLenum target, GL
 void WrappedOpenGL::glCopyTextureSubImage2D(GLuint texture, GLint level, GLint xoffset, GLint yoffset,
                                             GLint x, GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage2D(texture, level, xoffset, yoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1100,6 +1150,8 @@ void WrappedOpenGL::glCopyMultiTexSubImage2DEXT(GLenum texunit, GLenum target, G
                                                 GLint xoffset, GLint yoffset, GLint x, GLint y,
                                                 GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyMultiTexSubImage2DEXT(texunit, target, level, xoffset, yoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1110,6 +1162,8 @@ void WrappedOpenGL::glCopyMultiTexSubImage2DEXT(GLenum texunit, GLenum target, G
 void WrappedOpenGL::glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
                                         GLint x, GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1182,6 +1236,8 @@ void WrappedOpenGL::glCopyTextureSubImage3DEXT(GLuint texture, GLenum target, GL
                                                GLint xoffset, GLint yoffset, GLint zoffset, GLint x,
                                                GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage3DEXT(texture, target, level, xoffset, yoffset, zoffset, x, y, width,
                                     height);
 
@@ -1195,6 +1251,8 @@ void WrappedOpenGL::glCopyTextureSubImage3D(GLuint texture, GLint level, GLint x
                                             GLint yoffset, GLint zoffset, GLint x, GLint y,
                                             GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureSubImage3D(texture, level, xoffset, yoffset, zoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1207,6 +1265,8 @@ void WrappedOpenGL::glCopyMultiTexSubImage3DEXT(GLenum texunit, GLenum target, G
                                                 GLint xoffset, GLint yoffset, GLint zoffset,
                                                 GLint x, GLint y, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyMultiTexSubImage3DEXT(texunit, target, level, xoffset, yoffset, zoffset, x, y, width,
                                      height);
 
@@ -1219,6 +1279,8 @@ void WrappedOpenGL::glCopyTexSubImage3D(GLenum target, GLint level, GLint xoffse
                                         GLint zoffset, GLint x, GLint y, GLsizei width,
                                         GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTexSubImage3D(target, level, xoffset, yoffset, zoffset, x, y, width, height);
 
   if(m_State >= WRITING)
@@ -1310,6 +1372,8 @@ void WrappedOpenGL::Common_glTextureParameteriEXT(GLResourceRecord *record, GLen
 
 void WrappedOpenGL::glTextureParameteri(GLuint texture, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameteri(texture, pname, param);
 
   if(m_State >= WRITING)
@@ -1320,6 +1384,8 @@ void WrappedOpenGL::glTextureParameteri(GLuint texture, GLenum pname, GLint para
 
 void WrappedOpenGL::glTextureParameteriEXT(GLuint texture, GLenum target, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameteriEXT(texture, target, pname, param);
 
   if(m_State >= WRITING)
@@ -1329,6 +1395,8 @@ void WrappedOpenGL::glTextureParameteriEXT(GLuint texture, GLenum target, GLenum
 
 void WrappedOpenGL::glTexParameteri(GLenum target, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameteri(target, pname, param);
 
   if(m_State >= WRITING)
@@ -1337,6 +1405,8 @@ void WrappedOpenGL::glTexParameteri(GLenum target, GLenum pname, GLint param)
 
 void WrappedOpenGL::glMultiTexParameteriEXT(GLenum texunit, GLenum target, GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameteriEXT(texunit, target, pname, param);
 
   if(m_State >= WRITING)
@@ -1412,6 +1482,8 @@ void WrappedOpenGL::Common_glTextureParameterivEXT(GLResourceRecord *record, GLe
 void WrappedOpenGL::glTextureParameterivEXT(GLuint texture, GLenum target, GLenum pname,
                                             const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterivEXT(texture, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1422,6 +1494,8 @@ void WrappedOpenGL::glTextureParameterivEXT(GLuint texture, GLenum target, GLenu
 
 void WrappedOpenGL::glTextureParameteriv(GLuint texture, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameteriv(texture, pname, params);
 
   if(m_State >= WRITING)
@@ -1432,6 +1506,8 @@ void WrappedOpenGL::glTextureParameteriv(GLuint texture, GLenum pname, const GLi
 
 void WrappedOpenGL::glTexParameteriv(GLenum target, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameteriv(target, pname, params);
 
   if(m_State >= WRITING)
@@ -1441,6 +1517,8 @@ void WrappedOpenGL::glTexParameteriv(GLenum target, GLenum pname, const GLint *p
 void WrappedOpenGL::glMultiTexParameterivEXT(GLenum texunit, GLenum target, GLenum pname,
                                              const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameterivEXT(texunit, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1516,6 +1594,8 @@ void WrappedOpenGL::Common_glTextureParameterIivEXT(GLResourceRecord *record, GL
 void WrappedOpenGL::glTextureParameterIivEXT(GLuint texture, GLenum target, GLenum pname,
                                              const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterIivEXT(texture, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1526,6 +1606,8 @@ void WrappedOpenGL::glTextureParameterIivEXT(GLuint texture, GLenum target, GLen
 
 void WrappedOpenGL::glTextureParameterIiv(GLuint texture, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterIiv(texture, pname, params);
 
   if(m_State >= WRITING)
@@ -1536,6 +1618,8 @@ void WrappedOpenGL::glTextureParameterIiv(GLuint texture, GLenum pname, const GL
 
 void WrappedOpenGL::glTexParameterIiv(GLenum target, GLenum pname, const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameterIiv(target, pname, params);
 
   if(m_State >= WRITING)
@@ -1545,6 +1629,8 @@ void WrappedOpenGL::glTexParameterIiv(GLenum target, GLenum pname, const GLint *
 void WrappedOpenGL::glMultiTexParameterIivEXT(GLenum texunit, GLenum target, GLenum pname,
                                               const GLint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameterIivEXT(texunit, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1620,6 +1706,8 @@ void WrappedOpenGL::Common_glTextureParameterIuivEXT(GLResourceRecord *record, G
 void WrappedOpenGL::glTextureParameterIuivEXT(GLuint texture, GLenum target, GLenum pname,
                                               const GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterIuivEXT(texture, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1630,6 +1718,8 @@ void WrappedOpenGL::glTextureParameterIuivEXT(GLuint texture, GLenum target, GLe
 
 void WrappedOpenGL::glTextureParameterIuiv(GLuint texture, GLenum pname, const GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterIuiv(texture, pname, params);
 
   if(m_State >= WRITING)
@@ -1640,6 +1730,8 @@ void WrappedOpenGL::glTextureParameterIuiv(GLuint texture, GLenum pname, const G
 
 void WrappedOpenGL::glTexParameterIuiv(GLenum target, GLenum pname, const GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameterIuiv(target, pname, params);
 
   if(m_State >= WRITING)
@@ -1649,6 +1741,8 @@ void WrappedOpenGL::glTexParameterIuiv(GLenum target, GLenum pname, const GLuint
 void WrappedOpenGL::glMultiTexParameterIuivEXT(GLenum texunit, GLenum target, GLenum pname,
                                                const GLuint *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameterIuivEXT(texunit, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1718,6 +1812,8 @@ void WrappedOpenGL::Common_glTextureParameterfEXT(GLResourceRecord *record, GLen
 
 void WrappedOpenGL::glTextureParameterfEXT(GLuint texture, GLenum target, GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterfEXT(texture, target, pname, param);
 
   if(m_State >= WRITING)
@@ -1727,6 +1823,8 @@ void WrappedOpenGL::glTextureParameterfEXT(GLuint texture, GLenum target, GLenum
 
 void WrappedOpenGL::glTextureParameterf(GLuint texture, GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterf(texture, pname, param);
 
   if(m_State >= WRITING)
@@ -1737,6 +1835,8 @@ void WrappedOpenGL::glTextureParameterf(GLuint texture, GLenum pname, GLfloat pa
 
 void WrappedOpenGL::glTexParameterf(GLenum target, GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameterf(target, pname, param);
 
   if(m_State >= WRITING)
@@ -1745,6 +1845,8 @@ void WrappedOpenGL::glTexParameterf(GLenum target, GLenum pname, GLfloat param)
 
 void WrappedOpenGL::glMultiTexParameterfEXT(GLenum texunit, GLenum target, GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameterfEXT(texunit, target, pname, param);
 
   if(m_State >= WRITING)
@@ -1820,6 +1922,8 @@ void WrappedOpenGL::Common_glTextureParameterfvEXT(GLResourceRecord *record, GLe
 void WrappedOpenGL::glTextureParameterfvEXT(GLuint texture, GLenum target, GLenum pname,
                                             const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterfvEXT(texture, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1830,6 +1934,8 @@ void WrappedOpenGL::glTextureParameterfvEXT(GLuint texture, GLenum target, GLenu
 
 void WrappedOpenGL::glTextureParameterfv(GLuint texture, GLenum pname, const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureParameterfv(texture, pname, params);
 
   if(m_State >= WRITING)
@@ -1840,6 +1946,8 @@ void WrappedOpenGL::glTextureParameterfv(GLuint texture, GLenum pname, const GLf
 
 void WrappedOpenGL::glTexParameterfv(GLenum target, GLenum pname, const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexParameterfv(target, pname, params);
 
   if(m_State >= WRITING)
@@ -1849,6 +1957,8 @@ void WrappedOpenGL::glTexParameterfv(GLenum target, GLenum pname, const GLfloat
 void WrappedOpenGL::glMultiTexParameterfvEXT(GLenum texunit, GLenum target, GLenum pname,
                                              const GLfloat *params)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexParameterfvEXT(texunit, target, pname, params);
 
   if(m_State >= WRITING)
@@ -1871,6 +1981,8 @@ bool WrappedOpenGL::Serialise_glPixelStorei(GLenum pname, GLint param)
 
 void WrappedOpenGL::glPixelStorei(GLenum pname, GLint param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glPixelStorei(pname, param);
 
   // except for capturing frames we ignore this and embed the relevant
@@ -1886,6 +1998,8 @@ void WrappedOpenGL::glPixelStorei(GLenum pname, GLint param)
 
 void WrappedOpenGL::glPixelStoref(GLenum pname, GLfloat param)
 {
+  SCOPED_ENTRY_PROFILE();
+
   glPixelStorei(pname, (GLint)param);
 }
 
@@ -1901,6 +2015,8 @@ bool WrappedOpenGL::Serialise_glActiveTexture(GLenum texture)
 
 void WrappedOpenGL::glActiveTexture(GLenum texture)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glActiveTexture(texture);
 
   GetCtxData().m_TextureUnit = texture - eGL_TEXTURE0;
@@ -1965,7 +2081,7 @@ bool WrappedOpenGL::Serialise_glTextureImage1DEXT(GLuint texture, GLenum target,
   size_t subimageSize = GetByteSize(Width, 1, 1, Format, Type);
 
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
@@ -2004,8 +2120,6 @@ bool WrappedOpenGL::Serialise_glTextureImage1DEXT(GLuint texture, GLenum target,
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -2088,6 +2202,8 @@ void WrappedOpenGL::glTextureImage1DEXT(GLuint texture, GLenum target, GLint lev
                                         GLint internalformat, GLsizei width, GLint border,
                                         GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureImage1DEXT(texture, target, level, internalformat, width, border, format, type,
                              pixels);
 
@@ -2098,6 +2214,8 @@ void WrappedOpenGL::glTextureImage1DEXT(GLuint texture, GLenum target, GLint lev
 void WrappedOpenGL::glTexImage1D(GLenum target, GLint level, GLint internalformat, GLsizei width,
                                  GLint border, GLenum format, GLenum type, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexImage1D(target, level, internalformat, width, border, format, type, pixels);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -2121,6 +2239,8 @@ void WrappedOpenGL::glMultiTexImage1DEXT(GLenum texunit, GLenum target, GLint le
                                          GLint internalformat, GLsizei width, GLint border,
                                          GLenum format, GLenum type, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexImage1DEXT(texunit, target, level, internalformat, width, border, format, type,
                               pixels);
 
@@ -2174,7 +2294,7 @@ bool WrappedOpenGL::Serialise_glTextureImage2DEXT(GLuint texture, GLenum target,
   size_t subimageSize = GetByteSize(Width, Height, 1, Format, Type);
 
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
@@ -2235,8 +2355,6 @@ bool WrappedOpenGL::Serialise_glTextureImage2DEXT(GLuint texture, GLenum target,
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -2321,6 +2439,8 @@ void WrappedOpenGL::glTextureImage2DEXT(GLuint texture, GLenum target, GLint lev
                                         GLint internalformat, GLsizei width, GLsizei height,
                                         GLint border, GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureImage2DEXT(texture, target, level, internalformat, width, height, border, format,
                              type, pixels);
 
@@ -2332,6 +2452,8 @@ void WrappedOpenGL::glTexImage2D(GLenum target, GLint level, GLint internalforma
                                  GLsizei height, GLint border, GLenum format, GLenum type,
                                  const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -2356,6 +2478,8 @@ void WrappedOpenGL::glMultiTexImage2DEXT(GLenum texunit, GLenum target, GLint le
                                          GLint border, GLenum format, GLenum type,
                                          const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexImage2DEXT(texunit, target, level, internalformat, width, height, border, format,
                               type, pixels);
 
@@ -2410,7 +2534,7 @@ bool WrappedOpenGL::Serialise_glTextureImage3DEXT(GLuint texture, GLenum target,
   size_t subimageSize = GetByteSize(Width, Height, Depth, Format, Type);
 
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
@@ -2449,8 +2573,6 @@ bool WrappedOpenGL::Serialise_glTextureImage3DEXT(GLuint texture, GLenum target,
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -2538,6 +2660,8 @@ void WrappedOpenGL::glTextureImage3DEXT(GLuint texture, GLenum target, GLint lev
                                         GLsizei depth, GLint border, GLenum format, GLenum type,
                                         const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureImage3DEXT(texture, target, level, internalformat, width, height, depth, border,
                              format, type, pixels);
 
@@ -2550,6 +2674,8 @@ void WrappedOpenGL::glTexImage3D(GLenum target, GLint level, GLint internalforma
                                  GLsizei height, GLsizei depth, GLint border, GLenum format,
                                  GLenum type, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexImage3D(target, level, internalformat, width, height, depth, border, format, type,
                       pixels);
 
@@ -2575,6 +2701,8 @@ void WrappedOpenGL::glMultiTexImage3DEXT(GLenum texunit, GLenum target, GLint le
                                          GLsizei depth, GLint border, GLenum format, GLenum type,
                                          const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexImage3DEXT(texunit, target, level, internalformat, width, height, depth, border,
                               format, type, pixels);
 
@@ -2624,13 +2752,13 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage1DEXT(GLuint texture, GLen
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
   if(m_State == READING)
   {
-    void *databuf = buf;
+    const void *databuf = buf;
 
     // if we didn't have data provided (this is invalid, but could happen if the data
     // should have been sourced from an unpack buffer), then grow our scratch buffer if
@@ -2671,8 +2799,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage1DEXT(GLuint texture, GLen
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -2757,6 +2883,8 @@ void WrappedOpenGL::glCompressedTextureImage1DEXT(GLuint texture, GLenum target,
                                                   GLenum internalformat, GLsizei width, GLint border,
                                                   GLsizei imageSize, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureImage1DEXT(texture, target, level, internalformat, width, border,
                                        imageSize, pixels);
 
@@ -2769,6 +2897,8 @@ void WrappedOpenGL::glCompressedTexImage1D(GLenum target, GLint level, GLenum in
                                            GLsizei width, GLint border, GLsizei imageSize,
                                            const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexImage1D(target, level, internalformat, width, border, imageSize, pixels);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -2792,6 +2922,8 @@ void WrappedOpenGL::glCompressedMultiTexImage1DEXT(GLenum texunit, GLenum target
                                                    GLenum internalformat, GLsizei width, GLint border,
                                                    GLsizei imageSize, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexImage1DEXT(texunit, target, level, internalformat, width, border,
                                         imageSize, pixels);
 
@@ -2844,13 +2976,13 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage2DEXT(GLuint texture, GLen
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
   if(m_State == READING)
   {
-    void *databuf = buf;
+    const void *databuf = buf;
 
     // if we didn't have data provided (this is invalid, but could happen if the data
     // should have been sourced from an unpack buffer), then grow our scratch buffer if
@@ -2913,8 +3045,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage2DEXT(GLuint texture, GLen
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -3001,6 +3131,8 @@ void WrappedOpenGL::glCompressedTextureImage2DEXT(GLuint texture, GLenum target,
                                                   GLsizei height, GLint border, GLsizei imageSize,
                                                   const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureImage2DEXT(texture, target, level, internalformat, width, height,
                                        border, imageSize, pixels);
 
@@ -3013,6 +3145,8 @@ void WrappedOpenGL::glCompressedTexImage2D(GLenum target, GLint level, GLenum in
                                            GLsizei width, GLsizei height, GLint border,
                                            GLsizei imageSize, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize,
                                 pixels);
 
@@ -3038,6 +3172,8 @@ void WrappedOpenGL::glCompressedMultiTexImage2DEXT(GLenum texunit, GLenum target
                                                    GLsizei height, GLint border, GLsizei imageSize,
                                                    const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexImage2DEXT(texunit, target, level, internalformat, width, height,
                                         border, imageSize, pixels);
 
@@ -3091,13 +3227,13 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage3DEXT(GLuint texture, GLen
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
   SERIALISE_ELEMENT(bool, DataProvided, pixels != NULL);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, DataProvided);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, DataProvided);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
 
   if(m_State == READING)
   {
-    void *databuf = buf;
+    const void *databuf = buf;
 
     // if we didn't have data provided (this is invalid, but could happen if the data
     // should have been sourced from an unpack buffer), then grow our scratch buffer if
@@ -3138,8 +3274,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureImage3DEXT(GLuint texture, GLen
     if(unpackbuf)
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
     m_Real.glPixelStorei(eGL_UNPACK_ALIGNMENT, align);
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -3227,6 +3361,8 @@ void WrappedOpenGL::glCompressedTextureImage3DEXT(GLuint texture, GLenum target,
                                                   GLsizei height, GLsizei depth, GLint border,
                                                   GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureImage3DEXT(texture, target, level, internalformat, width, height, depth,
                                        border, imageSize, pixels);
 
@@ -3239,6 +3375,8 @@ void WrappedOpenGL::glCompressedTexImage3D(GLenum target, GLint level, GLenum in
                                            GLsizei width, GLsizei height, GLsizei depth,
                                            GLint border, GLsizei imageSize, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexImage3D(target, level, internalformat, width, height, depth, border,
                                 imageSize, pixels);
 
@@ -3264,6 +3402,8 @@ void WrappedOpenGL::glCompressedMultiTexImage3DEXT(GLenum texunit, GLenum target
                                                    GLsizei height, GLsizei depth, GLint border,
                                                    GLsizei imageSize, const GLvoid *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexImage3DEXT(texunit, target, level, internalformat, width, height,
                                         depth, border, imageSize, pixels);
 
@@ -3393,6 +3533,8 @@ void WrappedOpenGL::glCopyTextureImage1DEXT(GLuint texture, GLenum target, GLint
                                             GLenum internalformat, GLint x, GLint y, GLsizei width,
                                             GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureImage1DEXT(texture, target, level, internalformat, x, y, width, border);
 
   Common_glCopyTextureImage1DEXT(
@@ -3404,6 +3546,8 @@ void WrappedOpenGL::glCopyMultiTexImage1DEXT(GLenum texunit, GLenum target, GLin
                                              GLenum internalformat, GLint x, GLint y, GLsizei width,
                                              GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyMultiTexImage1DEXT(texunit, target, level, internalformat, x, y, width, border);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3418,6 +3562,8 @@ void WrappedOpenGL::glCopyMultiTexImage1DEXT(GLenum texunit, GLenum target, GLin
 void WrappedOpenGL::glCopyTexImage1D(GLenum target, GLint level, GLenum internalformat, GLint x,
                                      GLint y, GLsizei width, GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTexImage1D(target, level, internalformat, x, y, width, border);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3535,6 +3681,8 @@ void WrappedOpenGL::glCopyTextureImage2DEXT(GLuint texture, GLenum target, GLint
                                             GLenum internalformat, GLint x, GLint y, GLsizei width,
                                             GLsizei height, GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTextureImage2DEXT(texture, target, level, internalformat, x, y, width, height, border);
 
   Common_glCopyTextureImage2DEXT(
@@ -3546,6 +3694,8 @@ void WrappedOpenGL::glCopyMultiTexImage2DEXT(GLenum texunit, GLenum target, GLin
                                              GLenum internalformat, GLint x, GLint y, GLsizei width,
                                              GLsizei height, GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyMultiTexImage2DEXT(texunit, target, level, internalformat, x, y, width, height,
                                   border);
 
@@ -3561,6 +3711,8 @@ void WrappedOpenGL::glCopyMultiTexImage2DEXT(GLenum texunit, GLenum target, GLin
 void WrappedOpenGL::glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x,
                                      GLint y, GLsizei width, GLsizei height, GLint border)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3655,6 +3807,8 @@ void WrappedOpenGL::Common_glTextureStorage1DEXT(ResourceId texId, GLenum target
 void WrappedOpenGL::glTextureStorage1DEXT(GLuint texture, GLenum target, GLsizei levels,
                                           GLenum internalformat, GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage1DEXT(texture, target, levels, internalformat, width);
 
   Common_glTextureStorage1DEXT(GetResourceManager()->GetID(TextureRes(GetCtx(), texture)), target,
@@ -3664,6 +3818,8 @@ void WrappedOpenGL::glTextureStorage1DEXT(GLuint texture, GLenum target, GLsizei
 void WrappedOpenGL::glTextureStorage1D(GLuint texture, GLsizei levels, GLenum internalformat,
                                        GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage1D(texture, levels, internalformat, width);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3677,6 +3833,8 @@ void WrappedOpenGL::glTextureStorage1D(GLuint texture, GLsizei levels, GLenum in
 
 void WrappedOpenGL::glTexStorage1D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexStorage1D(target, levels, internalformat, width);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3777,6 +3935,8 @@ void WrappedOpenGL::Common_glTextureStorage2DEXT(ResourceId texId, GLenum target
 void WrappedOpenGL::glTextureStorage2DEXT(GLuint texture, GLenum target, GLsizei levels,
                                           GLenum internalformat, GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage2DEXT(texture, target, levels, internalformat, width, height);
 
   Common_glTextureStorage2DEXT(GetResourceManager()->GetID(TextureRes(GetCtx(), texture)), target,
@@ -3786,6 +3946,8 @@ void WrappedOpenGL::glTextureStorage2DEXT(GLuint texture, GLenum target, GLsizei
 void WrappedOpenGL::glTextureStorage2D(GLuint texture, GLsizei levels, GLenum internalformat,
                                        GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage2D(texture, levels, internalformat, width, height);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3800,6 +3962,8 @@ void WrappedOpenGL::glTextureStorage2D(GLuint texture, GLsizei levels, GLenum in
 void WrappedOpenGL::glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat,
                                    GLsizei width, GLsizei height)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexStorage2D(target, levels, internalformat, width, height);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3904,6 +4068,8 @@ void WrappedOpenGL::glTextureStorage3DEXT(GLuint texture, GLenum target, GLsizei
                                           GLenum internalformat, GLsizei width, GLsizei height,
                                           GLsizei depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage3DEXT(texture, target, levels, internalformat, width, height, depth);
 
   Common_glTextureStorage3DEXT(GetResourceManager()->GetID(TextureRes(GetCtx(), texture)), target,
@@ -3913,6 +4079,8 @@ void WrappedOpenGL::glTextureStorage3DEXT(GLuint texture, GLenum target, GLsizei
 void WrappedOpenGL::glTextureStorage3D(GLuint texture, GLsizei levels, GLenum internalformat,
                                        GLsizei width, GLsizei height, GLsizei depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage3D(texture, levels, internalformat, width, height, depth);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -3927,6 +4095,8 @@ void WrappedOpenGL::glTextureStorage3D(GLuint texture, GLsizei levels, GLenum in
 void WrappedOpenGL::glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat,
                                    GLsizei width, GLsizei height, GLsizei depth)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexStorage3D(target, levels, internalformat, width, height, depth);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -4036,6 +4206,8 @@ void WrappedOpenGL::glTextureStorage2DMultisampleEXT(GLuint texture, GLenum targ
                                                      GLenum internalformat, GLsizei width,
                                                      GLsizei height, GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage2DMultisampleEXT(texture, target, samples, internalformat, width, height,
                                           fixedsamplelocations);
 
@@ -4048,6 +4220,8 @@ void WrappedOpenGL::glTextureStorage2DMultisample(GLuint texture, GLsizei sample
                                                   GLenum internalformat, GLsizei width,
                                                   GLsizei height, GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage2DMultisample(texture, samples, internalformat, width, height,
                                        fixedsamplelocations);
 
@@ -4065,6 +4239,8 @@ void WrappedOpenGL::glTexStorage2DMultisample(GLenum target, GLsizei samples, GL
                                               GLsizei width, GLsizei height,
                                               GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexStorage2DMultisample(target, samples, internalformat, width, height,
                                    fixedsamplelocations);
 
@@ -4089,6 +4265,8 @@ void WrappedOpenGL::glTexImage2DMultisample(GLenum target, GLsizei samples, GLen
                                             GLsizei width, GLsizei height,
                                             GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexImage2DMultisample(target, samples, internalformat, width, height,
                                  fixedsamplelocations);
 
@@ -4206,6 +4384,8 @@ void WrappedOpenGL::glTextureStorage3DMultisampleEXT(GLuint texture, GLenum targ
                                                      GLsizei height, GLsizei depth,
                                                      GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage3DMultisampleEXT(texture, target, samples, internalformat, width, height,
                                           depth, fixedsamplelocations);
 
@@ -4219,6 +4399,8 @@ void WrappedOpenGL::glTextureStorage3DMultisample(GLuint texture, GLsizei sample
                                                   GLsizei height, GLsizei depth,
                                                   GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureStorage3DMultisample(texture, samples, internalformat, width, height, depth,
                                        fixedsamplelocations);
 
@@ -4236,6 +4418,8 @@ void WrappedOpenGL::glTexStorage3DMultisample(GLenum target, GLsizei samples, GL
                                               GLsizei width, GLsizei height, GLsizei depth,
                                               GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexStorage3DMultisample(target, samples, internalformat, width, height, depth,
                                    fixedsamplelocations);
 
@@ -4261,6 +4445,8 @@ void WrappedOpenGL::glTexImage3DMultisample(GLenum target, GLsizei samples, GLen
                                             GLsizei width, GLsizei height, GLsizei depth,
                                             GLboolean fixedsamplelocations)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexImage3DMultisample(target, samples, internalformat, width, height, depth,
                                  fixedsamplelocations);
 
@@ -4321,7 +4507,7 @@ bool WrappedOpenGL::Serialise_glTextureSubImage1DEXT(GLuint texture, GLenum targ
 
   size_t subimageSize = GetByteSize(Width, 1, 1, Format, Type);
 
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -4371,8 +4557,6 @@ bool WrappedOpenGL::Serialise_glTextureSubImage1DEXT(GLuint texture, GLenum targ
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, false);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -4437,6 +4621,8 @@ void WrappedOpenGL::glTextureSubImage1DEXT(GLuint texture, GLenum target, GLint
                                            GLint xoffset, GLsizei width, GLenum format, GLenum type,
                                            const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage1DEXT(texture, target, level, xoffset, width, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4448,6 +4634,8 @@ void WrappedOpenGL::glTextureSubImage1DEXT(GLuint texture, GLenum target, GLint
 void WrappedOpenGL::glTextureSubImage1D(GLuint texture, GLint level, GLint xoffset, GLsizei width,
                                         GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage1D(texture, level, xoffset, width, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4459,6 +4647,8 @@ void WrappedOpenGL::glTextureSubImage1D(GLuint texture, GLint level, GLint xoffs
 void WrappedOpenGL::glTexSubImage1D(GLenum target, GLint level, GLint xoffset, GLsizei width,
                                     GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexSubImage1D(target, level, xoffset, width, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4470,6 +4660,8 @@ void WrappedOpenGL::glMultiTexSubImage1DEXT(GLenum texunit, GLenum target, GLint
                                             GLint xoffset, GLsizei width, GLenum format,
                                             GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexSubImage1DEXT(texunit, target, level, xoffset, width, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4513,7 +4705,7 @@ bool WrappedOpenGL::Serialise_glTextureSubImage2DEXT(GLuint texture, GLenum targ
 
   size_t subimageSize = GetByteSize(Width, Height, 1, Format, Type);
 
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -4564,8 +4756,6 @@ bool WrappedOpenGL::Serialise_glTextureSubImage2DEXT(GLuint texture, GLenum targ
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, false);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -4631,6 +4821,8 @@ void WrappedOpenGL::glTextureSubImage2DEXT(GLuint texture, GLenum target, GLint
                                            GLint yoffset, GLsizei width, GLsizei height,
                                            GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage2DEXT(texture, target, level, xoffset, yoffset, width, height, format,
                                 type, pixels);
 
@@ -4644,6 +4836,8 @@ void WrappedOpenGL::glTextureSubImage2D(GLuint texture, GLint level, GLint xoffs
                                         GLsizei width, GLsizei height, GLenum format, GLenum type,
                                         const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage2D(texture, level, xoffset, yoffset, width, height, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4656,6 +4850,8 @@ void WrappedOpenGL::glTexSubImage2D(GLenum target, GLint level, GLint xoffset, G
                                     GLsizei width, GLsizei height, GLenum format, GLenum type,
                                     const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
 
   if(m_State >= WRITING)
@@ -4667,6 +4863,8 @@ void WrappedOpenGL::glMultiTexSubImage2DEXT(GLenum texunit, GLenum target, GLint
                                             GLint yoffset, GLsizei width, GLsizei height,
                                             GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexSubImage2DEXT(texunit, target, level, xoffset, yoffset, width, height, format,
                                  type, pixels);
 
@@ -4713,7 +4911,7 @@ bool WrappedOpenGL::Serialise_glTextureSubImage3DEXT(GLuint texture, GLenum targ
 
   size_t subimageSize = GetByteSize(Width, Height, Depth, Format, Type);
 
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, subimageSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, subimageSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -4765,8 +4963,6 @@ bool WrappedOpenGL::Serialise_glTextureSubImage3DEXT(GLuint texture, GLenum targ
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, false);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -4834,6 +5030,8 @@ void WrappedOpenGL::glTextureSubImage3DEXT(GLuint texture, GLenum target, GLint
                                            GLsizei width, GLsizei height, GLsizei depth,
                                            GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage3DEXT(texture, target, level, xoffset, yoffset, zoffset, width, height,
                                 depth, format, type, pixels);
 
@@ -4847,6 +5045,8 @@ void WrappedOpenGL::glTextureSubImage3D(GLuint texture, GLint level, GLint xoffs
                                         GLint zoffset, GLsizei width, GLsizei height, GLsizei depth,
                                         GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureSubImage3D(texture, level, xoffset, yoffset, zoffset, width, height, depth,
                              format, type, pixels);
 
@@ -4860,6 +5060,8 @@ void WrappedOpenGL::glTexSubImage3D(GLenum target, GLint level, GLint xoffset, G
                                     GLint zoffset, GLsizei width, GLsizei height, GLsizei depth,
                                     GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format,
                          type, pixels);
 
@@ -4873,6 +5075,8 @@ void WrappedOpenGL::glMultiTexSubImage3DEXT(GLenum texunit, GLenum target, GLint
                                             GLsizei width, GLsizei height, GLsizei depth,
                                             GLenum format, GLenum type, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexSubImage3DEXT(texunit, target, level, xoffset, yoffset, zoffset, width, height,
                                  depth, format, type, pixels);
 
@@ -4914,7 +5118,7 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage1DEXT(GLuint texture, G
   }
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -4950,8 +5154,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage1DEXT(GLuint texture, G
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, true);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -5017,6 +5219,8 @@ void WrappedOpenGL::glCompressedTextureSubImage1DEXT(GLuint texture, GLenum targ
                                                      GLint xoffset, GLsizei width, GLenum format,
                                                      GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage1DEXT(texture, target, level, xoffset, width, format, imageSize,
                                           pixels);
 
@@ -5030,6 +5234,8 @@ void WrappedOpenGL::glCompressedTextureSubImage1D(GLuint texture, GLint level, G
                                                   GLsizei width, GLenum format, GLsizei imageSize,
                                                   const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage1D(texture, level, xoffset, width, format, imageSize, pixels);
 
   if(m_State >= WRITING)
@@ -5042,6 +5248,8 @@ void WrappedOpenGL::glCompressedTexSubImage1D(GLenum target, GLint level, GLint
                                               GLsizei width, GLenum format, GLsizei imageSize,
                                               const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexSubImage1D(target, level, xoffset, width, format, imageSize, pixels);
 
   if(m_State >= WRITING)
@@ -5053,6 +5261,8 @@ void WrappedOpenGL::glCompressedMultiTexSubImage1DEXT(GLenum texunit, GLenum tar
                                                       GLint xoffset, GLsizei width, GLenum format,
                                                       GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexSubImage1DEXT(texunit, target, level, xoffset, width, format,
                                            imageSize, pixels);
 
@@ -5097,7 +5307,7 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage2DEXT(GLuint texture, G
   }
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -5133,8 +5343,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage2DEXT(GLuint texture, G
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, true);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -5202,6 +5410,8 @@ void WrappedOpenGL::glCompressedTextureSubImage2DEXT(GLuint texture, GLenum targ
                                                      GLsizei height, GLenum format,
                                                      GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage2DEXT(texture, target, level, xoffset, yoffset, width, height,
                                           format, imageSize, pixels);
 
@@ -5216,6 +5426,8 @@ void WrappedOpenGL::glCompressedTextureSubImage2D(GLuint texture, GLint level, G
                                                   GLenum format, GLsizei imageSize,
                                                   const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage2D(texture, level, xoffset, yoffset, width, height, format,
                                        imageSize, pixels);
 
@@ -5229,6 +5441,8 @@ void WrappedOpenGL::glCompressedTexSubImage2D(GLenum target, GLint level, GLint
                                               GLint yoffset, GLsizei width, GLsizei height,
                                               GLenum format, GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format,
                                    imageSize, pixels);
 
@@ -5242,6 +5456,8 @@ void WrappedOpenGL::glCompressedMultiTexSubImage2DEXT(GLenum texunit, GLenum tar
                                                       GLsizei height, GLenum format,
                                                       GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexSubImage2DEXT(texunit, target, level, xoffset, yoffset, width, height,
                                            format, imageSize, pixels);
 
@@ -5290,7 +5506,7 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage3DEXT(GLuint texture, G
   }
 
   SERIALISE_ELEMENT(uint32_t, byteSize, imageSize);
-  SERIALISE_ELEMENT_BUF_OPT(byte *, buf, srcPixels, byteSize, !UnpackBufBound);
+  SERIALISE_ELEMENT_BUF_BORROWED_OPT(buf, srcPixels, byteSize, !UnpackBufBound);
   SERIALISE_ELEMENT(uint64_t, bufoffs, (uint64_t)pixels);
 
   SAFE_DELETE_ARRAY(unpackedPixels);
@@ -5326,8 +5542,6 @@ bool WrappedOpenGL::Serialise_glCompressedTextureSubImage3DEXT(GLuint texture, G
       m_Real.glBindBuffer(eGL_PIXEL_UNPACK_BUFFER, unpackbuf);
       unpack.Apply(&m_Real, true);
     }
-
-    SAFE_DELETE_ARRAY(buf);
   }
 
   return true;
@@ -5398,6 +5612,8 @@ void WrappedOpenGL::glCompressedTextureSubImage3DEXT(GLuint texture, GLenum targ
                                                      GLenum format, GLsizei imageSize,
                                                      const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage3DEXT(texture, target, level, xoffset, yoffset, zoffset, width,
                                           height, depth, format, imageSize, pixels);
 
@@ -5412,6 +5628,8 @@ void WrappedOpenGL::glCompressedTextureSubImage3D(GLuint texture, GLint level, G
                                                   GLsizei height, GLsizei depth, GLenum format,
                                                   GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTextureSubImage3D(texture, level, xoffset, yoffset, zoffset, width, height,
                                        depth, format, imageSize, pixels);
 
@@ -5426,6 +5644,8 @@ void WrappedOpenGL::glCompressedTexSubImage3D(GLenum target, GLint level, GLint
                                               GLsizei height, GLsizei depth, GLenum format,
                                               GLsizei imageSize, const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth,
                                    format, imageSize, pixels);
 
@@ -5441,6 +5661,8 @@ void WrappedOpenGL::glCompressedMultiTexSubImage3DEXT(GLenum texunit, GLenum tar
                                                       GLenum format, GLsizei imageSize,
                                                       const void *pixels)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glCompressedMultiTexSubImage3DEXT(texunit, target, level, xoffset, yoffset, zoffset, width,
                                            height, depth, format, imageSize, pixels);
 
@@ -5584,6 +5806,8 @@ void WrappedOpenGL::Common_glTextureBufferRangeEXT(ResourceId texId, GLenum targ
 void WrappedOpenGL::glTextureBufferRangeEXT(GLuint texture, GLenum target, GLenum internalformat,
                                             GLuint buffer, GLintptr offset, GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureBufferRangeEXT(texture, target, internalformat, buffer, offset, size);
 
   Common_glTextureBufferRangeEXT(GetResourceManager()->GetID(TextureRes(GetCtx(), texture)), target,
@@ -5593,6 +5817,8 @@ void WrappedOpenGL::glTextureBufferRangeEXT(GLuint texture, GLenum target, GLenu
 void WrappedOpenGL::glTextureBufferRange(GLuint texture, GLenum internalformat, GLuint buffer,
                                          GLintptr offset, GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureBufferRange(texture, internalformat, buffer, offset, size);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -5607,6 +5833,8 @@ void WrappedOpenGL::glTextureBufferRange(GLuint texture, GLenum internalformat,
 void WrappedOpenGL::glTexBufferRange(GLenum target, GLenum internalformat, GLuint buffer,
                                      GLintptr offset, GLsizeiptr size)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexBufferRange(target, internalformat, buffer, offset, size);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -5761,6 +5989,8 @@ void WrappedOpenGL::Common_glTextureBufferEXT(ResourceId texId, GLenum target,
 void WrappedOpenGL::glTextureBufferEXT(GLuint texture, GLenum target, GLenum internalformat,
                                        GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureBufferEXT(texture, target, internalformat, buffer);
 
   Common_glTextureBufferEXT(GetResourceManager()->GetID(TextureRes(GetCtx(), texture)), target,
@@ -5769,6 +5999,8 @@ void WrappedOpenGL::glTextureBufferEXT(GLuint texture, GLenum target, GLenum int
 
 void WrappedOpenGL::glTextureBuffer(GLuint texture, GLenum internalformat, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTextureBuffer(texture, internalformat, buffer);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -5782,6 +6014,8 @@ void WrappedOpenGL::glTextureBuffer(GLuint texture, GLenum internalformat, GLuin
 
 void WrappedOpenGL::glTexBuffer(GLenum target, GLenum internalformat, GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glTexBuffer(target, internalformat, buffer);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -5803,6 +6037,8 @@ void WrappedOpenGL::glTexBuffer(GLenum target, GLenum internalformat, GLuint buf
 void WrappedOpenGL::glMultiTexBufferEXT(GLenum texunit, GLenum target, GLenum internalformat,
                                         GLuint buffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   m_Real.glMultiTexBufferEXT(texunit, target, internalformat, buffer);
 
   // saves on queries of the currently bound texture to this target, as we don't have records on
@@ -70,11 +70,11 @@ bool WrappedOpenGL::Serialise_glProgramUniformVector(GLuint program, GLint locat
 
   if(m_State >= WRITING)
   {
-    m_pSerialiser->RawWriteBytes(value, elemSize * elemsPerVec * Count);
+    GetSerialiser()->RawWriteBytes(value, elemSize * elemsPerVec * Count);
   }
   else if(m_State <= EXECUTING)
   {
-    value = m_pSerialiser->RawReadBytes(elemSize * elemsPerVec * Count);
+    value = GetSerialiser()->RawReadBytes(elemSize * elemsPerVec * Count);
 
     if(GetResourceManager()->HasLiveResource(id))
     {
@@ -113,7 +113,7 @@ bool WrappedOpenGL::Serialise_glProgramUniformVector(GLuint program, GLint locat
     }
   }
 
-  if(m_pSerialiser->GetDebugText())
+  if(GetSerialiser()->GetDebugText())
   {
     union
     {
@@ -127,43 +127,43 @@ bool WrappedOpenGL::Serialise_glProgramUniformVector(GLuint program, GLint locat
 
     switch(Type)
     {
-      case VEC1fv: m_pSerialiser->DebugPrint("value: {%f}\n", v.f[0]); break;
-      case VEC1iv: m_pSerialiser->DebugPrint("value: {%d}\n", v.i[0]); break;
-      case VEC1uiv: m_pSerialiser->DebugPrint("value: {%u}\n", v.u[0]); break;
-      case VEC1dv: m_pSerialiser->DebugPrint("value: {%f}\n", (float)v.d[0]); break;
-
-      case VEC2fv: m_pSerialiser->DebugPrint("value: {%f, %f}\n", v.f[0], v.f[1]); break;
-      case VEC2iv: m_pSerialiser->DebugPrint("value: {%d, %d}\n", v.i[0], v.i[1]); break;
-      case VEC2uiv: m_pSerialiser->DebugPrint("value: {%u, %u}\n", v.u[0], v.u[1]); break;
+      case VEC1fv: GetSerialiser()->DebugPrint("value: {%f}\n", v.f[0]); break;
+      case VEC1iv: GetSerialiser()->DebugPrint("value: {%d}\n", v.i[0]); break;
+      case VEC1uiv: GetSerialiser()->DebugPrint("value: {%u}\n", v.u[0]); break;
+      case VEC1dv: GetSerialiser()->DebugPrint("value: {%f}\n", (float)v.d[0]); break;
+
+      case VEC2fv: GetSerialiser()->DebugPrint("value: {%f, %f}\n", v.f[0], v.f[1]); break;
+      case VEC2iv: GetSerialiser()->DebugPrint("value: {%d, %d}\n", v.i[0], v.i[1]); break;
+      case VEC2uiv: GetSerialiser()->DebugPrint("value: {%u, %u}\n", v.u[0], v.u[1]); break;
       case VEC2dv:
-        m_pSerialiser->DebugPrint("value: {%f, %f}\n", (float)v.d[0], (float)v.d[1]);
+        GetSerialiser()->DebugPrint("value: {%f, %f}\n", (float)v.d[0], (float)v.d[1]);
         break;
 
       case VEC3fv:
-        m_pSerialiser->DebugPrint("value: {%f, %f, %f}\n", v.f[0], v.f[1], v.f[2]);
+        GetSerialiser()->DebugPrint("value: {%f, %f, %f}\n", v.f[0], v.f[1], v.f[2]);
         break;
       case VEC3iv:
-        m_pSerialiser->DebugPrint("value: {%d, %d, %d}\n", v.i[0], v.i[1], v.i[2]);
+        GetSerialiser()->DebugPrint("value: {%d, %d, %d}\n", v.i[0], v.i[1], v.i[2]);
         break;
       case VEC3uiv:
-        m_pSerialiser->DebugPrint("value: {%u, %u, %u}\n", v.u[0], v.u[1], v.u[2]);
+        GetSerialiser()->DebugPrint("value: {%u, %u, %u}\n", v.u[0], v.u[1], v.u[2]);
         break;
       case VEC3dv:
-        m_pSerialiser->DebugPrint("value: {%f, %f, %f}\n", (float)v.d[0], (float)v.d[1],
+        GetSerialiser()->DebugPrint("value: {%f, %f, %f}\n", (float)v.d[0], (float)v.d[1],
                                   (float)v.d[2]);
         break;
 
       case VEC4fv:
-        m_pSerialiser->DebugPrint("value: {%f, %f, %f, %f}\n", v.f[0], v.f[1], v.f[2], v.f[3]);
+        GetSerialiser()->DebugPrint("value: {%f, %f, %f, %f}\n", v.f[0], v.f[1], v.f[2], v.f[3]);
         break;
       case VEC4iv:
-        m_pSerialiser->DebugPrint("value: {%d, %d, %d, %d}\n", v.i[0], v.i[1], v.i[2], v.i[3]);
+        GetSerialiser()->DebugPrint("value: {%d, %d, %d, %d}\n", v.i[0], v.i[1], v.i[2], v.i[3]);
         break;
       case VEC4uiv:
-        m_pSerialiser->DebugPrint("value: {%u, %u, %u, %u}\n", v.u[0], v.u[1], v.u[2], v.u[3]);
+        GetSerialiser()->DebugPrint("value: {%u, %u, %u, %u}\n", v.u[0], v.u[1], v.u[2], v.u[3]);
         break;
       case VEC4dv:
-        m_pSerialiser->DebugPrint("value: {%f, %f, %f, %f}\n", (float)v.d[0], (float)v.d[1],
+        GetSerialiser()->DebugPrint("value: {%f, %f, %f, %f}\n", (float)v.d[0], (float)v.d[1],
                                   (float)v.d[2], (float)v.d[3]);
         break;
 
@@ -231,11 +231,11 @@ bool WrappedOpenGL::Serialise_glProgramUniformMatrix(GLuint program, GLint locat
 
   if(m_State >= WRITING)
   {
-    m_pSerialiser->RawWriteBytes(value, elemSize * elemsPerMat * Count);
+    GetSerialiser()->RawWriteBytes(value, elemSize * elemsPerMat * Count);
   }
   else if(m_State <= EXECUTING)
   {
-    value = m_pSerialiser->RawReadBytes(elemSize * elemsPerMat * Count);
+    value = GetSerialiser()->RawReadBytes(elemSize * elemsPerMat * Count);
 
     if(GetResourceManager()->HasLiveResource(id))
     {
@@ -312,20 +312,20 @@ bool WrappedOpenGL::Serialise_glProgramUniformMatrix(GLuint program, GLint locat
     }
   }
 
-  if(m_pSerialiser->GetDebugText())
+  if(GetSerialiser()->GetDebugText())
   {
     float *fv = (float *)value;
     double *dv = (double *)value;
 
-    m_pSerialiser->DebugPrint("value: {");
+    GetSerialiser()->DebugPrint("value: {");
     for(size_t i = 0; i < elemsPerMat; i++)
     {
       if(i == 0)
-        m_pSerialiser->DebugPrint("%f", isDouble ? (float)dv[i] : fv[i]);
+        GetSerialiser()->DebugPrint("%f", isDouble ? (float)dv[i] : fv[i]);
       else
-        m_pSerialiser->DebugPrint(", %f", isDouble ? (float)dv[i] : fv[i]);
+        GetSerialiser()->DebugPrint(", %f", isDouble ? (float)dv[i] : fv[i]);
     }
-    m_pSerialiser->DebugPrint("}\n");
+    GetSerialiser()->DebugPrint("}\n");
   }
 
   return true;
@@ -336,6 +336,8 @@ bool WrappedOpenGL::Serialise_glProgramUniformMatrix(GLuint program, GLint locat
   void WrappedOpenGL::CONCAT(CONCAT(FUNCNAME, count), suffix)(FUNCPARAMS, __VA_ARGS__) \
                                                                                        \
   {                                                                                    \
+    SCOPED_ENTRY_PROFILE();                                                            \
+                                                                                       \
     m_Real.CONCAT(CONCAT(FUNCNAME, count), suffix)(FUNCARGPASS, ARRAYLIST);            \
                                                                                        \
     if(m_State == WRITING_CAPFRAME)                                                    \
@@ -438,6 +440,8 @@ UNIFORM_FUNC(4, d, GLdouble, GLdouble v0, GLdouble v1, GLdouble v2, GLdouble v3)
       FUNCPARAMS, GLsizei count, const paramtype *value)                                     \
                                                                                              \
   {                                                                                          \
+    SCOPED_ENTRY_PROFILE();                                                                  \
+                                                                                             \
     m_Real.CONCAT(CONCAT(FUNCNAME, unicount), CONCAT(suffix, v))(FUNCARGPASS, count, value); \
                                                                                              \
     if(m_State == WRITING_CAPFRAME)                                                          \
@@ -518,6 +522,8 @@ UNIFORM_FUNC(4, d, GLdouble)
       FUNCPARAMS, GLsizei count, GLboolean transpose, const paramtype *value)           \
                                                                                         \
   {                                                                                     \
+    SCOPED_ENTRY_PROFILE();                                                             \
+                                                                                        \
     m_Real.CONCAT(CONCAT(FUNCNAME, dim), suffix)(FUNCARGPASS, count, transpose, value); \
                                                                                         \
     if(m_State == WRITING_CAPFRAME)                                                     \
@@ -46,7 +46,7 @@ static float round_ne(float x)
   return x < 0 ? x + 0.5f : x;
 }
 
-VarType State::OperationType(const OpcodeType &op) const
+VarType State::OperationType(const OpcodeType &op)
 {
   switch(op)
   {
@@ -580,6 +580,103 @@ void State::Init()
   }
 }
 
+void State::Decode(DXBC::DXBCFile *dxbc, GlobalState &global)
+{
+  GlobalState::DecodedShader &decoded = global.decoded;
+
+  decoded.ops.resize(dxbc->GetNumInstructions());
+
+  for(size_t i = 0; i < decoded.ops.size(); i++)
+  {
+    const ASMOperation &op = dxbc->GetInstruction(i);
+
+    decoded.ops[i].type = OperationType(op.operation);
+    decoded.ops[i].numOperands = (uint32_t)dxbc->NumOperands(op.operation);
+  }
+
+  decoded.cbufferIndex.clear();
+
+  for(size_t i = 0; i < dxbc->m_CBuffers.size(); i++)
+  {
+    uint32_t reg = dxbc->m_CBuffers[i].reg;
+
+    if(reg >= decoded.cbufferIndex.size())
+      decoded.cbufferIndex.resize(reg + 1, -1);
+
+    // the first cbuffer with a given register wins
+    if(decoded.cbufferIndex[reg] == -1)
+      decoded.cbufferIndex[reg] = (int32_t)i;
+  }
+
+  decoded.numthreads[0] = decoded.numthreads[1] = decoded.numthreads[2] = 0;
+
+  for(size_t i = 0; i < dxbc->GetNumDeclarations(); i++)
+  {
+    const ASMDecl &decl = dxbc->GetDeclaration(i);
+
+    if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
+    {
+      decoded.numthreads[0] = decl.groupSize[0];
+      decoded.numthreads[1] = decl.groupSize[1];
+      decoded.numthreads[2] = decl.groupSize[2];
+    }
+  }
+}
+
+// copies everything but the name and members from one variable to another. Stepping only ever
+// changes values, so this avoids re-allocating names on every copy
+static void CopyVariableValue(ShaderVariable &dst, const ShaderVariable &src)
+{
+  dst.rows = src.rows;
+  dst.columns = src.columns;
+  dst.type = src.type;
+  dst.displayAsHex = src.displayAsHex;
+  memcpy(&dst.value, &src.value, sizeof(src.value));
+}
+
+static void CopyRegisterValues(rdctype::array<ShaderVariable> &dst,
+                               const rdctype::array<ShaderVariable> &src)
+{
+  for(int32_t i = 0; i < dst.count; i++)
+    CopyVariableValue(dst[i], src[i]);
+}
+
+void State::CopyFrom(const State &o)
+{
+  if(this == &o)
+    return;
+
+  // states stepped from the same initial state always have the same register files, with only
+  // the values changing
+  bool sameLayout = dxbc == o.dxbc && registers.count == o.registers.count &&
+                    outputs.count == o.outputs.count &&
+                    indexableTemps.count == o.indexableTemps.count;
+
+  for(int32_t i = 0; sameLayout && i < indexableTemps.count; i++)
+    sameLayout = (indexableTemps[i].count == o.indexableTemps[i].count);
+
+  if(!sameLayout)
+  {
+    *this = o;
+    return;
+  }
+
+  CopyRegisterValues(registers, o.registers);
+  CopyRegisterValues(outputs, o.outputs);
+  for(int32_t i = 0; i < indexableTemps.count; i++)
+    CopyRegisterValues(indexableTemps[i], o.indexableTemps[i]);
+
+  nextInstruction = o.nextInstruction;
+  flags = o.flags;
+  semantics = o.semantics;
+  quadIndex = o.quadIndex;
+  done = o.done;
+  dxbc = o.dxbc;
+  decoded = o.decoded;
+  trace = o.trace;
+  device = o.device;
+}
+
 bool State::Finished() const
 {
   return dxbc && (done || nextInstruction >= (int)dxbc->GetNumInstructions());
@@ -823,9 +920,9 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
       RDCASSERT(indices[0] < (uint32_t)registers.count);
 
       if(indices[0] < (uint32_t)registers.count)
-        v = s = registers[indices[0]];
+        CopyVariableValue(s, registers[indices[0]]);
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -841,7 +938,7 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
           RDCASSERT(indices[1] < (uint32_t)indexableTemps[indices[0]].count);
           if(indices[1] < (uint32_t)indexableTemps[indices[0]].count)
           {
-            v = s = indexableTemps[indices[0]][indices[1]];
+            CopyVariableValue(s, indexableTemps[indices[0]][indices[1]]);
           }
         }
       }
@@ -852,9 +949,9 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
       RDCASSERT(indices[0] < (uint32_t)trace->inputs.count);
 
       if(indices[0] < (uint32_t)trace->inputs.count)
-        v = s = trace->inputs[indices[0]];
+        CopyVariableValue(s, trace->inputs[indices[0]]);
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -863,9 +960,9 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
       RDCASSERT(indices[0] < (uint32_t)outputs.count);
 
       if(indices[0] < (uint32_t)outputs.count)
-        v = s = outputs[indices[0]];
+        CopyVariableValue(s, outputs[indices[0]]);
       else
-        v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+        s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
 
       break;
     }
@@ -883,7 +980,7 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
     {
       // should be handled specially by instructions that expect these types of
       // argument but let's be sane and include the index
-      v = s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
+      s = ShaderVariable("", indices[0], indices[0], indices[0], indices[0]);
       break;
     }
     case TYPE_IMMEDIATE32:
@@ -919,22 +1016,14 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
             "Encountered immediate 64bit value!");    // need to figure out what to do here.
       }
 
-      v = s;
-
       break;
     }
     case TYPE_CONSTANT_BUFFER:
     {
       int cb = -1;
 
-      for(size_t i = 0; i < dxbc->m_CBuffers.size(); i++)
-      {
-        if(dxbc->m_CBuffers[i].reg == indices[0])
-        {
-          cb = (int)i;
-          break;
-        }
-      }
+      if(indices[0] < decoded->cbufferIndex.size())
+        cb = decoded->cbufferIndex[indices[0]];
 
       RDCASSERTMSG("Invalid cbuffer lookup", cb != -1 && cb < trace->cbuffers.count, cb,
                    trace->cbuffers.count);
@@ -945,20 +1034,20 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
                      indices[1], trace->cbuffers[cb].count);
 
         if(indices[1] < (uint32_t)trace->cbuffers[cb].count)
-          v = s = trace->cbuffers[cb][indices[1]];
+          CopyVariableValue(s, trace->cbuffers[cb][indices[1]]);
         else
-          v = s = ShaderVariable("", 0U, 0U, 0U, 0U);
+          s = ShaderVariable("", 0U, 0U, 0U, 0U);
       }
       else
       {
-        v = s = ShaderVariable("", 0U, 0U, 0U, 0U);
+        s = ShaderVariable("", 0U, 0U, 0U, 0U);
       }
 
       break;
     }
     case TYPE_IMMEDIATE_CONSTANT_BUFFER:
     {
-      v = s = ShaderVariable("", 0, 0, 0, 0);
+      s = ShaderVariable("", 0, 0, 0, 0);
 
       // if this Vec4f is entirely in the ICB
       if(indices[0] * 4 + 4 <= dxbc->m_Immediate.size())
@@ -978,26 +1067,14 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
     }
     case TYPE_INPUT_THREAD_GROUP_ID:
     {
-      v = s = ShaderVariable("vThreadGroupID", semantics.GroupID[0], semantics.GroupID[1],
-                             semantics.GroupID[2], (uint32_t)0);
+      s = ShaderVariable("vThreadGroupID", semantics.GroupID[0], semantics.GroupID[1],
+                         semantics.GroupID[2], (uint32_t)0);
 
       break;
     }
     case TYPE_INPUT_THREAD_ID:
     {
-      uint32_t numthreads[3] = {0, 0, 0};
-
-      for(size_t i = 0; i < dxbc->GetNumDeclarations(); i++)
-      {
-        const ASMDecl &decl = dxbc->GetDeclaration(i);
-
-        if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
-        {
-          numthreads[0] = decl.groupSize[0];
-          numthreads[1] = decl.groupSize[1];
-          numthreads[2] = decl.groupSize[2];
-        }
-      }
+      const uint32_t *numthreads = decoded->numthreads;
 
       RDCASSERT(numthreads[0] >= 1 && numthreads[0] <= 1024);
       RDCASSERT(numthreads[1] >= 1 && numthreads[1] <= 1024);
@@ -1013,26 +1090,14 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
     }
     case TYPE_INPUT_THREAD_ID_IN_GROUP:
     {
-      v = s = ShaderVariable("vThreadIDInGroup", semantics.ThreadID[0], semantics.ThreadID[1],
-                             semantics.ThreadID[2], (uint32_t)0);
+      s = ShaderVariable("vThreadIDInGroup", semantics.ThreadID[0], semantics.ThreadID[1],
+                         semantics.ThreadID[2], (uint32_t)0);
 
       break;
     }
     case TYPE_INPUT_THREAD_ID_IN_GROUP_FLATTENED:
     {
-      uint32_t numthreads[3] = {0, 0, 0};
-
-      for(size_t i = 0; i < dxbc->GetNumDeclarations(); i++)
-      {
-        const ASMDecl &decl = dxbc->GetDeclaration(i);
-
-        if(decl.declaration == OPCODE_DCL_THREAD_GROUP)
-        {
-          numthreads[0] = decl.groupSize[0];
-          numthreads[1] = decl.groupSize[1];
-          numthreads[2] = decl.groupSize[2];
-        }
-      }
+      const uint32_t *numthreads = decoded->numthreads;
 
       RDCASSERT(numthreads[0] >= 1 && numthreads[0] <= 1024);
       RDCASSERT(numthreads[1] >= 1 && numthreads[1] <= 1024);
@@ -1042,31 +1107,33 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
       uint32_t flattened = semantics.ThreadID[2] * numthreads[0] * numthreads[1] +
                            semantics.ThreadID[1] * numthreads[0] + semantics.ThreadID[0];
 
-      v = s = ShaderVariable("vThreadIDInGroupFlattened", flattened, flattened, flattened, flattened);
+      s = ShaderVariable("vThreadIDInGroupFlattened", flattened, flattened, flattened, flattened);
       break;
     }
     case TYPE_INPUT_COVERAGE_MASK:
     {
-      v = s = ShaderVariable("vCoverage", semantics.coverage, semantics.coverage,
-                             semantics.coverage, semantics.coverage);
+      s = ShaderVariable("vCoverage", semantics.coverage, semantics.coverage, semantics.coverage,
+                         semantics.coverage);
       break;
     }
     case TYPE_INPUT_PRIMITIVEID:
     {
-      v = s = ShaderVariable("vPrimitiveID", semantics.primID, semantics.primID, semantics.primID,
-                             semantics.primID);
+      s = ShaderVariable("vPrimitiveID", semantics.primID, semantics.primID, semantics.primID,
+                         semantics.primID);
       break;
     }
     default:
     {
       RDCERR("Currently unsupported operand type %d!", oper.type);
 
-      v = s = ShaderVariable("vUnsupported", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
+      s = ShaderVariable("vUnsupported", (uint32_t)0, (uint32_t)0, (uint32_t)0, (uint32_t)0);
 
       break;
     }
   }
 
+  CopyVariableValue(v, s);
+
   // perform swizzling
   v.value.uv[0] = s.value.uv[oper.comps[0] == 0xff ? 0 : oper.comps[0]];
   v.value.uv[1] = s.value.uv[oper.comps[1] == 0xff ? 1 : oper.comps[1]];
@@ -1093,21 +1160,32 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
 
 State State::GetNext(GlobalState &global, State quad[4]) const
 {
-  State s = *this;
+  State ret;
+  GetNext(global, quad, ret);
+  return ret;
+}
+
+void State::GetNext(GlobalState &global, State quad[4], State &s) const
+{
+  RDCASSERT(&s != this);
+
+  s.CopyFrom(*this);
 
   if(s.nextInstruction >= s.dxbc->GetNumInstructions())
-    return s;
+    return;
 
   const ASMOperation &op = s.dxbc->GetInstruction((size_t)s.nextInstruction);
+  const GlobalState::DecodedShader::Operation &decodedOp = decoded->ops[s.nextInstruction];
 
   s.nextInstruction++;
   s.flags = 0;
 
-  vector<ShaderVariable> srcOpers;
+  size_t numOperands = decodedOp.numOperands;
 
-  size_t numOperands = s.dxbc->NumOperands(op.operation);
+  VarType optype = decodedOp.type;
 
-  VarType optype = OperationType(op.operation);
+  vector<ShaderVariable> srcOpers;
+  srcOpers.reserve(numOperands);
 
   RDCASSERT(op.operands.size() == numOperands);
 
@@ -1758,7 +1836,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create constant buf %08x", hr);
-        return s;
+        return;
       }
 
       context->CSSetConstantBuffers(0, 1, &constBuf);
@@ -1784,7 +1862,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create UAV buf %08x", hr);
-        return s;
+        return;
       }
 
       bdesc.BindFlags = 0;
@@ -1796,7 +1874,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create copy buf %08x", hr);
-        return s;
+        return;
       }
 
       D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -1812,7 +1890,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create uav %08x", hr);
-        return s;
+        return;
       }
 
       context->CSSetUnorderedAccessViews(0, 1, &uav, NULL);
@@ -1826,7 +1904,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to map results %08x", hr);
-        return s;
+        return;
       }
 
       ShaderVariable calcResultA("calcA", 0.0f, 0.0f, 0.0f, 0.0f);
@@ -3682,7 +3760,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 
           s.SetDst(op.operands[0], op, fetch);
 
-          return s;
+          return;
         }
         if(decl.declaration == OPCODE_DCL_RESOURCE && decl.operand.type == TYPE_RESOURCE &&
            decl.operand.indices.size() == 1 && decl.operand.indices[0] == op.operands[2].indices[0])
@@ -4294,7 +4372,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create RT tex %08x", hr);
-        return s;
+        return;
       }
 
       tdesc.BindFlags = 0;
@@ -4306,7 +4384,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create copy tex %08x", hr);
-        return s;
+        return;
       }
 
       D3D11_RENDER_TARGET_VIEW_DESC rtDesc;
@@ -4320,7 +4398,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to create rt rtv %08x", hr);
-        return s;
+        return;
       }
 
       context->OMSetRenderTargetsAndUnorderedAccessViews(1, &rtv, NULL, 0, 0, NULL, NULL);
@@ -4334,7 +4412,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       if(FAILED(hr))
       {
         RDCERR("Failed to map results %08x", hr);
-        return s;
+        return;
       }
 
       ShaderVariable lookupResult("tex", 0.0f, 0.0f, 0.0f, 0.0f);
@@ -4624,8 +4702,6 @@ State State::GetNext(GlobalState &global, State quad[4]) const
       break;
     }
   }
-
-  return s;
 }
 
 };    // namespace ShaderDebug
@@ -112,6 +112,27 @@ public:
   };
 
   vector<groupsharedMem> groupshared;
+
+  // information about the shader being debugged that is needed on every step. This is decoded
+  // once up front so that executing an instruction doesn't walk the declarations, cbuffer list
+  // or opcode tables each time.
+  struct DecodedShader
+  {
+    DecodedShader() { numthreads[0] = numthreads[1] = numthreads[2] = 0; }
+    struct Operation
+    {
+      VarType type;
+      uint32_t numOperands;
+    };
+
+    // indexed by instruction
+    vector<Operation> ops;
+
+    // indexed by cbuffer register, the index of the cbuffer in the reflection data or -1
+    vector<int32_t> cbufferIndex;
+
+    uint32_t numthreads[3];
+  } decoded;
 };
 
 class State : public ShaderDebugState
@@ -126,9 +147,11 @@ public:
     trace = NULL;
     dxbc = NULL;
     device = NULL;
+    decoded = NULL;
     RDCEraseEl(semantics);
   }
-  State(int quadIdx, const ShaderDebugTrace *t, DXBC::DXBCFile *f, WrappedID3D11Device *d)
+  State(int quadIdx, const ShaderDebugTrace *t, DXBC::DXBCFile *f, const GlobalState &global,
+        WrappedID3D11Device *d)
   {
     quadIndex = quadIdx;
     nextInstruction = 0;
@@ -137,6 +160,7 @@ public:
     trace = t;
     dxbc = f;
     device = d;
+    decoded = &global.decoded;
     RDCEraseEl(semantics);
   }
 
@@ -159,8 +183,18 @@ public:
   void Init();
   bool Finished() const;
 
+  // decodes the shader into global.decoded, for use by any states stepped with that global state
+  static void Decode(DXBC::DXBCFile *dxbc, GlobalState &global);
+
   State GetNext(GlobalState &global, State quad[4]) const;
 
+  // as above, but writes the next state into an existing state which must not be this one or
+  // any state in the quad. Stepping between two states this way re-uses their register storage
+  void GetNext(GlobalState &global, State quad[4], State &next) const;
+
+  // copies all state from o, only copying register values when the register files match
+  void CopyFrom(const State &o);
+
 private:
   // index in the pixel quad
   int quadIndex;
@@ -185,9 +219,10 @@ private:
   ShaderVariable DDY(bool fine, State quad[4], const DXBC::ASMOperand &oper,
                      const DXBC::ASMOperation &op) const;
 
-  VarType OperationType(const DXBC::OpcodeType &op) const;
+  static VarType OperationType(const DXBC::OpcodeType &op);
 
   DXBC::DXBCFile *dxbc;
+  const GlobalState::DecodedShader *decoded;
   const ShaderDebugTrace *trace;
   WrappedID3D11Device *device;
 };
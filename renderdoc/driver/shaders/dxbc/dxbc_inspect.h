@@ -369,10 +369,28 @@ public:
     return m_Disassembly;
   }
 
-  size_t GetNumDeclarations() { return m_Declarations.size(); }
-  const ASMDecl &GetDeclaration(size_t i) { return m_Declarations[i]; }
-  size_t GetNumInstructions() { return m_Instructions.size(); }
-  const ASMOperation &GetInstruction(size_t i) { return m_Instructions[i]; }
+  // the bytecode is only decoded into declarations and instructions on first access, so that
+  // shaders which are only ever reflected don't pay for disassembly.
+  size_t GetNumDeclarations()
+  {
+    EnsureDisassembled();
+    return m_Declarations.size();
+  }
+  const ASMDecl &GetDeclaration(size_t i)
+  {
+    EnsureDisassembled();
+    return m_Declarations[i];
+  }
+  size_t GetNumInstructions()
+  {
+    EnsureDisassembled();
+    return m_Instructions.size();
+  }
+  const ASMOperation &GetInstruction(size_t i)
+  {
+    EnsureDisassembled();
+    return m_Instructions[i];
+  }
   size_t NumOperands(OpcodeType op);
 
   static void GetHash(uint32_t hash[4], const void *ByteCode, size_t BytecodeLength);
@@ -385,6 +403,11 @@ private:
   DXBCFile &operator=(const DXBCFile &o);
 
   void FetchTypeVersion();
+  void EnsureDisassembled()
+  {
+    if(!m_Disassembled)
+      DisassembleHexDump();
+  }
   void DisassembleHexDump();
   void MakeDisassemblyString();
   void GuessResources();
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <new>
 #include <string>
 #include <vector>
 #include "3rdparty/glslang/SPIRV/spirv.hpp"
@@ -84,13 +85,40 @@ struct SPVModule
   vector<SPVInstruction *> funcs;            // functions
   vector<SPVInstruction *> structs;          // struct types
 
+  // instructions and the type/op/constant/etc data hanging off them are placement-constructed
+  // into large pages owned by the module, instead of each being a separate heap allocation.
+  // They're destroyed together when the module is.
+  template <typename T>
+  T *Allocate()
+  {
+    return new(AllocateBytes(sizeof(T))) T();
+  }
+
   SPVInstruction *GetByID(uint32_t id);
   string Disassemble(const string &entryPoint);
 
   void MakeReflection(ShaderStageType stage, const string &entryPoint, ShaderReflection *reflection,
                       ShaderBindpointMapping *mapping);
+
+  // destroy all instructions and release the pages, leaving an empty module
+  void Clear();
+
+private:
+  // no copy semantics, the module owns the pages its instructions live in
+  SPVModule(const SPVModule &);
+  SPVModule &operator=(const SPVModule &);
+
+  void *AllocateBytes(size_t size);
+
+  vector<uint8_t *> m_Pages;
+  size_t m_PageOffset;
+
+  // disassembled text of each function in funcs, generated the first time it's needed
+  vector<string> m_FuncDisassembly;
 };
 
 string CompileSPIRV(SPIRVShaderStage shadType, const vector<string> &sources,
                     vector<uint32_t> &spirv);
+// identifies the compiler that CompileSPIRV uses, so cached output can be invalidated on upgrade
+string GetSPIRVCompilerVersion();
 void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module);
@@ -206,3 +206,12 @@ string CompileSPIRV(SPIRVShaderStage shadType, const std::vector<std::string> &s
 
   return errors;
 }
+
+string GetSPIRVCompilerVersion()
+{
+  string spirvVersion;
+  glslang::GetSpirvVersion(spirvVersion);
+
+  return StringFormat::Fmt("glslang %d SPIR-V %s", glslang::GetKhronosToolId(),
+                           spirvVersion.c_str());
+}
@@ -881,17 +881,26 @@ struct SPVInstruction
     source.col = source.line = 0;
   }
 
+  // the data is allocated from the module's pages, so only needs destructing here
   ~SPVInstruction()
   {
-    SAFE_DELETE(ext);
-    SAFE_DELETE(entry);
-    SAFE_DELETE(op);
-    SAFE_DELETE(flow);
-    SAFE_DELETE(type);
-    SAFE_DELETE(func);
-    SAFE_DELETE(block);
-    SAFE_DELETE(constant);
-    SAFE_DELETE(var);
+    Destroy(ext);
+    Destroy(entry);
+    Destroy(op);
+    Destroy(flow);
+    Destroy(type);
+    Destroy(func);
+    Destroy(block);
+    Destroy(constant);
+    Destroy(var);
+  }
+
+  template <typename T>
+  static void Destroy(T *&obj)
+  {
+    if(obj)
+      obj->~T();
+    obj = NULL;
   }
 
   spv::Op opcode;
@@ -2100,19 +2109,69 @@ static bool IsUnmodified(SPVFunction *func, SPVInstruction *from, SPVInstruction
   return ret;
 }
 
+// instruction data is small, so pages this size hold many hundreds of objects
+static const size_t SPVModulePageSize = 64 * 1024;
+
 SPVModule::SPVModule()
 {
   moduleVersion.major = moduleVersion.minor = 0;
   generator = 0;
   sourceVer = 0;
   sourceLang = spv::SourceLanguageUnknown;
+  m_PageOffset = SPVModulePageSize;
 }
 
 SPVModule::~SPVModule()
+{
+  Clear();
+}
+
+void SPVModule::Clear()
 {
   for(size_t i = 0; i < operations.size(); i++)
-    delete operations[i];
+    operations[i]->~SPVInstruction();
+
+  for(size_t i = 0; i < m_Pages.size(); i++)
+    delete[] m_Pages[i];
+
+  spirv.clear();
+  moduleVersion.major = moduleVersion.minor = 0;
+  generator = 0;
+  sourceVer = 0;
+  sourceLang = spv::SourceLanguageUnknown;
+  extensions.clear();
+  capabilities.clear();
   operations.clear();
+  ids.clear();
+  sourceexts.clear();
+  entries.clear();
+  globals.clear();
+  specConstants.clear();
+  funcs.clear();
+  structs.clear();
+
+  m_FuncDisassembly.clear();
+
+  m_Pages.clear();
+  m_PageOffset = SPVModulePageSize;
+}
+
+void *SPVModule::AllocateBytes(size_t size)
+{
+  // keep every allocation 16-byte aligned, enough for any of the instruction structs
+  size = AlignUp16(size);
+
+  RDCASSERT(size <= SPVModulePageSize);
+
+  if(m_PageOffset + size > SPVModulePageSize)
+  {
+    m_Pages.push_back(new uint8_t[SPVModulePageSize]);
+    m_PageOffset = 0;
+  }
+
+  void *ret = m_Pages.back() + m_PageOffset;
+  m_PageOffset += size;
+  return ret;
 }
 
 SPVInstruction *SPVModule::GetByID(uint32_t id)
@@ -2124,7 +2183,7 @@ SPVInstruction *SPVModule::GetByID(uint32_t id)
   // an ID, it won't be in our list so we have to add a dummy instruction for it
   RDCWARN("Expected to find ID %u but didn't - returning dummy instruction", id);
 
-  operations.push_back(new SPVInstruction());
+  operations.push_back(Allocate<SPVInstruction>());
   SPVInstruction &op = *operations.back();
   op.opcode = spv::OpUnknown;
   op.id = id;
@@ -2337,8 +2396,20 @@ string SPVModule::Disassemble(const string &entryPoint)
 
   retDisasm += "\n";
 
+  m_FuncDisassembly.resize(funcs.size());
+
   for(size_t f = 0; f < funcs.size(); f++)
   {
+    // the function disassembly modifies the instructions as it inlines them, so it must only
+    // be done once per function - after that re-use the text for any other entry point.
+    if(!m_FuncDisassembly[f].empty())
+    {
+      retDisasm += m_FuncDisassembly[f];
+      continue;
+    }
+
+    size_t funcStart = retDisasm.size();
+
     SPVFunction *func = funcs[f]->func;
     RDCASSERT(func && func->retType && func->funcType);
 
@@ -3433,6 +3504,8 @@ string SPVModule::Disassemble(const string &entryPoint)
     SAFE_DELETE_ARRAY(varDeclared);
 
     retDisasm += StringFormat::Fmt("} // %s\n\n", funcs[f]->str.c_str());
+
+    m_FuncDisassembly[f] = retDisasm.substr(funcStart);
   }
 
   return retDisasm;
@@ -4442,7 +4515,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
   {
     uint16_t WordCount = spirv[it] >> spv::WordCountShift;
 
-    module.operations.push_back(new SPVInstruction());
+    module.operations.push_back(module.Allocate<SPVInstruction>());
     SPVInstruction &op = *module.operations.back();
 
     op.opcode = spv::Op(spirv[it] & spv::OpCodeMask);
@@ -4508,7 +4581,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpEntryPoint:
       {
-        op.entry = new SPVEntryPoint();
+        op.entry = module.Allocate<SPVEntryPoint>();
         op.entry->func = spirv[it + 2];
         op.entry->model = spv::ExecutionModel(spirv[it + 1]);
         op.entry->name = (const char *)&spirv[it + 3];
@@ -4542,7 +4615,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpExtInstImport:
       {
-        op.ext = new SPVExtInstSet();
+        op.ext = module.Allocate<SPVExtInstSet>();
         op.ext->setname = (const char *)&spirv[it + 2];
         op.ext->canonicalNames = NULL;
 
@@ -4568,7 +4641,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       // Type opcodes
       case spv::OpTypeVoid:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eVoid;
 
         op.id = spirv[it + 1];
@@ -4577,7 +4650,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeBool:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eBool;
 
         op.id = spirv[it + 1];
@@ -4586,7 +4659,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeInt:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = spirv[it + 3] ? SPVTypeData::eSInt : SPVTypeData::eUInt;
         op.type->bitCount = spirv[it + 2];
 
@@ -4596,7 +4669,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeFloat:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eFloat;
         op.type->bitCount = spirv[it + 2];
 
@@ -4606,7 +4679,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeVector:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eVector;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4621,7 +4694,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeMatrix:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eMatrix;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4639,7 +4712,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeArray:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eArray;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4658,7 +4731,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeRuntimeArray:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eArray;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4673,7 +4746,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeStruct:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eStruct;
 
         for(int i = 2; i < WordCount; i++)
@@ -4694,7 +4767,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypePointer:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::ePointer;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 3]);
@@ -4709,7 +4782,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeImage:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eImage;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4732,7 +4805,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeSampler:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eSampler;
 
         op.id = spirv[it + 1];
@@ -4741,7 +4814,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeSampledImage:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eSampledImage;
 
         SPVInstruction *baseTypeInst = module.GetByID(spirv[it + 2]);
@@ -4755,7 +4828,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpTypeFunction:
       {
-        op.type = new SPVTypeData();
+        op.type = module.Allocate<SPVTypeData>();
         op.type->type = SPVTypeData::eFunction;
 
         for(int i = 3; i < WordCount; i++)
@@ -4788,7 +4861,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->specialized =
             (op.opcode == spv::OpSpecConstantTrue || op.opcode == spv::OpSpecConstantFalse);
         op.constant->type = typeInst->type;
@@ -4805,7 +4878,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->type = typeInst->type;
 
         op.constant->u32 = 0;
@@ -4820,7 +4893,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->specialized = op.opcode == spv::OpSpecConstant;
         op.constant->type = typeInst->type;
 
@@ -4847,7 +4920,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->specialized = op.opcode == spv::OpSpecConstantComposite;
         op.constant->type = typeInst->type;
 
@@ -4869,7 +4942,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->type = typeInst->type;
 
         op.constant->sampler.addressing = spv::SamplerAddressingMode(spirv[it + 3]);
@@ -4886,7 +4959,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.constant = new SPVConstant();
+        op.constant = module.Allocate<SPVConstant>();
         op.constant->specialized = true;
         op.constant->type = typeInst->type;
 
@@ -4915,7 +4988,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 4]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.func = new SPVFunction();
+        op.func = module.Allocate<SPVFunction>();
         op.func->retType = retTypeInst->type;
         op.func->funcType = typeInst->type;
         op.func->control = spv::FunctionControlMask(spirv[it + 3]);
@@ -4952,7 +5025,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.var = new SPVVariable();
+        op.var = module.Allocate<SPVVariable>();
         op.var->type = typeInst->type;
         op.var->storage = spv::StorageClass(spirv[it + 3]);
 
@@ -4977,7 +5050,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.var = new SPVVariable();
+        op.var = module.Allocate<SPVVariable>();
         op.var->type = typeInst->type;
         op.var->storage = spv::StorageClassFunction;
 
@@ -4992,7 +5065,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       // Branching/flow control
       case spv::OpLabel:
       {
-        op.block = new SPVBlock();
+        op.block = module.Allocate<SPVBlock>();
 
         RDCASSERT(curFunc);
 
@@ -5007,7 +5080,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       case spv::OpUnreachable:
       case spv::OpReturn:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         curBlock->exitFlow = &op;
         curBlock = NULL;
@@ -5015,7 +5088,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpReturnValue:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         op.flow->targets.push_back(spirv[it + 1]);
 
@@ -5025,7 +5098,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpBranch:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         op.flow->targets.push_back(spirv[it + 1]);
 
@@ -5035,7 +5108,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpBranchConditional:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         SPVInstruction *condInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(condInst);
@@ -5056,7 +5129,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpSwitch:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         SPVInstruction *condInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(condInst);
@@ -5083,7 +5156,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpSelectionMerge:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         op.flow->targets.push_back(spirv[it + 1]);
         op.flow->selControl = spv::SelectionControlMask(spirv[it + 2]);
@@ -5093,7 +5166,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       }
       case spv::OpLoopMerge:
       {
-        op.flow = new SPVFlowControl();
+        op.flow = module.Allocate<SPVFlowControl>();
 
         op.flow->targets.push_back(spirv[it + 1]);
         op.flow->loopControl = spv::LoopControlMask(spirv[it + 2]);
@@ -5108,7 +5181,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         SPVInstruction *ptrInst = module.GetByID(spirv[it + 3]);
@@ -5129,7 +5202,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       case spv::OpStore:
       case spv::OpCopyMemory:
       {
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = NULL;
 
         SPVInstruction *ptrInst = module.GetByID(spirv[it + 1]);
@@ -5153,7 +5226,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         for(int i = 3; i < WordCount; i += 2)
@@ -5182,7 +5255,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         SPVInstruction *imageInst = module.GetByID(spirv[it + 3]);
@@ -5289,7 +5362,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
           default: break;
         }
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
 
         if(op.opcode != spv::OpImageWrite)
         {
@@ -5534,7 +5607,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
 
         word++;
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
         op.op->mathop = mathop;
 
@@ -5573,7 +5646,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       {
         // these don't emit an ID, don't take a type, they are just
         // single operations
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = NULL;
 
         curBlock->instructions.push_back(&op);
@@ -5583,7 +5656,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       case spv::OpMemoryBarrier:
       {
         // these don't emit an ID, just have some properties
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = NULL;
 
         int word = 1;
@@ -5627,7 +5700,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         {
@@ -5658,7 +5731,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + 1]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         {
@@ -5693,7 +5766,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
         SPVInstruction *typeInst = module.GetByID(spirv[it + word]);
         RDCASSERT(typeInst && typeInst->type);
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
         op.op->type = typeInst->type;
 
         word++;
@@ -5746,7 +5819,7 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
       {
         int word = 1;
 
-        op.op = new SPVOperation();
+        op.op = module.Allocate<SPVOperation>();
 
         // all atomic operations but store return a new ID of a given type
         if(op.opcode != spv::OpAtomicStore)
@@ -1240,6 +1240,7 @@ string ToStrHelper<false, VkResourceType>::Get(const VkResourceType &el)
     TOSTR_CASE_STRINGIZE(eResSemaphore)
     TOSTR_CASE_STRINGIZE(eResSwapchain)
     TOSTR_CASE_STRINGIZE(eResSurface)
+    TOSTR_CASE_STRINGIZE(eResDescriptorUpdateTemplate)
     default: break;
   }
 
@@ -4652,6 +4653,62 @@ void Serialiser::Deserialise(const VkDescriptorSetLayoutCreateInfo *const el) co
   }
 }
 
+template <>
+void Serialiser::Serialise(const char *name, VkDescriptorUpdateTemplateEntryKHR &el)
+{
+  ScopedContext scope(this, name, "VkDescriptorUpdateTemplateEntryKHR", 0, true);
+
+  Serialise("dstBinding", el.dstBinding);
+  Serialise("dstArrayElement", el.dstArrayElement);
+  Serialise("descriptorCount", el.descriptorCount);
+  Serialise("descriptorType", el.descriptorType);
+
+  uint64_t offset = (uint64_t)el.offset;
+  uint64_t stride = (uint64_t)el.stride;
+  Serialise("offset", offset);
+  Serialise("stride", stride);
+  el.offset = (size_t)offset;
+  el.stride = (size_t)stride;
+}
+
+template <>
+void Serialiser::Serialise(const char *name, VkDescriptorUpdateTemplateCreateInfoKHR &el)
+{
+  ScopedContext scope(this, name, "VkDescriptorUpdateTemplateCreateInfoKHR", 0, true);
+
+  RDCASSERT(m_Mode < WRITING ||
+            el.sType == VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR);
+  // pNext is non-const in this version of the header
+  SerialiseNext(this, el.sType, (const void *&)el.pNext);
+
+  Serialise("flags", (VkFlagWithNoBits &)el.flags);
+  SerialiseComplexArray("pDescriptorUpdateEntries",
+                        (VkDescriptorUpdateTemplateEntryKHR *&)el.pDescriptorUpdateEntries,
+                        el.descriptorUpdateEntryCount);
+  Serialise("templateType", (uint32_t &)el.templateType);
+
+  // only descriptor set templates are supported, the pipeline layout and set are for push
+  // descriptors and are ignored
+  SerialiseObject(VkDescriptorSetLayout, "descriptorSetLayout", el.descriptorSetLayout);
+
+  if(m_Mode == READING)
+  {
+    el.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    el.pipelineLayout = VK_NULL_HANDLE;
+    el.set = 0;
+  }
+}
+
+template <>
+void Serialiser::Deserialise(const VkDescriptorUpdateTemplateCreateInfoKHR *const el) const
+{
+  if(m_Mode == READING)
+  {
+    RDCASSERT(el->pNext == NULL);    // otherwise delete
+    delete[] el->pDescriptorUpdateEntries;
+  }
+}
+
 template <>
 void Serialiser::Serialise(const char *name, VkComponentMapping &el)
 {
@@ -265,6 +265,10 @@ void Serialiser::Serialise(const char *name, VkDescriptorSetLayoutBinding &el);
 template <>
 void Serialiser::Serialise(const char *name, VkDescriptorSetLayoutCreateInfo &el);
 template <>
+void Serialiser::Serialise(const char *name, VkDescriptorUpdateTemplateEntryKHR &el);
+template <>
+void Serialiser::Serialise(const char *name, VkDescriptorUpdateTemplateCreateInfoKHR &el);
+template <>
 void Serialiser::Serialise(const char *name, VkDescriptorPoolCreateInfo &el);
 template <>
 void Serialiser::Serialise(const char *name, VkDescriptorSetAllocateInfo &el);
@@ -368,6 +372,8 @@ template <>
 void Serialiser::Deserialise(const VkWriteDescriptorSet *const el) const;
 template <>
 void Serialiser::Deserialise(const VkDescriptorSetLayoutCreateInfo *const el) const;
+template <>
+void Serialiser::Deserialise(const VkDescriptorUpdateTemplateCreateInfoKHR *const el) const;
 
 // the possible contents of a descriptor set slot,
 // taken from the VkWriteDescriptorSet
@@ -521,6 +527,11 @@ enum VulkanChunkType
   CONTEXT_CAPTURE_HEADER,
   CONTEXT_CAPTURE_FOOTER,
 
+  CREATE_DESCRIPTOR_UPDATE_TEMPLATE,
+  UPDATE_DESC_SET_WITH_TEMPLATE,
+
+  FRAME_BOUNDARY,
+
   NUM_VULKAN_CHUNKS,
 };
 
@@ -155,6 +155,11 @@ const char *VkChunkNames[] = {
     "Capture",
     "BeginCapture",
     "EndCapture",
+
+    "vkCreateDescriptorUpdateTemplateKHR",
+    "vkUpdateDescriptorSetWithTemplateKHR",
+
+    "vkQueuePresentKHR",
 };
 
 VkInitParams::VkInitParams()
@@ -170,6 +175,9 @@ VkInitParams::VkInitParams()
 // Here we list which non-current versions we support, and what changed
 const uint32_t VkInitParams::VK_OLD_VERSIONS[VkInitParams::VK_NUM_SUPPORTED_OLD_VERSIONS] = {
     0x0000005,    // from 0x5 to 0x6, we added serialisation of the original swapchain's imageUsage
+    0x0000006,    // from 0x6 to 0x7, we added serialisation of the semaphores in vkQueueSubmit
+    0x0000007,    // from 0x7 to 0x8, the capture footer stores any event timings recorded while
+                  // capturing
 };
 
 ReplayCreateStatus VkInitParams::Serialise()
@@ -264,12 +272,18 @@ WrappedVulkan::WrappedVulkan(const char *logFilename) : m_RenderState(&m_Creatio
   const bool debugSerialiser = true;
 #endif
 
+  m_CaptureHash = 0;
+
   if(RenderDoc::Inst().IsReplayApp())
   {
     m_State = READING;
     if(logFilename)
     {
       m_pSerialiser = new Serialiser(logFilename, Serialiser::READING, debugSerialiser);
+
+      m_CaptureHash = strhash(FileIO::GetFullPathname(logFilename).c_str());
+      m_CaptureHash = strhash(StringFormat::Fmt("%llu", m_pSerialiser->GetFileSize()).c_str(),
+                              m_CaptureHash);
     }
     else
     {
@@ -289,8 +303,23 @@ WrappedVulkan::WrappedVulkan(const char *logFilename) : m_RenderState(&m_Creatio
   m_Replay.SetDriver(this);
 
   m_FrameCounter = 0;
+  m_FrameRefEpoch = 0;
 
   m_AppControlledCapture = false;
+  m_CapSpanFrames = 0;
+  m_CapSpanWindow = NULL;
+
+  RDCEraseEl(m_InitStateBatch);
+
+  m_PartialCacheSkip = false;
+  m_PartialCacheStore = false;
+
+  m_ReplayPipelineCache = VK_NULL_HANDLE;
+  m_ReplayMemoryCategory = eReplayMemory_DebugResources;
+
+  m_InitStatePrepare.active = false;
+  m_InitStatePrepare.cmd = VK_NULL_HANDLE;
+  m_InitStatePrepare.recordedBytes = 0;
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
   tempMemoryTLSSlot = Threading::AllocateTLSSlot();
@@ -416,10 +445,10 @@ VkCommandBuffer WrappedVulkan::GetNextCmd()
   return ret;
 }
 
-void WrappedVulkan::SubmitCmds()
+void WrappedVulkan::SubmitCmds(VkFence fence)
 {
-  // nothing to do
-  if(m_InternalCmds.pendingcmds.empty())
+  // nothing to do. If a fence was passed it must still be signalled, so we do an empty submit
+  if(m_InternalCmds.pendingcmds.empty() && fence == VK_NULL_HANDLE)
     return;
 
   vector<VkCommandBuffer> cmds = m_InternalCmds.pendingcmds;
@@ -433,7 +462,7 @@ void WrappedVulkan::SubmitCmds()
       NULL,
       NULL,    // wait semaphores
       (uint32_t)cmds.size(),
-      &cmds[0],    // command buffers
+      cmds.empty() ? NULL : &cmds[0],    // command buffers
       0,
       NULL,    // signal semaphores
   };
@@ -443,7 +472,9 @@ void WrappedVulkan::SubmitCmds()
   // skip the submit
   if(m_Queue != VK_NULL_HANDLE)
   {
-    VkResult vkr = ObjDisp(m_Queue)->QueueSubmit(Unwrap(m_Queue), 1, &submitInfo, VK_NULL_HANDLE);
+    // the fence is an unwrapped handle, it's only used internally
+    VkResult vkr = ObjDisp(m_Queue)->QueueSubmit(Unwrap(m_Queue), cmds.empty() ? 0 : 1,
+                                                  &submitInfo, fence);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
   }
 
@@ -527,6 +558,89 @@ void WrappedVulkan::FlushQ()
   }
 }
 
+string WrappedVulkan::GetReplayPipelineCacheFilename()
+{
+  const VkPhysicalDeviceProperties &props = m_PhysicalDeviceData.props;
+
+  string uuid;
+  for(size_t i = 0; i < VK_UUID_SIZE; i++)
+    uuid += StringFormat::Fmt("%02x", props.pipelineCacheUUID[i]);
+
+  // the driver checks the cache header itself, but keeping each driver's data separately means
+  // switching between them doesn't throw away what the other had built up
+  return FileIO::GetAppFolderFilename(
+      StringFormat::Fmt("pipelinecache/vk_%04x_%04x_%08x_%s_%08x.bin", props.vendorID,
+                        props.deviceID, props.driverVersion, uuid.c_str(), m_CaptureHash));
+}
+
+void WrappedVulkan::CreateReplayPipelineCache()
+{
+  vector<byte> data;
+
+  string filename = GetReplayPipelineCacheFilename();
+
+  if(FileIO::slurp(filename.c_str(), data))
+    RDCLOG("Loaded %llu bytes of pipeline cache data from %s", (uint64_t)data.size(),
+           filename.c_str());
+
+  VkPipelineCacheCreateInfo cacheInfo = {
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, NULL, 0, data.size(),
+      data.empty() ? NULL : &data[0],
+  };
+
+  VkResult vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &cacheInfo, NULL,
+                                                        &m_ReplayPipelineCache);
+
+  // invalid data should just be ignored by the driver, but try again without it in case
+  if(vkr != VK_SUCCESS && !data.empty())
+  {
+    RDCWARN("Couldn't use pipeline cache data from %s, VkResult: 0x%08x", filename.c_str(), vkr);
+
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = NULL;
+
+    vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &cacheInfo, NULL,
+                                                 &m_ReplayPipelineCache);
+  }
+
+  if(vkr != VK_SUCCESS)
+  {
+    RDCERR("Failed to create replay pipeline cache, VkResult: 0x%08x", vkr);
+    m_ReplayPipelineCache = VK_NULL_HANDLE;
+  }
+}
+
+void WrappedVulkan::SaveReplayPipelineCache()
+{
+  if(m_ReplayPipelineCache == VK_NULL_HANDLE)
+    return;
+
+  size_t size = 0;
+  VkResult vkr =
+      ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache, &size, NULL);
+
+  if(vkr == VK_SUCCESS && size > 0)
+  {
+    vector<byte> data(size);
+
+    vkr = ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), m_ReplayPipelineCache, &size,
+                                                  &data[0]);
+
+    if(vkr == VK_SUCCESS)
+    {
+      string filename = GetReplayPipelineCacheFilename();
+
+      FileIO::CreateParentDirectory(filename);
+
+      if(!FileIO::dump(filename.c_str(), &data[0], size))
+        RDCWARN("Couldn't write pipeline cache data to %s", filename.c_str());
+    }
+  }
+
+  ObjDisp(m_Device)->DestroyPipelineCache(Unwrap(m_Device), m_ReplayPipelineCache, NULL);
+  m_ReplayPipelineCache = VK_NULL_HANDLE;
+}
+
 uint32_t WrappedVulkan::HandlePreCallback(VkCommandBuffer commandBuffer, DrawcallFlags type,
                                           uint32_t multiDrawOffset)
 {
@@ -766,6 +880,10 @@ static const VkExtensionProperties supportedExtensions[] = {
         VK_KHR_ANDROID_SURFACE_EXTENSION_NAME, VK_KHR_ANDROID_SURFACE_SPEC_VERSION,
     },
 #endif
+    {
+        VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME,
+        VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_SPEC_VERSION,
+    },
 #ifdef VK_KHR_display
     {
         VK_KHR_DISPLAY_EXTENSION_NAME, VK_KHR_DISPLAY_SPEC_VERSION,
@@ -1001,11 +1119,203 @@ void WrappedVulkan::Serialise_CaptureScope(uint64_t offset)
   }
 }
 
+void WrappedVulkan::BeginEventTimings(VkCommandBuffer commandBuffer)
+{
+  if(m_State < WRITING)
+    return;
+
+  VkResourceRecord *record = GetRecord(commandBuffer);
+  if(record == NULL)
+    return;
+
+  CmdBufferRecordingInfo *cmdInfo = record->cmdInfo;
+
+  cmdInfo->timingChunks.clear();
+  cmdInfo->timingActive = false;
+
+  // secondary command buffers can't reset the pool outside of a render pass, and their events
+  // only get IDs once they're executed, so only primary command buffers are timed.
+  if(!RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings ||
+     cmdInfo->allocInfo.level != VK_COMMAND_BUFFER_LEVEL_PRIMARY ||
+     !GetDeviceProps().limits.timestampComputeAndGraphics)
+    return;
+
+  VkDevice dev = cmdInfo->device;
+
+  if(cmdInfo->timingPool == VK_NULL_HANDLE)
+  {
+    VkQueryPoolCreateInfo poolInfo = {
+        VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, NULL, 0, VK_QUERY_TYPE_TIMESTAMP,
+        MaxEventTimings * 2, 0,
+    };
+
+    VkResult vkr =
+        ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &poolInfo, NULL, &cmdInfo->timingPool);
+    if(vkr != VK_SUCCESS)
+    {
+      RDCERR("Failed to create event timing query pool, VkResult: 0x%08x", vkr);
+      cmdInfo->timingPool = VK_NULL_HANDLE;
+      return;
+    }
+  }
+
+  ObjDisp(commandBuffer)
+      ->CmdResetQueryPool(Unwrap(commandBuffer), cmdInfo->timingPool, 0, MaxEventTimings * 2);
+
+  cmdInfo->timingActive = true;
+}
+
+void WrappedVulkan::BeginEventTiming(VkCommandBuffer commandBuffer)
+{
+  if(m_State < WRITING)
+    return;
+
+  VkResourceRecord *record = GetRecord(commandBuffer);
+  if(record == NULL || !record->cmdInfo->timingActive ||
+     record->cmdInfo->timingChunks.size() >= MaxEventTimings)
+    return;
+
+  // the event's chunk will be the next one added to the command buffer's record
+  uint32_t idx = (uint32_t)record->cmdInfo->timingChunks.size();
+  record->cmdInfo->timingChunks.push_back((uint32_t)record->NumChunks());
+
+  ObjDisp(commandBuffer)
+      ->CmdWriteTimestamp(Unwrap(commandBuffer), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                          record->cmdInfo->timingPool, idx * 2);
+}
+
+void WrappedVulkan::EndEventTiming(VkCommandBuffer commandBuffer)
+{
+  if(m_State < WRITING)
+    return;
+
+  VkResourceRecord *record = GetRecord(commandBuffer);
+  if(record == NULL || !record->cmdInfo->timingActive || record->cmdInfo->timingChunks.empty() ||
+     record->cmdInfo->timingChunks.back() != (uint32_t)record->NumChunks())
+    return;
+
+  uint32_t idx = (uint32_t)record->cmdInfo->timingChunks.size() - 1;
+
+  ObjDisp(commandBuffer)
+      ->CmdWriteTimestamp(Unwrap(commandBuffer), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                          record->cmdInfo->timingPool, idx * 2 + 1);
+}
+
+void WrappedVulkan::ResolveEventTimings(vector<ResourceId> &cmdIds, vector<uint32_t> &chunkIndices,
+                                        vector<uint64_t> &durations)
+{
+  VkDevice dev = GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  // a command buffer's pool only holds the timings from its most recent execution, so if it was
+  // submitted more than once in the frame only the last submission can be matched up.
+  vector<VkResourceRecord *> timed;
+  uint32_t dropped = 0;
+
+  {
+    SCOPED_LOCK(m_CmdBufferRecordsLock);
+
+    for(size_t i = m_CmdBufferRecords.size(); i > 0; i--)
+    {
+      VkResourceRecord *record = m_CmdBufferRecords[i - 1];
+
+      if(record->cmdInfo->timingChunks.empty())
+        continue;
+
+      bool dupe = false;
+      for(size_t t = 0; t < timed.size(); t++)
+        if(timed[t]->cmdInfo->timingPool == record->cmdInfo->timingPool)
+          dupe = true;
+
+      if(dupe)
+        dropped++;
+      else
+        timed.push_back(record);
+    }
+  }
+
+  if(!timed.empty())
+    vt->DeviceWaitIdle(Unwrap(dev));
+
+  const double period = GetDeviceProps().limits.timestampPeriod;
+
+  vector<uint64_t> results;
+
+  for(size_t t = 0; t < timed.size(); t++)
+  {
+    const CmdBufferRecordingInfo *cmdInfo = timed[t]->cmdInfo;
+    uint32_t count = (uint32_t)cmdInfo->timingChunks.size();
+
+    // each query is followed by its availability, in case the command buffer didn't run to the end
+    results.resize(count * 4);
+
+    VkResult vkr = vt->GetQueryPoolResults(
+        Unwrap(dev), cmdInfo->timingPool, 0, count * 2, results.size() * sizeof(uint64_t),
+        &results[0], sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    if(vkr != VK_SUCCESS && vkr != VK_NOT_READY)
+    {
+      RDCERR("Failed to read back event timings, VkResult: 0x%08x", vkr);
+      continue;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+      uint64_t start = results[i * 4 + 0], end = results[i * 4 + 2];
+
+      if(results[i * 4 + 1] == 0 || results[i * 4 + 3] == 0)
+        continue;
+
+      cmdIds.push_back(timed[t]->GetResourceID());
+      chunkIndices.push_back(cmdInfo->timingChunks[i]);
+      durations.push_back(end > start ? uint64_t(double(end - start) * period) : 0);
+    }
+  }
+
+  if(dropped > 0)
+    RDCWARN("Dropping event timings from %u earlier submissions of re-submitted command buffers",
+            dropped);
+
+  // the command buffers freed while capturing no longer need their pools
+  for(size_t i = 0; i < m_FreedTimingPools.size(); i++)
+    vt->DestroyQueryPool(Unwrap(dev), m_FreedTimingPools[i], NULL);
+  m_FreedTimingPools.clear();
+}
+
+void WrappedVulkan::FreeEventTimingPool(VkResourceRecord *cmdRecord)
+{
+  if(cmdRecord == NULL || cmdRecord->cmdInfo == NULL ||
+     cmdRecord->cmdInfo->timingPool == VK_NULL_HANDLE)
+    return;
+
+  VkDevice dev = cmdRecord->cmdInfo->device;
+  VkQueryPool pool = cmdRecord->cmdInfo->timingPool;
+  cmdRecord->cmdInfo->timingPool = VK_NULL_HANDLE;
+
+  // a submission in the frame being captured may still need its timings read back
+  {
+    SCOPED_LOCK(m_CapTransitionLock);
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_FreedTimingPools.push_back(pool);
+      return;
+    }
+  }
+
+  ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), pool, NULL);
+}
+
 void WrappedVulkan::EndCaptureFrame(VkImage presentImage)
 {
   // must use main serialiser here to match resource manager
   Serialiser *localSerialiser = GetMainSerialiser();
 
+  vector<ResourceId> timingCmds;
+  vector<uint32_t> timingChunks;
+  vector<uint64_t> timingDurations;
+  ResolveEventTimings(timingCmds, timingChunks, timingDurations);
+
   SCOPED_SERIALISE_CONTEXT(CONTEXT_CAPTURE_FOOTER);
 
   SERIALISE_ELEMENT(ResourceId, bbid, GetResID(presentImage));
@@ -1027,19 +1337,53 @@ void WrappedVulkan::EndCaptureFrame(VkImage presentImage)
     delete call;
   }
 
+  localSerialiser->Serialise("timingCmds", timingCmds);
+  localSerialiser->Serialise("timingChunks", timingChunks);
+  localSerialiser->Serialise("timingDurations", timingDurations);
+
   m_FrameCaptureRecord->AddChunk(scope.Get());
 }
 
+bool WrappedVulkan::Serialise_FrameBoundary(Serialiser *localSerialiser, VkImage presentImage)
+{
+  SERIALISE_ELEMENT(ResourceId, bbid, GetResID(presentImage));
+
+  // marks the end of one frame in a capture recording a run of them, so each frame's commands
+  // are separated in the event list
+  if(m_State == READING)
+  {
+    AddEvent("vkQueuePresentKHR()");
+
+    FetchDrawcall draw;
+    draw.name = "vkQueuePresentKHR()";
+    draw.flags |= eDraw_Present;
+
+    draw.copyDestination = bbid;
+
+    AddDrawcall(draw, true);
+  }
+
+  return true;
+}
+
 void WrappedVulkan::FirstFrame(VkSwapchainKHR swap)
 {
   SwapchainInfo *swapdesc = GetRecord(swap)->swapInfo;
+  void *wnd = swapdesc ? swapdesc->wndHandle : NULL;
 
   // if we have to capture the first frame, begin capturing immediately
-  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0))
+  uint32_t spanFrames = 0;
+  if(m_State == WRITING_IDLE && RenderDoc::Inst().ShouldTriggerCapture(0, spanFrames))
   {
-    RenderDoc::Inst().StartFrameCapture(LayerDisp(m_Instance), swapdesc ? swapdesc->wndHandle : NULL);
+    RenderDoc::Inst().StartFrameCapture(LayerDisp(m_Instance), wnd);
 
     m_AppControlledCapture = false;
+
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = wnd;
+    }
   }
 }
 
@@ -1128,6 +1472,11 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
 
   GetResourceManager()->ClearReferencedResources();
 
+  {
+    SCOPED_LOCK(m_DescSetFrameRefLock);
+    m_FrameRefEpoch++;
+  }
+
   GetResourceManager()->MarkResourceFrameReferenced(GetResID(m_Instance), eFrameRef_Read);
   GetResourceManager()->MarkResourceFrameReferenced(GetResID(m_Device), eFrameRef_Read);
   GetResourceManager()->MarkResourceFrameReferenced(GetResID(m_Queue), eFrameRef_Read);
@@ -1139,6 +1488,8 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
     SCOPED_LOCK(m_CapTransitionLock);
     GetResourceManager()->PrepareInitialContents();
 
+    ResetImageDiscards();
+
     RDCDEBUG("Attempting capture");
     m_FrameCaptureRecord->DeleteChunks();
 
@@ -1241,8 +1592,11 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
       SCOPED_LOCK(m_CoherentMapsLock);
       for(auto it = m_CoherentMaps.begin(); it != m_CoherentMaps.end(); ++it)
       {
-        Serialiser::FreeAlignedBuffer((*it)->memMapState->refData);
-        (*it)->memMapState->refData = NULL;
+        // writes are only tracked while capturing
+        WriteWatch::End((*it)->memMapState->writeWatch);
+        (*it)->memMapState->writeWatch = 0;
+
+        (*it)->memMapState->FreeRefData();
         (*it)->memMapState->needRefData = false;
       }
     }
@@ -1569,7 +1923,7 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     RDCDEBUG("Flushing %u command buffer records to file serialiser",
              (uint32_t)m_CmdBufferRecords.size());
 
-    map<int32_t, Chunk *> recordlist;
+    RecordChunkList recordlist;
 
     // ensure all command buffer records within the frame evne if recorded before, but
     // otherwise order must be preserved (vs. queue submits and desc set updates)
@@ -1586,17 +1940,17 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     RDCDEBUG("Flushing %u chunks to file serialiser from context record",
              (uint32_t)recordlist.size());
 
-    for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-      m_pFileSerialiser->Insert(it->second);
+    vector<Chunk *> sortedChunks;
+    recordlist.Merge(sortedChunks);
+
+    for(size_t i = 0; i < sortedChunks.size(); i++)
+      m_pFileSerialiser->Insert(sortedChunks[i]);
 
     RDCDEBUG("Done");
   }
 
-  m_pFileSerialiser->FlushToDisk();
-
-  RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-  SAFE_DELETE(m_pFileSerialiser);
+  RenderDoc::Inst().FinishCaptureWrite(m_pFileSerialiser, m_FrameCounter);
+  m_pFileSerialiser = NULL;
   SAFE_DELETE(m_HeaderChunk);
 
   m_State = WRITING_IDLE;
@@ -1731,6 +2085,8 @@ void WrappedVulkan::ReadLogInitialisation()
 
   m_pSerialiser->SetDebugText(false);
 
+  LogMemoryUsage(eMemScope_InitialContents);
+
   // ensure the capture at least created a device and fetched a queue.
   RDCASSERT(m_Device != VK_NULL_HANDLE && m_Queue != VK_NULL_HANDLE &&
             m_InternalCmds.cmdpool != VK_NULL_HANDLE);
@@ -1807,8 +2163,37 @@ void WrappedVulkan::ContextReplayLog(LogState readType, uint32_t startEventID, u
 
     ContextProcessChunk(offset, context);
 
+    // note which event each command buffer chunk was part of, for the captured event timings
+    if(m_State == READING && m_LastCmdBufferID != ResourceId() && context != END_CMD_BUFFER)
+    {
+      BakedCmdBufferInfo &cmdInfo = m_BakedCmdBufferInfo[m_LastCmdBufferID];
+      cmdInfo.chunkEventIDs.push_back(cmdInfo.curEventID);
+    }
+
     RenderDoc::Inst().SetProgress(FileInitialRead, float(offset) / float(m_pSerialiser->GetSize()));
 
+    if(m_PartialCacheSkip)
+    {
+      // vkBeginCommandBuffer picked up a cached partial command buffer, so jump straight past the
+      // rest of its chunks and restore what processing them would have done
+      const CachedPartialCmdBuffer &cached = m_PartialCmdCache.back();
+
+      m_pSerialiser->SetOffset(cached.endOffset);
+
+      m_RenderState = cached.renderState;
+      m_Partial[Primary].renderPassActive = cached.renderPassActive;
+      m_Partial[Primary].partialParent = ResourceId();
+      m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID = 0;
+
+      m_PartialCacheSkip = false;
+    }
+    else if(m_PartialCacheStore)
+    {
+      m_PartialCmdCache.back().endOffset = m_pSerialiser->GetOffset();
+
+      m_PartialCacheStore = false;
+    }
+
     // for now just abort after capture scope. Really we'd need to support multiple frames
     // but for now this will do.
     if(context == CONTEXT_CAPTURE_FOOTER)
@@ -1856,6 +2241,8 @@ void WrappedVulkan::ContextReplayLog(LogState readType, uint32_t startEventID, u
     m_ParentDrawcall.children.clear();
   }
 
+  ResetReplaySemaphores();
+
   ObjDisp(GetDev())->DeviceWaitIdle(Unwrap(GetDev()));
 
   // destroy any events we created for waiting on
@@ -1869,9 +2256,11 @@ void WrappedVulkan::ContextReplayLog(LogState readType, uint32_t startEventID, u
     if(m_Partial[p].resultPartialCmdBuffer != VK_NULL_HANDLE)
     {
       // deliberately call our own function, so this is destroyed as a wrapped object
-      vkFreeCommandBuffers(m_Partial[p].partialDevice, m_Partial[p].resultPartialCmdPool, 1,
-                           &m_Partial[p].resultPartialCmdBuffer);
+      if(!m_Partial[p].resultCached)
+        vkFreeCommandBuffers(m_Partial[p].partialDevice, m_Partial[p].resultPartialCmdPool, 1,
+                             &m_Partial[p].resultPartialCmdBuffer);
       m_Partial[p].resultPartialCmdBuffer = VK_NULL_HANDLE;
+      m_Partial[p].resultCached = false;
     }
   }
 
@@ -2082,6 +2471,14 @@ void WrappedVulkan::ProcessChunk(uint64_t offset, VulkanChunkType context)
     case UPDATE_DESC_SET:
       Serialise_vkUpdateDescriptorSets(GetMainSerialiser(), VK_NULL_HANDLE, 0, NULL, 0, NULL);
       break;
+    case CREATE_DESCRIPTOR_UPDATE_TEMPLATE:
+      Serialise_vkCreateDescriptorUpdateTemplateKHR(GetMainSerialiser(), VK_NULL_HANDLE, NULL, NULL,
+                                                    NULL);
+      break;
+    case UPDATE_DESC_SET_WITH_TEMPLATE:
+      Serialise_vkUpdateDescriptorSetWithTemplateKHR(GetMainSerialiser(), VK_NULL_HANDLE,
+                                                     VK_NULL_HANDLE, VK_NULL_HANDLE, NULL);
+      break;
 
     case BEGIN_CMD_BUFFER:
       Serialise_vkBeginCommandBuffer(GetMainSerialiser(), VK_NULL_HANDLE, NULL);
@@ -2298,6 +2695,40 @@ void WrappedVulkan::ProcessChunk(uint64_t offset, VulkanChunkType context)
         SAFE_DELETE_ARRAY(stack);
       }
 
+      if(GetLogVersion() >= 0x0000008)
+      {
+        vector<ResourceId> timingCmds;
+        vector<uint32_t> timingChunks;
+        vector<uint64_t> timingDurations;
+
+        localSerialiser->Serialise("timingCmds", timingCmds);
+        localSerialiser->Serialise("timingChunks", timingChunks);
+        localSerialiser->Serialise("timingDurations", timingDurations);
+
+        if(m_State == READING)
+        {
+          m_CapturedEventTimings.clear();
+
+          for(size_t i = 0; i < timingCmds.size() && i < timingChunks.size() &&
+                            i < timingDurations.size();
+              i++)
+          {
+            // the timings are from the command buffer's last submission in the frame
+            const vector<uint32_t> &submits = m_Partial[Primary].cmdBufferSubmits[timingCmds[i]];
+            const vector<uint32_t> &chunkEIDs = m_BakedCmdBufferInfo[timingCmds[i]].chunkEventIDs;
+
+            if(submits.empty() || timingChunks[i] >= chunkEIDs.size())
+              continue;
+
+            double seconds = double(timingDurations[i]) / 1000000000.0;
+
+            m_CapturedEventTimings.push_back(
+                CounterResult(submits.back() + chunkEIDs[timingChunks[i]],
+                              eCounter_CapturedGPUDuration, seconds));
+          }
+        }
+      }
+
       if(m_State == READING)
       {
         AddEvent("vkQueuePresentKHR()");
@@ -2312,6 +2743,7 @@ void WrappedVulkan::ProcessChunk(uint64_t offset, VulkanChunkType context)
       }
       break;
     }
+    case FRAME_BOUNDARY: Serialise_FrameBoundary(GetMainSerialiser(), VK_NULL_HANDLE); break;
     default:
     {
       // ignore system chunks
@@ -2715,6 +3147,31 @@ bool WrappedVulkan::InRerecordRange(ResourceId cmdid)
   return false;
 }
 
+bool WrappedVulkan::CanCachePartialCmd(ResourceId bakeId)
+{
+  // drawcall callbacks record their own work around each draw, and partial secondary command
+  // buffers are re-recorded separately, so only cache plain primary command buffers
+  if(m_DrawcallCallback)
+    return false;
+
+  VulkanDrawcallTreeNode *draw = m_BakedCmdBufferInfo[bakeId].draw;
+
+  return draw && draw->executedCmds.empty();
+}
+
+void WrappedVulkan::FreePartialCmdCache()
+{
+  for(size_t i = 0; i < m_PartialCmdCache.size(); i++)
+  {
+    CachedPartialCmdBuffer &cached = m_PartialCmdCache[i];
+
+    // same as the partial command buffers in ContextReplayLog
+    vkFreeCommandBuffers(cached.device, cached.pool, 1, &cached.cmd);
+  }
+
+  m_PartialCmdCache.clear();
+}
+
 VkCommandBuffer WrappedVulkan::RerecordCmdBuf(ResourceId cmdid, PartialReplayIndex partialType)
 {
   if(m_Partial[Primary].outsideCmdBuffer != VK_NULL_HANDLE)
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include "common/timing.h"
+#include "core/entry_profiler.h"
 #include "replay/replay_driver.h"
 #include "serialise/serialiser.h"
 #include "vk_common.h"
@@ -44,10 +45,10 @@ struct VkInitParams : public RDCInitParams
 
   void Set(const VkInstanceCreateInfo *pCreateInfo, ResourceId inst);
 
-  static const uint32_t VK_SERIALISE_VERSION = 0x0000006;
+  static const uint32_t VK_SERIALISE_VERSION = 0x0000008;
 
   // backwards compatibility for old logs described at the declaration of this array
-  static const uint32_t VK_NUM_SUPPORTED_OLD_VERSIONS = 1;
+  static const uint32_t VK_NUM_SUPPORTED_OLD_VERSIONS = 3;
   static const uint32_t VK_OLD_VERSIONS[VK_NUM_SUPPORTED_OLD_VERSIONS];
 
   // version number internal to vulkan stream
@@ -224,6 +225,11 @@ private:
   LogState m_State;
   bool m_AppControlledCapture;
 
+  // presents left in a run of frames being combined into this device's capture, only counted on
+  // the window the capture started on
+  uint32_t m_CapSpanFrames;
+  void *m_CapSpanWindow;
+
   uint64_t threadSerialiserTLSSlot;
 
   Threading::CriticalSection m_ThreadSerialisersLock;
@@ -255,11 +261,32 @@ private:
   Threading::CriticalSection m_CmdBufferRecordsLock;
   vector<VkResourceRecord *> m_CmdBufferRecords;
 
+  // the most events a command buffer can time, see CmdBufferRecordingInfo::timingPool
+  static const uint32_t MaxEventTimings = 1024;
+
+  // timing query pools of command buffers freed while capturing, kept until the frame's timings
+  // have been read back. Protected by m_CapTransitionLock
+  vector<VkQueryPool> m_FreedTimingPools;
+
+  void BeginEventTimings(VkCommandBuffer commandBuffer);
+  void BeginEventTiming(VkCommandBuffer commandBuffer);
+  void EndEventTiming(VkCommandBuffer commandBuffer);
+  void ResolveEventTimings(vector<ResourceId> &cmdIds, vector<uint32_t> &chunkIndices,
+                           vector<uint64_t> &durations);
+  void FreeEventTimingPool(VkResourceRecord *cmdRecord);
+
+  vector<CounterResult> m_CapturedEventTimings;
+
   VulkanResourceManager *m_ResourceManager;
   VulkanDebugManager *m_DebugManager;
 
   Threading::CriticalSection m_CapTransitionLock;
 
+  // incremented at the start of each capture, for descriptor sets to tell if they've already been
+  // marked referenced in this capture. See DescriptorSetData::bindFrameRefGen
+  uint32_t m_FrameRefEpoch;
+  Threading::CriticalSection m_DescSetFrameRefLock;
+
   VulkanDrawcallCallback *m_DrawcallCallback;
 
   // util function to handle fetching the right eventID, calling any
@@ -376,9 +403,96 @@ private:
     // -> FlushQ() ----back to freesems-------^
   } m_InternalCmds;
 
+  // while Apply_InitialStates is applying every resource's initial contents, their copies are all
+  // recorded into one command buffer instead of one each, and waiting for sparse binds to finish
+  // is done once at the end
+  struct
+  {
+    bool active;
+    VkCommandBuffer cmd;
+    bool sparseBound;
+  } m_InitStateBatch;
+
+  VkCommandBuffer BeginInitialStateCmd();
+  void EndInitialStateCmd(VkCommandBuffer cmd);
+  void FlushInitialStateBatch();
+
+  // while the resource manager is preparing initial contents, the readback copies are recorded
+  // into shared command buffers and only waited on once at the end. The temporary buffers and
+  // images they copy through can't be destroyed until then.
+  struct
+  {
+    bool active;
+    VkCommandBuffer cmd;
+    VkDeviceSize recordedBytes;
+    vector<VkBuffer> bufDeletes;
+    vector<VkImage> imageDeletes;
+    vector<VkDeviceMemory> memDeletes;
+  } m_InitStatePrepare;
+
+  VkCommandBuffer BeginPrepareCmd();
+  void EndPrepareCmd(VkDeviceSize copiedBytes);
+  void SubmitPrepareCmd();
+  void ReleasePrepareTemporaries();
+
+  // sparse resources never become clean, so every capture reads back all the memory bound to them.
+  // Instead each one keeps its readback memory from the last capture and only memory objects that
+  // have been written since are copied into it again. Snapshots not used by a capture are freed
+  // at the end of its prepare.
+  struct SparseSnapshotMem
+  {
+    ResourceId memId;
+    VkDeviceSize length;
+    bool stale;
+  };
+
+  struct SparseSnapshot
+  {
+    VkDeviceMemory readbackmem;    // wrapped, handed out as the initial contents resource
+    VkDeviceSize size;
+    uint32_t epoch;
+    vector<SparseSnapshotMem> mems;
+  };
+
+  map<ResourceId, SparseSnapshot> m_SparseSnapshots;
+  // memory ID -> the sparse resources whose snapshot contains it
+  map<ResourceId, vector<ResourceId> > m_SparseSnapshotWatch;
+  Threading::CriticalSection m_SparseSnapshotLock;
+
+  VkDeviceMemory ReadbackSparseMemory(ResourceId id, map<VkDeviceMemory, VkDeviceSize> &boundMems,
+                                      VkDeviceSize &totalSize);
+  void MarkSparseMemoryStale(ResourceId memId);
+  void FreeSparseSnapshot(ResourceId id);
+  void TrimSparseSnapshots();
+  void ReleaseSparseSnapshots();
+
   vector<VkDeviceMemory> m_CleanupMems;
   vector<VkEvent> m_CleanupEvents;
 
+  // on replay, the semaphores signalled by replayed submits that nothing has waited on yet. Waits
+  // on these are replayed as-is so that work on different queues overlaps the same way it did when
+  // captured, and anything left over is waited on at the end of the replay so that the next replay
+  // starts with everything unsignalled.
+  std::set<VkSemaphore> m_ReplaySignalledSems;
+  // storage for the unwrapped semaphores of the submit currently being replayed
+  vector<VkSemaphore> m_ReplayWaitSems, m_ReplaySignalSems;
+  vector<VkPipelineStageFlags> m_ReplayWaitStages;
+
+  void PatchReplaySemaphores(VkSubmitInfo &submitInfo, const vector<ResourceId> &waitSems,
+                             const vector<VkPipelineStageFlags> &waitStages,
+                             const vector<ResourceId> &signalSems);
+  void ResetReplaySemaphores();
+
+  // on replay every pipeline is created through this cache, which is saved to disk on shutdown and
+  // loaded again next time the same capture is opened on the same driver. Not wrapped.
+  VkPipelineCache m_ReplayPipelineCache;
+  // identifies the capture being replayed, for the pipeline cache filename
+  uint32_t m_CaptureHash;
+
+  string GetReplayPipelineCacheFilename();
+  void CreateReplayPipelineCache();
+  void SaveReplayPipelineCache();
+
   const VkPhysicalDeviceProperties &GetDeviceProps() { return m_PhysicalDeviceData.props; }
   VkDriverInfo GetDriverVersion() { return VkDriverInfo(m_PhysicalDeviceData.props); }
   const VkFormatProperties &GetFormatProperties(VkFormat f)
@@ -390,6 +504,53 @@ private:
   uint32_t GetUploadMemoryIndex(uint32_t resourceRequiredBitmask);
   uint32_t GetGPULocalMemoryIndex(uint32_t resourceRequiredBitmask);
 
+  // on replay, memory for our own resources that all live as long as each other is packed into a
+  // few large blocks per scope instead of one allocation per resource. It can only be freed as a
+  // whole scope.
+  enum MemoryScope
+  {
+    eMemScope_InitialContents,
+    eMemScope_Count,
+  };
+
+  enum MemoryType
+  {
+    eMemType_GPULocal,
+    eMemType_Upload,
+    eMemType_Readback,
+  };
+
+  struct MemoryAllocation
+  {
+    VkDeviceMemory mem;
+    VkDeviceSize offs;
+    VkDeviceSize size;
+  };
+
+  MemoryAllocation AllocateMemoryForResource(bool buffer, const VkMemoryRequirements &mrq,
+                                             MemoryScope scope, MemoryType type);
+  void FreeAllMemory(MemoryScope scope);
+  void LogMemoryUsage(MemoryScope scope);
+
+  struct MemoryBlock
+  {
+    VkDeviceMemory mem;
+    uint32_t memoryTypeIndex;
+    VkDeviceSize size;
+    VkDeviceSize used;
+    // whether the last allocation packed in was a buffer or an image, for bufferImageGranularity
+    bool lastBuffer;
+  };
+
+  vector<MemoryBlock> m_MemoryBlocks[eMemScope_Count];
+  Threading::CriticalSection m_MemoryBlocksLock;
+
+  // on replay, the size of every device memory allocation and the category it's reported under
+  // by GetReplayMemoryUsage. The capture's own allocations are capture resources, anything we
+  // allocate through vkAllocateMemory goes under m_ReplayMemoryCategory.
+  map<ResourceId, pair<ReplayMemoryCategory, VkDeviceSize> > m_ReplayAllocations;
+  ReplayMemoryCategory m_ReplayMemoryCategory;
+
   struct BakedCmdBufferInfo
   {
     BakedCmdBufferInfo()
@@ -438,6 +599,10 @@ private:
     uint32_t eventCount;             // how many events are in this cmd buffer, for quick skipping
     uint32_t curEventID;             // current event ID while reading or executing
     uint32_t drawCount;              // similar to above
+
+    // the event ID relative to the command buffer of each of its chunks, as it's read, to match up
+    // the timings recorded at capture time with the events they were recorded around.
+    vector<uint32_t> chunkEventIDs;
   };
 
   // on replay, the current command buffer for the last chunk we
@@ -482,6 +647,7 @@ private:
       partialParent = ResourceId();
       baseEvent = 0;
       renderPassActive = false;
+      resultCached = false;
     }
 
     // if we're doing a partial replay, by definition only one command
@@ -533,10 +699,48 @@ private:
     // reach the vkEndCommandBuffer that we also need to end a render
     // pass.
     bool renderPassActive;
+
+    // if the partial command buffer is held in m_PartialCmdCache, it isn't freed after the replay
+    bool resultCached;
   } m_Partial[ePartialNum];
 
   map<ResourceId, VkCommandBuffer> m_RerecordCmds;
 
+  // a primary command buffer partially re-recorded on a previous replay, kept so that replaying up
+  // to the same event again can submit it as it is. Its chunks are skipped entirely, and the state
+  // processing them would have left behind is restored instead.
+  struct CachedPartialCmdBuffer
+  {
+    CachedPartialCmdBuffer(VulkanCreationInfo *createInfo) : renderState(createInfo) {}
+    ResourceId bakeId;
+    uint32_t baseEvent;
+    uint32_t lastEvent;
+
+    VkDevice device;
+    VkCommandPool pool;
+    VkCommandBuffer cmd;
+
+    // where the chunks after its vkEndCommandBuffer start
+    uint64_t endOffset;
+
+    bool renderPassActive;
+    VulkanRenderState renderState;
+  };
+
+  static const size_t MaxCachedPartialCmdBuffers = 16;
+
+  // least recently used first
+  vector<CachedPartialCmdBuffer> m_PartialCmdCache;
+
+  // set while processing a begin/end command buffer chunk, for the replay loop to skip past the
+  // chunks of the cached command buffer at the back, or fill in where the chunks of the one just
+  // added end
+  bool m_PartialCacheSkip;
+  bool m_PartialCacheStore;
+
+  bool CanCachePartialCmd(ResourceId bakeId);
+  void FreePartialCmdCache();
+
   // There is only a state while currently partially replaying, it's
   // undefined/empty otherwise.
   // All IDs are original IDs, not live.
@@ -570,7 +774,7 @@ private:
 
   // used both on capture and replay side to track image layouts. Only locked
   // in capture
-  map<ResourceId, ImageLayouts> m_ImageLayouts;
+  ImageLayoutMap m_ImageLayouts;
   Threading::CriticalSection m_ImageLayoutsLock;
 
   // find swapchain for an image
@@ -602,6 +806,7 @@ private:
   bool HasSuccessfulCapture();
   bool Serialise_BeginCaptureFrame(bool applyInitialState);
   void EndCaptureFrame(VkImage presentImage);
+  bool Serialise_FrameBoundary(Serialiser *localSerialiser, VkImage presentImage);
 
   void FirstFrame(VkSwapchainKHR swap);
 
@@ -610,6 +815,17 @@ private:
   void MakeSubpassLoadRP(VkRenderPassCreateInfo &info, const VkRenderPassCreateInfo *origInfo,
                          uint32_t s);
 
+  void ReplayDescriptorSetWrite(VkDevice device, const VkWriteDescriptorSet &writeDesc);
+  void TrackDescriptorSetWrites(uint32_t writeCount, const VkWriteDescriptorSet *pDescriptorWrites);
+  void MarkDescSetReferenced(VkResourceRecord *setrecord);
+
+  // discarded image contents don't need to be saved as initial contents, see vk_initstate.cpp
+  void RecordImageDiscard(VkResourceRecord *cmdRecord, ResourceId image,
+                          const VkImageSubresourceRange &range);
+  void ApplyImageDiscards(const vector<pair<ResourceId, VkImageSubresourceRange> > &discards);
+  void ResetImageDiscards();
+  void ZeroDiscardedSubresources(ResourceId id, byte *data, size_t dataSize);
+
   bool IsDrawInRenderPass();
 
   void StartFrameCapture(void *dev, void *wnd);
@@ -698,12 +914,32 @@ public:
   VulkanReplay *GetReplay() { return &m_Replay; }
   // replay interface
   bool Prepare_InitialState(WrappedVkRes *res);
+  void BeginPrepare_InitialStates();
+  void EndPrepare_InitialStates();
   bool Serialise_InitialState(ResourceId resid, WrappedVkRes *res);
+  bool IsImageDiscarded(ResourceId id);
   void Create_InitialState(ResourceId id, WrappedVkRes *live, bool hasData);
   void Apply_InitialState(WrappedVkRes *live, VulkanResourceManager::InitialContentData initial);
+  void Apply_InitialStates(const VulkanResourceManager::InitialContentList &states);
 
   bool ReleaseResource(WrappedVkRes *res);
 
+  // bytes of device memory allocated on replay for category
+  uint64_t GetReplayMemoryUsage(ReplayMemoryCategory category);
+  VkDeviceSize GetReplayAllocationSize(VkDeviceMemory mem);
+  // sets the category our own allocations are counted against, and returns the previous one
+  ReplayMemoryCategory SetReplayMemoryCategory(ReplayMemoryCategory category)
+  {
+    ReplayMemoryCategory prev = m_ReplayMemoryCategory;
+    m_ReplayMemoryCategory = category;
+    return prev;
+  }
+
+  // called wherever a resource is marked dirty, to invalidate readback data kept for sparse
+  // resources. See m_SparseSnapshots
+  void MarkSparseSnapshotsStale(ResourceId id);
+  bool IsSparseSnapshotMemory(WrappedVkRes *res);
+
   ReplayCreateStatus Initialise(VkInitParams &params);
   uint32_t GetLogVersion() { return m_InitParams.SerialiseVersion; }
   void Shutdown();
@@ -713,6 +949,7 @@ public:
   FetchFrameRecord &GetFrameRecord() { return m_FrameRecord; }
   FetchAPIEvent GetEvent(uint32_t eventID);
   uint32_t GetMaxEID() { return m_Events.back().eventID; }
+  const vector<CounterResult> &GetCapturedEventTimings() { return m_CapturedEventTimings; }
   const FetchDrawcall *GetDrawcall(uint32_t eventID);
 
   vector<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
@@ -739,7 +976,7 @@ public:
     return m_PhysicalDevice;
   }
   VkCommandBuffer GetNextCmd();
-  void SubmitCmds();
+  void SubmitCmds(VkFence fence = VK_NULL_HANDLE);
   VkSemaphore GetNextSemaphore();
   void SubmitSemaphores();
   void FlushQ();
@@ -1052,6 +1289,22 @@ public:
                                 uint32_t descriptorCopyCount,
                                 const VkCopyDescriptorSet *pDescriptorCopies);
 
+  // VK_KHR_descriptor_update_template functions
+
+  IMPLEMENT_FUNCTION_SERIALISED(VkResult, vkCreateDescriptorUpdateTemplateKHR, VkDevice device,
+                                const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo,
+                                const VkAllocationCallbacks *pAllocator,
+                                VkDescriptorUpdateTemplateKHR *pDescriptorUpdateTemplate);
+
+  IMPLEMENT_FUNCTION_SERIALISED(void, vkDestroyDescriptorUpdateTemplateKHR, VkDevice device,
+                                VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate,
+                                const VkAllocationCallbacks *pAllocator);
+
+  IMPLEMENT_FUNCTION_SERIALISED(void, vkUpdateDescriptorSetWithTemplateKHR, VkDevice device,
+                                VkDescriptorSet descriptorSet,
+                                VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate,
+                                const void *pData);
+
   // Command pool functions
 
   IMPLEMENT_FUNCTION_SERIALISED(void, vkGetRenderAreaGranularity, VkDevice device,
@@ -1522,3 +1775,18 @@ public:
   VkResult vkGetSemaphoreFdKHX(VkDevice device, VkSemaphore semaphore,
                                VkExternalSemaphoreHandleTypeFlagBitsKHX handleType, int *pFd);
 };
+
+// counts our own replay allocations made while this is in scope against a category
+class ScopedReplayMemoryCategory
+{
+public:
+  ScopedReplayMemoryCategory(WrappedVulkan *driver, ReplayMemoryCategory category)
+      : m_pDriver(driver)
+  {
+    m_Prev = m_pDriver->SetReplayMemoryCategory(category);
+  }
+  ~ScopedReplayMemoryCategory() { m_pDriver->SetReplayMemoryCategory(m_Prev); }
+private:
+  WrappedVulkan *m_pDriver;
+  ReplayMemoryCategory m_Prev;
+};
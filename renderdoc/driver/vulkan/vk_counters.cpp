@@ -71,6 +71,9 @@ vector<uint32_t> VulkanReplay::EnumerateCounters()
     ret.push_back(eCounter_CSInvocations);
   }
 
+  if(!m_pDriver->GetCapturedEventTimings().empty())
+    ret.push_back(eCounter_CapturedGPUDuration);
+
   return ret;
 }
 
@@ -172,6 +175,15 @@ void VulkanReplay::DescribeCounter(uint32_t counterID, CounterDescription &desc)
       desc.resultCompType = eCompType_UInt;
       desc.units = eUnits_Absolute;
       break;
+    case eCounter_CapturedGPUDuration:
+      desc.name = "Captured GPU Duration";
+      desc.description =
+          "Time taken for this event on the GPU while the application was being captured, as "
+          "measured by delta between two GPU timestamps recorded around it.";
+      desc.resultByteWidth = 8;
+      desc.resultCompType = eCompType_Double;
+      desc.units = eUnits_Seconds;
+      break;
     default:
       desc.name = "Unknown";
       desc.description = "Unknown counter ID";
@@ -202,14 +214,16 @@ struct VulkanGPUTimerCallback : public VulkanDrawcallCallback
                                   VK_QUERY_CONTROL_PRECISE_BIT);
     if(m_PipeStatsQueryPool != VK_NULL_HANDLE)
       ObjDisp(cmd)->CmdBeginQuery(Unwrap(cmd), m_PipeStatsQueryPool, (uint32_t)m_Results.size(), 0);
-    ObjDisp(cmd)->CmdWriteTimestamp(Unwrap(cmd), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                    m_TimeStampQueryPool, (uint32_t)(m_Results.size() * 2 + 0));
+    if(m_TimeStampQueryPool != VK_NULL_HANDLE)
+      ObjDisp(cmd)->CmdWriteTimestamp(Unwrap(cmd), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      m_TimeStampQueryPool, (uint32_t)(m_Results.size() * 2 + 0));
   }
 
   bool PostDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    ObjDisp(cmd)->CmdWriteTimestamp(Unwrap(cmd), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                    m_TimeStampQueryPool, (uint32_t)(m_Results.size() * 2 + 1));
+    if(m_TimeStampQueryPool != VK_NULL_HANDLE)
+      ObjDisp(cmd)->CmdWriteTimestamp(Unwrap(cmd), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                      m_TimeStampQueryPool, (uint32_t)(m_Results.size() * 2 + 1));
     if(m_OcclusionQueryPool != VK_NULL_HANDLE)
       ObjDisp(cmd)->CmdEndQuery(Unwrap(cmd), m_OcclusionQueryPool, (uint32_t)m_Results.size());
     if(m_PipeStatsQueryPool != VK_NULL_HANDLE)
@@ -249,6 +263,32 @@ struct VulkanGPUTimerCallback : public VulkanDrawcallCallback
 };
 
 vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counters)
+{
+  vector<CounterResult> ret;
+
+  // the captured timings are already known, so only the remaining counters need a replay
+  vector<uint32_t> replayCounters;
+
+  for(size_t i = 0; i < counters.size(); i++)
+  {
+    if(counters[i] == eCounter_CapturedGPUDuration)
+    {
+      const vector<CounterResult> &timings = m_pDriver->GetCapturedEventTimings();
+      ret.insert(ret.end(), timings.begin(), timings.end());
+    }
+    else
+    {
+      replayCounters.push_back(counters[i]);
+    }
+  }
+
+  if(!replayCounters.empty())
+    FetchReplayCounters(replayCounters, ret);
+
+  return ret;
+}
+
+void VulkanReplay::FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret)
 {
   uint32_t maxEID = m_pDriver->GetMaxEID();
 
@@ -256,6 +296,23 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
 
   VkDevice dev = m_pDriver->GetDev();
 
+  // only create the query pools that the requested counters need, pipeline statistics in
+  // particular aren't free to gather on every event.
+  bool needTimestamps = false, needOcclusion = false, needPipeStats = false;
+
+  for(size_t c = 0; c < counters.size(); c++)
+  {
+    if(counters[c] == eCounter_EventGPUDuration)
+      needTimestamps = true;
+    else if(counters[c] == eCounter_SamplesWritten)
+      needOcclusion = true;
+    else
+      needPipeStats = true;
+  }
+
+  needOcclusion &= (availableFeatures.occlusionQueryPrecise != VK_FALSE);
+  needPipeStats &= (availableFeatures.pipelineStatisticsQuery != VK_FALSE);
+
   VkQueryPoolCreateInfo timeStampPoolCreateInfo = {
       VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, NULL, 0, VK_QUERY_TYPE_TIMESTAMP, maxEID * 2, 0};
 
@@ -279,20 +336,25 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
       VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, NULL,   0,
       VK_QUERY_TYPE_PIPELINE_STATISTICS,        maxEID, pipeStatsFlags};
 
-  VkQueryPool timeStampPool;
-  VkResult vkr =
-      ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &timeStampPoolCreateInfo, NULL, &timeStampPool);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  VkResult vkr = VK_SUCCESS;
+
+  VkQueryPool timeStampPool = VK_NULL_HANDLE;
+  if(needTimestamps)
+  {
+    vkr =
+        ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &timeStampPoolCreateInfo, NULL, &timeStampPool);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
 
   VkQueryPool occlusionPool = VK_NULL_HANDLE;
-  if(availableFeatures.occlusionQueryPrecise)
+  if(needOcclusion)
   {
     vkr = ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &occlusionPoolCreateInfo, NULL, &occlusionPool);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
   }
 
   VkQueryPool pipeStatsPool = VK_NULL_HANDLE;
-  if(availableFeatures.pipelineStatisticsQuery)
+  if(needPipeStats)
   {
     vkr = ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &pipeStatsPoolCreateInfo, NULL, &pipeStatsPool);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
@@ -306,7 +368,8 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
   vkr = ObjDisp(dev)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), timeStampPool, 0, maxEID * 2);
+  if(timeStampPool != VK_NULL_HANDLE)
+    ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), timeStampPool, 0, maxEID * 2);
   if(occlusionPool != VK_NULL_HANDLE)
     ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), occlusionPool, 0, maxEID);
   if(pipeStatsPool != VK_NULL_HANDLE)
@@ -324,47 +387,62 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
   // replay the events to perform all the queries
   m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
 
-  vector<uint64_t> m_TimeStampData;
-  m_TimeStampData.resize(cb.m_Results.size() * 2);
+  // wait once for the whole replay, so that every query below is already available and none of
+  // the readbacks stall individually.
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
 
-  vkr = ObjDisp(dev)->GetQueryPoolResults(
-      Unwrap(dev), timeStampPool, 0, (uint32_t)m_TimeStampData.size(),
-      sizeof(uint64_t) * m_TimeStampData.size(), &m_TimeStampData[0], sizeof(uint64_t),
-      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  uint32_t numResults = (uint32_t)cb.m_Results.size();
 
-  ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), timeStampPool, NULL);
+  vector<uint64_t> m_TimeStampData;
+  m_TimeStampData.resize(numResults * 2);
+  if(timeStampPool != VK_NULL_HANDLE && numResults > 0)
+  {
+    vkr = ObjDisp(dev)->GetQueryPoolResults(
+        Unwrap(dev), timeStampPool, 0, (uint32_t)m_TimeStampData.size(),
+        sizeof(uint64_t) * m_TimeStampData.size(), &m_TimeStampData[0], sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
 
   vector<uint64_t> m_OcclusionData;
-  m_OcclusionData.resize(cb.m_Results.size());
-  if(occlusionPool != VK_NULL_HANDLE)
+  m_OcclusionData.resize(numResults);
+  if(occlusionPool != VK_NULL_HANDLE && numResults > 0)
   {
     vkr = ObjDisp(dev)->GetQueryPoolResults(
         Unwrap(dev), occlusionPool, 0, (uint32_t)m_OcclusionData.size(),
         sizeof(uint64_t) * m_OcclusionData.size(), &m_OcclusionData[0], sizeof(uint64_t),
         VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
   }
 
   vector<uint64_t> m_PipeStatsData;
-  m_PipeStatsData.resize(cb.m_Results.size() * 11);
-  if(pipeStatsPool != VK_NULL_HANDLE)
+  m_PipeStatsData.resize(numResults * 11);
+  if(pipeStatsPool != VK_NULL_HANDLE && numResults > 0)
   {
     vkr = ObjDisp(dev)->GetQueryPoolResults(
-        Unwrap(dev), pipeStatsPool, 0, (uint32_t)cb.m_Results.size(),
-        sizeof(uint64_t) * m_PipeStatsData.size(), &m_PipeStatsData[0], sizeof(uint64_t) * 11,
+        Unwrap(dev), pipeStatsPool, 0, numResults, sizeof(uint64_t) * m_PipeStatsData.size(),
+        &m_PipeStatsData[0], sizeof(uint64_t) * 11,
         VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
 
+  if(timeStampPool != VK_NULL_HANDLE)
+    ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), timeStampPool, NULL);
+  if(occlusionPool != VK_NULL_HANDLE)
+    ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
+  if(pipeStatsPool != VK_NULL_HANDLE)
     ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), pipeStatsPool, NULL);
-  }
 
-  vector<CounterResult> ret;
+  ret.reserve(ret.size() + (numResults + cb.m_AliasEvents.size()) * counters.size());
+
+  // index of each event's first result, for looking up aliased events below
+  map<uint32_t, size_t> resultIndex;
 
   for(size_t i = 0; i < cb.m_Results.size(); i++)
   {
+    resultIndex[cb.m_Results[i]] = ret.size();
+
     for(size_t c = 0; c < counters.size(); c++)
     {
       CounterResult result;
@@ -392,7 +470,7 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
         case eCounter_TCSInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 8]; break;
         case eCounter_TESInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 9]; break;
         case eCounter_GSInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 3]; break;
-        case eCounter_PSInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 9]; break;
+        case eCounter_PSInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 7]; break;
         case eCounter_CSInvocations: result.value.u64 = m_PipeStatsData[i * 11 + 10]; break;
       }
       ret.push_back(result);
@@ -401,18 +479,16 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
 
   for(size_t i = 0; i < cb.m_AliasEvents.size(); i++)
   {
+    // find the results we're aliasing
+    auto it = resultIndex.find(cb.m_AliasEvents[i].first);
+    RDCASSERT(it != resultIndex.end());
+    if(it == resultIndex.end())
+      continue;
+
     for(size_t c = 0; c < counters.size(); c++)
     {
-      CounterResult search;
-      search.counterID = counters[c];
-      search.eventID = cb.m_AliasEvents[i].first;
-
-      // find the result we're aliasing
-      auto it = std::find(ret.begin(), ret.end(), search);
-      RDCASSERT(it != ret.end());
-
       // duplicate the result and append
-      CounterResult aliased = *it;
+      CounterResult aliased = ret[it->second + c];
       aliased.eventID = cb.m_AliasEvents[i].second;
       ret.push_back(aliased);
     }
@@ -420,6 +496,4 @@ vector<CounterResult> VulkanReplay::FetchCounters(const vector<uint32_t> &counte
 
   // sort so that the alias results appear in the right places
   std::sort(ret.begin(), ret.end());
-
-  return ret;
 }
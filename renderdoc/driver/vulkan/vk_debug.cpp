@@ -170,21 +170,128 @@ struct VulkanBlobShaderCallbacks
   byte *GetData(vector<uint32_t> *blob) const { return (byte *)&(*blob)[0]; }
 } ShaderCacheCallbacks;
 
-string VulkanDebugManager::GetSPIRVBlob(SPIRVShaderStage shadType,
-                                        const std::vector<std::string> &sources,
-                                        vector<uint32_t> **outBlob)
+// the cache key covers the full source (including any #defines prepended to it), the stage, and
+// the compiler version so that upgrading glslang doesn't pick up stale SPIR-V
+static uint32_t GetSPIRVBlobHash(SPIRVShaderStage shadType, const std::vector<std::string> &sources)
 {
-  RDCASSERT(sources.size() > 0);
+  static const string compilerVersion = GetSPIRVCompilerVersion();
 
-  uint32_t hash = strhash(sources[0].c_str());
-  for(size_t i = 1; i < sources.size(); i++)
+  uint32_t hash = strhash(compilerVersion.c_str());
+  for(size_t i = 0; i < sources.size(); i++)
     hash = strhash(sources[i].c_str(), hash);
 
   char typestr[2] = {'a', 0};
   typestr[0] += (char)shadType;
   hash = strhash(typestr, hash);
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+  return hash;
+}
+
+struct SPIRVCompileJobs
+{
+  std::vector<SPIRVShaderStage> stages;
+  std::vector<std::vector<std::string> > sources;
+  std::vector<vector<uint32_t> *> results;
+  volatile int32_t next;
+};
+
+static void SPIRVCompileWorker(void *param)
+{
+  SPIRVCompileJobs &jobs = *(SPIRVCompileJobs *)param;
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(&jobs.next);
+
+    if(idx >= (int32_t)jobs.stages.size())
+      break;
+
+    vector<uint32_t> *spirv = new vector<uint32_t>();
+    string errors = CompileSPIRV(jobs.stages[idx], jobs.sources[idx], *spirv);
+
+    // failures are reported when the shader is fetched with GetSPIRVBlob, which compiles again
+    if(!errors.empty() || spirv->empty())
+      SAFE_DELETE(spirv);
+
+    jobs.results[idx] = spirv;
+  }
+}
+
+void VulkanDebugManager::PrecompileSPIRVBlobs(const std::vector<SPIRVShaderStage> &stages,
+                                              const std::vector<std::vector<std::string> > &sources)
+{
+  RDCASSERT(stages.size() == sources.size());
+
+  SPIRVCompileJobs jobs;
+  jobs.next = -1;
+
+  std::vector<uint32_t> hashes;
+
+  for(size_t i = 0; i < stages.size(); i++)
+  {
+    uint32_t hash = GetSPIRVBlobHash(stages[i], sources[i]);
+
+    if(m_ShaderCache.find(hash) != m_ShaderCache.end() ||
+       FetchShaderCache(m_ShaderCacheFile, hash, m_ShaderCache, ShaderCacheCallbacks) ||
+       std::find(hashes.begin(), hashes.end(), hash) != hashes.end())
+      continue;
+
+    jobs.stages.push_back(stages[i]);
+    jobs.sources.push_back(sources[i]);
+    hashes.push_back(hash);
+  }
+
+  if(jobs.stages.empty())
+    return;
+
+  jobs.results.resize(jobs.stages.size(), NULL);
+
+  uint32_t numThreads = RDCMIN(Threading::GetNumberOfCores(), (uint32_t)jobs.stages.size());
+
+  RDCDEBUG("Compiling %u shaders missing from the shader cache on %u threads",
+           (uint32_t)jobs.stages.size(), numThreads);
+
+  std::vector<Threading::ThreadHandle> threads(numThreads, 0);
+
+  // this thread does its share of the work too
+  for(uint32_t t = 1; t < numThreads; t++)
+    threads[t] = Threading::CreateThread(&SPIRVCompileWorker, &jobs);
+
+  SPIRVCompileWorker(&jobs);
+
+  for(uint32_t t = 1; t < numThreads; t++)
+  {
+    Threading::JoinThread(threads[t]);
+    Threading::CloseThread(threads[t]);
+  }
+
+  for(size_t i = 0; i < jobs.results.size(); i++)
+  {
+    if(jobs.results[i] == NULL)
+      continue;
+
+    if(m_CacheShaders)
+    {
+      m_ShaderCache[hashes[i]] = jobs.results[i];
+      m_ShaderCacheDirty = true;
+    }
+    else
+    {
+      delete jobs.results[i];
+    }
+  }
+}
+
+string VulkanDebugManager::GetSPIRVBlob(SPIRVShaderStage shadType,
+                                        const std::vector<std::string> &sources,
+                                        vector<uint32_t> **outBlob)
+{
+  RDCASSERT(sources.size() > 0);
+
+  uint32_t hash = GetSPIRVBlobHash(shadType, sources);
+
+  if(m_ShaderCache.find(hash) != m_ShaderCache.end() ||
+     FetchShaderCache(m_ShaderCacheFile, hash, m_ShaderCache, ShaderCacheCallbacks))
   {
     *outBlob = m_ShaderCache[hash];
     return "";
@@ -217,6 +324,25 @@ string VulkanDebugManager::GetSPIRVBlob(SPIRVShaderStage shadType,
   return errors;
 }
 
+static string GetHistogramDefines(bool texelFetchBrokenDriver, size_t texType, size_t fmt)
+{
+  string defines = "";
+  if(texelFetchBrokenDriver)
+    defines += "#define NO_TEXEL_FETCH\n";
+  defines += string("#define SHADER_RESTYPE ") + ToStr::Get(texType) + "\n";
+  defines += string("#define UINT_TEX ") + (fmt == 1 ? "1" : "0") + "\n";
+  defines += string("#define SINT_TEX ") + (fmt == 2 ? "1" : "0") + "\n";
+  return defines;
+}
+
+// the buffer search doesn't sample, so the texture type is irrelevant
+static string GetValueSearchDefines(bool texelFetchBrokenDriver, size_t texType, bool buffer)
+{
+  string defines = GetHistogramDefines(texelFetchBrokenDriver, buffer ? RESTYPE_TEX2D : texType, 0);
+  defines += string("#define BUFFER_SEARCH ") + (buffer ? "1" : "0") + "\n";
+  return defines;
+}
+
 VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 {
   m_pDriver = driver;
@@ -320,6 +446,23 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   RDCEraseEl(m_MinMaxTilePipe);
   RDCEraseEl(m_HistogramPipe);
 
+  RDCEraseEl(m_ValueSearchTexPipe);
+  m_ValueSearchBufPipe = VK_NULL_HANDLE;
+  m_ValueSearchResultSize = 0;
+  m_ValueSearchSrcSize = 0;
+
+  RDCEraseEl(m_TexDiffWidth);
+  RDCEraseEl(m_TexDiffHeight);
+  RDCEraseEl(m_TexDiffImg);
+  RDCEraseEl(m_TexDiffMem);
+  RDCEraseEl(m_TexDiffView);
+  RDCEraseEl(m_TexDiffFB);
+  m_TexDiffRP = VK_NULL_HANDLE;
+  m_TexDiffDescSetLayout = VK_NULL_HANDLE;
+  m_TexDiffPipeLayout = VK_NULL_HANDLE;
+  m_TexDiffDescSet = VK_NULL_HANDLE;
+  m_TexDiffPipe = VK_NULL_HANDLE;
+
   m_OutlineDescSetLayout = VK_NULL_HANDLE;
   m_OutlinePipeLayout = VK_NULL_HANDLE;
   m_OutlineDescSet = VK_NULL_HANDLE;
@@ -333,6 +476,12 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   m_MeshPickLayout = VK_NULL_HANDLE;
   m_MeshPickPipeline = VK_NULL_HANDLE;
 
+  // readback and upload slots are created on demand
+  RDCEraseEl(m_ReadbackSlots);
+  m_NextReadbackSlot = 0;
+  RDCEraseEl(m_UploadSlots);
+  m_NextUploadSlot = 0;
+
   m_FontCharSize = 1.0f;
   m_FontCharAspect = 1.0f;
 
@@ -344,8 +493,8 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   // Do some work that's needed both during capture and during replay
 
   // Load shader cache, if present
-  bool success = LoadShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion,
-                                 m_ShaderCache, ShaderCacheCallbacks);
+  bool success =
+      m_ShaderCacheFile.Open("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion);
 
   // if we failed to load from the cache
   m_ShaderCacheDirty = !success;
@@ -1410,6 +1559,9 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
         {
             3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL,
         },
+        {
+            4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL,
+        },
     };
 
     VkDescriptorSetLayoutCreateInfo descsetLayoutInfo = {
@@ -1600,6 +1752,38 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
   }
 
+  {
+    VkDescriptorSetLayoutBinding layoutBinding[] = {
+        {
+            0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+        },
+        {
+            1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+        },
+        {
+            2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+        },
+        {
+            3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+        },
+        {
+            4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo descsetLayoutInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        NULL,
+        0,
+        ARRAY_COUNT(layoutBinding),
+        &layoutBinding[0],
+    };
+
+    vkr = m_pDriver->vkCreateDescriptorSetLayout(dev, &descsetLayoutInfo, NULL,
+                                                 &m_TexDiffDescSetLayout);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
   pipeLayoutInfo.pSetLayouts = &m_TexDisplayDescSetLayout;
 
   vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &m_TexDisplayPipeLayout);
@@ -1635,6 +1819,11 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &m_HistogramPipeLayout);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
+  pipeLayoutInfo.pSetLayouts = &m_TexDiffDescSetLayout;
+
+  vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &m_TexDiffPipeLayout);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
   pipeLayoutInfo.pSetLayouts = &m_MeshPickDescSetLayout;
 
   vkr = m_pDriver->vkCreatePipelineLayout(dev, &pipeLayoutInfo, NULL, &m_MeshPickLayout);
@@ -1674,6 +1863,10 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   vkr = m_pDriver->vkAllocateDescriptorSets(dev, &descSetAllocInfo, &m_HistogramDescSet[1]);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
+  descSetAllocInfo.pSetLayouts = &m_TexDiffDescSetLayout;
+  vkr = m_pDriver->vkAllocateDescriptorSets(dev, &descSetAllocInfo, &m_TexDiffDescSet);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
   descSetAllocInfo.pSetLayouts = &m_MeshFetchDescSetLayout;
   vkr = m_pDriver->vkAllocateDescriptorSets(dev, &descSetAllocInfo, &m_MeshFetchDescSet);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
@@ -1686,6 +1879,13 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   m_MeshPickIBSize = 0;
   m_MeshPickVBSize = 0;
 
+  m_MeshPickCached = false;
+  m_MeshPickEventID = 0;
+  m_MeshPickPrims = 0;
+
+  m_MeshPickGroupsSize = 1024 * sizeof(uint32_t);
+  m_MeshPickGroups.Create(driver, dev, m_MeshPickGroupsSize, 1, GPUBuffer::eGPUBufferSSBO);
+
   m_MeshPickUBO.Create(driver, dev, 128, 1, 0);
   RDCCOMPILE_ASSERT(sizeof(MeshPickUBOData) <= 128, "mesh pick UBO size");
 
@@ -1695,8 +1895,6 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
                           GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
   m_MeshPickResultReadback.Create(driver, dev, meshPickResultSize, 1, GPUBuffer::eGPUBufferReadback);
 
-  m_ReadbackWindow.Create(driver, dev, STAGE_BUFFER_BYTE_SIZE, 1, GPUBuffer::eGPUBufferReadback);
-
   m_OutlineUBO.Create(driver, dev, 128, 10, 0);
   RDCCOMPILE_ASSERT(sizeof(OutlineUBOData) <= 128, "outline UBO size");
 
@@ -1753,6 +1951,73 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
   m_CacheShaders = true;
 
+  // compile everything that isn't already in the shader cache up front on multiple threads, then
+  // the GetSPIRVBlob calls below will all be cache hits.
+  {
+    std::vector<SPIRVShaderStage> precompileStages;
+    std::vector<std::vector<std::string> > precompileSources;
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_fixedcol_frag), 430,
+                       false);
+    precompileStages.push_back(eSPIRVFragment);
+    precompileSources.push_back(sources);
+
+    for(size_t i = 0; i < ARRAY_COUNT(module); i++)
+    {
+      if(i == HISTOGRAMCS || i == MINMAXTILECS || i == MINMAXRESULTCS)
+        continue;
+
+      string defines = "";
+      if(texelFetchBrokenDriver)
+        defines += "#define NO_TEXEL_FETCH\n";
+
+      GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[i], 430, i != QUADWRITEFS);
+      precompileStages.push_back(shaderStages[i]);
+      precompileSources.push_back(sources);
+    }
+
+    for(size_t t = eTexType_1D; t < eTexType_Max; t++)
+    {
+      for(size_t f = 0; f < 3; f++)
+      {
+        string defines = GetHistogramDefines(texelFetchBrokenDriver, t, f);
+
+        GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[HISTOGRAMCS], 430);
+        precompileStages.push_back(eSPIRVCompute);
+        precompileSources.push_back(sources);
+
+        GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXTILECS], 430);
+        precompileStages.push_back(eSPIRVCompute);
+        precompileSources.push_back(sources);
+
+        if(t == 1)
+        {
+          GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXRESULTCS], 430);
+          precompileStages.push_back(eSPIRVCompute);
+          precompileSources.push_back(sources);
+        }
+      }
+
+      GenerateGLSLShader(sources, eShaderVulkan,
+                         GetValueSearchDefines(texelFetchBrokenDriver, t, false),
+                         GetEmbeddedResource(glsl_valuesearch_comp), 430);
+      precompileStages.push_back(eSPIRVCompute);
+      precompileSources.push_back(sources);
+    }
+
+    GenerateGLSLShader(sources, eShaderVulkan,
+                       GetValueSearchDefines(texelFetchBrokenDriver, 0, true),
+                       GetEmbeddedResource(glsl_valuesearch_comp), 430);
+    precompileStages.push_back(eSPIRVCompute);
+    precompileSources.push_back(sources);
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_texdiff_comp), 430);
+    precompileStages.push_back(eSPIRVCompute);
+    precompileSources.push_back(sources);
+
+    PrecompileSPIRVBlobs(precompileStages, precompileSources);
+  }
+
   {
     GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_fixedcol_frag), 430,
                        false);
@@ -1903,12 +2168,7 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
           VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL, 0, 0, NULL,
       };
 
-      string defines = "";
-      if(texelFetchBrokenDriver)
-        defines += "#define NO_TEXEL_FETCH\n";
-      defines += string("#define SHADER_RESTYPE ") + ToStr::Get(t) + "\n";
-      defines += string("#define UINT_TEX ") + (f == 1 ? "1" : "0") + "\n";
-      defines += string("#define SINT_TEX ") + (f == 2 ? "1" : "0") + "\n";
+      string defines = GetHistogramDefines(texelFetchBrokenDriver, t, f);
 
       GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[HISTOGRAMCS], 430);
 
@@ -1974,6 +2234,102 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
     }
   }
 
+  // the last iteration creates the buffer search
+  for(size_t t = eTexType_1D; t <= eTexType_Max; t++)
+  {
+    bool buffer = (t == eTexType_Max);
+
+    GenerateGLSLShader(sources, eShaderVulkan,
+                       GetValueSearchDefines(texelFetchBrokenDriver, t, buffer),
+                       GetEmbeddedResource(glsl_valuesearch_comp), 430);
+
+    vector<uint32_t> *blob = NULL;
+    string err = GetSPIRVBlob(eSPIRVCompute, sources, &blob);
+    RDCASSERT(err.empty() && blob);
+
+    VkShaderModuleCreateInfo modinfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL, 0, blob->size() * sizeof(uint32_t),
+        &(*blob)[0],
+    };
+
+    VkShaderModule valuesearch = VK_NULL_HANDLE;
+    vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL, &valuesearch);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    compPipeInfo.stage.module = valuesearch;
+
+    vkr = m_pDriver->vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &compPipeInfo, NULL,
+                                              buffer ? &m_ValueSearchBufPipe
+                                                     : &m_ValueSearchTexPipe[t]);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    m_pDriver->vkDestroyShaderModule(dev, valuesearch, NULL);
+  }
+
+  {
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_texdiff_comp), 430);
+
+    vector<uint32_t> *blob = NULL;
+    string err = GetSPIRVBlob(eSPIRVCompute, sources, &blob);
+    RDCASSERT(err.empty() && blob);
+
+    VkShaderModuleCreateInfo modinfo = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL, 0, blob->size() * sizeof(uint32_t),
+        &(*blob)[0],
+    };
+
+    VkShaderModule texdiff = VK_NULL_HANDLE;
+    vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL, &texdiff);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    compPipeInfo.stage.module = texdiff;
+    compPipeInfo.layout = m_TexDiffPipeLayout;
+
+    vkr = m_pDriver->vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &compPipeInfo, NULL,
+                                              &m_TexDiffPipe);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    m_pDriver->vkDestroyShaderModule(dev, texdiff, NULL);
+
+    // the diff inputs are rendered with the RGBA32F texture display pipeline, so this only needs
+    // to be compatible with the pick pixel render pass it was created against
+    VkAttachmentDescription attDesc = {0,
+                                       VK_FORMAT_R32G32B32A32_SFLOAT,
+                                       VK_SAMPLE_COUNT_1_BIT,
+                                       VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                       VK_ATTACHMENT_STORE_OP_STORE,
+                                       VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                       VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                       VK_IMAGE_LAYOUT_GENERAL,
+                                       VK_IMAGE_LAYOUT_GENERAL};
+
+    VkAttachmentReference attRef = {0, VK_IMAGE_LAYOUT_GENERAL};
+
+    VkSubpassDescription sub = {
+        0,    VK_PIPELINE_BIND_POINT_GRAPHICS,
+        0,    NULL,       // inputs
+        1,    &attRef,    // color
+        NULL,             // resolve
+        NULL,             // depth-stencil
+        0,    NULL,       // preserve
+    };
+
+    VkRenderPassCreateInfo rpinfo = {
+        VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        NULL,
+        0,
+        1,
+        &attDesc,
+        1,
+        &sub,
+        0,
+        NULL,    // dependencies
+    };
+
+    vkr = m_pDriver->vkCreateRenderPass(dev, &rpinfo, NULL, &m_TexDiffRP);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
   {
     compPipeInfo.stage.module = module[MESHCS];
     compPipeInfo.layout = m_MeshPickLayout;
@@ -2407,6 +2763,11 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
   // don't need to ring this, as we hard-sync for readback anyway
   m_HistogramUBO.Create(driver, dev, sizeof(HistogramUBOData), 1, 0);
+  m_ValueSearchUBO.Create(driver, dev, sizeof(ValueSearchUBOData), 1, 0);
+  m_TexDiffUBO.Create(driver, dev, sizeof(TexDiffUBOData), 1, 0);
+  m_TexDiffResult.Create(driver, dev, sizeof(Vec4u) * 2, 1,
+                         GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+  m_TexDiffReadback.Create(driver, dev, sizeof(Vec4u) * 2, 1, GPUBuffer::eGPUBufferReadback);
 
   ObjDisp(replayDataCmd)->EndCommandBuffer(Unwrap(replayDataCmd));
 
@@ -2447,8 +2808,7 @@ VulkanDebugManager::~VulkanDebugManager()
 
   if(m_ShaderCacheDirty)
   {
-    SaveShaderCache("vkshaders.cache", m_ShaderCacheMagic, m_ShaderCacheVersion, m_ShaderCache,
-                    ShaderCacheCallbacks);
+    SaveShaderCache(m_ShaderCacheFile, m_ShaderCache, ShaderCacheCallbacks);
   }
   else
   {
@@ -2575,9 +2935,25 @@ VulkanDebugManager::~VulkanDebugManager()
       if(t == 1)
         m_pDriver->vkDestroyPipeline(dev, m_MinMaxResultPipe[f], NULL);
     }
+
+    m_pDriver->vkDestroyPipeline(dev, m_ValueSearchTexPipe[t], NULL);
   }
 
-  m_ReadbackWindow.Destroy();
+  m_pDriver->vkDestroyPipeline(dev, m_ValueSearchBufPipe, NULL);
+
+  for(uint32_t i = 0; i < ReadbackSlotCount; i++)
+  {
+    WaitStagingSlot(m_ReadbackSlots[i]);
+    FreeStagingSlot(m_ReadbackSlots[i]);
+    ObjDisp(dev)->DestroyFence(Unwrap(dev), m_ReadbackSlots[i].fence, NULL);
+  }
+
+  for(uint32_t i = 0; i < UploadSlotCount; i++)
+  {
+    WaitStagingSlot(m_UploadSlots[i]);
+    FreeStagingSlot(m_UploadSlots[i]);
+    ObjDisp(dev)->DestroyFence(Unwrap(dev), m_UploadSlots[i].fence, NULL);
+  }
 
   m_MinMaxTileResult.Destroy();
   m_MinMaxResult.Destroy();
@@ -2586,6 +2962,32 @@ VulkanDebugManager::~VulkanDebugManager()
   m_HistogramReadback.Destroy();
   m_HistogramUBO.Destroy();
 
+  m_ValueSearchUBO.Destroy();
+  if(m_ValueSearchResultSize > 0)
+  {
+    m_ValueSearchResult.Destroy();
+    m_ValueSearchReadback.Destroy();
+  }
+  if(m_ValueSearchSrcSize > 0)
+    m_ValueSearchSrc.Destroy();
+
+  m_TexDiffUBO.Destroy();
+  m_TexDiffResult.Destroy();
+  m_TexDiffReadback.Destroy();
+
+  for(size_t i = 0; i < ARRAY_COUNT(m_TexDiffImg); i++)
+  {
+    m_pDriver->vkDestroyFramebuffer(dev, m_TexDiffFB[i], NULL);
+    m_pDriver->vkDestroyImageView(dev, m_TexDiffView[i], NULL);
+    m_pDriver->vkDestroyImage(dev, m_TexDiffImg[i], NULL);
+    m_pDriver->vkFreeMemory(dev, m_TexDiffMem[i], NULL);
+  }
+
+  m_pDriver->vkDestroyRenderPass(dev, m_TexDiffRP, NULL);
+  m_pDriver->vkDestroyPipeline(dev, m_TexDiffPipe, NULL);
+  m_pDriver->vkDestroyDescriptorSetLayout(dev, m_TexDiffDescSetLayout, NULL);
+  m_pDriver->vkDestroyPipelineLayout(dev, m_TexDiffPipeLayout, NULL);
+
   m_OverdrawRampUBO.Destroy();
 
   m_MeshPickUBO.Destroy();
@@ -2595,6 +2997,7 @@ VulkanDebugManager::~VulkanDebugManager()
   m_MeshPickVBUpload.Destroy();
   m_MeshPickResult.Destroy();
   m_MeshPickResultReadback.Destroy();
+  m_MeshPickGroups.Destroy();
 
   m_pDriver->vkDestroyDescriptorSetLayout(dev, m_MeshPickDescSetLayout, NULL);
   m_pDriver->vkDestroyPipelineLayout(dev, m_MeshPickLayout, NULL);
@@ -3029,6 +3432,126 @@ void VulkanDebugManager::CreateCustomShaderTex(uint32_t width, uint32_t height,
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 }
 
+void VulkanDebugManager::CreateTexDiffImage(uint32_t idx, uint32_t width, uint32_t height)
+{
+  VkDevice dev = m_Device;
+
+  VkResult vkr = VK_SUCCESS;
+
+  if(m_TexDiffImg[idx] != VK_NULL_HANDLE)
+  {
+    if(width == m_TexDiffWidth[idx] && height == m_TexDiffHeight[idx])
+      return;
+
+    m_pDriver->vkDestroyFramebuffer(dev, m_TexDiffFB[idx], NULL);
+    m_pDriver->vkDestroyImageView(dev, m_TexDiffView[idx], NULL);
+    m_pDriver->vkDestroyImage(dev, m_TexDiffImg[idx], NULL);
+    m_pDriver->vkFreeMemory(dev, m_TexDiffMem[idx], NULL);
+  }
+
+  m_TexDiffWidth[idx] = width;
+  m_TexDiffHeight[idx] = height;
+
+  VkImageCreateInfo imInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      NULL,
+      0,
+      VK_IMAGE_TYPE_2D,
+      VK_FORMAT_R32G32B32A32_SFLOAT,
+      {width, height, 1},
+      1,
+      1,
+      VK_SAMPLE_COUNT_1_BIT,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+          VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+      VK_SHARING_MODE_EXCLUSIVE,
+      0,
+      NULL,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  vkr = m_pDriver->vkCreateImage(dev, &imInfo, NULL, &m_TexDiffImg[idx]);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  m_pDriver->vkGetImageMemoryRequirements(dev, m_TexDiffImg[idx], &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &m_TexDiffMem[idx]);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = m_pDriver->vkBindImageMemory(dev, m_TexDiffImg[idx], m_TexDiffMem[idx], 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkImageViewCreateInfo viewInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      NULL,
+      0,
+      m_TexDiffImg[idx],
+      VK_IMAGE_VIEW_TYPE_2D,
+      imInfo.format,
+      {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+       VK_COMPONENT_SWIZZLE_IDENTITY},
+      {
+          VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1,
+      },
+  };
+
+  vkr = m_pDriver->vkCreateImageView(dev, &viewInfo, NULL, &m_TexDiffView[idx]);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkImageMemoryBarrier barrier = {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      NULL,
+      0,
+      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_IMAGE_LAYOUT_GENERAL,
+      0,
+      0,    // MULTIDEVICE - need to actually pick the right queue family here maybe?
+      Unwrap(m_TexDiffImg[idx]),
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+
+  m_pDriver->m_ImageLayouts[GetResID(m_TexDiffImg[idx])].subresourceStates[0].newLayout =
+      VK_IMAGE_LAYOUT_GENERAL;
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  ObjDisp(dev)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+#if ENABLED(SINGLE_FLUSH_VALIDATE)
+  m_pDriver->SubmitCmds();
+#endif
+
+  VkFramebufferCreateInfo fbinfo = {
+      VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+      NULL,
+      0,
+      m_TexDiffRP,
+      1,
+      &m_TexDiffView[idx],
+      width,
+      height,
+      1,
+  };
+
+  vkr = m_pDriver->vkCreateFramebuffer(dev, &fbinfo, NULL, &m_TexDiffFB[idx]);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+}
+
 void VulkanDebugManager::CreateCustomShaderPipeline(ResourceId shader)
 {
   VkDevice dev = m_Device;
@@ -3946,6 +4469,165 @@ FloatVector VulkanDebugManager::InterpretVertex(byte *data, uint32_t vert, const
 }
 
 // TODO: Point meshes don't pick correctly
+static bool RayIntersectsBox(const Vec3f &rayPos, const Vec3f &rayDir, const Vec3f &minBounds,
+                             const Vec3f &maxBounds)
+{
+  const float pos[3] = {rayPos.x, rayPos.y, rayPos.z};
+  const float dir[3] = {rayDir.x, rayDir.y, rayDir.z};
+  const float mn[3] = {minBounds.x, minBounds.y, minBounds.z};
+  const float mx[3] = {maxBounds.x, maxBounds.y, maxBounds.z};
+
+  // the triangle test only accepts hits in front of the ray position
+  float tmin = 0.0f;
+  float tmax = FLT_MAX;
+
+  for(int i = 0; i < 3; i++)
+  {
+    if(fabsf(dir[i]) < 1.0e-20f)
+    {
+      // parallel to this slab, so it must start inside it
+      if(pos[i] < mn[i] || pos[i] > mx[i])
+        return false;
+
+      continue;
+    }
+
+    float t1 = (mn[i] - pos[i]) / dir[i];
+    float t2 = (mx[i] - pos[i]) / dir[i];
+
+    tmin = RDCMAX(tmin, RDCMIN(t1, t2));
+    tmax = RDCMIN(tmax, RDCMAX(t1, t2));
+
+    if(tmin > tmax)
+      return false;
+  }
+
+  return true;
+}
+
+bool VulkanDebugManager::IsMeshPickCached(uint32_t eventID, const MeshDisplay &cfg)
+{
+  const MeshFormat &a = m_MeshPickFormat;
+  const MeshFormat &b = cfg.position;
+
+  return m_MeshPickCached && m_MeshPickEventID == eventID && a.buf == b.buf &&
+         a.offset == b.offset && a.stride == b.stride && a.compCount == b.compCount &&
+         a.compByteWidth == b.compByteWidth && a.compType == b.compType &&
+         a.bgraOrder == b.bgraOrder && a.specialFormat == b.specialFormat && a.idxbuf == b.idxbuf &&
+         a.idxoffs == b.idxoffs && a.idxByteWidth == b.idxByteWidth &&
+         a.baseVertex == b.baseVertex && a.numVerts == b.numVerts && a.topo == b.topo &&
+         a.unproject == b.unproject;
+}
+
+void VulkanDebugManager::BuildMeshPickGroups(const MeshDisplay &cfg,
+                                             const vector<FloatVector> &verts,
+                                             const vector<uint32_t> &idxs)
+{
+  m_MeshPickPrims = 0;
+  m_MeshPickGroupBounds.clear();
+
+  uint32_t numVerts = cfg.position.numVerts;
+
+  // the vertices making up each primitive, matching trianglePath() in mesh.comp
+  uint32_t primStride = 0, vertStride = 1, fanned = 0;
+
+  switch(cfg.position.topo)
+  {
+    case eTopology_TriangleList:
+      m_MeshPickPrims = numVerts / 3;
+      primStride = 3;
+      break;
+    case eTopology_TriangleStrip:
+      m_MeshPickPrims = numVerts >= 3 ? numVerts - 2 : 0;
+      primStride = 1;
+      break;
+    case eTopology_TriangleFan:
+      m_MeshPickPrims = numVerts >= 3 ? numVerts - 2 : 0;
+      primStride = 1;
+      fanned = 1;
+      break;
+    case eTopology_TriangleList_Adj:
+      m_MeshPickPrims = numVerts / 6;
+      primStride = 6;
+      vertStride = 2;
+      break;
+    case eTopology_TriangleStrip_Adj:
+      m_MeshPickPrims = numVerts >= 5 ? (numVerts - 3) / 2 : 0;
+      primStride = 2;
+      vertStride = 2;
+      break;
+    default:
+      // points and lines are tested in screen space, which changes with the camera
+      return;
+  }
+
+  uint32_t numGroups = (m_MeshPickPrims + meshPickGroupSize - 1) / meshPickGroupSize;
+  m_MeshPickGroupBounds.resize(numGroups);
+
+  for(uint32_t g = 0; g < numGroups; g++)
+  {
+    Vec3f mn(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vec3f mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    bool unbounded = false;
+
+    uint32_t primEnd = RDCMIN(m_MeshPickPrims, (g + 1) * meshPickGroupSize);
+
+    for(uint32_t p = g * meshPickGroupSize; p < primEnd && !unbounded; p++)
+    {
+      for(uint32_t v = 0; v < 3; v++)
+      {
+        uint32_t vertid = p * primStride + v * vertStride;
+        if(fanned)
+          vertid = v == 0 ? 0 : p + v;
+
+        uint32_t idx = idxs.empty() ? vertid : idxs[vertid];
+
+        if(idx >= verts.size())
+        {
+          unbounded = true;
+          break;
+        }
+
+        FloatVector pos = verts[idx];
+
+        // positions are tested the same way as in the shader
+        if(cfg.position.unproject)
+        {
+          pos.x /= pos.w;
+          pos.y /= -pos.w;
+          pos.z /= pos.w;
+        }
+
+        // NaN or infinite positions can't be bounded
+        if(!(fabsf(pos.x) <= FLT_MAX && fabsf(pos.y) <= FLT_MAX && fabsf(pos.z) <= FLT_MAX))
+        {
+          unbounded = true;
+          break;
+        }
+
+        mn = Vec3f(RDCMIN(mn.x, pos.x), RDCMIN(mn.y, pos.y), RDCMIN(mn.z, pos.z));
+        mx = Vec3f(RDCMAX(mx.x, pos.x), RDCMAX(mx.y, pos.y), RDCMAX(mx.z, pos.z));
+      }
+    }
+
+    if(unbounded)
+    {
+      mn = Vec3f(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+      mx = Vec3f(FLT_MAX, FLT_MAX, FLT_MAX);
+    }
+    else
+    {
+      // pad slightly so that hits right on an edge aren't lost to rounding
+      Vec3f pad = (mx - mn) * 0.001f + Vec3f(1.0e-6f, 1.0e-6f, 1.0e-6f);
+      mn = mn - pad;
+      mx = mx + pad;
+    }
+
+    m_MeshPickGroupBounds[g].minBounds = mn;
+    m_MeshPickGroupBounds[g].maxBounds = mx;
+  }
+}
+
 uint32_t VulkanDebugManager::PickVertex(uint32_t eventID, const MeshDisplay &cfg, uint32_t x,
                                         uint32_t y, uint32_t w, uint32_t h)
 {
@@ -4034,11 +4716,166 @@ uint32_t VulkanDebugManager::PickVertex(uint32_t eventID, const MeshDisplay &cfg
     }
   }
 
+  bool useIndices = cfg.position.idxByteWidth && cfg.position.idxbuf != ResourceId();
+
+  // only read back and unpack the mesh if it's not the one already uploaded
+  bool cached = IsMeshPickCached(eventID, cfg);
+
+  if(!cached)
+  {
+    vector<uint32_t> idxs;
+
+    // We copy into our own buffers to promote to the target type (uint32) that the
+    // shader expects. Most IBs will be 16-bit indices, most VBs will not be float4.
+
+    if(useIndices)
+    {
+      vector<byte> idxdata;
+      GetBufferData(cfg.position.idxbuf, cfg.position.idxoffs, 0, idxdata);
+
+      idxs.resize(cfg.position.numVerts, 0);
+
+      uint16_t *idxs16 = idxdata.empty() ? NULL : (uint16_t *)&idxdata[0];
+      uint32_t *idxs32 = idxdata.empty() ? NULL : (uint32_t *)&idxdata[0];
+
+      // if indices are 16-bit, manually upcast them so the shader only
+      // has to deal with one type
+      if(cfg.position.idxByteWidth == 2)
+      {
+        size_t bufsize = idxdata.size() / 2;
+
+        for(uint32_t i = 0; i < bufsize && i < cfg.position.numVerts; i++)
+          idxs[i] = idxs16[i];
+      }
+      else
+      {
+        size_t bufsize = idxdata.size() / 4;
+
+        for(uint32_t i = 0; i < bufsize && i < cfg.position.numVerts; i++)
+          idxs[i] = idxs32[i];
+      }
+
+      // resize up on demand
+      if(m_MeshPickIBSize < cfg.position.numVerts * sizeof(uint32_t))
+      {
+        if(m_MeshPickIBSize > 0)
+        {
+          m_MeshPickIB.Destroy();
+          m_MeshPickIBUpload.Destroy();
+        }
+
+        m_MeshPickIBSize = cfg.position.numVerts * sizeof(uint32_t);
+
+        m_MeshPickIB.Create(m_pDriver, dev, m_MeshPickIBSize, 1,
+                            GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+        m_MeshPickIBUpload.Create(m_pDriver, dev, m_MeshPickIBSize, 1, 0);
+      }
+
+      uint32_t *outidxs = (uint32_t *)m_MeshPickIBUpload.Map();
+
+      memset(outidxs, 0, m_MeshPickIBSize);
+      if(!idxs.empty())
+        memcpy(outidxs, &idxs[0], idxs.size() * sizeof(uint32_t));
+
+      m_MeshPickIBUpload.Unmap();
+    }
+
+    if(m_MeshPickVBSize < cfg.position.numVerts * sizeof(FloatVector))
+    {
+      if(m_MeshPickVBSize > 0)
+      {
+        m_MeshPickVB.Destroy();
+        m_MeshPickVBUpload.Destroy();
+      }
+
+      m_MeshPickVBSize = cfg.position.numVerts * sizeof(FloatVector);
+
+      m_MeshPickVB.Create(m_pDriver, dev, m_MeshPickVBSize, 1,
+                          GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+      m_MeshPickVBUpload.Create(m_pDriver, dev, m_MeshPickVBSize, 1, 0);
+    }
+
+    vector<FloatVector> verts(cfg.position.numVerts);
+
+    // unpack and linearise the data
+    {
+      vector<byte> oldData;
+      GetBufferData(cfg.position.buf, cfg.position.offset, 0, oldData);
+
+      byte *data = oldData.empty() ? NULL : &oldData[0];
+      byte *dataEnd = data + oldData.size();
+
+      bool valid = true;
+
+      uint32_t idxclamp = 0;
+      if(cfg.position.baseVertex < 0)
+        idxclamp = uint32_t(-cfg.position.baseVertex);
+
+      for(uint32_t i = 0; i < cfg.position.numVerts; i++)
+      {
+        uint32_t idx = i;
+
+        // apply baseVertex but clamp to 0 (don't allow index to become negative)
+        if(idx < idxclamp)
+          idx = 0;
+        else if(cfg.position.baseVertex < 0)
+          idx -= idxclamp;
+        else if(cfg.position.baseVertex > 0)
+          idx += cfg.position.baseVertex;
+
+        verts[i] = InterpretVertex(data, idx, cfg, dataEnd, valid);
+      }
+
+      FloatVector *vbData = (FloatVector *)m_MeshPickVBUpload.Map();
+      if(!verts.empty())
+        memcpy(vbData, &verts[0], verts.size() * sizeof(FloatVector));
+      m_MeshPickVBUpload.Unmap();
+    }
+
+    BuildMeshPickGroups(cfg, verts, idxs);
+
+    m_MeshPickCached = true;
+    m_MeshPickEventID = eventID;
+    m_MeshPickFormat = cfg.position;
+  }
+
+  // pick out the groups of triangles whose bounds the ray passes through
+  uint32_t numGroups = 0;
+
+  if(m_MeshPickPrims > 0)
+  {
+    vector<uint32_t> groups;
+    groups.reserve(m_MeshPickGroupBounds.size());
+
+    for(size_t i = 0; i < m_MeshPickGroupBounds.size(); i++)
+      if(RayIntersectsBox(rayPos, rayDir, m_MeshPickGroupBounds[i].minBounds,
+                          m_MeshPickGroupBounds[i].maxBounds))
+        groups.push_back((uint32_t)i);
+
+    numGroups = (uint32_t)groups.size();
+
+    if(m_MeshPickGroupsSize < numGroups * sizeof(uint32_t))
+    {
+      m_MeshPickGroups.Destroy();
+
+      m_MeshPickGroupsSize = numGroups * sizeof(uint32_t);
+
+      m_MeshPickGroups.Create(m_pDriver, dev, m_MeshPickGroupsSize, 1, GPUBuffer::eGPUBufferSSBO);
+    }
+
+    if(numGroups > 0)
+    {
+      uint32_t *groupData = (uint32_t *)m_MeshPickGroups.Map();
+      memcpy(groupData, &groups[0], numGroups * sizeof(uint32_t));
+      m_MeshPickGroups.Unmap();
+    }
+  }
+
   MeshPickUBOData *ubo = (MeshPickUBOData *)m_MeshPickUBO.Map();
 
   ubo->rayPos = rayPos;
   ubo->rayDir = rayDir;
-  ubo->use_indices = cfg.position.idxByteWidth ? 1U : 0U;
+  ubo->use_indices = useIndices ? 1U : 0U;
   ubo->numVerts = cfg.position.numVerts;
   bool isTriangleMesh = true;
 
@@ -4082,126 +4919,31 @@ uint32_t VulkanDebugManager::PickVertex(uint32_t eventID, const MeshDisplay &cfg
   ubo->coords = Vec2f((float)x, (float)y);
   ubo->viewport = Vec2f((float)w, (float)h);
 
-  m_MeshPickUBO.Unmap();
-
-  vector<byte> idxs;
-
-  if(cfg.position.idxByteWidth && cfg.position.idxbuf != ResourceId())
-    GetBufferData(cfg.position.idxbuf, cfg.position.idxoffs, 0, idxs);
-
-  // We copy into our own buffers to promote to the target type (uint32) that the
-  // shader expects. Most IBs will be 16-bit indices, most VBs will not be float4.
-
-  if(!idxs.empty())
-  {
-    // resize up on demand
-    if(m_MeshPickIBSize < cfg.position.numVerts * sizeof(uint32_t))
-    {
-      if(m_MeshPickIBSize > 0)
-      {
-        m_MeshPickIB.Destroy();
-        m_MeshPickIBUpload.Destroy();
-      }
-
-      m_MeshPickIBSize = cfg.position.numVerts * sizeof(uint32_t);
-
-      m_MeshPickIB.Create(m_pDriver, dev, m_MeshPickIBSize, 1,
-                          GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
-      m_MeshPickIBUpload.Create(m_pDriver, dev, m_MeshPickIBSize, 1, 0);
-    }
-
-    uint32_t *outidxs = (uint32_t *)m_MeshPickIBUpload.Map();
-
-    memset(outidxs, 0, m_MeshPickIBSize);
-
-    uint16_t *idxs16 = (uint16_t *)&idxs[0];
-    uint32_t *idxs32 = (uint32_t *)&idxs[0];
-
-    // if indices are 16-bit, manually upcast them so the shader only
-    // has to deal with one type
-    if(cfg.position.idxByteWidth == 2)
-    {
-      size_t bufsize = idxs.size() / 2;
-
-      for(uint32_t i = 0; i < bufsize && i < cfg.position.numVerts; i++)
-        outidxs[i] = idxs16[i];
-    }
-    else
-    {
-      size_t bufsize = idxs.size() / 4;
-
-      memcpy(outidxs, idxs32, RDCMIN(bufsize, cfg.position.numVerts * sizeof(uint32_t)));
-    }
-
-    m_MeshPickIBUpload.Unmap();
-  }
-
-  if(m_MeshPickVBSize < cfg.position.numVerts * sizeof(FloatVector))
-  {
-    if(m_MeshPickVBSize > 0)
-    {
-      m_MeshPickVB.Destroy();
-      m_MeshPickVBUpload.Destroy();
-    }
-
-    m_MeshPickVBSize = cfg.position.numVerts * sizeof(FloatVector);
-
-    m_MeshPickVB.Create(m_pDriver, dev, m_MeshPickVBSize, 1,
-                        GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
-    m_MeshPickVBUpload.Create(m_pDriver, dev, m_MeshPickVBSize, 1, 0);
-  }
-
-  // unpack and linearise the data
-  {
-    vector<byte> oldData;
-    GetBufferData(cfg.position.buf, cfg.position.offset, 0, oldData);
-
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
-
-    bool valid = true;
-
-    FloatVector *vbData = (FloatVector *)m_MeshPickVBUpload.Map();
-
-    uint32_t idxclamp = 0;
-    if(cfg.position.baseVertex < 0)
-      idxclamp = uint32_t(-cfg.position.baseVertex);
-
-    for(uint32_t i = 0; i < cfg.position.numVerts; i++)
-    {
-      uint32_t idx = i;
-
-      // apply baseVertex but clamp to 0 (don't allow index to become negative)
-      if(idx < idxclamp)
-        idx = 0;
-      else if(cfg.position.baseVertex < 0)
-        idx -= idxclamp;
-      else if(cfg.position.baseVertex > 0)
-        idx += cfg.position.baseVertex;
-
-      vbData[i] = InterpretVertex(data, idx, cfg, dataEnd, valid);
-    }
+  ubo->numGroupedPrims = m_MeshPickPrims;
 
-    m_MeshPickVBUpload.Unmap();
-  }
+  m_MeshPickUBO.Unmap();
 
   VkDescriptorBufferInfo ibInfo = {};
   VkDescriptorBufferInfo vbInfo = {};
+  VkDescriptorBufferInfo groupsInfo = {};
 
   m_MeshPickVB.FillDescriptor(vbInfo);
   m_MeshPickIB.FillDescriptor(ibInfo);
+  m_MeshPickGroups.FillDescriptor(groupsInfo);
 
   VkWriteDescriptorSet writes[] = {
       {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_MeshPickDescSet), 1, 0, 1,
        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &vbInfo, NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_MeshPickDescSet), 4, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &groupsInfo, NULL},
       {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, Unwrap(m_MeshPickDescSet), 2, 0, 1,
        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &ibInfo, NULL},
   };
 
-  if(!idxs.empty())
-    vt->UpdateDescriptorSets(Unwrap(m_Device), 2, writes, 0, NULL);
+  if(useIndices)
+    vt->UpdateDescriptorSets(Unwrap(m_Device), 3, writes, 0, NULL);
   else
-    vt->UpdateDescriptorSets(Unwrap(m_Device), 1, writes, 0, NULL);
+    vt->UpdateDescriptorSets(Unwrap(m_Device), 2, writes, 0, NULL);
 
   VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
@@ -4231,7 +4973,7 @@ uint32_t VulkanDebugManager::PickVertex(uint32_t eventID, const MeshDisplay &cfg
   DoPipelineBarrier(cmd, 1, &bufBarrier);
 
   // copy uploaded VB and if needed IB
-  if(!idxs.empty())
+  if(!cached && useIndices)
   {
     // wait for writes
     bufBarrier.buffer = Unwrap(m_MeshPickIBUpload.buf);
@@ -4251,29 +4993,38 @@ uint32_t VulkanDebugManager::PickVertex(uint32_t eventID, const MeshDisplay &cfg
     DoPipelineBarrier(cmd, 1, &bufBarrier);
   }
 
-  // wait for writes
-  bufBarrier.buffer = Unwrap(m_MeshPickVBUpload.buf);
-  bufBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+  if(!cached)
+  {
+    // wait for writes
+    bufBarrier.buffer = Unwrap(m_MeshPickVBUpload.buf);
+    bufBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+    bufBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    DoPipelineBarrier(cmd, 1, &bufBarrier);
 
-  // do copy
-  bufCopy.size = m_MeshPickVBSize;
-  vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_MeshPickVBUpload.buf), Unwrap(m_MeshPickVB.buf), 1,
-                    &bufCopy);
+    // do copy
+    bufCopy.size = m_MeshPickVBSize;
+    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_MeshPickVBUpload.buf), Unwrap(m_MeshPickVB.buf), 1,
+                      &bufCopy);
 
-  // wait for copy
-  bufBarrier.buffer = Unwrap(m_MeshPickVB.buf);
-  bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+    // wait for copy
+    bufBarrier.buffer = Unwrap(m_MeshPickVB.buf);
+    bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
+    DoPipelineBarrier(cmd, 1, &bufBarrier);
+  }
 
   vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(m_MeshPickPipeline));
   vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(m_MeshPickLayout),
                             0, 1, UnwrapPtr(m_MeshPickDescSet), 0, NULL);
 
-  uint32_t workgroupx = uint32_t(cfg.position.numVerts / 128 + 1);
-  vt->CmdDispatch(Unwrap(cmd), workgroupx, 1, 1);
+  // with grouped triangles each workgroup tests one group the ray hits, otherwise every vertex or
+  // primitive is tested
+  uint32_t workgroupx = uint32_t(cfg.position.numVerts / meshPickGroupSize + 1);
+  if(m_MeshPickPrims > 0)
+    workgroupx = numGroups;
+
+  if(workgroupx > 0)
+    vt->CmdDispatch(Unwrap(cmd), workgroupx, 1, 1);
 
   // wait for shader to finish writing before transferring to readback buffer
   bufBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
@@ -4451,19 +5202,41 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
   m_pDriver->SubmitCmds();
 #endif
 
+  // the destination offset and size of the chunk in flight in each readback slot. Chunks are
+  // spread over the slots so that the copy of one can overlap with reading back the previous
+  size_t chunkOffset[ReadbackSlotCount] = {};
+  size_t chunkLength[ReadbackSlotCount] = {};
+  bool chunkPending[ReadbackSlotCount] = {};
+
+  uint32_t slot = NextReadbackSlot();
+
   while(sizeRemaining > 0)
   {
     VkDeviceSize chunkSize = RDCMIN(sizeRemaining, STAGE_BUFFER_BYTE_SIZE);
 
+    // if this slot still has a chunk in flight from a previous iteration, read it out first
+    if(chunkPending[slot])
+    {
+      byte *pData = WaitReadback(slot);
+      memcpy(&ret[chunkOffset[slot]], pData, chunkLength[slot]);
+      EndReadback(slot);
+
+      chunkPending[slot] = false;
+    }
+
+    VkBuffer readbackBuf = BeginReadback(slot, chunkSize);
+
+    cmd = m_pDriver->GetNextCmd();
+
     vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     VkBufferCopy region = {srcoffset, 0, chunkSize};
-    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(m_ReadbackWindow.buf), 1, &region);
+    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), readbackBuf, 1, &region);
 
     bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     bufBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
-    bufBarrier.buffer = Unwrap(m_ReadbackWindow.buf);
+    bufBarrier.buffer = readbackBuf;
     bufBarrier.offset = 0;
     bufBarrier.size = chunkSize;
 
@@ -4473,24 +5246,365 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
     vkr = vt->EndCommandBuffer(Unwrap(cmd));
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
-
-    byte *pData = NULL;
-    vkr = vt->MapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem), 0, VK_WHOLE_SIZE, 0,
-                        (void **)&pData);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    SubmitReadback(slot);
 
-    RDCASSERT(pData != NULL);
-    memcpy(&ret[dstoffset], pData, (size_t)chunkSize);
+    chunkOffset[slot] = dstoffset;
+    chunkLength[slot] = (size_t)chunkSize;
+    chunkPending[slot] = true;
 
+    srcoffset += chunkSize;
     dstoffset += (size_t)chunkSize;
     sizeRemaining -= chunkSize;
 
-    vt->UnmapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem));
+    slot = NextReadbackSlot();
+  }
+
+  // read out whatever is still in flight
+  for(uint32_t i = 0; i < ReadbackSlotCount; i++)
+  {
+    if(!chunkPending[i])
+      continue;
+
+    byte *pData = WaitReadback(i);
+    memcpy(&ret[chunkOffset[i]], pData, chunkLength[i]);
+    EndReadback(i);
+  }
+
+  // recycle the command buffers we used, everything is complete by now
+  m_pDriver->FlushQ();
+}
+
+void VulkanDebugManager::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                        vector<vector<byte> > &ret)
+{
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  ret.resize(ranges.size());
+
+  struct BufferCopy
+  {
+    size_t idx;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize length;
+  };
+
+  vector<BufferCopy> copies;
+
+  for(size_t i = 0; i < ranges.size(); i++)
+  {
+    ResourceId buff = ranges[i].buffer;
+
+    VkBuffer srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
+
+    if(srcBuf == VK_NULL_HANDLE)
+    {
+      RDCERR("Getting buffer data for unknown buffer %llu!", buff);
+      continue;
+    }
+
+    uint64_t bufsize = m_pDriver->m_CreationInfo.m_Buffer[buff].size;
+
+    uint64_t offset = ranges[i].offset;
+    uint64_t len = ranges[i].length;
+
+    if(offset >= bufsize)
+      continue;
+
+    if(len == 0)
+      len = bufsize - offset;
+
+    len = RDCMIN(len, bufsize - offset);
+
+    // anything larger than a readback slot is read back in chunks on its own
+    if(len > STAGE_BUFFER_BYTE_SIZE)
+    {
+      GetBufferData(buff, offset, len, ret[i]);
+      continue;
+    }
+
+    BufferCopy copy = {i, Unwrap(srcBuf), offset, len};
+    copies.push_back(copy);
+  }
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vector<VkBufferMemoryBarrier> barriers;
+  vector<VkBufferCopy> regions;
+
+  // pack the rest side by side into a readback slot, so each fill of it needs only one submission
+  size_t c = 0;
+  while(c < copies.size())
+  {
+    size_t first = c;
+    VkDeviceSize used = 0;
+
+    barriers.clear();
+    regions.clear();
+
+    for(; c < copies.size() && used + copies[c].length <= STAGE_BUFFER_BYTE_SIZE; c++)
+    {
+      VkBufferMemoryBarrier bufBarrier = {
+          VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_ALL_WRITE_BITS,
+          VK_ACCESS_TRANSFER_READ_BIT,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          copies[c].buffer,
+          copies[c].offset,
+          copies[c].length,
+      };
+
+      VkBufferCopy region = {copies[c].offset, used, copies[c].length};
+
+      barriers.push_back(bufBarrier);
+      regions.push_back(region);
+
+      used += copies[c].length;
+    }
+
+    uint32_t slot = NextReadbackSlot();
+
+    VkBuffer readbackBuf = BeginReadback(slot, used);
+
+    VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+    VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    // wait for previous writes to happen before we copy to the readback buffer
+    DoPipelineBarrier(cmd, (uint32_t)barriers.size(), &barriers[0]);
+
+    for(size_t i = 0; i < regions.size(); i++)
+      vt->CmdCopyBuffer(Unwrap(cmd), barriers[i].buffer, readbackBuf, 1, &regions[i]);
+
+    VkBufferMemoryBarrier readBarrier = {
+        VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_ACCESS_HOST_READ_BIT,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        readbackBuf,
+        0,
+        used,
+    };
+
+    // wait for transfer to happen before we read
+    DoPipelineBarrier(cmd, 1, &readBarrier);
+
+    vkr = vt->EndCommandBuffer(Unwrap(cmd));
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    SubmitReadback(slot);
+
+    byte *pData = WaitReadback(slot);
+
+    VkDeviceSize readOffs = 0;
+    for(size_t i = first; i < c; i++)
+    {
+      vector<byte> &data = ret[copies[i].idx];
+      data.resize((size_t)copies[i].length);
+      memcpy(&data[0], pData + readOffs, (size_t)copies[i].length);
+      readOffs += copies[i].length;
+    }
+
+    EndReadback(slot);
+  }
+
+  // recycle the command buffers we used, everything is complete by now
+  m_pDriver->FlushQ();
+}
+
+uint32_t VulkanDebugManager::NextReadbackSlot()
+{
+  uint32_t ret = m_NextReadbackSlot;
+  m_NextReadbackSlot = (m_NextReadbackSlot + 1) % ReadbackSlotCount;
+  return ret;
+}
+
+void VulkanDebugManager::AllocStagingSlot(StagingSlot &slot, VkDeviceSize size, bool readback)
+{
+  VkDevice dev = m_Device;
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  VkResult vkr = VK_SUCCESS;
+
+  if(slot.fence == VK_NULL_HANDLE)
+  {
+    VkFenceCreateInfo fenceInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, 0};
+
+    vkr = vt->CreateFence(Unwrap(dev), &fenceInfo, NULL, &slot.fence);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  }
+
+  if(slot.size >= size)
+    return;
+
+  FreeStagingSlot(slot);
+
+  // round up so that slightly larger transfers don't each cause a reallocation
+  slot.size = AlignUp(size, (VkDeviceSize)(256 * 1024));
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      NULL,
+      0,
+      slot.size,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
+
+  vkr = vt->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &slot.buf);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  vt->GetBufferMemoryRequirements(Unwrap(dev), slot.buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      readback ? m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits)
+               : m_pDriver->GetUploadMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &slot.mem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = vt->BindBufferMemory(Unwrap(dev), slot.buf, slot.mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  // keep the memory persistently mapped, the fence tells us when it's safe to touch
+  vkr = vt->MapMemory(Unwrap(dev), slot.mem, 0, VK_WHOLE_SIZE, 0, (void **)&slot.data);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+}
+
+void VulkanDebugManager::FreeStagingSlot(StagingSlot &slot)
+{
+  VkDevice dev = m_Device;
+
+  if(slot.buf == VK_NULL_HANDLE)
+    return;
+
+  ObjDisp(dev)->UnmapMemory(Unwrap(dev), slot.mem);
+  ObjDisp(dev)->DestroyBuffer(Unwrap(dev), slot.buf, NULL);
+  ObjDisp(dev)->FreeMemory(Unwrap(dev), slot.mem, NULL);
+
+  slot.buf = VK_NULL_HANDLE;
+  slot.mem = VK_NULL_HANDLE;
+  slot.data = NULL;
+  slot.size = 0;
+}
+
+void VulkanDebugManager::WaitStagingSlot(StagingSlot &slot)
+{
+  if(!slot.submitted)
+    return;
+
+  VkResult vkr =
+      ObjDisp(m_Device)->WaitForFences(Unwrap(m_Device), 1, &slot.fence, VK_TRUE, UINT64_MAX);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  slot.submitted = false;
+}
+
+VkBuffer VulkanDebugManager::BeginReadback(uint32_t slotIdx, VkDeviceSize size)
+{
+  StagingSlot &slot = m_ReadbackSlots[slotIdx];
+
+  // if the previous readback in this slot was never waited on, it must finish before we reuse
+  // the buffer
+  if(slot.submitted)
+  {
+    WaitReadback(slotIdx);
+    EndReadback(slotIdx);
   }
 
-  vt->DeviceWaitIdle(Unwrap(dev));
+  AllocStagingSlot(slot, size, true);
+
+  return slot.buf;
+}
+
+void VulkanDebugManager::SubmitReadback(uint32_t slotIdx)
+{
+  StagingSlot &slot = m_ReadbackSlots[slotIdx];
+
+  VkResult vkr = ObjDisp(m_Device)->ResetFences(Unwrap(m_Device), 1, &slot.fence);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->SubmitCmds(slot.fence);
+
+  slot.submitted = true;
+}
+
+byte *VulkanDebugManager::WaitReadback(uint32_t slotIdx)
+{
+  StagingSlot &slot = m_ReadbackSlots[slotIdx];
+
+  WaitStagingSlot(slot);
+
+  RDCASSERT(slot.data != NULL);
+
+  return slot.data;
+}
+
+void VulkanDebugManager::EndReadback(uint32_t slotIdx)
+{
+  // don't hang on to very large readbacks (e.g. a whole texture), only keep the staging-sized
+  // buffers around for re-use
+  if(m_ReadbackSlots[slotIdx].size > STAGE_BUFFER_BYTE_SIZE)
+    FreeStagingSlot(m_ReadbackSlots[slotIdx]);
+}
+
+uint32_t VulkanDebugManager::NextUploadSlot()
+{
+  uint32_t ret = m_NextUploadSlot;
+  m_NextUploadSlot = (m_NextUploadSlot + 1) % UploadSlotCount;
+  return ret;
+}
+
+byte *VulkanDebugManager::BeginUpload(uint32_t slotIdx, VkDeviceSize size, VkBuffer &buf)
+{
+  StagingSlot &slot = m_UploadSlots[slotIdx];
+
+  // the ring has wrapped around onto an upload that may still be reading from this buffer
+  WaitStagingSlot(slot);
+
+  // as with readbacks, only keep staging-sized buffers around
+  if(slot.size > STAGE_BUFFER_BYTE_SIZE && size <= STAGE_BUFFER_BYTE_SIZE)
+    FreeStagingSlot(slot);
+
+  AllocStagingSlot(slot, size, false);
+
+  buf = slot.buf;
+  return slot.data;
+}
+
+void VulkanDebugManager::SubmitUpload(uint32_t slotIdx)
+{
+  StagingSlot &slot = m_UploadSlots[slotIdx];
+
+  // upload memory isn't necessarily coherent
+  VkMappedMemoryRange range = {
+      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, slot.mem, 0, VK_WHOLE_SIZE,
+  };
+
+  VkResult vkr = ObjDisp(m_Device)->FlushMappedMemoryRanges(Unwrap(m_Device), 1, &range);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = ObjDisp(m_Device)->ResetFences(Unwrap(m_Device), 1, &slot.fence);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->SubmitCmds(slot.fence);
+
+  slot.submitted = true;
+}
+
+void VulkanDebugManager::FlushUploads()
+{
+  for(uint32_t i = 0; i < UploadSlotCount; i++)
+    WaitStagingSlot(m_UploadSlots[i]);
 }
 
 void VulkanDebugManager::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo,
@@ -4533,8 +5647,8 @@ void VulkanDebugManager::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &
         specInfo[i].pMapEntries = entry;
         specInfo[i].mapEntryCount = (uint32_t)pipeInfo.shaders[i].specialization.size();
 
-        byte *minDataPtr = NULL;
-        byte *maxDataPtr = NULL;
+        const byte *minDataPtr = NULL;
+        const byte *maxDataPtr = NULL;
 
         for(size_t s = 0; s < pipeInfo.shaders[i].specialization.size(); s++)
         {
@@ -4757,8 +5871,8 @@ void VulkanDebugManager::MakeComputePipelineInfo(VkComputePipelineCreateInfo &pi
     specInfo.pMapEntries = entry;
     specInfo.mapEntryCount = (uint32_t)pipeInfo.shaders[i].specialization.size();
 
-    byte *minDataPtr = NULL;
-    byte *maxDataPtr = NULL;
+    const byte *minDataPtr = NULL;
+    const byte *maxDataPtr = NULL;
 
     for(size_t s = 0; s < pipeInfo.shaders[i].specialization.size(); s++)
     {
@@ -7907,6 +9021,8 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
   if(m_PostVSData.find(eventID) != m_PostVSData.end())
     return;
 
+  ScopedReplayMemoryCategory memCategory(m_pDriver, eReplayMemory_PostVSCache);
+
   if(!m_pDriver->GetDeviceFeatures().vertexPipelineStoresAndAtomics)
     return;
 
@@ -8103,7 +9219,9 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
     numIndices =
         RDCMIN(uint32_t(index16 ? idxdata.size() / 2 : idxdata.size() / 4), drawcall->numIndices);
 
-    // grab all unique vertex indices referenced
+    vector<uint32_t> remapped;
+    remapped.reserve(numIndices + 1);
+
     for(uint32_t i = 0; i < numIndices; i++)
     {
       uint32_t i32 = index16 ? uint32_t(idx16[i]) : idx32[i];
@@ -8111,20 +9229,17 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
       // we clamp to maxIdx here, to avoid any invalid indices like 0xffffffff
       // from filtering through. Worst case we index to the end of the vertex
       // buffers which is generally much more reasonable
-      i32 = RDCMIN(maxIdx, i32);
-
-      auto it = std::lower_bound(indices.begin(), indices.end(), i32);
-
-      if(it != indices.end() && *it == i32)
-        continue;
-
-      indices.insert(it, i32);
+      remapped.push_back(RDCMIN(maxIdx, i32));
     }
 
     // if we read out of bounds, we'll also have a 0 index being referenced
-    // (as 0 is read). Don't insert 0 if we already have 0 though
-    if(numIndices < drawcall->numIndices && (indices.empty() || indices[0] != 0))
-      indices.insert(indices.begin(), 0);
+    // (as 0 is read).
+    if(numIndices < drawcall->numIndices)
+      remapped.push_back(0);
+
+    // grab all unique vertex indices referenced, sorted. The output buffer below is still
+    // addressed by index - minIndex so the compacted indices themselves aren't needed.
+    CompactIndices(remapped, indices);
 
     minIndex = indices[0];
     maxIndex = indices[indices.size() - 1];
@@ -8641,6 +9756,60 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
   m_pDriver->vkDestroyShaderModule(dev, module, NULL);
 }
 
+uint64_t VulkanDebugManager::GetPostVSDataSize(const VulkanPostVSData &data)
+{
+  return m_pDriver->GetReplayAllocationSize(data.vsout.bufmem) +
+         m_pDriver->GetReplayAllocationSize(data.vsout.idxBufMem);
+}
+
+void VulkanDebugManager::TrimPostVSCache(uint64_t budget, uint32_t eventID)
+{
+  if(m_PostVSAlias.find(eventID) != m_PostVSAlias.end())
+    eventID = m_PostVSAlias[eventID];
+
+  uint64_t total = 0;
+
+  // the events furthest from the current one are evicted first, as they're the least likely to
+  // be looked at again soon
+  vector<pair<uint32_t, uint32_t> > candidates;
+
+  for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+  {
+    uint64_t size = GetPostVSDataSize(it->second);
+    total += size;
+
+    if(it->first != eventID && size > 0)
+    {
+      uint32_t dist = it->first > eventID ? it->first - eventID : eventID - it->first;
+      candidates.push_back(std::make_pair(dist, it->first));
+    }
+  }
+
+  if(total <= budget || candidates.empty())
+    return;
+
+  std::sort(candidates.rbegin(), candidates.rend());
+
+  // the buffers could still be referenced by a mesh render in flight
+  m_pDriver->FlushQ();
+
+  VkDevice dev = m_Device;
+
+  for(size_t i = 0; i < candidates.size() && total > budget; i++)
+  {
+    VulkanPostVSData &data = m_PostVSData[candidates[i].second];
+
+    total -= GetPostVSDataSize(data);
+
+    m_pDriver->vkDestroyBuffer(dev, data.vsout.buf, NULL);
+    m_pDriver->vkDestroyBuffer(dev, data.vsout.idxBuf, NULL);
+    m_pDriver->vkFreeMemory(dev, data.vsout.bufmem, NULL);
+    m_pDriver->vkFreeMemory(dev, data.vsout.idxBufMem, NULL);
+
+    m_PostVSData.erase(candidates[i].second);
+  }
+}
+
 MeshFormat VulkanDebugManager::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
 {
   // go through any aliasing
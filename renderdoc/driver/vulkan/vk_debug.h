@@ -25,6 +25,7 @@
 #pragma once
 
 #include "api/replay/renderdoc_replay.h"
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "replay/replay_driver.h"
 #include "vk_common.h"
@@ -118,7 +119,32 @@ public:
   // indicates that EID alias is the same as eventID
   void AliasPostVSBuffers(uint32_t eventID, uint32_t alias) { m_PostVSAlias[alias] = eventID; }
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
+  // frees cached post-VS data for other events until the cache fits in budget bytes
+  void TrimPostVSCache(uint64_t budget, uint32_t eventID);
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &ret);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &ret);
+
+  // persistent ring of host-visible readback buffers, each with its own fence, so readbacks don't
+  // need to allocate and several can be in flight at once. Returns the (unwrapped) buffer in the
+  // slot, large enough for size bytes - waiting on any previous use of the slot first.
+  uint32_t NextReadbackSlot();
+  VkBuffer BeginReadback(uint32_t slot, VkDeviceSize size);
+  // submits all pending internal command buffers, signalling the slot's fence on completion
+  void SubmitReadback(uint32_t slot);
+  // waits for the slot's readback to complete and returns a pointer to its mapped data. The data
+  // stays valid until EndReadback
+  byte *WaitReadback(uint32_t slot);
+  void EndReadback(uint32_t slot);
+
+  // the same for uploads: returns the slot's persistently mapped data, large enough for size
+  // bytes, and its (unwrapped) buffer to copy from. Only waits if the previous upload through the
+  // slot is still in flight, so consecutive uploads overlap with filling the next slot.
+  uint32_t NextUploadSlot();
+  byte *BeginUpload(uint32_t slot, VkDeviceSize size, VkBuffer &buf);
+  // submits all pending internal command buffers, signalling the slot's fence on completion
+  void SubmitUpload(uint32_t slot);
+  // waits for any uploads still in flight
+  void FlushUploads();
 
   FloatVector InterpretVertex(byte *data, uint32_t vert, const MeshDisplay &cfg, byte *end,
                               bool &valid);
@@ -134,9 +160,15 @@ public:
   void CreateCustomShaderTex(uint32_t width, uint32_t height, uint32_t mip);
   void CreateCustomShaderPipeline(ResourceId shader);
 
+  void CreateTexDiffImage(uint32_t idx, uint32_t width, uint32_t height);
+
   void ReplaceResource(ResourceId from, ResourceId to);
   void RemoveReplacement(ResourceId id);
 
+  vector<PixelModification> PixelHistory(vector<EventUsage> events, ResourceId target, uint32_t x,
+                                         uint32_t y, uint32_t slice, uint32_t mip,
+                                         uint32_t sampleIdx, FormatComponentType typeHint);
+
   struct GPUBuffer
   {
     enum CreateFlags
@@ -308,6 +340,32 @@ public:
   VkPipeline m_MinMaxTilePipe[eTexType_Max][3];    // float, uint, sint
   VkPipeline m_MinMaxResultPipe[3];                // float, uint, sint
 
+  // value search uses the histogram layout and descriptor set. Only float textures are searched.
+  VkPipeline m_ValueSearchTexPipe[eTexType_Max];
+  VkPipeline m_ValueSearchBufPipe;
+  GPUBuffer m_ValueSearchUBO;
+  // sized on demand, for the number of matches to store and the size of the searched buffer
+  GPUBuffer m_ValueSearchResult, m_ValueSearchReadback;
+  GPUBuffer m_ValueSearchSrc;
+  VkDeviceSize m_ValueSearchResultSize, m_ValueSearchSrcSize;
+
+  // texture diff. Images 0 and 1 are raw RGBA32F renders of the compared subresources and the
+  // output holds the difference. All stay in the general layout, to be rendered to and then
+  // loaded as storage images, and the output is displayed like any other texture.
+  static const uint32_t TexDiffOutput = 2;
+  uint32_t m_TexDiffWidth[3], m_TexDiffHeight[3];
+  VkImage m_TexDiffImg[3];
+  VkDeviceMemory m_TexDiffMem[3];
+  VkImageView m_TexDiffView[3];
+  VkFramebuffer m_TexDiffFB[3];
+  VkRenderPass m_TexDiffRP;
+  VkDescriptorSetLayout m_TexDiffDescSetLayout;
+  VkPipelineLayout m_TexDiffPipeLayout;
+  VkDescriptorSet m_TexDiffDescSet;
+  VkPipeline m_TexDiffPipe;
+  GPUBuffer m_TexDiffUBO;
+  GPUBuffer m_TexDiffResult, m_TexDiffReadback;    // Vec4u[2] max error bits, differing count
+
   static const int maxMeshPicks = 500;
 
   GPUBuffer m_MeshPickUBO;
@@ -315,6 +373,29 @@ public:
   GPUBuffer m_MeshPickVB, m_MeshPickVBUpload;
   uint32_t m_MeshPickIBSize, m_MeshPickVBSize;
   GPUBuffer m_MeshPickResult, m_MeshPickResultReadback;
+
+  // the mesh last uploaded to m_MeshPickVB/IB is kept, so repeated picks in the same mesh only
+  // re-run the test. Triangles are also split into groups of one workgroup each with their
+  // bounds, and only the groups the pick ray passes through are dispatched.
+  struct MeshPickBounds
+  {
+    Vec3f minBounds, maxBounds;
+  };
+
+  static const uint32_t meshPickGroupSize = 128;    // must match local_size_x in mesh.comp
+
+  bool m_MeshPickCached;
+  uint32_t m_MeshPickEventID;
+  MeshFormat m_MeshPickFormat;
+  uint32_t m_MeshPickPrims;
+  vector<MeshPickBounds> m_MeshPickGroupBounds;
+  GPUBuffer m_MeshPickGroups;
+  uint32_t m_MeshPickGroupsSize;
+
+  bool IsMeshPickCached(uint32_t eventID, const MeshDisplay &cfg);
+  void BuildMeshPickGroups(const MeshDisplay &cfg, const vector<FloatVector> &verts,
+                           const vector<uint32_t> &idxs);
+
   VkDescriptorSetLayout m_MeshPickDescSetLayout;
   VkDescriptorSet m_MeshPickDescSet;
   VkPipelineLayout m_MeshPickLayout;
@@ -326,7 +407,27 @@ public:
   VkPipeline m_OutlinePipeline[8];
   GPUBuffer m_OutlineUBO;
 
-  GPUBuffer m_ReadbackWindow;
+  struct StagingSlot
+  {
+    VkBuffer buf;
+    VkDeviceMemory mem;
+    VkFence fence;
+    VkDeviceSize size;
+    byte *data;
+    bool submitted;
+  };
+
+  void AllocStagingSlot(StagingSlot &slot, VkDeviceSize size, bool readback);
+  void FreeStagingSlot(StagingSlot &slot);
+  void WaitStagingSlot(StagingSlot &slot);
+
+  static const uint32_t ReadbackSlotCount = 4;
+  StagingSlot m_ReadbackSlots[ReadbackSlotCount];
+  uint32_t m_NextReadbackSlot;
+
+  static const uint32_t UploadSlotCount = 4;
+  StagingSlot m_UploadSlots[UploadSlotCount];
+  uint32_t m_NextUploadSlot;
 
   VkDescriptorSetLayout m_MeshFetchDescSetLayout;
   VkDescriptorSet m_MeshFetchDescSet;
@@ -342,13 +443,16 @@ private:
 
   VulkanResourceManager *GetResourceManager() { return m_ResourceManager; }
   static const uint32_t m_ShaderCacheMagic = 0xf00d00d5;
-  static const uint32_t m_ShaderCacheVersion = 1;
+  static const uint32_t m_ShaderCacheVersion = 2;
 
   bool m_ShaderCacheDirty, m_CacheShaders;
   map<uint32_t, vector<uint32_t> *> m_ShaderCache;
+  ShaderCacheFile m_ShaderCacheFile;
 
   string GetSPIRVBlob(SPIRVShaderStage shadType, const std::vector<std::string> &sources,
                       vector<uint32_t> **outBlob);
+  void PrecompileSPIRVBlobs(const std::vector<SPIRVShaderStage> &stages,
+                            const std::vector<std::vector<std::string> > &sources);
 
   void CopyDepthTex2DMSToArray(VkImage destArray, VkImage srcMS, VkExtent3D extent, uint32_t layers,
                                uint32_t samples, VkFormat fmt);
@@ -357,6 +461,12 @@ private:
 
   void PatchFixedColShader(VkShaderModule &mod, float col[4]);
 
+  friend struct VulkanPixelHistoryCallback;
+
+  VkImageLayout GetCurrentImageLayout(VkCommandBuffer cmd, ResourceId image,
+                                      const VkImageSubresource &sub);
+  bool IsRecordingSecondaryCmd();
+
   void RenderTextInternal(const TextPrintState &textstate, float x, float y, const char *text);
   static const uint32_t FONT_TEX_WIDTH = 256;
   static const uint32_t FONT_TEX_HEIGHT = 128;
@@ -372,6 +482,7 @@ private:
 
   map<uint32_t, VulkanPostVSData> m_PostVSData;
   map<uint32_t, uint32_t> m_PostVSAlias;
+  uint64_t GetPostVSDataSize(const VulkanPostVSData &data);
 
   WrappedVulkan *m_pDriver;
   VulkanResourceManager *m_ResourceManager;
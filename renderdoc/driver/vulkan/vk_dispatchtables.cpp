@@ -160,11 +160,82 @@ void InitDeviceExtensionTables(VkDevice device)
 
 #undef DeviceGPA
 
-static Threading::CriticalSection devlock;
-std::map<void *, VkLayerDispatchTableExtended> devlookup;
+// there are only ever a handful of devices and instances, created rarely, but their tables are
+// looked up every time an object is created. The tables live in fixed arrays that are written
+// under a lock when the device or instance is created, and read without one. The key is stored
+// before count is published with a release store, and Find reads count with an acquire load so
+// it never sees a new count before the key it covers, on weakly-ordered CPUs too.
+// The table contents are filled in after Create returns, and are published by the application
+// having to synchronise handing the new handle to another thread.
+template <typename TableType>
+struct DispatchTableLookup
+{
+  enum
+  {
+    MaxTables = 16
+  };
+
+  void *keys[MaxTables];
+  TableType tables[MaxTables];
+  volatile int32_t count;
+
+  // only used beyond MaxTables, always under the lock
+  Threading::CriticalSection lock;
+  std::map<void *, TableType> overflow;
+
+  TableType *Create(void *key)
+  {
+    SCOPED_LOCK(lock);
+
+    // the loader can re-use a key once its device or instance has been destroyed
+    for(int32_t i = 0; i < count; i++)
+    {
+      if(keys[i] == key)
+      {
+        RDCEraseEl(tables[i]);
+        return &tables[i];
+      }
+    }
+
+    if(count < MaxTables)
+    {
+      int32_t idx = count;
+      RDCEraseEl(tables[idx]);
+      keys[idx] = key;
+      Atomic::StoreRelease32(&count, idx + 1);
+      return &tables[idx];
+    }
+
+    RDCEraseEl(overflow[key]);
+    return &overflow[key];
+  }
+
+  TableType *Find(void *key)
+  {
+    // pairs with the release store in Create. A plain load, so lookups from many threads don't
+    // contend for the cache line
+    int32_t num = Atomic::LoadAcquire32(&count);
 
-static Threading::CriticalSection instlock;
-std::map<void *, VkLayerInstanceDispatchTableExtended> instlookup;
+    for(int32_t i = 0; i < num; i++)
+      if(keys[i] == key)
+        return &tables[i];
+
+    if(num < MaxTables)
+      return NULL;
+
+    SCOPED_LOCK(lock);
+
+    auto it = overflow.find(key);
+
+    if(it == overflow.end())
+      return NULL;
+
+    return &it->second;
+  }
+};
+
+static DispatchTableLookup<VkLayerDispatchTableExtended> devlookup;
+static DispatchTableLookup<VkLayerInstanceDispatchTableExtended> instlookup;
 
 static void *GetKey(void *obj)
 {
@@ -174,15 +245,7 @@ static void *GetKey(void *obj)
 
 void InitDeviceTable(VkDevice dev, PFN_vkGetDeviceProcAddr gpa)
 {
-  void *key = GetKey(dev);
-
-  VkLayerDispatchTableExtended *table = NULL;
-
-  {
-    SCOPED_LOCK(devlock);
-    RDCEraseEl(devlookup[key]);
-    table = &devlookup[key];
-  }
+  VkLayerDispatchTableExtended *table = devlookup.Create(GetKey(dev));
 
   table->GetDeviceProcAddr = gpa;
 
@@ -197,15 +260,7 @@ void InitDeviceTable(VkDevice dev, PFN_vkGetDeviceProcAddr gpa)
 
 void InitInstanceTable(VkInstance inst, PFN_vkGetInstanceProcAddr gpa)
 {
-  void *key = GetKey(inst);
-
-  VkLayerInstanceDispatchTableExtended *table = NULL;
-
-  {
-    SCOPED_LOCK(instlock);
-    RDCEraseEl(instlookup[key]);
-    table = &instlookup[key];
-  }
+  VkLayerInstanceDispatchTableExtended *table = instlookup.Create(GetKey(inst));
 
   // init the GetInstanceProcAddr function first
   table->GetInstanceProcAddr = gpa;
@@ -228,18 +283,12 @@ VkLayerDispatchTableExtended *GetDeviceDispatchTable(void *device)
   if(replay)
     return &replayDeviceTable;
 
-  void *key = GetKey(device);
-
-  {
-    SCOPED_LOCK(devlock);
+  VkLayerDispatchTableExtended *table = devlookup.Find(GetKey(device));
 
-    auto it = devlookup.find(key);
+  if(table == NULL)
+    RDCFATAL("Bad device pointer");
 
-    if(it == devlookup.end())
-      RDCFATAL("Bad device pointer");
-
-    return &it->second;
-  }
+  return table;
 }
 
 VkLayerInstanceDispatchTableExtended *GetInstanceDispatchTable(void *instance)
@@ -247,16 +296,10 @@ VkLayerInstanceDispatchTableExtended *GetInstanceDispatchTable(void *instance)
   if(replay)
     return &replayInstanceTable;
 
-  void *key = GetKey(instance);
-
-  {
-    SCOPED_LOCK(instlock);
-
-    auto it = instlookup.find(key);
+  VkLayerInstanceDispatchTableExtended *table = instlookup.Find(GetKey(instance));
 
-    if(it == instlookup.end())
-      RDCFATAL("Bad device pointer");
+  if(table == NULL)
+    RDCFATAL("Bad device pointer");
 
-    return &it->second;
-  }
+  return table;
 }
@@ -269,15 +269,16 @@
   CheckExt(VK_EXT_direct_mode_display);             \
   CheckExt(VK_EXT_acquire_xlib_display);
 
-#define CheckDeviceExts()                \
-  CheckExt(VK_EXT_debug_marker);         \
-  CheckExt(VK_KHR_swapchain);            \
-  CheckExt(VK_KHR_display_swapchain);    \
-  CheckExt(VK_NV_external_memory);       \
-  CheckExt(VK_NV_external_memory_win32); \
-  CheckExt(VK_NV_win32_keyed_mutex);     \
-  CheckExt(VK_KHR_maintenance1);         \
-  CheckExt(VK_EXT_display_control);
+#define CheckDeviceExts()                     \
+  CheckExt(VK_EXT_debug_marker);              \
+  CheckExt(VK_KHR_swapchain);                 \
+  CheckExt(VK_KHR_display_swapchain);         \
+  CheckExt(VK_NV_external_memory);            \
+  CheckExt(VK_NV_external_memory_win32);      \
+  CheckExt(VK_NV_win32_keyed_mutex);          \
+  CheckExt(VK_KHR_maintenance1);              \
+  CheckExt(VK_EXT_display_control);           \
+  CheckExt(VK_KHR_descriptor_update_template);
 
 #define HookInitVulkanInstanceExts()                                                                \
   HookInitExtension(VK_KHR_surface, DestroySurfaceKHR);                                             \
@@ -311,23 +312,26 @@
   HookInitExtension(VK_EXT_display_surface_counter, GetPhysicalDeviceSurfaceCapabilities2EXT);      \
   HookInitInstance_PlatformSpecific()
 
-#define HookInitVulkanDeviceExts()                                        \
-  HookInitExtension(VK_EXT_debug_marker, DebugMarkerSetObjectTagEXT);     \
-  HookInitExtension(VK_EXT_debug_marker, DebugMarkerSetObjectNameEXT);    \
-  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerBeginEXT);         \
-  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerEndEXT);           \
-  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerInsertEXT);        \
-  HookInitExtension(VK_KHR_swapchain, CreateSwapchainKHR);                \
-  HookInitExtension(VK_KHR_swapchain, DestroySwapchainKHR);               \
-  HookInitExtension(VK_KHR_swapchain, GetSwapchainImagesKHR);             \
-  HookInitExtension(VK_KHR_swapchain, AcquireNextImageKHR);               \
-  HookInitExtension(VK_KHR_swapchain, QueuePresentKHR);                   \
-  HookInitExtension(VK_KHR_display_swapchain, CreateSharedSwapchainsKHR); \
-  HookInitExtension(VK_KHR_maintenance1, TrimCommandPoolKHR);             \
-  HookInitExtension(VK_EXT_display_control, DisplayPowerControlEXT);      \
-  HookInitExtension(VK_EXT_display_control, RegisterDeviceEventEXT);      \
-  HookInitExtension(VK_EXT_display_control, RegisterDisplayEventEXT);     \
-  HookInitExtension(VK_EXT_display_control, GetSwapchainCounterEXT);      \
+#define HookInitVulkanDeviceExts()                                                          \
+  HookInitExtension(VK_EXT_debug_marker, DebugMarkerSetObjectTagEXT);                       \
+  HookInitExtension(VK_EXT_debug_marker, DebugMarkerSetObjectNameEXT);                      \
+  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerBeginEXT);                           \
+  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerEndEXT);                             \
+  HookInitExtension(VK_EXT_debug_marker, CmdDebugMarkerInsertEXT);                          \
+  HookInitExtension(VK_KHR_swapchain, CreateSwapchainKHR);                                  \
+  HookInitExtension(VK_KHR_swapchain, DestroySwapchainKHR);                                 \
+  HookInitExtension(VK_KHR_swapchain, GetSwapchainImagesKHR);                               \
+  HookInitExtension(VK_KHR_swapchain, AcquireNextImageKHR);                                 \
+  HookInitExtension(VK_KHR_swapchain, QueuePresentKHR);                                     \
+  HookInitExtension(VK_KHR_display_swapchain, CreateSharedSwapchainsKHR);                   \
+  HookInitExtension(VK_KHR_maintenance1, TrimCommandPoolKHR);                               \
+  HookInitExtension(VK_EXT_display_control, DisplayPowerControlEXT);                        \
+  HookInitExtension(VK_EXT_display_control, RegisterDeviceEventEXT);                        \
+  HookInitExtension(VK_EXT_display_control, RegisterDisplayEventEXT);                       \
+  HookInitExtension(VK_EXT_display_control, GetSwapchainCounterEXT);                        \
+  HookInitExtension(VK_KHR_descriptor_update_template, CreateDescriptorUpdateTemplateKHR);  \
+  HookInitExtension(VK_KHR_descriptor_update_template, DestroyDescriptorUpdateTemplateKHR); \
+  HookInitExtension(VK_KHR_descriptor_update_template, UpdateDescriptorSetWithTemplateKHR); \
   HookInitDevice_PlatformSpecific()
 
 #define DefineHooks()                                                                                \
@@ -682,6 +686,16 @@
               VkExternalImageFormatPropertiesNV *, pExternalImageFormatProperties);                  \
   HookDefine3(void, vkTrimCommandPoolKHR, VkDevice, device, VkCommandPool, commandPool,              \
               VkCommandPoolTrimFlagsKHR, flags);                                                     \
+  HookDefine4(VkResult, vkCreateDescriptorUpdateTemplateKHR, VkDevice, device,                       \
+              const VkDescriptorUpdateTemplateCreateInfoKHR *, pCreateInfo,                          \
+              const VkAllocationCallbacks *, pAllocator, VkDescriptorUpdateTemplateKHR *,            \
+              pDescriptorUpdateTemplate);                                                            \
+  HookDefine3(void, vkDestroyDescriptorUpdateTemplateKHR, VkDevice, device,                          \
+              VkDescriptorUpdateTemplateKHR, descriptorUpdateTemplate,                               \
+              const VkAllocationCallbacks *, pAllocator);                                            \
+  HookDefine4(void, vkUpdateDescriptorSetWithTemplateKHR, VkDevice, device, VkDescriptorSet,         \
+              descriptorSet, VkDescriptorUpdateTemplateKHR, descriptorUpdateTemplate,                \
+              const void *, pData);                                                                  \
   HookDefine2(void, vkGetPhysicalDeviceFeatures2KHR, VkPhysicalDevice, physicalDevice,               \
               VkPhysicalDeviceFeatures2KHR *, pFeatures);                                            \
   HookDefine2(void, vkGetPhysicalDeviceProperties2KHR, VkPhysicalDevice, physicalDevice,             \
@@ -25,6 +25,57 @@
 #include "vk_info.h"
 #include "3rdparty/glslang/SPIRV/spirv.hpp"
 
+InternPool::~InternPool()
+{
+  for(auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    for(size_t i = 0; i < it->second.size(); i++)
+      delete[] it->second[i].data;
+}
+
+const byte *InternPool::Intern(const byte *data, size_t size)
+{
+  // djb2 as in strhash, seeded with the size
+  uint32_t hash = 5381 + (uint32_t)size;
+  for(size_t i = 0; i < size; i++)
+    hash = ((hash << 5) + hash) + data[i];
+
+  vector<Entry> &bucket = m_Entries[hash];
+
+  for(size_t i = 0; i < bucket.size(); i++)
+    if(bucket[i].size == size && !memcmp(bucket[i].data, data, size))
+      return bucket[i].data;
+
+  Entry e;
+  e.data = new byte[size];
+  e.size = size;
+  memcpy(e.data, data, size);
+  bucket.push_back(e);
+
+  return e.data;
+}
+
+static void InternSpecialization(InternPool &pool, VulkanCreationInfo::Pipeline::Shader &shad,
+                                 const VkSpecializationInfo *specInfo)
+{
+  if(specInfo == NULL || specInfo->dataSize == 0)
+    return;
+
+  const byte *specdata = pool.Intern((const byte *)specInfo->pData, specInfo->dataSize);
+
+  vector<VulkanCreationInfo::Pipeline::Shader::SpecInfo> specialization;
+  specialization.resize(specInfo->mapEntryCount);
+
+  for(uint32_t s = 0; s < specInfo->mapEntryCount; s++)
+  {
+    specialization[s].specID = specInfo->pMapEntries[s].constantID;
+    specialization[s].data = specdata + specInfo->pMapEntries[s].offset;
+    // ignore pMapEntries[s].size, assume it's enough for the type
+    specialization[s].size = specInfo->pMapEntries[s].size;
+  }
+
+  shad.specialization = pool.Intern(specialization);
+}
+
 void DescSetLayout::Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
                          const VkDescriptorSetLayoutCreateInfo *pCreateInfo)
 {
@@ -81,6 +132,128 @@ void DescSetLayout::CreateBindingsArray(vector<DescriptorSetSlot *> &descBinding
   }
 }
 
+void DescUpdateTemplate::Init(const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo)
+{
+  entries.assign(pCreateInfo->pDescriptorUpdateEntries,
+                 pCreateInfo->pDescriptorUpdateEntries + pCreateInfo->descriptorUpdateEntryCount);
+
+  packedOffsets.resize(entries.size());
+  packedSize = 0;
+  dataSize = 0;
+
+  for(size_t i = 0; i < entries.size(); i++)
+  {
+    const VkDescriptorUpdateTemplateEntryKHR &entry = entries[i];
+    const size_t size = DescriptorSize(entry.descriptorType);
+
+    packedOffsets[i] = packedSize;
+    packedSize += size * entry.descriptorCount;
+
+    if(entry.descriptorCount > 0)
+      dataSize = RDCMAX(dataSize, entry.offset + entry.stride * (entry.descriptorCount - 1) + size);
+  }
+}
+
+size_t DescUpdateTemplate::DescriptorSize(VkDescriptorType type)
+{
+  switch(type)
+  {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: return sizeof(VkDescriptorImageInfo);
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: return sizeof(VkBufferView);
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: return sizeof(VkDescriptorBufferInfo);
+    default: RDCERR("Unexpected descriptor type %d", type);
+  }
+
+  return 0;
+}
+
+void DescUpdateTemplate::Pack(const void *pData, byte *packed) const
+{
+  const byte *src = (const byte *)pData;
+
+  for(size_t i = 0; i < entries.size(); i++)
+  {
+    const VkDescriptorUpdateTemplateEntryKHR &entry = entries[i];
+    const size_t size = DescriptorSize(entry.descriptorType);
+
+    byte *dst = packed + packedOffsets[i];
+
+    for(uint32_t d = 0; d < entry.descriptorCount; d++, dst += size)
+    {
+      memcpy(dst, src + entry.offset + entry.stride * d, size);
+
+      // the application doesn't have to fill in fields that the descriptor type ignores, so they
+      // could be garbage. Clear them so they aren't dereferenced as handles.
+      VkDescriptorImageInfo *info = (VkDescriptorImageInfo *)dst;
+
+      switch(entry.descriptorType)
+      {
+        case VK_DESCRIPTOR_TYPE_SAMPLER: info->imageView = VK_NULL_HANDLE; break;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: info->sampler = VK_NULL_HANDLE; break;
+        default: break;
+      }
+    }
+  }
+}
+
+void DescUpdateTemplate::MakeWrites(VkDescriptorSet set, byte *packed,
+                                    vector<VkWriteDescriptorSet> &writes) const
+{
+  for(size_t i = 0; i < entries.size(); i++)
+  {
+    const VkDescriptorUpdateTemplateEntryKHR &entry = entries[i];
+
+    VkWriteDescriptorSet write = {
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        NULL,
+        set,
+        entry.dstBinding,
+        entry.dstArrayElement,
+        entry.descriptorCount,
+        entry.descriptorType,
+        NULL,
+        NULL,
+        NULL,
+    };
+
+    byte *data = packed + packedOffsets[i];
+
+    switch(entry.descriptorType)
+    {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+      case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        write.pImageInfo = (VkDescriptorImageInfo *)data;
+        break;
+      case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        write.pTexelBufferView = (VkBufferView *)data;
+        break;
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        write.pBufferInfo = (VkDescriptorBufferInfo *)data;
+        break;
+      default: continue;
+    }
+
+    writes.push_back(write);
+  }
+}
+
 void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
                                         const VkGraphicsPipelineCreateInfo *pCreateInfo)
 {
@@ -115,23 +288,7 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
           ShaderStageType(reflData.stage), reflData.entryPoint, &reflData.refl, &reflData.mapping);
     }
 
-    if(pCreateInfo->pStages[i].pSpecializationInfo)
-    {
-      shad.specdata.resize(pCreateInfo->pStages[i].pSpecializationInfo->dataSize);
-      memcpy(&shad.specdata[0], pCreateInfo->pStages[i].pSpecializationInfo->pData,
-             shad.specdata.size());
-
-      const VkSpecializationMapEntry *maps = pCreateInfo->pStages[i].pSpecializationInfo->pMapEntries;
-      for(uint32_t s = 0; s < pCreateInfo->pStages[i].pSpecializationInfo->mapEntryCount; s++)
-      {
-        Shader::SpecInfo spec;
-        spec.specID = maps[s].constantID;
-        spec.data = &shad.specdata[maps[s].offset];
-        spec.size = maps[s].size;
-        // ignore maps[s].size, assume it's enough for the type
-        shad.specialization.push_back(spec);
-      }
-    }
+    InternSpecialization(info.m_Interned, shad, pCreateInfo->pStages[i].pSpecializationInfo);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -139,29 +296,36 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
 
   if(pCreateInfo->pVertexInputState)
   {
-    vertexBindings.resize(pCreateInfo->pVertexInputState->vertexBindingDescriptionCount);
+    // arrays are built up locally then interned, resize() zero-initialises the padding
+    vector<Binding> bindings;
+    vector<Attribute> attrs;
+
+    bindings.resize(pCreateInfo->pVertexInputState->vertexBindingDescriptionCount);
     for(uint32_t i = 0; i < pCreateInfo->pVertexInputState->vertexBindingDescriptionCount; i++)
     {
-      vertexBindings[i].vbufferBinding =
+      bindings[i].vbufferBinding =
           pCreateInfo->pVertexInputState->pVertexBindingDescriptions[i].binding;
-      vertexBindings[i].bytestride =
+      bindings[i].bytestride =
           pCreateInfo->pVertexInputState->pVertexBindingDescriptions[i].stride;
-      vertexBindings[i].perInstance =
+      bindings[i].perInstance =
           pCreateInfo->pVertexInputState->pVertexBindingDescriptions[i].inputRate ==
           VK_VERTEX_INPUT_RATE_INSTANCE;
     }
 
-    vertexAttrs.resize(pCreateInfo->pVertexInputState->vertexAttributeDescriptionCount);
+    attrs.resize(pCreateInfo->pVertexInputState->vertexAttributeDescriptionCount);
     for(uint32_t i = 0; i < pCreateInfo->pVertexInputState->vertexAttributeDescriptionCount; i++)
     {
-      vertexAttrs[i].binding =
+      attrs[i].binding =
           pCreateInfo->pVertexInputState->pVertexAttributeDescriptions[i].binding;
-      vertexAttrs[i].location =
+      attrs[i].location =
           pCreateInfo->pVertexInputState->pVertexAttributeDescriptions[i].location;
-      vertexAttrs[i].format = pCreateInfo->pVertexInputState->pVertexAttributeDescriptions[i].format;
-      vertexAttrs[i].byteoffset =
+      attrs[i].format = pCreateInfo->pVertexInputState->pVertexAttributeDescriptions[i].format;
+      attrs[i].byteoffset =
           pCreateInfo->pVertexInputState->pVertexAttributeDescriptions[i].offset;
     }
+
+    vertexBindings = info.m_Interned.Intern(bindings);
+    vertexAttrs = info.m_Interned.Intern(attrs);
   }
 
   topology = pCreateInfo->pInputAssemblyState->topology;
@@ -177,18 +341,24 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
   else
     viewportCount = 0;
 
-  viewports.resize(viewportCount);
-  scissors.resize(viewportCount);
+  vector<VkViewport> views;
+  vector<VkRect2D> scis;
+
+  views.resize(viewportCount);
+  scis.resize(viewportCount);
 
   for(uint32_t i = 0; i < viewportCount; i++)
   {
     if(pCreateInfo->pViewportState->pViewports)
-      viewports[i] = pCreateInfo->pViewportState->pViewports[i];
+      views[i] = pCreateInfo->pViewportState->pViewports[i];
 
     if(pCreateInfo->pViewportState->pScissors)
-      scissors[i] = pCreateInfo->pViewportState->pScissors[i];
+      scis[i] = pCreateInfo->pViewportState->pScissors[i];
   }
 
+  viewports = info.m_Interned.Intern(views);
+  scissors = info.m_Interned.Intern(scis);
+
   // VkPipelineRasterStateCreateInfo
   depthClampEnable = pCreateInfo->pRasterizationState->depthClampEnable ? true : false;
   rasterizerDiscardEnable = pCreateInfo->pRasterizationState->rasterizerDiscardEnable ? true : false;
@@ -262,29 +432,32 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     logicOp = pCreateInfo->pColorBlendState->logicOp;
     memcpy(blendConst, pCreateInfo->pColorBlendState->blendConstants, sizeof(blendConst));
 
-    attachments.resize(pCreateInfo->pColorBlendState->attachmentCount);
+    vector<Attachment> atts;
+    atts.resize(pCreateInfo->pColorBlendState->attachmentCount);
 
     for(uint32_t i = 0; i < pCreateInfo->pColorBlendState->attachmentCount; i++)
     {
-      attachments[i].blendEnable =
+      atts[i].blendEnable =
           pCreateInfo->pColorBlendState->pAttachments[i].blendEnable ? true : false;
 
-      attachments[i].blend.Source =
+      atts[i].blend.Source =
           pCreateInfo->pColorBlendState->pAttachments[i].srcColorBlendFactor;
-      attachments[i].blend.Destination =
+      atts[i].blend.Destination =
           pCreateInfo->pColorBlendState->pAttachments[i].dstColorBlendFactor;
-      attachments[i].blend.Operation = pCreateInfo->pColorBlendState->pAttachments[i].colorBlendOp;
+      atts[i].blend.Operation = pCreateInfo->pColorBlendState->pAttachments[i].colorBlendOp;
 
-      attachments[i].alphaBlend.Source =
+      atts[i].alphaBlend.Source =
           pCreateInfo->pColorBlendState->pAttachments[i].srcAlphaBlendFactor;
-      attachments[i].alphaBlend.Destination =
+      atts[i].alphaBlend.Destination =
           pCreateInfo->pColorBlendState->pAttachments[i].dstAlphaBlendFactor;
-      attachments[i].alphaBlend.Operation =
+      atts[i].alphaBlend.Operation =
           pCreateInfo->pColorBlendState->pAttachments[i].alphaBlendOp;
 
-      attachments[i].channelWriteMask =
+      atts[i].channelWriteMask =
           (uint8_t)pCreateInfo->pColorBlendState->pAttachments[i].colorWriteMask;
     }
+
+    attachments = info.m_Interned.Intern(atts);
   }
   else
   {
@@ -292,7 +465,7 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     logicOp = VK_LOGIC_OP_NO_OP;
     RDCEraseEl(blendConst);
 
-    attachments.clear();
+    attachments = InternedArray<Attachment>();
   }
 
   RDCEraseEl(dynamicStates);
@@ -329,21 +502,7 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
                                                    &reflData.refl, &reflData.mapping);
     }
 
-    if(pCreateInfo->stage.pSpecializationInfo)
-    {
-      shad.specdata.resize(pCreateInfo->stage.pSpecializationInfo->dataSize);
-      memcpy(&shad.specdata[0], pCreateInfo->stage.pSpecializationInfo->pData, shad.specdata.size());
-
-      const VkSpecializationMapEntry *maps = pCreateInfo->stage.pSpecializationInfo->pMapEntries;
-      for(uint32_t s = 0; s < pCreateInfo->stage.pSpecializationInfo->mapEntryCount; s++)
-      {
-        Shader::SpecInfo spec;
-        spec.specID = maps[s].constantID;
-        spec.data = &shad.specdata[maps[s].offset];
-        spec.size = maps[s].size;
-        shad.specialization.push_back(spec);
-      }
-    }
+    InternSpecialization(info.m_Interned, shad, pCreateInfo->stage.pSpecializationInfo);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -427,6 +586,18 @@ void VulkanCreationInfo::RenderPass::Init(VulkanResourceManager *resourceMan,
       dst.colorLayouts[i] = src.pColorAttachments[i].layout;
     }
 
+    // resolve attachments are either absent or one per colour attachment
+    if(src.pResolveAttachments)
+    {
+      dst.resolveAttachments.resize(src.colorAttachmentCount);
+      dst.resolveLayouts.resize(src.colorAttachmentCount);
+      for(uint32_t i = 0; i < src.colorAttachmentCount; i++)
+      {
+        dst.resolveAttachments[i] = src.pResolveAttachments[i].attachment;
+        dst.resolveLayouts[i] = src.pResolveAttachments[i].layout;
+      }
+    }
+
     dst.depthstencilAttachment =
         (src.pDepthStencilAttachment != NULL &&
                  src.pDepthStencilAttachment->attachment != VK_ATTACHMENT_UNUSED
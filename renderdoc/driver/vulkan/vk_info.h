@@ -60,8 +60,88 @@ struct DescSetLayout
   uint32_t dynamicCount;
 };
 
+// flattened form of a VK_KHR_descriptor_update_template. The application's data is laid out with
+// arbitrary offsets and strides, so for serialising and replaying we pack the descriptors each
+// entry references tightly in entry order, which turns back into one VkWriteDescriptorSet per
+// entry.
+struct DescUpdateTemplate
+{
+  void Init(const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo);
+
+  // size of one descriptor of this type in both the application and packed data
+  static size_t DescriptorSize(VkDescriptorType type);
+
+  // copy the descriptors out of pData into packed, which must be packedSize bytes. Any fields of the
+  // info structs that aren't used for the entry's descriptor type are set to NULL.
+  void Pack(const void *pData, byte *packed) const;
+
+  // append one write per entry to writes, pointing into the packed data
+  void MakeWrites(VkDescriptorSet set, byte *packed, vector<VkWriteDescriptorSet> &writes) const;
+
+  vector<VkDescriptorUpdateTemplateEntryKHR> entries;
+  vector<size_t> packedOffsets;
+  size_t packedSize;
+
+  // number of bytes of application data the entries cover
+  size_t dataSize;
+};
+
+// read-only view of an array owned by an InternPool. Many pipelines share identical vertex input,
+// viewport and blend state so these are only stored once rather than per pipeline.
+template <typename T>
+struct InternedArray
+{
+  InternedArray() : elems(NULL), count(0) {}
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const T &operator[](size_t i) const { return elems[i]; }
+  const T *begin() const { return elems; }
+  const T *end() const { return elems + count; }
+  const T *elems;
+  size_t count;
+};
+
+// deduplicating storage for creation info arrays. Arrays are compared bytewise, so any padding
+// in the elements must have been zero-initialised. Nothing is freed until the pool is destroyed,
+// which matches the creation info itself never removing entries.
+class InternPool
+{
+public:
+  InternPool() {}
+  ~InternPool();
+
+  template <typename T>
+  InternedArray<T> Intern(const vector<T> &arr)
+  {
+    InternedArray<T> ret;
+    if(!arr.empty())
+    {
+      ret.elems = (const T *)Intern((const byte *)&arr[0], arr.size() * sizeof(T));
+      ret.count = arr.size();
+    }
+    return ret;
+  }
+
+  const byte *Intern(const byte *data, size_t size);
+
+private:
+  InternPool(const InternPool &);
+  InternPool &operator=(const InternPool &);
+
+  struct Entry
+  {
+    byte *data;
+    size_t size;
+  };
+
+  // unique allocations, bucketed by a hash of their size and contents
+  map<uint32_t, vector<Entry> > m_Entries;
+};
+
 struct VulkanCreationInfo
 {
+  InternPool m_Interned;
+
   struct Pipeline
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -85,14 +165,14 @@ struct VulkanCreationInfo
       ShaderReflection *refl;
       ShaderBindpointMapping *mapping;
 
-      vector<byte> specdata;
+      // data pointers point into interned storage for the stage's specialisation data
       struct SpecInfo
       {
         uint32_t specID;
-        byte *data;
+        const byte *data;
         size_t size;
       };
-      vector<SpecInfo> specialization;
+      InternedArray<SpecInfo> specialization;
     };
     Shader shaders[6];
 
@@ -103,7 +183,7 @@ struct VulkanCreationInfo
       uint32_t bytestride;
       bool perInstance;
     };
-    vector<Binding> vertexBindings;
+    InternedArray<Binding> vertexBindings;
 
     struct Attribute
     {
@@ -112,7 +192,7 @@ struct VulkanCreationInfo
       VkFormat format;
       uint32_t byteoffset;
     };
-    vector<Attribute> vertexAttrs;
+    InternedArray<Attribute> vertexAttrs;
 
     // VkPipelineInputAssemblyStateCreateInfo
     VkPrimitiveTopology topology;
@@ -123,8 +203,8 @@ struct VulkanCreationInfo
 
     // VkPipelineViewportStateCreateInfo
     uint32_t viewportCount;
-    vector<VkViewport> viewports;
-    vector<VkRect2D> scissors;
+    InternedArray<VkViewport> viewports;
+    InternedArray<VkRect2D> scissors;
 
     // VkPipelineRasterizationStateCreateInfo
     bool depthClampEnable;
@@ -175,7 +255,7 @@ struct VulkanCreationInfo
 
       uint8_t channelWriteMask;
     };
-    vector<Attachment> attachments;
+    InternedArray<Attachment> attachments;
 
     // VkPipelineDynamicStateCreateInfo
     bool dynamicStates[VK_DYNAMIC_STATE_RANGE_SIZE];
@@ -205,10 +285,12 @@ struct VulkanCreationInfo
       // rarely used but the indices are often used
       vector<uint32_t> inputAttachments;
       vector<uint32_t> colorAttachments;
+      vector<uint32_t> resolveAttachments;
       int32_t depthstencilAttachment;
 
       vector<VkImageLayout> inputLayouts;
       vector<VkImageLayout> colorLayouts;
+      vector<VkImageLayout> resolveLayouts;
       VkImageLayout depthstencilLayout;
     };
     vector<Subpass> subpasses;
@@ -341,4 +423,5 @@ struct VulkanCreationInfo
   map<ResourceId, string> m_Names;
   map<ResourceId, SwapchainInfo> m_SwapChain;
   map<ResourceId, DescSetLayout> m_DescSetLayout;
+  map<ResourceId, DescUpdateTemplate> m_DescUpdateTemplate;
 };
@@ -41,6 +41,10 @@
 // command buffer that stalls the GPU).
 // See INITSTATEBATCH
 
+// while preparing initial contents in a batch, how many bytes of readback copies are recorded into
+// one command buffer before it's submitted and another is started
+static const VkDeviceSize MaxPrepareBatchBytes = 256 * 1024 * 1024;
+
 struct MemIDOffset
 {
   ResourceId memId;
@@ -114,101 +118,18 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkBuffer *buf)
 
   memcpy(binds, &buf->record->sparseInfo->opaquemappings[0], sizeof(VkSparseMemoryBind) * numElems);
 
-  VkDevice d = GetDev();
-  // INITSTATEBATCH
-  VkCommandBuffer cmd = GetNextCmd();
-
-  VkBufferCreateInfo bufInfo = {
-      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      NULL,
-      0,
-      0,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-  };
+  VkDeviceSize totalSize = 0;
+  VkDeviceMemory readbackmem = ReadbackSparseMemory(id, boundMems, totalSize);
 
   uint32_t memidx = 0;
   for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
   {
-    // store offset
-    it->second = bufInfo.size;
-
     memDataOffs[memidx].memId = GetResID(it->first);
-    memDataOffs[memidx].memOffs = bufInfo.size;
-
-    // increase size
-    bufInfo.size += GetRecord(it->first)->Length;
+    memDataOffs[memidx].memOffs = it->second;
     memidx++;
   }
 
-  info->totalSize = bufInfo.size;
-
-  VkDeviceMemory readbackmem = VK_NULL_HANDLE;
-
-  // since these are very short lived, they are not wrapped
-  VkBuffer dstBuf;
-
-  VkResult vkr = VK_SUCCESS;
-
-  vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &dstBuf);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  VkMemoryRequirements mrq = {0};
-
-  ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), dstBuf, &mrq);
-
-  VkMemoryAllocateInfo allocInfo = {
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, bufInfo.size,
-      GetReadbackMemoryIndex(mrq.memoryTypeBits),
-  };
-
-  allocInfo.allocationSize = AlignUp(allocInfo.allocationSize, mrq.alignment);
-
-  vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &readbackmem);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  GetResourceManager()->WrapResource(Unwrap(d), readbackmem);
-
-  vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), dstBuf, Unwrap(readbackmem), 0);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  vector<VkBuffer> bufdeletes;
-  bufdeletes.push_back(dstBuf);
-
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-  vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  // copy all of the bound memory objects
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
-  {
-    VkBuffer srcBuf;
-
-    bufInfo.size = GetRecord(it->first)->Length;
-    vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &srcBuf);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), srcBuf, Unwrap(it->first), 0);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    // copy srcbuf into its area in dstbuf
-    VkBufferCopy region = {0, it->second, bufInfo.size};
-
-    ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), srcBuf, dstBuf, 1, &region);
-
-    bufdeletes.push_back(srcBuf);
-  }
-
-  vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  // INITSTATEBATCH
-  SubmitCmds();
-  FlushQ();
-
-  for(size_t i = 0; i < bufdeletes.size(); i++)
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), bufdeletes[i], NULL);
+  info->totalSize = totalSize;
 
   GetResourceManager()->SetInitialContents(
       id, VulkanResourceManager::InitialContentData(GetWrapped(readbackmem), 0, (byte *)info));
@@ -289,35 +210,68 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkImage *im)
     }
   }
 
-  VkDevice d = GetDev();
-  // INITSTATEBATCH
-  VkCommandBuffer cmd = GetNextCmd();
-
-  VkBufferCreateInfo bufInfo = {
-      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      NULL,
-      0,
-      0,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-  };
+  VkDeviceSize totalSize = 0;
+  VkDeviceMemory readbackmem = ReadbackSparseMemory(id, boundMems, totalSize);
 
   uint32_t memidx = 0;
   for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
   {
-    // store offset
-    it->second = bufInfo.size;
-
     memDataOffs[memidx].memId = GetResID(it->first);
-    memDataOffs[memidx].memOffs = bufInfo.size;
-
-    // increase size
-    bufInfo.size += GetRecord(it->first)->Length;
+    memDataOffs[memidx].memOffs = it->second;
     memidx++;
   }
 
-  state->totalSize = bufInfo.size;
+  state->totalSize = totalSize;
+
+  GetResourceManager()->SetInitialContents(
+      id, VulkanResourceManager::InitialContentData(GetWrapped(readbackmem), 0, (byte *)blob));
+
+  return true;
+}
+
+VkDeviceMemory WrappedVulkan::ReadbackSparseMemory(ResourceId id,
+                                                  map<VkDeviceMemory, VkDeviceSize> &boundMems,
+                                                  VkDeviceSize &totalSize)
+{
+  SCOPED_LOCK(m_SparseSnapshotLock);
+
+  // lay the memory objects out one after another, storing each one's offset
+  totalSize = 0;
+  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
+  {
+    it->second = totalSize;
+    totalSize += GetRecord(it->first)->Length;
+  }
+
+  // the previous snapshot can only be updated in place if the same memory objects are bound, since
+  // then the layout is identical. Otherwise start again from scratch.
+  bool reuse = false;
+
+  auto snapit = m_SparseSnapshots.find(id);
+  if(snapit != m_SparseSnapshots.end() && snapit->second.mems.size() == boundMems.size())
+  {
+    reuse = true;
+
+    size_t i = 0;
+    for(auto it = boundMems.begin(); it != boundMems.end(); ++it, ++i)
+    {
+      if(snapit->second.mems[i].memId != GetResID(it->first))
+      {
+        reuse = false;
+        break;
+      }
+    }
+  }
+
+  VkDevice d = GetDev();
 
-  VkDeviceMemory readbackmem = VK_NULL_HANDLE;
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      NULL,
+      0,
+      totalSize,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
 
   // since these are very short lived, they are not wrapped
   VkBuffer dstBuf;
@@ -327,40 +281,71 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkImage *im)
   vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &dstBuf);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  VkMemoryRequirements mrq = {0};
+  m_InitStatePrepare.bufDeletes.push_back(dstBuf);
 
-  ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), dstBuf, &mrq);
+  if(!reuse)
+  {
+    FreeSparseSnapshot(id);
 
-  VkMemoryAllocateInfo allocInfo = {
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, bufInfo.size,
-      GetReadbackMemoryIndex(mrq.memoryTypeBits),
-  };
+    VkMemoryRequirements mrq = {0};
+
+    ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), dstBuf, &mrq);
 
-  allocInfo.allocationSize = AlignUp(allocInfo.allocationSize, mrq.alignment);
+    VkMemoryAllocateInfo allocInfo = {
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, totalSize,
+        GetReadbackMemoryIndex(mrq.memoryTypeBits),
+    };
 
-  vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &readbackmem);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    allocInfo.allocationSize = AlignUp(allocInfo.allocationSize, mrq.alignment);
 
-  GetResourceManager()->WrapResource(Unwrap(d), readbackmem);
+    SparseSnapshot &snap = m_SparseSnapshots[id];
 
-  vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), dstBuf, Unwrap(readbackmem), 0);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &snap.readbackmem);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  vector<VkBuffer> bufdeletes;
-  bufdeletes.push_back(dstBuf);
+    GetResourceManager()->WrapResource(Unwrap(d), snap.readbackmem);
 
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    snap.size = allocInfo.allocationSize;
+
+    for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
+    {
+      SparseSnapshotMem mem = {GetResID(it->first), GetRecord(it->first)->Length, true};
+      snap.mems.push_back(mem);
 
-  vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+      m_SparseSnapshotWatch[mem.memId].push_back(id);
+    }
+
+    snapit = m_SparseSnapshots.find(id);
+  }
+
+  SparseSnapshot &snap = snapit->second;
+
+  snap.epoch = m_FrameRefEpoch;
+
+  vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), dstBuf, Unwrap(snap.readbackmem), 0);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  // copy all of the bound memory objects
-  for(auto it = boundMems.begin(); it != boundMems.end(); ++it)
+  VkCommandBuffer cmd = VK_NULL_HANDLE;
+  VkDeviceSize copiedBytes = 0;
+
+  // copy only the memory objects written since the last snapshot
+  size_t i = 0;
+  for(auto it = boundMems.begin(); it != boundMems.end(); ++it, ++i)
   {
+    SparseSnapshotMem &mem = snap.mems[i];
+
+    // while memory is mapped the application can write to it without us seeing, so it's never
+    // assumed to be unchanged
+    VkResourceRecord *memrecord = GetRecord(it->first);
+    if(!mem.stale && (memrecord->memMapState == NULL || memrecord->memMapState->mappedPtr == NULL))
+      continue;
+
+    if(cmd == VK_NULL_HANDLE)
+      cmd = BeginPrepareCmd();
+
     VkBuffer srcBuf;
 
-    bufInfo.size = GetRecord(it->first)->Length;
+    bufInfo.size = mem.length;
     vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &srcBuf);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
@@ -372,23 +357,120 @@ bool WrappedVulkan::Prepare_SparseInitialState(WrappedVkImage *im)
 
     ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), srcBuf, dstBuf, 1, &region);
 
-    bufdeletes.push_back(srcBuf);
+    m_InitStatePrepare.bufDeletes.push_back(srcBuf);
+
+    mem.stale = false;
+    copiedBytes += bufInfo.size;
   }
 
-  vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  if(cmd != VK_NULL_HANDLE)
+    EndPrepareCmd(copiedBytes);
 
-  // INITSTATEBATCH
-  SubmitCmds();
-  FlushQ();
+  return snap.readbackmem;
+}
 
-  for(size_t i = 0; i < bufdeletes.size(); i++)
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), bufdeletes[i], NULL);
+void WrappedVulkan::MarkSparseSnapshotsStale(ResourceId id)
+{
+  SCOPED_LOCK(m_SparseSnapshotLock);
 
-  GetResourceManager()->SetInitialContents(
-      id, VulkanResourceManager::InitialContentData(GetWrapped(readbackmem), 0, (byte *)blob));
+  if(m_SparseSnapshots.empty())
+    return;
 
-  return true;
+  auto snapit = m_SparseSnapshots.find(id);
+  if(snapit != m_SparseSnapshots.end())
+  {
+    // written through the sparse resource itself, which could have touched any memory bound to it
+    // and so any other sparse resource sharing that memory
+    for(size_t i = 0; i < snapit->second.mems.size(); i++)
+      MarkSparseMemoryStale(snapit->second.mems[i].memId);
+
+    return;
+  }
+
+  MarkSparseMemoryStale(id);
+}
+
+void WrappedVulkan::MarkSparseMemoryStale(ResourceId memId)
+{
+  auto watchit = m_SparseSnapshotWatch.find(memId);
+  if(watchit == m_SparseSnapshotWatch.end())
+    return;
+
+  for(size_t i = 0; i < watchit->second.size(); i++)
+  {
+    SparseSnapshot &snap = m_SparseSnapshots[watchit->second[i]];
+
+    for(size_t m = 0; m < snap.mems.size(); m++)
+      if(snap.mems[m].memId == memId)
+        snap.mems[m].stale = true;
+  }
+}
+
+bool WrappedVulkan::IsSparseSnapshotMemory(WrappedVkRes *res)
+{
+  SCOPED_LOCK(m_SparseSnapshotLock);
+
+  for(auto it = m_SparseSnapshots.begin(); it != m_SparseSnapshots.end(); ++it)
+    if((WrappedVkRes *)GetWrapped(it->second.readbackmem) == res)
+      return true;
+
+  return false;
+}
+
+void WrappedVulkan::FreeSparseSnapshot(ResourceId id)
+{
+  auto snapit = m_SparseSnapshots.find(id);
+  if(snapit == m_SparseSnapshots.end())
+    return;
+
+  SparseSnapshot &snap = snapit->second;
+
+  for(size_t i = 0; i < snap.mems.size(); i++)
+  {
+    auto watchit = m_SparseSnapshotWatch.find(snap.mems[i].memId);
+    if(watchit == m_SparseSnapshotWatch.end())
+      continue;
+
+    vector<ResourceId> &owners = watchit->second;
+    owners.erase(std::remove(owners.begin(), owners.end(), id), owners.end());
+
+    if(owners.empty())
+      m_SparseSnapshotWatch.erase(watchit);
+  }
+
+  VkDevice d = GetDev();
+
+  VkDeviceMemory real = Unwrap(snap.readbackmem);
+  GetResourceManager()->ReleaseWrappedResource(snap.readbackmem);
+  ObjDisp(d)->FreeMemory(Unwrap(d), real, NULL);
+
+  m_SparseSnapshots.erase(snapit);
+}
+
+void WrappedVulkan::TrimSparseSnapshots()
+{
+  SCOPED_LOCK(m_SparseSnapshotLock);
+
+  // anything not prepared in this capture belongs to a resource that's been destroyed, or at
+  // least isn't dirty any more
+  vector<ResourceId> unused;
+
+  for(auto it = m_SparseSnapshots.begin(); it != m_SparseSnapshots.end(); ++it)
+    if(it->second.epoch != m_FrameRefEpoch)
+      unused.push_back(it->first);
+
+  for(size_t i = 0; i < unused.size(); i++)
+    FreeSparseSnapshot(unused[i]);
+}
+
+void WrappedVulkan::ReleaseSparseSnapshots()
+{
+  SCOPED_LOCK(m_SparseSnapshotLock);
+
+  while(!m_SparseSnapshots.empty())
+    FreeSparseSnapshot(m_SparseSnapshots.begin()->first);
+
+  m_SparseSnapshotWatch.clear();
 }
 
 bool WrappedVulkan::Serialise_SparseBufferInitialState(
@@ -470,8 +552,6 @@ bool WrappedVulkan::Serialise_SparseBufferInitialState(
 
     VkDevice d = GetDev();
 
-    VkDeviceMemory mem = VK_NULL_HANDLE;
-
     VkBufferCreateInfo bufInfo = {
         VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         NULL,
@@ -494,28 +574,19 @@ bool WrappedVulkan::Serialise_SparseBufferInitialState(
 
     ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), Unwrap(buf), &mrq);
 
-    VkMemoryAllocateInfo allocInfo = {
-        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-        GetUploadMemoryIndex(mrq.memoryTypeBits),
-    };
-
-    vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &mem);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    GetResourceManager()->WrapResource(Unwrap(d), mem);
+    MemoryAllocation alloc =
+        AllocateMemoryForResource(true, mrq, eMemScope_InitialContents, eMemType_Upload);
 
-    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(mem), 0);
+    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(alloc.mem), alloc.offs);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     byte *ptr = NULL;
-    ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mem), 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+    ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(alloc.mem), alloc.offs, alloc.size, 0, (void **)&ptr);
 
     size_t dummy = 0;
     m_pSerialiser->SerialiseBuffer("data", ptr, dummy);
 
-    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mem));
-
-    m_CleanupMems.push_back(mem);
+    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(alloc.mem));
 
     GetResourceManager()->SetInitialContents(
         id, VulkanResourceManager::InitialContentData(GetWrapped(buf), 0, (byte *)info));
@@ -682,8 +753,6 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(ResourceId id,
 
     VkDevice d = GetDev();
 
-    VkDeviceMemory mem = VK_NULL_HANDLE;
-
     VkBufferCreateInfo bufInfo = {
         VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         NULL,
@@ -703,28 +772,19 @@ bool WrappedVulkan::Serialise_SparseImageInitialState(ResourceId id,
 
     ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), Unwrap(buf), &mrq);
 
-    VkMemoryAllocateInfo allocInfo = {
-        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-        GetUploadMemoryIndex(mrq.memoryTypeBits),
-    };
+    MemoryAllocation alloc =
+        AllocateMemoryForResource(true, mrq, eMemScope_InitialContents, eMemType_Upload);
 
-    vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &mem);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    GetResourceManager()->WrapResource(Unwrap(d), mem);
-
-    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(mem), 0);
+    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(alloc.mem), alloc.offs);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
     byte *ptr = NULL;
-    ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mem), 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+    ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(alloc.mem), alloc.offs, alloc.size, 0, (void **)&ptr);
 
     size_t dummy = 0;
     m_pSerialiser->SerialiseBuffer("data", ptr, dummy);
 
-    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mem));
-
-    m_CleanupMems.push_back(mem);
+    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(alloc.mem));
 
     GetResourceManager()->SetInitialContents(id, VulkanResourceManager::InitialContentData(
                                                      GetWrapped(buf), eInitialContents_Sparse, blob));
@@ -788,17 +848,9 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkBuffer *buf,
   // flush it will be moved back to the pool
   SubmitSemaphores();
 
-  VkResult vkr = VK_SUCCESS;
-
   VkBuffer srcBuf = (VkBuffer)(uint64_t)contents.resource;
 
-  VkCommandBuffer cmd = GetNextCmd();
-
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  VkCommandBuffer cmd = BeginInitialStateCmd();
 
   VkBufferCreateInfo bufInfo = {
       VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -823,10 +875,13 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkBuffer *buf,
     ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
   }
 
-  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  EndInitialStateCmd(cmd);
 
-  FlushQ();
+  // when batching, one wait for all sparse binds happens before the copies are submitted
+  if(m_InitStateBatch.active)
+    m_InitStateBatch.sparseBound = true;
+  else
+    FlushQ();
 
   return true;
 }
@@ -928,17 +983,9 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkImage *im,
     ObjDisp(q)->QueueBindSparse(Unwrap(q), 1, &bindsparse, VK_NULL_HANDLE);
   }
 
-  VkResult vkr = VK_SUCCESS;
-
   VkBuffer srcBuf = (VkBuffer)(uint64_t)contents.resource;
 
-  VkCommandBuffer cmd = GetNextCmd();
-
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  VkCommandBuffer cmd = BeginInitialStateCmd();
 
   VkBufferCreateInfo bufInfo = {
       VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -964,12 +1011,208 @@ bool WrappedVulkan::Apply_SparseInitialState(WrappedVkImage *im,
     ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
   }
 
-  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  EndInitialStateCmd(cmd);
+
+  if(m_InitStateBatch.active)
+    m_InitStateBatch.sparseBound = true;
 
   return true;
 }
 
+// the aspects an image's initial contents hold data for, which all have to be discarded before a
+// subresource's contents aren't needed
+static VkImageAspectFlags GetContentAspects(VkFormat fmt)
+{
+  if(IsStencilOnlyFormat(fmt))
+    return VK_IMAGE_ASPECT_STENCIL_BIT;
+  else if(IsDepthOnlyFormat(fmt))
+    return VK_IMAGE_ASPECT_DEPTH_BIT;
+  else if(IsDepthOrStencilFormat(fmt))
+    return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+  return VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+// A transition from VK_IMAGE_LAYOUT_UNDEFINED or a clear discards the previous contents of the
+// subresources it covers, so if nothing in the frame read them before then they don't need to be
+// saved. This is tracked per subresource: while recording, a command buffer notes the discards it
+// makes before it does anything else with an image. Then when it's submitted inside the captured
+// frame, those are only accepted if nothing earlier in the frame referenced the image at all.
+// Images with every subresource discarded skip their initial contents entirely and are cleared on
+// replay, the rest have the discarded subresources zeroed so they cost next to nothing once
+// compressed.
+void WrappedVulkan::RecordImageDiscard(VkResourceRecord *cmdRecord, ResourceId image,
+                                       const VkImageSubresourceRange &range)
+{
+  CmdBufferRecordingInfo *cmdInfo = cmdRecord->cmdInfo;
+
+  // secondary command buffers don't know what the primary executing them did before
+  if(cmdInfo->allocInfo.level != VK_COMMAND_BUFFER_LEVEL_PRIMARY)
+    return;
+
+  VkResourceRecord *imRecord = GetResourceManager()->GetResourceRecord(image);
+
+  // sparse images save their page mapping along with the contents
+  if(imRecord == NULL || imRecord->sparseInfo)
+    return;
+
+  // if anything earlier in this command buffer used the image, it might have read the contents
+  if(cmdRecord->HasFrameReference(imRecord))
+    return;
+
+  for(size_t i = 0; i < cmdInfo->subcmds.size(); i++)
+  {
+    VkResourceRecord *baked = cmdInfo->subcmds[i]->bakedCommands;
+    if(baked && baked->HasFrameReference(imRecord))
+      return;
+  }
+
+  for(auto it = cmdInfo->boundDescSets.begin(); it != cmdInfo->boundDescSets.end(); ++it)
+  {
+    HashMap<ResourceId, uint32_t> &index = GetRecord(*it)->descInfo->bindFrameRefIndex;
+    if(index.find(image) != index.end())
+      return;
+  }
+
+  cmdInfo->discards.push_back(std::make_pair(image, range));
+}
+
+void WrappedVulkan::ApplyImageDiscards(
+    const vector<pair<ResourceId, VkImageSubresourceRange> > &discards)
+{
+  for(size_t i = 0; i < discards.size(); i++)
+  {
+    ResourceId id = discards[i].first;
+    const VkImageSubresourceRange &range = discards[i].second;
+
+    // anything referencing the image earlier in the frame could have read what was discarded
+    if(GetResourceManager()->IsFrameReferenced(id))
+      continue;
+
+    SCOPED_LOCK(m_ImageLayoutsLock);
+
+    auto it = m_ImageLayouts.find(id);
+    if(it == m_ImageLayouts.end())
+      continue;
+
+    ImageLayouts &layout = it->second;
+
+    // compressed images can't be cleared on replay
+    if(IsBlockFormat(layout.format))
+      continue;
+
+    if(layout.discarded.empty())
+      layout.discarded.resize(layout.layerCount * layout.levelCount, 0);
+
+    uint32_t levelEnd = range.levelCount == VK_REMAINING_MIP_LEVELS
+                            ? (uint32_t)layout.levelCount
+                            : range.baseMipLevel + range.levelCount;
+    uint32_t layerEnd = range.layerCount == VK_REMAINING_ARRAY_LAYERS
+                            ? (uint32_t)layout.layerCount
+                            : range.baseArrayLayer + range.layerCount;
+
+    levelEnd = RDCMIN(levelEnd, (uint32_t)layout.levelCount);
+    layerEnd = RDCMIN(layerEnd, (uint32_t)layout.layerCount);
+
+    for(uint32_t a = range.baseArrayLayer; a < layerEnd; a++)
+      for(uint32_t m = range.baseMipLevel; m < levelEnd; m++)
+        layout.discarded[a * layout.levelCount + m] |= range.aspectMask;
+  }
+}
+
+void WrappedVulkan::ResetImageDiscards()
+{
+  SCOPED_LOCK(m_ImageLayoutsLock);
+
+  for(auto it = m_ImageLayouts.begin(); it != m_ImageLayouts.end(); ++it)
+    it->second.discarded.clear();
+}
+
+bool WrappedVulkan::IsImageDiscarded(ResourceId id)
+{
+  SCOPED_LOCK(m_ImageLayoutsLock);
+
+  auto it = m_ImageLayouts.find(id);
+  if(it == m_ImageLayouts.end() || it->second.discarded.empty())
+    return false;
+
+  VkImageAspectFlags aspects = GetContentAspects(it->second.format);
+
+  for(size_t i = 0; i < it->second.discarded.size(); i++)
+    if((it->second.discarded[i] & aspects) != aspects)
+      return false;
+
+  return true;
+}
+
+void WrappedVulkan::ZeroDiscardedSubresources(ResourceId id, byte *data, size_t dataSize)
+{
+  SCOPED_LOCK(m_ImageLayoutsLock);
+
+  auto it = m_ImageLayouts.find(id);
+  if(it == m_ImageLayouts.end() || it->second.discarded.empty())
+    return;
+
+  const ImageLayouts &layout = it->second;
+
+  // multisampled images are read back through an array with a slice per sample, leave them alone
+  if(layout.sampleCount > 1)
+    return;
+
+  VkDeviceSize bufAlignment = 4;
+  if(IsBlockFormat(layout.format))
+    bufAlignment = (VkDeviceSize)GetByteSize(1, 1, 1, layout.format, 0);
+
+  VkFormat sizeFormat = GetDepthOnlyFormat(layout.format);
+
+  // the main part of each subresource is colour, depth or stencil, with stencil separately after
+  // depth for depth-stencil formats
+  VkImageAspectFlags mainAspect = GetContentAspects(layout.format) & ~VK_IMAGE_ASPECT_STENCIL_BIT;
+  if(mainAspect == 0)
+    mainAspect = VK_IMAGE_ASPECT_STENCIL_BIT;
+
+  uint32_t zeroed = 0;
+
+  // walk the subresources in the same order as Prepare_InitialState copies them out
+  VkDeviceSize offs = 0;
+  for(int a = 0; a < layout.layerCount; a++)
+  {
+    for(int m = 0; m < layout.levelCount; m++)
+    {
+      VkImageAspectFlags discarded = layout.discarded[a * layout.levelCount + m];
+
+      offs = AlignUp(offs, bufAlignment);
+
+      VkDeviceSize size = GetByteSize(layout.extent.width, layout.extent.height,
+                                      layout.extent.depth, sizeFormat, m);
+
+      if((discarded & mainAspect) && offs + size <= dataSize)
+      {
+        memset(data + offs, 0, (size_t)size);
+        zeroed++;
+      }
+
+      offs += size;
+
+      if(sizeFormat != layout.format)
+      {
+        offs = AlignUp(offs, bufAlignment);
+
+        size = GetByteSize(layout.extent.width, layout.extent.height, layout.extent.depth,
+                           VK_FORMAT_S8_UINT, m);
+
+        if((discarded & VK_IMAGE_ASPECT_STENCIL_BIT) && offs + size <= dataSize)
+          memset(data + offs, 0, (size_t)size);
+
+        offs += size;
+      }
+    }
+  }
+
+  if(zeroed > 0)
+    RDCDEBUG("Zeroed %u discarded subresources in initial contents of %llu", zeroed, id);
+}
+
 bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
 {
   ResourceId id = GetResourceManager()->GetID(res);
@@ -1022,8 +1265,6 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     }
 
     VkDevice d = GetDev();
-    // INITSTATEBATCH
-    VkCommandBuffer cmd = GetNextCmd();
 
     ImageLayouts *layout = NULL;
     {
@@ -1135,11 +1376,15 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), dstBuf, Unwrap(readbackmem), 0);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    m_InitStatePrepare.bufDeletes.push_back(dstBuf);
 
-    vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    if(arrayIm != VK_NULL_HANDLE)
+    {
+      m_InitStatePrepare.imageDeletes.push_back(arrayIm);
+      m_InitStatePrepare.memDeletes.push_back(arrayMem);
+    }
+
+    VkCommandBuffer cmd = BeginPrepareCmd();
 
     VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
     if(IsStencilOnlyFormat(layout->format))
@@ -1195,16 +1440,14 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
 
       DoPipelineBarrier(cmd, 1, &arrayimBarrier);
 
-      vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      // the debug manager submits the MSAA copy itself, so anything batched up has to be closed
+      // off and go to the queue ahead of it
+      SubmitPrepareCmd();
 
       GetDebugManager()->CopyTex2DMSToArray(arrayIm, realim, layout->extent, layout->layerCount,
                                             layout->sampleCount, layout->format);
 
-      cmd = GetNextCmd();
-
-      vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      cmd = BeginPrepareCmd();
 
       arrayimBarrier.srcAccessMask =
           VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
@@ -1286,24 +1529,11 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
       DoPipelineBarrier(cmd, 1, &srcimBarrier);
     }
 
-    vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    // INITSTATEBATCH
-    SubmitCmds();
-    FlushQ();
-
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), dstBuf, NULL);
-
-    if(arrayIm != VK_NULL_HANDLE)
-    {
-      ObjDisp(d)->DestroyImage(Unwrap(d), arrayIm, NULL);
-      ObjDisp(d)->FreeMemory(Unwrap(d), arrayMem, NULL);
-    }
+    EndPrepareCmd(mrq.size);
 
     GetResourceManager()->SetInitialContents(
         id, VulkanResourceManager::InitialContentData(GetWrapped(readbackmem), (uint32_t)mrq.size,
-                                                      NULL));
+                                                      NULL, mrq.size));
 
     return true;
   }
@@ -1312,8 +1542,6 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     VkResult vkr = VK_SUCCESS;
 
     VkDevice d = GetDev();
-    // INITSTATEBATCH
-    VkCommandBuffer cmd = GetNextCmd();
 
     VkResourceRecord *record = GetResourceManager()->GetResourceRecord(id);
     VkDeviceSize dataoffs = 0;
@@ -1369,29 +1597,20 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), dstBuf, Unwrap(readbackmem), 0);
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    m_InitStatePrepare.bufDeletes.push_back(srcBuf);
+    m_InitStatePrepare.bufDeletes.push_back(dstBuf);
 
-    vkr = ObjDisp(d)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    VkCommandBuffer cmd = BeginPrepareCmd();
 
     VkBufferCopy region = {dataoffs, 0, datasize};
 
     ObjDisp(d)->CmdCopyBuffer(Unwrap(cmd), srcBuf, dstBuf, 1, &region);
 
-    vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-    // INITSTATEBATCH
-    SubmitCmds();
-    FlushQ();
-
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), srcBuf, NULL);
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), dstBuf, NULL);
+    EndPrepareCmd(datasize);
 
     GetResourceManager()->SetInitialContents(
         id, VulkanResourceManager::InitialContentData(GetWrapped(readbackmem), (uint32_t)datasize,
-                                                      NULL));
+                                                      NULL, datasize));
 
     return true;
   }
@@ -1403,6 +1622,97 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
   return false;
 }
 
+VkCommandBuffer WrappedVulkan::BeginPrepareCmd()
+{
+  if(m_InitStatePrepare.cmd != VK_NULL_HANDLE)
+    return m_InitStatePrepare.cmd;
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_InitStatePrepare.cmd = cmd;
+
+  return cmd;
+}
+
+void WrappedVulkan::EndPrepareCmd(VkDeviceSize copiedBytes)
+{
+  if(m_InitStatePrepare.active)
+  {
+    // keep recording into the same command buffer, but don't let one grow so large that it stalls
+    // the GPU for too long. Submitted ones are only waited on at the end.
+    m_InitStatePrepare.recordedBytes += copiedBytes;
+
+    if(m_InitStatePrepare.recordedBytes >= MaxPrepareBatchBytes)
+      SubmitPrepareCmd();
+
+    return;
+  }
+
+  SubmitPrepareCmd();
+  FlushQ();
+
+  ReleasePrepareTemporaries();
+}
+
+void WrappedVulkan::SubmitPrepareCmd()
+{
+  VkCommandBuffer cmd = m_InitStatePrepare.cmd;
+
+  if(cmd != VK_NULL_HANDLE)
+  {
+    VkResult vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    m_InitStatePrepare.cmd = VK_NULL_HANDLE;
+  }
+
+  m_InitStatePrepare.recordedBytes = 0;
+
+  SubmitCmds();
+}
+
+void WrappedVulkan::ReleasePrepareTemporaries()
+{
+  VkDevice d = GetDev();
+
+  for(size_t i = 0; i < m_InitStatePrepare.bufDeletes.size(); i++)
+    ObjDisp(d)->DestroyBuffer(Unwrap(d), m_InitStatePrepare.bufDeletes[i], NULL);
+
+  for(size_t i = 0; i < m_InitStatePrepare.imageDeletes.size(); i++)
+    ObjDisp(d)->DestroyImage(Unwrap(d), m_InitStatePrepare.imageDeletes[i], NULL);
+
+  for(size_t i = 0; i < m_InitStatePrepare.memDeletes.size(); i++)
+    ObjDisp(d)->FreeMemory(Unwrap(d), m_InitStatePrepare.memDeletes[i], NULL);
+
+  m_InitStatePrepare.bufDeletes.clear();
+  m_InitStatePrepare.imageDeletes.clear();
+  m_InitStatePrepare.memDeletes.clear();
+}
+
+void WrappedVulkan::BeginPrepare_InitialStates()
+{
+  m_InitStatePrepare.active = true;
+}
+
+void WrappedVulkan::EndPrepare_InitialStates()
+{
+  // one wait for every readback recorded since the beginning
+  SubmitPrepareCmd();
+  FlushQ();
+
+  ReleasePrepareTemporaries();
+
+  m_InitStatePrepare.active = false;
+
+  TrimSparseSnapshots();
+}
+
 // second parameter isn't used, as we might be serialising init state for a deleted resource
 bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 {
@@ -1461,6 +1771,9 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 
       size_t dataSize = (size_t)initContents.num;
 
+      if(type == eResImage)
+        ZeroDiscardedSubresources(id, ptr, dataSize);
+
       m_pSerialiser->Serialise("dataSize", initContents.num);
       m_pSerialiser->SerialiseBuffer("data", ptr, dataSize);
 
@@ -1674,39 +1987,49 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 
       ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), Unwrap(buf), &mrq);
 
-      VkMemoryAllocateInfo allocInfo = {
-          VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, dataSize,
-          GetUploadMemoryIndex(mrq.memoryTypeBits),
-      };
+      VulkanCreationInfo::Image &c = m_CreationInfo.m_Image[liveid];
+
+      MemoryAllocation alloc;
 
       // first we upload the data into a single buffer, then we do
-      // a copy per-mip from that buffer to a new image
-      vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &uploadmem);
-      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      // a copy per-mip from that buffer to a new image. For MSAA images the buffer is only needed
+      // until it's been copied into an array image, so it gets its own memory to free afterwards
+      if(c.samples == VK_SAMPLE_COUNT_1_BIT)
+      {
+        alloc = AllocateMemoryForResource(true, mrq, eMemScope_InitialContents, eMemType_Upload);
+      }
+      else
+      {
+        VkMemoryAllocateInfo allocInfo = {
+            VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, dataSize,
+            GetUploadMemoryIndex(mrq.memoryTypeBits),
+        };
+
+        vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &uploadmem);
+        RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+        GetResourceManager()->WrapResource(Unwrap(d), uploadmem);
 
-      GetResourceManager()->WrapResource(Unwrap(d), uploadmem);
+        alloc.mem = uploadmem;
+        alloc.offs = 0;
+        alloc.size = VK_WHOLE_SIZE;
+      }
 
-      vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(uploadmem), 0);
+      vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(alloc.mem), alloc.offs);
       RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
       byte *ptr = NULL;
-      ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(uploadmem), 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+      ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(alloc.mem), alloc.offs, alloc.size, 0,
+                            (void **)&ptr);
 
       size_t dummy = 0;
       m_pSerialiser->SerialiseBuffer("data", ptr, dummy);
 
-      ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(uploadmem));
+      ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(alloc.mem));
 
       VulkanResourceManager::InitialContentData initial(GetWrapped(buf), 0, NULL);
 
-      VulkanCreationInfo::Image &c = m_CreationInfo.m_Image[liveid];
-
-      if(c.samples == VK_SAMPLE_COUNT_1_BIT)
-      {
-        // remember to free this memory on shutdown
-        m_CleanupMems.push_back(uploadmem);
-      }
-      else
+      if(c.samples != VK_SAMPLE_COUNT_1_BIT)
       {
         int numLayers = c.arrayLayers * (int)c.samples;
 
@@ -1737,17 +2060,11 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 
         ObjDisp(d)->GetImageMemoryRequirements(Unwrap(d), Unwrap(arrayIm), &mrq);
 
-        allocInfo.allocationSize = mrq.size;
-        allocInfo.memoryTypeIndex = GetGPULocalMemoryIndex(mrq.memoryTypeBits);
-
-        VkDeviceMemory arrayMem;
-
-        vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &arrayMem);
-        RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-        GetResourceManager()->WrapResource(Unwrap(d), arrayMem);
+        MemoryAllocation arrayAlloc =
+            AllocateMemoryForResource(false, mrq, eMemScope_InitialContents, eMemType_GPULocal);
 
-        vkr = ObjDisp(d)->BindImageMemory(Unwrap(d), Unwrap(arrayIm), Unwrap(arrayMem), 0);
+        vkr = ObjDisp(d)->BindImageMemory(Unwrap(d), Unwrap(arrayIm), Unwrap(arrayAlloc.mem),
+                                          arrayAlloc.offs);
         RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
         VkCommandBuffer cmd = GetNextCmd();
@@ -1872,7 +2189,6 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
         vkDestroyBuffer(d, buf, NULL);
         vkFreeMemory(d, uploadmem, NULL);
 
-        m_CleanupMems.push_back(arrayMem);
         initial.resource = GetWrapped(arrayIm);
       }
 
@@ -1895,8 +2211,6 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 
       VkDevice d = GetDev();
 
-      VkDeviceMemory mem = VK_NULL_HANDLE;
-
       VkBufferCreateInfo bufInfo = {
           VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
           NULL,
@@ -1916,28 +2230,20 @@ bool WrappedVulkan::Serialise_InitialState(ResourceId resid, WrappedVkRes *)
 
       ObjDisp(d)->GetBufferMemoryRequirements(Unwrap(d), Unwrap(buf), &mrq);
 
-      VkMemoryAllocateInfo allocInfo = {
-          VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-          GetUploadMemoryIndex(mrq.memoryTypeBits),
-      };
+      MemoryAllocation alloc =
+          AllocateMemoryForResource(true, mrq, eMemScope_InitialContents, eMemType_Upload);
 
-      vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &mem);
-      RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-      GetResourceManager()->WrapResource(Unwrap(d), mem);
-
-      vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(mem), 0);
+      vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(alloc.mem), alloc.offs);
       RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
       byte *ptr = NULL;
-      ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mem), 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+      ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(alloc.mem), alloc.offs, alloc.size, 0,
+                            (void **)&ptr);
 
       size_t dummy = 0;
       m_pSerialiser->SerialiseBuffer("data", ptr, dummy);
 
-      ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mem));
-
-      m_CleanupMems.push_back(mem);
+      ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(alloc.mem));
 
       GetResourceManager()->SetInitialContents(
           id, VulkanResourceManager::InitialContentData(GetWrapped(buf), (uint32_t)dataSize, NULL));
@@ -2001,6 +2307,76 @@ void WrappedVulkan::Create_InitialState(ResourceId id, WrappedVkRes *live, bool
   }
 }
 
+VkCommandBuffer WrappedVulkan::BeginInitialStateCmd()
+{
+  if(m_InitStateBatch.active && m_InitStateBatch.cmd != VK_NULL_HANDLE)
+    return m_InitStateBatch.cmd;
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  if(m_InitStateBatch.active)
+    m_InitStateBatch.cmd = cmd;
+
+  return cmd;
+}
+
+void WrappedVulkan::EndInitialStateCmd(VkCommandBuffer cmd)
+{
+  // the batch's command buffer stays open for the next resource
+  if(m_InitStateBatch.active)
+    return;
+
+  VkResult vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+#if ENABLED(SINGLE_FLUSH_VALIDATE)
+  SubmitCmds();
+#endif
+}
+
+void WrappedVulkan::FlushInitialStateBatch()
+{
+  if(m_InitStateBatch.cmd != VK_NULL_HANDLE)
+  {
+    VkResult vkr = ObjDisp(m_InitStateBatch.cmd)->EndCommandBuffer(Unwrap(m_InitStateBatch.cmd));
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    m_InitStateBatch.cmd = VK_NULL_HANDLE;
+  }
+
+  // sparse binds aren't ordered against command buffers submitted after them, so wait for them to
+  // complete before the copies into the newly bound memory go to the queue
+  if(m_InitStateBatch.sparseBound)
+  {
+    FlushQ();
+    m_InitStateBatch.sparseBound = false;
+  }
+
+#if ENABLED(SINGLE_FLUSH_VALIDATE)
+  SubmitCmds();
+#endif
+}
+
+void WrappedVulkan::Apply_InitialStates(const VulkanResourceManager::InitialContentList &states)
+{
+  // record every copy and clear into a single command buffer, in the same order as applying them
+  // one by one. Like that, everything is submitted together afterwards by ApplyInitialContents.
+  m_InitStateBatch.active = true;
+
+  for(size_t i = 0; i < states.size(); i++)
+    Apply_InitialState(states[i].first, states[i].second);
+
+  FlushInitialStateBatch();
+
+  m_InitStateBatch.active = false;
+}
+
 void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
                                        VulkanResourceManager::InitialContentData initial)
 {
@@ -2070,6 +2446,11 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
 
     if(m_CreationInfo.m_Image[id].samples != VK_SAMPLE_COUNT_1_BIT)
     {
+      // the MSAA copy is a compute dispatch the debug manager submits itself, so anything
+      // batched up has to go first
+      if(m_InitStateBatch.active)
+        FlushInitialStateBatch();
+
       VkCommandBuffer cmd = GetNextCmd();
 
       vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
@@ -2165,10 +2546,7 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
           return;
         }
 
-        VkCommandBuffer cmd = GetNextCmd();
-
-        vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-        RDCASSERTEQUAL(vkr, VK_SUCCESS);
+        VkCommandBuffer cmd = BeginInitialStateCmd();
 
         VkImageMemoryBarrier barrier = {
             VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -2216,19 +2594,11 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
           DoPipelineBarrier(cmd, 1, &barrier);
         }
 
-        vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-        RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-        SubmitCmds();
-#endif
+        EndInitialStateCmd(cmd);
       }
       else if(initial.num == eInitialContents_ClearDepthStencilImage)
       {
-        VkCommandBuffer cmd = GetNextCmd();
-
-        vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-        RDCASSERTEQUAL(vkr, VK_SUCCESS);
+        VkCommandBuffer cmd = BeginInitialStateCmd();
 
         VkImageMemoryBarrier barrier = {
             VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -2276,12 +2646,7 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
           DoPipelineBarrier(cmd, 1, &barrier);
         }
 
-        vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-        RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-        SubmitCmds();
-#endif
+        EndInitialStateCmd(cmd);
       }
       else
       {
@@ -2293,10 +2658,7 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
 
     WrappedVkBuffer *buf = (WrappedVkBuffer *)initial.resource;
 
-    VkCommandBuffer cmd = GetNextCmd();
-
-    vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    VkCommandBuffer cmd = BeginInitialStateCmd();
 
     VkExtent3D extent = m_CreationInfo.m_Image[id].extent;
 
@@ -2415,28 +2777,15 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
       }
     }
 
-    vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-    SubmitCmds();
-#endif
+    EndInitialStateCmd(cmd);
   }
   else if(type == eResDeviceMemory)
   {
-    VkResult vkr = VK_SUCCESS;
-
-    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
     VkBuffer srcBuf = (VkBuffer)(uint64_t)initial.resource;
     VkDeviceSize datasize = (VkDeviceSize)initial.num;
     VkDeviceSize dstMemOffs = 0;
 
-    VkCommandBuffer cmd = GetNextCmd();
-
-    vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    VkCommandBuffer cmd = BeginInitialStateCmd();
 
     VkBuffer dstBuf = m_CreationInfo.m_Memory[id].wholeMemBuf;
 
@@ -2444,12 +2793,7 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live,
 
     ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dstBuf), 1, &region);
 
-    vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-    SubmitCmds();
-#endif
+    EndInitialStateCmd(cmd);
   }
   else
   {
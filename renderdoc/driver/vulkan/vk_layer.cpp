@@ -276,9 +276,11 @@ VK_LAYER_RENDERDOC_CaptureGetDeviceProcAddr(VkDevice device, const char *pName)
 
   HookInitVulkanDeviceExts();
 
-  if(GetDeviceDispatchTable(device)->GetDeviceProcAddr == NULL)
+  VkLayerDispatchTableExtended *table = GetDeviceDispatchTable(device);
+
+  if(table->GetDeviceProcAddr == NULL)
     return NULL;
-  return GetDeviceDispatchTable(device)->GetDeviceProcAddr(Unwrap(device), pName);
+  return table->GetDeviceProcAddr(Unwrap(device), pName);
 }
 
 VK_LAYER_EXPORT PFN_vkVoidFunction VKAPI_CALL
@@ -317,8 +319,10 @@ VK_LAYER_RENDERDOC_CaptureGetInstanceProcAddr(VkInstance instance, const char *p
 
   HookInitVulkanDeviceExts();
 
-  if(GetInstanceDispatchTable(instance)->GetInstanceProcAddr == NULL)
+  VkLayerInstanceDispatchTableExtended *table = GetInstanceDispatchTable(instance);
+
+  if(table->GetInstanceProcAddr == NULL)
     return NULL;
-  return GetInstanceDispatchTable(instance)->GetInstanceProcAddr(Unwrap(instance), pName);
+  return table->GetInstanceProcAddr(Unwrap(instance), pName);
 }
 }
@@ -198,9 +198,31 @@ void VulkanResourceManager::RecordSingleBarrier(vector<pair<ResourceId, ImageReg
   dststates.insert(it, std::make_pair(id, ImageRegionState(subRange, t.oldLayout, t.newLayout)));
 }
 
+// collapse an image that has been split up by subresource back down to a single range once every
+// subresource is in the same state again, so later barriers on it only touch one entry.
+static void MergeImageStates(ImageLayouts &layouts)
+{
+  if(layouts.subresourceStates.size() <= 1 ||
+     layouts.subresourceStates.size() != size_t(layouts.layerCount * layouts.levelCount))
+    return;
+
+  VkImageLayout layout = layouts.subresourceStates[0].newLayout;
+
+  for(size_t i = 1; i < layouts.subresourceStates.size(); i++)
+    if(layouts.subresourceStates[i].newLayout != layout)
+      return;
+
+  layouts.subresourceStates.erase(layouts.subresourceStates.begin() + 1,
+                                  layouts.subresourceStates.end());
+  layouts.subresourceStates[0].subresourceRange.baseArrayLayer = 0;
+  layouts.subresourceStates[0].subresourceRange.baseMipLevel = 0;
+  layouts.subresourceStates[0].subresourceRange.layerCount = layouts.layerCount;
+  layouts.subresourceStates[0].subresourceRange.levelCount = layouts.levelCount;
+}
+
 void VulkanResourceManager::RecordBarriers(vector<pair<ResourceId, ImageRegionState> > &states,
-                                           const map<ResourceId, ImageLayouts> &layouts,
-                                           uint32_t numBarriers, const VkImageMemoryBarrier *barriers)
+                                           const ImageLayoutMap &layouts, uint32_t numBarriers,
+                                           const VkImageMemoryBarrier *barriers)
 {
   TRDBG("Recording %u barriers", numBarriers);
 
@@ -258,7 +280,7 @@ void VulkanResourceManager::MergeBarriers(vector<pair<ResourceId, ImageRegionSta
   TRDBG("Post-merge, there are %u states", (uint32_t)dststates.size());
 }
 
-void VulkanResourceManager::SerialiseImageStates(map<ResourceId, ImageLayouts> &states,
+void VulkanResourceManager::SerialiseImageStates(ImageLayoutMap &states,
                                                  vector<VkImageMemoryBarrier> &barriers)
 {
   Serialiser *localSerialiser = m_pSerialiser;
@@ -329,36 +351,7 @@ void VulkanResourceManager::SerialiseImageStates(map<ResourceId, ImageLayouts> &
   // try to merge images that have been split up by subresource but are now all in the same state
   // again.
   for(auto it = states.begin(); it != states.end(); ++it)
-  {
-    ImageLayouts &layouts = it->second;
-
-    if(layouts.subresourceStates.size() > 1 &&
-       layouts.subresourceStates.size() == size_t(layouts.layerCount * layouts.levelCount))
-    {
-      VkImageLayout layout = layouts.subresourceStates[0].newLayout;
-
-      bool allIdentical = true;
-
-      for(size_t i = 0; i < layouts.subresourceStates.size(); i++)
-      {
-        if(layouts.subresourceStates[i].newLayout != layout)
-        {
-          allIdentical = false;
-          break;
-        }
-      }
-
-      if(allIdentical)
-      {
-        layouts.subresourceStates.erase(layouts.subresourceStates.begin() + 1,
-                                        layouts.subresourceStates.end());
-        layouts.subresourceStates[0].subresourceRange.baseArrayLayer = 0;
-        layouts.subresourceStates[0].subresourceRange.baseMipLevel = 0;
-        layouts.subresourceStates[0].subresourceRange.layerCount = layouts.layerCount;
-        layouts.subresourceStates[0].subresourceRange.levelCount = layouts.levelCount;
-      }
-    }
-  }
+    MergeImageStates(it->second);
 }
 
 void VulkanResourceManager::MarkSparseMapReferenced(SparseMapping *sparse)
@@ -381,7 +374,7 @@ void VulkanResourceManager::MarkSparseMapReferenced(SparseMapping *sparse)
 }
 
 void VulkanResourceManager::ApplyBarriers(vector<pair<ResourceId, ImageRegionState> > &states,
-                                          map<ResourceId, ImageLayouts> &layouts)
+                                          ImageLayoutMap &layouts)
 {
   TRDBG("Applying %u barriers", (uint32_t)states.size());
 
@@ -400,12 +393,14 @@ void VulkanResourceManager::ApplyBarriers(vector<pair<ResourceId, ImageRegionSta
       continue;
     }
 
+    ImageLayouts &imgLayouts = stit->second;
+
     uint32_t nummips = t.subresourceRange.levelCount;
     uint32_t numslices = t.subresourceRange.layerCount;
     if(nummips == VK_REMAINING_MIP_LEVELS)
-      nummips = layouts[id].levelCount;
+      nummips = imgLayouts.levelCount;
     if(numslices == VK_REMAINING_ARRAY_LAYERS)
-      numslices = layouts[id].layerCount;
+      numslices = imgLayouts.layerCount;
 
     if(nummips == 0)
       nummips = 1;
@@ -415,6 +410,31 @@ void VulkanResourceManager::ApplyBarriers(vector<pair<ResourceId, ImageRegionSta
     if(t.oldLayout == t.newLayout)
       continue;
 
+    // a barrier over the whole of an image that's been split up by subresource puts it all in one
+    // state again, so replace the ranges with a single one instead of updating each subresource.
+    // The only way to get here with one range is for it to be the whole image, which is handled
+    // by the exact match below.
+    if(imgLayouts.subresourceStates.size() > 1 && t.subresourceRange.baseMipLevel == 0 &&
+       t.subresourceRange.baseArrayLayer == 0 && nummips == (uint32_t)imgLayouts.levelCount &&
+       numslices == (uint32_t)imgLayouts.layerCount)
+    {
+      ImageRegionState &whole = imgLayouts.subresourceStates[0];
+
+      imgLayouts.subresourceStates.erase(imgLayouts.subresourceStates.begin() + 1,
+                                         imgLayouts.subresourceStates.end());
+
+      whole.subresourceRange.baseMipLevel = 0;
+      whole.subresourceRange.levelCount = nummips;
+      whole.subresourceRange.baseArrayLayer = 0;
+      whole.subresourceRange.layerCount = numslices;
+
+      if(whole.oldLayout == UNKNOWN_PREV_IMG_LAYOUT)
+        whole.oldLayout = t.oldLayout;
+      whole.newLayout = t.newLayout;
+
+      continue;
+    }
+
     TRDBG("Barrier of %s (%u->%u, %u->%u) from %s to %s",
           ToStr::Get(t.subresourceRange.aspect).c_str(), t.subresourceRange.baseMipLevel,
           t.subresourceRange.levelCount, t.subresourceRange.baseArrayLayer,
@@ -563,6 +583,8 @@ void VulkanResourceManager::ApplyBarriers(vector<pair<ResourceId, ImageRegionSta
 
     if(!done)
       RDCERR("Couldn't find subresource range to apply barrier to - invalid!");
+    else
+      MergeImageStates(imgLayouts);
   }
 }
 
@@ -571,6 +593,51 @@ bool VulkanResourceManager::Force_InitialState(WrappedVkRes *res, bool prepare)
   return false;
 }
 
+bool VulkanResourceManager::AllowStaging_InitialState(WrappedVkRes *res)
+{
+  // only images are staged - they're written by command buffers, which mark everything they dirty
+  // again on submit. Memory can be written through a mapping at any time, and descriptor sets are
+  // updated without being marked dirty, so neither can be trusted to stay the same.
+  if(IdentifyTypeByPtr(res) != eResImage)
+    return false;
+
+  VkResourceRecord *record = ((WrappedVkImage *)res)->record;
+
+  if(record == NULL || record->sparseInfo)
+    return false;
+
+  // an image bound to host-visible memory could be written through a mapping
+  VkResourceRecord *memrecord = GetResourceRecord(record->baseResource);
+
+  return memrecord && memrecord->memMapState == NULL;
+}
+
+uint64_t VulkanResourceManager::GetSize_InitialState(ResourceId id, InitialContentData initial)
+{
+  // image contents are held in a readback allocation, with its size stored alongside
+  return initial.num;
+}
+
+bool VulkanResourceManager::Discarded_InitialState(ResourceId id, WrappedVkRes *res)
+{
+  if(IdentifyTypeByPtr(res) != eResImage)
+    return false;
+
+  VkResourceRecord *record = ((WrappedVkImage *)res)->record;
+
+  if(record == NULL || record->sparseInfo)
+    return false;
+
+  // the replay clears discarded images. If the memory behind one can be written through a mapping
+  // it's more likely to be aliased with other data that the clear would overwrite, so keep it.
+  VkResourceRecord *memrecord = GetResourceRecord(record->baseResource);
+
+  if(memrecord == NULL || memrecord->memMapState != NULL)
+    return false;
+
+  return m_Core->IsImageDiscarded(id);
+}
+
 bool VulkanResourceManager::Need_InitialStateChunk(WrappedVkRes *res)
 {
   return true;
@@ -581,6 +648,16 @@ bool VulkanResourceManager::Prepare_InitialState(WrappedVkRes *res)
   return m_Core->Prepare_InitialState(res);
 }
 
+void VulkanResourceManager::BeginPrepare_InitialStates()
+{
+  return m_Core->BeginPrepare_InitialStates();
+}
+
+void VulkanResourceManager::EndPrepare_InitialStates()
+{
+  return m_Core->EndPrepare_InitialStates();
+}
+
 bool VulkanResourceManager::Serialise_InitialState(ResourceId resid, WrappedVkRes *res)
 {
   return m_Core->Serialise_InitialState(resid, res);
@@ -596,7 +673,17 @@ void VulkanResourceManager::Apply_InitialState(WrappedVkRes *live, InitialConten
   return m_Core->Apply_InitialState(live, initial);
 }
 
+void VulkanResourceManager::Apply_InitialStates(const InitialContentList &states)
+{
+  return m_Core->Apply_InitialStates(states);
+}
+
 bool VulkanResourceManager::ResourceTypeRelease(WrappedVkRes *res)
 {
+  // sparse initial contents point at readback memory that's kept between captures, which the core
+  // frees itself
+  if(m_Core->IsSparseSnapshotMemory(res))
+    return true;
+
   return m_Core->ReleaseResource(res);
 }
@@ -105,17 +105,15 @@ public:
                            const SrcBarrierType &t, uint32_t nummips, uint32_t numslices);
 
   void RecordBarriers(vector<pair<ResourceId, ImageRegionState> > &states,
-                      const map<ResourceId, ImageLayouts> &layouts, uint32_t numBarriers,
+                      const ImageLayoutMap &layouts, uint32_t numBarriers,
                       const VkImageMemoryBarrier *barriers);
 
   void MergeBarriers(vector<pair<ResourceId, ImageRegionState> > &dststates,
                      vector<pair<ResourceId, ImageRegionState> > &srcstates);
 
-  void ApplyBarriers(vector<pair<ResourceId, ImageRegionState> > &states,
-                     map<ResourceId, ImageLayouts> &layouts);
+  void ApplyBarriers(vector<pair<ResourceId, ImageRegionState> > &states, ImageLayoutMap &layouts);
 
-  void SerialiseImageStates(map<ResourceId, ImageLayouts> &states,
-                            vector<VkImageMemoryBarrier> &barriers);
+  void SerialiseImageStates(ImageLayoutMap &states, vector<VkImageMemoryBarrier> &barriers);
 
   ResourceId GetID(WrappedVkRes *res)
   {
@@ -262,11 +260,17 @@ private:
 
   bool Force_InitialState(WrappedVkRes *res, bool prepare);
   bool AllowDeletedResource_InitialState() { return true; }
+  bool AllowStaging_InitialState(WrappedVkRes *res);
+  uint64_t GetSize_InitialState(ResourceId id, InitialContentData initial);
+  bool Discarded_InitialState(ResourceId id, WrappedVkRes *res);
   bool Need_InitialStateChunk(WrappedVkRes *res);
   bool Prepare_InitialState(WrappedVkRes *res);
+  void BeginPrepare_InitialStates();
+  void EndPrepare_InitialStates();
   bool Serialise_InitialState(ResourceId resid, WrappedVkRes *res);
   void Create_InitialState(ResourceId id, WrappedVkRes *live, bool hasData);
   void Apply_InitialState(WrappedVkRes *live, InitialContentData initial);
+  void Apply_InitialStates(const InitialContentList &states);
 
   WrappedVulkan *m_Core;
 };
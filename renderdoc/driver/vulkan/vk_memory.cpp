@@ -173,3 +173,183 @@ void WrappedVulkan::RemapMemoryIndices(VkPhysicalDeviceMemoryProperties *memProp
     }
   }
 }
+
+// memory allocated for a scope is packed into blocks of this size. Anything bigger gets a block to
+// itself.
+static const VkDeviceSize MemoryBlockSize = 256 * 1024 * 1024;
+
+WrappedVulkan::MemoryAllocation WrappedVulkan::AllocateMemoryForResource(
+    bool buffer, const VkMemoryRequirements &mrq, MemoryScope scope, MemoryType type)
+{
+  MemoryAllocation ret;
+  ret.mem = VK_NULL_HANDLE;
+  ret.offs = 0;
+  ret.size = mrq.size;
+
+  uint32_t memoryTypeIndex = 0;
+
+  switch(type)
+  {
+    case eMemType_GPULocal: memoryTypeIndex = GetGPULocalMemoryIndex(mrq.memoryTypeBits); break;
+    case eMemType_Upload: memoryTypeIndex = GetUploadMemoryIndex(mrq.memoryTypeBits); break;
+    case eMemType_Readback: memoryTypeIndex = GetReadbackMemoryIndex(mrq.memoryTypeBits); break;
+  }
+
+  SCOPED_LOCK(m_MemoryBlocksLock);
+
+  vector<MemoryBlock> &blocks = m_MemoryBlocks[scope];
+
+  // a buffer placed next to an optimally tiled image (or vice-versa) has to be at least
+  // bufferImageGranularity away from it
+  VkDeviceSize granularity = m_PhysicalDeviceData.props.limits.bufferImageGranularity;
+
+  for(size_t i = 0; i < blocks.size(); i++)
+  {
+    MemoryBlock &block = blocks[i];
+
+    if(block.memoryTypeIndex != memoryTypeIndex)
+      continue;
+
+    VkDeviceSize offs = block.used;
+
+    if(block.lastBuffer != buffer)
+      offs = AlignUp(offs, granularity);
+
+    offs = AlignUp(offs, mrq.alignment);
+
+    if(offs + mrq.size <= block.size)
+    {
+      block.used = offs + mrq.size;
+      block.lastBuffer = buffer;
+
+      ret.mem = block.mem;
+      ret.offs = offs;
+      return ret;
+    }
+  }
+
+  // no block has room left, so allocate a new one
+  VkDevice d = GetDev();
+
+  MemoryBlock block;
+  block.mem = VK_NULL_HANDLE;
+  block.memoryTypeIndex = memoryTypeIndex;
+  block.size = RDCMAX(MemoryBlockSize, mrq.size);
+  block.used = mrq.size;
+  block.lastBuffer = buffer;
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, block.size, memoryTypeIndex,
+  };
+
+  VkResult vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &block.mem);
+
+  // if the heap doesn't have room for a whole block, try again with only what's needed
+  if(vkr != VK_SUCCESS && block.size > mrq.size)
+  {
+    block.size = allocInfo.allocationSize = mrq.size;
+    vkr = ObjDisp(d)->AllocateMemory(Unwrap(d), &allocInfo, NULL, &block.mem);
+  }
+
+  if(vkr != VK_SUCCESS)
+  {
+    RDCERR("Failed to allocate %llu bytes from memory type %u, VkResult: 0x%08x", mrq.size,
+           memoryTypeIndex, vkr);
+    return ret;
+  }
+
+  GetResourceManager()->WrapResource(Unwrap(d), block.mem);
+
+  blocks.push_back(block);
+
+  ret.mem = block.mem;
+  return ret;
+}
+
+void WrappedVulkan::FreeAllMemory(MemoryScope scope)
+{
+  SCOPED_LOCK(m_MemoryBlocksLock);
+
+  vector<MemoryBlock> &blocks = m_MemoryBlocks[scope];
+
+  for(size_t i = 0; i < blocks.size(); i++)
+  {
+    ObjDisp(m_Device)->FreeMemory(Unwrap(m_Device), Unwrap(blocks[i].mem), NULL);
+    GetResourceManager()->ReleaseWrappedResource(blocks[i].mem);
+  }
+
+  blocks.clear();
+}
+
+void WrappedVulkan::LogMemoryUsage(MemoryScope scope)
+{
+  const char *scopeName = "Unknown";
+
+  switch(scope)
+  {
+    case eMemScope_InitialContents: scopeName = "Initial contents"; break;
+    case eMemScope_Count: break;
+  }
+
+  uint32_t numBlocks[VK_MAX_MEMORY_HEAPS] = {0};
+  VkDeviceSize allocated[VK_MAX_MEMORY_HEAPS] = {0};
+  VkDeviceSize used[VK_MAX_MEMORY_HEAPS] = {0};
+
+  SCOPED_LOCK(m_MemoryBlocksLock);
+
+  vector<MemoryBlock> &blocks = m_MemoryBlocks[scope];
+
+  for(size_t i = 0; i < blocks.size(); i++)
+  {
+    uint32_t heap = m_PhysicalDeviceData.memProps.memoryTypes[blocks[i].memoryTypeIndex].heapIndex;
+
+    numBlocks[heap]++;
+    allocated[heap] += blocks[i].size;
+    used[heap] += blocks[i].used;
+  }
+
+  for(uint32_t heap = 0; heap < m_PhysicalDeviceData.memProps.memoryHeapCount; heap++)
+  {
+    if(numBlocks[heap] == 0)
+      continue;
+
+    RDCLOG("%s memory in heap %u: %u blocks, %.2fMB allocated, %.2fMB used (of %.2fMB heap)",
+           scopeName, heap, numBlocks[heap], double(allocated[heap]) / (1024.0 * 1024.0),
+           double(used[heap]) / (1024.0 * 1024.0),
+           double(m_PhysicalDeviceData.memProps.memoryHeaps[heap].size) / (1024.0 * 1024.0));
+  }
+}
+
+uint64_t WrappedVulkan::GetReplayMemoryUsage(ReplayMemoryCategory category)
+{
+  uint64_t ret = 0;
+
+  // initial contents live in the packed blocks, which are counted as a whole
+  if(category == eReplayMemory_InitialContents)
+  {
+    SCOPED_LOCK(m_MemoryBlocksLock);
+
+    vector<MemoryBlock> &blocks = m_MemoryBlocks[eMemScope_InitialContents];
+
+    for(size_t i = 0; i < blocks.size(); i++)
+      ret += blocks[i].size;
+  }
+
+  for(auto it = m_ReplayAllocations.begin(); it != m_ReplayAllocations.end(); ++it)
+    if(it->second.first == category)
+      ret += it->second.second;
+
+  return ret;
+}
+
+VkDeviceSize WrappedVulkan::GetReplayAllocationSize(VkDeviceMemory mem)
+{
+  if(mem == VK_NULL_HANDLE)
+    return 0;
+
+  auto it = m_ReplayAllocations.find(GetResID(mem));
+  if(it == m_ReplayAllocations.end())
+    return 0;
+
+  return it->second.second;
+}
@@ -0,0 +1,1048 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_debug.h"
+#include "maths/formatpacking.h"
+#include "vk_core.h"
+#include "vk_resources.h"
+
+// Pixel history is gathered in a single replay of the frame. Every candidate event gets a pair of
+// slots in one readback buffer that the target pixel is copied into before and after the event,
+// and a pair of occlusion queries - one with the event's depth/stencil tests and one without - to
+// tell whether the event covered the pixel and whether any fragments passed. Everything is read
+// back once at the end.
+//
+// Copies can't happen inside a render pass, so for draws the render pass is ended around the copy
+// and resumed with a version of it that loads all attachments. That's only possible for render
+// passes with a single subpass, recorded inline in a primary command buffer. Elsewhere we still
+// get query results but no values.
+
+// each slot is big enough for any colour texel, and a multiple of any texel size since copies must
+// be texel aligned. Depth targets copy depth to the start of the slot and stencil halfway in.
+static const VkDeviceSize PixelHistorySlotSize = 96;
+static const VkDeviceSize PixelHistoryStencilOffset = 48;
+
+struct PixelHistoryEventData
+{
+  PixelHistoryEventData()
+      : recorded(false),
+        preCopied(false),
+        postCopied(false),
+        testsQueried(false),
+        coverageQueried(false),
+        depthTest(false),
+        stencilTest(false),
+        unboundPS(false)
+  {
+  }
+
+  // whether we saw this event at all during the replay
+  bool recorded;
+
+  // whether the pre and post values were copied into this event's slots
+  bool preCopied, postCopied;
+
+  // which of the two occlusion queries were issued
+  bool testsQueried, coverageQueried;
+
+  // the relevant state of the pipeline used, for classifying failed fragments
+  bool depthTest, stencilTest, unboundPS;
+};
+
+struct VulkanPixelHistoryCallback : public VulkanDrawcallCallback
+{
+  VulkanPixelHistoryCallback(WrappedVulkan *vk, const vector<EventUsage> &events,
+                             ResourceId target, uint32_t x, uint32_t y, uint32_t slice,
+                             uint32_t mip, VkBuffer dstBuffer, VkQueryPool queryPool)
+      : m_pDriver(vk),
+        m_pDebug(vk->GetDebugManager()),
+        m_Info(*vk->GetRenderState().m_CreationInfo),
+        m_Target(target),
+        m_X(x),
+        m_Y(y),
+        m_Slice(slice),
+        m_Mip(mip),
+        m_DstBuffer(dstBuffer),
+        m_QueryPool(queryPool),
+        m_PrevState(NULL)
+  {
+    for(size_t i = 0; i < events.size(); i++)
+      m_Slots[events[i].eventID] = (uint32_t)i;
+
+    m_Events.resize(events.size());
+
+    const VulkanCreationInfo::Image &iminfo = m_Info.m_Image[target];
+    m_Format = iminfo.format;
+    m_Is3D = (iminfo.type == VK_IMAGE_TYPE_3D);
+
+    m_Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    if(IsDepthOrStencilFormat(m_Format))
+    {
+      m_Aspect = 0;
+      if(!IsStencilOnlyFormat(m_Format))
+        m_Aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
+      if(IsStencilFormat(m_Format))
+        m_Aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+
+    m_Precise = (vk->GetDeviceFeatures().occlusionQueryPrecise != VK_FALSE);
+
+    m_pDriver->SetDrawcallCB(this);
+  }
+
+  ~VulkanPixelHistoryCallback()
+  {
+    m_pDriver->SetDrawcallCB(NULL);
+
+    VkDevice dev = m_pDriver->GetDev();
+
+    for(auto it = m_ResumeRPs.begin(); it != m_ResumeRPs.end(); ++it)
+      ObjDisp(dev)->DestroyRenderPass(Unwrap(dev), it->second, NULL);
+
+    for(auto it = m_PipelineCache.begin(); it != m_PipelineCache.end(); ++it)
+    {
+      m_pDriver->vkDestroyPipeline(dev, it->second.tested, NULL);
+      m_pDriver->vkDestroyPipeline(dev, it->second.untested, NULL);
+    }
+  }
+
+  PixelHistoryEventData *GetEvent(uint32_t eid, uint32_t &slot)
+  {
+    auto it = m_Slots.find(eid);
+    if(it == m_Slots.end())
+      return NULL;
+
+    slot = it->second;
+
+    // once cancelled, don't start on any more events but let those underway finish up so
+    // that the results so far are consistent
+    if(!m_Events[slot].recorded)
+    {
+      if(RenderDoc::Inst().IsOperationCancelled())
+        return NULL;
+
+      RenderDoc::Inst().SetOperationProgress(float(slot + 1) / float(m_Events.size()));
+    }
+
+    return &m_Events[slot];
+  }
+
+  void PreDraw(uint32_t eid, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->recorded = true;
+    ev->preCopied = CopyPixelInPass(cmd, SlotOffset(slot, false));
+
+    VulkanRenderState &pipestate = m_pDriver->GetRenderState();
+
+    if(pipestate.graphics.pipeline == ResourceId())
+      return;
+
+    const VulkanCreationInfo::Pipeline &p =
+        m_Info.m_Pipeline[pipestate.graphics.pipeline];
+
+    ev->depthTest = p.depthTestEnable;
+    ev->stencilTest = p.stencilTestEnable;
+    ev->unboundPS = (p.shaders[4].module == ResourceId());
+
+    // do a first draw with writes disabled and the original tests, scissored to the pixel, to see
+    // how many samples pass at this point.
+    m_PrevState = pipestate;
+
+    const TestPipelines &pipes = GetTestPipelines(pipestate.graphics.pipeline);
+
+    pipestate.graphics.pipeline = GetResID(pipes.tested);
+    pipestate.scissors = GetPixelScissors(m_PrevState);
+    pipestate.BindPipeline(cmd);
+
+    ObjDisp(cmd)->CmdBeginQuery(Unwrap(cmd), m_QueryPool, slot * 2 + 0,
+                                m_Precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+
+    ev->testsQueried = true;
+  }
+
+  bool PostDraw(uint32_t eid, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL || !ev->testsQueried)
+      return false;
+
+    ObjDisp(cmd)->CmdEndQuery(Unwrap(cmd), m_QueryPool, slot * 2 + 0);
+
+    VulkanRenderState &pipestate = m_pDriver->GetRenderState();
+
+    // if we can re-issue the draw ourselves, do it again without any depth or stencil testing to
+    // see if the pixel is covered at all. Indirect draws only get the first query.
+    const FetchDrawcall *draw = m_pDriver->GetDrawcall(eid);
+
+    if(draw && (draw->flags & eDraw_Indirect) == 0)
+    {
+      const TestPipelines &pipes = GetTestPipelines(m_PrevState.graphics.pipeline);
+
+      pipestate.graphics.pipeline = GetResID(pipes.untested);
+      pipestate.BindPipeline(cmd);
+
+      ObjDisp(cmd)->CmdBeginQuery(Unwrap(cmd), m_QueryPool, slot * 2 + 1,
+                                  m_Precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+
+      if(draw->flags & eDraw_UseIBuffer)
+        ObjDisp(cmd)->CmdDrawIndexed(Unwrap(cmd), draw->numIndices, draw->numInstances,
+                                     draw->indexOffset, draw->baseVertex, draw->instanceOffset);
+      else
+        ObjDisp(cmd)->CmdDraw(Unwrap(cmd), draw->numIndices, draw->numInstances,
+                              draw->vertexOffset, draw->instanceOffset);
+
+      ObjDisp(cmd)->CmdEndQuery(Unwrap(cmd), m_QueryPool, slot * 2 + 1);
+
+      ev->coverageQueried = true;
+    }
+
+    // restore the render state and go ahead with the real draw
+    pipestate = m_PrevState;
+    pipestate.BindPipeline(cmd);
+
+    return true;
+  }
+
+  void PostRedraw(uint32_t eid, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->postCopied = CopyPixelInPass(cmd, SlotOffset(slot, true));
+  }
+
+  void PreDispatch(uint32_t eid, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->recorded = true;
+    ev->preCopied = CopyPixel(cmd, SlotOffset(slot, false), false);
+  }
+
+  bool PostDispatch(uint32_t eid, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev != NULL)
+      ev->postCopied = CopyPixel(cmd, SlotOffset(slot, true), false);
+
+    return false;
+  }
+
+  void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) {}
+  void PreMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return;
+
+    ev->recorded = true;
+
+    if(IsInPassMisc(flags))
+      ev->preCopied = CopyPixelInPass(cmd, SlotOffset(slot, false));
+    else
+      ev->preCopied = CopyPixel(cmd, SlotOffset(slot, false), false);
+  }
+
+  bool PostMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd)
+  {
+    uint32_t slot = 0;
+    PixelHistoryEventData *ev = GetEvent(eid, slot);
+    if(ev == NULL)
+      return false;
+
+    if(IsInPassMisc(flags))
+      ev->postCopied = CopyPixelInPass(cmd, SlotOffset(slot, true));
+    else
+      ev->postCopied = CopyPixel(cmd, SlotOffset(slot, true), false);
+
+    return false;
+  }
+
+  void PostRemisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) {}
+  bool RecordAllCmds() { return true; }
+  void AliasEvent(uint32_t primary, uint32_t alias)
+  {
+    m_AliasEvents.push_back(std::make_pair(primary, alias));
+  }
+
+  static VkDeviceSize SlotOffset(uint32_t slot, bool post)
+  {
+    return (VkDeviceSize(slot) * 2 + (post ? 1 : 0)) * PixelHistorySlotSize;
+  }
+
+  // vkCmdClearAttachments is the only misc event which happens inside a render pass
+  static bool IsInPassMisc(DrawcallFlags flags)
+  {
+    return (flags & eDraw_Clear) && (flags & (eDraw_ClearColour | eDraw_ClearDepthStencil)) == 0;
+  }
+
+  int32_t FindTargetAttachment()
+  {
+    const VulkanRenderState &state = m_pDriver->GetRenderState();
+
+    if(state.framebuffer == ResourceId())
+      return -1;
+
+    const VulkanCreationInfo::Framebuffer &fb =
+        m_Info.m_Framebuffer[state.framebuffer];
+
+    for(size_t i = 0; i < fb.attachments.size(); i++)
+    {
+      const VulkanCreationInfo::ImageView &view =
+          m_Info.m_ImageView[fb.attachments[i].view];
+
+      if(view.image != m_Target)
+        continue;
+
+      const VkImageSubresourceRange &r = view.range;
+
+      if(m_Mip < r.baseMipLevel ||
+         (r.levelCount != VK_REMAINING_MIP_LEVELS && m_Mip >= r.baseMipLevel + r.levelCount))
+        continue;
+
+      if(!m_Is3D && (m_Slice < r.baseArrayLayer || (r.layerCount != VK_REMAINING_ARRAY_LAYERS &&
+                                                     m_Slice >= r.baseArrayLayer + r.layerCount)))
+        continue;
+
+      return (int32_t)i;
+    }
+
+    return -1;
+  }
+
+  // Copy the pixel at a point inside a render pass, by ending it, copying, then resuming it.
+  bool CopyPixelInPass(VkCommandBuffer cmd, VkDeviceSize offs)
+  {
+    VulkanRenderState &state = m_pDriver->GetRenderState();
+
+    if(state.renderPass == ResourceId() || m_DstBuffer == VK_NULL_HANDLE)
+      return false;
+
+    const VulkanCreationInfo::RenderPass &rp = m_Info.m_RenderPass[state.renderPass];
+
+    // we can't end and resume a render pass from a secondary, and we can only make a render pass
+    // that's compatible with the original and resumes partway through if it has one subpass.
+    if(rp.subpasses.size() != 1 || m_pDebug->IsRecordingSecondaryCmd())
+      return false;
+
+    VkRenderPass resumeRP = GetResumeRenderPass(state.renderPass);
+    if(resumeRP == VK_NULL_HANDLE)
+      return false;
+
+    state.EndRenderPass(cmd);
+
+    // after ending the render pass every attachment is in its final layout
+    int32_t att = FindTargetAttachment();
+
+    bool ret = false;
+
+    if(att >= 0)
+      ret = CopyPixel(cmd, offs, true, rp.attachments[att].finalLayout);
+    else
+      ret = CopyPixel(cmd, offs, false);
+
+    state.BeginRenderPassAndApplyState(cmd, resumeRP);
+
+    return ret;
+  }
+
+  bool CopyPixel(VkCommandBuffer cmd, VkDeviceSize offs, bool knownLayout,
+                 VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED)
+  {
+    if(m_DstBuffer == VK_NULL_HANDLE)
+      return false;
+
+    VkImageSubresource sub = {VK_IMAGE_ASPECT_COLOR_BIT, m_Mip, m_Is3D ? 0 : m_Slice};
+
+    if(m_Aspect & VK_IMAGE_ASPECT_DEPTH_BIT)
+      sub.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    else if(m_Aspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+      sub.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    if(!knownLayout)
+      layout = m_pDebug->GetCurrentImageLayout(cmd, m_Target, sub);
+
+    // if we don't know what layout the image is in, we can't safely copy from it
+    if(layout == VK_IMAGE_LAYOUT_UNDEFINED || layout == UNKNOWN_PREV_IMG_LAYOUT ||
+       layout == VK_IMAGE_LAYOUT_PREINITIALIZED)
+      return false;
+
+    VkImage im = m_pDriver->GetResourceManager()->GetCurrentHandle<VkImage>(m_Target);
+
+    VkAccessFlags allWrites = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                              VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    VkImageMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        allWrites,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        layout,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(im),
+        {m_Aspect, m_Mip, 1, m_Is3D ? 0 : m_Slice, 1},
+    };
+
+    DoPipelineBarrier(cmd, 1, &barrier);
+
+    VkBufferImageCopy regions[2] = {};
+    uint32_t regionCount = 0;
+
+    for(uint32_t a = 0; a < 2; a++)
+    {
+      VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+      if(m_Aspect != VK_IMAGE_ASPECT_COLOR_BIT)
+        aspect = (a == 0 ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_STENCIL_BIT);
+      else if(a > 0)
+        break;
+
+      if((m_Aspect & aspect) == 0)
+        continue;
+
+      VkBufferImageCopy &region = regions[regionCount++];
+
+      region.bufferOffset = offs;
+      if(aspect == VK_IMAGE_ASPECT_STENCIL_BIT)
+        region.bufferOffset += PixelHistoryStencilOffset;
+      region.imageSubresource.aspectMask = aspect;
+      region.imageSubresource.mipLevel = m_Mip;
+      region.imageSubresource.baseArrayLayer = m_Is3D ? 0 : m_Slice;
+      region.imageSubresource.layerCount = 1;
+      region.imageOffset.x = (int32_t)m_X;
+      region.imageOffset.y = (int32_t)m_Y;
+      region.imageOffset.z = m_Is3D ? (int32_t)m_Slice : 0;
+      region.imageExtent.width = 1;
+      region.imageExtent.height = 1;
+      region.imageExtent.depth = 1;
+    }
+
+    ObjDisp(cmd)->CmdCopyImageToBuffer(Unwrap(cmd), Unwrap(im),
+                                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_DstBuffer,
+                                       regionCount, regions);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = allWrites | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+
+    DoPipelineBarrier(cmd, 1, &barrier);
+
+    return true;
+  }
+
+  // a render pass compatible with the original one, that loads every attachment from its final
+  // layout, so it can pick up where the original left off once we've ended it for a copy.
+  VkRenderPass GetResumeRenderPass(ResourceId rpid)
+  {
+    auto it = m_ResumeRPs.find(rpid);
+    if(it != m_ResumeRPs.end())
+      return it->second;
+
+    const VulkanCreationInfo::RenderPass &rp = m_Info.m_RenderPass[rpid];
+    const VulkanCreationInfo::RenderPass::Subpass &sub = rp.subpasses[0];
+
+    vector<VkAttachmentDescription> atts = rp.attachments;
+
+    for(size_t i = 0; i < atts.size(); i++)
+    {
+      atts[i].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+      atts[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+      atts[i].initialLayout = atts[i].finalLayout;
+    }
+
+    vector<VkAttachmentReference> inputs(sub.inputAttachments.size());
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+      inputs[i].attachment = sub.inputAttachments[i];
+      inputs[i].layout = sub.inputLayouts[i];
+    }
+
+    vector<VkAttachmentReference> colors(sub.colorAttachments.size());
+    for(size_t i = 0; i < colors.size(); i++)
+    {
+      colors[i].attachment = sub.colorAttachments[i];
+      colors[i].layout = sub.colorLayouts[i];
+    }
+
+    vector<VkAttachmentReference> resolves(sub.resolveAttachments.size());
+    for(size_t i = 0; i < resolves.size(); i++)
+    {
+      resolves[i].attachment = sub.resolveAttachments[i];
+      resolves[i].layout = sub.resolveLayouts[i];
+    }
+
+    VkAttachmentReference depth = {
+        sub.depthstencilAttachment >= 0 ? (uint32_t)sub.depthstencilAttachment
+                                        : VK_ATTACHMENT_UNUSED,
+        sub.depthstencilLayout,
+    };
+
+    VkSubpassDescription subpass = {
+        0,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        (uint32_t)inputs.size(),
+        inputs.empty() ? NULL : &inputs[0],
+        (uint32_t)colors.size(),
+        colors.empty() ? NULL : &colors[0],
+        resolves.empty() ? NULL : &resolves[0],
+        sub.depthstencilAttachment >= 0 ? &depth : NULL,
+        0,
+        NULL,
+    };
+
+    VkRenderPassCreateInfo rpinfo = {
+        VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        NULL,
+        0,
+        (uint32_t)atts.size(),
+        atts.empty() ? NULL : &atts[0],
+        1,
+        &subpass,
+        0,
+        NULL,
+    };
+
+    VkDevice dev = m_pDriver->GetDev();
+
+    VkRenderPass ret = VK_NULL_HANDLE;
+    VkResult vkr = ObjDisp(dev)->CreateRenderPass(Unwrap(dev), &rpinfo, NULL, &ret);
+
+    if(vkr != VK_SUCCESS)
+    {
+      RDCERR("Failed to create resume render pass for pixel history, VkResult: 0x%08x", vkr);
+      ret = VK_NULL_HANDLE;
+    }
+
+    m_ResumeRPs[rpid] = ret;
+
+    return ret;
+  }
+
+  struct TestPipelines
+  {
+    TestPipelines() : tested(VK_NULL_HANDLE), untested(VK_NULL_HANDLE) {}
+    VkPipeline tested, untested;
+  };
+
+  const TestPipelines &GetTestPipelines(ResourceId pipeline)
+  {
+    auto it = m_PipelineCache.find(pipeline);
+    if(it != m_PipelineCache.end())
+      return it->second;
+
+    TestPipelines &ret = m_PipelineCache[pipeline];
+
+    VkGraphicsPipelineCreateInfo pipeCreateInfo;
+    m_pDebug->MakeGraphicsPipelineInfo(pipeCreateInfo, pipeline);
+
+    // disable colour writes/blends
+    VkPipelineColorBlendStateCreateInfo *cb =
+        (VkPipelineColorBlendStateCreateInfo *)pipeCreateInfo.pColorBlendState;
+    for(uint32_t i = 0; i < cb->attachmentCount; i++)
+    {
+      VkPipelineColorBlendAttachmentState *att =
+          (VkPipelineColorBlendAttachmentState *)&cb->pAttachments[i];
+      att->blendEnable = false;
+      att->colorWriteMask = 0x0;
+    }
+
+    // disable depth/stencil writes, but keep the tests
+    VkPipelineDepthStencilStateCreateInfo *ds =
+        (VkPipelineDepthStencilStateCreateInfo *)pipeCreateInfo.pDepthStencilState;
+    ds->depthWriteEnable = false;
+    ds->front.passOp = ds->front.failOp = ds->front.depthFailOp = VK_STENCIL_OP_KEEP;
+    ds->back.passOp = ds->back.failOp = ds->back.depthFailOp = VK_STENCIL_OP_KEEP;
+    ds->front.writeMask = ds->back.writeMask = 0;
+
+    // scissor to the pixel on top of whatever scissor is already set
+    VkPipelineDynamicStateCreateInfo *dyn =
+        (VkPipelineDynamicStateCreateInfo *)pipeCreateInfo.pDynamicState;
+    if(!m_Info.m_Pipeline[pipeline].dynamicStates[VK_DYNAMIC_STATE_SCISSOR])
+    {
+      VkDynamicState *dynSt = (VkDynamicState *)dyn->pDynamicStates;
+      dynSt[dyn->dynamicStateCount++] = VK_DYNAMIC_STATE_SCISSOR;
+    }
+
+    VkDevice dev = m_pDriver->GetDev();
+
+    VkResult vkr = m_pDriver->vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo,
+                                                        NULL, &ret.tested);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    // then the same with no depth or stencil tests, for coverage
+    ds->depthTestEnable = false;
+    ds->stencilTestEnable = false;
+    ds->depthBoundsTestEnable = false;
+
+    vkr = m_pDriver->vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo, NULL,
+                                               &ret.untested);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    return ret;
+  }
+
+  vector<VkRect2D> GetPixelScissors(const VulkanRenderState &state)
+  {
+    const VulkanCreationInfo::Pipeline &p = m_Info.m_Pipeline[state.graphics.pipeline];
+
+    vector<VkRect2D> ret;
+    if(p.dynamicStates[VK_DYNAMIC_STATE_SCISSOR])
+      ret = state.scissors;
+    else
+      ret.assign(p.scissors.begin(), p.scissors.end());
+
+    if(ret.empty())
+      ret.resize(RDCMAX((size_t)1, p.viewports.size()));
+
+    for(size_t i = 0; i < ret.size(); i++)
+    {
+      VkRect2D &s = ret[i];
+
+      int64_t x = (int64_t)m_X, y = (int64_t)m_Y;
+
+      bool inside = x >= s.offset.x && x < s.offset.x + (int64_t)s.extent.width &&
+                    y >= s.offset.y && y < s.offset.y + (int64_t)s.extent.height;
+
+      s.offset.x = (int32_t)m_X;
+      s.offset.y = (int32_t)m_Y;
+      s.extent.width = s.extent.height = inside ? 1 : 0;
+    }
+
+    return ret;
+  }
+
+  WrappedVulkan *m_pDriver;
+  VulkanDebugManager *m_pDebug;
+  VulkanCreationInfo &m_Info;
+
+  ResourceId m_Target;
+  VkFormat m_Format;
+  VkImageAspectFlags m_Aspect;
+  bool m_Is3D;
+  bool m_Precise;
+  uint32_t m_X, m_Y, m_Slice, m_Mip;
+
+  VkBuffer m_DstBuffer;
+  VkQueryPool m_QueryPool;
+
+  VulkanRenderState m_PrevState;
+
+  map<uint32_t, uint32_t> m_Slots;
+  vector<PixelHistoryEventData> m_Events;
+
+  map<ResourceId, VkRenderPass> m_ResumeRPs;
+  map<ResourceId, TestPipelines> m_PipelineCache;
+
+  // events which are the 'same' from being the same command buffer resubmitted
+  // multiple times in the frame.
+  vector<pair<uint32_t, uint32_t> > m_AliasEvents;
+};
+
+struct PixelModificationEIDSort
+{
+  bool operator()(const PixelModification &a, const PixelModification &b) const
+  {
+    return a.eventID < b.eventID;
+  }
+};
+
+static void DecodePixelValue(VkFormat format, const byte *data, ModificationValue &val)
+{
+  RDCEraseEl(val.col);
+  val.depth = -1.0f;
+  val.stencil = -1;
+
+  if(IsDepthOrStencilFormat(format))
+  {
+    switch(format)
+    {
+      case VK_FORMAT_D16_UNORM:
+      case VK_FORMAT_D16_UNORM_S8_UINT: val.depth = float(*(uint16_t *)data) / 65535.0f; break;
+      case VK_FORMAT_X8_D24_UNORM_PACK32:
+      case VK_FORMAT_D24_UNORM_S8_UINT:
+        val.depth = float(*(uint32_t *)data & 0xffffff) / 16777215.0f;
+        break;
+      case VK_FORMAT_D32_SFLOAT:
+      case VK_FORMAT_D32_SFLOAT_S8_UINT: val.depth = *(float *)data; break;
+      default: break;
+    }
+
+    if(IsStencilFormat(format))
+      val.stencil = int32_t(data[PixelHistoryStencilOffset]);
+
+    val.col.value_f[0] = val.depth;
+
+    return;
+  }
+
+  ResourceFormat fmt = MakeResourceFormat(format);
+
+  if(fmt.special)
+  {
+    uint32_t packed = *(uint32_t *)data;
+
+    if(fmt.specialFormat == eSpecial_R10G10B10A2 && fmt.compType == eCompType_UNorm)
+    {
+      Vec4f v = ConvertFromR10G10B10A2(packed);
+      memcpy(&val.col.value_f[0], &v, sizeof(Vec4f));
+    }
+    else if(fmt.specialFormat == eSpecial_R10G10B10A2 && fmt.compType == eCompType_UInt)
+    {
+      val.col.value_u[0] = (packed >> 0) & 0x3ff;
+      val.col.value_u[1] = (packed >> 10) & 0x3ff;
+      val.col.value_u[2] = (packed >> 20) & 0x3ff;
+      val.col.value_u[3] = (packed >> 30) & 0x3;
+    }
+    else if(fmt.specialFormat == eSpecial_R11G11B10)
+    {
+      Vec3f v = ConvertFromR11G11B10(packed);
+      memcpy(&val.col.value_f[0], &v, sizeof(Vec3f));
+      val.col.value_f[3] = 1.0f;
+    }
+    else
+    {
+      RDCWARN("Unhandled special format %u in pixel history, returning raw data",
+              fmt.specialFormat);
+      val.col.value_u[0] = packed;
+    }
+  }
+  else
+  {
+    for(uint32_t c = 0; c < fmt.compCount && c < 4; c++)
+    {
+      byte *comp = (byte *)data + c * fmt.compByteWidth;
+
+      if(fmt.compType == eCompType_UInt)
+      {
+        if(fmt.compByteWidth == 4)
+          val.col.value_u[c] = *(uint32_t *)comp;
+        else if(fmt.compByteWidth == 2)
+          val.col.value_u[c] = *(uint16_t *)comp;
+        else
+          val.col.value_u[c] = *(uint8_t *)comp;
+      }
+      else if(fmt.compType == eCompType_SInt)
+      {
+        if(fmt.compByteWidth == 4)
+          val.col.value_i[c] = *(int32_t *)comp;
+        else if(fmt.compByteWidth == 2)
+          val.col.value_i[c] = *(int16_t *)comp;
+        else
+          val.col.value_i[c] = *(int8_t *)comp;
+      }
+      else if(fmt.srgbCorrected && c == 3)
+      {
+        // alpha is not SRGB'd
+        val.col.value_f[c] = float(*comp) / 255.0f;
+      }
+      else
+      {
+        val.col.value_f[c] = ConvertComponent(fmt, comp);
+      }
+    }
+  }
+
+  if(fmt.bgraOrder)
+    std::swap(val.col.value_u[0], val.col.value_u[2]);
+}
+
+VkImageLayout VulkanDebugManager::GetCurrentImageLayout(VkCommandBuffer cmd, ResourceId image,
+                                                        const VkImageSubresource &sub)
+{
+  // barriers recorded so far in this command buffer take precedence over the state the image was
+  // in when the command buffer was submitted.
+  const vector<pair<ResourceId, ImageRegionState> > &cmdStates =
+      m_pDriver->m_BakedCmdBufferInfo[GetResID(cmd)].imgbarriers;
+
+  for(size_t i = 0; i < cmdStates.size(); i++)
+  {
+    if(cmdStates[i].first != image)
+      continue;
+
+    const VkImageSubresourceRange &r = cmdStates[i].second.subresourceRange;
+
+    if((r.aspectMask & sub.aspectMask) && sub.mipLevel >= r.baseMipLevel &&
+       sub.mipLevel < r.baseMipLevel + r.levelCount && sub.arrayLayer >= r.baseArrayLayer &&
+       sub.arrayLayer < r.baseArrayLayer + r.layerCount)
+      return cmdStates[i].second.newLayout;
+  }
+
+  auto it = m_pDriver->m_ImageLayouts.find(image);
+  if(it == m_pDriver->m_ImageLayouts.end())
+    return VK_IMAGE_LAYOUT_UNDEFINED;
+
+  const vector<ImageRegionState> &states = it->second.subresourceStates;
+
+  for(size_t i = 0; i < states.size(); i++)
+  {
+    const VkImageSubresourceRange &r = states[i].subresourceRange;
+
+    if((r.aspectMask & sub.aspectMask) && sub.mipLevel >= r.baseMipLevel &&
+       sub.mipLevel < r.baseMipLevel + r.levelCount && sub.arrayLayer >= r.baseArrayLayer &&
+       sub.arrayLayer < r.baseArrayLayer + r.layerCount)
+      return states[i].newLayout;
+  }
+
+  return VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+bool VulkanDebugManager::IsRecordingSecondaryCmd()
+{
+  return m_pDriver->m_BakedCmdBufferInfo[m_pDriver->m_LastCmdBufferID].level ==
+         VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+}
+
+vector<PixelModification> VulkanDebugManager::PixelHistory(vector<EventUsage> events,
+                                                           ResourceId target, uint32_t x,
+                                                           uint32_t y, uint32_t slice, uint32_t mip,
+                                                           uint32_t sampleIdx,
+                                                           FormatComponentType typeHint)
+{
+  vector<PixelModification> history;
+
+  if(events.empty())
+    return history;
+
+  const VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[target];
+
+  if(IsBlockFormat(iminfo.format))
+    return history;
+
+  if(iminfo.samples != VK_SAMPLE_COUNT_1_BIT)
+    RDCWARN("Pixel history on multisampled images only returns test results, not values");
+
+  SCOPED_TIMER("VulkanDebugManager::PixelHistory");
+
+  RDCDEBUG("Checking Pixel History on %llu (%u, %u) with %u possible events", target, x, y,
+           (uint32_t)events.size());
+
+  std::sort(events.begin(), events.end());
+
+  uint32_t numEvents = (uint32_t)events.size();
+
+  VkDevice dev = m_Device;
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  GPUBuffer readback;
+  readback.Create(m_pDriver, dev, PixelHistorySlotSize * 2 * numEvents, 1,
+                  GPUBuffer::eGPUBufferReadback);
+
+  VkQueryPoolCreateInfo queryPoolInfo = {
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, NULL, 0, VK_QUERY_TYPE_OCCLUSION, numEvents * 2, 0,
+  };
+
+  VkQueryPool queryPool = VK_NULL_HANDLE;
+  VkResult vkr = vt->CreateQueryPool(Unwrap(dev), &queryPoolInfo, NULL, &queryPool);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vt->CmdResetQueryPool(Unwrap(cmd), queryPool, 0, numEvents * 2);
+  vt->CmdFillBuffer(Unwrap(cmd), Unwrap(readback.buf), 0, VK_WHOLE_SIZE, 0);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->SubmitCmds();
+
+  vector<PixelHistoryEventData> eventData;
+  vector<pair<uint32_t, uint32_t> > aliases;
+
+  {
+    // multisampled images can't be copied from, so only gather the query results for them
+    VulkanPixelHistoryCallback cb(m_pDriver, events, target, x, y, slice, mip,
+                                  iminfo.samples == VK_SAMPLE_COUNT_1_BIT ? Unwrap(readback.buf)
+                                                                          : VK_NULL_HANDLE,
+                                  queryPool);
+
+    // replay the whole frame once, doing all the copies and queries
+    m_pDriver->ReplayLog(0, m_pDriver->GetMaxEID(), eReplay_Full);
+
+    eventData = cb.m_Events;
+    aliases = cb.m_AliasEvents;
+  }
+
+  cmd = m_pDriver->GetNextCmd();
+
+  vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkBufferMemoryBarrier bufBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_HOST_READ_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(readback.buf),
+      0,
+      VK_WHOLE_SIZE,
+  };
+
+  DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  // queries that were never issued stay unavailable and aren't written, so don't wait on them
+  vector<uint64_t> queryData(numEvents * 2, 0);
+  vkr = vt->GetQueryPoolResults(Unwrap(dev), queryPool, 0, numEvents * 2,
+                                sizeof(uint64_t) * queryData.size(), &queryData[0],
+                                sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if(vkr != VK_SUCCESS && vkr != VK_NOT_READY)
+    RDCERR("Failed to fetch pixel history query results, VkResult: 0x%08x", vkr);
+
+  vt->DestroyQueryPool(Unwrap(dev), queryPool, NULL);
+
+  byte *data = NULL;
+  vkr = vt->MapMemory(Unwrap(dev), Unwrap(readback.mem), 0, VK_WHOLE_SIZE, 0, (void **)&data);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  if(data == NULL)
+  {
+    RDCERR("Failed to map pixel history readback memory");
+    readback.Destroy();
+    return history;
+  }
+
+  // primary event -> aliases of it
+  std::multimap<uint32_t, uint32_t> aliasMap;
+  for(size_t i = 0; i < aliases.size(); i++)
+    aliasMap.insert(aliases[i]);
+
+  for(uint32_t i = 0; i < numEvents; i++)
+  {
+    const PixelHistoryEventData &ev = eventData[i];
+
+    if(!ev.recorded)
+      continue;
+
+    const byte *pre = data + VulkanPixelHistoryCallback::SlotOffset(i, false);
+    const byte *post = data + VulkanPixelHistoryCallback::SlotOffset(i, true);
+
+    bool valuesKnown = ev.preCopied && ev.postCopied;
+    bool unchanged = valuesKnown && memcmp(pre, post, (size_t)PixelHistorySlotSize) == 0;
+
+    uint64_t passed = queryData[i * 2 + 0];
+    uint64_t covered = queryData[i * 2 + 1];
+
+    // drop draws that didn't touch the pixel at all
+    if(ev.testsQueried && unchanged)
+    {
+      if(ev.coverageQueried && covered == 0)
+        continue;
+      if(!ev.coverageQueried && passed == 0)
+        continue;
+    }
+
+    PixelModification mod;
+    RDCEraseEl(mod);
+
+    mod.eventID = events[i].eventID;
+
+    ResourceUsage usage = events[i].usage;
+
+    mod.uavWrite = (usage >= eUsage_VS_RWResource && usage <= eUsage_CS_RWResource) ||
+                   usage == eUsage_All_RWResource;
+    mod.unboundPS = ev.unboundPS;
+
+    if(ev.preCopied)
+    {
+      DecodePixelValue(iminfo.format, pre, mod.preMod);
+    }
+    else
+    {
+      mod.preMod.depth = -1.0f;
+      mod.preMod.stencil = -1;
+    }
+
+    if(ev.postCopied)
+    {
+      DecodePixelValue(iminfo.format, post, mod.postMod);
+    }
+    else
+    {
+      mod.postMod.depth = -1.0f;
+      mod.postMod.stencil = -1;
+    }
+
+    // we don't get the individual fragment outputs
+    mod.shaderOut.depth = -1.0f;
+    mod.shaderOut.stencil = -1;
+
+    if(ev.testsQueried && passed == 0)
+    {
+      if(ev.depthTest)
+        mod.depthTestFailed = true;
+      else if(ev.stencilTest)
+        mod.stencilTestFailed = true;
+    }
+
+    history.push_back(mod);
+
+    auto range = aliasMap.equal_range(mod.eventID);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+      PixelModification aliased = mod;
+      aliased.eventID = it->second;
+      history.push_back(aliased);
+    }
+  }
+
+  vt->UnmapMemory(Unwrap(dev), Unwrap(readback.mem));
+  readback.Destroy();
+
+  // sort so that the alias results appear in the right places
+  std::stable_sort(history.begin(), history.end(), PixelModificationEIDSort());
+
+  return history;
+}
@@ -637,6 +637,8 @@ void VulkanReplay::Shutdown()
 {
   PreDeviceShutdownCounters();
 
+  DestroyProxyResources();
+
   m_pDriver->Shutdown();
   delete m_pDriver;
 
@@ -3144,6 +3146,12 @@ void VulkanReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+void VulkanReplay::GetBuffersData(const vector<BufferDataRange> &ranges,
+                                  vector<vector<byte> > &retData)
+{
+  GetDebugManager()->GetBuffersData(ranges, retData);
+}
+
 bool VulkanReplay::IsRenderOutput(ResourceId id)
 {
   for(int32_t i = 0; i < m_VulkanPipelineState.Pass.framebuffer.attachments.count; i++)
@@ -3160,6 +3168,33 @@ void VulkanReplay::FileChanged()
 {
 }
 
+vector<ReplayMemoryStats> VulkanReplay::GetMemoryStats()
+{
+  // proxy resources aren't supported on vulkan, everything else is tracked per allocation
+  ReplayMemoryCategory categories[] = {
+      eReplayMemory_CaptureResources, eReplayMemory_InitialContents, eReplayMemory_PostVSCache,
+      eReplayMemory_DebugResources,
+  };
+
+  vector<ReplayMemoryStats> ret;
+
+  for(size_t i = 0; i < ARRAY_COUNT(categories); i++)
+  {
+    ReplayMemoryStats stats = {};
+    stats.category = categories[i];
+    stats.gpuBytes = m_pDriver->GetReplayMemoryUsage(categories[i]);
+    ret.push_back(stats);
+  }
+
+  return ret;
+}
+
+void VulkanReplay::TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID)
+{
+  if(category == eReplayMemory_PostVSCache)
+    GetDebugManager()->TrimPostVSCache(budget, eventID);
+}
+
 void VulkanReplay::SavePipelineState()
 {
   {
@@ -4525,242 +4560,869 @@ bool VulkanReplay::GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t m
   return true;
 }
 
-void VulkanReplay::InitPostVSBuffers(uint32_t eventID)
+void VulkanReplay::PrepareValueSearch(uint32_t maxMatches)
 {
-  GetDebugManager()->InitPostVSBuffers(eventID);
-}
+  VulkanDebugManager *dbg = GetDebugManager();
 
-struct VulkanInitPostVSCallback : public VulkanDrawcallCallback
-{
-  VulkanInitPostVSCallback(WrappedVulkan *vk, const vector<uint32_t> &events)
-      : m_pDriver(vk), m_Events(events)
-  {
-    m_pDriver->SetDrawcallCB(this);
-  }
-  ~VulkanInitPostVSCallback() { m_pDriver->SetDrawcallCB(NULL); }
-  void PreDraw(uint32_t eid, VkCommandBuffer cmd)
-  {
-    if(std::find(m_Events.begin(), m_Events.end(), eid) != m_Events.end())
-      m_pDriver->GetDebugManager()->InitPostVSBuffers(eid);
-  }
+  // one uvec4 for the count, then one per match that can be stored
+  VkDeviceSize size = sizeof(Vec4u) * (1 + VkDeviceSize(maxMatches));
 
-  bool PostDraw(uint32_t eid, VkCommandBuffer cmd) { return false; }
-  void PostRedraw(uint32_t eid, VkCommandBuffer cmd) {}
-  // Dispatches don't rasterize, so do nothing
-  void PreDispatch(uint32_t eid, VkCommandBuffer cmd) {}
-  bool PostDispatch(uint32_t eid, VkCommandBuffer cmd) { return false; }
-  void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) {}
-  // Ditto copy/etc
-  void PreMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) {}
-  bool PostMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) { return false; }
-  void PostRemisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) {}
-  bool RecordAllCmds() { return false; }
-  void AliasEvent(uint32_t primary, uint32_t alias)
+  // resize up on demand
+  if(dbg->m_ValueSearchResultSize < size)
   {
-    if(std::find(m_Events.begin(), m_Events.end(), primary) != m_Events.end())
-      m_pDriver->GetDebugManager()->AliasPostVSBuffers(primary, alias);
-  }
-
-  WrappedVulkan *m_pDriver;
-  const vector<uint32_t> &m_Events;
-};
-
-void VulkanReplay::InitPostVSBuffers(const vector<uint32_t> &events)
-{
-  // first we must replay up to the first event without replaying it. This ensures any
-  // non-command buffer calls like memory unmaps etc all happen correctly before this
-  // command buffer
-  m_pDriver->ReplayLog(0, events.front(), eReplay_WithoutDraw);
+    if(dbg->m_ValueSearchResultSize > 0)
+    {
+      dbg->m_ValueSearchResult.Destroy();
+      dbg->m_ValueSearchReadback.Destroy();
+    }
 
-  VulkanInitPostVSCallback cb(m_pDriver, events);
+    dbg->m_ValueSearchResultSize = size;
 
-  // now we replay the events, which are guaranteed (because we generated them in
-  // GetPassEvents above) to come from the same command buffer, so the event IDs are
-  // still locally continuous, even if we jump into replaying.
-  m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
+    dbg->m_ValueSearchResult.Create(m_pDriver, m_pDriver->GetDev(), size, 1,
+                                    VulkanDebugManager::GPUBuffer::eGPUBufferGPULocal |
+                                        VulkanDebugManager::GPUBuffer::eGPUBufferSSBO);
+    dbg->m_ValueSearchReadback.Create(m_pDriver, m_pDriver->GetDev(), size, 1,
+                                      VulkanDebugManager::GPUBuffer::eGPUBufferReadback);
+  }
 }
 
-vector<EventUsage> VulkanReplay::GetUsage(ResourceId id)
+void VulkanReplay::DispatchValueSearch(VkCommandBuffer cmd, VkPipeline pipe, uint32_t groupsX,
+                                       uint32_t groupsY)
 {
-  return m_pDriver->GetUsage(id);
-}
+  const VkLayerDispatchTable *vt = ObjDisp(cmd);
+  VulkanDebugManager *dbg = GetDebugManager();
 
-MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
-{
-  return GetDebugManager()->GetPostVSBuffers(eventID, instID, stage);
-}
+  vt->CmdFillBuffer(Unwrap(cmd), Unwrap(dbg->m_ValueSearchResult.buf), 0, sizeof(Vec4u), 0);
 
-byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
-                                   const GetTextureDataParams &params, size_t &dataSize)
-{
-  bool wasms = false;
+  VkBufferMemoryBarrier resultBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(dbg->m_ValueSearchResult.buf),
+      0,
+      dbg->m_ValueSearchResultSize,
+  };
 
-  if(m_pDriver->m_CreationInfo.m_Image.find(tex) == m_pDriver->m_CreationInfo.m_Image.end())
-  {
-    RDCERR("Trying to get texture data for unknown ID %llu!", tex);
-    dataSize = 0;
-    return new byte[0];
-  }
+  // the count must be cleared before the shader adds to it
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
 
-  VulkanCreationInfo::Image &imInfo = m_pDriver->m_CreationInfo.m_Image[tex];
+  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(pipe));
+  vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Unwrap(dbg->m_HistogramPipeLayout), 0, 1,
+                            UnwrapPtr(dbg->m_HistogramDescSet[0]), 0, NULL);
 
-  ImageLayouts &layouts = m_pDriver->m_ImageLayouts[tex];
+  vt->CmdDispatch(Unwrap(cmd), groupsX, groupsY, 1);
 
-  VkImageCreateInfo imCreateInfo = {
-      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-      NULL,
-      0,
-      imInfo.type,
-      imInfo.format,
-      imInfo.extent,
-      (uint32_t)imInfo.mipLevels,
-      (uint32_t)imInfo.arrayLayers,
-      imInfo.samples,
-      VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-      VK_SHARING_MODE_EXCLUSIVE,
-      0,
-      NULL,
-      VK_IMAGE_LAYOUT_UNDEFINED,
+  // ensure shader writes complete before copying to readback buf
+  resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  resultBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
+
+  VkBufferCopy bufcopy = {
+      0, 0, dbg->m_ValueSearchResultSize,
   };
 
-  bool isDepth =
-      (layouts.subresourceStates[0].subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
-  bool isStencil =
-      (layouts.subresourceStates[0].subresourceRange.aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) != 0;
-  VkImageAspectFlags srcAspectMask = layouts.subresourceStates[0].subresourceRange.aspectMask;
+  vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(dbg->m_ValueSearchResult.buf),
+                    Unwrap(dbg->m_ValueSearchReadback.buf), 1, &bufcopy);
 
-  VkImage srcImage = Unwrap(GetResourceManager()->GetCurrentHandle<VkImage>(tex));
-  VkImage tmpImage = VK_NULL_HANDLE;
-  VkDeviceMemory tmpMemory = VK_NULL_HANDLE;
+  // wait for copy to complete before mapping
+  resultBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  resultBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  resultBarrier.buffer = Unwrap(dbg->m_ValueSearchReadback.buf);
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
+}
 
-  VkFramebuffer *tmpFB = NULL;
-  VkImageView *tmpView = NULL;
-  uint32_t numFBs = 0;
-  VkRenderPass tmpRP = VK_NULL_HANDLE;
+void VulkanReplay::FetchValueSearchResults(uint32_t maxMatches, vector<ValueSearchMatch> &matches,
+                                           uint32_t &numMatches)
+{
+  RDCCOMPILE_ASSERT(sizeof(ValueSearchMatch) == sizeof(Vec4u),
+                    "ValueSearchMatch must match the layout in the shader");
+
+  Vec4u *results = (Vec4u *)GetDebugManager()->m_ValueSearchReadback.Map(NULL);
+
+  // the count keeps going past the matches we had space for
+  numMatches = results[0].x;
+
+  matches.resize(RDCMIN(numMatches, maxMatches));
+  if(!matches.empty())
+    memcpy(&matches[0], &results[1], sizeof(ValueSearchMatch) * matches.size());
+
+  GetDebugManager()->m_ValueSearchReadback.Unmap();
+}
+
+bool VulkanReplay::SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                       uint32_t sample, const ValueSearchParams &params,
+                                       vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
 
   VkDevice dev = m_pDriver->GetDev();
   VkCommandBuffer cmd = m_pDriver->GetNextCmd();
   const VkLayerDispatchTable *vt = ObjDisp(dev);
 
-  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  ImageLayouts &layouts = m_pDriver->m_ImageLayouts[texid];
+  VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[texid];
+  VkImage liveIm = m_pDriver->GetResourceManager()->GetCurrentHandle<VkImage>(texid);
 
-  if(imInfo.samples > 1)
-  {
-    // make image n-array instead of n-samples
-    imCreateInfo.arrayLayers *= imCreateInfo.samples;
-    imCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  // integer values can't be NaN or infinite, and a range check on them is better done on the CPU
+  if(IsUIntFormat(iminfo.format) || IsSIntFormat(iminfo.format) ||
+     IsStencilOnlyFormat(layouts.format))
+    return false;
 
-    wasms = true;
-  }
+  VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+  if(IsDepthOrStencilFormat(layouts.format))
+    aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
 
-  if(params.remap)
-  {
-    // force readback texture to RGBA8 unorm
-    imCreateInfo.format =
-        IsSRGBFormat(imCreateInfo.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-    // force to 1 array slice, 1 mip
-    imCreateInfo.arrayLayers = 1;
-    imCreateInfo.mipLevels = 1;
-    // force to 2D
-    imCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-    imCreateInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  CreateTexImageView(aspectFlags, liveIm, iminfo);
 
-    imCreateInfo.extent.width = RDCMAX(1U, imCreateInfo.extent.width >> mip);
-    imCreateInfo.extent.height = RDCMAX(1U, imCreateInfo.extent.height >> mip);
-    imCreateInfo.extent.depth = RDCMAX(1U, imCreateInfo.extent.depth >> mip);
+  int textype = RESTYPE_TEX2D;
 
-    // create render texture similar to readback texture
-    vt->CreateImage(Unwrap(dev), &imCreateInfo, NULL, &tmpImage);
+  if(iminfo.type == VK_IMAGE_TYPE_1D)
+    textype = RESTYPE_TEX1D;
+  else if(iminfo.type == VK_IMAGE_TYPE_3D)
+    textype = RESTYPE_TEX3D;
+  else if(iminfo.samples != VK_SAMPLE_COUNT_1_BIT)
+    textype = RESTYPE_TEX2DMS;
 
-    VkMemoryRequirements mrq = {0};
-    vt->GetImageMemoryRequirements(Unwrap(dev), tmpImage, &mrq);
+  VkPipeline pipe = GetDebugManager()->m_ValueSearchTexPipe[textype];
 
-    VkMemoryAllocateInfo allocInfo = {
-        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-        m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
-    };
+  if(pipe == VK_NULL_HANDLE)
+    return false;
 
-    vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &tmpMemory);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  PrepareValueSearch(params.maxMatches);
 
-    vkr = vt->BindImageMemory(Unwrap(dev), tmpImage, tmpMemory, 0);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  RDCASSERT(iminfo.view != VK_NULL_HANDLE);
 
-    VkImageMemoryBarrier dstimBarrier = {
-        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        NULL,
-        0,
-        0,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        0,
-        0,    // MULTIDEVICE - need to actually pick the right queue family here maybe?
-        tmpImage,
-        {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}};
+  VkDescriptorImageInfo imdesc = {0};
+  imdesc.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  imdesc.imageView = Unwrap(iminfo.view);
+  imdesc.sampler = Unwrap(GetDebugManager()->m_PointSampler);
 
-    // move tmp image into transfer destination layout
-    DoPipelineBarrier(cmd, 1, &dstimBarrier);
+  VkDescriptorBufferInfo bufdescs[2];
+  RDCEraseEl(bufdescs);
+  GetDebugManager()->m_ValueSearchResult.FillDescriptor(bufdescs[0]);
+  GetDebugManager()->m_ValueSearchUBO.FillDescriptor(bufdescs[1]);
 
-    // end this command buffer, the rendertexture below will use its own and we want to ensure
-    // ordering
-    vt->EndCommandBuffer(Unwrap(cmd));
+  VkDescriptorSet descSet = Unwrap(GetDebugManager()->m_HistogramDescSet[0]);
 
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-    m_pDriver->SubmitCmds();
-#endif
+  VkWriteDescriptorSet writeSet[] = {
+      {
+          VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 0, 0, 1,
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0], NULL    // destination = matches
+      },
+      {
+          VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 1, 0, 1,
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0], NULL    // source = unused
+      },
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 2, 0, 1,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NULL, &bufdescs[1], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, uint32_t(5 + textype), 0, 1,
+       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &imdesc, NULL, NULL},
+  };
 
-    // create framebuffer/render pass to render to
-    VkAttachmentDescription attDesc = {0,
-                                       imCreateInfo.format,
-                                       VK_SAMPLE_COUNT_1_BIT,
-                                       VK_ATTACHMENT_LOAD_OP_LOAD,
-                                       VK_ATTACHMENT_STORE_OP_STORE,
-                                       VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-                                       VK_ATTACHMENT_STORE_OP_DONT_CARE,
-                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+  vt->UpdateDescriptorSets(Unwrap(dev), ARRAY_COUNT(writeSet), writeSet, 0, NULL);
 
-    VkAttachmentReference attRef = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+  ValueSearchUBOData *data = (ValueSearchUBOData *)GetDebugManager()->m_ValueSearchUBO.Map(NULL);
 
-    VkSubpassDescription sub = {
-        0,    VK_PIPELINE_BIND_POINT_GRAPHICS,
-        0,    NULL,       // inputs
-        1,    &attRef,    // color
-        NULL,             // resolve
-        NULL,             // depth-stencil
-        0,    NULL,       // preserve
-    };
+  RDCEraseMem(data, sizeof(ValueSearchUBOData));
 
-    VkRenderPassCreateInfo rpinfo = {
-        VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-        NULL,
-        0,
-        1,
-        &attDesc,
-        1,
-        &sub,
-        0,
-        NULL,    // dependencies
-    };
-    vt->CreateRenderPass(Unwrap(dev), &rpinfo, NULL, &tmpRP);
+  data->SearchFlags = params.flags;
+  data->SearchMin = params.minValue;
+  data->SearchMax = params.maxValue;
+  data->SearchChannels = params.channelMask & 0xf;
 
-    numFBs = (imCreateInfo.imageType == VK_IMAGE_TYPE_3D ? (imCreateInfo.extent.depth >> mip) : 1);
-    tmpFB = new VkFramebuffer[numFBs];
-    tmpView = new VkImageView[numFBs];
+  data->SearchTextureResolution.x = (float)RDCMAX(uint32_t(iminfo.extent.width) >> mip, 1U);
+  data->SearchTextureResolution.y = (float)RDCMAX(uint32_t(iminfo.extent.height) >> mip, 1U);
+  data->SearchTextureResolution.z = (float)RDCMAX(uint32_t(iminfo.extent.depth) >> mip, 1U);
+  if(iminfo.type != VK_IMAGE_TYPE_3D)
+    data->SearchSlice = (float)sliceFace + 0.001f;
+  else
+    data->SearchSlice = (float)(sliceFace >> mip);
+  data->SearchMip = (int)mip;
+  data->SearchSample = (int)RDCCLAMP(sample, 0U, uint32_t(iminfo.samples) - 1);
+  if(sample == ~0U)
+    data->SearchSample = -iminfo.samples;
+  data->SearchMaxMatches = params.maxMatches;
 
-    int oldW = m_DebugWidth, oldH = m_DebugHeight;
+  uint32_t groupsX =
+      (uint32_t)ceil(data->SearchTextureResolution.x / float(VALUESEARCH_TEXELS_PER_GROUP));
+  uint32_t groupsY =
+      (uint32_t)ceil(data->SearchTextureResolution.y / float(VALUESEARCH_TEXELS_PER_GROUP));
 
-    m_DebugWidth = imCreateInfo.extent.width;
-    m_DebugHeight = imCreateInfo.extent.height;
+  GetDebugManager()->m_ValueSearchUBO.Unmap();
 
-    // if 3d texture, render each slice separately, otherwise render once
-    for(uint32_t i = 0; i < numFBs; i++)
-    {
+  VkImageMemoryBarrier srcimBarrier = {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      NULL,
+      0,
+      0,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(liveIm),
+      {0, 0, 1, 0, 1}    // will be overwritten by subresourceRange below
+  };
+
+  // ensure all previous writes have completed
+  srcimBarrier.srcAccessMask = VK_ACCESS_ALL_WRITE_BITS;
+  // before we go reading
+  srcimBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+
+  for(size_t si = 0; si < layouts.subresourceStates.size(); si++)
+  {
+    srcimBarrier.subresourceRange = layouts.subresourceStates[si].subresourceRange;
+    srcimBarrier.oldLayout = layouts.subresourceStates[si].newLayout;
+    DoPipelineBarrier(cmd, 1, &srcimBarrier);
+  }
+
+  srcimBarrier.oldLayout = srcimBarrier.newLayout;
+
+  srcimBarrier.srcAccessMask = 0;
+  srcimBarrier.dstAccessMask = 0;
+
+  DispatchValueSearch(cmd, pipe, groupsX, groupsY);
+
+  // image layout back to normal
+  for(size_t si = 0; si < layouts.subresourceStates.size(); si++)
+  {
+    srcimBarrier.subresourceRange = layouts.subresourceStates[si].subresourceRange;
+    srcimBarrier.newLayout = layouts.subresourceStates[si].newLayout;
+    srcimBarrier.dstAccessMask = MakeAccessMask(srcimBarrier.newLayout);
+    DoPipelineBarrier(cmd, 1, &srcimBarrier);
+  }
+
+  vt->EndCommandBuffer(Unwrap(cmd));
+
+  // submit cmds and wait for idle so we can readback
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  FetchValueSearchResults(params.maxMatches, matches, numMatches);
+
+  return true;
+}
+
+bool VulkanReplay::SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                      uint32_t numElems, const ValueSearchParams &params,
+                                      vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  VkBuffer srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
+
+  if(srcBuf == VK_NULL_HANDLE || GetDebugManager()->m_ValueSearchBufPipe == VK_NULL_HANDLE)
+    return false;
+
+  // the shader reads the buffer as dwords
+  if(stride == 0 || (stride % 4) != 0 || (offset % 4) != 0)
+  {
+    RDCWARN("Can't search buffer with offset %llu and stride %u, must be dword aligned", offset,
+            stride);
+    return false;
+  }
+
+  uint64_t bufsize = m_pDriver->m_CreationInfo.m_Buffer[buff].size;
+
+  if(offset >= bufsize)
+    return true;
+
+  numElems = (uint32_t)RDCMIN(uint64_t(numElems), (bufsize - offset) / stride);
+
+  if(numElems == 0)
+    return true;
+
+  VulkanDebugManager *dbg = GetDebugManager();
+
+  VkDevice dev = m_pDriver->GetDev();
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  // the buffer might not have been created with storage usage, so the searched range is copied
+  // into one that was. This stays on the GPU, only the matches are read back.
+  VkDeviceSize len = VkDeviceSize(numElems) * stride;
+
+  if(dbg->m_ValueSearchSrcSize < len)
+  {
+    if(dbg->m_ValueSearchSrcSize > 0)
+      dbg->m_ValueSearchSrc.Destroy();
+
+    dbg->m_ValueSearchSrcSize = len;
+
+    // the shader reads whole uvec4s, so round up to cover the last one
+    dbg->m_ValueSearchSrc.Create(m_pDriver, dev, AlignUp16(len), 1,
+                                 VulkanDebugManager::GPUBuffer::eGPUBufferGPULocal |
+                                     VulkanDebugManager::GPUBuffer::eGPUBufferSSBO);
+  }
+
+  PrepareValueSearch(params.maxMatches);
+
+  // spread the groups over rows so that large buffers don't exceed the dispatch limit
+  uint32_t numGroups = (numElems + VALUESEARCH_ELEMS_PER_GROUP - 1) / VALUESEARCH_ELEMS_PER_GROUP;
+  uint32_t groupsX = RDCMIN(numGroups, 65535U);
+  uint32_t groupsY = (numGroups + groupsX - 1) / groupsX;
+
+  VkDescriptorBufferInfo bufdescs[3];
+  RDCEraseEl(bufdescs);
+  dbg->m_ValueSearchResult.FillDescriptor(bufdescs[0]);
+  dbg->m_ValueSearchSrc.FillDescriptor(bufdescs[1]);
+  dbg->m_ValueSearchUBO.FillDescriptor(bufdescs[2]);
+
+  VkDescriptorSet descSet = Unwrap(dbg->m_HistogramDescSet[0]);
+
+  VkWriteDescriptorSet writeSet[] = {
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 0, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[0], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 1, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[1], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 2, 0, 1,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NULL, &bufdescs[2], NULL},
+  };
+
+  vt->UpdateDescriptorSets(Unwrap(dev), ARRAY_COUNT(writeSet), writeSet, 0, NULL);
+
+  ValueSearchUBOData *data = (ValueSearchUBOData *)dbg->m_ValueSearchUBO.Map(NULL);
+
+  RDCEraseMem(data, sizeof(ValueSearchUBOData));
+
+  data->SearchFlags = params.flags;
+  data->SearchMin = params.minValue;
+  data->SearchMax = params.maxValue;
+  data->SearchChannels = params.channelMask;
+  data->SearchMaxMatches = params.maxMatches;
+
+  data->SearchStride = stride / 4;
+  data->SearchOffset = 0;
+  data->SearchNumElements = numElems;
+  data->SearchElementsPerRow = groupsX * VALUESEARCH_ELEMS_PER_GROUP;
+
+  dbg->m_ValueSearchUBO.Unmap();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+
+  VkBufferMemoryBarrier srcBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_ALL_WRITE_BITS,
+      VK_ACCESS_TRANSFER_READ_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(srcBuf),
+      offset,
+      len,
+  };
+
+  // ensure all previous writes have completed before copying
+  DoPipelineBarrier(cmd, 1, &srcBarrier);
+
+  VkBufferCopy bufcopy = {
+      offset, 0, len,
+  };
+
+  vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(dbg->m_ValueSearchSrc.buf), 1, &bufcopy);
+
+  srcBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  srcBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  srcBarrier.buffer = Unwrap(dbg->m_ValueSearchSrc.buf);
+  srcBarrier.offset = 0;
+
+  DoPipelineBarrier(cmd, 1, &srcBarrier);
+
+  DispatchValueSearch(cmd, dbg->m_ValueSearchBufPipe, groupsX, groupsY);
+
+  vt->EndCommandBuffer(Unwrap(cmd));
+
+  // submit cmds and wait for idle so we can readback
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  FetchValueSearchResults(params.maxMatches, matches, numMatches);
+
+  return true;
+}
+
+bool VulkanReplay::SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                       uint32_t mip, uint32_t sample, FormatComponentType typeHint)
+{
+  VulkanDebugManager *dbg = GetDebugManager();
+
+  if(input >= VulkanDebugManager::TexDiffOutput || texid == ResourceId() ||
+     dbg->m_TexDiffPipe == VK_NULL_HANDLE)
+    return false;
+
+  auto it = m_pDriver->m_CreationInfo.m_Image.find(texid);
+  if(it == m_pDriver->m_CreationInfo.m_Image.end())
+    return false;
+
+  VulkanCreationInfo::Image &iminfo = it->second;
+
+  // raw output of integer textures is their bits, which can't be subtracted as floats
+  if(IsUIntFormat(iminfo.format) || IsSIntFormat(iminfo.format))
+    return false;
+
+  uint32_t w = RDCMAX(1U, iminfo.extent.width >> mip);
+  uint32_t h = RDCMAX(1U, iminfo.extent.height >> mip);
+
+  dbg->CreateTexDiffImage(input, w, h);
+
+  int oldW = m_DebugWidth, oldH = m_DebugHeight;
+
+  m_DebugWidth = w;
+  m_DebugHeight = h;
+
+  // render the subresource 1:1 with raw output, which resolves multisampling, depth and any
+  // texture type down to floats in a plain 2D image
+  TextureDisplay disp;
+  disp.Red = disp.Green = disp.Blue = disp.Alpha = true;
+  disp.FlipY = false;
+  disp.offx = 0.0f;
+  disp.offy = 0.0f;
+  disp.CustomShader = ResourceId();
+  disp.texid = texid;
+  disp.typeHint = typeHint;
+  disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector(0, 0, 0, 0);
+  disp.HDRMul = -1.0f;
+  disp.linearDisplayAsGamma = false;
+  disp.mip = mip;
+  disp.sampleIdx = sample;
+  disp.overlay = eTexOverlay_None;
+  disp.rangemin = 0.0f;
+  disp.rangemax = 1.0f;
+  disp.rawoutput = true;
+  disp.scale = 1.0f;
+  disp.sliceFace = sliceFace;
+
+  VkClearValue clearval = {};
+  VkRenderPassBeginInfo rpbegin = {
+      VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+      NULL,
+      Unwrap(dbg->m_TexDiffRP),
+      Unwrap(dbg->m_TexDiffFB[input]),
+      {{
+           0, 0,
+       },
+       {w, h}},
+      1,
+      &clearval,
+  };
+
+  bool ret = RenderTextureInternal(disp, rpbegin, eTexDisplay_F32Render | eTexDisplay_MipShift);
+
+  m_DebugWidth = oldW;
+  m_DebugHeight = oldH;
+
+  return ret;
+}
+
+bool VulkanReplay::DiffTextureInputs(float threshold, TextureCompareResult &result)
+{
+  RDCEraseEl(result);
+
+  VulkanDebugManager *dbg = GetDebugManager();
+
+  if(dbg->m_TexDiffPipe == VK_NULL_HANDLE || dbg->m_TexDiffImg[0] == VK_NULL_HANDLE ||
+     dbg->m_TexDiffImg[1] == VK_NULL_HANDLE)
+    return false;
+
+  const uint32_t out = VulkanDebugManager::TexDiffOutput;
+
+  uint32_t w = RDCMIN(dbg->m_TexDiffWidth[0], dbg->m_TexDiffWidth[1]);
+  uint32_t h = RDCMIN(dbg->m_TexDiffHeight[0], dbg->m_TexDiffHeight[1]);
+
+  dbg->CreateTexDiffImage(out, w, h);
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  TexDiffUBOData *data = (TexDiffUBOData *)dbg->m_TexDiffUBO.Map(NULL);
+
+  data->DiffWidth = w;
+  data->DiffHeight = h;
+  data->DiffThreshold = threshold;
+  data->Padding5 = 0;
+
+  dbg->m_TexDiffUBO.Unmap();
+
+  VkDescriptorImageInfo imdescs[3];
+  RDCEraseEl(imdescs);
+  for(uint32_t i = 0; i < ARRAY_COUNT(imdescs); i++)
+  {
+    imdescs[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imdescs[i].imageView = Unwrap(dbg->m_TexDiffView[i]);
+  }
+
+  VkDescriptorBufferInfo bufdescs[2];
+  RDCEraseEl(bufdescs);
+  dbg->m_TexDiffUBO.FillDescriptor(bufdescs[0]);
+  dbg->m_TexDiffResult.FillDescriptor(bufdescs[1]);
+
+  VkDescriptorSet descSet = Unwrap(dbg->m_TexDiffDescSet);
+
+  VkWriteDescriptorSet writeSet[] = {
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 0, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &imdescs[0], NULL, NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 1, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &imdescs[1], NULL, NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 2, 0, 1,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NULL, &bufdescs[0], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 3, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, NULL, &bufdescs[1], NULL},
+      {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, NULL, descSet, 4, 0, 1,
+       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &imdescs[out], NULL, NULL},
+  };
+
+  vt->UpdateDescriptorSets(Unwrap(dev), ARRAY_COUNT(writeSet), writeSet, 0, NULL);
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+
+  // the images all stay in the general layout, these only order the accesses
+  VkImageMemoryBarrier imBarriers[3];
+  for(uint32_t i = 0; i < ARRAY_COUNT(imBarriers); i++)
+  {
+    VkImageMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL,
+        VK_IMAGE_LAYOUT_GENERAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(dbg->m_TexDiffImg[i]),
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+    imBarriers[i] = barrier;
+  }
+
+  DoPipelineBarrier(cmd, ARRAY_COUNT(imBarriers), imBarriers);
+
+  vt->CmdFillBuffer(Unwrap(cmd), Unwrap(dbg->m_TexDiffResult.buf), 0, sizeof(Vec4u) * 2, 0);
+
+  VkBufferMemoryBarrier resultBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(dbg->m_TexDiffResult.buf),
+      0,
+      sizeof(Vec4u) * 2,
+  };
+
+  // the results must be cleared before the shader accumulates into them
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
+
+  vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(dbg->m_TexDiffPipe));
+  vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Unwrap(dbg->m_TexDiffPipeLayout), 0, 1, &descSet, 0, NULL);
+
+  vt->CmdDispatch(Unwrap(cmd), (w + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP,
+                  (h + TEXDIFF_TEXELS_PER_GROUP - 1) / TEXDIFF_TEXELS_PER_GROUP, 1);
+
+  // the output is sampled for display and min/max afterwards
+  imBarriers[out].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  imBarriers[out].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+  DoPipelineBarrier(cmd, 1, &imBarriers[out]);
+
+  resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  resultBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
+
+  VkBufferCopy bufcopy = {
+      0, 0, sizeof(Vec4u) * 2,
+  };
+
+  vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(dbg->m_TexDiffResult.buf),
+                    Unwrap(dbg->m_TexDiffReadback.buf), 1, &bufcopy);
+
+  // wait for copy to complete before mapping
+  resultBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  resultBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  resultBarrier.buffer = Unwrap(dbg->m_TexDiffReadback.buf);
+  DoPipelineBarrier(cmd, 1, &resultBarrier);
+
+  vt->EndCommandBuffer(Unwrap(cmd));
+
+  // submit cmds and wait for idle so we can readback
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  Vec4u *stats = (Vec4u *)dbg->m_TexDiffReadback.Map(NULL);
+
+  RDCCOMPILE_ASSERT(sizeof(result.maxError) == sizeof(stats[0]), "max error doesn't match shader");
+  memcpy(result.maxError, &stats[0], sizeof(result.maxError));
+
+  result.numDifferent = stats[1].x;
+
+  dbg->m_TexDiffReadback.Unmap();
+
+  result.diffTexture = GetResID(dbg->m_TexDiffImg[out]);
+  result.width = w;
+  result.height = h;
+
+  return true;
+}
+
+void VulkanReplay::InitPostVSBuffers(uint32_t eventID)
+{
+  GetDebugManager()->InitPostVSBuffers(eventID);
+}
+
+struct VulkanInitPostVSCallback : public VulkanDrawcallCallback
+{
+  VulkanInitPostVSCallback(WrappedVulkan *vk, const vector<uint32_t> &events)
+      : m_pDriver(vk), m_Events(events)
+  {
+    m_pDriver->SetDrawcallCB(this);
+  }
+  ~VulkanInitPostVSCallback() { m_pDriver->SetDrawcallCB(NULL); }
+  void PreDraw(uint32_t eid, VkCommandBuffer cmd)
+  {
+    if(std::find(m_Events.begin(), m_Events.end(), eid) != m_Events.end())
+      m_pDriver->GetDebugManager()->InitPostVSBuffers(eid);
+  }
+
+  bool PostDraw(uint32_t eid, VkCommandBuffer cmd) { return false; }
+  void PostRedraw(uint32_t eid, VkCommandBuffer cmd) {}
+  // Dispatches don't rasterize, so do nothing
+  void PreDispatch(uint32_t eid, VkCommandBuffer cmd) {}
+  bool PostDispatch(uint32_t eid, VkCommandBuffer cmd) { return false; }
+  void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) {}
+  // Ditto copy/etc
+  void PreMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) {}
+  bool PostMisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) { return false; }
+  void PostRemisc(uint32_t eid, DrawcallFlags flags, VkCommandBuffer cmd) {}
+  bool RecordAllCmds() { return false; }
+  void AliasEvent(uint32_t primary, uint32_t alias)
+  {
+    if(std::find(m_Events.begin(), m_Events.end(), primary) != m_Events.end())
+      m_pDriver->GetDebugManager()->AliasPostVSBuffers(primary, alias);
+  }
+
+  WrappedVulkan *m_pDriver;
+  const vector<uint32_t> &m_Events;
+};
+
+void VulkanReplay::InitPostVSBuffers(const vector<uint32_t> &events)
+{
+  // first we must replay up to the first event without replaying it. This ensures any
+  // non-command buffer calls like memory unmaps etc all happen correctly before this
+  // command buffer
+  m_pDriver->ReplayLog(0, events.front(), eReplay_WithoutDraw);
+
+  VulkanInitPostVSCallback cb(m_pDriver, events);
+
+  // now we replay the events, which are guaranteed (because we generated them in
+  // GetPassEvents above) to come from the same command buffer, so the event IDs are
+  // still locally continuous, even if we jump into replaying.
+  m_pDriver->ReplayLog(events.front(), events.back(), eReplay_Full);
+}
+
+vector<EventUsage> VulkanReplay::GetUsage(ResourceId id)
+{
+  return m_pDriver->GetUsage(id);
+}
+
+MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
+{
+  return GetDebugManager()->GetPostVSBuffers(eventID, instID, stage);
+}
+
+byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                   const GetTextureDataParams &params, size_t &dataSize)
+{
+  bool wasms = false;
+
+  if(m_pDriver->m_CreationInfo.m_Image.find(tex) == m_pDriver->m_CreationInfo.m_Image.end())
+  {
+    RDCERR("Trying to get texture data for unknown ID %llu!", tex);
+    dataSize = 0;
+    return new byte[0];
+  }
+
+  VulkanCreationInfo::Image &imInfo = m_pDriver->m_CreationInfo.m_Image[tex];
+
+  ImageLayouts &layouts = m_pDriver->m_ImageLayouts[tex];
+
+  VkImageCreateInfo imCreateInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      NULL,
+      0,
+      imInfo.type,
+      imInfo.format,
+      imInfo.extent,
+      (uint32_t)imInfo.mipLevels,
+      (uint32_t)imInfo.arrayLayers,
+      imInfo.samples,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_SHARING_MODE_EXCLUSIVE,
+      0,
+      NULL,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  bool isDepth =
+      (layouts.subresourceStates[0].subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+  bool isStencil =
+      (layouts.subresourceStates[0].subresourceRange.aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) != 0;
+  VkImageAspectFlags srcAspectMask = layouts.subresourceStates[0].subresourceRange.aspectMask;
+
+  VkImage srcImage = Unwrap(GetResourceManager()->GetCurrentHandle<VkImage>(tex));
+  VkImage tmpImage = VK_NULL_HANDLE;
+  VkDeviceMemory tmpMemory = VK_NULL_HANDLE;
+
+  VkFramebuffer *tmpFB = NULL;
+  VkImageView *tmpView = NULL;
+  uint32_t numFBs = 0;
+  VkRenderPass tmpRP = VK_NULL_HANDLE;
+
+  VkDevice dev = m_pDriver->GetDev();
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  if(imInfo.samples > 1)
+  {
+    // make image n-array instead of n-samples
+    imCreateInfo.arrayLayers *= imCreateInfo.samples;
+    imCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    wasms = true;
+  }
+
+  if(params.remap)
+  {
+    RDCASSERT(params.remap == eRemap_RGBA8 || params.remap == eRemap_RGBA32);
+
+    // force readback texture to RGBA8 unorm, or RGBA32 float for anything needing more precision.
+    // The proxy packs that down further if it needs to
+    if(params.remap == eRemap_RGBA32)
+      imCreateInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    else
+      imCreateInfo.format =
+          IsSRGBFormat(imCreateInfo.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    // force to 1 array slice, 1 mip
+    imCreateInfo.arrayLayers = 1;
+    imCreateInfo.mipLevels = 1;
+    // force to 2D
+    imCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imCreateInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    imCreateInfo.extent.width = RDCMAX(1U, imCreateInfo.extent.width >> mip);
+    imCreateInfo.extent.height = RDCMAX(1U, imCreateInfo.extent.height >> mip);
+    imCreateInfo.extent.depth = RDCMAX(1U, imCreateInfo.extent.depth >> mip);
+
+    // create render texture similar to readback texture
+    vt->CreateImage(Unwrap(dev), &imCreateInfo, NULL, &tmpImage);
+
+    VkMemoryRequirements mrq = {0};
+    vt->GetImageMemoryRequirements(Unwrap(dev), tmpImage, &mrq);
+
+    VkMemoryAllocateInfo allocInfo = {
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+        m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+    };
+
+    vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &tmpMemory);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    vkr = vt->BindImageMemory(Unwrap(dev), tmpImage, tmpMemory, 0);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    VkImageMemoryBarrier dstimBarrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        0,
+        0,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        0,
+        0,    // MULTIDEVICE - need to actually pick the right queue family here maybe?
+        tmpImage,
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}};
+
+    // move tmp image into transfer destination layout
+    DoPipelineBarrier(cmd, 1, &dstimBarrier);
+
+    // end this command buffer, the rendertexture below will use its own and we want to ensure
+    // ordering
+    vt->EndCommandBuffer(Unwrap(cmd));
+
+#if ENABLED(SINGLE_FLUSH_VALIDATE)
+    m_pDriver->SubmitCmds();
+#endif
+
+    // create framebuffer/render pass to render to
+    VkAttachmentDescription attDesc = {0,
+                                       imCreateInfo.format,
+                                       VK_SAMPLE_COUNT_1_BIT,
+                                       VK_ATTACHMENT_LOAD_OP_LOAD,
+                                       VK_ATTACHMENT_STORE_OP_STORE,
+                                       VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                       VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkAttachmentReference attRef = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription sub = {
+        0,    VK_PIPELINE_BIND_POINT_GRAPHICS,
+        0,    NULL,       // inputs
+        1,    &attRef,    // color
+        NULL,             // resolve
+        NULL,             // depth-stencil
+        0,    NULL,       // preserve
+    };
+
+    VkRenderPassCreateInfo rpinfo = {
+        VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        NULL,
+        0,
+        1,
+        &attDesc,
+        1,
+        &sub,
+        0,
+        NULL,    // dependencies
+    };
+    vt->CreateRenderPass(Unwrap(dev), &rpinfo, NULL, &tmpRP);
+
+    numFBs = (imCreateInfo.imageType == VK_IMAGE_TYPE_3D ? (imCreateInfo.extent.depth >> mip) : 1);
+    tmpFB = new VkFramebuffer[numFBs];
+    tmpView = new VkImageView[numFBs];
+
+    int oldW = m_DebugWidth, oldH = m_DebugHeight;
+
+    m_DebugWidth = imCreateInfo.extent.width;
+    m_DebugHeight = imCreateInfo.extent.height;
+
+    // if 3d texture, render each slice separately, otherwise render once
+    for(uint32_t i = 0; i < numFBs; i++)
+    {
       TextureDisplay texDisplay;
 
       texDisplay.Red = texDisplay.Green = texDisplay.Blue = texDisplay.Alpha = true;
@@ -4827,7 +5489,8 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
           &clearval,
       };
 
-      RenderTextureInternal(texDisplay, rpbegin, 0);
+      RenderTextureInternal(texDisplay, rpbegin,
+                            params.remap == eRemap_RGBA32 ? eTexDisplay_F32Render : 0);
     }
 
     m_DebugWidth = oldW;
@@ -5149,39 +5812,16 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
                          imCreateInfo.format, mip);
 
   if(imCreateInfo.format == VK_FORMAT_D24_UNORM_S8_UINT)
-  {
-    dataSize = AlignUp(dataSize, (size_t)4);
-    dataSize += GetByteSize(imInfo.extent.width, imInfo.extent.height, imInfo.extent.depth,
-                            VK_FORMAT_S8_UINT, mip);
-  }
-
-  VkBufferCreateInfo bufInfo = {
-      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      NULL,
-      0,
-      dataSize,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-  };
-
-  VkBuffer readbackBuf = VK_NULL_HANDLE;
-  vkr = vt->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &readbackBuf);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  VkMemoryRequirements mrq = {0};
-
-  vt->GetBufferMemoryRequirements(Unwrap(dev), readbackBuf, &mrq);
-
-  VkMemoryAllocateInfo allocInfo = {
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, dataSize,
-      m_pDriver->GetReadbackMemoryIndex(mrq.memoryTypeBits),
-  };
-
-  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
-  vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &readbackMem);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  {
+    dataSize = AlignUp(dataSize, (size_t)4);
+    dataSize += GetByteSize(imInfo.extent.width, imInfo.extent.height, imInfo.extent.depth,
+                            VK_FORMAT_S8_UINT, mip);
+  }
 
-  vkr = vt->BindBufferMemory(Unwrap(dev), readbackBuf, readbackMem, 0);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  // the readback buffer comes from the debug manager's staging ring, so it doesn't need to be
+  // allocated each time
+  uint32_t readbackSlot = GetDebugManager()->NextReadbackSlot();
+  VkBuffer readbackBuf = GetDebugManager()->BeginReadback(readbackSlot, dataSize);
 
   if(isDepth && isStencil)
   {
@@ -5234,15 +5874,9 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
 
   vt->EndCommandBuffer(Unwrap(cmd));
 
-  m_pDriver->SubmitCmds();
-  m_pDriver->FlushQ();
-
-  // map the buffer and copy to return buffer
-  byte *pData = NULL;
-  vkr = vt->MapMemory(Unwrap(dev), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-  RDCASSERT(pData != NULL);
+  // only wait for this readback to complete, not for the whole device to go idle
+  GetDebugManager()->SubmitReadback(readbackSlot);
+  byte *pData = GetDebugManager()->WaitReadback(readbackSlot);
 
   byte *ret = new byte[dataSize];
 
@@ -5321,11 +5955,12 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
     memcpy(ret, pData, dataSize);
   }
 
-  vt->UnmapMemory(Unwrap(dev), readbackMem);
+  GetDebugManager()->EndReadback(readbackSlot);
+
+  // recycle the command buffers, everything we submitted has completed
+  m_pDriver->FlushQ();
 
   // clean up temporary objects
-  vt->DestroyBuffer(Unwrap(dev), readbackBuf, NULL);
-  vt->FreeMemory(Unwrap(dev), readbackMem, NULL);
 
   if(tmpImage != VK_NULL_HANDLE)
   {
@@ -5348,30 +5983,88 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
   return ret;
 }
 
-void VulkanReplay::BuildCustomShader(string source, string entry, const uint32_t compileFlags,
-                                     ShaderStageType type, ResourceId *id, string *errors)
+static SPIRVShaderStage GetSPIRVStage(ShaderStageType type)
 {
-  SPIRVShaderStage stage = eSPIRVInvalid;
-
   switch(type)
   {
-    case eShaderStage_Vertex: stage = eSPIRVVertex; break;
-    case eShaderStage_Hull: stage = eSPIRVTessControl; break;
-    case eShaderStage_Domain: stage = eSPIRVTessEvaluation; break;
-    case eShaderStage_Geometry: stage = eSPIRVGeometry; break;
-    case eShaderStage_Pixel: stage = eSPIRVFragment; break;
-    case eShaderStage_Compute: stage = eSPIRVCompute; break;
-    default:
-      RDCERR("Unexpected type in BuildShader!");
-      *id = ResourceId();
-      return;
+    case eShaderStage_Vertex: return eSPIRVVertex;
+    case eShaderStage_Hull: return eSPIRVTessControl;
+    case eShaderStage_Domain: return eSPIRVTessEvaluation;
+    case eShaderStage_Geometry: return eSPIRVGeometry;
+    case eShaderStage_Pixel: return eSPIRVFragment;
+    case eShaderStage_Compute: return eSPIRVCompute;
+    default: break;
+  }
+
+  return eSPIRVInvalid;
+}
+
+void VulkanReplay::PrecompileShader(const string &source, ShaderStageType type)
+{
+  SPIRVShaderStage stage = GetSPIRVStage(type);
+
+  if(stage == eSPIRVInvalid)
+    return;
+
+  PrecompiledSPIRV compiled;
+  compiled.stage = stage;
+  compiled.source = source;
+
+  vector<string> sources;
+  sources.push_back(source);
+
+  // glslang is safe to use from multiple threads, and this doesn't touch the device
+  compiled.errors = CompileSPIRV(stage, sources, compiled.spirv);
+
+  SCOPED_LOCK(m_PrecompiledLock);
+  m_PrecompiledSPIRV.push_back(compiled);
+}
+
+string VulkanReplay::CompileShaderSPIRV(SPIRVShaderStage stage, const string &source,
+                                        vector<uint32_t> &spirv)
+{
+  {
+    SCOPED_LOCK(m_PrecompiledLock);
+
+    for(size_t i = 0; i < m_PrecompiledSPIRV.size(); i++)
+    {
+      if(m_PrecompiledSPIRV[i].stage == stage && m_PrecompiledSPIRV[i].source == source)
+      {
+        string errors = m_PrecompiledSPIRV[i].errors;
+        spirv.swap(m_PrecompiledSPIRV[i].spirv);
+        m_PrecompiledSPIRV.erase(m_PrecompiledSPIRV.begin() + i);
+        return errors;
+      }
+    }
   }
 
   vector<string> sources;
   sources.push_back(source);
+
+  return CompileSPIRV(stage, sources, spirv);
+}
+
+void VulkanReplay::PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                                          ShaderStageType type)
+{
+  PrecompileShader(source, type);
+}
+
+void VulkanReplay::BuildCustomShader(string source, string entry, const uint32_t compileFlags,
+                                     ShaderStageType type, ResourceId *id, string *errors)
+{
+  SPIRVShaderStage stage = GetSPIRVStage(type);
+
+  if(stage == eSPIRVInvalid)
+  {
+    RDCERR("Unexpected type in BuildShader!");
+    *id = ResourceId();
+    return;
+  }
+
   vector<uint32_t> spirv;
 
-  string output = CompileSPIRV(stage, sources, spirv);
+  string output = CompileShaderSPIRV(stage, source, spirv);
 
   if(spirv.empty())
   {
@@ -5461,30 +6154,27 @@ ResourceId VulkanReplay::ApplyCustomShader(ResourceId shader, ResourceId texid,
   return GetResID(GetDebugManager()->m_CustomTexImg);
 }
 
+void VulkanReplay::PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                                          ShaderStageType type)
+{
+  PrecompileShader(source, type);
+}
+
 void VulkanReplay::BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                                      ShaderStageType type, ResourceId *id, string *errors)
 {
-  SPIRVShaderStage stage = eSPIRVInvalid;
+  SPIRVShaderStage stage = GetSPIRVStage(type);
 
-  switch(type)
+  if(stage == eSPIRVInvalid)
   {
-    case eShaderStage_Vertex: stage = eSPIRVVertex; break;
-    case eShaderStage_Hull: stage = eSPIRVTessControl; break;
-    case eShaderStage_Domain: stage = eSPIRVTessEvaluation; break;
-    case eShaderStage_Geometry: stage = eSPIRVGeometry; break;
-    case eShaderStage_Pixel: stage = eSPIRVFragment; break;
-    case eShaderStage_Compute: stage = eSPIRVCompute; break;
-    default:
-      RDCERR("Unexpected type in BuildShader!");
-      *id = ResourceId();
-      return;
+    RDCERR("Unexpected type in BuildShader!");
+    *id = ResourceId();
+    return;
   }
 
-  vector<string> sources;
-  sources.push_back(source);
   vector<uint32_t> spirv;
 
-  string output = CompileSPIRV(stage, sources, spirv);
+  string output = CompileShaderSPIRV(stage, source, spirv);
 
   if(spirv.empty())
   {
@@ -5511,11 +6201,16 @@ void VulkanReplay::BuildTargetShader(string source, string entry, const uint32_t
 void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
 {
   GetDebugManager()->ReplaceResource(from, to);
+
+  // cached partial command buffers were recorded with the pipelines being replaced
+  m_pDriver->FreePartialCmdCache();
 }
 
 void VulkanReplay::RemoveReplacement(ResourceId id)
 {
   GetDebugManager()->RemoveReplacement(id);
+
+  m_pDriver->FreePartialCmdCache();
 }
 
 void VulkanReplay::FreeTargetResource(ResourceId id)
@@ -5531,8 +6226,7 @@ vector<PixelModification> VulkanReplay::PixelHistory(vector<EventUsage> events,
                                                      uint32_t mip, uint32_t sampleIdx,
                                                      FormatComponentType typeHint)
 {
-  VULKANNOTIMP("PixelHistory");
-  return vector<PixelModification>();
+  return GetDebugManager()->PixelHistory(events, target, x, y, slice, mip, sampleIdx, typeHint);
 }
 
 ShaderDebugTrace VulkanReplay::DebugVertex(uint32_t eventID, uint32_t vertid, uint32_t instid,
@@ -5558,30 +6252,333 @@ ShaderDebugTrace VulkanReplay::DebugThread(uint32_t eventID, uint32_t groupid[3]
 
 ResourceId VulkanReplay::CreateProxyTexture(const FetchTexture &templateTex)
 {
-  VULKANNOTIMP("CreateProxyTexture");
-  return ResourceId();
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  VkImageCreateInfo imInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      NULL,
+      0,
+      VK_IMAGE_TYPE_2D,
+      MakeVkFormat(templateTex.format),
+      {templateTex.width, templateTex.height, 1},
+      RDCMAX(1U, templateTex.mips),
+      RDCMAX(1U, templateTex.arraysize),
+      // multisampled images can't be the destination of a buffer copy, so the proxy holds the
+      // data that's sent for each slice single-sampled
+      VK_SAMPLE_COUNT_1_BIT,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+          VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_SHARING_MODE_EXCLUSIVE,
+      0,
+      NULL,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  if(templateTex.dimension == 1)
+  {
+    imInfo.imageType = VK_IMAGE_TYPE_1D;
+    imInfo.extent.height = 1;
+  }
+  else if(templateTex.dimension == 3)
+  {
+    imInfo.imageType = VK_IMAGE_TYPE_3D;
+    imInfo.extent.depth = RDCMAX(1U, templateTex.depth);
+    imInfo.arrayLayers = 1;
+  }
+
+  if(templateTex.cubemap && imInfo.imageType == VK_IMAGE_TYPE_2D &&
+     imInfo.extent.width == imInfo.extent.height && (imInfo.arrayLayers % 6) == 0)
+    imInfo.flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+
+  ProxyResource proxy = {};
+
+  VkResult vkr = m_pDriver->vkCreateImage(dev, &imInfo, NULL, &proxy.image);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  m_pDriver->vkGetImageMemoryRequirements(dev, proxy.image, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &proxy.mem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = m_pDriver->vkBindImageMemory(dev, proxy.image, proxy.mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  ResourceId id = GetResID(proxy.image);
+
+  m_ProxyResources[id] = proxy;
+
+  if(templateTex.customName)
+    m_pDriver->m_CreationInfo.m_Names[id] = templateTex.name.elems;
+
+  // the image stays in GENERAL for its lifetime, so uploads don't need any layout transitions and
+  // the texture display code finds it in a known layout
+  ImageLayouts &layouts = m_pDriver->m_ImageLayouts[id];
+
+  VkImageMemoryBarrier barrier = {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      NULL,
+      0,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(proxy.image),
+      layouts.subresourceStates[0].subresourceRange,
+  };
+
+  layouts.subresourceStates[0].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  // no need to wait, the first upload is submitted after this on the same queue
+  m_pDriver->SubmitCmds();
+
+  return id;
 }
 
 void VulkanReplay::SetProxyTextureData(ResourceId texid, uint32_t arrayIdx, uint32_t mip,
                                        byte *data, size_t dataSize)
 {
-  VULKANNOTIMP("SetProxyTextureData");
+  auto it = m_ProxyResources.find(texid);
+  if(it == m_ProxyResources.end() || it->second.image == VK_NULL_HANDLE)
+  {
+    RDCERR("SetProxyTextureData called on non-proxy texture %llu", texid);
+    return;
+  }
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[texid];
+
+  VkExtent3D extent = {
+      RDCMAX(1U, iminfo.extent.width >> mip), RDCMAX(1U, iminfo.extent.height >> mip),
+      RDCMAX(1U, iminfo.extent.depth >> mip),
+  };
+
+  VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+  if(IsStencilOnlyFormat(iminfo.format))
+    aspectFlags = VK_IMAGE_ASPECT_STENCIL_BIT;
+  else if(IsDepthOrStencilFormat(iminfo.format))
+    aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;    // only the depth of depth-stencil is displayed
+
+  size_t expected = (size_t)GetByteSize(iminfo.extent.width, iminfo.extent.height,
+                                        iminfo.extent.depth, iminfo.format, mip);
+
+  if(dataSize < expected)
+  {
+    RDCERR("Insufficient data provided to SetProxyTextureData");
+    return;
+  }
+
+  // the upload ring lets this return as soon as the copy is submitted, so the next subresource can
+  // be received and decoded while the GPU copies this one. We only block if the ring wraps around
+  // onto a copy that's still in flight.
+  VulkanDebugManager *debug = GetDebugManager();
+
+  uint32_t slot = debug->NextUploadSlot();
+
+  VkBuffer stage = VK_NULL_HANDLE;
+  byte *mapped = debug->BeginUpload(slot, (VkDeviceSize)dataSize, stage);
+
+  memcpy(mapped, data, dataSize);
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  uint32_t layer = iminfo.type == VK_IMAGE_TYPE_3D ? 0 : arrayIdx;
+
+  VkBufferImageCopy region = {
+      0, 0, 0, {aspectFlags, mip, layer, 1}, {0, 0, 0}, extent,
+  };
+
+  vt->CmdCopyBufferToImage(Unwrap(cmd), stage, Unwrap(it->second.image), VK_IMAGE_LAYOUT_GENERAL,
+                           1, &region);
+
+  // make the copy visible to the texture display and any readbacks
+  VkImageMemoryBarrier barrier = {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(it->second.image),
+      {aspectFlags, mip, 1, layer, 1},
+  };
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  debug->SubmitUpload(slot);
 }
 
 bool VulkanReplay::IsTextureSupported(const ResourceFormat &format)
 {
-  return true;
+  VkFormat fmt = MakeVkFormat(format);
+
+  if(fmt == VK_FORMAT_UNDEFINED)
+    return false;
+
+  // proxy textures are uploaded with copies and displayed by sampling
+  VkFormatProperties props = {};
+  m_pDriver->vkGetPhysicalDeviceFormatProperties(m_pDriver->GetPhysDev(), fmt, &props);
+
+  return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 
 ResourceId VulkanReplay::CreateProxyBuffer(const FetchBuffer &templateBuf)
 {
-  VULKANNOTIMP("CreateProxyBuffer");
-  return ResourceId();
+  VkDevice dev = m_pDriver->GetDev();
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      NULL,
+      0,
+      RDCMAX((uint64_t)1, templateBuf.length),
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+  };
+
+  ProxyResource proxy = {};
+
+  VkResult vkr = m_pDriver->vkCreateBuffer(dev, &bufInfo, NULL, &proxy.buf);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  m_pDriver->vkGetBufferMemoryRequirements(dev, proxy.buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = m_pDriver->vkAllocateMemory(dev, &allocInfo, NULL, &proxy.mem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vkr = m_pDriver->vkBindBufferMemory(dev, proxy.buf, proxy.mem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  ResourceId id = GetResID(proxy.buf);
+
+  m_ProxyResources[id] = proxy;
+
+  if(templateBuf.customName)
+    m_pDriver->m_CreationInfo.m_Names[id] = templateBuf.name.elems;
+
+  return id;
+}
+
+void VulkanReplay::SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data,
+                                      size_t dataSize)
+{
+  auto it = m_ProxyResources.find(bufid);
+  if(it == m_ProxyResources.end() || it->second.buf == VK_NULL_HANDLE)
+  {
+    RDCERR("SetProxyBufferData called on non-proxy buffer %llu", bufid);
+    return;
+  }
+
+  if(dataSize == 0)
+    return;
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  // as with textures, returns once the copy is submitted
+  VulkanDebugManager *debug = GetDebugManager();
+
+  uint32_t slot = debug->NextUploadSlot();
+
+  VkBuffer stage = VK_NULL_HANDLE;
+  byte *mapped = debug->BeginUpload(slot, (VkDeviceSize)dataSize, stage);
+
+  memcpy(mapped, data, dataSize);
+
+  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkBufferCopy region = {0, offset, dataSize};
+  vt->CmdCopyBuffer(Unwrap(cmd), stage, Unwrap(it->second.buf), 1, &region);
+
+  VkBufferMemoryBarrier barrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_ALL_READ_BITS,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      Unwrap(it->second.buf),
+      offset,
+      dataSize,
+  };
+
+  DoPipelineBarrier(cmd, 1, &barrier);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  debug->SubmitUpload(slot);
 }
 
-void VulkanReplay::SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize)
+void VulkanReplay::DestroyProxyResources()
 {
-  VULKANNOTIMP("SetProxyTextureData");
+  if(m_ProxyResources.empty())
+    return;
+
+  VkDevice dev = m_pDriver->GetDev();
+
+  GetDebugManager()->FlushUploads();
+
+  // the display and any readbacks go through the same queue, so everything is done with them too
+  m_pDriver->FlushQ();
+
+  for(auto it = m_ProxyResources.begin(); it != m_ProxyResources.end(); ++it)
+  {
+    if(it->second.image != VK_NULL_HANDLE)
+      m_pDriver->vkDestroyImage(dev, it->second.image, NULL);
+    if(it->second.buf != VK_NULL_HANDLE)
+      m_pDriver->vkDestroyBuffer(dev, it->second.buf, NULL);
+    m_pDriver->vkFreeMemory(dev, it->second.mem, NULL);
+  }
+
+  m_ProxyResources.clear();
 }
 
 ReplayCreateStatus Vulkan_CreateReplayDevice(const char *logfile, IReplayDriver **driver)
@@ -5640,11 +6637,31 @@ ReplayCreateStatus Vulkan_CreateReplayDevice(const char *logfile, IReplayDriver
   return eReplayCreate_Success;
 }
 
+static string Vulkan_ReadMarkerName(Serialiser *ser)
+{
+  ResourceId cmdid;
+  ser->Serialise("cmdid", cmdid);
+
+  string name;
+  ser->SerialiseInternedString("name", name);
+  return name;
+}
+
 struct VulkanDriverRegistration
 {
   VulkanDriverRegistration()
   {
     RenderDoc::Inst().RegisterReplayProvider(RDC_Vulkan, "Vulkan", &Vulkan_CreateReplayDevice);
+
+    CaptureChunkInfo info;
+    info.chunkName = &WrappedVulkan::GetChunkName;
+    info.readMarkerName = &Vulkan_ReadMarkerName;
+    info.captureScope = CAPTURE_SCOPE;
+    info.pushMarker = BEGIN_EVENT;
+    info.popMarker = END_EVENT;
+    info.setMarker = SET_MARKER;
+    RenderDoc::Inst().RegisterCaptureChunkInfo(RDC_Vulkan, info);
+
     RenderDoc::Inst().SetVulkanLayerCheck(&VulkanReplay::CheckVulkanLayer);
     RenderDoc::Inst().SetVulkanLayerInstall(&VulkanReplay::InstallVulkanLayer);
   }
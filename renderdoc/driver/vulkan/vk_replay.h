@@ -187,10 +187,20 @@ public:
   bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                     FormatComponentType typeHint, float minval, float maxval, bool channels[4],
                     vector<uint32_t> &histogram);
+  bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                           uint32_t &numMatches);
+  bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride, uint32_t numElems,
+                          const ValueSearchParams &params, vector<ValueSearchMatch> &matches,
+                          uint32_t &numMatches);
+  bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                           uint32_t sample, FormatComponentType typeHint);
+  bool DiffTextureInputs(float threshold, TextureCompareResult &result);
 
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData);
+  void GetBuffersData(const vector<BufferDataRange> &ranges, vector<vector<byte> > &retData);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
@@ -199,6 +209,10 @@ public:
 
   void RenderMesh(uint32_t eventID, const vector<MeshFormat> &secondaryDraws, const MeshDisplay &cfg);
 
+  void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
+  void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                              ShaderStageType type);
   void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                          ShaderStageType type, ResourceId *id, string *errors);
   void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
@@ -206,6 +220,16 @@ public:
   void FreeCustomShader(ResourceId id);
 
   bool RenderTexture(TextureDisplay cfg);
+  bool HasPendingTextureData() { return false; }
+  vector<ProxyCommandStats> GetProxyStats() { return vector<ProxyCommandStats>(); }
+  bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page, uint32_t &total)
+  {
+    return false;
+  }
+  bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page, uint32_t &total)
+  {
+    return false;
+  }
 
   void RenderCheckerboard(Vec3f light, Vec3f dark);
 
@@ -238,12 +262,15 @@ public:
   bool IsTextureSupported(const ResourceFormat &format);
 
   ResourceId CreateProxyBuffer(const FetchBuffer &templateBuf);
-  void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize);
+  void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data, size_t dataSize);
 
   bool IsRenderOutput(ResourceId id);
 
   void FileChanged();
 
+  vector<ReplayMemoryStats> GetMemoryStats();
+  void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID);
+
   void InitCallstackResolver();
   bool HasCallstacks();
   Callstack::StackResolver *GetCallstackResolver();
@@ -267,6 +294,23 @@ public:
   static void InstallVulkanLayer(bool systemLevel);
 
 private:
+  void FetchReplayCounters(const vector<uint32_t> &counters, vector<CounterResult> &ret);
+
+  // SPIR-V compiled off-thread by PrecompileShader, consumed by the next build of the same source
+  struct PrecompiledSPIRV
+  {
+    SPIRVShaderStage stage;
+    string source;
+    vector<uint32_t> spirv;
+    string errors;
+  };
+
+  Threading::CriticalSection m_PrecompiledLock;
+  vector<PrecompiledSPIRV> m_PrecompiledSPIRV;
+
+  void PrecompileShader(const string &source, ShaderStageType type);
+  string CompileShaderSPIRV(SPIRVShaderStage stage, const string &source, vector<uint32_t> &spirv);
+
   struct OutputWindow
   {
     OutputWindow();
@@ -345,6 +389,19 @@ private:
 
   bool m_Proxy;
 
+  // images and buffers created to display a remote capture. Their data is uploaded through the
+  // debug manager's upload ring, so these are only destroyed once the uploads are complete.
+  struct ProxyResource
+  {
+    VkImage image;
+    VkBuffer buf;
+    VkDeviceMemory mem;
+  };
+
+  map<ResourceId, ProxyResource> m_ProxyResources;
+
+  void DestroyProxyResources();
+
   WrappedVulkan *m_pDriver;
 
   enum TexDisplayFlags
@@ -359,6 +416,12 @@ private:
   void CreateTexImageView(VkImageAspectFlags aspectFlags, VkImage liveIm,
                           VulkanCreationInfo::Image &iminfo);
 
+  void PrepareValueSearch(uint32_t maxMatches);
+  void DispatchValueSearch(VkCommandBuffer cmd, VkPipeline pipe, uint32_t groupsX,
+                           uint32_t groupsY);
+  void FetchValueSearchResults(uint32_t maxMatches, vector<ValueSearchMatch> &matches,
+                               uint32_t &numMatches);
+
   void FillCBufferVariables(rdctype::array<ShaderConstant>, vector<ShaderVariable> &outvars,
                             const vector<byte> &data, size_t baseOffset);
 
@@ -53,6 +53,7 @@ WRAPPED_POOL_INST(WrappedVkCommandPool)
 
 WRAPPED_POOL_INST(WrappedVkSwapchainKHR)
 WRAPPED_POOL_INST(WrappedVkSurfaceKHR)
+WRAPPED_POOL_INST(WrappedVkDescriptorUpdateTemplateKHR)
 
 byte VkResourceRecord::markerValue[32] = {
     0xaa, 0xbb, 0xcc, 0xdd, 0x88, 0x77, 0x66, 0x55, 0x01, 0x23, 0x45, 0x67, 0x98, 0x76, 0x54, 0x32,
@@ -121,6 +122,8 @@ VkResourceType IdentifyTypeByPtr(WrappedVkRes *ptr)
     return eResSwapchain;
   if(WrappedVkSurfaceKHR::IsAlloc(ptr))
     return eResSurface;
+  if(WrappedVkDescriptorUpdateTemplateKHR::IsAlloc(ptr))
+    return eResDescriptorUpdateTemplate;
 
   RDCERR("Unknown type for ptr 0x%p", ptr);
 
@@ -728,6 +731,28 @@ uint32_t GetByteSize(uint32_t Width, uint32_t Height, uint32_t Depth, VkFormat F
   return ret;
 }
 
+void MemMapState::AllocRefData()
+{
+  FreeRefData();
+
+  refDataSize = (size_t)mapSize;
+  refData = Serialiser::AllocAlignedBuffer(refDataSize);
+
+  RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows, int64_t(refDataSize));
+}
+
+void MemMapState::FreeRefData()
+{
+  if(refData == NULL)
+    return;
+
+  Serialiser::FreeAlignedBuffer(refData);
+  refData = NULL;
+
+  RenderDoc::Inst().AddCaptureMemory(eCaptureMemory_MapShadows, -int64_t(refDataSize));
+  refDataSize = 0;
+}
+
 VkResourceRecord::~VkResourceRecord()
 {
   VkResourceType resType = Resource != NULL ? IdentifyTypeByPtr(Resource) : eResUnknown;
@@ -747,7 +772,7 @@ VkResourceRecord::~VkResourceRecord()
 
   if(resType == eResDeviceMemory && memMapState)
   {
-    Serialiser::FreeAlignedBuffer(memMapState->refData);
+    memMapState->FreeRefData();
 
     SAFE_DELETE(memMapState);
   }
@@ -755,6 +780,9 @@ VkResourceRecord::~VkResourceRecord()
   if(resType == eResCommandBuffer)
     SAFE_DELETE(cmdInfo);
 
+  if(resType == eResCommandPool)
+    SAFE_DELETE(cmdPoolArena);
+
   if(resType == eResFramebuffer || resType == eResRenderPass)
     SAFE_DELETE_ARRAY(imageAttachments);
 
@@ -765,6 +793,9 @@ VkResourceRecord::~VkResourceRecord()
 
   if(resType == eResDescriptorSetLayout || resType == eResDescriptorSet)
     SAFE_DELETE(descInfo);
+
+  if(resType == eResDescriptorUpdateTemplate)
+    SAFE_DELETE(descTemplateInfo);
 }
 
 void SparseMapping::Update(uint32_t numBindings, const VkSparseImageMemoryBind *pBindings)
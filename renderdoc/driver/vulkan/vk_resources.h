@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include "common/wrapped_pool.h"
 #include "core/resource_manager.h"
 #include "vk_common.h"
@@ -69,7 +70,8 @@ enum VkResourceType
   eResSemaphore,
 
   eResSwapchain,
-  eResSurface
+  eResSurface,
+  eResDescriptorUpdateTemplate
 };
 
 // VkDisplayKHR and VkDisplayModeKHR are both UNWRAPPED because there's no need to wrap them.
@@ -138,6 +140,27 @@ struct TypedRealHandle
   bool operator!=(const TypedRealHandle o) const { return !(*this == o); }
 };
 
+template <>
+struct HashKey<TypedRealHandle>
+{
+  // NULL handles compare equal whatever their type, so they must hash the same too
+  static uint64_t Hash(const TypedRealHandle &h)
+  {
+    if(h.real.handle == 0)
+      return 0;
+    return HashMix64(h.real.handle ^ (uint64_t(h.type) << 56));
+  }
+};
+
+// the handle types applications create in the largest numbers reserve address space for this many
+// times their pool size, so that they stay in one range instead of spilling into heap pools. Only
+// on 64-bit, where address space is plentiful.
+#if ENABLED(RDOC_X64)
+#define VK_POOL_RESERVE_SCALE 16
+#else
+#define VK_POOL_RESERVE_SCALE 0
+#endif
+
 struct WrappedVkNonDispRes : public WrappedVkRes
 {
   template <typename T>
@@ -317,7 +340,9 @@ struct WrappedVkDeviceMemory : WrappedVkNonDispRes
   typedef VkDeviceMemory InnerType;
   static const int AllocPoolCount = 128 * 1024;
   static const int AllocPoolMaxByteSize = 3 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkDeviceMemory, AllocPoolCount, AllocPoolMaxByteSize);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkDeviceMemory, AllocPoolCount, AllocPoolMaxByteSize, true,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResDeviceMemory,
@@ -329,7 +354,9 @@ struct WrappedVkBuffer : WrappedVkNonDispRes
   typedef VkBuffer InnerType;
   static const int AllocPoolCount = 128 * 1024;
   static const int AllocPoolMaxByteSize = 3 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkBuffer, AllocPoolCount, AllocPoolMaxByteSize, false);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkBuffer, AllocPoolCount, AllocPoolMaxByteSize, false,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResBuffer,
@@ -341,7 +368,9 @@ struct WrappedVkImage : WrappedVkNonDispRes
   typedef VkImage InnerType;
   static const int AllocPoolCount = 128 * 1024;
   static const int AllocPoolMaxByteSize = 3 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkImage, AllocPoolCount, AllocPoolMaxByteSize);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkImage, AllocPoolCount, AllocPoolMaxByteSize, true,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResImage,
@@ -383,7 +412,9 @@ struct WrappedVkBufferView : WrappedVkNonDispRes
   typedef VkBufferView InnerType;
   static const int AllocPoolCount = 128 * 1024;
   static const int AllocPoolMaxByteSize = 3 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkBufferView, AllocPoolCount, AllocPoolMaxByteSize, false);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkBufferView, AllocPoolCount, AllocPoolMaxByteSize, false,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResBufferView,
@@ -395,7 +426,9 @@ struct WrappedVkImageView : WrappedVkNonDispRes
   typedef VkImageView InnerType;
   static const int AllocPoolCount = 128 * 1024;
   static const int AllocPoolMaxByteSize = 3 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkImageView, AllocPoolCount, AllocPoolMaxByteSize, false);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkImageView, AllocPoolCount, AllocPoolMaxByteSize, false,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResImageView,
@@ -500,7 +533,9 @@ struct WrappedVkDescriptorSet : WrappedVkNonDispRes
   typedef VkDescriptorSet InnerType;
   static const int AllocPoolCount = 256 * 1024;
   static const int AllocPoolMaxByteSize = 6 * 1024 * 1024;
-  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkDescriptorSet, AllocPoolCount, AllocPoolMaxByteSize);
+  static const int AllocPoolReserveCount = AllocPoolCount * VK_POOL_RESERVE_SCALE;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkDescriptorSet, AllocPoolCount, AllocPoolMaxByteSize, true,
+                             AllocPoolReserveCount);
   enum
   {
     TypeEnum = eResDescriptorSet,
@@ -546,6 +581,19 @@ struct WrappedVkSurfaceKHR : WrappedVkNonDispRes
     TypeEnum = eResSurface,
   };
 };
+struct WrappedVkDescriptorUpdateTemplateKHR : WrappedVkNonDispRes
+{
+  WrappedVkDescriptorUpdateTemplateKHR(VkDescriptorUpdateTemplateKHR obj, ResourceId objId)
+      : WrappedVkNonDispRes(obj, objId)
+  {
+  }
+  typedef VkDescriptorUpdateTemplateKHR InnerType;
+  ALLOCATE_WITH_WRAPPED_POOL(WrappedVkDescriptorUpdateTemplateKHR);
+  enum
+  {
+    TypeEnum = eResDescriptorUpdateTemplate,
+  };
+};
 
 // VkDisplayKHR and VkDisplayModeKHR are both UNWRAPPED because there's no need to wrap them.
 // The only thing we need to wrap VkSurfaceKHR for is to get back the window from it later.
@@ -643,6 +691,7 @@ UNWRAP_NONDISP_HELPER(VkFramebuffer)
 UNWRAP_NONDISP_HELPER(VkCommandPool)
 UNWRAP_NONDISP_HELPER(VkSwapchainKHR)
 UNWRAP_NONDISP_HELPER(VkSurfaceKHR)
+UNWRAP_NONDISP_HELPER(VkDescriptorUpdateTemplateKHR)
 
 // VkDisplayKHR and VkDisplayModeKHR are both UNWRAPPED because there's no need to wrap them.
 // The only thing we need to wrap VkSurfaceKHR for is to get back the window from it later.
@@ -885,10 +934,17 @@ struct CmdBufferRecordingInfo
   VkDevice device;
   VkCommandBufferAllocateInfo allocInfo;
 
+  // owned by the pool this was allocated from, the commands recorded are allocated from it
+  ChunkArena *arena;
+
   VkResourceRecord *framebuffer;
 
   vector<pair<ResourceId, ImageRegionState> > imgbarriers;
 
+  // image subresources whose contents this command buffer discards (transitions from UNDEFINED or
+  // clears) before it does anything else with the image. See WrappedVulkan::RecordImageDiscard
+  vector<pair<ResourceId, VkImageSubresourceRange> > discards;
+
   // sparse resources referenced by this command buffer (at submit time
   // need to go through the sparse mapping and reference all memory)
   set<SparseMapping *> sparse;
@@ -902,13 +958,26 @@ struct CmdBufferRecordingInfo
   set<VkDescriptorSet> boundDescSets;
 
   vector<VkResourceRecord *> subcmds;
+
+  // with eRENDERDOC_Option_CaptureEventTimings, primary command buffers write a pair of timestamps
+  // around each draw and dispatch into a query pool of their own, reset at the start of each
+  // recording. The pool lives as long as the command buffer, and each set of baked commands keeps
+  // the chunk index of every event it timed. See WrappedVulkan::BeginEventTiming
+  VkQueryPool timingPool;
+  bool timingActive;
+  vector<uint32_t> timingChunks;
 };
 
 struct DescSetLayout;
+struct DescUpdateTemplate;
 
 struct DescriptorSetData
 {
-  DescriptorSetData() : layout(NULL) {}
+  DescriptorSetData()
+      : layout(NULL), bindFrameRefGen(0), writeRefCount(0), sparseRefCount(0), markedEpoch(0),
+        markedGen(0)
+  {
+  }
   ~DescriptorSetData()
   {
     for(size_t i = 0; i < descBindings.size(); i++)
@@ -928,7 +997,35 @@ struct DescriptorSetData
   // the refcount has the high-bit set if this resource has sparse
   // mapping information
   static const uint32_t SPARSE_REF_BIT = 0x80000000;
-  map<ResourceId, pair<uint32_t, FrameRefType> > bindFrameRefs;
+  struct BindFrameRef
+  {
+    ResourceId id;
+    uint32_t count;
+    FrameRefType ref;
+  };
+
+  // stored flat and unordered so that iterating over a set with thousands of descriptors is cheap,
+  // with an index to find each resource's entry on update.
+  vector<BindFrameRef> bindFrameRefs;
+  HashMap<ResourceId, uint32_t> bindFrameRefIndex;
+
+  // incremented whenever a resource is added to bindFrameRefs or its ref type changes, so that
+  // binding the same set over and over only has to mark its resources referenced once in a
+  // capture until it's updated. Removals don't need to be re-marked.
+  uint32_t bindFrameRefGen;
+
+  // number of entries with writing ref types, and with sparse mappings
+  uint32_t writeRefCount;
+  uint32_t sparseRefCount;
+
+  // the capture epoch and generation that bindFrameRefs were last marked referenced at
+  uint32_t markedEpoch;
+  uint32_t markedGen;
+
+  static bool IsWriteRef(FrameRefType ref)
+  {
+    return ref == eFrameRef_Write || ref == eFrameRef_ReadBeforeWrite;
+  }
 };
 
 struct MemMapState
@@ -940,15 +1037,26 @@ struct MemMapState
         mapFlushed(false),
         mapCoherent(false),
         mappedPtr(NULL),
-        refData(NULL)
+        refData(NULL),
+        refDataSize(0),
+        writeWatch(0)
   {
   }
+
+  // refData counts against the capture memory budget, so it's allocated with mapSize bytes and
+  // freed through these.
+  void AllocRefData();
+  void FreeRefData();
+
   VkDeviceSize mapOffset, mapSize;
   bool needRefData;
   bool mapFlushed;
   bool mapCoherent;
   byte *mappedPtr;
   byte *refData;
+  size_t refDataSize;
+  // while capturing, tracks pages written since refData was last updated. See vkQueueSubmit
+  uint64_t writeWatch;
 };
 
 struct AttachmentInfo
@@ -991,8 +1099,11 @@ public:
     cmdInfo->dirtied.swap(bakedCommands->cmdInfo->dirtied);
     cmdInfo->boundDescSets.swap(bakedCommands->cmdInfo->boundDescSets);
     cmdInfo->imgbarriers.swap(bakedCommands->cmdInfo->imgbarriers);
+    cmdInfo->discards.swap(bakedCommands->cmdInfo->discards);
     cmdInfo->subcmds.swap(bakedCommands->cmdInfo->subcmds);
     cmdInfo->sparse.swap(bakedCommands->cmdInfo->sparse);
+    cmdInfo->timingChunks.swap(bakedCommands->cmdInfo->timingChunks);
+    bakedCommands->cmdInfo->timingPool = cmdInfo->timingPool;
   }
 
   void AddBindFrameRef(ResourceId id, FrameRefType ref, bool hasSparse = false)
@@ -1003,17 +1114,37 @@ public:
       return;
     }
 
-    if((descInfo->bindFrameRefs[id].first & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
+    auto it = descInfo->bindFrameRefIndex.find(id);
+
+    if(it == descInfo->bindFrameRefIndex.end())
     {
-      descInfo->bindFrameRefs[id] =
-          std::make_pair(1 | (hasSparse ? DescriptorSetData::SPARSE_REF_BIT : 0), ref);
+      DescriptorSetData::BindFrameRef bind;
+      bind.id = id;
+      bind.count = 1 | (hasSparse ? DescriptorSetData::SPARSE_REF_BIT : 0);
+      bind.ref = ref;
+
+      descInfo->bindFrameRefIndex[id] = (uint32_t)descInfo->bindFrameRefs.size();
+      descInfo->bindFrameRefs.push_back(bind);
+
+      if(DescriptorSetData::IsWriteRef(ref))
+        descInfo->writeRefCount++;
+      if(hasSparse)
+        descInfo->sparseRefCount++;
+
+      descInfo->bindFrameRefGen++;
     }
     else
     {
+      DescriptorSetData::BindFrameRef &bind = descInfo->bindFrameRefs[it->second];
+
       // be conservative - mark refs as read before write if we see a write and a read ref on it
-      if(ref == eFrameRef_Write && descInfo->bindFrameRefs[id].second == eFrameRef_Read)
-        descInfo->bindFrameRefs[id].second = eFrameRef_ReadBeforeWrite;
-      descInfo->bindFrameRefs[id].first++;
+      if(ref == eFrameRef_Write && bind.ref == eFrameRef_Read)
+      {
+        bind.ref = eFrameRef_ReadBeforeWrite;
+        descInfo->writeRefCount++;
+        descInfo->bindFrameRefGen++;
+      }
+      bind.count++;
     }
   }
 
@@ -1024,19 +1155,37 @@ public:
     if(id == ResourceId())
       return;
 
-    auto it = descInfo->bindFrameRefs.find(id);
+    auto it = descInfo->bindFrameRefIndex.find(id);
 
     // in the case of re-used handles bound to descriptor sets,
     // it's possible to try and remove a frameref on something we
     // don't have (which means we'll have a corresponding stale ref)
     // but this is harmless so we can ignore it.
-    if(it == descInfo->bindFrameRefs.end())
+    if(it == descInfo->bindFrameRefIndex.end())
       return;
 
-    it->second.first--;
+    uint32_t idx = it->second;
+    vector<DescriptorSetData::BindFrameRef> &refs = descInfo->bindFrameRefs;
 
-    if((it->second.first & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
-      descInfo->bindFrameRefs.erase(it);
+    refs[idx].count--;
+
+    if((refs[idx].count & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
+    {
+      if(DescriptorSetData::IsWriteRef(refs[idx].ref))
+        descInfo->writeRefCount--;
+      if(refs[idx].count & DescriptorSetData::SPARSE_REF_BIT)
+        descInfo->sparseRefCount--;
+
+      descInfo->bindFrameRefIndex.erase(it);
+
+      // move the last entry into the hole to keep the array packed
+      if(idx + 1 < refs.size())
+      {
+        refs[idx] = refs.back();
+        descInfo->bindFrameRefIndex[refs[idx].id] = idx;
+      }
+      refs.pop_back();
+    }
   }
 
   // we have a lot of 'cold' data in the resource record, as it can be accessed
@@ -1073,8 +1222,10 @@ public:
     SwapchainInfo *swapInfo;                       // only for swapchains
     MemMapState *memMapState;                      // only for device memory
     CmdBufferRecordingInfo *cmdInfo;               // only for command buffers
+    ChunkArena *cmdPoolArena;                      // only for command pools
     AttachmentInfo *imageAttachments;              // only for framebuffers and render passes
     DescriptorSetData *descInfo;    // only for descriptor sets and descriptor set layouts
+    DescUpdateTemplate *descTemplateInfo;    // only for descriptor update templates
   };
 
   VkResourceRecord *bakedCommands;
@@ -1162,8 +1313,21 @@ struct ImageLayouts
   int layerCount, levelCount, sampleCount;
   VkExtent3D extent;
   VkFormat format;
+
+  // capture-side only, the aspects of each subresource (indexed by layer * levelCount + mip) that
+  // were discarded in the frame being captured before anything read them. Empty if none were
+  vector<VkImageAspectFlags> discarded;
 };
 
+struct ResourceIdHasher
+{
+  size_t operator()(const ResourceId &id) const { return (size_t)HashKey<ResourceId>::Hash(id); }
+};
+
+// layouts are fetched by pointer under m_ImageLayoutsLock and then used outside of it, so this
+// must keep references stable when other threads insert - which HashMap doesn't
+typedef std::unordered_map<ResourceId, ImageLayouts, ResourceIdHasher> ImageLayoutMap;
+
 bool IsBlockFormat(VkFormat f);
 bool IsDepthOrStencilFormat(VkFormat f);
 bool IsDepthAndStencilFormat(VkFormat f);
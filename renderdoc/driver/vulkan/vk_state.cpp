@@ -87,7 +87,16 @@ void VulkanRenderState::BeginRenderPassAndApplyState(VkCommandBuffer cmd)
 {
   RDCASSERT(renderPass != ResourceId());
 
-  // clear values don't matter as we're using the load renderpass here, that
+  BeginRenderPassAndApplyState(cmd,
+                               Unwrap(m_CreationInfo->m_RenderPass[renderPass].loadRPs[subpass]));
+}
+
+void VulkanRenderState::BeginRenderPassAndApplyState(VkCommandBuffer cmd,
+                                                     VkRenderPass unwrappedRenderPass)
+{
+  RDCASSERT(renderPass != ResourceId());
+
+  // clear values don't matter as we're using a load renderpass here, that
   // has all load ops set to load (as we're doing a partial replay - can't
   // just clear the targets that are partially written to).
 
@@ -98,7 +107,7 @@ void VulkanRenderState::BeginRenderPassAndApplyState(VkCommandBuffer cmd)
   VkRenderPassBeginInfo rpbegin = {
       VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
       NULL,
-      Unwrap(m_CreationInfo->m_RenderPass[renderPass].loadRPs[subpass]),
+      unwrappedRenderPass,
       Unwrap(GetResourceManager()->GetCurrentHandle<VkFramebuffer>(framebuffer)),
       renderArea,
       (uint32_t)m_CreationInfo->m_RenderPass[renderPass].attachments.size(),
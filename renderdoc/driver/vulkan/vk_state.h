@@ -35,6 +35,7 @@ struct VulkanRenderState
   VulkanRenderState(VulkanCreationInfo *createInfo);
   VulkanRenderState &operator=(const VulkanRenderState &o);
   void BeginRenderPassAndApplyState(VkCommandBuffer cmd);
+  void BeginRenderPassAndApplyState(VkCommandBuffer cmd, VkRenderPass unwrappedRenderPass);
   void EndRenderPass(VkCommandBuffer cmd);
   void BindPipeline(VkCommandBuffer cmd);
 
@@ -339,6 +339,8 @@ VkResult WrappedVulkan::vkCreateCommandPool(VkDevice device,
                                             const VkAllocationCallbacks *pAllocator,
                                             VkCommandPool *pCmdPool)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret =
       ObjDisp(device)->CreateCommandPool(Unwrap(device), pCreateInfo, pAllocator, pCmdPool);
 
@@ -361,6 +363,7 @@ VkResult WrappedVulkan::vkCreateCommandPool(VkDevice device,
 
       VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pCmdPool);
       record->AddChunk(chunk);
+      record->cmdPoolArena = new ChunkArena();
     }
     else
     {
@@ -374,12 +377,38 @@ VkResult WrappedVulkan::vkCreateCommandPool(VkDevice device,
 VkResult WrappedVulkan::vkResetCommandPool(VkDevice device, VkCommandPool cmdPool,
                                            VkCommandPoolResetFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
+  VkResourceRecord *poolRecord = GetRecord(cmdPool);
+
+  if(poolRecord && poolRecord->cmdPoolArena)
+  {
+    poolRecord->LockChunks();
+    vector<VkResourceRecord *> cmdBuffers = poolRecord->pooledChildren;
+    poolRecord->UnlockChunks();
+
+    // this resets every command buffer in the pool, so remove all their baked commands the same way
+    // as vkResetCommandBuffer. Once any references held for a capture are gone, the pages they
+    // were allocated from are freed together
+    for(size_t i = 0; i < cmdBuffers.size(); i++)
+    {
+      if(cmdBuffers[i]->bakedCommands)
+        cmdBuffers[i]->bakedCommands->Delete(GetResourceManager());
+
+      cmdBuffers[i]->bakedCommands = NULL;
+    }
+
+    poolRecord->cmdPoolArena->Reset();
+  }
+
   return ObjDisp(device)->ResetCommandPool(Unwrap(device), Unwrap(cmdPool), flags);
 }
 
 void WrappedVulkan::vkTrimCommandPoolKHR(VkDevice device, VkCommandPool commandPool,
                                          VkCommandPoolTrimFlagsKHR flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->TrimCommandPoolKHR(Unwrap(device), Unwrap(commandPool), flags);
 }
 
@@ -389,6 +418,8 @@ VkResult WrappedVulkan::vkAllocateCommandBuffers(VkDevice device,
                                                  const VkCommandBufferAllocateInfo *pAllocateInfo,
                                                  VkCommandBuffer *pCommandBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkCommandBufferAllocateInfo unwrappedInfo = *pAllocateInfo;
   unwrappedInfo.commandPool = Unwrap(unwrappedInfo.commandPool);
   VkResult ret =
@@ -437,6 +468,7 @@ VkResult WrappedVulkan::vkAllocateCommandBuffers(VkDevice device,
         record->cmdInfo->device = device;
         record->cmdInfo->allocInfo = *pAllocateInfo;
         record->cmdInfo->allocInfo.commandBufferCount = 1;
+        record->cmdInfo->arena = record->pool->cmdPoolArena;
       }
       else
       {
@@ -523,7 +555,40 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(Serialiser *localSerialiser,
       }
     }
 
-    if(partial || (m_DrawcallCallback && m_DrawcallCallback->RecordAllCmds()))
+    bool cacheable = partial && partialType == Primary && CanCachePartialCmd(bakeId);
+
+    if(cacheable)
+    {
+      for(size_t i = 0; i < m_PartialCmdCache.size(); i++)
+      {
+        if(m_PartialCmdCache[i].bakeId == bakeId &&
+           m_PartialCmdCache[i].baseEvent == m_Partial[Primary].baseEvent &&
+           m_PartialCmdCache[i].lastEvent == m_LastEventID)
+        {
+#if ENABLED(VERBOSE_PARTIAL_REPLAY)
+          RDCDEBUG("vkBegin - using cached partial command buffer for %llu up to %u", bakeId,
+                   m_LastEventID);
+#endif
+
+          // move it to the back as the most recently used, where the replay loop will look for it
+          CachedPartialCmdBuffer cached = m_PartialCmdCache[i];
+          m_PartialCmdCache.erase(m_PartialCmdCache.begin() + i);
+          m_PartialCmdCache.push_back(cached);
+
+          m_Partial[Primary].resultPartialCmdBuffer = cached.cmd;
+          m_Partial[Primary].resultCached = true;
+
+          m_PartialCacheSkip = true;
+          break;
+        }
+      }
+    }
+
+    if(m_PartialCacheSkip)
+    {
+      // nothing to record, the cached command buffer is already complete
+    }
+    else if(partial || (m_DrawcallCallback && m_DrawcallCallback->RecordAllCmds()))
     {
       // pull all re-recorded commands from our own device and command pool for easier cleanup
       if(!partial)
@@ -547,6 +612,7 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(Serialiser *localSerialiser,
       if(partial)
       {
         m_Partial[partialType].resultPartialCmdBuffer = cmd;
+        m_Partial[partialType].resultCached = cacheable;
       }
       else
       {
@@ -563,8 +629,12 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(Serialiser *localSerialiser,
         m_RerecordCmds[cmdId] = cmd;
       }
 
-      // add one-time submit flag as this partial cmd buffer will only be submitted once
-      info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+      // add one-time submit flag as this partial cmd buffer will only be submitted once, unless
+      // it's being kept around for later replays
+      if(cacheable)
+        info.flags &= ~VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+      else
+        info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
       ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &info);
     }
@@ -610,6 +680,7 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(Serialiser *localSerialiser,
       m_BakedCmdBufferInfo[cmdId].curEventID = 0;
       m_BakedCmdBufferInfo[cmdId].eventCount = 0;
       m_BakedCmdBufferInfo[cmdId].drawCount = 0;
+      m_BakedCmdBufferInfo[cmdId].chunkEventIDs.clear();
 
       m_BakedCmdBufferInfo[cmdId].drawStack.push_back(draw);
     }
@@ -623,6 +694,8 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(Serialiser *localSerialiser,
 VkResult WrappedVulkan::vkBeginCommandBuffer(VkCommandBuffer commandBuffer,
                                              const VkCommandBufferBeginInfo *pBeginInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResourceRecord *record = GetRecord(commandBuffer);
   RDCASSERT(record);
 
@@ -648,7 +721,7 @@ VkResult WrappedVulkan::vkBeginCommandBuffer(VkCommandBuffer commandBuffer,
       SCOPED_SERIALISE_CONTEXT(BEGIN_CMD_BUFFER);
       Serialise_vkBeginCommandBuffer(localSerialiser, commandBuffer, pBeginInfo);
 
-      record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get(record->cmdInfo->arena));
     }
 
     if(pBeginInfo->pInheritanceInfo)
@@ -661,18 +734,22 @@ VkResult WrappedVulkan::vkBeginCommandBuffer(VkCommandBuffer commandBuffer,
   }
 
   VkCommandBufferInheritanceInfo unwrappedInfo;
+  VkCommandBufferBeginInfo beginInfo = *pBeginInfo;
   if(pBeginInfo->pInheritanceInfo)
   {
     unwrappedInfo = *pBeginInfo->pInheritanceInfo;
     unwrappedInfo.framebuffer = Unwrap(unwrappedInfo.framebuffer);
     unwrappedInfo.renderPass = Unwrap(unwrappedInfo.renderPass);
 
-    VkCommandBufferBeginInfo beginInfo = *pBeginInfo;
     beginInfo.pInheritanceInfo = &unwrappedInfo;
-    return ObjDisp(commandBuffer)->BeginCommandBuffer(Unwrap(commandBuffer), &beginInfo);
   }
 
-  return ObjDisp(commandBuffer)->BeginCommandBuffer(Unwrap(commandBuffer), pBeginInfo);
+  VkResult ret = ObjDisp(commandBuffer)->BeginCommandBuffer(Unwrap(commandBuffer), &beginInfo);
+
+  if(ret == VK_SUCCESS)
+    BeginEventTimings(commandBuffer);
+
+  return ret;
 }
 
 bool WrappedVulkan::Serialise_vkEndCommandBuffer(Serialiser *localSerialiser,
@@ -727,7 +804,36 @@ bool WrappedVulkan::Serialise_vkEndCommandBuffer(Serialiser *localSerialiser,
       m_RerecordCmds.erase(cmdid);
 
       if(m_Partial[Primary].partialParent == cmdid)
+      {
+        if(m_Partial[Primary].resultCached)
+        {
+          // keep it for later replays up to the same event. The replay loop fills in where the
+          // chunks after this one start
+          CachedPartialCmdBuffer cached(&m_CreationInfo);
+          cached.bakeId = bakeId;
+          cached.baseEvent = m_Partial[Primary].baseEvent;
+          cached.lastEvent = m_LastEventID;
+          cached.device = m_Partial[Primary].partialDevice;
+          cached.pool = m_Partial[Primary].resultPartialCmdPool;
+          cached.cmd = m_Partial[Primary].resultPartialCmdBuffer;
+          cached.endOffset = 0;
+          cached.renderPassActive = m_Partial[Primary].renderPassActive;
+          cached.renderState = m_RenderState;
+
+          if(m_PartialCmdCache.size() >= MaxCachedPartialCmdBuffers)
+          {
+            CachedPartialCmdBuffer &oldest = m_PartialCmdCache.front();
+            vkFreeCommandBuffers(oldest.device, oldest.pool, 1, &oldest.cmd);
+            m_PartialCmdCache.erase(m_PartialCmdCache.begin());
+          }
+
+          m_PartialCmdCache.push_back(cached);
+
+          m_PartialCacheStore = true;
+        }
+
         m_Partial[Primary].partialParent = ResourceId();
+      }
     }
 
     m_BakedCmdBufferInfo[cmdid].curEventID = 0;
@@ -764,6 +870,8 @@ bool WrappedVulkan::Serialise_vkEndCommandBuffer(Serialiser *localSerialiser,
       m_BakedCmdBufferInfo[bakeId].curEventID = 0;
       m_BakedCmdBufferInfo[bakeId].eventCount = m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID;
       m_BakedCmdBufferInfo[bakeId].drawCount = m_BakedCmdBufferInfo[m_LastCmdBufferID].drawCount;
+      m_BakedCmdBufferInfo[bakeId].chunkEventIDs.swap(
+          m_BakedCmdBufferInfo[m_LastCmdBufferID].chunkEventIDs);
 
       m_BakedCmdBufferInfo[m_LastCmdBufferID].draw = NULL;
       m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID = 0;
@@ -777,6 +885,8 @@ bool WrappedVulkan::Serialise_vkEndCommandBuffer(Serialiser *localSerialiser,
 
 VkResult WrappedVulkan::vkEndCommandBuffer(VkCommandBuffer commandBuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResourceRecord *record = GetRecord(commandBuffer);
   RDCASSERT(record);
 
@@ -791,7 +901,7 @@ VkResult WrappedVulkan::vkEndCommandBuffer(VkCommandBuffer commandBuffer)
       SCOPED_SERIALISE_CONTEXT(END_CMD_BUFFER);
       Serialise_vkEndCommandBuffer(localSerialiser, commandBuffer);
 
-      record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get(record->cmdInfo->arena));
     }
 
     record->Bake();
@@ -803,6 +913,8 @@ VkResult WrappedVulkan::vkEndCommandBuffer(VkCommandBuffer commandBuffer)
 VkResult WrappedVulkan::vkResetCommandBuffer(VkCommandBuffer commandBuffer,
                                              VkCommandBufferResetFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResourceRecord *record = GetRecord(commandBuffer);
   RDCASSERT(record);
 
@@ -904,6 +1016,7 @@ void WrappedVulkan::vkCmdBeginRenderPass(VkCommandBuffer commandBuffer,
                                          const VkRenderPassBeginInfo *pRenderPassBegin,
                                          VkSubpassContents contents)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkRenderPassBeginInfo unwrappedInfo = *pRenderPassBegin;
@@ -920,12 +1033,26 @@ void WrappedVulkan::vkCmdBeginRenderPass(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CONTEXT(BEGIN_RENDERPASS);
     Serialise_vkCmdBeginRenderPass(localSerialiser, commandBuffer, pRenderPassBegin, contents);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(pRenderPassBegin->renderPass), eFrameRef_Read);
 
     VkResourceRecord *fb = GetRecord(pRenderPassBegin->framebuffer);
 
     record->MarkResourceFrameReferenced(fb->GetResourceID(), eFrameRef_Read);
+
+    // attachments starting in the undefined layout are discarded by the render pass. Check them
+    // all before any are marked referenced, as one image can be several attachments
+    for(size_t i = 0; i < VkResourceRecord::MaxImageAttachments; i++)
+    {
+      VkResourceRecord *att = fb->imageAttachments[i].record;
+      if(att == NULL)
+        break;
+
+      if(fb->imageAttachments[i].barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+        RecordImageDiscard(record, att->baseResource,
+                           fb->imageAttachments[i].barrier.subresourceRange);
+    }
+
     for(size_t i = 0; i < VkResourceRecord::MaxImageAttachments; i++)
     {
       VkResourceRecord *att = fb->imageAttachments[i].record;
@@ -1004,6 +1131,7 @@ bool WrappedVulkan::Serialise_vkCmdNextSubpass(Serialiser *localSerialiser,
 
 void WrappedVulkan::vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdNextSubpass(Unwrap(commandBuffer), contents);
@@ -1017,7 +1145,7 @@ void WrappedVulkan::vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassCon
     SCOPED_SERIALISE_CONTEXT(NEXT_SUBPASS);
     Serialise_vkCmdNextSubpass(localSerialiser, commandBuffer, contents);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -1081,6 +1209,7 @@ bool WrappedVulkan::Serialise_vkCmdEndRenderPass(Serialiser *localSerialiser,
 
 void WrappedVulkan::vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdEndRenderPass(Unwrap(commandBuffer));
@@ -1094,7 +1223,7 @@ void WrappedVulkan::vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
     SCOPED_SERIALISE_CONTEXT(END_RENDERPASS);
     Serialise_vkCmdEndRenderPass(localSerialiser, commandBuffer);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     VkResourceRecord *fb = record->cmdInfo->framebuffer;
 
@@ -1149,11 +1278,13 @@ bool WrappedVulkan::Serialise_vkCmdBindPipeline(Serialiser *localSerialiser,
 
       if(!m_CreationInfo.m_Pipeline[liveid].dynamicStates[VK_DYNAMIC_STATE_VIEWPORT])
       {
-        m_RenderState.views = m_CreationInfo.m_Pipeline[liveid].viewports;
+        m_RenderState.views.assign(m_CreationInfo.m_Pipeline[liveid].viewports.begin(),
+                                   m_CreationInfo.m_Pipeline[liveid].viewports.end());
       }
       if(!m_CreationInfo.m_Pipeline[liveid].dynamicStates[VK_DYNAMIC_STATE_SCISSOR])
       {
-        m_RenderState.scissors = m_CreationInfo.m_Pipeline[liveid].scissors;
+        m_RenderState.scissors.assign(m_CreationInfo.m_Pipeline[liveid].scissors.begin(),
+                                      m_CreationInfo.m_Pipeline[liveid].scissors.end());
       }
       if(!m_CreationInfo.m_Pipeline[liveid].dynamicStates[VK_DYNAMIC_STATE_LINE_WIDTH])
       {
@@ -1209,6 +1340,7 @@ bool WrappedVulkan::Serialise_vkCmdBindPipeline(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdBindPipeline(VkCommandBuffer commandBuffer,
                                       VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdBindPipeline(Unwrap(commandBuffer), pipelineBindPoint, Unwrap(pipeline));
@@ -1222,7 +1354,7 @@ void WrappedVulkan::vkCmdBindPipeline(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CONTEXT(BIND_PIPELINE);
     Serialise_vkCmdBindPipeline(localSerialiser, commandBuffer, pipelineBindPoint, pipeline);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(pipeline), eFrameRef_Read);
   }
 }
@@ -1388,6 +1520,7 @@ void WrappedVulkan::vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer,
                                             uint32_t dynamicOffsetCount,
                                             const uint32_t *pDynamicOffsets)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkDescriptorSet *unwrapped = GetTempArray<VkDescriptorSet>(setCount);
@@ -1409,7 +1542,7 @@ void WrappedVulkan::vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer,
                                       firstSet, setCount, pDescriptorSets, dynamicOffsetCount,
                                       pDynamicOffsets);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(layout), eFrameRef_Read);
     record->cmdInfo->boundDescSets.insert(pDescriptorSets, pDescriptorSets + setCount);
 
@@ -1421,14 +1554,16 @@ void WrappedVulkan::vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer,
     // lower frequency.
     for(uint32_t i = 0; i < setCount; i++)
     {
-      VkResourceRecord *descSet = GetRecord(pDescriptorSets[i]);
+      DescriptorSetData &descInfo = *GetRecord(pDescriptorSets[i])->descInfo;
 
-      map<ResourceId, pair<uint32_t, FrameRefType> > &frameRefs = descSet->descInfo->bindFrameRefs;
+      // most sets are read-only, so skip looking through them at all
+      if(descInfo.writeRefCount == 0)
+        continue;
 
-      for(auto it = frameRefs.begin(); it != frameRefs.end(); ++it)
+      for(size_t r = 0; r < descInfo.bindFrameRefs.size(); r++)
       {
-        if(it->second.second == eFrameRef_Write || it->second.second == eFrameRef_ReadBeforeWrite)
-          record->cmdInfo->dirtied.insert(it->first);
+        if(DescriptorSetData::IsWriteRef(descInfo.bindFrameRefs[r].ref))
+          record->cmdInfo->dirtied.insert(descInfo.bindFrameRefs[r].id);
       }
     }
   }
@@ -1515,6 +1650,7 @@ void WrappedVulkan::vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32
                                            uint32_t bindingCount, const VkBuffer *pBuffers,
                                            const VkDeviceSize *pOffsets)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkBuffer *unwrapped = GetTempArray<VkBuffer>(bindingCount);
@@ -1534,7 +1670,7 @@ void WrappedVulkan::vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32
     Serialise_vkCmdBindVertexBuffers(localSerialiser, commandBuffer, firstBinding, bindingCount,
                                      pBuffers, pOffsets);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     for(uint32_t i = 0; i < bindingCount; i++)
     {
       record->MarkResourceFrameReferenced(GetResID(pBuffers[i]), eFrameRef_Read);
@@ -1594,6 +1730,7 @@ bool WrappedVulkan::Serialise_vkCmdBindIndexBuffer(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer,
                                          VkDeviceSize offset, VkIndexType indexType)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdBindIndexBuffer(Unwrap(commandBuffer), Unwrap(buffer), offset, indexType);
@@ -1607,7 +1744,7 @@ void WrappedVulkan::vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer
     SCOPED_SERIALISE_CONTEXT(BIND_INDEX_BUFFER);
     Serialise_vkCmdBindIndexBuffer(localSerialiser, commandBuffer, buffer, offset, indexType);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
     if(GetRecord(buffer)->sparseInfo)
@@ -1624,7 +1761,7 @@ bool WrappedVulkan::Serialise_vkCmdUpdateBuffer(Serialiser *localSerialiser,
   SERIALISE_ELEMENT(ResourceId, bufid, GetResID(destBuffer));
   SERIALISE_ELEMENT(VkDeviceSize, offs, destOffset);
   SERIALISE_ELEMENT(VkDeviceSize, sz, dataSize);
-  SERIALISE_ELEMENT_BUF(byte *, bufdata, (byte *)pData, (size_t)dataSize);
+  SERIALISE_ELEMENT_BUF_BORROWED(bufdata, (const byte *)pData, (size_t)dataSize);
 
   Serialise_DebugMessages(localSerialiser, false);
 
@@ -1639,7 +1776,8 @@ bool WrappedVulkan::Serialise_vkCmdUpdateBuffer(Serialiser *localSerialiser,
     {
       commandBuffer = RerecordCmdBuf(cmdid);
       ObjDisp(commandBuffer)
-          ->CmdUpdateBuffer(Unwrap(commandBuffer), Unwrap(destBuffer), offs, sz, (uint32_t *)bufdata);
+          ->CmdUpdateBuffer(Unwrap(commandBuffer), Unwrap(destBuffer), offs, sz,
+                            (const uint32_t *)bufdata);
     }
   }
   else if(m_State == READING)
@@ -1648,12 +1786,10 @@ bool WrappedVulkan::Serialise_vkCmdUpdateBuffer(Serialiser *localSerialiser,
     destBuffer = GetResourceManager()->GetLiveHandle<VkBuffer>(bufid);
 
     ObjDisp(commandBuffer)
-        ->CmdUpdateBuffer(Unwrap(commandBuffer), Unwrap(destBuffer), offs, sz, (uint32_t *)bufdata);
+        ->CmdUpdateBuffer(Unwrap(commandBuffer), Unwrap(destBuffer), offs, sz,
+                          (const uint32_t *)bufdata);
   }
 
-  if(m_State < WRITING)
-    SAFE_DELETE_ARRAY(bufdata);
-
   return true;
 }
 
@@ -1661,6 +1797,7 @@ void WrappedVulkan::vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer de
                                       VkDeviceSize destOffset, VkDeviceSize dataSize,
                                       const uint32_t *pData)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1676,7 +1813,7 @@ void WrappedVulkan::vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer de
     Serialise_vkCmdUpdateBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, dataSize,
                                 pData);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     VkResourceRecord *buf = GetRecord(destBuffer);
 
@@ -1730,6 +1867,7 @@ bool WrappedVulkan::Serialise_vkCmdFillBuffer(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer destBuffer,
                                     VkDeviceSize destOffset, VkDeviceSize fillSize, uint32_t data)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1744,7 +1882,7 @@ void WrappedVulkan::vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dest
     SCOPED_SERIALISE_CONTEXT(FILL_BUF);
     Serialise_vkCmdFillBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, fillSize, data);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     VkResourceRecord *buf = GetRecord(destBuffer);
 
@@ -1769,7 +1907,7 @@ bool WrappedVulkan::Serialise_vkCmdPushConstants(Serialiser *localSerialiser,
   SERIALISE_ELEMENT(VkShaderStageFlagBits, flags, (VkShaderStageFlagBits)stageFlags);
   SERIALISE_ELEMENT(uint32_t, s, start);
   SERIALISE_ELEMENT(uint32_t, len, length);
-  SERIALISE_ELEMENT_BUF(byte *, vals, (byte *)values, (size_t)len);
+  SERIALISE_ELEMENT_BUF_BORROWED(vals, (const byte *)values, (size_t)len);
 
   Serialise_DebugMessages(localSerialiser, false);
 
@@ -1797,9 +1935,6 @@ bool WrappedVulkan::Serialise_vkCmdPushConstants(Serialiser *localSerialiser,
     ObjDisp(commandBuffer)->CmdPushConstants(Unwrap(commandBuffer), Unwrap(layout), flags, s, len, vals);
   }
 
-  if(m_State < WRITING)
-    SAFE_DELETE_ARRAY(vals);
-
   return true;
 }
 
@@ -1807,6 +1942,7 @@ void WrappedVulkan::vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipeline
                                        VkShaderStageFlags stageFlags, uint32_t start,
                                        uint32_t length, const void *values)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1822,7 +1958,7 @@ void WrappedVulkan::vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipeline
     Serialise_vkCmdPushConstants(localSerialiser, commandBuffer, layout, stageFlags, start, length,
                                  values);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(layout), eFrameRef_Read);
   }
 }
@@ -1933,6 +2069,7 @@ void WrappedVulkan::vkCmdPipelineBarrier(
     uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers,
     uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   {
@@ -1972,7 +2109,14 @@ void WrappedVulkan::vkCmdPipelineBarrier(
                                    bufferMemoryBarrierCount, pBufferMemoryBarriers,
                                    imageMemoryBarrierCount, pImageMemoryBarriers);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
+
+    for(uint32_t i = 0; i < imageMemoryBarrierCount; i++)
+    {
+      if(pImageMemoryBarriers[i].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+        RecordImageDiscard(record, GetResID(pImageMemoryBarriers[i].image),
+                           pImageMemoryBarriers[i].subresourceRange);
+    }
 
     if(imageMemoryBarrierCount > 0)
     {
@@ -2024,6 +2168,7 @@ void WrappedVulkan::vkCmdWriteTimestamp(VkCommandBuffer commandBuffer,
                                         VkPipelineStageFlagBits pipelineStage,
                                         VkQueryPool queryPool, uint32_t query)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -2038,7 +2183,7 @@ void WrappedVulkan::vkCmdWriteTimestamp(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CONTEXT(WRITE_TIMESTAMP);
     Serialise_vkCmdWriteTimestamp(localSerialiser, commandBuffer, pipelineStage, queryPool, query);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(queryPool), eFrameRef_Read);
   }
@@ -2095,6 +2240,7 @@ void WrappedVulkan::vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQ
                                               VkBuffer destBuffer, VkDeviceSize destOffset,
                                               VkDeviceSize destStride, VkQueryResultFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -2111,7 +2257,7 @@ void WrappedVulkan::vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQ
     Serialise_vkCmdCopyQueryPoolResults(localSerialiser, commandBuffer, queryPool, firstQuery,
                                         queryCount, destBuffer, destOffset, destStride, flags);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(queryPool), eFrameRef_Read);
 
     VkResourceRecord *buf = GetRecord(destBuffer);
@@ -2166,6 +2312,7 @@ bool WrappedVulkan::Serialise_vkCmdBeginQuery(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool,
                                     uint32_t query, VkQueryControlFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdBeginQuery(Unwrap(commandBuffer), Unwrap(queryPool), query, flags);
@@ -2179,7 +2326,7 @@ void WrappedVulkan::vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool q
     SCOPED_SERIALISE_CONTEXT(BEGIN_QUERY);
     Serialise_vkCmdBeginQuery(localSerialiser, commandBuffer, queryPool, query, flags);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(queryPool), eFrameRef_Read);
   }
 }
@@ -2220,6 +2367,7 @@ bool WrappedVulkan::Serialise_vkCmdEndQuery(Serialiser *localSerialiser,
 
 void WrappedVulkan::vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)->CmdEndQuery(Unwrap(commandBuffer), Unwrap(queryPool), query);
@@ -2233,7 +2381,7 @@ void WrappedVulkan::vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool que
     SCOPED_SERIALISE_CONTEXT(END_QUERY);
     Serialise_vkCmdEndQuery(localSerialiser, commandBuffer, queryPool, query);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(queryPool), eFrameRef_Read);
   }
 }
@@ -2277,6 +2425,7 @@ bool WrappedVulkan::Serialise_vkCmdResetQueryPool(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool,
                                         uint32_t firstQuery, uint32_t queryCount)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -2291,7 +2440,7 @@ void WrappedVulkan::vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPo
     SCOPED_SERIALISE_CONTEXT(RESET_QUERY_POOL);
     Serialise_vkCmdResetQueryPool(localSerialiser, commandBuffer, queryPool, firstQuery, queryCount);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(queryPool), eFrameRef_Read);
   }
 }
@@ -2581,6 +2730,7 @@ bool WrappedVulkan::Serialise_vkCmdExecuteCommands(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount,
                                          const VkCommandBuffer *pCmdBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkCommandBuffer *unwrapped = GetTempArray<VkCommandBuffer>(commandBufferCount);
@@ -2597,7 +2747,7 @@ void WrappedVulkan::vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t
     SCOPED_SERIALISE_CONTEXT(EXEC_CMDS);
     Serialise_vkCmdExecuteCommands(localSerialiser, commandBuffer, commandBufferCount, pCmdBuffers);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     for(uint32_t i = 0; i < commandBufferCount; i++)
     {
@@ -2623,8 +2773,12 @@ bool WrappedVulkan::Serialise_vkCmdDebugMarkerBeginEXT(Serialiser *localSerialis
                                                        VkDebugMarkerMarkerInfoEXT *pMarker)
 {
   SERIALISE_ELEMENT(ResourceId, cmdid, GetResID(commandBuffer));
-  SERIALISE_ELEMENT(string, name,
-                    pMarker && pMarker->pMarkerName ? string(pMarker->pMarkerName) : "");
+
+  string name;
+  if(m_State >= WRITING && pMarker && pMarker->pMarkerName)
+    name = pMarker->pMarkerName;
+
+  localSerialiser->SerialiseInternedString("name", name);
 
   float color[4] = {};
   if(m_State >= WRITING && pMarker)
@@ -2655,6 +2809,8 @@ bool WrappedVulkan::Serialise_vkCmdDebugMarkerBeginEXT(Serialiser *localSerialis
 void WrappedVulkan::vkCmdDebugMarkerBeginEXT(VkCommandBuffer commandBuffer,
                                              VkDebugMarkerMarkerInfoEXT *pMarker)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ObjDisp(commandBuffer)->CmdDebugMarkerBeginEXT)
     ObjDisp(commandBuffer)->CmdDebugMarkerBeginEXT(Unwrap(commandBuffer), pMarker);
 
@@ -2667,7 +2823,7 @@ void WrappedVulkan::vkCmdDebugMarkerBeginEXT(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CONTEXT(BEGIN_EVENT);
     Serialise_vkCmdDebugMarkerBeginEXT(localSerialiser, commandBuffer, pMarker);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -2704,6 +2860,8 @@ bool WrappedVulkan::Serialise_vkCmdDebugMarkerEndEXT(Serialiser *localSerialiser
 
 void WrappedVulkan::vkCmdDebugMarkerEndEXT(VkCommandBuffer commandBuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ObjDisp(commandBuffer)->CmdDebugMarkerEndEXT)
     ObjDisp(commandBuffer)->CmdDebugMarkerEndEXT(Unwrap(commandBuffer));
 
@@ -2716,7 +2874,7 @@ void WrappedVulkan::vkCmdDebugMarkerEndEXT(VkCommandBuffer commandBuffer)
     SCOPED_SERIALISE_CONTEXT(END_EVENT);
     Serialise_vkCmdDebugMarkerEndEXT(localSerialiser, commandBuffer);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -2725,8 +2883,12 @@ bool WrappedVulkan::Serialise_vkCmdDebugMarkerInsertEXT(Serialiser *localSeriali
                                                         VkDebugMarkerMarkerInfoEXT *pMarker)
 {
   SERIALISE_ELEMENT(ResourceId, cmdid, GetResID(commandBuffer));
-  SERIALISE_ELEMENT(string, name,
-                    pMarker && pMarker->pMarkerName ? string(pMarker->pMarkerName) : "");
+
+  string name;
+  if(m_State >= WRITING && pMarker && pMarker->pMarkerName)
+    name = pMarker->pMarkerName;
+
+  localSerialiser->SerialiseInternedString("name", name);
 
   float color[4] = {};
   if(m_State >= WRITING && pMarker)
@@ -2757,6 +2919,8 @@ bool WrappedVulkan::Serialise_vkCmdDebugMarkerInsertEXT(Serialiser *localSeriali
 void WrappedVulkan::vkCmdDebugMarkerInsertEXT(VkCommandBuffer commandBuffer,
                                               VkDebugMarkerMarkerInfoEXT *pMarker)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(ObjDisp(commandBuffer)->CmdDebugMarkerInsertEXT)
     ObjDisp(commandBuffer)->CmdDebugMarkerInsertEXT(Unwrap(commandBuffer), pMarker);
 
@@ -2769,6 +2933,6 @@ void WrappedVulkan::vkCmdDebugMarkerInsertEXT(VkCommandBuffer commandBuffer,
     SCOPED_SERIALISE_CONTEXT(SET_MARKER);
     Serialise_vkCmdDebugMarkerInsertEXT(localSerialiser, commandBuffer, pMarker);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
@@ -60,6 +60,8 @@ VkResult WrappedVulkan::vkCreateDescriptorPool(VkDevice device,
                                                const VkAllocationCallbacks *pAllocator,
                                                VkDescriptorPool *pDescriptorPool)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(device)->CreateDescriptorPool(Unwrap(device), pCreateInfo, pAllocator,
                                                        pDescriptorPool);
 
@@ -145,6 +147,8 @@ VkResult WrappedVulkan::vkCreateDescriptorSetLayout(VkDevice device,
                                                     const VkAllocationCallbacks *pAllocator,
                                                     VkDescriptorSetLayout *pSetLayout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   size_t tempmemSize = sizeof(VkDescriptorSetLayoutBinding) * pCreateInfo->bindingCount;
 
   // need to count how many VkSampler arrays to allocate for
@@ -264,6 +268,8 @@ VkResult WrappedVulkan::vkAllocateDescriptorSets(VkDevice device,
                                                  const VkDescriptorSetAllocateInfo *pAllocateInfo,
                                                  VkDescriptorSet *pDescriptorSets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   size_t tempmemSize = sizeof(VkDescriptorSetAllocateInfo) +
                        sizeof(VkDescriptorSetLayout) * pAllocateInfo->descriptorSetCount;
 
@@ -348,6 +354,8 @@ VkResult WrappedVulkan::vkAllocateDescriptorSets(VkDevice device,
 VkResult WrappedVulkan::vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool,
                                              uint32_t count, const VkDescriptorSet *pDescriptorSets)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkDescriptorSet *unwrapped = GetTempArray<VkDescriptorSet>(count);
   for(uint32_t i = 0; i < count; i++)
     unwrapped[i] = Unwrap(pDescriptorSets[i]);
@@ -364,6 +372,8 @@ VkResult WrappedVulkan::vkFreeDescriptorSets(VkDevice device, VkDescriptorPool d
 VkResult WrappedVulkan::vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool,
                                               VkDescriptorPoolResetFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // need to free all child descriptor pools. Application is responsible for
   // ensuring no concurrent use with alloc/free from this pool, the same as
   // for DestroyDescriptorPool.
@@ -381,6 +391,154 @@ VkResult WrappedVulkan::vkResetDescriptorPool(VkDevice device, VkDescriptorPool
   return ObjDisp(device)->ResetDescriptorPool(Unwrap(device), Unwrap(descriptorPool), flags);
 }
 
+void WrappedVulkan::ReplayDescriptorSetWrite(VkDevice device,
+                                             const VkWriteDescriptorSet &writeDesc)
+{
+  // check for validity - if a resource wasn't referenced other than in this update
+  // (ie. the descriptor set was overwritten or never bound), then the write descriptor
+  // will be invalid with some missing handles. It's safe though to just skip this
+  // update as we only get here if it's never used.
+
+  // if a set was never bound, it will have been omitted and we just drop any writes to it
+  bool valid = (writeDesc.dstSet != VK_NULL_HANDLE);
+
+  if(!valid)
+    return;
+
+  const DescSetLayout &layout =
+      m_CreationInfo.m_DescSetLayout
+          [m_DescriptorSetState[GetResourceManager()->GetNonDispWrapper(writeDesc.dstSet)->id].layout];
+
+  const DescSetLayout::Binding *layoutBinding = &layout.bindings[writeDesc.dstBinding];
+  uint32_t curIdx = writeDesc.dstArrayElement;
+
+  switch(writeDesc.descriptorType)
+  {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+    {
+      for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
+        valid &= (writeDesc.pImageInfo[i].sampler != VK_NULL_HANDLE);
+      break;
+    }
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+    {
+      for(uint32_t i = 0; i < writeDesc.descriptorCount; i++, curIdx++)
+      {
+        // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
+        // explanation
+        if(curIdx >= layoutBinding->descriptorCount)
+        {
+          layoutBinding++;
+          curIdx = 0;
+        }
+
+        valid &= (writeDesc.pImageInfo[i].sampler != VK_NULL_HANDLE) ||
+                 (layoutBinding->immutableSampler &&
+                  layoutBinding->immutableSampler[curIdx] != ResourceId());
+        valid &= (writeDesc.pImageInfo[i].imageView != VK_NULL_HANDLE);
+      }
+      break;
+    }
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+    {
+      for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
+        valid &= (writeDesc.pImageInfo[i].imageView != VK_NULL_HANDLE);
+      break;
+    }
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+    {
+      for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
+        valid &= (writeDesc.pTexelBufferView[i] != VK_NULL_HANDLE);
+      break;
+    }
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+    {
+      for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
+        valid &= (writeDesc.pBufferInfo[i].buffer != VK_NULL_HANDLE);
+      break;
+    }
+    default: RDCERR("Unexpected descriptor type %d", writeDesc.descriptorType);
+  }
+
+  if(valid)
+  {
+    ObjDisp(device)->UpdateDescriptorSets(Unwrap(device), 1, &writeDesc, 0, NULL);
+
+    // update our local tracking
+    vector<DescriptorSetSlot *> &bindings =
+        m_DescriptorSetState[GetResourceManager()->GetNonDispWrapper(writeDesc.dstSet)->id]
+            .currentBindings;
+
+    {
+      RDCASSERT(writeDesc.dstBinding < bindings.size());
+
+      DescriptorSetSlot **bind = &bindings[writeDesc.dstBinding];
+      layoutBinding = &layout.bindings[writeDesc.dstBinding];
+      curIdx = writeDesc.dstArrayElement;
+
+      if(writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
+         writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+      {
+        for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
+        {
+          // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
+          // explanation
+          if(curIdx >= layoutBinding->descriptorCount)
+          {
+            layoutBinding++;
+            bind++;
+            curIdx = 0;
+          }
+
+          (*bind)[curIdx].texelBufferView = writeDesc.pTexelBufferView[d];
+        }
+      }
+      else if(writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+              writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+              writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+              writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+              writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
+      {
+        for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
+        {
+          // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
+          // explanation
+          if(curIdx >= layoutBinding->descriptorCount)
+          {
+            layoutBinding++;
+            bind++;
+            curIdx = 0;
+          }
+
+          (*bind)[curIdx].imageInfo = writeDesc.pImageInfo[d];
+        }
+      }
+      else
+      {
+        for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
+        {
+          // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
+          // explanation
+          if(curIdx >= layoutBinding->descriptorCount)
+          {
+            layoutBinding++;
+            bind++;
+            curIdx = 0;
+          }
+
+          (*bind)[curIdx].bufferInfo = writeDesc.pBufferInfo[d];
+        }
+      }
+    }
+  }
+}
+
 bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(Serialiser *localSerialiser, VkDevice device,
                                                      uint32_t writeCount,
                                                      const VkWriteDescriptorSet *pDescriptorWrites,
@@ -415,149 +573,7 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(Serialiser *localSerialiser
 
     if(writes)
     {
-      // check for validity - if a resource wasn't referenced other than in this update
-      // (ie. the descriptor set was overwritten or never bound), then the write descriptor
-      // will be invalid with some missing handles. It's safe though to just skip this
-      // update as we only get here if it's never used.
-
-      // if a set was never bound, it will have been omitted and we just drop any writes to it
-      bool valid = (writeDesc.dstSet != VK_NULL_HANDLE);
-
-      if(!valid)
-        return true;
-
-      const DescSetLayout &layout =
-          m_CreationInfo.m_DescSetLayout
-              [m_DescriptorSetState[GetResourceManager()->GetNonDispWrapper(writeDesc.dstSet)->id].layout];
-
-      const DescSetLayout::Binding *layoutBinding = &layout.bindings[writeDesc.dstBinding];
-      uint32_t curIdx = writeDesc.dstArrayElement;
-
-      switch(writeDesc.descriptorType)
-      {
-        case VK_DESCRIPTOR_TYPE_SAMPLER:
-        {
-          for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
-            valid &= (writeDesc.pImageInfo[i].sampler != VK_NULL_HANDLE);
-          break;
-        }
-        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-        {
-          for(uint32_t i = 0; i < writeDesc.descriptorCount; i++, curIdx++)
-          {
-            // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
-            // explanation
-            if(curIdx >= layoutBinding->descriptorCount)
-            {
-              layoutBinding++;
-              curIdx = 0;
-            }
-
-            valid &= (writeDesc.pImageInfo[i].sampler != VK_NULL_HANDLE) ||
-                     (layoutBinding->immutableSampler &&
-                      layoutBinding->immutableSampler[curIdx] != ResourceId());
-            valid &= (writeDesc.pImageInfo[i].imageView != VK_NULL_HANDLE);
-          }
-          break;
-        }
-        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-        {
-          for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
-            valid &= (writeDesc.pImageInfo[i].imageView != VK_NULL_HANDLE);
-          break;
-        }
-        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-        {
-          for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
-            valid &= (writeDesc.pTexelBufferView[i] != VK_NULL_HANDLE);
-          break;
-        }
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-        {
-          for(uint32_t i = 0; i < writeDesc.descriptorCount; i++)
-            valid &= (writeDesc.pBufferInfo[i].buffer != VK_NULL_HANDLE);
-          break;
-        }
-        default: RDCERR("Unexpected descriptor type %d", writeDesc.descriptorType);
-      }
-
-      if(valid)
-      {
-        ObjDisp(device)->UpdateDescriptorSets(Unwrap(device), 1, &writeDesc, 0, NULL);
-
-        // update our local tracking
-        vector<DescriptorSetSlot *> &bindings =
-            m_DescriptorSetState[GetResourceManager()->GetNonDispWrapper(writeDesc.dstSet)->id]
-                .currentBindings;
-
-        {
-          RDCASSERT(writeDesc.dstBinding < bindings.size());
-
-          DescriptorSetSlot **bind = &bindings[writeDesc.dstBinding];
-          layoutBinding = &layout.bindings[writeDesc.dstBinding];
-          curIdx = writeDesc.dstArrayElement;
-
-          if(writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
-             writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
-          {
-            for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
-            {
-              // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
-              // explanation
-              if(curIdx >= layoutBinding->descriptorCount)
-              {
-                layoutBinding++;
-                bind++;
-                curIdx = 0;
-              }
-
-              (*bind)[curIdx].texelBufferView = writeDesc.pTexelBufferView[d];
-            }
-          }
-          else if(writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
-                  writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
-                  writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
-                  writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
-                  writeDesc.descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
-          {
-            for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
-            {
-              // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
-              // explanation
-              if(curIdx >= layoutBinding->descriptorCount)
-              {
-                layoutBinding++;
-                bind++;
-                curIdx = 0;
-              }
-
-              (*bind)[curIdx].imageInfo = writeDesc.pImageInfo[d];
-            }
-          }
-          else
-          {
-            for(uint32_t d = 0; d < writeDesc.descriptorCount; d++, curIdx++)
-            {
-              // allow consecutive descriptor bind updates. See vkUpdateDescriptorSets for more
-              // explanation
-              if(curIdx >= layoutBinding->descriptorCount)
-              {
-                layoutBinding++;
-                bind++;
-                curIdx = 0;
-              }
-
-              (*bind)[curIdx].bufferInfo = writeDesc.pBufferInfo[d];
-            }
-          }
-        }
-      }
+      ReplayDescriptorSetWrite(device, writeDesc);
     }
     else
     {
@@ -627,11 +643,218 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(Serialiser *localSerialiser
   return true;
 }
 
+void WrappedVulkan::MarkDescSetReferenced(VkResourceRecord *setrecord)
+{
+  GetResourceManager()->MarkResourceFrameReferenced(setrecord->GetResourceID(), eFrameRef_Read);
+
+  DescriptorSetData &descInfo = *setrecord->descInfo;
+
+  // if the set hasn't gained any references since it was last marked in this capture, there's
+  // nothing new to mark
+  bool markAll = true;
+  {
+    SCOPED_LOCK(m_DescSetFrameRefLock);
+    if(descInfo.markedEpoch == m_FrameRefEpoch && descInfo.markedGen == descInfo.bindFrameRefGen)
+      markAll = false;
+    descInfo.markedEpoch = m_FrameRefEpoch;
+    descInfo.markedGen = descInfo.bindFrameRefGen;
+  }
+
+  // sparse resources can be rebound between submits, so always mark the memory they use
+  if(!markAll && descInfo.sparseRefCount == 0)
+    return;
+
+  for(size_t i = 0; i < descInfo.bindFrameRefs.size(); i++)
+  {
+    const DescriptorSetData::BindFrameRef &bind = descInfo.bindFrameRefs[i];
+
+    if(markAll)
+      GetResourceManager()->MarkResourceFrameReferenced(bind.id, bind.ref);
+
+    if(bind.count & DescriptorSetData::SPARSE_REF_BIT)
+    {
+      VkResourceRecord *record = GetResourceManager()->GetResourceRecord(bind.id);
+
+      GetResourceManager()->MarkSparseMapReferenced(record->sparseInfo);
+    }
+  }
+}
+
+void WrappedVulkan::TrackDescriptorSetWrites(uint32_t writeCount,
+                                             const VkWriteDescriptorSet *pDescriptorWrites)
+{
+  for(uint32_t i = 0; i < writeCount; i++)
+  {
+    VkResourceRecord *record = GetRecord(pDescriptorWrites[i].dstSet);
+    RDCASSERT(record->descInfo && record->descInfo->layout);
+    const DescSetLayout &layout = *record->descInfo->layout;
+
+    RDCASSERT(pDescriptorWrites[i].dstBinding < record->descInfo->descBindings.size());
+
+    DescriptorSetSlot **binding = &record->descInfo->descBindings[pDescriptorWrites[i].dstBinding];
+
+    const DescSetLayout::Binding *layoutBinding = &layout.bindings[pDescriptorWrites[i].dstBinding];
+
+    FrameRefType ref = eFrameRef_Write;
+
+    switch(layoutBinding->descriptorType)
+    {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+      case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+      case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: ref = eFrameRef_Read; break;
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+      case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: ref = eFrameRef_Write; break;
+      default: RDCERR("Unexpected descriptor type");
+    }
+
+    // We need to handle the cases where these bindings are stale:
+    // ie. image handle 0xf00baa is allocated
+    // bound into a descriptor set
+    // image is released
+    // descriptor set is bound but this image is never used by shader etc.
+    //
+    // worst case, a new image or something has been added with this handle -
+    // in this case we end up ref'ing an image that isn't actually used.
+    // Worst worst case, we ref an image as write when actually it's not, but
+    // this is likewise not a serious problem, and rather difficult to solve
+    // (would need to version handles somehow, but don't have enough bits
+    // to do that reliably).
+    //
+    // This is handled by RemoveBindFrameRef silently dropping id == ResourceId()
+
+    // start at the dstArrayElement
+    uint32_t curIdx = pDescriptorWrites[i].dstArrayElement;
+
+    for(uint32_t d = 0; d < pDescriptorWrites[i].descriptorCount; d++, curIdx++)
+    {
+      // roll over onto the next binding, on the assumption that it is the same
+      // type and there is indeed a next binding at all. See spec language:
+      //
+      // If the dstBinding has fewer than descriptorCount array elements remaining starting from
+      // dstArrayElement, then the remainder will be used to update the subsequent binding -
+      // dstBinding+1 starting at array element zero. This behavior applies recursively, with the
+      // update affecting consecutive bindings as needed to update all descriptorCount
+      // descriptors. All consecutive bindings updated via a single VkWriteDescriptorSet structure
+      // must have identical descriptorType and stageFlags, and must all either use immutable
+      // samplers or must all not use immutable samplers.
+
+      if(curIdx >= layoutBinding->descriptorCount)
+      {
+        layoutBinding++;
+        binding++;
+        curIdx = 0;
+      }
+
+      DescriptorSetSlot &bind = (*binding)[curIdx];
+
+      if(bind.texelBufferView != VK_NULL_HANDLE)
+      {
+        record->RemoveBindFrameRef(GetResID(bind.texelBufferView));
+
+        VkResourceRecord *viewRecord = GetRecord(bind.texelBufferView);
+        if(viewRecord && viewRecord->baseResource != ResourceId())
+          record->RemoveBindFrameRef(viewRecord->baseResource);
+      }
+      if(bind.imageInfo.imageView != VK_NULL_HANDLE)
+      {
+        record->RemoveBindFrameRef(GetResID(bind.imageInfo.imageView));
+
+        VkResourceRecord *viewRecord = GetRecord(bind.imageInfo.imageView);
+        if(viewRecord)
+        {
+          record->RemoveBindFrameRef(viewRecord->baseResource);
+          if(viewRecord->baseResourceMem != ResourceId())
+            record->RemoveBindFrameRef(viewRecord->baseResourceMem);
+        }
+      }
+      if(bind.imageInfo.sampler != VK_NULL_HANDLE)
+      {
+        record->RemoveBindFrameRef(GetResID(bind.imageInfo.sampler));
+      }
+      if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
+      {
+        record->RemoveBindFrameRef(GetResID(bind.bufferInfo.buffer));
+
+        VkResourceRecord *bufRecord = GetRecord(bind.bufferInfo.buffer);
+        if(bufRecord && bufRecord->baseResource != ResourceId())
+          record->RemoveBindFrameRef(bufRecord->baseResource);
+      }
+
+      // NULL everything out now so that we don't accidentally reference an object
+      // that was removed already
+      bind.texelBufferView = VK_NULL_HANDLE;
+      bind.bufferInfo.buffer = VK_NULL_HANDLE;
+      bind.imageInfo.imageView = VK_NULL_HANDLE;
+      bind.imageInfo.sampler = VK_NULL_HANDLE;
+
+      if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
+         pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+      {
+        bind.texelBufferView = pDescriptorWrites[i].pTexelBufferView[d];
+      }
+      else if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+              pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+              pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+              pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+              pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
+      {
+        bind.imageInfo = pDescriptorWrites[i].pImageInfo[d];
+
+        // ignore descriptors not part of the write, by NULL'ing out those members
+        // as they might not even point to a valid object
+        if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER)
+          bind.imageInfo.imageView = VK_NULL_HANDLE;
+        else if(pDescriptorWrites[i].descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+          bind.imageInfo.sampler = VK_NULL_HANDLE;
+      }
+      else
+      {
+        bind.bufferInfo = pDescriptorWrites[i].pBufferInfo[d];
+      }
+
+      if(bind.texelBufferView != VK_NULL_HANDLE)
+      {
+        record->AddBindFrameRef(GetResID(bind.texelBufferView), eFrameRef_Read,
+                                GetRecord(bind.texelBufferView)->sparseInfo != NULL);
+        if(GetRecord(bind.texelBufferView)->baseResource != ResourceId())
+          record->AddBindFrameRef(GetRecord(bind.texelBufferView)->baseResource, ref);
+      }
+      if(bind.imageInfo.imageView != VK_NULL_HANDLE)
+      {
+        record->AddBindFrameRef(GetResID(bind.imageInfo.imageView), eFrameRef_Read,
+                                GetRecord(bind.imageInfo.imageView)->sparseInfo != NULL);
+        record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResource, ref);
+        if(GetRecord(bind.imageInfo.imageView)->baseResourceMem != ResourceId())
+          record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResourceMem,
+                                  eFrameRef_Read);
+      }
+      if(bind.imageInfo.sampler != VK_NULL_HANDLE)
+      {
+        record->AddBindFrameRef(GetResID(bind.imageInfo.sampler), eFrameRef_Read);
+      }
+      if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
+      {
+        record->AddBindFrameRef(GetResID(bind.bufferInfo.buffer), eFrameRef_Read,
+                                GetRecord(bind.bufferInfo.buffer)->sparseInfo != NULL);
+        if(GetRecord(bind.bufferInfo.buffer)->baseResource != ResourceId())
+          record->AddBindFrameRef(GetRecord(bind.bufferInfo.buffer)->baseResource, ref);
+      }
+    }
+  }
+}
+
 void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
                                            const VkWriteDescriptorSet *pDescriptorWrites,
                                            uint32_t copyCount,
                                            const VkCopyDescriptorSet *pDescriptorCopies)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   {
@@ -768,197 +991,16 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       // GetResourceManager()->MarkResourceFrameReferenced(GetResID(pDescriptorCopies[i].destSet),
       // eFrameRef_Write);
 
-      {
-        GetResourceManager()->MarkResourceFrameReferenced(GetResID(pDescriptorCopies[i].srcSet),
-                                                          eFrameRef_Read);
-
-        VkResourceRecord *setrecord = GetRecord(pDescriptorCopies[i].srcSet);
-
-        for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
-            refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
-        {
-          GetResourceManager()->MarkResourceFrameReferenced(refit->first, refit->second.second);
-
-          if(refit->second.first & DescriptorSetData::SPARSE_REF_BIT)
-          {
-            VkResourceRecord *record = GetResourceManager()->GetResourceRecord(refit->first);
-
-            GetResourceManager()->MarkSparseMapReferenced(record->sparseInfo);
-          }
-        }
-      }
+      MarkDescSetReferenced(GetRecord(pDescriptorCopies[i].srcSet));
     }
   }
 
   // need to track descriptor set contents whether capframing or idle
   if(m_State >= WRITING)
   {
-    for(uint32_t i = 0; i < writeCount; i++)
-    {
-      VkResourceRecord *record = GetRecord(pDescriptorWrites[i].dstSet);
-      RDCASSERT(record->descInfo && record->descInfo->layout);
-      const DescSetLayout &layout = *record->descInfo->layout;
-
-      RDCASSERT(pDescriptorWrites[i].dstBinding < record->descInfo->descBindings.size());
-
-      DescriptorSetSlot **binding = &record->descInfo->descBindings[pDescriptorWrites[i].dstBinding];
-
-      const DescSetLayout::Binding *layoutBinding = &layout.bindings[pDescriptorWrites[i].dstBinding];
+    TrackDescriptorSetWrites(writeCount, pDescriptorWrites);
 
-      FrameRefType ref = eFrameRef_Write;
-
-      switch(layoutBinding->descriptorType)
-      {
-        case VK_DESCRIPTOR_TYPE_SAMPLER:
-        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: ref = eFrameRef_Read; break;
-        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: ref = eFrameRef_Write; break;
-        default: RDCERR("Unexpected descriptor type");
-      }
-
-      // We need to handle the cases where these bindings are stale:
-      // ie. image handle 0xf00baa is allocated
-      // bound into a descriptor set
-      // image is released
-      // descriptor set is bound but this image is never used by shader etc.
-      //
-      // worst case, a new image or something has been added with this handle -
-      // in this case we end up ref'ing an image that isn't actually used.
-      // Worst worst case, we ref an image as write when actually it's not, but
-      // this is likewise not a serious problem, and rather difficult to solve
-      // (would need to version handles somehow, but don't have enough bits
-      // to do that reliably).
-      //
-      // This is handled by RemoveBindFrameRef silently dropping id == ResourceId()
-
-      // start at the dstArrayElement
-      uint32_t curIdx = pDescriptorWrites[i].dstArrayElement;
-
-      for(uint32_t d = 0; d < pDescriptorWrites[i].descriptorCount; d++, curIdx++)
-      {
-        // roll over onto the next binding, on the assumption that it is the same
-        // type and there is indeed a next binding at all. See spec language:
-        //
-        // If the dstBinding has fewer than descriptorCount array elements remaining starting from
-        // dstArrayElement, then the remainder will be used to update the subsequent binding -
-        // dstBinding+1 starting at array element zero. This behavior applies recursively, with the
-        // update affecting consecutive bindings as needed to update all descriptorCount
-        // descriptors. All consecutive bindings updated via a single VkWriteDescriptorSet structure
-        // must have identical descriptorType and stageFlags, and must all either use immutable
-        // samplers or must all not use immutable samplers.
-
-        if(curIdx >= layoutBinding->descriptorCount)
-        {
-          layoutBinding++;
-          binding++;
-          curIdx = 0;
-        }
-
-        DescriptorSetSlot &bind = (*binding)[curIdx];
-
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.texelBufferView));
-
-          VkResourceRecord *viewRecord = GetRecord(bind.texelBufferView);
-          if(viewRecord && viewRecord->baseResource != ResourceId())
-            record->RemoveBindFrameRef(viewRecord->baseResource);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.imageInfo.imageView));
-
-          VkResourceRecord *viewRecord = GetRecord(bind.imageInfo.imageView);
-          if(viewRecord)
-          {
-            record->RemoveBindFrameRef(viewRecord->baseResource);
-            if(viewRecord->baseResourceMem != ResourceId())
-              record->RemoveBindFrameRef(viewRecord->baseResourceMem);
-          }
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.imageInfo.sampler));
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.bufferInfo.buffer));
-
-          VkResourceRecord *bufRecord = GetRecord(bind.bufferInfo.buffer);
-          if(bufRecord && bufRecord->baseResource != ResourceId())
-            record->RemoveBindFrameRef(bufRecord->baseResource);
-        }
-
-        // NULL everything out now so that we don't accidentally reference an object
-        // that was removed already
-        bind.texelBufferView = VK_NULL_HANDLE;
-        bind.bufferInfo.buffer = VK_NULL_HANDLE;
-        bind.imageInfo.imageView = VK_NULL_HANDLE;
-        bind.imageInfo.sampler = VK_NULL_HANDLE;
-
-        if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
-           pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
-        {
-          bind.texelBufferView = pDescriptorWrites[i].pTexelBufferView[d];
-        }
-        else if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
-                pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
-                pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
-                pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
-                pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
-        {
-          bind.imageInfo = pDescriptorWrites[i].pImageInfo[d];
-
-          // ignore descriptors not part of the write, by NULL'ing out those members
-          // as they might not even point to a valid object
-          if(pDescriptorWrites[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER)
-            bind.imageInfo.imageView = VK_NULL_HANDLE;
-          else if(pDescriptorWrites[i].descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-            bind.imageInfo.sampler = VK_NULL_HANDLE;
-        }
-        else
-        {
-          bind.bufferInfo = pDescriptorWrites[i].pBufferInfo[d];
-        }
-
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.texelBufferView), eFrameRef_Read,
-                                  GetRecord(bind.texelBufferView)->sparseInfo != NULL);
-          if(GetRecord(bind.texelBufferView)->baseResource != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.texelBufferView)->baseResource, ref);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.imageInfo.imageView), eFrameRef_Read,
-                                  GetRecord(bind.imageInfo.imageView)->sparseInfo != NULL);
-          record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResource, ref);
-          if(GetRecord(bind.imageInfo.imageView)->baseResourceMem != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResourceMem,
-                                    eFrameRef_Read);
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.imageInfo.sampler), eFrameRef_Read);
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.bufferInfo.buffer), eFrameRef_Read,
-                                  GetRecord(bind.bufferInfo.buffer)->sparseInfo != NULL);
-          if(GetRecord(bind.bufferInfo.buffer)->baseResource != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.bufferInfo.buffer)->baseResource, ref);
-        }
-      }
-    }
-
-    // this is almost identical to the above loop, except that instead of sourcing the descriptors
+    // this is almost identical to TrackDescriptorSetWrites, except that instead of sourcing the descriptors
     // from the writedescriptor struct, we source it from our stored bindings on the source
     // descrpitor set
 
@@ -1084,3 +1126,298 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
     }
   }
 }
+
+// descriptor update templates refer to application memory full of handles. These helpers apply a
+// conversion to each handle a descriptor of the given type actually uses, leaving alone any
+// fields the type ignores, since those may contain garbage.
+RDCCOMPILE_ASSERT(sizeof(VkSampler) == sizeof(ResourceId),
+                  "Handles are expected to be the same size as IDs, to convert in place");
+
+struct UnwrapHandle
+{
+  template <typename T>
+  void operator()(T &handle) const
+  {
+    handle = Unwrap(handle);
+  }
+};
+
+struct HandleToID
+{
+  template <typename T>
+  void operator()(T &handle) const
+  {
+    RDCCOMPILE_ASSERT(sizeof(T) == sizeof(ResourceId), "ID must fit exactly in the handle");
+
+    ResourceId id = GetResID(handle);
+    memcpy((void *)&handle, (const void *)&id, sizeof(handle));
+  }
+};
+
+struct IDToLiveHandle
+{
+  VulkanResourceManager *rm;
+
+  template <typename T>
+  void operator()(T &handle) const
+  {
+    RDCCOMPILE_ASSERT(sizeof(T) == sizeof(ResourceId), "ID must fit exactly in the handle");
+
+    ResourceId id;
+    memcpy((void *)&id, (const void *)&handle, sizeof(id));
+
+    // as with SerialiseObject, resources that weren't needed by the capture won't be live and we
+    // leave them NULL so the write is skipped.
+    handle = VK_NULL_HANDLE;
+    if(id != ResourceId() && rm->HasLiveResource(id))
+      handle = Unwrap(rm->GetLiveHandle<T>(id));
+  }
+};
+
+template <typename Convert>
+static void ConvertDescriptor(VkDescriptorType type, byte *desc, const Convert &convert)
+{
+  VkDescriptorImageInfo *imInfo = (VkDescriptorImageInfo *)desc;
+
+  switch(type)
+  {
+    case VK_DESCRIPTOR_TYPE_SAMPLER: convert(imInfo->sampler); break;
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+      convert(imInfo->sampler);
+      convert(imInfo->imageView);
+      break;
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: convert(imInfo->imageView); break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: convert(*(VkBufferView *)desc); break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+      convert(((VkDescriptorBufferInfo *)desc)->buffer);
+      break;
+    default: RDCERR("Unexpected descriptor type %d", type);
+  }
+}
+
+// convert the handles in data, laid out either as the application provides it, or packed.
+template <typename Convert>
+static void ConvertTemplateData(const DescUpdateTemplate &templ, byte *data, bool packed,
+                                const Convert &convert)
+{
+  for(size_t i = 0; i < templ.entries.size(); i++)
+  {
+    const VkDescriptorUpdateTemplateEntryKHR &entry = templ.entries[i];
+
+    size_t offset = packed ? templ.packedOffsets[i] : entry.offset;
+    size_t stride = packed ? DescUpdateTemplate::DescriptorSize(entry.descriptorType) : entry.stride;
+
+    for(uint32_t d = 0; d < entry.descriptorCount; d++)
+      ConvertDescriptor(entry.descriptorType, data + offset + stride * d, convert);
+  }
+}
+
+bool WrappedVulkan::Serialise_vkCreateDescriptorUpdateTemplateKHR(
+    Serialiser *localSerialiser, VkDevice device,
+    const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo,
+    const VkAllocationCallbacks *pAllocator, VkDescriptorUpdateTemplateKHR *pDescriptorUpdateTemplate)
+{
+  SERIALISE_ELEMENT(ResourceId, devId, GetResID(device));
+  SERIALISE_ELEMENT(VkDescriptorUpdateTemplateCreateInfoKHR, info, *pCreateInfo);
+  SERIALISE_ELEMENT(ResourceId, id, GetResID(*pDescriptorUpdateTemplate));
+
+  if(m_State == READING)
+  {
+    // we don't create a template on replay, so the replay device doesn't need the extension.
+    // Updates are replayed as the equivalent vkUpdateDescriptorSets writes, so we only need to
+    // know the template's entries, looked up by the original ID.
+    m_CreationInfo.m_DescUpdateTemplate[id].Init(&info);
+  }
+
+  return true;
+}
+
+VkResult WrappedVulkan::vkCreateDescriptorUpdateTemplateKHR(
+    VkDevice device, const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo,
+    const VkAllocationCallbacks *pAllocator, VkDescriptorUpdateTemplateKHR *pDescriptorUpdateTemplate)
+{
+  SCOPED_ENTRY_PROFILE();
+
+  if(pCreateInfo->templateType != VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR)
+  {
+    // push descriptors aren't supported, so the application can't have created a push
+    // descriptor template through us
+    RDCERR("Unsupported descriptor update template type %d", pCreateInfo->templateType);
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+
+  VkDescriptorUpdateTemplateCreateInfoKHR unwrappedInfo = *pCreateInfo;
+  unwrappedInfo.descriptorSetLayout = Unwrap(unwrappedInfo.descriptorSetLayout);
+  unwrappedInfo.pipelineLayout = Unwrap(unwrappedInfo.pipelineLayout);
+  VkResult ret = ObjDisp(device)->CreateDescriptorUpdateTemplateKHR(
+      Unwrap(device), &unwrappedInfo, pAllocator, pDescriptorUpdateTemplate);
+
+  if(ret == VK_SUCCESS)
+  {
+    ResourceId id = GetResourceManager()->WrapResource(Unwrap(device), *pDescriptorUpdateTemplate);
+
+    if(m_State >= WRITING)
+    {
+      Chunk *chunk = NULL;
+
+      {
+        CACHE_THREAD_SERIALISER();
+
+        SCOPED_SERIALISE_CONTEXT(CREATE_DESCRIPTOR_UPDATE_TEMPLATE);
+        Serialise_vkCreateDescriptorUpdateTemplateKHR(localSerialiser, device, pCreateInfo, NULL,
+                                                      pDescriptorUpdateTemplate);
+
+        chunk = scope.Get();
+      }
+
+      VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pDescriptorUpdateTemplate);
+      record->AddChunk(chunk);
+
+      record->AddParent(GetRecord(pCreateInfo->descriptorSetLayout));
+
+      record->descTemplateInfo = new DescUpdateTemplate();
+      record->descTemplateInfo->Init(pCreateInfo);
+    }
+    else
+    {
+      GetResourceManager()->AddLiveResource(id, *pDescriptorUpdateTemplate);
+
+      m_CreationInfo.m_DescUpdateTemplate[id].Init(&unwrappedInfo);
+    }
+  }
+
+  return ret;
+}
+
+bool WrappedVulkan::Serialise_vkUpdateDescriptorSetWithTemplateKHR(
+    Serialiser *localSerialiser, VkDevice device, VkDescriptorSet descriptorSet,
+    VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const void *pData)
+{
+  SERIALISE_ELEMENT(ResourceId, devId, GetResID(device));
+  SERIALISE_ELEMENT(ResourceId, setId, GetResID(descriptorSet));
+  SERIALISE_ELEMENT(ResourceId, templId, GetResID(descriptorUpdateTemplate));
+
+  // the descriptors are stored as one blob, packed in entry order and with each handle replaced by
+  // its ID. This is far cheaper than a chunk per write, and the template gives us the layout back.
+  byte *data = NULL;
+  uint32_t dataSize = 0;
+
+  if(m_State >= WRITING)
+  {
+    const DescUpdateTemplate &templ = *GetRecord(descriptorUpdateTemplate)->descTemplateInfo;
+
+    dataSize = (uint32_t)templ.packedSize;
+    data = GetTempMemory(templ.packedSize);
+
+    templ.Pack(pData, data);
+    ConvertTemplateData(templ, data, true, HandleToID());
+  }
+
+  localSerialiser->SerialisePODArray("Data", data, dataSize);
+
+  Serialise_DebugMessages(localSerialiser, false);
+
+  if(m_State < WRITING)
+  {
+    device = GetResourceManager()->GetLiveHandle<VkDevice>(devId);
+
+    auto it = m_CreationInfo.m_DescUpdateTemplate.find(templId);
+
+    if(it == m_CreationInfo.m_DescUpdateTemplate.end())
+    {
+      RDCERR("Missing descriptor update template for update");
+    }
+    else if(it->second.packedSize != dataSize)
+    {
+      RDCERR("Descriptor update data is %u bytes, expected %llu", dataSize,
+             (uint64_t)it->second.packedSize);
+    }
+    // as with vkUpdateDescriptorSets, if a set was never bound it will have been omitted and we
+    // just drop any updates to it
+    else if(GetResourceManager()->HasLiveResource(setId))
+    {
+      const DescUpdateTemplate &templ = it->second;
+
+      IDToLiveHandle convert;
+      convert.rm = GetResourceManager();
+      ConvertTemplateData(templ, data, true, convert);
+
+      VkDescriptorSet set = Unwrap(GetResourceManager()->GetLiveHandle<VkDescriptorSet>(setId));
+
+      vector<VkWriteDescriptorSet> writes;
+      templ.MakeWrites(set, data, writes);
+
+      for(size_t i = 0; i < writes.size(); i++)
+        ReplayDescriptorSetWrite(device, writes[i]);
+    }
+
+    SAFE_DELETE_ARRAY(data);
+  }
+
+  return true;
+}
+
+void WrappedVulkan::vkUpdateDescriptorSetWithTemplateKHR(
+    VkDevice device, VkDescriptorSet descriptorSet,
+    VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const void *pData)
+{
+  SCOPED_ENTRY_PROFILE();
+  SCOPED_DBG_SINK();
+
+  const DescUpdateTemplate &templ = *GetRecord(descriptorUpdateTemplate)->descTemplateInfo;
+
+  {
+    // unwrap a copy of the application's data in place, keeping its layout
+    byte *unwrapped = GetTempMemory(templ.dataSize);
+    memcpy(unwrapped, pData, templ.dataSize);
+
+    ConvertTemplateData(templ, unwrapped, false, UnwrapHandle());
+
+    ObjDisp(device)->UpdateDescriptorSetWithTemplateKHR(
+        Unwrap(device), Unwrap(descriptorSet), Unwrap(descriptorUpdateTemplate), unwrapped);
+  }
+
+  bool capframe = false;
+  {
+    SCOPED_LOCK(m_CapTransitionLock);
+    capframe = (m_State == WRITING_CAPFRAME);
+  }
+
+  if(capframe)
+  {
+    // the whole update is a single chunk. As with vkUpdateDescriptorSets we don't need to mark the
+    // descriptors or set referenced, but the template is needed to replay it.
+    {
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(UPDATE_DESC_SET_WITH_TEMPLATE);
+      Serialise_vkUpdateDescriptorSetWithTemplateKHR(localSerialiser, device, descriptorSet,
+                                                     descriptorUpdateTemplate, pData);
+
+      m_FrameCaptureRecord->AddChunk(scope.Get());
+    }
+
+    GetResourceManager()->MarkResourceFrameReferenced(GetResID(descriptorUpdateTemplate),
+                                                      eFrameRef_Read);
+  }
+
+  // need to track descriptor set contents whether capframing or idle
+  if(m_State >= WRITING)
+  {
+    vector<VkWriteDescriptorSet> writes;
+    writes.reserve(templ.entries.size());
+
+    byte *packed = GetTempMemory(templ.packedSize);
+    templ.Pack(pData, packed);
+    templ.MakeWrites(descriptorSet, packed, writes);
+
+    if(!writes.empty())
+      TrackDescriptorSetWrites((uint32_t)writes.size(), &writes[0]);
+  }
+}
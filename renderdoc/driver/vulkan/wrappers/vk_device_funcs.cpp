@@ -278,6 +278,8 @@ VkResult WrappedVulkan::vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo
                                          const VkAllocationCallbacks *pAllocator,
                                          VkInstance *pInstance)
 {
+  SCOPED_ENTRY_PROFILE();
+
   RDCASSERT(pCreateInfo);
 
   // don't support any extensions for this createinfo
@@ -417,6 +419,10 @@ void WrappedVulkan::Shutdown()
   SubmitCmds();
   FlushQ();
 
+  FreePartialCmdCache();
+
+  SaveReplayPipelineCache();
+
   // since we didn't create proper registered resources for our command buffers,
   // they won't be taken down properly with the pool. So we release them (just our
   // data) here.
@@ -438,6 +444,8 @@ void WrappedVulkan::Shutdown()
   }
   m_CleanupMems.clear();
 
+  FreeAllMemory(eMemScope_InitialContents);
+
   // destroy the physical devices manually because due to remapping the may have leftover
   // refcounts
   for(size_t i = 0; i < m_ReplayPhysicalDevices.size(); i++)
@@ -482,6 +490,8 @@ void WrappedVulkan::Shutdown()
 
 void WrappedVulkan::vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   RDCASSERT(m_Instance == instance);
 
   if(ObjDisp(m_Instance)->DestroyDebugReportCallbackEXT && m_DbgMsgCallback != VK_NULL_HANDLE)
@@ -671,6 +681,8 @@ VkResult WrappedVulkan::vkEnumeratePhysicalDevices(VkInstance instance,
                                                    uint32_t *pPhysicalDeviceCount,
                                                    VkPhysicalDevice *pPhysicalDevices)
 {
+  SCOPED_ENTRY_PROFILE();
+
   uint32_t count;
 
   VkResult vkr = ObjDisp(instance)->EnumeratePhysicalDevices(Unwrap(instance), &count, NULL);
@@ -1131,6 +1143,8 @@ bool WrappedVulkan::Serialise_vkCreateDevice(Serialiser *localSerialiser,
       }
     }
 
+    CreateReplayPipelineCache();
+
     m_DebugManager = new VulkanDebugManager(this, device);
 
     SAFE_DELETE_ARRAY(modQueues);
@@ -1145,6 +1159,8 @@ VkResult WrappedVulkan::vkCreateDevice(VkPhysicalDevice physicalDevice,
                                        const VkDeviceCreateInfo *pCreateInfo,
                                        const VkAllocationCallbacks *pAllocator, VkDevice *pDevice)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkDeviceCreateInfo createInfo = *pCreateInfo;
 
   uint32_t qCount = 0;
@@ -1435,6 +1451,8 @@ VkResult WrappedVulkan::vkCreateDevice(VkPhysicalDevice physicalDevice,
 
 void WrappedVulkan::vkDestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // flush out any pending commands/semaphores
   SubmitCmds();
   SubmitSemaphores();
@@ -1449,6 +1467,8 @@ void WrappedVulkan::vkDestroyDevice(VkDevice device, const VkAllocationCallbacks
   // delete all debug manager objects
   SAFE_DELETE(m_DebugManager);
 
+  ReleaseSparseSnapshots();
+
   // since we didn't create proper registered resources for our command buffers,
   // they won't be taken down properly with the pool. So we release them (just our
   // data) here.
@@ -1500,6 +1520,8 @@ bool WrappedVulkan::Serialise_vkDeviceWaitIdle(Serialiser *localSerialiser, VkDe
 
 VkResult WrappedVulkan::vkDeviceWaitIdle(VkDevice device)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(device)->DeviceWaitIdle(Unwrap(device));
 
   if(m_State >= WRITING_CAPFRAME)
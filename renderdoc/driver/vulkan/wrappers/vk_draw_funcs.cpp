@@ -136,11 +136,16 @@ bool WrappedVulkan::Serialise_vkCmdDraw(Serialiser *localSerialiser, VkCommandBu
 void WrappedVulkan::vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount,
                               uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)
       ->CmdDraw(Unwrap(commandBuffer), vertexCount, instanceCount, firstVertex, firstInstance);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -151,7 +156,7 @@ void WrappedVulkan::vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCoun
     Serialise_vkCmdDraw(localSerialiser, commandBuffer, vertexCount, instanceCount, firstVertex,
                         firstInstance);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -233,12 +238,17 @@ void WrappedVulkan::vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t ind
                                      uint32_t instanceCount, uint32_t firstIndex,
                                      int32_t vertexOffset, uint32_t firstInstance)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)
       ->CmdDrawIndexed(Unwrap(commandBuffer), indexCount, instanceCount, firstIndex, vertexOffset,
                        firstInstance);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -249,7 +259,7 @@ void WrappedVulkan::vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t ind
     Serialise_vkCmdDrawIndexed(localSerialiser, commandBuffer, indexCount, instanceCount,
                                firstIndex, vertexOffset, firstInstance);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -505,10 +515,15 @@ bool WrappedVulkan::Serialise_vkCmdDrawIndirect(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer,
                                       VkDeviceSize offset, uint32_t count, uint32_t stride)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)->CmdDrawIndirect(Unwrap(commandBuffer), Unwrap(buffer), offset, count, stride);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -518,7 +533,7 @@ void WrappedVulkan::vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer bu
     SCOPED_SERIALISE_CONTEXT(DRAW_INDIRECT);
     Serialise_vkCmdDrawIndirect(localSerialiser, commandBuffer, buffer, offset, count, stride);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
@@ -799,11 +814,16 @@ bool WrappedVulkan::Serialise_vkCmdDrawIndexedIndirect(Serialiser *localSerialis
 void WrappedVulkan::vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer,
                                              VkDeviceSize offset, uint32_t count, uint32_t stride)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)
       ->CmdDrawIndexedIndirect(Unwrap(commandBuffer), Unwrap(buffer), offset, count, stride);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -813,7 +833,7 @@ void WrappedVulkan::vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBu
     SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED_INDIRECT);
     Serialise_vkCmdDrawIndexedIndirect(localSerialiser, commandBuffer, buffer, offset, count, stride);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
@@ -883,10 +903,15 @@ bool WrappedVulkan::Serialise_vkCmdDispatch(Serialiser *localSerialiser,
 
 void WrappedVulkan::vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uint32_t y, uint32_t z)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)->CmdDispatch(Unwrap(commandBuffer), x, y, z);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -896,7 +921,7 @@ void WrappedVulkan::vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uin
     SCOPED_SERIALISE_CONTEXT(DISPATCH);
     Serialise_vkCmdDispatch(localSerialiser, commandBuffer, x, y, z);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -981,10 +1006,15 @@ bool WrappedVulkan::Serialise_vkCmdDispatchIndirect(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer,
                                           VkDeviceSize offset)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
+  BeginEventTiming(commandBuffer);
+
   ObjDisp(commandBuffer)->CmdDispatchIndirect(Unwrap(commandBuffer), Unwrap(buffer), offset);
 
+  EndEventTiming(commandBuffer);
+
   if(m_State >= WRITING)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -994,7 +1024,7 @@ void WrappedVulkan::vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffe
     SCOPED_SERIALISE_CONTEXT(DISPATCH_INDIRECT);
     Serialise_vkCmdDispatchIndirect(localSerialiser, commandBuffer, buffer, offset);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
@@ -1102,6 +1132,7 @@ void WrappedVulkan::vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcIma
                                    VkImageLayout destImageLayout, uint32_t regionCount,
                                    const VkImageBlit *pRegions, VkFilter filter)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1118,7 +1149,7 @@ void WrappedVulkan::vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcIma
     Serialise_vkCmdBlitImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
                              destImageLayout, regionCount, pRegions, filter);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
@@ -1229,6 +1260,7 @@ void WrappedVulkan::vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage src
                                       VkImageLayout destImageLayout, uint32_t regionCount,
                                       const VkImageResolve *pRegions)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1245,7 +1277,7 @@ void WrappedVulkan::vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage src
     Serialise_vkCmdResolveImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
                                 destImageLayout, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
@@ -1356,6 +1388,7 @@ void WrappedVulkan::vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcIma
                                    VkImageLayout destImageLayout, uint32_t regionCount,
                                    const VkImageCopy *pRegions)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1372,7 +1405,7 @@ void WrappedVulkan::vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcIma
     Serialise_vkCmdCopyImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
                              destImageLayout, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetResID(destImage), eFrameRef_Write);
@@ -1474,6 +1507,7 @@ void WrappedVulkan::vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuff
                                            VkImage destImage, VkImageLayout destImageLayout,
                                            uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1490,7 +1524,7 @@ void WrappedVulkan::vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuff
     Serialise_vkCmdCopyBufferToImage(localSerialiser, commandBuffer, srcBuffer, destImage,
                                      destImageLayout, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     record->MarkResourceFrameReferenced(GetResID(srcBuffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcBuffer)->baseResource, eFrameRef_Read);
@@ -1592,6 +1626,7 @@ void WrappedVulkan::vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImag
                                            VkImageLayout srcImageLayout, VkBuffer destBuffer,
                                            uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1608,7 +1643,7 @@ void WrappedVulkan::vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImag
     Serialise_vkCmdCopyImageToBuffer(localSerialiser, commandBuffer, srcImage, srcImageLayout,
                                      destBuffer, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
 
@@ -1718,6 +1753,7 @@ void WrappedVulkan::vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcB
                                     VkBuffer destBuffer, uint32_t regionCount,
                                     const VkBufferCopy *pRegions)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1734,7 +1770,7 @@ void WrappedVulkan::vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcB
     Serialise_vkCmdCopyBuffer(localSerialiser, commandBuffer, srcBuffer, destBuffer, regionCount,
                               pRegions);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(srcBuffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcBuffer)->baseResource, eFrameRef_Read);
 
@@ -1834,6 +1870,7 @@ void WrappedVulkan::vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage
                                          VkImageLayout imageLayout, const VkClearColorValue *pColor,
                                          uint32_t rangeCount, const VkImageSubresourceRange *pRanges)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1850,7 +1887,12 @@ void WrappedVulkan::vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage
     Serialise_vkCmdClearColorImage(localSerialiser, commandBuffer, image, imageLayout, pColor,
                                    rangeCount, pRanges);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
+
+    // the cleared ranges are completely overwritten
+    for(uint32_t i = 0; i < rangeCount; i++)
+      RecordImageDiscard(record, GetResID(image), pRanges[i]);
+
     record->MarkResourceFrameReferenced(GetResID(image), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(image)->baseResource, eFrameRef_Read);
     if(GetRecord(image)->sparseInfo)
@@ -1940,6 +1982,7 @@ void WrappedVulkan::vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, V
                                                 uint32_t rangeCount,
                                                 const VkImageSubresourceRange *pRanges)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -1956,7 +1999,12 @@ void WrappedVulkan::vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, V
     Serialise_vkCmdClearDepthStencilImage(localSerialiser, commandBuffer, image, imageLayout,
                                           pDepthStencil, rangeCount, pRanges);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
+
+    // the cleared ranges are completely overwritten
+    for(uint32_t i = 0; i < rangeCount; i++)
+      RecordImageDiscard(record, GetResID(image), pRanges[i]);
+
     record->MarkResourceFrameReferenced(GetResID(image), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(image)->baseResource, eFrameRef_Read);
     if(GetRecord(image)->sparseInfo)
@@ -2069,6 +2117,7 @@ void WrappedVulkan::vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_
                                           const VkClearAttachment *pAttachments, uint32_t rectCount,
                                           const VkClearRect *pRects)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(commandBuffer)
@@ -2084,7 +2133,7 @@ void WrappedVulkan::vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_
     Serialise_vkCmdClearAttachments(localSerialiser, commandBuffer, attachmentCount, pAttachments,
                                     rectCount, pRects);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
 
     // image/attachments are referenced when the render pass is started and the framebuffer is
     // bound.
@@ -67,6 +67,7 @@ bool WrappedVulkan::Serialise_vkCmdSetViewport(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdSetViewport(VkCommandBuffer cmdBuffer, uint32_t firstViewport,
                                      uint32_t viewportCount, const VkViewport *pViewports)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetViewport(Unwrap(cmdBuffer), firstViewport, viewportCount, pViewports);
@@ -80,7 +81,7 @@ void WrappedVulkan::vkCmdSetViewport(VkCommandBuffer cmdBuffer, uint32_t firstVi
     SCOPED_SERIALISE_CONTEXT(SET_VP);
     Serialise_vkCmdSetViewport(localSerialiser, cmdBuffer, firstViewport, viewportCount, pViewports);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -127,6 +128,7 @@ bool WrappedVulkan::Serialise_vkCmdSetScissor(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdSetScissor(VkCommandBuffer cmdBuffer, uint32_t firstScissor,
                                     uint32_t scissorCount, const VkRect2D *pScissors)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetScissor(Unwrap(cmdBuffer), firstScissor, scissorCount, pScissors);
@@ -140,7 +142,7 @@ void WrappedVulkan::vkCmdSetScissor(VkCommandBuffer cmdBuffer, uint32_t firstSci
     SCOPED_SERIALISE_CONTEXT(SET_SCISSOR);
     Serialise_vkCmdSetScissor(localSerialiser, cmdBuffer, firstScissor, scissorCount, pScissors);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -176,6 +178,7 @@ bool WrappedVulkan::Serialise_vkCmdSetLineWidth(Serialiser *localSerialiser,
 
 void WrappedVulkan::vkCmdSetLineWidth(VkCommandBuffer cmdBuffer, float lineWidth)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetLineWidth(Unwrap(cmdBuffer), lineWidth);
@@ -189,7 +192,7 @@ void WrappedVulkan::vkCmdSetLineWidth(VkCommandBuffer cmdBuffer, float lineWidth
     SCOPED_SERIALISE_CONTEXT(SET_LINE_WIDTH);
     Serialise_vkCmdSetLineWidth(localSerialiser, cmdBuffer, lineWidth);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -231,6 +234,7 @@ bool WrappedVulkan::Serialise_vkCmdSetDepthBias(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdSetDepthBias(VkCommandBuffer cmdBuffer, float depthBias,
                                       float depthBiasClamp, float slopeScaledDepthBias)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetDepthBias(Unwrap(cmdBuffer), depthBias, depthBiasClamp,
@@ -246,7 +250,7 @@ void WrappedVulkan::vkCmdSetDepthBias(VkCommandBuffer cmdBuffer, float depthBias
     Serialise_vkCmdSetDepthBias(localSerialiser, cmdBuffer, depthBias, depthBiasClamp,
                                 slopeScaledDepthBias);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -292,6 +296,7 @@ bool WrappedVulkan::Serialise_vkCmdSetBlendConstants(Serialiser *localSerialiser
 
 void WrappedVulkan::vkCmdSetBlendConstants(VkCommandBuffer cmdBuffer, const float *blendConst)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetBlendConstants(Unwrap(cmdBuffer), blendConst);
@@ -305,7 +310,7 @@ void WrappedVulkan::vkCmdSetBlendConstants(VkCommandBuffer cmdBuffer, const floa
     SCOPED_SERIALISE_CONTEXT(SET_BLEND_CONST);
     Serialise_vkCmdSetBlendConstants(localSerialiser, cmdBuffer, blendConst);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -345,6 +350,7 @@ bool WrappedVulkan::Serialise_vkCmdSetDepthBounds(Serialiser *localSerialiser,
 void WrappedVulkan::vkCmdSetDepthBounds(VkCommandBuffer cmdBuffer, float minDepthBounds,
                                         float maxDepthBounds)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetDepthBounds(Unwrap(cmdBuffer), minDepthBounds, maxDepthBounds);
@@ -358,7 +364,7 @@ void WrappedVulkan::vkCmdSetDepthBounds(VkCommandBuffer cmdBuffer, float minDept
     SCOPED_SERIALISE_CONTEXT(SET_DEPTH_BOUNDS);
     Serialise_vkCmdSetDepthBounds(localSerialiser, cmdBuffer, minDepthBounds, maxDepthBounds);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -402,6 +408,7 @@ bool WrappedVulkan::Serialise_vkCmdSetStencilCompareMask(Serialiser *localSerial
 void WrappedVulkan::vkCmdSetStencilCompareMask(VkCommandBuffer cmdBuffer,
                                                VkStencilFaceFlags faceMask, uint32_t compareMask)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetStencilCompareMask(Unwrap(cmdBuffer), faceMask, compareMask);
@@ -415,7 +422,7 @@ void WrappedVulkan::vkCmdSetStencilCompareMask(VkCommandBuffer cmdBuffer,
     SCOPED_SERIALISE_CONTEXT(SET_STENCIL_COMP_MASK);
     Serialise_vkCmdSetStencilCompareMask(localSerialiser, cmdBuffer, faceMask, compareMask);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -459,6 +466,7 @@ bool WrappedVulkan::Serialise_vkCmdSetStencilWriteMask(Serialiser *localSerialis
 void WrappedVulkan::vkCmdSetStencilWriteMask(VkCommandBuffer cmdBuffer, VkStencilFaceFlags faceMask,
                                              uint32_t writeMask)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetStencilWriteMask(Unwrap(cmdBuffer), faceMask, writeMask);
@@ -472,7 +480,7 @@ void WrappedVulkan::vkCmdSetStencilWriteMask(VkCommandBuffer cmdBuffer, VkStenci
     SCOPED_SERIALISE_CONTEXT(SET_STENCIL_WRITE_MASK);
     Serialise_vkCmdSetStencilWriteMask(localSerialiser, cmdBuffer, faceMask, writeMask);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
 
@@ -516,6 +524,7 @@ bool WrappedVulkan::Serialise_vkCmdSetStencilReference(Serialiser *localSerialis
 void WrappedVulkan::vkCmdSetStencilReference(VkCommandBuffer cmdBuffer, VkStencilFaceFlags faceMask,
                                              uint32_t reference)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetStencilReference(Unwrap(cmdBuffer), faceMask, reference);
@@ -529,6 +538,6 @@ void WrappedVulkan::vkCmdSetStencilReference(VkCommandBuffer cmdBuffer, VkStenci
     SCOPED_SERIALISE_CONTEXT(SET_STENCIL_REF);
     Serialise_vkCmdSetStencilReference(localSerialiser, cmdBuffer, faceMask, reference);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
   }
 }
@@ -43,6 +43,8 @@ void MakeFakeUUID()
 void WrappedVulkan::vkGetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice,
                                                 VkPhysicalDeviceFeatures *pFeatures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(physicalDevice)->GetPhysicalDeviceFeatures(Unwrap(physicalDevice), pFeatures);
 }
 
@@ -50,6 +52,8 @@ void WrappedVulkan::vkGetPhysicalDeviceFormatProperties(VkPhysicalDevice physica
                                                         VkFormat format,
                                                         VkFormatProperties *pFormatProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(physicalDevice)
       ->GetPhysicalDeviceFormatProperties(Unwrap(physicalDevice), format, pFormatProperties);
 }
@@ -59,6 +63,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceImageFormatProperties(
     VkImageUsageFlags usage, VkImageCreateFlags flags,
     VkImageFormatProperties *pImageFormatProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceImageFormatProperties(Unwrap(physicalDevice), format, type, tiling, usage,
                                                flags, pImageFormatProperties);
@@ -69,6 +75,8 @@ void WrappedVulkan::vkGetPhysicalDeviceSparseImageFormatProperties(
     VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageTiling tiling,
     uint32_t *pPropertyCount, VkSparseImageFormatProperties *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSparseImageFormatProperties(Unwrap(physicalDevice), format, type, samples,
                                                      usage, tiling, pPropertyCount, pProperties);
@@ -77,6 +85,8 @@ void WrappedVulkan::vkGetPhysicalDeviceSparseImageFormatProperties(
 void WrappedVulkan::vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice,
                                                   VkPhysicalDeviceProperties *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(physicalDevice)->GetPhysicalDeviceProperties(Unwrap(physicalDevice), pProperties);
 
   MakeFakeUUID();
@@ -87,6 +97,8 @@ void WrappedVulkan::vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevic
 void WrappedVulkan::vkGetPhysicalDeviceQueueFamilyProperties(
     VkPhysicalDevice physicalDevice, uint32_t *pCount, VkQueueFamilyProperties *pQueueFamilyProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // pretend to only have one queue, the one with graphics capability
   if(pCount)
     *pCount = 1;
@@ -104,6 +116,8 @@ void WrappedVulkan::vkGetPhysicalDeviceQueueFamilyProperties(
 void WrappedVulkan::vkGetPhysicalDeviceMemoryProperties(
     VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties *pMemoryProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(pMemoryProperties)
   {
     *pMemoryProperties = *GetRecord(physicalDevice)->memProps;
@@ -117,12 +131,16 @@ void WrappedVulkan::vkGetImageSubresourceLayout(VkDevice device, VkImage image,
                                                 const VkImageSubresource *pSubresource,
                                                 VkSubresourceLayout *pLayout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetImageSubresourceLayout(Unwrap(device), Unwrap(image), pSubresource, pLayout);
 }
 
 void WrappedVulkan::vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer,
                                                   VkMemoryRequirements *pMemoryRequirements)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetBufferMemoryRequirements(Unwrap(device), Unwrap(buffer), pMemoryRequirements);
 
   // don't do remapping here on replay.
@@ -144,6 +162,8 @@ void WrappedVulkan::vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buff
 void WrappedVulkan::vkGetImageMemoryRequirements(VkDevice device, VkImage image,
                                                  VkMemoryRequirements *pMemoryRequirements)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetImageMemoryRequirements(Unwrap(device), Unwrap(image), pMemoryRequirements);
 
   // don't do remapping here on replay.
@@ -166,6 +186,8 @@ void WrappedVulkan::vkGetImageSparseMemoryRequirements(
     VkDevice device, VkImage image, uint32_t *pNumRequirements,
     VkSparseImageMemoryRequirements *pSparseMemoryRequirements)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetImageSparseMemoryRequirements(Unwrap(device), Unwrap(image), pNumRequirements,
                                                     pSparseMemoryRequirements);
 }
@@ -173,18 +195,24 @@ void WrappedVulkan::vkGetImageSparseMemoryRequirements(
 void WrappedVulkan::vkGetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory,
                                                 VkDeviceSize *pCommittedMemoryInBytes)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetDeviceMemoryCommitment(Unwrap(device), Unwrap(memory), pCommittedMemoryInBytes);
 }
 
 void WrappedVulkan::vkGetRenderAreaGranularity(VkDevice device, VkRenderPass renderPass,
                                                VkExtent2D *pGranularity)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetRenderAreaGranularity(Unwrap(device), Unwrap(renderPass), pGranularity);
 }
 
 VkResult WrappedVulkan::vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache,
                                                size_t *pDataSize, void *pData)
 {
+  SCOPED_ENTRY_PROFILE();
+
   size_t totalSize = 16 + VK_UUID_SIZE + 4;    // required header (16+UUID) and 4 0 bytes
 
   if(pDataSize && !pData)
@@ -230,6 +258,8 @@ VkResult WrappedVulkan::vkMergePipelineCaches(VkDevice device, VkPipelineCache d
                                               uint32_t srcCacheCount,
                                               const VkPipelineCache *pSrcCaches)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // do nothing, our pipeline caches are always dummies
   return VK_SUCCESS;
 }
@@ -240,6 +270,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceExternalImageFormatPropertiesNV(
     VkExternalMemoryHandleTypeFlagsNV externalHandleType,
     VkExternalImageFormatPropertiesNV *pExternalImageFormatProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceExternalImageFormatPropertiesNV(Unwrap(physicalDevice), format, type,
                                                          tiling, usage, flags, externalHandleType,
@@ -251,6 +283,8 @@ VkResult WrappedVulkan::vkGetMemoryWin32HandleNV(VkDevice device, VkDeviceMemory
                                                  VkExternalMemoryHandleTypeFlagsNV handleType,
                                                  HANDLE *pHandle)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetMemoryWin32HandleNV(Unwrap(device), Unwrap(memory), handleType, pHandle);
 }
 
@@ -258,6 +292,8 @@ VkResult WrappedVulkan::vkGetMemoryWin32HandleKHX(VkDevice device, VkDeviceMemor
                                                   VkExternalMemoryHandleTypeFlagBitsKHX handleType,
                                                   HANDLE *pHandle)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetMemoryWin32HandleKHX(Unwrap(device), Unwrap(memory), handleType,
                                                   pHandle);
 }
@@ -266,6 +302,8 @@ VkResult WrappedVulkan::vkGetMemoryWin32HandlePropertiesKHX(
     VkDevice device, VkExternalMemoryHandleTypeFlagBitsKHX handleType, HANDLE handle,
     VkMemoryWin32HandlePropertiesKHX *pMemoryWin32HandleProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetMemoryWin32HandlePropertiesKHX(Unwrap(device), handleType, handle,
                                                             pMemoryWin32HandleProperties);
 }
@@ -274,6 +312,8 @@ VkResult WrappedVulkan::vkGetMemoryWin32HandlePropertiesKHX(
 VkResult WrappedVulkan::vkGetMemoryFdKHX(VkDevice device, VkDeviceMemory memory,
                                          VkExternalMemoryHandleTypeFlagBitsKHX handleType, int *pFd)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetMemoryFdKHX(Unwrap(device), Unwrap(memory), handleType, pFd);
 }
 
@@ -282,6 +322,8 @@ VkResult WrappedVulkan::vkGetMemoryFdPropertiesKHX(VkDevice device,
                                                    int fd,
                                                    VkMemoryFdPropertiesKHX *pMemoryFdProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetMemoryFdPropertiesKHX(Unwrap(device), handleType, fd,
                                                    pMemoryFdProperties);
 }
@@ -290,6 +332,8 @@ void WrappedVulkan::vkGetPhysicalDeviceExternalBufferPropertiesKHX(
     VkPhysicalDevice physicalDevice, const VkPhysicalDeviceExternalBufferInfoKHX *pExternalBufferInfo,
     VkExternalBufferPropertiesKHX *pExternalBufferProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceExternalBufferPropertiesKHX(Unwrap(physicalDevice), pExternalBufferInfo,
                                                      pExternalBufferProperties);
@@ -300,6 +344,8 @@ void WrappedVulkan::vkGetPhysicalDeviceExternalSemaphorePropertiesKHX(
     const VkPhysicalDeviceExternalSemaphoreInfoKHX *pExternalSemaphoreInfo,
     VkExternalSemaphorePropertiesKHX *pExternalSemaphoreProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceExternalSemaphorePropertiesKHX(
           Unwrap(physicalDevice), pExternalSemaphoreInfo, pExternalSemaphoreProperties);
@@ -308,12 +354,16 @@ void WrappedVulkan::vkGetPhysicalDeviceExternalSemaphorePropertiesKHX(
 void WrappedVulkan::vkGetPhysicalDeviceFeatures2KHR(VkPhysicalDevice physicalDevice,
                                                     VkPhysicalDeviceFeatures2KHR *pFeatures)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)->GetPhysicalDeviceFeatures2KHR(Unwrap(physicalDevice), pFeatures);
 }
 
 void WrappedVulkan::vkGetPhysicalDeviceProperties2KHR(VkPhysicalDevice physicalDevice,
                                                       VkPhysicalDeviceProperties2KHR *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)->GetPhysicalDeviceProperties2KHR(Unwrap(physicalDevice), pProperties);
 }
 
@@ -321,6 +371,8 @@ void WrappedVulkan::vkGetPhysicalDeviceFormatProperties2KHR(VkPhysicalDevice phy
                                                             VkFormat format,
                                                             VkFormatProperties2KHR *pFormatProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceFormatProperties2KHR(Unwrap(physicalDevice), format, pFormatProperties);
 }
@@ -329,6 +381,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceImageFormatProperties2KHR(
     VkPhysicalDevice physicalDevice, const VkPhysicalDeviceImageFormatInfo2KHR *pImageFormatInfo,
     VkImageFormatProperties2KHR *pImageFormatProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceImageFormatProperties2KHR(Unwrap(physicalDevice), pImageFormatInfo,
                                                    pImageFormatProperties);
@@ -338,6 +392,8 @@ void WrappedVulkan::vkGetPhysicalDeviceQueueFamilyProperties2KHR(
     VkPhysicalDevice physicalDevice, uint32_t *pCount,
     VkQueueFamilyProperties2KHR *pQueueFamilyProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceQueueFamilyProperties2KHR(Unwrap(physicalDevice), pCount,
                                                    pQueueFamilyProperties);
@@ -346,6 +402,8 @@ void WrappedVulkan::vkGetPhysicalDeviceQueueFamilyProperties2KHR(
 void WrappedVulkan::vkGetPhysicalDeviceMemoryProperties2KHR(
     VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2KHR *pMemoryProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceMemoryProperties2KHR(Unwrap(physicalDevice), pMemoryProperties);
 }
@@ -354,6 +412,8 @@ void WrappedVulkan::vkGetPhysicalDeviceSparseImageFormatProperties2KHR(
     VkPhysicalDevice physicalDevice, const VkPhysicalDeviceSparseImageFormatInfo2KHR *pFormatInfo,
     uint32_t *pPropertyCount, VkSparseImageFormatProperties2KHR *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSparseImageFormatProperties2KHR(Unwrap(physicalDevice), pFormatInfo,
                                                          pPropertyCount, pProperties);
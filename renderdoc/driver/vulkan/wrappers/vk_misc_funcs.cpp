@@ -91,10 +91,10 @@ DESTROY_IMPL(VkDescriptorPool, DestroyDescriptorPool)
 DESTROY_IMPL(VkSemaphore, DestroySemaphore)
 DESTROY_IMPL(VkFence, DestroyFence)
 DESTROY_IMPL(VkEvent, DestroyEvent)
-DESTROY_IMPL(VkCommandPool, DestroyCommandPool)
 DESTROY_IMPL(VkQueryPool, DestroyQueryPool)
 DESTROY_IMPL(VkFramebuffer, DestroyFramebuffer)
 DESTROY_IMPL(VkRenderPass, DestroyRenderPass)
+DESTROY_IMPL(VkDescriptorUpdateTemplateKHR, DestroyDescriptorUpdateTemplateKHR)
 
 #undef DESTROY_IMPL
 
@@ -102,6 +102,8 @@ DESTROY_IMPL(VkRenderPass, DestroyRenderPass)
 void WrappedVulkan::vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR obj,
                                           const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(obj == VK_NULL_HANDLE)
     return;
 
@@ -137,6 +139,8 @@ void WrappedVulkan::vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR obj,
 void WrappedVulkan::vkDestroyImage(VkDevice device, VkImage obj,
                                    const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(obj == VK_NULL_HANDLE)
     return;
 
@@ -149,11 +153,37 @@ void WrappedVulkan::vkDestroyImage(VkDevice device, VkImage obj,
   return ObjDisp(device)->DestroyImage(Unwrap(device), unwrappedObj, pAllocator);
 }
 
+// needs to be separate to free the timing query pools of the command buffers it frees
+void WrappedVulkan::vkDestroyCommandPool(VkDevice device, VkCommandPool obj,
+                                         const VkAllocationCallbacks *pAllocator)
+{
+  SCOPED_ENTRY_PROFILE();
+
+  if(obj == VK_NULL_HANDLE)
+    return;
+
+  VkResourceRecord *poolRecord = GetRecord(obj);
+
+  if(poolRecord)
+  {
+    poolRecord->LockChunks();
+    for(size_t i = 0; i < poolRecord->pooledChildren.size(); i++)
+      FreeEventTimingPool(poolRecord->pooledChildren[i]);
+    poolRecord->UnlockChunks();
+  }
+
+  VkCommandPool unwrappedObj = Unwrap(obj);
+  GetResourceManager()->ReleaseWrappedResource(obj, true);
+  ObjDisp(device)->DestroyCommandPool(Unwrap(device), unwrappedObj, pAllocator);
+}
+
 // needs to be separate since it's dispatchable
 void WrappedVulkan::vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool,
                                          uint32_t commandBufferCount,
                                          const VkCommandBuffer *pCommandBuffers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   for(uint32_t c = 0; c < commandBufferCount; c++)
   {
     if(pCommandBuffers[c] == VK_NULL_HANDLE)
@@ -163,6 +193,8 @@ void WrappedVulkan::vkFreeCommandBuffers(VkDevice device, VkCommandPool commandP
 
     VkCommandBuffer unwrapped = wrapped->real.As<VkCommandBuffer>();
 
+    FreeEventTimingPool(GetRecord(pCommandBuffers[c]));
+
     GetResourceManager()->ReleaseWrappedResource(pCommandBuffers[c]);
 
     ObjDisp(device)->FreeCommandBuffers(Unwrap(device), Unwrap(commandPool), 1, &unwrapped);
@@ -331,6 +363,13 @@ bool WrappedVulkan::ReleaseResource(WrappedVkRes *res)
       vt->DestroyDescriptorSetLayout(Unwrap(dev), real, NULL);
       break;
     }
+    case eResDescriptorUpdateTemplate:
+    {
+      VkDescriptorUpdateTemplateKHR real = nondisp->real.As<VkDescriptorUpdateTemplateKHR>();
+      GetResourceManager()->ReleaseWrappedResource(VkDescriptorUpdateTemplateKHR(handle));
+      vt->DestroyDescriptorUpdateTemplateKHR(Unwrap(dev), real, NULL);
+      break;
+    }
     case eResCommandPool:
     {
       VkCommandPool real = nondisp->real.As<VkCommandPool>();
@@ -424,6 +463,8 @@ bool WrappedVulkan::Serialise_vkCreateSampler(Serialiser *localSerialiser, VkDev
 VkResult WrappedVulkan::vkCreateSampler(VkDevice device, const VkSamplerCreateInfo *pCreateInfo,
                                         const VkAllocationCallbacks *pAllocator, VkSampler *pSampler)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(device)->CreateSampler(Unwrap(device), pCreateInfo, pAllocator, pSampler);
 
   if(ret == VK_SUCCESS)
@@ -510,6 +551,8 @@ VkResult WrappedVulkan::vkCreateFramebuffer(VkDevice device,
                                             const VkAllocationCallbacks *pAllocator,
                                             VkFramebuffer *pFramebuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkImageView *unwrapped = GetTempArray<VkImageView>(pCreateInfo->attachmentCount);
   for(uint32_t i = 0; i < pCreateInfo->attachmentCount; i++)
     unwrapped[i] = Unwrap(pCreateInfo->pAttachments[i]);
@@ -694,6 +737,8 @@ VkResult WrappedVulkan::vkCreateRenderPass(VkDevice device, const VkRenderPassCr
                                            const VkAllocationCallbacks *pAllocator,
                                            VkRenderPass *pRenderPass)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret =
       ObjDisp(device)->CreateRenderPass(Unwrap(device), pCreateInfo, pAllocator, pRenderPass);
 
@@ -812,6 +857,8 @@ VkResult WrappedVulkan::vkCreateQueryPool(VkDevice device, const VkQueryPoolCrea
                                           const VkAllocationCallbacks *pAllocator,
                                           VkQueryPool *pQueryPool)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret =
       ObjDisp(device)->CreateQueryPool(Unwrap(device), pCreateInfo, pAllocator, pQueryPool);
 
@@ -849,6 +896,8 @@ VkResult WrappedVulkan::vkGetQueryPoolResults(VkDevice device, VkQueryPool query
                                               size_t dataSize, void *pData, VkDeviceSize stride,
                                               VkQueryResultFlags flags)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetQueryPoolResults(Unwrap(device), Unwrap(queryPool), firstQuery,
                                               queryCount, dataSize, pData, stride, flags);
 }
@@ -908,6 +957,8 @@ VkResult WrappedVulkan::vkCreateDebugReportCallbackEXT(
     VkInstance instance, const VkDebugReportCallbackCreateInfoEXT *pCreateInfo,
     const VkAllocationCallbacks *pAllocator, VkDebugReportCallbackEXT *pCallback)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // we create an interception object here so that we can dynamically check the state of API
   // messages
   // being muted, since it's quite likely that the application will initialise Vulkan (and so create
@@ -940,6 +991,8 @@ void WrappedVulkan::vkDestroyDebugReportCallbackEXT(VkInstance instance,
                                                     VkDebugReportCallbackEXT callback,
                                                     const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   UserDebugCallbackData *user = (UserDebugCallbackData *)(uintptr_t)NON_DISP_TO_UINT64(callback);
 
   ObjDisp(instance)->DestroyDebugReportCallbackEXT(Unwrap(instance), user->realObject, pAllocator);
@@ -952,6 +1005,8 @@ void WrappedVulkan::vkDebugReportMessageEXT(VkInstance instance, VkDebugReportFl
                                             size_t location, int32_t messageCode,
                                             const char *pLayerPrefix, const char *pMessage)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(instance)->DebugReportMessageEXT(Unwrap(instance), flags, objectType, object,
                                                   location, messageCode, pLayerPrefix, pMessage);
 }
@@ -1029,6 +1084,8 @@ bool WrappedVulkan::Serialise_SetShaderDebugPath(Serialiser *localSerialiser, Vk
 VkResult WrappedVulkan::vkDebugMarkerSetObjectTagEXT(VkDevice device,
                                                      VkDebugMarkerObjectTagInfoEXT *pTagInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING && pTagInfo)
   {
     VkResourceRecord *record = GetObjRecord(pTagInfo->objectType, pTagInfo->object);
@@ -1085,7 +1142,7 @@ bool WrappedVulkan::Serialise_vkDebugMarkerSetObjectNameEXT(Serialiser *localSer
   if(m_State >= WRITING)
     name = pNameInfo->pObjectName;
 
-  localSerialiser->Serialise("name", name);
+  localSerialiser->SerialiseInternedString("name", name);
 
   if(m_State == READING)
     m_CreationInfo.m_Names[GetResourceManager()->GetLiveID(id)] = name;
@@ -1096,6 +1153,8 @@ bool WrappedVulkan::Serialise_vkDebugMarkerSetObjectNameEXT(Serialiser *localSer
 VkResult WrappedVulkan::vkDebugMarkerSetObjectNameEXT(VkDevice device,
                                                       VkDebugMarkerObjectNameInfoEXT *pNameInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING && pNameInfo)
   {
     Chunk *chunk = NULL;
@@ -59,6 +59,8 @@ bool WrappedVulkan::Serialise_vkGetDeviceQueue(Serialiser *localSerialiser, VkDe
 void WrappedVulkan::vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex,
                                      uint32_t queueIndex, VkQueue *pQueue)
 {
+  SCOPED_ENTRY_PROFILE();
+
   ObjDisp(device)->GetDeviceQueue(Unwrap(device), queueFamilyIndex, queueIndex, pQueue);
 
   if(m_SetDeviceLoaderData)
@@ -164,13 +166,39 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(Serialiser *localSerialiser, VkQueue
       fence = VK_NULL_HANDLE;
   }
 
-  // we don't serialise semaphores at all, just whether we waited on any.
-  // For waiting semaphores, since we don't track state we have to just conservatively
-  // wait for queue idle. Since we do that, there's equally no point in signalling semaphores
   SERIALISE_ELEMENT(uint32_t, numWaitSems, pSubmits->waitSemaphoreCount);
 
-  if(m_State < WRITING && numWaitSems > 0)
+  // older logs don't have the semaphores, only whether we waited on any. Without them we have to
+  // conservatively wait for queue idle, and there's equally no point in signalling anything
+  bool hasSems = m_State >= WRITING || GetLogVersion() >= 0x0000007;
+
+  vector<ResourceId> waitSemIds, signalSemIds;
+  vector<VkPipelineStageFlags> waitStages;
+
+  if(hasSems)
+  {
+    for(uint32_t i = 0; i < numWaitSems; i++)
+    {
+      SERIALISE_ELEMENT(ResourceId, waitSem, GetResID(pSubmits->pWaitSemaphores[i]));
+      SERIALISE_ELEMENT(VkPipelineStageFlags, waitStage, pSubmits->pWaitDstStageMask[i]);
+
+      waitSemIds.push_back(waitSem);
+      waitStages.push_back(waitStage);
+    }
+
+    SERIALISE_ELEMENT(uint32_t, numSignalSems, pSubmits->signalSemaphoreCount);
+
+    for(uint32_t i = 0; i < numSignalSems; i++)
+    {
+      SERIALISE_ELEMENT(ResourceId, signalSem, GetResID(pSubmits->pSignalSemaphores[i]));
+
+      signalSemIds.push_back(signalSem);
+    }
+  }
+  else if(m_State < WRITING && numWaitSems > 0)
+  {
     ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
+  }
 
   VkSubmitInfo submitInfo = {
       VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -188,6 +216,9 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(Serialiser *localSerialiser, VkQueue
 
   Serialise_DebugMessages(localSerialiser, true);
 
+  if(m_State < WRITING)
+    PatchReplaySemaphores(submitInfo, waitSemIds, waitStages, signalSemIds);
+
   if(m_State == READING)
   {
     // don't submit the fence, since we have nothing to wait on it being signalled, and we might
@@ -279,13 +310,24 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(Serialiser *localSerialiser, VkQueue
 
     if(numCmds == 0)
     {
-      // do nothing, don't bother with the logic below
+      // nothing to execute, but the submit might still be part of the synchronisation between
+      // queues so it needs to signal and wait the same way
+      if(submitInfo.waitSemaphoreCount > 0 || submitInfo.signalSemaphoreCount > 0)
+        ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &submitInfo, VK_NULL_HANDLE);
     }
     else if(m_LastEventID <= startEID)
     {
 #if ENABLED(VERBOSE_PARTIAL_REPLAY)
       RDCDEBUG("Queue Submit no replay %u == %u", m_LastEventID, startEID);
 #endif
+
+      // the command buffers aren't replayed, but the semaphore operations have already been
+      // accounted for so they still need to happen.
+      if(submitInfo.waitSemaphoreCount > 0 || submitInfo.signalSemaphoreCount > 0)
+      {
+        submitInfo.commandBufferCount = 0;
+        ObjDisp(queue)->QueueSubmit(Unwrap(queue), 1, &submitInfo, VK_NULL_HANDLE);
+      }
     }
     else if(m_DrawcallCallback && m_DrawcallCallback->RecordAllCmds())
     {
@@ -400,6 +442,92 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(Serialiser *localSerialiser, VkQueue
   return true;
 }
 
+void WrappedVulkan::PatchReplaySemaphores(VkSubmitInfo &submitInfo,
+                                          const vector<ResourceId> &waitSems,
+                                          const vector<VkPipelineStageFlags> &waitStages,
+                                          const vector<ResourceId> &signalSems)
+{
+  m_ReplayWaitSems.clear();
+  m_ReplayWaitStages.clear();
+  m_ReplaySignalSems.clear();
+
+  // only wait on semaphores that an earlier replayed submit signalled. Anything else was signalled
+  // outside of the frame (e.g. by acquiring a swapchain image) and has long since completed.
+  for(size_t i = 0; i < waitSems.size(); i++)
+  {
+    if(!GetResourceManager()->HasLiveResource(waitSems[i]))
+      continue;
+
+    VkSemaphore sem = GetResourceManager()->GetLiveHandle<VkSemaphore>(waitSems[i]);
+
+    auto it = m_ReplaySignalledSems.find(sem);
+    if(it == m_ReplaySignalledSems.end())
+      continue;
+
+    m_ReplaySignalledSems.erase(it);
+
+    m_ReplayWaitSems.push_back(Unwrap(sem));
+    m_ReplayWaitStages.push_back(waitStages[i]);
+  }
+
+  // a semaphore can't be signalled again before it's been waited on, which could happen if its
+  // waiter was outside the frame (e.g. a present) and the capture signals it again.
+  for(size_t i = 0; i < signalSems.size(); i++)
+  {
+    if(!GetResourceManager()->HasLiveResource(signalSems[i]))
+      continue;
+
+    VkSemaphore sem = GetResourceManager()->GetLiveHandle<VkSemaphore>(signalSems[i]);
+
+    if(!m_ReplaySignalledSems.insert(sem).second)
+      continue;
+
+    m_ReplaySignalSems.push_back(Unwrap(sem));
+  }
+
+  submitInfo.waitSemaphoreCount = (uint32_t)m_ReplayWaitSems.size();
+  submitInfo.pWaitSemaphores = m_ReplayWaitSems.empty() ? NULL : &m_ReplayWaitSems[0];
+  submitInfo.pWaitDstStageMask = m_ReplayWaitStages.empty() ? NULL : &m_ReplayWaitStages[0];
+  submitInfo.signalSemaphoreCount = (uint32_t)m_ReplaySignalSems.size();
+  submitInfo.pSignalSemaphores = m_ReplaySignalSems.empty() ? NULL : &m_ReplaySignalSems[0];
+}
+
+void WrappedVulkan::ResetReplaySemaphores()
+{
+  if(m_ReplaySignalledSems.empty() || m_Queue == VK_NULL_HANDLE)
+  {
+    m_ReplaySignalledSems.clear();
+    return;
+  }
+
+  // wait on anything still signalled so every semaphore is unsignalled for the next replay
+  m_ReplayWaitSems.clear();
+  m_ReplayWaitStages.clear();
+
+  for(auto it = m_ReplaySignalledSems.begin(); it != m_ReplaySignalledSems.end(); ++it)
+  {
+    m_ReplayWaitSems.push_back(Unwrap(*it));
+    m_ReplayWaitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+  }
+
+  VkSubmitInfo submitInfo = {
+      VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      NULL,
+      (uint32_t)m_ReplayWaitSems.size(),
+      &m_ReplayWaitSems[0],
+      &m_ReplayWaitStages[0],    // wait semaphores
+      0,
+      NULL,    // command buffers
+      0,
+      NULL,    // signal semaphores
+  };
+
+  VkResult vkr = ObjDisp(m_Queue)->QueueSubmit(Unwrap(m_Queue), 1, &submitInfo, VK_NULL_HANDLE);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_ReplaySignalledSems.clear();
+}
+
 void WrappedVulkan::InsertDrawsAndRefreshIDs(vector<VulkanDrawcallTreeNode> &cmdBufNodes)
 {
   // assign new drawcall IDs
@@ -452,6 +580,7 @@ void WrappedVulkan::InsertDrawsAndRefreshIDs(vector<VulkanDrawcallTreeNode> &cmd
 VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
                                       const VkSubmitInfo *pSubmits, VkFence fence)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   size_t tempmemSize = sizeof(VkSubmitInfo) * submitCount;
@@ -599,7 +728,8 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
       ObjDisp(queue)->QueueSubmit(Unwrap(queue), submitCount, unwrappedSubmits, Unwrap(fence));
 
   bool capframe = false;
-  set<ResourceId> refdIDs;
+  vector<VkResourceRecord *> refdCmds;
+  set<VkResourceRecord *> refdSets;
 
   for(uint32_t s = 0; s < submitCount; s++)
   {
@@ -629,7 +759,10 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         {
           for(auto it = record->bakedCommands->cmdInfo->dirtied.begin();
               it != record->bakedCommands->cmdInfo->dirtied.end(); ++it)
+          {
             GetResourceManager()->MarkPendingDirty(*it);
+            MarkSparseSnapshotsStale(*it);
+          }
 
           capframe = true;
         }
@@ -637,34 +770,29 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         {
           for(auto it = record->bakedCommands->cmdInfo->dirtied.begin();
               it != record->bakedCommands->cmdInfo->dirtied.end(); ++it)
+          {
             GetResourceManager()->MarkDirtyResource(*it);
+            MarkSparseSnapshotsStale(*it);
+          }
         }
       }
 
       if(capframe)
       {
+        // contents this command buffer discards are only unneeded if nothing earlier in the frame
+        // referenced them, so this has to come before its own references are added
+        if(!record->bakedCommands->cmdInfo->discards.empty())
+          ApplyImageDiscards(record->bakedCommands->cmdInfo->discards);
+
         // for each bound descriptor set, mark it referenced as well as all resources currently
         // bound to it
         for(auto it = record->bakedCommands->cmdInfo->boundDescSets.begin();
             it != record->bakedCommands->cmdInfo->boundDescSets.end(); ++it)
         {
-          GetResourceManager()->MarkResourceFrameReferenced(GetResID(*it), eFrameRef_Read);
-
           VkResourceRecord *setrecord = GetRecord(*it);
 
-          for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
-              refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
-          {
-            refdIDs.insert(refit->first);
-            GetResourceManager()->MarkResourceFrameReferenced(refit->first, refit->second.second);
-
-            if(refit->second.first & DescriptorSetData::SPARSE_REF_BIT)
-            {
-              VkResourceRecord *sparserecord = GetResourceManager()->GetResourceRecord(refit->first);
-
-              GetResourceManager()->MarkSparseMapReferenced(sparserecord->sparseInfo);
-            }
-          }
+          MarkDescSetReferenced(setrecord);
+          refdSets.insert(setrecord);
         }
 
         for(auto it = record->bakedCommands->cmdInfo->sparse.begin();
@@ -673,7 +801,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
 
         // pull in frame refs from this baked command buffer
         record->bakedCommands->AddResourceReferences(GetResourceManager());
-        record->bakedCommands->AddReferencedIDs(refdIDs);
+        refdCmds.push_back(record->bakedCommands);
 
         // ref the parent command buffer by itself, this will pull in the cmd buffer pool
         GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(), eFrameRef_Read);
@@ -682,7 +810,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         {
           record->bakedCommands->cmdInfo->subcmds[sub]->bakedCommands->AddResourceReferences(
               GetResourceManager());
-          record->bakedCommands->cmdInfo->subcmds[sub]->bakedCommands->AddReferencedIDs(refdIDs);
+          refdCmds.push_back(record->bakedCommands->cmdInfo->subcmds[sub]->bakedCommands);
           GetResourceManager()->MarkResourceFrameReferenced(
               record->bakedCommands->cmdInfo->subcmds[sub]->GetResourceID(), eFrameRef_Read);
 
@@ -724,21 +852,33 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
       // potential persistent map
       if(state.mapCoherent && state.mappedPtr && !state.mapFlushed)
       {
-        // only need to flush memory that could affect this submitted batch of work
-        if(refdIDs.find(record->GetResourceID()) == refdIDs.end())
+        // only need to flush memory that could affect this submitted batch of work. The command
+        // buffers and descriptor sets are each checked, rather than gathering all of their
+        // references into one set on every submit
+        bool refd = false;
+
+        for(size_t c = 0; !refd && c < refdCmds.size(); c++)
+          refd = refdCmds[c]->HasFrameReference(record);
+
+        for(auto setit = refdSets.begin(); !refd && setit != refdSets.end(); ++setit)
+        {
+          HashMap<ResourceId, uint32_t> &index = (*setit)->descInfo->bindFrameRefIndex;
+          refd = index.find(record->GetResourceID()) != index.end();
+        }
+
+        if(!refd)
         {
           RDCDEBUG("Map of memory %llu not referenced in this queue - not flushing",
                    record->GetResourceID());
           continue;
         }
 
-        size_t diffStart = 0, diffEnd = 0;
-        bool found = true;
+        // ranges relative to mappedPtr that have changed and need to be flushed
+        vector<pair<size_t, size_t> > diffs;
 
-// enabled as this is necessary for programs with very large coherent mappings
-// (> 1GB) as otherwise more than a couple of vkQueueSubmit calls leads to vast
-// memory allocation. There might still be bugs lurking in here though
-#if 1
+        // this is necessary for programs with very large coherent mappings (> 1GB) as otherwise
+        // more than a couple of vkQueueSubmit calls leads to vast memory allocation.
+        //
         // this causes vkFlushMappedMemoryRanges call to allocate and copy to refData
         // from serialised buffer. We want to copy *precisely* the serialised data,
         // otherwise there is a gap in time between serialising out a snapshot of
@@ -758,32 +898,55 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         // shouldn't miss anything
         state.needRefData = true;
 
-        // if we have a previous set of data, compare.
-        // otherwise just serialise it all
-        if(state.refData)
-          found = FindDiffRange((byte *)state.mappedPtr, state.refData, (size_t)state.mapSize,
-                                diffStart, diffEnd);
+        size_t diffStart = 0, diffEnd = 0;
+
+        if(state.refData && state.writeWatch)
+        {
+          // only pages written since the last flush can differ from the previous data
+          WriteWatch::FindModifiedRanges(state.writeWatch, state.mappedPtr, state.refData,
+                                         (size_t)state.mapSize, diffs);
+        }
+        else if(state.refData)
+        {
+          // if we have a previous set of data, compare.
+          if(FindDiffRange((byte *)state.mappedPtr, state.refData, (size_t)state.mapSize,
+                           diffStart, diffEnd))
+            diffs.push_back(std::make_pair(diffStart, diffEnd));
+        }
         else
-#endif
-          diffEnd = (size_t)state.mapSize;
+        {
+          // otherwise just serialise it all. If we can, start tracking writes before it's
+          // serialised so that anything written during or after is caught next time
+          if(RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites && state.mapOffset == 0 &&
+             state.writeWatch == 0)
+            state.writeWatch = WriteWatch::Begin(state.mappedPtr, (size_t)state.mapSize);
 
-        if(found)
+          diffs.push_back(std::make_pair((size_t)0, (size_t)state.mapSize));
+        }
+
+        if(!diffs.empty())
         {
           // MULTIDEVICE should find the device for this queue.
           // MULTIDEVICE only want to flush maps associated with this queue
           VkDevice dev = GetDev();
 
+          for(size_t d = 0; d < diffs.size(); d++)
           {
+            diffStart = diffs[d].first;
+            diffEnd = diffs[d].second;
+
             RDCLOG("Persistent map flush forced for %llu (%llu -> %llu)", record->GetResourceID(),
                    (uint64_t)diffStart, (uint64_t)diffEnd);
             VkMappedMemoryRange range = {VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL,
                                          (VkDeviceMemory)(uint64_t)record->Resource,
                                          state.mapOffset + diffStart, diffEnd - diffStart};
             vkFlushMappedMemoryRanges(dev, 1, &range);
-            state.mapFlushed = false;
           }
 
+          state.mapFlushed = false;
+
           GetResourceManager()->MarkPendingDirty(record->GetResourceID());
+          MarkSparseSnapshotsStale(record->GetResourceID());
         }
         else
         {
@@ -888,6 +1051,8 @@ bool WrappedVulkan::Serialise_vkQueueBindSparse(Serialiser *localSerialiser, VkQ
 VkResult WrappedVulkan::vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount,
                                           const VkBindSparseInfo *pBindInfo, VkFence fence)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING_CAPFRAME)
   {
     CACHE_THREAD_SERIALISER();
@@ -1060,6 +1225,8 @@ bool WrappedVulkan::Serialise_vkQueueWaitIdle(Serialiser *localSerialiser, VkQue
 
 VkResult WrappedVulkan::vkQueueWaitIdle(VkQueue queue)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(queue)->QueueWaitIdle(Unwrap(queue));
 
   if(m_State >= WRITING_CAPFRAME)
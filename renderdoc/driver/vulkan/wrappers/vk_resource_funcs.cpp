@@ -170,6 +170,9 @@ bool WrappedVulkan::Serialise_vkAllocateMemory(Serialiser *localSerialiser, VkDe
       ResourceId live = GetResourceManager()->WrapResource(Unwrap(device), mem);
       GetResourceManager()->AddLiveResource(id, mem);
 
+      m_ReplayAllocations[live] =
+          std::make_pair(eReplayMemory_CaptureResources, info.allocationSize);
+
       m_CreationInfo.m_Memory[live].Init(GetResourceManager(), m_CreationInfo, &info);
 
       // create a buffer with the whole memory range bound, for copying to and from
@@ -205,6 +208,8 @@ VkResult WrappedVulkan::vkAllocateMemory(VkDevice device, const VkMemoryAllocate
                                          const VkAllocationCallbacks *pAllocator,
                                          VkDeviceMemory *pMemory)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkMemoryAllocateInfo info = *pAllocateInfo;
   if(m_State >= WRITING)
   {
@@ -425,6 +430,8 @@ VkResult WrappedVulkan::vkAllocateMemory(VkDevice device, const VkMemoryAllocate
 
       m_CreationInfo.m_Memory[id].Init(GetResourceManager(), m_CreationInfo, &info);
 
+      m_ReplayAllocations[id] = std::make_pair(m_ReplayMemoryCategory, info.allocationSize);
+
       // create a buffer with the whole memory range bound, for copying to and from
       // conveniently (for initial state data)
       VkBuffer buf = VK_NULL_HANDLE;
@@ -457,6 +464,8 @@ VkResult WrappedVulkan::vkAllocateMemory(VkDevice device, const VkMemoryAllocate
 void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
                                  const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(memory == VK_NULL_HANDLE)
     return;
 
@@ -468,8 +477,14 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
   if(m_State >= WRITING)
   {
     // there is an implicit unmap on free, so make sure to tidy up
-    if(wrapped->record->memMapState && wrapped->record->memMapState->refData)
-      Serialiser::FreeAlignedBuffer(wrapped->record->memMapState->refData);
+    if(wrapped->record->memMapState)
+    {
+      WriteWatch::End(wrapped->record->memMapState->writeWatch);
+      wrapped->record->memMapState->writeWatch = 0;
+    }
+
+    if(wrapped->record->memMapState)
+      wrapped->record->memMapState->FreeRefData();
 
     {
       SCOPED_LOCK(m_CoherentMapsLock);
@@ -479,6 +494,10 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
         m_CoherentMaps.erase(it);
     }
   }
+  else
+  {
+    m_ReplayAllocations.erase(GetResID(memory));
+  }
 
   GetResourceManager()->ReleaseWrappedResource(memory);
 
@@ -488,6 +507,8 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
 VkResult WrappedVulkan::vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDeviceSize offset,
                                     VkDeviceSize size, VkMemoryMapFlags flags, void **ppData)
 {
+  SCOPED_ENTRY_PROFILE();
+
   void *realData = NULL;
   VkResult ret =
       ObjDisp(device)->MapMemory(Unwrap(device), Unwrap(mem), offset, size, flags, &realData);
@@ -579,6 +600,8 @@ bool WrappedVulkan::Serialise_vkUnmapMemory(Serialiser *localSerialiser, VkDevic
 
 void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     ResourceId id = GetResID(mem);
@@ -602,6 +625,8 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
           GetResourceManager()->MarkDirtyResource(id);
       }
 
+      MarkSparseSnapshotsStale(id);
+
       if(capframe)
       {
         // coherent maps must always serialise all data on unmap, even if a flush was seen, because
@@ -635,7 +660,11 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
       state.mappedPtr = NULL;
     }
 
-    Serialiser::FreeAlignedBuffer(state.refData);
+    // must stop before the memory is unmapped below
+    WriteWatch::End(state.writeWatch);
+    state.writeWatch = 0;
+
+    state.FreeRefData();
 
     if(state.mapCoherent)
     {
@@ -689,7 +718,7 @@ bool WrappedVulkan::Serialise_vkFlushMappedMemoryRanges(Serialiser *localSeriali
       RDCASSERT(memOffset == 0 && memSize == state->mapSize);
 
       // allocate ref data so we can compare next time to minimise serialised data
-      state->refData = Serialiser::AllocAlignedBuffer((size_t)state->mapSize);
+      state->AllocRefData();
     }
 
     // it's no longer safe to use state->mappedPtr, we need to save *precisely* what
@@ -699,7 +728,7 @@ bool WrappedVulkan::Serialise_vkFlushMappedMemoryRanges(Serialiser *localSeriali
 
     byte *serialisedData = localSerialiser->GetRawPtr(offs);
 
-    memcpy(state->refData, serialisedData + (size_t)memOffset, (size_t)memSize);
+    memcpy(state->refData + (size_t)memOffset, serialisedData, (size_t)memSize);
   }
 
   if(m_State < WRITING)
@@ -731,6 +760,8 @@ bool WrappedVulkan::Serialise_vkFlushMappedMemoryRanges(Serialiser *localSeriali
 VkResult WrappedVulkan::vkFlushMappedMemoryRanges(VkDevice device, uint32_t memRangeCount,
                                                   const VkMappedMemoryRange *pMemRanges)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State >= WRITING)
   {
     bool capframe = false;
@@ -767,6 +798,8 @@ VkResult WrappedVulkan::vkFlushMappedMemoryRanges(VkDevice device, uint32_t memR
       {
         GetResourceManager()->MarkDirtyResource(memid);
       }
+
+      MarkSparseSnapshotsStale(memid);
     }
   }
 
@@ -785,6 +818,8 @@ VkResult WrappedVulkan::vkFlushMappedMemoryRanges(VkDevice device, uint32_t memR
 VkResult WrappedVulkan::vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memRangeCount,
                                                        const VkMappedMemoryRange *pMemRanges)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkMappedMemoryRange *unwrapped = GetTempArray<VkMappedMemoryRange>(memRangeCount);
   for(uint32_t i = 0; i < memRangeCount; i++)
   {
@@ -823,6 +858,8 @@ bool WrappedVulkan::Serialise_vkBindBufferMemory(Serialiser *localSerialiser, Vk
 VkResult WrappedVulkan::vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory mem,
                                            VkDeviceSize memOffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResourceRecord *record = GetRecord(buffer);
 
   if(m_State >= WRITING)
@@ -874,6 +911,8 @@ bool WrappedVulkan::Serialise_vkBindImageMemory(Serialiser *localSerialiser, VkD
 VkResult WrappedVulkan::vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory mem,
                                           VkDeviceSize memOffset)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResourceRecord *record = GetRecord(image);
 
   if(m_State >= WRITING)
@@ -947,6 +986,8 @@ bool WrappedVulkan::Serialise_vkCreateBuffer(Serialiser *localSerialiser, VkDevi
 VkResult WrappedVulkan::vkCreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo,
                                        const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkBufferCreateInfo adjusted_info = *pCreateInfo;
 
   // TEMP HACK: Until we define a portable fake hardware, need to match the requirements for usage
@@ -1058,6 +1099,8 @@ VkResult WrappedVulkan::vkCreateBufferView(VkDevice device, const VkBufferViewCr
                                            const VkAllocationCallbacks *pAllocator,
                                            VkBufferView *pView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkBufferViewCreateInfo unwrappedInfo = *pCreateInfo;
   unwrappedInfo.buffer = Unwrap(unwrappedInfo.buffer);
   VkResult ret = ObjDisp(device)->CreateBufferView(Unwrap(device), &unwrappedInfo, pAllocator, pView);
@@ -1180,6 +1223,8 @@ bool WrappedVulkan::Serialise_vkCreateImage(Serialiser *localSerialiser, VkDevic
 VkResult WrappedVulkan::vkCreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo,
                                       const VkAllocationCallbacks *pAllocator, VkImage *pImage)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkImageCreateInfo createInfo_adjusted = *pCreateInfo;
 
   createInfo_adjusted.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
@@ -1382,6 +1427,8 @@ bool WrappedVulkan::Serialise_vkCreateImageView(Serialiser *localSerialiser, VkD
 VkResult WrappedVulkan::vkCreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateInfo,
                                           const VkAllocationCallbacks *pAllocator, VkImageView *pView)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkImageViewCreateInfo unwrappedInfo = *pCreateInfo;
   unwrappedInfo.image = Unwrap(unwrappedInfo.image);
   VkResult ret = ObjDisp(device)->CreateImageView(Unwrap(device), &unwrappedInfo, pAllocator, pView);
@@ -80,6 +80,8 @@ VkResult WrappedVulkan::vkCreatePipelineLayout(VkDevice device,
                                                const VkAllocationCallbacks *pAllocator,
                                                VkPipelineLayout *pPipelineLayout)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkDescriptorSetLayout *unwrapped = GetTempArray<VkDescriptorSetLayout>(pCreateInfo->setLayoutCount);
   for(uint32_t i = 0; i < pCreateInfo->setLayoutCount; i++)
     unwrapped[i] = Unwrap(pCreateInfo->pSetLayouts[i]);
@@ -180,6 +182,8 @@ VkResult WrappedVulkan::vkCreateShaderModule(VkDevice device,
                                              const VkAllocationCallbacks *pAllocator,
                                              VkShaderModule *pShaderModule)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret =
       ObjDisp(device)->CreateShaderModule(Unwrap(device), pCreateInfo, pAllocator, pShaderModule);
 
@@ -251,6 +255,8 @@ VkResult WrappedVulkan::vkCreatePipelineCache(VkDevice device,
                                               const VkAllocationCallbacks *pAllocator,
                                               VkPipelineCache *pPipelineCache)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // pretend the user didn't provide any cache data
 
   VkPipelineCacheCreateInfo createInfo = *pCreateInfo;
@@ -311,11 +317,9 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
     VkPipeline pipe = VK_NULL_HANDLE;
 
     device = GetResourceManager()->GetLiveHandle<VkDevice>(devId);
-    // don't use pipeline caches on replay
-    pipelineCache =
-        VK_NULL_HANDLE;    // GetResourceManager()->GetLiveHandle<VkPipelineCache>(cacheId);
-
-    VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache),
+    // don't use the application's pipeline caches on replay, they're always created empty. Our
+    // own cache persists between replays of the capture instead.
+    VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), m_ReplayPipelineCache,
                                                             1, &info, NULL, &pipe);
 
     if(ret != VK_SUCCESS)
@@ -356,6 +360,8 @@ VkResult WrappedVulkan::vkCreateGraphicsPipelines(VkDevice device, VkPipelineCac
                                                   const VkAllocationCallbacks *pAllocator,
                                                   VkPipeline *pPipelines)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // conservatively request memory for 5 stages on each pipeline
   // (worst case - can't have compute stage). Avoids needing to count
   byte *unwrapped = GetTempMemory(sizeof(VkGraphicsPipelineCreateInfo) * count +
@@ -383,8 +389,14 @@ VkResult WrappedVulkan::vkCreateGraphicsPipelines(VkDevice device, VkPipelineCac
     unwrappedInfos[i].basePipelineHandle = Unwrap(unwrappedInfos[i].basePipelineHandle);
   }
 
-  VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(
-      Unwrap(device), Unwrap(pipelineCache), count, unwrappedInfos, pAllocator, pPipelines);
+  VkPipelineCache unwrappedCache = Unwrap(pipelineCache);
+
+  // pipelines we create ourselves on replay go through the persistent replay cache too
+  if(m_State < WRITING && unwrappedCache == VK_NULL_HANDLE)
+    unwrappedCache = m_ReplayPipelineCache;
+
+  VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), unwrappedCache, count,
+                                                          unwrappedInfos, pAllocator, pPipelines);
 
   if(ret == VK_SUCCESS)
   {
@@ -467,9 +479,8 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(Serialiser *localSerialis
     VkPipeline pipe = VK_NULL_HANDLE;
 
     device = GetResourceManager()->GetLiveHandle<VkDevice>(devId);
-    pipelineCache = GetResourceManager()->GetLiveHandle<VkPipelineCache>(cacheId);
-
-    VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), Unwrap(pipelineCache), 1,
+    // as with graphics pipelines, use our own cache rather than the application's
+    VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), m_ReplayPipelineCache, 1,
                                                            &info, NULL, &pipe);
 
     if(ret != VK_SUCCESS)
@@ -510,6 +521,8 @@ VkResult WrappedVulkan::vkCreateComputePipelines(VkDevice device, VkPipelineCach
                                                  const VkAllocationCallbacks *pAllocator,
                                                  VkPipeline *pPipelines)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkComputePipelineCreateInfo *unwrapped = GetTempArray<VkComputePipelineCreateInfo>(count);
 
   for(uint32_t i = 0; i < count; i++)
@@ -520,8 +533,13 @@ VkResult WrappedVulkan::vkCreateComputePipelines(VkDevice device, VkPipelineCach
     unwrapped[i].basePipelineHandle = Unwrap(unwrapped[i].basePipelineHandle);
   }
 
-  VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), Unwrap(pipelineCache),
-                                                         count, unwrapped, pAllocator, pPipelines);
+  VkPipelineCache unwrappedCache = Unwrap(pipelineCache);
+
+  if(m_State < WRITING && unwrappedCache == VK_NULL_HANDLE)
+    unwrappedCache = m_ReplayPipelineCache;
+
+  VkResult ret = ObjDisp(device)->CreateComputePipelines(Unwrap(device), unwrappedCache, count,
+                                                         unwrapped, pAllocator, pPipelines);
 
   if(ret == VK_SUCCESS)
   {
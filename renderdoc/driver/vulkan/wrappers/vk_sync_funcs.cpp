@@ -103,6 +103,8 @@ bool WrappedVulkan::Serialise_vkCreateFence(Serialiser *localSerialiser, VkDevic
 VkResult WrappedVulkan::vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo,
                                       const VkAllocationCallbacks *pAllocator, VkFence *pFence)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(device)->CreateFence(Unwrap(device), pCreateInfo, pAllocator, pFence);
 
   if(ret == VK_SUCCESS)
@@ -154,6 +156,7 @@ bool WrappedVulkan::Serialise_vkGetFenceStatus(Serialiser *localSerialiser, VkDe
 
 VkResult WrappedVulkan::vkGetFenceStatus(VkDevice device, VkFence fence)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkResult ret = ObjDisp(device)->GetFenceStatus(Unwrap(device), Unwrap(fence));
@@ -209,6 +212,7 @@ bool WrappedVulkan::Serialise_vkResetFences(Serialiser *localSerialiser, VkDevic
 
 VkResult WrappedVulkan::vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkFence *unwrapped = GetTempArray<VkFence>(fenceCount);
@@ -267,6 +271,7 @@ bool WrappedVulkan::Serialise_vkWaitForFences(Serialiser *localSerialiser, VkDev
 VkResult WrappedVulkan::vkWaitForFences(VkDevice device, uint32_t fenceCount,
                                         const VkFence *pFences, VkBool32 waitAll, uint64_t timeout)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkFence *unwrapped = GetTempArray<VkFence>(fenceCount);
@@ -323,6 +328,8 @@ bool WrappedVulkan::Serialise_vkCreateEvent(Serialiser *localSerialiser, VkDevic
 VkResult WrappedVulkan::vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo,
                                       const VkAllocationCallbacks *pAllocator, VkEvent *pEvent)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret = ObjDisp(device)->CreateEvent(Unwrap(device), pCreateInfo, pAllocator, pEvent);
 
   if(ret == VK_SUCCESS)
@@ -371,6 +378,7 @@ bool WrappedVulkan::Serialise_vkSetEvent(Serialiser *localSerialiser, VkDevice d
 
 VkResult WrappedVulkan::vkSetEvent(VkDevice device, VkEvent event)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkResult ret = ObjDisp(device)->SetEvent(Unwrap(device), Unwrap(event));
@@ -405,6 +413,7 @@ bool WrappedVulkan::Serialise_vkResetEvent(Serialiser *localSerialiser, VkDevice
 
 VkResult WrappedVulkan::vkResetEvent(VkDevice device, VkEvent event)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkResult ret = ObjDisp(device)->ResetEvent(Unwrap(device), Unwrap(event));
@@ -442,6 +451,7 @@ bool WrappedVulkan::Serialise_vkGetEventStatus(Serialiser *localSerialiser, VkDe
 
 VkResult WrappedVulkan::vkGetEventStatus(VkDevice device, VkEvent event)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   VkResult ret = ObjDisp(device)->GetEventStatus(Unwrap(device), Unwrap(event));
@@ -513,6 +523,8 @@ VkResult WrappedVulkan::vkCreateSemaphore(VkDevice device, const VkSemaphoreCrea
                                           const VkAllocationCallbacks *pAllocator,
                                           VkSemaphore *pSemaphore)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkResult ret =
       ObjDisp(device)->CreateSemaphore(Unwrap(device), pCreateInfo, pAllocator, pSemaphore);
 
@@ -583,6 +595,7 @@ bool WrappedVulkan::Serialise_vkCmdSetEvent(Serialiser *localSerialiser, VkComma
 void WrappedVulkan::vkCmdSetEvent(VkCommandBuffer cmdBuffer, VkEvent event,
                                   VkPipelineStageFlags stageMask)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdSetEvent(Unwrap(cmdBuffer), Unwrap(event), stageMask);
@@ -596,7 +609,7 @@ void WrappedVulkan::vkCmdSetEvent(VkCommandBuffer cmdBuffer, VkEvent event,
     SCOPED_SERIALISE_CONTEXT(CMD_SET_EVENT);
     Serialise_vkCmdSetEvent(localSerialiser, cmdBuffer, event, stageMask);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(event), eFrameRef_Read);
   }
 }
@@ -639,6 +652,7 @@ bool WrappedVulkan::Serialise_vkCmdResetEvent(Serialiser *localSerialiser, VkCom
 void WrappedVulkan::vkCmdResetEvent(VkCommandBuffer cmdBuffer, VkEvent event,
                                     VkPipelineStageFlags stageMask)
 {
+  SCOPED_ENTRY_PROFILE();
   SCOPED_DBG_SINK();
 
   ObjDisp(cmdBuffer)->CmdResetEvent(Unwrap(cmdBuffer), Unwrap(event), stageMask);
@@ -652,7 +666,7 @@ void WrappedVulkan::vkCmdResetEvent(VkCommandBuffer cmdBuffer, VkEvent event,
     SCOPED_SERIALISE_CONTEXT(CMD_RESET_EVENT);
     Serialise_vkCmdResetEvent(localSerialiser, cmdBuffer, event, stageMask);
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     record->MarkResourceFrameReferenced(GetResID(event), eFrameRef_Read);
   }
 }
@@ -784,6 +798,8 @@ void WrappedVulkan::vkCmdWaitEvents(VkCommandBuffer cmdBuffer, uint32_t eventCou
                                     uint32_t imageMemoryBarrierCount,
                                     const VkImageMemoryBarrier *pImageMemoryBarriers)
 {
+  SCOPED_ENTRY_PROFILE();
+
   {
     byte *memory = GetTempMemory(sizeof(VkEvent) * eventCount +
                                  sizeof(VkBufferMemoryBarrier) * bufferMemoryBarrierCount +
@@ -832,7 +848,7 @@ void WrappedVulkan::vkCmdWaitEvents(VkCommandBuffer cmdBuffer, uint32_t eventCou
                                            imageMemoryBarrierCount, pImageMemoryBarriers);
     }
 
-    record->AddChunk(scope.Get());
+    record->AddChunk(scope.Get(record->cmdInfo->arena));
     for(uint32_t i = 0; i < eventCount; i++)
       record->MarkResourceFrameReferenced(GetResID(pEvents[i]), eFrameRef_Read);
   }
@@ -841,6 +857,8 @@ void WrappedVulkan::vkCmdWaitEvents(VkCommandBuffer cmdBuffer, uint32_t eventCou
 VkResult WrappedVulkan::vkImportSemaphoreFdKHX(VkDevice device,
                                                const VkImportSemaphoreFdInfoKHX *pImportSemaphoreFdInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkImportSemaphoreFdInfoKHX unwrappedInfo = *pImportSemaphoreFdInfo;
   unwrappedInfo.semaphore = Unwrap(unwrappedInfo.semaphore);
 
@@ -851,6 +869,8 @@ VkResult WrappedVulkan::vkGetSemaphoreFdKHX(VkDevice device, VkSemaphore semapho
                                             VkExternalSemaphoreHandleTypeFlagBitsKHX handleType,
                                             int *pFd)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetSemaphoreFdKHX(Unwrap(device), Unwrap(semaphore), handleType, pFd);
 }
 
@@ -859,6 +879,8 @@ VkResult WrappedVulkan::vkGetSemaphoreFdKHX(VkDevice device, VkSemaphore semapho
 VkResult WrappedVulkan::vkImportSemaphoreWin32HandleKHX(
     VkDevice device, const VkImportSemaphoreWin32HandleInfoKHX *pImportSemaphoreWin32HandleInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkImportSemaphoreWin32HandleInfoKHX unwrappedInfo = *pImportSemaphoreWin32HandleInfo;
   unwrappedInfo.semaphore = Unwrap(unwrappedInfo.semaphore);
 
@@ -869,6 +891,8 @@ VkResult WrappedVulkan::vkGetSemaphoreWin32HandleKHX(VkDevice device, VkSemaphor
                                                      VkExternalSemaphoreHandleTypeFlagBitsKHX handleType,
                                                      HANDLE *pHandle)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetSemaphoreWin32HandleKHX(Unwrap(device), Unwrap(semaphore), handleType,
                                                      pHandle);
 }
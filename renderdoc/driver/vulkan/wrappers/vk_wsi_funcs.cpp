@@ -33,6 +33,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice ph
                                                              VkSurfaceKHR surface,
                                                              VkBool32 *pSupported)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSurfaceSupportKHR(Unwrap(physicalDevice), queueFamilyIndex,
                                            Unwrap(surface), pSupported);
@@ -42,6 +44,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
     VkPhysicalDevice physicalDevice, VkSurfaceKHR surface,
     VkSurfaceCapabilitiesKHR *pSurfaceCapabilities)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSurfaceCapabilitiesKHR(Unwrap(physicalDevice), Unwrap(surface),
                                                 pSurfaceCapabilities);
@@ -52,6 +56,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice ph
                                                              uint32_t *pSurfaceFormatCount,
                                                              VkSurfaceFormatKHR *pSurfaceFormats)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSurfaceFormatsKHR(Unwrap(physicalDevice), Unwrap(surface),
                                            pSurfaceFormatCount, pSurfaceFormats);
@@ -62,6 +68,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevi
                                                                   uint32_t *pPresentModeCount,
                                                                   VkPresentModeKHR *pPresentModes)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSurfacePresentModesKHR(Unwrap(physicalDevice), Unwrap(surface),
                                                 pPresentModeCount, pPresentModes);
@@ -71,6 +79,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfaceCapabilities2EXT(
     VkPhysicalDevice physicalDevice, VkSurfaceKHR surface,
     VkSurfaceCapabilities2EXT *pSurfaceCapabilities)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceSurfaceCapabilities2EXT(Unwrap(physicalDevice), Unwrap(surface),
                                                  pSurfaceCapabilities);
@@ -79,6 +89,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceSurfaceCapabilities2EXT(
 VkResult WrappedVulkan::vkDisplayPowerControlEXT(VkDevice device, VkDisplayKHR display,
                                                  const VkDisplayPowerInfoEXT *pDisplayPowerInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // displays are not wrapped
   return ObjDisp(device)->DisplayPowerControlEXT(Unwrap(device), display, pDisplayPowerInfo);
 }
@@ -87,6 +99,8 @@ VkResult WrappedVulkan::vkGetSwapchainCounterEXT(VkDevice device, VkSwapchainKHR
                                                  VkSurfaceCounterFlagBitsEXT counter,
                                                  uint64_t *pCounterValue)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->GetSwapchainCounterEXT(Unwrap(device), Unwrap(swapchain), counter,
                                                  pCounterValue);
 }
@@ -96,6 +110,8 @@ VkResult WrappedVulkan::vkRegisterDeviceEventEXT(VkDevice device,
                                                  const VkAllocationCallbacks *pAllocator,
                                                  VkFence *pFence)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // for now we emulate this on replay as just a regular fence create, since we don't faithfully
   // replay sync events anyway.
   VkResult ret =
@@ -139,6 +155,8 @@ VkResult WrappedVulkan::vkRegisterDisplayEventEXT(VkDevice device, VkDisplayKHR
                                                   const VkAllocationCallbacks *pAllocator,
                                                   VkFence *pFence)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // for now we emulate this on replay as just a regular fence create, since we don't faithfully
   // replay sync events anyway.
   VkResult ret = ObjDisp(device)->RegisterDisplayEventEXT(Unwrap(device), display,
@@ -203,6 +221,8 @@ bool WrappedVulkan::Serialise_vkGetSwapchainImagesKHR(Serialiser *localSerialise
 VkResult WrappedVulkan::vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain,
                                                 uint32_t *pCount, VkImage *pSwapchainImages)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // make sure we always get the size
   uint32_t dummySize = 0;
   if(pCount == NULL)
@@ -274,6 +294,8 @@ VkResult WrappedVulkan::vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR sw
                                               uint64_t timeout, VkSemaphore semaphore,
                                               VkFence fence, uint32_t *pImageIndex)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(device)->AcquireNextImageKHR(Unwrap(device), Unwrap(swapchain), timeout,
                                               Unwrap(semaphore), Unwrap(fence), pImageIndex);
 }
@@ -592,6 +614,8 @@ VkResult WrappedVulkan::vkCreateSwapchainKHR(VkDevice device,
                                              const VkAllocationCallbacks *pAllocator,
                                              VkSwapchainKHR *pSwapChain)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkSwapchainCreateInfoKHR createInfo = *pCreateInfo;
 
   // make sure we can readback to get the screenshot, and render to it for the text overlay
@@ -610,12 +634,18 @@ VkResult WrappedVulkan::vkCreateSwapchainKHR(VkDevice device,
 
 VkResult WrappedVulkan::vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
 {
+  SCOPED_ENTRY_PROFILE();
+
   if(m_State == WRITING_IDLE)
   {
     RenderDoc::Inst().Tick();
 
     GetResourceManager()->FlushPendingDirty();
   }
+  else if(RenderDoc::Inst().IsRingFrameActive())
+  {
+    RenderDoc::Inst().Tick();
+  }
 
   m_FrameCounter++;    // first present becomes frame #1, this function is at the end of the frame
 
@@ -654,9 +684,7 @@ VkResult WrappedVulkan::vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR
 
   if(m_State == WRITING_IDLE)
   {
-    uint32_t overlay = RenderDoc::Inst().GetOverlayBits();
-
-    if(overlay & eRENDERDOC_Overlay_Enabled)
+    if(RenderDoc::Inst().ShouldDrawOverlay())
     {
       VkRenderPass rp = swapInfo.rp;
       VkImage im = swapInfo.images[pPresentInfo->pImageIndices[0]].im;
@@ -720,15 +748,47 @@ VkResult WrappedVulkan::vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR
 
   RenderDoc::Inst().SetCurrentDriver(RDC_Vulkan);
 
-  // kill any current capture that isn't application defined
+  // kill any current capture that isn't application defined, unless it's still recording a run of
+  // frames on this window, in which case the frame boundary is recorded and the capture continues
   if(m_State == WRITING_CAPFRAME && !m_AppControlledCapture)
-    RenderDoc::Inst().EndFrameCapture(LayerDisp(m_Instance), swapInfo.wndHandle);
+  {
+    if(m_CapSpanFrames > 0 && m_CapSpanWindow == swapInfo.wndHandle)
+    {
+      m_CapSpanFrames--;
+
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(FRAME_BOUNDARY);
+      Serialise_FrameBoundary(localSerialiser, swapInfo.images[swapInfo.lastPresent].im);
 
-  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && m_State == WRITING_IDLE)
+      m_FrameCaptureRecord->AddChunk(scope.Get());
+    }
+    else
+    {
+      m_CapSpanFrames = 0;
+      RenderDoc::Inst().EndFrameCapture(LayerDisp(m_Instance), swapInfo.wndHandle);
+    }
+  }
+
+  uint32_t spanFrames = 0;
+  if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter, spanFrames) && m_State == WRITING_IDLE)
   {
     RenderDoc::Inst().StartFrameCapture(LayerDisp(m_Instance), swapInfo.wndHandle);
 
     m_AppControlledCapture = false;
+
+    // the run belongs to this device's capture, once it has actually started
+    if(m_State == WRITING_CAPFRAME)
+    {
+      m_CapSpanFrames = spanFrames;
+      m_CapSpanWindow = swapInfo.wndHandle;
+    }
+  }
+  else if(m_State == WRITING_IDLE)
+  {
+    // spread out the work of preparing initial contents over the frames before a capture
+    SCOPED_LOCK(m_CapTransitionLock);
+    GetResourceManager()->StageInitialContents();
   }
 
   return vkr;
@@ -739,6 +799,8 @@ VkResult WrappedVulkan::vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR
 void WrappedVulkan::vkDestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface,
                                         const VkAllocationCallbacks *pAllocator)
 {
+  SCOPED_ENTRY_PROFILE();
+
   WrappedVkSurfaceKHR *wrapper = GetWrapped(surface);
 
   // record pointer has window handle packed in
@@ -762,6 +824,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceDisplayPropertiesKHR(VkPhysicalDevice
                                                                 uint32_t *pPropertyCount,
                                                                 VkDisplayPropertiesKHR *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceDisplayPropertiesKHR(Unwrap(physicalDevice), pPropertyCount, pProperties);
 }
@@ -770,6 +834,8 @@ VkResult WrappedVulkan::vkGetPhysicalDeviceDisplayPlanePropertiesKHR(
     VkPhysicalDevice physicalDevice, uint32_t *pPropertyCount,
     VkDisplayPlanePropertiesKHR *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   return ObjDisp(physicalDevice)
       ->GetPhysicalDeviceDisplayPlanePropertiesKHR(Unwrap(physicalDevice), pPropertyCount,
                                                    pProperties);
@@ -780,6 +846,8 @@ VkResult WrappedVulkan::vkGetDisplayPlaneSupportedDisplaysKHR(VkPhysicalDevice p
                                                               uint32_t *pDisplayCount,
                                                               VkDisplayKHR *pDisplays)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // we don't wrap the resulting displays since there's no data we need for them
   return ObjDisp(physicalDevice)
       ->GetDisplayPlaneSupportedDisplaysKHR(Unwrap(physicalDevice), planeIndex, pDisplayCount,
@@ -790,6 +858,8 @@ VkResult WrappedVulkan::vkGetDisplayModePropertiesKHR(VkPhysicalDevice physicalD
                                                       VkDisplayKHR display, uint32_t *pPropertyCount,
                                                       VkDisplayModePropertiesKHR *pProperties)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // display is not wrapped since we have no need of any data associated with it
   return ObjDisp(physicalDevice)
       ->GetDisplayModePropertiesKHR(Unwrap(physicalDevice), display, pPropertyCount, pProperties);
@@ -800,6 +870,8 @@ VkResult WrappedVulkan::vkCreateDisplayModeKHR(VkPhysicalDevice physicalDevice,
                                                const VkAllocationCallbacks *pAllocator,
                                                VkDisplayModeKHR *pMode)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // we don't wrap the resulting mode since there's no data we need for it
   return ObjDisp(physicalDevice)
       ->CreateDisplayModeKHR(Unwrap(physicalDevice), display, pCreateInfo, pAllocator, pMode);
@@ -809,6 +881,8 @@ VkResult WrappedVulkan::vkGetDisplayPlaneCapabilitiesKHR(VkPhysicalDevice physic
                                                          VkDisplayModeKHR mode, uint32_t planeIndex,
                                                          VkDisplayPlaneCapabilitiesKHR *pCapabilities)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // mode is not wrapped since we have no need of any data associated with it
   return ObjDisp(physicalDevice)
       ->GetDisplayPlaneCapabilitiesKHR(Unwrap(physicalDevice), mode, planeIndex, pCapabilities);
@@ -819,6 +893,8 @@ VkResult WrappedVulkan::vkCreateDisplayPlaneSurfaceKHR(VkInstance instance,
                                                        const VkAllocationCallbacks *pAllocator,
                                                        VkSurfaceKHR *pSurface)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // should not come in here at all on replay
   RDCASSERT(m_State >= WRITING);
 
@@ -855,6 +931,8 @@ VkResult WrappedVulkan::vkCreateSharedSwapchainsKHR(VkDevice device, uint32_t sw
                                                     const VkAllocationCallbacks *pAllocator,
                                                     VkSwapchainKHR *pSwapchains)
 {
+  SCOPED_ENTRY_PROFILE();
+
   VkSwapchainCreateInfoKHR *unwrapped = GetTempArray<VkSwapchainCreateInfoKHR>(swapchainCount);
   for(uint32_t i = 0; i < swapchainCount; i++)
   {
@@ -879,6 +957,8 @@ VkResult WrappedVulkan::vkCreateSharedSwapchainsKHR(VkDevice device, uint32_t sw
 
 VkResult WrappedVulkan::vkReleaseDisplayEXT(VkPhysicalDevice physicalDevice, VkDisplayKHR display)
 {
+  SCOPED_ENTRY_PROFILE();
+
   // displays are not wrapped
   return ObjDisp(physicalDevice)->ReleaseDisplayEXT(Unwrap(physicalDevice), display);
 }
@@ -25,6 +25,7 @@
 
 #include "hooks.h"
 #include "common/common.h"
+#include "common/timing.h"
 
 LibraryHooks &LibraryHooks::GetInstance()
 {
@@ -39,15 +40,25 @@ void LibraryHooks::RegisterHook(const char *libName, LibraryHook *hook)
 
 void LibraryHooks::CreateHooks()
 {
+  PerformanceTimer total;
+
   HOOKS_BEGIN();
   for(auto it = m_Hooks.begin(); it != m_Hooks.end(); ++it)
   {
-    RDCDEBUG("Hooking %s", it->first);
+    PerformanceTimer timer;
 
     if(!it->second->CreateHooks(it->first))
       RDCWARN("Couldn't hook into %s", it->first);
+
+    RDCDEBUG("Hooking %s took %.2f ms", it->first, timer.GetMilliseconds());
   }
+
+  double registerTime = total.GetMilliseconds();
+
   HOOKS_END();
+
+  RDCLOG("Installed hooks in %.2f ms (%.2f ms registering, %.2f ms patching loaded modules)",
+         total.GetMilliseconds(), registerTime, total.GetMilliseconds() - registerTime);
 }
 
 void LibraryHooks::RemoveHooks()
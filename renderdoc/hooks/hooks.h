@@ -46,7 +46,9 @@ public:
   void SetFuncPtr(void *ptr) { orig_funcptr = ptr; }
   bool Initialize(const char *function, const char *module_name, void *destination_function_ptr)
   {
-    orig_funcptr = Process::GetFunctionAddress(Process::LoadModule(module_name), function);
+    // don't load the module just to look up the original. If it isn't loaded yet the pointer is
+    // filled in once it is, see DllHookset::FetchOriginals
+    orig_funcptr = Process::GetFunctionAddress(Process::GetLoadedModule(module_name), function);
 
     return Win32_IAT_Hook(&orig_funcptr, module_name, function, destination_function_ptr);
   }
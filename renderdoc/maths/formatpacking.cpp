@@ -0,0 +1,516 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/common.h"
+#include "formatpacking.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FORMAT_CONVERT_X86 OPTION_ON
+#else
+#define FORMAT_CONVERT_X86 OPTION_OFF
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define FORMAT_CONVERT_NEON OPTION_ON
+#else
+#define FORMAT_CONVERT_NEON OPTION_OFF
+#endif
+
+#if ENABLED(FORMAT_CONVERT_X86)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+
+// MSVC allows any intrinsic in any function
+#define CONVERT_TARGET_SSE2
+#define CONVERT_TARGET_F16C
+
+#else
+
+// only these functions are compiled for the wider instruction sets, they're only called once the
+// CPU has been checked for support
+#define CONVERT_TARGET_SSE2 __attribute__((target("sse2")))
+#define CONVERT_TARGET_F16C __attribute__((target("avx,f16c")))
+
+#endif
+
+#endif    // FORMAT_CONVERT_X86
+
+#if ENABLED(FORMAT_CONVERT_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef void (*FromHalfKernel)(const uint16_t *src, float *dst, size_t count);
+typedef void (*ToHalfKernel)(const float *src, uint16_t *dst, size_t count);
+typedef void (*FromR10G10B10A2Kernel)(const uint32_t *src, Vec4f *dst, size_t count);
+typedef void (*FromR11G11B10Kernel)(const uint32_t *src, Vec3f *dst, size_t count);
+
+// the vectorised kernels all process a fixed number of elements per iteration, then hand the
+// remainder to these
+static void FromHalf_Scalar(const uint16_t *src, float *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    dst[i] = ConvertFromHalf(src[i]);
+}
+
+static void ToHalf_Scalar(const float *src, uint16_t *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    dst[i] = ConvertToHalf(src[i]);
+}
+
+static void FromR10G10B10A2_Scalar(const uint32_t *src, Vec4f *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    dst[i] = ConvertFromR10G10B10A2(src[i]);
+}
+
+static void FromR11G11B10_Scalar(const uint32_t *src, Vec3f *dst, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    dst[i] = ConvertFromR11G11B10(src[i]);
+}
+
+// the half and R11G11B10 kernels below don't go through the float conversion hardware for normal
+// values, they move the exponent and mantissa bits into place the same way the scalar code does.
+// Denormals are exact integer conversions scaled by a power of two, which is also exact.
+
+#if ENABLED(FORMAT_CONVERT_X86)
+
+CONVERT_TARGET_SSE2 static __m128i Select_SSE2(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// takes four halves zero-extended to 32-bits, and returns them as floats. Infinities and NaNs
+// all decode to the same NaN, and negative zero decodes to positive zero, as ConvertFromHalf does
+CONVERT_TARGET_SSE2 static __m128 HalfToFloat_SSE2(__m128i h)
+{
+  const __m128i exponentMask = _mm_set1_epi32(0x7c00);
+
+  __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+  __m128i magnitude = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+  __m128i exponent = _mm_and_si128(h, exponentMask);
+
+  // rebias the exponent from 15 to 127
+  __m128i normal = _mm_add_epi32(_mm_slli_epi32(magnitude, 13), _mm_set1_epi32(112 << 23));
+
+  // subnormals are mantissa * 2^-24
+  __m128 subnormalf = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(h, _mm_set1_epi32(0x3ff))),
+                                 _mm_castsi128_ps(_mm_set1_epi32((127 - 24) << 23)));
+
+  __m128i ret = Select_SSE2(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()),
+                            _mm_castps_si128(subnormalf), normal);
+  ret = _mm_or_si128(ret, sign);
+  ret = Select_SSE2(_mm_cmpeq_epi32(exponent, exponentMask), _mm_set1_epi32(0x7F800001), ret);
+  ret = _mm_andnot_si128(_mm_cmpeq_epi32(magnitude, _mm_setzero_si128()), ret);
+
+  return _mm_castsi128_ps(ret);
+}
+
+CONVERT_TARGET_SSE2 static void FromHalf_SSE2(const uint16_t *src, float *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 8 <= count; i += 8)
+  {
+    __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+
+    _mm_storeu_ps(dst + i, HalfToFloat_SSE2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+    _mm_storeu_ps(dst + i + 4, HalfToFloat_SSE2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+  }
+
+  FromHalf_Scalar(src + i, dst + i, count - i);
+}
+
+CONVERT_TARGET_SSE2 static __m128 UnpackUNorm_SSE2(__m128i v, int shift, int bits)
+{
+  __m128i comp = _mm_srl_epi32(v, _mm_cvtsi32_si128(shift));
+  comp = _mm_and_si128(comp, _mm_set1_epi32((1 << bits) - 1));
+
+  // divide rather than multiply by the reciprocal so that the rounding matches
+  return _mm_div_ps(_mm_cvtepi32_ps(comp), _mm_set1_ps(float((1 << bits) - 1)));
+}
+
+CONVERT_TARGET_SSE2 static void FromR10G10B10A2_SSE2(const uint32_t *src, Vec4f *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+    __m128 r = UnpackUNorm_SSE2(v, 0, 10);
+    __m128 g = UnpackUNorm_SSE2(v, 10, 10);
+    __m128 b = UnpackUNorm_SSE2(v, 20, 10);
+    __m128 a = UnpackUNorm_SSE2(v, 30, 2);
+
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+
+    float *out = &dst[i].x;
+    _mm_storeu_ps(out + 0, r);
+    _mm_storeu_ps(out + 4, g);
+    _mm_storeu_ps(out + 8, b);
+    _mm_storeu_ps(out + 12, a);
+  }
+
+  FromR10G10B10A2_Scalar(src + i, dst + i, count - i);
+}
+
+// decodes one of the unsigned 5-bit exponent floats packed into R11G11B10
+CONVERT_TARGET_SSE2 static __m128 UnpackSmallFloat_SSE2(__m128i v, int shift, int mantissaBits)
+{
+  const __m128i exponentMask = _mm_set1_epi32(0x1f);
+
+  __m128i mantissa = _mm_srl_epi32(v, _mm_cvtsi32_si128(shift));
+  mantissa = _mm_and_si128(mantissa, _mm_set1_epi32((1 << mantissaBits) - 1));
+  __m128i exponent = _mm_srl_epi32(v, _mm_cvtsi32_si128(shift + mantissaBits));
+  exponent = _mm_and_si128(exponent, exponentMask);
+
+  __m128i floatMantissa = _mm_sll_epi32(mantissa, _mm_cvtsi32_si128(23 - mantissaBits));
+
+  __m128i normal =
+      _mm_or_si128(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127 - 15)), 23),
+                   floatMantissa);
+  __m128i special = _mm_or_si128(_mm_set1_epi32(0x7f800000), floatMantissa);
+
+  // denormals (and zero) are mantissa * 2^(-14 - mantissaBits)
+  __m128 denormalf = _mm_mul_ps(
+      _mm_cvtepi32_ps(mantissa), _mm_castsi128_ps(_mm_set1_epi32((127 - 14 - mantissaBits) << 23)));
+
+  __m128i ret = Select_SSE2(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()),
+                            _mm_castps_si128(denormalf), normal);
+  ret = Select_SSE2(_mm_cmpeq_epi32(exponent, exponentMask), special, ret);
+
+  return _mm_castsi128_ps(ret);
+}
+
+CONVERT_TARGET_SSE2 static void FromR11G11B10_SSE2(const uint32_t *src, Vec3f *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+    __m128 r = UnpackSmallFloat_SSE2(v, 0, 6);
+    __m128 g = UnpackSmallFloat_SSE2(v, 11, 6);
+    __m128 b = UnpackSmallFloat_SSE2(v, 22, 5);
+    __m128 unused = _mm_setzero_ps();
+
+    _MM_TRANSPOSE4_PS(r, g, b, unused);
+
+    // each store writes one float past its Vec3f, which the next store overwrites. The last one
+    // is split so nothing past the end of dst is written
+    float *out = &dst[i].x;
+    _mm_storeu_ps(out + 0, r);
+    _mm_storeu_ps(out + 3, g);
+    _mm_storeu_ps(out + 6, b);
+    _mm_storel_pi((__m64 *)(out + 9), unused);
+    _mm_store_ss(out + 11, _mm_movehl_ps(unused, unused));
+  }
+
+  FromR11G11B10_Scalar(src + i, dst + i, count - i);
+}
+
+// the hardware conversion handles infinities, signed zero and NaNs differently to
+// ConvertFromHalf, so those lanes are patched up afterwards to match
+CONVERT_TARGET_F16C static void FromHalf_F16C(const uint16_t *src, float *dst, size_t count)
+{
+  const __m128i exponentMask = _mm_set1_epi32(0x7c00);
+
+  size_t i = 0;
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i h = _mm_loadl_epi64((const __m128i *)(src + i));
+    __m128i h32 = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+
+    __m128i ret = _mm_castps_si128(_mm_cvtph_ps(h));
+
+    ret = Select_SSE2(_mm_cmpeq_epi32(_mm_and_si128(h32, exponentMask), exponentMask),
+                      _mm_set1_epi32(0x7F800001), ret);
+    ret = _mm_andnot_si128(
+        _mm_cmpeq_epi32(_mm_and_si128(h32, _mm_set1_epi32(0x7fff)), _mm_setzero_si128()), ret);
+
+    _mm_storeu_ps(dst + i, _mm_castsi128_ps(ret));
+  }
+
+  FromHalf_Scalar(src + i, dst + i, count - i);
+}
+
+// rounding to nearest even matches ConvertToHalf for every value except NaNs, where the hardware
+// sets the quiet bit. Any group of four containing a NaN is converted with the scalar code
+CONVERT_TARGET_F16C static void ToHalf_F16C(const float *src, uint16_t *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128 f = _mm_loadu_ps(src + i);
+
+    if(_mm_movemask_ps(_mm_cmpunord_ps(f, f)) != 0)
+    {
+      ToHalf_Scalar(src + i, dst + i, 4);
+      continue;
+    }
+
+    _mm_storel_epi64((__m128i *)(dst + i), _mm_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  ToHalf_Scalar(src + i, dst + i, count - i);
+}
+
+#endif    // FORMAT_CONVERT_X86
+
+#if ENABLED(FORMAT_CONVERT_NEON)
+
+// see HalfToFloat_SSE2
+static float32x4_t HalfToFloat_NEON(uint32x4_t h)
+{
+  const uint32x4_t exponentMask = vdupq_n_u32(0x7c00);
+
+  uint32x4_t sign = vshlq_n_u32(vandq_u32(h, vdupq_n_u32(0x8000)), 16);
+  uint32x4_t magnitude = vandq_u32(h, vdupq_n_u32(0x7fff));
+  uint32x4_t exponent = vandq_u32(h, exponentMask);
+
+  uint32x4_t normal = vaddq_u32(vshlq_n_u32(magnitude, 13), vdupq_n_u32(112 << 23));
+
+  float32x4_t subnormalf =
+      vmulq_f32(vcvtq_f32_u32(vandq_u32(h, vdupq_n_u32(0x3ff))),
+                vreinterpretq_f32_u32(vdupq_n_u32((127 - 24) << 23)));
+
+  uint32x4_t ret = vbslq_u32(vceqq_u32(exponent, vdupq_n_u32(0)),
+                             vreinterpretq_u32_f32(subnormalf), normal);
+  ret = vorrq_u32(ret, sign);
+  ret = vbslq_u32(vceqq_u32(exponent, exponentMask), vdupq_n_u32(0x7F800001), ret);
+  ret = vbicq_u32(ret, vceqq_u32(magnitude, vdupq_n_u32(0)));
+
+  return vreinterpretq_f32_u32(ret);
+}
+
+static void FromHalf_NEON(const uint16_t *src, float *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 8 <= count; i += 8)
+  {
+    uint16x8_t h = vld1q_u16(src + i);
+
+    vst1q_f32(dst + i, HalfToFloat_NEON(vmovl_u16(vget_low_u16(h))));
+    vst1q_f32(dst + i + 4, HalfToFloat_NEON(vmovl_u16(vget_high_u16(h))));
+  }
+
+  FromHalf_Scalar(src + i, dst + i, count - i);
+}
+
+// see UnpackSmallFloat_SSE2. Shifts by a negative amount with vshlq are right shifts
+static float32x4_t UnpackSmallFloat_NEON(uint32x4_t v, int shift, int mantissaBits)
+{
+  const uint32x4_t exponentMask = vdupq_n_u32(0x1f);
+
+  uint32x4_t mantissa = vshlq_u32(v, vdupq_n_s32(-shift));
+  mantissa = vandq_u32(mantissa, vdupq_n_u32((1 << mantissaBits) - 1));
+  uint32x4_t exponent = vshlq_u32(v, vdupq_n_s32(-(shift + mantissaBits)));
+  exponent = vandq_u32(exponent, exponentMask);
+
+  uint32x4_t floatMantissa = vshlq_u32(mantissa, vdupq_n_s32(23 - mantissaBits));
+
+  uint32x4_t normal =
+      vorrq_u32(vshlq_n_u32(vaddq_u32(exponent, vdupq_n_u32(127 - 15)), 23), floatMantissa);
+  uint32x4_t special = vorrq_u32(vdupq_n_u32(0x7f800000), floatMantissa);
+
+  float32x4_t denormalf = vmulq_f32(
+      vcvtq_f32_u32(mantissa), vreinterpretq_f32_u32(vdupq_n_u32((127 - 14 - mantissaBits) << 23)));
+
+  uint32x4_t ret =
+      vbslq_u32(vceqq_u32(exponent, vdupq_n_u32(0)), vreinterpretq_u32_f32(denormalf), normal);
+  ret = vbslq_u32(vceqq_u32(exponent, exponentMask), special, ret);
+
+  return vreinterpretq_f32_u32(ret);
+}
+
+static void FromR11G11B10_NEON(const uint32_t *src, Vec3f *dst, size_t count)
+{
+  size_t i = 0;
+
+  for(; i + 4 <= count; i += 4)
+  {
+    uint32x4_t v = vld1q_u32(src + i);
+
+    float32x4x3_t rgb;
+    rgb.val[0] = UnpackSmallFloat_NEON(v, 0, 6);
+    rgb.val[1] = UnpackSmallFloat_NEON(v, 11, 6);
+    rgb.val[2] = UnpackSmallFloat_NEON(v, 22, 5);
+
+    // interleaving store, writes exactly four Vec3fs
+    vst3q_f32(&dst[i].x, rgb);
+  }
+
+  FromR11G11B10_Scalar(src + i, dst + i, count - i);
+}
+
+#endif    // FORMAT_CONVERT_NEON
+
+struct FormatConvertKernels
+{
+  FromHalfKernel fromHalf;
+  ToHalfKernel toHalf;
+  FromR10G10B10A2Kernel fromR10G10B10A2;
+  FromR11G11B10Kernel fromR11G11B10;
+};
+
+static FormatConvertKernels GetFormatConvertKernels(FormatConvertImpl impl)
+{
+  FormatConvertKernels ret = {&FromHalf_Scalar, &ToHalf_Scalar, &FromR10G10B10A2_Scalar,
+                              &FromR11G11B10_Scalar};
+
+  switch(impl)
+  {
+#if ENABLED(FORMAT_CONVERT_X86)
+    case eFormatConvert_F16C:
+    case eFormatConvert_SSE2:
+    {
+      if(!CPUSupportsSSE2())
+        break;
+
+      ret.fromHalf = &FromHalf_SSE2;
+      ret.fromR10G10B10A2 = &FromR10G10B10A2_SSE2;
+      ret.fromR11G11B10 = &FromR11G11B10_SSE2;
+
+      // F16C only adds the half conversions, the rest come from SSE2
+      if(impl == eFormatConvert_F16C && CPUSupportsF16C())
+      {
+        ret.fromHalf = &FromHalf_F16C;
+        ret.toHalf = &ToHalf_F16C;
+      }
+      break;
+    }
+#endif
+#if ENABLED(FORMAT_CONVERT_NEON)
+    case eFormatConvert_NEON:
+    {
+      ret.fromHalf = &FromHalf_NEON;
+      ret.fromR11G11B10 = &FromR11G11B10_NEON;
+      break;
+    }
+#endif
+    default: break;
+  }
+
+  return ret;
+}
+
+bool FormatConvertImplSupported(FormatConvertImpl impl)
+{
+  switch(impl)
+  {
+    case eFormatConvert_Scalar: return true;
+#if ENABLED(FORMAT_CONVERT_X86)
+    case eFormatConvert_SSE2: return CPUSupportsSSE2();
+    case eFormatConvert_F16C: return CPUSupportsSSE2() && CPUSupportsF16C();
+#endif
+#if ENABLED(FORMAT_CONVERT_NEON)
+    case eFormatConvert_NEON: return true;
+#endif
+    default: break;
+  }
+
+  return false;
+}
+
+const char *FormatConvertImplName(FormatConvertImpl impl)
+{
+  switch(impl)
+  {
+    case eFormatConvert_Scalar: return "scalar";
+    case eFormatConvert_SSE2: return "sse2";
+    case eFormatConvert_F16C: return "f16c";
+    case eFormatConvert_NEON: return "neon";
+    default: break;
+  }
+
+  return "unknown";
+}
+
+static const FormatConvertKernels &GetBestFormatConvertKernels()
+{
+  static FormatConvertKernels best = {};
+
+  // a race here is harmless, every thread picks the same kernels
+  if(best.fromHalf == NULL)
+  {
+    for(int i = eFormatConvert_Count - 1; i >= eFormatConvert_Scalar; i--)
+    {
+      if(FormatConvertImplSupported((FormatConvertImpl)i))
+      {
+        best = GetFormatConvertKernels((FormatConvertImpl)i);
+        break;
+      }
+    }
+  }
+
+  return best;
+}
+
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count)
+{
+  GetBestFormatConvertKernels().fromHalf(src, dst, count);
+}
+
+void ConvertToHalf(const float *src, uint16_t *dst, size_t count)
+{
+  GetBestFormatConvertKernels().toHalf(src, dst, count);
+}
+
+void ConvertFromR10G10B10A2(const uint32_t *src, Vec4f *dst, size_t count)
+{
+  GetBestFormatConvertKernels().fromR10G10B10A2(src, dst, count);
+}
+
+void ConvertFromR11G11B10(const uint32_t *src, Vec3f *dst, size_t count)
+{
+  GetBestFormatConvertKernels().fromR11G11B10(src, dst, count);
+}
+
+void ConvertFromHalf(FormatConvertImpl impl, const uint16_t *src, float *dst, size_t count)
+{
+  GetFormatConvertKernels(impl).fromHalf(src, dst, count);
+}
+
+void ConvertToHalf(FormatConvertImpl impl, const float *src, uint16_t *dst, size_t count)
+{
+  GetFormatConvertKernels(impl).toHalf(src, dst, count);
+}
+
+void ConvertFromR10G10B10A2(FormatConvertImpl impl, const uint32_t *src, Vec4f *dst, size_t count)
+{
+  GetFormatConvertKernels(impl).fromR10G10B10A2(src, dst, count);
+}
+
+void ConvertFromR11G11B10(FormatConvertImpl impl, const uint32_t *src, Vec3f *dst, size_t count)
+{
+  GetFormatConvertKernels(impl).fromR11G11B10(src, dst, count);
+}
@@ -61,6 +61,8 @@ inline Vec3f ConvertFromR11G11B10(uint32_t data)
   // R11G11B10 has 6/6/5 bit mantissas, 5bit exponents
 
   const int mantissaShift[] = {23 - 6, 23 - 6, 23 - 5};
+  // the implicit leading bit of each mantissa, once a denormal has been normalised
+  const uint32_t hiddenBit[] = {0x40, 0x40, 0x20};
 
   for(int i = 0; i < 3; i++)
   {
@@ -87,14 +89,14 @@ inline Vec3f ConvertFromR11G11B10(uint32_t data)
         exponents[i] = 1;
 
         // shift until hidden bit is set
-        while((mantissas[i] & 0x40) == 0)
+        while((mantissas[i] & hiddenBit[i]) == 0)
         {
           mantissas[i] <<= 1;
           exponents[i]--;
         }
 
         // remove the hidden bit
-        mantissas[i] &= ~0x40;
+        mantissas[i] &= ~hiddenBit[i];
 
         retu[i] = (exponents[i] + (127 - 15)) << 23 | mantissas[i] << mantissaShift[i];
       }
@@ -140,3 +142,30 @@ struct ResourceFormat;
 float ConvertComponent(const ResourceFormat &fmt, byte *data);
 
 #include "half_convert.h"
+
+// batch versions of the conversions above for contiguous arrays, using the widest SIMD kernels
+// the CPU supports. The results are bit-identical to converting each element one at a time
+void ConvertFromHalf(const uint16_t *src, float *dst, size_t count);
+void ConvertToHalf(const float *src, uint16_t *dst, size_t count);
+void ConvertFromR10G10B10A2(const uint32_t *src, Vec4f *dst, size_t count);
+void ConvertFromR11G11B10(const uint32_t *src, Vec3f *dst, size_t count);
+
+enum FormatConvertImpl
+{
+  eFormatConvert_Scalar,
+  eFormatConvert_SSE2,
+  eFormatConvert_F16C,
+  eFormatConvert_NEON,
+  eFormatConvert_Count,
+};
+
+bool FormatConvertImplSupported(FormatConvertImpl impl);
+const char *FormatConvertImplName(FormatConvertImpl impl);
+
+// as above with one implementation, for benchmarking. Kernels that an implementation doesn't
+// have, or that the CPU doesn't support, fall back to the next best one
+void ConvertFromHalf(FormatConvertImpl impl, const uint16_t *src, float *dst, size_t count);
+void ConvertToHalf(FormatConvertImpl impl, const float *src, uint16_t *dst, size_t count);
+void ConvertFromR10G10B10A2(FormatConvertImpl impl, const uint32_t *src, Vec4f *dst,
+                            size_t count);
+void ConvertFromR11G11B10(FormatConvertImpl impl, const uint32_t *src, Vec3f *dst, size_t count);
@@ -25,6 +25,8 @@
 
 #include "os/os_specific.h"
 #include <stdarg.h>
+#include <string.h>
+#include "common/threading.h"
 #include "serialise/string_utils.h"
 
 using std::string;
@@ -192,3 +194,221 @@ string OSUtility::MakeMachineIdentString(uint64_t ident)
 
   return ret;
 }
+
+namespace WriteWatch
+{
+enum
+{
+  WatchFree = 0,
+  WatchActive,
+};
+
+// a fixed table so that the fault handler can search it without locking. Ranges are only added
+// and removed under watchLock, the handler marks itself as a user of a range while it looks at it
+// so that End can wait for it before freeing anything.
+struct WatchedRange
+{
+  volatile int32_t state;
+  volatile int32_t users;
+  byte *base;
+  size_t size;
+  size_t pageSize;
+  size_t numPages;
+  volatile int32_t *dirty;
+};
+
+static const size_t MaxWatchedRanges = 256;
+static WatchedRange watchedRanges[MaxWatchedRanges] = {};
+static Threading::CriticalSection watchLock;
+static bool handlerInstalled = false;
+
+static bool WriteFault(void *addr)
+{
+  byte *ptr = (byte *)addr;
+
+  for(size_t i = 0; i < MaxWatchedRanges; i++)
+  {
+    WatchedRange &range = watchedRanges[i];
+
+    Atomic::Inc32(&range.users);
+
+    if(range.state == WatchActive && ptr >= range.base && ptr < range.base + range.size)
+    {
+      size_t page = size_t(ptr - range.base) / range.pageSize;
+      byte *pageBase = range.base + page * range.pageSize;
+
+      // the page must be writable before it's marked dirty, see GetDirtyPages
+      bool ret = VirtualMemory::SetWritable(pageBase, range.pageSize, true);
+      range.dirty[page] = 1;
+
+      Atomic::Dec32(&range.users);
+      return ret;
+    }
+
+    Atomic::Dec32(&range.users);
+  }
+
+  return false;
+}
+
+uint64_t Begin(void *ptr, size_t size)
+{
+  size_t pageSize = VirtualMemory::GetPageSize();
+
+  if(ptr == NULL || size == 0 || (uintptr_t(ptr) & (pageSize - 1)) != 0)
+    return 0;
+
+  SCOPED_LOCK(watchLock);
+
+  for(size_t i = 0; i < MaxWatchedRanges; i++)
+  {
+    WatchedRange &range = watchedRanges[i];
+
+    if(range.state != WatchFree)
+      continue;
+
+    if(!handlerInstalled)
+    {
+      VirtualMemory::SetWriteFaultCallback(&WriteFault);
+      handlerInstalled = true;
+    }
+
+    range.base = (byte *)ptr;
+    range.size = size;
+    range.pageSize = pageSize;
+    range.numPages = (size + pageSize - 1) / pageSize;
+    range.dirty = new int32_t[range.numPages];
+    memset((void *)range.dirty, 0, range.numPages * sizeof(int32_t));
+
+    // must be findable by the handler before any page faults
+    Atomic::CmpExch32(&range.state, WatchFree, WatchActive);
+
+    if(!VirtualMemory::SetWritable(ptr, size, false))
+    {
+      RDCWARN("Couldn't write-protect %p (%llu bytes) to track writes", ptr, (uint64_t)size);
+      VirtualMemory::SetWritable(ptr, size, true);
+
+      Atomic::CmpExch32(&range.state, WatchActive, WatchFree);
+      while(range.users > 0)
+        Threading::Sleep(0);
+
+      delete[] range.dirty;
+      range.dirty = NULL;
+      return 0;
+    }
+
+    return uint64_t(i + 1);
+  }
+
+  RDCWARN("Too many ranges being tracked for writes, not tracking %p", ptr);
+  return 0;
+}
+
+void GetDirtyPages(uint64_t watch, std::vector<bool> &dirty)
+{
+  dirty.clear();
+
+  if(watch == 0 || watch > MaxWatchedRanges)
+    return;
+
+  WatchedRange &range = watchedRanges[watch - 1];
+
+  dirty.resize(range.numPages, false);
+
+  // clear every flag before protecting the pages. A write that lands in between goes to a page that
+  // is still writable, so it's in the contents the caller reads afterwards. A write after the page
+  // is protected faults and sets the flag again for next time. The fault handler makes the page
+  // writable before setting the flag, so either order of the two is caught by one or the other.
+  for(size_t p = 0; p < range.numPages; p++)
+    if(range.dirty[p] && Atomic::CmpExch32(&range.dirty[p], 1, 0) == 1)
+      dirty[p] = true;
+
+  for(size_t p = 0; p < range.numPages;)
+  {
+    if(!dirty[p])
+    {
+      p++;
+      continue;
+    }
+
+    size_t end = p + 1;
+    while(end < range.numPages && dirty[end])
+      end++;
+
+    VirtualMemory::SetWritable(range.base + p * range.pageSize, (end - p) * range.pageSize, false);
+
+    p = end;
+  }
+}
+
+size_t GetPageSize(uint64_t watch)
+{
+  if(watch == 0 || watch > MaxWatchedRanges)
+    return 0;
+
+  return watchedRanges[watch - 1].pageSize;
+}
+
+void FindModifiedRanges(uint64_t watch, void *data, void *ref, size_t size,
+                        std::vector<std::pair<size_t, size_t> > &ranges)
+{
+  std::vector<bool> dirty;
+  GetDirtyPages(watch, dirty);
+
+  size_t pageSize = GetPageSize(watch);
+
+  byte *a = (byte *)data;
+  byte *b = (byte *)ref;
+
+  // only pages written since the last call can differ, so compare each run of them on its own
+  for(size_t p = 0; p < dirty.size();)
+  {
+    if(!dirty[p])
+    {
+      p++;
+      continue;
+    }
+
+    size_t end = p + 1;
+    while(end < dirty.size() && dirty[end])
+      end++;
+
+    size_t start = p * pageSize;
+
+    if(start >= size)
+      break;
+
+    size_t len = RDCMIN(size, end * pageSize) - start;
+
+    size_t diffStart = 0, diffEnd = 0;
+    if(FindDiffRange(a + start, b + start, len, diffStart, diffEnd))
+      ranges.push_back(std::make_pair(start + diffStart, start + diffEnd));
+
+    p = end;
+  }
+}
+
+void End(uint64_t watch)
+{
+  if(watch == 0 || watch > MaxWatchedRanges)
+    return;
+
+  SCOPED_LOCK(watchLock);
+
+  WatchedRange &range = watchedRanges[watch - 1];
+
+  if(range.state != WatchActive)
+    return;
+
+  VirtualMemory::SetWritable(range.base, range.size, true);
+
+  Atomic::CmpExch32(&range.state, WatchActive, WatchFree);
+
+  // wait for any handler still looking at this range
+  while(range.users > 0)
+    Threading::Sleep(0);
+
+  delete[] range.dirty;
+  range.dirty = NULL;
+}
+};
@@ -93,6 +93,8 @@ uint32_t LaunchAndInjectIntoProcess(const char *app, const char *workingDir, con
                                     EnvironmentModification *env, const char *logfile,
                                     const CaptureOptions *opts, bool waitForExit);
 void *LoadModule(const char *module);
+// returns the module if it's already loaded, without loading it
+void *GetLoadedModule(const char *module);
 void *GetFunctionAddress(void *module, const char *function);
 uint32_t GetCurrentPID();
 };
@@ -117,6 +119,9 @@ public:
   void Unlock();
 
 private:
+  template <class, class>
+  friend class ConditionVariableTemplate;
+
   // no copying
   CriticalSectionTemplate &operator=(const CriticalSectionTemplate &other);
   CriticalSectionTemplate(const CriticalSectionTemplate &other);
@@ -124,14 +129,69 @@ private:
   data m_Data;
 };
 
+// waits on a CriticalSection, which the calling thread must hold exactly once - the recursive
+// count isn't released by the wait. As usual, wakeups can be spurious so the condition being
+// waited for must be re-checked under the lock.
+template <class data, class lockdata>
+class ConditionVariableTemplate
+{
+public:
+  ConditionVariableTemplate();
+  ~ConditionVariableTemplate();
+  void Wait(CriticalSectionTemplate<lockdata> &cs);
+  // returns false if the timeout passed without being woken
+  bool Wait(CriticalSectionTemplate<lockdata> &cs, uint32_t milliseconds);
+  void Signal();
+  void Broadcast();
+
+private:
+  // no copying
+  ConditionVariableTemplate &operator=(const ConditionVariableTemplate &other);
+  ConditionVariableTemplate(const ConditionVariableTemplate &other);
+
+  data m_Data;
+};
+
+// many readers or one writer. Unlike CriticalSection this is not recursive - a thread holding
+// either lock must not try to take it again, in either mode.
+template <class data>
+class RWLockTemplate
+{
+public:
+  RWLockTemplate();
+  ~RWLockTemplate();
+  void ReadLock();
+  void ReadUnlock();
+  void WriteLock();
+  void WriteUnlock();
+
+private:
+  // no copying
+  RWLockTemplate &operator=(const RWLockTemplate &other);
+  RWLockTemplate(const RWLockTemplate &other);
+
+  data m_Data;
+};
+
 void Init();
 void Shutdown();
 uint64_t AllocateTLSSlot();
 
+// the destructor is called on a thread as it exits, with its value in the slot if that isn't NULL.
+// Must only be used after Init().
+typedef void (*TLSDestructor)(void *value);
+uint64_t AllocateTLSSlot(TLSDestructor destructor);
+
+// runs the TLS destructors for the calling thread. Only needed on platforms that don't tell us
+// when threads exit, i.e. from DllMain on windows.
+void DetachThread();
+
 void *GetTLSValue(uint64_t slot);
 void SetTLSValue(uint64_t slot, void *value);
 
 // must typedef CriticalSectionTemplate<X> CriticalSection
+// must typedef RWLockTemplate<X> RWLock
+// must typedef ConditionVariableTemplate<X, Y> ConditionVariable, with the CriticalSection's Y
 
 typedef void (*ThreadEntry)(void *);
 typedef uint64_t ThreadHandle;
@@ -141,6 +201,9 @@ void JoinThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// number of logical processors available, always at least 1
+uint32_t GetNumberOfCores();
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -167,6 +230,10 @@ public:
   bool SendDataBlocking(const void *buf, uint32_t length);
   bool RecvDataBlocking(void *data, uint32_t length);
 
+  // sends length bytes from the file starting at offset, without going through a user buffer
+  // where the platform allows. The file's own read position is not preserved.
+  bool SendFileBlocking(FILE *f, uint64_t offset, uint32_t length);
+
 private:
   ptrdiff_t socket;
 };
@@ -211,6 +278,10 @@ int64_t Inc64(volatile int64_t *i);
 int64_t Dec64(volatile int64_t *i);
 int64_t ExchAdd64(volatile int64_t *i, int64_t a);
 int32_t CmpExch32(volatile int32_t *dest, int32_t oldVal, int32_t newVal);
+// plain loads and stores with acquire/release ordering, for publishing data without a locked
+// read-modify-write on every read
+int32_t LoadAcquire32(volatile int32_t *i);
+void StoreRelease32(volatile int32_t *i, int32_t val);
 };
 
 namespace Callstack
@@ -240,6 +311,15 @@ class StackResolver
 public:
   virtual ~StackResolver() {}
   virtual AddressDetails GetAddr(uint64_t addr) = 0;
+
+  // resolves many addresses at once. Resolvers that can batch or parallelise lookups override
+  // this, by default it's the same as looking up each address in turn.
+  virtual void GetAddrs(const vector<uint64_t> &addrs, vector<AddressDetails> &details)
+  {
+    details.resize(addrs.size());
+    for(size_t i = 0; i < addrs.size(); i++)
+      details[i] = GetAddr(addrs[i]);
+  }
 };
 
 void Init();
@@ -309,6 +389,13 @@ bool feof(FILE *f);
 
 int fclose(FILE *f);
 
+// maps a range of an open file into memory, with pages loaded on demand as they're touched. The
+// view is copy-on-write so it can be modified, but changes never reach the file. Returns NULL on
+// failure (e.g. not enough address space), in which case the caller should fall back to reading.
+// The view stays valid after the FILE is closed, until it's unmapped.
+void *MapFileRange(FILE *f, uint64_t offset, uint64_t length, void **mappingHandle);
+void UnmapFileRange(void *mappingHandle);
+
 // functions for atomically appending to a log that may be in use in multiple
 // processes
 void *logfile_open(const char *filename);
@@ -378,6 +465,52 @@ string Fmt(const char *format, ...);
 int Wide2UTF8(wchar_t chr, char mbchr[4]);
 };
 
+// reserving address space up front and committing it in pieces, so that something growing on
+// demand stays in one contiguous range
+namespace VirtualMemory
+{
+size_t GetPageSize();
+// reserves size bytes without backing them. If largePages is set the range is backed by large
+// pages where the OS allows it when committed. Returns NULL on failure
+void *Reserve(size_t size, bool largePages);
+// makes a range within a reservation readable and writable. The range is expanded to the pages it
+// touches, and committing pages that are already committed is fine
+bool Commit(void *ptr, size_t size);
+void Release(void *ptr, size_t size);
+
+// changes whether a range of pages, which is expanded to the pages it touches, can be written.
+// Returns false if the OS refuses, e.g. for memory owned by a driver that doesn't allow it
+bool SetWritable(void *ptr, size_t size, bool writable);
+
+// installs a process-wide handler for writes to pages that aren't writable. The callback gets the
+// faulting address and returns true if it made the address writable, otherwise the fault is passed
+// on to whichever handler was there before. It runs inside the fault, so it must not lock or
+// allocate
+typedef bool (*WriteFaultCallback)(void *addr);
+void SetWriteFaultCallback(WriteFaultCallback callback);
+};
+
+// tracks which pages of memory are written, for memory the OS can't report on by itself. Pages are
+// write-protected and the first write to each is caught and recorded. Writes made by the OS into a
+// protected page, like a read() from a file, fail instead of being caught.
+namespace WriteWatch
+{
+// starts tracking [ptr, ptr+size), ptr must be page aligned. Returns 0 if the range can't be
+// tracked
+uint64_t Begin(void *ptr, size_t size);
+// returns one entry per page, true for those written since Begin or the previous call. Those pages
+// are protected again before returning, so any write that doesn't show up in their contents when
+// read afterwards is reported by the next call instead.
+void GetDirtyPages(uint64_t watch, std::vector<bool> &dirty);
+size_t GetPageSize(uint64_t watch);
+// compares only the pages of a watched range written since the last call against a reference copy
+// of the same size, appending [start, end) byte ranges that differ. The reference is not updated
+void FindModifiedRanges(uint64_t watch, void *data, void *ref, size_t size,
+                        std::vector<std::pair<size_t, size_t> > &ranges);
+// stops tracking and makes the range writable again. 0 is ignored
+void End(uint64_t watch);
+};
+
 namespace OSUtility
 {
 inline void ForceCrash();
@@ -434,6 +567,8 @@ inline uint32_t CountLeadingZeroes(uint32_t value);
 #if ENABLED(RDOC_X64)
 inline uint64_t CountLeadingZeroes(uint64_t value);
 #endif
+// value must be non-zero
+inline uint32_t CountTrailingZeroes(uint64_t value);
 };
 
 // must #define:
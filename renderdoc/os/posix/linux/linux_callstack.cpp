@@ -154,6 +154,113 @@ struct LookupModule
   char path[2048];
 };
 
+static Callstack::AddressDetails UnknownAddress(uint64_t addr)
+{
+  Callstack::AddressDetails ret;
+
+  ret.filename = "Unknown";
+  ret.line = 0;
+  ret.function = StringFormat::Fmt("0x%08llx", addr);
+
+  return ret;
+}
+
+// addr2line prints two lines per address, the function and then file:line
+static void ParseAddr2Line(char *function, char *fileline, Callstack::AddressDetails &ret)
+{
+  char *newline = strchr(function, '\n');
+  if(newline)
+    *newline = 0;
+
+  ret.function = function;
+
+  if(fileline == NULL)
+    return;
+
+  newline = strchr(fileline, '\n');
+  if(newline)
+    *newline = 0;
+
+  if(fileline[0] == 0)
+    return;
+
+  char *last = fileline + strlen(fileline) - 1;
+  uint32_t mul = 1;
+  ret.line = 0;
+  while(last >= fileline && *last >= '0' && *last <= '9')
+  {
+    ret.line += mul * (uint32_t(*last) - uint32_t('0'));
+    *last = 0;
+    last--;
+    mul *= 10;
+  }
+  if(last >= fileline && *last == ':')
+    *last = 0;
+
+  ret.filename = fileline;
+}
+
+struct ModuleLookup
+{
+  const LookupModule *module;
+  vector<uint64_t> addrs;
+  vector<Callstack::AddressDetails> details;
+};
+
+struct ModuleLookupQueue
+{
+  vector<ModuleLookup> *lookups;
+  volatile int32_t next;
+};
+
+static void ResolveModuleAddrs(ModuleLookup &lookup)
+{
+  // addr2line takes any number of addresses, but keep the command line to a sensible length
+  const size_t batchSize = 128;
+
+  for(size_t start = 0; start < lookup.addrs.size(); start += batchSize)
+  {
+    size_t end = RDCMIN(start + batchSize, lookup.addrs.size());
+
+    string cmd = StringFormat::Fmt("addr2line -j.text -fCe \"%s\"", lookup.module->path);
+    for(size_t i = start; i < end; i++)
+      cmd += StringFormat::Fmt(" 0x%llx", lookup.addrs[i] - lookup.module->base);
+
+    FILE *f = ::popen(cmd.c_str(), "r");
+
+    if(f == NULL)
+      continue;
+
+    for(size_t i = start; i < end; i++)
+    {
+      char function[4096] = {0};
+      char fileline[4096] = {0};
+
+      if(!fgets(function, sizeof(function) - 1, f) || !fgets(fileline, sizeof(fileline) - 1, f))
+        break;
+
+      ParseAddr2Line(function, fileline, lookup.details[i]);
+    }
+
+    ::pclose(f);
+  }
+}
+
+static void ResolveModuleThread(void *param)
+{
+  ModuleLookupQueue *queue = (ModuleLookupQueue *)param;
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(&queue->next) - 1;
+
+    if(idx >= (int32_t)queue->lookups->size())
+      break;
+
+    ResolveModuleAddrs((*queue->lookups)[idx]);
+  }
+}
+
 class LinuxResolver : public Callstack::StackResolver
 {
 public:
@@ -165,65 +272,96 @@ public:
     return m_Cache[addr];
   }
 
-private:
-  void EnsureCached(uint64_t addr)
+  void GetAddrs(const vector<uint64_t> &addrs, vector<Callstack::AddressDetails> &details)
   {
-    auto it = m_Cache.insert(
-        std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
-    if(!it.second)
-      return;
+    vector<ModuleLookup> lookups;
+    std::map<size_t, size_t> moduleLookup;
 
-    Callstack::AddressDetails &ret = it.first->second;
+    // group every address we haven't seen by the module it's in, so each module only needs a
+    // handful of addr2line runs
+    for(size_t i = 0; i < addrs.size(); i++)
+    {
+      uint64_t addr = addrs[i];
 
-    ret.filename = "Unknown";
-    ret.line = 0;
-    ret.function = StringFormat::Fmt("0x%08llx", addr);
+      if(!m_Cache.insert(std::make_pair(addr, UnknownAddress(addr))).second)
+        continue;
 
-    for(size_t i = 0; i < m_Modules.size(); i++)
+      size_t mod = FindModule(addr);
+
+      if(mod == m_Modules.size())
+        continue;
+
+      auto it = moduleLookup.find(mod);
+      if(it == moduleLookup.end())
+      {
+        it = moduleLookup.insert(std::make_pair(mod, lookups.size())).first;
+        lookups.push_back(ModuleLookup());
+        lookups.back().module = &m_Modules[mod];
+      }
+
+      ModuleLookup &lookup = lookups[it->second];
+      lookup.addrs.push_back(addr);
+      lookup.details.push_back(UnknownAddress(addr));
+    }
+
+    if(!lookups.empty())
     {
-      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+      // the modules are independent, so resolve several at once
+      const size_t maxThreads = 8;
+
+      ModuleLookupQueue queue;
+      queue.lookups = &lookups;
+      queue.next = 0;
+
+      vector<Threading::ThreadHandle> threads;
+      for(size_t i = 0; i < RDCMIN(maxThreads, lookups.size()); i++)
+        threads.push_back(Threading::CreateThread(&ResolveModuleThread, &queue));
+
+      for(size_t i = 0; i < threads.size(); i++)
       {
-        uint64_t relative = addr - m_Modules[i].base;
-        string cmd =
-            StringFormat::Fmt("addr2line -j.text -fCe \"%s\" 0x%llx", m_Modules[i].path, relative);
+        Threading::JoinThread(threads[i]);
+        Threading::CloseThread(threads[i]);
+      }
+
+      for(size_t l = 0; l < lookups.size(); l++)
+        for(size_t i = 0; i < lookups[l].addrs.size(); i++)
+          m_Cache[lookups[l].addrs[i]] = lookups[l].details[i];
+    }
 
-        FILE *f = ::popen(cmd.c_str(), "r");
+    details.resize(addrs.size());
+    for(size_t i = 0; i < addrs.size(); i++)
+      details[i] = m_Cache[addrs[i]];
+  }
 
-        char result[2048] = {0};
-        fread(result, 1, 2047, f);
+private:
+  size_t FindModule(uint64_t addr)
+  {
+    for(size_t i = 0; i < m_Modules.size(); i++)
+      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+        return i;
 
-        fclose(f);
+    return m_Modules.size();
+  }
 
-        char *line2 = strchr(result, '\n');
-        if(line2)
-        {
-          *line2 = 0;
-          line2++;
-        }
+  void EnsureCached(uint64_t addr)
+  {
+    auto it = m_Cache.insert(std::make_pair(addr, UnknownAddress(addr)));
+    if(!it.second)
+      return;
 
-        ret.function = result;
+    size_t mod = FindModule(addr);
 
-        if(line2)
-        {
-          char *last = line2 + strlen(line2) - 1;
-          uint32_t mul = 1;
-          ret.line = 0;
-          while(*last >= '0' && *last <= '9')
-          {
-            ret.line += mul * (uint32_t(*last) - uint32_t('0'));
-            *last = 0;
-            last--;
-            mul *= 10;
-          }
-          if(*last == ':')
-            *last = 0;
+    if(mod == m_Modules.size())
+      return;
 
-          ret.filename = line2;
-        }
+    ModuleLookup lookup;
+    lookup.module = &m_Modules[mod];
+    lookup.addrs.push_back(addr);
+    lookup.details.push_back(it.first->second);
 
-        break;
-      }
-    }
+    ResolveModuleAddrs(lookup);
+
+    it.first->second = lookup.details[0];
   }
 
   std::vector<LookupModule> m_Modules;
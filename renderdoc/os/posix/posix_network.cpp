@@ -32,6 +32,9 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 #include <unistd.h>
 #include <string>
 #include "os/os_specific.h"
@@ -41,6 +44,19 @@ using std::string;
 
 namespace Network
 {
+static void SetSocketBufferSizes(int s)
+{
+#if defined(__linux__)
+  // linux auto-tunes socket buffers to the link, and setting them explicitly would disable that
+  (void)s;
+#else
+  // large buffers let a single connection fill links with a high bandwidth-delay product
+  int size = 4 * 1024 * 1024;
+  setsockopt(s, SOL_SOCKET, SO_SNDBUF, (char *)&size, sizeof(size));
+  setsockopt(s, SOL_SOCKET, SO_RCVBUF, (char *)&size, sizeof(size));
+#endif
+}
+
 void Init()
 {
 }
@@ -93,6 +109,8 @@ Socket *Socket::AcceptClient(bool wait)
       int nodelay = 1;
       setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&nodelay, sizeof(nodelay));
 
+      SetSocketBufferSizes(s);
+
       return new Socket((ptrdiff_t)s);
     }
 
@@ -154,6 +172,93 @@ bool Socket::SendDataBlocking(const void *buf, uint32_t length)
   return true;
 }
 
+bool Socket::SendFileBlocking(FILE *f, uint64_t offset, uint32_t length)
+{
+  if(length == 0)
+    return true;
+
+  int fd = fileno(f);
+
+#if defined(__linux__)
+  int flags = fcntl(socket, F_GETFL, 0);
+  fcntl(socket, F_SETFL, flags & ~O_NONBLOCK);
+
+  uint32_t sent = 0;
+
+  while(sent < length)
+  {
+    off_t offs = off_t(offset + sent);
+    ssize_t ret = sendfile((int)socket, fd, &offs, length - sent);
+
+    if(ret < 0)
+    {
+      int err = errno;
+
+      if(err == EWOULDBLOCK || err == EAGAIN || err == EINTR)
+        continue;
+
+      // not every file supports sendfile, so send the rest by reading it below
+      if(err == EINVAL || err == ENOSYS)
+        break;
+
+      RDCWARN("sendfile: %d", err);
+      Shutdown();
+      return false;
+    }
+
+    if(ret == 0)
+    {
+      RDCWARN("sendfile: unexpected end of file");
+      Shutdown();
+      return false;
+    }
+
+    sent += (uint32_t)ret;
+  }
+
+  flags = fcntl(socket, F_GETFL, 0);
+  fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+
+  if(sent == length)
+    return true;
+
+  offset += sent;
+  length -= sent;
+#endif
+
+  const uint32_t bufSize = 256 * 1024;
+  byte *buf = new byte[RDCMIN(bufSize, length)];
+
+  bool success = true;
+
+  while(length > 0)
+  {
+    uint32_t len = RDCMIN(bufSize, length);
+
+    ssize_t ret = pread(fd, buf, len, off_t(offset));
+
+    if(ret <= 0)
+    {
+      RDCWARN("pread: %d", errno);
+      success = false;
+      break;
+    }
+
+    if(!SendDataBlocking(buf, (uint32_t)ret))
+    {
+      success = false;
+      break;
+    }
+
+    offset += (uint64_t)ret;
+    length -= (uint32_t)ret;
+  }
+
+  delete[] buf;
+
+  return success;
+}
+
 bool Socket::IsRecvDataWaiting()
 {
   char dummy;
@@ -331,6 +436,8 @@ Socket *CreateClientSocket(const char *host, uint16_t port, int timeoutMS)
     int nodelay = 1;
     setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&nodelay, sizeof(nodelay));
 
+    SetSocketBufferSizes(s);
+
     return new Socket((ptrdiff_t)s);
   }
 
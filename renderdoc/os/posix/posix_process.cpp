@@ -26,8 +26,10 @@
 #include <errno.h>
 #include <limits.h>
 #include <pwd.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -618,6 +620,11 @@ void *Process::LoadModule(const char *module)
   return dlopen(module, RTLD_NOW);
 }
 
+void *Process::GetLoadedModule(const char *module)
+{
+  return dlopen(module, RTLD_NOW | RTLD_NOLOAD);
+}
+
 void *Process::GetFunctionAddress(void *module, const char *function)
 {
   if(module == NULL)
@@ -630,3 +637,98 @@ uint32_t Process::GetCurrentPID()
 {
   return (uint32_t)getpid();
 }
+
+size_t VirtualMemory::GetPageSize()
+{
+  return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+void *VirtualMemory::Reserve(size_t size, bool largePages)
+{
+  void *ret = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  if(ret == MAP_FAILED)
+    return NULL;
+
+#if defined(MADV_HUGEPAGE)
+  // only a hint - transparent huge pages will back what's committed if they're enabled
+  if(largePages)
+    madvise(ret, size, MADV_HUGEPAGE);
+#endif
+
+  return ret;
+}
+
+bool VirtualMemory::Commit(void *ptr, size_t size)
+{
+  size_t pageSize = GetPageSize();
+  uintptr_t start = uintptr_t(ptr) & ~(pageSize - 1);
+  uintptr_t end = (uintptr_t(ptr) + size + pageSize - 1) & ~(pageSize - 1);
+
+  return mprotect((void *)start, end - start, PROT_READ | PROT_WRITE) == 0;
+}
+
+void VirtualMemory::Release(void *ptr, size_t size)
+{
+  munmap(ptr, size);
+}
+
+bool VirtualMemory::SetWritable(void *ptr, size_t size, bool writable)
+{
+  size_t pageSize = GetPageSize();
+  uintptr_t start = uintptr_t(ptr) & ~(pageSize - 1);
+  uintptr_t end = (uintptr_t(ptr) + size + pageSize - 1) & ~(pageSize - 1);
+
+  int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+
+  return mprotect((void *)start, end - start, prot) == 0;
+}
+
+static VirtualMemory::WriteFaultCallback writeFaultCallback = NULL;
+static struct sigaction prevSegvAction, prevBusAction;
+
+static void WriteFaultHandler(int sig, siginfo_t *info, void *context)
+{
+  // only protection faults can be ours, not accesses to unmapped memory
+  bool accessFault = (sig == SIGBUS) || (info->si_code == SEGV_ACCERR);
+
+  if(accessFault && writeFaultCallback && writeFaultCallback(info->si_addr))
+    return;
+
+  struct sigaction *prev = (sig == SIGBUS) ? &prevBusAction : &prevSegvAction;
+
+  if(prev->sa_flags & SA_SIGINFO)
+  {
+    prev->sa_sigaction(sig, info, context);
+  }
+  else if(prev->sa_handler == SIG_DFL || prev->sa_handler == SIG_IGN)
+  {
+    // go back to the default action and return, so the faulting instruction runs again and the
+    // process crashes just as it would have without us
+    signal(sig, SIG_DFL);
+  }
+  else
+  {
+    prev->sa_handler(sig);
+  }
+}
+
+void VirtualMemory::SetWriteFaultCallback(WriteFaultCallback callback)
+{
+  writeFaultCallback = callback;
+
+  static bool installed = false;
+  if(installed)
+    return;
+
+  installed = true;
+
+  struct sigaction action = {};
+  action.sa_sigaction = &WriteFaultHandler;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  sigemptyset(&action.sa_mask);
+
+  sigaction(SIGSEGV, &action, &prevSegvAction);
+  // apple reports writes to protected pages as SIGBUS
+  sigaction(SIGBUS, &action, &prevBusAction);
+}
@@ -58,6 +58,8 @@ struct pthreadLockData
   pthread_mutexattr_t attr;
 };
 typedef CriticalSectionTemplate<pthreadLockData> CriticalSection;
+typedef RWLockTemplate<pthread_rwlock_t> RWLock;
+typedef ConditionVariableTemplate<pthread_cond_t, pthreadLockData> ConditionVariable;
 };
 
 namespace Bits
@@ -73,4 +75,9 @@ inline uint64_t CountLeadingZeroes(uint64_t value)
   return __builtin_clzl(value);
 }
 #endif
+
+inline uint32_t CountTrailingZeroes(uint64_t value)
+{
+  return (uint32_t)__builtin_ctzll(value);
+}
 };
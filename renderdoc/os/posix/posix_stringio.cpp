@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -373,6 +374,55 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+struct FileMapping
+{
+  void *base;
+  size_t size;
+};
+
+void *MapFileRange(FILE *f, uint64_t offset, uint64_t length, void **mappingHandle)
+{
+  if(f == NULL || length == 0 || mappingHandle == NULL)
+    return NULL;
+
+  // can't map more than the address space
+  if(length > uint64_t(SIZE_MAX) / 2)
+    return NULL;
+
+  // mmap offsets must be page aligned
+  uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t alignedOffset = offset - (offset % pageSize);
+  size_t mapSize = size_t(length + (offset - alignedOffset));
+
+  void *base =
+      mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), (off_t)alignedOffset);
+
+  if(base == MAP_FAILED)
+  {
+    RDCWARN("Couldn't map %llu bytes of file: errno %d", length, errno);
+    return NULL;
+  }
+
+  FileMapping *mapping = new FileMapping;
+  mapping->base = base;
+  mapping->size = mapSize;
+
+  *mappingHandle = mapping;
+
+  return (char *)base + (offset - alignedOffset);
+}
+
+void UnmapFileRange(void *mappingHandle)
+{
+  FileMapping *mapping = (FileMapping *)mappingHandle;
+
+  if(mapping == NULL)
+    return;
+
+  munmap(mapping->base, mapping->size);
+  delete mapping;
+}
+
 void *logfile_open(const char *filename)
 {
   int fd = open(filename, O_APPEND | O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
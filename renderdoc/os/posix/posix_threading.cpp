@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 #include "os/os_specific.h"
@@ -64,6 +65,16 @@ int32_t CmpExch32(volatile int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return __sync_val_compare_and_swap(dest, oldVal, newVal);
 }
+
+int32_t LoadAcquire32(volatile int32_t *i)
+{
+  return __atomic_load_n(i, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease32(volatile int32_t *i, int32_t val)
+{
+  __atomic_store_n(i, val, __ATOMIC_RELEASE);
+}
 };
 
 namespace Threading
@@ -101,6 +112,88 @@ void CriticalSection::Unlock()
   pthread_mutex_unlock(&m_Data.lock);
 }
 
+template <>
+RWLock::RWLockTemplate()
+{
+  pthread_rwlock_init(&m_Data, NULL);
+}
+
+template <>
+RWLock::~RWLockTemplate()
+{
+  pthread_rwlock_destroy(&m_Data);
+}
+
+template <>
+void RWLock::ReadLock()
+{
+  pthread_rwlock_rdlock(&m_Data);
+}
+
+template <>
+void RWLock::ReadUnlock()
+{
+  pthread_rwlock_unlock(&m_Data);
+}
+
+template <>
+void RWLock::WriteLock()
+{
+  pthread_rwlock_wrlock(&m_Data);
+}
+
+template <>
+void RWLock::WriteUnlock()
+{
+  pthread_rwlock_unlock(&m_Data);
+}
+
+template <>
+ConditionVariable::ConditionVariableTemplate()
+{
+  pthread_cond_init(&m_Data, NULL);
+}
+
+template <>
+ConditionVariable::~ConditionVariableTemplate()
+{
+  pthread_cond_destroy(&m_Data);
+}
+
+template <>
+void ConditionVariable::Wait(CriticalSection &cs)
+{
+  pthread_cond_wait(&m_Data, &cs.m_Data.lock);
+}
+
+template <>
+bool ConditionVariable::Wait(CriticalSection &cs, uint32_t milliseconds)
+{
+  // the default condition clock is CLOCK_REALTIME, and gettimeofday is available everywhere
+  timeval now;
+  gettimeofday(&now, NULL);
+
+  uint64_t nsec = uint64_t(now.tv_usec) * 1000 + uint64_t(milliseconds % 1000) * 1000000;
+
+  timespec until;
+  until.tv_sec = now.tv_sec + time_t(milliseconds / 1000) + time_t(nsec / 1000000000);
+  until.tv_nsec = long(nsec % 1000000000);
+
+  return pthread_cond_timedwait(&m_Data, &cs.m_Data.lock, &until) == 0;
+}
+
+template <>
+void ConditionVariable::Signal()
+{
+  pthread_cond_signal(&m_Data);
+}
+
+template <>
+void ConditionVariable::Broadcast()
+{
+  pthread_cond_broadcast(&m_Data);
+}
+
 struct ThreadInitData
 {
   ThreadEntry entryFunc;
@@ -132,28 +225,67 @@ struct TLSData
 
 static CriticalSection *m_TLSListLock = NULL;
 static vector<TLSData *> *m_TLSList = NULL;
+// indexed by slot, and only grows. Protected by m_TLSListLock
+static vector<TLSDestructor> *m_TLSDestructors = NULL;
+
+static void FreeThreadTLS(TLSData *slots)
+{
+  vector<TLSDestructor> destructors;
+
+  m_TLSListLock->Lock();
+  destructors = *m_TLSDestructors;
+  for(size_t i = 0; i < m_TLSList->size(); i++)
+  {
+    if(m_TLSList->at(i) == slots)
+    {
+      m_TLSList->erase(m_TLSList->begin() + i);
+      break;
+    }
+  }
+  m_TLSListLock->Unlock();
+
+  // destructors are called without the lock, they may well take their own
+  for(size_t i = 0; i < slots->data.size() && i < destructors.size(); i++)
+    if(slots->data[i] && destructors[i])
+      destructors[i](slots->data[i]);
+
+  delete slots;
+}
+
+static void ThreadExitTLS(void *value)
+{
+  FreeThreadTLS((TLSData *)value);
+}
 
 void Init()
 {
-  int err = pthread_key_create(&OSTLSHandle, NULL);
+  int err = pthread_key_create(&OSTLSHandle, &ThreadExitTLS);
   if(err != 0)
     RDCFATAL("Can't allocate OS TLS slot");
 
   m_TLSListLock = new CriticalSection();
   m_TLSList = new vector<TLSData *>();
+  m_TLSDestructors = new vector<TLSDestructor>();
 
   CacheDebuggerPresent();
 }
 
 void Shutdown()
 {
+  // delete the key first so no more thread exit destructors run
+  pthread_key_delete(OSTLSHandle);
+
   for(size_t i = 0; i < m_TLSList->size(); i++)
     delete m_TLSList->at(i);
 
   delete m_TLSList;
+  delete m_TLSDestructors;
   delete m_TLSListLock;
+}
 
-  pthread_key_delete(OSTLSHandle);
+void DetachThread()
+{
+  // the key's destructor takes care of this when threads exit
 }
 
 // allocate a TLS slot in our per-thread vectors with an atomic increment.
@@ -164,6 +296,19 @@ uint64_t AllocateTLSSlot()
   return Atomic::Inc64(&nextTLSSlot);
 }
 
+uint64_t AllocateTLSSlot(TLSDestructor destructor)
+{
+  uint64_t slot = AllocateTLSSlot();
+
+  m_TLSListLock->Lock();
+  if(slot > m_TLSDestructors->size())
+    m_TLSDestructors->resize((size_t)slot);
+  m_TLSDestructors->at((size_t)slot - 1) = destructor;
+  m_TLSListLock->Unlock();
+
+  return slot;
+}
+
 // look up our per-thread vector.
 void *GetTLSValue(uint64_t slot)
 {
@@ -245,4 +390,10 @@ void Sleep(uint32_t milliseconds)
 {
   usleep(milliseconds * 1000);
 }
+
+uint32_t GetNumberOfCores()
+{
+  long ret = sysconf(_SC_NPROCESSORS_ONLN);
+  return ret > 0 ? (uint32_t)ret : 1;
+}
 };
@@ -26,7 +26,7 @@
 // must be separate so that it's included first and not sorted by clang-format
 #include <windows.h>
 
-#include <tlhelp32.h>
+#include <psapi.h>
 #include <algorithm>
 #include <map>
 #include <vector>
@@ -112,6 +112,18 @@ struct DllHookset
   DWORD OrdinalBase;
   vector<string> OrdinalNames;
 
+  // hooks are registered without loading their dll, so the original functions are looked up the
+  // first time the module is seen
+  void FetchOriginals()
+  {
+    for(size_t i = 0; i < FunctionHooks.size(); i++)
+    {
+      FunctionHook &hook = FunctionHooks[i];
+      if(hook.origptr && *hook.origptr == NULL)
+        *hook.origptr = (void *)GetProcAddress(module, hook.function.c_str());
+    }
+  }
+
   void FetchOrdinalNames()
   {
     byte *baseAddress = (byte *)module;
@@ -157,6 +169,34 @@ struct DllHookset
   }
 };
 
+// identifies a module we've already been through, so that later passes only have to look at
+// modules that were loaded since
+struct HookedModule
+{
+  DWORD timestamp;
+  DWORD imageSize;
+  // the first import we patched, if any, and what we patched it to
+  void **IATentry;
+  void *hookptr;
+};
+
+static bool GetModuleStamp(HMODULE module, HookedModule &record)
+{
+  PIMAGE_DOS_HEADER dosheader = (PIMAGE_DOS_HEADER)module;
+
+  if(dosheader->e_magic != 0x5a4d)
+    return false;
+
+  PIMAGE_FILE_HEADER fileHeader = (PIMAGE_FILE_HEADER)((byte *)module + dosheader->e_lfanew + 4);
+  PIMAGE_OPTIONAL_HEADER optHeader =
+      (PIMAGE_OPTIONAL_HEADER)((BYTE *)fileHeader + sizeof(IMAGE_FILE_HEADER));
+
+  record.timestamp = fileHeader->TimeDateStamp;
+  record.imageSize = optHeader->SizeOfImage;
+
+  return true;
+}
+
 struct CachedHookData
 {
   CachedHookData()
@@ -171,9 +211,55 @@ struct CachedHookData
   Threading::CriticalSection lock;
   char lowername[512];
 
+  map<HMODULE, HookedModule> hookedModules;
+  Threading::CriticalSection hookedLock;
+
   bool missedOrdinals;
 
+  // returns true if the module has been through ApplyHooks and is still the same image. A module
+  // can be unloaded and something else - or the same dll again, with fresh imports - loaded at the
+  // same address, so check the image stamp and that the first patched import is still ours.
+  bool IsModuleHooked(HMODULE module)
+  {
+    HookedModule record;
+
+    {
+      SCOPED_LOCK(hookedLock);
+      auto it = hookedModules.find(module);
+      if(it == hookedModules.end())
+        return false;
+      record = it->second;
+    }
+
+    HookedModule current = {};
+    if(!GetModuleStamp(module, current))
+      return false;
+
+    if(current.timestamp != record.timestamp || current.imageSize != record.imageSize)
+      return false;
+
+    return record.IATentry == NULL || *record.IATentry == record.hookptr;
+  }
+
+  void ForgetHookedModules()
+  {
+    SCOPED_LOCK(hookedLock);
+    hookedModules.clear();
+  }
+
   void ApplyHooks(const char *modName, HMODULE module)
+  {
+    HookedModule record = {};
+    GetModuleStamp(module, record);
+
+    ApplyHooksToModule(modName, module, record);
+
+    SCOPED_LOCK(hookedLock);
+    hookedModules[module] = record;
+  }
+
+private:
+  void ApplyHooksToModule(const char *modName, HMODULE module, HookedModule &record)
   {
     {
       size_t i = 0;
@@ -210,6 +296,7 @@ struct CachedHookData
         {
           it->second.module = module;
           it->second.FetchOrdinalNames();
+          it->second.FetchOriginals();
         }
         else if(it->second.module != module)
         {
@@ -265,7 +352,7 @@ struct CachedHookData
 
     byte *baseAddress = (byte *)module;
 
-    // the module could have been unloaded after our toolhelp snapshot, especially if we spent a
+    // the module could have been unloaded since we enumerated modules, especially if we spent a
     // long time
     // dealing with a previous module (like adding our hooks).
     wchar_t modpath[1024] = {0};
@@ -317,6 +404,18 @@ struct CachedHookData
         if(!_stricmp(it->first.c_str(), dllName))
           hookset = &it->second;
 
+      // the imported dll is loaded by now, but might come after this module in the module list.
+      // Make sure the originals are there before any calls can go through the hooks
+      if(hookset && hookset->module == NULL)
+      {
+        hookset->module = GetModuleHandleA(dllName);
+        if(hookset->module)
+        {
+          hookset->FetchOrdinalNames();
+          hookset->FetchOriginals();
+        }
+      }
+
       if(hookset && importDesc->OriginalFirstThunk > 0 && importDesc->FirstThunk > 0)
       {
         IMAGE_THUNK_DATA *origFirst =
@@ -383,6 +482,12 @@ struct CachedHookData
                       applied = found->ApplyHook(IATentry, already);
                     }
 
+                    if(applied && record.IATentry == NULL)
+                    {
+                      record.IATentry = IATentry;
+                      record.hookptr = found->hookptr;
+                    }
+
                     // if we failed, or if it's already set and we're not doing a missedOrdinals
                     // second pass, then just bail out immediately as we've already hooked this
                     // module and there's no point wasting time re-hooking nothing
@@ -446,6 +551,12 @@ struct CachedHookData
               applied = found->ApplyHook(IATentry, already);
             }
 
+            if(applied && record.IATentry == NULL)
+            {
+              record.IATentry = IATentry;
+              record.hookptr = found->hookptr;
+            }
+
             // if we failed, or if it's already set and we're not doing a missedOrdinals
             // second pass, then just bail out immediately as we've already hooked this
             // module and there's no point wasting time re-hooking nothing
@@ -484,65 +595,50 @@ struct CachedHookData
 
 static CachedHookData *s_HookData = NULL;
 
-static void HookAllModules()
+// applies hooks to every module that hasn't been through ApplyHooks yet. The first time that's
+// every module in the process, after that it's only the modules loaded since - whether directly,
+// as dependencies, or by another module as it initialised - so the cost is in the new modules
+// rather than in how many are loaded.
+static void HookNewModules()
 {
-  HANDLE hModuleSnap = INVALID_HANDLE_VALUE;
+  vector<HMODULE> modules(512);
+  DWORD needed = 0;
 
-  // up to 10 retries
-  for(int i = 0; i < 10; i++)
+  for(;;)
   {
-    hModuleSnap = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, GetCurrentProcessId());
+    DWORD size = DWORD(modules.size() * sizeof(HMODULE));
 
-    if(hModuleSnap == INVALID_HANDLE_VALUE)
+    if(!EnumProcessModules(GetCurrentProcess(), &modules[0], size, &needed))
     {
       DWORD err = GetLastError();
 
-      RDCWARN("CreateToolhelp32Snapshot() -> 0x%08x", err);
-
-      // retry if error is ERROR_BAD_LENGTH
-      if(err == ERROR_BAD_LENGTH)
-        continue;
+      RDCERR("Couldn't enumerate modules in process: 0x%08x", err);
+      return;
     }
 
-    // didn't retry, or succeeded
-    break;
-  }
+    if(needed <= size)
+      break;
 
-  if(hModuleSnap == INVALID_HANDLE_VALUE)
-  {
-    RDCERR("Couldn't create toolhelp dump of modules in process");
-    return;
+    // more modules than we had room for, possibly still growing
+    modules.resize(needed / sizeof(HMODULE) + 64);
   }
 
-#ifdef UNICODE
-#undef MODULEENTRY32
-#undef Module32First
-#undef Module32Next
-#endif
-
-  MODULEENTRY32 me32;
-  RDCEraseEl(me32);
-  me32.dwSize = sizeof(MODULEENTRY32);
-
-  BOOL success = Module32First(hModuleSnap, &me32);
+  modules.resize(needed / sizeof(HMODULE));
 
-  if(success == FALSE)
+  for(size_t i = 0; i < modules.size(); i++)
   {
-    DWORD err = GetLastError();
-
-    RDCERR("Couldn't get first module in process: 0x%08x", err);
-    CloseHandle(hModuleSnap);
-    return;
-  }
+    if(s_HookData->IsModuleHooked(modules[i]))
+      continue;
 
-  uintptr_t ret = 0;
+    // the module could have been unloaded since we enumerated
+    char filename[MAX_PATH + 1] = {0};
+    if(GetModuleFileNameA(modules[i], filename, MAX_PATH) == 0)
+      continue;
 
-  do
-  {
-    s_HookData->ApplyHooks(me32.szModule, me32.hModule);
-  } while(ret == 0 && Module32Next(hModuleSnap, &me32));
+    const char *slash = strrchr(filename, '\\');
 
-  CloseHandle(hModuleSnap);
+    s_HookData->ApplyHooks(slash ? slash + 1 : filename, modules[i]);
+  }
 }
 
 HMODULE WINAPI Hooked_LoadLibraryExA(LPCSTR lpLibFileName, HANDLE fileHandle, DWORD flags)
@@ -551,6 +647,11 @@ HMODULE WINAPI Hooked_LoadLibraryExA(LPCSTR lpLibFileName, HANDLE fileHandle, DW
   if(flags == 0 && GetModuleHandleA(lpLibFileName))
     dohook = false;
 
+  // no code runs from modules loaded as data or resources, so there's nothing to hook
+  if(flags & (LOAD_LIBRARY_AS_DATAFILE | LOAD_LIBRARY_AS_DATAFILE_EXCLUSIVE |
+              LOAD_LIBRARY_AS_IMAGE_RESOURCE))
+    dohook = false;
+
   SetLastError(S_OK);
 
   // we can use the function naked, as when setting up the hook for LoadLibraryExA, our own module
@@ -563,8 +664,8 @@ HMODULE WINAPI Hooked_LoadLibraryExA(LPCSTR lpLibFileName, HANDLE fileHandle, DW
 
   DWORD err = GetLastError();
 
-  if(dohook)
-    HookAllModules();
+  if(dohook && mod)
+    HookNewModules();
 
   SetLastError(err);
 
@@ -577,6 +678,11 @@ HMODULE WINAPI Hooked_LoadLibraryExW(LPCWSTR lpLibFileName, HANDLE fileHandle, D
   if(flags == 0 && GetModuleHandleW(lpLibFileName))
     dohook = false;
 
+  // no code runs from modules loaded as data or resources, so there's nothing to hook
+  if(flags & (LOAD_LIBRARY_AS_DATAFILE | LOAD_LIBRARY_AS_DATAFILE_EXCLUSIVE |
+              LOAD_LIBRARY_AS_IMAGE_RESOURCE))
+    dohook = false;
+
   SetLastError(S_OK);
 
 #if ENABLED(VERBOSE_DEBUG_HOOK)
@@ -589,8 +695,8 @@ HMODULE WINAPI Hooked_LoadLibraryExW(LPCWSTR lpLibFileName, HANDLE fileHandle, D
 
   DWORD err = GetLastError();
 
-  if(dohook)
-    HookAllModules();
+  if(dohook && mod)
+    HookNewModules();
 
   SetLastError(err);
 
@@ -630,7 +736,11 @@ FARPROC WINAPI Hooked_GetProcAddress(HMODULE mod, LPCSTR func)
   for(auto it = s_HookData->DllHooks.begin(); it != s_HookData->DllHooks.end(); ++it)
   {
     if(it->second.module == NULL)
+    {
       it->second.module = GetModuleHandleA(it->first.c_str());
+      if(it->second.module)
+        it->second.FetchOriginals();
+    }
 
     bool match = (mod == it->second.module);
 
@@ -748,7 +858,7 @@ void Win32_IAT_EndHooks()
   RDCDEBUG("Applying hooks");
 #endif
 
-  HookAllModules();
+  HookNewModules();
 
   if(s_HookData->missedOrdinals)
   {
@@ -757,8 +867,9 @@ void Win32_IAT_EndHooks()
 #endif
 
     // we need to do a second pass now that we know ordinal names to finally hook
-    // some imports by ordinal only.
-    HookAllModules();
+    // some imports by ordinal only. Every module has to be revisited for that.
+    s_HookData->ForgetHookedModules();
+    HookNewModules();
 
     s_HookData->missedOrdinals = false;
   }
@@ -79,6 +79,10 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     SetLastError(0);
     return ret;
   }
+  else if(ul_reason_for_call == DLL_THREAD_DETACH)
+  {
+    Threading::DetachThread();
+  }
 
   return TRUE;
 }
@@ -24,6 +24,8 @@
  ******************************************************************************/
 
 #include <winsock2.h>
+#include <io.h>
+#include <mswsock.h>
 #include <ws2tcpip.h>
 #include "os/os_specific.h"
 
@@ -33,6 +35,14 @@
 
 namespace Network
 {
+static void SetSocketBufferSizes(SOCKET s)
+{
+  // large buffers let a single connection fill links with a high bandwidth-delay product
+  int size = 4 * 1024 * 1024;
+  setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char *)&size, sizeof(size));
+  setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char *)&size, sizeof(size));
+}
+
 void Init()
 {
   WSAData wsaData = {0};
@@ -88,6 +98,8 @@ Socket *Socket::AcceptClient(bool wait)
       BOOL nodelay = TRUE;
       setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&nodelay, sizeof(nodelay));
 
+      SetSocketBufferSizes(s);
+
       return new Socket((ptrdiff_t)s);
     }
 
@@ -155,6 +167,40 @@ bool Socket::SendDataBlocking(const void *buf, uint32_t length)
   return true;
 }
 
+bool Socket::SendFileBlocking(FILE *f, uint64_t offset, uint32_t length)
+{
+  if(length == 0)
+    return true;
+
+  HANDLE file = (HANDLE)_get_osfhandle(_fileno(f));
+
+  // TransmitFile sends from the current file pointer when the socket isn't overlapped
+  LARGE_INTEGER offs;
+  offs.QuadPart = (LONGLONG)offset;
+  if(!SetFilePointerEx(file, offs, NULL, FILE_BEGIN))
+  {
+    RDCWARN("SetFilePointerEx: %d", GetLastError());
+    return false;
+  }
+
+  u_long enable = 0;
+  ioctlsocket(socket, FIONBIO, &enable);
+
+  BOOL success = TransmitFile(socket, file, length, 0, NULL, NULL, 0);
+
+  if(!success)
+  {
+    RDCWARN("TransmitFile: %d", WSAGetLastError());
+    Shutdown();
+    return false;
+  }
+
+  enable = 1;
+  ioctlsocket(socket, FIONBIO, &enable);
+
+  return true;
+}
+
 bool Socket::IsRecvDataWaiting()
 {
   char dummy;
@@ -346,6 +392,8 @@ Socket *CreateClientSocket(const char *host, uint16_t port, int timeoutMS)
     BOOL nodelay = TRUE;
     setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&nodelay, sizeof(nodelay));
 
+    SetSocketBufferSizes(s);
+
     return new Socket((ptrdiff_t)s);
   }
 
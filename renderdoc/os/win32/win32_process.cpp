@@ -1080,6 +1080,11 @@ void *Process::LoadModule(const char *module)
   return LoadLibraryA(module);
 }
 
+void *Process::GetLoadedModule(const char *module)
+{
+  return GetModuleHandleA(module);
+}
+
 void *Process::GetFunctionAddress(void *module, const char *function)
 {
   if(module == NULL)
@@ -1092,3 +1097,70 @@ uint32_t Process::GetCurrentPID()
 {
   return (uint32_t)GetCurrentProcessId();
 }
+
+size_t VirtualMemory::GetPageSize()
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (size_t)info.dwPageSize;
+}
+
+void *VirtualMemory::Reserve(size_t size, bool largePages)
+{
+  // large pages on windows need SeLockMemoryPrivilege and have to be reserved and committed all in
+  // one go, which defeats committing on demand. Normal pages are used instead.
+  return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool VirtualMemory::Commit(void *ptr, size_t size)
+{
+  return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+void VirtualMemory::Release(void *ptr, size_t size)
+{
+  VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+bool VirtualMemory::SetWritable(void *ptr, size_t size, bool writable)
+{
+  MEMORY_BASIC_INFORMATION info = {};
+  if(VirtualQuery(ptr, &info, sizeof(info)) == 0)
+    return false;
+
+  // keep caching modifiers, driver mappings are often write-combined
+  DWORD modifiers = info.Protect & (PAGE_NOCACHE | PAGE_WRITECOMBINE);
+
+  DWORD oldProtect = 0;
+  return VirtualProtect(ptr, size, (writable ? PAGE_READWRITE : PAGE_READONLY) | modifiers,
+                        &oldProtect) == TRUE;
+}
+
+static VirtualMemory::WriteFaultCallback writeFaultCallback = NULL;
+
+static LONG CALLBACK WriteFaultHandler(EXCEPTION_POINTERS *exception)
+{
+  EXCEPTION_RECORD *rec = exception->ExceptionRecord;
+
+  // ExceptionInformation[0] is 1 for a write, [1] is the address
+  if(rec->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && rec->NumberParameters >= 2 &&
+     rec->ExceptionInformation[0] == 1 && writeFaultCallback &&
+     writeFaultCallback((void *)rec->ExceptionInformation[1]))
+    return EXCEPTION_CONTINUE_EXECUTION;
+
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void VirtualMemory::SetWriteFaultCallback(WriteFaultCallback callback)
+{
+  writeFaultCallback = callback;
+
+  static bool installed = false;
+  if(installed)
+    return;
+
+  installed = true;
+
+  // first in the chain, so faults on tracked pages never reach the application's handlers
+  AddVectoredExceptionHandler(1, &WriteFaultHandler);
+}
@@ -62,6 +62,8 @@ void WriteOutput(int channel, const char *str);
 namespace Threading
 {
 typedef CriticalSectionTemplate<CRITICAL_SECTION> CriticalSection;
+typedef RWLockTemplate<SRWLOCK> RWLock;
+typedef ConditionVariableTemplate<CONDITION_VARIABLE, CRITICAL_SECTION> ConditionVariable;
 };
 
 namespace Bits
@@ -81,4 +83,19 @@ inline uint64_t CountLeadingZeroes(uint64_t value)
   return (result == TRUE) ? (index ^ 63) : 64;
 }
 #endif
+
+inline uint32_t CountTrailingZeroes(uint64_t value)
+{
+  DWORD index;
+#if ENABLED(RDOC_X64)
+  _BitScanForward64(&index, value);
+#else
+  if(_BitScanForward(&index, (DWORD)value) == FALSE)
+  {
+    _BitScanForward(&index, (DWORD)(value >> 32));
+    index += 32;
+  }
+#endif
+  return index;
+}
 };
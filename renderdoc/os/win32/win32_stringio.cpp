@@ -23,6 +23,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <io.h>
 #include <shlobj.h>
 #include <stdio.h>
 #include <string.h>
@@ -514,6 +515,72 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+struct FileMapping
+{
+  HANDLE mapping;
+  void *base;
+};
+
+void *MapFileRange(FILE *f, uint64_t offset, uint64_t length, void **mappingHandle)
+{
+  if(f == NULL || length == 0 || mappingHandle == NULL)
+    return NULL;
+
+  // can't map more than the address space
+  if(length > uint64_t(SIZE_MAX) / 2)
+    return NULL;
+
+  HANDLE file = (HANDLE)_get_osfhandle(_fileno(f));
+
+  if(file == INVALID_HANDLE_VALUE)
+    return NULL;
+
+  // view offsets must be aligned to the allocation granularity
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+
+  uint64_t alignedOffset = offset - (offset % info.dwAllocationGranularity);
+  SIZE_T mapSize = SIZE_T(length + (offset - alignedOffset));
+
+  HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+
+  if(mapping == NULL)
+  {
+    RDCWARN("Couldn't create file mapping: %d", GetLastError());
+    return NULL;
+  }
+
+  void *base = MapViewOfFile(mapping, FILE_MAP_COPY, DWORD(alignedOffset >> 32),
+                             DWORD(alignedOffset & 0xffffffff), mapSize);
+
+  if(base == NULL)
+  {
+    RDCWARN("Couldn't map %llu bytes of file: %d", length, GetLastError());
+    CloseHandle(mapping);
+    return NULL;
+  }
+
+  FileMapping *ret = new FileMapping;
+  ret->mapping = mapping;
+  ret->base = base;
+
+  *mappingHandle = ret;
+
+  return (char *)base + (offset - alignedOffset);
+}
+
+void UnmapFileRange(void *mappingHandle)
+{
+  FileMapping *mapping = (FileMapping *)mappingHandle;
+
+  if(mapping == NULL)
+    return;
+
+  UnmapViewOfFile(mapping->base);
+  CloseHandle(mapping->mapping);
+  delete mapping;
+}
+
 void *logfile_open(const char *filename)
 {
   wstring wfn = StringFormat::UTF82Wide(string(filename));
@@ -77,6 +77,21 @@ int32_t CmpExch32(volatile int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return (int32_t)InterlockedCompareExchange((volatile LONG *)dest, newVal, oldVal);
 }
+
+// x86 and x64 loads and stores already have acquire and release semantics, so only the compiler
+// has to be kept from reordering around them
+int32_t LoadAcquire32(volatile int32_t *i)
+{
+  int32_t ret = *i;
+  _ReadWriteBarrier();
+  return ret;
+}
+
+void StoreRelease32(volatile int32_t *i, int32_t val)
+{
+  _ReadWriteBarrier();
+  *i = val;
+}
 };
 
 namespace Threading
@@ -106,6 +121,66 @@ void CriticalSection::Unlock()
   LeaveCriticalSection(&m_Data);
 }
 
+RWLock::RWLockTemplate()
+{
+  InitializeSRWLock(&m_Data);
+}
+
+RWLock::~RWLockTemplate()
+{
+  // SRW locks need no cleanup
+}
+
+void RWLock::ReadLock()
+{
+  AcquireSRWLockShared(&m_Data);
+}
+
+void RWLock::ReadUnlock()
+{
+  ReleaseSRWLockShared(&m_Data);
+}
+
+void RWLock::WriteLock()
+{
+  AcquireSRWLockExclusive(&m_Data);
+}
+
+void RWLock::WriteUnlock()
+{
+  ReleaseSRWLockExclusive(&m_Data);
+}
+
+ConditionVariable::ConditionVariableTemplate()
+{
+  InitializeConditionVariable(&m_Data);
+}
+
+ConditionVariable::~ConditionVariableTemplate()
+{
+  // condition variables need no cleanup
+}
+
+void ConditionVariable::Wait(CriticalSection &cs)
+{
+  SleepConditionVariableCS(&m_Data, &cs.m_Data, INFINITE);
+}
+
+bool ConditionVariable::Wait(CriticalSection &cs, uint32_t milliseconds)
+{
+  return SleepConditionVariableCS(&m_Data, &cs.m_Data, milliseconds) == TRUE;
+}
+
+void ConditionVariable::Signal()
+{
+  WakeConditionVariable(&m_Data);
+}
+
+void ConditionVariable::Broadcast()
+{
+  WakeAllConditionVariable(&m_Data);
+}
+
 struct ThreadInitData
 {
   ThreadEntry entryFunc;
@@ -137,6 +212,32 @@ struct TLSData
 
 static CriticalSection *m_TLSListLock = NULL;
 static vector<TLSData *> *m_TLSList = NULL;
+// indexed by slot, and only grows. Protected by m_TLSListLock
+static vector<TLSDestructor> *m_TLSDestructors = NULL;
+
+static void FreeThreadTLS(TLSData *slots)
+{
+  vector<TLSDestructor> destructors;
+
+  m_TLSListLock->Lock();
+  destructors = *m_TLSDestructors;
+  for(size_t i = 0; i < m_TLSList->size(); i++)
+  {
+    if(m_TLSList->at(i) == slots)
+    {
+      m_TLSList->erase(m_TLSList->begin() + i);
+      break;
+    }
+  }
+  m_TLSListLock->Unlock();
+
+  // destructors are called without the lock, they may well take their own
+  for(size_t i = 0; i < slots->data.size() && i < destructors.size(); i++)
+    if(slots->data[i] && destructors[i])
+      destructors[i](slots->data[i]);
+
+  delete slots;
+}
 
 void Init()
 {
@@ -146,6 +247,7 @@ void Init()
 
   m_TLSListLock = new CriticalSection();
   m_TLSList = new vector<TLSData *>();
+  m_TLSDestructors = new vector<TLSDestructor>();
 }
 
 void Shutdown()
@@ -154,11 +256,29 @@ void Shutdown()
     delete m_TLSList->at(i);
 
   delete m_TLSList;
+  delete m_TLSDestructors;
   delete m_TLSListLock;
 
+  m_TLSListLock = NULL;
+
   TlsFree(OSTLSHandle);
 }
 
+void DetachThread()
+{
+  // threads can exit before Init or after Shutdown
+  if(m_TLSListLock == NULL)
+    return;
+
+  TLSData *slots = (TLSData *)TlsGetValue(OSTLSHandle);
+  if(slots == NULL)
+    return;
+
+  TlsSetValue(OSTLSHandle, NULL);
+
+  FreeThreadTLS(slots);
+}
+
 // allocate a TLS slot in our per-thread vectors with an atomic increment.
 // Note this is going to be 1-indexed because Inc64 returns the post-increment
 // value
@@ -167,6 +287,19 @@ uint64_t AllocateTLSSlot()
   return Atomic::Inc64(&nextTLSSlot);
 }
 
+uint64_t AllocateTLSSlot(TLSDestructor destructor)
+{
+  uint64_t slot = AllocateTLSSlot();
+
+  m_TLSListLock->Lock();
+  if(slot > m_TLSDestructors->size())
+    m_TLSDestructors->resize((size_t)slot);
+  m_TLSDestructors->at((size_t)slot - 1) = destructor;
+  m_TLSListLock->Unlock();
+
+  return slot;
+}
+
 // look up our per-thread vector.
 void *GetTLSValue(uint64_t slot)
 {
@@ -253,4 +386,11 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+uint32_t GetNumberOfCores()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
 };
@@ -48,6 +48,20 @@ int RENDERDOC_CC SetCaptureOptionU32(RENDERDOC_CaptureOption opt, uint32_t val)
     case eRENDERDOC_Option_SaveAllInitials: opts.SaveAllInitials = (val != 0); break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.CaptureAllCmdLists = (val != 0); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.DebugOutputMute = (val != 0); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.AsyncCaptureWrite = (val != 0); break;
+    case eRENDERDOC_Option_CombineMultiFrameCaptures:
+      opts.CombineMultiFrameCaptures = (val != 0);
+      break;
+    case eRENDERDOC_Option_StageInitialContentsMB: opts.StageInitialContentsMB = val; break;
+    case eRENDERDOC_Option_TrackMappedWrites: opts.TrackMappedWrites = (val != 0); break;
+    case eRENDERDOC_Option_DeduplicateCallstacks: opts.DeduplicateCallstacks = (val != 0); break;
+    case eRENDERDOC_Option_RingCaptureFrames: opts.RingCaptureFrames = val; break;
+    case eRENDERDOC_Option_RingCaptureMemoryMB: opts.RingCaptureMemoryMB = val; break;
+    case eRENDERDOC_Option_SpikeCaptureThresholdMS: opts.SpikeCaptureThresholdMS = val; break;
+    case eRENDERDOC_Option_SpikeCapturePercent: opts.SpikeCapturePercent = val; break;
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB: opts.CaptureMemoryBudgetMB = val; break;
+    case eRENDERDOC_Option_CaptureEventTimings: opts.CaptureEventTimings = (val != 0); break;
+    case eRENDERDOC_Option_HideOverlay: opts.HideOverlay = (val != 0); break;
     default: RDCLOG("Unrecognised capture option '%d'", opt); return 0;
   }
 
@@ -75,6 +89,28 @@ int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val)
     case eRENDERDOC_Option_SaveAllInitials: opts.SaveAllInitials = (val != 0.0f); break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.CaptureAllCmdLists = (val != 0.0f); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.DebugOutputMute = (val != 0.0f); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.AsyncCaptureWrite = (val != 0.0f); break;
+    case eRENDERDOC_Option_CombineMultiFrameCaptures:
+      opts.CombineMultiFrameCaptures = (val != 0.0f);
+      break;
+    case eRENDERDOC_Option_StageInitialContentsMB:
+      opts.StageInitialContentsMB = (uint32_t)val;
+      break;
+    case eRENDERDOC_Option_TrackMappedWrites: opts.TrackMappedWrites = (val != 0.0f); break;
+    case eRENDERDOC_Option_DeduplicateCallstacks:
+      opts.DeduplicateCallstacks = (val != 0.0f);
+      break;
+    case eRENDERDOC_Option_RingCaptureFrames: opts.RingCaptureFrames = (uint32_t)val; break;
+    case eRENDERDOC_Option_RingCaptureMemoryMB: opts.RingCaptureMemoryMB = (uint32_t)val; break;
+    case eRENDERDOC_Option_SpikeCaptureThresholdMS:
+      opts.SpikeCaptureThresholdMS = (uint32_t)val;
+      break;
+    case eRENDERDOC_Option_SpikeCapturePercent: opts.SpikeCapturePercent = (uint32_t)val; break;
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      opts.CaptureMemoryBudgetMB = (uint32_t)val;
+      break;
+    case eRENDERDOC_Option_CaptureEventTimings: opts.CaptureEventTimings = (val != 0.0f); break;
+    case eRENDERDOC_Option_HideOverlay: opts.HideOverlay = (val != 0.0f); break;
     default: RDCLOG("Unrecognised capture option '%d'", opt); return 0;
   }
 
@@ -110,6 +146,30 @@ uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1 : 0);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1 : 0);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().AsyncCaptureWrite ? 1 : 0);
+    case eRENDERDOC_Option_CombineMultiFrameCaptures:
+      return (RenderDoc::Inst().GetCaptureOptions().CombineMultiFrameCaptures ? 1 : 0);
+    case eRENDERDOC_Option_StageInitialContentsMB:
+      return (RenderDoc::Inst().GetCaptureOptions().StageInitialContentsMB);
+    case eRENDERDOC_Option_TrackMappedWrites:
+      return (RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites ? 1 : 0);
+    case eRENDERDOC_Option_DeduplicateCallstacks:
+      return (RenderDoc::Inst().GetCaptureOptions().DeduplicateCallstacks ? 1 : 0);
+    case eRENDERDOC_Option_RingCaptureFrames:
+      return (RenderDoc::Inst().GetCaptureOptions().RingCaptureFrames);
+    case eRENDERDOC_Option_RingCaptureMemoryMB:
+      return (RenderDoc::Inst().GetCaptureOptions().RingCaptureMemoryMB);
+    case eRENDERDOC_Option_SpikeCaptureThresholdMS:
+      return (RenderDoc::Inst().GetCaptureOptions().SpikeCaptureThresholdMS);
+    case eRENDERDOC_Option_SpikeCapturePercent:
+      return (RenderDoc::Inst().GetCaptureOptions().SpikeCapturePercent);
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureMemoryBudgetMB);
+    case eRENDERDOC_Option_CaptureEventTimings:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings ? 1 : 0);
+    case eRENDERDOC_Option_HideOverlay:
+      return (RenderDoc::Inst().GetCaptureOptions().HideOverlay ? 1 : 0);
     default: break;
   }
 
@@ -145,6 +205,30 @@ float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1.0f : 0.0f);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().AsyncCaptureWrite ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_CombineMultiFrameCaptures:
+      return (RenderDoc::Inst().GetCaptureOptions().CombineMultiFrameCaptures ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_StageInitialContentsMB:
+      return (RenderDoc::Inst().GetCaptureOptions().StageInitialContentsMB * 1.0f);
+    case eRENDERDOC_Option_TrackMappedWrites:
+      return (RenderDoc::Inst().GetCaptureOptions().TrackMappedWrites ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_DeduplicateCallstacks:
+      return (RenderDoc::Inst().GetCaptureOptions().DeduplicateCallstacks ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_RingCaptureFrames:
+      return (RenderDoc::Inst().GetCaptureOptions().RingCaptureFrames * 1.0f);
+    case eRENDERDOC_Option_RingCaptureMemoryMB:
+      return (RenderDoc::Inst().GetCaptureOptions().RingCaptureMemoryMB * 1.0f);
+    case eRENDERDOC_Option_SpikeCaptureThresholdMS:
+      return (RenderDoc::Inst().GetCaptureOptions().SpikeCaptureThresholdMS * 1.0f);
+    case eRENDERDOC_Option_SpikeCapturePercent:
+      return (RenderDoc::Inst().GetCaptureOptions().SpikeCapturePercent * 1.0f);
+    case eRENDERDOC_Option_CaptureMemoryBudgetMB:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureMemoryBudgetMB * 1.0f);
+    case eRENDERDOC_Option_CaptureEventTimings:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureEventTimings ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_HideOverlay:
+      return (RenderDoc::Inst().GetCaptureOptions().HideOverlay ? 1.0f : 0.0f);
     default: break;
   }
 
@@ -166,4 +250,16 @@ CaptureOptions::CaptureOptions()
   SaveAllInitials = false;
   CaptureAllCmdLists = false;
   DebugOutputMute = true;
+  AsyncCaptureWrite = false;
+  CombineMultiFrameCaptures = false;
+  StageInitialContentsMB = 0;
+  TrackMappedWrites = false;
+  DeduplicateCallstacks = false;
+  RingCaptureFrames = 0;
+  RingCaptureMemoryMB = 256;
+  SpikeCaptureThresholdMS = 0;
+  SpikeCapturePercent = 0;
+  CaptureMemoryBudgetMB = 0;
+  CaptureEventTimings = false;
+  HideOverlay = false;
 }
@@ -23,10 +23,13 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <math.h>
+#include <algorithm>
 #include <sstream>
 #include "api/replay/renderdoc_replay.h"
 #include "api/replay/version.h"
 #include "common/common.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "jpeg-compressor/jpgd.h"
 #include "jpeg-compressor/jpge.h"
@@ -170,6 +173,12 @@ extern "C" RENDERDOC_API uint16_t RENDERDOC_CC Maths_FloatToHalf(float f)
   return ConvertToHalf(f);
 }
 
+extern "C" RENDERDOC_API void RENDERDOC_CC Maths_HalfToFloatArray(const uint16_t *halves,
+                                                                  float *floats, uint32_t count)
+{
+  ConvertFromHalf(halves, floats, count);
+}
+
 extern "C" RENDERDOC_API Camera *RENDERDOC_CC Camera_InitArcball()
 {
   return new Camera(Camera::eType_Arcball);
@@ -450,36 +459,52 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *
                                                                     FileType type, uint32_t maxsize,
                                                                     rdctype::array<byte> *buf)
 {
-  Serialiser ser(filename, Serialiser::READING, false);
+  vector<byte> thumbdata;
+  uint32_t thumbwidth = 0, thumbheight = 0;
 
-  if(ser.HasError())
-    return false;
+  // captures with a thumbnail section can be read just by skipping through the section headers,
+  // older ones have to be opened to read the thumbnail chunk at the start of the frame capture
+  if(!Serialiser::ReadThumbnail(filename, thumbwidth, thumbheight, thumbdata))
+  {
+    Serialiser ser(filename, Serialiser::READING, false);
 
-  ser.Rewind();
+    if(ser.HasError())
+      return false;
 
-  int chunkType = ser.PushContext(NULL, NULL, 1, false);
+    ser.Rewind();
 
-  if(chunkType != THUMBNAIL_DATA)
-    return false;
+    int chunkType = ser.PushContext(NULL, NULL, 1, false);
 
-  bool HasThumbnail = false;
-  ser.Serialise(NULL, HasThumbnail);
+    if(chunkType != THUMBNAIL_DATA)
+      return false;
 
-  if(!HasThumbnail)
-    return false;
+    bool HasThumbnail = false;
+    ser.Serialise(NULL, HasThumbnail);
 
-  byte *jpgbuf = NULL;
-  size_t thumblen = 0;
-  uint32_t thumbwidth = 0, thumbheight = 0;
-  {
-    ser.Serialise("ThumbWidth", thumbwidth);
-    ser.Serialise("ThumbHeight", thumbheight);
-    ser.SerialiseBuffer("ThumbnailPixels", jpgbuf, thumblen);
+    if(!HasThumbnail)
+      return false;
+
+    byte *chunkbuf = NULL;
+    size_t chunklen = 0;
+    {
+      ser.Serialise("ThumbWidth", thumbwidth);
+      ser.Serialise("ThumbHeight", thumbheight);
+      ser.SerialiseBuffer("ThumbnailPixels", chunkbuf, chunklen);
+    }
+
+    if(chunkbuf == NULL)
+      return false;
+
+    thumbdata.assign(chunkbuf, chunkbuf + chunklen);
+    delete[] chunkbuf;
   }
 
-  if(jpgbuf == NULL)
+  if(thumbdata.empty())
     return false;
 
+  byte *jpgbuf = &thumbdata[0];
+  size_t thumblen = thumbdata.size();
+
   // if the desired output is jpg and either there's no max size or it's already satisfied,
   // return the data directly
   if(type == eFileType_JPG && (maxsize == 0 || (maxsize > thumbwidth && maxsize > thumbheight)))
@@ -562,7 +587,6 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *
       {
         RDCERR("Unsupported file type %d in thumbnail fetch", type);
         free(thumbpixels);
-        delete[] jpgbuf;
         return false;
       }
     }
@@ -572,11 +596,1246 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *
     free(thumbpixels);
   }
 
-  delete[] jpgbuf;
+  return true;
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_RecompressCapture(
+    const char *filename, const char *destfilename, CaptureCompression compression)
+{
+  if(!strcmp(filename, destfilename))
+  {
+    RDCERR("Can't recompress capture '%s' in place", filename);
+    return false;
+  }
+
+  Serialiser ser(filename, Serialiser::READING, false);
+
+  if(ser.HasError())
+    return false;
+
+  Serialiser::SectionFlags codec = Serialiser::eSectionFlag_LZ4Compressed;
+
+  if(compression == eCaptureCompression_Deflate)
+    codec = Serialiser::eSectionFlag_DeflateCompressed;
+
+  return ser.WriteRecompressed(destfilename, codec);
+}
+
+static double BenchmarkMBps(double ms, uint64_t bytes)
+{
+  return ms > 0.0 ? (double(bytes) / (1024.0 * 1024.0)) / (ms / 1000.0) : 0.0;
+}
+
+static string BenchmarkStage(const char *name, double ms, uint64_t bytes)
+{
+  return StringFormat::Fmt("    \"%s\": {\"ms\": %.3f, \"bytes\": %llu, \"MBps\": %.1f}", name, ms,
+                           bytes, BenchmarkMBps(ms, bytes));
+}
+
+// times FindDiffRange with each implementation over two identical buffers, i.e. the worst case of
+// a map that wasn't written to. Run single-threaded and with as many threads as it would use.
+static void BenchmarkDiffRange(uint64_t size, vector<string> &results)
+{
+  byte *a = Serialiser::AllocAlignedBuffer((size_t)size);
+  byte *b = Serialiser::AllocAlignedBuffer((size_t)size);
+
+  if(a == NULL || b == NULL)
+  {
+    Serialiser::FreeAlignedBuffer(a);
+    Serialiser::FreeAlignedBuffer(b);
+    return;
+  }
+
+  for(uint64_t i = 0; i < size; i++)
+    a[i] = b[i] = byte(i * 31);
+
+  uint32_t numThreads = RDCMIN(Threading::GetNumberOfCores(), 4U);
+
+  for(int i = 0; i < eDiffRange_Count; i++)
+  {
+    DiffRangeImpl impl = (DiffRangeImpl)i;
+
+    if(!DiffRangeImplSupported(impl))
+      continue;
+
+    uint32_t threadCounts[] = {1, numThreads};
+
+    for(size_t t = 0; t < ARRAY_COUNT(threadCounts); t++)
+    {
+      if(t > 0 && threadCounts[t] == 1)
+        break;
+
+      size_t diffStart = 0, diffEnd = 0;
+
+      PerformanceTimer timer;
+      FindDiffRange(impl, threadCounts[t], a, b, (size_t)size, diffStart, diffEnd);
+      double ms = timer.GetMilliseconds();
+
+      results.push_back(StringFormat::Fmt(
+          "    \"%s_x%u\": {\"ms\": %.3f, \"bytes\": %llu, \"MBps\": %.1f}",
+          DiffRangeImplName(impl), threadCounts[t], ms, size, BenchmarkMBps(ms, size)));
+    }
+  }
+
+  Serialiser::FreeAlignedBuffer(a);
+  Serialiser::FreeAlignedBuffer(b);
+}
+
+// times each batch format conversion kernel over size bytes of source data, capped so the decoded
+// output stays reasonable. Throughput is measured in source bytes
+static void BenchmarkFormatConvert(uint64_t size, vector<string> &results)
+{
+  size_t count = (size_t)RDCMIN(size, uint64_t(16 * 1024 * 1024)) / sizeof(uint32_t);
+
+  if(count == 0)
+    return;
+
+  vector<uint32_t> packed(count);
+  vector<float> floats(count * 2);
+  vector<uint16_t> halves(count * 2);
+  vector<Vec4f> rgba(count);
+  vector<Vec3f> rgb(count);
+
+  for(size_t i = 0; i < count; i++)
+  {
+    packed[i] = uint32_t(i * 2654435761U);
+    halves[i * 2 + 0] = uint16_t(packed[i]);
+    halves[i * 2 + 1] = uint16_t(packed[i] >> 16);
+    floats[i * 2 + 0] = float(i) * 0.001f;
+    floats[i * 2 + 1] = -float(i) * 0.5f;
+  }
+
+  uint64_t bytes = count * sizeof(uint32_t);
+
+  for(int i = 0; i < eFormatConvert_Count; i++)
+  {
+    FormatConvertImpl impl = (FormatConvertImpl)i;
+
+    if(!FormatConvertImplSupported(impl))
+      continue;
+
+    const char *name = FormatConvertImplName(impl);
+    double ms = 0.0;
+
+    {
+      PerformanceTimer timer;
+      ConvertFromHalf(impl, &halves[0], &floats[0], halves.size());
+      ms = timer.GetMilliseconds();
+      results.push_back(BenchmarkStage(StringFormat::Fmt("fromHalf_%s", name).c_str(), ms, bytes));
+    }
+
+    {
+      PerformanceTimer timer;
+      ConvertToHalf(impl, &floats[0], &halves[0], floats.size());
+      ms = timer.GetMilliseconds();
+      results.push_back(
+          BenchmarkStage(StringFormat::Fmt("toHalf_%s", name).c_str(), ms, bytes * 2));
+    }
+
+    {
+      PerformanceTimer timer;
+      ConvertFromR10G10B10A2(impl, &packed[0], &rgba[0], count);
+      ms = timer.GetMilliseconds();
+      results.push_back(
+          BenchmarkStage(StringFormat::Fmt("fromR10G10B10A2_%s", name).c_str(), ms, bytes));
+    }
+
+    {
+      PerformanceTimer timer;
+      ConvertFromR11G11B10(impl, &packed[0], &rgb[0], count);
+      ms = timer.GetMilliseconds();
+      results.push_back(
+          BenchmarkStage(StringFormat::Fmt("fromR11G11B10_%s", name).c_str(), ms, bytes));
+    }
+  }
+}
+
+// times serialising the fields of a typical draw call (a resource ID and four uint32s) into an
+// in-memory write serialiser, as the drivers do for every call during capture. "fields" is just
+// the element writes, "chunk" adds the context push/pop and Chunk creation around them.
+static void BenchmarkSerialise(vector<string> &results)
+{
+  const uint32_t numCalls = 1000000;
+
+  Serialiser ser(NULL, Serialiser::WRITING, false);
+
+  ResourceId id = ResourceId();
+  uint32_t vertexCount = 3, instanceCount = 1, firstVertex = 0, firstInstance = 0;
+
+  {
+    PerformanceTimer timer;
+
+    for(uint32_t i = 0; i < numCalls; i++)
+    {
+      // keep the buffer a realistic size rather than growing it for the whole run
+      if((i % 4096) == 0)
+        ser.Rewind();
+
+      ser.Serialise("cmdBuffer", id);
+      ser.Serialise("vertexCount", vertexCount);
+      ser.Serialise("instanceCount", instanceCount);
+      ser.Serialise("firstVertex", firstVertex);
+      ser.Serialise("firstInstance", firstInstance);
+    }
+
+    double ms = timer.GetMilliseconds();
+    results.push_back(
+        StringFormat::Fmt("    \"fields\": {\"ms\": %.3f, \"calls\": %u, \"nsPerCall\": %.2f}", ms,
+                          numCalls, ms * 1.0e6 / double(numCalls)));
+  }
+
+  ser.Rewind();
+
+  {
+    PerformanceTimer timer;
+
+    for(uint32_t i = 0; i < numCalls; i++)
+    {
+      ScopedContext scope(&ser, "vkCmdDraw", 1, true);
+
+      ser.Serialise("cmdBuffer", id);
+      ser.Serialise("vertexCount", vertexCount);
+      ser.Serialise("instanceCount", instanceCount);
+      ser.Serialise("firstVertex", firstVertex);
+      ser.Serialise("firstInstance", firstInstance);
+
+      Chunk *chunk = scope.Get();
+      delete chunk;
+    }
+
+    double ms = timer.GetMilliseconds();
+    results.push_back(
+        StringFormat::Fmt("    \"chunk\": {\"ms\": %.3f, \"calls\": %u, \"nsPerCall\": %.2f}", ms,
+                          numCalls, ms * 1.0e6 / double(numCalls)));
+  }
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_BenchmarkCapture(const char *filename,
+                                                                        bool32 replay,
+                                                                        uint64_t writeSize,
+                                                                        rdctype::str *json)
+{
+  if(json == NULL)
+    return false;
+
+  PerformanceTimer timer;
+
+  Serialiser *ser = new Serialiser(filename, Serialiser::READING, false);
+
+  double parseTime = timer.GetMilliseconds();
+
+  if(ser->HasError())
+  {
+    RDCERR("Couldn't open capture '%s' to benchmark", filename);
+    SAFE_DELETE(ser);
+    return false;
+  }
+
+  uint64_t fileSize = ser->GetFileSize();
+  uint64_t dataSize = ser->GetSize();
+
+  // the first pass over the frame capture data pays for reading and decompressing it, later
+  // passes are served from the block cache where the format allows.
+  const size_t readSize = 64 * 1024;
+
+  timer.Restart();
+
+  ser->SetOffset(0);
+  while(ser->GetOffset() < dataSize)
+    ser->RawReadBytes((size_t)RDCMIN(dataSize - ser->GetOffset(), (uint64_t)readSize));
+
+  double decompressTime = timer.GetMilliseconds();
+
+  timer.Restart();
+
+  uint32_t numChunks = 0;
+
+  ser->Rewind();
+  while(!ser->AtEnd())
+  {
+    uint32_t chunkType = ser->PushContext(NULL, NULL, 1, false);
+    ser->SkipCurrentChunk();
+    ser->PopContext(chunkType);
+    numChunks++;
+  }
+
+  double walkTime = timer.GetMilliseconds();
+
+  SAFE_DELETE(ser);
+
+  vector<string> stages;
+
+  stages.push_back(BenchmarkStage("sectionParse", parseTime, fileSize));
+  stages.push_back(BenchmarkStage("decompress", decompressTime, dataSize));
+  stages.push_back(BenchmarkStage("chunkWalk", walkTime, dataSize));
+
+  ReplayCreateStatus replayStatus = eReplayCreate_Success;
+
+  if(replay)
+  {
+    RDCDriver driverType = RDC_Unknown;
+    string driverName = "";
+    uint64_t fileMachineIdent = 0;
+    replayStatus =
+        RenderDoc::Inst().FillInitParams(filename, driverType, driverName, fileMachineIdent, NULL);
+
+    IReplayDriver *driver = NULL;
+
+    if(replayStatus == eReplayCreate_Success)
+    {
+      timer.Restart();
+
+      replayStatus = RenderDoc::Inst().CreateReplayDriver(driverType, filename, &driver);
+
+      stages.push_back(BenchmarkStage("createReplayDriver", timer.GetMilliseconds(), 0));
+    }
+
+    if(driver && replayStatus == eReplayCreate_Success)
+    {
+      timer.Restart();
+
+      driver->ReadLogInitialisation();
+
+      stages.push_back(BenchmarkStage("readLogInitialisation", timer.GetMilliseconds(), fileSize));
+
+      FetchFrameRecord frame = driver->GetFrameRecord();
+
+      uint32_t lastEvent = 0;
+      if(frame.drawcallList.count > 0)
+        lastEvent = frame.drawcallList[frame.drawcallList.count - 1].eventID;
+
+      timer.Restart();
+
+      driver->ReplayLog(lastEvent, eReplay_Full);
+
+      stages.push_back(BenchmarkStage("firstReplayLog", timer.GetMilliseconds(), 0));
+    }
+    else
+    {
+      RDCERR("Couldn't create replay driver to benchmark '%s': %d", filename, replayStatus);
+    }
+
+    if(driver)
+      driver->Shutdown();
+  }
+
+  vector<string> writes, diffs, converts, serialise;
+
+  if(writeSize > 0)
+  {
+    string tmpfile = string(filename) + ".benchmark.tmp";
+
+    Serialiser::SectionFlags codecs[] = {
+        Serialiser::eSectionFlag_LZ4Compressed, Serialiser::eSectionFlag_DeflateCompressed,
+    };
+    const char *codecNames[] = {"lz4", "deflate"};
+
+    for(size_t i = 0; i < ARRAY_COUNT(codecs); i++)
+    {
+      uint64_t compSize = 0;
+      double ms =
+          Serialiser::BenchmarkCompressedWrite(tmpfile.c_str(), codecs[i], writeSize, compSize);
+
+      FileIO::Delete(tmpfile.c_str());
+
+      if(ms < 0.0)
+        continue;
+
+      writes.push_back(StringFormat::Fmt(
+          "    \"%s\": {\"ms\": %.3f, \"bytes\": %llu, \"compressedBytes\": %llu, \"MBps\": %.1f}",
+          codecNames[i], ms, writeSize, compSize, BenchmarkMBps(ms, writeSize)));
+    }
+
+    BenchmarkDiffRange(writeSize, diffs);
+    BenchmarkFormatConvert(writeSize, converts);
+    BenchmarkSerialise(serialise);
+  }
+
+  string ret = "{\n";
+  ret += StringFormat::Fmt("  \"file\": \"%s\",\n", jsonescape(filename).c_str());
+  ret += StringFormat::Fmt("  \"fileBytes\": %llu,\n", fileSize);
+  ret += StringFormat::Fmt("  \"uncompressedBytes\": %llu,\n", dataSize);
+  ret += StringFormat::Fmt("  \"chunks\": %u,\n", numChunks);
+  if(replay)
+    ret += StringFormat::Fmt("  \"replayStatus\": %d,\n", replayStatus);
+
+  ret += "  \"stages\": {\n";
+  for(size_t i = 0; i < stages.size(); i++)
+    ret += stages[i] + (i + 1 < stages.size() ? ",\n" : "\n");
+  ret += "  },\n";
+
+  ret += "  \"compressedWrite\": {\n";
+  for(size_t i = 0; i < writes.size(); i++)
+    ret += writes[i] + (i + 1 < writes.size() ? ",\n" : "\n");
+  ret += "  },\n";
+
+  ret += "  \"findDiffRange\": {\n";
+  for(size_t i = 0; i < diffs.size(); i++)
+    ret += diffs[i] + (i + 1 < diffs.size() ? ",\n" : "\n");
+  ret += "  },\n";
+
+  ret += "  \"formatConvert\": {\n";
+  for(size_t i = 0; i < converts.size(); i++)
+    ret += converts[i] + (i + 1 < converts.size() ? ",\n" : "\n");
+  ret += "  },\n";
+
+  ret += "  \"serialise\": {\n";
+  for(size_t i = 0; i < serialise.size(); i++)
+    ret += serialise[i] + (i + 1 < serialise.size() ? ",\n" : "\n");
+  ret += "  }\n";
+
+  ret += "}\n";
+
+  *json = ret;
 
   return true;
 }
 
+// min/max/mean/median/stddev of a set of timings, as a JSON object
+static string BenchmarkStats(vector<double> times)
+{
+  if(times.empty())
+    return "{}";
+
+  std::sort(times.begin(), times.end());
+
+  double sum = 0.0;
+  for(size_t i = 0; i < times.size(); i++)
+    sum += times[i];
+
+  double mean = sum / double(times.size());
+
+  double variance = 0.0;
+  for(size_t i = 0; i < times.size(); i++)
+    variance += (times[i] - mean) * (times[i] - mean);
+  variance /= double(times.size());
+
+  size_t mid = times.size() / 2;
+  double median = (times.size() % 2) ? times[mid] : (times[mid - 1] + times[mid]) * 0.5;
+
+  return StringFormat::Fmt(
+      "{\"count\": %u, \"min\": %.4f, \"max\": %.4f, \"mean\": %.4f, \"median\": %.4f, "
+      "\"stddev\": %.4f}",
+      (uint32_t)times.size(), times[0], times.back(), mean, median, sqrt(variance));
+}
+
+struct BenchmarkRegion
+{
+  string name;
+  uint32_t depth;
+  uint32_t firstEvent, lastEvent;
+  vector<double> gpuTimes;
+};
+
+// sums the GPU time of each marker region from the per-event durations of one pass, adding the
+// regions the first time through. Returns the total for the draws passed in.
+static double BenchmarkRegionTimes(const rdctype::array<FetchDrawcall> &draws,
+                                   const std::map<uint32_t, double> &eventTimes, uint32_t depth,
+                                   vector<BenchmarkRegion> &regions, size_t &regionIdx)
+{
+  double total = 0.0;
+
+  for(int32_t i = 0; i < draws.count; i++)
+  {
+    const FetchDrawcall &d = draws[i];
+
+    if(d.children.count == 0)
+    {
+      std::map<uint32_t, double>::const_iterator it = eventTimes.find(d.eventID);
+      if(it != eventTimes.end())
+        total += it->second;
+      continue;
+    }
+
+    size_t idx = regionIdx++;
+
+    if(idx == regions.size())
+    {
+      BenchmarkRegion region;
+      region.name = d.name.elems ? d.name.elems : "";
+      region.depth = depth;
+      region.firstEvent = d.eventID;
+
+      const FetchDrawcall *last = &d;
+      while(last->children.count > 0)
+        last = &last->children[last->children.count - 1];
+      region.lastEvent = last->eventID;
+
+      regions.push_back(region);
+    }
+
+    double regionTime = BenchmarkRegionTimes(d.children, eventTimes, depth + 1, regions, regionIdx);
+
+    regions[idx].gpuTimes.push_back(regionTime);
+
+    total += regionTime;
+  }
+
+  return total;
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_BenchmarkReplay(const char *filename,
+                                                                       uint32_t warmup,
+                                                                       uint32_t iterations,
+                                                                       uint32_t gpuPasses,
+                                                                       rdctype::str *json)
+{
+  if(json == NULL)
+    return false;
+
+  RDCDriver driverType = RDC_Unknown;
+  string driverName = "";
+  uint64_t fileMachineIdent = 0;
+  ReplayCreateStatus status =
+      RenderDoc::Inst().FillInitParams(filename, driverType, driverName, fileMachineIdent, NULL);
+
+  IReplayDriver *driver = NULL;
+
+  if(status == eReplayCreate_Success)
+    status = RenderDoc::Inst().CreateReplayDriver(driverType, filename, &driver);
+
+  if(driver == NULL || status != eReplayCreate_Success)
+  {
+    RDCERR("Couldn't create replay driver to benchmark '%s': %d", filename, status);
+    if(driver)
+      driver->Shutdown();
+    return false;
+  }
+
+  PerformanceTimer timer;
+
+  driver->ReadLogInitialisation();
+
+  double loadTime = timer.GetMilliseconds();
+
+  APIProperties props = driver->GetAPIProperties();
+  FetchFrameRecord frame = driver->GetFrameRecord();
+
+  uint32_t lastEvent = 0;
+  if(frame.drawcallList.count > 0)
+  {
+    const FetchDrawcall *last = &frame.drawcallList[frame.drawcallList.count - 1];
+    while(last->children.count > 0)
+      last = &last->children[last->children.count - 1];
+    lastEvent = last->eventID;
+  }
+
+  for(uint32_t i = 0; i < warmup; i++)
+    driver->ReplayLog(lastEvent, eReplay_Full);
+
+  // replays are back to back, so once the driver's queue of frames in flight is full each one
+  // also waits for the GPU and these converge on the real frame cost. The total is the better
+  // figure for a GPU-bound frame, the individual times show the spread.
+  vector<double> wallTimes;
+
+  PerformanceTimer totalTimer;
+
+  for(uint32_t i = 0; i < iterations; i++)
+  {
+    timer.Restart();
+    driver->ReplayLog(lastEvent, eReplay_Full);
+    wallTimes.push_back(timer.GetMilliseconds());
+  }
+
+  double totalWallTime = totalTimer.GetMilliseconds();
+
+  // GPU time comes from the per-event duration counter, which every driver fetches for the whole
+  // frame in a single batched replay.
+  vector<uint32_t> counters = driver->EnumerateCounters();
+  bool hasDuration =
+      std::find(counters.begin(), counters.end(), (uint32_t)eCounter_EventGPUDuration) !=
+      counters.end();
+
+  vector<double> gpuTimes;
+  vector<BenchmarkRegion> regions;
+
+  for(uint32_t p = 0; hasDuration && p < gpuPasses; p++)
+  {
+    vector<uint32_t> request(1, (uint32_t)eCounter_EventGPUDuration);
+    vector<CounterResult> results = driver->FetchCounters(request);
+
+    std::map<uint32_t, double> eventTimes;
+    for(size_t i = 0; i < results.size(); i++)
+      eventTimes[results[i].eventID] = results[i].value.d * 1000.0;
+
+    size_t regionIdx = 0;
+    gpuTimes.push_back(BenchmarkRegionTimes(frame.drawcallList, eventTimes, 0, regions, regionIdx));
+  }
+
+  driver->Shutdown();
+
+  string ret = "{\n";
+  ret += StringFormat::Fmt("  \"file\": \"%s\",\n", jsonescape(filename).c_str());
+  ret += StringFormat::Fmt("  \"driver\": \"%s\",\n", jsonescape(driverName).c_str());
+  ret += StringFormat::Fmt("  \"degraded\": %s,\n", props.degraded ? "true" : "false");
+  ret += StringFormat::Fmt("  \"lastEvent\": %u,\n", lastEvent);
+  ret += StringFormat::Fmt("  \"loadMs\": %.3f,\n", loadTime);
+  ret += StringFormat::Fmt("  \"warmup\": %u,\n", warmup);
+  ret += StringFormat::Fmt("  \"iterations\": %u,\n", iterations);
+  ret += StringFormat::Fmt("  \"totalWallMs\": %.3f,\n", totalWallTime);
+  ret += StringFormat::Fmt("  \"wallMs\": %s,\n", BenchmarkStats(wallTimes).c_str());
+
+  if(hasDuration)
+    ret += StringFormat::Fmt("  \"gpuMs\": %s,\n", BenchmarkStats(gpuTimes).c_str());
+  else
+    ret += "  \"gpuMs\": null,\n";
+
+  ret += "  \"regions\": [\n";
+  for(size_t i = 0; i < regions.size(); i++)
+  {
+    ret += StringFormat::Fmt(
+        "    {\"name\": \"%s\", \"depth\": %u, \"firstEvent\": %u, \"lastEvent\": %u, "
+        "\"gpuMs\": %s}%s\n",
+        jsonescape(regions[i].name).c_str(), regions[i].depth, regions[i].firstEvent,
+        regions[i].lastEvent, BenchmarkStats(regions[i].gpuTimes).c_str(),
+        i + 1 < regions.size() ? "," : "");
+  }
+  ret += "  ]\n";
+
+  ret += "}\n";
+
+  *json = ret;
+
+  return true;
+}
+
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_ExportCaptureText(const char *filename, const char *destfilename)
+{
+  RDCDriver driverType = RDC_Unknown;
+  string driverName = "";
+  uint64_t fileMachineIdent = 0;
+  ReplayCreateStatus status =
+      RenderDoc::Inst().FillInitParams(filename, driverType, driverName, fileMachineIdent, NULL);
+
+  if(status != eReplayCreate_Success)
+    return status;
+
+  FILE *f = FileIO::fopen(destfilename, "wb");
+
+  if(!f)
+  {
+    RDCERR("Can't open '%s' to export capture text", destfilename);
+    return eReplayCreate_FileIOFailed;
+  }
+
+  // the driver reads with debug text enabled while it loads the capture, so every chunk is
+  // decoded and written out once and only the current chunk's text is kept in memory.
+  Serialiser::SetDebugTextExport(f);
+
+  IReplayDriver *driver = NULL;
+  status = RenderDoc::Inst().CreateReplayDriver(driverType, filename, &driver);
+
+  if(driver && status == eReplayCreate_Success)
+    driver->ReadLogInitialisation();
+  else
+    RDCERR("Couldn't create replay driver to export '%s': %d", filename, status);
+
+  Serialiser::SetDebugTextExport(NULL);
+
+  if(driver)
+    driver->Shutdown();
+
+  FileIO::fclose(f);
+
+  return status;
+}
+
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_ExportCaptureOutputs(const char *filename, const char *outdir, bool32 markerRegions,
+                               bool32 meshes)
+{
+  ReplayRenderer *render = new ReplayRenderer();
+
+  ReplayCreateStatus status = render->CreateDevice(filename);
+
+  if(status != eReplayCreate_Success)
+  {
+    RDCERR("Couldn't open '%s' to export outputs: %d", filename, status);
+    delete render;
+    return status;
+  }
+
+  bool success = render->ExportOutputs(outdir, markerRegions != 0, meshes != 0);
+
+  render->Shutdown();
+
+  return success ? eReplayCreate_Success : eReplayCreate_FileIOFailed;
+}
+
+// one top-level chunk of a capture, compared by its type and a hash of its contents
+struct DiffChunk
+{
+  uint32_t type;
+  uint32_t number;    // index of the chunk in the file, as counted by export
+  uint64_t hash[2];
+
+  bool operator==(const DiffChunk &o) const
+  {
+    return type == o.type && hash[0] == o.hash[0] && hash[1] == o.hash[1];
+  }
+};
+
+// the chunks directly inside one marker region. Regions are keyed by the path of marker names,
+// with the occurrence appended for a name that repeats under the same parent
+struct DiffRegion
+{
+  string name;
+  vector<DiffChunk> chunks;
+};
+
+struct DiffCapture
+{
+  const char *filename;
+  CaptureChunkInfo info;
+  bool success;
+  uint32_t numChunks;
+
+  // everything before the capture scope - resource creation and initial contents
+  DiffRegion resources;
+  // in the order each region starts. The first is for chunks outside any marker
+  vector<DiffRegion> regions;
+};
+
+static void DiffReadCapture(void *data)
+{
+  DiffCapture *cap = (DiffCapture *)data;
+
+  Serialiser *ser = new Serialiser(cap->filename, Serialiser::READING, false);
+
+  if(ser->HasError())
+  {
+    RDCERR("Couldn't open capture '%s' to diff", cap->filename);
+    SAFE_DELETE(ser);
+    return;
+  }
+
+  const CaptureChunkInfo &info = cap->info;
+
+  bool inFrame = false;
+  vector<size_t> regionStack;
+  map<string, uint32_t> occurrences;
+
+  cap->numChunks = 0;
+  cap->resources.name = "resources";
+
+  while(!ser->AtEnd() && !ser->HasError())
+  {
+    uint32_t chunkType = ser->PushContext(NULL, NULL, 1, false);
+
+    DiffChunk chunk;
+    chunk.type = chunkType;
+    chunk.number = cap->numChunks++;
+
+    // the capture scope holds the frame number, so it's never compared itself
+    if(!inFrame && chunkType == info.captureScope)
+    {
+      inFrame = true;
+
+      cap->regions.push_back(DiffRegion());
+      regionStack.push_back(0);
+
+      ser->HashCurrentChunk(chunk.hash);
+    }
+    else if(inFrame && chunkType == info.pushMarker)
+    {
+      string name = info.readMarkerName(ser);
+      ser->HashCurrentChunk(chunk.hash);
+
+      string path = cap->regions[regionStack.back()].name;
+      if(!path.empty())
+        path += "/";
+      path += name;
+
+      uint32_t occurrence = occurrences[path]++;
+      if(occurrence > 0)
+        path += StringFormat::Fmt("[%u]", occurrence);
+
+      regionStack.push_back(cap->regions.size());
+      cap->regions.push_back(DiffRegion());
+      cap->regions.back().name = path;
+    }
+    else if(inFrame && chunkType == info.popMarker)
+    {
+      ser->HashCurrentChunk(chunk.hash);
+
+      // unbalanced pops are ignored, the root region is never popped
+      if(regionStack.size() > 1)
+        regionStack.pop_back();
+    }
+    else
+    {
+      string name;
+      if(inFrame && chunkType == info.setMarker)
+        name = info.readMarkerName(ser);
+
+      ser->HashCurrentChunk(chunk.hash);
+
+      // the marker name was read rather than hashed, so fold it back in
+      if(!name.empty())
+      {
+        uint64_t nameHash[2];
+        Serialiser::HashBytes(name.c_str(), name.length(), nameHash);
+        chunk.hash[0] ^= nameHash[0];
+        chunk.hash[1] ^= nameHash[1];
+      }
+
+      if(inFrame)
+        cap->regions[regionStack.back()].chunks.push_back(chunk);
+      else
+        cap->resources.chunks.push_back(chunk);
+    }
+
+    ser->PopContext(chunkType);
+  }
+
+  cap->success = !ser->HasError();
+
+  SAFE_DELETE(ser);
+}
+
+enum DiffEditType
+{
+  eDiffEdit_Same,
+  eDiffEdit_Added,
+  eDiffEdit_Removed,
+};
+
+struct DiffEdit
+{
+  DiffEditType type;
+  uint32_t a, b;
+};
+
+// past this many edits in one region the diff falls back to comparing chunks by position, to bound
+// the memory the edit trace takes
+static const int MaxDiffEdits = 2048;
+
+// Myers' O(ND) shortest edit script between the chunk sequences of a region
+static void DiffChunkSequences(const vector<DiffChunk> &a, const vector<DiffChunk> &b,
+                               vector<DiffEdit> &edits)
+{
+  int n = (int)a.size(), m = (int)b.size();
+
+  // trim the common prefix and suffix, which in practice is most of any region
+  int prefix = 0;
+  while(prefix < n && prefix < m && a[prefix] == b[prefix])
+    prefix++;
+
+  int suffix = 0;
+  while(suffix < n - prefix && suffix < m - prefix && a[n - 1 - suffix] == b[m - 1 - suffix])
+    suffix++;
+
+  for(int i = 0; i < prefix; i++)
+  {
+    DiffEdit e = {eDiffEdit_Same, (uint32_t)i, (uint32_t)i};
+    edits.push_back(e);
+  }
+
+  int N = n - prefix - suffix, M = m - prefix - suffix;
+  int maxD = RDCMIN(N + M, MaxDiffEdits);
+
+  // trace[d] holds the furthest x reached on each diagonal k in [-d, d] after d edits
+  vector<vector<int> > trace;
+  vector<int> V(2 * maxD + 3, 0);
+  int off = maxD + 1;
+  int D = -1;
+
+  for(int d = 0; d <= maxD && D < 0; d++)
+  {
+    for(int k = -d; k <= d; k += 2)
+    {
+      int x;
+      if(k == -d || (k != d && V[off + k - 1] < V[off + k + 1]))
+        x = V[off + k + 1];
+      else
+        x = V[off + k - 1] + 1;
+
+      int y = x - k;
+
+      while(x < N && y < M && a[prefix + x] == b[prefix + y])
+      {
+        x++;
+        y++;
+      }
+
+      V[off + k] = x;
+
+      if(x >= N && y >= M)
+        D = d;
+    }
+
+    trace.push_back(vector<int>(V.begin() + off - d, V.begin() + off + d + 1));
+  }
+
+  size_t middleStart = edits.size();
+
+  if(D >= 0)
+  {
+    // walk back through the trace, emitting the edits in reverse
+    int x = N, y = M;
+
+    for(int d = D; d > 0; d--)
+    {
+      const vector<int> &prev = trace[d - 1];
+      int k = x - y;
+
+      int prevK;
+      if(k == -d || (k != d && prev[k - 1 + d - 1] < prev[k + 1 + d - 1]))
+        prevK = k + 1;
+      else
+        prevK = k - 1;
+
+      int prevX = prev[prevK + d - 1];
+      int prevY = prevX - prevK;
+
+      while(x > prevX && y > prevY)
+      {
+        x--;
+        y--;
+        DiffEdit e = {eDiffEdit_Same, uint32_t(prefix + x), uint32_t(prefix + y)};
+        edits.push_back(e);
+      }
+
+      if(prevK == k + 1)
+      {
+        DiffEdit e = {eDiffEdit_Added, 0, uint32_t(prefix + prevY)};
+        edits.push_back(e);
+      }
+      else
+      {
+        DiffEdit e = {eDiffEdit_Removed, uint32_t(prefix + prevX), 0};
+        edits.push_back(e);
+      }
+
+      x = prevX;
+      y = prevY;
+    }
+
+    while(x > 0 && y > 0)
+    {
+      x--;
+      y--;
+      DiffEdit e = {eDiffEdit_Same, uint32_t(prefix + x), uint32_t(prefix + y)};
+      edits.push_back(e);
+    }
+
+    std::reverse(edits.begin() + middleStart, edits.end());
+  }
+  else
+  {
+    // too different to be worth a minimal diff, compare by position instead
+    for(int i = 0; i < RDCMAX(N, M); i++)
+    {
+      if(i < N && i < M && a[prefix + i] == b[prefix + i])
+      {
+        DiffEdit e = {eDiffEdit_Same, uint32_t(prefix + i), uint32_t(prefix + i)};
+        edits.push_back(e);
+        continue;
+      }
+
+      if(i < N)
+      {
+        DiffEdit e = {eDiffEdit_Removed, uint32_t(prefix + i), 0};
+        edits.push_back(e);
+      }
+      if(i < M)
+      {
+        DiffEdit e = {eDiffEdit_Added, 0, uint32_t(prefix + i)};
+        edits.push_back(e);
+      }
+    }
+  }
+
+  for(int i = 0; i < suffix; i++)
+  {
+    DiffEdit e = {eDiffEdit_Same, uint32_t(n - suffix + i), uint32_t(m - suffix + i)};
+    edits.push_back(e);
+  }
+}
+
+struct DiffRegionResult
+{
+  uint32_t unchanged, added, removed, changed;
+  vector<string> listed;
+  bool truncated;
+};
+
+static void DiffListChange(DiffRegionResult &res, uint32_t maxListed, const CaptureChunkInfo &info,
+                           const char *op, const DiffChunk *a, const DiffChunk *b)
+{
+  if(res.listed.size() >= maxListed)
+  {
+    res.truncated = true;
+    return;
+  }
+
+  const char *name = info.chunkName((a ? a : b)->type);
+
+  string entry = StringFormat::Fmt("{\"op\": \"%s\", \"chunk\": \"%s\"", op,
+                                   jsonescape(name ? name : "Unknown").c_str());
+  if(a)
+    entry += StringFormat::Fmt(", \"a\": %u", a->number);
+  if(b)
+    entry += StringFormat::Fmt(", \"b\": %u", b->number);
+  entry += "}";
+
+  res.listed.push_back(entry);
+}
+
+static DiffRegionResult DiffRegions(const DiffRegion *a, const DiffRegion *b, uint32_t maxListed,
+                                    const CaptureChunkInfo &info)
+{
+  DiffRegionResult res;
+  res.unchanged = res.added = res.removed = res.changed = 0;
+  res.truncated = false;
+
+  static const vector<DiffChunk> empty;
+  const vector<DiffChunk> &ac = a ? a->chunks : empty;
+  const vector<DiffChunk> &bc = b ? b->chunks : empty;
+
+  vector<DiffEdit> edits;
+  DiffChunkSequences(ac, bc, edits);
+
+  // between each pair of unchanged chunks, a removed and an added chunk of the same type are
+  // reported as one changed call
+  size_t i = 0;
+  while(i < edits.size())
+  {
+    if(edits[i].type == eDiffEdit_Same)
+    {
+      res.unchanged++;
+      i++;
+      continue;
+    }
+
+    vector<uint32_t> removed, added;
+    for(; i < edits.size() && edits[i].type != eDiffEdit_Same; i++)
+    {
+      if(edits[i].type == eDiffEdit_Removed)
+        removed.push_back(edits[i].a);
+      else
+        added.push_back(edits[i].b);
+    }
+
+    vector<bool> addedUsed(added.size(), false);
+    size_t searchStart = 0;
+
+    for(size_t r = 0; r < removed.size(); r++)
+    {
+      const DiffChunk &rc = ac[removed[r]];
+
+      size_t match = added.size();
+      for(size_t j = searchStart; j < added.size(); j++)
+      {
+        if(!addedUsed[j] && bc[added[j]].type == rc.type)
+        {
+          match = j;
+          break;
+        }
+      }
+
+      if(match < added.size())
+      {
+        addedUsed[match] = true;
+        searchStart = match + 1;
+        res.changed++;
+        DiffListChange(res, maxListed, info, "changed", &rc, &bc[added[match]]);
+      }
+      else
+      {
+        res.removed++;
+        DiffListChange(res, maxListed, info, "removed", &rc, NULL);
+      }
+    }
+
+    for(size_t j = 0; j < added.size(); j++)
+    {
+      if(addedUsed[j])
+        continue;
+
+      res.added++;
+      DiffListChange(res, maxListed, info, "added", NULL, &bc[added[j]]);
+    }
+  }
+
+  return res;
+}
+
+static string DiffRegionJSON(const string &name, const char *status, const DiffRegionResult &res)
+{
+  string ret = StringFormat::Fmt(
+      "{\"name\": \"%s\", \"status\": \"%s\", \"unchanged\": %u, \"added\": %u, \"removed\": %u, "
+      "\"changed\": %u, \"truncated\": %s, \"changes\": [",
+      jsonescape(name).c_str(), status, res.unchanged, res.added, res.removed, res.changed,
+      res.truncated ? "true" : "false");
+
+  for(size_t i = 0; i < res.listed.size(); i++)
+  {
+    ret += "\n      ";
+    ret += res.listed[i];
+    if(i + 1 < res.listed.size())
+      ret += ",";
+  }
+
+  ret += "]}";
+
+  return ret;
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_DiffCaptures(const char *fileA,
+                                                                    const char *fileB,
+                                                                    uint32_t maxListed,
+                                                                    rdctype::str *json)
+{
+  if(json == NULL)
+    return false;
+
+  PerformanceTimer timer;
+
+  RDCDriver driverTypes[2] = {RDC_Unknown, RDC_Unknown};
+  string driverNames[2];
+  const char *files[2] = {fileA, fileB};
+
+  for(int i = 0; i < 2; i++)
+  {
+    uint64_t fileMachineIdent = 0;
+    ReplayCreateStatus status = RenderDoc::Inst().FillInitParams(
+        files[i], driverTypes[i], driverNames[i], fileMachineIdent, NULL);
+
+    if(status != eReplayCreate_Success)
+    {
+      RDCERR("Couldn't open '%s' to diff: %d", files[i], status);
+      return false;
+    }
+  }
+
+  if(driverTypes[0] != driverTypes[1])
+  {
+    RDCERR("Can't diff a %s capture against a %s capture", driverNames[0].c_str(),
+           driverNames[1].c_str());
+    return false;
+  }
+
+  CaptureChunkInfo info;
+  if(!RenderDoc::Inst().GetCaptureChunkInfo(driverTypes[0], info))
+  {
+    RDCERR("%s captures can't be diffed", driverNames[0].c_str());
+    return false;
+  }
+
+  // the two captures are independent, so read and hash them in parallel
+  DiffCapture caps[2];
+  Threading::ThreadHandle threads[2];
+  for(int i = 0; i < 2; i++)
+  {
+    caps[i].filename = files[i];
+    caps[i].info = info;
+    caps[i].success = false;
+    caps[i].numChunks = 0;
+    threads[i] = Threading::CreateThread(&DiffReadCapture, &caps[i]);
+  }
+
+  for(int i = 0; i < 2; i++)
+  {
+    Threading::JoinThread(threads[i]);
+    Threading::CloseThread(threads[i]);
+  }
+
+  if(!caps[0].success || !caps[1].success)
+    return false;
+
+  double readTime = timer.GetMilliseconds();
+
+  uint32_t totalAdded = 0, totalRemoved = 0, totalChanged = 0;
+  vector<string> regionJSON;
+
+  DiffRegionResult resources = DiffRegions(&caps[0].resources, &caps[1].resources, maxListed, info);
+
+  totalAdded += resources.added;
+  totalRemoved += resources.removed;
+  totalChanged += resources.changed;
+
+  map<string, size_t> regionsB;
+  for(size_t i = 0; i < caps[1].regions.size(); i++)
+    regionsB[caps[1].regions[i].name] = i;
+
+  vector<bool> matchedB(caps[1].regions.size(), false);
+
+  // regions are reported in the order of the first capture, then any that are only in the second
+  for(size_t i = 0; i < caps[0].regions.size(); i++)
+  {
+    const DiffRegion &ra = caps[0].regions[i];
+
+    const DiffRegion *rb = NULL;
+    auto it = regionsB.find(ra.name);
+    if(it != regionsB.end())
+    {
+      rb = &caps[1].regions[it->second];
+      matchedB[it->second] = true;
+    }
+
+    DiffRegionResult res = DiffRegions(&ra, rb, maxListed, info);
+
+    totalAdded += res.added;
+    totalRemoved += res.removed;
+    totalChanged += res.changed;
+
+    if(rb == NULL)
+      regionJSON.push_back(DiffRegionJSON(ra.name, "removed", res));
+    else if(res.added || res.removed || res.changed)
+      regionJSON.push_back(DiffRegionJSON(ra.name, "matched", res));
+  }
+
+  for(size_t i = 0; i < caps[1].regions.size(); i++)
+  {
+    if(matchedB[i])
+      continue;
+
+    DiffRegionResult res = DiffRegions(NULL, &caps[1].regions[i], maxListed, info);
+
+    totalAdded += res.added;
+
+    regionJSON.push_back(DiffRegionJSON(caps[1].regions[i].name, "added", res));
+  }
+
+  double totalTime = timer.GetMilliseconds();
+
+  bool identical = totalAdded == 0 && totalRemoved == 0 && totalChanged == 0 && regionJSON.empty();
+
+  string ret = "{\n";
+  ret += StringFormat::Fmt("  \"fileA\": \"%s\",\n", jsonescape(fileA).c_str());
+  ret += StringFormat::Fmt("  \"fileB\": \"%s\",\n", jsonescape(fileB).c_str());
+  ret += StringFormat::Fmt("  \"driver\": \"%s\",\n", jsonescape(driverNames[0]).c_str());
+  ret += StringFormat::Fmt("  \"chunksA\": %u,\n", caps[0].numChunks);
+  ret += StringFormat::Fmt("  \"chunksB\": %u,\n", caps[1].numChunks);
+  ret += StringFormat::Fmt("  \"regionsA\": %u,\n", (uint32_t)caps[0].regions.size());
+  ret += StringFormat::Fmt("  \"regionsB\": %u,\n", (uint32_t)caps[1].regions.size());
+  ret += StringFormat::Fmt("  \"readMs\": %.3f,\n", readTime);
+  ret += StringFormat::Fmt("  \"totalMs\": %.3f,\n", totalTime);
+  ret += StringFormat::Fmt("  \"identical\": %s,\n", identical ? "true" : "false");
+  ret += StringFormat::Fmt("  \"added\": %u,\n", totalAdded);
+  ret += StringFormat::Fmt("  \"removed\": %u,\n", totalRemoved);
+  ret += StringFormat::Fmt("  \"changed\": %u,\n", totalChanged);
+  ret += "  \"resources\": " + DiffRegionJSON("resources", "matched", resources) + ",\n";
+
+  ret += "  \"regions\": [\n";
+  for(size_t i = 0; i < regionJSON.size(); i++)
+    ret += "    " + regionJSON[i] + (i + 1 < regionJSON.size() ? ",\n" : "\n");
+  ret += "  ]\n";
+
+  ret += "}\n";
+
+  *json = ret;
+
+  return true;
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_ExportTrace(const char *filename)
+{
+  return Tracing::Export(filename);
+}
+
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_FreeArrayMem(const void *mem)
 {
   rdctype::array<char>::deallocate(mem);
@@ -0,0 +1,80 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "replay_driver.h"
+#include <algorithm>
+
+void CompactIndices(vector<uint32_t> &indices, vector<uint32_t> &uniqueIndices)
+{
+  uniqueIndices.clear();
+
+  if(indices.empty())
+    return;
+
+  uint32_t minIndex = indices[0], maxIndex = indices[0];
+  for(size_t i = 1; i < indices.size(); i++)
+  {
+    minIndex = RDCMIN(minIndex, indices[i]);
+    maxIndex = RDCMAX(maxIndex, indices[i]);
+  }
+
+  uint64_t range = uint64_t(maxIndex - minIndex) + 1;
+
+  // when the indices are dense enough a table over their range finds and remaps the unique set in
+  // linear time. Sparse or garbage indices, like 0xcccccccc, are sorted instead so we don't need a
+  // table of billions of entries.
+  if(range <= RDCMAX(uint64_t(indices.size()) * 4, uint64_t(64 * 1024)))
+  {
+    const uint32_t unused = ~0U;
+
+    vector<uint32_t> remap((size_t)range, unused);
+
+    for(size_t i = 0; i < indices.size(); i++)
+      remap[indices[i] - minIndex] = 0;
+
+    for(size_t r = 0; r < remap.size(); r++)
+    {
+      if(remap[r] == unused)
+        continue;
+
+      remap[r] = (uint32_t)uniqueIndices.size();
+      uniqueIndices.push_back(minIndex + uint32_t(r));
+    }
+
+    for(size_t i = 0; i < indices.size(); i++)
+      indices[i] = remap[indices[i] - minIndex];
+  }
+  else
+  {
+    uniqueIndices = indices;
+    std::sort(uniqueIndices.begin(), uniqueIndices.end());
+    uniqueIndices.erase(std::unique(uniqueIndices.begin(), uniqueIndices.end()),
+                        uniqueIndices.end());
+
+    for(size_t i = 0; i < indices.size(); i++)
+      indices[i] = uint32_t(
+          std::lower_bound(uniqueIndices.begin(), uniqueIndices.end(), indices[i]) -
+          uniqueIndices.begin());
+  }
+}
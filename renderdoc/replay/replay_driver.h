@@ -37,11 +37,16 @@ struct FetchFrameRecord
   rdctype::array<FetchDrawcall> drawcallList;
 };
 
+// drivers only need to handle RGBA8 and RGBA32 (float). The 16-bit remaps are only requested by
+// the replay proxy, which reads back RGBA32 from the driver and packs it before sending.
 enum RemapTextureEnum
 {
   eRemap_None,
   eRemap_RGBA8,
+  // 16-bit unorm
   eRemap_RGBA16,
+  // 16-bit float
+  eRemap_RGBA16F,
   eRemap_RGBA32,
   eRemap_D32S8
 };
@@ -117,9 +122,18 @@ public:
 
   virtual void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
                              vector<byte> &retData) = 0;
+  // retData is resized to one entry per range. Drivers that have no cost per readback can just
+  // loop over GetBufferData.
+  virtual void GetBuffersData(const vector<BufferDataRange> &ranges,
+                              vector<vector<byte> > &retData) = 0;
   virtual byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                const GetTextureDataParams &params, size_t &dataSize) = 0;
 
+  // Called from a worker thread, so must only do thread-safe work that doesn't touch the device.
+  // Compiles the shader ahead of time, so that a following BuildTargetShader with the same
+  // parameters can skip straight to creating it. Drivers that can't compile off-thread do nothing.
+  virtual void PrecompileTargetShader(string source, string entry, const uint32_t compileFlags,
+                                      ShaderStageType type) = 0;
   virtual void BuildTargetShader(string source, string entry, const uint32_t compileFlags,
                                  ShaderStageType type, ResourceId *id, string *errors) = 0;
   virtual void ReplaceResource(ResourceId from, ResourceId to) = 0;
@@ -152,6 +166,12 @@ public:
 
   virtual void FileChanged() = 0;
 
+  // memory the replay is using, one entry per category it knows about
+  virtual vector<ReplayMemoryStats> GetMemoryStats() = 0;
+  // frees cached data in category until it fits in budget bytes, keeping anything needed for
+  // eventID. Categories that can't be evicted are ignored.
+  virtual void TrimMemory(ReplayMemoryCategory category, uint64_t budget, uint32_t eventID) = 0;
+
   virtual void InitCallstackResolver() = 0;
   virtual bool HasCallstacks() = 0;
   virtual Callstack::StackResolver *GetCallstackResolver() = 0;
@@ -161,6 +181,15 @@ class IReplayDriver : public IRemoteDriver
 {
 public:
   virtual bool IsRemoteProxy() = 0;
+  // per-command traffic and timing of a remote replay, empty for local replays
+  virtual vector<ProxyCommandStats> GetProxyStats() = 0;
+  // the page of texture or buffer descriptions matching a query, and how many match in total.
+  // Over a proxy the query is answered on the remote side so only the page is sent back. Local
+  // drivers return false, and the replay renderer answers the query from its own lists.
+  virtual bool QueryTextures(const ResourceQuery &query, vector<FetchTexture> &page,
+                             uint32_t &total) = 0;
+  virtual bool QueryBuffers(const ResourceQuery &query, vector<FetchBuffer> &page,
+                            uint32_t &total) = 0;
 
   virtual vector<WindowingSystem> GetSupportedWindowSystems() = 0;
 
@@ -179,6 +208,27 @@ public:
   virtual bool GetHistogram(ResourceId texid, uint32_t sliceFace, uint32_t mip, uint32_t sample,
                             FormatComponentType typeHint, float minval, float maxval,
                             bool channels[4], vector<uint32_t> &histogram) = 0;
+  // find float values matching params on the GPU. numMatches is the total number found, matches
+  // holds at most params.maxMatches of them in no particular order. Returns false if the search
+  // can't be done (e.g. integer textures, or unsupported on this API), and the texture is then
+  // read back and searched on the CPU instead.
+  virtual bool SearchTextureValues(ResourceId texid, uint32_t sliceFace, uint32_t mip,
+                                   uint32_t sample, const ValueSearchParams &params,
+                                   vector<ValueSearchMatch> &matches, uint32_t &numMatches) = 0;
+  // as above, treating the buffer as numElems elements of stride bytes from offset, each made of
+  // 32-bit floats. channelMask selects which floats in each element are checked.
+  virtual bool SearchBufferValues(ResourceId buff, uint64_t offset, uint32_t stride,
+                                  uint32_t numElems, const ValueSearchParams &params,
+                                  vector<ValueSearchMatch> &matches, uint32_t &numMatches) = 0;
+
+  // copy a subresource as raw floats into one of two inputs (0 or 1) kept on the GPU. The inputs
+  // stay until they're next set, so they can come from different events. Returning false makes
+  // the caller compare on the CPU instead.
+  virtual bool SetTextureDiffInput(uint32_t input, ResourceId texid, uint32_t sliceFace,
+                                   uint32_t mip, uint32_t sample,
+                                   FormatComponentType typeHint) = 0;
+  // compare the two inputs into a diff texture, reducing it down to the stats in result
+  virtual bool DiffTextureInputs(float threshold, TextureCompareResult &result) = 0;
 
   virtual ResourceId CreateProxyTexture(const FetchTexture &templateTex) = 0;
   virtual void SetProxyTextureData(ResourceId texid, uint32_t arrayIdx, uint32_t mip, byte *data,
@@ -186,12 +236,20 @@ public:
   virtual bool IsTextureSupported(const ResourceFormat &format) = 0;
 
   virtual ResourceId CreateProxyBuffer(const FetchBuffer &templateBuf) = 0;
-  virtual void SetProxyBufferData(ResourceId bufid, byte *data, size_t dataSize) = 0;
+  // uploads dataSize bytes at offset, which need not cover the whole buffer
+  virtual void SetProxyBufferData(ResourceId bufid, uint64_t offset, byte *data,
+                                  size_t dataSize) = 0;
 
   virtual void RenderMesh(uint32_t eventID, const vector<MeshFormat> &secondaryDraws,
                           const MeshDisplay &cfg) = 0;
   virtual bool RenderTexture(TextureDisplay cfg) = 0;
+  // true if any RenderTexture since the last call drew a texture that isn't fully available yet,
+  // such as one still streaming from a remote replay, so rendering again would show more of it
+  virtual bool HasPendingTextureData() = 0;
 
+  // as PrecompileTargetShader, for a following BuildCustomShader
+  virtual void PrecompileCustomShader(string source, string entry, const uint32_t compileFlags,
+                                      ShaderStageType type) = 0;
   virtual void BuildCustomShader(string source, string entry, const uint32_t compileFlags,
                                  ShaderStageType type, ResourceId *id, string *errors) = 0;
   virtual ResourceId ApplyCustomShader(ResourceId shader, ResourceId texid, uint32_t mip,
@@ -208,6 +266,11 @@ public:
   virtual uint32_t PickVertex(uint32_t eventID, const MeshDisplay &cfg, uint32_t x, uint32_t y) = 0;
 };
 
+// replaces each index with its position in the sorted set of unique indices, returned in
+// uniqueIndices. Post-VS data is then only fetched for the vertices a draw actually references, and
+// the remapped indices point into it.
+void CompactIndices(vector<uint32_t> &indices, vector<uint32_t> &uniqueIndices);
+
 // utility function useful in any driver implementation
 template <typename FetchDrawcallContainer>
 FetchDrawcall *SetupDrawcallPointers(vector<FetchDrawcall *> *drawcallTable,
@@ -23,7 +23,9 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <algorithm>
 #include "common/common.h"
+#include "maths/camera.h"
 #include "maths/matrix.h"
 #include "serialise/string_utils.h"
 #include "replay_renderer.h"
@@ -93,6 +95,13 @@ ReplayOutput::ReplayOutput(ReplayRenderer *parent, WindowingSystem system, void
   m_ContextX = -1.0f;
   m_ContextY = -1.0f;
 
+  RDCEraseEl(m_LastCameraMatrix);
+
+  m_AtlasColumns = m_AtlasRows = 0;
+  m_Atlas.outputID = 0;
+  m_Atlas.texture = ResourceId();
+  m_Atlas.dirty = false;
+
   m_Config.m_Type = type;
 
   if(system != eWindowingSystem_Unknown)
@@ -105,6 +114,8 @@ ReplayOutput::ReplayOutput(ReplayRenderer *parent, WindowingSystem system, void
   m_pDevice->GetOutputWindowDimensions(m_MainOutput.outputID, m_Width, m_Height);
 
   m_CustomShaderResourceId = ResourceId();
+
+  m_PassMesh.vbSize = m_PassMesh.ibSize = 0;
 }
 
 ReplayOutput::~ReplayOutput()
@@ -117,8 +128,19 @@ ReplayOutput::~ReplayOutput()
   ClearThumbnails();
 }
 
+// the UI sets its display state before every Display(), usually unchanged. Comparing bytes is
+// conservative - differing padding only costs a redundant redraw, never a stale one.
+template <typename T>
+static bool SameDisplayState(const T &a, const T &b)
+{
+  return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
 bool ReplayOutput::SetOutputConfig(const OutputConfig &o)
 {
+  if(SameDisplayState(o, m_Config))
+    return true;
+
   m_OverlayDirty = true;
   m_Config = o;
   m_MainOutput.dirty = true;
@@ -127,6 +149,9 @@ bool ReplayOutput::SetOutputConfig(const OutputConfig &o)
 
 bool ReplayOutput::SetTextureDisplay(const TextureDisplay &o)
 {
+  if(SameDisplayState(o, m_RenderData.texDisplay))
+    return true;
+
   if(o.overlay != m_RenderData.texDisplay.overlay)
   {
     if(m_RenderData.texDisplay.overlay == eTexOverlay_ClearBeforeDraw ||
@@ -139,6 +164,9 @@ bool ReplayOutput::SetTextureDisplay(const TextureDisplay &o)
     }
     m_OverlayDirty = true;
   }
+  // the overlay is rendered for a particular target
+  if(o.texid != m_RenderData.texDisplay.texid || o.typeHint != m_RenderData.texDisplay.typeHint)
+    m_OverlayDirty = true;
   m_RenderData.texDisplay = o;
   m_MainOutput.dirty = true;
   return true;
@@ -146,6 +174,10 @@ bool ReplayOutput::SetTextureDisplay(const TextureDisplay &o)
 
 bool ReplayOutput::SetMeshDisplay(const MeshDisplay &o)
 {
+  // the camera is updated in place, so its matrix is checked separately in Display()
+  if(SameDisplayState(o, m_RenderData.meshDisplay))
+    return true;
+
   if(o.showWholePass != m_RenderData.meshDisplay.showWholePass)
     m_OverlayDirty = true;
   m_RenderData.meshDisplay = o;
@@ -163,9 +195,20 @@ void ReplayOutput::SetFrameEvent(int eventID)
   for(size_t i = 0; i < m_Thumbnails.size(); i++)
     m_Thumbnails[i].dirty = true;
 
+  m_Atlas.dirty = true;
+
   RefreshOverlay();
 }
 
+bool ReplayOutput::IsOverlayCached()
+{
+  const ReplayRenderer::OverlayKey &key = m_pRenderer->m_LastOverlay;
+
+  return key.overlay != eTexOverlay_None && key.overlay == m_RenderData.texDisplay.overlay &&
+         key.eventID == m_EventID && key.texid == m_RenderData.texDisplay.texid &&
+         key.typeHint == m_RenderData.texDisplay.typeHint;
+}
+
 void ReplayOutput::RefreshOverlay()
 {
   FetchDrawcall *draw = m_pRenderer->GetDrawcallByEID(m_EventID);
@@ -186,6 +229,10 @@ void ReplayOutput::RefreshOverlay()
     postVSBuffers = m_RenderData.texDisplay.overlay == eTexOverlay_TriangleSizePass ||
                     m_RenderData.texDisplay.overlay == eTexOverlay_TriangleSizeDraw;
     postVSWholePass = m_RenderData.texDisplay.overlay == eTexOverlay_TriangleSizePass;
+
+    // the post-VS data is only needed to render the overlay
+    if(IsOverlayCached())
+      postVSBuffers = postVSWholePass = false;
   }
 
   if(postVSBuffers)
@@ -208,11 +255,30 @@ void ReplayOutput::RefreshOverlay()
 
   if(m_Config.m_Type == eOutputType_TexDisplay && m_RenderData.texDisplay.overlay != eTexOverlay_None)
   {
-    if(draw && m_pDevice->IsRenderOutput(m_RenderData.texDisplay.texid))
+    if(draw && m_pRenderer->IsRenderOutput(m_RenderData.texDisplay.texid))
     {
-      m_OverlayResourceId = m_pDevice->RenderOverlay(
-          m_pDevice->GetLiveID(m_RenderData.texDisplay.texid), m_RenderData.texDisplay.typeHint,
-          m_RenderData.texDisplay.overlay, m_EventID, passEvents);
+      if(!IsOverlayCached())
+      {
+        ReplayRenderer::OverlayKey &key = m_pRenderer->m_LastOverlay;
+
+        m_OverlayResourceId = m_pDevice->RenderOverlay(
+            m_pDevice->GetLiveID(m_RenderData.texDisplay.texid), m_RenderData.texDisplay.typeHint,
+            m_RenderData.texDisplay.overlay, m_EventID, passEvents);
+
+        key.eventID = m_EventID;
+        key.texid = m_RenderData.texDisplay.texid;
+        key.typeHint = m_RenderData.texDisplay.typeHint;
+        key.overlay = m_RenderData.texDisplay.overlay;
+        key.result = m_OverlayResourceId;
+
+        // these modify the target itself, so they can't be shown again without re-rendering
+        if(key.overlay == eTexOverlay_ClearBeforeDraw || key.overlay == eTexOverlay_ClearBeforePass)
+          key.overlay = eTexOverlay_None;
+      }
+      else
+      {
+        m_OverlayResourceId = m_pRenderer->m_LastOverlay.result;
+      }
       m_OverlayDirty = false;
     }
     else
@@ -229,6 +295,13 @@ bool ReplayOutput::ClearThumbnails()
 
   m_Thumbnails.clear();
 
+  if(m_Atlas.outputID)
+    m_pDevice->DestroyOutputWindow(m_Atlas.outputID);
+
+  m_Atlas.outputID = 0;
+  m_AtlasColumns = m_AtlasRows = 0;
+  m_AtlasCells.clear();
+
   return true;
 }
 
@@ -292,6 +365,76 @@ bool ReplayOutput::AddThumbnail(WindowingSystem system, void *data, ResourceId t
   return true;
 }
 
+bool ReplayOutput::SetThumbnailAtlas(WindowingSystem system, void *data, uint32_t columns,
+                                     uint32_t rows)
+{
+  RDCASSERT(data);
+
+  if(columns == 0 || rows == 0)
+  {
+    RDCERR("Invalid thumbnail atlas layout %u x %u", columns, rows);
+    return false;
+  }
+
+  if(m_Atlas.outputID == 0 || m_Atlas.wndHandle != GetHandle(system, data))
+  {
+    if(m_Atlas.outputID)
+      m_pDevice->DestroyOutputWindow(m_Atlas.outputID);
+
+    m_Atlas.wndHandle = GetHandle(system, data);
+    m_Atlas.outputID = m_pDevice->MakeOutputWindow(system, data, false);
+
+    RDCASSERT(m_Atlas.outputID > 0);
+  }
+
+  m_AtlasColumns = columns;
+  m_AtlasRows = rows;
+
+  OutputPair empty;
+  empty.texture = ResourceId();
+  empty.depthMode = false;
+  empty.wndHandle = 0;
+  empty.typeHint = eCompType_None;
+  empty.outputID = 0;
+  empty.dirty = false;
+
+  m_AtlasCells.clear();
+  m_AtlasCells.resize(columns * rows, empty);
+
+  m_Atlas.dirty = true;
+
+  return true;
+}
+
+bool ReplayOutput::SetAtlasThumbnail(uint32_t cell, ResourceId texID, FormatComponentType typeHint)
+{
+  if(cell >= m_AtlasCells.size())
+  {
+    RDCERR("Atlas cell %u out of range (%u cells)", cell, (uint32_t)m_AtlasCells.size());
+    return false;
+  }
+
+  OutputPair &p = m_AtlasCells[cell];
+
+  p.texture = texID;
+  p.typeHint = typeHint;
+  p.depthMode = false;
+
+  for(size_t t = 0; t < m_pRenderer->m_Textures.size(); t++)
+  {
+    if(m_pRenderer->m_Textures[t].ID == texID)
+    {
+      p.depthMode = (m_pRenderer->m_Textures[t].creationFlags & eTextureCreate_DSV) > 0;
+      p.depthMode |= (m_pRenderer->m_Textures[t].format.compType == eCompType_Depth);
+      break;
+    }
+  }
+
+  m_Atlas.dirty = true;
+
+  return true;
+}
+
 bool ReplayOutput::GetMinMax(PixelValue *minval, PixelValue *maxval)
 {
   PixelValue *a = minval;
@@ -304,8 +447,6 @@ bool ReplayOutput::GetMinMax(PixelValue *minval, PixelValue *maxval)
   if(b == NULL)
     b = &dummy;
 
-  ResourceId tex = m_pDevice->GetLiveID(m_RenderData.texDisplay.texid);
-
   FormatComponentType typeHint = m_RenderData.texDisplay.typeHint;
   uint32_t slice = m_RenderData.texDisplay.sliceFace;
   uint32_t mip = m_RenderData.texDisplay.mip;
@@ -313,13 +454,12 @@ bool ReplayOutput::GetMinMax(PixelValue *minval, PixelValue *maxval)
 
   if(m_RenderData.texDisplay.CustomShader != ResourceId() && m_CustomShaderResourceId != ResourceId())
   {
-    tex = m_CustomShaderResourceId;
-    typeHint = eCompType_None;
-    slice = 0;
-    sample = 0;
+    return m_pDevice->GetMinMax(m_CustomShaderResourceId, 0, mip, 0, eCompType_None,
+                                &a->value_f[0], &b->value_f[0]);
   }
 
-  return m_pDevice->GetMinMax(tex, slice, mip, sample, typeHint, &a->value_f[0], &b->value_f[0]);
+  return m_pRenderer->GetTextureMinMax(m_RenderData.texDisplay.texid, slice, mip, sample, typeHint,
+                                       a, b);
 }
 
 bool ReplayOutput::GetHistogram(float minval, float maxval, bool channels[4],
@@ -330,23 +470,19 @@ bool ReplayOutput::GetHistogram(float minval, float maxval, bool channels[4],
 
   vector<uint32_t> hist;
 
-  ResourceId tex = m_pDevice->GetLiveID(m_RenderData.texDisplay.texid);
-
   FormatComponentType typeHint = m_RenderData.texDisplay.typeHint;
   uint32_t slice = m_RenderData.texDisplay.sliceFace;
   uint32_t mip = m_RenderData.texDisplay.mip;
   uint32_t sample = m_RenderData.texDisplay.sampleIdx;
 
-  if(m_RenderData.texDisplay.CustomShader != ResourceId() && m_CustomShaderResourceId != ResourceId())
-  {
-    tex = m_CustomShaderResourceId;
-    typeHint = eCompType_None;
-    slice = 0;
-    sample = 0;
-  }
+  bool ret = false;
 
-  bool ret =
-      m_pDevice->GetHistogram(tex, slice, mip, sample, typeHint, minval, maxval, channels, hist);
+  if(m_RenderData.texDisplay.CustomShader != ResourceId() && m_CustomShaderResourceId != ResourceId())
+    ret = m_pDevice->GetHistogram(m_CustomShaderResourceId, 0, mip, 0, eCompType_None, minval,
+                                  maxval, channels, hist);
+  else
+    ret = m_pRenderer->GetTextureHistogram(m_RenderData.texDisplay.texid, slice, mip, sample,
+                                           typeHint, minval, maxval, channels, hist);
 
   if(ret)
     *histogram = hist;
@@ -576,6 +712,110 @@ void ReplayOutput::DisplayContext()
   m_pDevice->FlipOutputWindow(m_PixelContext.outputID);
 }
 
+TextureDisplay ReplayOutput::GetThumbnailDisplay(const OutputPair &thumb)
+{
+  TextureDisplay disp;
+
+  disp.Red = disp.Green = disp.Blue = true;
+  disp.Alpha = false;
+  disp.HDRMul = -1.0f;
+  disp.linearDisplayAsGamma = true;
+  disp.FlipY = false;
+  disp.mip = 0;
+  disp.sampleIdx = ~0U;
+  disp.CustomShader = ResourceId();
+  disp.texid = m_pDevice->GetLiveID(thumb.texture);
+  disp.typeHint = thumb.typeHint;
+  disp.scale = -1.0f;
+  disp.rangemin = 0.0f;
+  disp.rangemax = 1.0f;
+  disp.sliceFace = 0;
+  disp.offx = 0.0f;
+  disp.offy = 0.0f;
+  disp.rawoutput = false;
+  disp.overlay = eTexOverlay_None;
+
+  disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector();
+
+  if(thumb.typeHint == eCompType_SNorm)
+    disp.rangemin = -1.0f;
+
+  if(thumb.depthMode)
+    disp.Green = disp.Blue = false;
+
+  return disp;
+}
+
+void ReplayOutput::DisplayAtlas()
+{
+  if(m_pDevice->CheckResizeOutputWindow(m_Atlas.outputID))
+    m_Atlas.dirty = true;
+
+  if(!m_Atlas.dirty)
+  {
+    m_pDevice->BindOutputWindow(m_Atlas.outputID, false);
+    m_pDevice->FlipOutputWindow(m_Atlas.outputID);
+    return;
+  }
+
+  if(!m_pDevice->IsOutputWindowVisible(m_Atlas.outputID))
+    return;
+
+  int32_t w = 0, h = 0;
+  m_pDevice->GetOutputWindowDimensions(m_Atlas.outputID, w, h);
+
+  m_pDevice->BindOutputWindow(m_Atlas.outputID, false);
+
+  float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  m_pDevice->ClearOutputWindowColour(m_Atlas.outputID, color);
+
+  float cellWidth = float(w) / float(m_AtlasColumns);
+  float cellHeight = float(h) / float(m_AtlasRows);
+
+  for(size_t i = 0; i < m_AtlasCells.size(); i++)
+  {
+    const OutputPair &cell = m_AtlasCells[i];
+
+    if(cell.texture == ResourceId())
+      continue;
+
+    const FetchTexture *tex = NULL;
+
+    for(size_t t = 0; t < m_pRenderer->m_Textures.size(); t++)
+    {
+      if(m_pRenderer->m_Textures[t].ID == cell.texture)
+      {
+        tex = &m_pRenderer->m_Textures[t];
+        break;
+      }
+    }
+
+    if(tex == NULL || tex->width == 0 || tex->height == 0)
+      continue;
+
+    TextureDisplay disp = GetThumbnailDisplay(cell);
+
+    // the drivers can only fit a texture to the whole window, so do the fit to the cell here.
+    // Each texture lands entirely inside its own cell so no clipping is needed.
+    float texWidth = float(tex->width);
+    float texHeight = float(tex->height);
+
+    disp.scale = RDCMIN(cellWidth / texWidth, cellHeight / texHeight);
+
+    float cellX = float(i % m_AtlasColumns) * cellWidth;
+    float cellY = float(i / m_AtlasColumns) * cellHeight;
+
+    disp.offx = cellX + (cellWidth - texWidth * disp.scale) * 0.5f;
+    disp.offy = cellY + (cellHeight - texHeight * disp.scale) * 0.5f;
+
+    m_pDevice->RenderTexture(disp);
+  }
+
+  m_pDevice->FlipOutputWindow(m_Atlas.outputID);
+
+  m_Atlas.dirty = false;
+}
+
 bool ReplayOutput::Display()
 {
   if(m_pDevice->CheckResizeOutputWindow(m_MainOutput.outputID))
@@ -617,34 +857,7 @@ bool ReplayOutput::Display()
     m_pDevice->BindOutputWindow(m_Thumbnails[i].outputID, false);
     m_pDevice->ClearOutputWindowColour(m_Thumbnails[i].outputID, color);
 
-    TextureDisplay disp;
-
-    disp.Red = disp.Green = disp.Blue = true;
-    disp.Alpha = false;
-    disp.HDRMul = -1.0f;
-    disp.linearDisplayAsGamma = true;
-    disp.FlipY = false;
-    disp.mip = 0;
-    disp.sampleIdx = ~0U;
-    disp.CustomShader = ResourceId();
-    disp.texid = m_pDevice->GetLiveID(m_Thumbnails[i].texture);
-    disp.typeHint = m_Thumbnails[i].typeHint;
-    disp.scale = -1.0f;
-    disp.rangemin = 0.0f;
-    disp.rangemax = 1.0f;
-    disp.sliceFace = 0;
-    disp.offx = 0.0f;
-    disp.offy = 0.0f;
-    disp.rawoutput = false;
-    disp.overlay = eTexOverlay_None;
-
-    disp.lightBackgroundColour = disp.darkBackgroundColour = FloatVector();
-
-    if(m_Thumbnails[i].typeHint == eCompType_SNorm)
-      disp.rangemin = -1.0f;
-
-    if(m_Thumbnails[i].depthMode)
-      disp.Green = disp.Blue = false;
+    TextureDisplay disp = GetThumbnailDisplay(m_Thumbnails[i]);
 
     m_pDevice->RenderTexture(disp);
 
@@ -653,9 +866,23 @@ bool ReplayOutput::Display()
     m_Thumbnails[i].dirty = false;
   }
 
+  if(m_Atlas.outputID)
+    DisplayAtlas();
+
   if(m_pDevice->CheckResizeOutputWindow(m_PixelContext.outputID))
     m_MainOutput.dirty = true;
 
+  if(m_Config.m_Type == eOutputType_MeshDisplay && m_RenderData.meshDisplay.cam)
+  {
+    Matrix4f camMat = m_RenderData.meshDisplay.cam->GetMatrix();
+
+    if(memcmp(camMat.Data(), m_LastCameraMatrix, sizeof(m_LastCameraMatrix)))
+    {
+      memcpy(m_LastCameraMatrix, camMat.Data(), sizeof(m_LastCameraMatrix));
+      m_MainOutput.dirty = true;
+    }
+  }
+
   if(!m_MainOutput.dirty)
   {
     m_pDevice->BindOutputWindow(m_MainOutput.outputID, false);
@@ -678,6 +905,16 @@ bool ReplayOutput::Display()
 
   DisplayContext();
 
+  // over a remote connection a large texture first arrives as a low resolution preview, and the
+  // rest streams in each time it's rendered. Keep redrawing until it's all here so each step
+  // shows up as soon as it arrives instead of waiting for the whole texture.
+  while(m_Config.m_Type == eOutputType_TexDisplay && m_pDevice->HasPendingTextureData())
+  {
+    DisplayTex();
+
+    m_pDevice->FlipOutputWindow(m_MainOutput.outputID);
+  }
+
   return true;
 }
 
@@ -705,9 +942,17 @@ void ReplayOutput::DisplayTex()
   {
     if(m_OverlayDirty)
     {
-      m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
-      RefreshOverlay();
-      m_pDevice->ReplayLog(m_EventID, eReplay_OnlyDraw);
+      // no need to replay to the event if there's nothing to render
+      if(IsOverlayCached())
+      {
+        RefreshOverlay();
+      }
+      else
+      {
+        m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
+        RefreshOverlay();
+        m_pDevice->ReplayLog(m_EventID, eReplay_OnlyDraw);
+      }
     }
   }
   else if(m_ForceOverlayRefresh)
@@ -742,7 +987,7 @@ void ReplayOutput::DisplayTex()
   m_pDevice->RenderTexture(texDisplay);
 
   if(m_RenderData.texDisplay.overlay != eTexOverlay_None && draw &&
-     m_pDevice->IsRenderOutput(m_RenderData.texDisplay.texid) &&
+     m_pRenderer->IsRenderOutput(m_RenderData.texDisplay.texid) &&
      m_RenderData.texDisplay.overlay != eTexOverlay_NaN &&
      m_RenderData.texDisplay.overlay != eTexOverlay_Clipping)
   {
@@ -761,6 +1006,304 @@ void ReplayOutput::DisplayTex()
   }
 }
 
+// which merged draw a topology can be appended to, or -1 if it has to be drawn on its own
+static int MergedMeshClass(PrimitiveTopology topo)
+{
+  switch(topo)
+  {
+    case eTopology_PointList: return 0;
+    case eTopology_LineList:
+    case eTopology_LineStrip:
+    case eTopology_LineLoop: return 1;
+    case eTopology_TriangleList:
+    case eTopology_TriangleStrip:
+    case eTopology_TriangleFan: return 2;
+    default: break;
+  }
+
+  return -1;
+}
+
+static void AppendMergedPrimitive(const uint32_t *verts, uint32_t count, uint32_t base,
+                                  uint32_t numVerts, vector<uint32_t> &out)
+{
+  // primitives that read past the end of the vertex data are dropped
+  for(uint32_t i = 0; i < count; i++)
+    if(verts[i] >= numVerts)
+      return;
+
+  for(uint32_t i = 0; i < count; i++)
+    out.push_back(base + verts[i]);
+}
+
+// strips, loops and fans are expanded to lists so that draws of one class can go in one draw
+static void AppendMergedPrimitives(const vector<uint32_t> &local, PrimitiveTopology topo,
+                                   uint32_t base, uint32_t numVerts, vector<uint32_t> &out)
+{
+  uint32_t n = (uint32_t)local.size();
+  uint32_t prim[3];
+
+  switch(topo)
+  {
+    case eTopology_PointList:
+      for(uint32_t i = 0; i < n; i++)
+        AppendMergedPrimitive(&local[i], 1, base, numVerts, out);
+      break;
+    case eTopology_LineList:
+      for(uint32_t i = 0; i + 1 < n; i += 2)
+        AppendMergedPrimitive(&local[i], 2, base, numVerts, out);
+      break;
+    case eTopology_LineStrip:
+    case eTopology_LineLoop:
+      for(uint32_t i = 0; i + 1 < n; i++)
+        AppendMergedPrimitive(&local[i], 2, base, numVerts, out);
+      if(topo == eTopology_LineLoop && n > 2)
+      {
+        prim[0] = local[n - 1];
+        prim[1] = local[0];
+        AppendMergedPrimitive(prim, 2, base, numVerts, out);
+      }
+      break;
+    case eTopology_TriangleList:
+      for(uint32_t i = 0; i + 2 < n; i += 3)
+        AppendMergedPrimitive(&local[i], 3, base, numVerts, out);
+      break;
+    case eTopology_TriangleStrip:
+      for(uint32_t i = 0; i + 2 < n; i++)
+        AppendMergedPrimitive(&local[i], 3, base, numVerts, out);
+      break;
+    case eTopology_TriangleFan:
+      for(uint32_t i = 1; i + 1 < n; i++)
+      {
+        prim[0] = local[0];
+        prim[1] = local[i];
+        prim[2] = local[i + 1];
+        AppendMergedPrimitive(prim, 3, base, numVerts, out);
+      }
+      break;
+    default: break;
+  }
+}
+
+static bool SameMeshSources(const vector<MeshFormat> &a, const vector<MeshFormat> &b)
+{
+  if(a.size() != b.size())
+    return false;
+
+  for(size_t i = 0; i < a.size(); i++)
+  {
+    if(a[i].buf != b[i].buf || a[i].offset != b[i].offset || a[i].stride != b[i].stride ||
+       a[i].idxbuf != b[i].idxbuf || a[i].idxoffs != b[i].idxoffs ||
+       a[i].idxByteWidth != b[i].idxByteWidth || a[i].baseVertex != b[i].baseVertex ||
+       a[i].numVerts != b[i].numVerts || a[i].topo != b[i].topo)
+      return false;
+  }
+
+  return true;
+}
+
+void ReplayOutput::MergePassMeshes(const vector<MeshFormat> &draws, vector<MeshFormat> &merged)
+{
+  // the post-VS data doesn't change while the same pass is displayed, so the merge is only
+  // rebuilt when the set of draws does
+  if(SameMeshSources(draws, m_PassMesh.sources))
+  {
+    merged.insert(merged.end(), m_PassMesh.merged.begin(), m_PassMesh.merged.end());
+    return;
+  }
+
+  m_PassMesh.sources = draws;
+  m_PassMesh.merged.clear();
+
+  vector<MeshFormat> &out = m_PassMesh.merged;
+
+  // reading back a remote replay's post-VS data would cost more than the draws save
+  if(m_pDevice->IsRemoteProxy() || draws.size() < 2)
+  {
+    out = draws;
+    merged.insert(merged.end(), out.begin(), out.end());
+    return;
+  }
+
+  // only float4 positions can be merged, which is what post-VS data normally is
+  vector<size_t> mergeable;
+  vector<BufferDataRange> idxRanges;
+
+  for(size_t i = 0; i < draws.size(); i++)
+  {
+    const MeshFormat &fmt = draws[i];
+
+    if(fmt.buf == ResourceId() || MergedMeshClass(fmt.topo) < 0 ||
+       fmt.specialFormat != eSpecial_Unknown || fmt.compType != eCompType_Float ||
+       fmt.compByteWidth != 4 || fmt.compCount != 4 || fmt.stride < 16 || fmt.numVerts == 0 ||
+       (fmt.idxbuf != ResourceId() && fmt.idxByteWidth != 2 && fmt.idxByteWidth != 4))
+    {
+      out.push_back(fmt);
+      continue;
+    }
+
+    mergeable.push_back(i);
+
+    if(fmt.idxbuf != ResourceId())
+      idxRanges.push_back(
+          BufferDataRange(fmt.idxbuf, fmt.idxoffs, uint64_t(fmt.numVerts) * fmt.idxByteWidth));
+  }
+
+  vector<vector<byte> > idxData;
+  if(!idxRanges.empty())
+    m_pDevice->GetBuffersData(idxRanges, idxData);
+
+  // the local vertex index of every vertex each draw reads, and the range of vertices it covers
+  vector<vector<uint32_t> > localIndices(mergeable.size());
+  vector<BufferDataRange> vertRanges(mergeable.size());
+
+  for(size_t m = 0, idx = 0; m < mergeable.size(); m++)
+  {
+    const MeshFormat &fmt = draws[mergeable[m]];
+    vector<uint32_t> &local = localIndices[m];
+
+    uint32_t minVert = 0, maxVert = fmt.numVerts - 1;
+
+    if(fmt.idxbuf != ResourceId())
+    {
+      const vector<byte> &data = idxData[idx++];
+      size_t numIndices = data.size() / fmt.idxByteWidth;
+
+      local.resize(numIndices);
+
+      for(size_t i = 0; i < numIndices; i++)
+      {
+        int64_t vert = fmt.baseVertex;
+        if(fmt.idxByteWidth == 2)
+          vert += ((uint16_t *)&data[0])[i];
+        else
+          vert += ((uint32_t *)&data[0])[i];
+        local[i] = vert < 0 ? 0 : uint32_t(vert);
+      }
+
+      if(!local.empty())
+      {
+        minVert = *std::min_element(local.begin(), local.end());
+        maxVert = *std::max_element(local.begin(), local.end());
+      }
+
+      for(size_t i = 0; i < numIndices; i++)
+        local[i] -= minVert;
+    }
+    else
+    {
+      local.resize(fmt.numVerts);
+      for(uint32_t i = 0; i < fmt.numVerts; i++)
+        local[i] = i;
+    }
+
+    vertRanges[m] = BufferDataRange(fmt.buf, fmt.offset + uint64_t(minVert) * fmt.stride,
+                                    uint64_t(maxVert - minVert) * fmt.stride + 16);
+  }
+
+  vector<vector<byte> > vertData;
+  m_pDevice->GetBuffersData(vertRanges, vertData);
+
+  vector<float> verts;
+  vector<uint32_t> indices[3];
+
+  for(size_t m = 0; m < mergeable.size(); m++)
+  {
+    const MeshFormat &fmt = draws[mergeable[m]];
+    const vector<byte> &data = vertData[m];
+
+    uint32_t numVerts = 0;
+    if(data.size() >= 16)
+      numVerts = uint32_t((data.size() - 16) / fmt.stride) + 1;
+
+    uint32_t base = uint32_t(verts.size() / 4);
+
+    verts.resize(verts.size() + numVerts * 4);
+    for(uint32_t v = 0; v < numVerts; v++)
+      memcpy(&verts[(base + v) * 4], &data[v * fmt.stride], sizeof(float) * 4);
+
+    AppendMergedPrimitives(localIndices[m], fmt.topo, base, numVerts,
+                           indices[MergedMeshClass(fmt.topo)]);
+  }
+
+  uint64_t vbSize = verts.size() * sizeof(float);
+  uint64_t ibSize = (indices[0].size() + indices[1].size() + indices[2].size()) * sizeof(uint32_t);
+
+  if(vbSize == 0 || ibSize == 0)
+  {
+    merged.insert(merged.end(), out.begin(), out.end());
+    return;
+  }
+
+  // proxy buffers can't be freed, so grow by at least double to avoid leaving many behind
+  if(vbSize > m_PassMesh.vbSize || m_PassMesh.vb == ResourceId())
+  {
+    FetchBuffer buf = {};
+    buf.name = "Merged pass mesh vertices";
+    buf.customName = true;
+    buf.creationFlags = eBufferCreate_VB;
+    buf.length = RDCMAX(vbSize, m_PassMesh.vbSize * 2);
+
+    m_PassMesh.vb = m_pDevice->CreateProxyBuffer(buf);
+    m_PassMesh.vbSize = m_PassMesh.vb == ResourceId() ? 0 : buf.length;
+  }
+
+  if(ibSize > m_PassMesh.ibSize || m_PassMesh.ib == ResourceId())
+  {
+    FetchBuffer buf = {};
+    buf.name = "Merged pass mesh indices";
+    buf.customName = true;
+    buf.creationFlags = eBufferCreate_IB;
+    buf.length = RDCMAX(ibSize, m_PassMesh.ibSize * 2);
+
+    m_PassMesh.ib = m_pDevice->CreateProxyBuffer(buf);
+    m_PassMesh.ibSize = m_PassMesh.ib == ResourceId() ? 0 : buf.length;
+  }
+
+  // drivers without proxy buffers draw each one as before
+  if(m_PassMesh.vb == ResourceId() || m_PassMesh.ib == ResourceId())
+  {
+    out = draws;
+    merged.insert(merged.end(), out.begin(), out.end());
+    return;
+  }
+
+  m_pDevice->SetProxyBufferData(m_PassMesh.vb, 0, (byte *)&verts[0], (size_t)vbSize);
+
+  const PrimitiveTopology topos[3] = {eTopology_PointList, eTopology_LineList,
+                                      eTopology_TriangleList};
+
+  uint64_t idxoffs = 0;
+
+  for(int c = 0; c < 3; c++)
+  {
+    if(indices[c].empty())
+      continue;
+
+    size_t size = indices[c].size() * sizeof(uint32_t);
+
+    m_pDevice->SetProxyBufferData(m_PassMesh.ib, idxoffs, (byte *)&indices[c][0], size);
+
+    // all draws in the pass are displayed the same, so take the other properties from the first
+    MeshFormat fmt = draws[mergeable[0]];
+    fmt.buf = m_PassMesh.vb;
+    fmt.offset = 0;
+    fmt.stride = sizeof(float) * 4;
+    fmt.idxbuf = m_PassMesh.ib;
+    fmt.idxoffs = idxoffs;
+    fmt.idxByteWidth = 4;
+    fmt.baseVertex = 0;
+    fmt.numVerts = (uint32_t)indices[c].size();
+    fmt.topo = topos[c];
+
+    out.push_back(fmt);
+
+    idxoffs += size;
+  }
+
+  merged.insert(merged.end(), out.begin(), out.end());
+}
+
 void ReplayOutput::DisplayMesh()
 {
   FetchDrawcall *draw = m_pRenderer->GetDrawcallByEID(m_EventID);
@@ -815,6 +1358,8 @@ void ReplayOutput::DisplayMesh()
 
   if(m_RenderData.meshDisplay.type != eMeshDataStage_VSIn)
   {
+    vector<MeshFormat> passDrawFmts;
+
     for(size_t i = 0; m_RenderData.meshDisplay.showWholePass && i < passEvents.size(); i++)
     {
       FetchDrawcall *d = m_pRenderer->GetDrawcallByEID(passEvents[i]);
@@ -832,11 +1377,15 @@ void ReplayOutput::DisplayMesh()
 
           // if unproject is marked, this output had a 'real' system position output
           if(fmt.unproject)
-            secondaryDraws.push_back(fmt);
+            passDrawFmts.push_back(fmt);
         }
       }
     }
 
+    // a pass can have thousands of draws, too many to draw one by one and stay interactive
+    if(!passDrawFmts.empty())
+      MergePassMeshes(passDrawFmts, secondaryDraws);
+
     // draw previous instances in the current drawcall
     if(draw->flags & eDraw_Instanced)
     {
@@ -894,6 +1443,20 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_AddThumbnail(IReplayOu
 {
   return output->AddThumbnail(system, data, texID, typeHint);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_SetThumbnailAtlas(IReplayOutput *output,
+                                                                            WindowingSystem system,
+                                                                            void *data,
+                                                                            uint32_t columns,
+                                                                            uint32_t rows)
+{
+  return output->SetThumbnailAtlas(system, data, columns, rows);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayOutput_SetAtlasThumbnail(IReplayOutput *output, uint32_t cell, ResourceId texID,
+                               FormatComponentType typeHint)
+{
+  return output->SetAtlasThumbnail(cell, texID, typeHint);
+}
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayOutput_Display(IReplayOutput *output)
 {
@@ -24,9 +24,13 @@
  ******************************************************************************/
 
 #include "replay_renderer.h"
+#include <math.h>
 #include <string.h>
 #include <time.h>
+#include <algorithm>
 #include "common/dds_readwrite.h"
+#include "common/tracing.h"
+#include "core/resource_manager.h"
 #include "jpeg-compressor/jpgd.h"
 #include "jpeg-compressor/jpge.h"
 #include "maths/formatpacking.h"
@@ -138,6 +142,22 @@ ReplayRenderer::ReplayRenderer()
   m_pDevice = NULL;
 
   m_EventID = 100000;
+  m_DevicePipelineStateStale = false;
+
+  m_NextShaderBuild = 1;
+  m_NextDebugSession = 1;
+
+  m_ResourceDataCacheSize = 0;
+  RDCEraseEl(m_MemoryBudgets);
+
+  m_LastOverlay.overlay = eTexOverlay_None;
+
+  m_CounterResultsLoaded = false;
+  m_CounterResultsDirty = false;
+
+  m_ResolvedCallstacksLoaded = false;
+  m_ResolvedCallstacksDirty = false;
+  m_CounterIdentity = 0;
 }
 
 ReplayRenderer::~ReplayRenderer()
@@ -149,6 +169,22 @@ ReplayRenderer::~ReplayRenderer()
 
   m_Outputs.clear();
 
+  // any builds still compiling must finish before the device goes away. Their results are
+  // discarded
+  for(auto it = m_ShaderBuilds.begin(); it != m_ShaderBuilds.end(); ++it)
+  {
+    Threading::JoinThread(it->second->thread);
+    Threading::CloseThread(it->second->thread);
+    delete it->second;
+  }
+
+  m_ShaderBuilds.clear();
+
+  for(auto it = m_DebugSessions.begin(); it != m_DebugSessions.end(); ++it)
+    delete it->second;
+
+  m_DebugSessions.clear();
+
   for(auto it = m_CustomShaders.begin(); it != m_CustomShaders.end(); ++it)
     m_pDevice->FreeCustomShader(*it);
 
@@ -159,6 +195,9 @@ ReplayRenderer::~ReplayRenderer()
 
   m_TargetResources.clear();
 
+  SaveCounterResults();
+  SaveResolvedCallstacks();
+
   if(m_pDevice)
     m_pDevice->Shutdown();
   m_pDevice = NULL;
@@ -166,10 +205,14 @@ ReplayRenderer::~ReplayRenderer()
 
 bool ReplayRenderer::SetFrameEvent(uint32_t eventID, bool force)
 {
+  SCOPED_TRACE("ReplayRenderer::SetFrameEvent");
+
   if(eventID != m_EventID || force)
   {
     m_EventID = eventID;
 
+    m_LastOverlay.overlay = eTexOverlay_None;
+
     m_pDevice->ReplayLog(eventID, eReplay_WithoutDraw);
 
     for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -178,6 +221,8 @@ bool ReplayRenderer::SetFrameEvent(uint32_t eventID, bool force)
     m_pDevice->ReplayLog(eventID, eReplay_OnlyDraw);
 
     FetchPipelineState();
+
+    EnforceMemoryBudgets();
   }
 
   return true;
@@ -227,6 +272,93 @@ bool ReplayRenderer::GetVulkanPipelineState(VulkanPipelineState *state)
   return false;
 }
 
+typedef VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding VKDescriptorBinding;
+
+bool ReplayRenderer::GetVulkanPipelineStatePaged(VulkanPipelineState *state,
+                                                 uint32_t maxArrayElements)
+{
+  if(state == NULL)
+    return false;
+
+  typedef rdctype::array<VKDescriptorBinding::BindingElement> ElementArray;
+
+  // swap the large descriptor arrays out for their first page while the state is copied, so the
+  // full arrays are never copied. The full state stays here for GetVulkanDescriptorBindings.
+  std::vector<std::pair<VKDescriptorBinding *, ElementArray> > swapped;
+
+  VulkanPipelineState::Pipeline *pipes[] = {&m_VulkanPipelineState.graphics,
+                                            &m_VulkanPipelineState.compute};
+
+  for(size_t p = 0; p < ARRAY_COUNT(pipes); p++)
+  {
+    for(int32_t s = 0; s < pipes[p]->DescSets.count; s++)
+    {
+      VulkanPipelineState::Pipeline::DescriptorSet &set = pipes[p]->DescSets[s];
+
+      for(int32_t b = 0; b < set.bindings.count; b++)
+      {
+        VKDescriptorBinding &bind = set.bindings[b];
+
+        if((uint32_t)bind.binds.count <= maxArrayElements)
+          continue;
+
+        std::vector<VKDescriptorBinding::BindingElement> page(
+            bind.binds.begin(), bind.binds.begin() + maxArrayElements);
+
+        swapped.push_back(std::make_pair(&bind, ElementArray()));
+        std::swap(swapped.back().second.elems, bind.binds.elems);
+        std::swap(swapped.back().second.count, bind.binds.count);
+
+        bind.binds = page;
+      }
+    }
+  }
+
+  *state = m_VulkanPipelineState;
+
+  for(size_t i = 0; i < swapped.size(); i++)
+  {
+    ElementArray &binds = swapped[i].first->binds;
+    binds.Delete();
+    std::swap(swapped[i].second.elems, binds.elems);
+    std::swap(swapped[i].second.count, binds.count);
+  }
+
+  return true;
+}
+
+bool ReplayRenderer::GetVulkanDescriptorBindings(
+    ShaderStageType stage, uint32_t set, uint32_t binding, uint32_t first, uint32_t count,
+    rdctype::array<VKDescriptorBinding::BindingElement> *elements)
+{
+  if(elements == NULL)
+    return false;
+
+  elements->Delete();
+
+  const VulkanPipelineState::Pipeline &pipe = stage == eShaderStage_Compute
+                                                  ? m_VulkanPipelineState.compute
+                                                  : m_VulkanPipelineState.graphics;
+
+  if(set >= (uint32_t)pipe.DescSets.count || binding >= (uint32_t)pipe.DescSets[set].bindings.count)
+    return false;
+
+  const rdctype::array<VKDescriptorBinding::BindingElement> &binds =
+      pipe.DescSets[set].bindings[binding].binds;
+
+  if(first >= (uint32_t)binds.count)
+    return true;
+
+  count = RDCMIN(count, (uint32_t)binds.count - first);
+
+  std::vector<VKDescriptorBinding::BindingElement> page(binds.begin() + first,
+                                                        binds.begin() + first + count);
+
+  *elements = page;
+
+  return true;
+}
+
 bool ReplayRenderer::GetFrameInfo(FetchFrameInfo *info)
 {
   if(info == NULL)
@@ -245,6 +377,28 @@ FetchDrawcall *ReplayRenderer::GetDrawcallByEID(uint32_t eventID)
   return m_Drawcalls[eventID];
 }
 
+const FetchAPIEvent *ReplayRenderer::GetAPIEventByEID(uint32_t eventID)
+{
+  // an event belongs to the first drawcall at or after it. Markers and other drawcalls without
+  // any events of their own are skipped over.
+  for(size_t e = eventID; e < m_Drawcalls.size(); e++)
+  {
+    FetchDrawcall *draw = m_Drawcalls[e];
+
+    if(draw == NULL || draw->events.count == 0)
+      continue;
+
+    for(const FetchAPIEvent &ev : draw->events)
+      if(ev.eventID == eventID)
+        return &ev;
+
+    if(draw->events[0].eventID > eventID)
+      break;
+  }
+
+  return NULL;
+}
+
 bool ReplayRenderer::GetDrawcalls(rdctype::array<FetchDrawcall> *draws)
 {
   if(draws == NULL)
@@ -257,6 +411,8 @@ bool ReplayRenderer::GetDrawcalls(rdctype::array<FetchDrawcall> *draws)
 bool ReplayRenderer::FetchCounters(uint32_t *counters, uint32_t numCounters,
                                    rdctype::array<CounterResult> *results)
 {
+  SCOPED_TRACE("ReplayRenderer::FetchCounters");
+
   if(results == NULL)
     return false;
 
@@ -265,7 +421,286 @@ bool ReplayRenderer::FetchCounters(uint32_t *counters, uint32_t numCounters,
   for(uint32_t i = 0; i < numCounters; i++)
     counterArray.push_back(counters[i]);
 
-  *results = m_pDevice->FetchCounters(counterArray);
+  // with resources replaced the results don't reflect the capture, so they can't be cached
+  if(!m_Replacements.empty())
+  {
+    *results = m_pDevice->FetchCounters(counterArray);
+    return true;
+  }
+
+  LoadCounterResults();
+
+  vector<uint32_t> missing;
+  for(size_t i = 0; i < counterArray.size(); i++)
+    if(m_CounterResults.find(counterArray[i]) == m_CounterResults.end())
+      missing.push_back(counterArray[i]);
+
+  vector<CounterResult> fetched;
+  bool cancelled = false;
+
+  if(!missing.empty())
+  {
+    RenderDoc::Inst().SetOperationProgress(0.0f);
+
+    fetched = m_pDevice->FetchCounters(missing);
+
+    // a cancelled fetch only has results for part of the frame, so it's returned but not cached
+    cancelled = RenderDoc::Inst().IsOperationCancelled();
+
+    if(!cancelled)
+    {
+      // make sure every fetched counter gets an entry, even if it had no results
+      for(size_t i = 0; i < missing.size(); i++)
+        m_CounterResults[missing[i]];
+
+      for(size_t i = 0; i < fetched.size(); i++)
+        m_CounterResults[fetched[i].counterID].push_back(fetched[i]);
+
+      m_CounterResultsDirty = true;
+    }
+  }
+
+  vector<CounterResult> ret;
+
+  std::sort(counterArray.begin(), counterArray.end());
+  counterArray.erase(std::unique(counterArray.begin(), counterArray.end()), counterArray.end());
+
+  for(size_t i = 0; i < counterArray.size(); i++)
+  {
+    auto it = m_CounterResults.find(counterArray[i]);
+    if(it != m_CounterResults.end())
+      ret.insert(ret.end(), it->second.begin(), it->second.end());
+  }
+
+  if(cancelled)
+    ret.insert(ret.end(), fetched.begin(), fetched.end());
+
+  // same order as the drivers return them in, by event then by counter
+  std::stable_sort(ret.begin(), ret.end());
+
+  *results = ret;
+
+  return true;
+}
+
+uint64_t ReplayRenderer::GetCounterIdentity()
+{
+  // there's no driver interface for the exact GPU and driver version, so identify the replay by
+  // the API, the machine, and the counters that are available - vendor specific counters and their
+  // descriptions differ between hardware and driver versions.
+  APIProperties props = m_pDevice->GetAPIProperties();
+
+  uint64_t machine = OSUtility::GetMachineIdent();
+
+  uint32_t hash = 5381;
+  hash = strhash(StringFormat::Fmt("%u %llu", props.localRenderer, machine).c_str(), hash);
+
+  vector<uint32_t> counters = m_pDevice->EnumerateCounters();
+
+  for(size_t i = 0; i < counters.size(); i++)
+  {
+    CounterDescription desc;
+    m_pDevice->DescribeCounter(counters[i], desc);
+
+    hash = strhash(StringFormat::Fmt("%u %u %u %u ", desc.counterID, desc.resultCompType,
+                                     desc.resultByteWidth, desc.units)
+                       .c_str(),
+                   hash);
+    hash = strhash(desc.name.elems ? desc.name.elems : "", hash);
+  }
+
+  return (uint64_t(props.localRenderer) << 32) | hash;
+}
+
+void ReplayRenderer::LoadCounterResults()
+{
+  if(m_CounterResultsLoaded)
+    return;
+
+  m_CounterResultsLoaded = true;
+
+  m_CounterIdentity = GetCounterIdentity();
+
+  if(m_Logfile.empty())
+    return;
+
+  Serialiser ser(m_Logfile.c_str(), Serialiser::READING, false);
+
+  if(ser.HasError())
+    return;
+
+  const vector<byte> *contents = ser.GetSectionContents(Serialiser::eSectionType_CounterResults);
+
+  if(contents == NULL)
+    return;
+
+  const byte *data = &(*contents)[0];
+  const byte *end = data + contents->size();
+
+  // version, identity, counter count
+  if(contents->size() < sizeof(uint32_t) * 2 + sizeof(uint64_t))
+    return;
+
+  uint32_t version = 0;
+  uint64_t identity = 0;
+  uint32_t numCounters = 0;
+
+  memcpy(&version, data, sizeof(version));
+  data += sizeof(version);
+  memcpy(&identity, data, sizeof(identity));
+  data += sizeof(identity);
+  memcpy(&numCounters, data, sizeof(numCounters));
+  data += sizeof(numCounters);
+
+  if(version != CounterResultsVersion)
+  {
+    RDCLOG("Stored counter results are from a different version, ignoring");
+    return;
+  }
+
+  if(identity != m_CounterIdentity)
+  {
+    RDCLOG("Stored counter results are from a different setup, ignoring");
+
+    // note which counters were stored, so that callers which show them automatically know to
+    // refresh them rather than wait for them to be requested
+    for(uint32_t c = 0; c < numCounters; c++)
+    {
+      uint32_t counterID = 0, numResults = 0;
+
+      if(data + sizeof(uint32_t) * 2 > end)
+        break;
+
+      memcpy(&counterID, data, sizeof(counterID));
+      data += sizeof(counterID);
+      memcpy(&numResults, data, sizeof(numResults));
+      data += sizeof(numResults);
+
+      if(uint64_t(end - data) < uint64_t(numResults) * sizeof(CounterResult))
+        break;
+
+      data += numResults * sizeof(CounterResult);
+
+      m_StaleCounters.insert(counterID);
+    }
+
+    return;
+  }
+
+  std::map<uint32_t, vector<CounterResult> > results;
+
+  for(uint32_t c = 0; c < numCounters; c++)
+  {
+    uint32_t counterID = 0, numResults = 0;
+
+    if(data + sizeof(uint32_t) * 2 > end)
+      break;
+
+    memcpy(&counterID, data, sizeof(counterID));
+    data += sizeof(counterID);
+    memcpy(&numResults, data, sizeof(numResults));
+    data += sizeof(numResults);
+
+    if(uint64_t(end - data) < uint64_t(numResults) * sizeof(CounterResult))
+    {
+      RDCWARN("Stored counter results are corrupt, ignoring");
+      return;
+    }
+
+    vector<CounterResult> &res = results[counterID];
+    res.resize(numResults);
+    if(numResults > 0)
+      memcpy(&res[0], data, numResults * sizeof(CounterResult));
+    data += numResults * sizeof(CounterResult);
+  }
+
+  RDCLOG("Loaded stored results for %u counters", (uint32_t)results.size());
+
+  m_CounterResults.swap(results);
+}
+
+void ReplayRenderer::SaveCounterResults()
+{
+  if(!m_CounterResultsDirty || m_Logfile.empty())
+    return;
+
+  vector<byte> contents;
+
+  uint32_t version = CounterResultsVersion;
+  uint32_t numCounters = (uint32_t)m_CounterResults.size();
+
+  contents.insert(contents.end(), (byte *)&version, (byte *)(&version + 1));
+  contents.insert(contents.end(), (byte *)&m_CounterIdentity, (byte *)(&m_CounterIdentity + 1));
+  contents.insert(contents.end(), (byte *)&numCounters, (byte *)(&numCounters + 1));
+
+  for(auto it = m_CounterResults.begin(); it != m_CounterResults.end(); ++it)
+  {
+    uint32_t counterID = it->first;
+    uint32_t numResults = (uint32_t)it->second.size();
+
+    contents.insert(contents.end(), (byte *)&counterID, (byte *)(&counterID + 1));
+    contents.insert(contents.end(), (byte *)&numResults, (byte *)(&numResults + 1));
+
+    if(numResults > 0)
+      contents.insert(contents.end(), (byte *)&it->second[0],
+                      (byte *)(&it->second[0] + numResults));
+  }
+
+  if(Serialiser::AppendSection(m_Logfile.c_str(), Serialiser::eSectionType_CounterResults,
+                               "renderdoc/internal/counterresults", &contents[0], contents.size()))
+    RDCLOG("Stored results for %u counters in capture", numCounters);
+
+  m_CounterResultsDirty = false;
+}
+
+bool ReplayRenderer::GetCachedCounterResults(uint32_t *counters, uint32_t numCounters,
+                                             rdctype::array<CounterResult> *results,
+                                             bool32 *stale)
+{
+  if(results == NULL)
+    return false;
+
+  if(stale)
+    *stale = false;
+
+  // with resources replaced nothing is cached
+  if(!m_Replacements.empty())
+    return false;
+
+  LoadCounterResults();
+
+  vector<uint32_t> counterArray(counters, counters + numCounters);
+
+  std::sort(counterArray.begin(), counterArray.end());
+  counterArray.erase(std::unique(counterArray.begin(), counterArray.end()), counterArray.end());
+
+  vector<CounterResult> ret;
+  bool found = true, allStale = true;
+
+  for(size_t i = 0; i < counterArray.size(); i++)
+  {
+    auto it = m_CounterResults.find(counterArray[i]);
+    if(it == m_CounterResults.end())
+    {
+      found = false;
+      if(m_StaleCounters.find(counterArray[i]) == m_StaleCounters.end())
+        allStale = false;
+      continue;
+    }
+
+    ret.insert(ret.end(), it->second.begin(), it->second.end());
+  }
+
+  if(!found)
+  {
+    if(stale)
+      *stale = allStale;
+    return false;
+  }
+
+  std::stable_sort(ret.begin(), ret.end());
+
+  *results = ret;
 
   return true;
 }
@@ -294,12 +729,17 @@ bool ReplayRenderer::GetBuffers(rdctype::array<FetchBuffer> *out)
 {
   if(m_Buffers.empty())
   {
-    vector<ResourceId> ids = m_pDevice->GetBuffers();
+    // over a proxy, fetch every description in one go instead of a round-trip for each
+    uint32_t total = 0;
+    if(!m_pDevice->QueryBuffers(ResourceQuery(), m_Buffers, total))
+    {
+      vector<ResourceId> ids = m_pDevice->GetBuffers();
 
-    m_Buffers.resize(ids.size());
+      m_Buffers.resize(ids.size());
 
-    for(size_t i = 0; i < ids.size(); i++)
-      m_Buffers[i] = m_pDevice->GetBuffer(ids[i]);
+      for(size_t i = 0; i < ids.size(); i++)
+        m_Buffers[i] = m_pDevice->GetBuffer(ids[i]);
+    }
   }
 
   if(out)
@@ -315,12 +755,16 @@ bool ReplayRenderer::GetTextures(rdctype::array<FetchTexture> *out)
 {
   if(m_Textures.empty())
   {
-    vector<ResourceId> ids = m_pDevice->GetTextures();
+    uint32_t total = 0;
+    if(!m_pDevice->QueryTextures(ResourceQuery(), m_Textures, total))
+    {
+      vector<ResourceId> ids = m_pDevice->GetTextures();
 
-    m_Textures.resize(ids.size());
+      m_Textures.resize(ids.size());
 
-    for(size_t i = 0; i < ids.size(); i++)
-      m_Textures[i] = m_pDevice->GetTexture(ids[i]);
+      for(size_t i = 0; i < ids.size(); i++)
+        m_Textures[i] = m_pDevice->GetTexture(ids[i]);
+    }
   }
 
   if(out)
@@ -332,1107 +776,3432 @@ bool ReplayRenderer::GetTextures(rdctype::array<FetchTexture> *out)
   return false;
 }
 
-bool ReplayRenderer::GetResolve(uint64_t *callstack, uint32_t callstackLen,
-                                rdctype::array<rdctype::str> *arr)
+bool ReplayRenderer::QueryTextures(const ResourceQuery &query, rdctype::array<FetchTexture> *texs,
+                                   uint32_t *total)
 {
-  if(arr == NULL || callstack == NULL || callstackLen == 0)
+  if(texs == NULL)
     return false;
 
-  Callstack::StackResolver *resolv = m_pDevice->GetCallstackResolver();
+  vector<FetchTexture> page;
+  uint32_t count = 0;
 
-  if(resolv == NULL)
+  // a remote replay answers the query itself, so the full list never comes over the network
+  if(!m_pDevice->QueryTextures(query, page, count))
   {
-    create_array_uninit(*arr, 1);
-    arr->elems[0] = "";
-    return true;
+    GetTextures(NULL);
+
+    count = m_ResourceIndex.QueryTextures(
+        m_Textures, query,
+        [this](ResourceId id) -> const vector<EventUsage> & {
+          return GetResourceUsage(m_pDevice->GetLiveID(id)).usage;
+        },
+        page);
   }
 
-  create_array_uninit(*arr, callstackLen);
-  for(size_t i = 0; i < callstackLen; i++)
-  {
-    Callstack::AddressDetails info = resolv->GetAddr(callstack[i]);
-    arr->elems[i] = info.formattedString();
-  }
+  *texs = page;
+  if(total)
+    *total = count;
 
   return true;
 }
 
-bool ReplayRenderer::GetDebugMessages(rdctype::array<DebugMessage> *msgs)
+bool ReplayRenderer::QueryBuffers(const ResourceQuery &query, rdctype::array<FetchBuffer> *bufs,
+                                  uint32_t *total)
 {
-  if(msgs)
-  {
-    *msgs = m_pDevice->GetDebugMessages();
-    return true;
-  }
+  if(bufs == NULL)
+    return false;
 
-  return false;
-}
+  vector<FetchBuffer> page;
+  uint32_t count = 0;
 
-bool ReplayRenderer::GetUsage(ResourceId id, rdctype::array<EventUsage> *usage)
-{
-  if(usage)
+  if(!m_pDevice->QueryBuffers(query, page, count))
   {
-    *usage = m_pDevice->GetUsage(m_pDevice->GetLiveID(id));
-    return true;
+    GetBuffers(NULL);
+
+    count = m_ResourceIndex.QueryBuffers(
+        m_Buffers, query,
+        [this](ResourceId id) -> const vector<EventUsage> & {
+          return GetResourceUsage(m_pDevice->GetLiveID(id)).usage;
+        },
+        page);
   }
 
-  return false;
+  *bufs = page;
+  if(total)
+    *total = count;
+
+  return true;
 }
 
-bool ReplayRenderer::GetPostVSData(uint32_t instID, MeshDataStage stage, MeshFormat *data)
+bool ReplayRenderer::GetResolve(uint64_t *callstack, uint32_t callstackLen,
+                                rdctype::array<rdctype::str> *arr)
 {
-  if(data == NULL)
+  if(arr == NULL || callstack == NULL || callstackLen == 0)
     return false;
 
-  FetchDrawcall *draw = GetDrawcallByEID(m_EventID);
+  Callstack::StackResolver *resolv = m_pDevice->GetCallstackResolver();
 
-  MeshFormat ret;
-  RDCEraseEl(ret);
+  if(resolv == NULL)
+  {
+    create_array_uninit(*arr, 1);
+    arr->elems[0] = "";
+    return true;
+  }
 
-  if(draw == NULL || (draw->flags & eDraw_Drawcall) == 0)
+  LoadResolvedCallstacks();
+
+  for(uint32_t i = 0; i < callstackLen; i++)
   {
-    *data = MeshFormat();
-    return false;
+    if(m_ResolvedAddrs.find(callstack[i]) == m_ResolvedAddrs.end() &&
+       m_UnresolvedAddrs.find(callstack[i]) == m_UnresolvedAddrs.end())
+    {
+      ResolveCaptureCallstacks(resolv, callstack, callstackLen);
+      break;
+    }
   }
 
-  instID = RDCMIN(instID, draw->numInstances - 1);
+  create_array_uninit(*arr, callstackLen);
+  for(uint32_t i = 0; i < callstackLen; i++)
+  {
+    auto it = m_ResolvedAddrs.find(callstack[i]);
+    if(it != m_ResolvedAddrs.end())
+    {
+      arr->elems[i] = it->second;
+      continue;
+    }
 
-  *data = m_pDevice->GetPostVSBuffers(draw->eventID, instID, stage);
+    it = m_UnresolvedAddrs.find(callstack[i]);
+    arr->elems[i] = it != m_UnresolvedAddrs.end() ? it->second : "";
+  }
 
   return true;
 }
 
-bool ReplayRenderer::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
-                                   rdctype::array<byte> *data)
+void ReplayRenderer::ResolveCaptureCallstacks(Callstack::StackResolver *resolv,
+                                              const uint64_t *callstack, uint32_t callstackLen)
 {
-  if(data == NULL || buff == ResourceId())
-    return false;
+  // rather than resolving one stack at a time, gather every address in the capture that we
+  // haven't seen so the resolver can batch them up, and it only has to happen once.
+  std::set<uint64_t> unique;
 
-  ResourceId liveId = m_pDevice->GetLiveID(buff);
+  for(uint32_t i = 0; i < callstackLen; i++)
+    unique.insert(callstack[i]);
 
-  if(liveId == ResourceId())
+  for(size_t d = 0; d < m_Drawcalls.size(); d++)
   {
-    RDCERR("Couldn't get Live ID for %llu getting buffer data", buff);
-    return false;
+    const FetchDrawcall *draw = m_Drawcalls[d];
+
+    if(draw == NULL)
+      continue;
+
+    for(int32_t e = 0; e < draw->events.count; e++)
+    {
+      const rdctype::array<uint64_t> &stack = draw->events[e].callstack;
+      unique.insert(stack.elems, stack.elems + stack.count);
+    }
   }
 
-  vector<byte> retData;
-  m_pDevice->GetBufferData(liveId, offset, len, retData);
+  vector<uint64_t> addrs;
+  addrs.reserve(unique.size());
 
-  create_array_init(*data, retData.size(), !retData.empty() ? &retData[0] : NULL);
+  for(auto it = unique.begin(); it != unique.end(); ++it)
+    if(m_ResolvedAddrs.find(*it) == m_ResolvedAddrs.end() &&
+       m_UnresolvedAddrs.find(*it) == m_UnresolvedAddrs.end())
+      addrs.push_back(*it);
 
-  return true;
+  if(addrs.empty())
+    return;
+
+  RDCLOG("Resolving %u callstack addresses", (uint32_t)addrs.size());
+
+  vector<Callstack::AddressDetails> details;
+  resolv->GetAddrs(addrs, details);
+
+  for(size_t i = 0; i < addrs.size() && i < details.size(); i++)
+  {
+    if(details[i].line == 0)
+    {
+      m_UnresolvedAddrs[addrs[i]] = details[i].formattedString();
+    }
+    else
+    {
+      m_ResolvedAddrs[addrs[i]] = details[i].formattedString();
+      m_ResolvedCallstacksDirty = true;
+    }
+  }
 }
 
-bool ReplayRenderer::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
-                                    rdctype::array<byte> *data)
+void ReplayRenderer::LoadResolvedCallstacks()
 {
-  if(data == NULL)
-    return false;
+  if(m_ResolvedCallstacksLoaded)
+    return;
 
-  ResourceId liveId = m_pDevice->GetLiveID(tex);
+  m_ResolvedCallstacksLoaded = true;
 
-  if(liveId == ResourceId())
+  if(m_Logfile.empty())
+    return;
+
+  Serialiser ser(m_Logfile.c_str(), Serialiser::READING, false);
+
+  if(ser.HasError())
+    return;
+
+  const vector<byte> *contents =
+      ser.GetSectionContents(Serialiser::eSectionType_ResolvedCallstacks);
+
+  if(contents == NULL)
+    return;
+
+  const byte *data = &(*contents)[0];
+  const byte *end = data + contents->size();
+
+  // version, machine, address count
+  if(contents->size() < sizeof(uint32_t) * 2 + sizeof(uint64_t))
+    return;
+
+  uint32_t version = 0;
+  uint64_t machine = 0;
+  uint32_t numAddrs = 0;
+
+  memcpy(&version, data, sizeof(version));
+  data += sizeof(version);
+  memcpy(&machine, data, sizeof(machine));
+  data += sizeof(machine);
+  memcpy(&numAddrs, data, sizeof(numAddrs));
+  data += sizeof(numAddrs);
+
+  // symbols are looked up locally, so another machine could resolve differently
+  if(version != ResolvedCallstacksVersion || machine != OSUtility::GetMachineIdent())
   {
-    RDCERR("Couldn't get Live ID for %llu getting texture data", tex);
-    return false;
+    RDCLOG("Stored callstacks were resolved on a different setup, ignoring");
+    return;
   }
 
-  size_t sz = 0;
-  byte *bytes = m_pDevice->GetTextureData(liveId, arrayIdx, mip, GetTextureDataParams(), sz);
+  for(uint32_t i = 0; i < numAddrs; i++)
+  {
+    uint64_t addr = 0;
+    uint32_t len = 0;
 
-  if(sz == 0 || bytes == NULL)
-    create_array_uninit(*data, 0);
-  else
-    create_array_init(*data, sz, bytes);
+    if(data + sizeof(addr) + sizeof(len) > end)
+      break;
 
-  SAFE_DELETE_ARRAY(bytes);
+    memcpy(&addr, data, sizeof(addr));
+    data += sizeof(addr);
+    memcpy(&len, data, sizeof(len));
+    data += sizeof(len);
 
-  return true;
+    if(uint64_t(end - data) < len)
+    {
+      RDCWARN("Stored callstacks are corrupt, ignoring the rest");
+      break;
+    }
+
+    m_ResolvedAddrs[addr] = string((const char *)data, (const char *)data + len);
+    data += len;
+  }
+
+  RDCLOG("Loaded %u stored callstack addresses", (uint32_t)m_ResolvedAddrs.size());
 }
 
-bool ReplayRenderer::SaveTexture(const TextureSave &saveData, const char *path)
+void ReplayRenderer::SaveResolvedCallstacks()
 {
-  TextureSave sd = saveData;    // mutable copy
-  ResourceId liveid = m_pDevice->GetLiveID(sd.id);
-  FetchTexture td = m_pDevice->GetTexture(liveid);
+  if(!m_ResolvedCallstacksDirty || m_Logfile.empty())
+    return;
 
-  bool success = false;
+  vector<byte> contents;
 
-  // clamp sample/mip/slice indices
-  if(td.msSamp == 1)
+  uint32_t version = ResolvedCallstacksVersion;
+  uint64_t machine = OSUtility::GetMachineIdent();
+  uint32_t numAddrs = (uint32_t)m_ResolvedAddrs.size();
+
+  contents.insert(contents.end(), (byte *)&version, (byte *)(&version + 1));
+  contents.insert(contents.end(), (byte *)&machine, (byte *)(&machine + 1));
+  contents.insert(contents.end(), (byte *)&numAddrs, (byte *)(&numAddrs + 1));
+
+  for(auto it = m_ResolvedAddrs.begin(); it != m_ResolvedAddrs.end(); ++it)
   {
-    sd.sample.sampleIndex = 0;
-    sd.sample.mapToArray = false;
+    uint64_t addr = it->first;
+    uint32_t len = (uint32_t)it->second.size();
+
+    contents.insert(contents.end(), (byte *)&addr, (byte *)(&addr + 1));
+    contents.insert(contents.end(), (byte *)&len, (byte *)(&len + 1));
+    contents.insert(contents.end(), it->second.begin(), it->second.end());
   }
-  else
+
+  if(Serialiser::AppendSection(m_Logfile.c_str(), Serialiser::eSectionType_ResolvedCallstacks,
+                               "renderdoc/internal/resolvedcallstacks", &contents[0],
+                               contents.size()))
+    RDCLOG("Stored %u resolved callstack addresses in capture", numAddrs);
+
+  m_ResolvedCallstacksDirty = false;
+}
+
+bool ReplayRenderer::GetDebugMessages(rdctype::array<DebugMessage> *msgs)
+{
+  if(msgs)
   {
-    if(sd.sample.sampleIndex != ~0U)
-      sd.sample.sampleIndex = RDCCLAMP(sd.sample.sampleIndex, 0U, td.msSamp);
+    *msgs = m_pDevice->GetDebugMessages();
+    return true;
   }
 
-  // don't support cube cruciform for non cubemaps, or
-  // cubemap arrays
-  if(!td.cubemap || td.arraysize != 6 || td.msSamp != 1)
-    sd.slice.cubeCruciform = false;
-
-  if(sd.mip != -1)
-    sd.mip = RDCCLAMP(sd.mip, 0, (int32_t)td.mips);
-  if(sd.slice.sliceIndex != -1)
-    sd.slice.sliceIndex = RDCCLAMP(sd.slice.sliceIndex, 0, int32_t(td.arraysize * td.depth));
+  return false;
+}
 
-  if(td.arraysize * td.depth * td.msSamp == 1)
+bool ReplayRenderer::GetProxyStats(rdctype::array<ProxyCommandStats> *stats)
+{
+  if(stats)
   {
-    sd.slice.sliceIndex = 0;
-    sd.slice.slicesAsGrid = false;
+    *stats = m_pDevice->GetProxyStats();
+    return true;
   }
 
-  // can't extract a channel that's not in the source texture
-  if(sd.channelExtract >= 0 && (uint32_t)sd.channelExtract >= td.format.compCount)
-    sd.channelExtract = -1;
+  return false;
+}
 
-  sd.slice.sliceGridWidth = RDCMAX(sd.slice.sliceGridWidth, 1);
+bool ReplayRenderer::GetMemoryStats(rdctype::array<ReplayMemoryStats> *stats)
+{
+  if(!stats)
+    return false;
 
-  // store sample count so we know how many 'slices' is one real slice
-  // multisampled textures cannot have mips, subresource layout is same as would be for mips:
-  // [slice0 sample0], [slice0 sample1], [slice1 sample0], [slice1 sample1]
-  uint32_t sampleCount = td.msSamp;
-  bool multisampled = td.msSamp > 1;
+  vector<ReplayMemoryStats> ret = m_pDevice->GetMemoryStats();
 
-  bool resolveSamples = (sd.sample.sampleIndex == ~0U);
+  uint64_t resourceDataBytes = m_ResourceDataCacheSize;
 
-  if(resolveSamples)
+  bool captureKnown = false;
+  for(size_t i = 0; i < ret.size(); i++)
   {
-    td.msSamp = 1;
-    sd.sample.mapToArray = false;
-    sd.sample.sampleIndex = 0;
+    if(ret[i].category == eReplayMemory_CaptureResources && ret[i].gpuBytes > 0)
+      captureKnown = true;
+
+    // our own cache of resource data is counted along with the driver's debug resources
+    if(ret[i].category == eReplayMemory_DebugResources && !ret[i].remote)
+    {
+      ret[i].cpuBytes += resourceDataBytes;
+      resourceDataBytes = 0;
+    }
   }
 
-  // treat any multisampled texture as if it were an array
-  // of <sample count> dimension (on top of potential existing array
-  // dimension). GetTextureData() uses the same convention.
-  if(td.msSamp > 1)
+  if(resourceDataBytes > 0)
   {
-    td.arraysize *= td.msSamp;
-    td.msSamp = 1;
+    ReplayMemoryStats debug = {};
+    debug.category = eReplayMemory_DebugResources;
+    debug.cpuBytes = resourceDataBytes;
+    ret.push_back(debug);
   }
 
-  if(sd.destType != eFileType_DDS && sd.sample.mapToArray && !sd.slice.slicesAsGrid &&
-     sd.slice.sliceIndex == -1)
+  // most drivers don't track the capture's own resources, so estimate them from their sizes
+  if(!captureKnown)
   {
-    sd.sample.mapToArray = false;
-    sd.sample.sampleIndex = 0;
+    ReplayMemoryStats capture = {};
+    capture.category = eReplayMemory_CaptureResources;
+    capture.remote = m_pDevice->IsRemoteProxy();
+
+    for(size_t i = 0; i < m_Textures.size(); i++)
+      capture.gpuBytes += m_Textures[i].byteSize;
+    for(size_t i = 0; i < m_Buffers.size(); i++)
+      capture.gpuBytes += m_Buffers[i].length;
+
+    ret.push_back(capture);
   }
 
-  // only DDS supports writing multiple mips, fall back to mip 0 if 'all mips' was specified
-  if(sd.destType != eFileType_DDS && sd.mip == -1)
-    sd.mip = 0;
+  for(size_t i = 0; i < ret.size(); i++)
+    if(ret[i].category < eReplayMemory_Count)
+      ret[i].budget = m_MemoryBudgets[ret[i].category];
 
-  // only DDS supports writing multiple slices, fall back to slice 0 if 'all slices' was specified
-  if(sd.destType != eFileType_DDS && sd.slice.sliceIndex == -1 && !sd.slice.slicesAsGrid &&
-     !sd.slice.cubeCruciform)
-    sd.slice.sliceIndex = 0;
+  *stats = ret;
+  return true;
+}
 
-  // fetch source data subresources (typically only one, possibly more
-  // if we're writing to DDS (so writing multiple mips/slices) or resolving
-  // down a multisampled texture for writing as a single 'image' elsewhere)
-  uint32_t sliceOffset = 0;
-  uint32_t sliceStride = 1;
-  uint32_t numSlices = td.arraysize * td.depth;
+bool ReplayRenderer::SetMemoryBudget(ReplayMemoryCategory category, uint64_t bytes)
+{
+  if(category >= eReplayMemory_Count)
+    return false;
 
-  uint32_t mipOffset = 0;
-  uint32_t numMips = td.mips;
+  m_MemoryBudgets[category] = bytes;
 
-  bool singleSlice = (sd.slice.sliceIndex != -1);
+  EnforceMemoryBudgets();
 
-  // set which slices/mips we need
-  if(multisampled)
+  return true;
+}
+
+void ReplayRenderer::EnforceMemoryBudgets()
+{
+  for(uint32_t c = 0; c < eReplayMemory_Count; c++)
   {
-    bool singleSample = !sd.sample.mapToArray;
+    uint64_t budget = m_MemoryBudgets[c];
 
-    // multisampled images have no mips
-    mipOffset = 0;
-    numMips = 1;
+    if(budget == 0)
+      continue;
 
-    if(singleSlice)
-    {
-      if(singleSample)
-      {
-        // we want a specific sample in a specific real slice
-        sliceOffset = sd.slice.sliceIndex * sampleCount + sd.sample.sampleIndex;
-        numSlices = 1;
-      }
-      else
-      {
-        // we want all the samples (now mapped to slices) in a specific real slice
-        sliceOffset = sd.slice.sliceIndex;
-        numSlices = sampleCount;
-      }
-    }
-    else
+    // the resource data cache is the only part of the debug resources that can be evicted
+    if(c == eReplayMemory_DebugResources)
     {
-      if(singleSample)
-      {
-        // we want one sample in every slice, so we have to set the stride to sampleCount
-        // to skip every other sample (mapped to slices), starting from the sample we want
-        // in the first real slice
-        sliceOffset = sd.sample.sampleIndex;
-        sliceStride = sampleCount;
-        numSlices = RDCMAX(1U, td.arraysize / sampleCount);
-      }
-      else
+      while(!m_ResourceDataLRU.empty() && m_ResourceDataCacheSize > budget)
       {
-        // we want all slices, all samples
-        sliceOffset = 0;
-        numSlices = td.arraysize;
+        auto it = m_ResourceDataCache.find(m_ResourceDataLRU.back());
+        m_ResourceDataCacheSize -= it->second.data.size();
+        m_ResourceDataCache.erase(it);
+        m_ResourceDataLRU.pop_back();
       }
+
+      continue;
     }
+
+    // anything evicted from the post-VS cache is generated again when it's next displayed
+    m_pDevice->TrimMemory((ReplayMemoryCategory)c, budget, m_EventID);
   }
-  else
+}
+
+void ReplayRenderer::SetOperationControl(volatile bool32 *cancel, float *progress)
+{
+  RenderDoc::Inst().SetOperationControl(cancel, progress);
+}
+
+// splits the serialiser's text for a chunk into parameters. The text is the chunk name, then the
+// parameters one per line between braces as "name: value", with structures as "name = type"
+// followed by their members in another pair of braces.
+static void ParseEventParameters(const char *desc, vector<APIEventParameter> &params)
+{
+  vector<int32_t> parents;
+  bool inChunk = false;
+
+  for(const char *line = desc; line && *line;)
   {
-    if(singleSlice)
+    const char *end = strchr(line, '\n');
+    if(end == NULL)
+      end = line + strlen(line);
+
+    const char *next = *end ? end + 1 : end;
+
+    // trim the indent and any trailing whitespace
+    while(line < end && (*line == ' ' || *line == '\t'))
+      line++;
+    while(end > line && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+      end--;
+
+    string text(line, end);
+    line = next;
+
+    if(text.empty())
+      continue;
+
+    // the first brace opens the chunk itself, everything before it is the chunk name
+    if(!inChunk)
     {
-      numSlices = 1;
-      sliceOffset = sd.slice.sliceIndex;
+      inChunk = (text == "{");
+      continue;
     }
-    // otherwise take all slices, as by default
 
-    if(sd.mip != -1)
+    if(text == "{")
     {
-      mipOffset = sd.mip;
-      numMips = 1;
+      // members of the last parameter. If there isn't one (shouldn't happen) lump them in with the
+      // current level so that the closing brace still balances.
+      parents.push_back(params.empty() ? (parents.empty() ? -1 : parents.back())
+                                       : int32_t(params.size() - 1));
+      continue;
     }
-    // otherwise take all mips, as by default
+
+    if(text == "}")
+    {
+      // the closing brace of the chunk ends the parameters
+      if(parents.empty())
+        break;
+
+      parents.pop_back();
+      continue;
+    }
+
+    APIEventParameter p;
+    p.parent = parents.empty() ? -1 : parents.back();
+    p.numChildren = 0;
+
+    size_t colon = text.find(": ");
+    size_t equals = text.find(" = ");
+
+    size_t split = RDCMIN(colon, equals);
+
+    if(split != string::npos)
+    {
+      p.name = text.substr(0, split);
+      p.value = text.substr(split + (split == colon ? 2 : 3));
+    }
+    else
+    {
+      p.name = text;
+    }
+
+    if(p.parent >= 0)
+      params[p.parent].numChildren++;
+
+    params.push_back(p);
   }
+}
 
-  vector<byte *> subdata;
+bool ReplayRenderer::GetAPIEventParameters(uint32_t eventID,
+                                           rdctype::array<APIEventParameter> *params)
+{
+  if(params == NULL)
+    return false;
 
-  bool downcast = false;
+  const FetchAPIEvent *ev = GetAPIEventByEID(eventID);
 
-  // don't support slice mappings for DDS - it supports slices natively
-  if(sd.destType == eFileType_DDS)
+  if(ev == NULL)
   {
-    sd.slice.cubeCruciform = false;
-    sd.slice.slicesAsGrid = false;
+    create_array(*params, 0);
+    return false;
   }
 
-  // force downcast to be able to do grid mappings
-  if(sd.slice.cubeCruciform || sd.slice.slicesAsGrid)
-    downcast = true;
+  vector<APIEventParameter> ret;
+  ParseEventParameters(ev->eventDesc.c_str(), ret);
 
-  // we don't support any file formats that handle these block compression formats
-  if(td.format.specialFormat == eSpecial_ETC2 || td.format.specialFormat == eSpecial_EAC ||
-     td.format.specialFormat == eSpecial_ASTC)
-    downcast = true;
+  *params = ret;
 
-  // for DDS don't downcast, for non-HDR always downcast if we're not already RGBA8 unorm
-  // for HDR&EXR we can convert from most regular types as well as 10.10.10.2 and 11.11.10
-  if((sd.destType != eFileType_DDS && sd.destType != eFileType_HDR && sd.destType != eFileType_EXR &&
-      (td.format.compByteWidth != 1 || td.format.compCount != 4 ||
-       td.format.compType != eCompType_UNorm || td.format.bgraOrder)) ||
-     downcast || (sd.destType != eFileType_DDS && td.format.special &&
-                  td.format.specialFormat != eSpecial_R10G10B10A2 &&
-                  td.format.specialFormat != eSpecial_R11G11B10))
+  return true;
+}
+
+bool ReplayRenderer::GetUsage(ResourceId id, rdctype::array<EventUsage> *usage)
+{
+  if(usage)
   {
-    downcast = true;
-    td.format.compByteWidth = 1;
-    td.format.compCount = 4;
-    td.format.compType = eCompType_UNorm;
-    td.format.special = false;
-    td.format.specialFormat = eSpecial_Unknown;
+    *usage = GetResourceUsage(m_pDevice->GetLiveID(id)).usage;
+    return true;
   }
 
-  uint32_t rowPitch = 0;
-  uint32_t slicePitch = 0;
+  return false;
+}
 
-  bool blockformat = false;
-  int blockSize = 0;
-  uint32_t bytesPerPixel = 1;
+bool ReplayRenderer::GetPostVSData(uint32_t instID, MeshDataStage stage, MeshFormat *data)
+{
+  SCOPED_TRACE("ReplayRenderer::GetPostVSData");
 
-  td.width = RDCMAX(1U, td.width >> mipOffset);
-  td.height = RDCMAX(1U, td.height >> mipOffset);
-  td.depth = RDCMAX(1U, td.depth >> mipOffset);
+  if(data == NULL)
+    return false;
 
-  if(td.format.specialFormat == eSpecial_BC1 || td.format.specialFormat == eSpecial_BC2 ||
-     td.format.specialFormat == eSpecial_BC3 || td.format.specialFormat == eSpecial_BC4 ||
-     td.format.specialFormat == eSpecial_BC5 || td.format.specialFormat == eSpecial_BC6 ||
-     td.format.specialFormat == eSpecial_BC7)
+  FetchDrawcall *draw = GetDrawcallByEID(m_EventID);
+
+  MeshFormat ret;
+  RDCEraseEl(ret);
+
+  if(draw == NULL || (draw->flags & eDraw_Drawcall) == 0)
   {
-    blockSize = (td.format.specialFormat == eSpecial_BC1 || td.format.specialFormat == eSpecial_BC4)
-                    ? 8
-                    : 16;
-    rowPitch = RDCMAX(1U, ((td.width + 3) / 4)) * blockSize;
-    slicePitch = rowPitch * RDCMAX(1U, td.height / 4);
-    blockformat = true;
+    *data = MeshFormat();
+    return false;
   }
-  else
-  {
-    switch(td.format.specialFormat)
-    {
-      case eSpecial_S8: bytesPerPixel = 1; break;
-      case eSpecial_R10G10B10A2:
-      case eSpecial_R9G9B9E5:
-      case eSpecial_R11G11B10:
-      case eSpecial_D24S8: bytesPerPixel = 4; break;
-      case eSpecial_R5G6B5:
-      case eSpecial_R5G5B5A1:
-      case eSpecial_R4G4B4A4: bytesPerPixel = 2; break;
-      case eSpecial_D32S8: bytesPerPixel = 8; break;
-      case eSpecial_D16S8:
-      case eSpecial_YUV:
-      case eSpecial_R4G4:
-        RDCERR("Unsupported file format %u", td.format.specialFormat);
-        return false;
-      default: bytesPerPixel = td.format.compCount * td.format.compByteWidth;
-    }
 
-    rowPitch = td.width * bytesPerPixel;
-    slicePitch = rowPitch * td.height;
-  }
+  instID = RDCMIN(instID, draw->numInstances - 1);
 
-  // loop over fetching subresources
-  for(uint32_t s = 0; s < numSlices; s++)
-  {
-    uint32_t slice = s * sliceStride + sliceOffset;
+  *data = m_pDevice->GetPostVSBuffers(draw->eventID, instID, stage);
 
-    for(uint32_t m = 0; m < numMips; m++)
-    {
-      uint32_t mip = m + mipOffset;
+  return true;
+}
 
-      GetTextureDataParams params;
-      params.forDiskSave = true;
-      params.typeHint = sd.typeHint;
-      params.resolve = resolveSamples;
-      params.remap = downcast ? eRemap_RGBA8 : eRemap_None;
-      params.blackPoint = sd.comp.blackPoint;
-      params.whitePoint = sd.comp.whitePoint;
+bool ReplayRenderer::PrefetchPostVSData()
+{
+  FetchDrawcall *draw = GetDrawcallByEID(m_EventID);
 
-      size_t datasize = 0;
-      byte *bytes = m_pDevice->GetTextureData(liveid, slice, mip, params, datasize);
+  if(draw == NULL)
+    return false;
 
-      if(bytes == NULL)
-      {
-        RDCERR("Couldn't get bytes for mip %u, slice %u", mip, slice);
+  vector<uint32_t> events;
+  events.reserve(MaxPostVSPrefetch);
 
-        for(size_t i = 0; i < subdata.size(); i++)
-          delete[] subdata[i];
+  // the closest draws before this one in the same pass
+  vector<uint32_t> passEvents = m_pDevice->GetPassEvents(m_EventID);
 
-        return false;
-      }
+  size_t first = 0;
+  if(passEvents.size() > MaxPostVSPrefetch / 2)
+    first = passEvents.size() - MaxPostVSPrefetch / 2;
 
-      if(td.depth == 1)
-      {
-        subdata.push_back(bytes);
-        continue;
-      }
+  for(size_t i = first; i < passEvents.size(); i++)
+    events.push_back(passEvents[i]);
 
-      uint32_t mipSlicePitch = slicePitch;
+  if(draw->flags & eDraw_Drawcall)
+    events.push_back(draw->eventID);
 
-      uint32_t w = RDCMAX(1U, td.width >> m);
-      uint32_t h = RDCMAX(1U, td.height >> m);
-      uint32_t d = RDCMAX(1U, td.depth >> m);
+  // then the draws following it, whichever pass they're in
+  for(FetchDrawcall *next = GetDrawcallByEID((uint32_t)draw->next);
+      next && events.size() < MaxPostVSPrefetch; next = GetDrawcallByEID((uint32_t)next->next))
+  {
+    if(next->flags & eDraw_Drawcall)
+      events.push_back(next->eventID);
+  }
 
-      if(blockformat)
-      {
-        mipSlicePitch = RDCMAX(1U, ((w + 3) / 4)) * blockSize * RDCMAX(1U, h / 4);
-      }
-      else
-      {
-        mipSlicePitch = w * bytesPerPixel * h;
-      }
+  vector<uint32_t> missing;
 
-      // we don't support slice ranges, only all-or-nothing
-      // we're also not dealing with multisampled slices if
-      // depth > 1. So if we only want one slice out of a 3D texture
-      // then make sure we get it
-      if(numSlices == 1)
-      {
-        byte *depthslice = new byte[mipSlicePitch];
-        byte *b = bytes + mipSlicePitch * sliceOffset;
-        memcpy(depthslice, b, slicePitch);
-        subdata.push_back(depthslice);
+  for(size_t i = 0; i < events.size(); i++)
+  {
+    if(m_PostVSPrefetched.find(events[i]) == m_PostVSPrefetched.end())
+    {
+      missing.push_back(events[i]);
+      m_PostVSPrefetched.insert(events[i]);
+    }
+  }
 
-        delete[] bytes;
-        continue;
-      }
+  if(missing.empty())
+    return true;
 
-      s += (d - 1);
+  m_pDevice->InitPostVSBuffers(missing);
 
-      byte *b = bytes;
+  // fetching replays through the other events, so put the replay back where it was
+  m_pDevice->ReplayLog(m_EventID, eReplay_Full);
 
-      // add each depth slice as a separate subdata
-      for(uint32_t di = 0; di < d; di++)
-      {
-        byte *depthslice = new byte[mipSlicePitch];
+  return true;
+}
 
-        memcpy(depthslice, b, mipSlicePitch);
+// decodes a row of width texels at src into RGBA floats, with missing channels set to 0 and alpha
+// to 1. The packed formats and halves go through the batch converters, which are much faster than
+// decoding texel by texel. Returns the byte after the row
+static byte *DecodeRowToRGBA(const ResourceFormat &fmt, byte *src, uint32_t width, Vec4f *dst)
+{
+  if(fmt.special && fmt.specialFormat == eSpecial_R10G10B10A2)
+  {
+    ConvertFromR10G10B10A2((const uint32_t *)src, dst, width);
+    return src + width * sizeof(uint32_t);
+  }
+
+  if(fmt.special && fmt.specialFormat == eSpecial_R11G11B10)
+  {
+    std::vector<Vec3f> rgb(width);
+    ConvertFromR11G11B10((const uint32_t *)src, &rgb[0], width);
 
-        subdata.push_back(depthslice);
+    for(uint32_t x = 0; x < width; x++)
+      dst[x] = Vec4f(rgb[x].x, rgb[x].y, rgb[x].z, 1.0f);
 
-        b += mipSlicePitch;
-      }
+    return src + width * sizeof(uint32_t);
+  }
 
-      delete[] bytes;
+  uint32_t numComps = RDCMIN(fmt.compCount, 4U);
+  size_t texelSize = fmt.compCount * fmt.compByteWidth;
+
+  std::vector<float> comps(width * numComps);
+
+  if(numComps > 0 && fmt.compByteWidth == 2 && fmt.compType == eCompType_Float)
+  {
+    // components can't be skipped, so this converts the whole row
+    if(numComps == fmt.compCount)
+    {
+      ConvertFromHalf((const uint16_t *)src, &comps[0], comps.size());
+    }
+    else
+    {
+      for(uint32_t x = 0; x < width; x++)
+        ConvertFromHalf((const uint16_t *)(src + x * texelSize), &comps[x * numComps], numComps);
     }
   }
-
-  // should have been handled above, but verify incoming data is RGBA8
-  if(sd.slice.slicesAsGrid && td.format.compByteWidth == 1 && td.format.compCount == 4)
+  else
   {
-    uint32_t sliceWidth = td.width;
-    uint32_t sliceHeight = td.height;
+    for(uint32_t x = 0; x < width; x++)
+    {
+      byte *texel = src + x * texelSize;
 
-    uint32_t sliceGridHeight = (td.arraysize * td.depth) / sd.slice.sliceGridWidth;
-    if((td.arraysize * td.depth) % sd.slice.sliceGridWidth != 0)
-      sliceGridHeight++;
+      for(uint32_t c = 0; c < numComps; c++)
+        comps[x * numComps + c] = ConvertComponent(fmt, texel + fmt.compByteWidth * c);
+    }
+  }
 
-    td.width *= sd.slice.sliceGridWidth;
-    td.height *= sliceGridHeight;
+  for(uint32_t x = 0; x < width; x++)
+  {
+    float *texel = &dst[x].x;
 
-    byte *combinedData = new byte[td.width * td.height * td.format.compCount];
+    texel[0] = texel[1] = texel[2] = 0.0f;
+    texel[3] = 1.0f;
 
-    memset(combinedData, 0, td.width * td.height * td.format.compCount);
+    for(uint32_t c = 0; c < numComps; c++)
+      texel[c] = comps[x * numComps + c];
+  }
 
-    for(size_t i = 0; i < subdata.size(); i++)
-    {
-      uint32_t gridx = (uint32_t)i % sd.slice.sliceGridWidth;
-      uint32_t gridy = (uint32_t)i / sd.slice.sliceGridWidth;
+  return src + width * texelSize;
+}
 
-      uint32_t yoffs = gridy * sliceHeight;
-      uint32_t xoffs = gridx * sliceWidth;
+// one subresource decoded to RGBA floats, for the CPU fallbacks of value search and comparison.
+// numChannels is how many of the channels the format actually has.
+struct DecodedSubresource
+{
+  vector<Vec4f> texels;
+  uint32_t width, height;
+  uint32_t numChannels;
+};
+
+// decodes one 2D slice out of data, which holds a whole mip of one array slice as returned by
+// GetTextureData. 3D textures have every depth slice in the mip, and sliceFace picks one of them
+// relative to mip 0's depth. Block compressed, multisampled and the rarer packed formats aren't
+// handled.
+static bool DecodeSubresource(const FetchTexture &td, uint32_t sliceFace, uint32_t mip,
+                              FormatComponentType typeHint, byte *data, size_t dataSize,
+                              DecodedSubresource &out)
+{
+  if(data == NULL || mip >= td.mips || td.msSamp > 1)
+    return false;
 
-      for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * 4 + 0];
-          uint32_t *dstpix = (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * 4 + 0];
+  ResourceFormat fmt = td.format;
 
-          *dstpix = *srcpix;
-        }
-      }
+  size_t texelSize = 0;
 
-      delete[] subdata[i];
-    }
+  if(fmt.special)
+  {
+    if(fmt.specialFormat == eSpecial_R10G10B10A2)
+      out.numChannels = 4;
+    else if(fmt.specialFormat == eSpecial_R11G11B10)
+      out.numChannels = 3;
+    else
+      return false;
 
-    subdata.resize(1);
-    subdata[0] = combinedData;
-    rowPitch = td.width * 4;
+    texelSize = sizeof(uint32_t);
   }
-
-  // should have been handled above, but verify incoming data is RGBA8 and 6 slices
-  if(sd.slice.cubeCruciform && td.format.compByteWidth == 1 && td.format.compCount == 4 &&
-     subdata.size() == 6)
+  else
   {
-    uint32_t sliceWidth = td.width;
-    uint32_t sliceHeight = td.height;
+    if(fmt.compCount == 0 || fmt.compCount > 4 || fmt.compByteWidth == 0)
+      return false;
 
-    td.width *= 4;
-    td.height *= 3;
+    out.numChannels = fmt.compCount;
+    texelSize = fmt.compCount * fmt.compByteWidth;
+  }
 
-    byte *combinedData = new byte[td.width * td.height * td.format.compCount];
+  // typeless textures are interpreted the same way as for display
+  if(fmt.compType == eCompType_None)
+    fmt.compType = typeHint;
 
-    memset(combinedData, 0, td.width * td.height * td.format.compCount);
+  out.width = RDCMAX(1U, td.width >> mip);
+  out.height = RDCMAX(1U, td.height >> mip);
 
-    /*
-     Y X=0   1   2   3
-     =     +---+
-     0     |+y |
-           |[2]|
-       +---+---+---+---+
-     1 |-x |+z |+x |-z |
-       |[1]|[4]|[0]|[5]|
-       +---+---+---+---+
-     2     |-y |
-           |[3]|
-           +---+
+  size_t sliceSize = texelSize * out.width * out.height;
+  size_t offset = 0;
 
-    */
+  if(td.resType == eResType_Texture3D)
+    offset = sliceSize * RDCMIN(sliceFace >> mip, RDCMAX(1U, td.depth >> mip) - 1);
 
-    uint32_t gridx[6] = {2, 0, 1, 1, 1, 3};
-    uint32_t gridy[6] = {1, 1, 0, 2, 1, 1};
+  if(dataSize < offset + sliceSize)
+    return false;
 
-    for(size_t i = 0; i < subdata.size(); i++)
-    {
-      uint32_t yoffs = gridy[i] * sliceHeight;
-      uint32_t xoffs = gridx[i] * sliceWidth;
+  out.texels.resize(size_t(out.width) * out.height);
 
-      for(uint32_t y = 0; y < sliceHeight; y++)
-      {
-        for(uint32_t x = 0; x < sliceWidth; x++)
-        {
-          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * 4 + 0];
-          uint32_t *dstpix = (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * 4 + 0];
+  byte *src = data + offset;
+  for(uint32_t y = 0; y < out.height; y++)
+    src = DecodeRowToRGBA(fmt, src, out.width, &out.texels[size_t(y) * out.width]);
 
-          *dstpix = *srcpix;
-        }
-      }
+  return true;
+}
 
-      delete[] subdata[i];
-    }
+// reads back a subresource from the replay and decodes it as above
+static bool ReadSubresource(IReplayDriver *driver, ResourceId liveId, uint32_t sliceFace,
+                            uint32_t mip, FormatComponentType typeHint, DecodedSubresource &out)
+{
+  FetchTexture td = driver->GetTexture(liveId);
 
-    subdata.resize(1);
-    subdata[0] = combinedData;
-    rowPitch = td.width * 4;
-  }
+  if(mip >= td.mips || td.msSamp > 1)
+    return false;
 
-  int numComps = td.format.compCount;
+  GetTextureDataParams params;
+  params.typeHint = typeHint;
+
+  uint32_t arrayIdx = td.resType == eResType_Texture3D ? 0 : sliceFace;
+
+  size_t dataSize = 0;
+  byte *data = driver->GetTextureData(liveId, arrayIdx, mip, params, dataSize);
+
+  bool ret = DecodeSubresource(td, sliceFace, mip, typeHint, data, dataSize, out);
+
+  delete[] data;
+
+  return ret;
+}
+
+static bool ValueSearchMatchLess(const ValueSearchMatch &a, const ValueSearchMatch &b)
+{
+  if(a.y != b.y)
+    return a.y < b.y;
+  if(a.x != b.x)
+    return a.x < b.x;
+  return a.component < b.component;
+}
+
+static bool IsValueSearchMatch(float val, const ValueSearchParams &params)
+{
+  uint32_t bits = 0;
+  memcpy(&bits, &val, sizeof(bits));
+
+  // check the bits directly, so the result doesn't depend on the compiler's float handling
+  bool special = (bits & 0x7f800000) == 0x7f800000;
+  bool nan = special && (bits & 0x007fffff) != 0;
+  bool inf = special && !nan;
+
+  if((params.flags & eValueSearch_NaN) && nan)
+    return true;
+
+  if((params.flags & eValueSearch_Inf) && inf)
+    return true;
+
+  if((params.flags & eValueSearch_OutOfRange) && !nan &&
+     (val < params.minValue || val > params.maxValue))
+    return true;
+
+  return false;
+}
+
+// used when the driver can't search on the GPU, checks the same elements as SearchBufferValues
+static void SearchBufferValuesCPU(const vector<byte> &data, uint32_t stride, uint32_t numElems,
+                                  const ValueSearchParams &params,
+                                  vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
+
+  if(stride == 0)
+    return;
+
+  numElems = (uint32_t)RDCMIN(uint64_t(numElems), uint64_t(data.size() / stride));
 
-  // if we want a grayscale image of one channel, splat it across all channels
-  // and set alpha to full
-  if(sd.channelExtract >= 0 && td.format.compByteWidth == 1 &&
-     (uint32_t)sd.channelExtract < td.format.compCount)
+  uint32_t numFloats = RDCMIN(stride / 4, 32U);
+
+  for(uint32_t e = 0; e < numElems; e++)
   {
-    uint32_t cc = td.format.compCount;
+    const byte *elem = &data[size_t(e) * stride];
 
-    for(uint32_t y = 0; y < td.height; y++)
+    for(uint32_t c = 0; c < numFloats; c++)
     {
-      for(uint32_t x = 0; x < td.width; x++)
+      if((params.channelMask & (1U << c)) == 0)
+        continue;
+
+      float val = 0.0f;
+      memcpy(&val, elem + c * sizeof(float), sizeof(float));
+
+      if(!IsValueSearchMatch(val, params))
+        continue;
+
+      if(numMatches < params.maxMatches)
       {
-        subdata[0][(y * td.width + x) * cc + 0] =
-            subdata[0][(y * td.width + x) * cc + sd.channelExtract];
-        if(cc >= 2)
-          subdata[0][(y * td.width + x) * cc + 1] =
-              subdata[0][(y * td.width + x) * cc + sd.channelExtract];
-        if(cc >= 3)
-          subdata[0][(y * td.width + x) * cc + 2] =
-              subdata[0][(y * td.width + x) * cc + sd.channelExtract];
-        if(cc >= 4)
-          subdata[0][(y * td.width + x) * cc + 3] = 255;
+        ValueSearchMatch m = {e, 0, c, val};
+        matches.push_back(m);
       }
+
+      numMatches++;
     }
   }
+}
 
-  // handle formats that don't support alpha
-  if(numComps == 4 && (sd.destType == eFileType_BMP || sd.destType == eFileType_JPG))
-  {
-    byte *nonalpha = new byte[td.width * td.height * 3];
+// used when the driver can't search the texture on the GPU, including integer formats
+static void SearchTextureValuesCPU(const DecodedSubresource &sub, const ValueSearchParams &params,
+                                   vector<ValueSearchMatch> &matches, uint32_t &numMatches)
+{
+  matches.clear();
+  numMatches = 0;
 
-    for(uint32_t y = 0; y < td.height; y++)
+  for(uint32_t y = 0; y < sub.height; y++)
+  {
+    for(uint32_t x = 0; x < sub.width; x++)
     {
-      for(uint32_t x = 0; x < td.width; x++)
+      const float *texel = &sub.texels[size_t(y) * sub.width + x].x;
+
+      for(uint32_t c = 0; c < sub.numChannels; c++)
       {
-        byte r = subdata[0][(y * td.width + x) * 4 + 0];
-        byte g = subdata[0][(y * td.width + x) * 4 + 1];
-        byte b = subdata[0][(y * td.width + x) * 4 + 2];
-        byte a = subdata[0][(y * td.width + x) * 4 + 3];
+        if((params.channelMask & (1U << c)) == 0 || !IsValueSearchMatch(texel[c], params))
+          continue;
 
-        if(sd.alpha != eAlphaMap_Discard)
+        if(numMatches < params.maxMatches)
         {
-          FloatVector col = sd.alphaCol;
-          if(sd.alpha == eAlphaMap_BlendToCheckerboard)
-          {
-            bool lightSquare = ((x / 64) % 2) == ((y / 64) % 2);
-            col = lightSquare ? sd.alphaCol : sd.alphaColSecondary;
-          }
-
-          col.x = powf(col.x, 1.0f / 2.2f);
-          col.y = powf(col.y, 1.0f / 2.2f);
-          col.z = powf(col.z, 1.0f / 2.2f);
-
-          FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f, float(b) / 255.0f,
-                                          float(a) / 255.0f);
-
-          pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
-          pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
-          pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
-
-          r = byte(pixel.x * 255.0f);
-          g = byte(pixel.y * 255.0f);
-          b = byte(pixel.z * 255.0f);
+          ValueSearchMatch m = {x, y, c, texel[c]};
+          matches.push_back(m);
         }
 
-        nonalpha[(y * td.width + x) * 3 + 0] = r;
-        nonalpha[(y * td.width + x) * 3 + 1] = g;
-        nonalpha[(y * td.width + x) * 3 + 2] = b;
+        numMatches++;
       }
     }
+  }
+}
 
-    delete[] subdata[0];
+bool ReplayRenderer::SearchTextureValues(ResourceId tex, uint32_t sliceFace, uint32_t mip,
+                                         uint32_t sample, const ValueSearchParams &params,
+                                         rdctype::array<ValueSearchMatch> *matches,
+                                         uint32_t *numMatches)
+{
+  SCOPED_TRACE("ReplayRenderer::SearchTextureValues");
 
-    subdata[0] = nonalpha;
+  if(matches == NULL || numMatches == NULL || tex == ResourceId())
+    return false;
 
-    numComps = 3;
-    rowPitch = td.width * 3;
-  }
+  vector<ValueSearchMatch> found;
+  uint32_t count = 0;
 
-  // assume that (R,G,0) is better mapping than (Y,A) for 2 component data
-  if(numComps == 2 && (sd.destType == eFileType_BMP || sd.destType == eFileType_JPG ||
-                       sd.destType == eFileType_PNG || sd.destType == eFileType_TGA))
+  ResourceId liveId = m_pDevice->GetLiveID(tex);
+
+  if(!m_pDevice->SearchTextureValues(liveId, sliceFace, mip, sample, params, found, count))
   {
-    byte *rg0 = new byte[td.width * td.height * 3];
+    // the sample can't be picked out of the readback, so multisampled textures need a GPU search
+    DecodedSubresource sub;
+    if(!ReadSubresource(m_pDevice, liveId, sliceFace, mip, eCompType_None, sub))
+      return false;
 
-    for(uint32_t y = 0; y < td.height; y++)
-    {
-      for(uint32_t x = 0; x < td.width; x++)
-      {
-        byte r = subdata[0][(y * td.width + x) * 2 + 0];
-        byte g = subdata[0][(y * td.width + x) * 2 + 1];
+    SearchTextureValuesCPU(sub, params, found, count);
+  }
 
-        rg0[(y * td.width + x) * 3 + 0] = r;
-        rg0[(y * td.width + x) * 3 + 1] = g;
-        rg0[(y * td.width + x) * 3 + 2] = 0;
+  // matches come back in whatever order the GPU found them
+  std::sort(found.begin(), found.end(), ValueSearchMatchLess);
 
-        // if we're greyscaling the image, then keep the greyscale here.
-        if(sd.channelExtract >= 0)
-          rg0[(y * td.width + x) * 3 + 2] = r;
-      }
-    }
+  *matches = found;
+  *numMatches = count;
 
-    delete[] subdata[0];
+  return true;
+}
 
-    subdata[0] = rg0;
+bool ReplayRenderer::SearchPostVSValues(uint32_t instID, MeshDataStage stage,
+                                        const ValueSearchParams &params,
+                                        rdctype::array<ValueSearchMatch> *matches,
+                                        uint32_t *numMatches)
+{
+  SCOPED_TRACE("ReplayRenderer::SearchPostVSValues");
 
-    numComps = 3;
-    rowPitch = td.width * 3;
-  }
+  if(matches == NULL || numMatches == NULL)
+    return false;
 
-  FILE *f = FileIO::fopen(path, "wb");
+  FetchDrawcall *draw = GetDrawcallByEID(m_EventID);
 
-  if(!f)
+  if(draw == NULL || (draw->flags & eDraw_Drawcall) == 0)
+    return false;
+
+  instID = RDCMIN(instID, draw->numInstances - 1);
+
+  MeshFormat fmt = m_pDevice->GetPostVSBuffers(draw->eventID, instID, stage);
+
+  if(fmt.buf == ResourceId() || fmt.stride == 0)
+    return false;
+
+  ResourceId liveId = m_pDevice->GetLiveID(fmt.buf);
+
+  // indexed output isn't in vertex order, so search everything up to the end of the buffer
+  uint32_t numElems = fmt.idxbuf != ResourceId() ? ~0U : fmt.numVerts;
+
+  vector<ValueSearchMatch> found;
+  uint32_t count = 0;
+
+  if(!m_pDevice->SearchBufferValues(liveId, fmt.offset, fmt.stride, numElems, params, found, count))
   {
-    success = false;
+    uint64_t len = numElems == ~0U ? 0 : uint64_t(numElems) * fmt.stride;
+
+    vector<byte> data;
+    m_pDevice->GetBufferData(liveId, fmt.offset, len, data);
+
+    // a length of 0 reads the whole buffer, skip to the output's offset
+    if(len == 0)
+      data.erase(data.begin(), data.begin() + (size_t)RDCMIN(fmt.offset, uint64_t(data.size())));
+
+    SearchBufferValuesCPU(data, fmt.stride, numElems, params, found, count);
   }
-  else
-  {
-    if(sd.destType == eFileType_DDS)
-    {
-      dds_data ddsData;
 
-      ddsData.width = td.width;
-      ddsData.height = td.height;
-      ddsData.depth = td.depth;
-      ddsData.format = td.format;
-      ddsData.mips = numMips;
-      ddsData.slices = numSlices / td.depth;
-      ddsData.subdata = &subdata[0];
-      ddsData.cubemap = td.cubemap && numSlices == 6;
+  std::sort(found.begin(), found.end(), ValueSearchMatchLess);
 
-      success = write_dds_to_file(f, ddsData);
-    }
-    else if(sd.destType == eFileType_BMP)
-    {
-      int ret = stbi_write_bmp_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
-                                       subdata[0]);
-      success = (ret != 0);
-    }
-    else if(sd.destType == eFileType_PNG)
-    {
-      // discard alpha if requested
-      for(uint32_t p = 0; sd.alpha == eAlphaMap_Discard && p < td.width * td.height; p++)
-        subdata[0][p * 4 + 3] = 255;
+  *matches = found;
+  *numMatches = count;
 
-      int ret = stbi_write_png_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
-                                       subdata[0], rowPitch);
-      success = (ret != 0);
-    }
-    else if(sd.destType == eFileType_TGA)
-    {
-      // discard alpha if requested
-      for(uint32_t p = 0; sd.alpha == eAlphaMap_Discard && p < td.width * td.height; p++)
-        subdata[0][p * 4 + 3] = 255;
+  return true;
+}
 
-      int ret = stbi_write_tga_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
-                                       subdata[0]);
-      success = (ret != 0);
-    }
-    else if(sd.destType == eFileType_JPG)
-    {
-      jpge::params p;
-      p.m_quality = sd.jpegQuality;
+bool ReplayRenderer::SetCompareInput(uint32_t input, const TextureCompareInput &in,
+                                     uint32_t &replayedEID)
+{
+  uint32_t eventID = in.eventID ? in.eventID : m_EventID;
 
-      int len = td.width * td.height * td.format.compCount;
-      // ensure buffer is at least 1024
-      if(len < 1024)
-        len = 1024;
+  if(eventID != replayedEID)
+  {
+    m_pDevice->ReplayLog(eventID, eReplay_Full);
+    replayedEID = eventID;
+  }
 
-      char *jpgdst = new char[len];
+  return m_pDevice->SetTextureDiffInput(input, m_pDevice->GetLiveID(in.texid), in.sliceFace,
+                                        in.mip, in.sampleIdx, in.typeHint);
+}
 
-      success = jpge::compress_image_to_jpeg_file_in_memory(jpgdst, len, td.width, td.height,
-                                                            numComps, subdata[0], p);
+bool ReplayRenderer::ReadCompareInput(const TextureCompareInput &in, uint32_t &replayedEID,
+                                      DecodedSubresource &out)
+{
+  uint32_t eventID = in.eventID ? in.eventID : m_EventID;
 
-      if(success)
-        fwrite(jpgdst, 1, len, f);
+  if(eventID != replayedEID)
+  {
+    m_pDevice->ReplayLog(eventID, eReplay_Full);
+    replayedEID = eventID;
+  }
 
-      delete[] jpgdst;
-    }
-    else if(sd.destType == eFileType_HDR || sd.destType == eFileType_EXR)
-    {
-      float *fldata = NULL;
-      float *abgr[4] = {NULL, NULL, NULL, NULL};
+  return ReadSubresource(m_pDevice, m_pDevice->GetLiveID(in.texid), in.sliceFace, in.mip,
+                         in.typeHint, out);
+}
 
-      if(sd.destType == eFileType_HDR)
-      {
-        fldata = new float[td.width * td.height * 4];
-      }
-      else
-      {
-        abgr[0] = new float[td.width * td.height];
-        abgr[1] = new float[td.width * td.height];
-        abgr[2] = new float[td.width * td.height];
-        abgr[3] = new float[td.width * td.height];
-      }
+ResourceId ReplayRenderer::GetCompareProxy(const FetchTexture &templateTex)
+{
+  for(size_t i = 0; i < m_CompareProxies.size(); i++)
+  {
+    const FetchTexture &p = m_CompareProxies[i].first;
+    if(p.width == templateTex.width && p.height == templateTex.height &&
+       p.depth == templateTex.depth && p.resType == templateTex.resType &&
+       p.format == templateTex.format)
+      return m_CompareProxies[i].second;
+  }
 
-      byte *srcData = subdata[0];
+  ResourceId proxyId = m_pDevice->CreateProxyTexture(templateTex);
+  if(proxyId != ResourceId())
+    m_CompareProxies.push_back(std::make_pair(templateTex, proxyId));
 
-      ResourceFormat saveFmt = td.format;
-      if(saveFmt.compType == eCompType_None)
-        saveFmt.compType = sd.typeHint;
-      if(saveFmt.compType == eCompType_None)
-        saveFmt.compType = saveFmt.compByteWidth == 4 ? eCompType_Float : eCompType_UNorm;
+  return proxyId;
+}
 
-      for(uint32_t y = 0; y < td.height; y++)
-      {
-        for(uint32_t x = 0; x < td.width; x++)
-        {
-          float r = 0.0f;
-          float g = 0.0f;
-          float b = 0.0f;
-          float a = 1.0f;
+static bool IsNaNBits(float f)
+{
+  uint32_t bits = 0;
+  memcpy(&bits, &f, sizeof(bits));
+  return (bits & 0x7f800000) == 0x7f800000 && (bits & 0x007fffff) != 0;
+}
 
-          if(saveFmt.special && saveFmt.specialFormat == eSpecial_R10G10B10A2)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
+bool ReplayRenderer::DiffSubresources(const DecodedSubresource &a, const DecodedSubresource &b,
+                                      float threshold, TextureCompareResult &result)
+{
+  RDCEraseEl(result);
 
-            Vec4f vec = ConvertFromR10G10B10A2(*u32);
+  uint32_t w = RDCMIN(a.width, b.width);
+  uint32_t h = RDCMIN(a.height, b.height);
 
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = vec.w;
+  const uint32_t infBits = 0x7f800000;
+  float inf = 0.0f;
+  memcpy(&inf, &infBits, sizeof(inf));
 
-            srcData += 4;
-          }
-          else if(saveFmt.special && saveFmt.specialFormat == eSpecial_R11G11B10)
-          {
-            uint32_t *u32 = (uint32_t *)srcData;
+  vector<Vec4f> diff(size_t(w) * h);
 
-            Vec3f vec = ConvertFromR11G11B10(*u32);
+  // the same rules as the GPU diff: equal infinities and matching NaNs aren't differences, a NaN
+  // on one side only is as different as it gets
+  for(uint32_t y = 0; y < h; y++)
+  {
+    for(uint32_t x = 0; x < w; x++)
+    {
+      const float *ta = &a.texels[size_t(y) * a.width + x].x;
+      const float *tb = &b.texels[size_t(y) * b.width + x].x;
+      float *td = &diff[size_t(y) * w + x].x;
 
-            r = vec.x;
-            g = vec.y;
-            b = vec.z;
-            a = 1.0f;
+      bool different = false;
 
-            srcData += 4;
-          }
-          else
-          {
-            if(saveFmt.compCount >= 1)
-              r = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 0);
-            if(saveFmt.compCount >= 2)
-              g = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 1);
-            if(saveFmt.compCount >= 3)
-              b = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 2);
-            if(saveFmt.compCount >= 4)
-              a = ConvertComponent(saveFmt, srcData + saveFmt.compByteWidth * 3);
-
-            srcData += saveFmt.compCount * saveFmt.compByteWidth;
-          }
+      for(int c = 0; c < 4; c++)
+      {
+        bool nanA = IsNaNBits(ta[c]), nanB = IsNaNBits(tb[c]);
 
-          if(saveFmt.bgraOrder)
-            std::swap(r, b);
+        if(ta[c] == tb[c] || (nanA && nanB))
+          td[c] = 0.0f;
+        else if(nanA || nanB)
+          td[c] = inf;
+        else
+          td[c] = fabsf(ta[c] - tb[c]);
 
-          // HDR can't represent negative values
-          if(sd.destType == eFileType_HDR)
-          {
-            r = RDCMAX(r, 0.0f);
-            g = RDCMAX(g, 0.0f);
-            b = RDCMAX(b, 0.0f);
-            a = RDCMAX(a, 0.0f);
-          }
+        result.maxError[c] = RDCMAX(result.maxError[c], td[c]);
+        different |= td[c] > threshold;
+      }
 
-          if(sd.channelExtract == 0)
-          {
-            g = b = r;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 1)
-          {
-            r = b = g;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 2)
-          {
-            r = g = b;
-            a = 1.0f;
-          }
-          if(sd.channelExtract == 3)
-          {
-            r = g = b = a;
-            a = 1.0f;
-          }
+      if(different)
+        result.numDifferent++;
+    }
+  }
 
-          if(fldata)
-          {
-            fldata[(y * td.width + x) * 4 + 0] = r;
-            fldata[(y * td.width + x) * 4 + 1] = g;
-            fldata[(y * td.width + x) * 4 + 2] = b;
-            fldata[(y * td.width + x) * 4 + 3] = a;
-          }
-          else
-          {
-            abgr[0][(y * td.width + x)] = a;
-            abgr[1][(y * td.width + x)] = b;
-            abgr[2][(y * td.width + x)] = g;
-            abgr[3][(y * td.width + x)] = r;
-          }
-        }
-      }
+  result.width = w;
+  result.height = h;
 
-      if(sd.destType == eFileType_HDR)
-      {
-        int ret = stbi_write_hdr_to_func(fileWriteFunc, (void *)f, td.width, td.height, 4, fldata);
-        success = (ret != 0);
-      }
-      else if(sd.destType == eFileType_EXR)
-      {
-        const char *err = NULL;
+  // the diff is uploaded so it can be displayed and inspected like the GPU diff's output. Proxies
+  // can only be made on a local replay, remotely only the stats are available.
+  if(!m_pDevice->IsRemoteProxy())
+  {
+    FetchTexture diffTex = FetchTexture();
+    diffTex.resType = eResType_Texture2D;
+    diffTex.dimension = 2;
+    diffTex.width = w;
+    diffTex.height = h;
+    diffTex.depth = 1;
+    diffTex.mips = 1;
+    diffTex.arraysize = 1;
+    diffTex.msSamp = 1;
+    diffTex.format.special = false;
+    diffTex.format.compCount = 4;
+    diffTex.format.compByteWidth = 4;
+    diffTex.format.compType = eCompType_Float;
+
+    result.diffTexture = GetCompareProxy(diffTex);
+
+    if(result.diffTexture != ResourceId())
+      m_pDevice->SetProxyTextureData(result.diffTexture, 0, 0, (byte *)&diff[0],
+                                     diff.size() * sizeof(Vec4f));
+  }
 
-        EXRImage exrImage;
-        InitEXRImage(&exrImage);
+  return true;
+}
 
-        int pixTypes[4] = {TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT,
-                           TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT};
-        int reqTypes[4] = {TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF,
-                           TINYEXR_PIXELTYPE_HALF};
+bool ReplayRenderer::CompareTextures(const TextureCompareInput &a, const TextureCompareInput &b,
+                                     float threshold, TextureCompareResult *result)
+{
+  SCOPED_TRACE("ReplayRenderer::CompareTextures");
 
-        // must be in this order as many viewers don't pay attention to channels and just assume
-        // they are in this order
-        const char *bgraNames[4] = {"A", "B", "G", "R"};
+  if(result == NULL)
+    return false;
 
-        exrImage.num_channels = 4;
-        exrImage.channel_names = bgraNames;
-        exrImage.images = (unsigned char **)abgr;
-        exrImage.width = td.width;
-        exrImage.height = td.height;
-        exrImage.pixel_types = pixTypes;
-        exrImage.requested_pixel_types = reqTypes;
+  RDCEraseEl(*result);
 
-        unsigned char *mem = NULL;
+  uint32_t replayedEID = m_EventID;
 
-        size_t ret = SaveMultiChannelEXRToMemory(&exrImage, &mem, &err);
+  bool gpu = SetCompareInput(0, a, replayedEID) && SetCompareInput(1, b, replayedEID);
 
-        success = (ret > 0);
-        if(success)
-          FileIO::fwrite(mem, 1, ret, f);
-        else
-          RDCERR("Error saving EXR file %d: '%s'", ret, err);
+  // without a GPU diff on this API, or for these formats, both sides are read back and compared
+  // on the CPU instead
+  DecodedSubresource subs[2];
+  bool cpu = !gpu && ReadCompareInput(a, replayedEID, subs[0]) &&
+             ReadCompareInput(b, replayedEID, subs[1]);
 
-        free(mem);
-      }
+  // the inputs are copied or read back, so the replay can go back to where it was
+  if(replayedEID != m_EventID)
+    m_pDevice->ReplayLog(m_EventID, eReplay_Full);
 
-      if(fldata)
-      {
-        delete[] fldata;
-      }
-      else
+  if(gpu)
+    return m_pDevice->DiffTextureInputs(threshold, *result);
+
+  return cpu && DiffSubresources(subs[0], subs[1], threshold, *result);
+}
+
+bool ReplayRenderer::CompareTextureWithCapture(const TextureCompareInput &a,
+                                               IReplayRenderer *other,
+                                               const TextureCompareInput &b, float threshold,
+                                               TextureCompareResult *result)
+{
+  SCOPED_TRACE("ReplayRenderer::CompareTextureWithCapture");
+
+  if(result == NULL || other == NULL)
+    return false;
+
+  RDCEraseEl(*result);
+
+  rdctype::array<FetchTexture> texs;
+  other->GetTextures(&texs);
+
+  const FetchTexture *src = NULL;
+  for(int32_t i = 0; i < texs.count; i++)
+  {
+    if(texs[i].ID == b.texid)
+    {
+      src = &texs[i];
+      break;
+    }
+  }
+
+  if(src == NULL || b.mip >= src->mips)
+    return false;
+
+  if(src->msSamp > 1)
+  {
+    RDCWARN("Can't compare multisampled texture %llu from another capture", b.texid);
+    return false;
+  }
+
+  if(b.eventID)
+    other->SetFrameEvent(b.eventID, false);
+
+  uint32_t arrayIdx = src->resType == eResType_Texture3D ? 0 : b.sliceFace;
+
+  rdctype::array<byte> data;
+  if(!other->GetTextureData(b.texid, arrayIdx, b.mip, &data) || data.count == 0)
+    return false;
+
+  // only the compared subresource is uploaded, as a single mip and slice texture
+  FetchTexture proxyTex = *src;
+  proxyTex.width = RDCMAX(1U, src->width >> b.mip);
+  proxyTex.height = RDCMAX(1U, src->height >> b.mip);
+  proxyTex.depth = src->resType == eResType_Texture3D ? RDCMAX(1U, src->depth >> b.mip) : 1;
+  proxyTex.mips = 1;
+  proxyTex.arraysize = 1;
+  proxyTex.cubemap = false;
+
+  if(src->resType == eResType_Texture1DArray)
+    proxyTex.resType = eResType_Texture1D;
+  else if(src->resType == eResType_Texture2DArray || src->resType == eResType_TextureCube ||
+          src->resType == eResType_TextureCubeArray)
+    proxyTex.resType = eResType_Texture2D;
+
+  // the GPU diff needs the other capture's texture uploaded as a proxy, which needs a local device
+  // and a format it can create
+  ResourceId proxyId;
+  if(!m_pDevice->IsRemoteProxy() && m_pDevice->IsTextureSupported(proxyTex.format))
+    proxyId = GetCompareProxy(proxyTex);
+
+  if(proxyId != ResourceId())
+    m_pDevice->SetProxyTextureData(proxyId, 0, 0, data.elems, (size_t)data.count);
+
+  uint32_t replayedEID = m_EventID;
+
+  // the proxy is already a live ID, and 3D slices are relative to the uploaded mip
+  uint32_t proxySlice = src->resType == eResType_Texture3D ? (b.sliceFace >> b.mip) : 0;
+
+  bool gpu = proxyId != ResourceId() && SetCompareInput(0, a, replayedEID) &&
+             m_pDevice->SetTextureDiffInput(1, proxyId, proxySlice, 0, 0, b.typeHint);
+
+  // otherwise compare on the CPU, the other capture's data is already here
+  DecodedSubresource subs[2];
+  bool cpu = !gpu && ReadCompareInput(a, replayedEID, subs[0]) &&
+             DecodeSubresource(*src, b.sliceFace, b.mip, b.typeHint, data.elems,
+                               (size_t)data.count, subs[1]);
+
+  if(replayedEID != m_EventID)
+    m_pDevice->ReplayLog(m_EventID, eReplay_Full);
+
+  if(gpu)
+    return m_pDevice->DiffTextureInputs(threshold, *result);
+
+  return cpu && DiffSubresources(subs[0], subs[1], threshold, *result);
+}
+
+bool ReplayRenderer::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
+                                   rdctype::array<byte> *data)
+{
+  SCOPED_TRACE("ReplayRenderer::GetBufferData");
+
+  if(data == NULL || buff == ResourceId())
+    return false;
+
+  ResourceId liveId = m_pDevice->GetLiveID(buff);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting buffer data", buff);
+    return false;
+  }
+
+  ResourceDataKey key;
+  bool cacheable = GetResourceDataKey(buff, false, offset, len, key);
+
+  if(cacheable)
+  {
+    const vector<byte> *cached = FindResourceData(key);
+    if(cached)
+    {
+      create_array_init(*data, cached->size(), !cached->empty() ? &(*cached)[0] : NULL);
+      return true;
+    }
+  }
+
+  vector<byte> retData;
+  m_pDevice->GetBufferData(liveId, offset, len, retData);
+
+  create_array_init(*data, retData.size(), !retData.empty() ? &retData[0] : NULL);
+
+  if(cacheable)
+    AddResourceData(key, !retData.empty() ? &retData[0] : NULL, retData.size());
+
+  return true;
+}
+
+bool ReplayRenderer::GetBuffersData(const rdctype::array<BufferDataRange> &ranges,
+                                    rdctype::array<rdctype::array<byte> > *data)
+{
+  if(data == NULL)
+    return false;
+
+  create_array_uninit(*data, ranges.count);
+
+  // ranges that weren't in the cache, fetched together in one go
+  vector<BufferDataRange> fetch;
+  vector<int32_t> fetchIdx;
+  vector<ResourceDataKey> fetchKeys;
+  vector<bool> fetchCacheable;
+
+  for(int32_t i = 0; i < ranges.count; i++)
+  {
+    const BufferDataRange &range = ranges[i];
+
+    if(range.buffer == ResourceId())
+      continue;
+
+    ResourceId liveId = m_pDevice->GetLiveID(range.buffer);
+
+    if(liveId == ResourceId())
+    {
+      RDCERR("Couldn't get Live ID for %llu getting buffer data", range.buffer);
+      continue;
+    }
+
+    ResourceDataKey key;
+    bool cacheable = GetResourceDataKey(range.buffer, false, range.offset, range.length, key);
+
+    if(cacheable)
+    {
+      const vector<byte> *cached = FindResourceData(key);
+      if(cached)
       {
-        delete[] abgr[0];
-        delete[] abgr[1];
-        delete[] abgr[2];
-        delete[] abgr[3];
+        create_array_init(data->elems[i], cached->size(), !cached->empty() ? &(*cached)[0] : NULL);
+        continue;
       }
     }
-
-    FileIO::fclose(f);
+
+    fetch.push_back(BufferDataRange(liveId, range.offset, range.length));
+    fetchIdx.push_back(i);
+    fetchKeys.push_back(key);
+    fetchCacheable.push_back(cacheable);
+  }
+
+  if(fetch.empty())
+    return true;
+
+  vector<vector<byte> > retData;
+  m_pDevice->GetBuffersData(fetch, retData);
+
+  for(size_t i = 0; i < fetch.size() && i < retData.size(); i++)
+  {
+    const vector<byte> &d = retData[i];
+
+    create_array_init(data->elems[fetchIdx[i]], d.size(), !d.empty() ? &d[0] : NULL);
+
+    if(fetchCacheable[i])
+      AddResourceData(fetchKeys[i], !d.empty() ? &d[0] : NULL, d.size());
+  }
+
+  return true;
+}
+
+bool ReplayRenderer::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                    rdctype::array<byte> *data)
+{
+  SCOPED_TRACE("ReplayRenderer::GetTextureData");
+
+  if(data == NULL)
+    return false;
+
+  ResourceId liveId = m_pDevice->GetLiveID(tex);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting texture data", tex);
+    return false;
+  }
+
+  ResourceDataKey key;
+  bool cacheable = GetResourceDataKey(tex, true, arrayIdx, mip, key);
+
+  if(cacheable)
+  {
+    const vector<byte> *cached = FindResourceData(key);
+    if(cached)
+    {
+      create_array_init(*data, cached->size(), !cached->empty() ? &(*cached)[0] : NULL);
+      return true;
+    }
+  }
+
+  size_t sz = 0;
+  byte *bytes = m_pDevice->GetTextureData(liveId, arrayIdx, mip, GetTextureDataParams(), sz);
+
+  if(sz == 0 || bytes == NULL)
+  {
+    create_array_uninit(*data, 0);
+    sz = 0;
+  }
+  else
+  {
+    create_array_init(*data, sz, bytes);
+  }
+
+  if(cacheable)
+    AddResourceData(key, bytes, sz);
+
+  SAFE_DELETE_ARRAY(bytes);
+
+  return true;
+}
+
+// copies src into the caller's buffer if it fits, and reports the size it needed either way
+static bool CopyResourceDataOut(const byte *src, size_t size, byte *dst, uint64_t dstSize,
+                                uint64_t *dataSize)
+{
+  if(dataSize)
+    *dataSize = size;
+
+  if(size > 0 && (dst == NULL || dstSize < size))
+    return false;
+
+  if(size > 0)
+    memcpy(dst, src, size);
+
+  return true;
+}
+
+bool ReplayRenderer::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dst,
+                                       uint64_t dstSize, uint64_t *dataSize)
+{
+  SCOPED_TRACE("ReplayRenderer::GetBufferDataInto");
+
+  if(dataSize)
+    *dataSize = 0;
+
+  if(buff == ResourceId())
+    return false;
+
+  ResourceId liveId = m_pDevice->GetLiveID(buff);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting buffer data", buff);
+    return false;
+  }
+
+  ResourceDataKey key;
+  bool cacheable = GetResourceDataKey(buff, false, offset, len, key);
+
+  if(cacheable)
+  {
+    const vector<byte> *cached = FindResourceData(key);
+    if(cached)
+      return CopyResourceDataOut(!cached->empty() ? &(*cached)[0] : NULL, cached->size(), dst,
+                                 dstSize, dataSize);
+  }
+
+  vector<byte> retData;
+  m_pDevice->GetBufferData(liveId, offset, len, retData);
+
+  const byte *bytes = !retData.empty() ? &retData[0] : NULL;
+
+  // cache before copying out, so that a retry after a too-small buffer doesn't read back again
+  if(cacheable)
+    AddResourceData(key, bytes, retData.size());
+
+  return CopyResourceDataOut(bytes, retData.size(), dst, dstSize, dataSize);
+}
+
+bool ReplayRenderer::GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dst,
+                                        uint64_t dstSize, uint64_t *dataSize)
+{
+  SCOPED_TRACE("ReplayRenderer::GetTextureDataInto");
+
+  if(dataSize)
+    *dataSize = 0;
+
+  ResourceId liveId = m_pDevice->GetLiveID(tex);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting texture data", tex);
+    return false;
+  }
+
+  ResourceDataKey key;
+  bool cacheable = GetResourceDataKey(tex, true, arrayIdx, mip, key);
+
+  if(cacheable)
+  {
+    const vector<byte> *cached = FindResourceData(key);
+    if(cached)
+      return CopyResourceDataOut(!cached->empty() ? &(*cached)[0] : NULL, cached->size(), dst,
+                                 dstSize, dataSize);
+  }
+
+  size_t sz = 0;
+  byte *bytes = m_pDevice->GetTextureData(liveId, arrayIdx, mip, GetTextureDataParams(), sz);
+
+  if(bytes == NULL)
+    sz = 0;
+
+  if(cacheable)
+    AddResourceData(key, bytes, sz);
+
+  bool ret = CopyResourceDataOut(bytes, sz, dst, dstSize, dataSize);
+
+  SAFE_DELETE_ARRAY(bytes);
+
+  return ret;
+}
+
+// a texture that has been read back for saving. Readback has to happen on the replay thread, but
+// encoding and writing the file only touches this data, so it can happen on any thread.
+struct TextureSaveJob
+{
+  TextureSaveJob() : rowPitch(0), numMips(0), numSlices(0), stream(NULL), numStreamed(0)
+  {
+    success = false;
+    RDCEraseEl(streamLayout);
+  }
+
+  TextureSave sd;
+  FetchTexture td;
+  vector<byte *> subdata;
+  uint32_t rowPitch;
+  uint32_t numMips;
+  uint32_t numSlices;
+  string path;
+
+  // if set, DDS subresources are written to this file as soon as they're read back instead of
+  // being kept in subdata, so only one is ever held in memory.
+  FILE *stream;
+  dds_data streamLayout;
+  uint32_t numStreamed;
+
+  bool success;
+};
+
+// if we want a grayscale image of one channel, splat it across all channels
+// and set alpha to full
+static void ExtractTextureChannel(byte *data, const FetchTexture &td, int32_t channel)
+{
+  if(channel < 0 || td.format.compByteWidth != 1 || (uint32_t)channel >= td.format.compCount)
+    return;
+
+  uint32_t cc = td.format.compCount;
+
+  for(uint32_t y = 0; y < td.height; y++)
+  {
+    for(uint32_t x = 0; x < td.width; x++)
+    {
+      data[(y * td.width + x) * cc + 0] = data[(y * td.width + x) * cc + channel];
+      if(cc >= 2)
+        data[(y * td.width + x) * cc + 1] = data[(y * td.width + x) * cc + channel];
+      if(cc >= 3)
+        data[(y * td.width + x) * cc + 2] = data[(y * td.width + x) * cc + channel];
+      if(cc >= 4)
+        data[(y * td.width + x) * cc + 3] = 255;
+    }
+  }
+}
+
+// takes ownership of a subresource that's been read back, either keeping it for encoding or
+// writing it straight out when streaming.
+static bool AddTextureSaveSubresource(TextureSaveJob &job, uint32_t mip, byte *data)
+{
+  if(job.stream == NULL)
+  {
+    job.subdata.push_back(data);
+    return true;
+  }
+
+  // matches EncodeTextureSave, which only applies this to the first subresource
+  if(job.numStreamed == 0)
+    ExtractTextureChannel(data, job.td, job.sd.channelExtract);
+
+  job.numStreamed++;
+
+  bool ret = write_dds_subresource_to_file(job.stream, job.streamLayout, (int)mip, data);
+
+  delete[] data;
+
+  return ret;
+}
+
+bool ReplayRenderer::FetchTextureSave(const TextureSave &saveData, TextureSaveJob &job)
+{
+  TextureSave sd = saveData;    // mutable copy
+  ResourceId liveid = m_pDevice->GetLiveID(sd.id);
+  FetchTexture td = m_pDevice->GetTexture(liveid);
+
+  // clamp sample/mip/slice indices
+  if(td.msSamp == 1)
+  {
+    sd.sample.sampleIndex = 0;
+    sd.sample.mapToArray = false;
+  }
+  else
+  {
+    if(sd.sample.sampleIndex != ~0U)
+      sd.sample.sampleIndex = RDCCLAMP(sd.sample.sampleIndex, 0U, td.msSamp);
+  }
+
+  // don't support cube cruciform for non cubemaps, or
+  // cubemap arrays
+  if(!td.cubemap || td.arraysize != 6 || td.msSamp != 1)
+    sd.slice.cubeCruciform = false;
+
+  if(sd.mip != -1)
+    sd.mip = RDCCLAMP(sd.mip, 0, (int32_t)td.mips);
+  if(sd.slice.sliceIndex != -1)
+    sd.slice.sliceIndex = RDCCLAMP(sd.slice.sliceIndex, 0, int32_t(td.arraysize * td.depth));
+
+  if(td.arraysize * td.depth * td.msSamp == 1)
+  {
+    sd.slice.sliceIndex = 0;
+    sd.slice.slicesAsGrid = false;
+  }
+
+  // can't extract a channel that's not in the source texture
+  if(sd.channelExtract >= 0 && (uint32_t)sd.channelExtract >= td.format.compCount)
+    sd.channelExtract = -1;
+
+  sd.slice.sliceGridWidth = RDCMAX(sd.slice.sliceGridWidth, 1);
+
+  // store sample count so we know how many 'slices' is one real slice
+  // multisampled textures cannot have mips, subresource layout is same as would be for mips:
+  // [slice0 sample0], [slice0 sample1], [slice1 sample0], [slice1 sample1]
+  uint32_t sampleCount = td.msSamp;
+  bool multisampled = td.msSamp > 1;
+
+  bool resolveSamples = (sd.sample.sampleIndex == ~0U);
+
+  if(resolveSamples)
+  {
+    td.msSamp = 1;
+    sd.sample.mapToArray = false;
+    sd.sample.sampleIndex = 0;
+  }
+
+  // treat any multisampled texture as if it were an array
+  // of <sample count> dimension (on top of potential existing array
+  // dimension). GetTextureData() uses the same convention.
+  if(td.msSamp > 1)
+  {
+    td.arraysize *= td.msSamp;
+    td.msSamp = 1;
+  }
+
+  if(sd.destType != eFileType_DDS && sd.sample.mapToArray && !sd.slice.slicesAsGrid &&
+     sd.slice.sliceIndex == -1)
+  {
+    sd.sample.mapToArray = false;
+    sd.sample.sampleIndex = 0;
+  }
+
+  // only DDS supports writing multiple mips, fall back to mip 0 if 'all mips' was specified
+  if(sd.destType != eFileType_DDS && sd.mip == -1)
+    sd.mip = 0;
+
+  // only DDS supports writing multiple slices, fall back to slice 0 if 'all slices' was specified
+  if(sd.destType != eFileType_DDS && sd.slice.sliceIndex == -1 && !sd.slice.slicesAsGrid &&
+     !sd.slice.cubeCruciform)
+    sd.slice.sliceIndex = 0;
+
+  // fetch source data subresources (typically only one, possibly more
+  // if we're writing to DDS (so writing multiple mips/slices) or resolving
+  // down a multisampled texture for writing as a single 'image' elsewhere)
+  uint32_t sliceOffset = 0;
+  uint32_t sliceStride = 1;
+  uint32_t numSlices = td.arraysize * td.depth;
+
+  uint32_t mipOffset = 0;
+  uint32_t numMips = td.mips;
+
+  bool singleSlice = (sd.slice.sliceIndex != -1);
+
+  // set which slices/mips we need
+  if(multisampled)
+  {
+    bool singleSample = !sd.sample.mapToArray;
+
+    // multisampled images have no mips
+    mipOffset = 0;
+    numMips = 1;
+
+    if(singleSlice)
+    {
+      if(singleSample)
+      {
+        // we want a specific sample in a specific real slice
+        sliceOffset = sd.slice.sliceIndex * sampleCount + sd.sample.sampleIndex;
+        numSlices = 1;
+      }
+      else
+      {
+        // we want all the samples (now mapped to slices) in a specific real slice
+        sliceOffset = sd.slice.sliceIndex;
+        numSlices = sampleCount;
+      }
+    }
+    else
+    {
+      if(singleSample)
+      {
+        // we want one sample in every slice, so we have to set the stride to sampleCount
+        // to skip every other sample (mapped to slices), starting from the sample we want
+        // in the first real slice
+        sliceOffset = sd.sample.sampleIndex;
+        sliceStride = sampleCount;
+        numSlices = RDCMAX(1U, td.arraysize / sampleCount);
+      }
+      else
+      {
+        // we want all slices, all samples
+        sliceOffset = 0;
+        numSlices = td.arraysize;
+      }
+    }
+  }
+  else
+  {
+    if(singleSlice)
+    {
+      numSlices = 1;
+      sliceOffset = sd.slice.sliceIndex;
+    }
+    // otherwise take all slices, as by default
+
+    if(sd.mip != -1)
+    {
+      mipOffset = sd.mip;
+      numMips = 1;
+    }
+    // otherwise take all mips, as by default
+  }
+
+  vector<byte *> &subdata = job.subdata;
+
+  bool downcast = false;
+
+  // don't support slice mappings for DDS - it supports slices natively
+  if(sd.destType == eFileType_DDS)
+  {
+    sd.slice.cubeCruciform = false;
+    sd.slice.slicesAsGrid = false;
+  }
+
+  // force downcast to be able to do grid mappings
+  if(sd.slice.cubeCruciform || sd.slice.slicesAsGrid)
+    downcast = true;
+
+  // we don't support any file formats that handle these block compression formats
+  if(td.format.specialFormat == eSpecial_ETC2 || td.format.specialFormat == eSpecial_EAC ||
+     td.format.specialFormat == eSpecial_ASTC)
+    downcast = true;
+
+  // for DDS don't downcast, for non-HDR always downcast if we're not already RGBA8 unorm
+  // for HDR&EXR we can convert from most regular types as well as 10.10.10.2 and 11.11.10
+  if((sd.destType != eFileType_DDS && sd.destType != eFileType_HDR && sd.destType != eFileType_EXR &&
+      (td.format.compByteWidth != 1 || td.format.compCount != 4 ||
+       td.format.compType != eCompType_UNorm || td.format.bgraOrder)) ||
+     downcast || (sd.destType != eFileType_DDS && td.format.special &&
+                  td.format.specialFormat != eSpecial_R10G10B10A2 &&
+                  td.format.specialFormat != eSpecial_R11G11B10))
+  {
+    downcast = true;
+    td.format.compByteWidth = 1;
+    td.format.compCount = 4;
+    td.format.compType = eCompType_UNorm;
+    td.format.special = false;
+    td.format.specialFormat = eSpecial_Unknown;
+  }
+
+  uint32_t rowPitch = 0;
+  uint32_t slicePitch = 0;
+
+  bool blockformat = false;
+  int blockSize = 0;
+  uint32_t bytesPerPixel = 1;
+
+  td.width = RDCMAX(1U, td.width >> mipOffset);
+  td.height = RDCMAX(1U, td.height >> mipOffset);
+  td.depth = RDCMAX(1U, td.depth >> mipOffset);
+
+  if(td.format.specialFormat == eSpecial_BC1 || td.format.specialFormat == eSpecial_BC2 ||
+     td.format.specialFormat == eSpecial_BC3 || td.format.specialFormat == eSpecial_BC4 ||
+     td.format.specialFormat == eSpecial_BC5 || td.format.specialFormat == eSpecial_BC6 ||
+     td.format.specialFormat == eSpecial_BC7)
+  {
+    blockSize = (td.format.specialFormat == eSpecial_BC1 || td.format.specialFormat == eSpecial_BC4)
+                    ? 8
+                    : 16;
+    rowPitch = RDCMAX(1U, ((td.width + 3) / 4)) * blockSize;
+    slicePitch = rowPitch * RDCMAX(1U, td.height / 4);
+    blockformat = true;
+  }
+  else
+  {
+    switch(td.format.specialFormat)
+    {
+      case eSpecial_S8: bytesPerPixel = 1; break;
+      case eSpecial_R10G10B10A2:
+      case eSpecial_R9G9B9E5:
+      case eSpecial_R11G11B10:
+      case eSpecial_D24S8: bytesPerPixel = 4; break;
+      case eSpecial_R5G6B5:
+      case eSpecial_R5G5B5A1:
+      case eSpecial_R4G4B4A4: bytesPerPixel = 2; break;
+      case eSpecial_D32S8: bytesPerPixel = 8; break;
+      case eSpecial_D16S8:
+      case eSpecial_YUV:
+      case eSpecial_R4G4:
+        RDCERR("Unsupported file format %u", td.format.specialFormat);
+        return false;
+      default: bytesPerPixel = td.format.compCount * td.format.compByteWidth;
+    }
+
+    rowPitch = td.width * bytesPerPixel;
+    slicePitch = rowPitch * td.height;
+  }
+
+  job.sd = sd;
+  job.td = td;
+
+  if(job.stream)
+  {
+    dds_data &ddsData = job.streamLayout;
+
+    ddsData.width = td.width;
+    ddsData.height = td.height;
+    ddsData.depth = td.depth;
+    ddsData.format = td.format;
+    ddsData.mips = numMips;
+    ddsData.slices = numSlices / td.depth;
+    ddsData.subdata = NULL;
+    ddsData.cubemap = td.cubemap && numSlices == 6;
+
+    if(!write_dds_header_to_file(job.stream, ddsData))
+      return false;
+  }
+
+  // loop over fetching subresources
+  for(uint32_t s = 0; s < numSlices; s++)
+  {
+    uint32_t slice = s * sliceStride + sliceOffset;
+
+    for(uint32_t m = 0; m < numMips; m++)
+    {
+      uint32_t mip = m + mipOffset;
+
+      GetTextureDataParams params;
+      params.forDiskSave = true;
+      params.typeHint = sd.typeHint;
+      params.resolve = resolveSamples;
+      params.remap = downcast ? eRemap_RGBA8 : eRemap_None;
+      params.blackPoint = sd.comp.blackPoint;
+      params.whitePoint = sd.comp.whitePoint;
+
+      size_t datasize = 0;
+      byte *bytes = m_pDevice->GetTextureData(liveid, slice, mip, params, datasize);
+
+      if(bytes == NULL)
+      {
+        RDCERR("Couldn't get bytes for mip %u, slice %u", mip, slice);
+
+        for(size_t i = 0; i < subdata.size(); i++)
+          delete[] subdata[i];
+
+        return false;
+      }
+
+      if(td.depth == 1)
+      {
+        if(!AddTextureSaveSubresource(job, m, bytes))
+          return false;
+        continue;
+      }
+
+      uint32_t mipSlicePitch = slicePitch;
+
+      uint32_t w = RDCMAX(1U, td.width >> m);
+      uint32_t h = RDCMAX(1U, td.height >> m);
+      uint32_t d = RDCMAX(1U, td.depth >> m);
+
+      if(blockformat)
+      {
+        mipSlicePitch = RDCMAX(1U, ((w + 3) / 4)) * blockSize * RDCMAX(1U, h / 4);
+      }
+      else
+      {
+        mipSlicePitch = w * bytesPerPixel * h;
+      }
+
+      // we don't support slice ranges, only all-or-nothing
+      // we're also not dealing with multisampled slices if
+      // depth > 1. So if we only want one slice out of a 3D texture
+      // then make sure we get it
+      if(numSlices == 1)
+      {
+        byte *depthslice = new byte[mipSlicePitch];
+        byte *b = bytes + mipSlicePitch * sliceOffset;
+        memcpy(depthslice, b, slicePitch);
+
+        delete[] bytes;
+
+        if(!AddTextureSaveSubresource(job, m, depthslice))
+          return false;
+        continue;
+      }
+
+      s += (d - 1);
+
+      byte *b = bytes;
+
+      // add each depth slice as a separate subdata
+      for(uint32_t di = 0; di < d; di++)
+      {
+        byte *depthslice = new byte[mipSlicePitch];
+
+        memcpy(depthslice, b, mipSlicePitch);
+
+        b += mipSlicePitch;
+
+        if(!AddTextureSaveSubresource(job, m, depthslice))
+        {
+          delete[] bytes;
+          return false;
+        }
+      }
+
+      delete[] bytes;
+    }
+  }
+
+  job.rowPitch = rowPitch;
+  job.numMips = numMips;
+  job.numSlices = numSlices;
+
+  return true;
+}
+
+static bool EncodeTextureSave(TextureSaveJob &job)
+{
+  const TextureSave &sd = job.sd;
+  FetchTexture &td = job.td;
+  vector<byte *> &subdata = job.subdata;
+  uint32_t &rowPitch = job.rowPitch;
+  uint32_t numMips = job.numMips;
+  uint32_t numSlices = job.numSlices;
+  const char *path = job.path.c_str();
+
+  bool success = false;
+
+  // should have been handled above, but verify incoming data is RGBA8
+  if(sd.slice.slicesAsGrid && td.format.compByteWidth == 1 && td.format.compCount == 4)
+  {
+    uint32_t sliceWidth = td.width;
+    uint32_t sliceHeight = td.height;
+
+    uint32_t sliceGridHeight = (td.arraysize * td.depth) / sd.slice.sliceGridWidth;
+    if((td.arraysize * td.depth) % sd.slice.sliceGridWidth != 0)
+      sliceGridHeight++;
+
+    td.width *= sd.slice.sliceGridWidth;
+    td.height *= sliceGridHeight;
+
+    byte *combinedData = new byte[td.width * td.height * td.format.compCount];
+
+    memset(combinedData, 0, td.width * td.height * td.format.compCount);
+
+    for(size_t i = 0; i < subdata.size(); i++)
+    {
+      uint32_t gridx = (uint32_t)i % sd.slice.sliceGridWidth;
+      uint32_t gridy = (uint32_t)i / sd.slice.sliceGridWidth;
+
+      uint32_t yoffs = gridy * sliceHeight;
+      uint32_t xoffs = gridx * sliceWidth;
+
+      for(uint32_t y = 0; y < sliceHeight; y++)
+      {
+        for(uint32_t x = 0; x < sliceWidth; x++)
+        {
+          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * 4 + 0];
+          uint32_t *dstpix = (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * 4 + 0];
+
+          *dstpix = *srcpix;
+        }
+      }
+
+      delete[] subdata[i];
+    }
+
+    subdata.resize(1);
+    subdata[0] = combinedData;
+    rowPitch = td.width * 4;
+  }
+
+  // should have been handled above, but verify incoming data is RGBA8 and 6 slices
+  if(sd.slice.cubeCruciform && td.format.compByteWidth == 1 && td.format.compCount == 4 &&
+     subdata.size() == 6)
+  {
+    uint32_t sliceWidth = td.width;
+    uint32_t sliceHeight = td.height;
+
+    td.width *= 4;
+    td.height *= 3;
+
+    byte *combinedData = new byte[td.width * td.height * td.format.compCount];
+
+    memset(combinedData, 0, td.width * td.height * td.format.compCount);
+
+    /*
+     Y X=0   1   2   3
+     =     +---+
+     0     |+y |
+           |[2]|
+       +---+---+---+---+
+     1 |-x |+z |+x |-z |
+       |[1]|[4]|[0]|[5]|
+       +---+---+---+---+
+     2     |-y |
+           |[3]|
+           +---+
+
+    */
+
+    uint32_t gridx[6] = {2, 0, 1, 1, 1, 3};
+    uint32_t gridy[6] = {1, 1, 0, 2, 1, 1};
+
+    for(size_t i = 0; i < subdata.size(); i++)
+    {
+      uint32_t yoffs = gridy[i] * sliceHeight;
+      uint32_t xoffs = gridx[i] * sliceWidth;
+
+      for(uint32_t y = 0; y < sliceHeight; y++)
+      {
+        for(uint32_t x = 0; x < sliceWidth; x++)
+        {
+          uint32_t *srcpix = (uint32_t *)&subdata[i][(y * sliceWidth + x) * 4 + 0];
+          uint32_t *dstpix = (uint32_t *)&combinedData[((y + yoffs) * td.width + x + xoffs) * 4 + 0];
+
+          *dstpix = *srcpix;
+        }
+      }
+
+      delete[] subdata[i];
+    }
+
+    subdata.resize(1);
+    subdata[0] = combinedData;
+    rowPitch = td.width * 4;
+  }
+
+  int numComps = td.format.compCount;
+
+  ExtractTextureChannel(subdata[0], td, sd.channelExtract);
+
+  // handle formats that don't support alpha
+  if(numComps == 4 && (sd.destType == eFileType_BMP || sd.destType == eFileType_JPG))
+  {
+    byte *nonalpha = new byte[td.width * td.height * 3];
+
+    for(uint32_t y = 0; y < td.height; y++)
+    {
+      for(uint32_t x = 0; x < td.width; x++)
+      {
+        byte r = subdata[0][(y * td.width + x) * 4 + 0];
+        byte g = subdata[0][(y * td.width + x) * 4 + 1];
+        byte b = subdata[0][(y * td.width + x) * 4 + 2];
+        byte a = subdata[0][(y * td.width + x) * 4 + 3];
+
+        if(sd.alpha != eAlphaMap_Discard)
+        {
+          FloatVector col = sd.alphaCol;
+          if(sd.alpha == eAlphaMap_BlendToCheckerboard)
+          {
+            bool lightSquare = ((x / 64) % 2) == ((y / 64) % 2);
+            col = lightSquare ? sd.alphaCol : sd.alphaColSecondary;
+          }
+
+          col.x = powf(col.x, 1.0f / 2.2f);
+          col.y = powf(col.y, 1.0f / 2.2f);
+          col.z = powf(col.z, 1.0f / 2.2f);
+
+          FloatVector pixel = FloatVector(float(r) / 255.0f, float(g) / 255.0f, float(b) / 255.0f,
+                                          float(a) / 255.0f);
+
+          pixel.x = pixel.x * pixel.w + col.x * (1.0f - pixel.w);
+          pixel.y = pixel.y * pixel.w + col.y * (1.0f - pixel.w);
+          pixel.z = pixel.z * pixel.w + col.z * (1.0f - pixel.w);
+
+          r = byte(pixel.x * 255.0f);
+          g = byte(pixel.y * 255.0f);
+          b = byte(pixel.z * 255.0f);
+        }
+
+        nonalpha[(y * td.width + x) * 3 + 0] = r;
+        nonalpha[(y * td.width + x) * 3 + 1] = g;
+        nonalpha[(y * td.width + x) * 3 + 2] = b;
+      }
+    }
+
+    delete[] subdata[0];
+
+    subdata[0] = nonalpha;
+
+    numComps = 3;
+    rowPitch = td.width * 3;
+  }
+
+  // assume that (R,G,0) is better mapping than (Y,A) for 2 component data
+  if(numComps == 2 && (sd.destType == eFileType_BMP || sd.destType == eFileType_JPG ||
+                       sd.destType == eFileType_PNG || sd.destType == eFileType_TGA))
+  {
+    byte *rg0 = new byte[td.width * td.height * 3];
+
+    for(uint32_t y = 0; y < td.height; y++)
+    {
+      for(uint32_t x = 0; x < td.width; x++)
+      {
+        byte r = subdata[0][(y * td.width + x) * 2 + 0];
+        byte g = subdata[0][(y * td.width + x) * 2 + 1];
+
+        rg0[(y * td.width + x) * 3 + 0] = r;
+        rg0[(y * td.width + x) * 3 + 1] = g;
+        rg0[(y * td.width + x) * 3 + 2] = 0;
+
+        // if we're greyscaling the image, then keep the greyscale here.
+        if(sd.channelExtract >= 0)
+          rg0[(y * td.width + x) * 3 + 2] = r;
+      }
+    }
+
+    delete[] subdata[0];
+
+    subdata[0] = rg0;
+
+    numComps = 3;
+    rowPitch = td.width * 3;
+  }
+
+  FILE *f = FileIO::fopen(path, "wb");
+
+  if(!f)
+  {
+    success = false;
+  }
+  else
+  {
+    if(sd.destType == eFileType_DDS)
+    {
+      dds_data ddsData;
+
+      ddsData.width = td.width;
+      ddsData.height = td.height;
+      ddsData.depth = td.depth;
+      ddsData.format = td.format;
+      ddsData.mips = numMips;
+      ddsData.slices = numSlices / td.depth;
+      ddsData.subdata = &subdata[0];
+      ddsData.cubemap = td.cubemap && numSlices == 6;
+
+      success = write_dds_to_file(f, ddsData);
+    }
+    else if(sd.destType == eFileType_BMP)
+    {
+      int ret = stbi_write_bmp_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
+                                       subdata[0]);
+      success = (ret != 0);
+    }
+    else if(sd.destType == eFileType_PNG)
+    {
+      // discard alpha if requested
+      for(uint32_t p = 0; sd.alpha == eAlphaMap_Discard && p < td.width * td.height; p++)
+        subdata[0][p * 4 + 3] = 255;
+
+      int ret = stbi_write_png_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
+                                       subdata[0], rowPitch);
+      success = (ret != 0);
+    }
+    else if(sd.destType == eFileType_TGA)
+    {
+      // discard alpha if requested
+      for(uint32_t p = 0; sd.alpha == eAlphaMap_Discard && p < td.width * td.height; p++)
+        subdata[0][p * 4 + 3] = 255;
+
+      int ret = stbi_write_tga_to_func(fileWriteFunc, (void *)f, td.width, td.height, numComps,
+                                       subdata[0]);
+      success = (ret != 0);
+    }
+    else if(sd.destType == eFileType_JPG)
+    {
+      jpge::params p;
+      p.m_quality = sd.jpegQuality;
+
+      int len = td.width * td.height * td.format.compCount;
+      // ensure buffer is at least 1024
+      if(len < 1024)
+        len = 1024;
+
+      char *jpgdst = new char[len];
+
+      success = jpge::compress_image_to_jpeg_file_in_memory(jpgdst, len, td.width, td.height,
+                                                            numComps, subdata[0], p);
+
+      if(success)
+        fwrite(jpgdst, 1, len, f);
+
+      delete[] jpgdst;
+    }
+    else if(sd.destType == eFileType_HDR || sd.destType == eFileType_EXR)
+    {
+      float *fldata = NULL;
+      float *abgr[4] = {NULL, NULL, NULL, NULL};
+
+      if(sd.destType == eFileType_HDR)
+      {
+        fldata = new float[td.width * td.height * 4];
+      }
+      else
+      {
+        abgr[0] = new float[td.width * td.height];
+        abgr[1] = new float[td.width * td.height];
+        abgr[2] = new float[td.width * td.height];
+        abgr[3] = new float[td.width * td.height];
+      }
+
+      byte *srcData = subdata[0];
+
+      ResourceFormat saveFmt = td.format;
+      if(saveFmt.compType == eCompType_None)
+        saveFmt.compType = sd.typeHint;
+      if(saveFmt.compType == eCompType_None)
+        saveFmt.compType = saveFmt.compByteWidth == 4 ? eCompType_Float : eCompType_UNorm;
+
+      std::vector<Vec4f> row(td.width);
+
+      for(uint32_t y = 0; y < td.height; y++)
+      {
+        srcData = DecodeRowToRGBA(saveFmt, srcData, td.width, &row[0]);
+
+        for(uint32_t x = 0; x < td.width; x++)
+        {
+          float r = row[x].x;
+          float g = row[x].y;
+          float b = row[x].z;
+          float a = row[x].w;
+
+          if(saveFmt.bgraOrder)
+            std::swap(r, b);
+
+          // HDR can't represent negative values
+          if(sd.destType == eFileType_HDR)
+          {
+            r = RDCMAX(r, 0.0f);
+            g = RDCMAX(g, 0.0f);
+            b = RDCMAX(b, 0.0f);
+            a = RDCMAX(a, 0.0f);
+          }
+
+          if(sd.channelExtract == 0)
+          {
+            g = b = r;
+            a = 1.0f;
+          }
+          if(sd.channelExtract == 1)
+          {
+            r = b = g;
+            a = 1.0f;
+          }
+          if(sd.channelExtract == 2)
+          {
+            r = g = b;
+            a = 1.0f;
+          }
+          if(sd.channelExtract == 3)
+          {
+            r = g = b = a;
+            a = 1.0f;
+          }
+
+          if(fldata)
+          {
+            fldata[(y * td.width + x) * 4 + 0] = r;
+            fldata[(y * td.width + x) * 4 + 1] = g;
+            fldata[(y * td.width + x) * 4 + 2] = b;
+            fldata[(y * td.width + x) * 4 + 3] = a;
+          }
+          else
+          {
+            abgr[0][(y * td.width + x)] = a;
+            abgr[1][(y * td.width + x)] = b;
+            abgr[2][(y * td.width + x)] = g;
+            abgr[3][(y * td.width + x)] = r;
+          }
+        }
+      }
+
+      if(sd.destType == eFileType_HDR)
+      {
+        int ret = stbi_write_hdr_to_func(fileWriteFunc, (void *)f, td.width, td.height, 4, fldata);
+        success = (ret != 0);
+      }
+      else if(sd.destType == eFileType_EXR)
+      {
+        const char *err = NULL;
+
+        EXRImage exrImage;
+        InitEXRImage(&exrImage);
+
+        int pixTypes[4] = {TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT,
+                           TINYEXR_PIXELTYPE_FLOAT, TINYEXR_PIXELTYPE_FLOAT};
+        int reqTypes[4] = {TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF, TINYEXR_PIXELTYPE_HALF,
+                           TINYEXR_PIXELTYPE_HALF};
+
+        // must be in this order as many viewers don't pay attention to channels and just assume
+        // they are in this order
+        const char *bgraNames[4] = {"A", "B", "G", "R"};
+
+        exrImage.num_channels = 4;
+        exrImage.channel_names = bgraNames;
+        exrImage.images = (unsigned char **)abgr;
+        exrImage.width = td.width;
+        exrImage.height = td.height;
+        exrImage.pixel_types = pixTypes;
+        exrImage.requested_pixel_types = reqTypes;
+
+        unsigned char *mem = NULL;
+
+        size_t ret = SaveMultiChannelEXRToMemory(&exrImage, &mem, &err);
+
+        success = (ret > 0);
+        if(success)
+          FileIO::fwrite(mem, 1, ret, f);
+        else
+          RDCERR("Error saving EXR file %d: '%s'", ret, err);
+
+        free(mem);
+      }
+
+      if(fldata)
+      {
+        delete[] fldata;
+      }
+      else
+      {
+        delete[] abgr[0];
+        delete[] abgr[1];
+        delete[] abgr[2];
+        delete[] abgr[3];
+      }
+    }
+
+    FileIO::fclose(f);
+  }
+
+  for(size_t i = 0; i < subdata.size(); i++)
+    delete[] subdata[i];
+
+  subdata.clear();
+
+  return success;
+}
+
+static void EncodeTextureSaveWorker(void *param)
+{
+  TextureSaveJob *job = (TextureSaveJob *)param;
+  job->success = EncodeTextureSave(*job);
+}
+
+bool ReplayRenderer::StreamTextureSave(const TextureSave &saveData, TextureSaveJob &job)
+{
+  job.stream = FileIO::fopen(job.path.c_str(), "wb");
+
+  if(!job.stream)
+    return false;
+
+  bool success = FetchTextureSave(saveData, job);
+
+  FileIO::fclose(job.stream);
+  job.stream = NULL;
+
+  // don't leave a half-written file behind
+  if(!success)
+    FileIO::Delete(job.path.c_str());
+
+  return success;
+}
+
+bool ReplayRenderer::SaveTexture(const TextureSave &saveData, const char *path)
+{
+  SCOPED_TRACE("ReplayRenderer::SaveTexture");
+
+  TextureSaveJob job;
+  job.path = path;
+
+  // DDS needs no encoding, so it's written as it's read back rather than all held in memory
+  if(saveData.destType == eFileType_DDS)
+    return StreamTextureSave(saveData, job);
+
+  if(!FetchTextureSave(saveData, job))
+    return false;
+
+  return EncodeTextureSave(job);
+}
+
+bool ReplayRenderer::SaveTextures(const rdctype::array<TextureSave> &saves,
+                                  const rdctype::array<rdctype::str> &paths)
+{
+  if(saves.count != paths.count)
+  {
+    RDCERR("Mismatched texture save count %d and path count %d", saves.count, paths.count);
+    return false;
+  }
+
+  vector<TextureSaveJob *> jobs;
+  jobs.resize(saves.count);
+
+  // readback has to stay on this thread, but each texture is encoded and written on a worker
+  // while the next one is being read back.
+  InitialContentsWorkers workers;
+
+  for(int32_t i = 0; i < saves.count; i++)
+  {
+    TextureSaveJob *job = jobs[i] = new TextureSaveJob;
+    job->path = paths[i].elems ? paths[i].elems : "";
+
+    // DDS needs no encoding so it's streamed out here, everything else goes to a worker
+    if(saves[i].destType == eFileType_DDS)
+      job->success = StreamTextureSave(saves[i], *job);
+    else if(FetchTextureSave(saves[i], *job))
+      workers.Queue(&EncodeTextureSaveWorker, job);
+  }
+
+  workers.Finish();
+
+  bool success = true;
+
+  for(size_t i = 0; i < jobs.size(); i++)
+  {
+    if(!jobs[i]->success)
+    {
+      RDCERR("Failed to save texture to '%s'", jobs[i]->path.c_str());
+      success = false;
+    }
+
+    SAFE_DELETE(jobs[i]);
+  }
+
+  return success;
+}
+
+static bool IsWriteUsage(ResourceUsage usage)
+{
+  switch(usage)
+  {
+    case eUsage_VertexBuffer:
+    case eUsage_IndexBuffer:
+    case eUsage_VS_Constants:
+    case eUsage_HS_Constants:
+    case eUsage_DS_Constants:
+    case eUsage_GS_Constants:
+    case eUsage_PS_Constants:
+    case eUsage_CS_Constants:
+    case eUsage_All_Constants:
+    case eUsage_VS_Resource:
+    case eUsage_HS_Resource:
+    case eUsage_DS_Resource:
+    case eUsage_GS_Resource:
+    case eUsage_PS_Resource:
+    case eUsage_CS_Resource:
+    case eUsage_All_Resource:
+    case eUsage_InputTarget:
+    case eUsage_CopySrc:
+    case eUsage_ResolveSrc:
+    case eUsage_Barrier:
+    case eUsage_Indirect:
+      // read-only
+      return false;
+
+    case eUsage_None:
+    case eUsage_SO:
+    case eUsage_VS_RWResource:
+    case eUsage_HS_RWResource:
+    case eUsage_DS_RWResource:
+    case eUsage_GS_RWResource:
+    case eUsage_PS_RWResource:
+    case eUsage_CS_RWResource:
+    case eUsage_All_RWResource:
+    case eUsage_ColourTarget:
+    case eUsage_DepthStencilTarget:
+    case eUsage_Clear:
+    case eUsage_Copy:
+    case eUsage_CopyDst:
+    case eUsage_Resolve:
+    case eUsage_ResolveDst:
+    case eUsage_GenMips:
+      // writing
+      return true;
+  }
+
+  return false;
+}
+
+void ReplayRenderer::BuildUsageIndex()
+{
+  m_UsageIndex.clear();
+
+  // over a proxy this would be a round-trip per resource at load, so leave it to fill in on demand
+  if(m_pDevice->IsRemoteProxy())
+    return;
+
+  vector<ResourceId> ids = m_pDevice->GetTextures();
+  vector<ResourceId> buffers = m_pDevice->GetBuffers();
+  ids.insert(ids.end(), buffers.begin(), buffers.end());
+
+  for(size_t i = 0; i < ids.size(); i++)
+    GetResourceUsage(ids[i]);
+}
+
+const ReplayRenderer::ResourceUsage &ReplayRenderer::GetResourceUsage(ResourceId liveid)
+{
+  auto it = m_UsageIndex.find(liveid);
+  if(it != m_UsageIndex.end())
+    return it->second;
+
+  ResourceUsage &ret = m_UsageIndex[liveid];
+
+  ret.usage = m_pDevice->GetUsage(liveid);
+  std::stable_sort(ret.usage.begin(), ret.usage.end());
+
+  for(size_t i = 0; i < ret.usage.size(); i++)
+  {
+    if(!IsWriteUsage(ret.usage[i].usage))
+      continue;
+
+    if(ret.writes.empty() || ret.writes.back() != ret.usage[i].eventID)
+      ret.writes.push_back(ret.usage[i].eventID);
+  }
+
+  return ret;
+}
+
+uint32_t ReplayRenderer::GetLastWrite(ResourceId liveid, uint32_t eventID)
+{
+  const vector<uint32_t> &writes = GetResourceUsage(liveid).writes;
+
+  auto it = std::upper_bound(writes.begin(), writes.end(), eventID);
+
+  return it == writes.begin() ? 0 : *(it - 1);
+}
+
+uint32_t ReplayRenderer::GetNextWrite(ResourceId liveid, uint32_t eventID)
+{
+  const vector<uint32_t> &writes = GetResourceUsage(liveid).writes;
+
+  auto it = std::upper_bound(writes.begin(), writes.end(), eventID);
+
+  return it == writes.end() ? ~0U : *it;
+}
+
+bool ReplayRenderer::TextureStatsKey::operator<(const TextureStatsKey &o) const
+{
+  if(tex != o.tex)
+    return tex < o.tex;
+  if(lastWrite != o.lastWrite)
+    return lastWrite < o.lastWrite;
+  if(sliceFace != o.sliceFace)
+    return sliceFace < o.sliceFace;
+  if(mip != o.mip)
+    return mip < o.mip;
+  if(sample != o.sample)
+    return sample < o.sample;
+  if(typeHint != o.typeHint)
+    return typeHint < o.typeHint;
+  if(histMin != o.histMin)
+    return histMin < o.histMin;
+  if(histMax != o.histMax)
+    return histMax < o.histMax;
+  return histChannels < o.histChannels;
+}
+
+bool ReplayRenderer::GetTextureStatsKey(ResourceId tex, uint32_t sliceFace, uint32_t mip,
+                                        uint32_t sample, FormatComponentType typeHint,
+                                        TextureStatsKey &key)
+{
+  // only textures from the capture can be cached, anything else (like custom shader output) can
+  // change without being written to by an event.
+  bool found = false;
+  for(size_t t = 0; t < m_Textures.size(); t++)
+  {
+    if(m_Textures[t].ID == tex)
+    {
+      found = true;
+      break;
+    }
+  }
+
+  if(!found)
+    return false;
+
+  RDCEraseEl(key);
+  key.tex = tex;
+  key.sliceFace = sliceFace;
+  key.mip = mip;
+  key.sample = sample;
+  key.typeHint = typeHint;
+
+  // the contents can only differ from a previous fetch if some event has written to the texture
+  // in between, so identify the contents by the last write at or before the current event.
+  key.lastWrite = GetLastWrite(m_pDevice->GetLiveID(tex), m_EventID);
+
+  return true;
+}
+
+bool ReplayRenderer::ResourceDataKey::operator<(const ResourceDataKey &o) const
+{
+  if(id != o.id)
+    return id < o.id;
+  if(eventID != o.eventID)
+    return eventID < o.eventID;
+  if(texture != o.texture)
+    return texture < o.texture;
+  if(a != o.a)
+    return a < o.a;
+  return b < o.b;
+}
+
+bool ReplayRenderer::GetResourceDataKey(ResourceId id, bool texture, uint64_t a, uint64_t b,
+                                        ResourceDataKey &key)
+{
+  // as with texture stats, only resources from the capture can be cached.
+  bool found = false;
+  if(texture)
+  {
+    for(size_t t = 0; t < m_Textures.size() && !found; t++)
+      found = (m_Textures[t].ID == id);
+  }
+  else
+  {
+    for(size_t t = 0; t < m_Buffers.size() && !found; t++)
+      found = (m_Buffers[t].ID == id);
+  }
+
+  if(!found)
+    return false;
+
+  RDCEraseEl(key);
+  key.id = id;
+  key.eventID = m_EventID;
+  key.texture = texture;
+  key.a = a;
+  key.b = b;
+
+  return true;
+}
+
+const vector<byte> *ReplayRenderer::FindResourceData(const ResourceDataKey &key)
+{
+  auto it = m_ResourceDataCache.find(key);
+  if(it == m_ResourceDataCache.end())
+    return NULL;
+
+  // move to the front as the most recently used
+  m_ResourceDataLRU.splice(m_ResourceDataLRU.begin(), m_ResourceDataLRU, it->second.lru);
+
+  return &it->second.data;
+}
+
+void ReplayRenderer::AddResourceData(const ResourceDataKey &key, const byte *data, size_t size)
+{
+  // don't let one huge fetch flush everything else out
+  if(size > MaxResourceDataCacheSize / 4)
+    return;
+
+  if(m_ResourceDataCache.find(key) != m_ResourceDataCache.end())
+    return;
+
+  while(!m_ResourceDataLRU.empty() && m_ResourceDataCacheSize + size > MaxResourceDataCacheSize)
+  {
+    auto it = m_ResourceDataCache.find(m_ResourceDataLRU.back());
+    m_ResourceDataCacheSize -= it->second.data.size();
+    m_ResourceDataCache.erase(it);
+    m_ResourceDataLRU.pop_back();
+  }
+
+  m_ResourceDataLRU.push_front(key);
+
+  ResourceDataEntry &entry = m_ResourceDataCache[key];
+  if(size > 0)
+    entry.data.assign(data, data + size);
+  entry.lru = m_ResourceDataLRU.begin();
+
+  m_ResourceDataCacheSize += size;
+}
+
+void ReplayRenderer::ClearResourceDataCache()
+{
+  m_ResourceDataCache.clear();
+  m_ResourceDataLRU.clear();
+  m_ResourceDataCacheSize = 0;
+}
+
+bool ReplayRenderer::GetTextureMinMax(ResourceId tex, uint32_t sliceFace, uint32_t mip,
+                                      uint32_t sample, FormatComponentType typeHint,
+                                      PixelValue *minval, PixelValue *maxval)
+{
+  TextureStatsKey key;
+  bool cacheable = GetTextureStatsKey(tex, sliceFace, mip, sample, typeHint, key);
+
+  if(cacheable)
+  {
+    auto it = m_MinMaxCache.find(key);
+    if(it != m_MinMaxCache.end())
+    {
+      *minval = it->second.first;
+      *maxval = it->second.second;
+      return true;
+    }
+  }
+
+  bool ret = m_pDevice->GetMinMax(m_pDevice->GetLiveID(tex), sliceFace, mip, sample, typeHint,
+                                  &minval->value_f[0], &maxval->value_f[0]);
+
+  if(ret && cacheable)
+  {
+    if(m_MinMaxCache.size() >= MaxTextureStatsCacheSize)
+      m_MinMaxCache.clear();
+
+    m_MinMaxCache[key] = std::make_pair(*minval, *maxval);
+  }
+
+  return ret;
+}
+
+bool ReplayRenderer::GetTextureHistogram(ResourceId tex, uint32_t sliceFace, uint32_t mip,
+                                         uint32_t sample, FormatComponentType typeHint,
+                                         float minval, float maxval, bool channels[4],
+                                         vector<uint32_t> &histogram)
+{
+  TextureStatsKey key;
+  bool cacheable = GetTextureStatsKey(tex, sliceFace, mip, sample, typeHint, key);
+
+  key.histMin = minval;
+  key.histMax = maxval;
+  key.histChannels = (channels[0] ? 0x1 : 0) | (channels[1] ? 0x2 : 0) | (channels[2] ? 0x4 : 0) |
+                     (channels[3] ? 0x8 : 0);
+
+  if(cacheable)
+  {
+    auto it = m_HistogramCache.find(key);
+    if(it != m_HistogramCache.end())
+    {
+      histogram = it->second;
+      return true;
+    }
+  }
+
+  bool ret = m_pDevice->GetHistogram(m_pDevice->GetLiveID(tex), sliceFace, mip, sample, typeHint,
+                                     minval, maxval, channels, histogram);
+
+  if(ret && cacheable)
+  {
+    if(m_HistogramCache.size() >= MaxTextureStatsCacheSize)
+      m_HistogramCache.clear();
+
+    m_HistogramCache[key] = histogram;
+  }
+
+  return ret;
+}
+
+bool ReplayRenderer::GetPixelHistoryEvents(ResourceId target, uint32_t x, uint32_t y,
+                                           uint32_t &slice, uint32_t &mip, uint32_t &sampleIdx,
+                                           vector<EventUsage> &events)
+{
+  for(size_t t = 0; t < m_Textures.size(); t++)
+  {
+    if(m_Textures[t].ID == target)
+    {
+      if(x >= m_Textures[t].width || y >= m_Textures[t].height)
+      {
+        RDCDEBUG("PixelHistory out of bounds on %llu (%u,%u) vs (%u,%u)", target, x, y,
+                 m_Textures[t].width, m_Textures[t].height);
+        return false;
+      }
+
+      if(m_Textures[t].msSamp == 1)
+        sampleIdx = ~0U;
+
+      slice = RDCCLAMP(slice, 0U, m_Textures[t].arraysize);
+      mip = RDCCLAMP(mip, 0U, m_Textures[t].mips);
+
+      break;
+    }
+  }
+
+  const vector<EventUsage> &usage = GetResourceUsage(m_pDevice->GetLiveID(target)).usage;
+
+  for(size_t i = 0; i < usage.size(); i++)
+  {
+    if(usage[i].eventID > m_EventID)
+      continue;
+
+    // read-only, not a valid pixel history event
+    if(!IsWriteUsage(usage[i].usage))
+      continue;
+
+    events.push_back(usage[i]);
+  }
+
+  if(events.empty())
+  {
+    RDCDEBUG("Target %llu not written to before %u", target, m_EventID);
+    return false;
+  }
+
+  return true;
+}
+
+bool ReplayRenderer::PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice,
+                                  uint32_t mip, uint32_t sampleIdx, FormatComponentType typeHint,
+                                  rdctype::array<PixelModification> *history)
+{
+  SCOPED_TRACE("ReplayRenderer::PixelHistory");
+
+  vector<EventUsage> events;
+
+  if(!GetPixelHistoryEvents(target, x, y, slice, mip, sampleIdx, events))
+  {
+    history->count = 0;
+    history->elems = NULL;
+    return false;
+  }
+
+  RenderDoc::Inst().SetOperationProgress(0.0f);
+
+  *history = m_pDevice->PixelHistory(events, m_pDevice->GetLiveID(target), x, y, slice, mip,
+                                     sampleIdx, typeHint);
+
+  RenderDoc::Inst().SetOperationProgress(1.0f);
+
+  SetFrameEvent(m_EventID, true);
+
+  return true;
+}
+
+bool ReplayRenderer::PixelHistoryBatched(ResourceId target, uint32_t x, uint32_t y,
+                                         uint32_t slice, uint32_t mip, uint32_t sampleIdx,
+                                         FormatComponentType typeHint,
+                                         pPixelHistoryBatchCallback callback, void *userData)
+{
+  SCOPED_TRACE("ReplayRenderer::PixelHistoryBatched");
+
+  vector<EventUsage> events;
+
+  if(callback == NULL || !GetPixelHistoryEvents(target, x, y, slice, mip, sampleIdx, events))
+    return false;
+
+  ResourceId liveID = m_pDevice->GetLiveID(target);
+
+  // each event's values are fetched independently, so the list can be split at any event. Start
+  // small so the most recent modifications show up quickly, then grow the batches to cut down on
+  // the per-call setup.
+  const size_t FirstBatchSize = 8;
+  const size_t MaxBatchSize = 64;
+
+  size_t batchSize = FirstBatchSize;
+  size_t end = events.size();
+
+  while(end > 0)
+  {
+    if(RenderDoc::Inst().IsOperationCancelled())
+      break;
+
+    size_t begin = end > batchSize ? end - batchSize : 0;
+
+    vector<EventUsage> batchEvents(events.begin() + begin, events.begin() + end);
+
+    float numEvents = float(events.size());
+    RenderDoc::Inst().SetOperationProgressRange(float(events.size() - end) / numEvents,
+                                                float(events.size() - begin) / numEvents);
+
+    rdctype::array<PixelModification> batch;
+    batch = m_pDevice->PixelHistory(batchEvents, liveID, x, y, slice, mip, sampleIdx, typeHint);
+
+    callback(userData, &batch);
+
+    end = begin;
+    batchSize = RDCMIN(batchSize * 2, MaxBatchSize);
+  }
+
+  RenderDoc::Inst().SetOperationProgressRange(0.0f, 1.0f);
+  RenderDoc::Inst().SetOperationProgress(1.0f);
+
+  SetFrameEvent(m_EventID, true);
+
+  return true;
+}
+
+bool ReplayRenderer::DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx,
+                                 uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugVertex");
+
+  if(trace == NULL)
+    return false;
+
+  *trace = m_pDevice->DebugVertex(m_EventID, vertid, instid, idx, instOffset, vertOffset);
+
+  SetFrameEvent(m_EventID, true);
+
+  return true;
+}
+
+bool ReplayRenderer::DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
+                                ShaderDebugTrace *trace)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugPixel");
+
+  if(trace == NULL)
+    return false;
+
+  *trace = m_pDevice->DebugPixel(m_EventID, x, y, sample, primitive);
+
+  SetFrameEvent(m_EventID, true);
+
+  return true;
+}
+
+bool ReplayRenderer::DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugThread");
+
+  if(trace == NULL)
+    return false;
+
+  *trace = m_pDevice->DebugThread(m_EventID, groupid, threadid);
+
+  SetFrameEvent(m_EventID, true);
+
+  return true;
+}
+
+uint32_t ReplayRenderer::StartDebugSession(ShaderDebugTrace *fullTrace, ShaderDebugTrace *trace,
+                                           uint32_t *numSteps)
+{
+  if(fullTrace->states.count == 0)
+  {
+    delete fullTrace;
+    return 0;
+  }
+
+  trace->inputs = fullTrace->inputs;
+  trace->cbuffers = fullTrace->cbuffers;
+  trace->states.Delete();
+
+  if(numSteps)
+    *numSteps = (uint32_t)fullTrace->states.count;
+
+  uint32_t session = m_NextDebugSession++;
+  m_DebugSessions[session] = fullTrace;
+  return session;
+}
+
+uint32_t ReplayRenderer::DebugVertexSession(uint32_t vertid, uint32_t instid, uint32_t idx,
+                                            uint32_t instOffset, uint32_t vertOffset,
+                                            ShaderDebugTrace *trace, uint32_t *numSteps)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugVertexSession");
+
+  if(trace == NULL)
+    return 0;
+
+  ShaderDebugTrace *fullTrace = new ShaderDebugTrace;
+  *fullTrace = m_pDevice->DebugVertex(m_EventID, vertid, instid, idx, instOffset, vertOffset);
+
+  SetFrameEvent(m_EventID, true);
+
+  return StartDebugSession(fullTrace, trace, numSteps);
+}
+
+uint32_t ReplayRenderer::DebugPixelSession(uint32_t x, uint32_t y, uint32_t sample,
+                                           uint32_t primitive, ShaderDebugTrace *trace,
+                                           uint32_t *numSteps)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugPixelSession");
+
+  if(trace == NULL)
+    return 0;
+
+  ShaderDebugTrace *fullTrace = new ShaderDebugTrace;
+  *fullTrace = m_pDevice->DebugPixel(m_EventID, x, y, sample, primitive);
+
+  SetFrameEvent(m_EventID, true);
+
+  return StartDebugSession(fullTrace, trace, numSteps);
+}
+
+uint32_t ReplayRenderer::DebugThreadSession(uint32_t groupid[3], uint32_t threadid[3],
+                                            ShaderDebugTrace *trace, uint32_t *numSteps)
+{
+  SCOPED_TRACE("ReplayRenderer::DebugThreadSession");
+
+  if(trace == NULL)
+    return 0;
+
+  ShaderDebugTrace *fullTrace = new ShaderDebugTrace;
+  *fullTrace = m_pDevice->DebugThread(m_EventID, groupid, threadid);
+
+  SetFrameEvent(m_EventID, true);
+
+  return StartDebugSession(fullTrace, trace, numSteps);
+}
+
+bool ReplayRenderer::GetDebugStates(uint32_t session, uint32_t first, uint32_t count,
+                                    rdctype::array<ShaderDebugState> *states)
+{
+  if(states == NULL)
+    return false;
+
+  auto it = m_DebugSessions.find(session);
+  if(it == m_DebugSessions.end())
+  {
+    RDCERR("Invalid shader debug session %u", session);
+    return false;
+  }
+
+  const rdctype::array<ShaderDebugState> &trace = it->second->states;
+
+  uint32_t numSteps = (uint32_t)trace.count;
+  first = RDCMIN(first, numSteps);
+  count = RDCMIN(count, numSteps - first);
+
+  *states = vector<ShaderDebugState>(trace.begin() + first, trace.begin() + first + count);
+
+  return true;
+}
+
+uint32_t ReplayRenderer::FindDebugStep(uint32_t session, uint32_t step, bool32 forward,
+                                       int32_t instruction, uint32_t flags,
+                                       const uint32_t *breakpoints, uint32_t numBreakpoints)
+{
+  auto it = m_DebugSessions.find(session);
+  if(it == m_DebugSessions.end())
+  {
+    RDCERR("Invalid shader debug session %u", session);
+    return step;
+  }
+
+  const rdctype::array<ShaderDebugState> &trace = it->second->states;
+
+  int32_t numSteps = trace.count;
+  int32_t cur = RDCMIN((int32_t)step, numSteps - 1);
+  int32_t inc = forward ? 1 : -1;
+
+  std::set<uint32_t> bps(breakpoints, breakpoints + (breakpoints ? numBreakpoints : 0));
+
+  bool firstStep = true;
+
+  for(;;)
+  {
+    const ShaderDebugState &state = trace[cur];
+
+    if(instruction >= 0 && state.nextInstruction == (uint32_t)instruction)
+      break;
+
+    if(!firstStep && bps.find(state.nextInstruction) != bps.end())
+      break;
+
+    if(cur + inc < 0 || cur + inc >= numSteps)
+      break;
+
+    if(!firstStep && (trace[cur + inc].flags & flags))
+      break;
+
+    firstStep = false;
+
+    cur += inc;
+  }
+
+  return (uint32_t)cur;
+}
+
+void ReplayRenderer::EndDebugSession(uint32_t session)
+{
+  auto it = m_DebugSessions.find(session);
+  if(it == m_DebugSessions.end())
+    return;
+
+  delete it->second;
+  m_DebugSessions.erase(it);
+}
+
+bool ReplayRenderer::GetCBufferVariableContents(ResourceId shader, const char *entryPoint,
+                                                uint32_t cbufslot, ResourceId buffer, uint64_t offs,
+                                                rdctype::array<ShaderVariable> *vars)
+{
+  if(vars == NULL)
+    return false;
+
+  rdctype::array<CBufferContentsRequest> requests;
+  create_array_uninit(requests, 1);
+  requests[0].shader = shader;
+  requests[0].entryPoint = entryPoint ? entryPoint : "";
+  requests[0].slot = cbufslot;
+  requests[0].buffer = buffer;
+  requests[0].offset = offs;
+
+  rdctype::array<rdctype::array<ShaderVariable> > results;
+  GetCBuffersVariableContents(requests, &results);
+
+  if(results.count == 1)
+    *vars = results[0];
+
+  return true;
+}
+
+bool ReplayRenderer::CBufferContentsKey::operator<(const CBufferContentsKey &o) const
+{
+  if(eventID != o.eventID)
+    return eventID < o.eventID;
+  if(shader != o.shader)
+    return shader < o.shader;
+  if(slot != o.slot)
+    return slot < o.slot;
+  if(buffer != o.buffer)
+    return buffer < o.buffer;
+  if(offset != o.offset)
+    return offset < o.offset;
+  return entryPoint < o.entryPoint;
+}
+
+bool ReplayRenderer::GetCBuffersVariableContents(
+    const rdctype::array<CBufferContentsRequest> &requests,
+    rdctype::array<rdctype::array<ShaderVariable> > *vars)
+{
+  if(vars == NULL)
+    return false;
+
+  create_array_uninit(*vars, requests.count);
+
+  vector<CBufferContentsKey> keys(requests.count);
+
+  // the blocks that haven't been filled out at this event yet, and the data for those that are
+  // backed by a buffer
+  vector<int32_t> missing;
+  vector<int32_t> dataIdx;
+  rdctype::array<BufferDataRange> ranges;
+  vector<BufferDataRange> rangeList;
+
+  for(int32_t i = 0; i < requests.count; i++)
+  {
+    const CBufferContentsRequest &req = requests[i];
+
+    CBufferContentsKey &key = keys[i];
+    key.eventID = m_EventID;
+    key.shader = req.shader;
+    key.entryPoint = req.entryPoint.elems ? req.entryPoint.elems : "";
+    key.slot = req.slot;
+    key.buffer = req.buffer;
+    key.offset = req.offset;
+
+    auto it = m_CBufferContentsCache.find(key);
+    if(it != m_CBufferContentsCache.end())
+    {
+      m_CBufferContentsLRU.splice(m_CBufferContentsLRU.begin(), m_CBufferContentsLRU,
+                                  it->second.lru);
+      vars->elems[i] = it->second.vars;
+      continue;
+    }
+
+    missing.push_back(i);
+
+    if(req.buffer != ResourceId())
+    {
+      dataIdx.push_back((int32_t)rangeList.size());
+      rangeList.push_back(BufferDataRange(req.buffer, req.offset, 0));
+    }
+    else
+    {
+      dataIdx.push_back(-1);
+    }
+  }
+
+  if(missing.empty())
+    return true;
+
+  rdctype::array<rdctype::array<byte> > data;
+  if(!rangeList.empty())
+  {
+    ranges = rangeList;
+    GetBuffersData(ranges, &data);
+  }
+
+  for(size_t m = 0; m < missing.size(); m++)
+  {
+    int32_t i = missing[m];
+    const CBufferContentsRequest &req = requests[i];
+
+    vector<byte> bytes;
+    if(dataIdx[m] >= 0 && dataIdx[m] < data.count)
+    {
+      const rdctype::array<byte> &d = data[dataIdx[m]];
+      bytes.assign(d.elems, d.elems + d.count);
+    }
+
+    vector<ShaderVariable> v;
+    m_pDevice->FillCBufferVariables(m_pDevice->GetLiveID(req.shader), keys[i].entryPoint,
+                                    req.slot, v, bytes);
+
+    vars->elems[i] = v;
+
+    // a block bound at several stages only needs to be kept once
+    if(m_CBufferContentsCache.find(keys[i]) != m_CBufferContentsCache.end())
+      continue;
+
+    if(m_CBufferContentsCache.size() >= MaxCBufferContentsCacheSize)
+    {
+      m_CBufferContentsCache.erase(m_CBufferContentsLRU.back());
+      m_CBufferContentsLRU.pop_back();
+    }
+
+    m_CBufferContentsLRU.push_front(keys[i]);
+
+    CBufferContentsEntry &entry = m_CBufferContentsCache[keys[i]];
+    entry.vars = v;
+    entry.lru = m_CBufferContentsLRU.begin();
+  }
+
+  return true;
+}
+
+void ReplayRenderer::GetSupportedWindowSystems(rdctype::array<WindowingSystem> *systems)
+{
+  if(systems)
+    *systems = m_pDevice->GetSupportedWindowSystems();
+}
+
+ReplayOutput *ReplayRenderer::CreateOutput(WindowingSystem system, void *data, OutputType type)
+{
+  ReplayOutput *out = new ReplayOutput(this, system, data, type);
+
+  m_Outputs.push_back(out);
+
+  m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
+
+  out->SetFrameEvent(m_EventID);
+
+  m_pDevice->ReplayLog(m_EventID, eReplay_OnlyDraw);
+
+  return out;
+}
+
+void ReplayRenderer::ShutdownOutput(IReplayOutput *output)
+{
+  RDCUNIMPLEMENTED("Shutting down individual outputs");
+}
+
+void ReplayRenderer::Shutdown()
+{
+  delete this;
+}
+
+// a file produced by ExportOutputs, written out on a worker thread
+struct ExportFileJob
+{
+  string path;
+  byte *data;
+  size_t size;
+  // if non-zero, data is RGBA8 and is written as a PNG of this size. Otherwise it's written raw
+  uint32_t width, height;
+  volatile int32_t *failures;
+};
+
+static void ExportFileWorker(void *param)
+{
+  ExportFileJob *job = (ExportFileJob *)param;
+
+  FILE *f = FileIO::fopen(job->path.c_str(), "wb");
+
+  bool success = false;
+
+  if(f)
+  {
+    if(job->width > 0)
+      success = stbi_write_png_to_func(fileWriteFunc, (void *)f, job->width, job->height, 4,
+                                       job->data, job->width * 4) != 0;
+    else
+      success = FileIO::fwrite(job->data, 1, job->size, f) == job->size;
+
+    FileIO::fclose(f);
+  }
+
+  if(!success)
+  {
+    RDCERR("Couldn't write export file '%s'", job->path.c_str());
+    Atomic::Inc32(job->failures);
+  }
+
+  delete[] job->data;
+  delete job;
+}
+
+static bool IsExportedDraw(const FetchDrawcall &draw)
+{
+  return (draw.flags & (eDraw_Drawcall | eDraw_Dispatch | eDraw_Clear)) != 0;
+}
+
+// the last drawcall inside a marker region, whose outputs are the region's results
+static const FetchDrawcall *LastExportedDraw(const rdctype::array<FetchDrawcall> &draws)
+{
+  for(int32_t i = draws.count - 1; i >= 0; i--)
+  {
+    if(draws[i].children.count > 0)
+    {
+      const FetchDrawcall *ret = LastExportedDraw(draws[i].children);
+      if(ret)
+        return ret;
+    }
+    else if(IsExportedDraw(draws[i]))
+    {
+      return &draws[i];
+    }
   }
 
-  for(size_t i = 0; i < subdata.size(); i++)
-    delete[] subdata[i];
-
-  return success;
+  return NULL;
 }
 
-bool ReplayRenderer::PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice,
-                                  uint32_t mip, uint32_t sampleIdx, FormatComponentType typeHint,
-                                  rdctype::array<PixelModification> *history)
+static void GatherExportDraws(const rdctype::array<FetchDrawcall> &draws, bool markerRegions,
+                              std::map<uint32_t, pair<const FetchDrawcall *, string> > &exports)
 {
-  for(size_t t = 0; t < m_Textures.size(); t++)
+  for(int32_t i = 0; i < draws.count; i++)
   {
-    if(m_Textures[t].ID == target)
+    const FetchDrawcall &d = draws[i];
+
+    if(d.children.count > 0)
     {
-      if(x >= m_Textures[t].width || y >= m_Textures[t].height)
+      GatherExportDraws(d.children, markerRegions, exports);
+
+      if(markerRegions)
       {
-        RDCDEBUG("PixelHistory out of bounds on %llu (%u,%u) vs (%u,%u)", target, x, y,
-                 m_Textures[t].width, m_Textures[t].height);
-        history->count = 0;
-        history->elems = NULL;
-        return false;
+        const FetchDrawcall *last = LastExportedDraw(d.children);
+
+        // nested regions that end on the same drawcall are exported once, under the innermost
+        if(last && exports.find(last->eventID) == exports.end())
+          exports[last->eventID] = std::make_pair(last, string(d.name.elems));
       }
+    }
+    else if(!markerRegions && IsExportedDraw(d))
+    {
+      exports[d.eventID] = std::make_pair(&d, string(d.name.elems));
+    }
+  }
+}
 
-      if(m_Textures[t].msSamp == 1)
-        sampleIdx = ~0U;
+bool ReplayRenderer::ExportOutputs(const char *outdir, bool markerRegions, bool meshes)
+{
+  string dir = outdir;
 
-      slice = RDCCLAMP(slice, 0U, m_Textures[t].arraysize);
-      mip = RDCCLAMP(mip, 0U, m_Textures[t].mips);
+  if(!dir.empty() && dir[dir.size() - 1] != '/' && dir[dir.size() - 1] != '\\')
+    dir += "/";
 
-      break;
-    }
-  }
+  // ordered by event, so the replay only ever moves forward
+  std::map<uint32_t, pair<const FetchDrawcall *, string> > exports;
+  GatherExportDraws(m_FrameRecord.m_DrawCallList, markerRegions, exports);
 
-  auto usage = m_pDevice->GetUsage(m_pDevice->GetLiveID(target));
+  FileIO::CreateParentDirectory(dir + "manifest.json");
 
-  vector<EventUsage> events;
+  InitialContentsWorkers workers;
+  volatile int32_t failures = 0;
 
-  for(size_t i = 0; i < usage.size(); i++)
+  string manifest = "{\n  \"events\": [\n";
+
+  for(auto it = exports.begin(); it != exports.end(); ++it)
   {
-    if(usage[i].eventID > m_EventID)
-      continue;
+    const FetchDrawcall *draw = it->second.first;
+    uint32_t eventID = draw->eventID;
 
-    switch(usage[i].usage)
-    {
-      case eUsage_VertexBuffer:
-      case eUsage_IndexBuffer:
-      case eUsage_VS_Constants:
-      case eUsage_HS_Constants:
-      case eUsage_DS_Constants:
-      case eUsage_GS_Constants:
-      case eUsage_PS_Constants:
-      case eUsage_CS_Constants:
-      case eUsage_All_Constants:
-      case eUsage_VS_Resource:
-      case eUsage_HS_Resource:
-      case eUsage_DS_Resource:
-      case eUsage_GS_Resource:
-      case eUsage_PS_Resource:
-      case eUsage_CS_Resource:
-      case eUsage_All_Resource:
-      case eUsage_InputTarget:
-      case eUsage_CopySrc:
-      case eUsage_ResolveSrc:
-      case eUsage_Barrier:
-      case eUsage_Indirect:
-        // read-only, not a valid pixel history event
-        continue;
+    SetFrameEvent(eventID, false);
 
-      case eUsage_None:
-      case eUsage_SO:
-      case eUsage_VS_RWResource:
-      case eUsage_HS_RWResource:
-      case eUsage_DS_RWResource:
-      case eUsage_GS_RWResource:
-      case eUsage_PS_RWResource:
-      case eUsage_CS_RWResource:
-      case eUsage_All_RWResource:
-      case eUsage_ColourTarget:
-      case eUsage_DepthStencilTarget:
-      case eUsage_Clear:
-      case eUsage_Copy:
-      case eUsage_CopyDst:
-      case eUsage_Resolve:
-      case eUsage_ResolveDst:
-      case eUsage_GenMips:
-        // writing - include in pixel history events
-        break;
-    }
+    string entry = StringFormat::Fmt("    {\"eventID\": %u, \"name\": \"%s\"", eventID,
+                                     jsonescape(it->second.second).c_str());
 
-    events.push_back(usage[i]);
-  }
+    for(int o = 0; o < 9; o++)
+    {
+      ResourceId id = o < 8 ? draw->outputs[o] : draw->depthOut;
 
-  if(events.empty())
-  {
-    RDCDEBUG("Target %llu not written to before %u", target, m_EventID);
-    history->count = 0;
-    history->elems = NULL;
-    return false;
-  }
+      if(id == ResourceId())
+        continue;
 
-  *history = m_pDevice->PixelHistory(events, m_pDevice->GetLiveID(target), x, y, slice, mip,
-                                     sampleIdx, typeHint);
+      ResourceId liveid = m_pDevice->GetLiveID(id);
+      FetchTexture td = m_pDevice->GetTexture(liveid);
 
-  SetFrameEvent(m_EventID, true);
+      GetTextureDataParams params;
+      params.forDiskSave = true;
+      params.resolve = true;
+      params.remap = eRemap_RGBA8;
 
-  return true;
-}
+      size_t size = 0;
+      byte *bytes = m_pDevice->GetTextureData(liveid, 0, 0, params, size);
 
-bool ReplayRenderer::DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx,
-                                 uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace)
-{
-  if(trace == NULL)
-    return false;
+      if(bytes == NULL || size < size_t(td.width) * td.height * 4)
+      {
+        RDCERR("Couldn't get output %llu at event %u for export", id, eventID);
+        SAFE_DELETE_ARRAY(bytes);
+        Atomic::Inc32(&failures);
+        continue;
+      }
 
-  *trace = m_pDevice->DebugVertex(m_EventID, vertid, instid, idx, instOffset, vertOffset);
+      string name = o < 8 ? StringFormat::Fmt("%06u_rt%d.png", eventID, o)
+                          : StringFormat::Fmt("%06u_depth.png", eventID);
 
-  SetFrameEvent(m_EventID, true);
+      entry += StringFormat::Fmt(", \"%s\": \"%s\"",
+                                 o < 8 ? StringFormat::Fmt("rt%d", o).c_str() : "depth",
+                                 name.c_str());
 
-  return true;
-}
+      ExportFileJob *job = new ExportFileJob;
+      job->path = dir + name;
+      job->data = bytes;
+      job->size = size;
+      job->width = td.width;
+      job->height = td.height;
+      job->failures = &failures;
 
-bool ReplayRenderer::DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
-                                ShaderDebugTrace *trace)
-{
-  if(trace == NULL)
-    return false;
+      workers.Queue(&ExportFileWorker, job);
+    }
 
-  *trace = m_pDevice->DebugPixel(m_EventID, x, y, sample, primitive);
+    if(meshes && (draw->flags & eDraw_Drawcall))
+    {
+      m_pDevice->InitPostVSBuffers(eventID);
+      MeshFormat fmt = m_pDevice->GetPostVSBuffers(eventID, 0, eMeshDataStage_VSOut);
 
-  SetFrameEvent(m_EventID, true);
+      vector<byte> vbdata, ibdata;
 
-  return true;
-}
+      if(fmt.buf != ResourceId())
+        m_pDevice->GetBufferData(fmt.buf, fmt.offset, 0, vbdata);
 
-bool ReplayRenderer::DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace)
-{
-  if(trace == NULL)
-    return false;
+      if(fmt.idxbuf != ResourceId())
+        m_pDevice->GetBufferData(fmt.idxbuf, fmt.idxoffs, uint64_t(fmt.numVerts) * fmt.idxByteWidth,
+                                 ibdata);
 
-  *trace = m_pDevice->DebugThread(m_EventID, groupid, threadid);
+      if(!vbdata.empty())
+      {
+        string vbname = StringFormat::Fmt("%06u_vsout.bin", eventID);
 
-  SetFrameEvent(m_EventID, true);
+        entry += StringFormat::Fmt(
+            ", \"vsout\": {\"file\": \"%s\", \"stride\": %u, \"numVerts\": %u, \"topology\": %u",
+            vbname.c_str(), fmt.stride, fmt.numVerts, (uint32_t)fmt.topo);
 
-  return true;
-}
+        ExportFileJob *job = new ExportFileJob;
+        job->path = dir + vbname;
+        job->size = vbdata.size();
+        job->data = new byte[job->size];
+        memcpy(job->data, &vbdata[0], job->size);
+        job->width = job->height = 0;
+        job->failures = &failures;
 
-bool ReplayRenderer::GetCBufferVariableContents(ResourceId shader, const char *entryPoint,
-                                                uint32_t cbufslot, ResourceId buffer, uint64_t offs,
-                                                rdctype::array<ShaderVariable> *vars)
-{
-  if(vars == NULL)
-    return false;
+        workers.Queue(&ExportFileWorker, job);
 
-  vector<byte> data;
-  if(buffer != ResourceId())
-    m_pDevice->GetBufferData(m_pDevice->GetLiveID(buffer), offs, 0, data);
+        if(!ibdata.empty())
+        {
+          string ibname = StringFormat::Fmt("%06u_vsout_idx.bin", eventID);
 
-  vector<ShaderVariable> v;
+          entry += StringFormat::Fmt(", \"indices\": \"%s\", \"indexByteWidth\": %u",
+                                     ibname.c_str(), fmt.idxByteWidth);
 
-  m_pDevice->FillCBufferVariables(m_pDevice->GetLiveID(shader), entryPoint, cbufslot, v, data);
+          job = new ExportFileJob;
+          job->path = dir + ibname;
+          job->size = ibdata.size();
+          job->data = new byte[job->size];
+          memcpy(job->data, &ibdata[0], job->size);
+          job->width = job->height = 0;
+          job->failures = &failures;
 
-  *vars = v;
+          workers.Queue(&ExportFileWorker, job);
+        }
 
-  return true;
-}
+        entry += "}";
+      }
+    }
 
-void ReplayRenderer::GetSupportedWindowSystems(rdctype::array<WindowingSystem> *systems)
-{
-  if(systems)
-    *systems = m_pDevice->GetSupportedWindowSystems();
-}
+    entry += "}";
 
-ReplayOutput *ReplayRenderer::CreateOutput(WindowingSystem system, void *data, OutputType type)
-{
-  ReplayOutput *out = new ReplayOutput(this, system, data, type);
+    manifest += entry;
 
-  m_Outputs.push_back(out);
+    auto next = it;
+    ++next;
+    manifest += next != exports.end() ? ",\n" : "\n";
+  }
 
-  m_pDevice->ReplayLog(m_EventID, eReplay_WithoutDraw);
+  manifest += "  ]\n}\n";
 
-  out->SetFrameEvent(m_EventID);
+  workers.Finish();
 
-  m_pDevice->ReplayLog(m_EventID, eReplay_OnlyDraw);
+  FILE *f = FileIO::fopen((dir + "manifest.json").c_str(), "wb");
 
-  return out;
-}
+  if(!f)
+  {
+    RDCERR("Couldn't write export manifest to '%s'", dir.c_str());
+    return false;
+  }
 
-void ReplayRenderer::ShutdownOutput(IReplayOutput *output)
-{
-  RDCUNIMPLEMENTED("Shutting down individual outputs");
-}
+  FileIO::fwrite(manifest.c_str(), 1, manifest.size(), f);
+  FileIO::fclose(f);
 
-void ReplayRenderer::Shutdown()
-{
-  delete this;
+  return failures == 0;
 }
 
 ResourceId ReplayRenderer::BuildTargetShader(const char *entry, const char *source,
@@ -1493,6 +4262,108 @@ ResourceId ReplayRenderer::BuildCustomShader(const char *entry, const char *sour
   return id;
 }
 
+void ReplayRenderer::ShaderBuildThread(void *param)
+{
+  ShaderBuild *build = (ShaderBuild *)param;
+
+  if(build->target)
+    build->device->PrecompileTargetShader(build->source, build->entry, build->compileFlags,
+                                          build->type);
+  else
+    build->device->PrecompileCustomShader(build->source, build->entry, build->compileFlags,
+                                          build->type);
+
+  Atomic::Inc32(&build->done);
+}
+
+uint32_t ReplayRenderer::StartShaderBuild(bool target, const char *entry, const char *source,
+                                          const uint32_t compileFlags, ShaderStageType type,
+                                          ResourceId replace)
+{
+  ShaderBuild *build = new ShaderBuild();
+  build->device = m_pDevice;
+  build->target = target;
+  build->entry = entry;
+  build->source = source;
+  build->compileFlags = compileFlags;
+  build->type = type;
+  build->replace = replace;
+  build->done = 0;
+
+  uint32_t ticket = m_NextShaderBuild++;
+  m_ShaderBuilds[ticket] = build;
+
+  build->thread = Threading::CreateThread(&ShaderBuildThread, build);
+
+  return ticket;
+}
+
+uint32_t ReplayRenderer::BuildCustomShaderAsync(const char *entry, const char *source,
+                                                const uint32_t compileFlags, ShaderStageType type)
+{
+  return StartShaderBuild(false, entry, source, compileFlags, type, ResourceId());
+}
+
+uint32_t ReplayRenderer::BuildTargetShaderAsync(const char *entry, const char *source,
+                                                const uint32_t compileFlags, ShaderStageType type,
+                                                ResourceId replace)
+{
+  return StartShaderBuild(true, entry, source, compileFlags, type, replace);
+}
+
+bool ReplayRenderer::GetShaderBuildResult(uint32_t ticket, ResourceId *id, rdctype::str *errors)
+{
+  auto it = m_ShaderBuilds.find(ticket);
+
+  if(it == m_ShaderBuilds.end())
+  {
+    RDCERR("Unknown shader build %u", ticket);
+    if(id)
+      *id = ResourceId();
+    return true;
+  }
+
+  ShaderBuild *build = it->second;
+
+  // still compiling
+  if(build->done == 0)
+    return false;
+
+  Threading::JoinThread(build->thread);
+  Threading::CloseThread(build->thread);
+
+  m_ShaderBuilds.erase(it);
+
+  // the compile has already been done, so this only needs to create the shader from the result
+  ResourceId ret;
+
+  if(build->target)
+  {
+    ret = BuildTargetShader(build->entry.c_str(), build->source.c_str(), build->compileFlags,
+                            build->type, errors);
+
+    if(build->replace != ResourceId())
+    {
+      if(ret != ResourceId())
+        ReplaceResource(build->replace, ret);
+      else
+        RemoveReplacement(build->replace);
+    }
+  }
+  else
+  {
+    ret = BuildCustomShader(build->entry.c_str(), build->source.c_str(), build->compileFlags,
+                            build->type, errors);
+  }
+
+  delete build;
+
+  if(id)
+    *id = ret;
+
+  return true;
+}
+
 bool ReplayRenderer::FreeTargetResource(ResourceId id)
 {
   m_TargetResources.erase(id);
@@ -1513,6 +4384,14 @@ bool ReplayRenderer::ReplaceResource(ResourceId from, ResourceId to)
 {
   m_pDevice->ReplaceResource(from, to);
 
+  m_Replacements.insert(from);
+
+  // replacing a resource can change the contents of any resource without a new write
+  m_MinMaxCache.clear();
+  m_HistogramCache.clear();
+  ClearResourceDataCache();
+  ClearPipelineStateCache();
+
   SetFrameEvent(m_EventID, true);
 
   for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -1526,6 +4405,14 @@ bool ReplayRenderer::RemoveReplacement(ResourceId id)
 {
   m_pDevice->RemoveReplacement(id);
 
+  m_Replacements.erase(id);
+
+  // replacing a resource can change the contents of any resource without a new write
+  m_MinMaxCache.clear();
+  m_HistogramCache.clear();
+  ClearResourceDataCache();
+  ClearPipelineStateCache();
+
   SetFrameEvent(m_EventID, true);
 
   for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -1537,6 +4424,8 @@ bool ReplayRenderer::RemoveReplacement(ResourceId id)
 
 ReplayCreateStatus ReplayRenderer::CreateDevice(const char *logfile)
 {
+  SCOPED_TRACE("ReplayRenderer::CreateDevice");
+
   RDCLOG("Creating replay device for %s", logfile);
 
   RDCDriver driverType = RDC_Unknown;
@@ -1554,6 +4443,8 @@ ReplayCreateStatus ReplayRenderer::CreateDevice(const char *logfile)
   IReplayDriver *driver = NULL;
   status = RenderDoc::Inst().CreateReplayDriver(driverType, logfile, &driver);
 
+  m_Logfile = logfile ? logfile : "";
+
   if(driver && status == eReplayCreate_Success)
   {
     RDCLOG("Created replay driver.");
@@ -1582,7 +4473,8 @@ ReplayCreateStatus ReplayRenderer::PostCreateInit(IReplayDriver *device)
 
   m_pDevice->ReadLogInitialisation();
 
-  FetchPipelineState();
+  // not at any particular event yet, so don't keep this in the cache
+  FetchDevicePipelineState();
 
   FetchFrameRecord fr = m_pDevice->GetFrameRecord();
 
@@ -1590,6 +4482,8 @@ ReplayCreateStatus ReplayRenderer::PostCreateInit(IReplayDriver *device)
   m_FrameRecord.m_DrawCallList = fr.drawcallList;
   SetupDrawcallPointers(&m_Drawcalls, m_FrameRecord.m_DrawCallList, NULL, NULL);
 
+  BuildUsageIndex();
+
   return eReplayCreate_Success;
 }
 
@@ -1615,8 +4509,67 @@ bool ReplayRenderer::InitResolver()
 }
 
 void ReplayRenderer::FetchPipelineState()
+{
+  auto it = m_PipelineStateCache.find(m_EventID);
+
+  if(it != m_PipelineStateCache.end())
+  {
+    PipelineStateEntry &entry = it->second;
+
+    m_D3D11PipelineState = entry.d3d11;
+    m_D3D12PipelineState = entry.d3d12;
+    m_GLPipelineState = entry.gl;
+    m_VulkanPipelineState = entry.vulkan;
+
+    m_PipelineStateLRU.splice(m_PipelineStateLRU.begin(), m_PipelineStateLRU, entry.lru);
+
+    m_DevicePipelineStateStale = true;
+    return;
+  }
+
+  FetchDevicePipelineState();
+
+  if(m_PipelineStateCache.size() >= MaxPipelineStateCacheSize)
+  {
+    m_PipelineStateCache.erase(m_PipelineStateLRU.back());
+    m_PipelineStateLRU.pop_back();
+  }
+
+  m_PipelineStateLRU.push_front(m_EventID);
+
+  PipelineStateEntry &entry = m_PipelineStateCache[m_EventID];
+  entry.d3d11 = m_D3D11PipelineState;
+  entry.d3d12 = m_D3D12PipelineState;
+  entry.gl = m_GLPipelineState;
+  entry.vulkan = m_VulkanPipelineState;
+  entry.lru = m_PipelineStateLRU.begin();
+}
+
+void ReplayRenderer::ClearPipelineStateCache()
+{
+  m_PipelineStateCache.clear();
+  m_PipelineStateLRU.clear();
+
+  // constant blocks are decoded with the bound shader's reflection, which a replacement changes
+  m_CBufferContentsCache.clear();
+  m_CBufferContentsLRU.clear();
+}
+
+bool ReplayRenderer::IsRenderOutput(ResourceId id)
+{
+  if(m_DevicePipelineStateStale)
+  {
+    m_pDevice->SavePipelineState();
+    m_DevicePipelineStateStale = false;
+  }
+
+  return m_pDevice->IsRenderOutput(id);
+}
+
+void ReplayRenderer::FetchDevicePipelineState()
 {
   m_pDevice->SavePipelineState();
+  m_DevicePipelineStateStale = false;
 
   m_D3D11PipelineState = m_pDevice->GetD3D11PipelineState();
   m_D3D12PipelineState = m_pDevice->GetD3D12PipelineState();
@@ -1738,6 +4691,21 @@ ReplayRenderer_GetVulkanPipelineState(IReplayRenderer *rend, VulkanPipelineState
   return rend->GetVulkanPipelineState(state);
 }
 
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetVulkanPipelineStatePaged(
+    IReplayRenderer *rend, VulkanPipelineState *state, uint32_t maxArrayElements)
+{
+  return rend->GetVulkanPipelineStatePaged(state, maxArrayElements);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetVulkanDescriptorBindings(
+    IReplayRenderer *rend, ShaderStageType stage, uint32_t set, uint32_t binding, uint32_t first,
+    uint32_t count,
+    rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+        *elements)
+{
+  return rend->GetVulkanDescriptorBindings(stage, set, binding, first, count, elements);
+}
+
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_BuildCustomShader(
     IReplayRenderer *rend, const char *entry, const char *source, const uint32_t compileFlags,
     ShaderStageType type, ResourceId *shaderID, rdctype::str *errors)
@@ -1816,6 +4784,20 @@ ReplayRenderer_GetBuffers(IReplayRenderer *rend, rdctype::array<FetchBuffer> *bu
 {
   return rend->GetBuffers(bufs);
 }
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_QueryTextures(IReplayRenderer *rend, const ResourceQuery &query,
+                             rdctype::array<FetchTexture> *texs, uint32_t *total)
+{
+  return rend->QueryTextures(query, texs, total);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_QueryBuffers(IReplayRenderer *rend, const ResourceQuery &query,
+                            rdctype::array<FetchBuffer> *bufs, uint32_t *total)
+{
+  return rend->QueryBuffers(query, bufs, total);
+}
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_GetResolve(IReplayRenderer *rend, uint64_t *callstack, uint32_t callstackLen,
                           rdctype::array<rdctype::str> *trace)
@@ -1827,6 +4809,31 @@ ReplayRenderer_GetDebugMessages(IReplayRenderer *rend, rdctype::array<DebugMessa
 {
   return rend->GetDebugMessages(msgs);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetProxyStats(IReplayRenderer *rend, rdctype::array<ProxyCommandStats> *stats)
+{
+  return rend->GetProxyStats(stats);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetMemoryStats(IReplayRenderer *rend, rdctype::array<ReplayMemoryStats> *stats)
+{
+  return rend->GetMemoryStats(stats);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetMemoryBudget(
+    IReplayRenderer *rend, ReplayMemoryCategory category, uint64_t bytes)
+{
+  return rend->SetMemoryBudget(category, bytes);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetAPIEventParameters(
+    IReplayRenderer *rend, uint32_t eventID, rdctype::array<APIEventParameter> *params)
+{
+  return rend->GetAPIEventParameters(eventID, params);
+}
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_SetOperationControl(
+    IReplayRenderer *rend, volatile bool32 *cancel, float *progress)
+{
+  rend->SetOperationControl(cancel, progress);
+}
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistory(
     IReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
@@ -1834,6 +4841,14 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistory(
 {
   return rend->PixelHistory(target, x, y, slice, mip, sampleIdx, typeHint, history);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistoryBatched(
+    IReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
+    uint32_t sampleIdx, FormatComponentType typeHint, pPixelHistoryBatchCallback callback,
+    void *userData)
+{
+  return rend->PixelHistoryBatched(target, x, y, slice, mip, sampleIdx, typeHint, callback,
+                                   userData);
+}
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC
 ReplayRenderer_DebugVertex(IReplayRenderer *rend, uint32_t vertid, uint32_t instid, uint32_t idx,
                            uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace)
@@ -1869,12 +4884,25 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetCBufferVariableCo
   return rend->GetCBufferVariableContents(shader, entryPoint, cbufslot, buffer, offs, vars);
 }
 
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetCBuffersVariableContents(
+    IReplayRenderer *rend, const rdctype::array<CBufferContentsRequest> &requests,
+    rdctype::array<rdctype::array<ShaderVariable> > *vars)
+{
+  return rend->GetCBuffersVariableContents(requests, vars);
+}
+
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SaveTexture(IReplayRenderer *rend,
                                                                         const TextureSave &saveData,
                                                                         const char *path)
 {
   return rend->SaveTexture(saveData, path);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_SaveTextures(IReplayRenderer *rend, const rdctype::array<TextureSave> &saves,
+                            const rdctype::array<rdctype::str> &paths)
+{
+  return rend->SaveTextures(saves, paths);
+}
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetPostVSData(IReplayRenderer *rend,
                                                                           uint32_t instID,
@@ -1883,6 +4911,36 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetPostVSData(IRepla
 {
   return rend->GetPostVSData(instID, stage, data);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_PrefetchPostVSData(IReplayRenderer *rend)
+{
+  return rend->PrefetchPostVSData();
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SearchTextureValues(
+    IReplayRenderer *rend, ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+    const ValueSearchParams &params, rdctype::array<ValueSearchMatch> *matches,
+    uint32_t *numMatches)
+{
+  return rend->SearchTextureValues(tex, sliceFace, mip, sample, params, matches, numMatches);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_CompareTextures(
+    IReplayRenderer *rend, const TextureCompareInput &a, const TextureCompareInput &b,
+    float threshold, TextureCompareResult *result)
+{
+  return rend->CompareTextures(a, b, threshold, result);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_CompareTextureWithCapture(
+    IReplayRenderer *rend, const TextureCompareInput &a, IReplayRenderer *other,
+    const TextureCompareInput &b, float threshold, TextureCompareResult *result)
+{
+  return rend->CompareTextureWithCapture(a, other, b, threshold, result);
+}
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SearchPostVSValues(
+    IReplayRenderer *rend, uint32_t instID, MeshDataStage stage, const ValueSearchParams &params,
+    rdctype::array<ValueSearchMatch> *matches, uint32_t *numMatches)
+{
+  return rend->SearchPostVSValues(instID, stage, params, matches, numMatches);
+}
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetBufferData(
     IReplayRenderer *rend, ResourceId buff, uint64_t offset, uint64_t len, rdctype::array<byte> *data)
@@ -1896,3 +4954,17 @@ ReplayRenderer_GetTextureData(IReplayRenderer *rend, ResourceId tex, uint32_t ar
 {
   return rend->GetTextureData(tex, arrayIdx, mip, data);
 }
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetBufferDataInto(IReplayRenderer *rend, ResourceId buff, uint64_t offset,
+                                 uint64_t len, byte *dst, uint64_t dstSize, uint64_t *dataSize)
+{
+  return rend->GetBufferDataInto(buff, offset, len, dst, dstSize, dataSize);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayRenderer_GetTextureDataInto(IReplayRenderer *rend, ResourceId tex, uint32_t arrayIdx,
+                                  uint32_t mip, byte *dst, uint64_t dstSize, uint64_t *dataSize)
+{
+  return rend->GetTextureDataInto(tex, arrayIdx, mip, dst, dstSize, dataSize);
+}
@@ -25,15 +25,19 @@
 
 #pragma once
 
+#include <list>
 #include <set>
 #include <vector>
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
 #include "core/core.h"
 #include "replay/replay_driver.h"
+#include "replay/resource_index.h"
 #include "type_helpers.h"
 
 struct ReplayRenderer;
+struct TextureSaveJob;
+struct DecodedSubresource;
 
 struct ReplayOutput : public IReplayOutput
 {
@@ -45,6 +49,8 @@ public:
   bool ClearThumbnails();
   bool AddThumbnail(WindowingSystem system, void *data, ResourceId texID,
                     FormatComponentType typeHint);
+  bool SetThumbnailAtlas(WindowingSystem system, void *data, uint32_t columns, uint32_t rows);
+  bool SetAtlasThumbnail(uint32_t cell, ResourceId texID, FormatComponentType typeHint);
 
   bool Display();
 
@@ -69,11 +75,14 @@ private:
   void SetFrameEvent(int eventID);
 
   void RefreshOverlay();
+  bool IsOverlayCached();
 
   void DisplayContext();
   void DisplayTex();
+  void DisplayAtlas();
 
   void DisplayMesh();
+  void MergePassMeshes(const vector<MeshFormat> &draws, vector<MeshFormat> &merged);
 
   ReplayRenderer *m_pRenderer;
 
@@ -93,11 +102,19 @@ private:
     bool dirty;
   } m_MainOutput;
 
+  TextureDisplay GetThumbnailDisplay(const OutputPair &thumb);
+
   ResourceId m_OverlayResourceId;
   ResourceId m_CustomShaderResourceId;
 
   std::vector<OutputPair> m_Thumbnails;
 
+  // the atlas window, and one entry per cell. Cells only use the texture/typeHint/depthMode
+  uint32_t m_AtlasColumns;
+  uint32_t m_AtlasRows;
+  OutputPair m_Atlas;
+  std::vector<OutputPair> m_AtlasCells;
+
   float m_ContextX;
   float m_ContextY;
   OutputPair m_PixelContext;
@@ -105,8 +122,21 @@ private:
   uint32_t m_EventID;
   OutputConfig m_Config;
 
+  // camera matrix the mesh output was last rendered with
+  float m_LastCameraMatrix[16];
+
   vector<uint32_t> passEvents;
 
+  // the other draws in the pass, merged into one draw per primitive type for the whole pass mesh
+  // display. The buffers are reused and only grow, sources is what the merge was built from.
+  struct
+  {
+    vector<MeshFormat> sources;
+    vector<MeshFormat> merged;
+    ResourceId vb, ib;
+    uint64_t vbSize, ibSize;
+  } m_PassMesh;
+
   int32_t m_Width;
   int32_t m_Height;
 
@@ -139,10 +169,19 @@ public:
 
   void FetchPipelineState();
 
+  // checks against the pipeline state at the current event, re-saving it in the driver first if
+  // the state was last served from m_PipelineStateCache
+  bool IsRenderOutput(ResourceId id);
+
   bool GetD3D11PipelineState(D3D11PipelineState *state);
   bool GetD3D12PipelineState(D3D12PipelineState *state);
   bool GetGLPipelineState(GLPipelineState *state);
   bool GetVulkanPipelineState(VulkanPipelineState *state);
+  bool GetVulkanPipelineStatePaged(VulkanPipelineState *state, uint32_t maxArrayElements);
+  bool GetVulkanDescriptorBindings(
+      ShaderStageType stage, uint32_t set, uint32_t binding, uint32_t first, uint32_t count,
+      rdctype::array<VulkanPipelineState::Pipeline::DescriptorSet::DescriptorBinding::BindingElement>
+          *elements);
 
   ResourceId BuildCustomShader(const char *entry, const char *source, const uint32_t compileFlags,
                                ShaderStageType type, rdctype::str *errors);
@@ -150,6 +189,14 @@ public:
 
   ResourceId BuildTargetShader(const char *entry, const char *source, const uint32_t compileFlags,
                                ShaderStageType type, rdctype::str *errors);
+
+  uint32_t BuildCustomShaderAsync(const char *entry, const char *source,
+                                  const uint32_t compileFlags, ShaderStageType type);
+  uint32_t BuildTargetShaderAsync(const char *entry, const char *source,
+                                  const uint32_t compileFlags, ShaderStageType type,
+                                  ResourceId replace);
+  bool GetShaderBuildResult(uint32_t ticket, ResourceId *id, rdctype::str *errors);
+
   bool ReplaceResource(ResourceId from, ResourceId to);
   bool RemoveReplacement(ResourceId id);
   bool FreeTargetResource(ResourceId id);
@@ -158,34 +205,80 @@ public:
   bool GetDrawcalls(rdctype::array<FetchDrawcall> *draws);
   bool FetchCounters(uint32_t *counters, uint32_t numCounters,
                      rdctype::array<CounterResult> *results);
+  bool GetCachedCounterResults(uint32_t *counters, uint32_t numCounters,
+                               rdctype::array<CounterResult> *results, bool32 *stale);
   bool EnumerateCounters(rdctype::array<uint32_t> *counters);
   bool DescribeCounter(uint32_t counterID, CounterDescription *desc);
   bool GetTextures(rdctype::array<FetchTexture> *texs);
   bool GetBuffers(rdctype::array<FetchBuffer> *bufs);
+  bool QueryTextures(const ResourceQuery &query, rdctype::array<FetchTexture> *texs,
+                     uint32_t *total);
+  bool QueryBuffers(const ResourceQuery &query, rdctype::array<FetchBuffer> *bufs, uint32_t *total);
   bool GetResolve(uint64_t *callstack, uint32_t callstackLen, rdctype::array<rdctype::str> *trace);
   bool GetDebugMessages(rdctype::array<DebugMessage> *msgs);
+  bool GetProxyStats(rdctype::array<ProxyCommandStats> *stats);
+  bool GetMemoryStats(rdctype::array<ReplayMemoryStats> *stats);
+  bool SetMemoryBudget(ReplayMemoryCategory category, uint64_t bytes);
+  bool GetAPIEventParameters(uint32_t eventID, rdctype::array<APIEventParameter> *params);
+  void SetOperationControl(volatile bool32 *cancel, float *progress);
 
   bool PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
                     uint32_t sampleIdx, FormatComponentType typeHint,
                     rdctype::array<PixelModification> *history);
+  bool PixelHistoryBatched(ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip,
+                           uint32_t sampleIdx, FormatComponentType typeHint,
+                           pPixelHistoryBatchCallback callback, void *userData);
   bool DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset,
                    uint32_t vertOffset, ShaderDebugTrace *trace);
   bool DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
                   ShaderDebugTrace *trace);
   bool DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace);
 
+  uint32_t DebugVertexSession(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset,
+                              uint32_t vertOffset, ShaderDebugTrace *trace, uint32_t *numSteps);
+  uint32_t DebugPixelSession(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive,
+                             ShaderDebugTrace *trace, uint32_t *numSteps);
+  uint32_t DebugThreadSession(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace,
+                              uint32_t *numSteps);
+  bool GetDebugStates(uint32_t session, uint32_t first, uint32_t count,
+                      rdctype::array<ShaderDebugState> *states);
+  uint32_t FindDebugStep(uint32_t session, uint32_t step, bool32 forward, int32_t instruction,
+                         uint32_t flags, const uint32_t *breakpoints, uint32_t numBreakpoints);
+  void EndDebugSession(uint32_t session);
+
   bool GetPostVSData(uint32_t instID, MeshDataStage stage, MeshFormat *data);
+  bool PrefetchPostVSData();
+  bool SearchTextureValues(ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           const ValueSearchParams &params,
+                           rdctype::array<ValueSearchMatch> *matches, uint32_t *numMatches);
+  bool SearchPostVSValues(uint32_t instID, MeshDataStage stage, const ValueSearchParams &params,
+                          rdctype::array<ValueSearchMatch> *matches, uint32_t *numMatches);
+  bool CompareTextures(const TextureCompareInput &a, const TextureCompareInput &b, float threshold,
+                       TextureCompareResult *result);
+  bool CompareTextureWithCapture(const TextureCompareInput &a, IReplayRenderer *other,
+                                 const TextureCompareInput &b, float threshold,
+                                 TextureCompareResult *result);
 
   bool GetUsage(ResourceId id, rdctype::array<EventUsage> *usage);
 
   bool GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, rdctype::array<byte> *data);
+  bool GetBuffersData(const rdctype::array<BufferDataRange> &ranges,
+                      rdctype::array<rdctype::array<byte> > *data);
   bool GetTextureData(ResourceId buff, uint32_t arrayIdx, uint32_t mip, rdctype::array<byte> *data);
+  bool GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dst,
+                         uint64_t dstSize, uint64_t *dataSize);
+  bool GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dst,
+                          uint64_t dstSize, uint64_t *dataSize);
 
   bool SaveTexture(const TextureSave &saveData, const char *path);
+  bool SaveTextures(const rdctype::array<TextureSave> &saves,
+                    const rdctype::array<rdctype::str> &paths);
 
   bool GetCBufferVariableContents(ResourceId shader, const char *entryPoint, uint32_t cbufslot,
                                   ResourceId buffer, uint64_t offs,
                                   rdctype::array<ShaderVariable> *vars);
+  bool GetCBuffersVariableContents(const rdctype::array<CBufferContentsRequest> &requests,
+                                   rdctype::array<rdctype::array<ShaderVariable> > *vars);
 
   void GetSupportedWindowSystems(rdctype::array<WindowingSystem> *systems);
 
@@ -194,10 +287,163 @@ public:
   void ShutdownOutput(IReplayOutput *output);
   void Shutdown();
 
+  // writes the colour and depth outputs of every drawcall - or only at the end of each marker
+  // region - to outdir as PNGs, optionally with the post-VS mesh data, along with a manifest.json
+  // listing them. The GPU work happens on this thread while the encoding and writing to disk is
+  // done on worker threads, so it overlaps replaying the next event.
+  bool ExportOutputs(const char *outdir, bool markerRegions, bool meshes);
+
 private:
   ReplayCreateStatus PostCreateInit(IReplayDriver *device);
 
+  bool GetPixelHistoryEvents(ResourceId target, uint32_t x, uint32_t y, uint32_t &slice,
+                             uint32_t &mip, uint32_t &sampleIdx, vector<EventUsage> &events);
+
+  // read back the subresources for a texture save, ready to be encoded on any thread
+  bool FetchTextureSave(const TextureSave &saveData, TextureSaveJob &job);
+  bool StreamTextureSave(const TextureSave &saveData, TextureSaveJob &job);
+
   FetchDrawcall *GetDrawcallByEID(uint32_t eventID);
+  const FetchAPIEvent *GetAPIEventByEID(uint32_t eventID);
+
+  // replays to the input's event if it isn't the one already replayed, then copies it to the GPU
+  bool SetCompareInput(uint32_t input, const TextureCompareInput &in, uint32_t &replayedEID);
+  // as above, reading the input back for a comparison on the CPU when the driver can't diff it
+  bool ReadCompareInput(const TextureCompareInput &in, uint32_t &replayedEID,
+                        DecodedSubresource &out);
+  bool DiffSubresources(const DecodedSubresource &a, const DecodedSubresource &b, float threshold,
+                        TextureCompareResult &result);
+  ResourceId GetCompareProxy(const FetchTexture &templateTex);
+
+  // textures uploaded from other captures to compare against, and the output of CPU diffs, reused
+  // when the template matches
+  vector<std::pair<FetchTexture, ResourceId> > m_CompareProxies;
+
+  // every resource's usage, fetched once from the driver and sorted by event, along with just the
+  // events that write to it. Keyed by live ID. Built up front on a local replay, and filled in as
+  // resources are queried over a remote proxy.
+  struct ResourceUsage
+  {
+    vector<EventUsage> usage;
+    vector<uint32_t> writes;
+  };
+
+  std::map<ResourceId, ResourceUsage> m_UsageIndex;
+
+  void BuildUsageIndex();
+  const ResourceUsage &GetResourceUsage(ResourceId liveid);
+  // the last event at or before eventID that writes to the resource, or 0 if there isn't one
+  uint32_t GetLastWrite(ResourceId liveid, uint32_t eventID);
+  // the first event after eventID that writes to the resource, or ~0U if there isn't one
+  uint32_t GetNextWrite(ResourceId liveid, uint32_t eventID);
+
+  // min/max and histogram results are cached per texture subresource, and only refetched once the
+  // texture has been written to by a later event.
+  struct TextureStatsKey
+  {
+    ResourceId tex;
+    uint32_t lastWrite;
+    uint32_t sliceFace, mip, sample;
+    FormatComponentType typeHint;
+
+    // only used for histograms
+    float histMin, histMax;
+    uint32_t histChannels;
+
+    bool operator<(const TextureStatsKey &o) const;
+  };
+
+  static const size_t MaxTextureStatsCacheSize = 1024;
+
+  bool GetTextureStatsKey(ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                          FormatComponentType typeHint, TextureStatsKey &key);
+  bool GetTextureMinMax(ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                        FormatComponentType typeHint, PixelValue *minval, PixelValue *maxval);
+  bool GetTextureHistogram(ResourceId tex, uint32_t sliceFace, uint32_t mip, uint32_t sample,
+                           FormatComponentType typeHint, float minval, float maxval,
+                           bool channels[4], vector<uint32_t> &histogram);
+
+  std::map<TextureStatsKey, std::pair<PixelValue, PixelValue> > m_MinMaxCache;
+  std::map<TextureStatsKey, vector<uint32_t> > m_HistogramCache;
+
+  // buffer and texture data fetched at an event is kept, least recently used first out, within a
+  // byte budget. Results are only reused at the same event, since CPU-side updates like maps aren't
+  // in the resource usage on every API.
+  struct ResourceDataKey
+  {
+    ResourceId id;
+    uint32_t eventID;
+    bool texture;
+    // offset and length for buffers, array slice and mip for textures
+    uint64_t a, b;
+
+    bool operator<(const ResourceDataKey &o) const;
+  };
+
+  struct ResourceDataEntry
+  {
+    vector<byte> data;
+    std::list<ResourceDataKey>::iterator lru;
+  };
+
+  static const uint64_t MaxResourceDataCacheSize = 256 * 1024 * 1024;
+
+  bool GetResourceDataKey(ResourceId id, bool texture, uint64_t a, uint64_t b,
+                          ResourceDataKey &key);
+  const vector<byte> *FindResourceData(const ResourceDataKey &key);
+  void AddResourceData(const ResourceDataKey &key, const byte *data, size_t size);
+  void ClearResourceDataCache();
+
+  std::map<ResourceDataKey, ResourceDataEntry> m_ResourceDataCache;
+  // most recently used at the front
+  std::list<ResourceDataKey> m_ResourceDataLRU;
+  uint64_t m_ResourceDataCacheSize;
+
+  // budgets set with SetMemoryBudget, or 0 for none. Applied whenever the event changes.
+  uint64_t m_MemoryBudgets[eReplayMemory_Count];
+  void EnforceMemoryBudgets();
+
+  // counter results fetched so far for each counter, persisted in the capture so they don't need
+  // to be fetched again next time it's opened on the same setup. They're only valid when matching
+  // the identity of the replaying driver and hardware, see GetCounterIdentity.
+  static const uint32_t CounterResultsVersion = 1;
+
+  uint64_t GetCounterIdentity();
+  void LoadCounterResults();
+  void SaveCounterResults();
+
+  string m_Logfile;
+  bool m_CounterResultsLoaded;
+  bool m_CounterResultsDirty;
+  uint64_t m_CounterIdentity;
+  std::map<uint32_t, vector<CounterResult> > m_CounterResults;
+  // counters that had results stored for a different identity, which were discarded
+  std::set<uint32_t> m_StaleCounters;
+
+  // formatted callstack entries, persisted in the capture so symbols only have to be resolved
+  // once per machine. Addresses that didn't resolve to a source location are kept separately and
+  // not persisted, so they're retried next time (e.g. once symbols are available).
+  static const uint32_t ResolvedCallstacksVersion = 1;
+
+  void LoadResolvedCallstacks();
+  void SaveResolvedCallstacks();
+  void ResolveCaptureCallstacks(Callstack::StackResolver *resolv, const uint64_t *callstack,
+                                uint32_t callstackLen);
+
+  bool m_ResolvedCallstacksLoaded;
+  bool m_ResolvedCallstacksDirty;
+  std::map<uint64_t, string> m_ResolvedAddrs;
+  std::map<uint64_t, string> m_UnresolvedAddrs;
+
+  // resources currently replaced, while there are any counter results don't reflect the capture
+  std::set<ResourceId> m_Replacements;
+
+  // how many draws around the current event PrefetchPostVSData covers. The drivers keep post-VS
+  // data for the lifetime of the replay, so this bounds how much one prefetch can add.
+  static const size_t MaxPostVSPrefetch = 32;
+
+  // events whose post-VS data has already been prefetched, so they aren't replayed to again
+  std::set<uint32_t> m_PostVSPrefetched;
 
   IReplayDriver *GetDevice() { return m_pDevice; }
   struct FrameRecord
@@ -211,20 +457,116 @@ private:
 
   uint32_t m_EventID;
 
+  // the overlay the driver last rendered. Drivers only keep one overlay texture between all
+  // outputs, so this lets an output re-use it when the same overlay is asked for again - e.g.
+  // toggling an overlay off and back on - instead of replaying to render it again. Reset whenever
+  // the replay moves or is forced to refresh.
+  struct OverlayKey
+  {
+    uint32_t eventID;
+    ResourceId texid;
+    FormatComponentType typeHint;
+    TextureDisplayOverlay overlay;
+    ResourceId result;
+  } m_LastOverlay;
+
   D3D11PipelineState m_D3D11PipelineState;
   D3D12PipelineState m_D3D12PipelineState;
   GLPipelineState m_GLPipelineState;
   VulkanPipelineState m_VulkanPipelineState;
 
+  // the capture doesn't change, so the pipeline state at an event is kept and reused when the
+  // replay comes back to it, least recently used first out. This saves rebuilding every stage's
+  // bindings and descriptors, and the shader reflection, on each event change. Cleared when a
+  // resource replacement could change what's bound.
+  struct PipelineStateEntry
+  {
+    D3D11PipelineState d3d11;
+    D3D12PipelineState d3d12;
+    GLPipelineState gl;
+    VulkanPipelineState vulkan;
+    std::list<uint32_t>::iterator lru;
+  };
+
+  static const size_t MaxPipelineStateCacheSize = 16;
+
+  void FetchDevicePipelineState();
+  void ClearPipelineStateCache();
+
+  std::map<uint32_t, PipelineStateEntry> m_PipelineStateCache;
+  // most recently used at the front
+  std::list<uint32_t> m_PipelineStateLRU;
+
+  // constant blocks filled out at an event, least recently used first out. Like the resource data
+  // cache these are only reused at the same event - CPU-side updates to constant buffers such as
+  // maps aren't in the resource usage on every API, so a block can change between two events
+  // without any event writing to its buffer. Cleared along with the pipeline state cache.
+  struct CBufferContentsKey
+  {
+    uint32_t eventID;
+    ResourceId shader;
+    string entryPoint;
+    uint32_t slot;
+    ResourceId buffer;
+    uint64_t offset;
+
+    bool operator<(const CBufferContentsKey &o) const;
+  };
+
+  struct CBufferContentsEntry
+  {
+    vector<ShaderVariable> vars;
+    std::list<CBufferContentsKey>::iterator lru;
+  };
+
+  static const size_t MaxCBufferContentsCacheSize = 256;
+
+  std::map<CBufferContentsKey, CBufferContentsEntry> m_CBufferContentsCache;
+  // most recently used at the front
+  std::list<CBufferContentsKey> m_CBufferContentsLRU;
+  // true when the driver's own saved state (used by IsRenderOutput) wasn't updated for this event
+  bool m_DevicePipelineStateStale;
+
   std::vector<ReplayOutput *> m_Outputs;
 
   std::vector<FetchBuffer> m_Buffers;
   std::vector<FetchTexture> m_Textures;
 
+  // answers queries against m_Textures and m_Buffers on a local replay
+  ResourceIndex m_ResourceIndex;
+
   IReplayDriver *m_pDevice;
 
   std::set<ResourceId> m_TargetResources;
   std::set<ResourceId> m_CustomShaders;
 
+  // a shader being compiled on a worker thread for BuildCustomShaderAsync/BuildTargetShaderAsync
+  struct ShaderBuild
+  {
+    IReplayDriver *device;
+    bool target;
+    string entry;
+    string source;
+    uint32_t compileFlags;
+    ShaderStageType type;
+    ResourceId replace;
+
+    Threading::ThreadHandle thread;
+    volatile int32_t done;
+  };
+
+  static void ShaderBuildThread(void *param);
+  uint32_t StartShaderBuild(bool target, const char *entry, const char *source,
+                            const uint32_t compileFlags, ShaderStageType type, ResourceId replace);
+
+  std::map<uint32_t, ShaderBuild *> m_ShaderBuilds;
+  uint32_t m_NextShaderBuild;
+
+  uint32_t StartDebugSession(ShaderDebugTrace *fullTrace, ShaderDebugTrace *trace,
+                             uint32_t *numSteps);
+
+  std::map<uint32_t, ShaderDebugTrace *> m_DebugSessions;
+  uint32_t m_NextDebugSession;
+
   friend struct ReplayOutput;
 };
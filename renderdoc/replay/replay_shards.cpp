@@ -0,0 +1,520 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <algorithm>
+#include "api/replay/renderdoc_replay.h"
+#include "common/common.h"
+#include "os/os_specific.h"
+
+// runs entry once for each job, each on its own thread, and waits for them all to finish
+template <typename Job>
+static void RunShardJobs(Threading::ThreadEntry entry, vector<Job> &jobs)
+{
+  vector<Threading::ThreadHandle> threads;
+  threads.reserve(jobs.size());
+
+  for(size_t i = 0; i < jobs.size(); i++)
+    threads.push_back(Threading::CreateThread(entry, &jobs[i]));
+
+  for(size_t i = 0; i < threads.size(); i++)
+  {
+    Threading::JoinThread(threads[i]);
+    Threading::CloseThread(threads[i]);
+  }
+}
+
+struct ShardOpenJob
+{
+  IRemoteServer *server;
+  const char *logfile;
+  float copyProgress;
+  float openProgress;
+  volatile int32_t done;
+
+  ReplayCreateStatus status;
+  IReplayRenderer *rend;
+};
+
+static void OpenShardThread(void *data)
+{
+  ShardOpenJob *job = (ShardOpenJob *)data;
+
+  // the server deletes its copy of the capture once the connection closes
+  rdctype::str remotePath = job->server->CopyCaptureToRemote(job->logfile, &job->copyProgress);
+
+  if(remotePath.count == 0)
+    job->status = eReplayCreate_NetworkIOFailed;
+  else
+    job->status = job->server->OpenCapture(~0U, remotePath.elems, &job->openProgress, &job->rend);
+
+  Atomic::Inc32(&job->done);
+}
+
+struct EventShardJob
+{
+  IReplayRenderer *rend;
+  uint32_t eventID;
+  bool success;
+};
+
+static void SetFrameEventThread(void *data)
+{
+  EventShardJob *job = (EventShardJob *)data;
+
+  job->success = job->rend->SetFrameEvent(job->eventID, false);
+}
+
+struct CounterShardJob
+{
+  IReplayRenderer *rend;
+  vector<uint32_t> counters;
+  rdctype::array<CounterResult> results;
+  bool success;
+};
+
+static void FetchCountersThread(void *data)
+{
+  CounterShardJob *job = (CounterShardJob *)data;
+
+  job->success = job->rend->FetchCounters(&job->counters[0], (uint32_t)job->counters.size(),
+                                          &job->results);
+}
+
+// orders results by event, then by where the counter was in the original request
+struct CounterResultOrder
+{
+  CounterResultOrder(const map<uint32_t, size_t> &order) : counterOrder(order) {}
+  bool operator()(const CounterResult &a, const CounterResult &b) const
+  {
+    if(a.eventID != b.eventID)
+      return a.eventID < b.eventID;
+
+    return counterOrder.find(a.counterID)->second < counterOrder.find(b.counterID)->second;
+  }
+
+  const map<uint32_t, size_t> &counterOrder;
+};
+
+struct TextureSaveShardJob
+{
+  IReplayRenderer *rend;
+  // the event to go back to afterwards, or ~0U to stay at the last event saved
+  uint32_t restoreEventID;
+
+  // sorted by event
+  vector<uint32_t> eventIDs;
+  vector<TextureSave> saves;
+  vector<rdctype::str> paths;
+
+  bool success;
+};
+
+static void SaveTexturesThread(void *data)
+{
+  TextureSaveShardJob *job = (TextureSaveShardJob *)data;
+
+  job->success = true;
+
+  size_t i = 0;
+  while(i < job->eventIDs.size())
+  {
+    // batch up all the saves at this event so they're read back and encoded together
+    size_t end = i;
+    while(end < job->eventIDs.size() && job->eventIDs[end] == job->eventIDs[i])
+      end++;
+
+    vector<TextureSave> saves(job->saves.begin() + i, job->saves.begin() + end);
+    vector<rdctype::str> paths(job->paths.begin() + i, job->paths.begin() + end);
+
+    job->rend->SetFrameEvent(job->eventIDs[i], false);
+
+    if(!job->rend->SaveTextures(saves, paths))
+      job->success = false;
+
+    i = end;
+  }
+
+  if(job->restoreEventID != ~0U)
+    job->rend->SetFrameEvent(job->restoreEventID, false);
+}
+
+struct EventIDOrder
+{
+  EventIDOrder(const rdctype::array<uint32_t> &ids) : eventIDs(ids) {}
+  bool operator()(int32_t a, int32_t b) const { return eventIDs[a] < eventIDs[b]; }
+  const rdctype::array<uint32_t> &eventIDs;
+};
+
+struct PixelHistoryShardJob
+{
+  IReplayRenderer *rend;
+  const rdctype::array<PixelHistoryQuery> *queries;
+  rdctype::array<rdctype::array<PixelModification> > *history;
+
+  // shared between the jobs, the next query to take
+  volatile int32_t *next;
+
+  bool success;
+};
+
+static void PixelHistoryThread(void *data)
+{
+  PixelHistoryShardJob *job = (PixelHistoryShardJob *)data;
+
+  job->success = true;
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(job->next) - 1;
+
+    if(idx >= job->queries->count)
+      break;
+
+    const PixelHistoryQuery &q = (*job->queries)[idx];
+
+    if(!job->rend->PixelHistory(q.target, q.x, q.y, q.slice, q.mip, q.sampleIdx, q.typeHint,
+                                &(*job->history)[idx]))
+      job->success = false;
+  }
+}
+
+struct ReplayShardSet : public IReplayShardSet
+{
+public:
+  ReplayShardSet() : m_EventID(~0U) {}
+  void AddShard(IRemoteServer *server, IReplayRenderer *rend)
+  {
+    m_Servers.push_back(server);
+    m_Shards.push_back(rend);
+  }
+
+  uint32_t GetShardCount() { return (uint32_t)m_Shards.size(); }
+  IReplayRenderer *GetShard(uint32_t idx)
+  {
+    if(idx >= m_Shards.size())
+      return NULL;
+
+    return m_Shards[idx];
+  }
+
+  bool SetFrameEvent(uint32_t eventID)
+  {
+    m_EventID = eventID;
+
+    vector<EventShardJob> jobs(m_Shards.size());
+    for(size_t i = 0; i < m_Shards.size(); i++)
+    {
+      jobs[i].rend = m_Shards[i];
+      jobs[i].eventID = eventID;
+      jobs[i].success = false;
+    }
+
+    RunShardJobs(&SetFrameEventThread, jobs);
+
+    bool success = true;
+    for(size_t i = 0; i < jobs.size(); i++)
+      success &= jobs[i].success;
+
+    return success;
+  }
+
+  bool FetchCounters(uint32_t *counters, uint32_t numCounters,
+                     rdctype::array<CounterResult> *results)
+  {
+    if(results == NULL)
+      return false;
+
+    results->Delete();
+
+    if(counters == NULL || numCounters == 0)
+      return true;
+
+    // deal the counters out round-robin, and don't bother with shards that wouldn't get any
+    vector<CounterShardJob> jobs(RDCMIN((size_t)numCounters, m_Shards.size()));
+    for(size_t i = 0; i < jobs.size(); i++)
+    {
+      jobs[i].rend = m_Shards[i];
+      jobs[i].success = false;
+    }
+
+    map<uint32_t, size_t> counterOrder;
+    for(uint32_t i = 0; i < numCounters; i++)
+    {
+      jobs[i % jobs.size()].counters.push_back(counters[i]);
+      counterOrder[counters[i]] = i;
+    }
+
+    RunShardJobs(&FetchCountersThread, jobs);
+
+    bool success = true;
+    vector<CounterResult> merged;
+
+    for(size_t i = 0; i < jobs.size(); i++)
+    {
+      if(!jobs[i].success)
+      {
+        RDCERR("Shard %u failed to fetch counters", (uint32_t)i);
+        success = false;
+      }
+
+      merged.insert(merged.end(), jobs[i].results.elems,
+                    jobs[i].results.elems + jobs[i].results.count);
+    }
+
+    std::stable_sort(merged.begin(), merged.end(), CounterResultOrder(counterOrder));
+
+    *results = merged;
+
+    return success;
+  }
+
+  bool SaveTextures(const rdctype::array<uint32_t> &eventIDs,
+                    const rdctype::array<TextureSave> &saves,
+                    const rdctype::array<rdctype::str> &paths)
+  {
+    if(eventIDs.count != saves.count || saves.count != paths.count)
+    {
+      RDCERR("Mismatched event count %d, texture save count %d and path count %d", eventIDs.count,
+             saves.count, paths.count);
+      return false;
+    }
+
+    if(saves.count == 0)
+      return true;
+
+    vector<int32_t> sorted;
+    sorted.reserve(saves.count);
+    for(int32_t i = 0; i < saves.count; i++)
+      sorted.push_back(i);
+
+    std::stable_sort(sorted.begin(), sorted.end(), EventIDOrder(eventIDs));
+
+    // split into contiguous ranges of even size, so each shard only replays forwards
+    size_t numJobs = RDCMIN((size_t)saves.count, m_Shards.size());
+    size_t perJob = (sorted.size() + numJobs - 1) / numJobs;
+
+    vector<TextureSaveShardJob> jobs(numJobs);
+    for(size_t i = 0; i < sorted.size(); i++)
+    {
+      TextureSaveShardJob &job = jobs[i / perJob];
+      int32_t idx = sorted[i];
+
+      job.eventIDs.push_back(eventIDs[idx]);
+      job.saves.push_back(saves[idx]);
+      job.paths.push_back(paths[idx]);
+    }
+
+    for(size_t i = 0; i < jobs.size(); i++)
+    {
+      jobs[i].rend = m_Shards[i];
+      jobs[i].restoreEventID = m_EventID;
+      jobs[i].success = false;
+    }
+
+    RunShardJobs(&SaveTexturesThread, jobs);
+
+    bool success = true;
+    for(size_t i = 0; i < jobs.size(); i++)
+      success &= jobs[i].success;
+
+    return success;
+  }
+
+  bool PixelHistory(const rdctype::array<PixelHistoryQuery> &queries,
+                    rdctype::array<rdctype::array<PixelModification> > *history)
+  {
+    if(history == NULL)
+      return false;
+
+    // allocate every result up front so the shards can fill them in place
+    *history = vector<rdctype::array<PixelModification> >(queries.count);
+
+    if(queries.count == 0)
+      return true;
+
+    volatile int32_t next = 0;
+
+    vector<PixelHistoryShardJob> jobs(RDCMIN((size_t)queries.count, m_Shards.size()));
+    for(size_t i = 0; i < jobs.size(); i++)
+    {
+      jobs[i].rend = m_Shards[i];
+      jobs[i].queries = &queries;
+      jobs[i].history = history;
+      jobs[i].next = &next;
+      jobs[i].success = false;
+    }
+
+    RunShardJobs(&PixelHistoryThread, jobs);
+
+    bool success = true;
+    for(size_t i = 0; i < jobs.size(); i++)
+      success &= jobs[i].success;
+
+    return success;
+  }
+
+  void Shutdown()
+  {
+    for(size_t i = 0; i < m_Shards.size(); i++)
+      m_Servers[i]->CloseCapture(m_Shards[i]);
+
+    delete this;
+  }
+
+private:
+  virtual ~ReplayShardSet() {}
+  vector<IRemoteServer *> m_Servers;
+  vector<IReplayRenderer *> m_Shards;
+
+  uint32_t m_EventID;
+};
+
+extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC
+RENDERDOC_OpenShardedReplay(IRemoteServer **servers, uint32_t numServers, const char *logfile,
+                            float *progress, IReplayShardSet **set)
+{
+  if(set == NULL || servers == NULL || numServers == 0 || logfile == NULL)
+    return eReplayCreate_InternalError;
+
+  float dummy = 0.0f;
+  if(progress == NULL)
+    progress = &dummy;
+
+  vector<ShardOpenJob> jobs(numServers);
+  vector<Threading::ThreadHandle> threads;
+
+  for(uint32_t i = 0; i < numServers; i++)
+  {
+    jobs[i].server = servers[i];
+    jobs[i].logfile = logfile;
+    jobs[i].copyProgress = 0.0f;
+    jobs[i].openProgress = 0.0f;
+    jobs[i].done = 0;
+    jobs[i].status = eReplayCreate_InternalError;
+    jobs[i].rend = NULL;
+
+    threads.push_back(Threading::CreateThread(&OpenShardThread, &jobs[i]));
+  }
+
+  // copying and opening each count for half of a shard's progress
+  for(;;)
+  {
+    bool done = true;
+    float total = 0.0f;
+
+    for(uint32_t i = 0; i < numServers; i++)
+    {
+      done &= (jobs[i].done != 0);
+      total += (jobs[i].copyProgress + jobs[i].openProgress) * 0.5f;
+    }
+
+    *progress = total / float(numServers);
+
+    if(done)
+      break;
+
+    Threading::Sleep(50);
+  }
+
+  for(size_t i = 0; i < threads.size(); i++)
+  {
+    Threading::JoinThread(threads[i]);
+    Threading::CloseThread(threads[i]);
+  }
+
+  ReplayCreateStatus status = eReplayCreate_Success;
+
+  for(uint32_t i = 0; i < numServers; i++)
+  {
+    if(jobs[i].status != eReplayCreate_Success)
+    {
+      RDCERR("Couldn't open '%s' on shard %u: %d", logfile, i, jobs[i].status);
+      status = jobs[i].status;
+    }
+  }
+
+  if(status != eReplayCreate_Success)
+  {
+    for(uint32_t i = 0; i < numServers; i++)
+      if(jobs[i].rend)
+        servers[i]->CloseCapture(jobs[i].rend);
+
+    return status;
+  }
+
+  ReplayShardSet *ret = new ReplayShardSet();
+
+  for(uint32_t i = 0; i < numServers; i++)
+    ret->AddShard(servers[i], jobs[i].rend);
+
+  RDCLOG("Opened '%s' on %u shards", logfile, numServers);
+
+  *set = ret;
+  *progress = 1.0f;
+
+  return eReplayCreate_Success;
+}
+
+extern "C" RENDERDOC_API uint32_t RENDERDOC_CC ReplayShardSet_GetShardCount(IReplayShardSet *set)
+{
+  return set->GetShardCount();
+}
+
+extern "C" RENDERDOC_API IReplayRenderer *RENDERDOC_CC ReplayShardSet_GetShard(IReplayShardSet *set,
+                                                                              uint32_t idx)
+{
+  return set->GetShard(idx);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayShardSet_SetFrameEvent(IReplayShardSet *set,
+                                                                         uint32_t eventID)
+{
+  return set->SetFrameEvent(eventID);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayShardSet_FetchCounters(IReplayShardSet *set, uint32_t *counters, uint32_t numCounters,
+                             rdctype::array<CounterResult> *results)
+{
+  return set->FetchCounters(counters, numCounters, results);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayShardSet_SaveTextures(
+    IReplayShardSet *set, const rdctype::array<uint32_t> &eventIDs,
+    const rdctype::array<TextureSave> &saves, const rdctype::array<rdctype::str> &paths)
+{
+  return set->SaveTextures(eventIDs, saves, paths);
+}
+
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC
+ReplayShardSet_PixelHistory(IReplayShardSet *set, const rdctype::array<PixelHistoryQuery> &queries,
+                            rdctype::array<rdctype::array<PixelModification> > *history)
+{
+  return set->PixelHistory(queries, history);
+}
+
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayShardSet_Shutdown(IReplayShardSet *set)
+{
+  set->Shutdown();
+}
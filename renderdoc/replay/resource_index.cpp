@@ -0,0 +1,131 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "resource_index.h"
+#include <algorithm>
+#include "serialise/string_utils.h"
+
+static bool SameFilter(const ResourceQuery &a, const ResourceQuery &b)
+{
+  return a.resType == b.resType && a.creationFlags == b.creationFlags &&
+         a.firstEvent == b.firstEvent && a.lastEvent == b.lastEvent &&
+         strcmp(a.name.c_str(), b.name.c_str()) == 0;
+}
+
+static bool MatchesType(const FetchTexture &tex, const ResourceQuery &query)
+{
+  return query.resType == eResType_None || tex.resType == query.resType;
+}
+
+static bool MatchesType(const FetchBuffer &buf, const ResourceQuery &query)
+{
+  return true;
+}
+
+static bool UsedInRange(const vector<EventUsage> &usage, uint32_t firstEvent, uint32_t lastEvent)
+{
+  auto it = std::lower_bound(usage.begin(), usage.end(), firstEvent,
+                             [](const EventUsage &u, uint32_t eid) { return u.eventID < eid; });
+
+  return it != usage.end() && it->eventID <= lastEvent;
+}
+
+void ResourceIndex::Clear()
+{
+  m_TextureNames.clear();
+  m_BufferNames.clear();
+  m_TextureMatches = Matches();
+  m_BufferMatches = Matches();
+}
+
+template <typename ResourceType>
+const vector<uint32_t> &ResourceIndex::Match(const vector<ResourceType> &resources,
+                                             vector<string> &names, Matches &matches,
+                                             const ResourceQuery &query, UsageLookup usage)
+{
+  if(matches.valid && SameFilter(matches.query, query) && names.size() == resources.size())
+    return matches.indices;
+
+  if(names.size() != resources.size())
+  {
+    names.resize(resources.size());
+    for(size_t i = 0; i < resources.size(); i++)
+      names[i] = strlower(string(resources[i].name.c_str()));
+  }
+
+  string needle = strlower(string(query.name.c_str()));
+
+  matches.valid = true;
+  matches.query = query;
+  matches.indices.clear();
+
+  for(size_t i = 0; i < resources.size(); i++)
+  {
+    const ResourceType &res = resources[i];
+
+    if(!MatchesType(res, query))
+      continue;
+
+    if((res.creationFlags & query.creationFlags) != query.creationFlags)
+      continue;
+
+    if(!needle.empty() && names[i].find(needle) == string::npos)
+      continue;
+
+    // the usage check is last, as it may have to fetch the usage
+    if(query.lastEvent > 0 && !UsedInRange(usage(res.ID), query.firstEvent, query.lastEvent))
+      continue;
+
+    matches.indices.push_back((uint32_t)i);
+  }
+
+  return matches.indices;
+}
+
+uint32_t ResourceIndex::QueryTextures(const vector<FetchTexture> &texs, const ResourceQuery &query,
+                                      UsageLookup usage, vector<FetchTexture> &page)
+{
+  const vector<uint32_t> &indices = Match(texs, m_TextureNames, m_TextureMatches, query, usage);
+
+  page.clear();
+
+  for(uint32_t i = query.first; i < (uint32_t)indices.size() && i - query.first < query.count; i++)
+    page.push_back(texs[indices[i]]);
+
+  return (uint32_t)indices.size();
+}
+
+uint32_t ResourceIndex::QueryBuffers(const vector<FetchBuffer> &bufs, const ResourceQuery &query,
+                                     UsageLookup usage, vector<FetchBuffer> &page)
+{
+  const vector<uint32_t> &indices = Match(bufs, m_BufferNames, m_BufferMatches, query, usage);
+
+  page.clear();
+
+  for(uint32_t i = query.first; i < (uint32_t)indices.size() && i - query.first < query.count; i++)
+    page.push_back(bufs[indices[i]]);
+
+  return (uint32_t)indices.size();
+}
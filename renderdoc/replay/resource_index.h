@@ -0,0 +1,69 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include "api/replay/renderdoc_replay.h"
+#include "common/common.h"
+
+// answers ResourceQuery pages from a list of texture or buffer descriptions. The lower-cased names
+// are built once, and the matches for the last query of each kind are kept so that paging through
+// them doesn't filter the whole list again. The replay renderer uses this for a local replay, and
+// the remote side of a proxy uses it so that only the requested page is sent back.
+class ResourceIndex
+{
+public:
+  // returns every use of a resource, given the ID from its description, sorted by event
+  typedef std::function<const vector<EventUsage> &(ResourceId)> UsageLookup;
+
+  // the descriptions are fixed for the life of a capture, so this is only needed if the list
+  // being queried is replaced
+  void Clear();
+
+  uint32_t QueryTextures(const vector<FetchTexture> &texs, const ResourceQuery &query,
+                         UsageLookup usage, vector<FetchTexture> &page);
+  uint32_t QueryBuffers(const vector<FetchBuffer> &bufs, const ResourceQuery &query,
+                        UsageLookup usage, vector<FetchBuffer> &page);
+
+private:
+  struct Matches
+  {
+    Matches() : valid(false) {}
+    bool valid;
+    ResourceQuery query;
+    vector<uint32_t> indices;
+  };
+
+  template <typename ResourceType>
+  const vector<uint32_t> &Match(const vector<ResourceType> &resources, vector<string> &names,
+                                Matches &matches, const ResourceQuery &query, UsageLookup usage);
+
+  vector<string> m_TextureNames;
+  vector<string> m_BufferNames;
+
+  Matches m_TextureMatches;
+  Matches m_BufferMatches;
+};
@@ -25,27 +25,162 @@
 
 #include "serialiser.h"
 #include <errno.h>
+#include <algorithm>
 #include "3rdparty/lz4/lz4.h"
+#include "3rdparty/miniz/miniz.h"
 #include "common/timing.h"
 #include "core/core.h"
 #include "serialise/string_utils.h"
 
+// miniz.h only declares the archive functions, these are the single call zlib-style functions
+// from miniz.c used for deflate compressed sections
+extern "C" {
+typedef unsigned long mz_ulong;
+mz_ulong mz_compressBound(mz_ulong source_len);
+int mz_compress2(unsigned char *pDest, mz_ulong *pDest_len, const unsigned char *pSource,
+                 mz_ulong source_len, int level);
+int mz_uncompress(unsigned char *pDest, mz_ulong *pDest_len, const unsigned char *pSource,
+                  mz_ulong source_len);
+};
+
+static const int MZ_OK = 0;
+
+// when deduplicating callstacks, each chunk header stores this in place of the stack depth,
+// followed by a uint32 index into the capture's callstack table. Real stacks are always shorter.
+static const uint8_t CallstackTableIndex = 0xff;
+
+// every unique callstack recorded by the process while deduplicating. Chunks recorded outside of
+// a frame capture (e.g. resource creation) can be written into any later capture, so the table is
+// never cleared and the whole of it is written out with each capture.
+struct CallstackTable
+{
+  Threading::CriticalSection lock;
+
+  // every stack's addresses back to back, stack i being addrs[offsets[i]] to addrs[offsets[i+1]]
+  vector<uint64_t> addrs;
+  vector<uint32_t> offsets;
+
+  // stack indices by hash of their addresses
+  map<uint64_t, vector<uint32_t> > lookup;
+};
+
+static CallstackTable callstackTable;
+
+static uint32_t AddToCallstackTable(const uint64_t *addrs, uint32_t numLevels)
+{
+  // FNV-1a over the addresses
+  uint64_t hash = 14695981039346656037ULL;
+  for(uint32_t i = 0; i < numLevels; i++)
+  {
+    hash ^= addrs[i];
+    hash *= 1099511628211ULL;
+  }
+
+  SCOPED_LOCK(callstackTable.lock);
+
+  if(callstackTable.offsets.empty())
+    callstackTable.offsets.push_back(0);
+
+  vector<uint32_t> &candidates = callstackTable.lookup[hash];
+
+  for(size_t i = 0; i < candidates.size(); i++)
+  {
+    uint32_t idx = candidates[i];
+    uint32_t offs = callstackTable.offsets[idx];
+    uint32_t len = callstackTable.offsets[idx + 1] - offs;
+
+    if(len == numLevels &&
+       (len == 0 || !memcmp(&callstackTable.addrs[offs], addrs, len * sizeof(uint64_t))))
+      return idx;
+  }
+
+  uint32_t idx = uint32_t(callstackTable.offsets.size() - 1);
+
+  callstackTable.addrs.insert(callstackTable.addrs.end(), addrs, addrs + numLevels);
+  callstackTable.offsets.push_back((uint32_t)callstackTable.addrs.size());
+
+  candidates.push_back(idx);
+
+  return idx;
+}
+
+// an interned string is stored with this in place of its length, followed by a uint32 index into
+// the capture's string table. Real strings can't be this long.
+static const uint32_t StringTableIndex = ~0U;
+
+// every unique interned string, kept for the same reason as the callstack table. Strings that are
+// different every frame would grow it forever, so past a limit new strings are written inline.
+struct StringTable
+{
+  static const size_t MaxStrings = 64 * 1024;
+  static const size_t MaxBytes = 16 * 1024 * 1024;
+
+  StringTable() : bytes(0) {}
+  Threading::CriticalSection lock;
+
+  vector<string> strings;
+  map<string, uint32_t> lookup;
+  size_t bytes;
+};
+
+// RDCMIN takes its arguments by reference, which needs these to have storage
+const size_t StringTable::MaxStrings;
+const size_t StringTable::MaxBytes;
+
+static StringTable stringTable;
+
+static uint32_t AddToStringTable(const string &str)
+{
+  SCOPED_LOCK(stringTable.lock);
+
+  map<string, uint32_t>::iterator it = stringTable.lookup.find(str);
+  if(it != stringTable.lookup.end())
+    return it->second;
+
+  if(stringTable.strings.size() >= StringTable::MaxStrings ||
+     stringTable.bytes + str.size() > StringTable::MaxBytes)
+    return StringTableIndex;
+
+  uint32_t idx = (uint32_t)stringTable.strings.size();
+
+  stringTable.strings.push_back(str);
+  stringTable.lookup[str] = idx;
+  stringTable.bytes += str.size();
+
+  return idx;
+}
+
 #if ENABLED(RDOC_MSVS)
 // warning C4422: 'snprintf' : too many arguments passed for format string
 // false positive as VS is trying to parse renderdoc's custom format strings
 #pragma warning(disable : 4422)
 #endif
 
-#if ENABLED(RDOC_DEVEL)
-
 int64_t Chunk::m_LiveChunks = 0;
 int64_t Chunk::m_TotalMem = 0;
 int64_t Chunk::m_MaxChunks = 0;
-
-#endif
+int64_t Chunk::m_ArenaMem = 0;
+int64_t Chunk::m_MaxArenaMem = 0;
+int64_t Chunk::m_SpilledMem = 0;
+
+// spilled chunks are appended to a single file, protected by spillLock. Once no chunk refers to it
+// any more the file is written from the start again, so it only grows as large as the most data
+// spilled at once.
+static Threading::CriticalSection spillLock;
+static string spillFilename;
+static FILE *spillFile = NULL;
+static uint64_t spillEnd = 0;
+static uint64_t spillRefs = 0;
+
+// only taken the first time a chunk's data is shared, to allocate its count of sharers
+static Threading::CriticalSection shareLock;
 
 const uint32_t Serialiser::MAGIC_HEADER = MAKE_FOURCC('R', 'D', 'O', 'C');
 const uint64_t Serialiser::BufferAlignment = 64;
+const uint32_t Serialiser::BufferDedupMinSize = 4 * 1024;
+const uint32_t Serialiser::BufferDedupReference = ~0U;
+
+FILE *Serialiser::m_DebugTextExportTarget = NULL;
 
 // based on blockStreaming_doubleBuffer.c in lz4 examples
 struct CompressedFileIO
@@ -53,20 +188,67 @@ struct CompressedFileIO
   // large block size
   static const size_t BlockSize = 64 * 1024;
 
-  CompressedFileIO(FILE *f)
+  // maximum amount of decompressed data to keep cached for seekable streams, see EnableBlockCache
+  static const uint64_t BlockCacheBudget = 512 * 1024 * 1024;
+
+  // number of blocks decompressed ahead of the reader on seekable streams, see Prefetch
+  static const size_t NumPrefetchSlots = 64;
+
+  // upper bound on prefetch threads, past this the reader parsing the data can't keep up anyway
+  static const uint32_t MaxPrefetchWorkers = 32;
+
+  // identifies the block directory at the end of sections with eSectionFlag_BlockDirectory
+  static const uint32_t BlockDirectoryMagic = MAKE_FOURCC('R', 'D', 'B', 'D');
+
+  // deflate streams (eSectionFlag_DeflateCompressed) are only ever made of independent blocks
+  CompressedFileIO(FILE *f, bool deflate = false)
   {
     m_F = f;
+    m_Deflate = deflate;
     LZ4_resetStream(&m_LZ4Comp);
     LZ4_setStreamDecode(&m_LZ4Decomp, NULL, 0);
     m_CompressedSize = m_UncompressedSize = 0;
     m_PageIdx = m_PageOffset = 0;
     m_PageData = 0;
 
+    m_Independent = false;
+    m_BlockIdx = 0;
+    m_CacheFromBlock = ~size_t(0);
+    m_CachedBytes = 0;
+
+    m_PrefetchSlots = NULL;
+    m_RunningWorkers = 0;
+    m_KillWorkers = false;
+
+    // leave one core for the thread consuming the data
+    uint32_t numCores = Threading::GetNumberOfCores();
+    m_NumWorkers = RDCMIN(numCores - 1, (uint32_t)MaxPrefetchWorkers);
+
     m_CompressSize = LZ4_COMPRESSBOUND(BlockSize);
+    if(deflate)
+      m_CompressSize = RDCMAX(m_CompressSize, (size_t)mz_compressBound(BlockSize));
     m_CompressBuf = new byte[m_CompressSize];
   }
 
-  ~CompressedFileIO() { SAFE_DELETE_ARRAY(m_CompressBuf); }
+  ~CompressedFileIO()
+  {
+    StopPrefetch();
+
+    if(m_PrefetchSlots)
+    {
+      for(size_t i = 0; i < NumPrefetchSlots; i++)
+      {
+        SAFE_DELETE_ARRAY(m_PrefetchSlots[i].data);
+        SAFE_DELETE_ARRAY(m_PrefetchSlots[i].comp);
+      }
+    }
+
+    SAFE_DELETE_ARRAY(m_PrefetchSlots);
+    SAFE_DELETE_ARRAY(m_CompressBuf);
+
+    for(size_t i = 0; i < m_BlockCache.size(); i++)
+      SAFE_DELETE_ARRAY(m_BlockCache[i].data);
+  }
   uint32_t GetCompressedSize() { return m_CompressedSize; }
   uint32_t GetUncompressedSize() { return m_UncompressedSize; }
   // write out some data - accumulate into the input pages, then
@@ -138,6 +320,127 @@ struct CompressedFileIO
     m_CompressedSize = m_UncompressedSize = 0;
     m_PageIdx = 0;
     m_PageOffset = 0;
+    m_PageData = 0;
+    m_BlockIdx = 0;
+  }
+
+  // for reading streams of independently compressed blocks. Scans the block headers from the
+  // current file position to find where each block starts (every block but the last decompresses
+  // to exactly BlockSize), so that we can later seek to any uncompressed offset. Leaves the file
+  // position where it was.
+  void BuildBlockDirectory(uint64_t compressedLength)
+  {
+    m_Independent = true;
+    m_BlockOffsets.clear();
+
+    uint64_t start = FileIO::ftell64(m_F);
+    uint64_t offs = start;
+
+    while(offs + sizeof(int32_t) <= start + compressedLength)
+    {
+      int32_t compSize = 0;
+      FileIO::fseek64(m_F, offs, SEEK_SET);
+      if(FileIO::fread(&compSize, sizeof(compSize), 1, m_F) != 1 || compSize <= 0)
+        break;
+
+      m_BlockOffsets.push_back(offs);
+      offs += sizeof(int32_t) + compSize;
+    }
+
+    FileIO::fseek64(m_F, start, SEEK_SET);
+  }
+
+  // for reading streams with eSectionFlag_BlockDirectory. The offset of each block (relative to
+  // the start of the compressed data) is stored after the last block, followed by the number of
+  // blocks and BlockDirectoryMagic, so every block can be located without reading any of them.
+  // If the directory doesn't look right we fall back to scanning, which stops at the directory
+  // since its first entry is always 0. Leaves the file position where it was.
+  void ReadBlockDirectory(uint64_t compressedLength)
+  {
+    uint64_t start = FileIO::ftell64(m_F);
+
+    uint32_t footer[2] = {0, 0};    // block count, magic
+    bool valid = false;
+
+    if(compressedLength >= sizeof(footer))
+    {
+      FileIO::fseek64(m_F, start + compressedLength - sizeof(footer), SEEK_SET);
+      valid = FileIO::fread(footer, sizeof(footer), 1, m_F) == 1 &&
+              footer[1] == BlockDirectoryMagic;
+    }
+
+    uint64_t dirSize = uint64_t(footer[0]) * sizeof(uint64_t) + sizeof(footer);
+
+    if(valid && dirSize <= compressedLength)
+    {
+      uint64_t dirStart = compressedLength - dirSize;
+
+      m_BlockOffsets.resize(footer[0]);
+
+      FileIO::fseek64(m_F, start + dirStart, SEEK_SET);
+      if(!m_BlockOffsets.empty())
+        valid = FileIO::fread(&m_BlockOffsets[0], sizeof(uint64_t), m_BlockOffsets.size(), m_F) ==
+                m_BlockOffsets.size();
+
+      for(size_t i = 0; valid && i < m_BlockOffsets.size(); i++)
+      {
+        // offsets must be strictly increasing and all lie before the directory
+        if(m_BlockOffsets[i] >= dirStart || (i > 0 && m_BlockOffsets[i] <= m_BlockOffsets[i - 1]))
+          valid = false;
+      }
+
+      for(size_t i = 0; valid && i < m_BlockOffsets.size(); i++)
+        m_BlockOffsets[i] += start;
+    }
+    else
+    {
+      valid = false;
+    }
+
+    FileIO::fseek64(m_F, start, SEEK_SET);
+
+    if(valid)
+    {
+      m_Independent = true;
+      return;
+    }
+
+    RDCWARN("Compressed block directory is missing or corrupt, scanning block headers instead");
+
+    BuildBlockDirectory(compressedLength);
+  }
+
+  bool IsSeekable() { return m_Independent; }
+  // position the stream so the next Read() returns data from the given uncompressed offset
+  void Seek(uint64_t offs)
+  {
+    RDCASSERT(m_Independent);
+
+    m_BlockIdx = size_t(offs / BlockSize);
+    m_UncompressedSize = uint32_t(m_BlockIdx * BlockSize);
+    m_PageOffset = 0;
+    m_PageData = 0;
+
+    size_t skip = size_t(offs % BlockSize);
+
+    if(skip > 0 && FillBuffer())
+    {
+      skip = RDCMIN(skip, m_PageData);
+      m_PageOffset += skip;
+      m_PageData -= skip;
+    }
+  }
+
+  // keep decompressed blocks from this offset onwards in memory, so repeatedly re-reading the
+  // same range (e.g. replaying the frame) doesn't decompress it again. Once the budget is used up
+  // later blocks are decompressed each time on demand, so the cached prefix doesn't get thrashed.
+  void EnableBlockCache(uint64_t fromOffset)
+  {
+    if(!m_Independent)
+      return;
+
+    m_CacheFromBlock = size_t(fromOffset / BlockSize);
+    m_BlockCache.resize(m_BlockOffsets.size());
   }
 
   // read out some data - if the input page is empty we fill
@@ -170,155 +473,862 @@ struct CompressedFileIO
         len -= readamount;
       }
 
-      if(len > 0)
-        FillBuffer();    // this will swap the input pages and reset the page offset
+      // this will swap the input pages and reset the page offset
+      if(len > 0 && !FillBuffer())
+      {
+        RDCERR("Reading past the end of compressed data");
+        memset(data, 0, len);
+        return;
+      }
     } while(len > 0);
   }
 
-  void FillBuffer()
+  bool FillBuffer()
   {
+    m_PageIdx = 1 - m_PageIdx;
+    m_PageOffset = 0;
+    m_PageData = 0;
+
+    if(m_Independent)
+      return FillIndependentBuffer();
+
     int32_t compSize = 0;
 
     FileIO::fread(&compSize, sizeof(compSize), 1, m_F);
+
+    if(compSize <= 0 || compSize > (int32_t)m_CompressSize)
+    {
+      RDCERR("Invalid compressed block size %i", compSize);
+      return false;
+    }
+
     size_t numRead = FileIO::fread(m_CompressBuf, 1, compSize, m_F);
 
     m_CompressedSize += compSize;
 
-    m_PageIdx = 1 - m_PageIdx;
-
-    int32_t decompSize = LZ4_decompress_safe_continue(
-        &m_LZ4Decomp, (const char *)m_CompressBuf, (char *)m_InPages[m_PageIdx], compSize, BlockSize);
+    int32_t decompSize = LZ4_decompress_safe_continue(&m_LZ4Decomp, (const char *)m_CompressBuf,
+                                                      (char *)m_InPages[m_PageIdx], compSize,
+                                                      BlockSize);
 
     if(decompSize < 0)
     {
       RDCERR("Error decompressing: %i (%i / %i)", decompSize, int(numRead), compSize);
-      return;
+      return false;
     }
 
-    m_PageOffset = 0;
     m_PageData = decompSize;
+
+    return true;
   }
 
-  static void Decompress(byte *destBuf, const byte *srcBuf, size_t len)
+  bool FillIndependentBuffer()
   {
-    LZ4_streamDecode_t lz4;
-    LZ4_setStreamDecode(&lz4, NULL, 0);
+    if(m_BlockIdx >= m_BlockOffsets.size())
+      return false;
 
-    const byte *srcBufEnd = srcBuf + len;
+    byte *page = m_InPages[m_PageIdx];
+    int32_t decompSize = -1;
 
-    while(srcBuf + 4 < srcBufEnd)
+    if(m_BlockIdx < m_BlockCache.size() && m_BlockCache[m_BlockIdx].data)
     {
-      const int32_t *compSize = (const int32_t *)srcBuf;
-      srcBuf = (const byte *)(compSize + 1);
+      CachedBlock &cached = m_BlockCache[m_BlockIdx];
+      memcpy(page, cached.data, cached.size);
+      decompSize = (int32_t)cached.size;
+    }
+    else
+    {
+      PrefetchSlot *slot =
+          m_PrefetchSlots ? &m_PrefetchSlots[m_BlockIdx % NumPrefetchSlots] : NULL;
 
-      if(srcBuf + *compSize > srcBufEnd)
-        break;
+      if(slot && slot->block == m_BlockIdx && slot->state != ePrefetch_Free)
+      {
+        // if no worker has picked it up yet, decompress it here rather than waiting
+        if(Atomic::CmpExch32(&slot->state, ePrefetch_Pending, ePrefetch_Busy) == ePrefetch_Pending)
+        {
+          slot->size = DecompressBlock(m_BlockIdx, slot->data, slot->comp);
+          Atomic::CmpExch32(&slot->state, ePrefetch_Busy, ePrefetch_Ready);
+        }
+
+        if(slot->state != ePrefetch_Ready)
+        {
+          SCOPED_LOCK(m_PrefetchLock);
+          while(slot->state != ePrefetch_Ready)
+            m_PrefetchSignal.Wait(m_PrefetchLock);
+        }
+
+        decompSize = slot->size;
+        if(decompSize > 0)
+          memcpy(page, slot->data, decompSize);
 
-      int32_t decompSize = LZ4_decompress_safe_continue(&lz4, (const char *)srcBuf, (char *)destBuf,
-                                                        *compSize, BlockSize);
+        Atomic::CmpExch32(&slot->state, ePrefetch_Ready, ePrefetch_Free);
+      }
+      else
+      {
+        decompSize = DecompressBlock(m_BlockIdx, page, m_CompressBuf);
+      }
 
       if(decompSize < 0)
-        return;
+        return false;
 
-      srcBuf += *compSize;
-      destBuf += decompSize;
+      if(m_BlockIdx >= m_CacheFromBlock && m_BlockIdx < m_BlockCache.size() &&
+         m_CachedBytes + decompSize <= BlockCacheBudget)
+      {
+        CachedBlock &cached = m_BlockCache[m_BlockIdx];
+        cached.data = new byte[decompSize];
+        cached.size = decompSize;
+        memcpy(cached.data, page, decompSize);
+
+        m_CachedBytes += decompSize;
+      }
     }
+
+    m_PageData = decompSize;
+    m_BlockIdx++;
+
+    Prefetch();
+
+    return true;
   }
 
-  LZ4_stream_t m_LZ4Comp;
-  LZ4_streamDecode_t m_LZ4Decomp;
-  FILE *m_F;
-  uint32_t m_CompressedSize, m_UncompressedSize;
+  // reads and decompresses one independent block into dest, which must be BlockSize bytes, using
+  // comp as scratch space for the compressed data. Safe to call from the prefetch workers, as the
+  // file position is only touched under m_FileLock.
+  int32_t DecompressBlock(size_t idx, byte *dest, byte *comp)
+  {
+    int32_t compSize = 0;
+    size_t numRead = 0;
 
-  byte m_InPages[2][BlockSize];
-  size_t m_PageIdx, m_PageOffset, m_PageData;
+    {
+      SCOPED_LOCK(m_FileLock);
 
-  byte *m_CompressBuf;
-  size_t m_CompressSize;
-};
+      FileIO::fseek64(m_F, m_BlockOffsets[idx], SEEK_SET);
+      FileIO::fread(&compSize, sizeof(compSize), 1, m_F);
 
-Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary)
-{
-  m_Length = (uint32_t)ser->GetOffset();
+      if(compSize <= 0 || compSize > (int32_t)m_CompressSize)
+      {
+        RDCERR("Invalid compressed block size %i in block %u", compSize, (uint32_t)idx);
+        return -1;
+      }
 
-  RDCASSERT(ser->GetOffset() < 0xffffffff);
+      numRead = FileIO::fread(comp, 1, compSize, m_F);
+    }
 
-  m_ChunkType = chunkType;
+    int32_t decompSize = -1;
 
-  m_Temporary = temporary;
+    // independent blocks don't need the previous page as a dictionary
+    if(m_Deflate)
+    {
+      mz_ulong destLen = BlockSize;
+      if(mz_uncompress(dest, &destLen, comp, compSize) == MZ_OK)
+        decompSize = (int32_t)destLen;
+    }
+    else
+    {
+      decompSize = LZ4_decompress_safe((const char *)comp, (char *)dest, compSize, (int)BlockSize);
+    }
 
-  if(ser->HasAlignedData())
-  {
-    m_Data = Serialiser::AllocAlignedBuffer(m_Length);
-    m_AlignedData = true;
+    if(decompSize < 0)
+      RDCERR("Error decompressing block %u: %i (%i / %i)", (uint32_t)idx, decompSize, int(numRead),
+             compSize);
+
+    return decompSize;
   }
-  else
+
+  // queue up the blocks following the current one to be decompressed on worker threads, so that
+  // streaming through a seekable stream is spread across all the cores rather than decompressing
+  // each block only when the reader reaches it. Blocks that are already cached are skipped.
+  void Prefetch()
   {
-    m_Data = new byte[m_Length];
-    m_AlignedData = false;
-  }
+    if(m_NumWorkers == 0)
+      return;
 
-  memcpy(m_Data, ser->GetRawPtr(0), m_Length);
+    if(m_PrefetchSlots == NULL)
+    {
+      m_PrefetchSlots = new PrefetchSlot[NumPrefetchSlots];
 
-  if(ser->GetDebugText())
-    m_DebugStr = ser->GetDebugStr();
+      for(size_t i = 0; i < NumPrefetchSlots; i++)
+      {
+        m_PrefetchSlots[i].state = ePrefetch_Free;
+        m_PrefetchSlots[i].block = ~size_t(0);
+        m_PrefetchSlots[i].size = 0;
+        m_PrefetchSlots[i].data = new byte[BlockSize];
+        m_PrefetchSlots[i].comp = new byte[m_CompressSize];
+      }
+    }
 
-  ser->Rewind();
+    bool queued = false;
 
-#if ENABLED(RDOC_DEVEL)
-  int64_t newval = Atomic::Inc64(&m_LiveChunks);
-  Atomic::ExchAdd64(&m_TotalMem, m_Length);
+    size_t end = RDCMIN(m_BlockIdx + NumPrefetchSlots, m_BlockOffsets.size());
 
-  if(newval > m_MaxChunks)
-  {
-    int breakpointme = 0;
-    (void)breakpointme;
-  }
+    for(size_t b = m_BlockIdx; b < end; b++)
+    {
+      if(b < m_BlockCache.size() && m_BlockCache[b].data)
+        continue;
 
-  m_MaxChunks = RDCMAX(newval, m_MaxChunks);
-#endif
-}
+      PrefetchSlot &slot = m_PrefetchSlots[b % NumPrefetchSlots];
 
-Chunk *Chunk::Duplicate()
-{
-  Chunk *ret = new Chunk();
-  ret->m_DebugStr = m_DebugStr;
-  ret->m_Length = m_Length;
-  ret->m_ChunkType = m_ChunkType;
-  ret->m_Temporary = m_Temporary;
-  ret->m_AlignedData = m_AlignedData;
+      int32_t state = slot.state;
 
-  if(m_AlignedData)
-    ret->m_Data = Serialiser::AllocAlignedBuffer(m_Length);
-  else
-    ret->m_Data = new byte[m_Length];
+      if(slot.block == b && state != ePrefetch_Free)
+        continue;
 
-  memcpy(ret->m_Data, m_Data, m_Length);
+      // the slot holds a block we've seeked away from. Reclaim it unless it's being worked on
+      if(state == ePrefetch_Busy)
+        continue;
 
-#if ENABLED(RDOC_DEVEL)
-  int64_t newval = Atomic::Inc64(&m_LiveChunks);
-  Atomic::ExchAdd64(&m_TotalMem, m_Length);
+      if(state != ePrefetch_Free && Atomic::CmpExch32(&slot.state, state, ePrefetch_Free) != state)
+        continue;
 
-  if(newval > m_MaxChunks)
-  {
-    int breakpointme = 0;
-    (void)breakpointme;
-  }
+      slot.block = b;
+      Atomic::CmpExch32(&slot.state, ePrefetch_Free, ePrefetch_Pending);
+      queued = true;
+    }
 
-  m_MaxChunks = RDCMAX(newval, m_MaxChunks);
-#endif
+    // wake any idle workers. The state changes above were made before taking the lock, so a worker
+    // that checked for work under the lock and found none is already waiting and sees this.
+    if(queued)
+    {
+      SCOPED_LOCK(m_PrefetchLock);
+      m_PrefetchSignal.Broadcast();
+    }
 
-  return ret;
-}
+    // workers exit by themselves once they've been idle for a while, so start them up again. Any
+    // pending block the reader reaches before a worker does is decompressed by the reader itself.
+    if(queued && m_RunningWorkers == 0)
+    {
+      JoinWorkers();
 
-Chunk::~Chunk()
-{
-#if ENABLED(RDOC_DEVEL)
-  Atomic::Dec64(&m_LiveChunks);
-  Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
-#endif
+      for(uint32_t i = 0; i < m_NumWorkers; i++)
+      {
+        Atomic::Inc32(&m_RunningWorkers);
+        m_Workers.push_back(Threading::CreateThread(&CompressedFileIO::PrefetchThread, this));
+      }
+    }
+  }
 
-  if(m_AlignedData)
+  void StopPrefetch()
+  {
+    {
+      SCOPED_LOCK(m_PrefetchLock);
+      m_KillWorkers = true;
+      m_PrefetchSignal.Broadcast();
+    }
+
+    JoinWorkers();
+    m_KillWorkers = false;
+  }
+
+  void JoinWorkers()
+  {
+    for(size_t i = 0; i < m_Workers.size(); i++)
+    {
+      Threading::JoinThread(m_Workers[i]);
+      Threading::CloseThread(m_Workers[i]);
+    }
+
+    m_Workers.clear();
+  }
+
+  // whether any slot has a block waiting for a worker
+  bool HasPendingPrefetch()
+  {
+    for(size_t i = 0; i < NumPrefetchSlots; i++)
+      if(m_PrefetchSlots[i].state == ePrefetch_Pending)
+        return true;
+
+    return false;
+  }
+
+  static void PrefetchThread(void *ths)
+  {
+    CompressedFileIO *io = (CompressedFileIO *)ths;
+
+    // sleep when there's nothing to do, and exit after a while without any work so that a reader
+    // sitting idle (e.g. during replay) doesn't keep threads around.
+    const uint32_t IdleExitMS = 1000;
+
+    while(!io->m_KillWorkers)
+    {
+      bool worked = false;
+
+      for(size_t i = 0; i < NumPrefetchSlots; i++)
+      {
+        PrefetchSlot &slot = io->m_PrefetchSlots[i];
+
+        if(slot.state != ePrefetch_Pending ||
+           Atomic::CmpExch32(&slot.state, ePrefetch_Pending, ePrefetch_Busy) != ePrefetch_Pending)
+          continue;
+
+        slot.size = io->DecompressBlock(slot.block, slot.data, slot.comp);
+        Atomic::CmpExch32(&slot.state, ePrefetch_Busy, ePrefetch_Ready);
+
+        // the reader may be waiting on exactly this block
+        {
+          SCOPED_LOCK(io->m_PrefetchLock);
+          io->m_PrefetchSignal.Broadcast();
+        }
+
+        worked = true;
+      }
+
+      if(worked)
+        continue;
+
+      SCOPED_LOCK(io->m_PrefetchLock);
+
+      if(io->m_KillWorkers || io->HasPendingPrefetch())
+        continue;
+
+      if(!io->m_PrefetchSignal.Wait(io->m_PrefetchLock, IdleExitMS) && !io->HasPendingPrefetch())
+        break;
+    }
+
+    Atomic::Dec32(&io->m_RunningWorkers);
+  }
+
+  static void Decompress(byte *destBuf, const byte *srcBuf, size_t len, bool deflate)
+  {
+    LZ4_streamDecode_t lz4;
+    LZ4_setStreamDecode(&lz4, NULL, 0);
+
+    const byte *srcBufEnd = srcBuf + len;
+
+    while(srcBuf + 4 < srcBufEnd)
+    {
+      const int32_t *compSize = (const int32_t *)srcBuf;
+      srcBuf = (const byte *)(compSize + 1);
+
+      // a zero size marks the start of the block directory, if there is one
+      if(*compSize <= 0 || srcBuf + *compSize > srcBufEnd)
+        break;
+
+      int32_t decompSize = -1;
+
+      if(deflate)
+      {
+        mz_ulong destLen = BlockSize;
+        if(mz_uncompress(destBuf, &destLen, srcBuf, *compSize) == MZ_OK)
+          decompSize = (int32_t)destLen;
+      }
+      else
+      {
+        decompSize = LZ4_decompress_safe_continue(&lz4, (const char *)srcBuf, (char *)destBuf,
+                                                  *compSize, BlockSize);
+      }
+
+      if(decompSize < 0)
+        return;
+
+      srcBuf += *compSize;
+      destBuf += decompSize;
+    }
+  }
+
+  LZ4_stream_t m_LZ4Comp;
+  LZ4_streamDecode_t m_LZ4Decomp;
+  FILE *m_F;
+  bool m_Deflate;
+  uint32_t m_CompressedSize, m_UncompressedSize;
+
+  byte m_InPages[2][BlockSize];
+  size_t m_PageIdx, m_PageOffset, m_PageData;
+
+  byte *m_CompressBuf;
+  size_t m_CompressSize;
+
+  // seekable reading of independent blocks
+  struct CachedBlock
+  {
+    CachedBlock() : data(NULL), size(0) {}
+    byte *data;
+    size_t size;
+  };
+
+  bool m_Independent;
+  vector<uint64_t> m_BlockOffsets;
+  size_t m_BlockIdx;
+
+  vector<CachedBlock> m_BlockCache;
+  size_t m_CacheFromBlock;
+  uint64_t m_CachedBytes;
+
+  // blocks being decompressed ahead of the reader. A slot for block b is at b % NumPrefetchSlots
+  enum PrefetchState
+  {
+    ePrefetch_Free = 0,
+    ePrefetch_Pending,
+    ePrefetch_Busy,
+    ePrefetch_Ready,
+  };
+
+  struct PrefetchSlot
+  {
+    volatile int32_t state;
+    size_t block;
+    int32_t size;
+    byte *data;
+    byte *comp;
+  };
+
+  PrefetchSlot *m_PrefetchSlots;
+
+  // guards the file position, shared between the reader and the prefetch workers
+  Threading::CriticalSection m_FileLock;
+
+  // idle workers wait on m_PrefetchSignal for blocks to be queued, and the reader waits on it for
+  // the block it needs to become ready. Broadcast under m_PrefetchLock after every such change.
+  Threading::CriticalSection m_PrefetchLock;
+  Threading::ConditionVariable m_PrefetchSignal;
+
+  uint32_t m_NumWorkers;
+  volatile int32_t m_RunningWorkers;
+  volatile bool m_KillWorkers;
+  vector<Threading::ThreadHandle> m_Workers;
+};
+
+// writes the same on-disk format as CompressedFileIO (a sequence of int32 compressed size followed
+// by that many bytes of LZ4 data), but each block is compressed independently instead of chained
+// against the previous one. Since no block references data from another, the chained decoder in
+// CompressedFileIO reads them back unchanged. Blocks can optionally be deflated instead, which is
+// much slower but gives a better ratio for captures that are being archived.
+//
+// Blocks are filled on the calling thread, compressed by a pool of worker threads, and written
+// out strictly in order by a dedicated writer thread, so the caller only blocks when every slot
+// in the ring is still waiting to be compressed or written. After the last block, Finish()
+// appends the block directory that CompressedFileIO::ReadBlockDirectory expects.
+//
+// This runs while the application carries on after a capture, so nothing spins: slot states and
+// counters are only changed under m_Lock, and each thread sleeps on a condition variable until
+// the state it's waiting for is signalled.
+struct ParallelCompressedFileIO
+{
+  static const size_t BlockSize = CompressedFileIO::BlockSize;
+
+  // number of blocks in flight at once. Bounds the extra memory to ~NumSlots * 2 * BlockSize
+  static const int32_t NumSlots = 64;
+
+  // don't spin up more workers than is useful, the disk becomes the limiting factor quickly.
+  // Deflate is slow enough that it stays CPU bound with many more workers
+  static const uint32_t MaxWorkers = 8;
+  static const uint32_t MaxDeflateWorkers = 32;
+
+  // favour ratio over speed, deflate is only used for offline recompression
+  static const int DeflateLevel = MZ_BEST_COMPRESSION;
+
+  enum SlotState
+  {
+    eSlot_Free = 0,
+    eSlot_Filled,
+    eSlot_Compressed,
+  };
+
+  struct Slot
+  {
+    int32_t state;
+    int32_t uncompSize;
+    int32_t compSize;
+    byte *uncomp;
+    byte *comp;
+  };
+
+  ParallelCompressedFileIO(FILE *f, bool deflate = false)
+  {
+    m_F = f;
+    m_Deflate = deflate;
+    m_CompressedSize = m_UncompressedSize = 0;
+    m_PageOffset = 0;
+
+    m_Submitted = 0;
+    m_NextCompress = 0;
+    m_Written = 0;
+
+    m_Finished = false;
+    m_KillWorkers = false;
+
+    m_CompressSize = LZ4_COMPRESSBOUND(BlockSize);
+    if(deflate)
+      m_CompressSize = (size_t)mz_compressBound(BlockSize);
+
+    for(int32_t i = 0; i < NumSlots; i++)
+    {
+      m_Slots[i].state = eSlot_Free;
+      m_Slots[i].uncompSize = m_Slots[i].compSize = 0;
+      m_Slots[i].uncomp = new byte[BlockSize];
+      m_Slots[i].comp = new byte[m_CompressSize];
+    }
+
+    // leave one core for the thread filling blocks
+    uint32_t maxWorkers = MaxWorkers;
+    if(deflate)
+      maxWorkers = MaxDeflateWorkers;
+
+    uint32_t numWorkers = Threading::GetNumberOfCores();
+    numWorkers = RDCCLAMP(numWorkers > 1 ? numWorkers - 1 : 1, 1U, maxWorkers);
+
+    for(uint32_t i = 0; i < numWorkers; i++)
+      m_Workers.push_back(Threading::CreateThread(&ParallelCompressedFileIO::WorkerThread, this));
+
+    m_WriterThread = Threading::CreateThread(&ParallelCompressedFileIO::WriterThread, this);
+  }
+
+  ~ParallelCompressedFileIO()
+  {
+    Finish();
+
+    for(int32_t i = 0; i < NumSlots; i++)
+    {
+      SAFE_DELETE_ARRAY(m_Slots[i].uncomp);
+      SAFE_DELETE_ARRAY(m_Slots[i].comp);
+    }
+  }
+
+  // only valid after Finish() has returned, as the writer thread updates this
+  uint32_t GetCompressedSize() { return m_CompressedSize; }
+  uint32_t GetUncompressedSize() { return m_UncompressedSize; }
+  void Write(const void *data, size_t len)
+  {
+    if(data == NULL || len == 0)
+      return;
+
+    m_UncompressedSize += (uint32_t)len;
+
+    const byte *src = (const byte *)data;
+
+    while(len > 0)
+    {
+      Slot &slot = m_Slots[m_Submitted % NumSlots];
+
+      // first write into a slot, wait for the writer to have consumed the previous block in it
+      if(m_PageOffset == 0)
+      {
+        SCOPED_LOCK(m_Lock);
+        while(slot.state != eSlot_Free)
+          m_SlotFreed.Wait(m_Lock);
+      }
+
+      size_t copySize = RDCMIN(len, BlockSize - m_PageOffset);
+
+      memcpy(slot.uncomp + m_PageOffset, src, copySize);
+      m_PageOffset += copySize;
+
+      src += copySize;
+      len -= copySize;
+
+      if(m_PageOffset == BlockSize)
+        SubmitBlock();
+    }
+  }
+
+  // submit any partial block and wait for everything to be written to disk. After this returns
+  // the file handle can be used again by the caller.
+  void Finish()
+  {
+    if(m_Finished)
+      return;
+
+    if(m_PageOffset > 0)
+      SubmitBlock();
+
+    // the writer exits once it has written every submitted block
+    {
+      SCOPED_LOCK(m_Lock);
+      m_Finished = true;
+      m_BlockCompressed.Signal();
+    }
+
+    Threading::JoinThread(m_WriterThread);
+    Threading::CloseThread(m_WriterThread);
+    m_WriterThread = 0;
+
+    {
+      SCOPED_LOCK(m_Lock);
+      m_KillWorkers = true;
+      m_WorkAvailable.Broadcast();
+    }
+
+    for(size_t i = 0; i < m_Workers.size(); i++)
+    {
+      Threading::JoinThread(m_Workers[i]);
+      Threading::CloseThread(m_Workers[i]);
+    }
+
+    m_Workers.clear();
+
+    WriteBlockDirectory();
+  }
+
+private:
+  void WriteBlockDirectory()
+  {
+    uint32_t footer[2] = {(uint32_t)m_BlockOffsets.size(), CompressedFileIO::BlockDirectoryMagic};
+
+    if(!m_BlockOffsets.empty())
+      FileIO::fwrite(&m_BlockOffsets[0], sizeof(uint64_t), m_BlockOffsets.size(), m_F);
+    FileIO::fwrite(footer, sizeof(footer), 1, m_F);
+
+    m_CompressedSize += uint32_t(m_BlockOffsets.size() * sizeof(uint64_t) + sizeof(footer));
+  }
+
+  void SubmitBlock()
+  {
+    SCOPED_LOCK(m_Lock);
+
+    Slot &slot = m_Slots[m_Submitted % NumSlots];
+
+    slot.uncompSize = (int32_t)m_PageOffset;
+    slot.state = eSlot_Filled;
+
+    m_Submitted++;
+    m_WorkAvailable.Signal();
+
+    m_PageOffset = 0;
+  }
+
+  static void WorkerThread(void *ths)
+  {
+    ParallelCompressedFileIO *io = (ParallelCompressedFileIO *)ths;
+
+    io->m_Lock.Lock();
+
+    for(;;)
+    {
+      while(!io->m_KillWorkers && io->m_NextCompress >= io->m_Submitted)
+        io->m_WorkAvailable.Wait(io->m_Lock);
+
+      if(io->m_KillWorkers)
+        break;
+
+      // claim the oldest block that hasn't been picked up yet
+      int32_t idx = io->m_NextCompress++;
+
+      Slot &slot = io->m_Slots[idx % NumSlots];
+
+      RDCASSERT(slot.state == eSlot_Filled);
+
+      io->m_Lock.Unlock();
+
+      if(io->m_Deflate)
+      {
+        mz_ulong compSize = (mz_ulong)io->m_CompressSize;
+        int ret = mz_compress2(slot.comp, &compSize, slot.uncomp, slot.uncompSize, DeflateLevel);
+        slot.compSize = ret == MZ_OK ? (int32_t)compSize : -1;
+      }
+      else
+      {
+        slot.compSize = LZ4_compress_fast((const char *)slot.uncomp, (char *)slot.comp,
+                                          slot.uncompSize, (int)io->m_CompressSize, 1);
+      }
+
+      io->m_Lock.Lock();
+
+      slot.state = eSlot_Compressed;
+
+      // only the block the writer is waiting on matters to it
+      if(idx == io->m_Written)
+        io->m_BlockCompressed.Signal();
+    }
+
+    io->m_Lock.Unlock();
+  }
+
+  static void WriterThread(void *ths)
+  {
+    ParallelCompressedFileIO *io = (ParallelCompressedFileIO *)ths;
+
+    io->m_Lock.Lock();
+
+    for(;;)
+    {
+      if(io->m_Written == io->m_Submitted)
+      {
+        // m_Finished is only set after the last block is submitted
+        if(io->m_Finished)
+          break;
+
+        io->m_BlockCompressed.Wait(io->m_Lock);
+        continue;
+      }
+
+      Slot &slot = io->m_Slots[io->m_Written % NumSlots];
+
+      if(slot.state != eSlot_Compressed)
+      {
+        io->m_BlockCompressed.Wait(io->m_Lock);
+        continue;
+      }
+
+      io->m_Lock.Unlock();
+
+      if(slot.compSize < 0)
+      {
+        RDCERR("Error compressing: %i", slot.compSize);
+      }
+      else
+      {
+        io->m_BlockOffsets.push_back(io->m_CompressedSize);
+
+        FileIO::fwrite(&slot.compSize, sizeof(slot.compSize), 1, io->m_F);
+        FileIO::fwrite(slot.comp, 1, slot.compSize, io->m_F);
+
+        io->m_CompressedSize += slot.compSize + sizeof(int32_t);
+      }
+
+      io->m_Lock.Lock();
+
+      slot.state = eSlot_Free;
+      io->m_Written++;
+      io->m_SlotFreed.Signal();
+    }
+
+    io->m_Lock.Unlock();
+  }
+
+  FILE *m_F;
+  bool m_Deflate;
+  uint32_t m_CompressedSize, m_UncompressedSize;
+
+  Slot m_Slots[NumSlots];
+  size_t m_CompressSize;
+
+  // offset into the block currently being filled, at slot m_Submitted % NumSlots
+  size_t m_PageOffset;
+
+  // guards the slot states, the counters below and the flags. Workers wait on m_WorkAvailable
+  // for a submitted block, the writer on m_BlockCompressed for the next block in order, and the
+  // filling thread on m_SlotFreed for the slot it wants to reuse.
+  Threading::CriticalSection m_Lock;
+  Threading::ConditionVariable m_WorkAvailable;
+  Threading::ConditionVariable m_BlockCompressed;
+  Threading::ConditionVariable m_SlotFreed;
+
+  // monotonic block counters. Written <= NextCompress <= Submitted
+  int32_t m_Submitted;
+  int32_t m_NextCompress;
+  int32_t m_Written;
+
+  bool m_Finished;
+  bool m_KillWorkers;
+
+  vector<Threading::ThreadHandle> m_Workers;
+  Threading::ThreadHandle m_WriterThread;
+
+  // compressed offset of each block written, only touched by the writer thread until Finish()
+  vector<uint64_t> m_BlockOffsets;
+};
+
+// Capturing a heavy frame creates hundreds of thousands of small chunks, so rather than going to
+// the heap for each one they're bump-allocated out of large pages. Each page counts the live chunks
+// in it, plus one reference held by the arena while it's still being allocated from, and is freed
+// as a whole once that drops to zero - so when a frame's records are freed the pages its chunks
+// were packed into go with them.
+//
+// There are several arenas, picked by thread, so threads recording commands at the same time don't
+// all contend on one lock. An object can also own its own ChunkArena for the chunks recorded into
+// it. Chunks can be freed from any thread.
+struct ChunkPage
+{
+  static const size_t PageSize = 256 * 1024;
+
+  // larger chunks go straight to the heap, so a few of them don't leave most of a page unused
+  static const size_t MaxSubAllocation = PageSize / 4;
+
+  static const uint32_t NumArenas = 16;
+
+  static ChunkArena arenas[NumArenas];
+
+  byte *base;
+  volatile int32_t refs;
+
+  static byte *Alloc(size_t size, size_t alignment, ChunkArena *arena, ChunkPage *&page)
+  {
+    page = NULL;
+
+    if(size > MaxSubAllocation)
+      return NULL;
+
+    if(arena == NULL)
+    {
+      // thread IDs are often pointers, so mix the bits before picking an arena
+      uint64_t id = Threading::GetCurrentID() * 0x9E3779B97F4A7C15ULL;
+      arena = &arenas[id >> 60];
+    }
+
+    SCOPED_LOCK(arena->m_Lock);
+
+    size_t offs = AlignUp(arena->m_Offset, alignment);
+
+    if(arena->m_Page == NULL || offs + size > PageSize)
+    {
+      if(arena->m_Page)
+        Release(arena->m_Page);
+
+      arena->m_Page = new ChunkPage();
+      arena->m_Page->base = Serialiser::AllocAlignedBuffer(PageSize);
+      arena->m_Page->refs = 1;
+      offs = 0;
+
+      Atomic::ExchAdd64(&Chunk::m_ArenaMem, PageSize);
+      Chunk::m_MaxArenaMem = RDCMAX(Chunk::m_ArenaMem, Chunk::m_MaxArenaMem);
+    }
+
+    arena->m_Offset = offs + size;
+
+    page = arena->m_Page;
+    Atomic::Inc32(&page->refs);
+
+    return page->base + offs;
+  }
+
+  static void Release(ChunkPage *page)
+  {
+    if(Atomic::Dec32(&page->refs) > 0)
+      return;
+
+    Serialiser::FreeAlignedBuffer(page->base);
+    delete page;
+
+    Atomic::ExchAdd64(&Chunk::m_ArenaMem, -int64_t(PageSize));
+  }
+};
+
+RDCCOMPILE_ASSERT(ChunkPage::NumArenas == 16, "Arena selection assumes 16 arenas");
+
+ChunkArena ChunkPage::arenas[ChunkPage::NumArenas];
+
+void ChunkArena::Reset()
+{
+  SCOPED_LOCK(m_Lock);
+
+  if(m_Page)
+    ChunkPage::Release(m_Page);
+
+  m_Page = NULL;
+  m_Offset = 0;
+}
+
+void Chunk::AllocData(ChunkArena *arena)
+{
+  // match the alignment AllocAlignedBuffer would give for aligned data
+  m_Data = ChunkPage::Alloc(m_Length, m_AlignedData ? 64 : 16, arena, m_Page);
+
+  if(m_Data)
+    return;
+
+  if(m_AlignedData)
+    m_Data = Serialiser::AllocAlignedBuffer(m_Length);
+  else
+    m_Data = new byte[m_Length];
+}
+
+void Chunk::FreeData()
+{
+  if(m_Page)
+  {
+    ChunkPage::Release(m_Page);
+    m_Page = NULL;
+    m_Data = NULL;
+  }
+  else if(m_AlignedData)
   {
     if(m_Data)
       Serialiser::FreeAlignedBuffer(m_Data);
@@ -331,6 +1341,298 @@ Chunk::~Chunk()
   }
 }
 
+void Chunk::ReleaseData()
+{
+  if(m_Sharers)
+  {
+    volatile int32_t *sharers = m_Sharers;
+    m_Sharers = NULL;
+
+    if(Atomic::Dec32(sharers) > 0)
+    {
+      // another chunk still has the data, and is now responsible for freeing it
+      m_Data = NULL;
+      m_Page = NULL;
+      return;
+    }
+
+    delete(int32_t *)sharers;
+  }
+
+  Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
+  FreeData();
+}
+
+byte *Chunk::GetWritableData()
+{
+  if(m_Spilled)
+    Unspill();
+
+  if(m_Sharers && *m_Sharers > 1)
+  {
+    // other chunks are sharing the data, so this one needs its own copy to modify. Copy before
+    // dropping the share, as the shared data can be freed as soon as it's dropped.
+    byte *shared = m_Data;
+    ChunkPage *sharedPage = m_Page;
+
+    AllocData(NULL);
+    memcpy(m_Data, shared, m_Length);
+
+    byte *copy = m_Data;
+    ChunkPage *copyPage = m_Page;
+
+    m_Data = shared;
+    m_Page = sharedPage;
+    ReleaseData();
+
+    m_Data = copy;
+    m_Page = copyPage;
+    Atomic::ExchAdd64(&m_TotalMem, m_Length);
+  }
+  else if(m_Sharers)
+  {
+    // every other chunk sharing the data has gone, so it's this chunk's alone
+    delete(int32_t *)m_Sharers;
+    m_Sharers = NULL;
+  }
+
+  m_Writable = true;
+
+  return m_Data;
+}
+
+void Chunk::SetSpillFile(const char *filename)
+{
+  SCOPED_LOCK(spillLock);
+  spillFilename = filename;
+}
+
+void Chunk::CloseSpillFile()
+{
+  SCOPED_LOCK(spillLock);
+
+  if(spillFile)
+  {
+    if(spillRefs > 0)
+      RDCWARN("Closing spill file with %llu chunks still spilled", spillRefs);
+
+    FileIO::fclose(spillFile);
+    FileIO::Delete(spillFilename.c_str());
+    spillFile = NULL;
+  }
+
+  spillEnd = 0;
+}
+
+bool Chunk::Spill()
+{
+  if(m_Spilled)
+    return true;
+
+  if(m_Length == 0)
+    return false;
+
+  SCOPED_LOCK(spillLock);
+
+  if(spillFile == NULL)
+  {
+    if(spillFilename.empty())
+      return false;
+
+    spillFile = FileIO::fopen(spillFilename.c_str(), "w+b");
+
+    if(spillFile == NULL)
+    {
+      RDCERR("Couldn't open %s to spill capture data to disk", spillFilename.c_str());
+      spillFilename.clear();
+      return false;
+    }
+  }
+
+  FileIO::fseek64(spillFile, spillEnd, SEEK_SET);
+
+  if(FileIO::fwrite(m_Data, 1, m_Length, spillFile) != m_Length)
+  {
+    RDCERR("Couldn't spill %u bytes of capture data to %s", m_Length, spillFilename.c_str());
+    return false;
+  }
+
+  m_SpillOffset = spillEnd;
+  spillEnd += m_Length;
+  spillRefs++;
+
+  // the spilled copy is this chunk's own, so it's counted again if other chunks still share the
+  // data in memory
+  ReleaseData();
+  Atomic::ExchAdd64(&m_TotalMem, m_Length);
+
+  m_Spilled = true;
+  m_Writable = false;
+
+  Atomic::ExchAdd64(&m_SpilledMem, m_Length);
+
+  return true;
+}
+
+bool Chunk::ReadSpilled(byte *dst)
+{
+  SCOPED_LOCK(spillLock);
+
+  FileIO::fseek64(spillFile, m_SpillOffset, SEEK_SET);
+
+  if(FileIO::fread(dst, 1, m_Length, spillFile) != m_Length)
+  {
+    RDCERR("Couldn't read %u bytes of spilled capture data back", m_Length);
+    return false;
+  }
+
+  return true;
+}
+
+void Chunk::ReleaseSpill()
+{
+  if(!m_Spilled)
+    return;
+
+  m_Spilled = false;
+  Atomic::ExchAdd64(&m_SpilledMem, -int64_t(m_Length));
+
+  SCOPED_LOCK(spillLock);
+
+  spillRefs--;
+  if(spillRefs == 0)
+    spillEnd = 0;
+}
+
+void Chunk::Unspill()
+{
+  AllocData(NULL);
+
+  if(!ReadSpilled(m_Data))
+    memset(m_Data, 0, m_Length);
+
+  ReleaseSpill();
+}
+
+Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary, ChunkArena *arena)
+{
+  m_Length = (uint32_t)ser->GetOffset();
+
+  m_Spilled = false;
+  m_SpillOffset = 0;
+
+  m_Sharers = NULL;
+  m_Writable = false;
+
+  RDCASSERT(ser->GetOffset() < 0xffffffff);
+
+  m_ChunkType = chunkType;
+
+  m_Temporary = temporary;
+
+  m_AlignedData = ser->HasAlignedData();
+  AllocData(arena);
+
+  memcpy(m_Data, ser->GetRawPtr(0), m_Length);
+
+  if(ser->GetDebugText())
+    m_DebugStr = ser->GetDebugStr();
+
+  ser->Rewind();
+
+  int64_t newval = Atomic::Inc64(&m_LiveChunks);
+  Atomic::ExchAdd64(&m_TotalMem, m_Length);
+
+#if ENABLED(RDOC_DEVEL)
+  if(newval > m_MaxChunks)
+  {
+    int breakpointme = 0;
+    (void)breakpointme;
+  }
+#endif
+
+  m_MaxChunks = RDCMAX(newval, m_MaxChunks);
+}
+
+Chunk *Chunk::Duplicate()
+{
+  Chunk *ret = new Chunk();
+  ret->m_DebugStr = m_DebugStr;
+  ret->m_Length = m_Length;
+  ret->m_ChunkType = m_ChunkType;
+  ret->m_Temporary = m_Temporary;
+  ret->m_AlignedData = m_AlignedData;
+
+  if(m_Spilled)
+  {
+    // the copy refers to the same spilled data, which can't change
+    SCOPED_LOCK(spillLock);
+    ret->m_Spilled = true;
+    ret->m_SpillOffset = m_SpillOffset;
+    spillRefs++;
+    Atomic::ExchAdd64(&m_SpilledMem, m_Length);
+    Atomic::ExchAdd64(&m_TotalMem, m_Length);
+  }
+  else if(m_Writable)
+  {
+    // the data can still be modified through the pointer that was handed out, so it's copied
+    ret->AllocData(NULL);
+
+    memcpy(ret->m_Data, m_Data, m_Length);
+
+    Atomic::ExchAdd64(&m_TotalMem, m_Length);
+  }
+  else
+  {
+    if(m_Sharers == NULL)
+    {
+      SCOPED_LOCK(shareLock);
+
+      if(m_Sharers == NULL)
+      {
+        int32_t *sharers = new int32_t;
+        *sharers = 1;
+        m_Sharers = sharers;
+      }
+    }
+
+    Atomic::Inc32(m_Sharers);
+
+    ret->m_Data = m_Data;
+    ret->m_Page = m_Page;
+    ret->m_Sharers = m_Sharers;
+  }
+
+  int64_t newval = Atomic::Inc64(&m_LiveChunks);
+
+#if ENABLED(RDOC_DEVEL)
+  if(newval > m_MaxChunks)
+  {
+    int breakpointme = 0;
+    (void)breakpointme;
+  }
+#endif
+
+  m_MaxChunks = RDCMAX(newval, m_MaxChunks);
+
+  return ret;
+}
+
+Chunk::~Chunk()
+{
+  Atomic::Dec64(&m_LiveChunks);
+
+  if(m_Spilled)
+  {
+    ReleaseSpill();
+    Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
+  }
+  else
+  {
+    ReleaseData();
+  }
+}
+
 /*
 
  -----------------------------
@@ -437,7 +1739,8 @@ struct BinarySectionHeader
   }
 
 Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
-    : m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL)
+    : m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL), m_MappedView(NULL),
+      m_CallstackTableLoaded(false), m_StringTableLoaded(false)
 {
   m_ResolverThread = 0;
 
@@ -448,6 +1751,9 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
   RDCCOMPILE_ASSERT(offsetof(BinarySectionHeader, name) == sizeof(uint32_t) * 5,
                     "BinarySectionHeader size has changed or contains padding");
 
+  RDCCOMPILE_ASSERT(sizeof(ChunkIndexEntry) == sizeof(uint64_t) * 2,
+                    "ChunkIndexEntry size has changed or contains padding");
+
   Reset();
 
   m_Mode = READING;
@@ -624,9 +1930,11 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
   m_CurrentBufferSize = (size_t)m_BufferSize;
   m_BufferHead = m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
 
-  if(m_KnownSections[eSectionType_FrameCapture]->flags & eSectionFlag_LZ4Compressed)
+  if(m_KnownSections[eSectionType_FrameCapture]->IsCompressed())
   {
-    CompressedFileIO::Decompress(m_Buffer, memoryBuf, memoryBufEnd - memoryBuf);
+    bool deflate = (m_KnownSections[eSectionType_FrameCapture]->flags &
+                    eSectionFlag_DeflateCompressed) != 0;
+    CompressedFileIO::Decompress(m_Buffer, memoryBuf, memoryBufEnd - memoryBuf, deflate);
   }
   else
   {
@@ -635,7 +1943,8 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 }
 
 Serialiser::Serialiser(const char *path, Mode mode, bool debugMode, uint64_t sizeHint)
-    : m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL)
+    : m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL), m_MappedView(NULL),
+      m_CallstackTableLoaded(false), m_StringTableLoaded(false)
 {
   m_ResolverThread = 0;
 
@@ -652,6 +1961,8 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode, uint64_t siz
 
   if(mode == READING)
   {
+    m_DebugTextExport = m_DebugTextExportTarget;
+
     m_ReadFileHandle = FileIO::fopen(m_Filename.c_str(), "rb");
 
     if(!m_ReadFileHandle)
@@ -858,12 +2169,20 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode, uint64_t siz
 
           sect->fileoffset = FileIO::ftell64(m_ReadFileHandle);
 
-          if(sect->flags & eSectionFlag_LZ4Compressed)
+          if(sect->IsCompressed())
           {
-            sect->compressedReader = new CompressedFileIO(m_ReadFileHandle);
+            bool deflate = (sect->flags & eSectionFlag_DeflateCompressed) != 0;
+
+            sect->compressedReader = new CompressedFileIO(m_ReadFileHandle, deflate);
             FileIO::fread(&sect->size, 1, sizeof(uint64_t), m_ReadFileHandle);
 
             sect->fileoffset += sizeof(uint64_t);
+            sect->compressedSize = sectionHeader.sectionLength;
+
+            if(sect->flags & eSectionFlag_BlockDirectory)
+              sect->compressedReader->ReadBlockDirectory(sectionHeader.sectionLength);
+            else if((sect->flags & eSectionFlag_IndependentBlocks) || deflate)
+              sect->compressedReader->BuildBlockDirectory(sectionHeader.sectionLength);
           }
 
           if(sect->type != eSectionType_Unknown && sect->type < eSectionType_Num)
@@ -871,8 +2190,19 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode, uint64_t siz
           m_Sections.push_back(sect);
 
           // if section isn't frame capture data and is small enough, read it all into memory now,
-          // otherwise skip
-          if(sect->type != eSectionType_FrameCapture && sectionHeader.sectionLength < 4 * 1024 * 1024)
+          // otherwise skip. The chunk index, counter results and callstack tables are always
+          // needed in memory, the resolve database is only read if callstacks are resolved.
+          bool loadData = sectionHeader.sectionLength < 4 * 1024 * 1024 ||
+                          sect->type == eSectionType_ChunkIndex ||
+                          sect->type == eSectionType_CounterResults ||
+                          sect->type == eSectionType_ResolvedCallstacks ||
+                          sect->type == eSectionType_CallstackTable ||
+                          sect->type == eSectionType_StringTable;
+
+          if(sect->type == eSectionType_ResolveDatabase)
+            loadData = false;
+
+          if(sect->type != eSectionType_FrameCapture && loadData)
           {
             sect->data.resize(sectionHeader.sectionLength);
             FileIO::fread(&sect->data[0], 1, sectionHeader.sectionLength, m_ReadFileHandle);
@@ -918,6 +2248,8 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode, uint64_t siz
     m_BufferHead = m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
     m_ReadOffset = 0;
 
+    LoadChunkIndex();
+
     FileIO::fseek64(m_ReadFileHandle, m_KnownSections[eSectionType_FrameCapture]->fileoffset,
                     SEEK_SET);
 
@@ -956,6 +2288,7 @@ void Serialiser::Reset()
 
   m_DebugText = "";
   m_DebugTextWriting = false;
+  m_DebugTextExport = NULL;
 
   RDCEraseEl(m_KnownSections);
 
@@ -970,7 +2303,7 @@ void Serialiser::Reset()
   SAFE_DELETE(m_pResolver);
   if(m_Buffer)
   {
-    FreeAlignedBuffer(m_Buffer);
+    FreeWindow(m_Buffer);
     m_Buffer = NULL;
   }
 
@@ -985,6 +2318,12 @@ void Serialiser::Reset()
   m_BufferHead = m_Buffer = NULL;
   m_CurrentBufferSize = 0;
   m_BufferSize = 0;
+  m_ChunkEnd = 0;
+
+  m_DedupBuffers.clear();
+  m_DedupChunk = NoBufferDedup;
+  m_DedupCount = 0;
+  m_DedupBytes = 0;
 }
 
 Serialiser::~Serialiser()
@@ -997,16 +2336,17 @@ Serialiser::~Serialiser()
     m_ResolverThread = 0;
   }
 
-  if(m_ReadFileHandle)
+  // compressed readers may have prefetch threads reading from the file, so stop them first
+  for(size_t i = 0; i < m_Sections.size(); i++)
   {
-    FileIO::fclose(m_ReadFileHandle);
-    m_ReadFileHandle = 0;
+    SAFE_DELETE(m_Sections[i]->compressedReader);
+    SAFE_DELETE(m_Sections[i]);
   }
 
-  for(size_t i = 0; i < m_Sections.size(); i++)
+  if(m_ReadFileHandle)
   {
-    SAFE_DELETE(m_Sections[i]->compressedReader);
-    SAFE_DELETE(m_Sections[i]);
+    FileIO::fclose(m_ReadFileHandle);
+    m_ReadFileHandle = 0;
   }
 
   for(size_t i = 0; i < m_Chunks.size(); i++)
@@ -1021,7 +2361,7 @@ Serialiser::~Serialiser()
   SAFE_DELETE(m_pCallstack);
   if(m_Buffer)
   {
-    FreeAlignedBuffer(m_Buffer);
+    FreeWindow(m_Buffer);
     m_Buffer = NULL;
   }
   m_Buffer = NULL;
@@ -1111,7 +2451,7 @@ void *Serialiser::ReadBytes(size_t nBytes)
                                          size_t(m_BufferSize - m_ReadOffset - currentDataSize)));
 
     if(oldBuffer != m_Buffer)
-      FreeAlignedBuffer(oldBuffer);
+      FreeWindow(oldBuffer);
   }
 
   void *ret = m_BufferHead;
@@ -1134,7 +2474,7 @@ void Serialiser::ReadFromFile(uint64_t bufferOffs, size_t length)
 
   RDCASSERT(s);
 
-  if(s->flags & eSectionFlag_LZ4Compressed)
+  if(s->IsCompressed())
   {
     RDCASSERT(s->compressedReader);
     s->compressedReader->Read(m_Buffer + bufferOffs, length);
@@ -1186,8 +2526,357 @@ void Serialiser::FreeAlignedBuffer(byte *buf)
   delete[] rawAlloc;
 }
 
+void Serialiser::SetThumbnail(uint32_t width, uint32_t height, const byte *jpg, size_t length)
+{
+  if(jpg == NULL)
+    width = height = 0;
+
+  m_ThumbnailSection.clear();
+  m_ThumbnailSection.insert(m_ThumbnailSection.end(), (byte *)&width, (byte *)(&width + 1));
+  m_ThumbnailSection.insert(m_ThumbnailSection.end(), (byte *)&height, (byte *)(&height + 1));
+
+  if(jpg && length > 0)
+    m_ThumbnailSection.insert(m_ThumbnailSection.end(), jpg, jpg + length);
+}
+
+void Serialiser::GetThumbnail(vector<byte> &jpg) const
+{
+  const size_t headerSize = sizeof(uint32_t) * 2;
+
+  jpg.clear();
+
+  if(m_ThumbnailSection.size() > headerSize)
+    jpg.assign(m_ThumbnailSection.begin() + headerSize, m_ThumbnailSection.end());
+}
+
+bool Serialiser::ReadThumbnail(const char *path, uint32_t &width, uint32_t &height,
+                               vector<byte> &jpg)
+{
+  FILE *f = FileIO::fopen(path, "rb");
+
+  if(f == NULL)
+    return false;
+
+  bool found = false;
+
+  FileHeader header;
+  header.magic = 0;
+
+  if(FileIO::fread(&header, 1, sizeof(FileHeader), f) == sizeof(FileHeader) &&
+     header.magic == MAGIC_HEADER && header.version == SERIALISE_VERSION)
+  {
+    const size_t headerSize = offsetof(BinarySectionHeader, name);
+
+    while(!found)
+    {
+      BinarySectionHeader sectionHeader = {0};
+
+      if(FileIO::fread(&sectionHeader, 1, headerSize, f) != headerSize)
+        break;
+
+      // ASCII sections have to be parsed a byte at a time to find their length, leave those to the
+      // full reader. They're only ever appended by hand, after the thumbnail.
+      if(sectionHeader.isASCII != 0)
+        break;
+
+      FileIO::fseek64(f, sectionHeader.sectionNameLength, SEEK_CUR);
+
+      uint64_t length = sectionHeader.sectionLength;
+
+      // compressed sections have their uncompressed size before the data
+      if(sectionHeader.sectionFlags & (eSectionFlag_LZ4Compressed | eSectionFlag_DeflateCompressed))
+        length += sizeof(uint64_t);
+
+      if(sectionHeader.sectionType == eSectionType_Thumbnail &&
+         sectionHeader.sectionFlags == eSectionFlag_None && length >= sizeof(uint32_t) * 2)
+      {
+        FileIO::fread(&width, 1, sizeof(width), f);
+        FileIO::fread(&height, 1, sizeof(height), f);
+
+        jpg.resize((size_t)length - sizeof(uint32_t) * 2);
+        found = jpg.empty() || FileIO::fread(&jpg[0], 1, jpg.size(), f) == jpg.size();
+
+        if(jpg.empty() || width == 0 || height == 0)
+        {
+          jpg.clear();
+          width = height = 0;
+        }
+
+        break;
+      }
+
+      FileIO::fseek64(f, length, SEEK_CUR);
+    }
+  }
+
+  FileIO::fclose(f);
+
+  return found;
+}
+
+bool Serialiser::AppendSection(const char *path, SectionType type, const char *name,
+                               const byte *data, size_t length)
+{
+  FILE *f = FileIO::fopen(path, "r+b");
+
+  if(f == NULL)
+  {
+    RDCWARN("Couldn't open '%s' to append section '%s'", path, name);
+    return false;
+  }
+
+  FileHeader header;
+  header.magic = 0;
+  FileIO::fread(&header, 1, sizeof(FileHeader), f);
+
+  if(header.magic != MAGIC_HEADER || header.version != SERIALISE_VERSION)
+  {
+    RDCWARN("Can't append section '%s' to '%s', not a current capture file", name, path);
+    FileIO::fclose(f);
+    return false;
+  }
+
+  FileIO::fseek64(f, 0, SEEK_END);
+
+  BinarySectionHeader section = {0};
+  section.isASCII = 0;    // redundant but explicit
+  section.sectionNameLength = uint32_t(strlen(name) + 1);    // includes null terminator
+  section.sectionType = type;
+  section.sectionFlags = eSectionFlag_None;
+  section.sectionLength = uint32_t(length);
+
+  FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), f);
+  FileIO::fwrite(name, 1, section.sectionNameLength, f);
+  size_t written = length > 0 ? FileIO::fwrite(data, 1, length, f) : 0;
+
+  FileIO::fclose(f);
+
+  return written == length;
+}
+
+void Serialiser::LoadChunkIndex()
+{
+  Section *s = m_KnownSections[eSectionType_ChunkIndex];
+
+  m_ChunkIndex.clear();
+  m_ChunkIndexByType.clear();
+
+  if(s == NULL || s->data.size() < sizeof(uint32_t))
+    return;
+
+  uint32_t numEntries = 0;
+  memcpy(&numEntries, &s->data[0], sizeof(uint32_t));
+
+  if(s->data.size() != sizeof(uint32_t) + numEntries * sizeof(ChunkIndexEntry))
+  {
+    RDCWARN("Chunk index is corrupt, expected %u entries in %llu bytes. Ignoring", numEntries,
+            (uint64_t)s->data.size());
+    return;
+  }
+
+  m_ChunkIndex.resize(numEntries);
+  if(numEntries > 0)
+    memcpy(&m_ChunkIndex[0], &s->data[sizeof(uint32_t)], numEntries * sizeof(ChunkIndexEntry));
+
+  // don't need the raw data now
+  s->data.clear();
+
+  // sanity check that the offsets are sorted and in range, so lookups can binary search
+  for(size_t i = 0; i < m_ChunkIndex.size(); i++)
+  {
+    if(m_ChunkIndex[i].offset >= m_BufferSize ||
+       (i > 0 && m_ChunkIndex[i].offset <= m_ChunkIndex[i - 1].offset))
+    {
+      RDCWARN("Chunk index entry %u is invalid. Ignoring index", (uint32_t)i);
+      m_ChunkIndex.clear();
+      return;
+    }
+  }
+}
+
+bool Serialiser::CanUseChunkIndex()
+{
+  // we need to be able to jump anywhere, either because all the data is in memory or because we can
+  // seek the window to it
+  return !m_ChunkIndex.empty() && m_Mode == READING && (m_ReadFileHandle == NULL || IsSeekable());
+}
+
+bool Serialiser::SeekToChunk(uint32_t chunkNumber)
+{
+  if(!CanUseChunkIndex() || chunkNumber >= m_ChunkIndex.size())
+    return false;
+
+  SetOffset(m_ChunkIndex[chunkNumber].offset);
+  return true;
+}
+
+void Serialiser::SkipToChunk(uint32_t chunkIdx, uint32_t *idx)
+{
+  if(CanUseChunkIndex())
+  {
+    uint64_t offs = GetOffset();
+
+    if(m_ChunkIndexByType.empty())
+    {
+      for(size_t i = 0; i < m_ChunkIndex.size(); i++)
+        m_ChunkIndexByType[m_ChunkIndex[i].chunkType].push_back((uint32_t)i);
+    }
+
+    // find the first chunk at or after our current position. We might be sitting on padding
+    // before it.
+    uint32_t cur = 0;
+    {
+      size_t lo = 0, hi = m_ChunkIndex.size();
+      while(lo < hi)
+      {
+        size_t mid = (lo + hi) / 2;
+        if(m_ChunkIndex[mid].offset < offs)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      cur = (uint32_t)lo;
+    }
+
+    // then the first chunk of the right type at or after that
+    uint32_t found = (uint32_t)m_ChunkIndex.size();
+
+    auto it = m_ChunkIndexByType.find(chunkIdx);
+    if(it != m_ChunkIndexByType.end())
+    {
+      const vector<uint32_t> &entries = it->second;
+      auto e = std::lower_bound(entries.begin(), entries.end(), cur);
+      if(e != entries.end())
+        found = *e;
+    }
+
+    if(idx)
+      (*idx) += found - cur;
+
+    // if it wasn't found, put us at the end just as the linear search below would
+    SetOffset(found < m_ChunkIndex.size() ? m_ChunkIndex[found].offset : m_BufferSize);
+    return;
+  }
+
+  do
+  {
+    size_t offs = m_BufferHead - m_Buffer + (size_t)m_ReadOffset;
+
+    uint32_t c = PushContext(NULL, NULL, 1, false);
+
+    // found
+    if(c == chunkIdx)
+    {
+      m_Indent--;
+      m_BufferHead = (m_Buffer + offs) - (size_t)m_ReadOffset;
+      return;
+    }
+    else
+    {
+      SkipCurrentChunk();
+      PopContext(1);
+    }
+
+    if(idx)
+      (*idx)++;
+
+  } while(!AtEnd());
+}
+
+bool Serialiser::IsSeekable()
+{
+  Section *s = m_KnownSections[eSectionType_FrameCapture];
+
+  if(m_ReadFileHandle == NULL || s == NULL)
+    return false;
+
+  // uncompressed data can be read from anywhere with a plain seek
+  if(!s->IsCompressed())
+    return true;
+
+  return s->compressedReader && s->compressedReader->IsSeekable();
+}
+
+void Serialiser::SeekWindow(uint64_t offs)
+{
+  Section *s = m_KnownSections[eSectionType_FrameCapture];
+
+  RDCASSERT(s && IsSeekable());
+
+  if(s->IsCompressed())
+    s->compressedReader->Seek(offs);
+  else
+    FileIO::fseek64(m_ReadFileHandle, s->fileoffset + offs, SEEK_SET);
+
+  // drop back to the default window size, in case it was expanded to fit a large element
+  size_t windowSize = (size_t)RDCMIN(m_BufferSize, (uint64_t)64 * 1024);
+
+  if(windowSize != m_CurrentBufferSize)
+  {
+    FreeWindow(m_Buffer);
+    m_CurrentBufferSize = windowSize;
+    m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
+  }
+
+  m_BufferHead = m_Buffer;
+  m_ReadOffset = offs;
+
+  ReadFromFile(0, (size_t)RDCMIN((uint64_t)m_CurrentBufferSize, m_BufferSize - offs));
+}
+
+void Serialiser::FreeWindow(byte *buf)
+{
+  if(m_MappedView)
+  {
+    FileIO::UnmapFileRange(m_MappedView);
+    m_MappedView = NULL;
+  }
+  else
+  {
+    FreeAlignedBuffer(buf);
+  }
+}
+
 void Serialiser::SetPersistentBlock(uint64_t offs)
 {
+  Section *s = m_KnownSections[eSectionType_FrameCapture];
+
+  RDCASSERT(s);
+
+  // if the blocks are independent, we don't need to read everything in. Just keep the file open
+  // and page data in as it's touched. SetOffset will move the window around as needed, and we
+  // cache the decompressed blocks from here on up to a budget.
+  if(s && s->IsCompressed() && IsSeekable())
+  {
+    s->compressedReader->EnableBlockCache(offs);
+    return;
+  }
+
+  // for uncompressed data, map the whole section and let the OS page it in on demand
+  if(s && !s->IsCompressed() && m_ReadFileHandle)
+  {
+    void *mapping = NULL;
+    byte *mapped =
+        (byte *)FileIO::MapFileRange(m_ReadFileHandle, s->fileoffset, m_BufferSize, &mapping);
+
+    if(mapped)
+    {
+      uint64_t prevOffs = uint64_t(m_BufferHead - m_Buffer) + m_ReadOffset;
+
+      FreeWindow(m_Buffer);
+
+      m_MappedView = mapping;
+      m_Buffer = mapped;
+      m_CurrentBufferSize = (size_t)m_BufferSize;
+      m_ReadOffset = 0;
+      m_BufferHead = m_Buffer + prevOffs;
+
+      FileIO::fclose(m_ReadFileHandle);
+      m_ReadFileHandle = 0;
+      return;
+    }
+  }
+
   // as long as this is called immediately after pushing the chunk context at the
   // offset, we will always have the start in memory, as we keep 64 bytes of
   // a backwards window even if we had to shift the currently in-memory bytes
@@ -1215,7 +2904,7 @@ void Serialiser::SetPersistentBlock(uint64_t offs)
 
   memcpy(newBuf, persistentBase, persistentInMemory);
 
-  FreeAlignedBuffer(m_Buffer);
+  FreeWindow(m_Buffer);
 
   m_CurrentBufferSize = persistentSize;
   m_Buffer = newBuf;
@@ -1245,48 +2934,167 @@ void Serialiser::SetOffset(uint64_t offs)
     return;
   }
 
+  // if we can seek, jump the window to wherever we're going if it's not already in memory
+  if(m_Mode == READING && (offs < m_ReadOffset || offs > m_ReadOffset + m_CurrentBufferSize) &&
+     IsSeekable())
+  {
+    SeekWindow(offs);
+  }
   // if we're jumping back before our in-memory window just reset the window
   // and load it all in from scratch.
-  if(m_Mode == READING && offs < m_ReadOffset)
+  else if(m_Mode == READING && offs < m_ReadOffset)
+  {
+    // if we're reading from file, only support rewinding all the way to the start
+    RDCASSERT(m_ReadFileHandle == NULL || offs == 0);
+
+    if(m_ReadFileHandle)
+    {
+      Section *s = m_KnownSections[eSectionType_FrameCapture];
+      RDCASSERT(s);
+      FileIO::fseek64(m_ReadFileHandle, s->fileoffset, SEEK_SET);
+
+      if(s->IsCompressed())
+      {
+        RDCASSERT(s->compressedReader);
+        s->compressedReader->Reset();
+      }
+    }
+
+    FreeWindow(m_Buffer);
+
+    m_CurrentBufferSize = (size_t)RDCMIN(m_BufferSize, (uint64_t)64 * 1024);
+    m_BufferHead = m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
+    m_ReadOffset = offs;
+
+    ReadFromFile(0, m_CurrentBufferSize);
+  }
+
+  RDCASSERT(m_BufferHead && m_Buffer && offs <= GetSize());
+  m_BufferHead = m_Buffer + offs - m_ReadOffset;
+  m_Indent = 0;
+}
+
+void Serialiser::InitCallstackResolver()
+{
+  if(m_pResolver == NULL && m_ResolverThread == 0 &&
+     m_KnownSections[eSectionType_ResolveDatabase] != NULL)
+  {
+    m_ResolverThreadKillSignal = false;
+    m_ResolverThread = Threading::CreateThread(&Serialiser::CreateResolver, (void *)this);
+  }
+}
+
+void Serialiser::LoadCallstackTable()
+{
+  if(m_CallstackTableLoaded)
+    return;
+
+  m_CallstackTableLoaded = true;
+
+  const vector<byte> *contents = GetSectionContents(eSectionType_CallstackTable);
+
+  if(contents == NULL)
+  {
+    RDCERR("Chunk refers to callstack table, but capture has none");
+    return;
+  }
+
+  const byte *data = &(*contents)[0];
+  size_t size = contents->size();
+
+  uint32_t numStacks = 0;
+
+  if(size >= sizeof(numStacks))
+    memcpy(&numStacks, data, sizeof(numStacks));
+
+  size_t offsetsSize = sizeof(uint32_t) * (size_t(numStacks) + 1);
+
+  if(size < sizeof(numStacks) + offsetsSize)
+  {
+    RDCERR("Callstack table is corrupt");
+    return;
+  }
+
+  data += sizeof(numStacks);
+
+  vector<uint32_t> offsets(numStacks + 1);
+  memcpy(&offsets[0], data, offsetsSize);
+  data += offsetsSize;
+
+  size_t numAddrs = (size - sizeof(numStacks) - offsetsSize) / sizeof(uint64_t);
+
+  // offsets must be increasing and stay within the addresses that are there
+  for(uint32_t i = 0; i < numStacks; i++)
+  {
+    if(offsets[i] > offsets[i + 1] || offsets[i + 1] > numAddrs)
+    {
+      RDCERR("Callstack table is corrupt");
+      return;
+    }
+  }
+
+  // always have at least one element, so stacks can be indexed even if they're all empty
+  m_CallstackTableAddrs.resize(RDCMAX((size_t)1, numAddrs));
+  if(numAddrs > 0)
+    memcpy(&m_CallstackTableAddrs[0], data, numAddrs * sizeof(uint64_t));
+
+  m_CallstackTableOffsets.swap(offsets);
+}
+
+void Serialiser::LoadStringTable()
+{
+  if(m_StringTableLoaded)
+    return;
+
+  m_StringTableLoaded = true;
+
+  const vector<byte> *contents = GetSectionContents(eSectionType_StringTable);
+
+  // in-memory serialisers reading chunks recorded by this process have no sections, but the strings
+  // are all in the process's own table.
+  if(contents == NULL)
+  {
+    SCOPED_LOCK(stringTable.lock);
+    m_StringTable = stringTable.strings;
+    return;
+  }
+
+  const byte *data = &(*contents)[0];
+  const byte *end = data + contents->size();
+
+  uint32_t numStrings = 0;
+
+  if(end - data >= (ptrdiff_t)sizeof(numStrings))
+    memcpy(&numStrings, data, sizeof(numStrings));
+  data += sizeof(numStrings);
+
+  vector<string> strings;
+  strings.reserve(RDCMIN((size_t)numStrings, StringTable::MaxStrings));
+
+  for(uint32_t i = 0; i < numStrings; i++)
   {
-    // if we're reading from file, only support rewinding all the way to the start
-    RDCASSERT(m_ReadFileHandle == NULL || offs == 0);
+    uint32_t len = 0;
 
-    if(m_ReadFileHandle)
+    if(end - data < (ptrdiff_t)sizeof(len))
     {
-      Section *s = m_KnownSections[eSectionType_FrameCapture];
-      RDCASSERT(s);
-      FileIO::fseek64(m_ReadFileHandle, s->fileoffset, SEEK_SET);
-
-      if(s->flags & eSectionFlag_LZ4Compressed)
-      {
-        RDCASSERT(s->compressedReader);
-        s->compressedReader->Reset();
-      }
+      RDCERR("String table is corrupt");
+      return;
     }
 
-    FreeAlignedBuffer(m_Buffer);
+    memcpy(&len, data, sizeof(len));
+    data += sizeof(len);
 
-    m_CurrentBufferSize = (size_t)RDCMIN(m_BufferSize, (uint64_t)64 * 1024);
-    m_BufferHead = m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
-    m_ReadOffset = offs;
+    if(end - data < (ptrdiff_t)len)
+    {
+      RDCERR("String table is corrupt");
+      return;
+    }
 
-    ReadFromFile(0, m_CurrentBufferSize);
+    strings.push_back(string((const char *)data, (const char *)data + len));
+    data += len;
   }
 
-  RDCASSERT(m_BufferHead && m_Buffer && offs <= GetSize());
-  m_BufferHead = m_Buffer + offs - m_ReadOffset;
-  m_Indent = 0;
-}
-
-void Serialiser::InitCallstackResolver()
-{
-  if(m_pResolver == NULL && m_ResolverThread == 0 &&
-     m_KnownSections[eSectionType_ResolveDatabase] != NULL)
-  {
-    m_ResolverThreadKillSignal = false;
-    m_ResolverThread = Threading::CreateThread(&Serialiser::CreateResolver, (void *)this);
-  }
+  m_StringTable.swap(strings);
 }
 
 void Serialiser::SetCallstack(uint64_t *levels, size_t numLevels)
@@ -1306,7 +3114,50 @@ void Serialiser::CreateResolver(void *ths)
   Section *s = ser->m_KnownSections[Serialiser::eSectionType_ResolveDatabase];
   RDCASSERT(s);
 
-  ser->m_pResolver = Callstack::MakeResolver((char *)&s->data[0], s->data.size(), dir,
+  // the main thread may be reading the frame capture through m_ReadFileHandle, so read the
+  // database from our own handle.
+  vector<byte> db;
+
+  if(s->data.empty())
+  {
+    FILE *f = FileIO::fopen(ser->m_Filename.c_str(), "rb");
+
+    if(!f)
+    {
+      RDCERR("Can't open capture file '%s' to read resolve database", ser->m_Filename.c_str());
+      return;
+    }
+
+    db.resize((size_t)s->size);
+
+    FileIO::fseek64(f, s->fileoffset, SEEK_SET);
+
+    if(s->IsCompressed())
+    {
+      CompressedFileIO reader(f, (s->flags & eSectionFlag_DeflateCompressed) != 0);
+
+      if(s->flags & eSectionFlag_BlockDirectory)
+        reader.ReadBlockDirectory(s->compressedSize);
+
+      if(!db.empty())
+        reader.Read(&db[0], db.size());
+    }
+    else if(!db.empty())
+    {
+      db.resize(FileIO::fread(&db[0], 1, db.size(), f));
+    }
+
+    FileIO::fclose(f);
+  }
+  else
+  {
+    db.swap(s->data);
+  }
+
+  if(db.empty() || ser->m_ResolverThreadKillSignal)
+    return;
+
+  ser->m_pResolver = Callstack::MakeResolver((char *)&db[0], db.size(), dir,
                                              &ser->m_ResolverThreadKillSignal);
 }
 
@@ -1376,7 +3227,9 @@ void Serialiser::FlushToDisk()
       section.isASCII = 0;                                // redundant but explicit
       section.sectionNameLength = sizeof(sectionName);    // includes null terminator
       section.sectionType = eSectionType_FrameCapture;
-      section.sectionFlags = eSectionFlag_LZ4Compressed;
+      section.sectionFlags = SectionFlags(eSectionFlag_LZ4Compressed |
+                                          eSectionFlag_IndependentBlocks |
+                                          eSectionFlag_BlockDirectory);
       section.sectionLength =
           0;    // will be fixed up later, to avoid having to compress everything into memory
 
@@ -1390,13 +3243,18 @@ void Serialiser::FlushToDisk()
       FileIO::fwrite(&len, 1, sizeof(uint64_t), binFile);
     }
 
-    CompressedFileIO fwriter(binFile);
+    ParallelCompressedFileIO fwriter(binFile);
 
     // track offset so we can add padding. The padding is relative
     // to the start of the decompressed buffer, so we start it from 0
     uint64_t offs = 0;
     uint64_t alignedoffs = 0;
 
+    vector<ChunkIndexEntry> chunkIndex;
+    chunkIndex.reserve(m_Chunks.size());
+
+    vector<byte> spillScratch;
+
     // write frame capture contents
     for(size_t i = 0; i < m_Chunks.size(); i++)
     {
@@ -1434,7 +3292,21 @@ void Serialiser::FlushToDisk()
         }
       }
 
-      fwriter.Write(chunk->GetData(), chunk->GetLength());
+      ChunkIndexEntry entry = {offs, chunk->GetChunkType(), chunk->GetLength()};
+      chunkIndex.push_back(entry);
+
+      if(chunk->IsSpilled())
+      {
+        // read spilled chunks through a scratch buffer so they don't all come back into memory
+        spillScratch.resize(chunk->GetLength());
+        if(!chunk->ReadSpilled(&spillScratch[0]))
+          memset(&spillScratch[0], 0, spillScratch.size());
+        fwriter.Write(&spillScratch[0], chunk->GetLength());
+      }
+      else
+      {
+        fwriter.Write(chunk->GetData(), chunk->GetLength());
+      }
 
       offs += chunk->GetLength();
 
@@ -1442,88 +3314,429 @@ void Serialiser::FlushToDisk()
         SAFE_DELETE(chunk);
     }
 
-    fwriter.Flush();
+    fwriter.Finish();
+
+    m_Chunks.clear();
+
+    // fixup section size
+    {
+      uint32_t compsize = 0;
+      uint64_t uncompsize = 0;
+
+      uint64_t curoffs = FileIO::ftell64(binFile);
+
+      FileIO::fseek64(binFile, compressedSizeOffset, SEEK_SET);
+
+      compsize = fwriter.GetCompressedSize();
+      FileIO::fwrite(&compsize, 1, sizeof(compsize), binFile);
+
+      FileIO::fseek64(binFile, uncompressedSizeOffset, SEEK_SET);
+
+      uncompsize = fwriter.GetUncompressedSize();
+      FileIO::fwrite(&uncompsize, 1, sizeof(uncompsize), binFile);
+
+      FileIO::fseek64(binFile, curoffs, SEEK_SET);
+
+      RDCLOG("Compressed frame capture data from %u to %u", fwriter.GetUncompressedSize(),
+             fwriter.GetCompressedSize());
+    }
+
+    // write the thumbnail section, straight after the frame capture so ReadThumbnail only has to
+    // skip one section to find it
+    if(!m_ThumbnailSection.empty())
+    {
+      const char sectionName[] = "renderdoc/internal/thumbnail";
+
+      BinarySectionHeader section = {0};
+      section.isASCII = 0;                                // redundant but explicit
+      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+      section.sectionType = eSectionType_Thumbnail;
+      section.sectionFlags = eSectionFlag_None;
+      section.sectionLength = (uint32_t)m_ThumbnailSection.size();
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+      FileIO::fwrite(&m_ThumbnailSection[0], 1, m_ThumbnailSection.size(), binFile);
+    }
+
+    // write the table of unique callstacks, if any chunks were recorded that refer to it
+    {
+      vector<uint32_t> offsets;
+      vector<uint64_t> addrs;
+
+      {
+        SCOPED_LOCK(callstackTable.lock);
+        offsets = callstackTable.offsets;
+        addrs = callstackTable.addrs;
+      }
+
+      if(!offsets.empty())
+      {
+        const char sectionName[] = "renderdoc/internal/callstacktable";
+
+        uint32_t numStacks = uint32_t(offsets.size() - 1);
+
+        BinarySectionHeader section = {0};
+        section.isASCII = 0;                                // redundant but explicit
+        section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+        section.sectionType = eSectionType_CallstackTable;
+        section.sectionFlags = eSectionFlag_None;
+        section.sectionLength = uint32_t(sizeof(numStacks) + sizeof(uint32_t) * offsets.size() +
+                                         sizeof(uint64_t) * addrs.size());
+
+        FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+        FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+        FileIO::fwrite(&numStacks, 1, sizeof(numStacks), binFile);
+        FileIO::fwrite(&offsets[0], sizeof(uint32_t), offsets.size(), binFile);
+        if(!addrs.empty())
+          FileIO::fwrite(&addrs[0], sizeof(uint64_t), addrs.size(), binFile);
+      }
+    }
+
+    // write the table of interned strings, if any chunks were recorded that refer to it
+    {
+      vector<string> strings;
+
+      {
+        SCOPED_LOCK(stringTable.lock);
+        strings = stringTable.strings;
+      }
+
+      if(!strings.empty())
+      {
+        const char sectionName[] = "renderdoc/internal/stringtable";
+
+        uint32_t numStrings = (uint32_t)strings.size();
+
+        size_t length = sizeof(numStrings);
+        for(size_t i = 0; i < strings.size(); i++)
+          length += sizeof(uint32_t) + strings[i].size();
+
+        BinarySectionHeader section = {0};
+        section.isASCII = 0;                                // redundant but explicit
+        section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+        section.sectionType = eSectionType_StringTable;
+        section.sectionFlags = eSectionFlag_None;
+        section.sectionLength = (uint32_t)length;
+
+        FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+        FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+        FileIO::fwrite(&numStrings, 1, sizeof(numStrings), binFile);
+        for(size_t i = 0; i < strings.size(); i++)
+        {
+          uint32_t len = (uint32_t)strings[i].size();
+          FileIO::fwrite(&len, 1, sizeof(len), binFile);
+          if(len > 0)
+            FileIO::fwrite(strings[i].c_str(), 1, len, binFile);
+        }
+      }
+    }
+
+    // write chunk index section
+    {
+      const char sectionName[] = "renderdoc/internal/chunkindex";
+
+      uint32_t numEntries = (uint32_t)chunkIndex.size();
+
+      BinarySectionHeader section = {0};
+      section.isASCII = 0;                                // redundant but explicit
+      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+      section.sectionType = eSectionType_ChunkIndex;
+      section.sectionFlags = eSectionFlag_None;
+      section.sectionLength = uint32_t(sizeof(numEntries) + sizeof(ChunkIndexEntry) * numEntries);
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+      FileIO::fwrite(&numEntries, 1, sizeof(numEntries), binFile);
+      if(numEntries > 0)
+        FileIO::fwrite(&chunkIndex[0], sizeof(ChunkIndexEntry), numEntries, binFile);
+    }
+
+    char *symbolDB = NULL;
+    size_t symbolDBSize = 0;
+
+    if(RenderDoc::Inst().GetCaptureOptions().CaptureCallstacks ||
+       RenderDoc::Inst().GetCaptureOptions().CaptureCallstacksOnlyDraws)
+    {
+      // get symbol database
+      Callstack::GetLoadedModules(symbolDB, symbolDBSize);
+
+      symbolDB = new char[symbolDBSize];
+      symbolDBSize = 0;
+
+      Callstack::GetLoadedModules(symbolDB, symbolDBSize);
+    }
+
+    // write symbol database section. It's compressed the same way as the frame capture, and
+    // isn't read back until a callstack is first resolved, see CreateResolver
+    if(symbolDB)
+    {
+      const char sectionName[] = "renderdoc/internal/resolvedb";
+
+      BinarySectionHeader section = {0};
+      section.isASCII = 0;                                // redundant but explicit
+      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+      section.sectionType = eSectionType_ResolveDatabase;
+      section.sectionFlags = SectionFlags(eSectionFlag_LZ4Compressed |
+                                          eSectionFlag_IndependentBlocks |
+                                          eSectionFlag_BlockDirectory);
+      section.sectionLength = 0;    // will be fixed up once the data is compressed
+
+      uint64_t dbSizeOffset =
+          FileIO::ftell64(binFile) + offsetof(BinarySectionHeader, sectionLength);
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+
+      uint64_t len = symbolDBSize;
+      FileIO::fwrite(&len, 1, sizeof(uint64_t), binFile);
+
+      ParallelCompressedFileIO fwriter(binFile);
+      fwriter.Write(symbolDB, symbolDBSize);
+      fwriter.Finish();
+
+      uint64_t curoffs = FileIO::ftell64(binFile);
+
+      uint32_t compsize = fwriter.GetCompressedSize();
+      FileIO::fseek64(binFile, dbSizeOffset, SEEK_SET);
+      FileIO::fwrite(&compsize, 1, sizeof(compsize), binFile);
+
+      FileIO::fseek64(binFile, curoffs, SEEK_SET);
+
+      RDCDEBUG("Compressed resolve database from %llu to %u", len, compsize);
+
+      SAFE_DELETE_ARRAY(symbolDB);
+    }
+
+    // write the machine identifier as an ASCII section
+    {
+      const char sectionName[] = "renderdoc/internal/machineid";
+
+      uint64_t machineID = OSUtility::GetMachineIdent();
+
+      BinarySectionHeader section = {0};
+      section.isASCII = 0;                                // redundant but explicit
+      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
+      section.sectionType = eSectionType_MachineID;
+      section.sectionFlags = eSectionFlag_None;
+      section.sectionLength = sizeof(machineID);
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+      FileIO::fwrite(&machineID, 1, sizeof(machineID), binFile);
+    }
+
+    FileIO::fclose(binFile);
+  }
+}
+
+bool Serialiser::WriteRecompressed(const char *path, SectionFlags codec)
+{
+  Section *frameCap = m_KnownSections[eSectionType_FrameCapture];
+
+  if(m_Mode != READING || m_HasError || m_ReadFileHandle == NULL || frameCap == NULL)
+  {
+    RDCERR("Can only recompress a capture that's been opened from a file for reading");
+    return false;
+  }
+
+  if(codec != eSectionFlag_LZ4Compressed && codec != eSectionFlag_DeflateCompressed)
+  {
+    RDCERR("Unsupported compression codec %x", codec);
+    return false;
+  }
+
+  FILE *binFile = FileIO::fopen(path, "w+b");
+
+  if(!binFile)
+  {
+    RDCERR("Can't open capture file '%s' for write, errno %d", path, errno);
+    return false;
+  }
+
+  FileHeader header;    // automagically initialised with correct data
+
+  FileIO::fwrite(&header, 1, sizeof(FileHeader), binFile);
+
+  // large enough for a compressed block, and used for copying uncompressed data in pieces
+  const size_t copySize = CompressedFileIO::BlockSize;
+  byte *copyBuf = new byte[copySize];
+
+  for(size_t i = 0; i < m_Sections.size(); i++)
+  {
+    Section *s = m_Sections[i];
+
+    // ASCII stored sections are written back out as binary, the contents are identical
+    BinarySectionHeader section = {0};
+    section.isASCII = 0;
+    section.sectionNameLength = uint32_t(s->name.length() + 1);    // includes null terminator
+    section.sectionType = s->type;
+    section.sectionFlags = eSectionFlag_None;
+    section.sectionLength = (uint32_t)s->size;
+
+    // compressed sections are recompressed with the new codec, as is an uncompressed frame capture
+    if(s == frameCap || s->IsCompressed())
+    {
+      section.sectionFlags =
+          SectionFlags(codec | eSectionFlag_IndependentBlocks | eSectionFlag_BlockDirectory);
+      section.sectionLength = 0;    // fixed up once the data is compressed
+
+      uint64_t compressedSizeOffset =
+          FileIO::ftell64(binFile) + offsetof(BinarySectionHeader, sectionLength);
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(s->name.c_str(), 1, section.sectionNameLength, binFile);
+
+      uint64_t uncompsize = s->size;
+      FileIO::fwrite(&uncompsize, 1, sizeof(uncompsize), binFile);
+
+      ParallelCompressedFileIO fwriter(binFile, codec == eSectionFlag_DeflateCompressed);
+
+      // the compressed reader seeks itself from here, whichever format it is
+      FileIO::fseek64(m_ReadFileHandle, s->fileoffset, SEEK_SET);
+      if(s->compressedReader)
+        s->compressedReader->Reset();
+
+      for(uint64_t offs = 0; offs < s->size;)
+      {
+        size_t len = (size_t)RDCMIN(s->size - offs, (uint64_t)copySize);
+
+        if(s->compressedReader)
+          s->compressedReader->Read(copyBuf, len);
+        else
+          FileIO::fread(copyBuf, 1, len, m_ReadFileHandle);
+
+        fwriter.Write(copyBuf, len);
+        offs += len;
+      }
+
+      fwriter.Finish();
+
+      uint64_t curoffs = FileIO::ftell64(binFile);
+
+      uint32_t compsize = fwriter.GetCompressedSize();
+      FileIO::fseek64(binFile, compressedSizeOffset, SEEK_SET);
+      FileIO::fwrite(&compsize, 1, sizeof(compsize), binFile);
+
+      FileIO::fseek64(binFile, curoffs, SEEK_SET);
+
+      RDCLOG("Recompressed '%s' from %llu to %u", s->name.c_str(), s->size, compsize);
+
+      continue;
+    }
+
+    // the chunk index data is discarded once it's loaded, so write it back from the index
+    if(s->type == eSectionType_ChunkIndex && s->data.empty())
+    {
+      uint32_t numEntries = (uint32_t)m_ChunkIndex.size();
+
+      section.sectionLength = uint32_t(sizeof(numEntries) + sizeof(ChunkIndexEntry) * numEntries);
+
+      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+      FileIO::fwrite(s->name.c_str(), 1, section.sectionNameLength, binFile);
+      FileIO::fwrite(&numEntries, 1, sizeof(numEntries), binFile);
+      if(numEntries > 0)
+        FileIO::fwrite(&m_ChunkIndex[0], sizeof(ChunkIndexEntry), numEntries, binFile);
+
+      continue;
+    }
+
+    FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
+    FileIO::fwrite(s->name.c_str(), 1, section.sectionNameLength, binFile);
+
+    if(!s->data.empty())
+    {
+      FileIO::fwrite(&s->data[0], 1, s->data.size(), binFile);
+    }
+    else
+    {
+      // large sections aren't kept in memory, copy them straight from the source file
+      FileIO::fseek64(m_ReadFileHandle, s->fileoffset, SEEK_SET);
+
+      for(uint64_t offs = 0; offs < s->size;)
+      {
+        size_t len = (size_t)RDCMIN(s->size - offs, (uint64_t)copySize);
 
-    m_Chunks.clear();
+        FileIO::fread(copyBuf, 1, len, m_ReadFileHandle);
+        FileIO::fwrite(copyBuf, 1, len, binFile);
+        offs += len;
+      }
+    }
+  }
 
-    // fixup section size
-    {
-      uint32_t compsize = 0;
-      uint64_t uncompsize = 0;
+  SAFE_DELETE_ARRAY(copyBuf);
 
-      uint64_t curoffs = FileIO::ftell64(binFile);
+  FileIO::fclose(binFile);
 
-      FileIO::fseek64(binFile, compressedSizeOffset, SEEK_SET);
+  return true;
+}
 
-      compsize = fwriter.GetCompressedSize();
-      FileIO::fwrite(&compsize, 1, sizeof(compsize), binFile);
+double Serialiser::BenchmarkCompressedWrite(const char *path, SectionFlags codec, uint64_t size,
+                                            uint64_t &compressedSize)
+{
+  compressedSize = 0;
 
-      FileIO::fseek64(binFile, uncompressedSizeOffset, SEEK_SET);
+  if(codec != eSectionFlag_LZ4Compressed && codec != eSectionFlag_DeflateCompressed)
+  {
+    RDCERR("Unsupported compression codec %x", codec);
+    return -1.0;
+  }
 
-      uncompsize = fwriter.GetUncompressedSize();
-      FileIO::fwrite(&uncompsize, 1, sizeof(uncompsize), binFile);
+  const size_t blockSize = CompressedFileIO::BlockSize;
+  byte *block = new byte[blockSize];
 
-      FileIO::fseek64(binFile, curoffs, SEEK_SET);
+  // roughly what chunk data looks like - runs of small values and zeroes between stretches of
+  // incompressible data such as texture contents
+  uint32_t seed = 0x1234567;
+  for(size_t i = 0; i < blockSize; i++)
+  {
+    seed = seed * 1103515245 + 12345;
 
-      RDCLOG("Compressed frame capture data from %u to %u", fwriter.GetUncompressedSize(),
-             fwriter.GetCompressedSize());
-    }
+    if((i / 256) % 4 == 0)
+      block[i] = byte(seed >> 24);
+    else if((i / 256) % 4 == 1)
+      block[i] = 0;
+    else
+      block[i] = byte((seed >> 24) & 0x7);
+  }
 
-    char *symbolDB = NULL;
-    size_t symbolDBSize = 0;
+  FILE *binFile = FileIO::fopen(path, "w+b");
 
-    if(RenderDoc::Inst().GetCaptureOptions().CaptureCallstacks ||
-       RenderDoc::Inst().GetCaptureOptions().CaptureCallstacksOnlyDraws)
-    {
-      // get symbol database
-      Callstack::GetLoadedModules(symbolDB, symbolDBSize);
+  if(!binFile)
+  {
+    RDCERR("Can't open benchmark file '%s' for write, errno %d", path, errno);
+    SAFE_DELETE_ARRAY(block);
+    return -1.0;
+  }
 
-      symbolDB = new char[symbolDBSize];
-      symbolDBSize = 0;
+  PerformanceTimer timer;
 
-      Callstack::GetLoadedModules(symbolDB, symbolDBSize);
-    }
+  {
+    ParallelCompressedFileIO fwriter(binFile, codec == eSectionFlag_DeflateCompressed);
 
-    // write symbol database section
-    if(symbolDB)
+    for(uint64_t offs = 0; offs < size;)
     {
-      const char sectionName[] = "renderdoc/internal/resolvedb";
-
-      BinarySectionHeader section = {0};
-      section.isASCII = 0;                                // redundant but explicit
-      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
-      section.sectionType = eSectionType_ResolveDatabase;
-      section.sectionLength = (uint32_t)symbolDBSize;
-
-      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
-      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
+      size_t len = (size_t)RDCMIN(size - offs, (uint64_t)blockSize);
 
-      // write actual data
-      FileIO::fwrite(symbolDB, 1, symbolDBSize, binFile);
+      // vary each block a little so identical blocks can't be special-cased
+      memcpy(block, &offs, sizeof(offs));
 
-      SAFE_DELETE_ARRAY(symbolDB);
+      fwriter.Write(block, len);
+      offs += len;
     }
 
-    // write the machine identifier as an ASCII section
-    {
-      const char sectionName[] = "renderdoc/internal/machineid";
+    fwriter.Finish();
 
-      uint64_t machineID = OSUtility::GetMachineIdent();
+    compressedSize = fwriter.GetCompressedSize();
+  }
 
-      BinarySectionHeader section = {0};
-      section.isASCII = 0;                                // redundant but explicit
-      section.sectionNameLength = sizeof(sectionName);    // includes null terminator
-      section.sectionType = eSectionType_MachineID;
-      section.sectionFlags = eSectionFlag_None;
-      section.sectionLength = sizeof(machineID);
+  FileIO::fclose(binFile);
 
-      FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
-      FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
-      FileIO::fwrite(&machineID, 1, sizeof(machineID), binFile);
-    }
+  double ret = timer.GetMilliseconds();
 
-    FileIO::fclose(binFile);
-  }
+  SAFE_DELETE_ARRAY(block);
+
+  return ret;
 }
 
 void Serialiser::DebugPrint(const char *fmt, ...)
@@ -1589,11 +3802,23 @@ uint32_t Serialiser::PushContext(const char *name, const char *typeName, uint32_
       if(call)
       {
         uint8_t numLevels = call->NumLevels() & 0xff;
-        WriteFrom(numLevels);
 
-        if(call->NumLevels())
+        if(RenderDoc::Inst().GetCaptureOptions().DeduplicateCallstacks)
+        {
+          uint8_t marker = CallstackTableIndex;
+          uint32_t idx = AddToCallstackTable(call->GetAddrs(), numLevels);
+
+          WriteFrom(marker);
+          WriteFrom(idx);
+        }
+        else
         {
-          WriteBytes((byte *)call->GetAddrs(), sizeof(uint64_t) * numLevels);
+          WriteFrom(numLevels);
+
+          if(call->NumLevels())
+          {
+            WriteBytes((byte *)call->GetAddrs(), sizeof(uint64_t) * numLevels);
+          }
         }
 
         SAFE_DELETE(call);
@@ -1675,8 +3900,29 @@ uint32_t Serialiser::PushContext(const char *name, const char *typeName, uint32_
           uint8_t callLen = 0;
           ReadInto(callLen);
 
-          uint64_t *calls = (uint64_t *)ReadBytes(callLen * sizeof(uint64_t));
-          SetCallstack(calls, callLen);
+          if(callLen == CallstackTableIndex)
+          {
+            uint32_t idx = 0;
+            ReadInto(idx);
+
+            LoadCallstackTable();
+
+            if(idx + 1 < m_CallstackTableOffsets.size())
+            {
+              uint32_t offs = m_CallstackTableOffsets[idx];
+              SetCallstack(&m_CallstackTableAddrs[0] + offs,
+                           m_CallstackTableOffsets[idx + 1] - offs);
+            }
+            else
+            {
+              SetCallstack(NULL, 0);
+            }
+          }
+          else
+          {
+            uint64_t *calls = (uint64_t *)ReadBytes(callLen * sizeof(uint64_t));
+            SetCallstack(calls, callLen);
+          }
         }
         else
         {
@@ -1700,6 +3946,9 @@ uint32_t Serialiser::PushContext(const char *name, const char *typeName, uint32_
 
         m_LastChunkLen = chunkSize;
       }
+
+      if(m_Indent == 0)
+        m_ChunkEnd = GetOffset() + m_LastChunkLen;
     }
 
     if(!name && m_ChunkLookup)
@@ -1748,19 +3997,18 @@ void Serialiser::PopContext(uint32_t chunkIdx)
 
       uint32_t chunklen = (uint32_t)chunkLength;
 
-      byte *head = m_BufferHead;
-      SetOffset(chunkOffset);
+      // the placeholder was written when the context was pushed, so it's already in the buffer
+      // and can be patched directly.
       if(smallchunk)
       {
         uint16_t miniSize = (chunklen & 0xffff);
         RDCASSERT(chunklen <= 0xffff);
-        WriteFrom(miniSize);
+        memcpy(m_Buffer + chunkOffset, &miniSize, sizeof(miniSize));
       }
       else
       {
-        WriteFrom(chunklen);
+        memcpy(m_Buffer + chunkOffset, &chunklen, sizeof(chunklen));
       }
-      m_BufferHead = head;
     }
 
     if(m_DebugTextWriting)
@@ -1769,7 +4017,13 @@ void Serialiser::PopContext(uint32_t chunkIdx)
   else
   {
     if(m_DebugTextWriting)
+    {
       DebugPrint("}\n");
+
+      // the text is reset at the start of the next top-level chunk, so this is all of it
+      if(m_DebugTextExport && m_Indent == 0)
+        FileIO::fwrite(m_DebugText.c_str(), 1, m_DebugText.length(), m_DebugTextExport);
+    }
   }
 }
 
@@ -1814,6 +4068,68 @@ void Serialiser::SerialiseString(const char *name, string &el)
   }
 }
 
+void Serialiser::SerialiseInternedString(const char *name, string &el)
+{
+  if(m_Mode >= WRITING)
+  {
+    uint32_t idx = AddToStringTable(el);
+
+    if(idx == StringTableIndex)
+    {
+      SerialiseString(name, el);
+      return;
+    }
+
+    uint32_t marker = StringTableIndex;
+    Serialise(NULL, marker);
+    Serialise(NULL, idx);
+
+    if(m_DebugTextWriting)
+    {
+      string s = el;
+      if(s.length() > 64)
+        s = s.substr(0, 60) + "...";
+      DebugPrint("%s: \"%s\" (interned %u)\n", name, s.c_str(), idx);
+    }
+
+    return;
+  }
+
+  uint32_t len = 0;
+  Serialise(NULL, len);
+
+  if(len != StringTableIndex)
+  {
+    el.resize(len);
+    memcpy(&el[0], ReadBytes(len), len);
+  }
+  else
+  {
+    uint32_t idx = 0;
+    Serialise(NULL, idx);
+
+    LoadStringTable();
+
+    if(idx < m_StringTable.size())
+    {
+      el = m_StringTable[idx];
+    }
+    else
+    {
+      RDCERR("Interned string %u is out of range of the string table", idx);
+      el = "";
+    }
+  }
+
+  if(m_DebugTextWriting)
+  {
+    string s = el;
+    if(s.length() > 64)
+      s = s.substr(0, 60) + "...";
+    DebugPrint("%s: \"%s\"\n", name, s.c_str());
+  }
+}
+
 void Serialiser::Insert(Chunk *chunk)
 {
   m_Chunks.push_back(chunk);
@@ -1821,6 +4137,38 @@ void Serialiser::Insert(Chunk *chunk)
   m_DebugText += chunk->GetDebugString();
 }
 
+uint64_t Serialiser::GetInsertedChunkBytes()
+{
+  uint64_t ret = 0;
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+    ret += m_Chunks[i]->GetLength();
+  return ret;
+}
+
+void Serialiser::TakeChunkOwnership()
+{
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+  {
+    if(m_Chunks[i]->IsTemporary())
+      continue;
+
+    m_Chunks[i] = m_Chunks[i]->Duplicate();
+    m_Chunks[i]->m_Temporary = true;
+  }
+}
+
+uint64_t Serialiser::SpillOwnedChunks()
+{
+  uint64_t ret = 0;
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+  {
+    Chunk *chunk = m_Chunks[i];
+    if(chunk->IsTemporary() && !chunk->IsSpilled() && chunk->Spill())
+      ret += chunk->GetLength();
+  }
+  return ret;
+}
+
 void Serialiser::AlignNextBuffer(const size_t alignment)
 {
   // on new logs, we don't have to align. This code will be deleted once backwards-compat is dropped
@@ -1865,10 +4213,207 @@ void Serialiser::AlignNextBuffer(const size_t alignment)
   }
 }
 
+// MurmurHash3 x64 128-bit variant, by Austin Appleby (public domain). Used to spot duplicate
+// buffers, so it needs to be fast on large inputs and wide enough that collisions aren't a concern.
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+static void HashBuffer(const byte *data, size_t len, uint64_t hash[2])
+{
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+  uint64_t h1 = 0, h2 = 0;
+
+  const size_t nblocks = len / 16;
+
+  for(size_t i = 0; i < nblocks; i++)
+  {
+    uint64_t k1, k2;
+    memcpy(&k1, data + i * 16, sizeof(k1));
+    memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+    k1 *= c1;
+    k1 = rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+
+    h1 = rotl64(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2;
+    k2 = rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+
+    h2 = rotl64(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const byte *tail = data + nblocks * 16;
+  const size_t rem = len & 15;
+
+  uint64_t k1 = 0, k2 = 0;
+
+  for(size_t i = rem; i > 8; i--)
+    k2 |= uint64_t(tail[i - 1]) << ((i - 9) * 8);
+
+  for(size_t i = RDCMIN(rem, (size_t)8); i > 0; i--)
+    k1 |= uint64_t(tail[i - 1]) << ((i - 1) * 8);
+
+  if(rem > 8)
+  {
+    k2 *= c2;
+    k2 = rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+  }
+
+  if(rem > 0)
+  {
+    k1 *= c1;
+    k1 = rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  h1 ^= (uint64_t)len;
+  h2 ^= (uint64_t)len;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  hash[0] = h1;
+  hash[1] = h2;
+}
+
+void Serialiser::ResetBufferDedup()
+{
+  if(m_DedupCount > 0)
+    RDCLOG("De-duplicated %u buffers, saving %llu bytes", m_DedupCount, m_DedupBytes);
+
+  m_DedupBuffers.clear();
+  m_DedupChunk = NoBufferDedup;
+  m_DedupCount = 0;
+  m_DedupBytes = 0;
+}
+
+bool Serialiser::ReadDedupBuffer(byte *&buf, uint32_t &bufLen)
+{
+  BufferDedupLocation loc;
+  ReadInto(bufLen);
+  ReadInto(loc.chunkIndex);
+  ReadInto(loc.chunkOffset);
+
+  if(buf == NULL)
+    buf = new byte[bufLen];
+
+  // same requirement as any other jump through the chunk index, the data must either be entirely
+  // in memory or reachable by moving the read window
+  if(!CanUseChunkIndex() || loc.chunkIndex >= m_ChunkIndex.size())
+  {
+    RDCERR("Can't resolve reference to buffer in chunk %u of %u", loc.chunkIndex,
+           (uint32_t)m_ChunkIndex.size());
+    memset(buf, 0, bufLen);
+    return false;
+  }
+
+  // jump back to the first copy, then return to where we were
+  uint64_t offs = GetOffset();
+
+  SetOffset(m_ChunkIndex[loc.chunkIndex].offset + loc.chunkOffset);
+  memcpy(buf, ReadBytes(bufLen), bufLen);
+  SetOffset(offs);
+
+  return true;
+}
+
+void Serialiser::HashBytes(const void *data, size_t len, uint64_t hash[2])
+{
+  HashBuffer((const byte *)data, len, hash);
+}
+
+void Serialiser::HashCurrentChunk(uint64_t hash[2])
+{
+  RDCASSERT(m_Mode == READING && m_Indent == 1);
+
+  hash[0] = hash[1] = 0;
+
+  // hash in fixed-size pieces that are folded together, so a large chunk doesn't need the read
+  // window expanded to hold all of it at once
+  const uint64_t pieceSize = 64 * 1024;
+
+  uint64_t offs = GetOffset();
+  uint64_t remaining = m_ChunkEnd > offs ? m_ChunkEnd - offs : 0;
+
+  while(remaining > 0 && !m_HasError)
+  {
+    size_t len = (size_t)RDCMIN(remaining, pieceSize);
+
+    uint64_t piece[2];
+    HashBuffer((const byte *)ReadBytes(len), len, piece);
+
+    hash[0] = fmix64(rotl64(hash[0], 31) ^ piece[0]);
+    hash[1] = fmix64(rotl64(hash[1], 33) ^ piece[1]);
+
+    remaining -= len;
+  }
+}
+
 void Serialiser::SerialiseBuffer(const char *name, byte *&buf, size_t &len)
 {
   uint32_t bufLen = (uint32_t)len;
 
+  if(m_Mode >= WRITING && m_DedupChunk != NoBufferDedup && bufLen >= BufferDedupMinSize)
+  {
+    BufferDedupKey key;
+    key.length = bufLen;
+    HashBuffer(buf, bufLen, key.hash);
+
+    auto it = m_DedupBuffers.find(key);
+    if(it != m_DedupBuffers.end())
+    {
+      WriteFrom(BufferDedupReference);
+      WriteFrom(bufLen);
+      WriteFrom(it->second.chunkIndex);
+      WriteFrom(it->second.chunkOffset);
+
+      m_DedupCount++;
+      m_DedupBytes += bufLen;
+
+      if(m_DebugTextWriting && name && name[0])
+        DebugPrint("%s: RawBuffer % 5d:< duplicate of chunk %u >\n", name, bufLen,
+                   it->second.chunkIndex);
+
+      return;
+    }
+
+    // the data will be written at the next aligned offset below
+    BufferDedupLocation &loc = m_DedupBuffers[key];
+    loc.chunkIndex = m_DedupChunk;
+    loc.chunkOffset = (uint32_t)AlignUp(GetOffset() + sizeof(bufLen), BufferAlignment);
+  }
+
   if(m_Mode >= WRITING)
   {
     WriteFrom(bufLen);
@@ -1893,6 +4438,13 @@ void Serialiser::SerialiseBuffer(const char *name, byte *&buf, size_t &len)
   {
     ReadInto(bufLen);
 
+    if(bufLen == BufferDedupReference)
+    {
+      ReadDedupBuffer(buf, bufLen);
+      len = (size_t)bufLen;
+      return;
+    }
+
     // ensure byte alignment
     uint64_t offs = GetOffset();
 
@@ -1912,21 +4464,79 @@ void Serialiser::SerialiseBuffer(const char *name, byte *&buf, size_t &len)
   len = (size_t)bufLen;
 
   if(m_DebugTextWriting && name && name[0])
+    DebugPrintBuffer(name, buf, bufLen);
+}
+
+void Serialiser::SerialiseBorrowedBuffer(const char *name, const byte *&buf, size_t &len)
+{
+  if(m_Mode >= WRITING)
+  {
+    byte *data = (byte *)buf;
+    SerialiseBuffer(name, data, len);
+    return;
+  }
+
+  uint32_t bufLen = 0;
+  ReadInto(bufLen);
+
+  if(bufLen == BufferDedupReference)
   {
-    const char *ellipsis = "...";
+    byte *copy = NULL;
+    ReadDedupBuffer(copy, bufLen);
+
+    m_BorrowedCopy.assign(copy, copy + bufLen);
+    SAFE_DELETE_ARRAY(copy);
 
-    uint32_t lbuf[4];
+    buf = m_BorrowedCopy.empty() ? NULL : &m_BorrowedCopy[0];
+    len = (size_t)bufLen;
+    return;
+  }
 
-    memcpy(lbuf, buf, RDCMIN(len, 4 * sizeof(uint32_t)));
+  // ensure byte alignment
+  uint64_t offs = GetOffset();
 
-    if(bufLen <= 16)
-    {
-      ellipsis = "   ";
-    }
+  // serialise version 0x00000031 had only 16-byte alignment
+  uint64_t alignedoffs = AlignUp(offs, m_SerVer == 0x00000031 ? 16 : BufferAlignment);
 
-    DebugPrint("%s: RawBuffer % 5d:< 0x%08x 0x%08x 0x%08x 0x%08x %s>\n", name, bufLen, lbuf[0],
-               lbuf[1], lbuf[2], lbuf[3], ellipsis);
+  if(offs != alignedoffs)
+  {
+    ReadBytes((size_t)(alignedoffs - offs));
+    offs = alignedoffs;
+  }
+
+  // reading past the end of the in-memory window moves it, which would leave buf dangling. So pull
+  // in the rest of the chunk along with the buffer, then the remaining reads in the chunk are
+  // guaranteed to come from memory that's already there.
+  size_t resident = bufLen;
+  if(m_ChunkEnd > offs + bufLen && m_ChunkEnd <= m_BufferSize)
+    resident = (size_t)(m_ChunkEnd - offs);
+
+  buf = (const byte *)ReadBytes(resident);
+
+  if(buf)
+    m_BufferHead -= resident - bufLen;
+
+  len = (size_t)bufLen;
+
+  if(m_DebugTextWriting && name && name[0] && buf)
+    DebugPrintBuffer(name, buf, bufLen);
+}
+
+void Serialiser::DebugPrintBuffer(const char *name, const byte *buf, uint32_t bufLen)
+{
+  const char *ellipsis = "...";
+
+  uint32_t lbuf[4] = {0};
+
+  memcpy(lbuf, buf, RDCMIN((size_t)bufLen, 4 * sizeof(uint32_t)));
+
+  if(bufLen <= 16)
+  {
+    ellipsis = "   ";
   }
+
+  DebugPrint("%s: RawBuffer % 5d:< 0x%08x 0x%08x 0x%08x 0x%08x %s>\n", name, bufLen, lbuf[0],
+             lbuf[1], lbuf[2], lbuf[3], ellipsis);
 }
 
 template <>
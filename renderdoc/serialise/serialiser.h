@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -88,40 +89,114 @@ typedef const char *(*ChunkLookup)(uint32_t chunkType);
 class Serialiser;
 class ScopedContext;
 struct CompressedFileIO;
+struct ChunkPage;
+
+// a bump allocator for chunk data owned by one object, for chunks that are recorded together and
+// mostly freed together - such as the commands recorded into the command buffers of one pool.
+// Chunks not given an arena use one of a set picked by thread, see ChunkPage.
+//
+// Pages are shared with the chunks allocated from them, so chunks can outlive the arena and be
+// freed from any thread. Allocating from one arena on several threads at once is safe but
+// serialises on its lock.
+class ChunkArena
+{
+public:
+  ChunkArena() : m_Page(NULL), m_Offset(0) {}
+  ~ChunkArena() { Reset(); }
+  // stop allocating from the current page, so that it's freed as soon as the last chunk in it is
+  // instead of being held until the page fills up
+  void Reset();
+
+private:
+  // no copy semantics
+  ChunkArena(const ChunkArena &);
+  ChunkArena &operator=(const ChunkArena &);
+
+  friend struct ChunkPage;
+
+  Threading::CriticalSection m_Lock;
+  ChunkPage *m_Page;
+  size_t m_Offset;
+};
 
 // holds the memory, length and type for a given chunk, so that it can be
-// passed around and moved between owners before being serialised out
+// passed around and moved between owners before being serialised out.
+// Small chunks are sub-allocated from shared pages, see ChunkPage.
+//
+// A chunk's data doesn't change once it's recorded, so Duplicate() hands back a chunk sharing the
+// same data rather than a copy. The exception is data handed out by GetWritableData(), e.g. as a
+// record's CPU-side copy of a buffer's contents - that's never shared, and any chunks already
+// sharing it keep the old contents.
 class Chunk
 {
 public:
   ~Chunk();
 
   const char *GetDebugString() { return m_DebugStr.c_str(); }
-  byte *GetData() { return m_Data; }
+  const byte *GetData()
+  {
+    if(m_Spilled)
+      Unspill();
+    return m_Data;
+  }
+  // the data for a caller to modify in place. After this the chunk always copies when duplicated
+  byte *GetWritableData();
   uint32_t GetLength() { return m_Length; }
   uint32_t GetChunkType() { return m_ChunkType; }
   bool IsAligned() { return m_AlignedData; }
   bool IsTemporary() { return m_Temporary; }
-#if ENABLED(RDOC_DEVEL)
   static uint64_t NumLiveChunks() { return m_LiveChunks; }
+  static uint64_t MaxLiveChunks() { return m_MaxChunks; }
   static uint64_t TotalMem() { return m_TotalMem; }
-#else
-  static uint64_t NumLiveChunks() { return 0; }
-  static uint64_t TotalMem() { return 0; }
-#endif
-
-  // grab current contents of the serialiser into this chunk
-  Chunk(Serialiser *ser, uint32_t chunkType, bool temp);
+  // memory held in chunk pages, which is at least the size of the chunks allocated from them
+  static uint64_t ArenaMem() { return m_ArenaMem; }
+  static uint64_t MaxArenaMem() { return m_MaxArenaMem; }
+  // the part of TotalMem() that has been spilled to disk and isn't using any memory
+  static uint64_t SpilledMem() { return m_SpilledMem; }
+  // set the file that chunks are spilled to. Spilling fails until this is set
+  static void SetSpillFile(const char *filename);
+  static void CloseSpillFile();
+
+  // write the data out to the spill file and free it. GetData() reads it back in, so this must
+  // only be used on chunks that nothing else holds pointers into. Other chunks sharing the data
+  // keep it in memory. Returns false if the data
+  // couldn't be written, in which case the chunk is left as it was.
+  bool Spill();
+  bool IsSpilled() { return m_Spilled; }
+  // grab current contents of the serialiser into this chunk. The data is allocated from arena if
+  // it's set and the chunk is small enough
+  Chunk(Serialiser *ser, uint32_t chunkType, bool temp, ChunkArena *arena = NULL);
 
   Chunk *Duplicate();
 
 private:
-  Chunk() {}
+  Chunk()
+      : m_Data(NULL),
+        m_Page(NULL),
+        m_Sharers(NULL),
+        m_Writable(false),
+        m_Spilled(false),
+        m_SpillOffset(0)
+  {
+  }
   // no copy semantics
   Chunk(const Chunk &);
   Chunk &operator=(const Chunk &);
 
   friend class ScopedContext;
+  friend class Serialiser;
+  friend struct ChunkPage;
+
+  void AllocData(ChunkArena *arena);
+  void FreeData();
+
+  // drops this chunk's hold on its data, which is freed once no other chunk is sharing it
+  void ReleaseData();
+
+  // read spilled data back into dst, which must be at least m_Length bytes
+  bool ReadSpilled(byte *dst);
+  void Unspill();
+  void ReleaseSpill();
 
   bool m_AlignedData;
   bool m_Temporary;
@@ -130,11 +205,21 @@ private:
 
   uint32_t m_Length;
   byte *m_Data;
+  // the page m_Data was allocated from, or NULL if it was allocated on its own
+  ChunkPage *m_Page;
+  // how many chunks share m_Data, allocated the first time it's shared. The data is counted in
+  // TotalMem() once, not for every chunk sharing it.
+  volatile int32_t *m_Sharers;
+  // set once GetWritableData() has handed the data out, so it can't be shared
+  bool m_Writable;
+  // if set, m_Data is NULL and the data is in the spill file at m_SpillOffset
+  bool m_Spilled;
+  uint64_t m_SpillOffset;
   string m_DebugStr;
 
-#if ENABLED(RDOC_DEVEL)
   static int64_t m_LiveChunks, m_MaxChunks, m_TotalMem;
-#endif
+  static int64_t m_ArenaMem, m_MaxArenaMem;
+  static int64_t m_SpilledMem;
 };
 
 // this class has a few functions. It can be used to serialise chunks - on writing it enforces
@@ -176,16 +261,31 @@ public:
     eSectionFlag_None = 0x0,
     eSectionFlag_ASCIIStored = 0x1,
     eSectionFlag_LZ4Compressed = 0x2,
+    // the LZ4 blocks are compressed independently rather than chained, so decompression can start
+    // at any block.
+    eSectionFlag_IndependentBlocks = 0x4,
+    // the compressed blocks are followed by a directory of where each block starts, so they can be
+    // located without scanning. Only used together with eSectionFlag_IndependentBlocks.
+    eSectionFlag_BlockDirectory = 0x8,
+    // like eSectionFlag_LZ4Compressed but each independent block is deflated instead, for a better
+    // ratio at the cost of speed. Never set together with eSectionFlag_LZ4Compressed.
+    eSectionFlag_DeflateCompressed = 0x10,
   };
 
   enum SectionType
   {
     eSectionType_Unknown = 0,
-    eSectionType_FrameCapture,       // renderdoc/internal/framecapture
-    eSectionType_ResolveDatabase,    // renderdoc/internal/resolvedb
-    eSectionType_MachineID,          // renderdoc/internal/machineid
-    eSectionType_FrameBookmarks,     // renderdoc/ui/bookmarks
-    eSectionType_Notes,              // renderdoc/ui/notes
+    eSectionType_FrameCapture,          // renderdoc/internal/framecapture
+    eSectionType_ResolveDatabase,       // renderdoc/internal/resolvedb
+    eSectionType_MachineID,             // renderdoc/internal/machineid
+    eSectionType_FrameBookmarks,        // renderdoc/ui/bookmarks
+    eSectionType_Notes,                 // renderdoc/ui/notes
+    eSectionType_ChunkIndex,            // renderdoc/internal/chunkindex
+    eSectionType_CounterResults,        // renderdoc/internal/counterresults
+    eSectionType_Thumbnail,             // renderdoc/internal/thumbnail
+    eSectionType_ResolvedCallstacks,    // renderdoc/internal/resolvedcallstacks
+    eSectionType_CallstackTable,        // renderdoc/internal/callstacktable
+    eSectionType_StringTable,           // renderdoc/internal/stringtable
     eSectionType_Num,
   };
 
@@ -258,35 +358,21 @@ public:
   }
 
   // assumes buffer head is sitting before a chunk (ie. pushcontext will be valid)
-  void SkipToChunk(uint32_t chunkIdx, uint32_t *idx = NULL)
-  {
-    do
-    {
-      size_t offs = m_BufferHead - m_Buffer + (size_t)m_ReadOffset;
-
-      uint32_t c = PushContext(NULL, NULL, 1, false);
+  void SkipToChunk(uint32_t chunkIdx, uint32_t *idx = NULL);
 
-      // found
-      if(c == chunkIdx)
-      {
-        m_Indent--;
-        m_BufferHead = (m_Buffer + offs) - (size_t)m_ReadOffset;
-        return;
-      }
-      else
-      {
-        SkipCurrentChunk();
-        PopContext(1);
-      }
-
-      if(idx)
-        (*idx)++;
-
-    } while(!AtEnd());
-  }
+  // if the capture has a chunk index, the number of top-level chunks in the frame capture section
+  // and a jump straight to the start of the n'th one. Returns false if there's no index.
+  bool HasChunkIndex() { return !m_ChunkIndex.empty(); }
+  uint32_t GetNumChunks() { return (uint32_t)m_ChunkIndex.size(); }
+  bool SeekToChunk(uint32_t chunkNumber);
 
   // assumes buffer head is sitting in a chunk (ie. immediately after a pushcontext)
   void SkipCurrentChunk() { ReadBytes(m_LastChunkLen); }
+  // assumes buffer head is somewhere in a top-level chunk. Hashes the rest of its contents without
+  // decoding them, leaving the head at the end of the chunk
+  void HashCurrentChunk(uint64_t hash[2]);
+  // the 128-bit hash used for buffer deduplication and chunk hashes
+  static void HashBytes(const void *data, size_t len, uint64_t hash[2]);
   void InitCallstackResolver();
   bool HasCallstacks() { return m_KnownSections[eSectionType_ResolveDatabase] != NULL; }
   // get callstack resolver, created with the DB in the file
@@ -309,6 +395,24 @@ public:
     return 0;
   }
 
+  // the contents of a section that was read into memory when the file was opened, or NULL if
+  // there's no such section (or it was too large to be loaded up front)
+  const vector<byte> *GetSectionContents(SectionType type)
+  {
+    Section *s = m_KnownSections[type];
+
+    if(s == NULL || s->data.empty())
+      return NULL;
+
+    return &s->data;
+  }
+
+  // add an uncompressed binary section to the end of an existing capture. When reading, later
+  // sections of a type replace earlier ones, so this can update a section without rewriting the
+  // whole file.
+  static bool AppendSection(const char *path, SectionType type, const char *name,
+                            const byte *data, size_t length);
+
   // get the callstack associated with the last scope
   Callstack::Stackwalk *GetLastCallstack()
   {
@@ -325,6 +429,29 @@ public:
   // Write a chunk to disk
   void Insert(Chunk *el);
 
+  // also store the thumbnail in its own small section when writing, so ReadThumbnail can get it
+  // without opening the capture. An empty thumbnail still writes a section, recording that there
+  // is none.
+  void SetThumbnail(uint32_t width, uint32_t height, const byte *jpg, size_t length);
+  // the jpeg data last passed to SetThumbnail, empty if there is none
+  void GetThumbnail(vector<byte> &jpg) const;
+
+  // read the thumbnail section of a capture by skipping over the section headers. Returns false if
+  // there's no thumbnail section (e.g. an older capture), otherwise the jpeg data which is empty
+  // if the capture has no thumbnail.
+  static bool ReadThumbnail(const char *path, uint32_t &width, uint32_t &height,
+                            vector<byte> &jpg);
+  uint32_t GetNumInsertedChunks() { return (uint32_t)m_Chunks.size(); }
+  uint64_t GetInsertedChunkBytes();
+
+  // replace any inserted chunks that are owned elsewhere with private copies, so that this
+  // serialiser can be flushed after the records that own them have been modified or freed.
+  void TakeChunkOwnership();
+
+  // spill the inserted chunks this serialiser owns to disk, see Chunk::Spill. Returns how many
+  // bytes were spilled.
+  uint64_t SpillOwnedChunks();
+
   // serialise a fixed-size array.
   template <int Num, class T>
   void SerialisePODArray(const char *name, T *el)
@@ -551,13 +678,34 @@ public:
   // not sure if I still neeed these specialisations anymore.
   void SerialiseString(const char *name, string &el);
 
+  // for strings that repeat a lot across chunks, like debug names and markers. When writing, each
+  // unique string is stored once in the capture's string table and chunks only hold its index.
+  // Reads strings written with SerialiseString too, so it can replace it without a version bump.
+  void SerialiseInternedString(const char *name, string &el);
+
   // serialise a buffer.
   //
   // If serialising in, buf must either be NULL in which case allocated
   // memory will be returned, or it must be already large enough.
   void SerialiseBuffer(const char *name, byte *&buf, size_t &len);
+
+  // as SerialiseBuffer, but when serialising in buf is pointed straight at the data in the
+  // serialiser's own memory instead of being copied into an allocation. It must not be freed or
+  // modified, and isn't necessarily aligned. It stays valid while the rest of the current chunk is
+  // read, until the serialiser moves on to another chunk or seeks elsewhere - which resolving a
+  // deduplicated buffer in the same chunk also does.
+  void SerialiseBorrowedBuffer(const char *name, const byte *&buf, size_t &len);
   void AlignNextBuffer(const size_t alignment);
 
+  // While set, large buffers written with SerialiseBuffer are hashed and any repeat of a buffer
+  // written since the last ResetBufferDedup() is written as a reference to the first copy instead.
+  // fileChunkIndex is the index the chunk currently being serialised will have once inserted into
+  // the file serialiser, or NoBufferDedup for data that will not end up in the file. References
+  // are resolved on read through the chunk index.
+  static const uint32_t NoBufferDedup = ~0U;
+  void SetBufferDedupChunk(uint32_t fileChunkIndex) { m_DedupChunk = fileChunkIndex; }
+  void ResetBufferDedup();
+
   // NOT recommended interface. Useful for specific situations if e.g. you have
   // a buffer of data that is not arbitrary in size and can be determined by a 'type' or
   // similar elsewhere in the stream, so you want to skip the type-safety of the above
@@ -572,12 +720,29 @@ public:
 
   void FlushToDisk();
 
+  // writes the capture this serialiser was opened from out to a new file, with the frame capture
+  // data recompressed using codec (eSectionFlag_LZ4Compressed or eSectionFlag_DeflateCompressed)
+  // and all other sections copied across unchanged. Only valid on a file serialiser opened for
+  // reading, and the read position is undefined afterwards.
+  bool WriteRecompressed(const char *path, SectionFlags codec);
+
+  // compresses size bytes of synthetic capture-like data to path through the same compressed
+  // block writer captures use, and returns how many milliseconds that took including flushing
+  // the file. Negative on failure. The file is left behind for the caller to delete.
+  static double BenchmarkCompressedWrite(const char *path, SectionFlags codec, uint64_t size,
+                                         uint64_t &compressedSize);
+
   // set a function used when serialising a text representation
   // of the chunks
   void SetChunkNameLookup(ChunkLookup lookup) { m_ChunkLookup = lookup; }
   void SetDebugText(bool enabled) { m_DebugTextWriting = enabled; }
   bool GetDebugText() { return m_DebugTextWriting; }
   string GetDebugStr() { return m_DebugText; }
+
+  // while set, serialisers opened to read a capture file write out the debug text of each
+  // top-level chunk to f as soon as the chunk has been read, so a whole capture can be exported
+  // without holding more than one chunk's text in memory. Set to NULL to stop.
+  static void SetDebugTextExport(FILE *f) { m_DebugTextExportTarget = f; }
 private:
   //////////////////////////////////////////
   // Raw memory buffer read/write
@@ -587,9 +752,25 @@ private:
 
   void ReadFromFile(uint64_t bufferOffs, size_t length);
 
+  // can we reposition the read window anywhere in the frame capture section, rather than only
+  // streaming forwards through it
+  bool IsSeekable();
+  void SeekWindow(uint64_t offs);
+  void FreeWindow(byte *buf);
+
+  // this is on the path of every serialised element during capture, so the common case of there
+  // being room in the buffer is inlined down to a plain store. WriteBytes handles the rest,
+  // including refusing to write once the serialiser has errored.
   template <class T>
   void WriteFrom(const T &f)
   {
+    if(!m_HasError && m_BufferHead + sizeof(T) + 8 <= m_Buffer + m_BufferSize)
+    {
+      memcpy(m_BufferHead, &f, sizeof(T));
+      m_BufferHead += sizeof(T);
+      return;
+    }
+
     WriteBytes((byte *)&f, sizeof(T));
   }
 
@@ -631,6 +812,47 @@ private:
 
   static const uint64_t BufferAlignment;
 
+  // buffers smaller than this aren't worth hashing for de-duplication
+  static const uint32_t BufferDedupMinSize;
+
+  // written in place of a buffer length for a buffer that refers to an identical earlier one
+  static const uint32_t BufferDedupReference;
+
+  struct BufferDedupKey
+  {
+    uint64_t hash[2];
+    uint32_t length;
+
+    bool operator<(const BufferDedupKey &o) const
+    {
+      if(length != o.length)
+        return length < o.length;
+      if(hash[0] != o.hash[0])
+        return hash[0] < o.hash[0];
+      return hash[1] < o.hash[1];
+    }
+  };
+
+  // where the first copy of a buffer lives - the top-level chunk and the offset within it
+  struct BufferDedupLocation
+  {
+    uint32_t chunkIndex;
+    uint32_t chunkOffset;
+  };
+
+  map<BufferDedupKey, BufferDedupLocation> m_DedupBuffers;
+  uint32_t m_DedupChunk;
+  uint32_t m_DedupCount;
+  uint64_t m_DedupBytes;
+
+  bool ReadDedupBuffer(byte *&buf, uint32_t &bufLen);
+
+  // a deduplicated buffer that was borrowed is copied here, as the data it refers to is elsewhere
+  // in the file
+  vector<byte> m_BorrowedCopy;
+
+  void DebugPrintBuffer(const char *name, const byte *buf, uint32_t bufLen);
+
   //////////////////////////////////////////
 
   uint64_t m_SerVer;
@@ -657,6 +879,8 @@ private:
   byte *m_Buffer;
   byte *m_BufferHead;
   size_t m_LastChunkLen;
+  // when reading, the offset the current top-level chunk ends at
+  uint64_t m_ChunkEnd;
   bool m_AlignedData;
   vector<uint64_t> m_ChunkFixups;
 
@@ -665,15 +889,25 @@ private:
   struct Section
   {
     Section()
-        : type(eSectionType_Unknown), flags(eSectionFlag_None), fileoffset(0), compressedReader(NULL)
+        : type(eSectionType_Unknown),
+          flags(eSectionFlag_None),
+          fileoffset(0),
+          compressedSize(0),
+          compressedReader(NULL)
     {
     }
+    bool IsCompressed() const
+    {
+      return (flags & (eSectionFlag_LZ4Compressed | eSectionFlag_DeflateCompressed)) != 0;
+    }
+
     string name;
     SectionType type;
     SectionFlags flags;
 
     uint64_t fileoffset;
     uint64_t size;
+    uint64_t compressedSize;    // bytes stored on disk after the size, for compressed sections
     vector<byte> data;    // some sections can be loaded entirely into memory
     CompressedFileIO *compressedReader;
   };
@@ -684,6 +918,41 @@ private:
   // this lists known sections, some may be NULL
   Section *m_KnownSections[eSectionType_Num];
 
+  // one entry per top-level chunk in the frame capture, in file order. Offsets are into the
+  // uncompressed frame capture data, at the chunk header (after any alignment padding)
+  struct ChunkIndexEntry
+  {
+    uint64_t offset;
+    uint32_t chunkType;
+    uint32_t length;
+  };
+
+  vector<ChunkIndexEntry> m_ChunkIndex;
+
+  // chunk type -> entries in m_ChunkIndex of that type, built on first use
+  map<uint32_t, vector<uint32_t> > m_ChunkIndexByType;
+
+  bool CanUseChunkIndex();
+  void LoadChunkIndex();
+
+  // contents of the thumbnail section to write: width, height, then the jpeg data
+  vector<byte> m_ThumbnailSection;
+
+  // unique callstacks referenced by index from chunk headers, read from the callstack table
+  // section on first use. Stack i is m_CallstackTableAddrs[offsets[i]] to [offsets[i+1]].
+  bool m_CallstackTableLoaded;
+  vector<uint32_t> m_CallstackTableOffsets;
+  vector<uint64_t> m_CallstackTableAddrs;
+
+  void LoadCallstackTable();
+
+  // strings referenced by index from SerialiseInternedString, read from the string table section on
+  // first use
+  bool m_StringTableLoaded;
+  vector<string> m_StringTable;
+
+  void LoadStringTable();
+
   // where does our in-memory window point to in the data stream. ie. m_pBuffer[0] is
   // m_ReadOffset into the frame capture section
   uint64_t m_ReadOffset;
@@ -693,6 +962,10 @@ private:
   // how big is the current in-memory window
   size_t m_CurrentBufferSize;
 
+  // if the persistent block is a view of the file mapped into memory, this is the mapping.
+  // m_Buffer then points into the mapping rather than an allocation
+  void *m_MappedView;
+
   // the file pointer to read from
   FILE *m_ReadFileHandle;
 
@@ -707,6 +980,9 @@ private:
   bool m_DebugTextWriting;
   string m_DebugText;
   ChunkLookup m_ChunkLookup;
+
+  FILE *m_DebugTextExport;
+  static FILE *m_DebugTextExportTarget;
 };
 
 template <>
@@ -741,6 +1017,12 @@ public:
     return new Chunk(m_Ser, m_Idx, temporary);
   }
 
+  Chunk *Get(ChunkArena *arena)
+  {
+    End();
+    return new Chunk(m_Ser, m_Idx, false, arena);
+  }
+
 private:
   uint32_t m_Idx;
   Serialiser *m_Ser;
@@ -837,6 +1119,24 @@ struct ScopedDeserialise
     GET_SERIALISER->SerialiseBuffer(#name, name, CONCAT(buflen, __LINE__)); \
   }
 
+// as SERIALISE_ELEMENT_BUF, but name is a const byte * that on reading points into the serialiser
+// and must not be freed. See Serialiser::SerialiseBorrowedBuffer for how long it stays valid.
+#define SERIALISE_ELEMENT_BUF_BORROWED(name, inBuf, Len) \
+  const byte *name = NULL;                               \
+  if(m_State >= WRITING)                                 \
+    name = (const byte *)(inBuf);                        \
+  size_t CONCAT(buflen, __LINE__) = Len;                 \
+  GET_SERIALISER->SerialiseBorrowedBuffer(#name, name, CONCAT(buflen, __LINE__));
+#define SERIALISE_ELEMENT_BUF_BORROWED_OPT(name, inBuf, Len, Condition)             \
+  const byte *name = NULL;                                                          \
+  if(Condition)                                                                     \
+  {                                                                                 \
+    if(m_State >= WRITING)                                                          \
+      name = (const byte *)(inBuf);                                                 \
+    size_t CONCAT(buflen, __LINE__) = Len;                                          \
+    GET_SERIALISER->SerialiseBorrowedBuffer(#name, name, CONCAT(buflen, __LINE__)); \
+  }
+
 // forward declare generic pointer version to void*
 template <class T>
 struct ToStrHelper<true, T>
@@ -99,3 +99,32 @@ std::string trim(const std::string &str)
   // searching from the start found something, so searching from the end must have too.
   return str.substr(start, end - start + 1);
 }
+
+std::string jsonescape(const std::string &str)
+{
+  const char hex[] = "0123456789abcdef";
+
+  std::string ret;
+  ret.reserve(str.size());
+
+  for(size_t i = 0; i < str.size(); i++)
+  {
+    unsigned char c = (unsigned char)str[i];
+
+    if(c == '"' || c == '\\')
+      ret.push_back('\\');
+
+    if(c < 0x20)
+    {
+      ret += "\\u00";
+      ret.push_back(hex[c >> 4]);
+      ret.push_back(hex[c & 0xf]);
+    }
+    else
+    {
+      ret.push_back(str[i]);
+    }
+  }
+
+  return ret;
+}
@@ -39,6 +39,9 @@ std::wstring strupper(const std::wstring &str);
 
 std::string trim(const std::string &str);
 
+// escapes quotes, backslashes and control characters for use inside a JSON string
+std::string jsonescape(const std::string &str);
+
 uint32_t strhash(const char *str, uint32_t existingHash = 5381);
 
 template <class strType>
@@ -282,6 +282,356 @@ struct ThumbCommand : public Command
   }
 };
 
+struct RecompressCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add<string>("out", 'o', "The output filename to save the recompressed capture to", true,
+                       "filename.rdc");
+    parser.add<string>("codec", 'c',
+                       "The compression to use. lz4 is fast to load, deflate is smaller for "
+                       "archiving. Default is deflate.",
+                       false, "deflate", cmdline::oneof<string>("lz4", "deflate"));
+  }
+  virtual const char *Description()
+  {
+    return "Rewrites a capture to a new file with different compression.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().empty())
+    {
+      std::cerr << "Error: recompress command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string filename = parser.rest()[0];
+
+    string outfile = parser.get<string>("out");
+
+    CaptureCompression compression = eCaptureCompression_Deflate;
+
+    if(parser.get<string>("codec") == "lz4")
+      compression = eCaptureCompression_LZ4;
+
+    bool32 ret = RENDERDOC_RecompressCapture(filename.c_str(), outfile.c_str(), compression);
+
+    if(!ret)
+    {
+      std::cerr << "Couldn't recompress '" << filename << "' to '" << outfile << "'" << std::endl;
+      return 1;
+    }
+
+    std::cout << "Recompressed '" << filename << "' to '" << outfile << "'." << std::endl;
+
+    return 0;
+  }
+};
+
+struct BenchmarkCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add<string>("out", 'o', "Write the JSON results to this file instead of stdout.", false);
+    parser.add("replay", 'r',
+               "Also time creating a replay device, ReadLogInitialisation and the first replay.");
+    parser.add<uint32_t>("write-size", 's',
+                         "Megabytes of synthetic data to compress and diff. 0 to skip.",
+                         false, 64);
+  }
+  virtual const char *Description()
+  {
+    return "Times each stage of loading a capture, and capture compression throughput.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().empty())
+    {
+      std::cerr << "Error: benchmark command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string filename = parser.rest()[0];
+
+    uint64_t writeSize = uint64_t(parser.get<uint32_t>("write-size")) * 1024 * 1024;
+
+    rdctype::str json;
+    bool32 ret =
+        RENDERDOC_BenchmarkCapture(filename.c_str(), parser.exist("replay"), writeSize, &json);
+
+    if(!ret)
+    {
+      std::cerr << "Couldn't benchmark '" << filename << "'" << std::endl;
+      return 1;
+    }
+
+    if(parser.exist("out"))
+    {
+      string outfile = parser.get<string>("out");
+
+      FILE *f = fopen(outfile.c_str(), "wb");
+
+      if(!f)
+      {
+        std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
+        return 1;
+      }
+
+      fwrite(json.elems, 1, json.count, f);
+      fclose(f);
+    }
+    else
+    {
+      std::cout << json.elems;
+    }
+
+    return 0;
+  }
+};
+
+struct BenchmarkReplayCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add<string>("out", 'o', "Write the JSON results to this file instead of stdout.", false);
+    parser.add<uint32_t>("warmup", 'w', "Untimed replays of the frame before timing starts.",
+                         false, 3);
+    parser.add<uint32_t>("frames", 'n', "Number of timed replays of the frame.", false, 20);
+    parser.add<uint32_t>("gpu-passes", 'g',
+                         "Number of times to fetch per-event GPU durations. 0 to skip.", false, 5);
+  }
+  virtual const char *Description()
+  {
+    return "Replays a capture's frame repeatedly and reports wall-clock and GPU time as JSON.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().empty())
+    {
+      std::cerr << "Error: benchmarkreplay command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string filename = parser.rest()[0];
+
+    rdctype::str json;
+    bool32 ret = RENDERDOC_BenchmarkReplay(filename.c_str(), parser.get<uint32_t>("warmup"),
+                                           parser.get<uint32_t>("frames"),
+                                           parser.get<uint32_t>("gpu-passes"), &json);
+
+    if(!ret)
+    {
+      std::cerr << "Couldn't benchmark replay of '" << filename << "'" << std::endl;
+      return 1;
+    }
+
+    if(parser.exist("out"))
+    {
+      string outfile = parser.get<string>("out");
+
+      FILE *f = fopen(outfile.c_str(), "wb");
+
+      if(!f)
+      {
+        std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
+        return 1;
+      }
+
+      fwrite(json.elems, 1, json.count, f);
+      fclose(f);
+    }
+    else
+    {
+      std::cout << json.elems;
+    }
+
+    return 0;
+  }
+};
+
+struct ExportCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add<string>("out", 'o', "The file to write the text to.", true);
+  }
+  virtual const char *Description()
+  {
+    return "Writes out the decoded contents of every chunk in a capture as text.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().empty())
+    {
+      std::cerr << "Error: export command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string filename = parser.rest()[0];
+    string outfile = parser.get<string>("out");
+
+    ReplayCreateStatus status = RENDERDOC_ExportCaptureText(filename.c_str(), outfile.c_str());
+
+    if(status != eReplayCreate_Success)
+    {
+      std::cerr << "Couldn't export '" << filename << "': " << status << std::endl;
+      return 1;
+    }
+
+    return 0;
+  }
+};
+
+struct DiffCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<before.rdc> <after.rdc>");
+    parser.add<string>("out", 'o', "Write the JSON results to this file instead of stdout.", false);
+    parser.add<uint32_t>("max-listed", 'n', "Most changes to list for each marker region.", false,
+                         100);
+  }
+  virtual const char *Description()
+  {
+    return "Compares two captures of the same API chunk by chunk and reports the differences as "
+           "JSON.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().size() < 2)
+    {
+      std::cerr << "Error: diff command requires two capture filenames." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string before = parser.rest()[0];
+    string after = parser.rest()[1];
+
+    rdctype::str json;
+    bool32 ret = RENDERDOC_DiffCaptures(before.c_str(), after.c_str(),
+                                        parser.get<uint32_t>("max-listed"), &json);
+
+    if(!ret)
+    {
+      std::cerr << "Couldn't diff '" << before << "' against '" << after << "'" << std::endl;
+      return 1;
+    }
+
+    if(parser.exist("out"))
+    {
+      string outfile = parser.get<string>("out");
+
+      FILE *f = fopen(outfile.c_str(), "wb");
+
+      if(!f)
+      {
+        std::cerr << "Couldn't open destination file '" << outfile << "'" << std::endl;
+        return 1;
+      }
+
+      fwrite(json.elems, 1, json.count, f);
+      fclose(f);
+    }
+    else
+    {
+      std::cout << json.elems;
+    }
+
+    return 0;
+  }
+};
+
+struct ExportOutputsCommand : public Command
+{
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc> [<filename.rdc> ...]");
+    parser.add<string>("out", 'o', "The directory to write the outputs to.", true);
+    parser.add("markers", 'm', "Only export the outputs at the end of each marker region.");
+    parser.add("meshes", 'v', "Also export the post-VS mesh data of each drawcall.");
+  }
+  virtual const char *Description()
+  {
+    return "Replays captures headlessly and writes out the outputs of every drawcall.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual int Execute(cmdline::parser &parser, const CaptureOptions &)
+  {
+    if(parser.rest().empty())
+    {
+      std::cerr << "Error: exportoutputs command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return 0;
+    }
+
+    string outdir = parser.get<string>("out");
+
+    int ret = 0;
+
+    for(size_t i = 0; i < parser.rest().size(); i++)
+    {
+      string filename = parser.rest()[i];
+
+      // with several captures, each goes in its own directory named after the capture
+      string dir = outdir;
+      if(parser.rest().size() > 1)
+      {
+        string base = filename;
+
+        size_t sep = base.find_last_of("/\\");
+        if(sep != string::npos)
+          base = base.substr(sep + 1);
+
+        size_t ext = base.rfind('.');
+        if(ext != string::npos)
+          base = base.substr(0, ext);
+
+        dir += "/" + base;
+      }
+
+      ReplayCreateStatus status = RENDERDOC_ExportCaptureOutputs(
+          filename.c_str(), dir.c_str(), parser.exist("markers"), parser.exist("meshes"));
+
+      if(status != eReplayCreate_Success)
+      {
+        std::cerr << "Couldn't export outputs of '" << filename << "': " << status << std::endl;
+        ret = 1;
+        continue;
+      }
+
+      std::cout << "Exported outputs of '" << filename << "' to '" << dir << "'." << std::endl;
+    }
+
+    return ret;
+  }
+};
+
 struct CaptureCommand : public Command
 {
   virtual void AddOptions(cmdline::parser &parser)
@@ -458,6 +808,9 @@ struct ReplayCommand : public Command
                        "Instead of replaying locally, replay on this host over the network.", false);
     parser.add<uint32_t>("remote-port", 0, "If --remote-host is set, use this port.", false,
                          RENDERDOC_GetDefaultRemoteServerPort());
+    parser.add<string>("trace", 0,
+                       "On exit, write a Chrome trace of the loading and replay to this file.",
+                       false);
   }
   virtual const char *Description()
   {
@@ -538,6 +891,10 @@ struct ReplayCommand : public Command
         std::cerr << "Couldn't load and replay '" << filename << "'." << std::endl;
       }
     }
+
+    if(parser.exist("trace") && !RENDERDOC_ExportTrace(parser.get<string>("trace").c_str()))
+      std::cerr << "Couldn't write trace to '" << parser.get<string>("trace") << "'." << std::endl;
+
     return 0;
   }
 };
@@ -674,6 +1031,12 @@ int renderdoccmd(std::vector<std::string> &argv)
 
     // add platform agnostic commands
     add_command("thumb", new ThumbCommand());
+    add_command("recompress", new RecompressCommand());
+    add_command("benchmark", new BenchmarkCommand());
+    add_command("benchmarkreplay", new BenchmarkReplayCommand());
+    add_command("export", new ExportCommand());
+    add_command("exportoutputs", new ExportOutputsCommand());
+    add_command("diff", new DiffCommand());
     add_command("capture", new CaptureCommand());
     add_command("inject", new InjectCommand());
     add_command("remoteserver", new RemoteServerCommand());
@@ -754,6 +1117,36 @@ int renderdoccmd(std::vector<std::string> &argv)
               "Capturing Option: Save all initial resource contents at frame start.");
       cmd.add("opt-capture-all-cmd-lists", 0,
               "Capturing Option: In D3D11, record all command lists from application start.");
+      cmd.add("opt-async-capture-write", 0,
+              "Capturing Option: Write captures to disk in the background after the frame.");
+      cmd.add("opt-combine-multi-frame", 0,
+              "Capturing Option: Record multi-frame captures into a single capture.");
+      cmd.add<int>("opt-stage-initial-contents", 0,
+                   "Capturing Option: Prepare up to N MB of initial contents before a capture.",
+                   false, 0);
+      cmd.add("opt-track-mapped-writes", 0,
+              "Capturing Option: Track written pages of coherent maps by write-protecting them.");
+      cmd.add("opt-dedup-callstacks", 0,
+              "Capturing Option: Store each unique callstack once and refer to it by index.");
+      cmd.add("opt-capture-event-timings", 0,
+              "Capturing Option: Record GPU timestamps around each draw in the captured frame.");
+      cmd.add("opt-hide-overlay", 0,
+              "Capturing Option: Don't draw the overlay on the application's presents.");
+      cmd.add<int>("opt-ring-frames", 0,
+                   "Capturing Option: Keep the last N frames so triggering captures past frames.",
+                   false, 0);
+      cmd.add<int>("opt-ring-memory", 0,
+                   "Capturing Option: Limit the frames kept by --opt-ring-frames to N MB.", false,
+                   256);
+      cmd.add<int>("opt-spike-ms", 0,
+                   "Capturing Option: Capture when a frame takes longer than N milliseconds.",
+                   false, 0);
+      cmd.add<int>("opt-spike-percent", 0,
+                   "Capturing Option: Capture when a frame takes over N% of the average.", false,
+                   0);
+      cmd.add<int>("opt-memory-budget", 0,
+                   "Capturing Option: Discard captures needing more than N MB of memory.", false,
+                   0);
     }
 
     cmd.parse_check(argv, true);
@@ -785,8 +1178,26 @@ int renderdoccmd(std::vector<std::string> &argv)
         opts.SaveAllInitials = true;
       if(cmd.exist("opt-capture-all-cmd-lists"))
         opts.CaptureAllCmdLists = true;
+      if(cmd.exist("opt-async-capture-write"))
+        opts.AsyncCaptureWrite = true;
+      if(cmd.exist("opt-combine-multi-frame"))
+        opts.CombineMultiFrameCaptures = true;
+      if(cmd.exist("opt-track-mapped-writes"))
+        opts.TrackMappedWrites = true;
+      if(cmd.exist("opt-dedup-callstacks"))
+        opts.DeduplicateCallstacks = true;
+      if(cmd.exist("opt-capture-event-timings"))
+        opts.CaptureEventTimings = true;
+      if(cmd.exist("opt-hide-overlay"))
+        opts.HideOverlay = true;
 
       opts.DelayForDebugger = (uint32_t)cmd.get<int>("opt-delay-for-debugger");
+      opts.StageInitialContentsMB = (uint32_t)cmd.get<int>("opt-stage-initial-contents");
+      opts.RingCaptureFrames = (uint32_t)cmd.get<int>("opt-ring-frames");
+      opts.RingCaptureMemoryMB = (uint32_t)cmd.get<int>("opt-ring-memory");
+      opts.SpikeCaptureThresholdMS = (uint32_t)cmd.get<int>("opt-spike-ms");
+      opts.SpikeCapturePercent = (uint32_t)cmd.get<int>("opt-spike-percent");
+      opts.CaptureMemoryBudgetMB = (uint32_t)cmd.get<int>("opt-memory-budget");
     }
 
     if(cmd.exist("help"))
@@ -80,5 +80,17 @@ public class CaptureOptions
         public bool SaveAllInitials;
         public bool CaptureAllCmdLists;
         public bool DebugOutputMute;
+        public bool AsyncCaptureWrite;
+        public bool CombineMultiFrameCaptures;
+        public UInt32 StageInitialContentsMB;
+        public bool TrackMappedWrites;
+        public bool DeduplicateCallstacks;
+        public UInt32 RingCaptureFrames;
+        public UInt32 RingCaptureMemoryMB;
+        public UInt32 SpikeCaptureThresholdMS;
+        public UInt32 SpikeCapturePercent;
+        public UInt32 CaptureMemoryBudgetMB;
+        public bool CaptureEventTimings;
+        public bool HideOverlay;
     };
 };
@@ -518,6 +518,9 @@ public enum GPUCounters : uint
         PSInvocations,
         CSInvocations,
 
+        // one past the GL replay counters, see eCounter_GLMaxCounters in replay_enums.h
+        CapturedGPUDuration = CSInvocations + 2,
+
         FirstAMD = 1000000,
 
         FirstIntel = 2000000,
@@ -525,6 +528,14 @@ public enum GPUCounters : uint
         FirstNvidia = 3000000,
     };
 
+    [Flags]
+    public enum ValueSearchFlags
+    {
+        NaN = 0x1,
+        Inf = 0x2,
+        OutOfRange = 0x4,
+    };
+
     public enum CounterUnits
     {
         Absolute,
@@ -570,6 +581,8 @@ public enum TargetControlMessageType
         CaptureCopied,
         RegisterAPI,
         NewChild,
+        CaptureStats,
+        EntryPointStats,
     };
 
     public enum EnvironmentModificationType
@@ -547,6 +547,49 @@ public class EventUsage
         public ResourceId view;
     };
 
+    [StructLayout(LayoutKind.Sequential)]
+    public struct ValueSearchParams
+    {
+        public ValueSearchFlags flags;
+        public float minValue;
+        public float maxValue;
+        public UInt32 channelMask;
+        public UInt32 maxMatches;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class ValueSearchMatch
+    {
+        public UInt32 x;
+        public UInt32 y;
+        public UInt32 component;
+        public float value;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TextureCompareInput
+    {
+        public ResourceId texid;
+        public UInt32 eventID;
+        public UInt32 sliceFace;
+        public UInt32 mip;
+        public UInt32 sampleIdx;
+        public FormatComponentType typeHint;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class TextureCompareResult
+    {
+        public ResourceId diffTexture;
+        public UInt32 width;
+        public UInt32 height;
+
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 4)]
+        public float[] maxError;
+
+        public UInt32 numDifferent;
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public class FetchDrawcall
     {
@@ -68,6 +68,24 @@ public string GetDescription()
         }
     }
 
+    [StructLayout(LayoutKind.Sequential)]
+    public class CaptureRecordStats
+    {
+        public ResourceId ID;
+        public UInt32 numChunks;
+        public UInt64 chunkBytes;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class EntryPointStats
+    {
+        [CustomMarshalAs(CustomUnmanagedType.UTF8TemplatedString)]
+        public string name;
+        public UInt64 calls;
+        public UInt64 sampledCalls;
+        public UInt64 totalNS;
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public class TargetControlMessage
     {
@@ -114,6 +132,56 @@ public struct NewChildData
         };
         [CustomMarshalAs(CustomUnmanagedType.CustomClass)]
         public NewChildData NewChild;
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct CaptureStatsData
+        {
+            public UInt64 liveChunks;
+            public UInt64 peakLiveChunks;
+            public UInt64 chunkBytes;
+            public UInt64 chunkPageBytes;
+            public UInt64 peakChunkPageBytes;
+
+            public UInt32 numRecords;
+            public UInt32 numRecordChunks;
+            public UInt64 recordChunkBytes;
+
+            public UInt32 numInitialContents;
+            public UInt32 numInitialChunks;
+            public UInt64 initialChunkBytes;
+
+            public UInt32 ringFrames;
+            public UInt64 ringBytes;
+            public UInt64 ringByteLimit;
+            public double ringFrameOverheadMS;
+
+            public UInt64 captureMemoryBytes;
+            public UInt64 captureMemoryBudget;
+            public UInt64 initialContentBytes;
+            public UInt64 mapShadowBytes;
+            public UInt64 spilledBytes;
+            public UInt32 abortedCaptures;
+
+            public double avgFrameTimeMS;
+            public double minFrameTimeMS;
+            public double maxFrameTimeMS;
+
+            [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
+            public CaptureRecordStats[] largestRecords;
+        };
+        [CustomMarshalAs(CustomUnmanagedType.CustomClass)]
+        public CaptureStatsData CaptureStats;
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct EntryPointStatsData
+        {
+            public UInt32 sampleInterval;
+
+            [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
+            public EntryPointStats[] entryPoints;
+        };
+        [CustomMarshalAs(CustomUnmanagedType.CustomClass)]
+        public EntryPointStatsData EntryPoints;
     };
 
     public class ReplayOutput
@@ -129,6 +197,10 @@ public class ReplayOutput
         private static extern bool ReplayOutput_ClearThumbnails(IntPtr real);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayOutput_AddThumbnail(IntPtr real, UInt32 windowSystem, IntPtr wnd, ResourceId texID, FormatComponentType typeHint);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayOutput_SetThumbnailAtlas(IntPtr real, UInt32 windowSystem, IntPtr wnd, UInt32 columns, UInt32 rows);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayOutput_SetAtlasThumbnail(IntPtr real, UInt32 cell, ResourceId texID, FormatComponentType typeHint);
 
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayOutput_Display(IntPtr real);
@@ -180,6 +252,15 @@ public bool AddThumbnail(IntPtr wnd, ResourceId texID, FormatComponentType typeH
             // 1 == eWindowingSystem_Win32
             return ReplayOutput_AddThumbnail(m_Real, 1u, wnd, texID, typeHint);
         }
+        public bool SetThumbnailAtlas(IntPtr wnd, UInt32 columns, UInt32 rows)
+        {
+            // 1 == eWindowingSystem_Win32
+            return ReplayOutput_SetThumbnailAtlas(m_Real, 1u, wnd, columns, rows);
+        }
+        public bool SetAtlasThumbnail(UInt32 cell, ResourceId texID, FormatComponentType typeHint)
+        {
+            return ReplayOutput_SetAtlasThumbnail(m_Real, cell, texID, typeHint);
+        }
 
         public bool Display()
         {
@@ -369,10 +450,23 @@ public class ReplayRenderer
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_GetPostVSData(IntPtr real, UInt32 instID, MeshDataStage stage, IntPtr outdata);
 
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_SearchTextureValues(IntPtr real, ResourceId tex, UInt32 sliceFace, UInt32 mip, UInt32 sample, ref ValueSearchParams searchParams, IntPtr outmatches, out UInt32 numMatches);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_SearchPostVSValues(IntPtr real, UInt32 instID, MeshDataStage stage, ref ValueSearchParams searchParams, IntPtr outmatches, out UInt32 numMatches);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_CompareTextures(IntPtr real, ref TextureCompareInput a, ref TextureCompareInput b, float threshold, IntPtr outresult);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_CompareTextureWithCapture(IntPtr real, ref TextureCompareInput a, IntPtr other, ref TextureCompareInput b, float threshold, IntPtr outresult);
+
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_GetBufferData(IntPtr real, ResourceId buff, UInt64 offset, UInt64 len, IntPtr outdata);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_GetTextureData(IntPtr real, ResourceId tex, UInt32 arrayIdx, UInt32 mip, IntPtr outdata);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_GetBufferDataInto(IntPtr real, ResourceId buff, UInt64 offset, UInt64 len, [Out] byte[] dst, UInt64 dstSize, out UInt64 dataSize);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_GetTextureDataInto(IntPtr real, ResourceId tex, UInt32 arrayIdx, UInt32 mip, [Out] byte[] dst, UInt64 dstSize, out UInt64 dataSize);
 
         private IntPtr m_Real = IntPtr.Zero;
 
@@ -872,6 +966,71 @@ public MeshFormat GetPostVSData(UInt32 instID, MeshDataStage stage)
             return ret;
         }
 
+        // numMatches is the total found, which can be more than the matches returned
+        public ValueSearchMatch[] SearchTextureValues(ResourceId tex, UInt32 sliceFace, UInt32 mip, UInt32 sample, ValueSearchParams searchParams, out UInt32 numMatches)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+
+            bool success = ReplayRenderer_SearchTextureValues(m_Real, tex, sliceFace, mip, sample, ref searchParams, mem, out numMatches);
+
+            ValueSearchMatch[] ret = null;
+
+            if (success)
+                ret = (ValueSearchMatch[])CustomMarshal.GetTemplatedArray(mem, typeof(ValueSearchMatch), true);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
+        public ValueSearchMatch[] SearchPostVSValues(UInt32 instID, MeshDataStage stage, ValueSearchParams searchParams, out UInt32 numMatches)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+
+            bool success = ReplayRenderer_SearchPostVSValues(m_Real, instID, stage, ref searchParams, mem, out numMatches);
+
+            ValueSearchMatch[] ret = null;
+
+            if (success)
+                ret = (ValueSearchMatch[])CustomMarshal.GetTemplatedArray(mem, typeof(ValueSearchMatch), true);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
+        public TextureCompareResult CompareTextures(TextureCompareInput a, TextureCompareInput b, float threshold)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(TextureCompareResult));
+
+            bool success = ReplayRenderer_CompareTextures(m_Real, ref a, ref b, threshold, mem);
+
+            TextureCompareResult ret = null;
+
+            if (success)
+                ret = (TextureCompareResult)CustomMarshal.PtrToStructure(mem, typeof(TextureCompareResult), false);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
+        public TextureCompareResult CompareTextureWithCapture(TextureCompareInput a, ReplayRenderer other, TextureCompareInput b, float threshold)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(TextureCompareResult));
+
+            bool success = ReplayRenderer_CompareTextureWithCapture(m_Real, ref a, other.Real, ref b, threshold, mem);
+
+            TextureCompareResult ret = null;
+
+            if (success)
+                ret = (TextureCompareResult)CustomMarshal.PtrToStructure(mem, typeof(TextureCompareResult), false);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
         public byte[] GetBufferData(ResourceId buff, UInt64 offset, UInt64 len)
         {
             IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
@@ -903,6 +1062,18 @@ public byte[] GetTextureData(ResourceId tex, UInt32 arrayIdx, UInt32 mip)
 
             return ret;
         }
+
+        // reads straight into dst, which the caller sizes. dataSize receives the size of the data
+        // even when dst was too small to hold it
+        public bool GetBufferDataInto(ResourceId buff, UInt64 offset, UInt64 len, byte[] dst, out UInt64 dataSize)
+        {
+            return ReplayRenderer_GetBufferDataInto(m_Real, buff, offset, len, dst, dst == null ? 0 : (UInt64)dst.LongLength, out dataSize);
+        }
+
+        public bool GetTextureDataInto(ResourceId tex, UInt32 arrayIdx, UInt32 mip, byte[] dst, out UInt64 dataSize)
+        {
+            return ReplayRenderer_GetTextureDataInto(m_Real, tex, arrayIdx, mip, dst, dst == null ? 0 : (UInt64)dst.LongLength, out dataSize);
+        }
     };
 
     public class RemoteServer
@@ -1158,6 +1329,14 @@ public class TargetControl
         private static extern void TargetControl_CopyCapture(IntPtr real, UInt32 remoteID, IntPtr localpath);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern void TargetControl_DeleteCapture(IntPtr real, UInt32 remoteID);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void TargetControl_QueryCaptureStats(IntPtr real);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void TargetControl_ProfileEntryPoints(IntPtr real, UInt32 sampleInterval);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void TargetControl_QueryEntryPointStats(IntPtr real);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void TargetControl_SetSpikeCaptureTrigger(IntPtr real, UInt32 thresholdMS, UInt32 averagePercent);
 
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern void TargetControl_ReceiveMessage(IntPtr real, IntPtr outmsg);
@@ -1241,6 +1420,26 @@ public void DeleteCapture(UInt32 id)
             TargetControl_DeleteCapture(m_Real, id);
         }
 
+        public void QueryCaptureStats()
+        {
+            TargetControl_QueryCaptureStats(m_Real);
+        }
+
+        public void ProfileEntryPoints(UInt32 sampleInterval)
+        {
+            TargetControl_ProfileEntryPoints(m_Real, sampleInterval);
+        }
+
+        public void QueryEntryPointStats()
+        {
+            TargetControl_QueryEntryPointStats(m_Real);
+        }
+
+        public void SetSpikeCaptureTrigger(UInt32 thresholdMS, UInt32 averagePercent)
+        {
+            TargetControl_SetSpikeCaptureTrigger(m_Real, thresholdMS, averagePercent);
+        }
+
         public void ReceiveMessage()
         {
             if (m_Real != IntPtr.Zero)
@@ -1288,6 +1487,16 @@ public void ReceiveMessage()
                     NewChild = msg.NewChild;
                     ChildAdded = true;
                 }
+                else if (msg.Type == TargetControlMessageType.CaptureStats)
+                {
+                    CaptureStats = msg.CaptureStats;
+                    StatsUpdated = true;
+                }
+                else if (msg.Type == TargetControlMessageType.EntryPointStats)
+                {
+                    EntryPoints = msg.EntryPoints;
+                    EntryPointsUpdated = true;
+                }
             }
         }
 
@@ -1300,9 +1509,15 @@ public void ReceiveMessage()
         public bool ChildAdded;
         public bool CaptureCopied;
         public bool InfoUpdated;
+        public bool StatsUpdated;
+        public bool EntryPointsUpdated;
 
         public TargetControlMessage.NewCaptureData CaptureFile = new TargetControlMessage.NewCaptureData();
 
         public TargetControlMessage.NewChildData NewChild = new TargetControlMessage.NewChildData();
+
+        public TargetControlMessage.CaptureStatsData CaptureStats = new TargetControlMessage.CaptureStatsData();
+
+        public TargetControlMessage.EntryPointStatsData EntryPoints = new TargetControlMessage.EntryPointStatsData();
     };
 };